@@ -27,11 +27,27 @@ macro(make_importer dir)
 endmacro()
 
 make_importer(rvemc)
-target_link_libraries(rvemc PRIVATE assimp cxxopts simdjson fmt glm rve_importlib meshoptimizer)
+target_link_libraries(rvemc PRIVATE assimp cxxopts simdjson fmt glm rve_importlib meshoptimizer stb_image)
+target_include_directories(rvemc PRIVATE "${CMAKE_CURRENT_LIST_DIR}/../deps/stbi")
 
 make_importer(rveskc)
 target_link_libraries(rveskc PRIVATE assimp cxxopts simdjson fmt glm rve_importlib)
 
 make_importer(rveac)
-target_link_libraries(rveac PRIVATE assimp cxxopts simdjson fmt glm rve_importlib)
+target_link_libraries(rveac PRIVATE assimp cxxopts simdjson fmt glm rve_importlib ozz_animation_offline ozz_animation ozz_base)
+
+make_importer(rveauc)
+target_link_libraries(rveauc PRIVATE cxxopts simdjson fmt libnyquist r8brain)
+
+make_importer(rvetc)
+target_link_libraries(rvetc PRIVATE cxxopts simdjson fmt stb_image dds_image)
+target_include_directories(rvetc PRIVATE "${CMAKE_CURRENT_LIST_DIR}/../deps/stbi")
+
+make_importer(rvepack)
+target_link_libraries(rvepack PRIVATE cxxopts fmt)
+target_include_directories(rvepack PRIVATE "${CMAKE_CURRENT_LIST_DIR}/../deps/miniz-cpp")
+
+make_importer(rvebatch)
+find_package(Threads REQUIRED)
+target_link_libraries(rvebatch PRIVATE cxxopts simdjson fmt Threads::Threads)
 
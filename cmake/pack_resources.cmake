@@ -1,8 +1,8 @@
 # pack resources
 function(pack_resources)
 	set(optional )
-	set(args TARGET OUTPUT_FILE STREAMING_INPUT_ROOT)
-	set(list_args SHADERS MESHES OBJECTS SKELETONS ANIMATIONS TEXTURES UIS FONTS SOUNDS STREAMING_ASSETS)
+	set(args TARGET OUTPUT_FILE STREAMING_INPUT_ROOT LOAD_ORDER)
+	set(list_args SHADERS MESHES OBJECTS SKELETONS ANIMATIONS TEXTURES COMPRESSED_TEXTURES UIS FONTS SOUNDS COMPILED_SOUNDS STREAMING_ASSETS)
 	cmake_parse_arguments(
 		PARSE_ARGV 0
 		ARGS
@@ -42,6 +42,15 @@ function(pack_resources)
 	# clear copy-depends
 	set_property(GLOBAL PROPERTY COPY_DEPENDS "")
 
+	# the inputs of an imported asset: its description, the source file, and files beside it with the same name,
+	# such as the .bin of a .gltf
+	function(import_inputs var conf infile)
+		get_filename_component(in_dir "${infile}" DIRECTORY)
+		get_filename_component(in_stem "${infile}" NAME_WE)
+		file(GLOB sidecars "${in_dir}/${in_stem}.*")
+		set(${var} "${conf}" "${infile}" ${sidecars} PARENT_SCOPE)
+	endfunction()
+
 	function(copy_helper_impl FILE_LIST output_dir root_dir)
 		foreach(FILE ${FILE_LIST})
 			# copy objects pre-build if they are changed
@@ -102,11 +111,11 @@ function(pack_resources)
 	
 	copy_streaming_helper("${ARGS_STREAMING_ASSETS}" "" "${ARGS_STREAMING_INPUT_ROOT}")
 
-	target_sources(${ARGS_TARGET} PUBLIC ${ARGS_OBJECTS} ${ARGS_TEXTURES} ${ARGS_SOUNDS} ${ARGS_MESHES} ${ARGS_SKELETONS} ${ARGS_ANIMATIONS})
-	set_source_files_properties(${ARGS_OBJECTS} ${ARGS_TEXTURES} ${ARGS_SOUNDS} ${ARGS_SKELETONS} ${ARGS_ANIMATIONS} PROPERTIES HEADER_FILE_ONLY ON)
+	target_sources(${ARGS_TARGET} PUBLIC ${ARGS_OBJECTS} ${ARGS_TEXTURES} ${ARGS_COMPRESSED_TEXTURES} ${ARGS_SOUNDS} ${ARGS_MESHES} ${ARGS_SKELETONS} ${ARGS_ANIMATIONS})
+	set_source_files_properties(${ARGS_OBJECTS} ${ARGS_TEXTURES} ${ARGS_COMPRESSED_TEXTURES} ${ARGS_SOUNDS} ${ARGS_SKELETONS} ${ARGS_ANIMATIONS} PROPERTIES HEADER_FILE_ONLY ON)
 	
 	source_group("Objects" FILES ${ARGS_OBJECTS})
-	source_group("Textures" FILES ${ARGS_TEXTURES})
+	source_group("Textures" FILES ${ARGS_TEXTURES} ${ARGS_COMPRESSED_TEXTURES})
 	source_group("Sounds" FILES ${ARGS_SOUNDS})
 	source_group("UI" FILES ${ARGS_UIS})
 	source_group("Streaming" FILES ${ARGS_STREAMING_ASSETS})
@@ -123,10 +132,12 @@ function(pack_resources)
 		get_filename_component(outname "${MESHCONF}" NAME_WE)
 		get_filename_component(indir "${MESHCONF}" DIRECTORY)
 		set(outfilename "${outdir}/${outname}.rvem")
+		import_inputs(inputs "${MESHCONF}" "${indir}/${inmeshfile}")
+		rve_asset_command(import_command "${RVEMC_PATH}" "${inputs}" "${outfilename}" -f "${MESHCONF}" -o "${outdir}")
 		add_custom_command(PRE_BUILD 
 			OUTPUT "${outfilename}"
-			COMMAND ${RVEMC_PATH} -f "${MESHCONF}" -o "${outdir}"
-			DEPENDS "${MESHCONF}" "${indir}/${inmeshfile}" "${RVEMC_PATH}"
+			COMMAND ${import_command}
+			DEPENDS "${MESHCONF}" "${indir}/${inmeshfile}" "${RVEMC_PATH}" ${RVEBATCH_PATH}
 			COMMENT "Importing Mesh ${MESHCONF}"
 		)
 		set_property(GLOBAL APPEND PROPERTY COPY_DEPENDS "${outfilename}")
@@ -147,10 +158,12 @@ function(pack_resources)
 		get_filename_component(outname "${SKELCONF}" NAME_WE)
 		get_filename_component(indir "${SKELCONF}" DIRECTORY)
 		set(outfilename "${outdir}/${outname}.rves")
+		import_inputs(inputs "${SKELCONF}" "${indir}/${inmeshfile}")
+		rve_asset_command(import_command "${RVESKC_PATH}" "${inputs}" "${outfilename}" -f "${SKELCONF}" -o "${outdir}")
 		add_custom_command(PRE_BUILD 
 			OUTPUT "${outfilename}"
-			COMMAND ${RVESKC_PATH} -f "${SKELCONF}" -o "${outdir}"
-			DEPENDS "${SKELCONF}" "${indir}/${inmeshfile}" "${RVESKC_PATH}"
+			COMMAND ${import_command}
+			DEPENDS "${SKELCONF}" "${indir}/${inmeshfile}" "${RVESKC_PATH}" ${RVEBATCH_PATH}
 			COMMENT "Importing Skeleton ${SKELCONF}"
 		)
 		set_property(GLOBAL APPEND PROPERTY COPY_DEPENDS "${outfilename}")
@@ -165,15 +178,59 @@ function(pack_resources)
 		get_filename_component(outname "${ANIMCONF}" NAME_WE)
 		get_filename_component(indir "${ANIMCONF}" DIRECTORY)
 		set(outfilename "${outdir}/${outname}.rvea")
+		import_inputs(inputs "${ANIMCONF}" "${indir}/${inmeshfile}")
+		rve_asset_command(import_command "${RVEAC_PATH}" "${inputs}" "${outfilename}" -f "${ANIMCONF}" -o "${outdir}")
 		add_custom_command(PRE_BUILD 
 			OUTPUT "${outfilename}"
-			COMMAND ${RVEAC_PATH} -f "${ANIMCONF}" -o "${outdir}"
-			DEPENDS "${ANIMCONF}" "${indir}/${inmeshfile}" "${RVEAC_PATH}"
+			COMMAND ${import_command}
+			DEPENDS "${ANIMCONF}" "${indir}/${inmeshfile}" "${RVEAC_PATH}" ${RVEBATCH_PATH}
 			COMMENT "Importing Animation ${ANIMCONF}"
 		)
 		set_property(GLOBAL APPEND PROPERTY COPY_DEPENDS "${outfilename}")
 	endforeach()
 
+	# compress Textures
+	foreach(TEXCONF ${ARGS_COMPRESSED_TEXTURES})
+		file(READ "${TEXCONF}" desc_STR)
+		string(JSON intexfile GET "${desc_STR}" file)
+		
+		set(outdir "${CMAKE_CURRENT_BINARY_DIR}/${ARGS_TARGET}/textures/")
+		get_filename_component(outname "${TEXCONF}" NAME_WE)
+		get_filename_component(indir "${TEXCONF}" DIRECTORY)
+		set(outfilename "${outdir}/${outname}.dds")
+		rve_asset_command(import_command "${RVETC_PATH}" "${TEXCONF};${indir}/${intexfile}" "${outfilename}" -f "${TEXCONF}" -o "${outdir}")
+		add_custom_command(PRE_BUILD 
+			OUTPUT "${outfilename}"
+			COMMAND ${import_command}
+			DEPENDS "${TEXCONF}" "${indir}/${intexfile}" "${RVETC_PATH}" ${RVEBATCH_PATH}
+			COMMENT "Compressing Texture ${TEXCONF}"
+		)
+		set_property(GLOBAL APPEND PROPERTY COPY_DEPENDS "${outfilename}")
+		target_sources(${ARGS_TARGET} PUBLIC "${indir}/${intexfile}")
+		set_source_files_properties("${indir}/${intexfile}" PROPERTIES HEADER_FILE_ONLY ON)
+	endforeach()
+
+	# compile Sounds to the output rate and channels, so they load without resampling
+	foreach(SOUNDCONF ${ARGS_COMPILED_SOUNDS})
+		file(READ "${SOUNDCONF}" desc_STR)
+		string(JSON insoundfile GET "${desc_STR}" file)
+		
+		set(outdir "${CMAKE_CURRENT_BINARY_DIR}/${ARGS_TARGET}/sounds/")
+		get_filename_component(outname "${SOUNDCONF}" NAME_WE)
+		get_filename_component(indir "${SOUNDCONF}" DIRECTORY)
+		set(outfilename "${outdir}/${outname}.rvesnd")
+		rve_asset_command(import_command "${RVEAUC_PATH}" "${SOUNDCONF};${indir}/${insoundfile}" "${outfilename}" -f "${SOUNDCONF}" -o "${outdir}")
+		add_custom_command(PRE_BUILD 
+			OUTPUT "${outfilename}"
+			COMMAND ${import_command}
+			DEPENDS "${SOUNDCONF}" "${indir}/${insoundfile}" "${RVEAUC_PATH}" ${RVEBATCH_PATH}
+			COMMENT "Compiling Sound ${SOUNDCONF}"
+		)
+		set_property(GLOBAL APPEND PROPERTY COPY_DEPENDS "${outfilename}")
+		target_sources(${ARGS_TARGET} PUBLIC "${indir}/${insoundfile}")
+		set_source_files_properties("${indir}/${insoundfile}" PROPERTIES HEADER_FILE_ONLY ON)
+	endforeach()
+
 	# get dependency outputs
 	get_property(copy_depends GLOBAL PROPERTY COPY_DEPENDS)
 
@@ -277,13 +334,16 @@ function(pack_resources)
 
 	set(assets ${ARGS_OBJECTS} ${ARGS_TEXTURES} ${copy_depends})
 
-	# the command to pack into a zip
+	# the command to pack into an asset pack, optionally laid out in the order given by LOAD_ORDER
+	if (ARGS_LOAD_ORDER)
+		set(load_order_args --order "${ARGS_LOAD_ORDER}")
+	endif()
 	add_custom_command(
 		POST_BUILD 
 		OUTPUT "${outpack}"
-		DEPENDS ${assets}
+		DEPENDS ${assets} ${ARGS_LOAD_ORDER} "${RVEPACK_PATH}"
 		COMMENT "Packing resources for ${ARGS_TARGET} to ${outpack}"
-		COMMAND ${CMAKE_COMMAND} -E tar "cfv" "${outpack}" --format=zip "${CMAKE_CURRENT_BINARY_DIR}/${ARGS_TARGET}"
+		COMMAND ${RVEPACK_PATH} -i "${CMAKE_CURRENT_BINARY_DIR}/${ARGS_TARGET}" -o "${outpack}" ${load_order_args}
 		VERBATIM
 	)
 
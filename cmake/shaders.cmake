@@ -21,6 +21,29 @@ define_property(GLOBAL PROPERTY COPY_DEPENDS
 	FULL_DOCS "Engine Directory"
 )
 
+# sets var to the command that runs tool with the remaining arguments, through the asset cache if it is enabled,
+# so that rerunning it with unchanged inputs copies the outputs from the cache instead of compiling them again.
+# the tool binary is part of the cache key, so rebuilding a tool only invalidates the cache if the tool changed.
+function(rve_asset_command var tool inputs outputs)
+	set(tool_arg "${tool}")
+	if (TARGET "${tool}")
+		# built in this tree, and it is an argument rather than the command, so CMake won't resolve it
+		set(tool_arg "$<TARGET_FILE:${tool}>")
+	endif()
+	if (NOT RAVENGINE_ASSET_CACHE)
+		set(${var} "${tool_arg}" ${ARGN} PARENT_SCOPE)
+		return()
+	endif()
+	set(command "${RVEBATCH_PATH}" -c "${RAVENGINE_ASSET_CACHE_DIR}")
+	foreach(input ${inputs})
+		list(APPEND command --in "${input}")
+	endforeach()
+	foreach(output ${outputs})
+		list(APPEND command --out "${output}")
+	endforeach()
+	set(${var} ${command} -- "${tool_arg}" ${ARGN} PARENT_SCOPE)
+endfunction()
+
 macro(shader_compile infile stage api extension binary)
 	if (NOT RAVENGINE_SERVER)
 		set(bindir "${shader_target}_ShaderIntermediate")
@@ -33,11 +56,15 @@ macro(shader_compile infile stage api extension binary)
 		if (${api} MATCHES "Metal")
 			set(entrypoint "--entrypoint" "${name_only}")
 		endif()
+		file(GLOB shader_includes "${shader_inc_dir}/*.glsl" "${shader_inc_dir}/*.h")
+		rve_asset_command(rglc_command "${rglc_path}" "${infile};${shader_includes}" "${outname}"
+			-f "${infile}" -o "${outname}" --api ${api} --stage ${stage} --include "${shader_inc_dir}" --debug ${binary} ${entrypoint}
+		)
 		add_custom_command(
 			PRE_BUILD
 			OUTPUT "${outname}"
-			DEPENDS ${infile} GNS_Deps "${eng_dir}/shaders/ravengine_shader.glsl" "${eng_dir}/shaders/ravengine_shader_defs.h" "${eng_dir}/shaders/BRDF.glsl"
-			COMMAND ${rglc_path} -f "${infile}" -o "${outname}" --api ${api} --stage ${stage} --include "${shader_inc_dir}" --debug ${binary} ${entrypoint}
+			DEPENDS ${infile} GNS_Deps "${eng_dir}/shaders/ravengine_shader.glsl" "${eng_dir}/shaders/ravengine_shader_defs.h" "${eng_dir}/shaders/BRDF.glsl" ${RVEBATCH_PATH}
+			COMMAND ${rglc_command}
 		)
 	endif()
 endmacro()
@@ -51,12 +78,21 @@ macro(rvesc_compile_shader infile shaderfile api extension outputfilename extraf
 	set(shaderfilepath  "${desc_dir}/${shaderfile}")
 
 	separate_arguments(sh_extraflags_sep UNIX_COMMAND ${extraflags})
-	
+	if (RAVENGINE_REDUCED_PRECISION_SHADERS)
+		list(APPEND sh_extraflags_sep --reduced-precision)
+	endif()
+
+	# the shader can include the engine's headers and ones next to it
+	file(GLOB shader_includes "${shader_inc_dir}/*.glsl" "${shader_inc_dir}/*.h" "${desc_dir}/*.glsl" "${desc_dir}/*.h")
+	# only debug builds keep debug info, everything else goes through the SPIR-V optimizer
+	rve_asset_command(rvesc_command "${RVESC_PATH}" "${infile};${shaderfilepath};${shader_includes}" "${outname}"
+		-f "${infile}" -o "${outname}" --api ${api} --include "${shader_inc_dir}" ${sh_extraflags_sep} $<$<CONFIG:Debug>:--debug>
+	)
 	add_custom_command(
 		PRE_BUILD
 		OUTPUT "${outname}"
-		DEPENDS "${infile}" GNS_Deps "${RVESC_PATH}" "${shaderfilepath}"
-		COMMAND ${RVESC_PATH} -f "${infile}" -o "${outname}" --api ${api} --include "${shader_inc_dir}" ${sh_extraflags_sep} --debug 
+		DEPENDS "${infile}" GNS_Deps "${RVESC_PATH}" "${shaderfilepath}" ${RVEBATCH_PATH}
+		COMMAND ${rvesc_command}
 	)
 
 endmacro()
@@ -736,32 +736,36 @@ CompileResult SerializeSPIRV(const spirvbytes& bin){
  Perform standard optimizations on a SPIR-V binary
  @param bin the SPIR-V binary to optimize
  @param options settings for the optimizer
+ @param translating true if SPIRV-Cross or DXC translates the binary rather than a Vulkan driver loading it. These get the performance passes (spirv-opt -O)
+ and keep the SPIR-V version glslang wrote, because options.version is the version of the target language.
  */
-spirvbytes OptimizeSPIRV(const spirvbytes& bin, const Options &options){
+spirvbytes OptimizeSPIRV(const spirvbytes& bin, const Options &options, bool translating = false){
 	
-	spv_target_env target;
-	switch(options.version){
-		case 10:
-			target = SPV_ENV_UNIVERSAL_1_0;
-			break;
-		case 11:
-			target = SPV_ENV_UNIVERSAL_1_1;
-			break;
-		case 12:
-			target = SPV_ENV_UNIVERSAL_1_2;
-			break;
-		case 13:
-			target = SPV_ENV_UNIVERSAL_1_3;
-			break;
-		case 14:
-			target = SPV_ENV_UNIVERSAL_1_4;
-			break;
-		case 15:
-			target = SPV_ENV_UNIVERSAL_1_5;
-			break;
-		default:
-			throw runtime_error("Unknown Vulkan version");
-			break;
+	spv_target_env target = SPV_ENV_UNIVERSAL_1_6;	// the version glslang writes
+	if (!translating) {
+		switch(options.version){
+			case 10:
+				target = SPV_ENV_UNIVERSAL_1_0;
+				break;
+			case 11:
+				target = SPV_ENV_UNIVERSAL_1_1;
+				break;
+			case 12:
+				target = SPV_ENV_UNIVERSAL_1_2;
+				break;
+			case 13:
+				target = SPV_ENV_UNIVERSAL_1_3;
+				break;
+			case 14:
+				target = SPV_ENV_UNIVERSAL_1_4;
+				break;
+			case 15:
+				target = SPV_ENV_UNIVERSAL_1_5;
+				break;
+			default:
+				throw runtime_error("Unknown Vulkan version");
+				break;
+		}
 	}
 	
 	spvtools::MessageConsumer consumer = [&](spv_message_level_t level, const char* source, const spv_position_t& position, const char* message){
@@ -780,9 +784,14 @@ spirvbytes OptimizeSPIRV(const spirvbytes& bin, const Options &options){
     
     //create a general optimizer
 	spvtools::Optimizer optimizer(target);
-	optimizer.RegisterSizePasses();
-	optimizer.RegisterPerformancePasses();
-	optimizer.RegisterLegalizationPasses();
+	if (translating) {
+		optimizer.RegisterPerformancePasses();
+	}
+	else {
+		optimizer.RegisterSizePasses();
+		optimizer.RegisterPerformancePasses();
+		optimizer.RegisterLegalizationPasses();
+	}
 	optimizer.SetMessageConsumer(consumer);
 	
 	spirvbytes newbin;
@@ -832,6 +841,11 @@ static APIConversion ShaderStageToInternal(ShaderStage api) {
 }
 
 static CompileResult CompileSpirVTo(const spirvbytes& spirv, TargetAPI api, const Options& opt,  APIConversion types) {
+	// fold constants and eliminate dead branches before translating, so permutations compiled with a feature off do not carry its code.
+	// WGSL is left as is, because Tint's SPIR-V reader rejects some of what the optimizer writes.
+	auto translated = [&]() -> spirvbytes {
+		return opt.debug ? spirv : OptimizeSPIRV(spirv, opt, true);
+	};
 	switch (api) {
 	case TargetAPI::OpenGL:
 	case TargetAPI::OpenGL_ES:
@@ -848,19 +862,19 @@ static CompileResult CompileSpirVTo(const spirvbytes& spirv, TargetAPI api, cons
 		
 		break;
 	case TargetAPI::HLSL:
-		return CompileResult{ SPIRVToHLSL(spirv,opt,types.model) };
+		return CompileResult{ SPIRVToHLSL(translated(),opt,types.model) };
 		break;
 	case TargetAPI::Metal:
-		return CompileResult{ SPIRVtoMSL(spirv,opt,types.model) };
+		return CompileResult{ SPIRVtoMSL(translated(),opt,types.model) };
 		break;
 #ifdef ST_DXIL_ENABLED
 	case TargetAPI::DXIL:
-		return CompileResult{ SPIRVToDXIL(spirv,opt,types.model) };
+		return CompileResult{ SPIRVToDXIL(translated(),opt,types.model) };
 		break;
 #endif
 #ifdef __APPLE__
 	case TargetAPI::MetalBinary:
-		return CompileResult{SPIRVtoMBL(spirv,opt,types.model)};
+		return CompileResult{SPIRVtoMBL(translated(),opt,types.model)};
 		break;
 #endif
 	case TargetAPI::WGSL:
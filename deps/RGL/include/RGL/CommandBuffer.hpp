@@ -7,6 +7,7 @@
 #include <RGL/Synchronization.hpp>
 #include <span>
 #include <string>
+#include <vector>
 
 struct DrawInstancedConfig{
     uint32_t
@@ -43,8 +44,18 @@ namespace RGL {
 	};
 
 
+	// how much of a command buffer waits for the command buffers it depends on
+	enum class WaitStage : uint8_t {
+		AllCommands,	// nothing starts until they finish
+		Draws,			// compute and copies may start early; draws, from reading indirect arguments on, wait
+	};
+
 	struct CommitConfig {
 		RGLFencePtr signalFence;
+		// command buffers committed earlier this frame, on any queue of the same device, that the GPU must finish first.
+		// This is how work on a ComputeOnly queue is ordered against the AllCommands queue.
+		std::span<const RGLCommandBufferPtr> waitFor;
+		WaitStage waitStage = WaitStage::AllCommands;
 	};
 
 	struct ResourceBarrierConfig {
@@ -75,6 +86,10 @@ namespace RGL {
 		RGLBufferPtr indirectBuffer;
 		uint32_t offsetIntoBuffer = 0;	// in bytes
 		uint32_t nDraws;
+		// optional: read the number of draws (a uint32) from this buffer, nDraws becomes the upper bound.
+		// Only valid if the device SupportsIndirectCount.
+		RGLBufferPtr countBuffer;
+		uint32_t countBufferOffset = 0;	// in bytes
 	};
 
 	struct DispatchIndirectConfig {
@@ -96,6 +111,20 @@ namespace RGL {
 
 struct TextureView;
 
+	// GPU time spent between a Begin*DebugMarker and its matching End*DebugMarker
+	struct TimestampRegion {
+		std::string label;
+		uint64_t beginNs = 0, endNs = 0;	// on the GPU's clock
+		uint32_t depth = 0;					// number of enclosing markers
+	};
+
+	// draws and dispatches encoded between a Begin*DebugMarker and its matching End*DebugMarker, including those of nested markers
+	struct CommandCountRegion {
+		std::string label;
+		uint32_t draws = 0, dispatches = 0;	// an indirect command counts as the number of commands it may execute
+		uint32_t depth = 0;					// number of enclosing markers
+	};
+
 	struct ICommandBuffer {
 		// clear the command buffer, to encode new commands
 		virtual void Reset() = 0;
@@ -146,6 +175,7 @@ struct TextureView;
 			TextureView view;
 			Rect destLoc;
 			uint32_t arrayLayer = 0;
+			uint32_t mip = 0;
 		};
 		virtual void CopyBufferToTexture(RGLBufferPtr source, uint32_t size, const TextureDestConfig& dest) = 0;
 
@@ -179,6 +209,57 @@ struct TextureView;
 		virtual void EndRenderDebugMarker() = 0;
 		virtual void EndComputeDebugMarker() = 0;
 
+		// when enabled, debug markers also record GPU timestamps. Backends without timestamp support ignore this.
+		virtual void SetTimestampsEnabled(bool enabled) {}
+
+		// the regions of the most recently completed submission, in the order their markers began.
+		// Read after Reset, which waits for that submission.
+		virtual std::span<const TimestampRegion> GetResolvedTimestamps() const { return {}; }
+
+		// when enabled, debug markers also count the draws and dispatches encoded inside them
+		void SetCommandCountsEnabled(bool enabled) {
+			countingCommands = enabled;
+		}
+
+		// the regions of the commands encoded since the last Begin, in the order their markers began
+		std::span<const CommandCountRegion> GetCommandCounts() const {
+			return commandCounts;
+		}
+
 		virtual void BlockUntilCompleted() = 0;
+
+	protected:
+		// for backends to call from Begin, the debug markers, and the draw and dispatch functions
+		void ResetCommandCounts() {
+			recordingCounts = countingCommands;	// so markers begun before a change are not ended after it
+			commandCounts.clear();
+			openCountRegions.clear();
+		}
+		void CountBeginMarker(const std::string& label) {
+			if (recordingCounts) {
+				openCountRegions.push_back(uint32_t(commandCounts.size()));
+				commandCounts.push_back({ .label = label, .depth = uint32_t(openCountRegions.size() - 1) });
+			}
+		}
+		void CountEndMarker() {
+			if (!openCountRegions.empty()) {
+				openCountRegions.pop_back();
+			}
+		}
+		void CountDraws(uint32_t count) {
+			for (const auto region : openCountRegions) {
+				commandCounts[region].draws += count;
+			}
+		}
+		void CountDispatches(uint32_t count) {
+			for (const auto region : openCountRegions) {
+				commandCounts[region].dispatches += count;
+			}
+		}
+
+	private:
+		bool countingCommands = false, recordingCounts = false;
+		std::vector<CommandCountRegion> commandCounts;
+		std::vector<uint32_t> openCountRegions;		// indices into commandCounts
 	};
 }
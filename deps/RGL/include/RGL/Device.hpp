@@ -3,6 +3,8 @@
 #include <string>
 #include <span>
 #include <filesystem>
+#include <vector>
+#include <cstddef>
 #include <RGL/CommandQueue.hpp>
 #include <RGL/Span.hpp>
 #include <RGL/Types.hpp>
@@ -69,5 +71,28 @@ namespace RGL {
 
 		virtual RGLFencePtr CreateFence(bool preSignaled) = 0;
 		virtual void BlockUntilIdle() = 0;
+
+		/**
+		Seed the pipeline cache with data saved by GetPipelineCacheData on a previous run. Pipelines created afterwards
+		skip driver compilation when they hit. Data from a different device or driver is ignored.
+		Backends without a pipeline cache ignore this.
+		*/
+		virtual void LoadPipelineCache(std::span<const std::byte> data) {}
+
+		/**
+		@return the contents of the pipeline cache, to be persisted and passed to LoadPipelineCache. Empty if the backend has no pipeline cache.
+		*/
+		virtual std::vector<std::byte> GetPipelineCacheData() const { return {}; }
+
+		/**
+		@return true if ExecuteIndirect and ExecuteIndirectIndexed accept IndirectConfig::countBuffer
+		*/
+		virtual bool SupportsIndirectCount() const { return false; }
+
+		/**
+		@return the size in pixels of the square each texel of a shading rate texture covers, or 0 if render passes cannot take one.
+		See IRenderPass::SetShadingRateTexture.
+		*/
+		virtual uint32_t GetShadingRateTileSize() const { return 0; }
 	};
 }
@@ -263,6 +263,9 @@ namespace RGL {
 		// list of what states are dynamic (TODO)
 		RGLPipelineLayoutPtr pipelineLayout;
 
+		// draws use the render pass's shading rate texture. Required for pipelines drawn in a pass that has one, and invalid in a pass that does not.
+		bool variableShadingRate = false;
+
 		std::string debugName;
 	};
 
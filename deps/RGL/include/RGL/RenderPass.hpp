@@ -31,6 +31,13 @@ struct IRenderPass {
     virtual void SetAttachmentTexture(uint32_t index, const TextureView& texture) = 0;
     virtual void SetDepthAttachmentTexture(const TextureView& texture) = 0;
     virtual void SetStencilAttachmentTexture(const TextureView& texture) = 0;
+
+    /**
+     Shade each tile of the attachments at the rate in the matching texel of this R8_Uint texture, which must have TextureUsage::ShadingRate.
+     A texel's value is (log2(width) << 2) | log2(height) of the rate, so 0 is every pixel and 5 is one shade per 2x2 pixels.
+     Only has an effect if the device's GetShadingRateTileSize is not 0.
+     */
+    virtual void SetShadingRateTexture(const TextureView& texture) {}
 };
 
 RGLRenderPassPtr CreateRenderPass(const RenderPassConfig& config);
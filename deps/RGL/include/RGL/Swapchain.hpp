@@ -8,6 +8,15 @@ namespace RGL{
 	struct SwapchainPresentConfig {
 		uint32_t imageIndex = 0;
 	};
+
+	// how presented images reach the display. Backends without a mode use the nearest one they have.
+	enum class PresentMode : uint8_t {
+		Fifo,			// wait for vertical blank, never tears
+		FifoRelaxed,	// wait for vertical blank, but a late frame is shown at once and tears, instead of waiting a whole refresh. Fifo where unavailable.
+		Mailbox,		// never tears, and a newer frame replaces a queued one instead of waiting, so rendering is not throttled. Immediate where unavailable.
+		Immediate,		// show frames as soon as they are presented, tears
+	};
+
 	struct ISwapchain{
 		virtual ~ISwapchain() {}
 		virtual void Resize(uint32_t width, uint32_t height) = 0;
@@ -15,6 +24,22 @@ namespace RGL{
 		virtual ITexture* ImageAtIndex(uint32_t index) = 0;
 		virtual void Present(const SwapchainPresentConfig&) = 0;
 
-		virtual void SetVsyncMode(bool mode) = 0;
+		virtual void SetPresentMode(PresentMode mode) = 0;
+
+		void SetVsyncMode(bool mode) {
+			SetPresentMode(mode ? PresentMode::Fifo : PresentMode::Immediate);
+		}
+
+		/**
+		 Limit how many presented frames may wait for the display. Lower values show input sooner, at the cost of GPU idle time.
+		 Metal supports 1 and 2. Has no effect on backends without latency control.
+		 */
+		virtual void SetMaxFrameLatency(uint32_t frames) = 0;
+
+		/**
+		 Block until the display has taken enough frames that presenting another stays within SetMaxFrameLatency.
+		 Call this before reading input for a frame, so the frame is built from input that is as new as possible.
+		 */
+		virtual void WaitForFrameLatency() = 0;
 	};
 }
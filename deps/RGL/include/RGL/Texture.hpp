@@ -159,6 +159,7 @@ namespace RGL {
 		uint32_t layer = 0;
 	};
 
+	// the data of every mip in the texture config, tightly packed and largest first, see MipSizeBytes
 	struct TextureUploadData {
 		untyped_span data{nullptr, 0};
 		TextureUploadData(const decltype(data)& data) : data(data) {}
@@ -36,6 +36,8 @@ namespace RGL {
         RGBA32_Sfloat,
 
         R8_Uint,
+        R8_Unorm,
+        RG8_Unorm,
         R16_Float,
         R32_Uint,
         R32_Float,
@@ -57,10 +59,66 @@ namespace RGL {
         BC5_Unorm,          // DXT5
         BC5_SRGB,
 
+        BC7_Unorm,
+        BC7_SRGB,
+
 		D32SFloat,			// 32 bit float
 		D24UnormS8Uint,		// 24 bit depth, 8 bit stencil
 	};
 
+	/**
+	@return the width and height of a block of texels in the format, 4 for block-compressed formats and 1 for the rest
+	*/
+	inline uint32_t FormatBlockDimension(TextureFormat format) {
+		switch (format) {
+		case TextureFormat::BC1_RGB_Unorm: case TextureFormat::BC1_RGB_SRGB: case TextureFormat::BC1_RGBA_Unorm: case TextureFormat::BC1_RGBA_SRGB:
+		case TextureFormat::BC2_Unorm: case TextureFormat::BC2_SRGB:
+		case TextureFormat::BC3_Unorm: case TextureFormat::BC3_SRGB:
+		case TextureFormat::BC4_Unorm: case TextureFormat::BC4_SRGB:
+		case TextureFormat::BC5_Unorm: case TextureFormat::BC5_SRGB:
+		case TextureFormat::BC7_Unorm: case TextureFormat::BC7_SRGB:
+			return 4;
+		default:
+			return 1;
+		}
+	}
+
+	/**
+	@return the size of one block of the format in bytes. In uncompressed formats, a block is one texel.
+	*/
+	inline uint32_t FormatBytesPerBlock(TextureFormat format) {
+		switch (format) {
+		case TextureFormat::R8_Uint: case TextureFormat::R8_Unorm:
+			return 1;
+		case TextureFormat::RG8_Unorm: case TextureFormat::R16_Float:
+			return 2;
+		case TextureFormat::BGRA8_Unorm: case TextureFormat::RGBA8_Uint: case TextureFormat::RGBA8_Unorm:
+		case TextureFormat::R32_Uint: case TextureFormat::R32_Float: case TextureFormat::D32SFloat: case TextureFormat::D24UnormS8Uint:
+			return 4;
+		case TextureFormat::RGBA16_Unorm: case TextureFormat::RGBA16_Snorm: case TextureFormat::RGBA16_Sfloat:
+		case TextureFormat::BC1_RGB_Unorm: case TextureFormat::BC1_RGB_SRGB: case TextureFormat::BC1_RGBA_Unorm: case TextureFormat::BC1_RGBA_SRGB:
+		case TextureFormat::BC4_Unorm: case TextureFormat::BC4_SRGB:
+			return 8;
+		case TextureFormat::RGBA32_Sfloat:
+		case TextureFormat::BC2_Unorm: case TextureFormat::BC2_SRGB:
+		case TextureFormat::BC3_Unorm: case TextureFormat::BC3_SRGB:
+		case TextureFormat::BC5_Unorm: case TextureFormat::BC5_SRGB:
+		case TextureFormat::BC7_Unorm: case TextureFormat::BC7_SRGB:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
+	/**
+	@return the size of one mip of a texture, in bytes
+	*/
+	inline uint32_t MipSizeBytes(TextureFormat format, uint32_t width, uint32_t height, uint32_t mip) {
+		const auto blockDim = FormatBlockDimension(format);
+		const uint32_t mipWidth = (width >> mip) > 0 ? (width >> mip) : 1, mipHeight = (height >> mip) > 0 ? (height >> mip) : 1;
+		return ((mipWidth + blockDim - 1) / blockDim) * ((mipHeight + blockDim - 1) / blockDim) * FormatBytesPerBlock(format);
+	}
+
 	enum class MSASampleCount : uint8_t {
             C0 = 0,
 			C1 = 1,
@@ -94,6 +152,7 @@ namespace RGL {
         bool DepthStencilAttachment : 1 = false;
         bool TransientAttachment : 1 = false;
         bool InputAttachment : 1 = false;
+        bool ShadingRate : 1 = false;       // bound with IRenderPass::SetShadingRateTexture
     };
 
     struct TextureAspect {
@@ -46,6 +46,7 @@ namespace RGL {
 			owningQueue->owningDevice->SamplerHeap->Heap(),
 		};
 		commandList->SetDescriptorHeaps(std::size(heaps), heaps);
+		ResetCommandCounts();
 	}
 	void CommandBufferD3D12::End()
 	{
@@ -140,9 +141,29 @@ namespace RGL {
 
 		// bind the targets
 		commandList->OMSetRenderTargets(nrtvs, rtvs, FALSE, dsvptr);
+
+		// the shading rate image overrides the draws' rate of 1x1
+		if (currentRenderPass->shadingRateTexture) {
+			auto& tx = currentRenderPass->shadingRateTexture->texture.dx;
+			Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList5> commandList5;
+			if (tx.parentResource->owningDevice->shadingRateTileSize > 0 && SUCCEEDED(commandList.As(&commandList5))) {
+				SyncIfNeeded(tx, D3D12_RESOURCE_STATE_SHADING_RATE_SOURCE, false);
+				constexpr D3D12_SHADING_RATE_COMBINER combiners[] = { D3D12_SHADING_RATE_COMBINER_PASSTHROUGH, D3D12_SHADING_RATE_COMBINER_OVERRIDE };
+				commandList5->RSSetShadingRate(D3D12_SHADING_RATE_1X1, combiners);
+				commandList5->RSSetShadingRateImage(tx.parentResource->texture.Get());
+				shadingRateImageBound = true;
+			}
+		}
 	}
 	void CommandBufferD3D12::EndRendering()
 	{
+		if (shadingRateImageBound) {
+			Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList5> commandList5;
+			commandList.As(&commandList5);
+			commandList5->RSSetShadingRateImage(nullptr);
+			commandList5->RSSetShadingRate(D3D12_SHADING_RATE_1X1, nullptr);
+			shadingRateImageBound = false;
+		}
 		currentRenderPass = nullptr;
 		currentRenderPipeline = nullptr;
 	}
@@ -165,6 +186,7 @@ namespace RGL {
 	}
 	void CommandBufferD3D12::DispatchCompute(uint32_t threadsX, uint32_t threadsY, uint32_t threadsZ,  uint32_t threadsPerThreadgroupX, uint32_t threadsPerThreadgroupY, uint32_t threadsPerThreadgroupZ)
 	{
+		CountDispatches(1);
 		commandList->Dispatch(threadsX, threadsY, threadsZ);
 	}
 	void CommandBufferD3D12::BindBuffer(RGLBufferPtr buffer, uint32_t bindingOffset, uint32_t offsetIntoBuffer)
@@ -207,7 +229,12 @@ namespace RGL {
 	{
 		SyncIfNeeded(static_cast<const BufferD3D12*>(buffer.get()), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, false);
 
-		commandList->IASetVertexBuffers(bindingInfo.bindingPosition, 1, &std::static_pointer_cast<BufferD3D12>(buffer)->vertexBufferView + bindingInfo.offsetIntoBuffer);
+		// the offset is in elements, as on the other backends
+		auto view = std::static_pointer_cast<BufferD3D12>(buffer)->vertexBufferView;
+		const auto offsetBytes = uint64_t(bindingInfo.offsetIntoBuffer) * view.StrideInBytes;
+		view.BufferLocation += offsetBytes;
+		view.SizeInBytes -= UINT(offsetBytes);
+		commandList->IASetVertexBuffers(bindingInfo.bindingPosition, 1, &view);
 	}
 	void CommandBufferD3D12::SetVertexBytes(const untyped_span data, uint32_t offset)
 	{
@@ -326,10 +353,12 @@ namespace RGL {
 
 	void CommandBufferD3D12::Draw(uint32_t nVertices, const DrawInstancedConfig& config)
 	{
+		CountDraws(1);
 		commandList->DrawInstanced(nVertices, config.nInstances, config.startVertex, config.firstInstance);
 	}
 	void CommandBufferD3D12::DrawIndexed(uint32_t nIndices, const DrawIndexedInstancedConfig& config)
 	{
+		CountDraws(1);
 		commandList->DrawIndexedInstanced(nIndices, config.nInstances, config.firstIndex, config.startVertex, config.firstInstance);
 	}
 
@@ -399,7 +428,7 @@ namespace RGL {
 	{
 
 		auto castedBuffer = std::static_pointer_cast<BufferD3D12>(source);
-		auto mip = 0;	// TODO: support mip levels other than 0
+		auto mip = dest.mip;
 		auto layer = dest.arrayLayer;
 
 		D3D12_TEXTURE_COPY_LOCATION destination{
@@ -413,7 +442,7 @@ namespace RGL {
 		};
 		D3D12_RESOURCE_DESC srcDesc = destination.pResource->GetDesc();
 		castedBuffer->owningDevice->device->GetCopyableFootprints(
-			&srcDesc, 0, 1, 0,
+			&srcDesc, destination.SubresourceIndex, 1, 0,
 			&srcLocation.PlacedFootprint,
 			NULL, NULL, NULL
 		);
@@ -491,6 +520,11 @@ namespace RGL {
 
 	void CommandBufferD3D12::Commit(const CommitConfig& config)
 	{
+		// D3D12 queues wait whole, so every WaitStage waits for all commands
+		for (const auto& dependency : config.waitFor) {
+			auto dependencyD3D12 = static_cast<CommandBufferD3D12*>(dependency.get());
+			owningQueue->m_d3d12CommandQueue->Wait(dependencyD3D12->internalFence.Get(), 1);	// signalled by its commit
+		}
 		owningQueue->ExecuteCommandList(commandList);
 		if (config.signalFence) {
 			auto d3d12fence = std::static_pointer_cast<FenceD3D12>(config.signalFence);
@@ -503,15 +537,20 @@ namespace RGL {
 		auto buffer = std::static_pointer_cast<BufferD3D12>(config.indirectBuffer);
 
 		SyncIfNeeded(static_cast<const BufferD3D12*>(buffer.get()), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, false);
+		auto countBuffer = std::static_pointer_cast<BufferD3D12>(config.countBuffer);
+		if (countBuffer) {
+			SyncIfNeeded(static_cast<const BufferD3D12*>(countBuffer.get()), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, false);
+		}
 
 		auto sig = buffer->owningDevice->multidrawIndexedSignature;
+		CountDraws(config.nDraws);
 		commandList->ExecuteIndirect(
 			sig.Get(),
 			config.nDraws,
 			buffer->buffer.Get(),
 			config.offsetIntoBuffer,
-			nullptr,
-			0
+			countBuffer ? countBuffer->buffer.Get() : nullptr,
+			config.countBufferOffset
 		);
 	}
 	void CommandBufferD3D12::ExecuteIndirect(const IndirectConfig& config)
@@ -519,15 +558,20 @@ namespace RGL {
 		auto buffer = std::static_pointer_cast<BufferD3D12>(config.indirectBuffer);
 
 		SyncIfNeeded(static_cast<const BufferD3D12*>(buffer.get()), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, false);
+		auto countBuffer = std::static_pointer_cast<BufferD3D12>(config.countBuffer);
+		if (countBuffer) {
+			SyncIfNeeded(static_cast<const BufferD3D12*>(countBuffer.get()), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, false);
+		}
 
 		auto sig = buffer->owningDevice->multidrawSignature;
+		CountDraws(config.nDraws);
 		commandList->ExecuteIndirect(
 			sig.Get(),
 			config.nDraws,
 			buffer->buffer.Get(),
 			config.offsetIntoBuffer,
-			nullptr,
-			0
+			countBuffer ? countBuffer->buffer.Get() : nullptr,
+			config.countBufferOffset
 		);
 	}
 	void CommandBufferD3D12::DispatchIndirect(const DispatchIndirectConfig& config)
@@ -537,6 +581,7 @@ namespace RGL {
 		SyncIfNeeded(static_cast<const BufferD3D12*>(buffer.get()), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, false);
 
 		auto sig = buffer->owningDevice->dispatchIndirectSignature;
+		CountDispatches(1);
 		commandList->ExecuteIndirect(
 			sig.Get(),
 			1,
@@ -549,6 +594,7 @@ namespace RGL {
 	}
 	void CommandBufferD3D12::BeginRenderDebugMarker(const std::string& label)
 	{
+		CountBeginMarker(label);
 		/*
 		auto fn = GetBeginEvent();
 		if (fn != nullptr) {
@@ -565,6 +611,7 @@ namespace RGL {
 	}
 	void CommandBufferD3D12::EndRenderDebugMarker()
 	{
+		CountEndMarker();
 		/*
 		auto fn = GetEndEvent();
 		if (fn != nullptr) {
@@ -40,6 +40,7 @@ namespace RGL {
 		std::shared_ptr<struct RenderPassD3D12> currentRenderPass;
 		std::shared_ptr<struct RenderPipelineD3D12> currentRenderPipeline;
 		std::shared_ptr<struct ComputePipelineD3D12> currentComputePipeline;
+		bool shadingRateImageBound = false;		// the command list state outlives the pass, so it is reset in EndRendering
 
 		//TODO: also store if the last use was a write or a read
 		//if a read, then we need to insert a standard barrier even if it's already in the right state
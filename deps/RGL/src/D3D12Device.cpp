@@ -147,6 +147,11 @@ namespace RGL {
             0 // No flags
         );
 
+        D3D12_FEATURE_DATA_D3D12_OPTIONS6 options6{};
+        if (SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS6, &options6, sizeof(options6))) && options6.VariableShadingRateTier >= D3D12_VARIABLE_SHADING_RATE_TIER_2) {
+            shadingRateTileSize = options6.ShadingRateImageTileSize;
+        }
+
         internalCommandList = internalQueue->CreateCommandList();
         g_RTVDescriptorHeapSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
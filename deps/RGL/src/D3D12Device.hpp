@@ -69,6 +69,15 @@ namespace RGL {
 
 		size_t GetTotalVRAM() const final;
 		size_t GetCurrentVRAMInUse() const final;
+
+		bool SupportsIndirectCount() const final {
+			return true;	// ExecuteIndirect always takes a count buffer
+		}
+
+		uint32_t GetShadingRateTileSize() const final {
+			return shadingRateTileSize;
+		}
+		uint32_t shadingRateTileSize = 0;	// 0 below VRS tier 2, which adds shading rate images
 	};
 
 	RGLDevicePtr CreateDefaultDeviceD3D12();
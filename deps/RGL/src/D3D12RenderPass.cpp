@@ -18,5 +18,9 @@ namespace RGL {
 	{
 		stencilTexture = texture;
 	}
+	void RenderPassD3D12::SetShadingRateTexture(const TextureView& texture)
+	{
+		shadingRateTexture = texture;
+	}
 }
 #endif
\ No newline at end of file
@@ -16,9 +16,11 @@ namespace RGL {
 
 		std::optional<TextureView> depthTexture;
 		std::optional <TextureView> stencilTexture;
+		std::optional<TextureView> shadingRateTexture;
 
 		void SetAttachmentTexture(uint32_t index, const TextureView& texture) final;
 		void SetDepthAttachmentTexture(const TextureView& texture) final;
 		void SetStencilAttachmentTexture(const TextureView& texture) final;
+		void SetShadingRateTexture(const TextureView& texture) final;
 	};
 }
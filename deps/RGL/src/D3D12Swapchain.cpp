@@ -7,6 +7,7 @@
 #include "D3D12CommandQueue.hpp"
 #include <directx/d3dx12.h>
 #include "D3D12Texture.hpp"
+#include <algorithm>
 
 #undef min
 #undef max
@@ -68,7 +69,8 @@ namespace RGL {
         swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;   // for going as fast as possible (no vsync), discard frames in-flight to reduce latency
         swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
         // It is recommended to always allow tearing if tearing support is available.
-        swapChainDesc.Flags = CheckTearingSupport() ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
+        // The waitable object lets the app block until the display can take another frame, see WaitForFrameLatency
+        swapChainDesc.Flags = (CheckTearingSupport() ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0) | DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
 
         ComPtr<IDXGISwapChain1> swapChain1;
 
@@ -97,6 +99,8 @@ namespace RGL {
         device->internalQueue->Flush();
         UpdateRenderTargetViews(owningDevice->device, swapchain, owningDevice->RTVHeap.value());
         tearingSupported = CheckTearingSupport();
+        frameLatencyWaitable = swapchain->GetFrameLatencyWaitableObject();
+        SetMaxFrameLatency(2);
     }
 
     void SwapchainD3D12::UpdateRenderTargetViews(ComPtr<ID3D12Device2> device, ComPtr<IDXGISwapChain4> swapChain, D3D12DynamicDescriptorHeap<2048>& descriptorHeap)
@@ -170,16 +174,28 @@ namespace RGL {
 	}
 	void SwapchainD3D12::Present(const SwapchainPresentConfig& config)
 	{
-        UINT syncInterval = vsync ? 1 : 0;
-        UINT presentFlags = (tearingSupported && !vsync) ? DXGI_PRESENT_ALLOW_TEARING : 0;
+        // DXGI has no relaxed FIFO. A flip model swapchain presented with interval 0 and without tearing behaves like mailbox.
+        const bool waitForVblank = presentMode == PresentMode::Fifo || presentMode == PresentMode::FifoRelaxed;
+        UINT syncInterval = waitForVblank ? 1 : 0;
+        UINT presentFlags = (tearingSupported && presentMode == PresentMode::Immediate) ? DXGI_PRESENT_ALLOW_TEARING : 0;
         swapchain->Present(syncInterval, presentFlags);
 	}
-    void SwapchainD3D12::SetVsyncMode(bool mode)
+    void SwapchainD3D12::SetPresentMode(PresentMode mode)
     {
-        vsync = mode;
+        presentMode = mode;
+    }
+    void SwapchainD3D12::SetMaxFrameLatency(uint32_t frames)
+    {
+        DX_CHECK(swapchain->SetMaximumFrameLatency(std::clamp(frames, 1u, uint32_t(DXGI_MAX_SWAP_CHAIN_BUFFERS))));
+    }
+    void SwapchainD3D12::WaitForFrameLatency()
+    {
+        // bounded, so a minimized window whose frames are never shown does not stall the loop
+        WaitForSingleObjectEx(frameLatencyWaitable, 100, TRUE);
     }
     SwapchainD3D12::~SwapchainD3D12()
     {
+        CloseHandle(frameLatencyWaitable);
     }
 }
 
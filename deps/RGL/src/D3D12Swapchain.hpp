@@ -35,9 +35,12 @@ namespace RGL {
 		void GetNextImage(uint32_t* index) final;
 		ITexture* ImageAtIndex(uint32_t index) final;
 		void Present(const SwapchainPresentConfig&) final;
-		void SetVsyncMode(bool mode) final;
+		void SetPresentMode(PresentMode mode) final;
+		void SetMaxFrameLatency(uint32_t frames) final;
+		void WaitForFrameLatency() final;
 		virtual ~SwapchainD3D12();
 	private:
-		bool vsync = true;
+		PresentMode presentMode = PresentMode::Fifo;
+		HANDLE frameLatencyWaitable = nullptr;
 	};
 }
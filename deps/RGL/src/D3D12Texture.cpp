@@ -6,6 +6,8 @@
 #include <D3D12MemAlloc.h>
 #include <ResourceUploadBatch.h>
 #include <DirectXTex.h>
+#include <vector>
+#include <algorithm>
 
 using namespace Microsoft::WRL;
 
@@ -58,16 +60,24 @@ namespace RGL {
 
 		upload.Begin();
 
+		// upload as many mips as the data holds, tightly packed and largest first
 		const auto size = GetSize();
-		size_t outRowPitch = 0, slicePitch=0;
-		DX_CHECK(DirectX::ComputePitch(textureFormat, size.width, size.height, outRowPitch, slicePitch));
-
-		D3D12_SUBRESOURCE_DATA initData = { bytes.data.data(), outRowPitch, slicePitch};
+		std::vector<D3D12_SUBRESOURCE_DATA> initData;
+		size_t offset = 0;
+		for (uint32_t mip = 0; mip < config.mipLevels; mip++) {
+			size_t outRowPitch = 0, slicePitch = 0;
+			DX_CHECK(DirectX::ComputePitch(textureFormat, std::max(size.width >> mip, 1u), std::max(size.height >> mip, 1u), outRowPitch, slicePitch));
+			if (mip > 0 && offset + slicePitch > bytes.data.size()) {
+				break;
+			}
+			initData.push_back({ static_cast<const std::byte*>(bytes.data.data()) + offset, LONG_PTR(outRowPitch), LONG_PTR(slicePitch) });
+			offset += slicePitch;
+		}
 		upload.Transition(texture.Get(),
 			nativeState,
 			D3D12_RESOURCE_STATE_COPY_DEST
 		);
-		upload.Upload(texture.Get(), 0, &initData, 1);
+		upload.Upload(texture.Get(), 0, initData.data(), uint32_t(initData.size()));
 
 		constexpr static auto endState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
 
@@ -15,6 +15,8 @@ struct BufferMTL;
         OBJC_ID(MTLRenderCommandEncoder) currentCommandEncoder = nullptr;
         OBJC_ID(MTLComputeCommandEncoder) currentComputeCommandEncoder = nullptr;
         OBJC_ID(MTLDepthStencilState) noDepthStencil = nullptr;
+        OBJC_ID(MTLEvent) commitEvent = nullptr;     // signalled with commitValue by each commit, for other command buffers that wait on this one
+        uint64_t commitValue = 0;
         int currentPrimitiveType = 0;
         
         std::shared_ptr<BufferMTL> indexBuffer;
@@ -127,6 +127,7 @@ uint32_t bytesPerPixel(MTLPixelFormat format){
 CommandBufferMTL::CommandBufferMTL(decltype(owningQueue) owningQueue) : owningQueue(owningQueue){
     auto dummydepthdesc = [MTLDepthStencilDescriptor new];
     noDepthStencil = [owningQueue->owningDevice->device newDepthStencilStateWithDescriptor:dummydepthdesc];
+    commitEvent = [owningQueue->owningDevice->device newEvent];
 }
 
 void CommandBufferMTL::Reset(){
@@ -145,6 +146,7 @@ void CommandBufferMTL::Begin(){
 desc.errorOptions = MTLCommandBufferErrorOptionEncoderExecutionStatus;
 #endif
     currentCommandBuffer = [owningQueue->commandQueue commandBufferWithDescriptor:desc];
+    ResetCommandCounts();
 }
 
 void CommandBufferMTL::End(){
@@ -182,6 +184,7 @@ void CommandBufferMTL::EndCompute(){
 }
 
 void CommandBufferMTL::DispatchCompute(uint32_t threadsX, uint32_t threadsY, uint32_t threadsZ, uint32_t threadsPerThreadgroupX, uint32_t threadsPerThreadgroupY, uint32_t threadsPerThreadgroupZ){
+    CountDispatches(1);
     [currentComputeCommandEncoder dispatchThreadgroups:MTLSizeMake(threadsX, threadsY, threadsZ) threadsPerThreadgroup:MTLSizeMake(threadsPerThreadgroupX, threadsPerThreadgroupY, threadsPerThreadgroupZ)];
 }
 
@@ -236,10 +239,12 @@ void CommandBufferMTL::SetFragmentBytes(const untyped_span data, uint32_t offset
 }
 
 void CommandBufferMTL::Draw(uint32_t nVertices, const DrawInstancedConfig& config){
+    CountDraws(1);
     [currentCommandEncoder drawPrimitives:MTLPrimitiveType(currentPrimitiveType) vertexStart:config.startVertex * vertexBuffer->stride vertexCount:nVertices instanceCount:config.nInstances baseInstance:config.firstInstance];
 }
 
 void CommandBufferMTL::DrawIndexed(uint32_t nIndices, const DrawIndexedInstancedConfig& config){
+    CountDraws(1);
     assert(indexBuffer != nil); // did you forget to call SetIndexBuffer?
     auto indexType = MTLIndexTypeUInt32;
     if (indexBuffer->stride == 2){
@@ -274,6 +279,17 @@ void CommandBufferMTL::SetScissor(const Rect & scissor){
 }
 
 void CommandBufferMTL::Commit(const CommitConfig & config){
+    if (!config.waitFor.empty()){
+        // the work is already encoded, so the waits go in a command buffer of their own, ahead of this one in the queue.
+        // Metal has no stage granularity here, so every WaitStage waits for all commands.
+        auto waitBuffer = [owningQueue->commandQueue commandBuffer];
+        for (const auto& dependency : config.waitFor){
+            auto dependencyMTL = static_cast<CommandBufferMTL*>(dependency.get());
+            [waitBuffer encodeWaitForEvent:dependencyMTL->commitEvent value:dependencyMTL->commitValue];
+        }
+        [waitBuffer commit];
+    }
+    [currentCommandBuffer encodeSignalEvent:commitEvent value:++commitValue];
     [currentCommandBuffer commit];
 }
 
@@ -338,16 +354,16 @@ void CommandBufferMTL::CopyBufferToTexture(RGLBufferPtr source, uint32_t size, c
     auto castedBuffer = std::static_pointer_cast<BufferMTL>(source);
     auto castedTexture = TextureMTL::ViewToTexture(dest.view);
     
-    auto bytesPerRow = size / dest.destLoc.extent[0];
+    auto bytesPerRow = size / dest.destLoc.extent[1];
     
     [blitencoder copyFromBuffer:castedBuffer->buffer
                    sourceOffset:0
               sourceBytesPerRow:bytesPerRow
             sourceBytesPerImage:size
-                     sourceSize:MTLSizeMake(dest.destLoc.extent[0], dest.destLoc.extent[0], 1)
+                     sourceSize:MTLSizeMake(dest.destLoc.extent[0], dest.destLoc.extent[1], 1)
                       toTexture:castedTexture
                destinationSlice:dest.arrayLayer
-               destinationLevel:0
+               destinationLevel:dest.mip
               destinationOrigin:MTLOriginMake(dest.destLoc.offset[0], dest.destLoc.offset[1], 0)];
     
     [blitencoder endEncoding];
@@ -393,6 +409,7 @@ void CommandBufferMTL::CopyTextureToTexture(const TextureCopyConfig& from, const
 }
 
 void CommandBufferMTL::BeginRenderDebugMarker(const std::string &label){
+    CountBeginMarker(label);
 #ifndef NDEBUG
     auto str = [NSString stringWithUTF8String:label.c_str()];
     [currentCommandBuffer pushDebugGroup:str];
@@ -404,6 +421,7 @@ void CommandBufferMTL::BeginComputeDebugMarker(const std::string &label){
 }
 
 void CommandBufferMTL::EndRenderDebugMarker(){
+    CountEndMarker();
 #ifndef NDEBUG
     [currentCommandBuffer popDebugGroup];
 #endif
@@ -421,6 +439,7 @@ void CommandBufferMTL::ExecuteIndirectIndexed(const RGL::IndirectConfig & config
         indexType = MTLIndexTypeUInt16;
     }
     
+    CountDraws(config.nDraws);
     // because Metal doesn't have multidraw...
     for(uint32_t i = 0; i < config.nDraws; i++){
         [currentCommandEncoder drawIndexedPrimitives:MTLPrimitiveType(currentPrimitiveType) indexType:indexType indexBuffer:indexBuffer->buffer indexBufferOffset:0 indirectBuffer:buffer->buffer indirectBufferOffset:config.offsetIntoBuffer + i * sizeof(IndirectIndexedCommand)];
@@ -430,12 +449,14 @@ void CommandBufferMTL::ExecuteIndirectIndexed(const RGL::IndirectConfig & config
 
 void CommandBufferMTL::DispatchIndirect(const DispatchIndirectConfig& config){
     auto buffer = std::static_pointer_cast<BufferMTL>(config.indirectBuffer);
+    CountDispatches(1);
     [currentComputeCommandEncoder dispatchThreadgroupsWithIndirectBuffer:buffer->buffer indirectBufferOffset:config.offsetIntoBuffer threadsPerThreadgroup:MTLSizeMake(config.blocksizeX, config.blocksizeY, config.blocksizeZ)];
 }
 
 void CommandBufferMTL::ExecuteIndirect(const RGL::IndirectConfig & config) {
     auto buffer = std::static_pointer_cast<BufferMTL>(config.indirectBuffer);
     
+    CountDraws(config.nDraws);
     // because Metal doesn't have multidraw...
     for(uint32_t i = 0; i < config.nDraws; i++){
         [currentCommandEncoder drawPrimitives:MTLPrimitiveType(currentPrimitiveType) indirectBuffer:buffer->buffer indirectBufferOffset:config.offsetIntoBuffer + i * sizeof(IndirectCommand)];
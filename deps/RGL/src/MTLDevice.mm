@@ -134,7 +134,7 @@ size_t DeviceMTL::GetTotalVRAM() const
 
 size_t DeviceMTL::GetCurrentVRAMInUse() const
 {
-    [device currentAllocatedSize];
+    return [device currentAllocatedSize];
 }
 
 RGL::DeviceData DeviceMTL::GetDeviceData() {
@@ -20,6 +20,8 @@ namespace RGL{
         std::array<TextureMTL,3> activeTextures;
         uint32_t idx = 0;
         
-        void SetVsyncMode(bool mode) final;
+        void SetPresentMode(PresentMode mode) final;
+        void SetMaxFrameLatency(uint32_t frames) final;
+        void WaitForFrameLatency() final;
 	};
 }
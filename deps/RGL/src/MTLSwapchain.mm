@@ -2,6 +2,7 @@
 #import <Metal/Metal.h>
 #import <QuartzCore/CAMetalLayer.h>
 #include "MTLSwapchain.hpp"
+#include <algorithm>
 
 namespace RGL{
 
@@ -28,13 +29,23 @@ void SwapchainMTL::Present(const SwapchainPresentConfig& config) {
     [activeTextures[config.imageIndex].drawable present];
 }
 
-void SwapchainMTL::SetVsyncMode(bool mode){
+void SwapchainMTL::SetPresentMode(PresentMode mode){
 #if TARGET_OS_IPHONE
 #else
-    [surface->layer setDisplaySyncEnabled:mode];
+    // Core Animation has no relaxed or mailbox presentation
+    [surface->layer setDisplaySyncEnabled:mode == PresentMode::Fifo || mode == PresentMode::FifoRelaxed];
 #endif
 }
 
+void SwapchainMTL::SetMaxFrameLatency(uint32_t frames){
+    // the layer allows 2 or 3 drawables, one of which is being rendered
+    surface->layer.maximumDrawableCount = std::clamp<NSUInteger>(frames + 1, 2, activeTextures.size());
+}
+
+void SwapchainMTL::WaitForFrameLatency(){
+    // nextDrawable blocks until a drawable is free, which maximumDrawableCount already limits
+}
+
 }
 
 #endif
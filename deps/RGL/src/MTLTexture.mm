@@ -4,6 +4,7 @@
 #include "MTLTexture.hpp"
 #include "MTLDevice.hpp"
 #include "RGLMTL.hpp"
+#include <algorithm>
 
 namespace RGL {
 
@@ -66,17 +67,29 @@ Dimension TextureMTL::GetSize() const{
 TextureMTL::TextureMTL(const std::shared_ptr<DeviceMTL> owningDevice, const TextureConfig& config, const TextureUploadData& data) : TextureMTL(owningDevice, config){
     
     
-    MTLRegion region = {
-        { 0, 0, 0 },                   // MTLOrigin
-        {config.width, config.height, 1} // MTLSize
-    };
-    
-    NSUInteger bytesPerRow = 4 * config.width;   // TODO: replace 4 with nchannels of format
-    
-    [texture replaceRegion:region
-                mipmapLevel:0
-                  withBytes:data.data.data()
-                bytesPerRow:bytesPerRow];
+    // upload as many mips as the data holds, tightly packed and largest first
+    const auto blockDim = FormatBlockDimension(config.format);
+    size_t offset = 0;
+    for (uint32_t mip = 0; mip < config.mipLevels; mip++) {
+        const auto mipSize = MipSizeBytes(config.format, config.width, config.height, mip);
+        if (mip > 0 && offset + mipSize > data.data.size()) {
+            break;
+        }
+        const uint32_t mipWidth = std::max(config.width >> mip, 1u), mipHeight = std::max(config.height >> mip, 1u);
+        MTLRegion region = {
+            { 0, 0, 0 },                   // MTLOrigin
+            {mipWidth, mipHeight, 1} // MTLSize
+        };
+        
+        // for compressed formats, a row is a row of blocks
+        NSUInteger bytesPerRow = ((mipWidth + blockDim - 1) / blockDim) * FormatBytesPerBlock(config.format);
+        
+        [texture replaceRegion:region
+                    mipmapLevel:mip
+                      withBytes:static_cast<const std::byte*>(data.data.data()) + offset
+                    bytesPerRow:bytesPerRow];
+        offset += mipSize;
+    }
 }
 
 TextureView TextureMTL::GetDefaultView() const{
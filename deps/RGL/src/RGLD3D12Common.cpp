@@ -390,9 +390,14 @@ namespace RGL {
 
         case decltype(format)::BC5_SRGB:  return DXGI_FORMAT_BC5_SNORM;
         case decltype(format)::BC5_Unorm:  return DXGI_FORMAT_BC5_UNORM;
+
+        case decltype(format)::BC7_SRGB:  return DXGI_FORMAT_BC7_UNORM_SRGB;
+        case decltype(format)::BC7_Unorm:  return DXGI_FORMAT_BC7_UNORM;
         
 
         case decltype(format)::R8_Uint:  return DXGI_FORMAT_R8_UINT;
+        case decltype(format)::R8_Unorm:  return DXGI_FORMAT_R8_UNORM;
+        case decltype(format)::RG8_Unorm:  return DXGI_FORMAT_R8G8_UNORM;
         case decltype(format)::R16_Float:  return DXGI_FORMAT_R16_FLOAT;
         case decltype(format)::R32_Uint:  return DXGI_FORMAT_R32_UINT;
         case decltype(format)::R32_Float: return DXGI_FORMAT_R32_FLOAT;
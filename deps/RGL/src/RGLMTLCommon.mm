@@ -29,11 +29,27 @@ MTLPixelFormat rgl2mtlformat(TextureFormat format){
         case decltype(format)::RGBA16_Snorm: return MTLPixelFormatRGBA16Snorm;
         case decltype(format)::RGBA16_Sfloat: return MTLPixelFormatRGBA16Float;
         case decltype(format)::R8_Uint: return MTLPixelFormatR8Uint;
+        case decltype(format)::R8_Unorm: return MTLPixelFormatR8Unorm;
+        case decltype(format)::RG8_Unorm: return MTLPixelFormatRG8Unorm;
         case decltype(format)::R16_Float: return MTLPixelFormatR16Float;
         case decltype(format)::R32_Uint: return MTLPixelFormatR32Uint;
         case decltype(format)::R32_Float: return MTLPixelFormatR32Float;
 #if !TARGET_OS_IPHONE
         case decltype(format)::D24UnormS8Uint: return MTLPixelFormatDepth24Unorm_Stencil8;
+        case decltype(format)::BC1_RGB_Unorm:
+        case decltype(format)::BC1_RGBA_Unorm: return MTLPixelFormatBC1_RGBA;
+        case decltype(format)::BC1_RGB_SRGB:
+        case decltype(format)::BC1_RGBA_SRGB: return MTLPixelFormatBC1_RGBA_sRGB;
+        case decltype(format)::BC2_Unorm: return MTLPixelFormatBC2_RGBA;
+        case decltype(format)::BC2_SRGB: return MTLPixelFormatBC2_RGBA_sRGB;
+        case decltype(format)::BC3_Unorm: return MTLPixelFormatBC3_RGBA;
+        case decltype(format)::BC3_SRGB: return MTLPixelFormatBC3_RGBA_sRGB;
+        case decltype(format)::BC4_Unorm: return MTLPixelFormatBC4_RUnorm;
+        case decltype(format)::BC4_SRGB: return MTLPixelFormatBC4_RSnorm;
+        case decltype(format)::BC5_Unorm: return MTLPixelFormatBC5_RGUnorm;
+        case decltype(format)::BC5_SRGB: return MTLPixelFormatBC5_RGSnorm;
+        case decltype(format)::BC7_Unorm: return MTLPixelFormatBC7_RGBAUnorm;
+        case decltype(format)::BC7_SRGB: return MTLPixelFormatBC7_RGBAUnorm_sRGB;
 #endif
         default:
             FatalError("Texture format not supported");
@@ -343,6 +343,8 @@ namespace RGL {
         case decltype(format)::RGBA32_Sfloat:       return VK_FORMAT_R16G16B16A16_SFLOAT;
 
         case decltype(format)::R8_Uint:             return VK_FORMAT_R8_UINT;
+        case decltype(format)::R8_Unorm:            return VK_FORMAT_R8_UNORM;
+        case decltype(format)::RG8_Unorm:           return VK_FORMAT_R8G8_UNORM;
         case decltype(format)::R16_Float:           return VK_FORMAT_R16_SFLOAT;
         case decltype(format)::R32_Uint:            return VK_FORMAT_R32_UINT;
         case decltype(format)::R32_Float:           return VK_FORMAT_R32_SFLOAT;
@@ -350,6 +352,21 @@ namespace RGL {
         case decltype(format)::D24UnormS8Uint:      return VK_FORMAT_D24_UNORM_S8_UINT;
         case decltype(format)::D32SFloat:           return VK_FORMAT_D32_SFLOAT;
 
+        case decltype(format)::BC1_RGB_Unorm:       return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case decltype(format)::BC1_RGB_SRGB:        return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        case decltype(format)::BC1_RGBA_Unorm:      return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case decltype(format)::BC1_RGBA_SRGB:       return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        case decltype(format)::BC2_Unorm:           return VK_FORMAT_BC2_UNORM_BLOCK;
+        case decltype(format)::BC2_SRGB:            return VK_FORMAT_BC2_SRGB_BLOCK;
+        case decltype(format)::BC3_Unorm:           return VK_FORMAT_BC3_UNORM_BLOCK;
+        case decltype(format)::BC3_SRGB:            return VK_FORMAT_BC3_SRGB_BLOCK;
+        case decltype(format)::BC4_Unorm:           return VK_FORMAT_BC4_UNORM_BLOCK;
+        case decltype(format)::BC4_SRGB:            return VK_FORMAT_BC4_SNORM_BLOCK;
+        case decltype(format)::BC5_Unorm:           return VK_FORMAT_BC5_UNORM_BLOCK;
+        case decltype(format)::BC5_SRGB:            return VK_FORMAT_BC5_SNORM_BLOCK;
+        case decltype(format)::BC7_Unorm:           return VK_FORMAT_BC7_UNORM_BLOCK;
+        case decltype(format)::BC7_SRGB:            return VK_FORMAT_BC7_SRGB_BLOCK;
+
         default:
             FatalError("Texture format is not supported");
         }
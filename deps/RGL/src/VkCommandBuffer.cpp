@@ -49,6 +49,7 @@ namespace RGL {
 		vkWaitForFences(owningQueue->owningDevice->device, 1, &internalFence, VK_TRUE, INT_MAX);
 		VK_CHECK(vkResetCommandBuffer(commandBuffer, 0));
 		vkResetFences(owningQueue->owningDevice->device, 1, &internalFence);
+		ResolveTimestamps();
 	}
 	void CommandBufferVk::Begin()
 	{
@@ -58,6 +59,13 @@ namespace RGL {
 		.pInheritanceInfo = nullptr,
 		};
 		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo))
+		ResetCommandCounts();
+
+		// query resets must happen outside of a rendering block
+		recordingTimestamps = timestampsEnabled && timestampQueryPool != VK_NULL_HANDLE;
+		if (recordingTimestamps) {
+			vkCmdResetQueryPool(commandBuffer, timestampQueryPool, 0, maxTimestampRegions * 2);
+		}
 	}
 	void CommandBufferVk::End()
 	{
@@ -121,6 +129,15 @@ namespace RGL {
 				}
 			);
 		}
+
+		if (renderPass->shadingRateTexture && owningQueue->owningDevice->shadingRateTileSize > 0) {
+			RecordTextureBinding(renderPass->shadingRateTexture.value(),
+				{
+					.lastLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR,
+					.written = false
+				}
+			);
+		}
 	}
 
 	void CommandBufferVk::EndRendering()
@@ -143,6 +160,7 @@ namespace RGL {
 	}
 	void CommandBufferVk::DispatchCompute(uint32_t threadsX, uint32_t threadsY, uint32_t threadsZ, uint32_t threadsPerThreadgroupX, uint32_t threadsPerThreadgroupY, uint32_t threadsPerThreadgroupZ)
 	{
+		CountDispatches(1);
 		EncodeCommand(CmdDispatch{ threadsX, threadsY, threadsZ });
 	}
 	void CommandBufferVk::BindBuffer(RGLBufferPtr buffer, uint32_t bindingOffset, uint32_t offsetIntoBuffer)
@@ -257,10 +275,12 @@ namespace RGL {
 
 	void CommandBufferVk::Draw(uint32_t nVertices, const DrawInstancedConfig& config)
 	{
+		CountDraws(1);
 		EncodeCommand(CmdDraw{ nVertices, config });
 	}
 	void CommandBufferVk::DrawIndexed(uint32_t nIndices, const DrawIndexedInstancedConfig& config)
 	{
+		CountDraws(1);
 		EncodeCommand(CmdDrawIndexed{ nIndices, config });
 	}
 
@@ -287,7 +307,8 @@ namespace RGL {
 			.nBytes = size,
 			.destTexture = dest.view,
 			.destLoc = dest.destLoc,
-			.arrayLayer = dest.arrayLayer
+			.arrayLayer = dest.arrayLayer,
+			.mip = dest.mip
 		});
 	}
 	void CommandBufferVk::CopyBufferToBuffer(BufferCopyConfig from, BufferCopyConfig to, uint32_t size)
@@ -341,18 +362,27 @@ namespace RGL {
 	void CommandBufferVk::ExecuteIndirect(const IndirectConfig& config)
 	{
 		RecordBufferBinding(std::static_pointer_cast<BufferVk>(config.indirectBuffer).get(), { .written = false });
+		if (config.countBuffer) {
+			RecordBufferBinding(std::static_pointer_cast<BufferVk>(config.countBuffer).get(), { .written = false });
+		}
+		CountDraws(config.nDraws);
 		EncodeCommand(CmdExecuteIndirect{ config });
 	}
 	void CommandBufferVk::DispatchIndirect(const DispatchIndirectConfig& config)
 	{
 		RecordBufferBinding(std::static_pointer_cast<BufferVk>(config.indirectBuffer).get(), { .written = false });
+		CountDispatches(1);
 		EncodeCommand(CmdDispatchIndirect{config});
 	}
 	void CommandBufferVk::BeginRenderDebugMarker(const std::string& label)
 	{
-#ifndef NDEBUG
-		EncodeCommand(CmdBeginDebugMarker{ label });
+		CountBeginMarker(label);
+#ifdef NDEBUG
+		if (!recordingTimestamps) {
+			return;
+		}
 #endif
+		EncodeCommand(CmdBeginDebugMarker{ label });
 	}
 	void CommandBufferVk::BeginComputeDebugMarker(const std::string& label)
 	{
@@ -360,14 +390,71 @@ namespace RGL {
 	}
 	void CommandBufferVk::EndRenderDebugMarker()
 	{
-#ifndef NDEBUG
-		EncodeCommand(CmdEndDebugMarker{});
+		CountEndMarker();
+#ifdef NDEBUG
+		if (!recordingTimestamps) {
+			return;
+		}
 #endif
+		EncodeCommand(CmdEndDebugMarker{});
 	}
 	void CommandBufferVk::EndComputeDebugMarker()
 	{
 		EndRenderDebugMarker();
 	}
+	void CommandBufferVk::SetTimestampsEnabled(bool enabled)
+	{
+		timestampsEnabled = enabled;
+		if (!enabled || timestampQueryPool != VK_NULL_HANDLE) {
+			return;
+		}
+		auto owningDevice = owningQueue->owningDevice;
+
+		// the graphics queue must report valid timestamp bits, otherwise timestamps cannot be written
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(owningDevice->physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(owningDevice->physicalDevice, &queueFamilyCount, queueFamilies.data());
+		if (queueFamilies.at(owningDevice->indices.graphicsFamily.value()).timestampValidBits == 0) {
+			timestampsEnabled = false;
+			return;
+		}
+
+		VkPhysicalDeviceProperties props;
+		vkGetPhysicalDeviceProperties(owningDevice->physicalDevice, &props);
+		timestampPeriod = props.limits.timestampPeriod;
+
+		VkQueryPoolCreateInfo poolInfo{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = maxTimestampRegions * 2,
+		};
+		VK_CHECK(vkCreateQueryPool(owningDevice->device, &poolInfo, nullptr, &timestampQueryPool));
+	}
+	std::span<const TimestampRegion> CommandBufferVk::GetResolvedTimestamps() const
+	{
+		return resolvedTimestamps;
+	}
+	void CommandBufferVk::ResolveTimestamps()
+	{
+		// the fence has been waited on, so every query of the last submission is available
+		resolvedTimestamps.clear();
+		openTimestampRegions.clear();
+		if (pendingTimestamps.empty()) {
+			return;
+		}
+		std::vector<uint64_t> ticks(pendingTimestamps.size() * 2);
+		auto result = vkGetQueryPoolResults(owningQueue->owningDevice->device, timestampQueryPool, 0, ticks.size(), ticks.size() * sizeof(uint64_t), ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result == VK_SUCCESS) {
+			for (uint32_t i = 0; i < pendingTimestamps.size(); i++) {
+				auto& region = pendingTimestamps[i];
+				region.beginNs = ticks[i * 2] * double(timestampPeriod);
+				region.endNs = ticks[i * 2 + 1] * double(timestampPeriod);
+			}
+			std::swap(resolvedTimestamps, pendingTimestamps);
+		}
+		pendingTimestamps.clear();
+	}
 	void CommandBufferVk::BlockUntilCompleted()
 	{
 		vkWaitForFences(owningQueue->owningDevice->device, 1, &internalFence, VK_TRUE, UINT64_MAX);
@@ -375,6 +462,10 @@ namespace RGL {
 	void CommandBufferVk::ExecuteIndirectIndexed(const IndirectConfig& config)
 	{
 		RecordBufferBinding(std::static_pointer_cast<BufferVk>(config.indirectBuffer).get(), { .written = false });
+		if (config.countBuffer) {
+			RecordBufferBinding(std::static_pointer_cast<BufferVk>(config.countBuffer).get(), { .written = false });
+		}
+		CountDraws(config.nDraws);
 		EncodeCommand(CmdExecuteIndirectIndexed{ config });
 	}
 	CommandBufferVk::CommandBufferVk(decltype(owningQueue) owningQueue) : owningQueue(owningQueue)
@@ -392,11 +483,25 @@ namespace RGL {
 		  .flags = VkFenceCreateFlags(0)
 		};
 		VK_CHECK(vkCreateFence(owningQueue->owningDevice->device, &fenceInfo, nullptr, &internalFence));
+		VkSemaphoreTypeCreateInfo timelineInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = 0
+		};
+		VkSemaphoreCreateInfo semaphoreInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &timelineInfo
+		};
+		VK_CHECK(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timelineSemaphore));
 	}
 	CommandBufferVk::~CommandBufferVk()
 	{
 		vkWaitForFences(owningQueue->owningDevice->device, 1, &internalFence, VK_TRUE, UINT64_MAX);
 		vkDestroyFence(owningQueue->owningDevice->device, internalFence, nullptr);
+		vkDestroySemaphore(owningQueue->owningDevice->device, timelineSemaphore, nullptr);
+		if (timestampQueryPool != VK_NULL_HANDLE) {
+			vkDestroyQueryPool(owningQueue->owningDevice->device, timestampQueryPool, nullptr);
+		}
 	}
 
 	void CommandBufferVk::RecordBufferBinding(const BufferVk* buffer, BufferLastUse usage)
@@ -602,8 +707,17 @@ namespace RGL {
 				}
 
 
+				const auto shadingRateTileSize = owningQueue->owningDevice->shadingRateTileSize;
+				VkRenderingFragmentShadingRateAttachmentInfoKHR shadingRateInfo{
+					.sType = VK_STRUCTURE_TYPE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_INFO_KHR,
+					.imageView = renderPass->shadingRateTexture ? renderPass->shadingRateTexture->texture.vk.view : VK_NULL_HANDLE,
+					.imageLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR,
+					.shadingRateAttachmentTexelSize = { shadingRateTileSize, shadingRateTileSize },
+				};
+
 				const VkRenderingInfoKHR render_info{
 					.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+					.pNext = (shadingRateInfo.imageView != VK_NULL_HANDLE && shadingRateTileSize > 0) ? &shadingRateInfo : nullptr,
 					.renderArea = {
 						.offset = {0,0},
 						.extent = VkExtent2D{.width = texSize.width, .height = texSize.height},
@@ -785,6 +899,18 @@ namespace RGL {
 			[this](const CmdExecuteIndirectIndexed& arg) {
 				auto& config = arg.config;
 				const auto buffer = std::static_pointer_cast<BufferVk>(config.indirectBuffer);
+				if (config.countBuffer) {
+					const auto countBuffer = std::static_pointer_cast<BufferVk>(config.countBuffer);
+					vkCmdDrawIndexedIndirectCount(commandBuffer,
+						buffer->buffer,
+						config.offsetIntoBuffer,
+						countBuffer->buffer,
+						config.countBufferOffset,
+						config.nDraws,
+						sizeof(IndirectIndexedCommand)
+					);
+					return;
+				}
 				vkCmdDrawIndexedIndirect(commandBuffer,
 					buffer->buffer,
 					config.offsetIntoBuffer,
@@ -795,6 +921,18 @@ namespace RGL {
 			[this](const CmdExecuteIndirect& arg) {
 				auto& config = arg.config;
 				const auto buffer = std::static_pointer_cast<BufferVk>(config.indirectBuffer);
+				if (config.countBuffer) {
+					const auto countBuffer = std::static_pointer_cast<BufferVk>(config.countBuffer);
+					vkCmdDrawIndirectCount(commandBuffer,
+						buffer->buffer,
+						config.offsetIntoBuffer,
+						countBuffer->buffer,
+						config.countBufferOffset,
+						config.nDraws,
+						sizeof(IndirectCommand)
+					);
+					return;
+				}
 				vkCmdDrawIndirect(commandBuffer,
 					buffer->buffer,
 					config.offsetIntoBuffer,
@@ -843,6 +981,7 @@ namespace RGL {
 				currentRenderPipeline = pipeline;
 			},
 			[this](const CmdBeginDebugMarker& arg) {
+#ifndef NDEBUG
 				if (owningQueue->owningDevice->rgl_vkCmdBeginDebugUtilsLabelEXT) {
 					VkDebugUtilsLabelEXT markerInfo = {
 					.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
@@ -850,11 +989,31 @@ namespace RGL {
 					};
 					owningQueue->owningDevice->rgl_vkCmdBeginDebugUtilsLabelEXT(commandBuffer, &markerInfo);
 				}
+#endif
+				if (recordingTimestamps) {
+					// past capacity, the marker still needs a stack entry so its End pairs correctly
+					uint32_t regionIdx = noTimestampRegion;
+					if (pendingTimestamps.size() < maxTimestampRegions) {
+						regionIdx = pendingTimestamps.size();
+						pendingTimestamps.push_back({ .label = arg.label, .depth = uint32_t(openTimestampRegions.size()) });
+						vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, regionIdx * 2);
+					}
+					openTimestampRegions.push_back(regionIdx);
+				}
 			},
 			[this](const CmdEndDebugMarker&) {
+#ifndef NDEBUG
 				if (owningQueue->owningDevice->rgl_vkCmdEndDebugUtilsLabelEXT) {
 					owningQueue->owningDevice->rgl_vkCmdEndDebugUtilsLabelEXT(commandBuffer);
 				}
+#endif
+				if (recordingTimestamps && !openTimestampRegions.empty()) {
+					auto regionIdx = openTimestampRegions.back();
+					openTimestampRegions.pop_back();
+					if (regionIdx != noTimestampRegion) {
+						vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampQueryPool, regionIdx * 2 + 1);
+					}
+				}
 			},
 			[this](const CmdBeginCompute& arg) {
 				ApplyBarriers();
@@ -971,14 +1130,14 @@ namespace RGL {
 				region.bufferImageHeight = 0;
 
 				region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				region.imageSubresource.mipLevel = 0;
+				region.imageSubresource.mipLevel = arg.mip;
 				region.imageSubresource.baseArrayLayer = arg.arrayLayer;
 				region.imageSubresource.layerCount = 1;
 
-				region.imageOffset = { 0, 0, 0 };
+				region.imageOffset = { arg.destLoc.offset[0], arg.destLoc.offset[1], 0 };
 				region.imageExtent = {
 					arg.destLoc.extent[0],
-					arg.destLoc.extent[0],
+					arg.destLoc.extent[1],
 					1
 				};
 
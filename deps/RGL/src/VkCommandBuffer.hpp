@@ -5,6 +5,7 @@
 #include "RGLVk.hpp"
 #include <unordered_set>
 #include <unordered_map>
+#include <limits>
 #include <RGL/SubresourceRange.hpp>
 
 namespace RGL {
@@ -47,6 +48,10 @@ namespace RGL {
 		std::unordered_set<struct SwapchainVK*> swapchainsToSignal;
 		std::unordered_set<const struct TextureVk*> swapchainImages;
 
+		// signalled with timelineValue by each commit, for other command buffers that wait on this one
+		VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+		uint64_t timelineValue = 0;
+
 		struct TextureLastUse {
 			VkImageLayout lastLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 			bool written = false;
@@ -164,6 +169,7 @@ namespace RGL {
 			TextureView destTexture;
 			Rect destLoc;
 			uint32_t arrayLayer;
+			uint32_t mip;
 		};
 
 		struct CmdCopyBufferToBuffer {
@@ -290,6 +296,9 @@ namespace RGL {
 		void EndRenderDebugMarker() final;
 		void EndComputeDebugMarker() final;
 
+		void SetTimestampsEnabled(bool enabled) final;
+		std::span<const TimestampRegion> GetResolvedTimestamps() const final;
+
 		void BlockUntilCompleted() final;
 
 	private:
@@ -301,6 +310,16 @@ namespace RGL {
 		std::vector<VkBufferMemoryBarrier2> barriersToAdd;
 		void ApplyBarriers();
 		VkFence internalFence;
+
+		// timestamp queries written around debug markers. Region i uses queries 2i and 2i+1.
+		constexpr static uint32_t maxTimestampRegions = 256;
+		constexpr static uint32_t noTimestampRegion = std::numeric_limits<uint32_t>::max();
+		VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+		float timestampPeriod = 1;		// nanoseconds per tick
+		bool timestampsEnabled = false, recordingTimestamps = false;
+		std::vector<TimestampRegion> pendingTimestamps, resolvedTimestamps;
+		std::vector<uint32_t> openTimestampRegions;
+		void ResolveTimestamps();
 	};
 }
 
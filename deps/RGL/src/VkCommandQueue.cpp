@@ -6,36 +6,60 @@
 #include "VkSwapchain.hpp"
 
 namespace RGL {
-    CommandQueueVk::CommandQueueVk(decltype(owningDevice) device) : owningDevice(device)
+    CommandQueueVk::CommandQueueVk(decltype(owningDevice) device, uint32_t queueIndex) : owningDevice(device)
     {
-        vkGetDeviceQueue(device->device, device->indices.graphicsFamily.value(), 0, &queue);    // 0 because we only have 1 queue
+        vkGetDeviceQueue(device->device, device->indices.graphicsFamily.value(), queueIndex, &queue);
         VK_VALID(queue);
     }
     void CommandQueueVk::Submit(CommandBufferVk* cb, const CommitConfig& config, VkFence internalFence)
 	{
         const uint32_t nSwapchains = cb->swapchainsToSignal.size();
-        stackarray(waitSemaphores, VkSemaphore, nSwapchains);
-        stackarray(signalSemaphores, VkSemaphore, nSwapchains);
+        const uint32_t nWaits = nSwapchains + config.waitFor.size();
+        const uint32_t nSignals = nSwapchains + 1;
+        stackarray(waitSemaphores, VkSemaphore, nWaits);
+        stackarray(waitValues, uint64_t, nWaits);     // ignored for the swapchains' binary semaphores
+        stackarray(waitStages, VkPipelineStageFlags, nWaits);
+        stackarray(signalSemaphores, VkSemaphore, nSignals);
+        stackarray(signalValues, uint64_t, nSignals);
         {
             uint32_t i = 0;
             for (const auto swapchain : cb->swapchainsToSignal) {
                 waitSemaphores[i] = swapchain->imageAvailableSemaphore;
+                waitValues[i] = 0;
+                waitStages[i] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
                 signalSemaphores[i] = swapchain->renderCompleteSemaphore;
+                signalValues[i] = 0;
+                i++;
+            }
+            const VkPipelineStageFlags dependencyStage = config.waitStage == WaitStage::Draws ? VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            for (const auto& dependency : config.waitFor) {
+                auto dependencyVk = static_cast<CommandBufferVk*>(dependency.get());
+                waitSemaphores[i] = dependencyVk->timelineSemaphore;
+                waitValues[i] = dependencyVk->timelineValue;
+                waitStages[i] = dependencyStage;
                 i++;
             }
         }
-       
+        // every submission advances this command buffer's timeline, for later submissions that wait on it
+        signalSemaphores[nSwapchains] = cb->timelineSemaphore;
+        signalValues[nSwapchains] = ++cb->timelineValue;
 
-
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+        VkTimelineSemaphoreSubmitInfo timelineInfo{
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .waitSemaphoreValueCount = nWaits,
+            .pWaitSemaphoreValues = waitValues,
+            .signalSemaphoreValueCount = nSignals,
+            .pSignalSemaphoreValues = signalValues
+        };
         VkSubmitInfo submitInfo{
            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-           .waitSemaphoreCount = nSwapchains,
+           .pNext = &timelineInfo,
+           .waitSemaphoreCount = nWaits,
            .pWaitSemaphores = waitSemaphores,
            .pWaitDstStageMask = waitStages,
            .commandBufferCount = 1,
            .pCommandBuffers = &(cb->commandBuffer),
-           .signalSemaphoreCount = nSwapchains,
+           .signalSemaphoreCount = nSignals,
            .pSignalSemaphores = signalSemaphores
         };
         std::shared_ptr<FenceVk> fence;
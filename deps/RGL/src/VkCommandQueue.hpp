@@ -14,7 +14,7 @@ namespace RGL {
 	struct CommandQueueVk : public ICommandQueue, public std::enable_shared_from_this<CommandQueueVk> {
 		const std::shared_ptr<DeviceVk> owningDevice;
 		VkQueue queue;
-		CommandQueueVk(decltype(owningDevice) device);
+		CommandQueueVk(decltype(owningDevice) device, uint32_t queueIndex);
 
 		// call by commandbuffer::commit
 		void Submit(CommandBufferVk*, const CommitConfig&, VkFence internalFence);
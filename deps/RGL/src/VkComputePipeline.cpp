@@ -24,7 +24,7 @@ namespace RGL {
 
         bufferBindings = library->bindingInfo;
 
-        VK_CHECK(vkCreateComputePipelines(owningDevice->device, VK_NULL_HANDLE, 1,&pipelineInfo,nullptr,&computePipeline));
+        VK_CHECK(vkCreateComputePipelines(owningDevice->device, owningDevice->pipelineCache, 1,&pipelineInfo,nullptr,&computePipeline));
 	}
 	ComputePipelineVk::~ComputePipelineVk()
 	{
@@ -17,6 +17,8 @@
 #include <unordered_set>
 #include <vk_mem_alloc.h>
 #include <algorithm>
+#include <cstring>
+#include <array>
 
 namespace RGL {
 
@@ -161,7 +163,17 @@ namespace RGL {
     RGL::DeviceVk::DeviceVk(decltype(physicalDevice) physicalDevice) : physicalDevice(physicalDevice) {
         // next create the logical device and the queue
         indices = findQueueFamilies(physicalDevice);
-        float queuePriority = 1.0f;     // required even if we only have one queue. Used to cooperatively schedule multiple queues
+        float queuePriorities[] = { 1.0f, 1.0f };     // required even if we only have one queue. Used to cooperatively schedule multiple queues
+
+        // ComputeOnly queues get a second queue of the graphics family where there is one, so their work can overlap the main queue's.
+        // Staying in the family means resources need no ownership transfers between the two.
+        {
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+            numGraphicsQueues = std::min<uint32_t>(queueFamilies[indices.graphicsFamily.value()].queueCount, std::size(queuePriorities));
+        }
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
@@ -170,14 +182,30 @@ namespace RGL {
             VkDeviceQueueCreateInfo queueCreateInfo{
             .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
             .queueFamilyIndex = queueFamily,
-            .queueCount = 1,
-            .pQueuePriorities = &queuePriority
+            .queueCount = queueFamily == indices.graphicsFamily.value() ? numGraphicsQueues : 1,
+            .pQueuePriorities = queuePriorities
             };
             queueCreateInfos.push_back(queueCreateInfo);
         }
+        // variable rate shading is optional, so its extension and features are only chained where it exists
+        const bool hasShadingRateExtension = getMissingDeviceExtensions(physicalDevice, std::array{ VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME }).empty();
+        // as is waiting for presentation, for frame latency control
+        const bool hasPresentWaitExtensions = getMissingDeviceExtensions(physicalDevice, std::array{ VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME }).empty();
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+            .pNext = nullptr
+        };
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+            .pNext = &presentWaitFeatures
+        };
+        VkPhysicalDeviceFragmentShadingRateFeaturesKHR shadingRateFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR,
+            .pNext = hasPresentWaitExtensions ? &presentIdFeatures : nullptr      // queried with these whether or not they are enabled
+        };
         VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT lib_features{
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
-            .pNext = nullptr
+            .pNext = hasShadingRateExtension ? static_cast<void*>(&shadingRateFeatures) : hasPresentWaitExtensions ? static_cast<void*>(&presentIdFeatures) : nullptr
         };
 
         VkPhysicalDeviceFragmentShaderInterlockFeaturesEXT fse_features{
@@ -232,14 +260,56 @@ namespace RGL {
         if (lib_features.graphicsPipelineLibrary == VK_FALSE) {
             FatalError("Cannot init - Graphics Pipeline Library is not supported");
         }
+        if (vulkan1_2Features.timelineSemaphore == VK_FALSE) {
+            FatalError("Cannot init - Timeline Semaphores are not supported");
+        }
+        supportsIndirectCount = vulkan1_2Features.drawIndirectCount == VK_TRUE;
+
+        std::vector<const char*> enabledExtensions(std::begin(deviceExtensions), std::end(deviceExtensions));
+        if (hasShadingRateExtension && shadingRateFeatures.attachmentFragmentShadingRate == VK_TRUE) {
+            VkPhysicalDeviceFragmentShadingRatePropertiesKHR shadingRateProperties{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR,
+            };
+            VkPhysicalDeviceProperties2 properties2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &shadingRateProperties
+            };
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+            // RGL's shading rate texels are square, so use the smallest square the device allows
+            const auto& minTexel = shadingRateProperties.minFragmentShadingRateAttachmentTexelSize;
+            const auto& maxTexel = shadingRateProperties.maxFragmentShadingRateAttachmentTexelSize;
+            const auto tileSize = std::max(minTexel.width, minTexel.height);
+            if (tileSize <= std::min(maxTexel.width, maxTexel.height)) {
+                shadingRateTileSize = tileSize;
+                enabledExtensions.push_back(VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME);
+            }
+        }
+        supportsPresentWait = hasPresentWaitExtensions && presentIdFeatures.presentId == VK_TRUE && presentWaitFeatures.presentWait == VK_TRUE;
+        if (supportsPresentWait) {
+            enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+
+        // relink the optional features so only those of enabled extensions are chained
+        void** featureChainEnd = &lib_features.pNext;
+        *featureChainEnd = nullptr;
+        if (shadingRateTileSize != 0) {
+            *featureChainEnd = &shadingRateFeatures;
+            featureChainEnd = &shadingRateFeatures.pNext;
+            *featureChainEnd = nullptr;
+        }
+        if (supportsPresentWait) {
+            *featureChainEnd = &presentIdFeatures;
+        }
 
         VkDeviceCreateInfo deviceCreateInfo{
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
             .pNext = &deviceFeatures2,
             .queueCreateInfoCount = static_cast<decltype(VkDeviceCreateInfo::queueCreateInfoCount)>(queueCreateInfos.size()),
             .pQueueCreateInfos = queueCreateInfos.data(),      // could pass an array here if we were making more than one queue
-            .enabledExtensionCount = static_cast<uint32_t>(std::size(deviceExtensions)),             // device-specific extensions are ignored on later vulkan versions but we set it anyways
-            .ppEnabledExtensionNames = deviceExtensions,
+            .enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size()),             // device-specific extensions are ignored on later vulkan versions but we set it anyways
+            .ppEnabledExtensionNames = enabledExtensions.data(),
             .pEnabledFeatures = nullptr,        // because we are using deviceFeatures2
         };
         if (IsValidationEnabled()) {
@@ -395,6 +465,50 @@ namespace RGL {
 
         // buffers
         createDescriptorSetForBindless(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, globalBufferDescriptorSetLayout, globalBufferDescriptorPool, globalBufferDescriptorSet);
+
+        VkPipelineCacheCreateInfo cacheInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        };
+        VK_CHECK(vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache));
+    }
+
+    void DeviceVk::LoadPipelineCache(std::span<const std::byte> data)
+    {
+        // drivers should reject foreign data themselves, but not all do, so check that it came from this device and driver
+        VkPipelineCacheHeaderVersionOne header;
+        if (data.size() < sizeof(header)) {
+            return;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(physicalDevice, &props);
+        if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.vendorID != props.vendorID || header.deviceID != props.deviceID || std::memcmp(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            return;
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = data.size(),
+            .pInitialData = data.data(),
+        };
+        VkPipelineCache loadedCache = VK_NULL_HANDLE;
+        if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &loadedCache) != VK_SUCCESS) {
+            return;
+        }
+        // keep anything compiled before the load
+        VK_CHECK(vkMergePipelineCaches(device, loadedCache, 1, &pipelineCache));
+        vkDestroyPipelineCache(device, pipelineCache, nullptr);
+        pipelineCache = loadedCache;
+    }
+
+    std::vector<std::byte> DeviceVk::GetPipelineCacheData() const
+    {
+        size_t size = 0;
+        VK_CHECK(vkGetPipelineCacheData(device, pipelineCache, &size, nullptr));
+        std::vector<std::byte> data(size);
+        VK_CHECK(vkGetPipelineCacheData(device, pipelineCache, &size, data.data()));
+        data.resize(size);
+        return data;
     }
 
     void DeviceVk::SetDebugNameForResource(void* resource, VkObjectType type, const char* debugName)
@@ -415,6 +529,7 @@ namespace RGL {
     }
 
     RGL::DeviceVk::~DeviceVk() {
+        vkDestroyPipelineCache(device, pipelineCache, nullptr);
 
         vkDestroyDescriptorPool(device, globalTextureDescriptorPool, VK_NULL_HANDLE);
         vkDestroyDescriptorPool(device, globalBufferDescriptorPool, VK_NULL_HANDLE);
@@ -522,7 +637,9 @@ namespace RGL {
 
     RGLCommandQueuePtr DeviceVk::CreateCommandQueue(QueueType type)
     {
-        return std::make_shared<CommandQueueVk>(shared_from_this());    // vulkan does not use the queue type
+        // copies share the main queue. Their work is small enough that overlapping it is not worth a queue.
+        const uint32_t queueIndex = type == QueueType::ComputeOnly ? numGraphicsQueues - 1 : 0;
+        return std::make_shared<CommandQueueVk>(shared_from_this(), queueIndex);
     }
     RGLFencePtr DeviceVk::CreateFence(bool preSignaled)
     {
@@ -541,9 +658,12 @@ namespace RGL {
 
         vmaGetHeapBudgets(vkallocator, budgets);
 
+        // only the heaps on the device, so system memory the GPU can reach does not count as VRAM
         size_t budget = 0;
         for (int i = 0; i < memprop.memoryHeapCount; i++) {
-            budget += budgets[i].budget;
+            if (memprop.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                budget += budgets[i].budget;
+            }
         }
 
         return budget;
@@ -558,7 +678,9 @@ namespace RGL {
 
         size_t budget = 0;
         for (int i = 0; i < memprop.memoryHeapCount; i++) {
-            budget += budgets[i].usage;
+            if (memprop.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                budget += budgets[i].usage;
+            }
         }
 
         return budget;
@@ -24,6 +24,7 @@ namespace RGL {
 		VkDevice device = VK_NULL_HANDLE;
 		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;	// does not need to be destroyed
 		QueueFamilyIndices indices;
+		uint32_t numGraphicsQueues = 1;		// 2 if ComputeOnly queues have a queue of their own
 		VkQueue presentQueue = VK_NULL_HANDLE;	// do not need to be destroyed
 		VkCommandPool commandPool = VK_NULL_HANDLE;
         VmaAllocator_T* vkallocator;
@@ -67,6 +68,22 @@ namespace RGL {
 		size_t GetTotalVRAM() const final;
 		size_t GetCurrentVRAMInUse() const final;
 
+		void LoadPipelineCache(std::span<const std::byte> data) final;
+		std::vector<std::byte> GetPipelineCacheData() const final;
+
+		bool SupportsIndirectCount() const final {
+			return supportsIndirectCount;
+		}
+		bool supportsIndirectCount = false;		// drawIndirectCount is optional in Vulkan 1.2
+
+		uint32_t GetShadingRateTileSize() const final {
+			return shadingRateTileSize;
+		}
+		uint32_t shadingRateTileSize = 0;		// 0 without VK_KHR_fragment_shading_rate attachments
+		bool supportsPresentWait = false;		// VK_KHR_present_id and VK_KHR_present_wait, for SwapchainVK::WaitForFrameLatency
+
+		VkPipelineCache pipelineCache = VK_NULL_HANDLE;		// used by every pipeline created on this device
+
 		uint32_t frameIndex = 0;
 
 		VkDescriptorSetLayout globalTextureDescriptorSetLayout = VK_NULL_HANDLE, globalBufferDescriptorSetLayout;
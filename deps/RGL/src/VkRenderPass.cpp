@@ -30,6 +30,11 @@ namespace RGL{
         stencilTexture = texture;
     }
 
+    void RenderPassVk::SetShadingRateTexture(const TextureView& texture)
+    {
+        shadingRateTexture = texture;
+    }
+
 }
 
 #endif
\ No newline at end of file
@@ -235,10 +235,23 @@ namespace RGL {
             .maxDepthBounds = 1.0f,      // Optional
         };
 
+        // the shading rate texture replaces the pipeline's rate of 1x1
+        const bool variableShadingRate = desc.variableShadingRate && owningDevice->shadingRateTileSize > 0;
+        VkPipelineFragmentShadingRateStateCreateInfoKHR shadingRateState{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_FRAGMENT_SHADING_RATE_STATE_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .fragmentSize = { 1, 1 },
+            .combinerOps = { VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR, VK_FRAGMENT_SHADING_RATE_COMBINER_OP_REPLACE_KHR },
+        };
+        if (variableShadingRate) {
+            renderingCreateInfo.pNext = &shadingRateState;
+        }
+
         // create the pipeline object
         VkGraphicsPipelineCreateInfo pipelineInfo{
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
             .pNext = &renderingCreateInfo,
+            .flags = variableShadingRate ? VkPipelineCreateFlags(VK_PIPELINE_CREATE_RENDERING_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR) : 0,
             .stageCount = static_cast<uint32_t>(shaderStages.size()),
             .pStages = shaderStages.data(),
             .pVertexInputState = &vertexInputInfo,
@@ -256,7 +269,7 @@ namespace RGL {
             .basePipelineIndex = -1, // optional
             
         };
-        VK_CHECK(vkCreateGraphicsPipelines(owningDevice->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline));
+        VK_CHECK(vkCreateGraphicsPipelines(owningDevice->device, owningDevice->pipelineCache, 1, &pipelineInfo, nullptr, &graphicsPipeline));
 
         if (desc.debugName != "") {
             owningDevice->SetDebugNameForResource((void*)graphicsPipeline, VK_OBJECT_TYPE_PIPELINE, desc.debugName.c_str());
@@ -41,20 +41,25 @@ void RGL::SwapchainVK::Resize(uint32_t width, uint32_t height)
         return availableFormats[0];
     };
     auto chooseSwapPresentMode = [this](const std::vector<VkPresentModeKHR>& availablePresentModes) -> VkPresentModeKHR {
-        if (vsync) {
-            // disabling this because apparently VK_PRESENT_MODE_MAILBOX_KHR is uncapped on some OS/driver combos
-#if 0
-            for (const auto& availablePresentMode : availablePresentModes) {
-                if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-                    return availablePresentMode;    // use Mailbox on high-perf devices
-                }
+        const auto available = [&](VkPresentModeKHR mode) {
+            return std::find(availablePresentModes.begin(), availablePresentModes.end(), mode) != availablePresentModes.end();
+        };
+        // FIFO is the only mode every device has
+        switch (presentMode) {
+        case PresentMode::FifoRelaxed:
+            return available(VK_PRESENT_MODE_FIFO_RELAXED_KHR) ? VK_PRESENT_MODE_FIFO_RELAXED_KHR : VK_PRESENT_MODE_FIFO_KHR;
+        case PresentMode::Mailbox:
+            if (available(VK_PRESENT_MODE_MAILBOX_KHR)) {
+                return VK_PRESENT_MODE_MAILBOX_KHR;
             }
-#endif
-
-            return VK_PRESENT_MODE_FIFO_KHR;        // otherwise use FIFO when on low-power devices, like a mobile phone
-        }
-        else {
-            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+            return available(VK_PRESENT_MODE_IMMEDIATE_KHR) ? VK_PRESENT_MODE_IMMEDIATE_KHR : VK_PRESENT_MODE_FIFO_KHR;
+        case PresentMode::Immediate:
+            if (available(VK_PRESENT_MODE_IMMEDIATE_KHR)) {
+                return VK_PRESENT_MODE_IMMEDIATE_KHR;
+            }
+            return available(VK_PRESENT_MODE_MAILBOX_KHR) ? VK_PRESENT_MODE_MAILBOX_KHR : VK_PRESENT_MODE_FIFO_KHR;
+        default:
+            return VK_PRESENT_MODE_FIFO_KHR;
         }
     };
     auto chooseSwapExtent = [width,height](const VkSurfaceCapabilitiesKHR& capabilities) ->VkExtent2D {
@@ -113,6 +118,7 @@ void RGL::SwapchainVK::Resize(uint32_t width, uint32_t height)
     }
 
     VK_CHECK(vkCreateSwapchainKHR(owningDevice->device, &swapchainCreateInfo, nullptr, &swapChain));
+    presentCount = 0;
 
     // remember these values
     swapChainImageFormat = surfaceFormat.format;
@@ -170,8 +176,15 @@ void RGL::SwapchainVK::GetNextImage(uint32_t* index)
 void RGL::SwapchainVK::Present(const SwapchainPresentConfig& config)
 {
     VkSwapchainKHR swapChains[] = { swapChain };
+    const uint64_t presentId = ++presentCount;
+    VkPresentIdKHR presentIdInfo{
+        .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+        .swapchainCount = 1,
+        .pPresentIds = &presentId
+    };
     VkPresentInfoKHR presentInfo{
         .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .pNext = owningDevice->supportsPresentWait ? &presentIdInfo : nullptr,
         .waitSemaphoreCount = 1,
         .pWaitSemaphores = &renderCompleteSemaphore,
         .swapchainCount = 1,
@@ -189,14 +202,29 @@ void RGL::SwapchainVK::Present(const SwapchainPresentConfig& config)
     }
 }
 
-void RGL::SwapchainVK::SetVsyncMode(bool mode)
+void RGL::SwapchainVK::SetPresentMode(PresentMode mode)
 {
-    vsync = mode;
+    presentMode = mode;
     auto size = RGLTextureResources[0].GetSize();
     // re-create with the new queue present mode
     Resize(size.width, size.height);
 }
 
+void RGL::SwapchainVK::SetMaxFrameLatency(uint32_t frames)
+{
+    maxFrameLatency = std::max(frames, 1u);
+}
+
+void RGL::SwapchainVK::WaitForFrameLatency()
+{
+    if (!owningDevice->supportsPresentWait || presentCount <= maxFrameLatency) {
+        return;
+    }
+    // bounded, so a minimized window whose frames are never shown does not stall the loop
+    constexpr uint64_t timeoutNs = 100'000'000;
+    vkWaitForPresentKHR(owningDevice->device, swapChain, presentCount - maxFrameLatency, timeoutNs);
+}
+
 
 void RGL::SwapchainVK::DestroySwapchainIfNeeded()
 {
@@ -28,10 +28,14 @@ namespace RGL {
 
 		void Present(const SwapchainPresentConfig&) final;
 
-		void SetVsyncMode(bool mode) final;
+		void SetPresentMode(PresentMode mode) final;
+		void SetMaxFrameLatency(uint32_t frames) final;
+		void WaitForFrameLatency() final;
 
 	private:
-		bool vsync = true;
+		PresentMode presentMode = PresentMode::Fifo;
+		uint32_t maxFrameLatency = 2;
+		uint64_t presentCount = 0;		// present IDs of this VkSwapchainKHR, for VK_KHR_present_wait
 		void DestroySwapchainIfNeeded();
 	};
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "VkDevice.hpp"
 #include "RGLVk.hpp"
 #include <cstring>
+#include <vector>
+#include <algorithm>
 #include <vk_mem_alloc.h>
 
 namespace RGL {
@@ -53,37 +55,51 @@ namespace RGL {
 		if (rglUsage.TransientAttachment) {
 			usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
 		}
+		if (rglUsage.ShadingRate) {
+			usage |= VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
+		}
 
 		return usage;
 	}
 
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue) {
+	// copies as many mips as the buffer holds, tightly packed and largest first
+	void copyBufferToImage(VkBuffer buffer, size_t bufferSize, VkImage image, const TextureConfig& config, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue) {
 		VkCommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
 
-		VkBufferImageCopy region{};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
-
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = {
-			width,
-			height,
-			1
-		};
+		std::vector<VkBufferImageCopy> regions;
+		size_t offset = 0;
+		for (uint32_t mip = 0; mip < config.mipLevels; mip++) {
+			const auto mipSize = MipSizeBytes(config.format, config.width, config.height, mip);
+			if (mip > 0 && offset + mipSize > bufferSize) {
+				break;
+			}
+			VkBufferImageCopy region{};
+			region.bufferOffset = offset;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = mip;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = {
+				std::max(config.width >> mip, 1u),
+				std::max(config.height >> mip, 1u),
+				1
+			};
+			regions.push_back(region);
+			offset += mipSize;
+		}
 
 		vkCmdCopyBufferToImage(
 			commandBuffer,
 			buffer,
 			image,
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&region
+			uint32_t(regions.size()),
+			regions.data()
 		);
 
 		endSingleTimeCommands(commandBuffer, graphicsQueue, device, commandPool);
@@ -154,7 +170,7 @@ namespace RGL {
 		// so we have to be aware of that when copying the data
 		transitionImageLayout(vkImage, format, nativeFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, device, owningDevice->commandPool, owningDevice->presentQueue, createdAspectVk);
 
-		copyBufferToImage(stagingBuffer, vkImage, static_cast<uint32_t>(config.width), static_cast<uint32_t>(config.height), device, owningDevice->commandPool, owningDevice->presentQueue);
+		copyBufferToImage(stagingBuffer, bytes.data.size(), vkImage, config, device, owningDevice->commandPool, owningDevice->presentQueue);
 
 		transitionImageLayout(vkImage, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, device, owningDevice->commandPool, owningDevice->presentQueue, createdAspectVk);
 
@@ -250,6 +266,9 @@ namespace RGL {
 		else if (createdConfig.usage.DepthStencilAttachment) {
 			nativeFormat = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
 		}
+		else if (createdConfig.usage.ShadingRate) {
+			nativeFormat = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
+		}
 		else if (createdConfig.usage.Sampled) {
 			nativeFormat = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		}
@@ -86,6 +86,7 @@ namespace RGL{
 
 
     void CommandBufferWG::Commit(const CommitConfig& config) { 
+        // WebGPU runs submissions in order, so config.waitFor is already satisfied
         wgpuQueueSubmit(owningQueue->queue, commandBuffers.size(), commandBuffers.data());
     }
             
@@ -13,7 +13,7 @@ namespace RGL{
             .height = height,
             .format = wgpuSurfaceGetPreferredFormat(surface->surface,owningDevice->adapter),
             .usage = WGPUTextureUsage_RenderAttachment,
-            .presentMode = vsync ? WGPUPresentMode_Fifo : WGPUPresentMode_Immediate,
+            .presentMode = presentMode == PresentMode::Immediate ? WGPUPresentMode_Immediate : presentMode == PresentMode::Mailbox ? WGPUPresentMode_Mailbox : WGPUPresentMode_Fifo,
         };
         return wgpuDeviceCreateSwapChain(owningDevice->device, surface->surface, &swapChainDesc);
     }
@@ -56,8 +56,8 @@ namespace RGL{
         #endif
     }
 
-    void SwapchainWG::SetVsyncMode(bool mode){
-        vsync = mode;
+    void SwapchainWG::SetPresentMode(PresentMode mode){
+        presentMode = mode;
         Resize(currentSize.width, currentSize.height);
     }
 }
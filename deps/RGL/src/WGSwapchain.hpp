@@ -23,9 +23,11 @@ namespace RGL{
         std::array<TextureWG,3> activeTextures;
         uint32_t idx = 0;
 
-        void SetVsyncMode(bool mode) final;
+        void SetPresentMode(PresentMode mode) final;
+        void SetMaxFrameLatency(uint32_t frames) final {}
+        void WaitForFrameLatency() final {}
     private:
         WGPUSwapChain makeSwapchain(uint32_t width, uint32_t height);
-        bool vsync = true;
+        PresentMode presentMode = PresentMode::Fifo;
 	};
 }
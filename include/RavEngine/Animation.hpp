@@ -34,6 +34,10 @@ namespace RavEngine {
         float ticksPerSecond = 0;
 		uint32_t numTracks = 0;
 		uint16_t nameLength = 0;
+		enum class Encoding : uint8_t {
+			Keyframes,		// each track's keys follow the name, as SerializedJointAnimationTrackHeader and key arrays
+			OzzArchive		// an ozz archive of the runtime animation follows the name, with reduced and quantized keys
+		} encoding = Encoding::Keyframes;
 	};
 
 	struct SerializedJointAnimationTrackHeader {
@@ -7,6 +7,7 @@
 #include <ozz/base/memory/unique_ptr.h>
 #include "Function.hpp"
 #include "mathtypes.hpp"
+#include <mutex>
 
 namespace ozz::animation {
 	struct Skeleton;
@@ -51,14 +52,20 @@ struct IAnimGraphable{
 };
 
 /**
-* Represents a pre-computed animation track
+* Represents a pre-computed animation track. Only the header is read on construction, the keys are loaded on first use.
 */
 class AnimationAsset : public IAnimGraphable{
-	//duration
-	//clip data
-	ozz::unique_ptr<ozz::animation::Animation> anim;
+	//clip data, see Load
+	mutable ozz::unique_ptr<ozz::animation::Animation> anim;
+	mutable std::once_flag loaded;
+	std::string path;
 public:
 	AnimationAsset(const std::string& name);
+
+	/**
+	* Load the keys now instead of on first use, for example behind a loading screen. Thread safe.
+	*/
+	void Load() const;
 	
 	/**
 	 Sample the animation curves
@@ -69,9 +76,10 @@ public:
 	bool Sample(float t, float start, float speed, bool looping, ozz::vector<ozz::math::SoaTransform>&, ozz::animation::SamplingJob::Context& cache, const ozz::animation::Skeleton* skeleton) const override;
 	
 	/**
-	* @return the Ozz animation object
+	* @return the Ozz animation object, loading it if needed
 	*/
-	constexpr inline const decltype(anim)& GetAnim() const{
+	const decltype(anim)& GetAnim() const{
+		Load();
 		return anim;
 	}
 	
@@ -2,13 +2,16 @@
 #include <ozz/animation/runtime/animation.h>
 #include <ozz/base/maths/soa_transform.h>
 #include "AnimationAsset.hpp"
+#include "SamplingContextPool.hpp"
 #include "DataStructures.hpp"
 #include "Ref.hpp"
 #include <algorithm>
 #include "Tween.hpp"
 #include "App.hpp"
 #include "Function.hpp"
+#include "StringID.hpp"
 #include "Queryable.hpp"
+#include <span>
 
 namespace RavEngine{
 
@@ -118,14 +121,28 @@ struct AnimBlendTree : public IAnimGraphable{
     constexpr inline void SetBlendPos(const clamped_vec2& newPos){
 		blend_pos = newPos;
 	}
+
+	/**
+	* Configure how the nodes are blended
+	* @param threshold if the weights of the nodes add up to less than this, the skeleton's rest pose makes up the difference
+	* @param cullWeight nodes with at most this weight at the control point are not sampled
+	*/
+	constexpr inline void SetBlendThreshold(float threshold, float cullWeight = 0){
+		blendThreshold = threshold;
+		nodeCullWeight = cullWeight;
+	}
 	
 private:
 	struct Sampler{
 		ozz::vector<ozz::math::SoaTransform> locals;
 		Node node;
+		// each node keeps its own while it has influence, so the sampling cache is not invalidated by the other nodes' animations
+		SamplingContextPool::Handle context;
 	};
 	locked_node_hashmap<anim_id_t,Sampler,SpinLock> states;
 	clamped_vec2 blend_pos;
+	float blendThreshold = 0.1f;
+	float nodeCullWeight = 0;
 };
 
 #if !RVE_SERVER
@@ -324,18 +341,72 @@ public:
             }
         }
         
-        void Tick(const Ref<SkeletonAsset>& skeleton);
+        void Tick(const Ref<SkeletonAsset>& skeleton, float timeScale, double currentTime);
+        
+        /**
+         Add what the layer's pose depends on to a pose sharing key, and choose the time to sample at
+         @return false if the layer cannot share its pose this frame
+         */
+        bool HashSharedState(uint64_t& key, double currentTime, double quantum);
+        
+        float skippedTimeScale = 0;     // frame time scale accumulated while a level of detail left this layer out
+        double sharedSampleTime = 0;    // the quantized time HashSharedState chose
         
         ozz::vector<ozz::math::SoaTransform> transforms, transformsSecondaryBlending;
-        std::shared_ptr<ozz::animation::SamplingJob::Context> cache = std::make_shared<ozz::animation::SamplingJob::Context>();
+        // held only while playing. The second is for the target state while blending.
+        SamplingContextPool::Handle cache, blendCache;
+        
+        void ReleaseContexts(){
+            cache.reset();
+            blendCache.reset();
+        }
     };
 	
 
+	/**
+	 A level of detail for the animator, chosen by the distance from the nearest active camera. AnimatorSystem scales the
+	 distance by the camera's field of view, so a zoomed in camera keeps characters detailed, as their screen size would.
+	 */
+	struct LOD{
+		float minDistance = 0;				// applies from this distance until the next level's. The first level applies from 0.
+		uint8_t updateInterval = 1;			// tick once every this many frames. Playback keeps time, so only smoothness is lost.
+		uint8_t maxLayers = kmax_layers;	// layers after the first this many are not evaluated
+		bool updatePose = true;				// if false, only the state machines advance. The pose and skinning matrices keep their last values.
+	};
+
+	/**
+	 Set the levels of detail, or none to always update fully
+	 @param newLODs in order of increasing minDistance
+	 */
+	void SetLODs(std::span<const LOD> newLODs);
+
+	std::span<const LOD> GetLODs() const{
+		return lods;
+	}
+
+	/**
+	 @return the index of the level of detail the last Tick used
+	 */
+	uint8_t GetCurrentLOD() const{
+		return currentLOD;
+	}
+
+	/**
+	 Configure how the layers are blended
+	 @param threshold if the weights of the layers add up to less than this, the skeleton's rest pose makes up the difference
+	 @param cullWeight layers with at most this weight are not evaluated. They catch up on their time once their weight rises.
+	 */
+	constexpr inline void SetBlendThreshold(float threshold, float cullWeight = 0){
+		blendThreshold = threshold;
+		layerCullWeight = cullWeight;
+	}
+
 	/**
 	Process one frame of this animator.
 	@param t the transform component on the object
+	@param viewDistance the distance from the viewer, to choose the level of detail
 	*/
-    void Tick(const Transform& t);
+    void Tick(const Transform& t, float viewDistance = 0);
 	
     inline decltype(skeleton) GetSkeleton() const{
 		return skeleton;
@@ -345,18 +416,66 @@ public:
     virtual void DebugDraw(RavEngine::DebugDrawer& dbg, const Transform&) const override;
 #endif
 	
+	using SocketHandle = uint16_t;
+
+	/**
+	 Follow a bone, for example to attach a weapon to a hand. The bone is looked up once, and every socket of the animator
+	 is updated together at the end of Tick.
+	 @param boneName the bone to follow
+	 @return a handle for GetSocketMatrix and UpdateSocket. Adding a bone again returns its existing handle.
+	 */
+	SocketHandle AddSocket(const std::string_view boneName);
+	SocketHandle AddSocket(StringID boneName);
+
+	/**
+	 @return the world matrix of the socket's bone, as of the last Tick
+	 */
+	const matrix4& GetSocketMatrix(SocketHandle socket) const{
+		return socketMatrices[socket];
+	}
+
+	/**
+	 Move a transform to the socket's bone
+	 */
+	void UpdateSocket(SocketHandle socket, Transform& t) const;
+
+	/**
+	 Move a transform to a bone, looking it up by name. Prefer AddSocket for a bone that is followed every frame.
+	 */
 	void UpdateSocket(const std::string&, Transform&) const;
+	void UpdateSocket(StringID, Transform&) const;
 
 protected:
     
     
     mutable ozz::vector<matrix4> glm_pose;
     ozz::vector<matrix4> local_pose;
-    ozz::vector<matrix4> skinningmats;
+    ozz::vector<ozz::math::Float4x4> skinningmats;     // model-space pose times inverse bindpose, in the form the GPU reads
+    matrix4 worldMatrix{1};                            // of the owner, when the pose was last updated
+    uint64_t skinningMatsHash = 1;
     ozz::vector<ozz::math::Float4x4> models;
     ozz::vector<ozz::math::SoaTransform> all_transforms;
 
-    Vector<std::unique_ptr<Layer>> layers;
+    SmallVector<std::unique_ptr<Layer>, 2> layers;     // most animators have one or two
+
+    Vector<LOD> lods;
+    uint8_t currentLOD = 0;
+    uint32_t lodFrame = 0;              // staggered between animators, so ones at the same interval do not all tick in the same frame
+    float skippedTimeScale = 0;         // frame time scale accumulated over the frames the level of detail skipped
+    float blendThreshold = 0.1f;
+    float layerCullWeight = 0;
+
+    Vector<uint16_t> socketJoints;      // by SocketHandle
+    Vector<matrix4> socketMatrices;
+
+    void UpdateSockets();
+
+    struct SharedPose;
+    std::shared_ptr<const SharedPose> sharedPose;   // if set, this frame's pose was computed by another animator
+    static locked_hashmap<uint64_t, std::shared_ptr<const SharedPose>, SpinLock> sharedPoses;  // this frame's, by pose sharing key
+    double poseSharingQuantum = 0;
+
+    const ozz::vector<ozz::math::Float4x4>& ActiveModels() const;
 
     
 	/**
@@ -384,9 +503,37 @@ public:
 	
 	const decltype(local_pose)& GetLocalPose();
 	
-	inline const decltype(skinningmats)& GetSkinningMats(){
-		return skinningmats;
+	const decltype(skinningmats)& GetSkinningMats() const;
+
+	/**
+	 Store the skinning matrices without converting through glm, such as into mapped GPU memory
+	 @param dest room for a matrix per joint
+	 */
+	void WriteSkinningMats(std::span<glm::mat4> dest) const;
+
+	/**
+	 @return a hash of the skinning matrices, never 0. It stays the same while the pose does, and animators in the same pose share it,
+	 so the renderer can reuse skinned vertices instead of skinning again.
+	 */
+	uint64_t GetPoseHash() const{
+		return skinningMatsHash;
 	}
+
+	/**
+	 Share poses with other animators of the same skeleton whose layers play the same looping states, with the same weights and
+	 masks, at the same time rounded down to a multiple of the quantum. The first of them to tick in a frame evaluates the pose and
+	 the others reference it, so the renderer also skins it once. Layers that are paused, blending, or in a state that does not
+	 loop keep the animator from sharing while they are.
+	 @param quantum in seconds, or 0 to always evaluate this animator's own pose
+	 */
+	void SetPoseSharing(double quantum){
+		poseSharingQuantum = quantum;
+	}
+
+	/**
+	 Forget the poses shared last frame. Invoked by AnimatorSystem before it ticks the animators.
+	 */
+	static void ClearSharedPoses();
     
 };
 
@@ -3,13 +3,25 @@
 #include "GetApp.hpp"
 
 namespace RavEngine{
+class World;
+
 /**
-* Updates all AnimatorComponents
+* Updates all AnimatorComponents, in parallel. Each animator only writes its own pose and socket matrices. Blending uses per-thread
+* scratch, and SocketSystem moves the socket transforms afterward.
 */
 class AnimatorSystem : public AutoCTTI{
+	struct Viewer{
+		vector3 position;
+		float distanceScale;	// relative to a 60 degree field of view
+	};
+	// the World copies systems for each task, so the copies share the viewers
+	std::shared_ptr<Vector<Viewer>> viewers = std::make_shared<Vector<Viewer>>();
 public:
-    inline void operator()(AnimatorComponent& c, const Transform& t) const {
-		c.Tick(t);
-	}
+	/**
+	* Gather the active cameras, to choose the animators' levels of detail, and forget last frame's shared poses
+	*/
+	void before(World*) const;
+
+	void operator()(AnimatorComponent& c, const Transform& t) const;
 };
 }
@@ -10,7 +10,14 @@
 #include "AudioSnapshot.hpp"
 #endif
 #include <optional>
+#include <mutex>
+#include <string>
 #include "GetApp.hpp"
+#include "FrameLimiter.hpp"
+#include "MemoryTracking.hpp"
+#include "PerfCounters.hpp"
+#include "Function.hpp"
+#include "Vector.hpp"
 
 #define SINGLE_THREADED 0
 
@@ -30,6 +37,25 @@ struct AudioPlayer;
             WebGPU,
 			AutoSelect
 		} preferredBackend = RenderBackend::AutoSelect;
+
+		/**
+		 Compiled GPU pipelines are saved here on shutdown and loaded on startup, so later runs skip driver shader compiles.
+		 If empty, a file in the platform's per-user data directory is used. Set an app-specific path when
+		 shipping several apps, because each app's pipelines replace the others' in a shared file.
+		 */
+		std::string pipelineCachePath;
+		bool enablePipelineCache = true;
+
+		// threads that render audio. Rooms, and the sources within a room, are spread across them.
+		uint16_t audioWorkerThreads = 2;
+	};
+
+	// thread pools are created with the App, before OnConfigure, so they are sized by its constructor instead of AppConfig
+	struct ExecutorConfig {
+		// App::executor workers, for work a frame waits on: systems, render sync and physics. 0 means one per core, less the main and audio threads.
+		uint32_t frameWorkers = 0;
+		// App::backgroundExecutor workers, for asset loads, texture streaming and navmesh rebuilds. 0 means a quarter of the cores.
+		uint32_t backgroundWorkers = 0;
 	};
 
 	typedef std::chrono::high_resolution_clock clocktype;
@@ -39,6 +65,7 @@ struct AudioPlayer;
 	
 	class InputManager;
 	class World;
+	class PerformanceOverlay;
 
 	class App {
 		friend class NetworkManager;
@@ -51,7 +78,7 @@ struct AudioPlayer;
 #endif
         std::unique_ptr<VirtualFilesystem> Resources;
 	public:
-        App();
+        App(const ExecutorConfig& executorConfig = {});
 		virtual ~App();
 
 		// set this to true in app constructor if XR is desired
@@ -74,10 +101,41 @@ struct AudioPlayer;
 
 		bool GetAudioActive() const;
 
-		// Override to disable networking. If true, networking backend and associated threads will be created. 
+		// Override to disable networking. If true, networking backend and associated threads will be created at startup.
+		// Otherwise the backend is started by InitNetworking when the first NetworkServer or NetworkClient is created.
 		virtual bool NeedsNetworking() const {
 			return false;
 		}
+
+		/**
+		 Start the networking backend if it is not already running. Safe to call more than once.
+		 */
+		void InitNetworking();
+
+		struct StartupPhase {
+			const char* name;
+			std::chrono::duration<double, std::milli> duration;
+		};
+
+		/**
+		 @return how long each part of startup took, in the order they ran. Also logged once OnStartup returns.
+		 */
+		const auto& GetStartupPhases() const {
+			return startupPhases;
+		}
+
+		/**
+		 @return the memory held by each tracked pool, by each component type across loaded worlds, and by each asset cache, plus the
+		 device's VRAM use. Walks every component set and cached asset, so do not call this every frame.
+		 */
+		MemoryReport GetMemoryReport();
+
+		/**
+		 @return every performance counter as of the end of the last frame. See PerfCounters to add counters.
+		 */
+		const PerfSnapshot& GetPerfSnapshot() const {
+			return perfSnapshot;
+		}
 		
 		/**
 		 Signal to gracefully shut down the application
@@ -101,14 +159,14 @@ struct AudioPlayer;
 		//number of cores on device
 		const int numcpus = std::thread::hardware_concurrency();
 		
-		//global thread pool, threads = logical processors on CPU
-        tf::Executor executor{
-#if SINGLE_THREADED
-        1 // use main thread only on emscripten
-#else
-            std::max<size_t>(std::thread::hardware_concurrency() - 2, 2)    // for audio - TODO: make configurable
-#endif
-        };
+		// thread pool for frame work, see ExecutorConfig
+        tf::Executor executor;
+
+		/**
+		 Thread pool for work that may take several frames, such as loads and streaming. Its threads run below normal OS priority,
+		 so they use idle cores without delaying the frame's work on the executor.
+		 */
+		tf::Executor backgroundExecutor;
 		
 		//networking interface
 		NetworkManager networkManager;
@@ -147,8 +205,21 @@ struct AudioPlayer;
 		 @endcode
 		 */
         template<typename T>
-		constexpr inline void DispatchMainThread(const T& f){
-			main_tasks.enqueue(f);
+		inline void DispatchMainThread(T&& f){
+			main_tasks.enqueue(MainThreadTask(std::forward<T>(f)));
+		}
+
+		/**
+		 Limit how long each tick spends running tasks from DispatchMainThread. Tasks left over run first on the next tick.
+		 At least one batch of tasks runs every tick, so the queue always makes progress.
+		 @param budget the time limit, or 0 to run every queued task each tick
+		 */
+		void SetMainThreadTaskBudget(std::chrono::microseconds budget) {
+			mainTaskBudget = budget;
+		}
+
+		std::chrono::microseconds GetMainThreadTaskBudget() const {
+			return mainTaskBudget;
 		}
 
 		/**
@@ -158,6 +229,85 @@ struct AudioPlayer;
         float GetCurrentFPSScale() const{
             return currentScale;
         }
+
+		/**
+		@return how long the worlds, the network and the other per-tick work took on the last frame, excluding rendering and the frame limiter
+		*/
+		clocktype::duration GetLastTickDuration() const {
+			return lastTickDuration;
+		}
+
+		/**
+		 Tick worlds at a fixed rate instead of once per frame. Each frame runs as many simulation ticks as have elapsed,
+		 and render data for moving meshes is interpolated between the last two ticks. On servers, this also sets the loop rate.
+		 @param ticksPerSecond the simulation rate, or 0 to tick once per frame (the default)
+		 */
+		void SetFixedTickRate(double ticksPerSecond) {
+			fixedTickRate = std::max(ticksPerSecond, 0.0);
+			fixedTickAccumulator = 0;
+		}
+
+		double GetFixedTickRate() const {
+			return fixedTickRate;
+		}
+
+		/**
+		 Tick loaded worlds concurrently on the executor instead of one after another. All worlds finish ticking before anything is rendered.
+		 @note Only enable this if worlds do not touch each other's entities or components while they tick.
+		 */
+		void SetParallelWorldTicks(bool enabled) {
+			parallelWorldTicks = enabled;
+		}
+
+		bool GetParallelWorldTicks() const {
+			return parallelWorldTicks;
+		}
+
+		/**
+		 Encode the rendered world's frame on the executor while the other loaded worlds tick and the network server replicates.
+		 The rendered world still finishes its tick before it is drawn. Main thread tasks queued by the other worlds run next frame.
+		 @note Only enable this if the other worlds do not touch the rendered world while they tick.
+		 */
+		void SetPipelinedFrames(bool enabled) {
+			pipelinedFrames = enabled;
+		}
+
+		bool GetPipelinedFrames() const {
+			return pipelinedFrames;
+		}
+
+		/**
+		 Cap how often the main loop runs. 0 removes the cap. Servers without a cap tick at the fixed tick rate, or at min_tick_time.
+		 The loop sleeps between frames, so a cap also saves power.
+		 */
+		void SetTargetFrameRate(double framesPerSecond) {
+			targetFrameRate = std::max(framesPerSecond, 0.0);
+		}
+
+		double GetTargetFrameRate() const {
+			return targetFrameRate;
+		}
+
+		/**
+		 How long before each frame is due the limiter stops sleeping and spins. Raise this if frames start late, lower it to use less CPU.
+		 */
+		void SetFrameLimiterSpinTime(std::chrono::microseconds spinTime) {
+			frameLimiter.spinTime = spinTime;
+		}
+
+#if !RVE_SERVER
+		/**
+		 Wait for the GPU to finish the previous frame before reading input, instead of after. When GPU bound, this shortens the
+		 time from input to display at the cost of overlap between the CPU and GPU.
+		 */
+		void SetLowLatencyFrames(bool enabled) {
+			lowLatencyFrames = enabled;
+		}
+
+		bool GetLowLatencyFrames() const {
+			return lowLatencyFrames;
+		}
+#endif
 #if !RVE_SERVER
 		Ref<InputManager> inputManager;
 #endif
@@ -200,6 +350,21 @@ struct AudioPlayer;
 		 @note Do not call this every frame. To update periodically with data such as frame rates, use a scheduled system.
 		 */
         void SetWindowTitle(const char* title);
+
+		/**
+		 Show or hide the performance overlay, which draws frame times, the slowest systems, per-pass draw counts, VRAM, audio and network over the main window.
+		 It is available in release builds, and also toggles with the hotkey set by SetPerformanceOverlayHotkey.
+		 */
+		void SetPerformanceOverlayVisible(bool visible);
+
+		bool IsPerformanceOverlayVisible() const;
+
+		/**
+		 @param scancode the SDL scancode that toggles the performance overlay, F3 by default. 0 disables the hotkey.
+		 */
+		void SetPerformanceOverlayHotkey(int scancode) {
+			performanceOverlayHotkey = scancode;
+		}
 #endif
 		
 		std::optional<Ref<World>> GetWorldByName(const std::string& name);
@@ -235,12 +400,34 @@ struct AudioPlayer;
         void Tick();
         
         float currentScale = 0.01f;
+        clocktype::duration lastTickDuration{ 0 };
+        PerfSnapshot perfSnapshot;
+        double fixedTickRate = 0;
+        double fixedTickAccumulator = 0;    // seconds of simulation owed, when ticking at a fixed rate
+        constexpr static uint32_t maxFixedTicksPerFrame = 8;  // beyond this, time is dropped instead of simulated
+        bool parallelWorldTicks = false;
+        bool pipelinedFrames = false;
+        bool lowLatencyFrames = false;
+        double targetFrameRate = 0;
+        FrameLimiter frameLimiter;
+
+        // 0 if the loop is not paced
+        clocktype::duration FrameInterval() const;
+
+		std::vector<StartupPhase> startupPhases;
+		std::once_flag networkingOnce;
+		bool networkingInitialized = false;
         
 		Ref<World> renderWorld;
 	
-		ConcurrentQueue<Function<void(void)>> main_tasks;
+		// captures up to this size are stored inline, so most dispatches do not allocate
+		using MainThreadTask = SmallFunction<void(void), 64>;
+		ConcurrentQueue<MainThreadTask> main_tasks;
+		Vector<MainThreadTask> deferredMainTasks;	// dequeued but over budget, run first next tick
+		std::chrono::microseconds mainTaskBudget{ 4000 };
+		void RunMainThreadTasks();
 		
-		locked_hashset<Ref<World>,SpinLock> loadedWorlds;
+		locked_hashset<Ref<World>,NamedSpinLock<"App::loadedWorlds">> loadedWorlds;
 #if !RVE_SERVER
         AudioSnapshot a1, a2, a3, *acurrent = &a1, *ainactive = &a2, *arender = &a3;
         SpinLock audiomtx1;
@@ -251,6 +438,8 @@ struct AudioPlayer;
 		RGLDevicePtr device;
 		std::unique_ptr<Window> window;
 		RenderViewCollection mainWindowView;
+		std::unique_ptr<PerformanceOverlay> performanceOverlay;
+		int performanceOverlayHotkey = 60;	// SDL_SCANCODE_F3
 
 		std::vector<RenderViewCollection> xrRenderViewCollections;
 #endif
@@ -0,0 +1,30 @@
+#pragma once
+#include "Function.hpp"
+#include <cstdint>
+
+namespace RavEngine {
+
+	enum class AssetLoadPriority : uint8_t {
+		Low,
+		Normal,
+		High,
+	};
+
+	/**
+	 Runs asset loads on App::executor. Only a few run at once, so that loads do not take every worker from the frame's
+	 tasks. Higher priority loads start first, and loads of one priority start in the order they were requested.
+	 */
+	struct AssetLoadQueue {
+		static void Enqueue(AssetLoadPriority priority, Function<void()>&& load);
+
+		/**
+		 @param maxLoads the number of loads that may run at once. 0 means one per App::backgroundExecutor worker, the default.
+		 */
+		static void SetMaxConcurrentLoads(uint32_t maxLoads);
+
+		/**
+		 Run a function on the main thread at the start of the next frame
+		 */
+		static void RunOnMainThread(Function<void()>&& function);
+	};
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "AssetPackFormat.hpp"
+#include "Vector.hpp"
+#include "Map.hpp"
+#include "Function.hpp"
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace RavEngine::AssetPack {
+
+	/**
+	 The entry table of a pack, read once when the pack is mounted
+	 */
+	class Index {
+	public:
+		/**
+		 @param table the first TableSize bytes of the pack
+		 @param packSize the size of the whole pack, to check that entries are inside it
+		 @return false if the table is malformed
+		 */
+		bool Load(std::span<const std::byte> table, uint64_t packSize);
+
+		/**
+		 @return the entry for a file, or nullptr if the pack does not have it
+		 */
+		const Entry* Find(std::string_view path) const;
+
+		bool IsDirectory(std::string_view path) const {
+			return directories.contains(std::string(path));
+		}
+
+		/**
+		 Call a function on the name of each file and directory directly in a directory
+		 @return false if the directory does not exist
+		 */
+		bool EnumerateDirectory(std::string_view path, FunctionRef<void(const std::string&)> callback) const;
+
+		std::string_view PathOf(const Entry& entry) const {
+			return std::string_view(paths).substr(entry.pathOffset, entry.pathLength);
+		}
+
+		const Vector<Entry>& Entries() const {
+			return entries;
+		}
+
+	private:
+		Vector<Entry> entries;
+		std::string paths;
+		UnorderedMap<std::string, Vector<std::string>> directories;		// directory path to child names, "" is the root
+	};
+
+	/**
+	 Let PhysFS mount packs. Packs are tried first for .rvedata files, which are otherwise zips.
+	 */
+	void RegisterArchiver();
+
+	/**
+	 Find where a file stored uncompressed lives in a mounted pack, so it can be mapped instead of read
+	 @param archive the path the pack was mounted from, as given by PHYSFS_getRealDir
+	 @return false if the archive is not a pack, or the file is compressed or not in it
+	 */
+	bool FindStoredFile(const char* archive, std::string_view path, uint64_t& offset, uint64_t& size);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// shared by the engine and the rvepack tool, so it must not depend on the rest of the engine
+
+namespace RavEngine::AssetPack {
+
+	/**
+	 A pack is a Header, the entry table sorted by path hash, the entry paths, and the file data. Files are laid out in the
+	 order they are loaded, so loading a level reads the pack front to back. Files stored uncompressed start on an
+	 alignment boundary so they can be memory-mapped. All values are little-endian.
+	 */
+	constexpr std::array<char, 4> magic{ 'R','V','E','P' };
+	constexpr uint32_t formatVersion = 1;
+	constexpr uint64_t alignment = 4096;
+
+	enum class Encoding : uint8_t {
+		None,
+		Deflate,
+	};
+
+	struct Header {
+		std::array<char, 4> magic = AssetPack::magic;
+		uint32_t version = formatVersion;
+		uint32_t entryCount = 0;
+		uint32_t pathsSize = 0;			// bytes of paths after the entry table
+	};
+	static_assert(sizeof(Header) == 16);
+
+	struct Entry {
+		uint64_t pathHash = 0;
+		uint64_t offset = 0;			// from the start of the pack
+		uint64_t size = 0;				// uncompressed
+		uint64_t storedSize = 0;		// in the pack
+		uint32_t pathOffset = 0;		// into the paths, which are not null terminated
+		uint16_t pathLength = 0;
+		Encoding encoding = Encoding::None;
+		uint8_t group = 0;				// load order group, files in one group are contiguous
+	};
+	static_assert(sizeof(Entry) == 40);
+
+	/**
+	 FNV-1a, 64 bit
+	 */
+	constexpr uint64_t HashPath(std::string_view path) {
+		uint64_t hash = 0xcbf29ce484222325;
+		for (const char c : path) {
+			hash ^= uint8_t(c);
+			hash *= 0x100000001b3;
+		}
+		return hash;
+	}
+
+	constexpr uint64_t TableSize(const Header& header) {
+		return sizeof(Header) + uint64_t(header.entryCount) * sizeof(Entry) + header.pathsSize;
+	}
+}
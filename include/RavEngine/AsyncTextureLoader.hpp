@@ -0,0 +1,73 @@
+#pragma once
+#if !RVE_SERVER
+#include "Vector.hpp"
+#include "Queue.hpp"
+#include "Function.hpp"
+#include <RGL/Types.hpp>
+#include <RGL/TextureFormat.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace RavEngine {
+    class AsyncTexture;
+    class RenderEngine;
+
+    /**
+     Reads and decodes AsyncTextures on the executor, and uploads the finished ones at the start of each frame. Uploads are recorded on the
+     frame's command buffer through staging buffers, so they do not stall the render thread. At most uploadBudgetBytes are uploaded per
+     frame, and the rest wait for the next frame, so a burst of new content does not hitch a single frame.
+     */
+    class AsyncTextureLoader {
+    public:
+        ~AsyncTextureLoader();
+
+        /**
+         @return the number of textures still being read or decoded, or waiting for upload
+         */
+        uint32_t GetNumPending() const {
+            return numPending;
+        }
+
+        uint64_t uploadBudgetBytes = 32 * 1024 * 1024;   // at least one texture is uploaded per frame, even if it is larger
+
+    private:
+        friend class AsyncTexture;
+        friend class RenderEngine;
+
+        struct Entry {
+            AsyncTexture* texture = nullptr;
+            uint32_t generation = 0;        // bumped when the slot is released, so loads for the old texture are dropped
+        };
+
+        struct Decoded {
+            uint32_t slot = 0, generation = 0;
+            uint32_t width = 0, height = 0;
+            RGL::TextureFormat format = RGL::TextureFormat::RGBA8_Unorm;
+            Vector<Vector<std::byte>> mips;     // largest first
+        };
+
+        Vector<Entry> entries;
+        Vector<uint32_t> freeSlots;
+        std::mutex mtx;
+        ConcurrentQueue<Decoded> decoded;
+        Queue<Decoded> ready;
+        std::atomic<uint32_t> decodesInFlight = 0, numPending = 0;
+
+        uint32_t Register(AsyncTexture* texture);
+        void Unregister(uint32_t slot);
+
+        /**
+         Run decode on the executor, and upload its result to the texture in the slot on a later frame
+         */
+        void Load(uint32_t slot, Function<Decoded()>&& decode);
+
+        /**
+         Upload the textures that finished decoding, within the budget. Must be called once per frame, on the render thread.
+         */
+        void Update(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine);
+    };
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#include "Vector.hpp"
+#include <cstdint>
+#include <span>
+
+namespace RavEngine {
+    /**
+     One channel of audio compressed as 4-bit IMA ADPCM, about an eighth of the size of float samples. The samples are split into
+     blocks that each begin with the decoder state, so playback can decode any block without decoding the ones before it.
+     */
+    class ADPCMChannel {
+    public:
+        constexpr static uint32_t samplesPerBlock = 256;
+        constexpr static uint32_t headerBytes = 4;     // the first sample as int16, the step index, and a pad byte
+        constexpr static uint32_t bytesPerBlock = headerBytes + samplesPerBlock / 2;
+
+        ADPCMChannel() {}
+
+        /**
+         Compress samples
+         @param samples in [-1,1] normalized float. Values outside are clipped.
+         */
+        ADPCMChannel(std::span<const float> samples);
+
+        /**
+         Decode one block into float samples. The samples of the last block past GetNumSamples() are not meaningful.
+         @param block the block index, less than GetNumBlocks()
+         */
+        void DecodeBlock(uint32_t block, std::span<float, samplesPerBlock> out) const;
+
+        uint32_t GetNumSamples() const {
+            return numSamples;
+        }
+
+        uint32_t GetNumBlocks() const {
+            return (numSamples + samplesPerBlock - 1) / samplesPerBlock;
+        }
+
+        size_t GetSizeBytes() const {
+            return blocks.size();
+        }
+
+    private:
+        Vector<uint8_t> blocks;
+        uint32_t numSamples = 0;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "AudioTypes.hpp"
 #include "DataStructures.hpp"
+#include <optional>
 
 namespace RavEngine{
 
@@ -9,6 +10,14 @@ Derive from this class to create custom audio filter layers
 */
 struct AudioFilterLayer {
     virtual void process(const PlanarSampleBufferInlineView&, PlanarSampleBufferInlineView&) = 0;
+
+    /**
+     Layers that only scale their input return the factor, so that the graph folds consecutive ones into a single pass.
+     @return the gain this layer applies, or nothing if it does anything else
+     */
+    virtual std::optional<float> GetLinearGain() const {
+        return std::nullopt;
+    }
 };
 
 /**
@@ -18,19 +27,19 @@ struct AudioGainFilterLayer : public AudioFilterLayer {
     float gain = 1;
     void process(const PlanarSampleBufferInlineView& in, PlanarSampleBufferInlineView& out) final {
         for (int c = 0; c < in.GetNChannels(); c++) {
-            auto channel = in[c];
-#pragma omp simd
-            for (int i = 0; i < channel.size(); i++) {
-                out[c][i] = channel[i] * gain;
-            }
+            AudioKernels::Scale(out[c].data(), in[c].data(), gain, in.sizeOneChannel());
         }
     }
+    std::optional<float> GetLinearGain() const final {
+        return gain;
+    }
     AudioGainFilterLayer() {}
     AudioGainFilterLayer(float gain) : gain(gain) {}
 };
 
 /**
 Represents an audio effect stack. Effects are processed in insertion order, with the results of Effect N passed as the input to Effect N+1.
+Consecutive linear layers are applied as one gain, in place.
 */
 class AudioGraphAsset{
    
@@ -52,9 +61,15 @@ public:
      @param inout input samples
      @param scratch buffer
      @param nchannels the number of channels in the buffers
-     @post inout will be swapped with scratchBuffer. This is why they are passed by reference.
+     @param skipLeadingGain true if the caller already applied GetLeadingGain to the input
+     @post inout holds the result, in the same memory it viewed before. The contents of scratchBuffer are undefined.
+     */
+    void Render(PlanarSampleBufferInlineView& inout, PlanarSampleBufferInlineView& scratchBuffer, uint8_t nchannels, bool skipLeadingGain = false);
+
+    /**
+     @return the product of the linear layers at the front of the graph. Sources scale their samples by their volume anyway, so they fold this in for free.
      */
-    void Render(PlanarSampleBufferInlineView& inout, PlanarSampleBufferInlineView& scratchBuffer, uint8_t nchannels);
+    float GetLeadingGain() const;
     
 };
 
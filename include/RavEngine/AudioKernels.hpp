@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ Vectorized loops over float samples, with SSE on x86 and NEON on ARM. The pointers need no particular alignment, and
+ unless noted, the source and destination may be the same.
+ */
+namespace RavEngine::AudioKernels {
+    void Fill(float* data, float value, size_t n);
+
+    // dst += src
+    void Add(float* dst, const float* src, size_t n);
+
+    // dst = src * gain
+    void Scale(float* dst, const float* src, float gain, size_t n);
+
+    // clamp to [lo, hi]
+    void Clamp(float* data, float lo, float hi, size_t n);
+
+    /**
+     Convert planar samples to interleaved, clamping them to [-1,1] for output. The two buffers may not overlap.
+     @param planar nchannels runs of frames samples, one after the other
+     @param interleaved frames * nchannels samples
+     */
+    void InterleaveClamped(const float* planar, uint8_t nchannels, size_t frames, float* interleaved);
+}
@@ -10,6 +10,9 @@
 #include "Types.hpp"
 #include "AudioSnapshot.hpp"
 #include <semaphore>
+#include <chrono>
+#include <array>
+#include <mutex>
 
 struct _IPLContext_t;
 struct _IPLHRTF_t;
@@ -25,6 +28,23 @@ struct AudioDataProvider;
  Engine class that plays audio
  */
 class AudioPlayer{
+public:
+    /**
+     Timings and counts of the last rendered quantum, for tuning buffer sizes and voice budgets
+     */
+    struct Metrics{
+        using duration_t = std::chrono::duration<double, std::milli>;
+        duration_t providerTime{ 0 };       // point, ambient and virtual providers
+        duration_t roomTime{ 0 };           // audio spaces, after the providers completed
+        duration_t finalMixTime{ 0 };
+        duration_t quantumTime{ 0 };        // the whole quantum, including the preamble
+        uint32_t queuedFrames = 0;          // frames still queued for the device when the quantum began
+        uint32_t activeVoices = 0;
+        uint32_t virtualVoices = 0;
+        uint64_t underruns = 0;             // quanta that began with nothing queued, since Init
+        uint64_t quanta = 0;                // quanta rendered since Init
+    };
+private:
 #if !RVE_SERVER
     SDL_AudioStream* stream = nullptr;
 	WeakRef<World> worldToRender;
@@ -42,6 +62,8 @@ class AudioPlayer{
     static constexpr uint16_t config_buffersize = 512;
     static constexpr uint16_t config_samplesPerSec = 44'100;
     static constexpr uint32_t config_nchannels = 2;
+    static constexpr uint32_t minSourcesPerChunk = 4;      // a room's sources are only split across workers if each gets at least this many
+    static constexpr std::chrono::milliseconds config_simulationInterval{ 50 };      // how often geometry audio spaces are simulated
 #if !RVE_SERVER
 	void Tick();
 
@@ -57,6 +79,7 @@ class AudioPlayer{
     std::vector<entity_id_t> destroyedSources, destroyedMeshComponents;
 
     decltype(AudioSnapshot::dataProviders.begin()) dataProvidersBegin, dataProvidersEnd;
+    decltype(AudioSnapshot::virtualProviders.begin()) virtualProvidersBegin, virtualProvidersEnd;
     decltype(AudioSnapshot::ambientSources.begin()) ambientSourcesBegin, ambientSourcesEnd;
     decltype(AudioSnapshot::simpleAudioSpaces.begin()) simpleSpacesBegin, simpleSpacesEnd;
     decltype(AudioSnapshot::geometryAudioSpaces.begin()) geometrySpacesBegin, geometrySpacesEnd;
@@ -67,12 +90,43 @@ class AudioPlayer{
     matrix4 invListenerTransform{ 1 }, listenerTransform{ 1 };
 
     std::optional<std::thread> audioTickThread;
+    std::optional<std::thread> simulationThread;
+    std::mutex simulatedSpacesMtx;
+    std::vector<WeakRef<GeometryAudioSpace::RoomData>> simulatedSpaces;
+
+    // run on simulationThread, at config_simulationInterval
+    void SimulateSpaces();
     std::atomic<bool> audioThreadShouldRun = true;
     std::vector<float> interleavedOutputBuffer;
+    std::vector<std::unique_ptr<SingleAudioRenderBuffer>> workerBuffers;     // per audio worker, for rendering one source at a time
 
     void PerformAudioTickPreamble();
+
+    enum class Stage : uint8_t{
+        Preamble,
+        Providers,
+        Rooms,
+        FinalMix,
+        Count
+    };
+    // the time each stage of the quantum completed. Each slot is written by one task.
+    std::array<std::chrono::steady_clock::time_point, size_t(Stage::Count)> stageEnds;
+    void MarkStageEnd(Stage stage){
+        stageEnds[size_t(stage)] = std::chrono::steady_clock::now();
+    }
+    void RecordMetrics(std::chrono::steady_clock::time_point quantumBegin, uint32_t queuedFrames);
+    mutable std::mutex metricsMtx;
+    Metrics metrics;
+    bool PrepareGeometryAudioSpace(AudioSnapshot::GeometryAudioSpaceData& r);
+    void RenderGeometrySources(AudioSnapshot::GeometryAudioSpaceData& r, uint32_t begin, uint32_t end, PlanarSampleBufferInlineView& accumulationView, SingleAudioRenderBuffer& working);
     void CalculateGeometryAudioSpace(AudioSnapshot::GeometryAudioSpaceData& r);
+    bool PrepareSimpleAudioSpace(AudioSnapshot::SimpleAudioSpaceData&);
+    void RenderSimpleSources(AudioSnapshot::SimpleAudioSpaceData& r, uint32_t begin, uint32_t end, PlanarSampleBufferInlineView& accumulationView, SingleAudioRenderBuffer& working);
     void CalculateSimpleAudioSpace(AudioSnapshot::SimpleAudioSpaceData&);
+    
+    // prepare the space, then render its sources in chunks across workers and sum their mixes. Serial if the space has an effect graph.
+    template<typename Space, typename Prepare, typename Render>
+    void EmplaceSpaceTasks(tf::Subflow& subflow, Space& r, Prepare prepare, Render render);
     void CalculateBoxAudioSpace(AudioSnapshot::BoxReverbationSpaceData&);
     void CalculateFinalMix();
     void ST_DoMix();
@@ -101,7 +155,10 @@ public:
     }
     _IPLAudioSettings_t GetSteamAudioSettings() const;
 
-    AudioPlayer();
+    /**
+     @param nWorkers the number of threads that render audio
+     */
+    AudioPlayer(uint16_t nWorkers = 2);
     
 	/**
 	 Set the current world to output audio for
@@ -136,6 +193,16 @@ public:
     decltype(globalSamples) GetGlobalAudioTime() const{
         return globalSamples;
     }
+
+    /**
+     @return the metrics of the last rendered quantum. Thread safe. They are also plotted in the profiler.
+     */
+    Metrics GetMetrics() const;
+    
+    /**
+     Simulate a geometry audio space on the background simulation thread until it is destroyed. Invoked by GeometryAudioSpace.
+     */
+    void AddSimulatedSpace(const Ref<GeometryAudioSpace::RoomData>& space);
 #endif
     
 };
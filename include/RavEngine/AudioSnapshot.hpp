@@ -3,11 +3,64 @@
 #include "DataStructures.hpp"
 #include "AudioSource.hpp"
 #include "AudioSpace.hpp"
+#include <algorithm>
 
 namespace RavEngine{
 struct AudioGraphAsset;
 struct AudioMeshAsset;
 
+/**
+ Refs that are kept when the array is cleared, so that adding the same objects in the same order, as a scene does every tick
+ while it is unchanged, does not touch their reference counts or allocate. The slots past the current size are released on the next Clear.
+ */
+template<typename T>
+struct PinnedRefArray{
+    using iterator = typename Vector<Ref<T>>::iterator;
+    
+    void Add(const Ref<T>& ref){
+        if (count < refs.size()){
+            if (refs[count] != ref){
+                refs[count] = ref;
+            }
+        }
+        else{
+            refs.push_back(ref);
+        }
+        count++;
+    }
+    
+    void Clear(){
+        refs.erase(refs.begin() + count, refs.end());
+        count = 0;
+    }
+    
+    /**
+     Move the Refs that do not satisfy the predicate to another array, keeping the rest
+     */
+    template<typename Pred>
+    void Partition(Pred&& keep, PinnedRefArray& rest){
+        auto split = std::partition(begin(), end(), keep);
+        for (auto it = split; it != end(); ++it){
+            rest.Add(*it);
+        }
+        count = split - begin();
+    }
+    
+    iterator begin(){
+        return refs.begin();
+    }
+    iterator end(){
+        return refs.begin() + count;
+    }
+    size_t size() const{
+        return count;
+    }
+    
+private:
+    Vector<Ref<T>> refs;
+    size_t count = 0;
+};
+
 struct AudioSnapshot{
     struct PointSourceBase{
         vector3 worldpos;
@@ -15,7 +68,7 @@ struct AudioSnapshot{
     };
     
     struct PointSource : public PointSourceBase{
-        Ref<AudioDataProvider> data;
+        AudioDataProvider* data;     // kept alive by the snapshot's dataProviders
         entity_t ownerID = {INVALID_ENTITY};
         PointSource(const decltype(data)& data, const decltype(worldpos)& wp, const decltype(worldrot)& wr, decltype(ownerID) ownerID): data(data), ownerID(ownerID), PointSourceBase{wp, wr} {}
         bool operator==(const PointSource& other) const{
@@ -61,8 +114,9 @@ struct AudioSnapshot{
     };
     
     UnorderedVector<PointSource> sources;
-    UnorderedSet<Ref<AudioDataProvider>> dataProviders;
-    UnorderedVector<Ref<AudioDataProvider>> ambientSources;
+    PinnedRefArray<AudioDataProvider> dataProviders;         // each provider once, even if several sources share it
+    PinnedRefArray<AudioDataProvider> virtualProviders;      // the providers of sources cut by LimitVoices, advanced without spatializing
+    PinnedRefArray<AudioDataProvider> ambientSources;
     
     Vector<SimpleAudioSpaceData> simpleAudioSpaces;
     Vector<GeometryAudioSpaceData> geometryAudioSpaces;
@@ -74,17 +128,44 @@ struct AudioSnapshot{
     quaternion listenerRot;
     Ref<AudioGraphAsset> listenerGraph;
     WeakRef<World> sourceWorld;
+    uint32_t maxVoices = 0;     // from the listener, 0 for no limit
     
+    /**
+     Add a point source, and its provider if no other source in this snapshot has added it
+     */
+    void AddPointSource(const Ref<AudioDataProvider>& provider, const vector3& worldpos, const quaternion& worldrot, entity_t ownerID){
+        sources.emplace(provider.get(), worldpos, worldrot, ownerID);
+        if (provider->snapshotStamp != stamp){
+            provider->snapshotStamp = stamp;
+            dataProviders.Add(provider);
+        }
+    }
+    
+    /**
+     Keep only the maxVoices most audible point sources, ranked by distance attenuation, volume and priority. The providers of the
+     others move to virtualProviders. Invoke once all the sources are added.
+     */
+    void LimitVoices();
+    
+    // the containers keep their memory, so a scene that does not grow collects without allocating
     void Clear(){
+        stamp = NextStamp();
         sources.clear();
-        ambientSources.clear();
+        virtualProviders.Clear();
+        maxVoices = 0;
+        ambientSources.Clear();
         simpleAudioSpaces.clear();
         geometryAudioSpaces.clear();
         boxAudioSpaces.clear();
         sourceWorld.reset();
         audioMeshes.clear();
-        dataProviders.clear();
+        dataProviders.Clear();
     }
+    
+private:
+    // marks the providers added to this snapshot since the last Clear, unique across snapshots
+    static uint64_t NextStamp();
+    uint64_t stamp = NextStamp();
 };
 }
 
@@ -92,7 +173,7 @@ namespace std{
     template<>
     struct hash<RavEngine::AudioSnapshot::PointSource>{
         inline size_t operator()(const RavEngine::AudioSnapshot::PointSource& obj){
-            return reinterpret_cast<size_t>(obj.data.get());
+            return reinterpret_cast<size_t>(obj.data);
         }
     };
 }
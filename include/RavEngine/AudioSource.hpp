@@ -2,12 +2,14 @@
 #if !RVE_SERVER
 #include "Queryable.hpp"
 #include <string>
+#include <limits>
 #include "mathtypes.hpp"
 #include "Ref.hpp"
 #include "AudioTypes.hpp"
 #include "Types.hpp"
 #include "ComponentWithOwner.hpp"
 #include "AudioRenderBuffer.hpp"
+#include "AudioADPCM.hpp"
 
 namespace RavEngine{
 
@@ -16,17 +18,26 @@ class AudioAsset{
 	friend class AudioSyncSystem;
 	friend class AudioSourceBase;
 private:
-	const float* audiodata;
+	const float* audiodata = nullptr;
 	double lengthSeconds = 0;
 	uint8_t nchannels = 0;
+	uint32_t numSamples = 0;
 public:
-    PlanarSampleBufferInlineView data;
+	enum class Encoding : uint8_t {
+		PCM,	// float samples, the cheapest to play
+		ADPCM	// about an eighth of the memory, decoded a block at a time while playing, with a little loss of quality
+	};
+
+    PlanarSampleBufferInlineView data;		// empty if the asset is compressed
+	Vector<ADPCMChannel> compressed;		// one per channel, if the asset is compressed
+	
 	/**
 	 Construct an AudioAsset given a file path. The AudioAsset will decode the audio into samples.
 	 @param name the file name to load
 	 @param desired_channels the number of channels the file should have after loading
+	 @param encoding how to keep the samples in memory. Use ADPCM for large sets of short sounds.
 	 */
-	AudioAsset(const std::string& name, decltype(nchannels) desired_channels = 1);
+	AudioAsset(const std::string& name, decltype(nchannels) desired_channels = 1, Encoding encoding = Encoding::PCM);
 	
 	/**
 	 Use for generated audio. The AudioAsset assumes ownership of the data and will free it on destruction.
@@ -38,6 +49,7 @@ public:
 		audiodata = interleavedData.data();
 		data = PlanarSampleBufferInlineView{const_cast<float*>(audiodata),interleavedData.size(),nchannels };
 		data.ImportInterleavedData(interleavedData, nchannels);
+		numSamples = uint32_t(data.sizeOneChannel());
     }
 	
 	~AudioAsset();
@@ -52,8 +64,12 @@ public:
     }
     
     inline auto GetNumSamples() const{
-        return data.sizeOneChannel();
+        return numSamples;
     }
+	
+	inline bool IsCompressed() const{
+		return !compressed.empty();
+	}
 };
 
 
@@ -65,6 +81,8 @@ struct AudioDataProvider{
     
     SingleAudioRenderBuffer renderData;
     float volume = 1;
+    float priority = 1;
+    uint64_t snapshotStamp = 0;     // for AudioSnapshot to add each provider once
     bool loops : 1 = false;
     bool isPlaying : 1 = false;
     
@@ -84,6 +102,14 @@ struct AudioDataProvider{
     
     virtual void Restart() = 0;
     
+    /**
+     Advance by one buffer without needing its samples, because the source is virtualized. By default this renders the buffer anyway.
+     Override it if the playhead can be advanced more cheaply.
+     */
+    virtual void AdvanceSilently(PlanarSampleBufferInlineView& out_buffer, PlanarSampleBufferInlineView& effectScratchBuffer){
+        ProvideBufferData(out_buffer, effectScratchBuffer);
+    }
+    
     
     inline float GetVolume() const { return volume; }
     
@@ -93,6 +119,14 @@ struct AudioDataProvider{
      */
     inline void SetVolume(float vol){volume = vol;}
     
+    inline float GetPriority() const { return priority; }
+    
+    /**
+     Change how this source ranks against others when the listener has a voice budget. Audibility is multiplied by the priority.
+     @param p new priority for this source, 1 by default
+     */
+    inline void SetPriority(float p){priority = p;}
+    
     /**
      Enable or disable looping for this audio source. A looping source will continuously play until manually stopped, whereas
      non-looping sources will automatically deactivate when finished
@@ -111,7 +145,22 @@ struct AudioDataProvider{
  This is a marker component to indicate where the "microphone" is in the world. Do not have more than one in a world.
  Applying an effect graph to the listener will apply the graph to all sounds in the world at once.
  */
-class AudioListener : public Queryable<AudioListener>, public AudioGraphComposed, public AutoCTTI{};
+class AudioListener : public Queryable<AudioListener>, public AudioGraphComposed, public AutoCTTI{
+    uint32_t maxVoices = 0;
+public:
+    /**
+     Limit how many point sources are spatialized at once. The most audible sources, by distance, volume and priority, are spatialized.
+     The rest are virtualized: their playheads advance, but they are not heard until they rank high enough again.
+     @param voices the number of sources, or 0 for no limit
+     */
+    inline void SetMaxVoices(uint32_t voices){
+        maxVoices = voices;
+    }
+    
+    inline uint32_t GetMaxVoices() const{
+        return maxVoices;
+    }
+};
 
 /**
  Player for AudioAssets
@@ -121,6 +170,15 @@ struct SampledAudioDataProvider : public AudioGraphComposed, public AudioDataPro
     
     uint64_t lastPlayTime = 0;
     
+private:
+    // the block of a compressed asset decoded last, so a render quantum inside one block decodes it once
+    Vector<float> decodedBlock;
+    uint32_t decodedBlockIndex = std::numeric_limits<uint32_t>::max();
+    const AudioAsset* decodedAsset = nullptr;
+    
+    void ProvideCompressedData(PlanarSampleBufferInlineView& buffer, uint64_t playhead_pos, float gain);
+    
+public:
     SampledAudioDataProvider(decltype(asset) a, uint8_t nchannels = 1);
     
     /**
@@ -146,6 +204,11 @@ struct SampledAudioDataProvider : public AudioGraphComposed, public AudioDataPro
      @param buffer output destination
      */
     void ProvideBufferData(PlanarSampleBufferInlineView& buffer, PlanarSampleBufferInlineView& scratchSpace) final;
+    
+    /**
+     The playhead follows the global audio time, so this only notices the end of the clip
+     */
+    void AdvanceSilently(PlanarSampleBufferInlineView& buffer, PlanarSampleBufferInlineView& scratchSpace) final;
 };
 
 /**
@@ -166,7 +229,7 @@ public:
         player = p;
     }
     
-    inline decltype(player) GetPlayer() const{
+    inline const decltype(player)& GetPlayer() const{
         return player;
     }
 
@@ -13,6 +13,7 @@
 #include "Filesystem.hpp"
 #include <api/resonance_audio_api.h>
 #include <common/room_properties.h>
+#include <mutex>
 
 struct _IPLBinauralEffect_t;
 struct _IPLDirectEffect_t;
@@ -80,6 +81,7 @@ public:
 
         SingleAudioRenderBuffer workingBuffers;
         SingleAudioRenderBufferNoScratch accumulationBuffer;
+        std::vector<std::unique_ptr<SingleAudioRenderBufferNoScratch>> partialMixes;     // when sources render in parallel, the mixes of all but the first chunk
 
 #if ENABLE_RINGBUFFERS
         AudioRingbuffer debugBuffer;
@@ -132,7 +134,8 @@ public:
             const matrix4& invRoomTransform);
 
         /**
-        Compute the Effect parameters for this room
+        Commit the sources, meshes and listener to the simulator. If the simulation thread is running, this does nothing and the
+        changes are committed next time.
         @param invRoomTranform the inverse of the room's world-space transformation matrix
         @param listenerForwardWorldSpace the forward vector for the listener in world space
         @param listenerUpWorldSpace the up vector for the listener in world space
@@ -147,8 +150,15 @@ public:
         @param roomPos the world-space position of the room
         @param invRoomTransform the inverse of the world-space transformation matrix for the room
         @param ownerID the world-local owner ID for the mesh
+        @param roomMoved whether invRoomTransform changed since the last quantum. If neither the room nor the mesh moved, this only looks up the mesh.
         */
-        void ConsiderMesh(Ref<AudioMeshAsset> mesh, const matrix4& transform, const vector3& roomPos, const matrix4& invRoomTransform, entity_t ownerID);
+        void ConsiderMesh(Ref<AudioMeshAsset> mesh, const matrix4& transform, const vector3& roomPos, const matrix4& invRoomTransform, entity_t ownerID, bool roomMoved);
+
+        /**
+        Simulate the last committed state and publish the results for RenderAudioSource. Invoked by the AudioPlayer's simulation
+        thread, at a lower rate than audio is rendered.
+        */
+        void Simulate();
 
         void RenderAudioSource(
             PlanarSampleBufferInlineView& outBuffer, PlanarSampleBufferInlineView& scratchBuffer,
@@ -161,23 +171,31 @@ public:
     private:
         float sourceRadius = 10, meshRadius = 10;
 
+        struct SimulationResults;
+
         struct SteamAudioSourceConfig {
             _IPLSource_t* source = nullptr;
             _IPLDirectEffect_t* directEffect = nullptr;
             _IPLPathEffect_t* pathEffect = nullptr;
             _IPLBinauralEffect_t* binauralEffect = nullptr; //NOTE: this will be replaced by pathEffect at some point
+            std::shared_ptr<SimulationResults> results;
             vector3 roomSpacePos{ 0,0,0 };
+            bool added = false;     // to the simulator
         };
 
         // must be called when destroying a SteamAudioSourceConfig
         void DestroySteamAudioSourceConfig(SteamAudioSourceConfig&);
 
+        void SetSourceInputs(const SteamAudioSourceConfig&);
+
         locked_hashmap<entity_id_t, SteamAudioSourceConfig, SpinLock> steamAudioSourceData;
 
         struct SteamAudioMeshConfig {
             _IPLInstancedMesh_t* instancedMesh = nullptr;
-            vector3 lastPos{ 0,0,0 };
-            quaternion lastRot{ 0,0,0,0 };
+            matrix4 lastWorldTransform{ 1 };
+            matrix4 transformInRoomSpace{ 1 };
+            bool added = false;     // to the scene
+            bool transformDirty = false;
         };
 
         // must be called when destroying a SteamAudioMeshConfig
@@ -188,8 +206,18 @@ public:
         _IPLSimulator_t* steamAudioSimulator = nullptr;
         _IPLScene_t* rootScene = nullptr;
 
+        // held while the simulator runs or changes. Changes made while the simulation thread holds it wait for the next commit.
+        std::mutex simulationMtx;
+        std::vector<std::shared_ptr<SimulationResults>> simulatedSources;     // what the simulation thread publishes to, rebuilt when sources change
+        std::vector<_IPLSource_t*> removedSources;
+        std::vector<_IPLInstancedMesh_t*> removedMeshes;
+        bool sourcesChanged = false;
+        bool committed = false;
+        matrix4 lastInvRoomTransform{ 0 };     // to tell if the room moved, so its meshes must be placed again
+
         SingleAudioRenderBuffer workingBuffers;
         SingleAudioRenderBufferNoScratch accumulationBuffer;
+        std::vector<std::unique_ptr<SingleAudioRenderBufferNoScratch>> partialMixes;     // see SimpleAudioSpace::RoomData
     };
 
     const auto GetData() const {
@@ -218,7 +246,7 @@ public:
         return data->meshRadius;
     }
 
-    GeometryAudioSpace(Entity owner) : ComponentWithOwner(owner), data(std::make_shared<RoomData>()) {}
+    GeometryAudioSpace(Entity owner);
 
     void DebugDraw(RavEngine::DebugDrawer& dbg, const RavEngine::Transform& tr) const override {}
 private:
@@ -0,0 +1,56 @@
+#pragma once
+#if !RVE_SERVER
+#include "AudioSource.hpp"
+#include <memory>
+#include <string>
+
+namespace RavEngine{
+
+/**
+ Player for long audio files, such as music and ambience. Unlike an AudioAsset, the file is not decoded up front. It is kept
+ compressed in memory, and is decoded and resampled a little ahead of the playhead on the App's executor, into a ring buffer
+ that the audio thread reads. WAV and Ogg Vorbis files are decoded incrementally. Other formats are decoded whole on first Play.
+ */
+struct StreamingAudioDataProvider : public AudioGraphComposed, public AudioDataProvider{
+    /**
+     @param name the file name to load, in the sounds directory like AudioAsset
+     @param nchannels the number of channels to play, converting from the file's if needed
+     @param bufferSeconds how far ahead of the playhead to decode
+     */
+    StreamingAudioDataProvider(const std::string& name, uint8_t nchannels = 1, double bufferSeconds = 1);
+    
+    /**
+     Start decoding, so the start of the file is ready before the first Play
+     */
+    void Prefetch();
+    
+    /**
+     Begin playing, decoding ahead first if Prefetch was not invoked
+     */
+    void Play() final;
+    
+    /**
+     Move the playhead to the beginning of the file. This does not trigger it to begin playing.
+     */
+    void Restart() final;
+    
+    /**
+     @return the length of the file in seconds
+     */
+    double GetLength() const;
+    
+    /**
+     Copy the decoded samples ahead of the playhead. If decoding has fallen behind, the rest of the buffer is silent.
+     @param buffer output destination
+     */
+    void ProvideBufferData(PlanarSampleBufferInlineView& buffer, PlanarSampleBufferInlineView& scratchSpace) final;
+    
+    struct Stream;
+private:
+    std::shared_ptr<Stream> stream;     // shared with the decode tasks, which may outlive this
+    
+    void ScheduleDecode();
+};
+
+}
+#endif
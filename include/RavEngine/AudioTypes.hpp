@@ -2,6 +2,7 @@
 #include <span>
 #include "Ref.hpp"
 #include "DataStructures.hpp"
+#include "AudioKernels.hpp"
 
 namespace RavEngine{
     class AudioAsset;
@@ -95,18 +96,11 @@ namespace RavEngine{
     };
 
     inline void AdditiveBlendSamples(InterleavedSampleBufferView& A, const InterleavedSampleBufferView& B){
-        auto bounds = std::min(A.size(),A.size());
-#pragma omp simd
-        for(decltype(bounds) i = 0; i < bounds; i++){
-            A[i] += B[i];
-        }
+        AudioKernels::Add(A.data(), B.data(), std::min(A.size(),B.size()));
     }
     inline void AdditiveBlendSamples(PlanarSampleBufferInlineView& A, const PlanarSampleBufferInlineView& B){
         for(uint8_t c = 0; c < std::min(A.GetNChannels(),B.GetNChannels()); c++){
-#pragma omp simd
-            for(size_t i = 0; i < A.sizeOneChannel();i++){
-                A[c][i] += B[c][i];
-            }
+            AudioKernels::Add(A[c].data(), B[c].data(), A.sizeOneChannel());
         }
     }
 
@@ -114,7 +108,7 @@ namespace RavEngine{
     struct AudioGraphComposed{
         using effect_graph_ptr_t = Ref<AudioGraphAsset>;
     private:
-        void renderImpl(PlanarSampleBufferInlineView& inputBuffer, PlanarSampleBufferInlineView& scratchBuffer, uint8_t nchannels);
+        void renderImpl(PlanarSampleBufferInlineView& inputBuffer, PlanarSampleBufferInlineView& scratchBuffer, uint8_t nchannels, bool skipLeadingGain);
         effect_graph_ptr_t effectGraph;
     public:
         
@@ -130,9 +124,15 @@ namespace RavEngine{
          Render the graph in-place, using provided memory for scratch space
          @param inputSamples the input buffer to apply the effect graph to. Contents will be modified after this function.
          @param intermediateBuffer memory of equal size to inputSamples to store intermediate data. Assumed to be zero-filled.
+         @param skipLeadingGain true if inputSamples were already scaled by GetLeadingGain
          */
-        void Render(PlanarSampleBufferInlineView& inputSamples, PlanarSampleBufferInlineView& intermediateBuffer, uint8_t nchannels){
-            renderImpl(inputSamples, intermediateBuffer, nchannels);
+        void Render(PlanarSampleBufferInlineView& inputSamples, PlanarSampleBufferInlineView& intermediateBuffer, uint8_t nchannels, bool skipLeadingGain = false){
+            renderImpl(inputSamples, intermediateBuffer, nchannels, skipLeadingGain);
         }
+        
+        /**
+         @return the gain that the graph applies before any other layer, 1 if there is none
+         */
+        float GetLeadingGain() const;
     };
 }
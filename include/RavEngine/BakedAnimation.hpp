@@ -0,0 +1,71 @@
+#pragma once
+#include "Ref.hpp"
+#include "Vector.hpp"
+#include <span>
+#include <cstdint>
+#if !RVE_SERVER
+#include <RGL/Types.hpp>
+#endif
+
+namespace RavEngine {
+	class SkeletonAsset;
+	struct IAnimGraphable;
+
+	/**
+	 Clips sampled ahead of time into a GPU buffer of skinning matrices, a frame at a time. Entities with a BakedAnimatorComponent
+	 instead of an AnimatorComponent are posed by the skinning shader reading a frame from the buffer, so they cost no CPU animation
+	 time, and entities showing the same frame are skinned once. For crowds, where state machines and blending are not needed.
+	 */
+	class BakedAnimation {
+	public:
+		struct Clip {
+			Ref<IAnimGraphable> clip;
+			float duration = 0;		// in seconds
+			bool looping = true;
+		};
+
+		/**
+		 Sample the clips and upload the frames
+		 @param skeleton the skeleton the clips animate. Meshes using the baked animation must use it too.
+		 @param framesPerSecond the sampling rate. Frames are not interpolated, so lower rates look choppier but share more skinning.
+		 */
+		BakedAnimation(Ref<SkeletonAsset> skeleton, std::span<const Clip> clips, float framesPerSecond = 30);
+		~BakedAnimation();
+
+		/**
+		 @param time in seconds since the clip started
+		 @return the index of the first matrix of the clip's frame at the time
+		 */
+		uint32_t GetFrameOffset(uint16_t clip, double time) const;
+
+		uint16_t GetNumClips() const {
+			return uint16_t(clips.size());
+		}
+
+		const auto& GetSkeleton() const {
+			return skeleton;
+		}
+
+#if !RVE_SERVER
+		/**
+		 @return the skinning matrices, one per joint per frame. For internal use only.
+		 */
+		const auto& GetBuffer() const {
+			return matrices;
+		}
+#endif
+
+	private:
+		struct ClipRange {
+			uint32_t firstFrame = 0, numFrames = 0;
+			bool looping = true;
+		};
+		Vector<ClipRange> clips;
+		Ref<SkeletonAsset> skeleton;
+		float framesPerSecond;
+		uint32_t numJoints;
+#if !RVE_SERVER
+		RGLBufferPtr matrices;
+#endif
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "CTTI.hpp"
+#include "Ref.hpp"
+#include "App.hpp"
+
+namespace RavEngine {
+	class BakedAnimation;
+
+	/**
+	 Plays a clip of a BakedAnimation on a SkinnedMeshComponent, in place of an AnimatorComponent. The renderer chooses the frame
+	 from the app time, so there is nothing to tick.
+	 */
+	struct BakedAnimatorComponent : public AutoCTTI {
+		Ref<BakedAnimation> animation;
+		double startTime = 0;		// in app time. Give instances of a clip different start times so they do not move in step.
+		float speed = 1;
+		uint16_t clip = 0;
+
+		BakedAnimatorComponent(Ref<BakedAnimation> animation, uint16_t clip = 0, double startTime = 0) : animation(animation), startTime(startTime), clip(clip) {}
+
+		/**
+		 Switch to a clip, from its beginning
+		 */
+		void Play(uint16_t newClip) {
+			clip = newClip;
+			startTime = GetApp()->GetCurrentTime();
+		}
+
+		/**
+		 @return the time into the current clip, in seconds
+		 */
+		double GetClipTime() const {
+			return (GetApp()->GetCurrentTime() - startTime) * speed;
+		}
+	};
+}
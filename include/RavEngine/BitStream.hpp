@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+namespace RavEngine {
+
+	/**
+	 Writes values of any bit width, least significant bit first, into a fixed buffer. The buffer must start zeroed.
+	 */
+	class BitWriter {
+		std::span<uint8_t> buffer;
+		size_t bitOffset = 0;
+	public:
+		BitWriter(std::span<uint8_t> buffer) : buffer(buffer) {}
+
+		/**
+		 Write the low bits of a value
+		 @param nbits at most 32
+		 @return false if the buffer is full, in which case nothing is written
+		 */
+		bool Write(uint32_t value, uint8_t nbits) {
+			if (bitOffset + nbits > buffer.size() * 8) {
+				return false;
+			}
+			for (uint8_t i = 0; i < nbits; i++, bitOffset++) {
+				if (value & (1u << i)) {
+					buffer[bitOffset / 8] |= uint8_t(1u << (bitOffset % 8));
+				}
+			}
+			return true;
+		}
+
+		size_t BitsWritten() const {
+			return bitOffset;
+		}
+	};
+
+	/**
+	 Reads values written by BitWriter
+	 */
+	class BitReader {
+		std::span<const uint8_t> buffer;
+		size_t bitOffset = 0;
+	public:
+		BitReader(std::span<const uint8_t> buffer) : buffer(buffer) {}
+
+		/**
+		 Read a value
+		 @param nbits at most 32
+		 @return false if the buffer is exhausted, in which case value is unchanged
+		 */
+		bool Read(uint32_t& value, uint8_t nbits) {
+			if (bitOffset + nbits > buffer.size() * 8) {
+				return false;
+			}
+			uint32_t result = 0;
+			for (uint8_t i = 0; i < nbits; i++, bitOffset++) {
+				if (buffer[bitOffset / 8] & (1u << (bitOffset % 8))) {
+					result |= 1u << i;
+				}
+			}
+			value = result;
+			return true;
+		}
+
+		size_t BitsRead() const {
+			return bitOffset;
+		}
+	};
+}
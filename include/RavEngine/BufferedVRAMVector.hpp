@@ -4,6 +4,10 @@
 #include "Function.hpp"
 #include "VRAMSparseSet.hpp"
 #include "Types.hpp"
+#include "DirtyBitset.hpp"
+#include "MemoryTracking.hpp"
+#include <span>
+#include <atomic>
 
 namespace RavEngine{
 
@@ -12,9 +16,14 @@ class BufferedVRAMStructureBase{
 protected:
     RGLBufferPtr privateBuffer;
     std::string debugName;
-    std::vector<unsigned char> syncTrackingBuffer;
+    DirtyBitset syncTracking;
+    MemoryTracking::Pool* memoryPool = nullptr;     // named after debugName, found when the private buffer is first created
+    static std::atomic<uint64_t> totalPrivateBytes;
 
-    void EncodeSync(RGLDevicePtr device, RGLBufferPtr hostBuffer, RGLCommandBufferPtr commandBuffer, uint32_t elemSize, const Function<void(RGLBufferPtr)>& gcBuffersFn, bool& previousCommandResetCB);
+    void TrackPrivateBuffer();
+    void UntrackPrivateBuffer();
+
+    void EncodeSync(RGLDevicePtr device, RGLBufferPtr hostBuffer, RGLCommandBufferPtr commandBuffer, uint32_t elemSize, FunctionRef<void(RGLBufferPtr)> gcBuffersFn, bool& previousCommandResetCB);
     
     void InitializePrivateBuffer(RGLDevicePtr device, uint32_t size);
 
@@ -22,6 +31,13 @@ public:
     auto GetPrivateBuffer() const{
         return privateBuffer;
     }
+
+    /**
+     @return the size of the private buffers of every BufferedVRAMVector and BufferedVRAMSparseSet together, in bytes
+     */
+    static uint64_t GetTotalPrivateBytes() {
+        return totalPrivateBytes.load(std::memory_order_relaxed);
+    }
     BufferedVRAMStructureBase() {}
     BufferedVRAMStructureBase(const std::string_view debugName) : debugName(debugName) {}
 
@@ -54,29 +70,27 @@ public:
      @note This function may change the value returned by GetPrivateBuffer(). Do not call GetPrivateBuffer() until after calling EncodeSync.
      @return true if commands were encoded
      */
-    void EncodeSync(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, const Function<void(RGLBufferPtr)>& gcBuffersFn, bool& previousCommandResetCB){
+    void EncodeSync(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, FunctionRef<void(RGLBufferPtr)> gcBuffersFn, bool& previousCommandResetCB){
         BufferedVRAMStructureBase::EncodeSync(device, hostBuffer.buffer, commandBuffer, sizeof(T), gcBuffersFn,  previousCommandResetCB);
     }
     
     void Resize(uint32_t newSize){
         if (hostBuffer.size() != newSize){
             hostBuffer.resize(newSize);
-            syncTrackingBuffer.resize(newSize, true);   // ensure the initial copy is included
+            syncTracking.Resize(newSize, true);   // ensure the initial copy is included
         }
     }
     
     void push_back(const T& value){
         hostBuffer.push_back(value);
-        syncTrackingBuffer.resize(hostBuffer.size(), true);
+        syncTracking.Resize(hostBuffer.size(), true);
     }
     
     void erase(const auto& it){
         hostBuffer.erase(it);
         auto index = it - hostBuffer.begin();
         // elements have been shifted down, so mark all elements afterward as modified
-        for(auto it = syncTrackingBuffer.begin() + index; it != syncTrackingBuffer.end(); ++it){
-            *it = true;
-        }
+        syncTracking.SetRange(index, syncTracking.size());
     }
     
     auto begin(){
@@ -85,7 +99,7 @@ public:
     
     void reserve(uint32_t size){
         hostBuffer.reserve(size);
-        syncTrackingBuffer.reserve(size);
+        syncTracking.Reserve(size);
     }
     
     auto Size() const{
@@ -98,14 +112,26 @@ public:
     
     void SetValueAt(uint32_t i, const T& value){
         hostBuffer[i] = value;
-        syncTrackingBuffer[i] = true;    // signal that this was modified
+        syncTracking.Set(i);    // signal that this was modified
     }
     
     auto& GetValueAtForWriting(uint32_t i){
-        syncTrackingBuffer[i] = true;   // signal that this was modified
+        syncTracking.Set(i);   // signal that this was modified
         return hostBuffer[i];
     }
 
+    /**
+     Mark a set of elements as modified and get the host data for writing them in place. Intended for batch writers.
+     @param modifiedIndices the indices that will be written
+     @return pointer to element 0 of the host buffer
+     */
+    T* GetHostDataForWriting(std::span<const uint32_t> modifiedIndices){
+        for (const auto i : modifiedIndices){
+            syncTracking.Set(i);
+        }
+        return hostBuffer.data();
+    }
+
 };
 
 /**
@@ -116,8 +142,8 @@ class BufferedVRAMSparseSet : public BufferedVRAMStructureBase{
     VRAMSparseSet<index_t, T> sparseSet;
     
     void ResizeIfNeeded(){
-        if (sparseSet.DenseSize() > syncTrackingBuffer.size()){
-            syncTrackingBuffer.resize(sparseSet.DenseSize(), true);   // ensure the initial copy is included
+        if (sparseSet.DenseSize() > syncTracking.size()){
+            syncTracking.Resize(sparseSet.DenseSize(), true);   // ensure the initial copy is included
         }
     }
     
@@ -140,11 +166,11 @@ public:
     void Emplace(index_t sparse_index, A&& ... args) {
         sparseSet.Emplace(sparse_index, std::forward<A>(args) ...);
         ResizeIfNeeded();
-        syncTrackingBuffer[sparseSet.SparseToDense(sparse_index)] = true;   // mark modified
+        syncTracking.Set(sparseSet.SparseToDense(sparse_index));   // mark modified
     }
     
     void EraseAtSparseIndex(index_t sparseIndex){
-        syncTrackingBuffer[sparseSet.SparseToDense(sparseIndex)] = true;   // mark modified
+        syncTracking.Set(sparseSet.SparseToDense(sparseIndex));   // mark modified
         sparseSet.EraseAtSparseIndex(sparseIndex);
     }
     
@@ -166,7 +192,7 @@ public:
     
     auto& GetHostDenseForWriting(index_t dense_index){
         ResizeIfNeeded();
-        syncTrackingBuffer[dense_index] = true;
+        syncTracking.Set(dense_index);
         return sparseSet.GetDense()[dense_index];
     }
     
@@ -176,7 +202,7 @@ public:
     
     auto& GetForSparseIndexForWriting(index_t sparse_index){
         ResizeIfNeeded();
-        syncTrackingBuffer[sparseSet.SparseToDense(sparse_index)] = true;
+        syncTracking.Set(sparseSet.SparseToDense(sparse_index));
         return sparseSet.GetForSparseIndex(sparse_index);
     }
     
@@ -186,7 +212,7 @@ public:
      @note This function may change the value returned by GetPrivateBuffer(). Do not call GetPrivateBuffer() until after calling EncodeSync.
      @return true if commands were encoded
      */
-    void EncodeSync(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, const Function<void(RGLBufferPtr)>& gcBuffersFn, bool& previousCommandResetCB){
+    void EncodeSync(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, FunctionRef<void(RGLBufferPtr)> gcBuffersFn, bool& previousCommandResetCB){
         if (privateBuffer == nullptr){
             InitializePrivateBuffer(device, 8 * sizeof(T));
         }
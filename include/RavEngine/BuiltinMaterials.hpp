@@ -2,6 +2,7 @@
 #if !RVE_SERVER
 #include "Material.hpp"
 #include "Common3D.hpp"
+#include "MeshAsset.hpp"
 #include <variant>
 
 namespace RavEngine {
@@ -75,6 +76,89 @@ namespace RavEngine {
 		PBRPushConstantData pushConstantData;
 	};
 
+	// matches impostor_shared.glsl
+	struct ImpostorPushConstantData {
+		glm::vec3 center{ 0 };
+		float radius = 1;
+		uint32_t framesPerSide = 2;
+		uint32_t hemisphere = 0;
+		float roughness = 0.8;
+		float specular = 0.5;
+	};
+
+	/**
+	 Draws a mesh's impostor quad, textured from the atlases rvemc baked for it. See ImpostorEncoding and MeshCollectionStatic::SetImpostor.
+	 */
+	struct ImpostorMaterial : public LitMaterial {
+		ImpostorMaterial();
+	};
+
+	class ImpostorMaterialInstance : public MaterialInstance {
+	public:
+		/**
+		 @param impostor the quad's atlases, see MeshAsset::GetPackedImpostor
+		 */
+		ImpostorMaterialInstance(Ref<ImpostorMaterial> m, const MeshAsset::PackedImpostor& impostor, uint32_t priority = 0);
+
+		void SetAlbedoAtlas(Ref<Texture> texture) {
+			textureBindings[1] = texture;
+		}
+		void SetNormalDepthAtlas(Ref<Texture> texture) {
+			textureBindings[2] = texture;
+		}
+		void SetRoughness(float r) {
+			pushConstantData.roughness = r;
+		}
+		void SetSpecular(float s) {
+			pushConstantData.specular = s;
+		}
+
+		virtual const RGL::untyped_span GetPushConstantData() const override {
+			return pushConstantData;
+		}
+	private:
+		ImpostorPushConstantData pushConstantData;
+	};
+
+	// layout matches materials/terrain_shared.glsl
+	struct TerrainPushConstantData {
+		glm::vec2 tileOrigin{ 0 };		// world XZ of the tile's sample (0, 0)
+		float tileSize = 1;
+		uint32_t resolution = 2;		// samples along a side of the height texture
+		float skirtDepth = 1;
+		float layerTiling = 0.1;		// repeats of the layer textures per world unit
+		float roughness = 0.9;
+		float specular = 0.3;
+	};
+
+	/**
+	 Draws the patches of a Terrain tile. The vertex shader places each vertex of the patch grid on the tile's height texture,
+	 and the fragment shader blends four layer textures by the tile's splat map. See Terrain.
+	 */
+	struct TerrainMaterial : public LitMaterial {
+		TerrainMaterial();
+	};
+
+	class TerrainMaterialInstance : public MaterialInstance {
+	public:
+		/**
+		 @param heights R32 float heights, in world units
+		 @param normals RGBA8 surface normals, mapped from [-1, 1]
+		 @param splat RGBA8 weights of the four layers
+		 */
+		TerrainMaterialInstance(Ref<TerrainMaterial> m, Ref<Texture> heights, Ref<Texture> normals, Ref<Texture> splat, const TerrainPushConstantData& data, uint32_t priority = 0);
+
+		void SetLayerTexture(uint8_t layer, Ref<Texture> texture) {
+			textureBindings[4 + layer] = texture;
+		}
+
+		virtual const RGL::untyped_span GetPushConstantData() const override {
+			return pushConstantData;
+		}
+	private:
+		TerrainPushConstantData pushConstantData;
+	};
+
    
 }
 
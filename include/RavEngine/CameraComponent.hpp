@@ -120,11 +120,43 @@ namespace RavEngine {
 
 		Ref<TonemapPassInstance> tonemap;
 		IndirectLightingSettings indirectLightingSettings;
-		
+		CameraFeatureSettings features;
+		FoveationSettings foveation;
+
+		// how often a camera with a target is rendered. Cameras rendering to the screen render every frame.
+		enum class UpdateMode : uint8_t {
+			EveryNFrames,	// render one frame out of every updateInterval
+			OnDemand		// render only after RequestRender
+		};
+		UpdateMode updateMode = UpdateMode::EveryNFrames;
+		uint16_t updateInterval = 1;
+
+		/**
+		Render the target on the next frame, regardless of updateMode. Targets always render on the camera's first frame.
+		*/
+		constexpr inline void RequestRender(){
+			renderRequested = true;
+		}
+
+		/**
+		Advance the update policy by a frame. For internal use only.
+		@return true if the target should be rendered this frame
+		*/
+		constexpr inline bool AdvanceTargetUpdate(){
+			framesSinceRender++;
+			if (renderRequested || (updateMode == UpdateMode::EveryNFrames && framesSinceRender >= updateInterval)){
+				renderRequested = false;
+				framesSinceRender = 0;
+				return true;
+			}
+			return false;
+		}
 
 	protected:
         Mode projection = Mode::Perspective;
 		bool active = false;
+		bool renderRequested = true;
+		uint16_t framesSinceRender = 0;
 	};
 }
 #endif
@@ -0,0 +1,58 @@
+#pragma once
+#include "Ref.hpp"
+#include "Vector.hpp"
+#include <cstdint>
+#include <span>
+
+namespace physx {
+	class PxTriangleMesh;
+	class PxConvexMesh;
+}
+
+namespace RavEngine {
+	class MeshAsset;
+
+	/**
+	 Cooked PhysX meshes, shared by every MeshCollider and ConvexMeshCollider made from the same MeshAsset. Cooking is slow, so meshes
+	 can also be cooked ahead of time with Serialize, stored with the game's assets, and handed back with Deserialize before the
+	 colliders are created. Deserialized meshes do not need the MeshAsset to keep a system RAM copy. Thread safe.
+	 */
+	struct CollisionMeshCache {
+		enum class Type : uint8_t {
+			Triangle,
+			Convex
+		};
+
+		/**
+		 @return the cooked triangle mesh for the asset, cooking it if it is not cached. The cache keeps its own reference.
+		 */
+		static physx::PxTriangleMesh* GetTriangleMesh(const Ref<MeshAsset>& mesh);
+
+		/**
+		 @return the cooked convex hull of the asset, cooking it if it is not cached. The cache keeps its own reference.
+		 */
+		static physx::PxConvexMesh* GetConvexMesh(const Ref<MeshAsset>& mesh);
+
+		/**
+		 Cook the asset into the binary format that Deserialize reads. The data is specific to the PhysX version.
+		 @pre the MeshAsset keeps a system RAM copy
+		 */
+		static Vector<uint8_t> Serialize(const Ref<MeshAsset>& mesh, Type type);
+
+		/**
+		 Cache data made by Serialize for the asset, so colliders made from it do not cook.
+		 @return false if the data is not valid, or was cooked as another type
+		 */
+		static bool Deserialize(const Ref<MeshAsset>& mesh, Type type, std::span<const uint8_t> data);
+
+		/**
+		 Release the meshes of assets that no longer exist. Colliders keep their own references.
+		 */
+		static void Compact();
+
+		/**
+		 Release every cached mesh. Invoked by PhysicsSolver::ReleaseStatics.
+		 */
+		static void Clear();
+	};
+}
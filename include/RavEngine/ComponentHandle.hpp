@@ -60,6 +60,46 @@ namespace RavEngine{
         }
     };
 
+    /**
+     A ComponentHandle that remembers where its component is. Dereferencing it compares the set's relocation counter
+     with the one seen at the last lookup, and only looks the component up again if components in the set have moved since.
+     Dereferencing the same handle from multiple threads at once is not safe, since it refreshes the cache.
+     */
+    template<typename T>
+    struct CachedComponentHandle : public ComponentHandle<T>{
+    private:
+        T* cached = nullptr;
+        const uint32_t* relocationVersion = nullptr;
+        uint32_t cachedVersion = 0;
+    public:
+        using ComponentHandle<T>::ComponentHandle;
+        CachedComponentHandle(){}
+        CachedComponentHandle(const ComponentHandle<T>& handle) : ComponentHandle<T>(handle){}
+
+        inline T* operator->(){
+            return get();
+        }
+
+        inline T* get(){
+            if (cached != nullptr && *relocationVersion == cachedVersion) [[likely]] {
+                return cached;
+            }
+            cached = &this->owner.template GetComponentForCache<T>(relocationVersion);
+            cachedVersion = *relocationVersion;
+            return cached;
+        }
+
+        template<typename U>
+        inline U* get_as(){
+            return static_cast<U*>(get());
+        }
+
+        inline void reset(){
+            ComponentHandle<T>::reset();
+            cached = nullptr;
+        }
+    };
+
     template<typename Base>
     struct PolymorphicComponentHandle : ComponentHandleBase{
         ctti_t full_type_id;
@@ -105,6 +145,9 @@ namespace std{
         }
     };
 
+    template<typename T>
+    struct hash<RavEngine::CachedComponentHandle<T>> : hash<RavEngine::ComponentHandle<T>>{};
+
 template<typename T>
 struct hash<RavEngine::PolymorphicComponentHandle<T>>{
     inline size_t operator()(const RavEngine::PolymorphicComponentHandle<T>& ch) const{
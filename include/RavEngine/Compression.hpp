@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <span>
+
+namespace RavEngine::Compression {
+
+	/**
+	 @return the most bytes Deflate can write for an input of this size
+	 */
+	size_t DeflateBound(size_t size);
+
+	/**
+	 Compress with zlib deflate
+	 @param output at least DeflateBound(input.size()) bytes
+	 @param level 0 (store) to 9 (smallest)
+	 @return the number of bytes written
+	 */
+	size_t Deflate(std::span<const std::byte> input, std::span<std::byte> output, int level = 6);
+
+	/**
+	 Decompress data made by Deflate
+	 @param output exactly the uncompressed size
+	 @return false if the data is malformed or does not decompress to the size of output
+	 */
+	bool Inflate(std::span<const std::byte> input, std::span<std::byte> output);
+}
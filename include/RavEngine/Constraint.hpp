@@ -55,11 +55,12 @@ public:
 struct SocketConstraint : public Constraint, public QueryableDelta<Constraint,SocketConstraint>{
 	using QueryableDelta<Constraint,SocketConstraint>::GetQueryTypes;
 	std::string boneTarget;
+	uint16_t socket = 0;	// the target's AnimatorComponent::SocketHandle for the bone
 	SocketConstraint(Entity id, decltype(target), const decltype(boneTarget)& );
 };
 
 /**
- Executes all Socket Constraints
+ Executes all Socket Constraints. The animators compute their socket matrices in parallel, so this serial pass only copies them.
  */
 struct SocketSystem{
 	void operator()(const SocketConstraint&, Transform&);
@@ -3,10 +3,14 @@
 #include "SpinLock.hpp"
 #include "Function.hpp"
 #include "Ref.hpp"
+#include "Vector.hpp"
+#include <array>
+#include <glm/mat4x4.hpp>
 
 namespace  RavEngine {
 
 class MeshAsset;
+class RenderEngine;
 
 class DebugDrawer{
 public:
@@ -62,9 +66,40 @@ public:
      */
     void DrawArrow(const vector3& start, const vector3& end, const color_t color);
 
+    /**
+     Render a line. Lines are batched, so all of them are drawn at once.
+     @param start the begin coordinate for the line
+     @param end the end coordinate for the line
+     @param color the color of the line
+     */
+    void DrawLine(const vector3& start, const vector3& end, const color_t color);
+
 	void DrawWireframeMesh(const matrix4& transform, const Ref<MeshAsset>& mesh);
     
 private:
+	friend class RenderEngine;
+
+	// boxes, spheres, cylinders and capsules are drawn as instances of a unit shape, instead of being tessellated on the CPU every frame
+	enum UnitShape : uint8_t {
+		UnitBox,			// [-0.5, 0.5] on each axis
+		UnitSphere,			// radius 1 around the origin
+		UnitCylinder,		// radius 1, from y = 0 to y = 1
+		UnitShapeCount
+	};
+	struct ShapeInstance {
+		glm::mat4 transform;	// from the unit shape to world space, including the shape's dimensions
+		uint32_t color;
+	};
+	std::array<Vector<ShapeInstance>, UnitShapeCount> shapeInstances;
+
+	// the same layout as Im3d::VertexData, so lines share its pipeline
+	struct LineVertex {
+		glm::vec4 position;		// w is unused
+		uint32_t color;
+	};
+	Vector<LineVertex> lineVertices;
+
+	void AddShape(UnitShape shape, const matrix4& transform, color_t color);
 	
 	SpinLock mtx;
 	/**
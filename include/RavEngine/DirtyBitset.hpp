@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace RavEngine {
+    /**
+     One bit per element marking it as modified. Marking is safe from multiple threads at once.
+     Consuming scans a word at a time, so a mostly clean set costs 1/64th of a per-element scan,
+     and hands back coalesced ranges to copy.
+     */
+    class DirtyBitset {
+        std::vector<uint64_t> words;
+        uint32_t nBits = 0;
+
+        constexpr static uint32_t bitsPerWord = 64;
+
+    public:
+        uint32_t size() const {
+            return nBits;
+        }
+
+        /**
+         Change the number of tracked elements
+         @param newSize the new number of elements
+         @param markNew if true, elements added by growing are marked
+         */
+        void Resize(uint32_t newSize, bool markNew) {
+            const auto oldSize = nBits;
+            words.resize((newSize + bitsPerWord - 1) / bitsPerWord, 0);
+            nBits = newSize;
+            if (newSize > oldSize && markNew) {
+                SetRange(oldSize, newSize);
+            }
+            else if (newSize < oldSize && newSize % bitsPerWord != 0) {
+                // bits past the end must stay clear, so ranges never extend beyond the size
+                words.back() &= (uint64_t(1) << (newSize % bitsPerWord)) - 1;
+            }
+        }
+
+        void Reserve(uint32_t n) {
+            words.reserve((n + bitsPerWord - 1) / bitsPerWord);
+        }
+
+        void Set(uint32_t i) {
+            std::atomic_ref<uint64_t>(words[i / bitsPerWord]).fetch_or(uint64_t(1) << (i % bitsPerWord), std::memory_order_relaxed);
+        }
+
+        /**
+         Mark [begin, end). Not safe to call concurrently with Set on the same words.
+         */
+        void SetRange(uint32_t begin, uint32_t end) {
+            while (begin < end && begin % bitsPerWord != 0) {
+                words[begin / bitsPerWord] |= uint64_t(1) << (begin % bitsPerWord);
+                begin++;
+            }
+            while (end - begin >= bitsPerWord) {
+                words[begin / bitsPerWord] = ~uint64_t(0);
+                begin += bitsPerWord;
+            }
+            while (begin < end) {
+                words[begin / bitsPerWord] |= uint64_t(1) << (begin % bitsPerWord);
+                begin++;
+            }
+        }
+
+        bool Test(uint32_t i) const {
+            return (words[i / bitsPerWord] >> (i % bitsPerWord)) & 1;
+        }
+
+        /**
+         Visit every marked range in ascending order and clear the set
+         @param maxGap ranges separated by at most this many unmarked elements are merged, trading a little extra copying for fewer copies
+         @param fn called with [begin, end) of each merged range
+         */
+        template<typename Fn>
+        void ConsumeRanges(uint32_t maxGap, const Fn& fn) {
+            uint32_t rangeBegin = 0, rangeEnd = 0;
+            bool open = false;
+            const auto nWords = static_cast<uint32_t>(words.size());
+            for (uint32_t w = 0; w < nWords; w++) {
+                auto bits = words[w];
+                if (bits == 0) {
+                    continue;
+                }
+                words[w] = 0;
+                while (bits != 0) {
+                    const uint32_t start = std::countr_zero(bits);
+                    const auto shifted = bits >> start;
+                    const uint32_t length = ~shifted == 0 ? bitsPerWord - start : std::countr_zero(~shifted);
+                    const auto begin = w * bitsPerWord + start, end = begin + length;
+                    if (open && begin <= rangeEnd + maxGap) {
+                        rangeEnd = end;
+                    }
+                    else {
+                        if (open) {
+                            fn(rangeBegin, rangeEnd);
+                        }
+                        rangeBegin = begin;
+                        rangeEnd = end;
+                        open = true;
+                    }
+                    bits = start + length >= bitsPerWord ? 0 : bits & ~(((uint64_t(1) << length) - 1) << start);
+                }
+            }
+            if (open) {
+                fn(rangeBegin, rangeEnd);
+            }
+        }
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+
+namespace RavEngine {
+    struct DynamicResolutionConfig {
+        float targetFrameTimeMs = 1000.f / 60.f;
+        float headroom = 0.9f;                  // the fraction of the target frame time the GPU should stay under
+        float minScale = 0.5f, maxScale = 1.f;
+        float maxIncreasePerFrame = 0.05f;
+        uint8_t framesBeforeIncrease = 8;
+    };
+
+    /**
+     Picks the fraction of the output resolution to render the scene at, from the GPU time of the previous frames.
+     Rendering cost is assumed to scale with the number of pixels, so the scale moves by the square root of how far the
+     frame is from its budget. It drops as soon as a frame runs over, so load spikes do not miss the display's refresh,
+     and only climbs back after several frames in a row fit, a little at a time, so it does not oscillate.
+     */
+    class DynamicResolutionController {
+    public:
+        using Config = DynamicResolutionConfig;
+
+        DynamicResolutionController(const Config& config = {}) : config(config), scale(config.maxScale) {}
+
+        /**
+         Feed the GPU time of a completed frame
+         @param gpuFrameTimeMs the GPU time of the frame, in milliseconds. Frames without timings (0 or less) are ignored.
+         @return the scale to render the next frame at
+         */
+        float Update(float gpuFrameTimeMs);
+
+        /**
+         Change the config, and start over from the largest scale
+         */
+        void SetConfig(const Config& newConfig);
+
+        const Config& GetConfig() const {
+            return config;
+        }
+
+        /**
+         @return the fraction of the output width and height to render at, in [minScale, maxScale]
+         */
+        float GetScale() const {
+            return scale;
+        }
+
+    private:
+        Config config;
+        float scale;
+        uint8_t framesUnderBudget = 0;
+    };
+}
@@ -48,6 +48,22 @@ struct Entity : public AutoCTTI{
     T& GetComponent() const{
        return world->GetComponent<T>(id);
     }
+
+    /**
+     GetComponent, also returning a counter that changes when the component may have moved. Used by CachedComponentHandle.
+     */
+    template<typename T>
+    T& GetComponentForCache(const uint32_t*& relocationVersion) const{
+        return world->GetComponentForCache<T>(id, relocationVersion);
+    }
+
+    /**
+     Record that component T on this entity was modified, so that change-filtered queries visit it
+     */
+    template<typename T>
+    void MarkComponentChanged() const{
+        world->MarkComponentChanged<T>(id);
+    }
     
     entity_t GetID() const{
         return id;
@@ -70,6 +86,10 @@ struct Entity : public AutoCTTI{
         world->SetEntityRenderlayer(id, layers);
     }
 
+    renderlayer_t GetEntityRenderlayer() const{
+        return world->GetEntityRenderlayer(id);
+    }
+
     void SetEntityAttributes(perobject_t attributes) {
         world->SetEntityAttributes(id, attributes);
     }
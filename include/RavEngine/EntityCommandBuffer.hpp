@@ -0,0 +1,98 @@
+#pragma once
+#include "Entity.hpp"
+#include "Function.hpp"
+#include "Vector.hpp"
+#include "CTTI.hpp"
+
+namespace RavEngine {
+    /**
+     Records structural changes (entity creation and destruction, component emplace and destroy) so that they can be
+     made from Systems running in parallel. Each executor thread has its own buffer, obtained with World::GetCommandBuffer().
+     Recorded commands are applied in one batch at the end of the ECS portion of World::Tick, or when World::FlushCommandBuffers is called.
+     @note Commands targeting an entity that has been destroyed by the time of playback are skipped.
+     */
+    class EntityCommandBuffer {
+        friend class World;
+
+        // playback order: all instantiations, then component changes grouped by type, then entity destructions
+        enum class CommandType : uint8_t {
+            Instantiate,
+            ComponentOp,
+            Destroy
+        };
+
+        struct Command {
+            SmallFunction<void(World*)> apply;
+            ctti_t componentType = 0;
+            uint32_t sequence = 0;
+            CommandType type;
+        };
+
+        Vector<Command> commands;
+        uint32_t nextSequence = 0;
+
+        void Record(CommandType type, ctti_t componentType, SmallFunction<void(World*)>&& fn) {
+            commands.push_back({ std::move(fn), componentType, nextSequence++, type });
+        }
+
+        // entity handles can go stale between recording and playback
+        static bool IsLive(const Entity& e, World* world) {
+            return e.IsValid() && e.GetWorld() == world && world->CorrectVersion(e.GetID());
+        }
+
+    public:
+        /**
+         Instantiate an entity of type T during playback. Invokes the @code Create @endcode function of T.
+         @param args parameters to pass to @code Create @endcode. They are copied into the buffer.
+         */
+        template<typename T, typename ... A>
+        void Instantiate(A&& ... args) {
+            Record(CommandType::Instantiate, CTTI<T>(), [... args = std::forward<A>(args)](World* world) mutable {
+                world->Instantiate<T>(args...);
+            });
+        }
+
+        /**
+         Add a component to an entity during playback
+         @param entity the entity to add to
+         @param args parameters to pass to the component's constructor. They are copied into the buffer.
+         */
+        template<typename T, typename ... A>
+        void EmplaceComponent(Entity entity, A&& ... args) {
+            Record(CommandType::ComponentOp, CTTI<T>(), [entity, ... args = std::forward<A>(args)](World* world) mutable {
+                if (IsLive(entity, world)) {
+                    entity.EmplaceComponent<T>(args...);
+                }
+            });
+        }
+
+        /**
+         Remove a component from an entity during playback
+         @param entity the entity to remove from
+         */
+        template<typename T>
+        void DestroyComponent(Entity entity) {
+            Record(CommandType::ComponentOp, CTTI<T>(), [entity](World* world) {
+                if (IsLive(entity, world) && entity.HasComponent<T>()) {
+                    entity.DestroyComponent<T>();
+                }
+            });
+        }
+
+        /**
+         Destroy an entity during playback
+         @param entity the entity to destroy
+         */
+        void Destroy(Entity entity) {
+            Record(CommandType::Destroy, 0, [entity](World* world) mutable {
+                if (IsLive(entity, world)) {
+                    entity.Destroy();
+                }
+            });
+        }
+
+        bool empty() const {
+            return commands.empty();
+        }
+    };
+}
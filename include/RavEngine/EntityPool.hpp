@@ -0,0 +1,123 @@
+#pragma once
+#include "Entity.hpp"
+#include "Vector.hpp"
+#include "Function.hpp"
+#include "mathtypes.hpp"
+
+namespace RavEngine {
+
+    class EntityPoolBase {
+    protected:
+        struct Pooled {
+            entity_t id;
+            renderlayer_t layers = ALL_LAYERS;  // to restore when the entity is spawned again
+        };
+
+        /**
+         Hide an entity and take its physics bodies out of the simulation
+         @return the render layers it had
+         */
+        static renderlayer_t Deactivate(Entity entity);
+
+        /**
+         Undo Deactivate, and move the entity
+         */
+        static void Activate(Entity entity, renderlayer_t layers, const vector3& position, const quaternion& rotation);
+
+        /**
+         Move the entity's Transform, and its dynamic body, which does not follow its Transform
+         */
+        static void Place(Entity entity, const vector3& position, const quaternion& rotation);
+    };
+
+    /**
+     Recycles entities that are spawned and despawned many times a second, such as projectiles, hit effects and pickups.
+     Despawned entities stay alive with all their components, but are drawn on no render layer and have their physics bodies taken out
+     of the simulation. Spawning one again restores them and moves it, skipping the entity creation, component construction, mesh
+     render data registration and physics actor creation that Instantiate and Destroy pay on every cycle.
+     @note Systems still visit pooled entities. Use onDespawn and onSpawn to remove and re-add the components that drive gameplay, which are cheap.
+     @note The pool must be destroyed before its world.
+     */
+    template<typename T = Entity>
+    class EntityPool : public EntityPoolBase {
+    public:
+        using callback_t = Function<void(T)>;
+
+        EntityPool(World* world) : world(world) {}
+        EntityPool(const EntityPool&) = delete;
+        EntityPool& operator=(const EntityPool&) = delete;
+
+        ~EntityPool() {
+            Clear();
+        }
+
+        /**
+         Take an entity from the pool, or Instantiate a new one if the pool is empty
+         @param args parameters to pass to @code Create @endcode, for new entities only
+         */
+        template<typename ... A>
+        T Spawn(const vector3& position, const quaternion& rotation, A&& ... args) {
+            T entity;
+            if (pooled.empty()) {
+                entity = world->template Instantiate<T>(std::forward<A>(args)...);
+                Place(entity, position, rotation);
+            }
+            else {
+                const auto recycled = pooled.back();
+                pooled.pop_back();
+                entity.id = recycled.id;
+                entity.world = world;
+                Activate(entity, recycled.layers, position, rotation);
+            }
+            if (onSpawn) {
+                onSpawn(entity);
+            }
+            return entity;
+        }
+
+        /**
+         Return an entity to the pool, instead of destroying it. It must have come from Spawn or Reserve, and not be in the pool already.
+         */
+        void Despawn(T entity) {
+            if (onDespawn) {
+                onDespawn(entity);
+            }
+            pooled.push_back({ entity.GetID(), Deactivate(entity) });
+        }
+
+        /**
+         Fill the pool ahead of time, such as during a load screen, so that the first Spawns do not create entities
+         @param args parameters to pass to each @code Create @endcode
+         */
+        template<typename ... A>
+        void Reserve(uint32_t count, A&& ... args) {
+            auto entities = world->template InstantiateMany<T>(count, std::forward<A>(args)...);
+            pooled.reserve(pooled.size() + entities.size());
+            for (const auto& entity : entities) {
+                pooled.push_back({ entity.GetID(), Deactivate(entity) });
+            }
+        }
+
+        /**
+         Destroy the entities in the pool
+         */
+        void Clear() {
+            for (const auto& entry : pooled) {
+                if (world->CorrectVersion(entry.id)) {
+                    Entity(entry.id, world).Destroy();
+                }
+            }
+            pooled.clear();
+        }
+
+        size_t NumPooled() const {
+            return pooled.size();
+        }
+
+        callback_t onSpawn, onDespawn;
+
+    private:
+        World* world;
+        Vector<Pooled> pooled;
+    };
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "Vector.hpp"
+
+namespace RavEngine {
+
+	/**
+	 A per-thread bump allocator for temporaries, such as the containers a frame builds and throws away. Allocating is a pointer bump.
+	 Whenever every allocation from an arena has been freed, which for per-frame temporaries happens at least once a frame, it starts
+	 over from the beginning, merging the chunks it grew into so that the next frame fits in one.
+	 @note Memory may be freed on any thread, but is only reused once everything allocated before it has been freed, so don't keep
+	 long-lived allocations in it.
+	 */
+	class FrameArena {
+		struct alignas(std::max_align_t) Header {
+			FrameArena* arena;
+		};
+		struct Chunk {
+			std::byte* data;
+			size_t size;
+		};
+		Vector<Chunk> chunks;		// the last is the one being allocated from
+		std::byte* top = nullptr, * end = nullptr;
+		size_t capacity = 0;
+		std::atomic<uint32_t> refs = 1;		// one per live allocation, plus one while the owning thread is alive
+
+		static std::byte* AlignUp(std::byte* ptr, size_t alignment) {
+			return reinterpret_cast<std::byte*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1));
+		}
+		void Grow(size_t size, size_t alignment);
+		void Restart();
+
+	public:
+		constexpr static size_t initialChunkSize = 64 * 1024;
+
+		FrameArena() = default;
+		~FrameArena();
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		/**
+		 @return the calling thread's arena
+		 */
+		static FrameArena& ForThisThread();
+
+		void* Allocate(size_t size, size_t alignment) {
+			if (IsEmpty()) {
+				Restart();
+			}
+			alignment = std::max(alignment, alignof(Header));
+			auto ptr = top ? AlignUp(top + sizeof(Header), alignment) : nullptr;
+			if (ptr == nullptr || ptr + size > end) {
+				Grow(size, alignment);
+				ptr = AlignUp(top + sizeof(Header), alignment);
+			}
+			reinterpret_cast<Header*>(ptr)[-1].arena = this;
+			top = ptr + size;
+			refs.fetch_add(1, std::memory_order_relaxed);
+			return ptr;
+		}
+
+		static void Free(void* memory, size_t size) {
+			auto ptr = static_cast<std::byte*>(memory);
+			auto arena = reinterpret_cast<Header*>(ptr)[-1].arena;
+			// the most recent allocation, such as a vector's old buffer after it grows, can be reused right away
+			if (arena == &ForThisThread() && ptr + size == arena->top) {
+				arena->top = ptr - sizeof(Header);
+			}
+			Release(arena);
+		}
+
+		// drop a reference, deleting the arena if it was the last, which can only happen once its thread has exited
+		static void Release(FrameArena* arena) {
+			if (arena->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete arena;
+			}
+		}
+
+		// true if everything allocated from the arena has been freed
+		bool IsEmpty() const {
+			return refs.load(std::memory_order_acquire) == 1;
+		}
+
+		// bytes reserved across all chunks
+		size_t GetCapacity() const {
+			return capacity;
+		}
+
+		size_t GetNumChunks() const {
+			return chunks.size();
+		}
+	};
+
+	/**
+	 An STL allocator that allocates from the calling thread's FrameArena
+	 */
+	template<typename T>
+	struct FrameAllocator {
+		using value_type = T;
+		using is_always_equal = std::true_type;
+
+		FrameAllocator() noexcept = default;
+		template<typename U>
+		FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(FrameArena::ForThisThread().Allocate(n * sizeof(T), alignof(T)));
+		}
+		void deallocate(T* ptr, size_t n) noexcept {
+			FrameArena::Free(ptr, n * sizeof(T));
+		}
+
+		template<typename U>
+		bool operator==(const FrameAllocator<U>&) const noexcept {
+			return true;
+		}
+	};
+
+	template<typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+	template<typename T>
+	using FrameUnorderedVector = unordered_vector<T, FrameVector<T>>;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+
+namespace RavEngine {
+
+	/**
+	 Waits for frame deadlines without burning a core. It sleeps on the OS's high resolution timer until shortly before the
+	 deadline, then spins the rest, since timers can wake late.
+	 */
+	class FrameLimiter {
+	public:
+		using clock = std::chrono::high_resolution_clock;
+
+		FrameLimiter();
+		~FrameLimiter();
+		FrameLimiter(const FrameLimiter&) = delete;
+		FrameLimiter& operator=(const FrameLimiter&) = delete;
+
+		/**
+		 Return at the deadline, or immediately if it has passed
+		 */
+		void WaitUntil(clock::time_point deadline);
+
+		// how long before the deadline to stop sleeping and spin. Longer is more precise but uses more CPU.
+		std::chrono::microseconds spinTime;
+
+	private:
+		void SleepFor(std::chrono::nanoseconds duration);
+#ifdef _WIN32
+		void* timer = nullptr;
+		bool highResolution = false;
+#endif
+	};
+}
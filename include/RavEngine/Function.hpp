@@ -1,10 +1,140 @@
 #pragma once
 //#include <boost/function.hpp>
 #include <functional>
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace RavEngine{
 
 template<typename ... A>
 using Function = std::function<A...>;
 
+template<typename Signature, size_t Capacity = 56>
+class SmallFunction;
+
+/**
+ A move-only Function that stores callables of up to Capacity bytes inline instead of on the heap.
+ Larger callables, and ones that may throw when moved, are heap allocated like a Function.
+ */
+template<typename R, typename ... A, size_t Capacity>
+class SmallFunction<R(A...), Capacity> {
+	struct VTable {
+		R (*invoke)(void* storage, A&& ... args);
+		void (*move)(void* dest, void* src);	// move-constructs dest from src, then destroys src
+		void (*destroy)(void* storage);
+	};
+
+	alignas(std::max_align_t) mutable std::byte storage[Capacity];	// mutable so that, like a Function, it can be called through a const reference
+	const VTable* vtable = nullptr;
+
+	template<typename F>
+	constexpr static bool storedInline = sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+	template<typename F>
+	static const VTable* VTableFor() {
+		if constexpr (storedInline<F>) {
+			constexpr static VTable table{
+				[](void* storage, A&& ... args) -> R { return (*std::launder(static_cast<F*>(storage)))(std::forward<A>(args)...); },
+				[](void* dest, void* src) {
+					auto f = std::launder(static_cast<F*>(src));
+					new (dest) F(std::move(*f));
+					f->~F();
+				},
+				[](void* storage) { std::launder(static_cast<F*>(storage))->~F(); }
+			};
+			return &table;
+		}
+		else {
+			// the storage holds a pointer to the callable
+			constexpr static VTable table{
+				[](void* storage, A&& ... args) -> R { return (**static_cast<F**>(storage))(std::forward<A>(args)...); },
+				[](void* dest, void* src) { *static_cast<F**>(dest) = *static_cast<F**>(src); },
+				[](void* storage) { delete *static_cast<F**>(storage); }
+			};
+			return &table;
+		}
+	}
+
+	void Reset() {
+		if (vtable) {
+			vtable->destroy(storage);
+			vtable = nullptr;
+		}
+	}
+
+public:
+	SmallFunction() {}
+
+	template<typename F> requires (!std::is_same_v<std::decay_t<F>, SmallFunction> && std::is_invocable_r_v<R, std::decay_t<F>&, A...>)
+	SmallFunction(F&& f) {
+		using stored_t = std::decay_t<F>;
+		if constexpr (storedInline<stored_t>) {
+			new (storage) stored_t(std::forward<F>(f));
+		}
+		else {
+			*reinterpret_cast<stored_t**>(storage) = new stored_t(std::forward<F>(f));
+		}
+		vtable = VTableFor<stored_t>();
+	}
+
+	SmallFunction(SmallFunction&& other) noexcept {
+		*this = std::move(other);
+	}
+
+	SmallFunction& operator=(SmallFunction&& other) noexcept {
+		if (this != &other) {
+			Reset();
+			if (other.vtable) {
+				other.vtable->move(storage, other.storage);
+				vtable = other.vtable;
+				other.vtable = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	SmallFunction(const SmallFunction&) = delete;
+	SmallFunction& operator=(const SmallFunction&) = delete;
+
+	~SmallFunction() {
+		Reset();
+	}
+
+	explicit operator bool() const {
+		return vtable != nullptr;
+	}
+
+	R operator()(A ... args) const {
+		return vtable->invoke(storage, std::forward<A>(args)...);
+	}
+};
+
+template<typename Signature>
+class FunctionRef;
+
+/**
+ A non-owning reference to a callable, for parameters that are only called before the function returns.
+ It never allocates, but must not outlive the callable it was made from.
+ */
+template<typename R, typename ... A>
+class FunctionRef<R(A...)> {
+	void* callable = nullptr;
+	R (*invoke)(void* callable, A&& ... args) = nullptr;
+
+public:
+	template<typename F> requires (!std::is_same_v<std::decay_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, A...>)
+	FunctionRef(F&& f) : callable(const_cast<void*>(static_cast<const void*>(std::addressof(f)))) {
+		invoke = [](void* callable, A&& ... args) -> R {
+			return (*static_cast<std::remove_reference_t<F>*>(callable))(std::forward<A>(args)...);
+		};
+	}
+
+	R operator()(A ... args) const {
+		return invoke(callable, std::forward<A>(args)...);
+	}
+};
+
 }
@@ -10,6 +10,8 @@
 #include "Ref.hpp"
 #include <RmlUi/Core/ElementDocument.h>
 #include "Types.hpp"
+#include "StringID.hpp"
+#include "Vector.hpp"
 
 namespace Rml {
 	class Context;
@@ -17,6 +19,33 @@ namespace Rml {
 }
 
 namespace RavEngine{
+/**
+* The geometry a GUI produced the last time its context was rendered, so that frames where nothing changed
+* can submit it again without walking the element tree. Recorded and replayed by the RenderEngine.
+*/
+struct GUIDrawList {
+	struct Draw {
+		Rml::TextureHandle texture = 0;
+		Rml::CompiledGeometryHandle compiled = 0;	// if 0, the draw is the uncompiled range below
+		Rml::Vector2f translation;
+		uint32_t firstVertex = 0, nVertices = 0, firstIndex = 0, nIndices = 0;
+		uint16_t scissorX = 0, scissorY = 0, scissorWidth = 0, scissorHeight = 0;
+		bool scissorEnabled = false;
+	};
+	Vector<Draw> draws;
+	Vector<Rml::Vertex> vertices;
+	Vector<int> indices;
+	uint64_t resourceGeneration = 0;	// the RenderEngine's GUI resource generation when this was recorded
+	bool valid = false;
+
+	void clear() {
+		draws.clear();
+		vertices.clear();
+		indices.clear();
+		valid = false;
+	}
+};
+
 /**
 * For putting interactive UI in a scene.
 */
@@ -27,7 +56,7 @@ protected:
 	
     struct GUIData : public RavEngine::IInputListener{
         Rml::Context* context = nullptr;
-        locked_hashmap<std::string, Rml::ElementDocument*, SpinLock> documents;
+        locked_hashmap<StringID, Rml::ElementDocument*, SpinLock> documents;
         ~GUIData();
         
         ConcurrentQueue<Function<void(void)>> q_a, q_b;
@@ -44,6 +73,17 @@ protected:
 		struct {
 			float x = 0, y = 0;
 		} MousePos;
+
+		// the context is only updated when one of these says something may have changed
+		std::atomic<bool> needsUpdate = true;				// set by changes that do not go through the task queue
+		double nextUpdateTime = 0;							// when the context asked to be updated again, for animations
+		bool contentChanged = true;							// the context was updated since drawList was recorded
+		struct {
+			float x = -1, y = -1;
+			Rml::Vector2i dim{ 0, 0 };
+		} lastMouseMove;
+		Rml::Vector2i requestedDimensions{ 0, 0 };
+		GUIDrawList drawList;
         
         template<typename T>
         inline void ExclusiveAccess(const T& func){
@@ -108,12 +148,14 @@ public:
 	 @throws if this document is not loaded
 	 */
 	void RemoveDocument(const std::string& name);
+	void RemoveDocument(StringID name);
 	
 	/**
 	 @returns true if a document with the passed name is currently loaded.
 	 @param name the name of the RML file
 	 */
 	bool IsDocumentLoaded(const std::string& name) const;
+	bool IsDocumentLoaded(StringID name) const;
 	
 	/**
 	 Get a pointer to a document, for performing queries or bindings.
@@ -122,6 +164,7 @@ public:
 	 @throws if the document is not loaded.
 	 */
 	Rml::ElementDocument* GetDocument(const std::string& name) const;
+	Rml::ElementDocument* GetDocument(StringID name) const;
 	
 	/**
 	 Change the size of the context.
@@ -156,6 +199,15 @@ public:
     template<typename T>
     constexpr inline void ExclusiveAccess(const T& func) {
         data->ExclusiveAccess(func);
+        data->needsUpdate = true;
+	}
+
+	/**
+	Make the next frame update and redraw this GUI. The GUI only updates when it receives input, runs an EnqueueUIUpdate or
+	ExclusiveAccess function, or has an animation playing, so call this after changing a bound data model or element by other means.
+	*/
+	void RequestUpdate() {
+		data->needsUpdate = true;
 	}
 
     /**
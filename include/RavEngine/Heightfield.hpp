@@ -0,0 +1,85 @@
+#pragma once
+#include "Vector.hpp"
+#include <glm/vec3.hpp>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+namespace RavEngine {
+
+    /**
+     A grid of heights on the XZ plane. Sample (x, z) is at (x * spacing, height, z * spacing) relative to the grid's origin.
+     Each cell is split into two triangles along the diagonal from sample (x, z) to (x + 1, z + 1), the same way the terrain
+     draws it and PhysX collides with it.
+     */
+    struct Heightfield {
+        uint32_t width = 0, depth = 0;      // samples along X and Z
+        float spacing = 1;                  // between neighboring samples
+        Vector<float> heights;              // width * depth, in rows of constant Z
+
+        struct Range {
+            float min = 0, max = 0;
+        };
+
+        Heightfield() {}
+        Heightfield(uint32_t width, uint32_t depth, float spacing) : width(width), depth(depth), spacing(spacing), heights(size_t(width) * depth, 0.f) {}
+
+        float& At(uint32_t x, uint32_t z) {
+            return heights[size_t(z) * width + x];
+        }
+        float At(uint32_t x, uint32_t z) const {
+            return heights[size_t(z) * width + x];
+        }
+
+        /**
+         @param x position relative to the origin
+         @param z position relative to the origin
+         @return the height of the surface above a position. Positions off the grid are clamped to its edge.
+         */
+        float Sample(float x, float z) const;
+
+        /**
+         @return the surface normal at a sample, from the slope to its neighbors
+         */
+        glm::vec3 Normal(uint32_t x, uint32_t z) const;
+
+        /**
+         @return the lowest and highest samples in a rectangle of samples, bounds inclusive
+         */
+        Range HeightRange(uint32_t x0, uint32_t z0, uint32_t x1, uint32_t z1) const;
+    };
+
+    /**
+     A streamed tile of terrain is a TerrainTileHeader, resolution * resolution float heights in rows of constant Z, then
+     splatResolution * splatResolution RGBA8 texels weighting the four material layers. The heights on a tile's edges repeat
+     the ones on its neighbors' edges, so tiles meet without gaps.
+     */
+    struct TerrainTileHeader {
+        const std::array<char, 4> header = { 'r','v','e','t' };
+        uint32_t resolution = 0;
+        uint32_t splatResolution = 0;
+    };
+
+    struct TerrainTileData {
+        Heightfield heights;
+        uint32_t splatResolution = 0;
+        Vector<std::array<uint8_t, 4>> splat;
+    };
+
+    /**
+     @param bytes the contents of a tile file
+     @param tileSize the length of a side of the tile, in world units
+     @param out receives the tile. The heights' spacing is set from tileSize.
+     @return false if bytes is not a complete tile
+     */
+    bool ParseTerrainTile(std::span<const std::byte> bytes, float tileSize, TerrainTileData& out);
+
+    /**
+     @param heights a square heightfield
+     @param splatResolution the length of a side of the splat map, 0 for none
+     @param splat splatResolution * splatResolution texels
+     @return the contents of a tile file, see ParseTerrainTile
+     */
+    Vector<std::byte> SerializeTerrainTile(const Heightfield& heights, uint32_t splatResolution, std::span<const std::array<uint8_t, 4>> splat);
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+// shared by the engine and rvemc, and mirrored in materials/impostor_shared.glsl
+
+namespace RavEngine::ImpostorEncoding {
+
+	/**
+	 An impostor draws a mesh far away as a camera-facing quad, textured from a grid of pictures of the mesh taken from
+	 directions around it. The directions are the points of an octahedral map (or of a hemi-octahedral map, for meshes that
+	 are never seen from below), so frame (x, y) of an N by N grid looks from GridToDirection((x, y) / (N - 1)).
+
+	 A mesh part whose SerializedMeshDataHeader has a non-zero impostorFramesPerSide has an ImpostorHeader after its LODs,
+	 then the quad as a complete serialized mesh, then the mip chains of the two RGBA8 atlases, largest mip first.
+	 The albedo atlas holds sRGB-encoded albedo and coverage. The normal atlas holds the object-space normal in RGB and
+	 the depth in A, where depth is the distance of the surface in front of the frame's plane through the center,
+	 relative to the radius, mapped from [-1, 1].
+	 */
+	struct ImpostorHeader {
+		glm::vec3 center{ 0 };			// of the sphere the frames were taken of, in object space
+		float radius = 0;
+		float minDistance = 0;			// the impostor replaces the mesh beyond this distance from the camera
+		uint32_t atlasSize = 0;			// texels, both atlases are square
+		uint8_t framesPerSide = 0;
+		uint8_t hemisphere = 0;			// if 1, the frames only cover the upper hemisphere
+		uint8_t mipLevels = 1;			// of each atlas. The smallest mip still has a few texels per frame.
+		uint8_t padding = 0;
+	};
+	static_assert(sizeof(ImpostorHeader) == 28);
+
+	/**
+	 @param dir the direction from the center to the viewer, in object space
+	 @return where dir is in the grid of frames, in [0, 1]
+	 */
+	inline glm::vec2 DirectionToGrid(glm::vec3 dir, bool hemisphere) {
+		if (hemisphere) {
+			dir.y = std::max(dir.y, 0.f);
+		}
+		const float sum = std::abs(dir.x) + std::abs(dir.y) + std::abs(dir.z);
+		if (sum == 0) {
+			return { 0.5f, 0.5f };
+		}
+		dir /= sum;
+		glm::vec2 p;
+		if (hemisphere) {
+			p = { dir.x + dir.z, dir.x - dir.z };
+		}
+		else {
+			p = { dir.x, dir.z };
+			if (dir.y < 0) {
+				p = glm::vec2((1 - std::abs(dir.z)) * (dir.x >= 0 ? 1 : -1), (1 - std::abs(dir.x)) * (dir.z >= 0 ? 1 : -1));
+			}
+		}
+		return glm::clamp(p * 0.5f + 0.5f, glm::vec2(0), glm::vec2(1));
+	}
+
+	/**
+	 The inverse of DirectionToGrid
+	 */
+	inline glm::vec3 GridToDirection(glm::vec2 grid, bool hemisphere) {
+		const glm::vec2 p = grid * 2.f - 1.f;
+		glm::vec3 dir;
+		if (hemisphere) {
+			dir.x = (p.x + p.y) * 0.5f;
+			dir.z = (p.x - p.y) * 0.5f;
+			dir.y = 1 - std::abs(dir.x) - std::abs(dir.z);
+		}
+		else {
+			dir = { p.x, 1 - std::abs(p.x) - std::abs(p.y), p.y };
+			const float t = std::max(-dir.y, 0.f);
+			dir.x += dir.x >= 0 ? -t : t;
+			dir.z += dir.z >= 0 ? -t : t;
+		}
+		return glm::normalize(dir);
+	}
+
+	// bytes of RGBA8 texels in an atlas's mip chain
+	inline size_t AtlasBytes(const ImpostorHeader& header) {
+		size_t total = 0;
+		for (uint32_t mip = 0; mip < header.mipLevels; mip++) {
+			const size_t size = std::max(header.atlasSize >> mip, 1u);
+			total += size * size * 4;
+		}
+		return total;
+	}
+
+	inline glm::vec3 FrameDirection(uint32_t x, uint32_t y, uint32_t framesPerSide, bool hemisphere) {
+		const float last = float(std::max(framesPerSide, 2u) - 1);
+		return GridToDirection(glm::vec2(x, y) / last, hemisphere);
+	}
+
+	/**
+	 The axes of the picture taken from dir. Right and up are in the picture's plane, and dir points out of it.
+	 */
+	struct FrameBasis {
+		glm::vec3 right, up;
+	};
+
+	inline FrameBasis BasisForDirection(glm::vec3 dir) {
+		// straight above or below, world up is in line with dir, so use a horizontal axis instead
+		const glm::vec3 reference = std::abs(dir.y) > 0.999f ? glm::vec3(0, 0, -1) : glm::vec3(0, 1, 0);
+		const auto right = glm::normalize(glm::cross(reference, dir));
+		return { right, glm::cross(dir, right) };
+	}
+}
@@ -12,6 +12,9 @@
 #include "DataStructures.hpp"
 #include <RavEngine/mathtypes.hpp>
 #include "WeakRef.hpp"
+#include "StringID.hpp"
+#include "Vector.hpp"
+#include <algorithm>
 
 namespace RavEngine {
 
@@ -130,8 +133,9 @@ namespace RavEngine {
 		return static_cast<CID>(1 << x);
 	}
 
-	typedef Function<void(float)> axisCallback;
-	typedef Function<void()> actionCallback;
+	// member function bindings capture a handle and a method pointer, which fit inline
+	typedef SmallFunction<void(float)> axisCallback;
+	typedef SmallFunction<void()> actionCallback;
 
     class InputManager
     {
@@ -152,7 +156,7 @@ namespace RavEngine {
 			 @param c the controller bitmask for this binding
 			 @param s the required state of the source controller
 			 */
-			ActionBinding(decltype(id) id, actionCallback fn, void* addr, CID c, ActionState s) : id(id), func(fn), controller(c), state(s), func_addr(addr){}
+			ActionBinding(decltype(id) id, actionCallback&& fn, void* addr, CID c, ActionState s) : id(id), func(std::move(fn)), controller(c), state(s), func_addr(addr){}
 			/**
 			 Execute this ActionBinding. If the action binding is invalid, or the input state / controller are not applicable, this function will do nothing.
 			 @param state_in the state of the action being invoked
@@ -195,7 +199,7 @@ namespace RavEngine {
 			 @param dz the binding deadzone filter range
 			 @param scale the scale factor to apply to the passed value
 			 */
-			AxisBinding(decltype(id) id, axisCallback fn, void* addr, CID c, float dz): id(id), func(fn), func_addr(addr), controller(c),deadzone(dz){}
+			AxisBinding(decltype(id) id, axisCallback&& fn, void* addr, CID c, float dz): id(id), func(std::move(fn)), func_addr(addr), controller(c),deadzone(dz){}
 			
 			/**
 			 Execute this ActionBinding
@@ -219,44 +223,51 @@ namespace RavEngine {
 		};
 		
 		
-		//stores which mappings each event ID is bound to
-		locked_hashmap<int, locked_hashset<std::string,SpinLock>,SpinLock> CodeToAction;
-		//the binding objects, keyed by binding ID
-		locked_hashmap<std::string, LinkedList<ActionBinding>,SpinLock> ActionBindings;
-		//stores which mappings each event ID is bound to
-		struct AxisID{
-			std::string identifier;
-			float scale = 1;
-		};
-		
-		struct aid_hasher{
-            inline std::size_t operator()(const AxisID& other) const{
-				std::hash<std::string> hasher;
-				return hasher(other.identifier);
-			}
+		// bindings live in flat arrays, reached through the hashed names, so dispatching an event does no string hashing or allocation
+		struct ActionData{
+			Vector<ActionBinding> bindings;
 		};
-		
-		struct aid_eq{
-            inline bool operator()(const AxisID& A, const AxisID& B) const{
-				return A.identifier == B.identifier && A.scale == B.scale;
-			}
+		struct AxisMapping{
+			uint32_t axis;		// index into Axes
+			float scale = 1;
 		};
-		
-		locked_hashmap<int, locked_hashset<AxisID,SpinLock,aid_hasher,aid_eq>,SpinLock> CodeToAxis;
 		//the buffered axis inputs for each identifier
 		struct AxisInput{
+			int code;
 			float value;
 			CID source_controller;
 		};
 		struct AxisData{
-            UnorderedMap<int,AxisInput> bufferedInputs;
-			LinkedList<AxisBinding> bindings;
+			SmallVector<AxisInput,2> bufferedInputs;	// the latest value from each input code mapped to this axis
+			Vector<AxisBinding> bindings;
 		};
-        UnorderedMap<std::string, AxisData> AxisBindings;
+		UnorderedMap<StringID, uint32_t> ActionIndices, AxisIndices;
+		Vector<ActionData> Actions;
+		Vector<AxisData> Axes;
+		//stores which mappings each event ID is bound to
+		UnorderedMap<int, SmallVector<uint32_t,2>> CodeToAction;
+		UnorderedMap<int, SmallVector<AxisMapping,2>> CodeToAxis;
 		
 		//AnyActions
 		LinkedList<WeakPtrKey<IInputListener>> AnyEventBindings;
 		
+		// high polling rate mice send many motion and wheel events per frame. They are combined here and buffered once, in TickAxes.
+		struct{
+			float x = 0, y = 0, xrel = 0, yrel = 0, wheelX = 0, wheelY = 0;
+			bool moved = false, scrolled = false;
+		} coalesced;
+		
+		/**
+		 @return the index of the action or axis with this name, adding it if it does not exist
+		 */
+		uint32_t ActionIndex(StringID name);
+		uint32_t AxisIndex(StringID name);
+		
+		/**
+		 Buffer the coalesced mouse input
+		 */
+		void FlushCoalescedInput();
+		
 		/**
 		 Process a single action event
 		 @param ID the event ID. It may need to be transformed if there is overlap in SDL
@@ -295,9 +306,7 @@ namespace RavEngine {
 		 @param name the identifer to use when binding or unbinding actions
 		 @param Id the button identifier to use. See the SDL key bindings for more information. To bind controllers, see the special bindings at the top of this file.
 		 */
-        inline void AddActionMap(const std::string& name, int Id){
-			CodeToAction[Id].insert(name);
-		}
+        void AddActionMap(const std::string& name, int Id);
 		
 		/**
 		 Create an axis mapping entry. Axis mappings correspond to items that have a range of values, such as the mouse or analog sticks.
@@ -305,27 +314,21 @@ namespace RavEngine {
 		 @param Id the button identifier to use. See the SDL key bindings for more information. To bind controllers, see the special bindings at the top of this file.
 		 @param scale the scale factor to apply to all bindings mapped to this axis
 		 */
-        inline void AddAxisMap(const std::string& name, int Id, float scale = 1){
-			CodeToAxis[Id].insert({name,scale});
-		}
+        void AddAxisMap(const std::string& name, int Id, float scale = 1);
 		
 		/**
 		 Remove an action mapping entry. Both the name and ID must match to complete removal.
 		 @param name the identifer to look for
 		 @param Id the button identifier to use. See the SDL key bindings for more information.
 		 */
-        inline void RemoveActionMap(const std::string& name, int Id){
-			CodeToAction[Id].erase(name);
-		}
+        void RemoveActionMap(const std::string& name, int Id);
 		
 		/**
 		 Remove an axis mapping entry. Both the name and ID must match to complete removal.
 		 @param name the identifer to look for
 		 @param Id the button identifier to use. See the SDL key bindings for more information.
 		 */
-        inline void RemoveAxisMap(const std::string& name, int Id, float scale = 1){
-			CodeToAxis[Id].erase({name, scale});
-		}
+        void RemoveAxisMap(const std::string& name, int Id, float scale = 1);
 		
 		/**
 		 * Bind an action map to a member function
@@ -341,7 +344,7 @@ namespace RavEngine {
 			};
 			ActionBinding ab(thisptr.get_id(),binding,&f,controllers,type);
 			
-			ActionBindings[name].push_back(ab);
+			Actions[ActionIndex(StringID(name))].bindings.push_back(std::move(ab));
 		}
 
         /**
@@ -358,7 +361,7 @@ namespace RavEngine {
 			};
 			AxisBinding ab(thisptr.get_id(), func, &f, controllers, deadZone);
 			
-			AxisBindings[name].bindings.push_back(ab);
+			Axes[AxisIndex(StringID(name))].bindings.push_back(std::move(ab));
         }
 
 		/**
@@ -375,7 +378,10 @@ namespace RavEngine {
 			};
 			ActionBinding ab(thisptr.get_id(),binding,&f,controllers,type);
 			
-			ActionBindings[name].remove(ab);	//remove the first binding that compares equal
+			auto& bindings = Actions[ActionIndex(StringID(name))].bindings;
+			if (auto it = std::find(bindings.begin(), bindings.end(), ab); it != bindings.end()){
+				bindings.erase(it);	//remove the first binding that compares equal
+			}
 		}
 		
 		/**
@@ -391,7 +397,10 @@ namespace RavEngine {
 			};
 			AxisBinding ab(thisptr.get_id(), func, &f, controllers, deadZone);
 			
-			AxisBindings[name].bindings.remove(ab);
+			auto& bindings = Axes[AxisIndex(StringID(name))].bindings;
+			if (auto it = std::find(bindings.begin(), bindings.end(), ab); it != bindings.end()){
+				bindings.erase(it);
+			}
 		}
 		
 		/**
@@ -0,0 +1,122 @@
+#pragma once
+#if !RVE_SERVER
+
+#include "Material.hpp"
+#include "MeshAsset.hpp"
+#include "mathtypes.hpp"
+#include "ComponentWithOwner.hpp"
+#include "Layer.hpp"
+#include "Vector.hpp"
+#include "Types.hpp"
+#include <span>
+
+namespace RavEngine {
+    struct MeshCollectionStatic;
+    template<typename T> class BufferedVRAMVector;
+
+    /**
+     Renders many copies of one mesh and material from a single entity. Each instance is only a transform matrix,
+     relative to the owning entity's Transform. Instances are culled and drawn by the same GPU path as StaticMesh,
+     but do not need their own Entity, Transform or StaticMesh.
+     @note the owning entity must have a Transform
+     */
+    class InstancedStaticMesh : public ComponentWithOwner, public Disableable {
+        friend class World;
+
+        Ref<MeshCollectionStatic> mesh;
+        Ref<MaterialInstance> material;
+        Vector<matrix4> instanceTransforms;     // relative to the owner's transform
+        Vector<entity_t> renderSlots;           // world render-data index for each instance, parallel to instanceTransforms
+        matrix4 lastOwnerMatrix{ 0 };           // deliberately invalid so the first sync writes every instance
+        uint32_t dirtyBegin = 0, dirtyEnd = 0;  // range of instances written since the last sync
+        renderlayer_t renderLayers = ALL_LAYERS;
+        perobject_t attributes = ALL_ATTRIBUTES;
+
+        void MarkDirty(uint32_t index) {
+            if (dirtyBegin == dirtyEnd) {
+                dirtyBegin = index;
+                dirtyEnd = index + 1;
+            }
+            else {
+                dirtyBegin = std::min(dirtyBegin, index);
+                dirtyEnd = std::max(dirtyEnd, index + 1);
+            }
+        }
+
+        void AllocateSlots(uint32_t count);
+        void SyncRenderTransforms(BufferedVRAMVector<matrix4>& worldTransforms, const matrix4& ownerMatrix);
+
+    public:
+        InstancedStaticMesh(Entity owner, Ref<MeshCollectionStatic> mesh, Ref<MaterialInstance> material);
+
+        MOVE_NO_COPY(InstancedStaticMesh);
+
+        /**
+         Add one instance
+         @param transform the instance's transform relative to the owning entity
+         @return the index of the new instance
+         */
+        uint32_t AddInstance(const matrix4& transform);
+
+        /**
+         Add many instances at once. Render data is allocated once for the whole batch.
+         @param transforms the instances' transforms relative to the owning entity
+         */
+        void AddInstances(std::span<const matrix4> transforms);
+
+        /**
+         Remove an instance. The last instance is moved into its index.
+         @param index the instance to remove
+         */
+        void RemoveInstance(uint32_t index);
+
+        /**
+         Remove all instances
+         */
+        void ClearInstances();
+
+        void SetInstanceTransform(uint32_t index, const matrix4& transform) {
+            instanceTransforms.at(index) = transform;
+            MarkDirty(index);
+        }
+
+        const matrix4& GetInstanceTransform(uint32_t index) const {
+            return instanceTransforms.at(index);
+        }
+
+        auto GetInstanceCount() const {
+            return static_cast<uint32_t>(instanceTransforms.size());
+        }
+
+        auto GetMesh() const {
+            return mesh;
+        }
+
+        auto GetMaterial() const {
+            return material;
+        }
+
+        /**
+         Assign a material to all instances
+         @param mat the material instance to assign
+         */
+        void SetMaterial(Ref<MaterialInstance> mat);
+
+        /**
+         Set the render layers of all instances
+         */
+        void SetRenderLayers(renderlayer_t layers);
+
+        /**
+         Set the per-object attributes (culling, shadows) of all instances
+         */
+        void SetAttributes(perobject_t attributes);
+
+        // shadow Disableable::SetEnabled
+        void SetEnabled(bool);
+
+        // called by the world when the component is destroyed
+        void Destroy();
+    };
+}
+#endif
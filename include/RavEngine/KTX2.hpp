@@ -0,0 +1,46 @@
+#pragma once
+#include "Vector.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+namespace RavEngine::KTX2 {
+
+	enum class ReadResult : uint8_t {
+		Success,
+		NotKTX2,
+		Truncated,			// the header or a level is outside the file
+		Unsupported,		// a 3D texture, array, cubemap, or an unsupported supercompression scheme
+		BasisUniversal,		// ETC1S or UASTC, which need transcoding
+	};
+
+	enum class Supercompression : uint32_t {
+		None = 0,
+		BasisLZ = 1,
+		Zstandard = 2,
+		ZLIB = 3,
+	};
+
+	struct Image {
+		uint32_t vkFormat = 0;				// a VkFormat
+		uint32_t width = 0, height = 0;
+		Supercompression supercompression = Supercompression::None;
+		Vector<std::span<const std::byte>> levels;	// as stored in the file, largest first
+		Vector<uint64_t> levelSizes;		// after decompression
+	};
+
+	bool IsKTX2(std::span<const std::byte> data);
+
+	/**
+	 Read the header and level index of a 2D KTX2 texture
+	 @param image its levels point into data
+	 */
+	ReadResult Read(std::span<const std::byte> data, Image& image);
+
+	/**
+	 Decompress the levels of an image
+	 @param mips the levels tightly packed, largest first
+	 @return false if a level does not decompress to its size
+	 */
+	bool DecodeLevels(const Image& image, Vector<std::byte>& mips);
+}
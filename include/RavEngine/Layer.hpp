@@ -1,5 +1,6 @@
 #pragma once
 #include <limits>
+#include <glm/vec2.hpp>
 
 namespace RavEngine{
     using renderlayer_t = uint32_t;
@@ -10,12 +11,35 @@ namespace RavEngine{
     constexpr perobject_t OcclusionCullingBit = 1 << 1;
     constexpr perobject_t CastsShadowsBit = 1 << 2;
     constexpr perobject_t RecievesShadowsBit = 1 << 3;
+    constexpr perobject_t StaticTransformBit = 1 << 15;    // maintained by the engine from Transform::SetStatic, cannot be set by the user
     constexpr perobject_t ALL_ATTRIBUTES = std::numeric_limits<decltype(ALL_ATTRIBUTES)>::max();
 
 
+    // the resolution SSAO and SSGI are traced at
+    enum class IndirectLightingResolution : uint8_t {
+        Full,       // every sample is traced each frame at the SSGI target's first mip
+        Half,       // traced at half of Full, rotating the samples each frame and accumulating them over several frames
+        Quarter     // like Half, at a quarter of Full
+    };
+
     struct IndirectLightingSettings {
         float ssaoStrength = 1;
         bool SSAOEnabled = true;
         bool SSGIEnabled = false;
+        IndirectLightingResolution resolution = IndirectLightingResolution::Full;
+    };
+
+    // parts of the frame a camera can go without, for cheaper secondary views such as mirrors and monitors. SSGI is in IndirectLightingSettings
+    struct CameraFeatureSettings {
+        bool transparency = true;               // render transparent materials
+        uint8_t maxShadowCascades = 255;        // directional lights render at most this many of their cascades for the camera, the last one reaching its far clip
+    };
+
+    // shade lit materials at a lower rate away from a point of the view. Only has an effect if RenderEngine::GetShadingRateTileSize is not 0. Headset views have it enabled
+    struct FoveationSettings {
+        bool enabled = false;
+        float innerRadius = 0.3f;               // every pixel is shaded within this distance of the center, as a fraction of the view's height
+        float outerRadius = 0.5f;               // one shade per 2x2 pixels up to this distance, and per 4x4 beyond it
+        glm::vec2 center{ 0.5f, 0.5f };         // in the view, 0,0 being the top left. Move it to follow eye tracking
     };
 }
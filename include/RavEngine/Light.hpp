@@ -5,12 +5,13 @@
 #include "Layer.hpp"
 #include "Types.hpp"
 #if !RVE_SERVER
-#include "DepthPyramid.hpp"
+#include <RGL/Types.hpp>
 #endif
 
 namespace RavEngine{
 class MeshAsset;
 class CameraComponent;
+
 /**
 Represents a light-emitting object. Lights can be constrained to specific objects with layers. 
 By default, lights will illuminate objects on any layer. 
@@ -112,10 +113,17 @@ struct DirectionalLight : public ShadowLightBase, public QueryableDelta<Queryabl
     DirectionalLight();
     
 #if !RVE_SERVER
+    constexpr static uint32_t shadowMapSize = 4096;     // of each cascade, unless the RenderEngine lowers it to save VRAM
+
     struct ShadowMap {
-        Array<DepthPyramid,MAX_CASCADES> pyramid;
         Array<RGLTexturePtr,4> shadowMap;
     } shadowData;
+
+    /**
+    Reallocate the cascades at a new size. The RenderEngine calls this, and updates the light's render data to match.
+    @return the replaced textures, which the GPU may still be using
+    */
+    Array<RGLTexturePtr,4> ResizeShadowMaps(uint32_t dim);
     Array<float, MAX_CASCADES> shadowCascades{0.1, 0.2, 0.3, 1};
     uint8_t numCascades = shadowCascades.size();
 #endif
@@ -126,6 +134,7 @@ struct DirectionalLight : public ShadowLightBase, public QueryableDelta<Queryabl
 
 /**
 A light that emits rays omnidirectionally from a single point. This is useful for modelling lightbulbs.
+Its six shadow faces are placed in the RenderEngine's shadow atlas.
 */
 struct PointLight : public ShadowLightBase, public QueryableDelta<QueryableDelta<Light, ShadowLightBase>,PointLight>{
 	using light_t = PointLight;
@@ -133,16 +142,6 @@ struct PointLight : public ShadowLightBase, public QueryableDelta<QueryableDelta
 	
 	void DebugDraw(RavEngine::DebugDrawer&, const Transform&) const override;
 
-	PointLight();
-
-#if !RVE_SERVER
-	struct ShadowData {
-		Array<DepthPyramid, 6> cubePyramids;
-		Array<RGLTexturePtr, 6> cubeShadowmaps;
-		RGLTexturePtr mapCube;
-	} shadowData;
-#endif
-
     matrix4 CalcProjectionMatrix() const;
     static matrix4 CalcViewMatrix(const vector3& lightPos, uint8_t index);
 	
@@ -158,6 +157,7 @@ private:
 
 /**
 A light that emits rays from a sigle point, constrained to a cone. This is useful for modeling flashlights.
+Its shadow map is placed in the RenderEngine's shadow atlas.
 */
 class SpotLight : public ShadowLightBase, public QueryableDelta<QueryableDelta<Light,ShadowLightBase>,SpotLight>{
     //light properties
@@ -169,24 +169,9 @@ public:
 	
 	void DebugDraw(RavEngine::DebugDrawer&, const Transform&) const override;
     
-    SpotLight();
-    
     matrix4 CalcProjectionMatrix() const;
     matrix4 CalcViewMatrix(const matrix4& worldTransform) const;
     
-#if !RVE_SERVER
-    struct ShadowMap {
-        DepthPyramid pyramid;
-        RGLTexturePtr shadowMap;
-    } shadowData;
-#endif
-    
-#if !RVE_SERVER
-    const ShadowMap& GetShadowMap() const {
-        return shadowData;
-    }
-#endif
-    
     constexpr void SetConeAngle(decltype(coneAngle) inAngle){
         invalidate();
         coneAngle = inAngle;
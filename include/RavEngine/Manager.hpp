@@ -4,7 +4,13 @@
 #include "SpinLock.hpp"
 #include "Map.hpp"
 #include "Vector.hpp"
-#include <tuple>
+#include "Array.hpp"
+#include "Function.hpp"
+#include "AssetLoadQueue.hpp"
+#include "MemoryTracking.hpp"
+#include "PerfCounters.hpp"
+#include <atomic>
+#include <future>
 
 namespace RavEngine {
 
@@ -18,10 +24,117 @@ namespace RavEngine {
  */
 template<typename key_t, typename T, bool keyIsConstructionParam = true>
 struct GenericWeakReadThroughCache : public CacheBase{
+    using future_t = std::shared_future<Ref<T>>;
+    using callback_t = Function<void(const Ref<T>&)>;
 
 protected:
-    static UnorderedMap<std::tuple<key_t, unique_key_t>,WeakRef<T>> items;
-    static SpinLock mtx;
+    // the hash is computed once per lookup, and picks the shard as well as the bucket
+    struct cache_key_t {
+        key_t key;
+        unique_key_t unique_key;
+        size_t hash;
+
+        cache_key_t(const key_t& key, unique_key_t unique_key) : key(key), unique_key(unique_key), hash(phmap::HashState().combine(0, key, unique_key)) {}
+
+        bool operator==(const cache_key_t& other) const {
+            return hash == other.hash && unique_key == other.unique_key && key == other.key;
+        }
+
+        friend size_t hash_value(const cache_key_t& value) {
+            return value.hash;
+        }
+    };
+
+    // an object being constructed, by whichever thread gets to it first
+    struct PendingLoad {
+        std::atomic<bool> started = false;
+        std::promise<Ref<T>> promise;
+        future_t future = promise.get_future().share();
+        Function<Ref<T>()> construct;
+        Vector<callback_t> callbacks;      // guarded by the shard's lock
+    };
+
+    struct Slot {
+        WeakRef<T> item;
+        Ref<PendingLoad> pending;          // set while the item is loading
+    };
+
+    // lookups of different keys rarely contend, and locks are never held while constructing
+    struct Shard {
+        SpinLock mtx{ "Manager::Shard" };
+        UnorderedMap<cache_key_t, Slot> slots;
+    };
+    constexpr static size_t numShards = 16;
+    static Array<Shard, numShards> shards;
+    static std::atomic<AssetLoadPriority> loadPriority;
+
+    static Shard& ShardFor(const cache_key_t& key){
+        // the low bits pick the bucket in the shard's map, so use the high ones
+        return shards[(key.hash >> (sizeof(size_t) * 8 - 4)) % numShards];
+    }
+
+    template<typename ... A>
+    static Function<Ref<T>()> MakeConstructor(const key_t& str, A ... extras){
+        if constexpr (keyIsConstructionParam) {
+            return [str, extras...] { return std::make_shared<T>(str, extras...); };
+        }
+        else {
+            return [extras...] { return std::make_shared<T>(extras...); };
+        }
+    }
+
+    /**
+     Find a cached object, or else the load of it in progress, or else begin a load. Call with the shard's lock held.
+     @param isNew set to true if a load was begun
+     */
+    template<typename ... A>
+    static Ref<T> FindOrBegin(Shard& shard, const cache_key_t& key, Ref<PendingLoad>& pending, bool& isNew, A ... extras){
+        // summed over every cache. A request for an object that is already loading is neither.
+        static auto hits = PerfCounters::GetCounter("Assets: Cache Hits"), misses = PerfCounters::GetCounter("Assets: Cache Misses");
+        auto& slot = shard.slots[key];
+        if (auto ptr = slot.item.lock()) {
+            hits->Add();
+            return ptr;
+        }
+        if (!slot.pending) {
+            slot.pending = std::make_shared<PendingLoad>();
+            slot.pending->construct = MakeConstructor(key.key, extras...);
+            isNew = true;
+            misses->Add();
+        }
+        pending = slot.pending;
+        return nullptr;
+    }
+
+    /**
+     Construct the object if no other thread has started to
+     @return false if another thread is constructing it
+     */
+    static bool TryConstruct(const cache_key_t& key, const Ref<PendingLoad>& pending){
+        if (pending->started.exchange(true)) {
+            return false;
+        }
+        auto value = pending->construct();
+        Vector<callback_t> callbacks;
+        {
+            auto& shard = ShardFor(key);
+            std::lock_guard guard(shard.mtx);
+            auto& slot = shard.slots[key];
+            slot.item = value;
+            slot.pending = nullptr;
+            callbacks = std::move(pending->callbacks);
+        }
+        pending->promise.set_value(value);
+        if (!callbacks.empty()) {
+            AssetLoadQueue::RunOnMainThread([callbacks = std::move(callbacks), value] {
+                for (const auto& callback : callbacks) {
+                    callback(value);
+                }
+            });
+        }
+        return true;
+    }
+
 public:
     /**
      Load object from cache. If the object is not cached in memory, it will be loaded from disk.
@@ -43,54 +156,143 @@ public:
      */
     template<typename ... A>
     static inline Ref<T> GetWithKey(const key_t& str, unique_key_t unique_key, A ... extras) {
-        auto key = std::tuple<key_t, unique_key_t>(str, unique_key);
-       
-        //TODO: optimize
-        std::lock_guard guard(mtx);
-        if (items.contains(key)) {
-            auto value = items.at(key).lock();
-            if (auto ptr = value) {
+        const cache_key_t key(str, unique_key);
+        Ref<PendingLoad> pending;
+        bool isNew = false;
+        {
+            auto& shard = ShardFor(key);
+            std::lock_guard guard(shard.mtx);
+            if (auto ptr = FindOrBegin(shard, key, pending, isNew, extras...)) {
                 return ptr;
             }
         }
-        Ref<T> m;
-        if constexpr (keyIsConstructionParam) {
-            m = std::make_shared<T>(str, extras...);
+        // construct it here if it is still waiting in the load queue, so that loads made while loading cannot deadlock
+        TryConstruct(key, pending);
+        return pending->future.get();
+    }
+
+    /**
+     Load an object on App::executor without blocking the caller. Requests for an object that is already loading share that load.
+     @param str the name of the asset
+     @param onLoaded called on the main thread once the object is loaded, can be empty
+     @param extras additional arguments to pass to the constructor
+     @return a future for the object, which is ready immediately if the object is cached
+     */
+    template<typename ... A>
+    static inline future_t GetAsync(const key_t& str, callback_t onLoaded, A ... extras){
+        return GetAsyncWithKey(str, 0, std::move(onLoaded), extras...);
+    }
+
+    /**
+     Load an object on App::executor without blocking the caller. Requests for an object that is already loading share that load.
+     @param str the name of the asset
+     @param unique_key a differentiator to force a new load and identify it later
+     @param onLoaded called on the main thread once the object is loaded, can be empty
+     @param extras additional arguments to pass to the constructor
+     @return a future for the object, which is ready immediately if the object is cached
+     */
+    template<typename ... A>
+    static inline future_t GetAsyncWithKey(const key_t& str, unique_key_t unique_key, callback_t onLoaded, A ... extras){
+        const cache_key_t key(str, unique_key);
+        Ref<PendingLoad> pending;
+        bool isNew = false;
+        {
+            auto& shard = ShardFor(key);
+            std::lock_guard guard(shard.mtx);
+            if (auto ptr = FindOrBegin(shard, key, pending, isNew, extras...)) {
+                std::promise<Ref<T>> ready;
+                ready.set_value(ptr);
+                if (onLoaded) {
+                    AssetLoadQueue::RunOnMainThread([onLoaded = std::move(onLoaded), ptr] {
+                        onLoaded(ptr);
+                    });
+                }
+                return ready.get_future().share();
+            }
+            if (onLoaded) {
+                pending->callbacks.push_back(std::move(onLoaded));
+            }
         }
-        else {
-            m = std::make_shared<T>(extras...);
+        if (isNew) {
+            AssetLoadQueue::Enqueue(loadPriority, [key, pending] {
+                TryConstruct(key, pending);
+            });
+        }
+        return pending->future;
+    }
+
+    /**
+     Set where asynchronous loads of this type go in the load queue relative to other types. The default is Normal.
+     */
+    static void SetLoadPriority(AssetLoadPriority priority){
+        loadPriority = priority;
+    }
+
+    /**
+     @return the number of live objects in the cache, and their total size if T has a GetMemoryFootprint method
+     */
+    static MemoryReport::Item GetMemoryUsage(){
+        MemoryReport::Item usage;
+        Vector<Ref<T>> live;
+        for (auto& shard : shards) {
+            {
+                std::lock_guard guard(shard.mtx);
+                for (const auto& [key, slot] : shard.slots) {
+                    if (auto ptr = slot.item.lock()) {
+                        live.push_back(std::move(ptr));
+                    }
+                }
+            }
+            // outside the lock, in case this holds the last reference
+            usage.count += live.size();
+            if constexpr (requires(const T& item) { item.GetMemoryFootprint(); }) {
+                for (const auto& item : live) {
+                    usage.bytes += item->GetMemoryFootprint();
+                }
+            }
+            live.clear();
         }
-        items[key] = m;
-        return m;
+        return usage;
     }
 
     /**
      Reduce the size of the cache by removing expired pointers
      */
     static void Compact(){
-        RavEngine::Vector<std::tuple<std::string, unique_key_t>> toremove;
-        for(const auto& entry : items){
-            if (entry.second.expired()){
-                toremove.push_back(entry.first);
+        for (auto& shard : shards) {
+            std::lock_guard guard(shard.mtx);
+            for (auto it = shard.slots.begin(); it != shard.slots.end();) {
+                if (it->second.item.expired() && !it->second.pending) {
+                    shard.slots.erase(it++);
+                }
+                else {
+                    ++it;
+                }
             }
         }
-        for(const auto& c : toremove){
-            items.erase(c);
-        }
     }
     
     /**
      * Remove all items from the cache
      */
     static void Clear(){
-        std::lock_guard guard(mtx);
-        items.clear();
+        for (auto& shard : shards) {
+            std::lock_guard guard(shard.mtx);
+            // loads in progress finish into the cache
+            for (auto it = shard.slots.begin(); it != shard.slots.end();) {
+                if (!it->second.pending) {
+                    shard.slots.erase(it++);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
     }
 };
 }
 template<typename key, typename T, bool keyIsConstructionParam>
-RavEngine::SpinLock RavEngine::GenericWeakReadThroughCache<key,T,keyIsConstructionParam>::mtx;
+RavEngine::Array<typename RavEngine::GenericWeakReadThroughCache<key, T, keyIsConstructionParam>::Shard, RavEngine::GenericWeakReadThroughCache<key, T, keyIsConstructionParam>::numShards> RavEngine::GenericWeakReadThroughCache<key, T, keyIsConstructionParam>::shards;
 
 template<typename key,typename T, bool keyIsConstructionParam>
-RavEngine::UnorderedMap<std::tuple<key, RavEngine::CacheBase::unique_key_t>, WeakRef<T>> RavEngine::GenericWeakReadThroughCache<key, T, keyIsConstructionParam>::items;
-
+std::atomic<RavEngine::AssetLoadPriority> RavEngine::GenericWeakReadThroughCache<key, T, keyIsConstructionParam>::loadPriority = RavEngine::AssetLoadPriority::Normal;
@@ -11,6 +11,9 @@
 #include <RGL/Span.hpp>
 #include <span>
 #include <variant>
+#include <future>
+#include <algorithm>
+#include <chrono>
 #include "MaterialShared.hpp"
 
 namespace RavEngine {
@@ -30,6 +33,7 @@ namespace RavEngine {
 		OpacityMode opacityMode = OpacityMode::Opaque;
 
 		MeshAttributes requiredAttributes;
+		bool variableShadingRate = false;	// drawn in the lit passes, which may shade at a reduced rate. See FoveationSettings
 	};
 
 	
@@ -70,6 +74,20 @@ namespace RavEngine {
 			static inline Ref<T> GetWithKey(RavEngine::CacheBase::unique_key_t key, A&& ... args) {
 				return GenericWeakReadThroughCache<ctti_t, T, false>::GetWithKey(CTTI<T>(), key, args...);
 			}
+
+			/**
+			 Create a material on App::executor, including all of its pipelines. See GenericWeakReadThroughCache::GetAsync.
+			 @param onLoaded called on the main thread once the material exists, can be empty
+			 */
+			template<typename T, typename ... A>
+			static inline auto GetAsync(typename GenericWeakReadThroughCache<ctti_t, T, false>::callback_t onLoaded, A&& ... args) {
+				return GenericWeakReadThroughCache<ctti_t, T, false>::GetAsync(CTTI<T>(), std::move(onLoaded), args...);
+			}
+
+			template<typename T, typename ... A>
+			static inline auto GetAsyncWithKey(RavEngine::CacheBase::unique_key_t key, typename GenericWeakReadThroughCache<ctti_t, T, false>::callback_t onLoaded, A&& ... args) {
+				return GenericWeakReadThroughCache<ctti_t, T, false>::GetAsyncWithKey(CTTI<T>(), key, std::move(onLoaded), args...);
+			}
             
             /**
              Shrink memory usage by removing expired entries
@@ -114,6 +132,60 @@ namespace RavEngine {
 		friend class RenderEngine;
 	};
 
+	/**
+	 Creates materials ahead of the first frame that draws them, so that content appearing mid-game does not stall while
+	 their pipelines compile. Every pipeline of a material, including its shadow and depth prepass variants, is created
+	 with it, on App::executor, and compiles from the on-disk pipeline cache if a previous run created it.
+	 The materials stay alive until the warmup is destroyed, so keep it for as long as the level or pack that uses them.
+	 */
+	class MaterialWarmup {
+		struct Entry {
+			Function<bool()> isReady;
+			Function<void()> wait;
+		};
+		Vector<Entry> entries;
+
+		template<typename F>
+		void Track(F&& future) {
+			entries.push_back({
+				[future] { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; },
+				[future] { future.wait(); }
+			});
+		}
+
+	public:
+		/**
+		 Start creating a material, with the same arguments it would be created with by Material::Manager::Get
+		 */
+		template<typename T, typename ... A>
+		void Add(A&& ... args) {
+			Track(Material::Manager::GetAsync<T>({}, args...));
+		}
+
+		template<typename T, typename ... A>
+		void AddWithKey(CacheBase::unique_key_t key, A&& ... args) {
+			Track(Material::Manager::GetAsyncWithKey<T>(key, {}, args...));
+		}
+
+		/**
+		 @return true if every added material exists. Poll this from a loading screen.
+		 */
+		bool IsReady() const {
+			return std::all_of(entries.begin(), entries.end(), [](const Entry& entry) { return entry.isReady(); });
+		}
+
+		// block until every added material exists
+		void Wait() const {
+			for (const auto& entry : entries) {
+				entry.wait();
+			}
+		}
+
+		auto size() const {
+			return entries.size();
+		}
+	};
+
 
 	struct MaterialRenderOptions  {
 		RGL::CullMode cullMode = RGL::CullMode::Back;
@@ -169,6 +241,11 @@ namespace RavEngine {
 		PipelineUseConfiguration GetMainRenderPipeline()const;
 		PipelineUseConfiguration GetDepthPrepassPipeline() const;
 
+		/**
+		@return the material shared by every instance that draws with the same pipelines
+		*/
+		const Material* GetBaseMaterial() const;
+
 		const MaterialVariant* operator->() const {
 			return this;
 		}
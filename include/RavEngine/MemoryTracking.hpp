@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "Vector.hpp"
+
+namespace RavEngine {
+
+	struct MemoryReport {
+		struct Item {
+			std::string name;
+			size_t bytes = 0;
+			size_t count = 0;		// allocations, components or assets, depending on the section
+		};
+		Vector<Item> pools;				// tagged allocations, such as PhysX and GPU buffers by debug name
+		Vector<Item> componentSets;		// storage of each component type, summed over loaded worlds
+		Vector<Item> assetCaches;		// live assets in each cache. Bytes are only known for some asset types.
+		size_t vramInUseMB = 0;			// as reported by the graphics device, 0 on servers
+
+		/**
+		 @return a table of every item, largest first within each section
+		 */
+		std::string ToString() const;
+	};
+
+	/**
+	 Counters for allocations that are not visible to the system allocator, or that belong to a particular owner. In profile
+	 builds, every tracked allocation is also reported to Tracy under its pool's name.
+	 */
+	namespace MemoryTracking {
+		struct Pool;
+
+		/**
+		 @return the pool with this name, created on first use. Pools live until exit, so callers may keep the pointer.
+		 */
+		Pool* GetPool(std::string_view name);
+
+		void Allocated(Pool* pool, const void* ptr, size_t bytes);
+		void Freed(Pool* pool, const void* ptr, size_t bytes);
+	}
+}
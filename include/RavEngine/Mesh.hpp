@@ -14,6 +14,8 @@ struct SerializedMeshDataHeader{
     uint32_t numVertices = 0;
     uint32_t numIndicies = 0;
     VertexAttrib_t attributes = 0;     // info about the file
+    uint8_t numAdditionalLODs = 0;     // each is a float minimum distance and a complete serialized mesh, following this mesh's data
+    uint8_t impostorFramesPerSide = 0; // if not 0, an impostor follows the LODs, see ImpostorEncoding::ImpostorHeader
 
     constexpr static VertexAttrib_t 
         SkinnedMeshBit = 1 << 0,
@@ -22,10 +24,26 @@ struct SerializedMeshDataHeader{
         hasTangentsBit = 1 << 3,
         hasBitangentsBit = 1 << 4,
         hasUV0Bit = 1 << 5,
-        hasLightmapUVBit = 1 << 6
+        hasLightmapUVBit = 1 << 6,
+        hasMeshletsBit = 1 << 7     // a uint32_t meshlet count and the Meshlets follow the indices
         ;
 };
 
+/**
+ A cluster of triangles that is culled independently of the rest of its mesh.
+ The triangles of a meshlet are contiguous in the mesh's index buffer, so a meshlet can be drawn as an ordinary indexed draw.
+ Layout matches Meshlet in defaultcull.csh.
+ */
+struct Meshlet{
+    uint32_t indexStart = 0;    // relative to the start of the mesh's indices
+    uint32_t indexCount = 0;
+    glm::vec3 center{ 0 };      // bounding sphere, in mesh space
+    float radius = 0;
+    glm::vec3 coneApex{ 0 };    // normal cone, for backface culling the whole meshlet
+    glm::vec3 coneAxis{ 0 };
+    float coneCutoff = 1;       // the meshlet faces away from a viewer at v if dot(normalize(coneApex - v), coneAxis) >= coneCutoff
+};
+
 typedef VertexNormalUV vertex_t;
 
 using VertexPosition_t = decltype(VertexNormalUV::position);
@@ -43,6 +61,7 @@ struct MeshPartBase{
     T<VertexBitangent_t> bitangents;
     T<VertexUV_t> uv0;
     T<VertexUV_t> lightmapUVs;
+    T<Meshlet> meshlets;        // optional, empty if the mesh was not clustered
 
     uint32_t NumVerts() const {
         return positions.size();
@@ -77,6 +96,7 @@ struct MeshPartView : public MeshPartBase<basic_immutable_span>{
         uv0 = { other.uv0.data(),other.uv0.size() };
         lightmapUVs = { other.lightmapUVs.data(),other.lightmapUVs.size() };
         indices = { other.indices.data(), other.indices.size() };
+        meshlets = { other.meshlets.data(), other.meshlets.size() };
         attributes = other.attributes;
     }
 };
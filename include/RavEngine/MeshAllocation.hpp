@@ -1,10 +1,17 @@
 #pragma once
 #include "DataStructures.hpp"
 #include "Mesh.hpp"
+#include "OffsetAllocator.hpp"
 
 namespace RavEngine {
-	using allocation_freelist_t = LinkedList<Range>;
-	using allocation_allocatedlist_t = allocation_freelist_t;
+	/**
+	A range in a shared mesh buffer, and the allocator node that owns it
+	*/
+	struct AllocatedRange : public Range {
+		OffsetAllocator::node_t node = OffsetAllocator::INVALID_NODE;
+	};
+	// records are stable, so compaction can move a range without invalidating the MeshRanges pointing at it
+	using allocation_allocatedlist_t = LinkedList<AllocatedRange>;
 
 	struct MeshRange {
 	private:
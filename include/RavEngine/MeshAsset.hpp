@@ -13,12 +13,16 @@
 #include "MeshAllocation.hpp"
 #include "Mesh.hpp"
 #include "MaterialShared.hpp"
+#include "ImpostorEncoding.hpp"
+#include <optional>
 
 struct aiMesh;
 struct aiScene;
 
 namespace RavEngine{
 
+class Texture;
+
 struct MeshAssetOptions{
     bool keepInSystemRAM = false;
     bool uploadToGPU = true;
@@ -26,6 +30,20 @@ struct MeshAssetOptions{
 
 class MeshAsset {
 public:
+	// a simplified version of this mesh stored in the same asset file
+	struct PackedLOD {
+		Ref<MeshAsset> mesh;
+		float minDistance = 0;
+	};
+
+	// a camera-facing quad and the atlases it samples, stored in the same asset file
+	struct PackedImpostor {
+		Ref<MeshAsset> quad;
+		ImpostorEncoding::ImpostorHeader header;
+#if !RVE_SERVER
+		Ref<Texture> albedoAtlas, normalDepthAtlas;		// null if the mesh was not uploaded to the GPU
+#endif
+	};
 
 	MeshAsset(const MeshAsset&) = delete;
 	MeshAsset(MeshAsset&&) = delete;
@@ -41,6 +59,9 @@ protected:
     Bounds bounds;
     float radius = 0;
 	MeshAttributes attributes;
+	Vector<Meshlet> meshlets;
+	Vector<PackedLOD> packedLODs;
+	std::optional<PackedImpostor> packedImpostor;
 
 	friend class RenderEngine;
 #if !RVE_SERVER
@@ -66,6 +87,24 @@ protected:
 	MeshPart DeserializeMesh(const std::istream& stream);
 	std::pair<MeshPart,uint32_t> DeserializeMeshFromMemory(const std::span<uint8_t> mem);
 
+	/**
+	 Read a serialized mesh without copying it
+	 @param mem the serialized mesh, aligned to 4 bytes. The view points into it.
+	 @return the view, and how many bytes of mem the mesh used
+	 */
+	std::pair<MeshPartView,uint32_t> ViewMeshInMemory(const std::span<const uint8_t> mem);
+
+	/**
+	 Read a serialized mesh, decoding it into storage if it is compressed, or viewing it in place if it is not
+	 @param mem the serialized mesh, aligned to 4 bytes
+	 @param storage holds the decoded mesh. The view points into it or into mem.
+	 @return the view, and how many bytes of mem the mesh used
+	 */
+	std::pair<MeshPartView,uint32_t> ReadMeshInMemory(const std::span<const uint8_t> mem, MeshPart& storage);
+
+	// like InitializeFromRawMeshView, but copies the mesh if options asks to keep it in system RAM
+	void InitializeFromSerializedMesh(const MeshPartView& mp, const MeshAssetOptions& options);
+
     friend class RenderEngine;
 	
 public:
@@ -73,6 +112,27 @@ public:
 	auto GetRadius() const {
 		return radius;
 	}
+
+	/**
+	 @return the meshlets of this mesh, or an empty span if it was not clustered
+	 */
+	std::span<const Meshlet> GetMeshlets() const {
+		return meshlets;
+	}
+
+	/**
+	 @return the LODs that were generated into this mesh's asset file, in the order they were written
+	 */
+	std::span<const PackedLOD> GetPackedLODs() const {
+		return packedLODs;
+	}
+
+	/**
+	 @return the impostor that was baked into this mesh's asset file, or nullptr if it has none. See MeshCollectionStatic::SetImpostor.
+	 */
+	const PackedImpostor* GetPackedImpostor() const {
+		return packedImpostor ? &packedImpostor.value() : nullptr;
+	}
 #if !RVE_SERVER
 	auto GetAllocation() const {
 		return meshAllocation;
@@ -141,6 +201,11 @@ public:
     inline void DeallocSystemCopy(){
 		systemRAMcopy = MeshPart{};
 	}
+
+	/**
+	 @return the bytes of this mesh's vertices and indices in the shared GPU buffers, plus its system RAM copy and meshlets
+	 */
+	size_t GetMemoryFootprint() const;
 };
 
 }
@@ -9,6 +9,7 @@
 namespace RavEngine {
 
 	class MeshAssetSkinned;
+	class MaterialInstance;
 	struct MeshRange;
 	struct SkeletonAsset;
 
@@ -16,11 +17,18 @@ namespace RavEngine {
 	struct MeshCollection {
 		Vector<Ref<T>> meshes;
 		struct Entry {
-			Ref<T> mesh;
+			Ref<T> mesh;			// nullptr draws nothing at this LOD
 			float minDistance = 0;	// the minimum distance from the object to the camera for this LOD to be usable
 		};
 	};
 
+	// where the indirect commands of one LOD start. Matches MeshletLODRange in defaultcull.csh
+	struct LODDrawSlots {
+		uint32_t firstSlot = 0;		// relative to the first indirect command of the mesh collection
+		uint32_t firstMeshlet = 0;
+		uint32_t numMeshlets = 0;	// 0 if the LOD is drawn with a single command
+	};
+
 	struct MeshCollectionStatic : public MeshCollection<MeshAsset> {
 		friend class RenderEngine;
 		MeshCollectionStatic() {}
@@ -46,12 +54,67 @@ namespace RavEngine {
 
 		void SetMeshForLOD(uint32_t i, Ref<MeshAsset> mesh) {
 			meshes.at(i) = mesh;
+			UpdateDrawSlots();
 		}
 
 		float GetRadius() const;
 
+		/**
+		 @return the attributes of the meshes, which all LODs share
+		 */
+		MeshAttributes GetAttributes() const;
+
+		/**
+		 Draw an impostor instead of this collection's meshes beyond a distance. The impostor has its own material, so it is
+		 drawn from a second collection whose LOD 0 is empty, and this collection gets an empty LOD at that distance.
+		 Set it before the collection is given to a StaticMesh or InstancedStaticMesh.
+		 @param quad the camera-facing quad, see MeshAsset::GetPackedImpostor
+		 @param material what to draw the quad with, usually an ImpostorMaterialInstance
+		 @param minDistance the distance from the camera beyond which the impostor is drawn
+		 */
+		void SetImpostor(Ref<MeshAsset> quad, Ref<MaterialInstance> material, float minDistance);
+
+		void SetImpostor(const MeshAsset::PackedImpostor& impostor, Ref<MaterialInstance> material) {
+			SetImpostor(impostor.quad, material, impostor.header.minDistance);
+		}
+
+		void ClearImpostor();
+
+		/**
+		 @return the collection the impostor is drawn from, or nullptr if there is no impostor
+		 */
+		auto GetImpostorCollection() const {
+			return impostor.collection;
+		}
+
+		auto GetImpostorMaterial() const {
+			return impostor.material;
+		}
+
+		/**
+		 @return the number of indirect commands needed to draw every LOD. LODs with meshlets use one command per meshlet.
+		 */
+		auto GetNumDrawSlots() const {
+			return numDrawSlots;
+		}
+
+		bool HasMeshlets() const {
+			return meshletData.Size() > 0;
+		}
+
 	private:
+		void UpdateDrawSlots();
+
 		BufferedVRAMVector<float> lodDistances;
+		BufferedVRAMVector<LODDrawSlots> lodDrawSlots;
+		BufferedVRAMVector<Meshlet> meshletData;	// the meshlets of every LOD
+		uint32_t numDrawSlots = 0;
+
+		struct {
+			Ref<MeshCollectionStatic> collection;
+			Ref<MaterialInstance> material;
+			uint32_t emptyLOD = 0;		// the LOD of this collection that hides the meshes where the impostor is drawn
+		} impostor;
 	};
 
 	struct MeshCollectionSkinned : protected MeshCollection<MeshAssetSkinned> {
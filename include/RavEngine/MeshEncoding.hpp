@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+
+// shared by the engine and rvemc
+
+namespace RavEngine::MeshEncoding {
+
+	/**
+	 A mesh part whose SerializedMeshDataHeader has this magic instead of "rvem" is quantized and compressed. After the
+	 header is an EncodedMeshHeader, then the meshopt-encoded position, attribute and index streams, each padded to 4 bytes,
+	 then the meshlets as in an uncompressed mesh. Vertices are decoded to full precision when the mesh is loaded.
+	 */
+	constexpr std::array<char, 4> magic{ 'r','v','e','q' };
+
+	struct EncodedMeshHeader {
+		glm::vec3 boundsMin{ 0 };			// quantized positions are boundsMin + q / 65535 * boundsExtent
+		glm::vec3 boundsExtent{ 0 };
+		uint32_t positionStreamSize = 0;	// bytes, before padding
+		uint32_t attributeStreamSize = 0;
+		uint32_t indexStreamSize = 0;
+		uint8_t quantizedPositions = 0;		// if 0, positions are FullPosition instead of QuantizedPosition
+		uint8_t padding[3]{};
+	};
+	static_assert(sizeof(EncodedMeshHeader) == 40);
+
+	// the bitangent is the sign times cross(normal, tangent)
+	struct QuantizedPosition {
+		uint16_t x = 0, y = 0, z = 0;
+		uint16_t bitangentSign = 0;			// 1 if negative
+	};
+	static_assert(sizeof(QuantizedPosition) == 8);
+
+	struct FullPosition {
+		glm::vec3 position{ 0 };
+		float bitangentSign = 1;
+	};
+	static_assert(sizeof(FullPosition) == 16);
+
+	struct QuantizedAttributes {
+		int16_t normal[2]{};				// octahedral, snorm
+		int16_t tangent[2]{};
+		uint16_t uv0[2]{};					// half floats
+		uint16_t lightmapUV[2]{};
+	};
+	static_assert(sizeof(QuantizedAttributes) == 16);
+
+	constexpr uint32_t Padded(uint32_t size) {
+		return (size + 3) & ~3u;
+	}
+
+	inline void EncodeOctahedral(glm::vec3 n, int16_t out[2]) {
+		const float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		if (sum == 0) {
+			out[0] = out[1] = 0;
+			return;
+		}
+		n /= sum;
+		glm::vec2 p{ n.x, n.y };
+		if (n.z < 0) {
+			p = glm::vec2((1 - std::abs(n.y)) * (n.x >= 0 ? 1 : -1), (1 - std::abs(n.x)) * (n.y >= 0 ? 1 : -1));
+		}
+		out[0] = int16_t(std::lround(std::clamp(p.x, -1.f, 1.f) * 32767));
+		out[1] = int16_t(std::lround(std::clamp(p.y, -1.f, 1.f) * 32767));
+	}
+
+	inline glm::vec3 DecodeOctahedral(const int16_t in[2]) {
+		glm::vec3 n{ std::max(in[0] / 32767.f, -1.f), std::max(in[1] / 32767.f, -1.f), 0 };
+		n.z = 1 - std::abs(n.x) - std::abs(n.y);
+		const float t = std::max(-n.z, 0.f);
+		n.x += n.x >= 0 ? -t : t;
+		n.y += n.y >= 0 ? -t : t;
+		return glm::normalize(n);
+	}
+
+	inline uint16_t QuantizeUnorm16(float value, float min, float extent) {
+		return extent > 0 ? uint16_t(std::lround(std::clamp((value - min) / extent, 0.f, 1.f) * 65535)) : 0;
+	}
+
+	inline float DequantizeUnorm16(uint16_t value, float min, float extent) {
+		return min + value / 65535.f * extent;
+	}
+
+	inline void EncodeHalf2(glm::vec2 value, uint16_t out[2]) {
+		out[0] = glm::packHalf1x16(value.x);
+		out[1] = glm::packHalf1x16(value.y);
+	}
+
+	inline glm::vec2 DecodeHalf2(const uint16_t in[2]) {
+		return { glm::unpackHalf1x16(in[0]), glm::unpackHalf1x16(in[1]) };
+	}
+
+	inline float BitangentSign(glm::vec3 normal, glm::vec3 tangent, glm::vec3 bitangent) {
+		return glm::dot(glm::cross(normal, tangent), bitangent) < 0 ? -1.f : 1.f;
+	}
+}
@@ -2,6 +2,8 @@
 #include "Queryable.hpp"
 #include "IDebugRenderable.hpp"
 #include "Vector.hpp"
+#include <memory>
+#include <span>
 
 class dtNavMesh;
 class dtNavMeshQuery;
@@ -9,15 +11,7 @@ class dtNavMeshQuery;
 namespace RavEngine{
 
     class NavMeshComponent : public IDebugRenderable, public Queryable<NavMeshComponent,IDebugRenderable>{
-    private:
-        dtNavMesh* navMesh = nullptr;
-        dtNavMeshQuery* navMeshQuery = nullptr;
-        unsigned char* navData = nullptr;
-        Bounds bounds;
-        mutable SpinLock mtx;
-
     public:
-		using Queryable<NavMeshComponent,IDebugRenderable>::GetQueryTypes;
         struct Options{
             float cellSize = 0.3f;
             float cellHeight = 0.2f;
@@ -26,42 +20,149 @@ namespace RavEngine{
             float maxVertsPerPoly = 6.f;
             float detailSampleDist = 6.f;
             float detailSampleMaxError = 1.f;
-            
+
             struct Agent{
                 float height = 2.0f;
                 float radius = 0.6f;
                 float maxClimb = 0.9f;
                 float maxSlope = 45.f;
             } agent;
-           
+
             float regionMinDimension = 8.f;
             float regionMergeDimension = 20.f;
-            
+
             enum PartitionMethod{
                 Watershed,  // best but slowest
                 Monotone,   // worst but fastest
                 Layer       // compromise, good for tiled w/ small-medium tiles
             } partitionMethod = Watershed;
-            
+
+            // if nonzero, the navmesh is built as square tiles of this many cells per side, so changes only rebuild the tiles they touch
+            uint16_t tileSize = 0;
+        };
+
+        struct PathRequest{
+            vector3 start, end;     // in local coordinates to the owning entity
+            uint16_t maxPoints = 256;
+        };
+
+        struct PathResult{
+            RavEngine::Vector<vector3> points;
+            bool found = false;
+        };
+
+        enum class PathStatus : uint8_t{
+            Pending,    // queued or partially searched, see UpdatePaths
+            Found,
+            Failed,     // no route, or the start or end is not near the navmesh
+            Unknown     // the handle was never issued, was already taken, or was cancelled
         };
-        
+
+        using PathHandle = uint32_t;
+
+    private:
+        struct BuildState;
+        struct PathQueries;
+        dtNavMesh* navMesh = nullptr;
+        std::shared_ptr<BuildState> build;
+        std::shared_ptr<PathQueries> queries;     // also holds the navmesh lock, which path queries share
+        Bounds bounds;
+
+        // swap in the tiles rebuilt in the background, once all of them are done. Call with the navmesh locked exclusively.
+        void ApplyRebuiltTiles();
+
+        // lock the navmesh exclusively to apply rebuilt tiles, only if there are some to apply
+        void ApplyRebuiltTilesIfReady();
+
+        // rebuild the area in the background in tiled mode, or all of it now otherwise. Call with the navmesh locked exclusively.
+        void RebuildArea(const float* bmin, const float* bmax);
+
+    public:
+		using Queryable<NavMeshComponent,IDebugRenderable>::GetQueryTypes;
+
         /**
-         Construct a mesh asset 
+         Construct a mesh asset
          */
         NavMeshComponent(Ref<MeshAsset> mesh, Options opt);
-        
+
+        /**
+         Build the navmesh from a mesh, replacing the current one. In tiled mode, the tiles are built in parallel.
+         */
         void UpdateNavMesh(Ref<MeshAsset> mesh, Options opt);
-        
+
+        /**
+         Rebuild the part of the navmesh in a box after the mesh changed there, for example when a door opens. In tiled mode, only the
+         tiles the box overlaps are rebuilt, in the background, and they replace the old tiles together once all are done. Otherwise
+         the whole navmesh is rebuilt now. The area the navmesh covers stays that of the last UpdateNavMesh.
+         @param min the minimum corner of the box, in local coordinates to the owning entity
+         @param max the maximum corner of the box
+         */
+        void UpdateNavMeshArea(Ref<MeshAsset> mesh, const vector3& min, const vector3& max);
+
+        /**
+         Make a box unwalkable without changing the mesh, for example for a closed door or a placed crate. Rebuilds like UpdateNavMeshArea.
+         @param min the minimum corner of the box, in local coordinates to the owning entity
+         @param max the maximum corner of the box
+         @return an identifier for RemoveObstacle
+         */
+        uint32_t AddObstacle(const vector3& min, const vector3& max);
+
+        void RemoveObstacle(uint32_t id);
+
         /**
-         Calculate a route between two points
+         @return true while tiles are rebuilding in the background. Paths use the old tiles until all are done.
+         */
+        bool IsRebuilding() const;
+
+        /**
+         Calculate a route between two points. Thread safe, paths on other threads are calculated at the same time.
          @param start the start location of the path, in local coordinates to the owning entity
          @param end the end location of the path, in local coordinates to the owning entity
          @return list of coordinates composing the path
          */
         RavEngine::Vector<vector3> CalculatePath(const vector3& start, const vector3& end, uint16_t maxPoints = std::numeric_limits<uint16_t>::max());
-        
+
+        /**
+         Calculate many routes in parallel on the executor. Unlike CalculatePath, a route that cannot be found is not an error.
+         @param requests the routes to calculate
+         @param results one per request, reusing the memory of their points
+         */
+        void CalculatePaths(std::span<const PathRequest> requests, std::span<PathResult> results);
+
+        /**
+         Queue a route to be searched a little at a time by UpdatePaths, so long routes do not stall the caller.
+         @return a handle for GetPathStatus and TakePath
+         */
+        PathHandle BeginPath(const PathRequest& request);
+
+        /**
+         Search the queued routes in order, stopping once the budget is spent. Invoke this once per tick from the system that
+         owns the agents.
+         @param maxIterations the number of navmesh nodes to visit, across all routes
+         @return the number of routes still pending
+         */
+        uint32_t UpdatePaths(int maxIterations);
+
+        PathStatus GetPathStatus(PathHandle handle) const;
+
+        /**
+         Take the points of a route that is no longer pending, and forget the handle
+         @return the status of the route. The points are only written if it is Found.
+         */
+        PathStatus TakePath(PathHandle handle, RavEngine::Vector<vector3>& points);
+
+        void CancelPath(PathHandle handle);
+
+        /**
+         Reuse the results of routes whose start and end fall in the same cells of a grid, and that have the same maxPoints.
+         The cache is cleared whenever the navmesh changes.
+         @param quantization the size of the grid cells, or 0 to disable the cache
+         @param maxEntries the cache is cleared once it holds this many routes
+         */
+        void SetPathCache(float quantization, uint32_t maxEntries = 1024);
+
         void DebugDraw(class RavEngine::DebugDrawer& dbg, const struct RavEngine::Transform& tr) const override;
-                
+
         virtual ~NavMeshComponent();
     };
 }
@@ -1,27 +1,89 @@
 #pragma once
 #include <atomic>
 #include <thread>
+#include <memory>
 #include "Uuid.hpp"
 #include "SpinLock.hpp"
 #include "DataStructures.hpp"
 #include "Entity.hpp"
+#include "RPCBatch.hpp"
+#include "NetworkIDTable.hpp"
+#include "NetworkStats.hpp"
+#include "Vector.hpp"
+#include <chrono>
 #include <steam/steamnetworkingtypes.h>
 
+class ISteamNetworkingSockets;
+
 namespace RavEngine{
 
 class NetworkBase{
     friend class NetworkManager;
+    friend class RPCComponent;
 protected:
 	std::thread worker;
 	std::atomic<bool> workerIsRunning = false;
 	std::atomic<bool> workerHasStopped = true;
 
+	constexpr static int receiveBatchSize = 256;		// messages taken from the networking library per call
+
+	// sleep the worker for a short while, invoked when nothing was received
+	static void WaitForMessages();
+
+
+    //Track all the networkidentities by their session IDs
+    NetworkIDTable<Entity> NetworkIdentities;
+
+	// RPCs waiting to be sent to one connection, by reliability class
+	struct OutgoingRPCs {
+		RPCBatch unreliable, reliable;
+	};
+
+	/**
+	 Pack the RPCs queued for a connection into networking messages
+	 @param messages receives the messages, to pass to SendMessages
+	 */
+	static void PackRPCs(HSteamNetConnection connection, OutgoingRPCs& outgoing, Vector<SteamNetworkingMessage_t*>& messages);
 
-    //Track all the networkidentities by their IDs
-    locked_node_hashmap<uuids::uuid, Entity,SpinLock> NetworkIdentities;
+	// send the messages in one call, and clear them
+	void SendMessages(ISteamNetworkingSockets* net_interface, Vector<SteamNetworkingMessage_t*>& messages) const;
+
+	// counted from the send and receive paths, and read with GetStats
+	mutable NetworkStats stats;
+	mutable SpinLock statsLock;
+	NetworkStats::Traffic lastPlottedTraffic;		// main thread only
+
+	void RecordSent(HSteamNetConnection connection, size_t bytes, int flags) const;
+	void RecordReceived(HSteamNetConnection connection, size_t bytes) const;
+	void RecordRPCSent(const std::string_view& msg) const;
+	void RecordRPCReceived(const std::string_view& msg) const;
+	void RecordRPCSerialized(uint16_t id, std::chrono::nanoseconds time) const;
+	void RecordRPCHandled(uint16_t id, std::chrono::nanoseconds time) const;
+	void ForgetConnection(HSteamNetConnection connection);
+
+	/**
+	 Copy the counters, and fill in the status of each connection
+	 */
+	NetworkStats CollectStats(ISteamNetworkingSockets* net_interface) const;
+
+	/**
+	 @return the traffic of all connections since the last call
+	 */
+	NetworkStats::Traffic TakeTrafficSinceLastPlot();
 
 public:
+
+	// a received message, released once everything that reads from it is done
+	using MessageRef = std::shared_ptr<SteamNetworkingMessage_t>;
+
+	/**
+	 Take ownership of a received message
+	 */
+	static MessageRef TakeMessage(SteamNetworkingMessage_t* message);
 	
+	// the number of snapshots kept for delta encoding. A client that falls further behind is sent a full snapshot.
+	constexpr static uint32_t replicationHistory = 32;
+
 	enum Reliability{
 		Unreliable = k_nSteamNetworkingSend_Unreliable,
 		Reliable = k_nSteamNetworkingSend_Reliable
@@ -34,7 +96,12 @@ public:
 			RPC,
             OwnershipToThis,	// receive on client
             OwnershipRevoked,	// receive on client
-			ClientRequestingWorldSynchronization	// receive on server
+			ClientRequestingWorldSynchronization,	// receive on server
+			Replicate,			// receive on client
+			ReplicationAck,		// receive on server
+			BatchedRPCs,		// several RPC commands, see RPCBatch
+			CompactRPC,			// an RPC with one signature for all its parameters
+			SpawnBatch			// receive on client, see SpawnBatch
 		};
 	};
 };
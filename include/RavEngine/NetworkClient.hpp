@@ -6,12 +6,15 @@
 #include "ComponentHandle.hpp"
 #include "Function.hpp"
 #include "Ref.hpp"
+#include "Array.hpp"
+#include <memory>
 
 namespace RavEngine {
 	class World;
 	struct Entity;
 	class World;
 	struct NetworkIdentity;
+	class ReplicationSnapshot;
 
 class NetworkClient : public NetworkBase{
     UnorderedMap<ctti_t, Function<void(Entity, Ref<World>)>> OnNetSpawnHooks;
@@ -26,7 +29,32 @@ public:
 
 	void SendMessageToServer(const std::string_view& msg, Reliability mode) const;
 
-	void OnRPC(const std::string_view& cmd);
+	/**
+	Queue an RPC for the server. Queued RPCs are packed into as few messages as possible and sent at the end of the tick.
+	@param coalesce replace an RPC with the same entity and id queued this tick, instead of sending both
+	*/
+	void QueueRPC(const std::string_view& msg, Reliability mode, bool coalesce);
+
+	/**
+	Send the queued RPCs. Invoked automatically at the end of the tick.
+	*/
+	void FlushRPCs();
+
+	/**
+	@return what was sent to and received from the server, and per RPC id. Thread safe.
+	*/
+	NetworkStats GetStats() const;
+
+	/**
+	Plot this tick's traffic in the profiler. Invoked automatically at the end of the tick.
+	*/
+	void PlotStats();
+
+	/**
+	Route a received RPC to its entity
+	@param source the message cmd points into, kept alive until the RPC is processed
+	*/
+	void OnRPC(const std::string_view& cmd, const MessageRef& source);
 
 	void SendSyncWorldRequest(Ref<World> world);
 
@@ -50,6 +78,15 @@ protected:
      @param cmd the raw command from server
      */
     void NetSpawn(const std::string_view& cmd);
+
+    /**
+     Invoked when a batch of spawn commands is received, while synchronizing a world
+     @param cmd the raw command from server
+     */
+    void NetSpawnBatch(const std::string_view& cmd);
+
+    // create an entity the server spawned. Main thread only.
+    void SpawnFromServer(ctti_t id, netid_t sessionID, const uuids::uuid& uuid, Ref<World> world);
     
     /**
      Invoked when destroy command is received
@@ -60,6 +97,24 @@ protected:
 	void OwnershipRevoked(const std::string_view& cmd);
 	void OwnershipToThis(const std::string_view& cmd);
 
+	/**
+	 Invoked when a replication snapshot is received. Rebuilds it from its baseline, acknowledges it, and applies it on the main thread.
+	 @param cmd the raw command from server
+	 */
+	void OnReplicate(const std::string_view& cmd);
+
+	// set the replicated fields. Main thread only.
+	void ApplySnapshot(std::shared_ptr<const ReplicationSnapshot> snapshot);
+
+	// the last replicationHistory snapshots rebuilt on the worker, indexed by sequence
+	Array<std::shared_ptr<const ReplicationSnapshot>, replicationHistory> receivedSnapshots;
+	uint32_t lastReceivedSequence = 0;
+	std::shared_ptr<const ReplicationSnapshot> lastAppliedSnapshot;		// main thread only
+
+	OutgoingRPCs outgoingRPCs;
+	SpinLock outgoingRPCsLock;
+	Vector<SteamNetworkingMessage_t*> outgoingMessages;		// reused by FlushRPCs
+
 	static NetworkClient* currentClient;
 };
 
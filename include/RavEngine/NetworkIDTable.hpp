@@ -0,0 +1,131 @@
+#pragma once
+#include "Vector.hpp"
+#include "SpinLock.hpp"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace RavEngine {
+
+	/**
+	 Identifies a networked entity on the wire for one session, assigned by the server when the entity spawns. The low bits index
+	 a NetworkIDTable, the high bits count how many times that slot was reused, so a message for a destroyed entity misses
+	 instead of reaching a newer one. 0 is never assigned.
+	 */
+	using netid_t = uint32_t;
+
+	/**
+	 Maps session IDs to values in a dense array. Thread safe.
+	 */
+	template<typename T>
+	class NetworkIDTable {
+	public:
+		constexpr static netid_t invalid = 0;
+		constexpr static uint32_t indexBits = 20;
+		constexpr static uint32_t maxSlots = 1 << indexBits;
+
+		constexpr static uint32_t IndexOf(netid_t id) {
+			return id & (maxSlots - 1);
+		}
+
+		/**
+		 Assign a new session ID. Server only.
+		 @return the ID, or invalid if every slot is in use
+		 */
+		netid_t Allocate(const T& value) {
+			std::lock_guard lock(mtx);
+			uint32_t index;
+			// slots are reused first-in first-out, so a slot is reused as late as possible
+			if (!freeSlots.empty()) {
+				index = freeSlots.front();
+				freeSlots.pop_front();
+			}
+			else if (slots.size() < maxSlots) {
+				index = uint32_t(slots.size());
+				slots.emplace_back();
+			}
+			else {
+				return invalid;
+			}
+			auto& slot = slots[index];
+			slot.generation = NextGeneration(slot.generation);
+			slot.value = value;
+			slot.occupied = true;
+			return (slot.generation << indexBits) | index;
+		}
+
+		/**
+		 Store a value under an ID assigned by the server, replacing an older entity in its slot. Client only.
+		 */
+		void Set(netid_t id, const T& value) {
+			std::lock_guard lock(mtx);
+			const auto index = IndexOf(id);
+			if (index >= slots.size()) {
+				slots.resize(index + 1);
+			}
+			auto& slot = slots[index];
+			slot.generation = id >> indexBits;
+			slot.value = value;
+			slot.occupied = true;
+		}
+
+		/**
+		 @return true if the ID was in the table
+		 */
+		bool Erase(netid_t id) {
+			std::lock_guard lock(mtx);
+			auto slot = Lookup(id);
+			if (!slot) {
+				return false;
+			}
+			slot->occupied = false;
+			slot->value = {};
+			freeSlots.push_back(IndexOf(id));
+			return true;
+		}
+
+		/**
+		 @return a copy of the value with the ID, or nothing if the ID is not in the table
+		 */
+		std::optional<T> Find(netid_t id) const {
+			std::lock_guard lock(mtx);
+			std::optional<T> result;
+			if (auto slot = const_cast<NetworkIDTable*>(this)->Lookup(id)) {
+				result.emplace(slot->value);
+			}
+			return result;
+		}
+
+		void Clear() {
+			std::lock_guard lock(mtx);
+			slots.clear();
+			freeSlots.clear();
+		}
+
+	private:
+		struct Slot {
+			T value{};
+			uint32_t generation = 0;
+			bool occupied = false;
+		};
+		Vector<Slot> slots;
+		std::deque<uint32_t> freeSlots;
+		mutable SpinLock mtx;
+
+		static uint32_t NextGeneration(uint32_t generation) {
+			// skip 0 so that no ID is invalid
+			generation = (generation + 1) & ((1 << (32 - indexBits)) - 1);
+			return generation == 0 ? 1 : generation;
+		}
+
+		Slot* Lookup(netid_t id) {
+			const auto index = IndexOf(id);
+			if (id == invalid || index >= slots.size()) {
+				return nullptr;
+			}
+			auto& slot = slots[index];
+			return slot.occupied && slot.generation == (id >> indexBits) ? &slot : nullptr;
+		}
+	};
+}
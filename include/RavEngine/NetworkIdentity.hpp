@@ -2,6 +2,7 @@
 #include "ComponentWithOwner.hpp"
 #include "Queryable.hpp"
 #include "Uuid.hpp"
+#include "NetworkIDTable.hpp"
 #include <steam/isteamnetworkingutils.h>
 
 namespace RavEngine {
@@ -9,6 +10,10 @@ namespace RavEngine {
 	private:
         uuids::uuid NetworkID;
 		ctti_t NetTypeID = 0;		// the CTTI type of the T when it was constructed via Instantiate<T>, on clients this is set to 0
+		netid_t SessionID = NetworkIDTable<Entity>::invalid;		// identifies the entity in messages, set when it spawns
+
+		friend class NetworkServer;
+		friend class NetworkClient;
 	public:
 				
 		//default constructor - used on Server (triggers spawn message)
@@ -28,9 +33,17 @@ namespace RavEngine {
 		inline decltype(NetTypeID) GetNetTypeID() const {
 			return NetTypeID;
 		}
+
+		// the NetworkID is stable across sessions, the SessionID is only meaningful to the current server and its clients
+		inline netid_t GetSessionID() const {
+			return SessionID;
+		}
 		
 		HSteamNetConnection Owner = k_HSteamNetConnection_Invalid;	
 
+		// with NetworkServer::EnableRelevancy, spawn and replicate this entity on every client regardless of distance
+		bool AlwaysRelevant = false;
+
 		/** On the server:
 		*	invalid = the server has ownership
 		*	<any number> = the machine on the specified connection has ownership
@@ -103,12 +103,12 @@ namespace RavEngine {
 		/**
 		Spawn a networkidentity. For internal use only, called by the world
 		*/
-		void Spawn(World* source, ctti_t type_id, Entity ent_id, const uuids::uuid& entity_id);
+		void Spawn(World* source, ctti_t type_id, Entity ent_id, NetworkIdentity& identity);
 
 		/**
 		Spawn a networkidentity. For internal use only, called by the world
 		*/
-		void Destroy(const uuids::uuid& entity_id);
+		void Destroy(const NetworkIdentity& identity);
 	};
 
 }
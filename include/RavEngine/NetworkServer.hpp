@@ -7,7 +7,14 @@
 #include <phmap.h>
 #include "Function.hpp"
 #include "ComponentHandle.hpp"
+#include "ReplicationSnapshot.hpp"
+#include "Array.hpp"
+#include "mathtypes.hpp"
 #include <string_view>
+#include <string>
+#include <span>
+#include <optional>
+#include <deque>
 
 namespace RavEngine {
 	struct Entity;
@@ -21,8 +28,8 @@ public:
 	~NetworkServer();	//calls stop
 	static void SteamNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t*);
 
-	void SpawnEntity(World*, ctti_t, Entity, const uuids::uuid&);
-	void DestroyEntity(const uuids::uuid&);
+	void SpawnEntity(World*, ctti_t, Entity, NetworkIdentity&);
+	void DestroyEntity(const NetworkIdentity&);
 
 	void SendMessageToAllClients(const std::string_view& msg, Reliability mode) const;
 
@@ -30,6 +37,17 @@ public:
 
 	void SendMessageToAllClientsExcept(const std::string_view& msg, HSteamNetConnection connection, Reliability mode) const;
 
+	/**
+	Assemble a message for each of a set of clients on the App::executor workers, then send them all in one call.
+	Use it for per-client encoding, such as replication filtered by relevancy.
+	@param encode writes the message for a client into an empty string, or leaves it empty to send nothing. It is invoked concurrently,
+	once per client, so it may only write state that belongs to that client.
+	*/
+	void SendMessagePerClient(std::span<const HSteamNetConnection> connections, const Function<void(HSteamNetConnection, std::string&)>& encode, Reliability mode) const;
+
+	// sends to fewer clients than this assemble their messages on the calling thread, where scheduling would cost more than it saves
+	uint32_t minClientsForParallelSend = 32;
+
 	/**
 	* Disconnect a client from the server
 	* @param the connection handle to disconnect
@@ -44,16 +62,88 @@ public:
 	@param object the networkidentity to udpate the ownership of
 	*/
 	void ChangeOwnership(HSteamNetConnection newOwner, ComponentHandle<NetworkIdentity> object);
+
+	struct RelevancySettings {
+		float radius = 100;		// entities further than this from a client's viewpoint are not relevant to it
+		float cellSize = 50;	// of the grid entities are bucketed into every tick. Near the radius is best.
+	};
+
+	/**
+	Spawn, destroy, replicate and send client RPCs only for the entities relevant to each client, instead of every entity to every client.
+	An entity is relevant to a client if it is AlwaysRelevant, has no Transform, is owned by the client, or is within the radius of
+	the client's viewpoint and IsRelevantTo accepts it. Clients without a viewpoint only get the first three. Call before clients connect.
+	*/
+	void EnableRelevancy(const RelevancySettings& settings);
+
+	/**
+	Set where a client is looking from, usually the position of its player. Main thread only.
+	*/
+	void SetClientViewpoint(HSteamNetConnection connection, const vector3& position);
+
+	// team or visibility rules, consulted for the entities in range of a client. Invoked on the main thread.
+	Function<bool(HSteamNetConnection, const NetworkIdentity&)> IsRelevantTo;
+
+	/**
+	Spawn the entities of a world that became relevant to each client, and destroy those that stopped being relevant.
+	Invoked automatically on the main thread after the worlds tick.
+	*/
+	void UpdateRelevancy(World* world);
+
+	/**
+	Queue an RPC for a client. Queued RPCs are packed into as few messages as possible and sent at the end of the tick.
+	@param coalesce replace an RPC with the same entity and id queued this tick, instead of sending both
+	*/
+	void QueueRPC(const std::string_view& msg, HSteamNetConnection connection, Reliability mode, bool coalesce);
+
+	/**
+	Queue an RPC about an entity for every client it is relevant to, or for every client if relevancy is not enabled. Main thread only.
+	@param except a client not to send to
+	*/
+	void QueueEntityRPC(const std::string_view& msg, netid_t id, Reliability mode, bool coalesce, HSteamNetConnection except = k_HSteamNetConnection_Invalid);
+
+	/**
+	Send the queued RPCs. Invoked automatically at the end of the tick.
+	*/
+	void FlushRPCs();
+
+	/**
+	Send the next spawn batches to clients synchronizing a world, as fast as their connections drain. Invoked automatically at the end of the tick.
+	*/
+	void StreamWorldSynchronization();
+
+	// a client synchronizing a world is sent more spawn batches while less than this is waiting to be sent to it
+	int maxPendingSynchronizationBytes = 256 * 1024;
+
+	/**
+	Record the ReplicationComponents of a world into this tick's snapshot. Invoked automatically on the main thread after the worlds tick.
+	*/
+	void CaptureReplicatedState(World* world);
+
+	/**
+	Send this tick's snapshot to every client as one unreliable message, encoded against the last snapshot the client acknowledged.
+	Invoked automatically after CaptureReplicatedState.
+	*/
+	void SendReplicationSnapshot();
+
+	/**
+	@return what was sent to and received from each client, and per RPC id. Thread safe.
+	*/
+	NetworkStats GetStats() const;
+
+	/**
+	Plot this tick's traffic in the profiler. Invoked automatically at the end of the tick.
+	*/
+	void PlotStats();
 		
 	//attach event listeners here
 	Function<void(HSteamNetConnection)> OnClientConnecting, OnClientConnected, OnClientDisconnected;
     
-    std::string CreateSpawnCommand(const uuids::uuid& id, ctti_t type, std::string_view& worldID);
+    std::string CreateSpawnCommand(const NetworkIdentity& identity, const std::string_view& worldID);
 
-    std::string CreateDestroyCommand(const uuids::uuid& id);
+    std::string CreateDestroyCommand(netid_t id);
 	
 protected:
-	void OnRPC(const std::string_view& cmd, HSteamNetConnection);
+	void OnRPC(const std::string_view& cmd, HSteamNetConnection, const MessageRef& source);
 
 	ISteamNetworkingSockets *net_interface = nullptr;
 	HSteamListenSocket listenSocket = k_HSteamListenSocket_Invalid;
@@ -77,6 +167,38 @@ protected:
 	//invoked when clients request to have their worlds synchronized
 	void SynchronizeWorldToClient(HSteamNetConnection connection, const std::string_view& in_message);
 
+	void OnReplicationAck(const std::string_view& cmd, HSteamNetConnection connection);
+
+	// the last replicationHistory snapshots, indexed by sequence
+	Array<ReplicationSnapshot, replicationHistory> replicationHistoryRing;
+	uint32_t replicationSequence = 0;
+	bool replicationCaptureBegun = false;
+
+	// the newest snapshot each client has acknowledged, written by the worker
+	locked_hashmap<HSteamNetConnection, uint32_t, SpinLock> replicationAcks;
+
+	struct ClientInterest {
+		std::optional<vector3> viewpoint;
+		UnorderedMap<std::string, UnorderedSet<netid_t>> spawned;		// per world the client synchronized, the entities spawned on it
+		Array<Vector<uint32_t>, replicationHistory> replicated;			// per snapshot, the entities the client was sent
+
+		bool IsSpawned(netid_t id) const;
+	};
+	std::optional<RelevancySettings> relevancy;
+
+	// the entities of a world a client has yet to be sent
+	struct WorldSynchronization {
+		std::string worldID;
+		Vector<netid_t> entities;
+		size_t next = 0;
+	};
+	UnorderedMap<HSteamNetConnection, std::deque<WorldSynchronization>> synchronizations;	// main thread only
+
+	UnorderedMap<HSteamNetConnection, OutgoingRPCs> outgoingRPCs;
+	SpinLock outgoingRPCsLock;
+	Vector<SteamNetworkingMessage_t*> outgoingMessages;		// reused by FlushRPCs
+	UnorderedMap<HSteamNetConnection, ClientInterest> interests;		// main thread only
+
 public:
 	/**
 	* Get the internal client structure. Note that to track application-specific client data, create your own datastructure and add event listeners to the OnConnecting, Ondisconnected, etc functions and track it yourself.
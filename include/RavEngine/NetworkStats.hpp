@@ -0,0 +1,45 @@
+#pragma once
+#include "Map.hpp"
+#include <chrono>
+#include <cstdint>
+#include <steam/steamnetworkingtypes.h>
+
+namespace RavEngine {
+
+	/**
+	 What a NetworkServer or NetworkClient sent and received. Counts are totals since the connection opened, or since the
+	 first call for an RPC, so read them twice and subtract for a rate.
+	 */
+	struct NetworkStats {
+		struct Traffic {
+			uint64_t messagesSent = 0, bytesSent = 0;
+			uint64_t reliableMessagesSent = 0, reliableBytesSent = 0;		// included in the above
+			uint64_t messagesReceived = 0, bytesReceived = 0;
+		};
+
+		struct Connection {
+			Traffic traffic;
+
+			// the rest is the networking library's view of the connection when the stats were read
+			int pingMs = -1;
+			float qualityLocal = 0, qualityRemote = 0;		// the fraction of packets delivered from the peer and to the peer, 1 is no loss
+			float inBytesPerSec = 0, outBytesPerSec = 0;
+			int sendRateBytesPerSec = 0;					// the estimated capacity of the connection
+			int pendingReliableBytes = 0, pendingUnreliableBytes = 0;	// waiting to be put on the wire
+			int64_t queueTimeUsec = 0;						// how long a message sent now would wait before being put on the wire
+		};
+
+		struct RPC {
+			using duration_t = std::chrono::nanoseconds;
+			uint64_t calls = 0;								// invocations on this side, each serialized once
+			uint64_t messagesSent = 0, bytesSent = 0;		// one per recipient, before batching
+			uint64_t messagesReceived = 0, bytesReceived = 0;
+			uint64_t handled = 0;							// received RPCs that were run
+			duration_t serializeTime{ 0 };					// over all calls
+			duration_t handleTime{ 0 };						// deserializing and running, over all handled
+		};
+
+		UnorderedMap<HSteamNetConnection, Connection> connections;
+		UnorderedMap<uint16_t, RPC> rpcs;				// by RPC id
+	};
+}
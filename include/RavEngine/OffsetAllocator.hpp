@@ -0,0 +1,113 @@
+#pragma once
+#include "Vector.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace RavEngine {
+    /**
+     A two-level segregated fit (TLSF) allocator over a range of offsets. It does not own any memory, it only
+     decides where allocations go, so it can manage GPU buffers. Allocating and freeing are O(1): free regions are
+     binned by size on a floating-point-like scale, and a pair of bitmasks finds a fitting bin without searching.
+     Neighbouring free regions are merged when freed.
+     */
+    class OffsetAllocator {
+    public:
+        using node_t = uint32_t;
+        constexpr static node_t INVALID_NODE = std::numeric_limits<node_t>::max();
+
+        struct Allocation {
+            uint32_t offset = 0;
+            node_t node = INVALID_NODE;
+
+            bool IsValid() const {
+                return node != INVALID_NODE;
+            }
+        };
+
+        /**
+         @param size the number of units the allocator manages, starting at offset 0
+         */
+        OffsetAllocator(uint32_t size = 0);
+
+        /**
+         Find a place for an allocation
+         @param size the number of units to allocate
+         @return the allocation, or an invalid allocation if no free region is large enough
+         */
+        Allocation Allocate(uint32_t size);
+
+        /**
+         Release an allocation, merging it with free neighbours
+         @param node the node of a valid allocation returned by Allocate
+         */
+        void Free(node_t node);
+
+        /**
+         Extend the managed range. Existing allocations keep their offsets.
+         @param newSize the new total size, must not be smaller than the current size
+         */
+        void Grow(uint32_t newSize);
+
+        /**
+         Forget every allocation and manage a new range. Used when the owner relocates all of its data.
+         */
+        void Reset(uint32_t size);
+
+        /**
+         @return the size of an allocation
+         */
+        uint32_t GetSize(node_t node) const {
+            return nodes[node].size;
+        }
+
+        /**
+         @return the total managed size
+         */
+        uint32_t GetCapacity() const {
+            return capacity;
+        }
+
+        /**
+         @return the number of free units, across all free regions
+         */
+        uint32_t GetFreeStorage() const {
+            return freeStorage;
+        }
+
+        /**
+         @return the size of the largest free region. An allocation of this size is guaranteed to succeed.
+         */
+        uint32_t GetLargestFreeRegion() const;
+
+    private:
+        constexpr static uint32_t nSecondLevelBits = 3;
+        constexpr static uint32_t nSecondLevel = 1 << nSecondLevelBits;
+        constexpr static uint32_t nFirstLevel = 32;
+        constexpr static uint32_t nBins = nFirstLevel * nSecondLevel;
+
+        struct Node {
+            uint32_t offset = 0, size = 0;
+            node_t binPrev = INVALID_NODE, binNext = INVALID_NODE;                // free regions in the same bin
+            node_t neighborPrev = INVALID_NODE, neighborNext = INVALID_NODE;      // adjacent regions, by offset
+            bool used = false;
+        };
+        Vector<Node> nodes;
+        node_t freeNodes = INVALID_NODE;    // unused node records, linked through binNext
+        node_t lastNode = INVALID_NODE;     // the region with the highest offset
+        std::array<node_t, nBins> binHeads;
+        std::array<uint8_t, nFirstLevel> usedSecondLevel;
+        uint32_t usedFirstLevel = 0;
+        uint32_t capacity = 0, freeStorage = 0;
+
+        static uint32_t BinRoundDown(uint32_t size);
+        static uint32_t BinRoundUp(uint32_t size);
+        static uint32_t BinLowerBound(uint32_t bin);
+
+        node_t NewNode();
+        void ReleaseNode(node_t node);
+        node_t InsertFree(uint32_t offset, uint32_t size);
+        void InsertIntoBin(node_t node);
+        void RemoveFromBin(node_t node);
+    };
+}
@@ -36,6 +36,7 @@ namespace RavEngine {
 			std::vector<XrViewConfigurationView> viewConfigurationViews;
 			std::vector <XrCompositionLayerProjectionView> projectionViews;
 			std::vector<XrView> views;
+			std::vector<XrView> locatedViews;	// scratch for xrLocateViews, copied into views when the poses are valid
 
 			union XrSwapchainImage {
 #if RGL_DX12_AVAILABLE
@@ -46,13 +47,14 @@ namespace RavEngine {
 #endif
 			};
 
-			// one list of images per eye
+			// one list of images per swapchain
 			std::vector<std::vector<XrSwapchainImage>> swapchainImages;
 			std::vector<std::vector<std::unique_ptr<RGL::ITexture>>> rglSwapchainImages;
 			std::vector<std::vector<XrSwapchainImage>> depthSwapchainImages;
 			std::vector<std::vector<RGLTexturePtr>> rglDepthSwapchainImages;
-			// one swapchain per eye, plus depth
+			// one swapchain with every eye side by side, plus depth
 			int64_t swapchain_format, depth_swapchain_format = -1;
+			uint32_t stereoWidth = 0, stereoHeight = 0;
 			std::vector<XrSwapchain> swapchains;
 			std::vector<XrSwapchain> depth_swapchains;
 
@@ -106,8 +108,21 @@ namespace RavEngine {
 		std::vector<RenderViewCollection> CreateRenderTargetCollections();
 
 		void UpdateXRTargetCollections(std::vector<RenderViewCollection>& collections, const std::vector<XrView>& views);
-		std::pair<std::vector<XrView>, XrFrameState> BeginXRFrame();
-		void EndXRFrame(XrFrameState& frameState);
+
+		/**
+		 Wait until the runtime wants the next frame, then begin it. xrWaitFrame paces the app loop, so call this before simulating the frame.
+		 @return the frame's timing, including its predicted display time
+		 */
+		XrFrameState BeginXRFrame();
+
+		/**
+		 Locate the views at the frame's predicted display time. Call this as late as possible before encoding, so the poses are fresh.
+		 If the runtime loses tracking, the last valid poses are kept.
+		 @return the views, valid until the next call
+		 */
+		const std::vector<XrView>& LocateXRViews(const XrFrameState& frameState);
+
+		void EndXRFrame(const XrFrameState& frameState);
 	};
 #endif
 }
\ No newline at end of file
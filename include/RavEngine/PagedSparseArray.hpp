@@ -0,0 +1,107 @@
+#pragma once
+#include "Vector.hpp"
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+namespace RavEngine {
+    /**
+     Sparse index -> dense index table, stored in fixed-size pages that are allocated on first write and freed
+     when their last valid entry is cleared. Lookups remain O(1) while sparse ranges of IDs cost only a null page pointer.
+     */
+    template<typename index_t, index_t pageSize = 1024>
+    class PagedSparseArray {
+        static_assert((pageSize & (pageSize - 1)) == 0, "pageSize must be a power of 2");
+    public:
+        constexpr static index_t invalid_value = std::numeric_limits<index_t>::max();
+    private:
+        struct Page {
+            std::unique_ptr<index_t[]> entries;
+            index_t nValid = 0;
+        };
+        Vector<Page> pages;
+
+        constexpr static index_t PageOf(index_t i) {
+            return i / pageSize;
+        }
+        constexpr static index_t OffsetOf(index_t i) {
+            return i & (pageSize - 1);
+        }
+
+    public:
+        /**
+         @return the value stored at sparse index i, or invalid_value if none is stored
+         */
+        inline index_t operator[](index_t i) const {
+            const auto p = PageOf(i);
+            if (p >= pages.size() || !pages[p].entries) {
+                return invalid_value;
+            }
+            return pages[p].entries[OffsetOf(i)];
+        }
+
+        inline bool Contains(index_t i) const {
+            return (*this)[i] != invalid_value;
+        }
+
+        /**
+         Store a value at sparse index i. Storing invalid_value clears the entry, and frees its page if it was the last one.
+         */
+        inline void Set(index_t i, index_t value) {
+            const auto p = PageOf(i);
+            if (value == invalid_value) {
+                if (p >= pages.size() || !pages[p].entries) {
+                    return;
+                }
+                auto& page = pages[p];
+                auto& entry = page.entries[OffsetOf(i)];
+                if (entry != invalid_value) {
+                    entry = invalid_value;
+                    assert(page.nValid > 0);
+                    if (--page.nValid == 0) {
+                        page.entries.reset();
+                    }
+                }
+                return;
+            }
+            if (p >= pages.size()) {
+                pages.resize(p + 1);
+            }
+            auto& page = pages[p];
+            if (!page.entries) {
+                page.entries = std::make_unique<index_t[]>(pageSize);
+                std::fill(page.entries.get(), page.entries.get() + pageSize, invalid_value);
+            }
+            auto& entry = page.entries[OffsetOf(i)];
+            if (entry == invalid_value) {
+                page.nValid++;
+            }
+            entry = value;
+        }
+
+        /**
+         Grow the page table so that indices up to maxIndex do not resize it. Pages themselves are still allocated lazily.
+         */
+        inline void Reserve(index_t maxIndex) {
+            const auto p = PageOf(maxIndex);
+            if (p >= pages.size()) {
+                pages.resize(p + 1);
+            }
+        }
+
+        /**
+         @return the number of pages currently allocated
+         */
+        inline size_t AllocatedPageCount() const {
+            return std::count_if(pages.begin(), pages.end(), [](const Page& page) { return bool(page.entries); });
+        }
+
+        /**
+         @return the bytes held by the page table and the allocated pages
+         */
+        inline size_t AllocatedBytes() const {
+            return pages.capacity() * sizeof(Page) + AllocatedPageCount() * pageSize * sizeof(index_t);
+        }
+    };
+}
@@ -4,6 +4,8 @@
 #include "RGL/Types.hpp"
 #include "Ref.hpp"
 #include "ComponentWithOwner.hpp"
+#include "ParticlePool.hpp"
+#include "mathtypes.hpp"
 
 namespace RavEngine {
 
@@ -35,6 +37,19 @@ namespace RavEngine {
 			Burst
 		} mode = Mode::Stream;
 
+		/**
+		Automatic culling and level of detail. Emitters without bounds are always simulated and rendered.
+		Only cameras decide visibility here, so with simulateOffscreen off the shadow of an off-screen emitter stops moving.
+		*/
+		struct CullingSettings {
+			vector3 boundsCenter{ 0 };		// in the owner's local space
+			float boundsRadius = 0;			// must contain every particle the emitter can simulate, in the owner's local units. 0 disables culling and LOD.
+			float lodDistance = 0;			// past this distance from the nearest camera, the emitter is ticked less often and spawns fewer particles. 0 disables.
+			uint8_t maxTickInterval = 4;	// the most frames between ticks of a distant emitter
+			bool simulateOffscreen = true;	// if false, emitters no camera can see are not ticked, and catch up when they become visible again
+			float maxCatchUpSeconds = 1;	// the longest stretch of skipped time that is simulated on the first tick after it
+		} culling;
+
 		ParticleEmitter(Entity owner, uint32_t maxParticles, uint16_t sizeOfEachParticle, const Ref<ParticleUpdateMaterialInstance> updateMat, const ParticleRenderMaterialVariant& mat);
         
         MOVE_NO_COPY(ParticleEmitter);
@@ -102,17 +117,15 @@ namespace RavEngine {
 		}
 
 	private:
+		// the simulation buffers are shared with the other emitters of the same particle size, see ParticlePool
+		ParticlePool::Slot poolSlot;	// assigned on the first frame the emitter is ticked
+		uint16_t particleSize;
+
+		// mesh emitters only, created on the first frame the emitter is ticked
 		RGLBufferPtr
-			particleDataBuffer = nullptr,
-			particleReuseFreelist = nullptr,
-			spawnedThisFrameList = nullptr,
-			activeParticleIndexBuffer = nullptr,
-			indirectComputeBuffer = nullptr,
 			indirectDrawBuffer = nullptr,
-			emitterStateBuffer = nullptr,
-			particleLifeBuffer = nullptr,
-			indirectDrawBufferStaging = nullptr, // not initialized in the Emitter constructor
-			meshAliveParticleIndexBuffer = nullptr;		// not initialized in the Emitter constructor
+			indirectDrawBufferStaging = nullptr,
+			meshAliveParticleIndexBuffer = nullptr;
 
 		ParticleRenderMaterialVariant renderMaterial;
 		Ref<ParticleUpdateMaterialInstance> updateMaterial;
@@ -129,9 +142,14 @@ namespace RavEngine {
 
 		// this is icky and nasty, we need a better solution than this
 		struct RenderState {
+			RGLBufferPtr maxTotalParticlesBuffer;
 			uint32_t maxTotalParticlesOffset = 0;
+			glm::vec3 worldBoundsCenter{ 0 };		// culling bounds, updated each frame
+			float worldBoundsRadius = 0;
 		} renderState;
 
+		float untickedTime = 0;		// in fps scale units, time since the last tick that the next tick simulates
+
 		bool emittingThisFrame : 1 = false;
 		bool isVisible : 1 = true;
 		bool isFrozen : 1 = false;
@@ -0,0 +1,62 @@
+#pragma once
+#include "OffsetAllocator.hpp"
+#include "Vector.hpp"
+#include "Queue.hpp"
+#include "Types.hpp"
+#include <RGL/Types.hpp>
+#include <cstdint>
+
+namespace RavEngine {
+
+    /**
+     Holds the simulation buffers of every ParticleEmitter with the same particle size, so that emitters sharing an update material can be
+     simulated with one dispatch per stage. Each emitter owns a slot of emitter state and a range of particles. Both are placed on binding
+     offset boundaries, so the renderer binds an emitter's part of the buffers with an offset and the render shaders never see the pool.
+     Render thread only.
+     */
+    class ParticlePool {
+    public:
+        constexpr static uint32_t particleAlignment = 64;    // particle ranges start on multiples of this, which puts them at 256-byte offsets
+        constexpr static uint32_t stateStride = 256;         // bytes per emitter state, see ParticleState in particle_shared.glsl
+        constexpr static uint32_t invalidSlot = ~0u;
+
+        struct Slot {
+            uint32_t state = invalidSlot;
+            OffsetAllocator::Allocation particles;
+
+            bool IsValid() const {
+                return state != invalidSlot;
+            }
+
+            uint32_t GetParticleBase() const {
+                return particles.offset * particleAlignment;
+            }
+        };
+
+        ParticlePool(uint16_t particleSize) : particleSize(particleSize) {}
+
+        /**
+         Reserve the state and particles of a new emitter, growing the buffers if they are full. Growing copies the buffers on the GPU
+         and waits for it, so it must happen before this frame's commands use the pool.
+         @param owner written to the emitter's state, for the render shaders
+         */
+        Slot Allocate(RGLDevicePtr device, RGLCommandQueuePtr queue, ConcurrentQueue<RGLBufferPtr>& gcBuffers, uint32_t maxParticles, entity_t owner);
+
+        void Free(const Slot& slot);
+
+        RGLBufferPtr
+            particleData,           // particleSize bytes per particle
+            particleLife,
+            particleFreelist,
+            spawnedThisFrame,
+            activeParticleIndices,
+            emitterState,           // stateStride bytes per emitter
+            drawCommands;           // an RGL::IndirectCommand per emitter, used by billboard emitters
+
+    private:
+        uint16_t particleSize;
+        OffsetAllocator particleAllocator;      // in units of particleAlignment
+        Vector<uint32_t> freeStateSlots;
+        uint32_t stateCapacity = 0;
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <limits>
+#include "Vector.hpp"
+#include "Array.hpp"
+
+namespace RavEngine {
+
+	/**
+	 The performance counters as of the end of a frame. Names are owned by the counters, which live until exit.
+	 */
+	struct PerfSnapshot {
+		constexpr static uint32_t numBuckets = 32;
+
+		struct Counter {
+			std::string_view name;
+			uint64_t frame = 0;		// added during the frame
+			uint64_t total = 0;		// added since startup
+		};
+		struct Gauge {
+			std::string_view name;
+			double value = 0;		// the last value set
+		};
+		struct Histogram {
+			std::string_view name;
+			uint64_t count = 0;		// values recorded during the frame
+			double sum = 0, min = 0, max = 0;
+			Array<uint32_t, numBuckets> buckets{};		// see PerfCounters::Histogram::BucketFor
+
+			double Mean() const {
+				return count > 0 ? sum / count : 0;
+			}
+
+			/**
+			 @param fraction between 0 and 1, such as 0.99 for the 99th percentile
+			 @return an estimate of the value below which this fraction of the frame's values fall: the top of the bucket it lands in, clamped to the frame's range
+			 */
+			double Percentile(double fraction) const;
+		};
+
+		uint64_t frame = 0;		// snapshots taken since startup, including this one
+		Vector<Counter> counters;
+		Vector<Gauge> gauges;
+		Vector<Histogram> histograms;
+
+		/**
+		 @return the entry with this name, or nullptr if nothing by that name existed when the snapshot was taken
+		 */
+		const Counter* FindCounter(std::string_view name) const;
+		const Gauge* FindGauge(std::string_view name) const;
+		const Histogram* FindHistogram(std::string_view name) const;
+
+		/**
+		 @return a table of every entry, in the order they were created
+		 */
+		std::string ToString() const;
+	};
+
+	/**
+	 Named counters that any subsystem can update from any thread without locking, and that App snapshots once per frame,
+	 see App::GetPerfSnapshot. Getting a counter by name takes a lock, so look it up once and keep the pointer. In profile builds,
+	 every counter, gauge and histogram mean is also plotted in Tracy when the snapshot is taken.
+	 */
+	namespace PerfCounters {
+
+		// an amount that only grows, such as bytes sent. Snapshots report how much it grew during the frame.
+		struct Counter {
+			const std::string name;
+			std::atomic<uint64_t> value = 0;
+			uint64_t lastSnapshot = 0;
+
+			Counter(std::string_view name) : name(name) {}
+
+			void Add(uint64_t amount = 1) {
+				value.fetch_add(amount, std::memory_order_relaxed);
+			}
+		};
+
+		// a level, such as the number of live entities. Snapshots report the last value set.
+		struct Gauge {
+			const std::string name;
+			std::atomic<double> value = 0;
+
+			Gauge(std::string_view name) : name(name) {}
+
+			void Set(double newValue) {
+				value.store(newValue, std::memory_order_relaxed);
+			}
+		};
+
+		/**
+		 The distribution of values recorded during a frame, such as durations in milliseconds. Values fall into power-of-two buckets,
+		 so percentiles are accurate to within a factor of two. Snapshots restart it, and a value recorded while a snapshot is being
+		 taken may be counted in either frame.
+		 */
+		struct Histogram {
+			const std::string name;
+			std::atomic<uint64_t> count = 0;
+			std::atomic<double> sum = 0, min = std::numeric_limits<double>::infinity(), max = -std::numeric_limits<double>::infinity();
+			Array<std::atomic<uint32_t>, PerfSnapshot::numBuckets> buckets{};
+
+			Histogram(std::string_view name) : name(name) {}
+
+			/**
+			 @return the bucket for a value. Bucket 0 holds values below 2^-10, bucket i holds [2^(i-11), 2^(i-10)), and the last bucket holds everything above.
+			 */
+			static uint32_t BucketFor(double value);
+
+			/**
+			 @return the value at the top of a bucket
+			 */
+			static double BucketLimit(uint32_t bucket);
+
+			void Record(double value);
+		};
+
+		/**
+		 @return the counter with this name, created on first use. Counters live until exit, so callers may keep the pointer.
+		 */
+		Counter* GetCounter(std::string_view name);
+		Gauge* GetGauge(std::string_view name);
+		Histogram* GetHistogram(std::string_view name);
+
+		/**
+		 Read every counter, gauge and histogram, and restart the histograms for the next frame. App calls this once per frame.
+		 @param snapshot overwritten, reusing its storage
+		 */
+		void TakeSnapshot(PerfSnapshot& snapshot);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#if !RVE_SERVER
+#include "GUI.hpp"
+#include <array>
+#include <optional>
+#include <string>
+#include <cstdint>
+
+namespace RavEngine {
+
+    /**
+     An on-screen readout of frame times, the slowest systems, draws and dispatches per pass, VRAM, audio and network, for
+     reporting performance without a profiler. It is available in every build configuration. See App::SetPerformanceOverlayVisible.
+     While shown, it turns on GPU pass timings and command counting, which have a small cost of their own.
+     */
+    class PerformanceOverlay {
+    public:
+        // one frame, in milliseconds
+        struct FrameSample {
+            float tick = 0;             // ticking the worlds, running main thread tasks and replicating
+            float renderSync = 0;       // see RenderEngine::FrameTimings
+            float encode = 0;
+            float gpu = 0;
+        };
+
+        constexpr static uint32_t historyLength = 120;      // frames in each graph
+        constexpr static uint32_t numTopSystems = 5;
+        constexpr static double refreshInterval = 0.25;     // seconds between updates of the text. The graphs move every frame
+
+        void SetVisible(bool visible);
+
+        bool IsVisible() const {
+            return gui.has_value();
+        }
+
+        /**
+         Record the frame that was just encoded. Main thread only.
+         @param tickMs the time spent in FrameSample::tick
+         */
+        void RecordFrame(float tickMs);
+
+        /**
+         Refresh the readout. Main thread only, before the frame is encoded.
+         @return the GUI to draw over the main window, or nullptr if the overlay is hidden
+         */
+        GUIComponent* Update(uint32_t width, uint32_t height, float dpiScale);
+
+    private:
+        std::optional<GUIComponent> gui;
+        std::array<FrameSample, historyLength> history{};
+        uint32_t nextSample = 0;
+        double nextRefresh = 0;
+        bool gpuTimingsWereEnabled = false;
+        std::string passesText;     // captured in RecordFrame, because the counts are cleared when the next frame begins
+
+        void CreateDocument();
+        void UpdateGraphs();
+        void UpdateText();
+    };
+}
+#endif
@@ -45,7 +45,6 @@ public Queryable<PhysicsBodyComponent
         void CompleteConstruction();
 		friend class PhysicsLinkSystemRead;
 		friend class PhysicsLinkSystemWrite;
-		mutable bool setPoseNeedsSync = false;
 	public:
 		using Queryable<PhysicsBodyComponent
 #if !RVE_SERVER
@@ -182,6 +181,38 @@ public Queryable<PhysicsBodyComponent
 		*/
 		inline void SetWantsContactData(bool state) {
 			wantsContactData = state;
+			UpdateFilterData();
+		}
+
+		struct EventFlags {
+			enum Enum : uint8_t {
+				None = 0,
+				ColliderEnter = (1 << 0),
+				ColliderPersist = (1 << 1),
+				ColliderExit = (1 << 2),
+				TriggerEnter = (1 << 3),
+				TriggerExit = (1 << 4),
+				AllCollider = ColliderEnter | ColliderPersist | ColliderExit,
+				AllTrigger = TriggerEnter | TriggerExit,
+				All = AllCollider | AllTrigger
+			};
+		};
+
+		/**
+		@return the EventFlags this body receives
+		*/
+		inline uint8_t GetEventFlags() const {
+			return eventFlags;
+		}
+
+		/**
+		Choose the events this body receives. The simulation does not report events that neither body of a pair wants, so bodies that
+		no receiver listens to should clear their flags. Persist events are reported every step for every touching pair.
+		@param flags a combination of EventFlags
+		*/
+		inline void SetEventFlags(uint8_t flags) {
+			eventFlags = flags;
+			UpdateFilterData();
 		}
 		
 		void DebugDraw(RavEngine::DebugDrawer& dbg, const RavEngine::Transform& tr) const {
@@ -195,6 +226,10 @@ public Queryable<PhysicsBodyComponent
 		}
 	protected:
 		bool wantsContactData = false;
+		uint8_t eventFlags = EventFlags::All;
+
+		// apply the filtering settings to the colliders, and to the pairs the simulation already found
+		void UpdateFilterData();
 
 		template<typename T>
 		inline void LockWrite(const T& func){
@@ -250,6 +285,9 @@ public Queryable<PhysicsBodyComponent
         void SetKinematicTarget(const vector3& targetPos, const quaternion& targetRot);
         std::pair<vector3, quaternion> GetKinematicTarget() const;
 
+		// shadow PhysicsBodyComponent::SetSimulationEnabled, so that simulation regions do not turn a body the game disabled back on
+		void SetSimulationEnabled(bool);
+
 		/**
 		Wake the body
 		*/
@@ -264,6 +302,13 @@ public Queryable<PhysicsBodyComponent
 		@return true if the body is asleep.
 		*/
 		bool IsSleeping() const;
+
+		/**
+		@return true if the body is outside every simulation region, see PhysicsSolver::useSimulationRegions
+		*/
+		bool IsFrozenByRegion() const {
+			return regionFrozen;
+		}
 		
 		enum AxisLock{
 			Linear_X = (1 << 0),
@@ -329,6 +374,12 @@ public Queryable<PhysicsBodyComponent
 		void Destroy() {
 			PhysicsBodyComponent::Destroy();
 		}
+
+	protected:
+		friend class PhysicsSolver;
+		// while frozen the body is not simulated, and these are restored when it returns to a region
+		bool regionFrozen = false;
+		vector3 frozenLinearVelocity{ 0 }, frozenAngularVelocity{ 0 };
 	};
 
 	struct RigidBodyStaticComponent : public PhysicsBodyComponent, public QueryableDelta<PhysicsBodyComponent,RigidBodyStaticComponent> {
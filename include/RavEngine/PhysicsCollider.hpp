@@ -16,6 +16,7 @@ namespace physx {
 
 namespace RavEngine {
     struct PhysicsBodyComponent;
+    struct Heightfield;
 	struct Transform;
     class PhysicsCollider
 	{
@@ -142,7 +143,7 @@ namespace RavEngine {
 
 	struct MeshCollider : public PhysicsCollider {
 		/**
-		 Create a MeshCollider given a MeshAsset physics material
+		 Create a MeshCollider given a MeshAsset physics material. The cooked mesh is shared through the CollisionMeshCache.
 		 @param mesh the MeshAsset to use
 		 @param mat the PhysicsMaterial to use
 		 */
@@ -158,7 +159,7 @@ namespace RavEngine {
 	struct ConvexMeshCollider : public PhysicsCollider {
 		
 		/**
-		 Create a Convex Mesh Collider given a MeshAsset physics material
+		 Create a Convex Mesh Collider given a MeshAsset physics material. The cooked hull is shared through the CollisionMeshCache.
 		 @param mesh the MeshAsset to use
 		 @param mat the PhysicsMaterial to use
 		 */
@@ -168,4 +169,18 @@ namespace RavEngine {
 			//TODO: debug draw mesh collider
 		}
 	};
+
+	struct HeightfieldCollider : public PhysicsCollider {
+
+		/**
+		 Create a collider from a Heightfield, with sample (0, 0) at the owner's origin. Only static bodies can have one.
+		 @param heights the grid to collide with. PhysX stores heights as 16-bit integers, so they are rounded to 1/65534 of the grid's height range.
+		 @param mat the PhysicsMaterial to use
+		 */
+        HeightfieldCollider(PhysicsBodyComponent* owner, const Heightfield& heights, Ref<PhysicsMaterial> mat);
+
+		void DebugDraw(RavEngine::DebugDrawer& dbg, color_t, const RavEngine::Transform&) const override{
+			//TODO: debug draw heightfield collider
+		}
+	};
 }
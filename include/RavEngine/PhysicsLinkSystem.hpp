@@ -21,6 +21,7 @@ namespace RavEngine {
 	/**
 	 This System copies the Entity's transform to the physics simulation transform.
 	 It must run after any transform modifications in other systems, ideally at the end of the pipeline.
+	 Only transforms that changed since the last copy are written.
 	 */
 	class PhysicsLinkSystemWrite : public AutoCTTI{
 	public:
@@ -33,9 +34,11 @@ namespace RavEngine {
 	/**
 	 This System copies the state of the physics simulation transform to the Entity's transform.
 	 It must run before any transform modifications in other systems, ideally at the beginning of the pipeline.
+	 Only the bodies PhysX reports as moved are visited (see PhysicsSolver::movedBodies), so it is not a component scan,
+	 and the World registers it by hand.
 	 */
 	class PhysicsLinkSystemRead : public AutoCTTI {
 	public:
-		void operator()(const RigidBodyDynamicComponent&, Transform&) const;
+		void operator()(World*) const;
 	};
 }
@@ -15,7 +15,11 @@
 #include <PxPhysicsAPI.h>
 #include <PxFiltering.h>
 #include <cstdint>
+#include <span>
+#include <mutex>
 #include "Types.hpp"
+#include "Function.hpp"
+#include "Vector.hpp"
 #include "Entity.hpp"
 
 struct FilterLayers {
@@ -30,19 +34,38 @@ struct FilterLayers {
 namespace RavEngine {
     struct Entity;
     struct PhysicsBodyComponent;
+    struct ContactPairPoint;
     struct World;
+
+    // PhysX's default allocator, with its allocations counted in the "PhysX" memory pool
+    class PhysXTrackingAllocator : public physx::PxAllocatorCallback {
+        physx::PxDefaultAllocator allocator;
+    public:
+        void* allocate(size_t size, const char* typeName, const char* filename, int line) final;
+        void deallocate(void* ptr) final;
+    };
+
     class PhysicsSolver : public physx::PxSimulationEventCallback {
         friend class World;
         PhysicsTaskDispatcher taskDispatcher;
     protected:
         //static members must exist only once in the application
         static physx::PxDefaultErrorCallback gDefaultErrorCallback;
-        static physx::PxDefaultAllocator gDefaultAllocatorCallback;
+        static PhysXTrackingAllocator gDefaultAllocatorCallback;
         static physx::PxFoundation* foundation;
     public:
         static physx::PxPhysics* phys;
         static physx::PxPvd* pvd;
 		static physx::PxCooking* cooking;
+        static physx::PxCudaContextManager* cudaContextManager;     // shared by the GPU accelerated scenes
+
+        /**
+        If true, Worlds created afterwards simulate rigid bodies and run the broadphase on the GPU, on platforms and hardware that
+        PhysX supports (NVIDIA GPUs on x64 Windows and Linux, with the PhysXGpu library next to the executable). Otherwise, or if
+        the CUDA context cannot be created, they simulate on the CPU. Worth it for scenes with many thousands of active bodies.
+        */
+        static bool requestGPUAcceleration;
+
         World* owner = nullptr;
         physx::PxScene* scene;
 
@@ -61,20 +84,123 @@ namespace RavEngine {
 
         // If deltatime > this value, the system will substep
         constexpr static float max_step_time = 1.f/30;
+
+        bool simulationInFlight = false;
+        float accumulatedTime = 0;      // simulation time not yet stepped in fixed timestep mode
+
+        // bodies whose Transforms PhysicsLinkSystemRead must update, from the active actors of each fetched step
+        Vector<entity_t> movedBodies;
+        std::mutex movedBodiesMtx;      // for RequestPoseSync, everything else is ordered by the task graph
+        friend class PhysicsLinkSystemRead;
+
+        void CollectActiveActors();
+
+        bool gpuAccelerated = false;
+
+        struct RegionAnchor {
+            physx::PxVec3 position;
+            float radiusSquared;
+        };
+        Vector<RegionAnchor> regionAnchors;
+        Vector<pos_t> regionChanges;        // dense indices of the bodies that enter or leave the regions this update
+        uint32_t numRegionFrozen = 0;
+        uint16_t ticksSinceRegionUpdate = 0;
+
+        /**
+        Freeze the dynamic bodies that left every simulation region, and restore the ones that came back. Invoked by the World before Tick.
+        */
+        void UpdateSimulationRegions();
+
+        // contact and trigger events recorded by onContact and onTrigger, which run inside the simulation, and dispatched by
+        // DispatchEvents once the step has been fetched. The buffers keep their capacity between steps.
+        struct BufferedEvent {
+            entity_t receiver, other;
+            uint32_t firstContactPoint = 0, numContactPoints = 0;   // into bufferedContactPoints
+            uint32_t sequence = 0;      // the order the simulation reported the event in
+            uint8_t type = 0;           // one PhysicsBodyComponent::EventFlags value
+        };
+        Vector<BufferedEvent> bufferedEvents;
+        Vector<ContactPairPoint> bufferedContactPoints;
+        Vector<physx::PxContactPairPoint> extractedContactPoints;
+
+        void FetchInFlight();
+        void DispatchEvents();
         
         friend class PhysicsBodyComponent;
 
     public:
         PhysicsSolver(World* world);
-		~PhysicsSolver(){
-			DeallocatePhysx();
-		}
+		~PhysicsSolver();
 
         void Spawn( PhysicsBodyComponent&);
         void Destroy( PhysicsBodyComponent&);
 
+        /**
+        Advance the simulation. If overlapSimulation is set, the last substep is left running in the background, see FetchResults.
+        */
         void Tick(float deltaTime);
 
+        /**
+        Wait for the substep that Tick left running, apply its results, and dispatch its contact and trigger events.
+        Does nothing if no simulation is in flight.
+        */
+        void FetchResults();
+
+        /**
+        If true, the World fetches each tick's simulation at the start of the next tick, so the simulation runs alongside the
+        systems that do not depend on it and bodies are read one step behind. If false, the simulation completes within the tick.
+        */
+        bool overlapSimulation = false;
+
+        /**
+        If true, Tick accumulates the elapsed time and simulates it in steps of exactly fixedStepTime, so every step is the same size
+        and the simulation is reproducible. Time left over carries to the next tick, see GetInterpolationAlpha. If false, each tick's
+        time is split into equal substeps of at most max_step_time.
+        */
+        bool fixedTimestep = false;
+        float fixedStepTime = 1.f / 60;
+
+        /**
+        In fixed timestep mode, the most steps one Tick simulates. Time beyond that is dropped, so a long frame slows the simulation
+        down instead of making the next frame longer too.
+        */
+        uint8_t maxStepsPerTick = 4;
+
+        /**
+        @return in fixed timestep mode, how far the time between the last simulated step and the next one has progressed, from 0 to 1.
+        Renderers can blend between a body's previous and current pose by this amount. 1 outside fixed timestep mode.
+        */
+        float GetInterpolationAlpha() const {
+            return fixedTimestep ? accumulatedTime / fixedStepTime : 1;
+        }
+
+        /**
+        If true, dynamic bodies outside the radius of every SimulationAnchor stop simulating. They keep their velocities, stay
+        visible to scene queries, and resume where they left off when an anchor comes back in range. With no anchors, every body
+        simulates. Kinematic bodies and bodies disabled with SetSimulationEnabled are left alone. Joints on a frozen body are removed
+        by PhysX.
+        */
+        bool useSimulationRegions = false;
+
+        // bodies freeze beyond radius * (1 + regionHysteresis) and resume within radius, so bodies at the boundary do not toggle
+        float regionHysteresis = 0.1f;
+
+        // ticks between region updates, to spread their cost
+        uint16_t regionUpdateInterval = 10;
+
+        /**
+        Copy the body's simulation pose to its Transform on the next PhysicsLinkSystemRead, even if PhysX does not report it as moved.
+        Thread safe.
+        */
+        void RequestPoseSync(entity_t id);
+
+        /**
+        @return true if this scene simulates on the GPU, see requestGPUAcceleration
+        */
+        bool IsGPUAccelerated() const {
+            return gpuAccelerated;
+        }
+
         static void ReleaseStatics();
 
         //scene query methods
@@ -138,6 +264,49 @@ namespace RavEngine {
         */
         bool CapsuleOverlap(const vector3& origin, const quaternion& rotation, decimalType radius, decimalType halfheight, OverlapHit& out_hit);
 
+        // batched scene queries, one per element, with the same parameters as the single query methods
+        struct RaycastQuery {
+            vector3 origin;
+            vector3 direction;
+            decimalType maxDistance = 0;
+        };
+
+        struct BoxOverlapQuery {
+            vector3 origin;
+            quaternion rotation;
+            vector3 half_ext;
+        };
+
+        struct SphereOverlapQuery {
+            vector3 origin;
+            decimalType radius = 0;
+        };
+
+        struct CapsuleOverlapQuery {
+            vector3 origin;
+            quaternion rotation;
+            decimalType radius = 0;
+            decimalType halfheight = 0;
+        };
+
+        /**
+        Perform many raycasts, split across App::executor. Blocks until all of them are complete.
+        @param queries the raycasts to perform
+        @param out_hits receives the result of each query at the same index, must be at least as large as queries
+        @return the number of queries that hit
+        */
+        uint32_t RaycastBatch(std::span<const RaycastQuery> queries, std::span<RaycastHit> out_hits);
+
+        /**
+        Perform many overlaps, split across App::executor. Blocks until all of them are complete.
+        @param queries the overlaps to perform
+        @param out_hits receives the result of each query at the same index, must be at least as large as queries
+        @return the number of queries that found data
+        */
+        uint32_t BoxOverlapBatch(std::span<const BoxOverlapQuery> queries, std::span<OverlapHit> out_hits);
+        uint32_t SphereOverlapBatch(std::span<const SphereOverlapQuery> queries, std::span<OverlapHit> out_hits);
+        uint32_t CapsuleOverlapBatch(std::span<const CapsuleOverlapQuery> queries, std::span<OverlapHit> out_hits);
+
 
     protected:
         struct PhysicsTransform {
@@ -153,5 +322,12 @@ namespace RavEngine {
         @param out_hit the destination to write the results
         */
         bool generic_overlap(const PhysicsTransform& transform, const physx::PxGeometry& geo, OverlapHit& out_hit);
+
+        /**
+        Run query(i) for each i in [0, count) on App::executor, under the scene's read lock
+        @param query returns true if query i hit
+        @return the number of queries that hit
+        */
+        uint32_t dispatch_queries(uint32_t count, FunctionRef<bool(uint32_t)> query);
     };
 }
@@ -21,12 +21,18 @@ namespace RavEngine {
 #define RVE_PROFILE_FN_N(name) ZoneScopedN(name)
 #define RVE_PROFILE_SECTION(varName,zoneName) TracyCZoneN(RVE_PRF_ ## varName,zoneName,true);
 #define RVE_PROFILE_SECTION_END(varName) TracyCZoneEnd(RVE_PRF_ ## varName) ;
+#define RVE_PROFILE_PLOT(name, value) TracyPlot(name, value)
+#define RVE_PROFILE_ALLOC(ptr, size, poolName) TracyAllocN(ptr, size, poolName)
+#define RVE_PROFILE_FREE(ptr, poolName) TracyFreeN(ptr, poolName)
 #else
 #define RVE_PROFILE_FN
 #define RVE_PROFILE_FN_NC(n,c)
 #define RVE_PROFILE_FN_N(n)
 #define RVE_PROFILE_SECTION(varName,zoneName)
 #define RVE_PROFILE_SECTION_END(varName)
+#define RVE_PROFILE_PLOT(name, value)
+#define RVE_PROFILE_ALLOC(ptr, size, poolName)
+#define RVE_PROFILE_FREE(ptr, poolName)
 #endif
 	}
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+#include "mathtypes.hpp"
+#include "BitStream.hpp"
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace RavEngine {
+
+	/**
+	 A float in [Min, Max] stored in Bits bits. Values outside the range are clamped.
+	 */
+	template<float Min, float Max, uint8_t Bits>
+	struct RangedFloat {
+		static_assert(Min < Max, "Range is empty");
+		static_assert(Bits > 0 && Bits <= 32, "RangedFloat holds at most 32 bits");
+		using storage_t = std::conditional_t<(Bits <= 8), uint8_t, std::conditional_t<(Bits <= 16), uint16_t, uint32_t>>;
+		constexpr static uint32_t maxSteps = uint32_t((uint64_t(1) << Bits) - 1);
+
+		storage_t steps = 0;
+
+		RangedFloat() = default;
+		RangedFloat(float value) {
+			const auto t = (std::clamp(value, Min, Max) - Min) / (Max - Min);
+			steps = storage_t(std::lround(double(t) * maxSteps));
+		}
+
+		float Get() const {
+			return Min + float(double(steps) / maxSteps) * (Max - Min);
+		}
+	};
+
+	/**
+	 A vector stored as three half-precision floats, 6 bytes instead of 12
+	 */
+	struct HalfVector3 {
+		uint16_t x = 0, y = 0, z = 0;
+
+		HalfVector3() = default;
+		HalfVector3(const vector3& value) :
+			x(glm::packHalf1x16(float(value.x))),
+			y(glm::packHalf1x16(float(value.y))),
+			z(glm::packHalf1x16(float(value.z))) {}
+
+		vector3 Get() const {
+			return vector3(glm::unpackHalf1x16(x), glm::unpackHalf1x16(y), glm::unpackHalf1x16(z));
+		}
+	};
+
+	/**
+	 A rotation in 4 bytes, using the smallest-three encoding: the index of the largest component in 2 bits, and the other three
+	 in 10 bits each. The largest is rebuilt from the unit length, and its sign is made positive, since q and -q are the same rotation.
+	 */
+	struct PackedQuaternion {
+		constexpr static uint8_t componentBits = 10;
+		Array<uint8_t, 4> bits{};
+
+		PackedQuaternion() = default;
+		PackedQuaternion(const quaternion& value) {
+			const auto q = glm::normalize(value);
+			const float components[] = { float(q.x), float(q.y), float(q.z), float(q.w) };
+			uint8_t largest = 0;
+			for (uint8_t i = 1; i < 4; i++) {
+				if (std::abs(components[i]) > std::abs(components[largest])) {
+					largest = i;
+				}
+			}
+			const float sign = components[largest] < 0 ? -1.f : 1.f;
+
+			BitWriter writer(bits);
+			writer.Write(largest, 2);
+			for (uint8_t i = 0; i < 4; i++) {
+				if (i != largest) {
+					writer.Write(Component(sign * components[i]).steps, componentBits);
+				}
+			}
+		}
+
+		quaternion Get() const {
+			BitReader reader(bits);
+			uint32_t largest = 0;
+			reader.Read(largest, 2);
+			float components[4]{};
+			float sumSquares = 0;
+			for (uint8_t i = 0; i < 4; i++) {
+				if (i != largest) {
+					Component component;
+					uint32_t steps = 0;
+					reader.Read(steps, componentBits);
+					component.steps = decltype(component.steps)(steps);
+					components[i] = component.Get();
+					sumSquares += components[i] * components[i];
+				}
+			}
+			components[largest] = std::sqrt(std::max(0.f, 1.f - sumSquares));
+			return glm::normalize(quaternion(components[3], components[0], components[1], components[2]));
+		}
+
+	private:
+		// the components other than the largest are within +/- 1/sqrt(2)
+		using Component = RangedFloat<-0.70710678f, 0.70710678f, componentBits>;
+	};
+}
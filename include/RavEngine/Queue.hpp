@@ -1,6 +1,7 @@
 #pragma once
 #include <concurrentqueue.h>
 #include <queue>
+#include <algorithm>
 
 namespace RavEngine {
     template<typename T>
@@ -8,4 +9,23 @@ namespace RavEngine {
 
     template<typename T>
     using Queue = std::queue<T>;
+
+    /**
+     Move everything in a ConcurrentQueue onto the end of a vector, dequeueing in bulk rather than one item at a time.
+     Reuse the vector between calls so that draining does not allocate.
+     @return the number of items moved
+     */
+    template<typename T, typename Container>
+    size_t DequeueAllInto(ConcurrentQueue<T>& queue, Container& into) {
+        size_t total = 0, got = 0, want = 0;
+        do {
+            const auto old = into.size();
+            want = std::max<size_t>(queue.size_approx(), 16);
+            into.resize(old + want);
+            got = queue.try_dequeue_bulk(into.begin() + old, want);
+            into.resize(old + got);
+            total += got;
+        } while (got == want);
+        return total;
+    }
 }
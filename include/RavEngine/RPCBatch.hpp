@@ -0,0 +1,47 @@
+#pragma once
+#include "Vector.hpp"
+#include "Map.hpp"
+#include "Function.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace RavEngine {
+
+	/**
+	 RPC messages queued for one connection and reliability class, packed into as few network messages as possible.
+	 A batch is the BatchedRPCs command code followed by each RPC as a 16-bit length and its bytes.
+	 */
+	class RPCBatch {
+	public:
+		constexpr static uint32_t maxBatchSize = 1100;		// fits in one packet after the transport's headers
+
+		/**
+		 Queue an RPC message
+		 @param coalesce replace the queued message for the same entity and RPC id, if there is one, instead of adding another
+		 */
+		void Add(const std::string_view& msg, bool coalesce);
+
+		bool Empty() const {
+			return queued.empty();
+		}
+
+		/**
+		 Pack the queued messages in the order they were added, and forget them
+		 @param send invoked with each batch. RPCs too long to share a batch are passed on their own, without the batch header.
+		 */
+		void Flush(FunctionRef<void(const std::string_view&)> send);
+
+		/**
+		 Split a batch made by Flush
+		 @param each invoked with each RPC message in the batch
+		 @return false if the batch is malformed
+		 */
+		static bool Unpack(const std::string_view& batch, FunctionRef<void(const std::string_view&)> each);
+
+	private:
+		Vector<std::string> queued;
+		UnorderedMap<std::string, uint32_t> coalesced;		// entity and RPC id -> index into queued
+		std::string packed;
+	};
+}
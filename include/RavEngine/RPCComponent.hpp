@@ -22,9 +22,9 @@ namespace RavEngine {
         
         MOVE_NO_COPY(RPCComponent);
         
-        template<typename ... A>
-        struct RPCMessage{
-            static constexpr size_t bufsize = (RPCMsgUnpacker::TotalSerializedSize<A>() + ...) + RPCMsgUnpacker::header_size;
+        template<size_t size>
+        struct RPCBuffer{
+            static constexpr size_t bufsize = size;
         private:
             std::array<char,bufsize> buffer {0};
         public:
@@ -42,6 +42,12 @@ namespace RavEngine {
                 return std::string_view(buffer.data(),bufsize);
             }
         };
+
+        template<typename ... A>
+        using RPCMessage = RPCBuffer<(RPCMsgUnpacker::TotalSerializedSize<A>() + ...) + RPCMsgUnpacker::header_size>;
+
+        template<typename ... A>
+        using CompactRPCMessage = RPCBuffer<RPCMsgUnpacker::CompactSize<A...>()>;
         
 
 	private:
@@ -53,7 +59,8 @@ namespace RavEngine {
 		typedef locked_node_hashmap<uint16_t, rpc_entry, phmap::NullMutex> rpc_store;
 
         struct enqueued_rpc {
-			std::string msg;
+			NetworkBase::MessageRef source;		// owns msg
+			std::string_view msg;
 			bool isOwner;
 			HSteamNetConnection origin;
 		};
@@ -65,6 +72,7 @@ namespace RavEngine {
                 readingptr_s = &S_buffer_A, writingptr_s = &S_buffer_B;
             
             rpc_store ClientRPCs, ServerRPCs;
+            UnorderedSet<uint16_t> CoalescedRPCs, CompactRPCs;
 
             void Swap(){
                 queue_t* reading = readingptr_c.load(), * writing = writingptr_c.load();
@@ -115,13 +123,13 @@ namespace RavEngine {
 		*/
 		template<typename ... A>
 		inline RPCMessage<A...> SerializeRPC(uint16_t id, A&& ... args) const{
-			auto& uuid_bytes = GetOwner().GetComponent<NetworkIdentity>().GetNetworkID();
+			const auto sessionID = GetOwner().GetComponent<NetworkIdentity>().GetSessionID();
             RPCMessage<A...> msg;   // default-init to zeros
 
 			//write message header
 			msg[0] = NetworkBase::CommandCode::RPC;							//command code
-			std::memcpy(msg.data() + 1, uuid_bytes.raw(), uuid_bytes.size());	//entity uuid
-			std::memcpy(msg.data() + 1 + uuid_bytes.size(), &id, sizeof(id));	//RPC ID
+			std::memcpy(msg.data() + 1, &sessionID, sizeof(sessionID));		//entity session id
+			std::memcpy(msg.data() + RPCMsgUnpacker::code_offset, &id, sizeof(id));	//RPC ID
 
 			//write mesage body
 			size_t offset = RPCMsgUnpacker::header_size;
@@ -130,12 +138,54 @@ namespace RavEngine {
 			return msg;
 		}
 
+		/**
+		Create a serialized RPC invocation with one signature for all the parameters, instead of a type per parameter
+		@param id the RPC id number
+		@param args the varargs to encode
+		*/
+		template<typename ... A>
+		inline CompactRPCMessage<A...> SerializeCompactRPC(uint16_t id, A&& ... args) const{
+			const auto sessionID = GetOwner().GetComponent<NetworkIdentity>().GetSessionID();
+			const auto signature = RPCMsgUnpacker::Signature<A...>();
+            CompactRPCMessage<A...> msg;
+
+			msg[0] = NetworkBase::CommandCode::CompactRPC;
+			std::memcpy(msg.data() + 1, &sessionID, sizeof(sessionID));
+			std::memcpy(msg.data() + RPCMsgUnpacker::code_offset, &id, sizeof(id));
+			std::memcpy(msg.data() + RPCMsgUnpacker::header_size, &signature, sizeof(signature));
+
+			size_t offset = RPCMsgUnpacker::header_size + sizeof(signature);
+			((std::memcpy(msg.data() + offset, &args, RPCMsgUnpacker::SerializedSize<A>()), offset += RPCMsgUnpacker::SerializedSize<A>()), ...);
+			Debug::Assert(offset == msg.bufsize, "Incorrect number of bytes written!");
+			return msg;
+		}
+
+		/**
+		Serialize an RPC in the encoding chosen for it, and pass it to send
+		@param network counts the time spent serializing
+		*/
+		template<typename Fn, typename ... A>
+		inline void SerializeAndSend(const NetworkBase& network, uint16_t id, const Fn& send, A&& ... args) const{
+			const auto begin = std::chrono::steady_clock::now();
+			const auto serialized = [&](const std::string_view& msg) {
+				network.RecordRPCSerialized(id, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin));
+				send(msg);
+			};
+			if (data->CompactRPCs.contains(id)) {
+				serialized(SerializeCompactRPC(id, args...).toView());
+			}
+			else {
+				serialized(SerializeRPC(id, args...).toView());
+			}
+		}
+
 		/**
 		Consume enqueued RPCs
 		@param ptr the queue to consume from
 		@param table the datastructure to look up the results in
+		@param network counts the time spent running each RPC, if it exists
 		*/
-        inline void ProcessRPCs_impl(const std::atomic<queue_t*>& ptr, const rpc_store& table) {
+        inline void ProcessRPCs_impl(const std::atomic<queue_t*>& ptr, const rpc_store& table, const NetworkBase* network) {
 			auto reading = ptr.load();
 			enqueued_rpc cmd;
 			while (reading->try_dequeue(cmd)) {
@@ -146,8 +196,12 @@ namespace RavEngine {
 				//invoke that RPC
 				if (table.if_contains(RPC, [&](const rpc_entry& func) {
 					if (cmd.isOwner || func.mode == Directionality::Bidirectional) {
+                        const auto begin = std::chrono::steady_clock::now();
                         RPCMsgUnpacker packer{cmd.msg};
 						func.func(packer, cmd.origin);
+						if (network) {
+							network->RecordRPCHandled(RPC, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin));
+						}
 					}
 					})) {
 				}
@@ -179,6 +233,23 @@ namespace RavEngine {
 			RegisterRPC_Impl(name, func, data->ClientRPCs, type);
 		}
 
+		/**
+		Send only the latest invocation of an RPC on this entity each tick. Use for RPCs that carry state rather than events.
+		@param id the numeric ID for the RPC
+		*/
+		inline void CoalesceRPC(uint16_t id) {
+			data->CoalescedRPCs.insert(id);
+		}
+
+		/**
+		Send an RPC with one signature for all its parameters instead of a type per parameter, which saves 8 bytes a parameter.
+		Read its parameters with RPCMsgUnpacker::Unpack. Pair with the types in Quantize.hpp to shrink the parameters themselves.
+		@param id the numeric ID for the RPC
+		*/
+		inline void CompactRPC(uint16_t id) {
+			data->CompactRPCs.insert(id);
+		}
+
 		/**
 		Invoke an RPC on the server
 		@param id the name of the RPC
@@ -188,8 +259,9 @@ namespace RavEngine {
 		template<typename ... A>
         constexpr inline void InvokeServerRPC(uint16_t id, NetworkBase::Reliability mode, A&& ... args) const{
 			if (data->ServerRPCs.contains(id)) {
-				auto msg = SerializeRPC(id, args...);
-				GetApp()->networkManager.client->SendMessageToServer(msg.toView(), mode);
+				SerializeAndSend(*GetApp()->networkManager.client, id, [&](const std::string_view& msg) {
+					GetApp()->networkManager.client->QueueRPC(msg, mode, data->CoalescedRPCs.contains(id));
+				}, args...);
 			}
 			else {
 				Debug::Warning("Cannot send Server RPC with ID {}", id);
@@ -199,8 +271,9 @@ namespace RavEngine {
 		template<typename ... A>
         constexpr inline void InvokeClientRPCDirected(uint16_t id, HSteamNetConnection target, NetworkBase::Reliability mode, A&& ... args) const{
 			if (data->ClientRPCs.contains(id)) {
-				auto msg = SerializeRPC(id, args...);
-				GetApp()->networkManager.server->SendMessageToClient(msg, target, mode);
+				SerializeAndSend(*GetApp()->networkManager.server, id, [&](const std::string_view& msg) {
+					GetApp()->networkManager.server->QueueRPC(msg, target, mode, data->CoalescedRPCs.contains(id));
+				}, args...);
 			}
 			else {
 				Debug::Warning("Cannot send Client RPC with ID {} to recipient {}", id, target);
@@ -210,8 +283,9 @@ namespace RavEngine {
 		template<typename ... A>
         constexpr inline void InvokeClientRPCToAllExcept(uint16_t id, HSteamNetConnection doNotSend, NetworkBase::Reliability mode, A&& ... args) const{
 			if (data->ClientRPCs.contains(id)) {
-				auto msg = SerializeRPC(id, args...);
-				GetApp()->networkManager.server->SendMessageToAllClientsExcept(msg.toView(), doNotSend, mode);
+				SerializeAndSend(*GetApp()->networkManager.server, id, [&](const std::string_view& msg) {
+					GetApp()->networkManager.server->QueueEntityRPC(msg, GetOwner().GetComponent<NetworkIdentity>().GetSessionID(), mode, data->CoalescedRPCs.contains(id), doNotSend);
+				}, args...);
 			}
 			else {
 				Debug::Warning("Cannot send Client RPC with ID {} to all except {}", id, doNotSend);
@@ -227,8 +301,9 @@ namespace RavEngine {
 		template<typename ... A>
         constexpr inline void InvokeClientRPC(uint16_t id, NetworkBase::Reliability mode, A&& ... args) const{
 			if (data->ClientRPCs.contains(id)) {
-				auto msg = SerializeRPC(id, args...);
-				GetApp()->networkManager.server->SendMessageToAllClients(msg.toView(), mode);
+				SerializeAndSend(*GetApp()->networkManager.server, id, [&](const std::string_view& msg) {
+					GetApp()->networkManager.server->QueueEntityRPC(msg, GetOwner().GetComponent<NetworkIdentity>().GetSessionID(), mode, data->CoalescedRPCs.contains(id));
+				}, args...);
 			}
 			else {
 				Debug::Warning("Cannot send Client RPC with ID {}", id);
@@ -238,29 +313,29 @@ namespace RavEngine {
 		/**
 		Invoked automatically. For internal use only.
 		*/
-        inline void CacheClientRPC(const std::string_view& cmd, bool isOwner, HSteamNetConnection origin) {
-			data->writingptr_c.load()->enqueue({ std::string(cmd.data(),cmd.size()), isOwner, origin });
+        inline void CacheClientRPC(const std::string_view& cmd, const NetworkBase::MessageRef& source, bool isOwner, HSteamNetConnection origin) {
+			data->writingptr_c.load()->enqueue({ source, cmd, isOwner, origin });
 		}
 
 		/**
 		Invoked automatically. For internal use only.
 		*/
-        inline void CacheServerRPC(const std::string_view& cmd, bool isOwner, HSteamNetConnection origin) {
-			data->writingptr_s.load()->enqueue({ std::string(cmd.data(),cmd.size()), isOwner, origin });
+        inline void CacheServerRPC(const std::string_view& cmd, const NetworkBase::MessageRef& source, bool isOwner, HSteamNetConnection origin) {
+			data->writingptr_s.load()->enqueue({ source, cmd, isOwner, origin });
 		}
 
 		/**
 		Invoked automatically. For internal use only.
 		*/
         inline void ProcessClientRPCs() {
-			ProcessRPCs_impl(data->readingptr_c, data->ClientRPCs);
+			ProcessRPCs_impl(data->readingptr_c, data->ClientRPCs, GetApp()->networkManager.client.get());
 		}
 
 		/**
 		Invoked automatically. For internal use only.
 		*/
         inline void ProcessServerRPCs() {
-			ProcessRPCs_impl(data->readingptr_s, data->ServerRPCs);
+			ProcessRPCs_impl(data->readingptr_s, data->ServerRPCs, GetApp()->networkManager.server.get());
 		}
 
 
@@ -1,35 +1,58 @@
 #pragma once
-#include <string>
+#include <string_view>
 #include <optional>
 #include <cstring>
+#include <tuple>
+#include <type_traits>
+#include "NetworkIDTable.hpp"
+#include "NetworkBase.hpp"
 
 namespace RavEngine {
 	class RPCMsgUnpacker {
-		std::string message;
-		uint32_t offset = header_size;   //advance past the RPC message header
+	public:
+        using signature_t = uint32_t;
+        static constexpr size_t code_offset = 1 + sizeof(netid_t);
+        static constexpr size_t header_size = code_offset + sizeof(uint16_t);    //command code, entity session id, method ID
+
+	private:
+		std::string_view message;	// owned by the received network message
+		bool compact;				// one signature for all the parameters instead of a type per parameter
+		uint32_t offset;   //advance past the RPC message header
         
         template<typename T>
-        inline T Deserialize() const{
+        inline T Deserialize(size_t at) const{
             T val;
-            std::memcpy(&val, message.data() + offset+sizeof(ctti_t), SerializedSize<T>());
+            std::memcpy(&val, message.data() + at, SerializedSize<T>());
             return val;
         }
         
 	public:
-        static constexpr size_t code_offset = 16 + 1;
-        static constexpr size_t header_size = code_offset + sizeof(uint16_t);    //uuid, command code, method ID
-        
-		RPCMsgUnpacker(const std::string& msg) : message(msg) {}
+		RPCMsgUnpacker(const std::string_view& msg) : message(msg),
+            compact(!msg.empty() && uint8_t(msg[0]) == NetworkBase::CommandCode::CompactRPC),
+            offset(uint32_t(header_size + (compact ? sizeof(signature_t) : 0))) {}
 
+        /**
+         Read the next parameter. In compact messages, the type is not checked, use Unpack.
+         */
 		template<typename T>
         constexpr inline std::optional<T> Get() {
 			std::optional<T> result;
+            if (compact){
+                if (offset + SerializedSize<T>() <= message.size()){
+                    result.emplace(Deserialize<T>(offset));
+                    offset += SerializedSize<T>();
+                }
+                return result;
+            }
+            if (offset + TotalSerializedSize<T>() > message.size()){
+                return result;  // no more parameters
+            }
 			//is the current parameter the same type as T?
             ctti_t enc_type = 0;
             std::memcpy(&enc_type,message.data()+offset,sizeof(enc_type));
             if (enc_type == CTTI<T>()){
                 //deserialize the type using template specialization
-                auto val = Deserialize<T>();
+                auto val = Deserialize<T>(offset + sizeof(ctti_t));
 
                 //advance the offset pointer
                 offset += TotalSerializedSize<decltype(val)>();
@@ -40,6 +63,51 @@ namespace RavEngine {
 				
 			return result;
 		}
+
+        /**
+         Read all the parameters at once, checking that they are the types the RPC was invoked with
+         @return the parameters, or nothing if the types do not match
+         */
+        template<typename ... A>
+        inline std::optional<std::tuple<A...>> Unpack() {
+            if (compact){
+                signature_t signature = 0;
+                if (message.size() != CompactSize<A...>()){
+                    return std::nullopt;
+                }
+                std::memcpy(&signature, message.data() + header_size, sizeof(signature));
+                if (signature != Signature<A...>()){
+                    return std::nullopt;
+                }
+            }
+            // braced initialization reads the parameters in order
+            std::tuple<std::optional<A>...> values{ Get<A>()... };
+            return std::apply([](auto& ... value) -> std::optional<std::tuple<A...>> {
+                if ((value.has_value() && ...)){
+                    return std::tuple<A...>(std::move(*value)...);
+                }
+                return std::nullopt;
+            }, values);
+        }
+
+        bool IsCompact() const{
+            return compact;
+        }
+
+        /**
+         @return a hash of the parameter types, sent once in compact messages
+         */
+        template<typename ... A>
+        static inline constexpr signature_t Signature(){
+            signature_t hash = 2166136261u;
+            ((hash = (hash ^ signature_t(CTTI<std::remove_cvref_t<A>>())) * 16777619u), ...);
+            return hash;
+        }
+
+        template<typename ... A>
+        static inline constexpr size_t CompactSize(){
+            return header_size + sizeof(signature_t) + (SerializedSize<A>() + ... + 0);
+        }
         
         template<typename T>
         static inline constexpr size_t SerializedSize(){
@@ -11,21 +11,33 @@
 #include <RmlUi/Core/RenderInterface.h>
 #include <DebugDraw.h>
 #include "Common3D.hpp"
+#include "DebugDrawer.hpp"
 #include "Defines.hpp"
 #include "PhysXDefines.h"
 #include <RGL/Types.hpp>
 #include <RGL/TextureFormat.hpp>
 #include <RGL/Buffer.hpp>
+#include <RGL/CommandBuffer.hpp>
+#include <RGL/Swapchain.hpp>
 #include <span>
 #include "SpinLock.hpp"
 #include "MeshAllocation.hpp"
 #include "RenderTargetCollection.hpp"
 #include "PostProcess.hpp"
 #include <unordered_set>
+#include <deque>
+#include <filesystem>
+#include <array>
 #include "cluster_defs.h"
 #include "Queue.hpp"
 #include "Layer.hpp"
 #include "Mesh.hpp"
+#include "ShadowAtlasAllocator.hpp"
+#include "DynamicResolutionController.hpp"
+#include "VRAMBudgetController.hpp"
+#include "TextureStreamer.hpp"
+#include "AsyncTextureLoader.hpp"
+#include "ParticlePool.hpp"
 #include <span>
 
 struct SDL_Window;
@@ -44,7 +56,11 @@ namespace RavEngine {
     class World;
 	struct MeshAsset;
 	struct GUIComponent;
+	struct GUIDrawList;
 	struct DummyTonemapInstance;
+	struct ParticleEmitter;
+	struct ParticleUpdateMaterial;
+	struct Skybox;
 
 	namespace Clustered {
 		constexpr static uint32_t gridSizeX = 12;
@@ -52,13 +68,25 @@ namespace RavEngine {
 		constexpr static uint32_t gridSizeZ = 24;
 		constexpr static uint32_t numClusters = gridSizeX * gridSizeY * gridSizeZ;
 
-		struct Cluster {
+		constexpr static uint32_t initialLightIndexCapacity = numClusters * 32;
+
+		// view-space bounds, which only change with the projection and the screen size
+		struct ClusterBounds {
 			glm::vec3 minPoint;
 			glm::vec3 maxPoint;
+		};
+
+		// the cluster's point lights are at [offset, offset + pointLightCount) in the light index list, followed by its spot lights
+		struct Cluster {
+			uint32_t offset;
 			uint32_t pointLightCount;
 			uint32_t spotLightCount;
-			uint32_t pointLightIndices[CLUSTER_MAX_POINTS];
-			uint32_t spotLightIndices[CLUSTER_MAX_SPOTS];
+		};
+
+		// see TileDepthBounds in cluster_shared.glsl
+		struct TileDepthBounds {
+			float nearDistance;
+			float farDistance;
 		};
 	}
 
@@ -72,24 +100,71 @@ namespace RavEngine {
 
 		RGLDevicePtr device;
 		RGLCommandQueuePtr mainCommandQueue;
-		RGLCommandBufferPtr mainCommandBuffer, transformSyncCommandBuffer, transientCommandBuffer;
+		RGLCommandBufferPtr mainCommandBuffer, transformSyncCommandBuffer, transientCommandBuffer, meshUploadCommandBuffer;
+		// compute work that nothing before the first draw depends on, such as the particle simulation, runs here alongside the main queue
+		RGLCommandQueuePtr asyncComputeQueue;
+		RGLCommandBufferPtr asyncComputeCommandBuffer;
+		std::vector<RGLCommandBufferPtr> asyncComputeDependencies;
 		bool transientSubmittedLastFrame = false;
 
 		RGLTexturePtr dummyShadowmap, dummyCubemap;
 		RGLSamplerPtr textureSampler, shadowSampler, depthPyramidSampler;
-		RGLRenderPassPtr litRenderPass, unlitRenderPass, depthPrepassRenderPass, postProcessRenderPass, postProcessRenderPassClear, finalRenderPass, finalRenderPassNoDepth, shadowRenderPass, lightingClearRenderPass, litClearRenderPass, finalClearRenderPass, depthPyramidCopyPass, litTransparentPass, unlitTransparentPass, transparentClearPass, transparencyApplyPass, ssgiPassNoClear, ssgiAmbientApplyPass, ssgiPassClear;
+		RGLSamplerPtr materialTextureSampler;	// filters between mips when minifying, textureSampler only samples mip 0
+		RGLRenderPassPtr litRenderPass, unlitRenderPass, depthPrepassRenderPass, postProcessRenderPass, postProcessRenderPassClear, finalRenderPass, finalRenderPassNoDepth, shadowRenderPass, shadowRenderPassLoad, lightingClearRenderPass, litClearRenderPass, finalClearRenderPass, depthPyramidCopyPass, litTransparentPass, unlitTransparentPass, transparentClearPass, transparencyApplyPass, ssgiPassNoClear, ssgiAmbientApplyPass, ssgiPassClear, ssgiTemporalPass, skyCachePass, skyIrradiancePass;
 
-		RGLRenderPipelinePtr depthPyramidCopyPipeline,
-			im3dLineRenderPipeline, im3dPointRenderPipeline, im3dTriangleRenderPipeline, recastLinePipeline, recastPointPipeline, recastTrianglePipeline, guiRenderPipeline, transparencyApplyPipeline, ssgipipeline, ssgiDownsamplePipeline, ssgiUpsamplePipeline, ambientSSGIApplyPipeline, aoUpsamplePipeline, ssgiUpsamplePipleineFinalStep;
-		RGLComputePipelinePtr skinnedMeshComputePipeline, defaultCullingComputePipeline, skinningDrawCallPreparePipeline, depthPyramidPipeline, particleCreatePipeline, particleDispatchSetupPipeline, particleDispatchSetupPipelineIndexed, particleKillPipeline, clusterBuildGridPipeline, clusterPopulatePipeline;
+		RGLRenderPipelinePtr depthPyramidCopyPipeline, shadowTileClearPipeline,
+			im3dLineRenderPipeline, im3dPointRenderPipeline, im3dTriangleRenderPipeline, recastLinePipeline, recastPointPipeline, recastTrianglePipeline, guiRenderPipeline, transparencyApplyPipeline, ssgipipeline, ssgiDownsamplePipeline, ssgiUpsamplePipeline, ambientSSGIApplyPipeline, aoUpsamplePipeline, ssgiUpsamplePipleineFinalStep, ssgiTemporalPipeline, skyCachePipeline, skyIrradiancePipeline;
+		RGLComputePipelinePtr skinnedMeshComputePipeline, defaultCullingComputePipeline, skinningDrawCallPreparePipeline, depthPyramidPipeline, particleCreatePipeline, particleDispatchSetupPipeline, particleKillPipeline, clusterBuildGridPipeline, clusterCullLightsPipeline, clusterPopulatePipeline, clusterDepthBoundsPipeline, compactDrawsPipeline;
 		RGLBufferPtr screenTriVerts,
-			sharedPositionBuffer,sharedNormalBuffer, sharedTangentBuffer, sharedBitangentBuffer, sharedUV0Buffer, sharedLightmapUVBuffer, sharedIndexBuffer, sharedSkeletonMatrixBuffer, sharedSkinnedPositionBuffer, sharedSkinnedNormalBuffer, sharedSkinnedTangentBuffer, sharedSkinnedBitangentBuffer, sharedSkinnedUV0Buffer, quadVertBuffer, lightClusterBuffer, debugRenderBufferUpload;
-		uint32_t debugRenderBufferSize = 0, debugRenderBufferOffset = 0;
+			sharedPositionBuffer,sharedNormalBuffer, sharedTangentBuffer, sharedBitangentBuffer, sharedUV0Buffer, sharedLightmapUVBuffer, sharedIndexBuffer, sharedSkeletonMatrixBuffer, sharedSkinnedPositionBuffer, sharedSkinnedNormalBuffer, sharedSkinnedTangentBuffer, sharedSkinnedBitangentBuffer, sharedSkinnedUV0Buffer, quadVertBuffer, lightClusterBuffer, clusterLightIndexBuffer, clusterLightCounterBuffer, clusterLightCounterResetBuffer, dummyCullHistoryBuffer;
+		RGLBufferPtr sharedSkinningSlotBuffer;	// the output slot of each object a skinning dispatch skins
+		OffsetAllocator skinnedOutputAllocator;	// in vertices, places each skinned command's slots in the shared skinned vertex buffers
+		bool supportsIndirectCount = false;		// if true, culled draws are compacted and submitted with a GPU-written draw count
+		uint32_t shadingRateTileSize = 0;		// pixels per shading rate texel, 0 if the device cannot vary the shading rate. See FoveationSettings
+		RGLComputePipelinePtr shadingRatePipeline;	// only created if shadingRateTileSize is not 0
+		RGLComputePipelinePtr fusedPostProcessPipeline;	// see VideoSettings::fusedPostProcessing
+
+		struct FusedPostProcessUBO {
+			glm::ivec2 dim;
+			uint32_t options = 0;
+			float bloomStrength = 0;
+			static constexpr uint32_t TRANSPARENCYBIT = 1, BLOOMBIT = 1 << 1, FXAABIT = 1 << 2;
+			static constexpr uint32_t tileSize = 16;	// see post_fused.csh
+		};
+
+		RGLComputePipelinePtr temporalUpscalePipeline;	// see VideoSettings::temporalUpscaling
+		RGLSamplerPtr temporalUpscaleSampler;			// bilinear, for the Catmull-Rom taps into the history
+
+		struct TemporalUpscaleUBO {
+			glm::mat4 invViewProj;		// this frame's, with the jitter, to place the depth samples in the world
+			glm::mat4 prevViewProj;		// last frame's, without the jitter
+			glm::ivec4 inputRect;		// the camera's render area in the scene textures
+			glm::ivec4 outputRect;		// the camera's viewport in the output and the history
+			glm::vec2 jitter;			// in input pixels
+			float currentWeight = 0.1;	// how much of this frame goes into the result where the history is valid
+			uint32_t options = 0;
+			static constexpr uint32_t HISTORYBIT = 1, OBJECTMOTIONBIT = 1 << 1;
+			static constexpr uint32_t tileSize = 8;		// see taa_upscale.csh
+		};
+
+		// last frame's worldTransforms, for the motion of objects under temporal upscaling. Copied at the end of each frame that upscales.
+		RGLBufferPtr prevWorldTransforms;
+		const World* prevWorldTransformsWorld = nullptr;
+		uint64_t prevWorldTransformsFrame = 0;
+
+		struct ShadingRateUBO {
+			glm::uvec2 tileOffset;
+			glm::uvec2 tileCount;
+			glm::vec2 center;
+			float innerRadius, outerRadius;
+			uint32_t enabled;
+		};
 
 		constexpr static uint32_t initialVerts = 1024, initialIndices = 1536;
 
 		struct PyramidCopyUBO {
 			uint32_t size;
+			float uvScale = 1;	// the part of the depth texture that was rendered to, see renderScale
 		};
 
 		Ref<DummyTonemapInstance> dummyTonemap;
@@ -101,6 +176,9 @@ namespace RavEngine {
             perObject = 7,
             depthPyramid = 8,
             depthPyramidSamplerBinding = 9,
+            cullHistory = 10,
+            visibility = 11,
+            views = 12,
         };
 
 #pragma pack(push, 1)
@@ -115,9 +193,42 @@ namespace RavEngine {
 
 		struct GridAssignUBO {
 			glm::mat4 viewMat;
+			uint32_t pointLightCount, spotLightCount, lightIndexCapacity;
+			uint32_t tilesPerSlice = 0;
+		};
+
+		struct LightCullUBO {
+			glm::vec4 planes[6];		// see FrustumPlanes, normalized
 			uint32_t pointLightCount, spotLightCount;
 		};
 
+		struct ClusterDepthBoundsUBO {
+			glm::mat4 invProj;
+			glm::uvec2 viewportOffset;
+			glm::uvec2 viewportSize;
+			glm::uvec2 gridSize;
+		};
+
+		// cluster bounds are rebuilt only when a view's projection or size changes
+		struct ClusterGridCacheEntry {
+			GridBuildUBO key;
+			RGLBufferPtr bounds;
+			uint64_t lastUsedFrame = 0;
+		};
+		Vector<ClusterGridCacheEntry> clusterGridCache;
+		constexpr static uint64_t clusterGridCacheFrames = 60;	// grids unused for this long are released
+		uint32_t clusterLightIndexCapacity = Clustered::initialLightIndexCapacity;
+		RGLBufferPtr clusterTileDepthBuffer;	// a TileDepthBounds per screen tile of the cluster grid, from the current camera's depth prepass
+		RGLBufferPtr clusterVisibleLightBuffer;	// the point and spot lights in the current view, see cluster_cull_lights.csh
+		uint32_t clusterVisibleLightCapacity = 0;	// lights the visible list can hold, grown to the world's light count
+		bool clusterTileDepthValid = false;		// set between a camera's depth prepass and its opaque lit pass, when the bounds match its depth
+
+		/**
+		Grow the light index list if the previous frame overflowed it, and release stale cluster grids.
+		Must be called after the previous frame has completed on the GPU.
+		*/
+		void UpdateLightClusters();
+
 		struct DownsampleUBO {
 			glm::uvec4 targetDim;
 		};
@@ -125,14 +236,41 @@ namespace RavEngine {
 		struct UpsampleUBO {
 			glm::uvec4 targetDim;
 			float filterRadius;
+			float depthSensitivity = 0;	// ao_upsample only. Taps at other depths than the center are weighted down by this much, 0 disables
+		};
+
+		struct SSGITemporalUBO {
+			glm::mat4 invProj;
+			glm::mat4 currentToPrevView;
+			glm::mat4 prevProj;
+			glm::ivec2 outputDim;
+			glm::vec2 uvScale;
+			glm::vec2 prevUVScale;
+			float currentWeight;		// how much of this frame's trace goes into the result
+			uint32_t historyValid;
 		};
 
 		struct AmbientSSGIApplyUBO {
+			glm::mat4 invView;		// to bring the view space normals into the world space of the sky irradiance
 			uint32_t ambientLightCount = 0;
 			float ssaoStrength = 1;
 			uint32_t options = 0;
-			static constexpr uint32_t SSAOBIT = 1, SSGIBIT = 1 << 1;
+			float skyIntensity = 0;
+			static constexpr uint32_t SSAOBIT = 1, SSGIBIT = 1 << 1, SKYBIT = 1 << 2;
 		};
+
+		// the EngineData of sky materials, see skybox.vsh
+		struct SkyboxData {
+			glm::mat3 invView;
+			glm::vec3 camPos;
+			float fov;
+			float aspectRatio;
+		};
+
+		/**
+		Render a cached sky into its faces and irradiance if the sky or its resolution changed since it was last rendered. See Skybox::cached
+		*/
+		void UpdateSkyCache(Skybox& skybox);
         
         RGLShaderLibraryPtr defaultPostEffectVSH;
 
@@ -151,6 +289,7 @@ namespace RavEngine {
 			albedoFormat = RGL::TextureFormat::RGBA16_Sfloat,
 			viewSpaceNormalTextureFormat = RGL::TextureFormat::RGBA16_Sfloat,
 			ssgiOutputFormat = RGL::TextureFormat::RGBA16_Sfloat,
+			indirectLightingHistoryDepthFormat = RGL::TextureFormat::R32_Float,
 			depthFormat = RGL::TextureFormat::D32SFloat;
 
 		struct navDebugUBO {
@@ -160,6 +299,7 @@ namespace RavEngine {
 
 		struct LightToFBUBO {
 			glm::ivec4 viewRect;
+			glm::vec2 sourceUVScale{ 1, 1 };	// the part of the lighting texture the scene was rendered into, see renderScale
 		};
 
 		struct GUIUBO {
@@ -174,9 +314,15 @@ namespace RavEngine {
 			uint32_t numObjects = 0;
 			uint32_t numVertices = 0;
 			uint32_t numBones = 0;
-			uint32_t boneReadOffset = 0;
 			uint32_t vertexWriteOffset = 0;
 			uint32_t vertexReadOffset = 0;
+			uint32_t slotReadOffset = 0;
+		};
+
+		// see SkinningObject in skinning_cs.csh
+		struct SkinningObject {
+			uint32_t slot = 0;
+			uint32_t boneBegin = 0;
 		};
 
 		struct SSGIUBO {
@@ -187,6 +333,8 @@ namespace RavEngine {
 			float sampleRadius;
 			float sliceCount;
 			float hitThickness;
+			glm::vec2 uvScale{ 1, 1 };	// from outputDim to the part of the input textures the scene was rendered into
+			float noiseOffset = 0;		// rotates the samples between frames when they are accumulated
 		};
 
 		struct JointInfluence {
@@ -204,6 +352,12 @@ namespace RavEngine {
 			uint32_t entityIDInputBufferBindlessHandle = 0;
 			uint32_t indirectOutputBufferBindlessHandle = 0;
 			uint32_t lodDistanceBufferBindlessHandle = 0;
+			uint32_t hasMeshlets = 0;		// if 0, the two handles below are not valid and each LOD is one indirect command
+			uint32_t lodDrawSlotsBufferBindlessHandle = 0;
+			uint32_t meshletBufferBindlessHandle = 0;
+			// how far apart consecutive views' slices of the indirect and output ID buffers are, when culling several views at once
+			uint32_t indirectViewStride = 0;
+			uint32_t cullingViewStride = 0;
 		};
 
 		struct CullingUBO {
@@ -212,6 +366,38 @@ namespace RavEngine {
 			uint32_t numCubos;
 			renderlayer_t cameraRenderLayers = 0;
 			uint32_t singleInstanceModeAndShadowMode = 0;	// skinning vs not skinning
+			uint32_t cullPhase = 0;		// a CullPhase
+			uint32_t numViews = 1;		// if more than 1, the views come from a CullingView buffer instead of viewProj, camPos and cameraRenderLayers
+		};
+
+		// one view of a multi-view cull, see CullingUBO::numViews
+		struct CullingView {
+			glm::mat4 viewProj;
+			glm::vec3 camPos;
+			renderlayer_t renderLayers = 0;
+		};
+		// the most views one culling dispatch tests, which bounds how many copies of the indirect and culling buffers exist
+		constexpr static uint32_t maxCullViews = 6;
+
+		// matches the CULL_PHASE_ defines in defaultcull.csh
+		enum class CullPhase : uint32_t {
+			Single = 0,
+			VisibleLastFrame = 1,
+			Remaining = 2,
+		};
+
+		// one view's slice of a material's indirect buffer, for compactdraws.csh
+		struct CompactDrawRange {
+			uint32_t indirectBufferBindlessHandle;
+			uint32_t compactedBufferBindlessHandle;
+			uint32_t countBufferBindlessHandle;
+			uint32_t sliceStart;	// in commands
+			uint32_t numDrawSlots;
+			uint32_t view;
+		};
+
+		struct CompactDrawsUBO {
+			uint32_t numRanges;
 		};
 
 		struct SkinningPrepareUBO {
@@ -224,23 +410,50 @@ namespace RavEngine {
 			uint32_t baseInstanceOffset = 0;
 		};
 
-		struct ParticleCreationPushConstants {
-			uint32_t particlesToSpawn;
+		// one emitter of a batched particle dispatch, see ParticleEmitterDispatch in particle_shared.glsl
+		struct ParticleEmitterDispatch {
+			uint32_t stateSlot;
+			uint32_t particleBase;
 			uint32_t maxParticles;
+			uint32_t particlesToSpawn;
 		};
 
-		struct KillParticleUBO {
-			uint32_t maxTotalParticles;
+		struct ParticleDispatchSetupUBO {
+			uint32_t numEmitters;
+			uint32_t firstCommand;
 		};
 
+		// emitters that share an update material, a pool and a time step are simulated together, one dispatch per stage
+		struct ParticleBatch {
+			Ref<ParticleUpdateMaterial> material;
+			uint16_t particleSize = 0;
+			float timeScale = 0;		// the update shader's fpsScale, larger for emitters that skipped frames
+			uint32_t maxSpawn = 0;
+			Vector<ParticleEmitterDispatch> emitters;
+			Vector<ParticleEmitter*> meshEmitters;
+		};
+		Vector<ParticleBatch> particleBatches;
+		UnorderedMap<uint16_t, ParticlePool> particlePools;		// by particle size
+		RGLBufferPtr particleDispatchBuffer;	// the init, update and kill dispatches of each batch, written by particle_dispatch_setup
+		uint32_t particleDispatchBufferBatches = 0;
+
 		virtual ~RenderEngine();
         RenderEngine(const AppConfig&, RGLDevicePtr device);
 
+		/**
+		Create the targets for rendering a view. Depth and the depth pyramid belong to the collection. The other targets only hold data
+		while a view is being encoded, and views are encoded one after another, so collections of the same size share them.
+		*/
 		RenderTargetCollection CreateRenderTargetCollection(dim size, bool createDepth = true);
 		void ResizeRenderTargetCollection(RenderTargetCollection& collection, dim size);
 
 		//render a world, for internal use only
 		RGLCommandBufferPtr Draw(Ref<RavEngine::World>, const std::span<RenderViewCollection> screenTargets, float guiScaleFactor);
+
+		// the command buffers that the one returned by Draw must wait for, at RGL::WaitStage::Draws, when it is committed
+		std::span<const RGLCommandBufferPtr> GetDrawDependencies() const {
+			return { &asyncComputeCommandBuffer, 1 };
+		}
         
         /**
          @return The name of the current rendering API in use
@@ -248,9 +461,23 @@ namespace RavEngine {
         static const std::string_view GetCurrentBackendName();
 		
 		static struct vs {
-			bool vsync = true;
+			// Fifo is vsync. Mailbox and Immediate show frames sooner, at the cost of GPU work on frames that are never shown, and tearing for Immediate.
+			RGL::PresentMode presentMode = RGL::PresentMode::Fifo;
+			// frames presented but not yet displayed. 1 has the least input latency, higher values absorb uneven frame times.
+			uint32_t maxFrameLatency = 2;
+			// when the post processing stack ends in a BloomEffect and/or FXAAEffect, apply them and the transparency resolve
+			// in one compute pass, instead of a full screen pass each. The bloom mip chain is still rendered as its own passes.
+			bool fusedPostProcessing = false;
+			// render the scene at temporalUpscalingScale of the output resolution, with a sub-pixel jitter that changes every frame,
+			// and reconstruct the output resolution from the frames accumulated over time. This also anti-aliases, so FXAA is redundant
+			// with it. When dynamic resolution is enabled, it picks the scale instead.
+			bool temporalUpscaling = false;
+			float temporalUpscalingScale = 0.67f;
 		} VideoSettings;
 
+		/**
+		 Apply changes to VideoSettings to the main window
+		 */
 		void SyncVideoSettings();
 		
 		// Rml::SystemInterface overrides, used internally
@@ -303,9 +530,28 @@ namespace RavEngine {
         void vertex(const float x, const float y, const float z, unsigned int color, const float u, const float v) final;
         void end() final;
 
+		/**
+		Draw a batch of world space vertices with the navigation debug pipelines, using the model matrix of the current
+		debug renderable. Faster than a begin / vertex / end sequence for large amounts of geometry.
+		*/
+		void DrawDebugVertices(duDebugDrawPrimitives prim, std::span<const VertexColorUV> vertices);
+		void CreateNavDebugPipelines();
+
 		void DebugRender(const Im3d::DrawList&);
+
+		/**
+		Draw the shapes and lines recorded in a DebugDrawer, culling shapes outside the view, then clear them.
+		*/
+		void DrawDebugShapes(DebugDrawer& drawer, const glm::mat4& viewProj);
         
 		size_t GetCurrentVRAMUse();
+
+		/**
+		@return the most transient data written in any one frame so far, in bytes
+		*/
+		auto GetTransientHighWaterMark() const {
+			return transientHighWaterMark;
+		}
         
 		size_t GetTotalVRAM();
 
@@ -313,42 +559,397 @@ namespace RavEngine {
 		ConcurrentQueue<RGLTexturePtr> gcTextures;
 		ConcurrentQueue<RGLPipelineLayoutPtr> gcPipelineLayout;
 		ConcurrentQueue<RGLRenderPipelinePtr> gcRenderPipeline;
+		ConcurrentQueue<std::pair<uint16_t, ParticlePool::Slot>> gcParticleSlots;	// by particle size, released on the render thread
+		ConcurrentQueue<std::pair<OffsetAllocator::node_t, OffsetAllocator::node_t>> gcGUIGeometry;	// compiled GUI vertices and indices
+		ConcurrentQueue<OffsetAllocator::node_t> gcSkinnedOutput;	// regions of destroyed skinned commands, see skinnedOutputAllocator
 
 		MeshRange AllocateMesh(const MeshPartView& mesh);
 
 		void DeallocateMesh(const MeshRange& range);
 
+		/**
+		Move every mesh in the shared vertex and index buffers to the front, removing the holes left by unloaded meshes.
+		Meshes are relocated with GPU copies. Invalidates any cached offsets into the shared buffers, see GetMeshAllocationGeneration.
+		*/
+		void CompactMeshAllocations();
+
+		/**
+		@return a counter that changes whenever meshes move in the shared vertex and index buffers
+		*/
+		auto GetMeshAllocationGeneration() const {
+			return meshAllocationGeneration;
+		}
+
+		/**
+		If nonzero, meshes are compacted at the start of a frame when the fraction of free space in the shared buffers that is
+		outside the largest free region exceeds this value. For example, 0.5 compacts once half of the free space is in holes.
+		*/
+		float meshCompactionThreshold = 0;
+
+		/**
+		If false, every render target collection allocates its own transient targets instead of sharing them with collections of the same size
+		*/
+		bool shareTransientRenderTargets = true;
+
+		/**
+		If true, the lit opaque depth prepass is culled in two phases. Objects visible last frame are drawn first and the depth pyramid is rebuilt
+		from them. Then everything else is tested against that pyramid. If false, the prepass is culled once against last frame's pyramid.
+		*/
+		bool twoPhaseOcclusionCulling = true;
+
+		/**
+		If true, spot and point light shadow maps keep their static casters (entities with a static Transform) in a cached layer.
+		Each frame the cached layer is copied into the shadow map and only dynamic casters are drawn on top. The cached layer is
+		re-rendered when the light's view changes or when a static caster is moved, added, removed, or changes static-ness.
+		The cached layers live in a second atlas the size of the shadow atlas.
+		*/
+		bool cacheStaticShadows = true;
+
+		/**
+		Spot lights and the faces of point lights render their shadows into tiles of one shared atlas. Each frame, a shadowed light gets a
+		tile sized to how large its area of influence appears in the largest view that can see it, up to the max tile size of its type.
+		Lights that no view can see get no tile. When the atlas is full, the lights that appear smallest get smaller tiles, or none.
+		*/
+		constexpr static uint16_t shadowAtlasSize = 4096, shadowAtlasMinTileSize = 64, maxSpotShadowTileSize = 2048, maxPointShadowTileSize = 1024;
+
+		/**
+		Force every cached static shadow layer to be re-rendered on the next frame. Call this after changes the engine does not track,
+		such as swapping the mesh or material of a static caster.
+		*/
+		void InvalidateCachedShadows() {
+			shadowCacheInvalidations++;
+		}
+
+		/**
+		Time every render debug marker (shadowmaps, SSGI, post processing, ...) on the GPU. Results arrive one frame late,
+		and are also sent to Tracy as GPU zones in profiling builds. Has no effect on backends without timestamp support.
+		*/
+		void SetGPUPassTimingsEnabled(bool enabled);
+
+		bool GetGPUPassTimingsEnabled() const {
+			return gpuPassTimingsRequested;
+		}
+
+		/**
+		@return the GPU time of each marked pass in the most recently completed frame, in the order the passes began
+		*/
+		std::span<const RGL::TimestampRegion> GetGPUPassTimings() const;
+
+		/**
+		Count the draws and dispatches encoded under every render debug marker, for GetCommandCounts.
+		*/
+		void SetCommandCountsEnabled(bool enabled);
+
+		/**
+		@return the draws and dispatches of each marked pass of the frame encoded last, in the order the passes began
+		*/
+		std::span<const RGL::CommandCountRegion> GetCommandCounts() const;
+
+		struct FrameTimings {
+			float renderSyncMs = 0;		// waiting in Draw for the GPU to finish the frame that last used the command buffer
+			float encodeMs = 0;			// the rest of Draw
+			float gpuMs = 0;			// the previous frame on the GPU, from its first marked pass to its last. 0 without GPU pass timings
+		};
+
+		/**
+		@return where the last call to Draw spent its time
+		*/
+		const FrameTimings& GetLastFrameTimings() const {
+			return lastFrameTimings;
+		}
+
+		/**
+		Render the scene of every view into the top left of its targets, at a fraction of the output resolution picked each frame
+		from the GPU time of the previous frames, and scale it up in the tonemap pass. The GUI and debug overlays stay at the output
+		resolution. This turns on GPU pass timings, which it reads the frame time from, so it has no effect on backends without
+		timestamp support.
+		*/
+		void SetDynamicResolutionEnabled(bool enabled);
+
+		void SetDynamicResolutionConfig(const DynamicResolutionController::Config& config) {
+			dynamicResolution.SetConfig(config);
+		}
+
+		/**
+		@return the fraction of the output width and height the scene is rendered at
+		*/
+		float GetRenderScale() const {
+			return renderScale;
+		}
+
+		/**
+		@return the size in pixels of the tiles lit materials can be shaded at a reduced rate in, or 0 if the device does not support it and FoveationSettings have no effect
+		*/
+		uint32_t GetShadingRateTileSize() const {
+			return shadingRateTileSize;
+		}
+
+		/**
+		If true, the engine steps through VRAMPressureLevels to stay within the VRAM budget the OS grants it. Devices that do not
+		report a budget are never under pressure.
+		*/
+		bool vramBudgetEnabled = true;
+
+		void SetVRAMBudgetConfig(const VRAMBudgetController::Config& config) {
+			vramBudget.SetConfig(config);
+		}
+
+		VRAMPressureLevel GetVRAMPressureLevel() const {
+			return vramBudget.GetLevel();
+		}
+
+		/**
+		@return false if cameras that render to a RenderTexture should be skipped to save VRAM, see VRAMPressureLevel::RenderTextureCameras
+		*/
+		bool ShouldRenderTextureCameras() const {
+			return !vramBudget.IsAtLeast(VRAMPressureLevel::RenderTextureCameras);
+		}
+
+		// VRAM in bytes, updated at the start of each Draw
+		struct VRAMResidency {
+			uint64_t usage = 0, budget = 0;		// as the device reports them. The budget is 0 if the device does not report one
+			uint64_t streamingTextures = 0;		// granted to StreamingTextures
+			uint64_t shadowMaps = 0;			// directional cascades, the shadow atlas and its static layer
+			uint64_t meshes = 0;				// the shared vertex and index buffers
+			uint64_t buffers = 0;				// the private buffers of BufferedVRAMVectors and BufferedVRAMSparseSets
+		};
+
+		const VRAMResidency& GetVRAMResidency() const {
+			return vramResidency;
+		}
+
+		/**
+		@return the streamer that decides which mips of each StreamingTexture are resident
+		*/
+		TextureStreamer& GetTextureStreamer() {
+			return textureStreamer;
+		}
+
+		/**
+		@return the loader that decodes and uploads every AsyncTexture
+		*/
+		AsyncTextureLoader& GetAsyncTextureLoader() {
+			return asyncTextureLoader;
+		}
+
+    private:
+		std::filesystem::path pipelineCachePath;	// empty if the pipeline cache is not persisted
+		void LoadPipelineCache();
+		void SavePipelineCache();
+
+		void ReportGPUPassTimings();
+		bool gpuPassTimingsRequested = false;
+
+		FrameTimings lastFrameTimings;
+
+		DynamicResolutionController dynamicResolution;
+		bool dynamicResolutionEnabled = false;
+		float renderScale = 1;
+		void UpdateRenderScale();
+
+		VRAMBudgetController vramBudget;
+		VRAMResidency vramResidency;
+		uint64_t textureLimitFrame = 0;		// when the streaming textures last gave up memory
+		void UpdateVRAMBudget(World* world);
+
+		// halves shadow map sizes under VRAMPressureLevel::ShadowResolution
+		uint8_t ShadowResolutionShift() const {
+			return vramBudget.IsAtLeast(VRAMPressureLevel::ShadowResolution) ? 1 : 0;
+		}
+
+		TextureStreamer textureStreamer;
+		AsyncTextureLoader asyncTextureLoader;
+		uint16_t nextGPUZoneQueryId = 0;
+		uint8_t gpuZoneContext = 0;
+		bool gpuZoneContextCreated = false;
+
+		uint64_t shadowCacheInvalidations = 0;
+		uint64_t StaticShadowCastersKey(const World* world) const;
+
+		// false if a camera cannot draw anything transparent, so its view can skip clearing, accumulating and applying the transparency
+		bool CameraHasTransparency(World* world, renderlayer_t layers, const glm::mat4& viewProj) const;
+
+		// a spot light or one face of a point light in the shadow atlas
+		struct ShadowAtlasEntry {
+			ShadowAtlasAllocator::Tile tile;
+			uint64_t lastUsedFrame = 0;
+			// the static layer of the tile in shadowAtlasStaticTexture, see cacheStaticShadows
+			glm::mat4 staticViewProj{ 0 };
+			uint64_t staticCastersKey = 0;		// 0 if the static layer must be re-rendered
+			renderlayer_t staticLayers = 0;
+		};
+		UnorderedMap<uint64_t, ShadowAtlasEntry> shadowAtlasEntries;	// see ShadowAtlasKey
+		ShadowAtlasAllocator shadowAtlasAllocator{ shadowAtlasSize, shadowAtlasMinTileSize };
+		RGLTexturePtr shadowAtlasTexture, shadowAtlasStaticTexture;
+		DepthPyramid shadowPlaceholderPyramid;	// bound when culling shadow views, which are not occlusion culled
+
+		constexpr static uint8_t spotLightAtlasFace = 6;
+		static uint64_t ShadowAtlasKey(entity_id_t light, uint8_t face) {
+			return (uint64_t(light) << 3) | face;
+		}
+
+		/**
+		Size and place the shadow atlas tiles of the world's shadowed spot and point lights, and write the tiles into their upload data.
+		Must run before the light data is synced.
+		*/
+		void UpdateShadowAtlas(World* world, std::span<const RenderViewCollection> screenTargets);
+    public:
+
     protected:
 		dim_t<int> currentRenderSize;
 		matrix4 make_gui_matrix(Rml::Vector2f translation);
 
-		constexpr static uint32_t transientSizeBytes = 65536;
-		RGLBufferPtr transientBuffer, transientStagingBuffer;
-		uint32_t transientOffset = 0;
+		// per-frame constants are linearly allocated from chained blocks, with one arena per frame in flight
+		constexpr static uint32_t transientBlockSizeBytes = 65536, transientFramesInFlight = 2;
+		struct TransientAllocation {
+			RGLBufferPtr buffer;
+			uint32_t offset = 0;
+		};
+		struct TransientBlock {
+			RGLBufferPtr buffer, stagingBuffer;
+			uint32_t size = 0, offset = 0;
+		};
+		struct TransientArena {
+			Vector<TransientBlock> blocks;
+			uint32_t currentBlock = 0, bytesUsed = 0;
+		};
+		std::array<TransientArena, transientFramesInFlight> transientArenas;
+		uint32_t transientHighWaterMark = 0;
+
+		TransientArena& CurrentTransientArena() {
+			return transientArenas[frameCount % transientFramesInFlight];
+		}
 		
 		/**
-		* Add data to the transient buffer.
-		* The transient buffer is reset every frame. 
-		* @return the offset in bytes to the transient buffer
+		* Add data to the current frame's transient arena, adding a block if it does not fit.
+		* The arena is reset when its frame comes around again.
+		* @param alignment the alignment of the returned offset, must be a power of 2
+		* @return the buffer the data is in, and the offset in bytes to it
+		*/
+		TransientAllocation WriteTransient(RGL::untyped_span data, uint32_t alignment = 16);
+
+		/**
+		* Encode the copies from the current arena's staging blocks to the blocks the shaders read.
+		* @return true if anything was written this frame
+		*/
+		bool EncodeTransientSync(RGLCommandBufferPtr commandBuffer);
+
+		// debug vertices are copied into persistently mapped buffers, one per frame in flight, which grow when a frame needs more.
+		// The stride of the buffer is the vertex size, so each vertex format has its own arena.
+		constexpr static uint32_t debugVertexFramesInFlight = 3;
+		struct DebugVertexArena {
+			struct Frame {
+				RGLBufferPtr buffer;
+				uint32_t capacity = 0, used = 0;	// in vertices
+			};
+			std::array<Frame, debugVertexFramesInFlight> frames;
+			uint32_t stride = 0;
+			const char* debugName = nullptr;
+		};
+		DebugVertexArena im3dDebugVertices, navDebugVertices, debugShapeInstances;
+
+		// line list outlines of the DebugDrawer unit shapes, one after another in one buffer
+		RGLBufferPtr debugShapeVertices;
+		struct DebugShapeRange {
+			uint32_t firstVertex = 0, nVertices = 0;
+			float boundingRadius = 0;	// around the origin, for culling instances
+		};
+		std::array<DebugShapeRange, DebugDrawer::UnitShapeCount> debugShapeRanges;
+		RGLRenderPipelinePtr debugShapeRenderPipeline;
+		Vector<DebugDrawer::ShapeInstance> visibleDebugShapes;
+
+		/**
+		* Copy vertices into this frame's buffer of a debug arena
+		* @return the buffer, and the offset to bind it at in vertices
 		*/
-		uint32_t WriteTransient(RGL::untyped_span data);
+		TransientAllocation WriteDebugVertices(DebugVertexArena& arena, RGL::untyped_span vertices);
 
-		allocation_freelist_t vertexFreeList{ 1, Range{.start = 0, .count = initialVerts}};
-		allocation_freelist_t indexFreeList{ 1, Range{.start = 0, .count = initialIndices}};
+		OffsetAllocator vertexAllocator{ initialVerts }, indexAllocator{ initialIndices };
 		allocation_allocatedlist_t vertexAllocatedList, indexAllocatedList;
 		uint32_t currentVertexSize = initialVerts, currentIndexSize = initialIndices;
+		uint32_t meshAllocationGeneration = 0;
+
+		// the transient targets of live collections, by size. Entries expire with the last collection using them.
+		struct TransientTargetSet {
+			using weak_texture_t = std::weak_ptr<RGLTexturePtr::element_type>;
+			weak_texture_t lightingTexture, lightingScratchTexture, radianceTexture, viewSpaceNormalsTexture, ssgiOutputTexture, mlabDepth;
+			std::array<weak_texture_t, 4> mlabAccum;
+		};
+		UnorderedMap<uint64_t, TransientTargetSet> transientTargetPool;
+
+		// mesh data waiting to be copied from the staging ring into the shared buffers, in the order its space was reserved
+		constexpr static uint32_t meshStagingSizeBytes = 1 << 23, nMeshStreams = 7;
+		struct PendingMeshUpload {
+			MeshRange range;
+			uint32_t stagingOffset = 0;
+			std::array<uint32_t, nMeshStreams> streamOffsets{}, streamSizes{};	// position, normal, tangent, bitangent, uv0, lightmap uv, index
+			enum class State : uint8_t {
+				Writing,	// a loader thread is still copying into the ring
+				Ready,
+				Encoded,	// in the upload command buffer
+				Done
+			} state = State::Writing;
+			bool cancelled = false;
+		};
+		std::deque<PendingMeshUpload> pendingMeshUploads;
+		uint64_t pendingMeshUploadsFrontSeq = 0;
+		uint32_t meshStagingHead = 0, meshStagingTail = 0;
+		RGLBufferPtr meshStagingBuffer;
+		bool meshUploadSubmitted = false;
+
+		bool ReserveMeshStaging(uint32_t size, uint32_t& offset);
+		
+		/**
+		* Encode the copies for every staged mesh and submit them ahead of the frame. Called by the render thread.
+		*/
+		void FlushMeshUploads();
 		
 		void ReallocateVertexAllocationToSize(uint32_t newSize);
 		void ReallocateIndexAllocationToSize(uint32_t newSize);
-		void ReallocateGeneric(RGLBufferPtr& reallocBuffer, uint32_t& reallocBufferSize, uint32_t newSize, allocation_allocatedlist_t& allocatedList, allocation_freelist_t& freelist, uint32_t stride, RGL::BufferConfig::Type bufferType, decltype(frameCount)& lastResizeFrame, const char* debugName = nullptr);
+		void ReallocateGeneric(RGLBufferPtr& reallocBuffer, uint32_t oldSize, uint32_t newSize, uint32_t stride, RGL::BufferConfig::Type bufferType, decltype(frameCount)& lastResizeFrame, const char* debugName = nullptr);
+		void CompactMeshAllocationsIfFragmented();
 
 		SpinLock allocationLock;
 
-		void DestroyUnusedResources();
+		// resources collected from the gc queues, held until the GPU has finished every frame that could use them
+		struct RetiredResources {
+			Vector<RGLBufferPtr> buffers;
+			Vector<RGLTexturePtr> textures;
+			Vector<RGLPipelineLayoutPtr> pipelineLayouts;
+			Vector<RGLRenderPipelinePtr> renderPipelines;
+
+			void clear() {
+				buffers.clear();
+				textures.clear();
+				pipelineLayouts.clear();
+				renderPipelines.clear();
+			}
+		};
+		constexpr static uint32_t gcFramesInFlight = 3;
+		std::array<RetiredResources, gcFramesInFlight> retiredResources;
+		Vector<std::pair<OffsetAllocator::node_t, OffsetAllocator::node_t>> releasedGUIGeometry;
+
+		/**
+		Release resources retired gcFramesInFlight frames ago, and retire the ones in the gc queues
+		@param releaseAll release everything, for when the GPU is idle
+		*/
+		void DestroyUnusedResources(bool releaseAll = false);
         static RavEngine::Vector<VertexColorUV> navMeshPolygon;
+		duDebugDrawPrimitives navMeshPrimitive = DU_DRAW_TRIS;
         bool navDebugDepthEnabled = false; 
 
     public:
+		/**
+		* Record the GUI draws made until EndGUIDrawList into list, replacing what it held. Internal use only.
+		*/
+		void BeginGUIDrawList(GUIDrawList& list);
+		void EndGUIDrawList();
+
+		/**
+		* Submit a recorded GUI draw list again. Internal use only.
+		* @return false if the list is empty or refers to resources RmlUi has since released, in which case the GUI must be rendered again
+		*/
+		bool ReplayGUIDrawList(GUIDrawList& list);
 
     protected:
 		
@@ -359,7 +960,49 @@ namespace RavEngine {
         struct scissor{
             uint16_t x, y, width, height;
             bool enabled = false;
+
+            bool operator==(const scissor& other) const {
+                return enabled == other.enabled && (!enabled || (x == other.x && y == other.y && width == other.width && height == other.height));
+            }
         } RMLScissor;
+
+		// geometry RmlUi does not compile is written to host-visible buffers, one pair per frame in flight, and reset each frame
+		struct GUIFrameGeometry {
+			RGLBufferPtr vertexBuffer, indexBuffer;
+			uint32_t vertexCapacity = 0, indexCapacity = 0, nVertices = 0, nIndices = 0;
+		};
+		std::array<GUIFrameGeometry, transientFramesInFlight> guiFrameGeometry;
+
+		// consecutive uncompiled draws with the same texture and scissor, drawn together by FlushGUIBatch.
+		// Their vertices are translated on the CPU, so the batch draws with an untranslated matrix.
+		struct GUIBatch {
+			Rml::TextureHandle texture = 0;
+			scissor scissorRect;
+			uint32_t firstVertex = 0, firstIndex = 0, nIndices = 0;
+		} guiBatch;
+
+		/**
+		* Draw the pending GUI batch, if any. Called before anything else is drawn into the GUI, and after the last GUI is rendered.
+		*/
+		void FlushGUIBatch();
+
+		// while a GUI context renders, its draws are also recorded here so that unchanged frames can replay them
+		GUIDrawList* guiRecording = nullptr;
+		// bumped whenever RmlUi releases a texture or compiled geometry, which a recorded draw list may refer to
+		uint64_t guiResourceGeneration = 0;
+
+		// compiled geometry is suballocated from a shared vertex buffer and a shared index buffer
+		struct GUIGeometryPool {
+			RGLBufferPtr buffer;
+			OffsetAllocator allocator;
+			uint32_t capacity = 0;
+		} guiCompiledVertices, guiCompiledIndices;
+
+		/**
+		* Copy data into a compiled geometry pool, growing it if it is full
+		* @return the allocation, in units of stride
+		*/
+		OffsetAllocator::Allocation WriteGUIGeometry(GUIGeometryPool& pool, RGL::untyped_span data, uint32_t stride, RGL::BufferConfig::Type bufferType, const char* debugName);
 	
     };
 }
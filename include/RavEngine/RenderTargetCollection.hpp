@@ -6,9 +6,11 @@
 #include "DepthPyramid.hpp"
 #include "Vector.hpp"
 #include "Layer.hpp"
+#include <memory>
 
 namespace RavEngine{
     class RenderTexture;
+    class GUIComponent;
     struct PostProcessEffectStack;
 
 	struct ViewportOverride {
@@ -16,14 +18,50 @@ namespace RavEngine{
 		glm::vec2 sizeFactor {1, 1};
 	};
 
+	// what two-phase occlusion culling remembers about a collection between frames
+	struct OcclusionCullingHistory {
+		RGLBufferPtr visibilityBuffer;		// one word per entity, see defaultcull.csh
+		Vector<glm::mat4> viewProjs;		// the matrix each camera of the view used last frame
+		float depthRenderScale = 1;			// the render scale the depth texture was last drawn at, see RenderEngine::GetRenderScale
+	};
+
+	// what temporally accumulated SSAO and SSGI remember about a collection between frames, see IndirectLightingResolution
+	struct IndirectLightingHistory {
+		struct View {
+			std::array<RGLTexturePtr, 2> color, depth;	// ping-ponged, at the traced resolution. depth is the linear view depth
+			glm::mat4 viewOnly, projOnly;
+			glm::vec2 uvScale{ 1, 1 };	// the part of the textures the scene was traced into
+			uint64_t lastFrame = 0;		// the frame the history was last written, older histories are discarded
+			uint8_t current = 0;		// the texture written last
+		};
+		Vector<View> views;		// one per camera of the view
+	};
+
+	// what temporal upscaling remembers about a collection between frames, see RenderEngine::VideoSettings::temporalUpscaling
+	struct TemporalUpscalingHistory {
+		struct View {
+			glm::mat4 viewProj;		// without the jitter
+			uint64_t lastFrame = 0;	// the frame the history was last written, older histories are discarded
+		};
+		std::array<RGLTexturePtr, 2> color;	// ping-ponged, at the output resolution. Each camera owns its viewport of them
+		Vector<View> views;		// one per camera of the view
+		uint8_t current = 0;	// the texture written last
+	};
+
 	struct RenderTargetCollection {
 		RGLTexturePtr depthStencil, lightingTexture, lightingScratchTexture, mlabDepth, radianceTexture, viewSpaceNormalsTexture, ssgiOutputTexture;
+		RGLTexturePtr entityIDTexture;		// written by the depth prepasses, the entity of each pixel plus 1, or 0 where no object with a transform was drawn
+		constexpr static auto entityIDFormat = RGL::TextureFormat::R32_Uint;
         
         std::array<RGLTexturePtr, 4> mlabAccum;
         constexpr static std::array<RGL::TextureFormat, 4> formats = {RGL::TextureFormat::RGBA16_Sfloat, RGL::TextureFormat::RGBA8_Unorm, RGL::TextureFormat::RGBA8_Unorm, RGL::TextureFormat::RGBA8_Unorm};
         constexpr static auto mlabDepthFormat = RGL::TextureFormat::RGBA16_Sfloat;
 		RGL::ITexture* finalFramebuffer = nullptr;
 		DepthPyramid depthPyramid;
+		std::shared_ptr<OcclusionCullingHistory> occlusionHistory;	// shared, because collections are copied into the views every frame
+		std::shared_ptr<IndirectLightingHistory> indirectLightingHistory;
+		std::shared_ptr<TemporalUpscalingHistory> temporalUpscalingHistory;
+		RGLTexturePtr shadingRateTexture;	// one texel per shading rate tile, written each frame from the cameras' FoveationSettings. Null if the device cannot vary the shading rate
 	};
 
 	struct RenderViewCollection {
@@ -41,9 +79,14 @@ namespace RavEngine{
             const PostProcessEffectStack* postProcessingEffects = nullptr;
 			const void* tonemap = nullptr;	// because we can't forward declare 'using's 
 			IndirectLightingSettings indirectSettings;
+			CameraFeatureSettings features;
+			FoveationSettings foveation;
+			glm::vec2 jitter{ 0, 0 };	// the sub-pixel offset of the projection this frame, in pixels of the render area. Set by the renderer
 		};
 		Vector<camData> camDatas;
 		dim_t<int> pixelDimensions;
+		bool stereo = false;	// camDatas are the left and right eye of one viewer, side by side in the target. The eyes are culled together and share shadows.
+		GUIComponent* overlay = nullptr;	// drawn over the view's GUIs, such as the performance overlay. Updated by its owner before Draw
 	};
 }
 #endif
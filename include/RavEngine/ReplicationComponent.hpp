@@ -0,0 +1,98 @@
+#pragma once
+#include "ComponentWithOwner.hpp"
+#include "Queryable.hpp"
+#include "Function.hpp"
+#include "Vector.hpp"
+#include "Debug.hpp"
+#include "ReplicationSnapshot.hpp"
+#include <cstring>
+#include <type_traits>
+#include <limits>
+
+namespace RavEngine {
+
+	/**
+	 Fields of an entity with a NetworkIdentity that the server sends to clients every tick. Only the fields that changed since the
+	 last snapshot a client acknowledged are sent. Declare the same fields in the same order on the server and on clients,
+	 usually in the entity's constructor. Clients do not apply fields to entities they own.
+	 */
+	class ReplicationComponent : public ComponentWithOwner, public Queryable<ReplicationComponent> {
+		struct Field {
+			Function<void(uint8_t*)> read;
+			Function<void(const uint8_t*)> write;
+			uint16_t size;
+		};
+		Vector<Field> fields;
+		uint32_t appliedSequence = 0;		// the snapshot last applied to this entity
+
+	public:
+		ReplicationComponent(Entity owner) : ComponentWithOwner(owner) {}
+
+		MOVE_NO_COPY(ReplicationComponent);
+
+		/**
+		 Declare a replicated field
+		 @param get invoked on the server to read the value
+		 @param set invoked on clients with a new value
+		 */
+		template<typename T>
+		void ReplicateField(const Function<T()>& get, const Function<void(const T&)>& set) {
+			static_assert(std::is_trivially_copyable_v<T>, "Replicated fields must be trivially copyable");
+			static_assert(sizeof(T) <= std::numeric_limits<uint16_t>::max(), "Replicated field is too large");
+			Debug::Assert(fields.size() < ReplicationSnapshot::maxFields, "An entity can replicate at most {} fields", ReplicationSnapshot::maxFields);
+			fields.push_back({
+				.read = [get](uint8_t* dst) {
+					const T value = get();
+					std::memcpy(dst, &value, sizeof(value));
+				},
+				.write = [set](const uint8_t* src) {
+					T value;
+					std::memcpy(&value, src, sizeof(value));
+					set(value);
+				},
+				.size = uint16_t(sizeof(T))
+			});
+		}
+
+		/**
+		 Record the fields into a snapshot. Invoked automatically on the server.
+		 */
+		void Capture(ReplicationSnapshot& snapshot, netid_t id) const {
+			snapshot.BeginEntity(id);
+			for (const auto& field : fields) {
+				field.read(snapshot.AddField(field.size));
+			}
+		}
+
+		/**
+		 Set the fields that differ from the previous snapshot. Invoked automatically on clients.
+		 @param previousSnapshot the snapshot applied before this one, or nullptr. Every field is set if it was not applied to this entity.
+		 */
+		void Apply(const ReplicationSnapshot& snapshot, const ReplicationSnapshot::Entity& entity, const ReplicationSnapshot* previousSnapshot) {
+			const ReplicationSnapshot::Entity* previous = nullptr;
+			if (previousSnapshot && previousSnapshot->sequence == appliedSequence) {
+				previous = previousSnapshot->Find(entity.id);
+			}
+			appliedSequence = snapshot.sequence;
+
+			if (entity.nFields != fields.size()) {
+				Debug::Warning("Replicated entity has {} fields but {} are declared here", entity.nFields, fields.size());
+				return;
+			}
+			for (uint8_t i = 0; i < entity.nFields; i++) {
+				auto value = snapshot.GetField(entity, i);
+				if (value.size() != fields[i].size) {
+					Debug::Warning("Replicated field {} has {} bytes but {} are declared here", i, value.size(), fields[i].size);
+					return;
+				}
+				if (previous && previous->nFields == entity.nFields) {
+					auto old = previousSnapshot->GetField(*previous, i);
+					if (old.size() == value.size() && std::memcmp(old.data(), value.data(), value.size()) == 0) {
+						continue;
+					}
+				}
+				fields[i].write(value.data());
+			}
+		}
+	};
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "NetworkIDTable.hpp"
+#include "Vector.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace RavEngine {
+
+	/**
+	 The replicated fields of every networked entity at one server tick. Snapshots are sent as deltas against an earlier snapshot
+	 that the receiver already has, so unchanged entities and fields cost nothing.
+	 */
+	class ReplicationSnapshot {
+	public:
+		constexpr static uint8_t maxFields = 32;		// one bit per field in the change mask
+
+		struct Entity {
+			netid_t id;
+			uint32_t fieldBegin = 0;	// into fieldSizes
+			uint32_t dataBegin = 0;		// into data
+			uint8_t nFields = 0;
+		};
+
+		uint32_t sequence = 0;		// 0 is never sent, so it means no baseline
+
+		/**
+		 Begin recording an entity. Its fields follow, in the order they are declared.
+		 */
+		void BeginEntity(netid_t id);
+
+		/**
+		 Record a field of the last entity
+		 @return where to write the size bytes of the field
+		 */
+		uint8_t* AddField(uint16_t size);
+
+		/**
+		 Sort the entities, once all are recorded. Encode and Decode expect this.
+		 */
+		void Finalize();
+
+		/**
+		 Forget the entities, keeping the memory for the next tick
+		 */
+		void Clear();
+
+		/**
+		 @return the entity with the id, or nullptr
+		 */
+		const Entity* Find(netid_t id) const;
+
+		std::span<const uint8_t> GetField(const Entity& entity, uint8_t field) const;
+
+		const auto& GetEntities() const {
+			return entities;
+		}
+
+		/**
+		 Append the delta from baseline to this snapshot
+		 @param baseline a snapshot the receiver has, or nullptr to send every entity in full
+		 @param subset if set, only these entities are sent, as ascending indices into GetEntities
+		 @param baselineSubset if set, the entities of the baseline that the receiver was sent
+		 */
+		void Encode(const ReplicationSnapshot* baseline, std::string& out, const Vector<uint32_t>* subset = nullptr, const Vector<uint32_t>* baselineSubset = nullptr) const;
+
+		/**
+		 Rebuild a snapshot from a delta made by Encode
+		 @param baseline the snapshot the delta was made against, or nullptr if it was sent in full
+		 @return false if the delta is malformed
+		 */
+		bool Decode(std::string_view in, const ReplicationSnapshot* baseline);
+
+	private:
+		Vector<Entity> entities;
+		Vector<uint16_t> fieldSizes;
+		Vector<uint8_t> data;
+
+		// copy an entity of another snapshot
+		void CopyEntity(const ReplicationSnapshot& other, const Entity& entity);
+		bool SameLayout(const Entity& entity, const ReplicationSnapshot& other, const Entity& otherEntity) const;
+	};
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <ozz/animation/runtime/sampling_job.h>
+#include <memory>
+
+namespace RavEngine {
+
+	/**
+	 Sampling contexts shared by every animator. A context is only needed while its animation plays, so layers and blend tree
+	 nodes hold one while they are evaluated and hand it back when they stop, for another to reuse. Contexts are pooled by
+	 the number of joints they support, so skeletons of the same size share them. Thread safe.
+	 */
+	struct SamplingContextPool {
+		struct Release {
+			void operator()(ozz::animation::SamplingJob::Context* context) const;
+		};
+		using Handle = std::unique_ptr<ozz::animation::SamplingJob::Context, Release>;
+
+		/**
+		 @return a context for at least this many joints, reused if one is free. It returns to the pool when the handle is destroyed.
+		 */
+		static Handle Acquire(int numJoints);
+
+		/**
+		 Free the contexts that are not in use
+		 */
+		static void Trim();
+	};
+}
@@ -24,6 +24,13 @@ enum class PostProcessOutput : uint8_t{
     UserDefined
 };
 
+// the built-in effects that RenderEngine::VideoSettings::fusedPostProcessing can apply in one compute pass
+enum class FusedScreenEffect : uint8_t{
+    None,           // rendered as its own passes
+    BloomApply,     // the last pass, which merges the bloom into the color. The mip chain is still rendered as its own passes
+    FXAA
+};
+
 constexpr static uint8_t nPostProcessTextureInputs = 8;
 constexpr static uint8_t nPostProcessSamplerInputs = nPostProcessTextureInputs + 1;
 
@@ -92,6 +99,7 @@ template<typename T>
 struct ScreenEffect{
     Vector<Ref<T>> passes;
     bool enabled = true;
+    FusedScreenEffect fusedStep = FusedScreenEffect::None;
     virtual void Preamble(dim_t<int> targetSize){}
 };
 
@@ -2,10 +2,48 @@
 #include "Queryable.hpp"
 #include "Types.hpp"
 #include "ComponentWithOwner.hpp"
+#include "Vector.hpp"
+#include <optional>
+#include <type_traits>
 
 namespace RavEngine {
 	class World;
 	struct Transform;
+
+	/**
+	The component types a script's Tick reads and writes, on any entity including its own.
+	*/
+	struct ScriptAccess {
+		Vector<ctti_t> reads, writes;
+
+		// true if Tick only writes components of its own entity (for example, it only moves its own Transform),
+		// so that instances of the same script type may tick in parallel with each other
+		bool instancesIndependent = false;
+
+		/**
+		Build an access declaration from component types. As with system parameters, const types are read and the others are written.
+		*/
+		template<typename ... A>
+		static ScriptAccess Of(bool instancesIndependent = false) {
+			ScriptAccess access;
+			access.instancesIndependent = instancesIndependent;
+			([&] {
+				if constexpr (std::is_const_v<A>) {
+					access.reads.push_back(CTTI<std::remove_const_t<A>>());
+				}
+				else {
+					access.writes.push_back(CTTI<A>());
+				}
+			}(), ...);
+			return access;
+		}
+
+		/**
+		@return true if scripts with these two declarations cannot tick at the same time
+		*/
+		bool ConflictsWith(const ScriptAccess& other) const;
+	};
+
 	/**
 	Define an Entity-side Script which can contain code. Subclass to add behavior. Be sure to invoke the base class constructor!
 	*/
@@ -30,11 +68,23 @@ namespace RavEngine {
 		virtual void Stop() {}
 
 		/**
-		Invoked as the last step of the systems execution on a background thread. Any cross-object access must be appropriately protected.
+		Invoked as the last step of the systems execution on a background thread. Scripts are ticked grouped by type.
+		Scripts that do not declare their access in GetAccess tick one at a time. Scripts that do may tick at the same time as
+		scripts of other types with non-conflicting access, so any access beyond what was declared must be appropriately protected.
+		Record structural changes, such as spawning entities or adding components, with World::GetCommandBuffer.
 		@param fpsScale the frame rate scalar for this frame.
 		*/
 		virtual void Tick(float fpsScale) = 0;
 
+		/**
+		Override to declare the components this script's Tick reads and writes, so that it can tick in parallel with other scripts.
+		Queried once per script type, so every instance of a type must return the same declaration.
+		@return the access declaration, or nullopt if the script may touch anything
+		*/
+		virtual std::optional<ScriptAccess> GetAccess() const {
+			return std::nullopt;
+		}
+
 		/**
 		Shortcut to get the transform component of the attached entity
 		@throws if the script is not attached to any entity.
@@ -2,10 +2,25 @@
 
 #include "ScriptComponent.hpp"
 #include "CTTI.hpp"
+#include "Map.hpp"
+#include <typeindex>
 
 namespace RavEngine {
+	/**
+	Ticks every ScriptComponent. Scripts are gathered by concrete type, then each type is ticked as a batch, so consecutive
+	Tick calls dispatch to the same function. Batches whose declared access does not conflict run in parallel.
+	*/
 	class ScriptSystem : public AutoCTTI {
+		struct Batch {
+			Vector<ScriptComponent*> scripts;
+			std::optional<ScriptAccess> access;
+		};
+		// kept between ticks, so that a type's access is only queried once and its batch keeps its capacity
+		Vector<Batch> batches;
+		UnorderedMap<std::type_index, uint32_t> batchForType;
+		Vector<Vector<uint32_t>> waves;
 	public:
-         void operator()(ScriptComponent& c) const;
+		void operator()(ScriptComponent& c);
+		void after(World* world);
 	};
 }
@@ -0,0 +1,17 @@
+#pragma once
+#include "Array.hpp"
+#include <cstdint>
+
+namespace RavEngine {
+	/**
+	 Prefixes sounds compiled by rveauc. The samples follow it as 32-bit floats, one channel after another.
+	 */
+	struct SerializedAudioDataHeader {
+		Array<char, 4> header = { 'r','v','a','u' };
+		uint32_t sampleRate = 0;
+		uint32_t numSamples = 0;		// per channel
+		uint8_t nchannels = 0;
+		uint8_t pad[7]{};
+		double lengthSeconds = 0;
+	};
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "Vector.hpp"
+#include <cstdint>
+
+namespace RavEngine {
+    /**
+     A quadtree allocator for the square tiles of a shadow atlas. It does not own any memory, it only decides where tiles go.
+     Tile sizes are powers of two. Each node of the tree is free, split into four children, or allocated. A freed tile
+     merges with its siblings once all four are free, so mixing tile sizes does not fragment the atlas over time.
+     */
+    class ShadowAtlasAllocator {
+    public:
+        struct Tile {
+            uint16_t x = 0, y = 0, size = 0;   // in texels
+
+            bool IsValid() const {
+                return size != 0;
+            }
+            bool operator==(const Tile&) const = default;
+        };
+
+        /**
+         @param atlasSize the width and height of the atlas, must be a power of two
+         @param minTileSize the smallest tile handed out, must be a power of two no larger than atlasSize
+         */
+        ShadowAtlasAllocator(uint16_t atlasSize, uint16_t minTileSize);
+
+        /**
+         Find a place for a tile
+         @param size the width of the tile. It is rounded up to a power of two and clamped to [minTileSize, atlasSize].
+         @return the tile, or an invalid tile if no free region is large enough
+         */
+        Tile Allocate(uint16_t size);
+
+        /**
+         Release a tile, merging it with its siblings if they are all free
+         @param tile a valid tile returned by Allocate
+         */
+        void Free(const Tile& tile);
+
+        /**
+         Forget every tile
+         */
+        void Reset();
+
+        uint16_t GetAtlasSize() const {
+            return atlasSize;
+        }
+
+        uint16_t GetMinTileSize() const {
+            return minTileSize;
+        }
+
+        /**
+         @return the number of free texels, across all free tiles
+         */
+        uint32_t GetFreeTexels() const {
+            return freeTexels;
+        }
+
+    private:
+        enum class NodeState : uint8_t {
+            Free,
+            Split,
+            Allocated
+        };
+        Vector<NodeState> nodes;    // a complete quadtree in level order, the children of node i are 4i+1 to 4i+4
+        uint16_t atlasSize, minTileSize;
+        uint8_t numLevels;
+        uint32_t freeTexels = 0;
+
+        bool AllocateInNode(uint32_t node, uint8_t level, uint8_t targetLevel, uint16_t x, uint16_t y, Tile& tile);
+    };
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "CTTI.hpp"
+
+namespace RavEngine {
+	/**
+	 Marks an entity, such as a player or a camera, around which dynamic bodies keep simulating when PhysicsSolver::useSimulationRegions
+	 is set. The anchor's position is read from the entity's Transform.
+	 */
+	struct SimulationAnchor : public AutoCTTI {
+		float radius = 100;		// bodies farther than this from every anchor stop simulating
+
+		SimulationAnchor(float radius = 100) : radius(radius) {}
+	};
+}
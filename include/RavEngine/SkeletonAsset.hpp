@@ -1,9 +1,13 @@
 #pragma once
 #include <ozz/animation/runtime/skeleton.h>
 #include <ozz/animation/offline/skeleton_builder.h>
+#include <ozz/base/maths/simd_math.h>
+#include <ozz/base/containers/vector.h>
 #include <string>
 #include <optional>
 #include "Vector.hpp"
+#include "Map.hpp"
+#include "StringID.hpp"
 #include "mathtypes.hpp"
 #if !RVE_SERVER
 #include <RGL/Types.hpp>
@@ -18,6 +22,8 @@ class SkeletonAsset{
 #endif
 
     RavEngine::Vector<glm::mat4> bindposes;
+    ozz::vector<ozz::math::Float4x4> inverseBindposes;
+    UnorderedMap<StringID, uint16_t> boneIndices;
 public:
 	SkeletonAsset(const std::string& path);
 	~SkeletonAsset();
@@ -41,9 +47,16 @@ public:
 	/**
 	 @return bindposes for use in software
 	 */
-    inline const auto GetBindposes() const{
+    inline const auto& GetBindposes() const{
 		return bindposes;
 	}
+
+	/**
+	 @return the same bindposes as GetBindposes, in SIMD form for multiplying with ozz model-space matrices
+	 */
+    inline const auto& GetInverseBindposes() const{
+		return inverseBindposes;
+	}
 	
 #if !RVE_SERVER
 	/**
@@ -60,7 +73,13 @@ public:
 	 @return True if the skeleton has a bone by the name, false if not
 	 */
 	bool HasBone(const std::string_view boneName) const;
+	bool HasBone(StringID boneName) const;
     
+    /**
+     @param boneName name of the bone to find
+     @return the index of the bone's joint, if the skeleton has a bone by the name
+     */
     std::optional<uint16_t> IndexForBone(const std::string_view boneName) const;
+    std::optional<uint16_t> IndexForBone(StringID boneName) const;
 };
 }
@@ -36,6 +36,21 @@ namespace RavEngine {
 		bool enabled = true;
 		Ref<ISkyMaterialInstance> skyMat;
 
+		/**
+		If true, the sky material is rendered into a low resolution cubemap only when the sky changes, and the sky pass samples the cubemap
+		instead of evaluating the material for every pixel. The cubemap also lights the world, through its irradiance in the ambient pass.
+		The cubemap is rendered from the world origin, so terms of the material that depend on the camera position do not follow the camera.
+		Call Invalidate after changing the parameters of the material.
+		*/
+		bool cached = false;
+		uint32_t cacheResolution = 128;		// pixels per side of each cubemap face
+		float ambientIntensity = 1;			// how much the cached sky's irradiance lights surfaces. It is occluded by SSAO
+
+		// re-render the cached cubemap on the next frame
+		void Invalidate() {
+			version++;
+		}
+
 		// default constructor, loads default sky implementation
 		Skybox();
 
@@ -43,6 +58,14 @@ namespace RavEngine {
 		Skybox(const decltype(skyMat)& sm ): skyMat(sm){}
 
 		friend class App;
+		friend class RenderEngine;
+	private:
+		uint32_t version = 0;
+		struct {
+			RGLTexturePtr faces, depth, irradiance;	// faces is a row of the six cube faces, irradiance has one texel per face direction
+			const ISkyMaterialInstance* material = nullptr;
+			uint32_t version = 0, resolution = 0;
+		} cache;
 	};
 
 	
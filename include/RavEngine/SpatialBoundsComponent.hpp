@@ -0,0 +1,42 @@
+#pragma once
+#include "ComponentWithOwner.hpp"
+#include "SpatialIndex.hpp"
+
+namespace RavEngine {
+    struct MeshCollectionStatic;
+
+    /**
+     Registers its owner in the world's SpatialIndex as a sphere around the owner's Transform.
+     The index is updated once per tick for owners whose transforms changed.
+     @note the owning entity must have a Transform
+     */
+    struct SpatialBoundsComponent : public ComponentWithOwner {
+        SpatialBoundsComponent(Entity owner, float radius) : ComponentWithOwner(owner), radius(radius) {}
+#if !RVE_SERVER
+        /**
+         Use the bounding radius of a mesh
+         */
+        SpatialBoundsComponent(Entity owner, const MeshCollectionStatic& mesh);
+#endif
+
+        MOVE_NO_COPY(SpatialBoundsComponent);
+
+        auto GetRadius() const {
+            return radius;
+        }
+
+        void SetRadius(float r) {
+            radius = r;
+            needsUpdate = true;
+        }
+
+        // called by the world when the component is destroyed
+        void Destroy();
+
+    private:
+        friend class World;
+        float radius;
+        SpatialIndex::proxy_t proxy = SpatialIndex::INVALID_PROXY;
+        bool needsUpdate = true;
+    };
+}
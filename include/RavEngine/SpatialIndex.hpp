@@ -0,0 +1,183 @@
+#pragma once
+#include "mathtypes.hpp"
+#include "Types.hpp"
+#include "Vector.hpp"
+#include "Function.hpp"
+#include <cstdint>
+
+namespace RavEngine {
+    /**
+     An axis-aligned bounding box in world space
+     */
+    struct AABB {
+        vector3 min{ 0 }, max{ 0 };
+
+        static AABB FromSphere(const vector3& center, float radius) {
+            return { center - vector3(radius), center + vector3(radius) };
+        }
+
+        bool Overlaps(const AABB& other) const {
+            return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::lessThanEqual(other.min, max));
+        }
+
+        bool Contains(const AABB& other) const {
+            return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::lessThanEqual(other.max, max));
+        }
+
+        AABB Union(const AABB& other) const {
+            return { glm::min(min, other.min), glm::max(max, other.max) };
+        }
+
+        float SurfaceArea() const {
+            const auto d = max - min;
+            return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+    };
+
+    /**
+     The six planes of a camera's view volume, with normals pointing inward
+     */
+    struct Frustum {
+        vector4 planes[6];
+
+        /**
+         Extract the planes with the Gribb-Hartmann method. The near plane accepts both [-1,1] and [0,1] depth ranges, which is conservative for either.
+         @param viewProj the camera's projection * view matrix
+         */
+        static Frustum FromViewProj(const matrix4& viewProj) {
+            auto row = [&viewProj](int i) { return vector4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+            const vector4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+            return { { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2 } };
+        }
+
+        /**
+         @return true if the box is at least partially inside
+         */
+        bool Intersects(const AABB& b) const {
+            for (const auto& plane : planes) {
+                // the box corner furthest along the plane normal
+                const vector3 n(plane);
+                const vector3 p(n.x >= 0 ? b.max.x : b.min.x, n.y >= 0 ? b.max.y : b.min.y, n.z >= 0 ? b.max.z : b.min.z);
+                if (glm::dot(n, p) + plane.w < 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         @return true if the sphere is at least partially inside. Planes are not normalized, so each is scaled by its normal's length.
+         */
+        bool Intersects(const vector3& center, float radius) const {
+            for (const auto& plane : planes) {
+                const vector3 n(plane);
+                if (glm::dot(n, center) + plane.w < -radius * glm::length(n)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     An incrementally updated bounding volume hierarchy (dynamic AABB tree) over entities.
+     Leaves store a slightly enlarged box, so small motions do not restructure the tree.
+     A World owns one, see World::GetSpatialIndex.
+     */
+    class SpatialIndex {
+    public:
+        using proxy_t = uint32_t;
+        constexpr static proxy_t INVALID_PROXY = std::numeric_limits<proxy_t>::max();
+
+        /**
+         Add an entity to the index
+         @param entity the entity to return from queries
+         @param bounds the entity's tight world space bounds
+         @return a handle to pass to Update and Remove
+         */
+        proxy_t Insert(entity_t entity, const AABB& bounds);
+
+        /**
+         Update the bounds of an entity in the index. The tree is only restructured if the new bounds leave the enlarged leaf box.
+         @return true if the tree was restructured
+         */
+        bool Update(proxy_t proxy, const AABB& bounds);
+
+        void Remove(proxy_t proxy);
+
+        /**
+         Visit every entity whose bounds overlap the box. Return false from the callback to stop early.
+         */
+        void QueryAABB(const AABB& box, FunctionRef<bool(entity_t)> fn) const;
+
+        /**
+         Visit every entity whose bounds overlap the sphere. Return false from the callback to stop early.
+         */
+        void QuerySphere(const vector3& center, float radius, FunctionRef<bool(entity_t)> fn) const;
+
+        /**
+         Visit every entity whose bounds are at least partially inside the frustum. Return false from the callback to stop early.
+         @param viewProj the camera's projection * view matrix
+         */
+        void QueryFrustum(const matrix4& viewProj, FunctionRef<bool(entity_t)> fn) const;
+
+        /**
+         Visit every entity whose bounds the ray passes through, in tree order. Return false from the callback to stop early.
+         @param origin the start of the ray
+         @param direction the direction of the ray, does not need to be normalized
+         @param maxDistance the length of the ray, in multiples of direction
+         @param fn receives the entity and the distance along the ray at which it enters the entity's bounds
+         */
+        void RayCast(const vector3& origin, const vector3& direction, float maxDistance, FunctionRef<bool(entity_t, float)> fn) const;
+
+        /**
+         @return the tight bounds the entity was last inserted or updated with
+         */
+        const AABB& GetBounds(proxy_t proxy) const {
+            return nodes[proxy].tight;
+        }
+
+        auto GetProxyCount() const {
+            return nProxies;
+        }
+
+        /**
+         @return the number of edges from the root to the deepest leaf
+         */
+        uint32_t GetHeight() const {
+            return root == INVALID_PROXY ? 0 : nodes[root].height;
+        }
+
+        /**
+         How far leaf boxes are enlarged beyond their tight bounds, in world units
+         */
+        float margin = 0.1f;
+
+    private:
+        struct Node {
+            AABB fat;                       // enlarged for leaves, union of children for internal nodes
+            AABB tight;                     // leaves only
+            proxy_t parent = INVALID_PROXY;
+            proxy_t children[2]{ INVALID_PROXY, INVALID_PROXY };
+            entity_t entity;
+            int32_t height = 0;             // 0 for leaves, -1 for free nodes
+
+            bool IsLeaf() const {
+                return children[0] == INVALID_PROXY;
+            }
+        };
+        Vector<Node> nodes;
+        proxy_t root = INVALID_PROXY;
+        proxy_t freeList = INVALID_PROXY;   // linked through Node::parent
+        uint32_t nProxies = 0;
+
+        proxy_t AllocateNode();
+        void FreeNode(proxy_t node);
+        void InsertLeaf(proxy_t leaf);
+        void RemoveLeaf(proxy_t leaf);
+        void Refit(proxy_t node);
+
+        template<typename Overlap, typename Visit>
+        void Traverse(const Overlap& overlaps, const Visit& visit) const;
+    };
+}
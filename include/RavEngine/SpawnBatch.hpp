@@ -0,0 +1,40 @@
+#pragma once
+#include "NetworkIDTable.hpp"
+#include "Uuid.hpp"
+#include "CTTI.hpp"
+#include "Vector.hpp"
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace RavEngine {
+
+	/**
+	 Many spawn commands for one world in one compressed message, sent to clients that join a world that already has entities.
+	 The message is the SpawnBatch command code, the world ID, the number of records, their uncompressed size, and the
+	 compressed records.
+	 */
+	struct SpawnBatch {
+		struct Record {
+			ctti_t type = 0;
+			netid_t sessionID = 0;
+			uuids::uuid id;
+		};
+
+		constexpr static uint32_t recordsPerBatch = 2048;		// ~56KB before compression
+
+		/**
+		 Create a batch
+		 @param records at most recordsPerBatch
+		 @param worldID the World::worldID of the world the entities are in
+		 */
+		static std::string Encode(std::span<const Record> records, const std::string_view& worldID);
+
+		/**
+		 Read a batch made by Encode
+		 @param worldID receives the world ID
+		 @return false if the batch is malformed
+		 */
+		static bool Decode(const std::string_view& batch, std::string& worldID, Vector<Record>& records);
+	};
+}
@@ -1,34 +1,92 @@
 #pragma once
 #include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include "Profile.hpp"
 
 namespace RavEngine{
 
+struct LockSiteStats;
+
 /**
-  A spinlock implemented using std::atomic_flag, which uses test-and-set instead of kernel calls.
+  An adaptive lock. Uncontended, it is a single compare-and-swap. Contended, it spins with a pause instruction and
+  backoff for a short time, then parks the thread with atomic::wait so waiters do not burn timeslices when threads
+  outnumber cores. In profile builds, contended acquisitions record their count and wait time by lock site.
  */
 class SpinLock{
-	std::atomic_flag flag
-#ifndef _WIN32
-		ATOMIC_FLAG_INIT
+	// 0 = unlocked, 1 = locked, 2 = locked and threads may be parked
+	std::atomic<uint32_t> state = 0;
+#if RVE_PROFILE
+	const char* site = nullptr;
+	std::atomic<LockSiteStats*> stats = nullptr;		// found on first contention
 #endif
-		;
+
+	void LockContended();
 public:
     inline void lock(){
-		while(flag.test_and_set());
+		uint32_t expected = 0;
+		if (!state.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+			LockContended();
+		}
+	}
+
+	inline bool try_lock(){
+		uint32_t expected = 0;
+		return state.compare_exchange_strong(expected, 1, std::memory_order_acquire);
 	}
 	
     inline void unlock(){
-		flag.clear();
+		if (state.exchange(0, std::memory_order_release) == 2) {
+			state.notify_one();
+		}
 	}
     
     // constructors and operators
     SpinLock(){};
+	/**
+	 @param site the name contention statistics are recorded under. Must outlive the lock, such as a string literal.
+	 */
+	SpinLock(const char* site)
+#if RVE_PROFILE
+		: site(site)
+#endif
+	{}
     //SpinLock(SpinLock&& other){}
     
     // copy-assign or copy-construct a lock does NOT
     // copy its state. These exist as conveniences for other things. 
-    SpinLock(const SpinLock& other){}
+    SpinLock(const SpinLock& other)
+#if RVE_PROFILE
+		: site(other.site)
+#endif
+	{}
     inline void operator=(const SpinLock& other){}
+
+	struct ContentionStats {
+		const char* site;
+		uint64_t contentions = 0;	// acquisitions that did not get the lock immediately
+		double waitMs = 0;			// total time those acquisitions waited
+	};
+
+	/**
+	 @return contention by lock site since startup. Empty unless the engine is built with profiling.
+	 */
+	static std::vector<ContentionStats> GetContentionStats();
+};
+
+// for locks that their owner constructs, such as the locks in locked_hashmap
+template<size_t N>
+struct LockSiteName {
+	char value[N];
+	constexpr LockSiteName(const char (&str)[N]) {
+		std::copy_n(str, N, value);
+	}
+};
+
+template<LockSiteName name>
+struct NamedSpinLock : public SpinLock {
+	NamedSpinLock() : SpinLock(name.value) {}
 };
 
 // do not dynamic allocate
@@ -17,6 +17,7 @@ namespace RavEngine {
 	};
 
 	struct IStream {
+		virtual ~IStream() = default;
 
 		virtual IStreamResult read(std::span<std::byte> outData) = 0;
 		virtual void reset() = 0;
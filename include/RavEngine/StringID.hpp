@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <functional>
+
+namespace RavEngine {
+
+/**
+ A string reduced to a stable 64-bit hash, for keys that are looked up often. Hashing and comparing one is a single
+ integer operation, and literals are hashed at compile time with "name"_sid. The same string gives the same ID in every run.
+ Intern a string to be able to get it back with ToString, for example for error messages.
+ */
+struct StringID {
+    uint64_t value = 0;
+
+    constexpr StringID() = default;
+    constexpr explicit StringID(std::string_view str) : value(Hash(str)) {}
+
+    // FNV-1a over the characters, without a terminator, so that literals and runtime strings agree
+    constexpr static uint64_t Hash(std::string_view str) {
+        uint64_t hash = 14695981039346656037ull;
+        for (const auto c : str) {
+            hash ^= uint8_t(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    constexpr bool operator==(const StringID&) const = default;
+    constexpr auto operator<=>(const StringID&) const = default;
+
+    /**
+     @return the string this ID was interned from, or an empty view if it was never interned. The view is valid for the life of the program.
+     */
+    std::string_view ToString() const;
+};
+
+/**
+ Record a string so that StringID::ToString can find it. In debug builds, this also reports two strings with the same ID.
+ @return the same ID as StringID(str)
+ */
+StringID Intern(std::string_view str);
+
+inline namespace StringIDLiterals {
+    consteval StringID operator""_sid(const char* str, size_t length) {
+        return StringID(std::string_view(str, length));
+    }
+}
+
+}
+
+template<>
+struct std::hash<RavEngine::StringID> {
+    size_t operator()(const RavEngine::StringID& id) const {
+        return size_t(id.value);
+    }
+};
@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <string>
 #include <bitset>
+#include <vector>
 
 namespace RavEngine {
 
@@ -17,6 +18,44 @@ namespace RavEngine {
 		*/
 		uint16_t NumLogicalProcessors();
     
+        enum class CoreClass : uint8_t {
+            Performance, Efficiency
+        };
+
+        struct LogicalCore {
+            uint16_t id = 0;                // the OS's index for the logical processor
+            uint16_t physicalCore = 0;      // logical cores that share a physical core are SMT siblings
+            uint16_t numaNode = 0;
+            CoreClass coreClass = CoreClass::Performance;
+        };
+
+        struct CPUTopology {
+            std::vector<LogicalCore> cores;
+            uint16_t numPhysicalCores = 0;
+            uint16_t numNumaNodes = 1;
+            bool hybrid = false;            // true if the CPU has both performance and efficiency cores
+
+            uint16_t NumCores(CoreClass coreClass) const;
+        };
+
+        /**
+         @return the logical cores of the CPU, which kind each is, and how they are grouped. Detected on first call and cached.
+         On Apple platforms, which do not expose core IDs, the performance cores are listed first.
+         */
+        const CPUTopology& GetCPUTopology();
+
+        enum class ThreadRole : uint8_t {
+            LatencyCritical,    // the main thread, frame workers, audio mixing and networking
+            Background          // streaming and asset loading
+        };
+
+        /**
+         Steer the calling thread onto the cores suited to its role. On hybrid CPUs, latency critical threads are kept on the performance
+         cores and background threads on the efficiency cores. Background threads also run at a lower priority. On Apple platforms,
+         which do not allow affinity, this sets the thread's QoS class, which the scheduler uses to pick cores.
+         */
+        void PlaceCurrentThread(ThreadRole role);
+    
         /**
          @return the string name of the GPU, as reported by the operating system (eg "Intel(R) Core(TM) i9-9880H CPU @ 2.30GHz")
          */
@@ -67,6 +106,11 @@ namespace RavEngine {
         @return total system memroy in MB
          */
         uint32_t SystemRAM();
+
+        /**
+        @return the physical memory this process occupies, in bytes, or 0 if the platform does not report it
+         */
+        uint64_t ProcessResidentMemory();
     
         struct OSVersion{
             uint16_t major = 0, minor = 0, patch = 0, extra = 0;
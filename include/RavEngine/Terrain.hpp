@@ -0,0 +1,129 @@
+#pragma once
+#include "WorldStreamer.hpp"
+#include "Heightfield.hpp"
+#include "PhysicsMaterial.hpp"
+#include "Ref.hpp"
+#include <array>
+#include <optional>
+
+namespace RavEngine {
+    class Texture;
+    struct MeshCollectionStatic;
+    struct TerrainMaterial;
+    class TerrainMaterialInstance;
+
+    struct TerrainConfig {
+        float tileSize = 256;               // tiles are StreamingCells of this size
+        uint32_t patchesPerSide = 8;        // each tile is drawn as patchesPerSide * patchesPerSide patches, which are culled and pick their LOD on their own
+        uint32_t patchResolution = 32;      // quads along a side of a patch at LOD 0. Tiles must have patchesPerSide * patchResolution + 1 samples per side.
+        uint8_t numLODs = 4;                // each LOD halves the resolution of the one before it
+        float lodDistance = 48;             // LOD n is drawn beyond lodDistance * 2^(n - 1) from the camera
+        float skirtDepth = 2;               // how far the edges of patches hang down, to hide the cracks where LODs meet
+        float loadRadius = 768;
+        float unloadRadius = 1024;          // keep it above loadRadius, so tiles on the edge do not thrash
+        uint32_t maxLoadsInFlight = 2;
+        uint32_t tilesPerFrame = 1;         // tiles given their textures, patches and collider per Update, so a tile crossing the radius does not hitch the frame
+    };
+
+    /**
+     A heightfield landscape, streamed in tiles around a set of anchors. See TerrainTileHeader for the format of a tile.
+     Tiles are read and parsed on the background executor. On the game thread, each tile gets its height, normal and splat
+     textures, an entity per patch and a static body with a HeightfieldCollider.
+     All patches share one grid mesh with a LOD per resolution, so they are culled, LOD-selected and batched into the same
+     indirect draws on the GPU like any other MeshCollectionStatic. The vertex shader moves the grid's vertices onto the
+     tile's heights, and lowers its skirts to cover the seams between patches at different LODs.
+     */
+    class Terrain {
+    public:
+        using Config = TerrainConfig;
+        using path_fn = Function<std::string(StreamingCell)>;
+
+        /**
+         @param tilePath returns the resources path of a tile, or an empty string if the terrain has nothing there. Tiles that do not exist are holes.
+         @param physicsMaterial the material of the tiles' colliders
+         */
+        Terrain(path_fn tilePath, Ref<PhysicsMaterial> physicsMaterial, const Config& config = {});
+        ~Terrain();
+
+        /**
+         Apply the loads that finished, destroy the tiles out of range, commit up to tilesPerFrame tiles,
+         and start loading the closest missing tiles. Call once per frame on the thread that owns the world.
+         @param anchors the positions to keep the terrain loaded around. With no anchors, every tile is evicted.
+         */
+        void Update(World& world, std::span<const glm::vec3> anchors);
+
+        /**
+         Set the texture of one of the four layers the splat maps blend, on every tile
+         */
+        void SetLayerTexture(uint8_t layer, Ref<Texture> texture);
+
+        /**
+         @return the height of the terrain under a position, if the tile there is resident
+         */
+        std::optional<float> SampleHeight(glm::vec3 position) const;
+
+        /**
+         @return true if a tile has its patches and collider
+         */
+        bool IsResident(StreamingCell tile) const;
+
+        uint32_t GetNumLoadsInFlight() const {
+            return loadsInFlight;
+        }
+
+        const Config& GetConfig() const {
+            return config;
+        }
+
+    private:
+        enum class TileState : uint8_t {
+            Loading,
+            Loaded,     // parsed, waiting for its turn to commit
+            Resident
+        };
+
+        struct Tile {
+            TileState state = TileState::Loading;
+            uint32_t generation = 0;            // a load for an evicted tile is dropped when it lands
+            bool empty = false;                 // the tile does not exist, or could not be read
+            TerrainTileData data;               // the splat map is released once uploaded
+            Vector<std::array<uint8_t, 4>> normals;
+            Vector<entity_t> entities;
+#if !RVE_SERVER
+            Ref<TerrainMaterialInstance> material;
+#endif
+        };
+
+        struct LoadedTile {
+            StreamingCell tile;
+            uint32_t generation = 0;
+            bool empty = true;
+            TerrainTileData data;
+            Vector<std::array<uint8_t, 4>> normals;
+        };
+
+        static uint64_t KeyFor(StreamingCell tile) {
+            return (uint64_t(uint32_t(tile.x)) << 32) | uint32_t(tile.z);
+        }
+
+        void Commit(World& world, StreamingCell coord, Tile& tile);
+        void Evict(World& world, Tile& tile);
+
+        path_fn tilePath;
+        Ref<PhysicsMaterial> physicsMaterial;
+        Config config;
+#if !RVE_SERVER
+        Ref<MeshCollectionStatic> patchMesh;
+        Ref<TerrainMaterial> material;
+        std::array<Ref<Texture>, 4> layerTextures;
+#endif
+        UnorderedMap<uint64_t, Tile> tiles;
+        Vector<StreamingCell> loaded;           // in the order they landed
+        ConcurrentQueue<LoadedTile> loadedTiles;
+        std::atomic<uint32_t> loadsInFlight = 0;
+        uint32_t nextGeneration = 0;
+        Vector<std::pair<float, StreamingCell>> candidates;
+        Vector<StreamingCell> tilesNearAnchor;
+        Vector<uint64_t> evicted;
+    };
+}
@@ -9,10 +9,17 @@
 #include "RenderTargetCollection.hpp"
 #include <span>
 #include <cstddef>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include "Vector.hpp"
+#include "Function.hpp"
+#include "AsyncTextureLoader.hpp"
 
 namespace RavEngine{
 
 struct IStream;
+class RenderEngine;
 
 class Texture {
 public:
@@ -60,6 +67,12 @@ protected:
 	void CreateTexture(int width, int height, const Config& config);
 
 	void InitFromDDS(IStream&);
+	void InitFromKTX2(IStream&, const std::string& name);
+
+	/**
+	 Create the texture and its full mip chain from an RGBA8 image
+	 */
+	void InitFromRGBA8(const unsigned char* pixels, int width, int height);
 };
 
 class RuntimeTexture : public Texture{
@@ -72,7 +85,7 @@ public:
 	 @param height height of the texture
 	 @param hasMipMaps does the texture contain mip maps
 	 @param numLayers the number of layers in the texture (NOT channels!)
-	 @param data pointer to the image data. Must be a 4-channel image.
+	 @param data pointer to the image data, in the config's format
 	 @param flags optional creation flags
 	 */
 	RuntimeTexture(int width, int height, const Config& config) : Texture(){
@@ -80,6 +93,120 @@ public:
 	}
 };
 
+/**
+ A texture whose large mips are loaded on demand. The texture starts with only its tail (the mips no larger than
+ tailSize) resident, and the TextureStreamer adds and removes the larger mips based on the mips shaders report sampling,
+ the mips requested with RequestMip, and the streaming budget. Missing mips are decoded from the file on the executor.
+ The GPU texture holds only the resident mips, and is replaced when they change, so do not cache GetRHITexturePointer.
+ Supports the raster formats of Texture, and DDS files with pre-built mip chains.
+ */
+class StreamingTexture : public Texture {
+public:
+	constexpr static uint16_t tailSize = 64;
+
+	/**
+	 Create a streaming texture given a file
+	 @param filename name of the texture
+	 */
+	StreamingTexture(const std::string& filename);
+	StreamingTexture(const Filesystem::Path& pathOnDisk);
+	~StreamingTexture();
+
+	/**
+	 Ask for a mip to be resident, in addition to the mips reported by shaders. Requests last for one frame, and are granted within the budget.
+	 */
+	void RequestMip(uint8_t mip);
+
+	/**
+	 @return the index of this texture in TextureStreamer::GetFeedbackBuffer
+	 */
+	uint32_t GetFeedbackSlot() const {
+		return slot;
+	}
+
+	/**
+	 @return the width and height of mip 0, which may not be resident
+	 */
+	RGL::Dimension GetFullSize() const {
+		return { fullWidth, fullHeight };
+	}
+
+	uint8_t GetNumMips() const {
+		return numMips;
+	}
+
+	/**
+	 @return the largest resident mip
+	 */
+	uint8_t GetResidentMip() const {
+		return residentMip;
+	}
+
+private:
+	friend class TextureStreamer;
+	struct Source;
+	std::shared_ptr<const Source> source;
+	std::string debugName;
+	RGL::TextureFormat format = RGL::TextureFormat::RGBA8_Unorm;
+	uint32_t fullWidth = 0, fullHeight = 0;
+	uint32_t slot = 0;
+	uint8_t numMips = 1, tailMip = 0, residentMip = 0;
+	uint8_t blockDim = 1, bytesPerBlock = 4;
+	std::atomic<uint8_t> requestedMip = std::numeric_limits<uint8_t>::max();
+
+	void Init(Vector<std::byte>&& fileData, const std::string& name);
+
+	/**
+	 @return mips [first, last) of the texture
+	 */
+	static Vector<Vector<std::byte>> DecodeMips(const Source& source, uint8_t first, uint8_t last);
+
+	/**
+	 Replace the GPU texture with one holding mips [newBaseMip, numMips)
+	 @param newMips the data of the first mips of the new texture. The rest are copied from the current texture.
+	 */
+	void SetResidentMips(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine, uint8_t newBaseMip, std::span<const Vector<std::byte>> newMips);
+};
+
+/**
+ A texture that is read, decoded and uploaded without blocking the caller, so that spawning content mid-game does not hitch.
+ It shows Texture::Manager::defaultTexture until the AsyncTextureLoader uploads it at the start of a later frame. Its GPU
+ texture is replaced when it finishes loading, so do not cache GetRHITexturePointer.
+ Supports the raster formats of Texture, and DDS files.
+ */
+class AsyncTexture : public Texture {
+public:
+	/**
+	 Begin loading a texture given a file
+	 @param filename name of the texture
+	 */
+	AsyncTexture(const std::string& filename);
+	AsyncTexture(const Filesystem::Path& pathOnDisk);
+	~AsyncTexture();
+
+	/**
+	 Use the manager to avoid loading duplicate textures
+	 */
+	struct Manager : public GenericWeakReadThroughCache<std::string, AsyncTexture> {};
+
+	/**
+	 @return true once the texture has been uploaded and no longer shows the default texture
+	 */
+	bool IsLoaded() const {
+		return loaded;
+	}
+
+private:
+	friend class AsyncTextureLoader;
+	uint32_t slot = 0;
+	std::string debugName;
+	std::atomic<bool> loaded = false;
+
+	void Load(Function<Vector<std::byte>()>&& read);
+
+	void Upload(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine, const AsyncTextureLoader::Decoded& decoded);
+};
+
 class RenderTexture {
 public:
     RenderTexture(int width, int height);
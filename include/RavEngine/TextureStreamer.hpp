@@ -0,0 +1,127 @@
+#pragma once
+#if !RVE_SERVER
+#include "Vector.hpp"
+#include "Queue.hpp"
+#include <RGL/Types.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+
+namespace RavEngine {
+    class StreamingTexture;
+    class RenderEngine;
+
+    /**
+     The residency of one streaming texture, see ResolveTextureStreamingBudget
+     */
+    struct TextureStreamingRequest {
+        uint32_t width = 0, height = 0;     // of mip 0
+        uint8_t numMips = 1;
+        uint8_t tailMip = 0;                // this mip and the smaller ones are always resident
+        uint8_t wantedMip = 0;              // the largest mip the texture should have resident
+        uint8_t blockDim = 1;               // the width and height of a block of texels, 4 for block-compressed formats
+        uint8_t bytesPerBlock = 4;
+        uint8_t grantedMip = 0;             // output: the largest mip the texture may have resident
+    };
+
+    /**
+     @return the size of mips [baseMip, numMips) of a texture, in bytes
+     */
+    uint64_t TextureMipChainBytes(const TextureStreamingRequest& request, uint8_t baseMip);
+
+    /**
+     Decide how much of each texture may be resident. Every texture is granted its wanted mip, then while the total is over budget,
+     the texture whose largest granted mip is the biggest drops it, so detail is taken from the largest textures first.
+     Textures never drop their tail.
+     @return the total size of the granted mips, which is over budget only if the tails alone are
+     */
+    uint64_t ResolveTextureStreamingBudget(std::span<TextureStreamingRequest> requests, uint64_t budgetBytes);
+
+    /**
+     Streams the mips of every StreamingTexture in and out of VRAM. Once per frame, it reads the mips that shaders requested in the
+     previous frame, fits the requests into the memory budget, decodes missing mips on the executor, and reallocates the textures
+     whose residency changed. A texture keeps a mip until evictionDelayFrames pass without a request for it, so textures near a
+     mip boundary do not thrash.
+     */
+    class TextureStreamer {
+    public:
+        constexpr static uint32_t maxStreamingTextures = 16384;
+        constexpr static uint32_t noRequest = std::numeric_limits<uint32_t>::max();
+
+        ~TextureStreamer();
+
+        /**
+         Set the memory that streaming textures may use together, in bytes. The tails of the textures are counted but never evicted.
+         */
+        void SetBudget(uint64_t bytes) {
+            budgetBytes = bytes;
+        }
+
+        uint64_t GetBudget() const {
+            return budgetBytes;
+        }
+
+        /**
+         @return the memory granted to streaming textures on the last frame, in bytes
+         */
+        uint64_t GetResidentBytes() const {
+            return residentBytes;
+        }
+
+        /**
+         One uint per streaming texture, indexed by StreamingTexture::GetFeedbackSlot, holding the largest mip sampled by any
+         shader in the frame, or noRequest. To have a material report its mips, bind this buffer to one of its buffer slots and
+         call RequestStreamingTextureMip from texture_streaming.glsl in its fragment shader. The buffer is never reallocated.
+         */
+        RGLBufferPtr GetFeedbackBuffer() const {
+            return feedbackBuffer;
+        }
+
+        uint32_t evictionDelayFrames = 120;
+
+    private:
+        friend class StreamingTexture;
+        friend class RenderEngine;
+
+        struct Entry {
+            StreamingTexture* texture = nullptr;
+            uint32_t generation = 0;        // bumped when the slot is released, so decodes for the old texture are dropped
+            uint64_t lastRequestFrame = 0;
+            uint8_t wantedMip = 0;
+            bool loading = false;           // a decode is in flight, the residency does not change until it lands
+        };
+
+        struct DecodedMips {
+            uint32_t slot = 0, generation = 0;
+            uint8_t baseMip = 0;
+            Vector<Vector<std::byte>> mips;     // mips [baseMip, baseMip + size)
+        };
+
+        Vector<Entry> entries;
+        Vector<uint32_t> freeSlots;
+        std::mutex mtx;
+        ConcurrentQueue<DecodedMips> decodedMips;
+        std::atomic<uint32_t> decodesInFlight = 0;
+        RGLBufferPtr feedbackBuffer;
+        uint64_t budgetBytes = 1024ull * 1024 * 1024, residentBytes = 0, frameCount = 0;
+        uint64_t pressureLimitBytes = std::numeric_limits<uint64_t>::max();    // lowered by the RenderEngine under VRAMPressureLevel::TextureMips
+        Vector<TextureStreamingRequest> requests;
+        Vector<uint32_t> requestSlots;
+
+        void Init(RGLDevicePtr device);
+
+        /**
+         Apply the decodes that finished, read back the mip requests, and start decodes or evict mips to match the budget.
+         Must be called once per frame, after the previous frame has completed on the GPU.
+         */
+        void Update(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine);
+
+        uint32_t Register(StreamingTexture* texture);
+        void Unregister(uint32_t slot);
+        void SubmitDecodedMips(uint32_t slot, uint8_t baseMip, Vector<Vector<std::byte>>&& mips);
+    };
+}
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+#include "Vector.hpp"
+#include "Function.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace RavEngine {
+    /**
+     A hierarchical timer wheel. Scheduling and expiring a callback is O(1), and advancing time only
+     touches the slots that come due, so the cost of a tick does not depend on how many callbacks are pending.
+     Callback nodes are pooled and reused.
+     */
+    class TimerWheel {
+    public:
+        using callback_t = Function<void(void)>;
+
+        /**
+         @param slotSeconds the resolution of the wheel. Callbacks run at most this much later than requested, never earlier.
+         */
+        TimerWheel(double slotSeconds = 0.001) : slotSeconds(slotSeconds) {
+            for (auto& level : slots) {
+                level.fill(INVALID_NODE);
+            }
+        }
+
+        /**
+         Schedule a callback
+         @param runAtSeconds the time, on the same clock passed to Advance, at or after which the callback is due
+         @param fn the callback
+         */
+        void Schedule(double runAtSeconds, callback_t fn);
+
+        /**
+         Advance the wheel to a time, and move every callback that has come due into out. Callbacks are not invoked here.
+         @param nowSeconds the current time
+         @param out receives due callbacks, in no particular order
+         */
+        void Advance(double nowSeconds, Vector<callback_t>& out);
+
+        /**
+         @return the number of callbacks waiting to come due
+         */
+        auto size() const {
+            return nPending;
+        }
+
+    private:
+        constexpr static uint32_t bitsPerLevel = 8;
+        constexpr static uint32_t slotsPerLevel = 1 << bitsPerLevel;
+        constexpr static uint32_t nLevels = 4;
+        constexpr static uint32_t INVALID_NODE = std::numeric_limits<uint32_t>::max();
+
+        struct Node {
+            callback_t fn;
+            uint64_t dueTick = 0;
+            uint32_t next = INVALID_NODE;
+        };
+        Vector<Node> nodes;
+        uint32_t freeList = INVALID_NODE;
+        std::array<std::array<uint32_t, slotsPerLevel>, nLevels> slots;  // head of each slot's list
+        uint32_t ready = INVALID_NODE;      // nodes that were already due when scheduled
+        uint64_t currentTick = 0;
+        double slotSeconds;
+        uint32_t nPending = 0;
+
+        void Place(uint32_t node);
+        void Expire(uint32_t& head, Vector<callback_t>& out);
+    };
+}
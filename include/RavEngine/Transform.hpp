@@ -19,37 +19,59 @@
 namespace RavEngine {
 	struct Transform : public ComponentWithOwner, public Queryable<Transform> {
     protected:
+        // non-owning, cached because hierarchy updates dereference them constantly. Most transforms have few children, so they are stored inline.
+        SmallUnorderedVector<CachedComponentHandle<Transform>, 2>  children;
         mutable matrix4 matrix;				// defined as the world space transform of the PARENT
-        UnorderedVector<ComponentHandle<Transform>>  children;        //non-owning
         quaternion rotation;
         ComponentHandle<Transform> parent;    //non-owning
         vector3 position, scale;
         mutable bool isDirty : 1 = true;		// used for when the transform hierarchy has been changed
         mutable bool isTickDirty : 1 = true;    // used for when this transform has been updated in the current tick and needs updating in the world's render data
+        mutable bool isStatic : 1 = false;      // skipped by the world's per-tick scans, see SetStatic
+        mutable bool staticMoveQueued : 1 = false;  // static and changed since the world last consumed its static move list
+        mutable bool physicsPoseDirty : 1 = true;   // changed since PhysicsLinkSystemWrite last copied it
+        mutable bool spatialBoundsDirty : 1 = true; // changed since the world's SpatialIndex last read it
+        mutable bool renderMatrixWritten : 1 = false;   // this tick's world matrix is already in the world's render data, see PhysicsLinkSystemRead
 
         // sanity checking for optimal struct padding
 #if RVE_64_BIT
-        static_assert(sizeof(matrix) >= sizeof(children), "Invalid struct order");
-        static_assert(sizeof(children) >= sizeof(rotation), "Invalid struct order");
+        static_assert(sizeof(children) >= sizeof(matrix), "Invalid struct order");
+        static_assert(sizeof(matrix) >= sizeof(rotation), "Invalid struct order");
         static_assert(sizeof(rotation) >= sizeof(position), "Invalid struct order");
         static_assert(sizeof(parent) >= sizeof(position), "Invalid struct order");
 #endif
         
 		friend class World;
+		friend class PhysicsLinkSystemWrite;
+		friend class PhysicsLinkSystemRead;
         
         inline void MarkAsDirty() const{
             isDirty = true;
 			isTickDirty = true;
+			renderMatrixWritten = false;
+			physicsPoseDirty = true;
+			spatialBoundsDirty = true;
+			if (isStatic) [[unlikely]] {
+				QueueStaticMove();
+			}
         }
 
+		// tell the world that this static transform must be picked up once by its per-tick passes
+		void QueueStaticMove() const;
+
 		inline void ClearTickDirty() {
 			isTickDirty = false;
+			renderMatrixWritten = false;
 		}
 
+		// true if the owning world propagates hierarchy changes in a batch, see World::SetDeferredTransformPropagation
+		bool HierarchyIsDeferred() const;
+		void InvalidateHierarchy() const;
+
 		inline void UpdateChildren()
 		{
 			MarkAsDirty();
-			if (children.size() > 0) [[unlikely]]  {
+			if (children.size() > 0 && !HierarchyIsDeferred()) [[unlikely]]  {
 				constexpr auto update = [](Transform* transform, auto&& updatefn) -> void {
 					transform->MarkAsDirty();
 					auto newParentMatrix = transform->GetWorldMatrix();
@@ -68,6 +90,17 @@ namespace RavEngine {
         inline bool getTickDirty() const{
             return isTickDirty;
         }
+
+		/**
+		 Mark this transform as static. Static transforms are removed from the world's per-tick render data and
+		 physics sync scans. They can still be moved, in which case the change is picked up once on the next tick.
+		 @param in true to make this transform static, false to return it to per-tick scanning
+		 */
+		void SetStatic(bool in);
+
+		inline bool IsStatic() const {
+			return isStatic;
+		}
         
 		Transform(Entity owner, const vector3& inpos, const quaternion& inrot, const vector3& inscale) : ComponentWithOwner(owner), matrix(1){
 			SetLocalPosition(inpos);
@@ -146,6 +179,9 @@ namespace RavEngine {
         
         // destroy everything parented to this
         void Destroy(){
+            if (HasParent() || children.size() > 0){
+                InvalidateHierarchy();
+            }
             for(auto& child : children){
                 child.GetOwner().Destroy();
             }
@@ -157,7 +193,13 @@ namespace RavEngine {
 	@return glm matrix representing this transform
 	*/
 	inline matrix4 Transform::GenerateLocalMatrix() const{
-		return glm::translate(matrix4(1), (vector3)position) * glm::toMat4((quaternion)rotation) * glm::scale(matrix4(1), (vector3)scale);
+		// equivalent to translate * rotate * scale, without the two full matrix multiplies
+		matrix4 result = glm::toMat4((quaternion)rotation);
+		result[0] *= scale.x;
+		result[1] *= scale.y;
+		result[2] *= scale.z;
+		result[3] = vector4((vector3)position, 1);
+		return result;
 	}
 
 	/**
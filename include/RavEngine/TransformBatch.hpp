@@ -0,0 +1,25 @@
+#pragma once
+#include "mathtypes.hpp"
+#include <span>
+#include <cstdint>
+
+namespace RavEngine {
+    struct Transform;
+
+    namespace TransformBatch {
+        /**
+         Compute the world matrix of many transforms at once, and write each into a destination array.
+         Equivalent to `out[outIndices[i]] = transforms[i]->GetWorldMatrix()`, but builds the local translate-rotate-scale matrix
+         directly and multiplies it by the parent-space matrix with SSE or NEON where available.
+         @param transforms the transforms to evaluate
+         @param outIndices for each transform, the index in out to write to
+         @param out the destination, for example a host-visible buffer
+         */
+        void WriteWorldMatrices(std::span<const Transform* const> transforms, std::span<const uint32_t> outIndices, matrix4* out);
+
+        /**
+         Compute parent * translate(position) * rotate(rotation) * scale(scale) for a single transform, using the same kernel as WriteWorldMatrices.
+         */
+        void ComposeMatrix(const matrix4& parent, const vector3& position, const quaternion& rotation, const vector3& scale, matrix4& out);
+    }
+}
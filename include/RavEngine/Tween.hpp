@@ -64,8 +64,10 @@ namespace TweenCurves{
 		 @param step the function to invoke on each step.
 		 @param intialValue the starting value, set to 0 if not passed.
 		 */
-		Tween(const stepfunc& step, Floats ... initialValue){
-			anim = tweeny::from(initialValue...).onStep([=](Floats... values) -> bool{
+		template<typename F>
+		Tween(F&& step, Floats ... initialValue){
+			// capture the callable itself rather than a stepfunc, so it is not wrapped twice
+			anim = tweeny::from(initialValue...).onStep([step = std::forward<F>(step)](Floats... values) -> bool{
 				step(values...);
 				return false;
 			});
@@ -0,0 +1,97 @@
+#pragma once
+#include "Vector.hpp"
+#include "Function.hpp"
+#include <cstdint>
+#include <limits>
+
+namespace tf {
+    class Executor;
+}
+
+namespace RavEngine {
+    /**
+     Steps many float tweens together. Unlike Tween, each tween writes straight to a float instead of invoking a function per
+     step, and the tweens are stored as parallel arrays, so stepping thousands of them is one pass over contiguous memory.
+     Completion callbacks are collected and handed back in one batch.
+     */
+    class TweenManager {
+    public:
+        using callback_t = Function<void(void)>;
+
+        // the curves of TweenCurves, by identifier instead of by type
+        enum class Easing : uint8_t {
+            Linear,
+            Stepped,
+            QuadraticIn, QuadraticOut, QuadraticInOut,
+            CubicIn, CubicOut, CubicInOut,
+            QuarticIn, QuarticOut, QuarticInOut,
+            QuinticIn, QuinticOut, QuinticInOut,
+            SinusoidalIn, SinusoidalOut, SinusoidalInOut,
+            ExponentialIn, ExponentialOut, ExponentialInOut,
+            CircularIn, CircularOut, CircularInOut,
+            BounceIn, BounceOut, BounceInOut,
+            ElasticIn, ElasticOut, ElasticInOut,
+            BackIn, BackOut, BackInOut
+        };
+
+        struct Handle {
+            uint32_t slot = std::numeric_limits<uint32_t>::max();
+            uint32_t generation = 0;
+        };
+
+        /**
+         Start a tween
+         @param target the float to write on each step. It must stay valid until the tween completes or is cancelled.
+         @param from the value at the start
+         @param to the value at the end
+         @param duration in the same units as the time passed to Step
+         @param easing the curve between from and to
+         @param onComplete returned by the Step in which the tween reaches its end
+         @return a handle for Cancel and IsActive
+         */
+        Handle Add(float* target, float from, float to, float duration, Easing easing = Easing::Linear, callback_t onComplete = {});
+
+        /**
+         Stop a tween without completing it. The target keeps its current value.
+         @return false if the tween already completed or was cancelled
+         */
+        bool Cancel(Handle handle);
+
+        bool IsActive(Handle handle) const;
+
+        /**
+         Advance every tween and write their targets
+         @param delta the time that passed. For a tween made in seconds, pass GetApp()->GetCurrentFPSScale() / App::evalNormal.
+         @param completed receives the callbacks of tweens that reached their end, in no particular order. They are not invoked here.
+         @param executor if set, the targets are written in parallel on it
+         */
+        void Step(float delta, Vector<callback_t>& completed, tf::Executor* executor = nullptr);
+
+        /**
+         @return the number of active tweens
+         */
+        auto size() const {
+            return targets.size();
+        }
+
+    private:
+        // by dense index, kept packed by moving the last tween into a removed one's place
+        Vector<float> start, end, elapsed, duration;
+        Vector<Easing> easing;
+        Vector<float*> targets;
+        Vector<callback_t> callbacks;
+        Vector<uint32_t> slotOf;
+
+        // by Handle::slot
+        struct Slot {
+            uint32_t dense = 0;
+            uint32_t generation = 0;
+            bool active = false;
+        };
+        Vector<Slot> slots;
+        Vector<uint32_t> freeSlots;
+
+        void Remove(uint32_t dense);
+        void StepRange(float delta, uint32_t begin, uint32_t count);
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <RGL/Types.hpp>
+#include <RGL/Buffer.hpp>
+#include <array>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "MemoryTracking.hpp"
+#include "Types.hpp"
+
+namespace RavEngine {
+
+/**
+ The part of an UploadRingVector that does not depend on the element type
+ */
+class UploadRingBase {
+public:
+    // one copy per frame in flight, plus the one being written
+    constexpr static uint32_t framesInFlight = 3;
+
+protected:
+    struct Copy {
+        RGLBufferPtr buffer;
+        void* mapped = nullptr;
+        uint32_t capacity = 0;      // in elements
+    };
+    std::array<Copy, framesInFlight> copies;
+    uint32_t current = 0;
+    uint32_t nValues = 0;
+    uint32_t stride = 0;
+    std::string debugName;
+    MemoryTracking::Pool* memoryPool = nullptr;
+
+    void Begin(RGLDevicePtr device, uint64_t frameCount, uint32_t numElements);
+
+public:
+    UploadRingBase(std::string_view debugName, uint32_t stride) : stride(stride), debugName(debugName) {}
+    ~UploadRingBase();
+
+    MOVE_NO_COPY(UploadRingBase);
+
+    /**
+     Tell the GPU that elements were written. On memory that is not coherent with the GPU, writes are not visible to it until they are flushed.
+     @param first the first element written
+     @param count the number of elements written
+     */
+    void FlushRange(uint32_t first, uint32_t count);
+
+    void FlushAll() {
+        FlushRange(0, nValues);
+    }
+
+    /**
+     @return this frame's copy, to bind directly. Valid until the next Begin.
+     */
+    RGLBufferPtr GetBuffer() const {
+        return copies[current].buffer;
+    }
+
+    uint32_t size() const {
+        return nValues;
+    }
+};
+
+/**
+ An array of per-frame data that the GPU reads straight from host-visible, write-combined memory, so there is no private
+ buffer to copy into and no tracking of which elements changed. Each frame writes to its own persistently mapped copy,
+ so writing never races with the GPU reading an earlier frame.
+ Use it for small data that is rewritten every frame. Because the memory is write-combined, write elements whole and never read them back.
+ */
+template<typename T>
+class UploadRingVector : public UploadRingBase {
+    static_assert(std::is_trivially_copyable_v<T>, "The GPU reads the elements as raw bytes");
+public:
+    UploadRingVector(std::string_view debugName) : UploadRingBase(debugName, sizeof(T)) {}
+
+    /**
+     Switch to this frame's copy, growing it to hold numElements. The contents are undefined until written this frame.
+     @param frameCount the RenderEngine's frame counter
+     */
+    void BeginFrame(RGLDevicePtr device, uint64_t frameCount, uint32_t numElements) {
+        Begin(device, frameCount, numElements);
+    }
+
+    T* data() {
+        return static_cast<T*>(copies[current].mapped);
+    }
+
+    T& operator[](uint32_t i) {
+        return data()[i];
+    }
+};
+
+}
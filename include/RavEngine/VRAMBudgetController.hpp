@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+
+namespace RavEngine {
+    /**
+     The steps the engine takes to fit in the VRAM budget, in the order they are taken. Each level includes the ones before it.
+     */
+    enum class VRAMPressureLevel : uint8_t {
+        None,
+        TextureMips,            // streaming textures give up their largest mips until usage is under budget
+        ShadowResolution,       // directional shadow cascades and shadow atlas tiles are allocated at half size
+        StaticShadowCache,      // the cached static shadow layers are released, so static casters are redrawn every frame
+        RenderTextureCameras,   // cameras that render to a RenderTexture stop rendering, and their targets keep their last image
+        Max = RenderTextureCameras
+    };
+
+    struct VRAMBudgetConfig {
+        float highWater = 0.9f;                 // take the next step when usage is over this fraction of the budget
+        float lowWater = 0.75f;                 // undo the last step when usage is under this fraction of the budget
+        uint16_t framesBetweenSteps = 30;       // released resources are destroyed some frames later, so a step takes time to show
+    };
+
+    /**
+     Picks how much the engine gives up to stay within the VRAM budget the OS grants it, from the usage and budget the device
+     reports each frame. Exceeding the budget gets the process's memory paged out or, on some drivers, the device lost. It steps
+     up one VRAMPressureLevel at a time while usage is over the high water mark, and back down while it is under the low water
+     mark, waiting between steps so the previous one can take effect.
+     */
+    class VRAMBudgetController {
+    public:
+        using Config = VRAMBudgetConfig;
+
+        VRAMBudgetController(const Config& config = {}) : config(config), framesSinceStep(config.framesBetweenSteps) {}
+
+        /**
+         Feed the usage of a frame
+         @param usageBytes the VRAM the process uses
+         @param budgetBytes the VRAM the OS lets the process use. Devices that do not report a budget pass 0, which is ignored.
+         @return the level to run the next frame at
+         */
+        VRAMPressureLevel Update(uint64_t usageBytes, uint64_t budgetBytes);
+
+        /**
+         Change the config, and start over from no pressure
+         */
+        void SetConfig(const Config& newConfig);
+
+        const Config& GetConfig() const {
+            return config;
+        }
+
+        VRAMPressureLevel GetLevel() const {
+            return level;
+        }
+
+        bool IsAtLeast(VRAMPressureLevel other) const {
+            return level >= other;
+        }
+
+        /**
+         @return how far usage was over the high water mark on the last update, in bytes, or 0 if it was under
+         */
+        uint64_t GetOverageBytes() const {
+            return overageBytes;
+        }
+
+    private:
+        Config config;
+        VRAMPressureLevel level = VRAMPressureLevel::None;
+        uint16_t framesSinceStep;
+        uint64_t overageBytes = 0;
+    };
+}
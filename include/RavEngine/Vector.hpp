@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "unordered_vector.hpp"
+#include "small_vector.hpp"
 
 namespace RavEngine{
 
@@ -10,4 +11,11 @@ namespace RavEngine{
     template<typename T>
     using UnorderedVector = unordered_vector<T,Vector<T>>;
 
+    // for per-entity lists that rarely hold more than N elements
+    template<typename T, uint32_t N>
+    using SmallVector = small_vector<T,N>;
+
+    template<typename T, uint32_t N>
+    using SmallUnorderedVector = unordered_vector<T,small_vector<T,N>>;
+
 }
@@ -5,11 +5,74 @@
 #include "Vector.hpp"
 #include "Utilities.hpp"
 #include "Debug.hpp"
+#include "Stream.hpp"
 #include <span>
+#include <algorithm>
 
 struct PHYSFS_File;
 
 namespace RavEngine{
+
+/**
+ A read-only view of a file's bytes, valid while this is alive. Loose files on disk and files stored uncompressed in an
+ asset pack are memory-mapped, other files are read into memory.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    std::span<const std::byte> Data() const{
+        return data;
+    }
+
+    /**
+     @return true if the bytes are mapped from the file, false if they were read into memory
+     */
+    bool IsMapped() const{
+        return mapping != nullptr;
+    }
+
+private:
+    friend class VirtualFilesystem;
+    std::span<const std::byte> data;
+    Vector<std::byte> owned;        // used if the file could not be mapped
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+
+    void Release();
+};
+
+/**
+ Reads a file in the VFS incrementally, for parsing large assets without holding all of them in memory
+ */
+class VirtualFileStream : public IStream {
+public:
+    VirtualFileStream(VirtualFileStream&& other) noexcept;
+    VirtualFileStream& operator=(VirtualFileStream&& other) noexcept;
+    VirtualFileStream(const VirtualFileStream&) = delete;
+    VirtualFileStream& operator=(const VirtualFileStream&) = delete;
+    ~VirtualFileStream();
+
+    IStreamResult read(std::span<std::byte> outData) final;
+
+    void reset() final;
+    void advance(size_t) final;
+
+    size_t size() final;
+    size_t current_pos() final;
+
+private:
+    friend class VirtualFilesystem;
+    VirtualFileStream(PHYSFS_File* file, size_t length) : file(file), length(length){}
+    PHYSFS_File* file = nullptr;
+    size_t length = 0;
+};
+
 class VirtualFilesystem {
 private:
     struct ptrsize{
@@ -66,6 +129,39 @@ public:
         close(ptrsize.ptr);
     }
 
+    /**
+     Read only the start of a file, for example its header
+     @param path the resources path to the asset
+     @param data the buffer to fill
+     @return the number of bytes read, less than the size of data if the file is shorter
+     */
+    size_t FilePrefixAt(const char* path, std::span<uint8_t> data){
+        auto fullpath = Format("{}/{}",rootname,path);
+        
+        if(!Exists(path)){
+            Debug::Fatal("cannot open {}",fullpath);
+        }
+        
+        auto ptrsize = GetSizeAndPtr(fullpath.c_str());
+        size_t length_read = ReadInto(ptrsize.ptr, data.data(), std::min(data.size(), ptrsize.size));
+        close(ptrsize.ptr);
+        return length_read;
+    }
+
+    /**
+     Get a read-only view of the file data, without copying it when the file can be memory-mapped
+     @param path the resources path to the asset
+     @return the view. Unlike FileContentsAt, it is not null terminated.
+     */
+    MappedFile MapFile(const char* path);
+
+    /**
+     Open a file to read in pieces
+     @param path the resources path to the asset
+     @param chunkSize reads are served from a buffer refilled this many bytes at a time
+     */
+    VirtualFileStream OpenStream(const char* path, size_t chunkSize = 64 * 1024);
+
 	/**
 	 @return true if the VFS has the file at the path
 	 */
@@ -24,8 +24,15 @@ namespace RavEngine {
 			RGL::ITexture* texture;
 			RGL::SwapchainPresentConfig presentConfig;
 		};
-        void QueueGetNextSwapchainImage(RGL::SwapchainPresentConfig&);
-		SwapchainResult BlockGetNextSwapchainImage(const RGL::SwapchainPresentConfig& );
+
+		// block until the display can take another frame within RenderEngine::VideoSettings.maxFrameLatency
+		void WaitForFrameLatency();
+
+		// block until the GPU has finished the last frame submitted with swapchainFence
+		void WaitForPreviousFrame();
+
+		// acquire the image to render the frame into. Acquiring can block, so do it as late as possible.
+		SwapchainResult AcquireNextSwapchainImage();
 
 		dim_t<int> windowdims;
         
@@ -15,12 +15,23 @@
 #include "Types.hpp"
 #include "PolymorphicIndirection.hpp"
 #include "SparseSet.hpp"
+#include "PagedSparseArray.hpp"
+#include "SpatialIndex.hpp"
+#include "TimerWheel.hpp"
+#include <span>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <array>
+#include <chrono>
 #if !RVE_SERVER
     #include "VRAMSparseSet.hpp"
     #include "BuiltinMaterials.hpp"
     #include "Light.hpp"
     #include "BufferedVRAMVector.hpp"
+    #include "UploadRingVector.hpp"
     #include "BufferPool.hpp"
+    #include "OffsetAllocator.hpp"
 #else
     #include "Ref.hpp"
 #endif
@@ -33,28 +44,22 @@
 #include "Layer.hpp"
 #include "Profile.hpp"
 #include "Validator.hpp"
+#include "MemoryTracking.hpp"
+#include "PerfCounters.hpp"
+#include "sorted_vector_map.hpp"
 
 #if !RVE_SERVER
 namespace RavEngine {
     struct MaterialSort {
         Ref<MaterialInstance> mat;
+        const Material* baseMaterial;   // instances of one Material share pipelines, so they are kept adjacent
         MaterialSort(const decltype(mat)& mat) : mat(mat) {
             assert(mat != nullptr);
+            baseMaterial = mat->GetMat()->GetBaseMaterial();
         }
         bool operator<(const MaterialSort& other) const {
-            constexpr auto make128key = [](const auto & mat) {
-                using int128 = std::ranges::range_difference_t<std::ranges::iota_view<long long, long long>>;
-                // put priority in the high bits
-                int128 key = mat->GetPriority();
-                key <<= 64;
-                auto ptr = mat.get();
-                key |= uintptr_t(ptr);
-                return key;
-            };
-            auto key1 = make128key(mat);
-            auto key2 = make128key(other.mat);
-       
-            return key1 < key2;
+            // priority first, then pipeline, then the instance's own bindings
+            return std::tuple(mat->GetPriority(), uintptr_t(baseMaterial), uintptr_t(mat.get())) < std::tuple(other.mat->GetPriority(), uintptr_t(other.baseMaterial), uintptr_t(other.mat.get()));
         }
         bool operator==(const MaterialSort& other) const = default;
     };
@@ -77,6 +82,9 @@ namespace RavEngine {
 	struct PhysicsCallback;
 	struct StaticMesh;
 	struct SkinnedMeshComponent;
+    class InstancedStaticMesh;
+    struct Transform;
+    struct SpatialBoundsComponent;
     struct RenderEngine;
     struct Skybox;
     struct PhysicsSolver;
@@ -90,6 +98,7 @@ namespace RavEngine {
     struct AudioMeshComponent;
     struct MeshCollectionStatic;
     struct MeshCollectionSkinned;
+    class EntityCommandBuffer;
     class World;
 
     template <typename T, typename... Ts>
@@ -144,6 +153,35 @@ namespace RavEngine {
         a.after((World*)nullptr);
     };
 
+    // systems that declare `constexpr static bool filterChanged = true` only visit rows changed since their previous run
+    template<typename T>
+    concept SystemFiltersChanged = requires {
+        requires T::filterChanged;
+    };
+
+    // true if the query function takes T by mutable reference
+    template<typename T, typename argtuple>
+    struct IsMutableQueryArg;
+
+    template<typename T, typename ... Ts>
+    struct IsMutableQueryArg<T, std::tuple<Ts...>> : std::disjunction<std::is_same<Ts, T&>...> {};
+
+    using change_tick_t = uint32_t;
+
+    /**
+     Assigns small, dense indices to component types the first time each type is used,
+     so that a World can locate a type's storage with an array load instead of a locked hash lookup.
+     */
+    struct ComponentTypeRegistry {
+        template<typename T>
+        static uint32_t IndexFor() {
+            static const uint32_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+    private:
+        static std::atomic<uint32_t> nextIndex;
+    };
+
     struct WorldDataProvider {
         World* world;
     };
@@ -180,6 +218,7 @@ namespace RavEngine {
 	class World : public std::enable_shared_from_this<World> {
 		friend class AudioPlayer;
 		friend class App;
+		friend class ScriptSystem;
         friend class PhysicsBodyComponent;
         Queue<entity_id_t> available;
         Vector<uint8_t> versions;
@@ -208,14 +247,64 @@ namespace RavEngine {
         
         friend class Entity;
         friend class Registry;
+        friend struct Transform;
+        friend struct SpatialBoundsComponent;
     public:
+        struct OwningGroup;
+
+        // the part of an EntitySparseSet that does not depend on the component type, so polymorphic queries can read it directly
+        struct EntitySparseSetErased{
+        protected:
+            PagedSparseArray<entity_id_t> sparse_set;
+            std::byte* denseData = nullptr;     // dense_set.data(), refreshed after every change to the dense set
+            const entity_id_t* ownerData = nullptr;     // the owner of each dense row, refreshed with denseData
+            entity_id_t rowCount = 0;
+        public:
+            inline std::byte* GetErasedComponent(entity_id_t local_id, uint32_t stride) const{
+                assert(sparse_set.Contains(local_id));
+                return denseData + size_t(sparse_set[local_id]) * stride;
+            }
+
+            // so that a query can drive its iteration from whichever of its sets is smallest
+            inline entity_id_t ErasedSize() const{
+                return rowCount;
+            }
+            inline entity_id_t ErasedOwner(entity_id_t denseIdx) const{
+                return ownerData[denseIdx];
+            }
+            inline bool ErasedHas(entity_id_t local_id) const{
+                return sparse_set.Contains(local_id);
+            }
+            inline entity_id_t ErasedDenseIndex(entity_id_t local_id) const{
+                assert(sparse_set.Contains(local_id));
+                return sparse_set[local_id];
+            }
+        };
+
         template<typename T>
-        class EntitySparseSet{
+        class EntitySparseSet : public EntitySparseSetErased{
             unordered_vector<T> dense_set;
             UnorderedVector<entity_id_t> aux_set;
-            Vector<entity_id_t> sparse_set{INVALID_ENTITY};
+            
+            uint32_t structureVersion = 0;  // advanced whenever rows are added, removed or reordered
+            uint32_t relocationVersion = 0; // advanced whenever existing components move in memory, see CachedComponentHandle
+
+            inline void RefreshDenseData(){
+                const auto data = reinterpret_cast<std::byte*>(const_cast<T*>(dense_set.data()));
+                if (data != denseData){
+                    relocationVersion++;
+                    denseData = data;
+                }
+                ownerData = aux_set.data();
+                rowCount = static_cast<entity_id_t>(dense_set.size());
+            }
             
         public:
+            // world change tick at which each dense row was last written, parallel to dense_set
+            Vector<change_tick_t> change_set;
+        public:
+            // if non-null, the group that controls the ordering of the front of dense_set
+            OwningGroup* owningGroup = nullptr;
             
             using const_iterator = typename decltype(dense_set)::const_iterator_type;
             
@@ -223,50 +312,125 @@ namespace RavEngine {
             inline T& Emplace(entity_id_t local_id, A&& ... args){
                 auto& ret = dense_set.emplace(std::forward<A>(args)...);
                 aux_set.emplace(local_id);
-                if (local_id >= sparse_set.size()){
-                    sparse_set.resize(closest_multiple_of<int>(local_id+1,2),INVALID_ENTITY);  //ensure there is enough space for this id
-                }
-                
-				sparse_set[local_id] = static_cast<typename decltype(sparse_set)::value_type>(dense_set.size()-1);
+                change_set.push_back(0);
+                sparse_set.Set(local_id, static_cast<entity_id_t>(dense_set.size()-1));
+                structureVersion++;
+                RefreshDenseData();
                 return ret;
             }
             
             inline void Destroy(entity_id_t local_id){
-                assert(local_id < sparse_set.size());
                 assert(HasComponent(local_id)); // Cannot destroy a component on an entity that does not have one!
                 // call the destructor
                 if constexpr(HasDestroy<T>::value){
                     auto& oldvalue = GetComponent(local_id);
                     oldvalue.Destroy();
                 }
-                dense_set.erase(dense_set.begin() + sparse_set[local_id]);
-                aux_set.erase(aux_set.begin() + sparse_set[local_id]);
+                const auto denseidx = sparse_set[local_id];
+                dense_set.erase(dense_set.begin() + denseidx);
+                aux_set.erase(aux_set.begin() + denseidx);
+                change_set[denseidx] = change_set.back();   // mirror the unordered erase
+                change_set.pop_back();
 
-                if (sparse_set[local_id] < aux_set.size()) {    // did a move happen during this deletion?
+                if (denseidx < aux_set.size()) {    // did a move happen during this deletion?
                     // update the location it points
-                    auto owner = aux_set[sparse_set[local_id]];
-                    sparse_set[owner] = sparse_set[local_id];
+                    auto owner = aux_set[denseidx];
+                    sparse_set.Set(owner, denseidx);
                     
                 }
-                sparse_set[local_id] = INVALID_INDEX;
+                sparse_set.Set(local_id, INVALID_ENTITY);
+                structureVersion++;
+                relocationVersion++;
+                RefreshDenseData();
             }
 
             inline T& GetComponent(entity_id_t local_id){
                 assert(HasComponent(local_id));
                 return dense_set[sparse_set[local_id]];
             }
+
+            /**
+             Grow storage once ahead of a batch of Emplace calls
+             @param additional the number of components about to be added
+             @param maxLocalID the highest entity ID that will be emplaced
+             */
+            inline void Reserve(size_t additional, entity_id_t maxLocalID){
+                dense_set.reserve(dense_set.size() + additional);
+                aux_set.reserve(aux_set.size() + additional);
+                change_set.reserve(change_set.size() + additional);
+                sparse_set.Reserve(maxLocalID);
+                RefreshDenseData();
+            }
             
             inline auto SparseToDense(entity_t local_id){
                 return sparse_set[local_id.id];
             }
+
+            inline auto DenseIndexForEntity(entity_id_t local_id) const{
+                assert(HasComponent(local_id));
+                return sparse_set[local_id];
+            }
+
+            /**
+             Move the component owned by local_id to a dense index, swapping it with the component currently stored there.
+             */
+            inline void SwapIntoDenseIndex(entity_id_t local_id, entity_id_t dest){
+                assert(HasComponent(local_id));
+                assert(dest < dense_set.size());
+                const auto src = sparse_set[local_id];
+                if (src == dest){
+                    return;
+                }
+                std::swap(dense_set[src], dense_set[dest]);
+                const auto displacedOwner = aux_set[dest];
+                std::swap(aux_set[src], aux_set[dest]);
+                std::swap(change_set[src], change_set[dest]);
+                sparse_set.Set(local_id, dest);
+                sparse_set.Set(displacedOwner, src);
+                structureVersion++;
+                relocationVersion++;
+            }
             
+            /**
+             Fill an empty set from raw row data, as written by World::SaveSnapshot
+             @param owners count entity IDs, in dense order
+             @param components count tightly packed components
+             @param tick the change tick to give every row
+             */
+            inline void LoadDense(const std::byte* owners, const std::byte* components, entity_id_t count, change_tick_t tick){
+                static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>, "Only trivially copyable components can be loaded from raw data");
+                assert(dense_set.empty());
+                auto& dense = dense_set.get_underlying();
+                dense.resize(count);
+                std::memcpy(dense.data(), components, size_t(count) * sizeof(T));
+                auto& auxDense = aux_set.get_underlying();
+                auxDense.resize(count);
+                std::memcpy(auxDense.data(), owners, size_t(count) * sizeof(entity_id_t));
+                change_set.assign(count, tick);
+                entity_id_t maxID = 0;
+                for (const auto owner : auxDense){
+                    maxID = std::max(maxID, owner);
+                }
+                sparse_set.Reserve(maxID);
+                for (entity_id_t i = 0; i < count; i++){
+                    sparse_set.Set(auxDense[i], i);
+                }
+                structureVersion++;
+                relocationVersion++;
+                RefreshDenseData();
+            }
+
+            inline const entity_id_t* GetOwnerData() const{
+                return aux_set.data();
+            }
+
             inline T& GetFirst(){
                 assert(!dense_set.empty());
                 return dense_set[0];
             }
             
             inline bool HasComponent(entity_id_t local_id) const{
-                return local_id < sparse_set.size() && sparse_set[local_id] != INVALID_ENTITY;
+                return sparse_set.Contains(local_id);
             }
             
             auto begin(){
@@ -293,11 +457,34 @@ namespace RavEngine {
             auto GetOwner(entity_id_t idx) const{
                 return aux_set[idx];
             }
+
+            inline void MarkChangedAtDense(entity_id_t idx, change_tick_t tick){
+                change_set[idx] = tick;
+            }
+
+            inline void MarkChangedForEntity(entity_id_t local_id, change_tick_t tick){
+                change_set[DenseIndexForEntity(local_id)] = tick;
+            }
+
+            /**
+             @return the world change tick at which the row at this dense index was last written
+             */
+            inline change_tick_t GetChangeTickAtDense(entity_id_t idx) const{
+                return change_set[idx];
+            }
             
             auto DenseSize() const{
                 return dense_set.size();
             }
             
+            inline auto GetStructureVersion() const{
+                return structureVersion;
+            }
+
+            inline const uint32_t* GetRelocationVersion() const{
+                return &relocationVersion;
+            }
+            
             auto GetDenseData() const{
                 return dense_set.data();
             }
@@ -305,14 +492,31 @@ namespace RavEngine {
             inline const decltype(dense_set)& GetDense() const{
                 return dense_set;
             }
+
+            /**
+             @return the bytes allocated by this set, including reserved but unused capacity
+             */
+            size_t AllocatedBytes() const{
+                return dense_set.capacity() * sizeof(T) + aux_set.capacity() * sizeof(entity_id_t) + change_set.capacity() * sizeof(change_tick_t) + sparse_set.AllocatedBytes();
+            }
         };
     private:
         class AnySparseSet{
             constexpr static size_t buf_size = sizeof(EntitySparseSet<size_t>);   // we use size_t here because all SparseSets are the same size
             std::array<char, buf_size> buffer;
-            Function<void(AnySparseSet*,entity_t,World*)> _impl_destroyFn;
-            Function<void(AnySparseSet*)> _impl_deallocFn;
+            void (*_impl_destroyFn)(AnySparseSet*,entity_t,World*) = nullptr;
+            void (*_impl_deallocFn)(AnySparseSet*) = nullptr;
+            size_t (*_impl_allocatedBytesFn)(const AnySparseSet*) = nullptr;
+            size_t (*_impl_denseSizeFn)(const AnySparseSet*) = nullptr;
         public:
+            std::string_view typeName;      // for memory reports
+
+            size_t AllocatedBytes() const{
+                return _impl_allocatedBytesFn(this);
+            }
+            size_t DenseSize() const{
+                return _impl_denseSizeFn(this);
+            }
             // avoid capture overhead by wrapping
             void destroyFn(entity_t id, World* world){
                 _impl_destroyFn(this, id, world);
@@ -337,7 +541,14 @@ namespace RavEngine {
                 }),
                 _impl_deallocFn([](AnySparseSet* thisptr) {
                     thisptr->GetSet<T>()->~EntitySparseSet<T>();
-                })
+                }),
+                _impl_allocatedBytesFn([](const AnySparseSet* thisptr) {
+                    return reinterpret_cast<const EntitySparseSet<T>*>(thisptr->buffer.data())->AllocatedBytes();
+                }),
+                _impl_denseSizeFn([](const AnySparseSet* thisptr) -> size_t {
+                    return reinterpret_cast<const EntitySparseSet<T>*>(thisptr->buffer.data())->DenseSize();
+                }),
+                typeName(type_name<T>())
             {
                 static_assert(sizeof(EntitySparseSet<T>) <= buf_size);
                 new (buffer.data()) EntitySparseSet<T>();
@@ -348,18 +559,95 @@ namespace RavEngine {
             }
         };
         
-		locked_node_hashmap<RavEngine::ctti_t, AnySparseSet,SpinLock> componentMap;
+		locked_node_hashmap<RavEngine::ctti_t, AnySparseSet,NamedSpinLock<"World::componentMap">> componentMap;
+
+        // componentMap nodes indexed by ComponentTypeRegistry index. Types beyond the table fall back to componentMap.
+        constexpr static uint32_t maxIndexedComponentTypes = 512;
+        std::array<std::atomic<AnySparseSet*>, maxIndexedComponentTypes> indexedComponentSets{};
+
+        /**
+         @return the storage for T, or nullptr if no component of type T has been created in this world
+         */
+        template<typename T>
+        inline EntitySparseSet<T>* GetSetIfExists(){
+            const auto index = ComponentTypeRegistry::IndexFor<T>();
+            if (index < maxIndexedComponentTypes) [[likely]] {
+                auto set = indexedComponentSets[index].load(std::memory_order_acquire);
+                return set ? set->template GetSet<T>() : nullptr;
+            }
+            auto it = componentMap.find(RavEngine::CTTI<T>());
+            return it != componentMap.end() ? (*it).second.template GetSet<T>() : nullptr;
+        }
+
+    public:
+        /**
+         An owning group keeps the first `size` elements of each owned sparse set in the same order,
+         so that row N of every set belongs to the same entity. Queries that exactly match the group's types
+         iterate it linearly without per-entity validity checks.
+         */
+        struct OwningGroup{
+            Vector<ctti_t> types;
+            pos_t size = 0;
+            Function<void(entity_id_t)> tryAdd, remove;
+        };
+    private:
+        Vector<std::unique_ptr<OwningGroup>> owningGroups;
 
 #if !RVE_SERVER
         friend class StaticMesh;
         friend class SkinnedMeshComponent;
+        friend class InstancedStaticMesh;
         friend class RenderEngine;
         // renderer-friendly representation of static meshes
         struct MDICommandBase {
             RGLBufferPtr indirectBuffer, cullingBuffer, indirectStagingBuffer, cuboBuffer, cuboStagingBuffer;
+            // the surviving commands of each slice of indirectBuffer, and how many there are per view. Only used if the device supports indirect-count draws.
+            RGLBufferPtr compactedIndirectBuffer, drawCountBuffer;
+            // per-mesh culling inputs, which do not depend on the view. Rebuilt only when cullingLayout changes.
+            Vector<std::byte> cachedCubos;
+            size_t cullingLayout = 0;
+            // the indirect buffer and the culling buffer hold one slice of this many entries per culled view
+            uint32_t numDrawSlots = 0, cullingViewStride = 0;
+            MDICommandBase() = default;
+            MOVE_NO_COPY(MDICommandBase);    // moved when the render data map inserts or erases a material
             ~MDICommandBase();
         };
 
+        // maps a mesh (and skeleton) to its position in an unordered_vector of commands, so lookups don't search
+        template<typename key_t>
+        struct MDICommandIndex {
+            UnorderedMap<key_t, uint32_t> indexForKey;
+            Vector<key_t> keyForIndex;      // parallel to the commands
+
+            template<typename commands_t>
+            auto Find(commands_t& commands, const key_t& key) -> typename commands_t::value_type* {
+                auto it = indexForKey.find(key);
+                return it != indexForKey.end() ? &commands[it->second] : nullptr;
+            }
+
+            template<typename commands_t, typename ... A>
+            auto& Emplace(commands_t& commands, const key_t& key, A&& ... args) {
+                assert(!indexForKey.contains(key));
+                indexForKey[key] = static_cast<uint32_t>(commands.size());
+                keyForIndex.push_back(key);
+                return commands.emplace(std::forward<A>(args)...);
+            }
+
+            template<typename commands_t>
+            void Erase(commands_t& commands, const key_t& key) {
+                const auto index = indexForKey.at(key);
+                indexForKey.erase(key);
+                // unordered_vector moves the last command into the erased slot
+                const auto last = static_cast<uint32_t>(commands.size() - 1);
+                if (index != last) {
+                    keyForIndex[index] = keyForIndex[last];
+                    indexForKey[keyForIndex[index]] = index;
+                }
+                keyForIndex.pop_back();
+                commands.erase(commands.begin() + index);
+            }
+        };
+
         struct MDIICommand : public MDICommandBase {
             struct command {
                 WeakRef<MeshCollectionStatic> mesh;
@@ -370,6 +658,8 @@ namespace RavEngine {
                 }
             };
             unordered_vector<command> commands;
+            using key_t = const MeshCollectionStatic*;
+            MDICommandIndex<key_t> commandIndex;
         };
 
         struct MDIICommandSkinned : public MDICommandBase {
@@ -381,8 +671,33 @@ namespace RavEngine {
                 command(decltype(mesh) mesh, decltype(skeleton) skeleton, set_t::index_type index, const set_t::value_type& first_value) : mesh(mesh), skeleton(skeleton) {
                     entities.Emplace(index, first_value);
                 }
+
+                // The slots of a command, in RenderEngine::skinnedOutputAllocator. It only moves when the command outgrows it
+                // or shrinks well below it, so instances coming and going in other commands do not move these vertices.
+                struct OutputRegion {
+                    OffsetAllocator::Allocation allocation;
+                    uint32_t capacity = 0;          // in slots
+                    OutputRegion() = default;
+                    OutputRegion(OutputRegion&& other) noexcept : allocation(std::exchange(other.allocation, {})), capacity(std::exchange(other.capacity, 0)) {}
+                    OutputRegion& operator=(OutputRegion&& other) noexcept {
+                        std::swap(allocation, other.allocation);
+                        std::swap(capacity, other.capacity);
+                        return *this;
+                    }
+                    ~OutputRegion();                // returns the region to the render engine
+                };
+
+                // Skinned vertices are kept between frames. Each entity (by dense index) has an output slot, and draws from
+                // outputSlots[i], which is another entity's slot when both are in the same pose.
+                Vector<uint64_t> slotPoses;         // the pose hash each slot holds, 0 if it holds nothing usable
+                Vector<entity_id_t> slotOwners;     // the entity each slot was skinned for
+                Vector<uint32_t> outputSlots;
+                OutputRegion outputRegion;
+                uint32_t outputVertexOffset = 0;    // where the slots begin in the shared skinned vertex buffers
             };
             unordered_vector<command> commands;
+            using key_t = std::pair<const MeshCollectionSkinned*, const SkeletonAsset*>;
+            MDICommandIndex<key_t> commandIndex;
         };
     
         struct DirLightUploadData {
@@ -391,19 +706,21 @@ namespace RavEngine {
             float intensity;
             int castsShadows;
             int shadowmapBindlessIndex[MAX_CASCADES]{0};
-            float cascadeDistances[MAX_CASCADES]{0};
             renderlayer_t shadowLayers;
             renderlayer_t illuminationLayers;
-            uint32_t numCascades;
         };
         
+        // cameras can render fewer cascades than the light has, see CameraFeatureSettings
         struct DirLightUploadDataPassVarying{
             glm::mat4 lightViewProj[MAX_CASCADES];
+            float cascadeDistances[MAX_CASCADES]{0};
+            uint32_t numCascades = 0;
         };
         
         struct DirLightUploadDataPassVaryingHostOnly{
             glm::mat4 lightview[MAX_CASCADES];
             glm::mat4 lightProj[MAX_CASCADES];
+            DirLightUploadDataPassVarying varying;     // readable copy of what was uploaded
         };
         
         struct AmbientLightUploadData{
@@ -421,7 +738,8 @@ namespace RavEngine {
             int castsShadows;
             renderlayer_t shadowLayers;
             renderlayer_t illuminationLayers;
-            int shadowmapBindlessIndices[6]{ 0 };
+            uint32_t shadowmapBindlessIndex = 0;     // the shadow atlas, written by the RenderEngine
+            glm::vec4 shadowAtlasRects[6]{};        // per face: the offset (xy) and size (zw) of its tile, in atlas UVs. Empty if the face has no tile.
         };
 
         struct SpotLightDataUpload {
@@ -435,6 +753,7 @@ namespace RavEngine {
             uint32_t shadowmapBindlessIndex;
             renderlayer_t shadowLayers;
             renderlayer_t illuminationLayers;
+            glm::vec4 shadowAtlasRect{ 0 };      // see PointLightUploadData::shadowAtlasRects
         };
 
         // data for the render engine
@@ -448,7 +767,8 @@ namespace RavEngine {
              
             BufferedVRAMSparseSet<entity_id_t, SpotLightDataUpload> spotLightData{"Point Light Private Buffer"};
             
-            BufferedVRAMVector<DirLightUploadDataPassVarying> directionalLightPassVarying{"Directional Light Pass Varying Buffer"};
+            // rewritten every frame, so the GPU reads it from upload memory instead of through a synced private buffer
+            UploadRingVector<DirLightUploadDataPassVarying> directionalLightPassVarying{"Directional Light Pass Varying Buffer"};
             
             Vector<DirLightUploadDataPassVaryingHostOnly> directionalLightPassVaryingHostOnly;
             
@@ -462,8 +782,9 @@ namespace RavEngine {
             BufferedVRAMVector<matrix4> worldTransforms{"World Transform Private Buffer"};
 
 
-            OrderedMap<MaterialSort, MDIICommand> staticMeshRenderData;
-            OrderedMap<MaterialSort, MDIICommandSkinned> skinnedMeshRenderData;
+            // iterated in full for every view and shadow map, but only change when a material gains its first or loses its last mesh
+            sorted_vector_map<MaterialSort, MDIICommand> staticMeshRenderData;
+            sorted_vector_map<MaterialSort, MDIICommandSkinned> skinnedMeshRenderData;
 
             RGLBufferPtr cuboBuffer;
 
@@ -475,6 +796,10 @@ namespace RavEngine {
         void updateStaticMeshMaterial(entity_t localId, Ref<MaterialInstance> oldMat, Ref<MaterialInstance> newMat, Ref<MeshCollectionStatic> mesh);
         void updateSkinnedMeshMaterial(entity_t localId, Ref<MaterialInstance> oldMat, Ref<MaterialInstance> newMat, Ref<MeshCollectionSkinned> mesh, Ref<SkeletonAsset> skeleton);
         void StaticMeshChangedVisibility(const StaticMesh*);
+        // instance batches draw through staticMeshRenderData, using bare entity IDs as render slots
+        void AddInstancedMeshRenderData(std::span<const entity_t> slots, Ref<MaterialInstance> mat, Ref<MeshCollectionStatic> mesh);
+        void RemoveInstancedMeshRenderData(std::span<const entity_t> slots, Ref<MaterialInstance> mat, Ref<MeshCollectionStatic> mesh);
+        void ReleaseInstanceSlots(std::span<const entity_t> slots);
         void SkinnedMeshChangedVisibility(const SkinnedMeshComponent*);
 #endif
         
@@ -494,43 +819,40 @@ namespace RavEngine {
         }
         
         struct PolymorphicIndirection{
+            // one concrete component type on the owner. Reading it is an index into that type's dense storage, no type-erased call
             struct elt{
-                Function<void*(entity_t)> getfn;
+                const EntitySparseSetErased* set = nullptr;
+                uint32_t stride = 0;            // sizeof the concrete type
                 ctti_t full_id = 0;
                 template<typename T>
-                elt(World* world, T* discard) : full_id(CTTI<T>()){
-                    auto setptr = world->componentMap.at(CTTI<T>()).template GetSet<T>();
-                    getfn = [setptr](entity_t local_id) -> void*{
-                        auto& thevalue = setptr->GetComponent(local_id.id);
-                        return &(thevalue);
-                    };
+                elt(World* world, T* discard) : set(world->template GetSetIfExists<T>()), stride(sizeof(T)), full_id(CTTI<T>()){
+                    assert(set);
                 }
                 
+                // queried base types are at the start of the concrete type, as with the static_cast from the concrete pointer this replaces
                 template<typename T>
-                T* Get(entity_t local_id){
-                    return static_cast<T*>(getfn(local_id));
+                T* Get(entity_t local_id) const{
+                    return reinterpret_cast<T*>(set->GetErasedComponent(local_id.id, stride));
                 }
                 
                 inline bool operator==(const elt& other) const{
                     return full_id == other.full_id;
                 }
             };
-            UnorderedVector<elt> elts;
+            SmallUnorderedVector<elt, 2> elts;     // an entity rarely has more than a couple of components of one base
             entity_t owner = {INVALID_ENTITY};
             World* world = nullptr;
             
             template<typename T>
             inline void push(){
                 T* discard = nullptr;
-                assert(std::find(elts.begin(),elts.end(),elt(world,discard)) ==elts.end());  // no duplicates
+                assert(std::find_if(elts.begin(),elts.end(),[](const elt& e){ return e.full_id == CTTI<T>(); }) == elts.end());  // no duplicates
                 elts.emplace(world,discard);
             }
             
             template<typename T>
             inline void erase(){
-                T* discard = nullptr;
-                elt value_erase(world,discard);
-                auto it = std::find(elts.begin(),elts.end(),value_erase);
+                auto it = std::find_if(elts.begin(),elts.end(),[](const elt& e){ return e.full_id == CTTI<T>(); });
                 assert(it != elts.end());
                 elts.erase(it);
             }
@@ -582,7 +904,7 @@ namespace RavEngine {
         class SparseSetForPolymorphic{
             using U = PolymorphicIndirection;
             unordered_vector<U> dense_set;
-            Vector<entity_id_t> sparse_set{INVALID_ENTITY};
+            PagedSparseArray<entity_id_t> sparse_set;
             
         public:
             
@@ -594,10 +916,7 @@ namespace RavEngine {
                 //if a record for this does not exist, create it
                 if (!HasForEntity(local_id)){
                     dense_set.emplace(local_id_in,world);
-                    if (local_id >= sparse_set.size()){
-                        sparse_set.resize(closest_multiple_of<entity_id_t>(local_id+1,2),INVALID_ENTITY);  //ensure there is enough space for this id
-                    }
-                    sparse_set[local_id] = static_cast<decltype(sparse_set)::value_type>(dense_set.size()-1);
+                    sparse_set.Set(local_id, static_cast<entity_id_t>(dense_set.size()-1));
                 }
                 
                 // then push the Elt into it
@@ -617,9 +936,9 @@ namespace RavEngine {
 
                    if (denseidx < dense_set.size()) {    // did a move happen during this deletion?
                        auto ownerOfMoved = dense_set[denseidx].owner;
-                       sparse_set[ownerOfMoved.id] = denseidx;
+                       sparse_set.Set(ownerOfMoved.id, denseidx);
                    }
-                   sparse_set[local_id] = INVALID_INDEX;
+                   sparse_set.Set(local_id, INVALID_ENTITY);
                }
             }
 
@@ -640,7 +959,7 @@ namespace RavEngine {
 
             
             inline bool HasForEntity(entity_id_t local_id) const{
-                return local_id < sparse_set.size() && sparse_set[local_id] != INVALID_ENTITY;
+                return sparse_set.Contains(local_id);
             }
             
             auto begin(){
@@ -694,7 +1013,15 @@ namespace RavEngine {
         
         template<typename T>
         inline EntitySparseSet<T>* MakeIfNotExists(){
-            return (*componentMap.try_emplace(RavEngine::CTTI<T>(),static_cast<T*>(nullptr)).first).second.template GetSet<T>();
+            if (auto set = GetSetIfExists<T>()) [[likely]] {
+                return set;
+            }
+            auto& anySet = (*componentMap.try_emplace(RavEngine::CTTI<T>(),static_cast<T*>(nullptr)).first).second;
+            const auto index = ComponentTypeRegistry::IndexFor<T>();
+            if (index < maxIndexedComponentTypes) {
+                indexedComponentSets[index].store(&anySet, std::memory_order_release);     // nodes never move, so the pointer stays valid
+            }
+            return anySet.template GetSet<T>();
         }
         
         struct EntityRedir{
@@ -702,6 +1029,82 @@ namespace RavEngine {
             entity_t id;
             operator Entity() const;
         };
+
+        struct SnapshotWriter{
+            Vector<std::byte> bytes;
+            inline void Write(const void* data, size_t size){
+                const auto offset = bytes.size();
+                bytes.resize(offset + size);
+                std::memcpy(bytes.data() + offset, data, size);
+            }
+            template<typename V>
+            inline void Write(const V& value){
+                Write(&value, sizeof(value));
+            }
+        };
+
+        struct SnapshotReader{
+            std::span<const std::byte> bytes;
+            size_t offset = 0;
+            const std::byte* Take(size_t size);
+            template<typename V>
+            inline V Read(){
+                V value;
+                std::memcpy(&value, Take(sizeof(V)), sizeof(V));
+                return value;
+            }
+            inline bool AtEnd() const{
+                return offset == bytes.size();
+            }
+        };
+
+        // one component type's rows within a snapshot
+        struct SnapshotSection{
+            uint64_t type;
+            uint32_t stride;
+            entity_id_t count;
+            const std::byte* owners;
+            const std::byte* components;
+        };
+
+        void WriteSnapshotEntities(SnapshotWriter& writer) const;
+        void ReadSnapshotEntities(SnapshotReader& reader);
+        SnapshotSection ReadSnapshotSection(SnapshotReader& reader);
+        void FinishSnapshotLoad();
+
+        template<typename T>
+        inline void WriteSnapshotComponents(SnapshotWriter& writer){
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable components can be written to a snapshot");
+            static_assert(!HasQueryTypes<T>::value, "Components with polymorphic query types cannot be written to a snapshot");
+            auto set = GetSetIfExists<T>();
+            if (set == nullptr || set->DenseSize() == 0){
+                return;
+            }
+            const auto count = static_cast<entity_id_t>(set->DenseSize());
+            writer.Write(uint64_t(CTTI<T>()));
+            writer.Write(uint32_t(sizeof(T)));
+            writer.Write(count);
+            writer.Write(set->GetOwnerData(), size_t(count) * sizeof(entity_id_t));
+            writer.Write(set->GetDenseData(), size_t(count) * sizeof(T));
+        }
+
+        template<typename T>
+        inline bool ReadSnapshotComponents(const SnapshotSection& section){
+            if (section.type != CTTI<T>()){
+                return false;
+            }
+            if (section.stride != sizeof(T)){
+                Debug::Fatal("Snapshot stores {} with size {}, but it has size {}", type_name<T>(), section.stride, sizeof(T));
+            }
+            auto set = MakeIfNotExists<T>();
+            set->LoadDense(section.owners, section.components, section.count, changeTick);
+            if (set->owningGroup){
+                for (entity_id_t i = 0; i < section.count; i++){
+                    set->owningGroup->tryAdd(set->GetOwner(i));
+                }
+            }
+            return true;
+        }
                 
         template<typename T, typename ... A>
         inline T& EmplaceComponent(entity_t local_id, A&& ... args){
@@ -732,18 +1135,40 @@ namespace RavEngine {
             }
 #endif
             //detect if T constructor's first argument is an Entity, if it is, then we need to pass that before args (pass local_id again)
+            T* ret = nullptr;
             if constexpr(std::is_constructible<T,Entity, A...>::value || (sizeof ... (A) == 0 && std::is_constructible<T,Entity>::value)){
-                return ptr->Emplace(local_id.id, EntityRedir{this,local_id}, std::forward<A>(args)...);
+                ret = &ptr->Emplace(local_id.id, EntityRedir{this,local_id}, std::forward<A>(args)...);
             }
             else{
-                return ptr->Emplace(local_id.id,std::forward<A>(args)...);
+                ret = &ptr->Emplace(local_id.id,std::forward<A>(args)...);
             }
+            if (ptr->owningGroup) {
+                // joining the group moves the component, so re-fetch it
+                ptr->owningGroup->tryAdd(local_id.id);
+                ret = &ptr->GetComponent(local_id.id);
+            }
+            ptr->MarkChangedForEntity(local_id.id, changeTick);   // new components count as changed
+            return *ret;
         }
 
         template<typename T>
         inline T& GetComponent(entity_t local_id) {
             assert(CorrectVersion(local_id));
-            return componentMap.at(RavEngine::CTTI<T>()).template GetSet<T>()->GetComponent(local_id.id);
+            auto set = GetSetIfExists<T>();
+            assert(set);
+            return set->GetComponent(local_id.id);
+        }
+
+        /**
+         Like GetComponent, and also returns the relocation counter of T's set. The component stays at the same address until the counter changes.
+         */
+        template<typename T>
+        inline T& GetComponentForCache(entity_t local_id, const uint32_t*& relocationVersion) {
+            assert(CorrectVersion(local_id));
+            auto set = GetSetIfExists<T>();
+            assert(set);
+            relocationVersion = set->GetRelocationVersion();
+            return set->GetComponent(local_id.id);
         }
         
         template<typename T>
@@ -755,7 +1180,8 @@ namespace RavEngine {
         template<typename T>
         inline bool HasComponent(entity_t local_id) {
             assert(CorrectVersion(local_id));
-            return componentMap.at(RavEngine::CTTI<T>()).template GetSet<T>()->HasComponent(local_id.id);
+            auto set = GetSetIfExists<T>();
+            return set && set->HasComponent(local_id.id);
         }
         
         template<typename T>
@@ -770,7 +1196,8 @@ namespace RavEngine {
         template<typename T>
         inline void DestroyComponent(entity_t local_id){
 
-            auto setptr = componentMap.at(RavEngine::CTTI<T>()).template GetSet<T>();
+            auto setptr = GetSetIfExists<T>();
+            assert(setptr);
 
             if constexpr (std::is_same_v<T, StaticMesh>) {
                 // remove the entry from the render data structure
@@ -803,6 +1230,10 @@ namespace RavEngine {
             }
 #endif
             
+            if (setptr->owningGroup) {
+                // leave the group first so that the erase below does not disturb its ordering
+                setptr->owningGroup->remove(local_id.id);
+            }
             setptr->Destroy(local_id.id);
             // does this component have alternate query types
             if constexpr (HasQueryTypes<T>::value) {
@@ -816,8 +1247,9 @@ namespace RavEngine {
                 
         template<typename T>
         inline EntitySparseSet<T>* GetRange(){
-            auto& set = componentMap.at(RavEngine::CTTI<T>());
-            return set.template GetSet<T>();
+            auto set = GetSetIfExists<T>();
+            assert(set);
+            return set;
         }
         
         template<typename T, bool isPolymorphic = false>
@@ -847,6 +1279,40 @@ namespace RavEngine {
             return static_cast<EntitySparseSet<T>*>(ptr)->Get(denseidx);
         }
        
+        /**
+         @return the owning group if every type in the query is owned by the same group and the query covers the whole group, otherwise nullptr
+         */
+        template<typename ... A>
+        inline OwningGroup* FindOwningGroupForQuery(const std::array<void*, sizeof...(A)>& ptrs) const{
+            if constexpr (sizeof...(A) < 2){
+                return nullptr;
+            }
+            else{
+                using primary_t = typename std::tuple_element<0, std::tuple<A...> >::type;
+                auto group = static_cast<EntitySparseSet<primary_t>*>(ptrs[0])->owningGroup;
+                if (group == nullptr || group->types.size() != sizeof...(A)){
+                    return nullptr;
+                }
+                const bool allOwned = ((static_cast<EntitySparseSet<A>*>(ptrs[Index_v<A, A...>])->owningGroup == group) && ...);
+                return allOwned ? group : nullptr;
+            }
+        }
+
+        /**
+         @return the set to drive a non-polymorphic query from. Every match has a row in every set of the query, so this is the one with the fewest rows.
+         */
+        template<typename ... A>
+        inline const EntitySparseSetErased* SmallestSetForQuery(const std::array<void*, sizeof...(A)>& ptrs) const{
+            const EntitySparseSetErased* smallest = nullptr;
+            ([&] {
+                const EntitySparseSetErased* set = static_cast<EntitySparseSet<A>*>(ptrs[Index_v<A, A...>]);
+                if (smallest == nullptr || set->ErasedSize() < smallest->ErasedSize()) {
+                    smallest = set;
+                }
+            }(), ...);
+            return smallest;
+        }
+
         template<typename T, bool isPolymorphic = false>
         inline void* FilterGetSparseSet(){
             if constexpr (!isPolymorphic){
@@ -863,6 +1329,7 @@ namespace RavEngine {
         }
         
         entity_t CreateEntity();
+        void CreateEntities(pos_t count, Vector<entity_t>& outIDs);
         
         template<typename func, bool polymorphic>
         struct FuncMode{
@@ -928,8 +1395,54 @@ namespace RavEngine {
             return instance;
         };
                 
+        template<typename T, typename filterone_t>
+        static constexpr bool QueryWritesComponent(){
+            return IsMutableQueryArg<T, decltype(arguments(std::declval<filterone_t&>().fm.f))>::value;
+        }
+
+        // stamp the mutably-queried components of a row, addressed by dense index (single-type or grouped queries)
+        template<typename ... A, typename filterone_t>
+        inline void MarkQueryRowChangedDense(filterone_t& fom, entity_id_t denseIdx){
+            ([&] {
+                if constexpr (QueryWritesComponent<A, filterone_t>()) {
+                    static_cast<EntitySparseSet<A>*>(fom.ptrs[Index_v<A, A...>])->MarkChangedAtDense(denseIdx, changeTick);
+                }
+            }(), ...);
+        }
+
+        // stamp the mutably-queried components of a row, addressed by owning entity
         template<typename ... A, typename filterone_t>
-        inline void FilterOne(filterone_t& fom, entity_id_t i){
+        inline void MarkQueryRowChangedForEntity(filterone_t& fom, entity_id_t owner){
+            ([&] {
+                if constexpr (QueryWritesComponent<A, filterone_t>()) {
+                    static_cast<EntitySparseSet<A>*>(fom.ptrs[Index_v<A, A...>])->MarkChangedForEntity(owner, changeTick);
+                }
+            }(), ...);
+        }
+
+        /**
+         @return true if any queried component of the row at dense index i of the primary set was written at or after `since`.
+         Rows missing one of the queried components return false.
+         */
+        template<typename ... A, typename filterone_t>
+        inline bool QueryRowChangedSince(filterone_t& fom, entity_id_t i, bool grouped, change_tick_t since, const EntitySparseSetErased* primary){
+            static_assert(!filterone_t::isPolymorphic(), "Change filtering is not supported for polymorphic queries");
+            if (filterone_t::nTypes() == 1 || grouped) {
+                return ((static_cast<EntitySparseSet<A>*>(fom.ptrs[Index_v<A, A...>])->GetChangeTickAtDense(i) >= since) || ...);
+            }
+            const auto owner = primary->ErasedOwner(i);
+            return (([&] {
+                auto set = static_cast<EntitySparseSet<A>*>(fom.ptrs[Index_v<A, A...>]);
+                return set->HasComponent(owner) && set->GetChangeTickAtDense(set->DenseIndexForEntity(owner)) >= since;
+            }()) || ...);
+        }
+
+        /**
+         Visit row i of a query. For multi-type non-polymorphic queries, i is a dense index of primary, see SmallestSetForQuery.
+         Other queries iterate the set of their first type, and ignore primary.
+         */
+        template<typename ... A, typename filterone_t>
+        inline void FilterOne(filterone_t& fom, entity_id_t i, const EntitySparseSetErased* primary){
             using primary_t = typename std::tuple_element<0, std::tuple<A...> >::type;
             using dataProviderType = filterone_t::DataProvider_t;
             if constexpr(filterone_t::nTypes() == 1){
@@ -941,6 +1454,7 @@ namespace RavEngine {
                     else {
                         fom.fm.f(FilterComponentGetDirect<primary_t>(i, fom.ptrs[Index_v<primary_t, A...>]));
                     }
+                    MarkQueryRowChangedDense<A...>(fom, i);
                     
                 }
                 else{
@@ -961,7 +1475,7 @@ namespace RavEngine {
             else{
                 entity_id_t owner;
                 if constexpr (!filterone_t::isPolymorphic()) {
-                    owner = static_cast<EntitySparseSet<primary_t>*>(fom.ptrs[0])->GetOwner(i);
+                    owner = primary->ErasedOwner(i);
                 }
                 else {
                     owner = static_cast<SparseSetForPolymorphic*>(fom.ptrs[0])->GetOwnerForDenseIdx(i).id;
@@ -977,6 +1491,7 @@ namespace RavEngine {
                             else {
                                 fom.fm.f(FilterComponentGet<A>(owner, fom.ptrs[Index_v<A, A...>])...);
                             }
+                            MarkQueryRowChangedForEntity<A...>(fom, owner);
                             
                         }
                         else{
@@ -997,6 +1512,31 @@ namespace RavEngine {
             }
         }
                 
+        // row i of every set in an owning group belongs to the same entity, so no lookups or validity checks are needed
+        template<typename ... A, typename filterone_t>
+        inline void FilterOneGrouped(filterone_t& fom, entity_id_t i){
+            using dataProviderType = filterone_t::DataProvider_t;
+            if constexpr (IsEngineDataProvider<dataProviderType>) {
+                auto dp = MakeEngineDataProvider<dataProviderType>();
+                fom.fm.f(dp, FilterComponentGetDirect<A>(i, fom.ptrs[Index_v<A, A...>])...);
+            }
+            else {
+                fom.fm.f(FilterComponentGetDirect<A>(i, fom.ptrs[Index_v<A, A...>])...);
+            }
+            MarkQueryRowChangedDense<A...>(fom, i);
+        }
+
+        template<typename ... A, typename filterone_t>
+        inline void FilterOneMaybeGrouped(filterone_t& fom, entity_id_t i, bool grouped, const EntitySparseSetErased* primary){
+            if constexpr (!filterone_t::isPolymorphic() && filterone_t::nTypes() > 1) {
+                if (grouped) {
+                    FilterOneGrouped<A...>(fom, i);
+                    return;
+                }
+            }
+            FilterOne<A...>(fom, i, primary);
+        }
+
         template<typename ... A, typename funcmode>
         inline auto GenFilterData(const funcmode& fn){
             constexpr auto n_types = sizeof ... (A);
@@ -1012,7 +1552,7 @@ namespace RavEngine {
                         return static_cast<EntitySparseSet<primary_t>*>(ptrs[0]);
                     }
                     else{
-                        return static_cast<EntitySparseSet<PolymorphicIndirection>*>(ptrs[0]);
+                        return static_cast<SparseSetForPolymorphic*>(ptrs[0]);
                     }
                 }
             } data {FilterGetSparseSet<A,funcmode::isPolymorphic()>()...};
@@ -1036,29 +1576,161 @@ namespace RavEngine {
         // "unit test" to sanity check the templates above
         static_assert(std::is_same_v<remove_polymorphic_arg_t<float>, remove_polymorphic_arg_t<PolymorphicGetResult<float, World::PolymorphicIndirection>>>, "template failed");
 
-        template<typename funcmode_t>
-        inline void FilterGeneric(const funcmode_t& fm) {
+        template<bool onlyChanged = false, typename funcmode_t>
+        inline void FilterGeneric(const funcmode_t& fm, change_tick_t since = 0) {
             using argtypes = decltype(arguments(fm.f));
             // step 1: get it as types
-            [this,&fm] <typename... Ts>(std::type_identity<std::tuple<Ts...>>) -> void
+            [this,&fm,since] <typename... Ts>(std::type_identity<std::tuple<Ts...>>) -> void
             {
                 using argtypes_noref = std::tuple<remove_polymorphic_arg_t<std::remove_const_t<std::remove_reference_t<Ts>>>...>;
                 // step 2: get it as non-reference types, and slice off the first argument
                 // because it's a float and we don't want it
-                [this,&fm]<typename ... A>(std::type_identity<std::tuple<A...>>) -> void
+                [this,&fm,since]<typename ... A>(std::type_identity<std::tuple<A...>>) -> void
                 {
                     auto fd = GenFilterData<A...>(fm);
-                    auto mainFilter = fd.getMainFilter();
                     FilterOneMode fom(fm, fd.ptrs, std::type_identity<DataProviderNone>{});
-                    for (entity_id_t i = 0; i < mainFilter->DenseSize(); i++) {
-                        FilterOne<A...>(fom, i);
+                    if constexpr (!funcmode_t::isPolymorphic()) {
+                        if (auto group = FindOwningGroupForQuery<A...>(fd.ptrs)) {
+                            for (entity_id_t i = 0; i < group->size; i++) {
+                                if constexpr (onlyChanged) {
+                                    if (!QueryRowChangedSince<A...>(fom, i, true, since, nullptr)) {
+                                        continue;
+                                    }
+                                }
+                                FilterOneGrouped<A...>(fom, i);
+                            }
+                            return;
+                        }
+                        const auto primary = SmallestSetForQuery<A...>(fd.ptrs);
+                        for (entity_id_t i = 0; i < primary->ErasedSize(); i++) {
+                            if constexpr (onlyChanged) {
+                                if (!QueryRowChangedSince<A...>(fom, i, false, since, primary)) {
+                                    continue;
+                                }
+                            }
+                            FilterOne<A...>(fom, i, primary);
+                        }
+                    }
+                    else {
+                        auto mainFilter = fd.getMainFilter();
+                        for (entity_id_t i = 0; i < mainFilter->DenseSize(); i++) {
+                            FilterOne<A...>(fom, i, nullptr);
+                        }
+                    }
+                }(std::type_identity<argtypes_noref>{});
+            }(std::type_identity<argtypes>{});
+        }
+
+        // the non-polymorphic Filter, specialized per query: the sets are held typed, and rows do no mode dispatch
+        template<typename func>
+        inline void FilterTyped(func& f) {
+            using argtypes = decltype(arguments(f));
+            [this,&f] <typename... Ts>(std::type_identity<std::tuple<Ts...>>) -> void
+            {
+                FilterTypedSets<argtypes, std::remove_const_t<std::remove_reference_t<Ts>>...>(f);
+            }(std::type_identity<argtypes>{});
+        }
+
+        template<typename argtypes, typename ... A, typename func>
+        inline void FilterTypedSets(func& f) {
+            static_assert(sizeof...(A) > 0, "Must supply a type to query for");
+            const std::tuple<EntitySparseSet<A>*...> sets{ FilterGetSparseSetTyped<A>()... };
+            if constexpr (sizeof...(A) > 1) {
+                if (auto group = FindOwningGroupForQuery<A...>({ std::get<EntitySparseSet<A>*>(sets)... })) {
+                    FilterTypedDense<argtypes, A...>(sets, f, group->size);
+                    return;
+                }
+                // every match is in every set, so walk the smallest one
+                const std::array<size_t, sizeof...(A)> sizes{ std::get<EntitySparseSet<A>*>(sets)->DenseSize()... };
+                const auto smallest = size_t(std::min_element(sizes.begin(), sizes.end()) - sizes.begin());
+                [&]<size_t ... I>(std::index_sequence<I...>) {
+                    ((I == smallest && (FilterTypedFrom<I, argtypes, A...>(sets, f), true)) || ...);
+                }(std::index_sequence_for<A...>{});
+            }
+            else {
+                FilterTypedDense<argtypes, A...>(sets, f, std::get<0>(sets)->DenseSize());
+            }
+        }
+
+        // row i of every set belongs to the same entity: a single-type query, or an owning group
+        template<typename argtypes, typename ... A, typename func>
+        inline void FilterTypedDense(const std::tuple<EntitySparseSet<A>*...>& sets, func& f, entity_id_t count) {
+            for (entity_id_t i = 0; i < count; i++) {
+                f(std::get<EntitySparseSet<A>*>(sets)->Get(i)...);
+                ([&] {
+                    if constexpr (IsMutableQueryArg<A, argtypes>::value) {
+                        std::get<EntitySparseSet<A>*>(sets)->MarkChangedAtDense(i, changeTick);
+                    }
+                }(), ...);
+            }
+        }
+
+        template<size_t primaryIndex, typename argtypes, typename ... A, typename func>
+        inline void FilterTypedFrom(const std::tuple<EntitySparseSet<A>*...>& sets, func& f) {
+            const auto primary = std::get<primaryIndex>(sets);
+            for (entity_id_t i = 0; i < primary->DenseSize(); i++) {
+                const auto owner = primary->GetOwner(i);
+                if (!EntityIsValid(owner) || !(std::get<EntitySparseSet<A>*>(sets)->HasComponent(owner) && ...)) {
+                    continue;
+                }
+                const std::array<entity_id_t, sizeof...(A)> rows{ std::get<EntitySparseSet<A>*>(sets)->DenseIndexForEntity(owner)... };
+                f(std::get<EntitySparseSet<A>*>(sets)->Get(rows[Index_v<A, A...>])...);
+                ([&] {
+                    if constexpr (IsMutableQueryArg<A, argtypes>::value) {
+                        std::get<EntitySparseSet<A>*>(sets)->MarkChangedAtDense(rows[Index_v<A, A...>], changeTick);
+                    }
+                }(), ...);
+            }
+        }
+
+        template<typename funcmode_t>
+        inline void ParallelFilterGeneric(const funcmode_t& fm, pos_t minChunkSize) {
+            using argtypes = decltype(arguments(fm.f));
+            [this,&fm,minChunkSize] <typename... Ts>(std::type_identity<std::tuple<Ts...>>) -> void
+            {
+                using argtypes_noref = std::tuple<remove_polymorphic_arg_t<std::remove_const_t<std::remove_reference_t<Ts>>>...>;
+                [this,&fm,minChunkSize]<typename ... A>(std::type_identity<std::tuple<A...>>) -> void
+                {
+                    auto fd = GenFilterData<A...>(fm);
+                    pos_t rangeSize = static_cast<pos_t>(fd.getMainFilter()->DenseSize());
+                    bool grouped = false;
+                    const EntitySparseSetErased* primary = nullptr;
+                    if constexpr (!funcmode_t::isPolymorphic()) {
+                        if (auto group = FindOwningGroupForQuery<A...>(fd.ptrs)) {
+                            rangeSize = group->size;
+                            grouped = true;
+                        }
+                        else {
+                            primary = SmallestSetForQuery<A...>(fd.ptrs);
+                            rangeSize = primary->ErasedSize();
+                        }
                     }
+                    FilterOneMode fom(fm, fd.ptrs, std::type_identity<DataProviderNone>{});
+                    DispatchParallelChunks(rangeSize, minChunkSize, [this,&fom,grouped,primary](pos_t begin, pos_t end) {
+                        for (pos_t i = begin; i < end; i++) {
+                            FilterOneMaybeGrouped<A...>(fom, i, grouped, primary);
+                        }
+                    });
                 }(std::type_identity<argtypes_noref>{});
             }(std::type_identity<argtypes>{});
         }
+
+        /**
+         Split [0, count) into chunks of at least minChunkSize and invoke fn(begin, end) for each on App::executor.
+         Blocks until all chunks are complete. Safe to call from the main thread or from an executor worker.
+         */
+        void DispatchParallelChunks(pos_t count, pos_t minChunkSize, FunctionRef<void(pos_t, pos_t)> fn);
+
+        /**
+         Run a graph on App::executor and wait for it. From an executor worker, the calling worker helps run the graph instead of blocking.
+         */
+        void RunTaskGraph(tf::Taskflow& graph);
+
         void NetworkingSpawn(ctti_t,Entity&);
         void NetworkingDestroy(entity_t);
         void SetupPerEntityRenderData(entity_t);
+        void SetupPerEntityRenderData(std::span<const entity_t>);
+        void SetEntityStaticForRendering(entity_t, bool isStatic);
     public:
         
         /**
@@ -1068,6 +1740,12 @@ namespace RavEngine {
          */
         void SetEntityRenderlayer(entity_t globalid, renderlayer_t layers);
 
+        /**
+         @param globalid the entity ID
+         @return the render layer bitmask
+         */
+        renderlayer_t GetEntityRenderlayer(entity_t globalid);
+
         /**
          Specify per-object rendering attributes
          @param globalid the entity ID
@@ -1100,13 +1778,165 @@ namespace RavEngine {
             return en;
         }
         
+        /**
+         Create many bare entities at once. Entity storage and per-entity render data are resized once for the whole batch.
+         @note Unlike Instantiate, this does not invoke a Create function or register the entities for networking. Use InstantiateMany for that.
+         @param count the number of entities to create
+         @return the IDs of the new entities
+         */
+        Vector<entity_t> CreateEntities(pos_t count){
+            Vector<entity_t> ids;
+            CreateEntities(count, ids);
+            return ids;
+        }
+
+        /**
+         Add many entities of type @code T @endcode to the world. Invokes the @code Create @endcode function of T on each.
+         @param count the number of entities to create
+         @param args parameters to pass to each @code Create @endcode call
+         @return handles to the constructed entities.
+         */
+        template<typename T, typename ... A>
+        inline Vector<T> InstantiateMany(pos_t count, A&& ... args){
+            Vector<entity_t> ids;
+            CreateEntities(count, ids);
+            Vector<T> entities;
+            entities.reserve(ids.size());
+            for (const auto id : ids) {
+                T& en = entities.emplace_back();
+                en.id = id;
+                en.world = this;
+                en.Create(args...);
+                NetworkingSpawn(CTTI<T>(),en);
+            }
+            return entities;
+        }
+
+        /**
+         Add a component of type T to every entity in a list. Storage for T is grown once for the whole batch.
+         @param entities the entities to add to. None of them may already have a T.
+         @param args parameters to pass to every component's constructor (copied per entity)
+         */
+        template<typename T, typename ... A>
+        inline void EmplaceComponents(std::span<const entity_t> entities, const A& ... args){
+            if (entities.empty()){
+                return;
+            }
+            auto set = MakeIfNotExists<T>();
+            entity_id_t maxID = 0;
+            for (const auto id : entities){
+                maxID = std::max<entity_id_t>(maxID, id.id);
+            }
+            set->Reserve(entities.size(), maxID);
+            for (const auto id : entities){
+                EmplaceComponent<T>(id, args...);
+            }
+        }
+
+        /**
+         Write the entity table and the components of the given types to a binary snapshot. Each component type is stored as a copy of its dense array.
+         @note Only trivially copyable components can be saved. Pointers inside components, including the World pointer in an Entity, are written as-is and are not valid in another world.
+         @return the snapshot, to pass to LoadSnapshot
+         */
+        template<typename ... T>
+        Vector<std::byte> SaveSnapshot(){
+            SnapshotWriter writer;
+            WriteSnapshotEntities(writer);
+            (WriteSnapshotComponents<T>(writer), ...);
+            return std::move(writer.bytes);
+        }
+
+        /**
+         Restore a snapshot from SaveSnapshot. Entity IDs and versions come back exactly as saved, and each component type is restored with one bulk copy.
+         This does not invoke Create functions or register the entities for networking.
+         @param snapshot the data from SaveSnapshot
+         @note The world must not have created any entities. Component types stored in the snapshot but not listed in T are skipped.
+         */
+        template<typename ... T>
+        void LoadSnapshot(std::span<const std::byte> snapshot){
+            SnapshotReader reader{snapshot};
+            ReadSnapshotEntities(reader);
+            while (!reader.AtEnd()){
+                const auto section = ReadSnapshotSection(reader);
+                (ReadSnapshotComponents<T>(section) || ...);
+            }
+            FinishSnapshotLoad();
+        }
+
+        /**
+         A snapshot from SaveSnapshot, unpacked so that its entities can be added to a world that already has entities, see MergeSnapshot.
+         The snapshot's live entities are numbered 0 to numEntities - 1 in the order of their IDs.
+         */
+        struct UnpackedSnapshot{
+            struct Section{
+                uint64_t type = 0;
+                uint32_t stride = 0;
+                Vector<entity_id_t> owners;         // the numbers of the entities that own the rows, ascending
+                Vector<std::byte> components;       // the rows, in the order of owners
+            };
+            entity_id_t numEntities = 0;
+            Vector<Section> sections;
+        };
+
+        /**
+         Unpack a snapshot from SaveSnapshot. This does not touch any world, so it can run on a background thread.
+         */
+        static UnpackedSnapshot UnpackSnapshot(std::span<const std::byte> snapshot);
+
+        /**
+         Give a range of an unpacked snapshot's entities their components. Large snapshots can be merged a batch at a time over several frames.
+         This does not invoke Create functions or register the entities for networking.
+         @param snapshot from UnpackSnapshot
+         @param first the number of the first snapshot entity in the batch
+         @param ids the entities that become snapshot entities first to first + ids.size() - 1, from CreateEntities. They must not have the components yet.
+         @note Component types stored in the snapshot but not listed in T are skipped.
+         */
+        template<typename ... T>
+        void MergeSnapshot(const UnpackedSnapshot& snapshot, entity_id_t first, std::span<const entity_t> ids){
+            for (const auto& section : snapshot.sections){
+                (MergeSnapshotComponents<T>(section, first, ids) || ...);
+            }
+        }
+
+    private:
+        template<typename T>
+        inline bool MergeSnapshotComponents(const UnpackedSnapshot::Section& section, entity_id_t first, std::span<const entity_t> ids){
+            if (section.type != CTTI<T>()){
+                return false;
+            }
+            static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>, "Only trivially copyable components can be merged from a snapshot");
+            if (section.stride != sizeof(T)){
+                Debug::Fatal("Snapshot stores {} with size {}, but it has size {}", type_name<T>(), section.stride, sizeof(T));
+            }
+            // owners are ascending, so the rows of the batch are contiguous
+            const auto begin = std::lower_bound(section.owners.begin(), section.owners.end(), first);
+            const auto end = std::lower_bound(begin, section.owners.end(), entity_id_t(first + ids.size()));
+            if (begin == end){
+                return true;
+            }
+            auto set = MakeIfNotExists<T>();
+            entity_id_t maxID = 0;
+            for (const auto id : ids){
+                maxID = std::max<entity_id_t>(maxID, id.id);
+            }
+            set->Reserve(end - begin, maxID);
+            for (auto it = begin; it != end; ++it){
+                T value;
+                std::memcpy(&value, section.components.data() + size_t(it - section.owners.begin()) * sizeof(T), sizeof(T));
+                EmplaceComponent<T>(ids[*it - first], std::move(value));
+            }
+            return true;
+        }
+    public:
+
         /**
          Iterate the world, invoking a function for all entities with the requested components
          @param f the function to invoke. The parameters of @code f @endcode are the types used to query the scene
+         @note Entities are visited in the order of whichever requested component has the fewest instances
          */
         template<typename func>
         inline void Filter(func&& f){
-            FilterGeneric(FuncMode<func, false>{ f });
+            FilterTyped(f);
         }
         
         /**
@@ -1117,6 +1947,60 @@ namespace RavEngine {
         inline void FilterPolymorphic(func&& f){
             FilterGeneric(FuncMode<func, true>{ f });
         }
+
+        /**
+         Iterate the world, invoking a function only for entities where at least one of the requested components was written at or after a change tick.
+         Components are considered written when they are created, when they are passed by mutable reference to a Filter or System, or when MarkComponentChanged is called.
+         @param f the function to invoke. The parameters of @code f @endcode are the types used to query the scene
+         @param since the change tick to compare against. Store the value of GetCurrentChangeTick() after a call to pick up only newer changes on the next call.
+         @note Entities are visited in the order of whichever requested component has the fewest instances
+         */
+        template<typename func>
+        inline void FilterChanged(func&& f, change_tick_t since){
+            FilterGeneric<true>(FuncMode<func, false>{ f }, since);
+        }
+
+        /**
+         @return the current change tick. This advances once per World::Tick.
+         */
+        change_tick_t GetCurrentChangeTick() const{
+            return changeTick;
+        }
+
+        /**
+         Record that a component was modified outside of a mutable query, so that change-filtered queries will visit it.
+         */
+        template<typename T>
+        inline void MarkComponentChanged(entity_t local_id){
+            assert(CorrectVersion(local_id));
+            auto set = GetSetIfExists<T>();
+            assert(set);
+            set->MarkChangedForEntity(local_id.id, changeTick);
+        }
+
+        constexpr static pos_t defaultParallelFilterChunkSize = 256;
+
+        /**
+         Iterate the world in parallel, invoking a function for all entities with the requested components.
+         The dense range of the queried component type with the fewest instances is split into chunks which are executed on App::executor.
+         @param f the function to invoke. It is called concurrently from multiple threads, so it must not modify shared state without synchronization.
+         @param minChunkSize the minimum number of entities a single task will process. Queries smaller than this run inline on the calling thread.
+         @note This call blocks until every chunk has completed. Do not add or remove components of the queried types from inside f.
+         */
+        template<typename func>
+        inline void ParallelFilter(func&& f, pos_t minChunkSize = defaultParallelFilterChunkSize){
+            ParallelFilterGeneric(FuncMode<func, false>{ f }, minChunkSize);
+        }
+
+        /**
+         Iterate the world in parallel via a polymorphic query. See ParallelFilter for threading requirements.
+         @param f the function to invoke. The parameters of @code f @endcode are the types used to query the scene
+         @param minChunkSize the minimum number of entities a single task will process
+         */
+        template<typename func>
+        inline void ParallelFilterPolymorphic(func&& f, pos_t minChunkSize = defaultParallelFilterChunkSize){
+            ParallelFilterGeneric(FuncMode<func, true>{ f }, minChunkSize);
+        }
         
         // this does not check if the entity actually has the component
         // instead it iterates over keys in the hashtable
@@ -1128,6 +2012,19 @@ namespace RavEngine {
             }
         }
         
+        /**
+         Limits on how much of its query an amortized system visits per tick. If both are set, the smaller applies.
+         Each tick visits at least one entity.
+         */
+        struct SystemBudget {
+            pos_t entitiesPerTick = 0;                                  // 0 for no limit
+            std::chrono::duration<float, std::milli> timePerTick{ 0 };  // estimated from the system's average time per entity, 0 for no limit
+
+            bool IsLimited() const {
+                return entitiesPerTick > 0 || timePerTick.count() > 0;
+            }
+        };
+
         virtual ~World();
         
 		constexpr static uint8_t id_size = 8;
@@ -1157,6 +2054,7 @@ namespace RavEngine {
                     // use `A...` here
                     
                     auto ptr = &ecsRangeSizes[CTTI<T>()];
+                    ptr->timing = PerfCounters::GetHistogram(Format("System: {} (ms)", type_name<T>()));
                     
                     FuncModeCopy<T,polymorphic> fm{T(std::forward<Args>(args)...)};
                     
@@ -1170,8 +2068,37 @@ namespace RavEngine {
 
                                    
                     // value update
-                    auto range_update = ECSTasks.emplace([this,ptr,setptr](){
-                        *ptr = static_cast<pos_t>(setptr->DenseSize());
+                    auto range_update = ECSTasks.emplace([this,ptr,setptr,ptrs = fd.ptrs](){
+                        RVE_PROFILE_FN_N(type_name<T>().data());
+                        ptr->UpdateRowCost();
+                        ptr->elapsed = {};
+                        ptr->lastRunTick = ptr->currentRunTick;
+                        ptr->currentRunTick = changeTick;
+                        ptr->group = nullptr;
+                        ptr->primary = nullptr;
+                        if constexpr (!polymorphic) {
+                            ptr->group = FindOwningGroupForQuery<A...>(ptrs);
+                            // rows of an owning group line up with the rows of its first set
+                            ptr->primary = ptr->group ? setptr : SmallestSetForQuery<A...>(ptrs);
+                        }
+                        ptr->total = ptr->group ? ptr->group->size : static_cast<pos_t>(ptr->primary ? ptr->primary->ErasedSize() : setptr->DenseSize());
+                        ptr->begin = 0;
+                        ptr->size = ptr->total;
+                        if (ptr->budget.IsLimited() && ptr->total > 0) {
+                            // resume at the entity the last slice stopped before, wherever churn has moved it
+                            pos_t start = ptr->nextRow;
+                            if constexpr (!polymorphic) {
+                                if (ptr->nextOwner != INVALID_ENTITY && ptr->primary->ErasedHas(ptr->nextOwner)) {
+                                    start = ptr->primary->ErasedDenseIndex(ptr->nextOwner);
+                                }
+                            }
+                            ptr->begin = start < ptr->total ? start : 0;
+                            ptr->size = ptr->SliceSize();
+                            ptr->nextRow = ptr->Row(ptr->size);
+                            if constexpr (!polymorphic) {
+                                ptr->nextOwner = ptr->primary->ErasedOwner(ptr->nextRow);
+                            }
+                        }
                     }).name(Format("{} range update",type_name<T>()));
                     
                     tf::Task do_task;
@@ -1179,31 +2106,64 @@ namespace RavEngine {
                     if constexpr (isSerial) {
                         do_task = ECSTasks.emplace([this, ptr, fom] () mutable {
                             RVE_PROFILE_FN_N(type_name<T>().data());
+                            const auto start = e_clock_t::now();
                             if constexpr (SystemHasBefore<T>) {
                                 fom.fm.f.before(this);
                             }
-                            for (pos_t i = 0; i < std::ref(*ptr); i++) {
-                                FilterOne<A...>(fom, i);
+                            const bool grouped = ptr->group != nullptr;
+                            for (pos_t i = 0; i < ptr->size; i++) {
+                                const auto row = ptr->Row(i);
+                                if constexpr (SystemFiltersChanged<T>) {
+                                    if (!QueryRowChangedSince<A...>(fom, row, grouped, ptr->lastRunTick, ptr->primary)) {
+                                        continue;
+                                    }
+                                }
+                                FilterOneMaybeGrouped<A...>(fom, row, grouped, ptr->primary);
                             }
                             if constexpr (SystemHasAfter<T>) {
                                 fom.fm.f.after(this);
                             }
+                            ptr->elapsed += e_clock_t::now() - start;
+                            ptr->RecordSample();
                         }).name(Format("{} serial", type_name<T>().data()));
                     }
                     else {
-                        do_task = ECSTasks.for_each_index(pos_t(0), std::ref(*ptr), pos_t(1), [this, fom](auto i) mutable {
-                            FilterOne<A...>(fom, i);
+                        // a subflow around the loop, so the system can be timed from when its first row starts until its last row ends
+                        do_task = ECSTasks.emplace([this, fom, ptr](tf::Subflow& subflow) {
+                            RVE_PROFILE_FN_N(type_name<T>().data());
+                            const auto start = e_clock_t::now();
+                            subflow.for_each_index(pos_t(0), ptr->size, pos_t(1), [this, fom, ptr](auto i) mutable {
+                                const auto row = ptr->Row(i);
+                                if constexpr (SystemFiltersChanged<T>) {
+                                    if (!QueryRowChangedSince<A...>(fom, row, ptr->group != nullptr, ptr->lastRunTick, ptr->primary)) {
+                                        return;
+                                    }
+                                }
+                                FilterOneMaybeGrouped<A...>(fom, row, ptr->group != nullptr, ptr->primary);
+                            });
+                            subflow.join();
+                            ptr->elapsed += e_clock_t::now() - start;
+                            if constexpr (!SystemHasAfter<T>) {
+                                ptr->RecordSample();
+                            }
                             }).name(Format("{}", type_name<T>().data()));
                         if constexpr (SystemHasBefore<T>) {
-                            before.emplace(ECSTasks.emplace([fom, this] {
+                            before.emplace(ECSTasks.emplace([fom, this, ptr] {
+                                RVE_PROFILE_FN_N(type_name<T>().data());
+                                const auto start = e_clock_t::now();
                                 fom.fm.f.before(this);
+                                ptr->elapsed += e_clock_t::now() - start;
                             }).name(Format("{}::before()", type_name<T>().data())));
                             range_update.precede(before.value());
                             do_task.succeed(before.value());
                         }
                         if constexpr (SystemHasAfter<T>) {
-                            after.emplace(ECSTasks.emplace([fom, this] {
+                            after.emplace(ECSTasks.emplace([fom, this, ptr] {
+                                RVE_PROFILE_FN_N(type_name<T>().data());
+                                const auto start = e_clock_t::now();
                                 fom.fm.f.after(this);
+                                ptr->elapsed += e_clock_t::now() - start;
+                                ptr->RecordSample();
                             }).name(Format("{}::after()", type_name<T>().data())));
                             do_task.precede(after.value());
                         }
@@ -1258,7 +2218,8 @@ namespace RavEngine {
                         enteryValidatorTypes(std::type_identity<validatorTupleType>{});
                     }
                     
-                    typeToSystem[CTTI<T>()] = tasks;                    
+                    typeToSystem[CTTI<T>()] = tasks;
+                    systemRegistrationOrder.push_back(CTTI<T>());
                     return tasks;
                     
                 };
@@ -1273,6 +2234,14 @@ namespace RavEngine {
             }(std::type_identity<argtypes>{}, std::forward<Args>(args)...);
         }
         
+        template<bool isSerial, bool polymorphic, typename T, typename ... Args>
+        inline auto EmplaceAmortizedSystemGeneric(const SystemBudget& budget, Args&& ... args){
+            static_assert(!SystemFiltersChanged<T>, "Amortized systems cannot filter changed rows, because changes to rows outside a slice would be missed");
+            auto tasks = EmplaceSystemGeneric<isSerial, polymorphic, T>(std::forward<Args>(args)...);
+            ecsRangeSizes[CTTI<T>()].budget = budget;
+            return tasks;
+        }
+
         template<bool isSerial, bool polymorphic,typename T, typename interval_t, typename ... Args>
         inline void EmplaceTimedSystemGeneric(const interval_t interval, Args&& ... args){
             auto task = EmplaceSystemGeneric<isSerial, polymorphic,T>(args...);
@@ -1300,26 +2269,7 @@ namespace RavEngine {
         template<typename T, typename U>
         inline void CreateDependency(){
             // T depends on (runs after) U
-            auto& tPair = typeToSystem.at(CTTI<T>());
-            auto& uPair = typeToSystem.at(CTTI<U>());
-
-            tf::Task dependecyRoot;
-            if (auto postHook = uPair.postHook) {
-                dependecyRoot = postHook.value();
-            }
-            else {
-                dependecyRoot = uPair.do_task;
-            }
-
-            tf::Task dependencyLeaf;
-            if (auto preHook = tPair.preHook) {
-                dependencyLeaf = preHook.value();
-            }
-            else {
-                dependencyLeaf = tPair.do_task;
-            }
-            
-            dependencyLeaf.succeed(dependecyRoot);
+            LinkSystems(typeToSystem.at(CTTI<U>()), typeToSystem.at(CTTI<T>()));
             graphWasModified = true;
         }
      
@@ -1338,12 +2288,14 @@ namespace RavEngine {
                 ECSTasks.erase(after.value());
             }
             typeToSystem.erase(CTTI<T>());
+            std::erase(systemRegistrationOrder, CTTI<T>());
 
             // graphWasModified is not set to true here, because removing systems cannot introduce new hazards to an already-safe graph.
         }
         
         /**
          Instantiate a parallel system. T is the class/struct type of the system.
+         Each tick, the system walks whichever of its queried component types has the fewest instances, so the order of its parameters does not affect its cost.
          @param args values to pass to the system constructor
         */
         template<typename T, typename ... Args>
@@ -1362,6 +2314,36 @@ namespace RavEngine {
             return EmplaceTimedSystemGeneric<false, false,T>(interval, std::forward<Args>(args)...);
         }
         
+        /**
+         Instantiate a parallel system that visits a slice of its entities each tick, cycling through all of them over several ticks,
+         so that work such as AI perception or LOD selection is spread evenly across frames instead of arriving at once like a timed system.
+         Slices resume from the entity the previous slice stopped before, even if entities were added or removed in between.
+         @param budget how many entities, or how much time, each tick may spend
+         @param args values to pass to the system constructor
+         */
+        template<typename T, typename ... Args>
+        auto EmplaceAmortizedSystem(const SystemBudget& budget, Args&& ... args){
+            return EmplaceAmortizedSystemGeneric<false, false, T>(budget, std::forward<Args>(args)...);
+        }
+
+        /**
+         Instantiate a serial system that visits a slice of its entities each tick. See EmplaceAmortizedSystem.
+         @param budget how many entities, or how much time, each tick may spend
+         @param args values to pass to the system constructor
+         */
+        template<typename T, typename ... Args>
+        auto EmplaceSerialAmortizedSystem(const SystemBudget& budget, Args&& ... args){
+            return EmplaceAmortizedSystemGeneric<true, false, T>(budget, std::forward<Args>(args)...);
+        }
+
+        /**
+         Change the budget of a system. A budget with no limits makes it visit every entity each tick.
+         */
+        template<typename T>
+        void SetSystemBudget(const SystemBudget& budget){
+            ecsRangeSizes.at(CTTI<T>()).budget = budget;
+        }
+
         /**
          Instantiate a parallel system that performs polymorphic queries to get component data. T is the class/struct type of the system.
          @param args values to pass to the system constructor
@@ -1420,9 +2402,101 @@ namespace RavEngine {
             return EmplaceTimedSystemGeneric<true, true, T>(interval, std::forward<Args>(args)...);
         }
         
+        /**
+         Declare an owning group. The sparse sets of the listed component types are kept in the same dense order
+         for every entity that has all of them, so Filters and Systems whose query is exactly these types
+         become linear scans with no per-entity lookups.
+         @note A component type may only be owned by one group. Joining or leaving a group moves components,
+         so references to any of the grouped components of an entity are invalidated when a grouped component is added to or removed from that entity.
+         */
+        template<typename ... A>
+        void DeclareGroup(){
+            static_assert(sizeof...(A) >= 2, "A group must contain at least two component types");
+            auto& group = owningGroups.emplace_back(std::make_unique<OwningGroup>());
+            auto groupPtr = group.get();
+            groupPtr->types = { CTTI<A>()... };
+
+            auto sets = std::make_tuple(MakeIfNotExists<A>()...);
+            std::apply([groupPtr](auto ... set) {
+                ((Debug::Assert(set->owningGroup == nullptr, "Component type is already owned by another group"), set->owningGroup = groupPtr), ...);
+            }, sets);
+
+            groupPtr->tryAdd = [groupPtr, sets](entity_id_t id) {
+                auto primary = std::get<0>(sets);
+                const bool hasAll = std::apply([id](auto ... set) { return (set->HasComponent(id) && ...); }, sets);
+                if (!hasAll || primary->DenseIndexForEntity(id) < groupPtr->size) {
+                    return;
+                }
+                std::apply([id, groupPtr](auto ... set) { (set->SwapIntoDenseIndex(id, groupPtr->size), ...); }, sets);
+                groupPtr->size++;
+            };
+            groupPtr->remove = [groupPtr, sets](entity_id_t id) {
+                auto primary = std::get<0>(sets);
+                if (!primary->HasComponent(id) || primary->DenseIndexForEntity(id) >= groupPtr->size) {
+                    return;     // not a member
+                }
+                groupPtr->size--;
+                std::apply([id, groupPtr](auto ... set) { (set->SwapIntoDenseIndex(id, groupPtr->size), ...); }, sets);
+            };
+
+            // adopt entities that already satisfy the group
+            auto primary = std::get<0>(sets);
+            for (entity_id_t i = 0; i < primary->DenseSize(); i++) {
+                groupPtr->tryAdd(primary->GetOwner(i));
+            }
+        }
+
         const auto& getTypeToSystem() const {
             return typeToSystem;
         }
+
+        /**
+         Derive system ordering from the component types each system reads and writes, instead of requiring CreateDependency for every pair.
+         When enabled, systems whose accesses do not conflict are left free to run concurrently, and each conflicting pair
+         is ordered by registration order (the system emplaced first runs first). Dependencies created with CreateDependency are respected.
+         Systems with pre/post hooks or that use a WorldDataProvider conflict with every other system.
+         The graph is rebuilt at the start of the next tick after a system is added.
+         @param enabled true to schedule automatically
+         */
+        void SetAutomaticSystemScheduling(bool enabled) {
+            autoScheduleSystems = enabled;
+            graphWasModified = true;
+        }
+
+        bool GetAutomaticSystemScheduling() const {
+            return autoScheduleSystems;
+        }
+
+        /**
+         Choose how changes to parented Transforms reach their descendants. By default every setter immediately walks the subtree.
+         When deferred, setters only mark the transform, and the world recomputes all parent-space matrices once per tick, after systems
+         and command buffer playback have run. The hierarchy is kept sorted by depth, and each level is processed in parallel.
+         @note while deferred, world-space getters on descendants reflect the most recent propagation
+         @param deferred true to propagate in a batch
+         */
+        void SetDeferredTransformPropagation(bool deferred);
+
+        bool GetDeferredTransformPropagation() const {
+            return deferTransformPropagation;
+        }
+
+        /**
+         Bring all descendant transforms up to date now. Called automatically each tick when propagation is deferred.
+         */
+        void PropagateTransformHierarchy();
+
+        /**
+         @return the bounding volume hierarchy of every entity with a SpatialBoundsComponent, for frustum, sphere, box and ray queries.
+         It is updated once per tick, after transform propagation.
+         */
+        const SpatialIndex& GetSpatialIndex() const {
+            return spatialIndex;
+        }
+
+        /**
+         Bring the spatial index up to date with transforms changed since the last update. Called automatically each tick.
+         */
+        void UpdateSpatialIndex();
 	private:
 		std::atomic<bool> isRendering = false;
         char worldIDbuf [id_size]{0};
@@ -1454,7 +2528,60 @@ namespace RavEngine {
              std::chrono::time_point<e_clock_t> last_timestamp = e_clock_t::now();
         };
         UnorderedNodeMap<ctti_t, TimedSystemEntry> timedSystemRecords;
-        UnorderedNodeMap<ctti_t, pos_t> ecsRangeSizes;
+        struct SystemRange{
+            pos_t size = 0;                 // rows to visit this tick
+            pos_t begin = 0, total = 0;     // the first row to visit, and the rows in the set. Visits wrap around to row 0.
+            OwningGroup* group = nullptr;   // set if this tick the system iterates an owning group
+            const EntitySparseSetErased* primary = nullptr;     // the set whose rows are visited, for non-polymorphic queries
+            change_tick_t lastRunTick = 0, currentRunTick = 0;  // for systems that only visit changed rows
+
+            // amortized systems visit a slice of the rows each tick, continuing from the row the last slice stopped before
+            SystemBudget budget;
+            pos_t nextRow = 0;
+            entity_id_t nextOwner = INVALID_ENTITY;
+            float rowCostMs = 0;            // running average, for time budgets
+
+            inline pos_t Row(pos_t i) const {
+                const auto row = begin + i;
+                return row >= total ? row - total : row;
+            }
+
+            void UpdateRowCost() {
+                if (size > 0 && elapsed.count() > 0) {
+                    const auto cost = elapsed.count() / size;
+                    rowCostMs = rowCostMs > 0 ? rowCostMs + (cost - rowCostMs) / 4 : cost;
+                }
+            }
+
+            pos_t SliceSize() const {
+                pos_t slice = total;
+                if (budget.entitiesPerTick > 0) {
+                    slice = std::min(slice, budget.entitiesPerTick);
+                }
+                if (budget.timePerTick.count() > 0) {
+                    // until the cost of a row is known, start small
+                    constexpr pos_t firstSlice = 64;
+                    const auto fit = rowCostMs > 0 ? static_cast<pos_t>(std::min<double>(budget.timePerTick.count() / rowCostMs, total)) : firstSlice;
+                    slice = std::min(slice, fit);
+                }
+                return std::max<pos_t>(slice, 1);
+            }
+
+            // time spent in the system's tasks this tick, and in its last statsWindow ticks, for GetSystemStats
+            constexpr static uint32_t statsWindow = 128;
+            std::chrono::duration<float, std::milli> elapsed{ 0 };
+            std::array<float, statsWindow> samples{};
+            uint32_t nextSample = 0, numSamples = 0;
+            PerfCounters::Histogram* timing = nullptr;      // shared by the worlds that run the system
+
+            void RecordSample() {
+                timing->Record(elapsed.count());
+                samples[nextSample] = elapsed.count();
+                nextSample = (nextSample + 1) % statsWindow;
+                numSamples = std::min(numSamples + 1, statsWindow);
+            }
+        };
+        UnorderedNodeMap<ctti_t, SystemRange> ecsRangeSizes;
 
         struct SystemTasks {
             tf::Task rangeUpdate, do_task;
@@ -1464,31 +2591,88 @@ namespace RavEngine {
             bool usesWorldDataProvider = false;
         };
         UnorderedMap<ctti_t, SystemTasks> typeToSystem;
+        Vector<ctti_t> systemRegistrationOrder;
+        bool autoScheduleSystems = false;
+        void ScheduleSystems();
+        static void LinkSystems(const SystemTasks& first, const SystemTasks& second);
+        Vector<Vector<size_t>> SystemSuccessors() const;
+
+        // parented transforms sorted by depth, for deferred propagation
+        struct TransformHierarchy {
+            Vector<entity_id_t> nodes;
+            Vector<pos_t> parentIndices;    // index into nodes, INVALID_INDEX for roots
+            Vector<pos_t> levelStarts;      // depth N occupies [levelStarts[N], levelStarts[N+1])
+            Vector<matrix4> worldMatrices;
+            Vector<uint8_t> moved;          // set if the node or any ancestor changed this pass
+            bool needsRebuild = true;
+        } transformHierarchy;
+        bool deferTransformPropagation = false;
+        void RebuildTransformHierarchy();
+
+        SpatialIndex spatialIndex;
+
+        // the rows of one component set whose owners are not static, rebuilt when the set or static membership changes
+        struct NonStaticSubset {
+            Vector<entity_id_t> denseIndices;
+            uint32_t setVersion = std::numeric_limits<uint32_t>::max();
+            uint32_t staticVersion = std::numeric_limits<uint32_t>::max();
+            Vector<Transform*> consumed;    // mesh sets only: per row of the last render data pass, the transform whose tick-dirty flag it used up
+        };
+        uint32_t staticMembershipVersion = 0;   // advanced by Transform::SetStatic
+        uint32_t staticMoveVersion = 0;         // advanced whenever a static transform is queued as moved
+        SpinLock staticMoveLock;
+        Vector<entity_id_t> movedStaticEntities;    // static transforms changed since the render data was last updated
+        void QueueStaticTransformMove(const Transform& transform);
+        void ClearStaticTransformMoves();
+        template<typename T>
+        void RefreshNonStaticSubset(const EntitySparseSet<T>* set, NonStaticSubset& subset);
+        // invoke fn with the dense index of every row of set whose owner is not static, or is static and has moved.
+        // The rows are split across the executor's workers, so fn may only write state that belongs to its row.
+        template<typename T, typename Fn>
+        void ParallelForEachNonStaticOrMoved(EntitySparseSet<T>* set, NonStaticSubset& subset, pos_t minChunkSize, const Fn& fn);
+#if !RVE_SERVER
+        NonStaticSubset staticMeshSubset, skinnedMeshSubset, dirLightSubset, spotLightSubset, pointLightSubset;
+
+        // world transforms of moving meshes at the last two fixed ticks, for render interpolation
+        struct InterpolationState {
+            vector3 position, scale;
+            quaternion rotation;
+            bool operator==(const InterpolationState&) const = default;
+            static InterpolationState FromMatrix(const matrix4& m);
+            matrix4 ToMatrix() const;
+        };
+        struct TransformInterpolation {
+            Vector<InterpolationState> previous, current;   // indexed by entity ID
+            Vector<uint32_t> capturedAtStep;                // 0 if the entity has no recorded state
+            Vector<uint32_t> capturedVersion;               // entity version the state belongs to, IDs are reused
+            Vector<entity_id_t> moving;                     // entities where previous != current
+            uint32_t step = 0;
+            float alpha = 1;
+        } transformInterpolation;
+        void CaptureInterpolationStep();
+        void WriteInterpolatedTransforms();
+#endif
         UnorderedMap<ctti_t, std::string_view> typeToName;
         				
 		void SetupTaskGraph();
 		
 		std::chrono::time_point<e_clock_t> time_now = e_clock_t::now();
 		float currentFPSScale = 0.01f;
+        change_tick_t changeTick = 1;   // advanced once per tick, used for change-filtered queries
 		
 		//Entity list
-        struct dispatched_func{
-            double runAtTime = 0;
-            Function<void(void)> func;
-            dispatched_func(const decltype(runAtTime) rt,const decltype(func)& func) : func(func), runAtTime(rt){}
-            dispatched_func(const dispatched_func& other){
-                runAtTime = other.runAtTime;
-                func = other.func;
-            }
-            dispatched_func(){}
-        };
-        UnorderedSet<std::shared_ptr<dispatched_func>> async_tasks;
-        decltype(async_tasks)::iterator async_begin, async_end;
-        RavEngine::Vector<std::shared_ptr<dispatched_func>> ranFunctions;
+        // index 0 is shared by non-worker threads, index N+1 belongs to executor worker N
+        Vector<std::unique_ptr<EntityCommandBuffer>> commandBuffers;
+
+        // functions from DispatchAsync, keyed by the app time they are due. Only touched on the main thread and in the ECS graph.
+        TimerWheel asyncTimers;
+        RavEngine::Vector<TimerWheel::callback_t> dueAsync;
+        decltype(dueAsync)::iterator async_begin, async_end;
 	protected:
         
 		//physics system
         friend class PhysicsLinkSystemWrite;
+        friend class PhysicsLinkSystemRead;
 		std::unique_ptr<PhysicsSolver> Solver;
 		
 		//fire-and-forget audio
@@ -1525,7 +2709,9 @@ namespace RavEngine {
          */
         template<typename T>
         inline T& GetComponent(){
-            return componentMap.at(RavEngine::CTTI<T>()).template GetSet<T>()->GetFirst();
+            auto set = GetSetIfExists<T>();
+            assert(set);
+            return set->GetFirst();
         }
         
 		std::string_view worldID{ worldIDbuf,id_size };
@@ -1544,6 +2730,37 @@ namespace RavEngine {
         inline void ExportTaskGraph(std::ostream& out){
             masterTasks.dump(out);
         }
+
+        struct SystemStats {
+            std::string_view name;
+            float meanMs = 0, p99Ms = 0, lastMs = 0;    // time in the system's tasks, excluding time waiting for other systems
+            pos_t entities = 0;                         // the rows the system iterated on its last tick
+            uint32_t samples = 0;                       // ticks the times are over
+            bool onCriticalPath = false;                // the chain of dependent systems with the longest mean time
+        };
+
+        /**
+         @return timing for each system over its recent ticks, in registration order. Timed systems are only sampled on ticks they run.
+         */
+        Vector<SystemStats> GetSystemStats() const;
+
+        /**
+         @return the number of entities that are alive in this world
+         */
+        pos_t GetNumLiveEntities() const {
+            return numEntities - pos_t(available.size());
+        }
+
+        /**
+         Log the systems and the dependencies between them in graphviz format, labeled with their mean and p99 times. The critical path,
+         the chain of dependent systems that takes longest, is drawn in red.
+         */
+        void ExportSystemGraph(std::ostream& out) const;
+
+        /**
+         Add the bytes and component count of each component set in this world to sets, merging with items of the same type name
+         */
+        void AddComponentMemory(Vector<MemoryReport::Item>& sets);
 				
 		/**
 		Initializes the physics-related Systems.
@@ -1558,6 +2775,19 @@ namespace RavEngine {
 		*/
 		void Tick(float);
 
+		/**
+		 Run systems, physics and hierarchy propagation without updating render data. Used by the App when it ticks at a fixed rate.
+		 When App::GetFixedTickRate is nonzero, the transforms of moving meshes are also recorded so SyncRenderData can interpolate them.
+		 @param scale the tick fraction to evaluate
+		 */
+		void TickSimulation(float scale);
+
+		/**
+		 Update the render data from the simulation state. Does nothing in server builds.
+		 @param alpha how far between the previous and the most recent fixed tick to place moving meshes, in [0,1]. 1 uses the most recent state as-is.
+		 */
+		void SyncRenderData(float alpha = 1);
+
 		World();
 		
 		/**
@@ -1609,6 +2839,18 @@ namespace RavEngine {
          @note You must ensure data your function references is kept loaded when this function runs. For example, to keep an entity loaded, capture by value an owning pointer to it. In addition, do not make assumptions about what thread your dispatched function runs on.
          */
         void DispatchAsync(const Function<void(void)>& func, double delaySeconds);
+
+        /**
+         @return the command buffer for the calling thread. Use it to record structural changes from inside parallel systems.
+         @note Each executor worker has its own buffer. All threads that are not executor workers share one buffer, so only one of them (usually the main thread) may record at a time.
+         */
+        EntityCommandBuffer& GetCommandBuffer();
+
+        /**
+         Apply every recorded command buffer. This is called automatically after the ECS portion of each Tick.
+         Must not be called while systems are running.
+         */
+        void FlushCommandBuffers();
         
         /**
          @return the internal data structure storing all components of a given type.
@@ -1616,11 +2858,7 @@ namespace RavEngine {
          */
         template<typename T>
         inline auto GetAllComponentsOfType(){
-            EntitySparseSet<T>* ret = nullptr;
-            if (componentMap.find(CTTI<T>()) != componentMap.end()){
-                ret = GetRange<T>();
-            }
-            return ret;
+            return GetSetIfExists<T>();
         }
 	};
 }
@@ -0,0 +1,138 @@
+#pragma once
+#include "World.hpp"
+#include "Queue.hpp"
+#include "Map.hpp"
+#include "Function.hpp"
+#include <glm/vec3.hpp>
+#include <atomic>
+#include <string>
+#include <span>
+
+namespace RavEngine {
+
+    /**
+     A cell of a streamed world. Cells are columns on the XZ plane, so cell (x, z) covers [x, x + 1) * cellSize on X and [z, z + 1) * cellSize on Z.
+     */
+    struct StreamingCell {
+        int32_t x = 0, z = 0;
+
+        bool operator==(const StreamingCell&) const = default;
+    };
+
+    /**
+     @return the distance on the XZ plane from a position to the nearest point of a cell, or 0 if the position is over the cell
+     */
+    float StreamingCellDistance(StreamingCell cell, glm::vec3 position, float cellSize);
+
+    /**
+     Append every cell whose nearest point is within radius of a position on the XZ plane
+     */
+    void StreamingCellsWithin(glm::vec3 position, float radius, float cellSize, Vector<StreamingCell>& cells);
+
+    struct WorldStreamerConfig {
+        float cellSize = 128;
+        float loadRadius = 256;             // cells within this distance of an anchor are loaded
+        float unloadRadius = 320;           // cells farther than this from every anchor are evicted. Keep it above loadRadius, so cells on the edge do not thrash.
+        uint32_t entitiesPerFrame = 2048;   // entities created or destroyed per Update, so a cell crossing the radius does not hitch the frame
+        uint32_t maxLoadsInFlight = 4;
+    };
+
+    /**
+     Streams the cells of an open world in and out of a World around a set of anchors, such as the player and the camera.
+     Each cell is a snapshot from World::SaveSnapshot, saved from the cell's part of the level, in the resources or in a mounted pack.
+     Cells are read and unpacked on the background executor, and their entities are created and given their components on the
+     game thread within a budget of entities per frame, so a cell can take several frames to appear. Cells that every anchor has
+     moved away from are destroyed within the same budget.
+     @note Snapshots only hold trivially copyable components. Use onCellLoaded to give the entities of a cell the rest of their
+     components, such as their Transforms and meshes.
+     */
+    class WorldStreamer {
+    public:
+        using Config = WorldStreamerConfig;
+        using path_fn = Function<std::string(StreamingCell)>;
+        using cell_callback_t = Function<void(StreamingCell, std::span<const entity_t>)>;
+
+        /**
+         @param cellPath returns the resources path of the snapshot for a cell, or an empty string if the world has nothing there.
+         Cells whose snapshot does not exist are empty.
+         */
+        WorldStreamer(path_fn cellPath, const Config& config = {}) : cellPath(std::move(cellPath)), config(config) {}
+        ~WorldStreamer();
+
+        /**
+         Set the component types to create from the snapshots. Types stored in a snapshot but not listed here are skipped.
+         */
+        template<typename ... T>
+        void SetComponentTypes() {
+            merge = [](World& world, const World::UnpackedSnapshot& snapshot, entity_id_t first, std::span<const entity_t> ids) {
+                world.MergeSnapshot<T...>(snapshot, first, ids);
+            };
+        }
+
+        /**
+         Apply the loads that finished, evict the cells out of range, create and destroy up to entitiesPerFrame entities,
+         and start loading the closest missing cells. Call once per frame on the thread that owns the world.
+         @param anchors the positions to keep the world loaded around. With no anchors, every cell is evicted.
+         */
+        void Update(World& world, std::span<const glm::vec3> anchors);
+
+        /**
+         Invoked once all the entities of a cell exist
+         */
+        cell_callback_t onCellLoaded;
+
+        /**
+         Invoked when a loaded cell is evicted, before its entities are destroyed. Entities that were destroyed since the cell loaded are still listed.
+         */
+        cell_callback_t onCellUnloading;
+
+        /**
+         @return true if all the entities of a cell exist
+         */
+        bool IsResident(StreamingCell cell) const;
+
+        uint32_t GetNumLoadsInFlight() const {
+            return loadsInFlight;
+        }
+
+        const Config& GetConfig() const {
+            return config;
+        }
+
+    private:
+        enum class CellState : uint8_t {
+            Loading,
+            Committing,     // unpacked, its entities are being created
+            Resident,
+            Evicting        // its entities are being destroyed
+        };
+
+        struct Cell {
+            CellState state = CellState::Loading;
+            uint32_t generation = 0;            // a load for an evicted cell is dropped when it lands
+            World::UnpackedSnapshot snapshot;   // while committing
+            Vector<entity_t> entities;
+        };
+
+        struct LoadedCell {
+            StreamingCell cell;
+            uint32_t generation = 0;
+            World::UnpackedSnapshot snapshot;
+        };
+
+        static uint64_t KeyFor(StreamingCell cell) {
+            return (uint64_t(uint32_t(cell.x)) << 32) | uint32_t(cell.z);
+        }
+
+        path_fn cellPath;
+        Config config;
+        Function<void(World&, const World::UnpackedSnapshot&, entity_id_t, std::span<const entity_t>)> merge;
+        UnorderedMap<uint64_t, Cell> cells;
+        Vector<StreamingCell> committing, evicting;     // in the order they started
+        ConcurrentQueue<LoadedCell> loadedCells;
+        std::atomic<uint32_t> loadsInFlight = 0;
+        uint32_t nextGeneration = 0;
+        Vector<std::pair<float, StreamingCell>> candidates;
+        Vector<StreamingCell> cellsNearAnchor;
+    };
+}
@@ -0,0 +1,251 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+
+namespace RavEngine {
+
+/**
+ A vector that stores up to N elements inside itself, and moves them to the heap only when it grows past N.
+ For per-entity lists that are usually tiny, this saves an allocation per list and keeps the elements next to their owner.
+ It has the subset of the std::vector interface that the engine uses, so it can be the storage of an unordered_vector.
+ Unlike a std::vector, moving one that stores its elements inline moves each element, and invalidates iterators to them.
+ */
+template<typename T, uint32_t N>
+class small_vector {
+    static_assert(N > 0, "Use a std::vector if there is no inline capacity");
+
+    T* elements;
+    uint32_t count = 0;
+    uint32_t cap = N;
+    alignas(T) std::byte inlineStorage[N * sizeof(T)];
+
+    T* InlineData() {
+        return std::launder(reinterpret_cast<T*>(inlineStorage));
+    }
+
+    bool IsInline() const {
+        return elements == reinterpret_cast<const T*>(inlineStorage);
+    }
+
+    void Grow(size_t minCapacity) {
+        const auto newCap = uint32_t(std::max<size_t>(minCapacity, size_t(cap) * 2));
+        auto newElements = static_cast<T*>(::operator new(newCap * sizeof(T), std::align_val_t(alignof(T))));
+        std::uninitialized_move(elements, elements + count, newElements);
+        std::destroy(elements, elements + count);
+        FreeHeap();
+        elements = newElements;
+        cap = newCap;
+    }
+
+    void FreeHeap() {
+        if (!IsInline()) {
+            ::operator delete(elements, std::align_val_t(alignof(T)));
+        }
+    }
+
+    // take other's elements, leaving it empty. This must be empty and inline.
+    void Steal(small_vector& other) {
+        if (other.IsInline()) {
+            std::uninitialized_move(other.elements, other.elements + other.count, elements);
+            std::destroy(other.elements, other.elements + other.count);
+        }
+        else {
+            elements = other.elements;
+            cap = other.cap;
+            other.elements = other.InlineData();
+            other.cap = N;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+
+    small_vector() : elements(InlineData()) {}
+
+    small_vector(std::initializer_list<T> init) : small_vector() {
+        reserve(init.size());
+        for (const auto& value : init) {
+            push_back(value);
+        }
+    }
+
+    small_vector(const small_vector& other) : small_vector() {
+        reserve(other.count);
+        std::uninitialized_copy(other.begin(), other.end(), elements);
+        count = other.count;
+    }
+
+    small_vector(small_vector&& other) noexcept : small_vector() {
+        Steal(other);
+    }
+
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.count);
+            std::uninitialized_copy(other.begin(), other.end(), elements);
+            count = other.count;
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept {
+        if (this != &other) {
+            clear();
+            FreeHeap();
+            elements = InlineData();
+            cap = N;
+            Steal(other);
+        }
+        return *this;
+    }
+
+    ~small_vector() {
+        clear();
+        FreeHeap();
+    }
+
+    iterator begin() {
+        return elements;
+    }
+    iterator end() {
+        return elements + count;
+    }
+    const_iterator begin() const {
+        return elements;
+    }
+    const_iterator end() const {
+        return elements + count;
+    }
+
+    size_type size() const {
+        return count;
+    }
+
+    size_type capacity() const {
+        return cap;
+    }
+
+    // heap bytes in use, for memory reports
+    size_type heap_bytes() const {
+        return IsInline() ? 0 : cap * sizeof(T);
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    T* data() {
+        return elements;
+    }
+    const T* data() const {
+        return elements;
+    }
+
+    T& operator[](size_type idx) {
+        return elements[idx];
+    }
+    const T& operator[](size_type idx) const {
+        return elements[idx];
+    }
+
+    T& at(size_type idx) {
+        if (idx >= count) {
+            throw std::out_of_range("small_vector index out of range");
+        }
+        return elements[idx];
+    }
+    const T& at(size_type idx) const {
+        if (idx >= count) {
+            throw std::out_of_range("small_vector index out of range");
+        }
+        return elements[idx];
+    }
+
+    T& front() {
+        return elements[0];
+    }
+    T& back() {
+        return elements[count - 1];
+    }
+    const T& back() const {
+        return elements[count - 1];
+    }
+
+    void reserve(size_type num) {
+        if (num > cap) {
+            Grow(num);
+        }
+    }
+
+    template<typename ... A>
+    T& emplace_back(A&& ... args) {
+        if (count == cap) {
+            // construct first, in case args refer to an element that growing would move
+            T value(std::forward<A>(args)...);
+            Grow(count + 1);
+            return *new (elements + count++) T(std::move(value));
+        }
+        return *new (elements + count++) T(std::forward<A>(args)...);
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() {
+        std::destroy_at(elements + --count);
+    }
+
+    // erase preserving the order of the rest, like std::vector
+    iterator erase(const_iterator pos) {
+        auto it = elements + (pos - elements);
+        std::move(it + 1, end(), it);
+        pop_back();
+        return it;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        auto it = elements + (first - elements);
+        const auto numErased = size_type(last - first);
+        std::move(it + numErased, end(), it);
+        std::destroy(end() - numErased, end());
+        count -= uint32_t(numErased);
+        return it;
+    }
+
+    void resize(size_type num) {
+        if (num < count) {
+            std::destroy(elements + num, end());
+        }
+        else {
+            reserve(num);
+            std::uninitialized_value_construct(end(), elements + num);
+        }
+        count = uint32_t(num);
+    }
+
+    void clear() {
+        std::destroy(begin(), end());
+        count = 0;
+    }
+};
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cassert>
+#include <phmap.h>
+
+namespace RavEngine {
+
+/**
+ A map that keeps its entries sorted by key in one contiguous vector, so iterating it in order is a linear walk.
+ A hash index gives O(1) lookup by key. Inserting or erasing shifts the entries after it and rebuilds the index, so
+ this suits maps that are iterated far more often than they gain or lose keys.
+ @note References and iterators become invalid when a key is inserted or erased. Do not modify keys through iterators.
+ */
+template<typename K, typename V, typename Compare = std::less<K>>
+class sorted_vector_map {
+public:
+    using value_type = std::pair<K, V>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+    // std::hash specializations in the engine are not always const-callable
+    struct Hasher {
+        size_t operator()(const K& key) const {
+            return std::hash<K>{}(key);
+        }
+    };
+
+    std::vector<value_type> entries;
+    phmap::flat_hash_map<K, uint32_t, Hasher> index;
+
+    void RebuildIndex(size_t from) {
+        for (size_t i = from; i < entries.size(); i++) {
+            index[entries[i].first] = uint32_t(i);
+        }
+    }
+
+public:
+    iterator begin() {
+        return entries.begin();
+    }
+    iterator end() {
+        return entries.end();
+    }
+    const_iterator begin() const {
+        return entries.begin();
+    }
+    const_iterator end() const {
+        return entries.end();
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    bool empty() const {
+        return entries.empty();
+    }
+
+    iterator find(const K& key) {
+        auto it = index.find(key);
+        return it != index.end() ? entries.begin() + it->second : entries.end();
+    }
+
+    const_iterator find(const K& key) const {
+        auto it = index.find(key);
+        return it != index.end() ? entries.begin() + it->second : entries.end();
+    }
+
+    bool contains(const K& key) const {
+        return index.contains(key);
+    }
+
+    V& at(const K& key) {
+        auto it = index.find(key);
+        assert(it != index.end());
+        return entries[it->second].second;
+    }
+
+    /**
+     @return the value for key, default-constructing it in sorted position if it is not present
+     */
+    V& operator[](const K& key) {
+        if (auto it = index.find(key); it != index.end()) {
+            return entries[it->second].second;
+        }
+        auto pos = std::lower_bound(entries.begin(), entries.end(), key, [](const value_type& entry, const K& key) {
+            return Compare{}(entry.first, key);
+        });
+        const auto offset = size_t(pos - entries.begin());
+        entries.emplace(pos, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+        RebuildIndex(offset);
+        return entries[offset].second;
+    }
+
+    /**
+     @return the number of entries removed, 0 or 1
+     */
+    size_t erase(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return 0;
+        }
+        const auto offset = it->second;
+        index.erase(it);
+        entries.erase(entries.begin() + offset);
+        RebuildIndex(offset);
+        return 1;
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+    }
+};
+
+}
@@ -105,6 +105,10 @@ public:
     inline size_type size() const{
         return underlying.size();
     }
+
+    inline size_type capacity() const{
+        return underlying.capacity();
+    }
     
     inline void reserve(size_t num){
         underlying.reserve(num);
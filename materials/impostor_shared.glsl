@@ -0,0 +1,51 @@
+layout(push_constant, std430) uniform UniformBufferObject{
+	vec3 center;
+	float radius;
+	uint framesPerSide;
+	uint hemisphere;
+	float roughness;
+	float specular;
+} ubo;
+
+// mirrors ImpostorEncoding.hpp
+
+vec2 impostorDirectionToGrid(vec3 dir, bool hemisphere){
+    if (hemisphere){
+        dir.y = max(dir.y, 0);
+    }
+    dir /= max(abs(dir.x) + abs(dir.y) + abs(dir.z), 1e-6);
+    vec2 p;
+    if (hemisphere){
+        p = vec2(dir.x + dir.z, dir.x - dir.z);
+    }
+    else{
+        p = dir.xz;
+        if (dir.y < 0){
+            p = (1 - abs(dir.zx)) * vec2(dir.x >= 0 ? 1 : -1, dir.z >= 0 ? 1 : -1);
+        }
+    }
+    return clamp(p * 0.5 + 0.5, vec2(0), vec2(1));
+}
+
+vec3 impostorGridToDirection(vec2 grid, bool hemisphere){
+    const vec2 p = grid * 2 - 1;
+    vec3 dir;
+    if (hemisphere){
+        dir.x = (p.x + p.y) * 0.5;
+        dir.z = (p.x - p.y) * 0.5;
+        dir.y = 1 - abs(dir.x) - abs(dir.z);
+    }
+    else{
+        dir = vec3(p.x, 1 - abs(p.x) - abs(p.y), p.y);
+        const float t = max(-dir.y, 0);
+        dir.x += dir.x >= 0 ? -t : t;
+        dir.z += dir.z >= 0 ? -t : t;
+    }
+    return normalize(dir);
+}
+
+void impostorBasis(vec3 dir, out vec3 right, out vec3 up){
+    const vec3 reference = abs(dir.y) > 0.999 ? vec3(0, 0, -1) : vec3(0, 1, 0);
+    right = normalize(cross(reference, dir));
+    up = cross(dir, right);
+}
@@ -8,27 +8,43 @@ layout(binding = 6) uniform texture2D t_ao;
 layout(binding = 7) uniform texture2D t_emissive;
 
 layout(location = 0) in vec2 inUV;
+#ifndef RVE_ALPHA_CUTOFF    // alpha testing decides which fragments write depth
 layout(early_fragment_tests) in;
+#endif
 
 LitOutput frag()
 {
 	LitOutput mat_out;
 
 	mat_out.color = texture(sampler2D(t_diffuse, g_sampler), inUV) * ubo.colorTint;
+#if RVE_FEATURE_NORMAL_MAP
 	vec3 normal = texture(sampler2D(t_normal, g_sampler), inUV).rgb;
 	normal = normal * 2.0 - 1.0;
+#else
+	vec3 normal = vec3(0, 0, 1);
+#endif
 
 	mat_out.normal = normal;
 
+#if RVE_FEATURE_SURFACE_MAPS
 	float specular = texture(sampler2D(t_specular, g_sampler), inUV).r;
 	float metallic = texture(sampler2D(t_metallic, g_sampler), inUV).r;
 	float roughness = texture(sampler2D(t_roughness, g_sampler), inUV).r;
 	mat_out.ao = texture(sampler2D(t_ao, g_sampler), inUV).r;
+#else
+	// the same as the default textures, so the tints alone set the surface
+	float specular = 1, metallic = 1, roughness = 1;
+	mat_out.ao = 1;
+#endif
 
 	mat_out.roughness = roughness * ubo.roughnessTint;
 	mat_out.specular = specular * ubo.specularTint;
 	mat_out.metallic = metallic * ubo.metallicTint;
+#if RVE_FEATURE_EMISSIVE
 	mat_out.emissiveColor = texture(sampler2D(t_emissive, g_sampler), inUV).rgb;
+#else
+	mat_out.emissiveColor = vec3(0);
+#endif
 
 	return mat_out;
 }
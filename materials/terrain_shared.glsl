@@ -0,0 +1,12 @@
+// matches TerrainPushConstantData in BuiltinMaterials.hpp
+layout(push_constant, std430) uniform UniformBufferObject{
+	vec2 tileOrigin;
+	float tileSize;
+	uint resolution;
+	float skirtDepth;
+	float layerTiling;
+	float roughness;
+	float specular;
+} ubo;
+
+layout(binding = 0) uniform sampler g_sampler;
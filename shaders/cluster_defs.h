@@ -1,4 +1,2 @@
-#define CLUSTER_MAX_POINTS 16
-#define CLUSTER_MAX_SPOTS 16
 #define LIGHT_MIN_INFLUENCE 0.01
 #define SH_MAX_CASCADES 4
@@ -1,13 +1,25 @@
 #include "cluster_defs.h"
 
-struct Cluster
+// view-space bounds, which only change with the projection and the screen size
+struct ClusterBounds
 {
     vec3 minPoint;
     vec3 maxPoint;
+};
+
+// the view-space distances of the nearest and farthest geometry in a screen tile. Near is beyond far if the tile is empty.
+struct TileDepthBounds
+{
+    float nearDistance;
+    float farDistance;
+};
+
+// the cluster's point lights are lightIndices[offset, offset + pointLightCount), followed by its spot lights
+struct Cluster
+{
+    uint offset;
     uint pointLightCount;
     uint spotLightCount;
-    uint pointLightIndices[CLUSTER_MAX_POINTS];
-    uint spotLightIndices[CLUSTER_MAX_SPOTS];
 };
 
 
@@ -21,7 +33,8 @@ struct PointLight
     int castsShadows;
     uint shadowRenderLayers;
     uint illuminationLayers;
-    uint shadowmapBindlessIndices[6];
+    uint shadowmapBindlessIndex;
+    vec4 shadowAtlasRects[6];
 };
 
 struct SpotLight{
@@ -35,6 +48,7 @@ struct SpotLight{
     uint shadowmapBindlessIndex;
     uint shadowRenderLayers;
     uint illuminationLayers;
+    vec4 shadowAtlasRect;
 };
 
 
@@ -1,3 +1,20 @@
 struct ParticleVertexOut{
     vec3 localPosition;
+};
+
+// one emitter's state in a ParticlePool, padded to ParticlePool::stateStride so the renderer can bind it with an offset
+struct ParticleState{
+    uint aliveParticleCount;
+    uint freeListCount;
+    uint createdThisFrame;
+    uint emitterOwnerID;
+    uint padding[60];
+};
+
+// one emitter of a batched particle dispatch, see RenderEngine::ParticleEmitterDispatch
+struct ParticleEmitterDispatch{
+    uint stateSlot;
+    uint particleBase;      // the emitter's particles start here in the pool, particle IDs are relative to it
+    uint maxParticles;
+    uint particlesToSpawn;
 };
\ No newline at end of file
@@ -32,3 +32,26 @@ float pcfForShadow(vec3 pixelWorldPos, mat4 lightViewProj, sampler shadowSampler
 
     return texture(sampler2DShadow(t_depthshadow,shadowSampler), sampledPos.xyz, 0).x;
 }
+
+// like pcfForShadow, but for a tile of a shadow atlas. atlasRect is the tile's offset (xy) and size (zw) in atlas UVs.
+float pcfForShadowAtlas(vec3 pixelWorldPos, mat4 lightViewProj, vec4 atlasRect, sampler shadowSampler, texture2D t_atlas){
+	if (atlasRect.z <= 0){
+		return 1;	// the light did not get a tile this frame
+	}
+	vec4 sampledPos = vec4(pixelWorldPos,1);
+	sampledPos = lightViewProj * sampledPos;
+	sampledPos /= sampledPos.w;
+	sampledPos.xy = sampledPos.xy * 0.5 + 0.5;
+	sampledPos.y = 1 - sampledPos.y;
+
+	// outside the tile is another light's shadow map
+	if (sampledPos.z > 1 || sampledPos.z < 0 || any(lessThan(sampledPos.xy, vec2(0))) || any(greaterThan(sampledPos.xy, vec2(1)))){
+		return 1;
+	}
+
+	// keep the filter footprint inside the tile
+	const vec2 halfTexel = 0.5 / vec2(textureSize(sampler2DShadow(t_atlas,shadowSampler), 0));
+	vec2 atlasUV = clamp(atlasRect.xy + sampledPos.xy * atlasRect.zw, atlasRect.xy + halfTexel, atlasRect.xy + atlasRect.zw - halfTexel);
+
+    return texture(sampler2DShadow(t_atlas,shadowSampler), vec3(atlasUV, sampledPos.z), 0).x;
+}
@@ -0,0 +1,41 @@
+// A cached sky is a row of six square cube faces in one 2D texture, in the order +X, -X, +Y, -Y, +Z, -Z.
+// Must match RenderEngine::UpdateSkyCache, which renders the faces.
+
+const uint skyCacheFaceCount = 6;
+
+void skyCacheFaceBasis(uint face, out vec3 forward, out vec3 up, out vec3 right){
+    const uint axis = face / 2u;
+    const float s = (face % 2u == 0u) ? 1.0 : -1.0;
+    forward = vec3(0);
+    forward[axis] = s;
+    up = axis == 1u ? vec3(0, 0, s) : vec3(0, 1, 0);
+    right = cross(forward, up);
+}
+
+// where a world space direction is in the face row. faceResolution is the height of the texture
+vec2 skyCacheUV(vec3 dir, float faceResolution){
+    const vec3 a = abs(dir);
+    const uint axis = (a.x >= a.y && a.x >= a.z) ? 0u : (a.y >= a.z ? 1u : 2u);
+    const uint face = axis * 2u + (dir[axis] < 0 ? 1u : 0u);
+
+    vec3 forward, up, right;
+    skyCacheFaceBasis(face, forward, up, right);
+
+    // project onto the face, which is 0.5 units in front of the origin and 1 unit across
+    const vec3 p = dir * (0.5 / a[axis]);
+    vec2 local = vec2(dot(p, right), dot(p, up)) + 0.5;
+
+    // keep bilinear taps off the neighboring faces
+    const float halfTexel = 0.5 / faceResolution;
+    local = clamp(local, halfTexel, 1 - halfTexel);
+
+    return vec2((float(face) + local.x) / float(skyCacheFaceCount), local.y);
+}
+
+// the irradiance of the sky on a surface facing normal, from the ambient cube written by sky_irradiance.fsh
+vec3 skyCacheIrradiance(texture2D irradiance, vec3 normal){
+    const vec3 n2 = normal * normal;
+    return texelFetch(irradiance, ivec2(normal.x >= 0 ? 0 : 1, 0), 0).rgb * n2.x
+        + texelFetch(irradiance, ivec2(normal.y >= 0 ? 2 : 3, 0), 0).rgb * n2.y
+        + texelFetch(irradiance, ivec2(normal.z >= 0 ? 4 : 5, 0), 0).rgb * n2.z;
+}
@@ -0,0 +1,22 @@
+// Reports the mips a material samples from its StreamingTextures, see TextureStreamer::GetFeedbackBuffer.
+// Define TEXTURE_STREAMING_BINDING to the buffer slot the feedback buffer is bound to before including this file.
+
+#ifndef TEXTURE_STREAMING_BINDING
+#define TEXTURE_STREAMING_BINDING 7
+#endif
+
+layout(std430, binding = TEXTURE_STREAMING_BINDING) buffer TextureStreamingFeedback {
+	uint requestedMips[];
+} textureStreamingFeedback;
+
+// slot is StreamingTexture::GetFeedbackSlot, and fullSize is StreamingTexture::GetFullSize, because the resident texture may be smaller
+void RequestStreamingTextureMip(uint slot, vec2 uv, vec2 fullSize){
+	vec2 dx = dFdx(uv * fullSize);
+	vec2 dy = dFdy(uv * fullSize);
+	uint mip = uint(max(floor(0.5 * log2(max(dot(dx, dx), dot(dy, dy)))), 0));
+
+	// most fragments request a mip that is already reported, skip the atomic for them
+	if (textureStreamingFeedback.requestedMips[slot] > mip){
+		atomicMin(textureStreamingFeedback.requestedMips[slot], mip);
+	}
+}
@@ -2,6 +2,7 @@
 #include "App.hpp"
 #include "Function.hpp"
 #include <ozz/base/io/archive.h>
+#include <ozz/base/io/stream.h>
 #include <ozz/base/maths/simd_math.h>
 #include <ozz/animation/runtime/blending_job.h>
 #include <ozz/animation/offline/raw_animation.h>
@@ -14,6 +15,7 @@
 #include "VirtualFileSystem.hpp"
 #include "SkeletonAsset.hpp"
 #include "Animation.hpp"
+#include <array>
 
 using namespace RavEngine;
 using namespace std;
@@ -58,14 +60,17 @@ void ReadNFromMem(uint8_t*& fp, T* dest, uint32_t count) {
 	fp += nbytes;
 }
 
+static void CheckHeader(const SerializedJointAnimationHeader& header) {
+	if (strncmp(header.header.data(), "rvea", sizeof("rvea") - 1) != 0) {
+		Debug::Fatal("Header does not match, data is not an animation!");
+	}
+}
+
 JointAnimation DeserializeJointAnimation(const std::span<uint8_t> data) {
 	uint8_t* fp = data.data();
 	auto header = ReadBytesFromMem<SerializedJointAnimationHeader>(fp);
 
-	// check header
-	if (strncmp(header.header.data(), "rvea", sizeof("rvea") - 1) != 0) {
-		Debug::Fatal("Header does not match, data is not a mesh!");
-	}
+	CheckHeader(header);
 
 	JointAnimation anim{
 		.duration = header.duration,
@@ -93,23 +98,52 @@ JointAnimation DeserializeJointAnimation(const std::span<uint8_t> data) {
 	return anim;
 }
 
-AnimationAsset::AnimationAsset(const std::string& name){
-	auto path = Format("animations/{}.rvea", name);
-	if(GetApp()->GetResources().Exists(path.c_str())){
-		
-		auto data = GetApp()->GetResources().FileContentsAt(path.c_str());
-		auto anim = DeserializeJointAnimation(data);
+AnimationAsset::AnimationAsset(const std::string& name) : path(Format("animations/{}.rvea", name)){
+	if(!GetApp()->GetResources().Exists(path.c_str())){
+		Debug::Fatal("No file at {}",path);
+	}
+
+	// only the header is needed until the clip is sampled
+	std::array<uint8_t, sizeof(SerializedJointAnimationHeader)> headerData;
+	auto nread = GetApp()->GetResources().FilePrefixAt(path.c_str(), headerData);
+	Debug::Assert(nread == headerData.size(), "{} is too short to be an animation", path);
+	uint8_t* fp = headerData.data();
+	auto header = ReadBytesFromMem<SerializedJointAnimationHeader>(fp);
+	CheckHeader(header);
+
+	tps = header.ticksPerSecond;
+	duration_seconds = header.duration / tps;
+}
+
+void AnimationAsset::Load() const{
+	std::call_once(loaded, [this] {
+		auto data = GetApp()->GetResources().FileContentsAt(path.c_str(), false);
+		uint8_t* fp = data.data();
+		auto header = ReadBytesFromMem<SerializedJointAnimationHeader>(fp);
+
+		if (header.encoding == SerializedJointAnimationHeader::Encoding::OzzArchive) {
+			// already optimized and quantized by rveac, so it is used as-is
+			fp += header.nameLength;
+			ozz::io::MemoryStream stream;
+			stream.Write(fp, data.data() + data.size() - fp);
+			stream.Seek(0, ozz::io::Stream::kSet);
+			ozz::io::IArchive archive(&stream);
+			Debug::Assert(archive.TestTag<ozz::animation::Animation>(), "{} does not contain an ozz animation", path);
+			auto loadedAnim = ozz::make_unique<ozz::animation::Animation>();
+			archive >> *loadedAnim;
+			anim = std::move(loadedAnim);
+			return;
+		}
+
+		auto jointAnim = DeserializeJointAnimation(data);
 
 		// convert to ozz
 		ozz::animation::offline::RawAnimation raw_animation;
-		raw_animation.duration = anim.duration;
-		raw_animation.name = anim.name;
-		raw_animation.tracks.reserve(anim.tracks.size());
+		raw_animation.duration = jointAnim.duration;
+		raw_animation.name = jointAnim.name;
+		raw_animation.tracks.reserve(jointAnim.tracks.size());
 
-        tps = anim.ticksPerSecond;;
-		duration_seconds = anim.duration / tps;
-
-		for (const auto& src_track : anim.tracks) {
+		for (const auto& src_track : jointAnim.tracks) {
 			auto& track = raw_animation.tracks.emplace_back();
 			{
 				track.translations.reserve(src_track.translations.size());
@@ -132,15 +166,11 @@ AnimationAsset::AnimationAsset(const std::string& name){
 				}
 			}
 		}
-		Debug::Assert(raw_animation.Validate(),"Animation {} failed validation",name);
+		Debug::Assert(raw_animation.Validate(),"Animation {} failed validation",path);
 
 		ozz::animation::offline::AnimationBuilder builder;
-		this->anim = std::move(builder(raw_animation));
-		
-	}
-	else{
-		Debug::Fatal("No file at {}",path);
-	}
+		anim = builder(raw_animation);
+	});
 }
 
 void IAnimGraphable::SampleDirect(float t, const ozz::animation::Animation *anim, ozz::animation::SamplingJob::Context &cache, ozz::vector<ozz::math::SoaTransform> &locals) const{
@@ -164,7 +194,7 @@ bool AnimationAsset::Sample(float time, float start, float speed, bool looping,
 		ret = t >= 1;
 	}
 	
-	SampleDirect(t, anim.get(), cache, locals);
+	SampleDirect(t, GetAnim().get(), cache, locals);
 	return ret;
 }
 
@@ -7,7 +7,11 @@
 #include "Debug.hpp"
 #include "Transform.hpp"
 #include "SkeletonAsset.hpp"
+#include "Utilities.hpp"
 #include <utility>
+#include <span>
+#include <atomic>
+#include <bit>
 
 using namespace RavEngine;
 using namespace std;
@@ -17,6 +21,34 @@ inline float distance(const clamped_vec2& p1, const clamped_vec2& p2){
 	return std::sqrt(std::pow(p2.get_x() - p1.get_x(), 2) + std::pow(p2.get_y() - p1.get_y(), 2));
 }
 
+// ozz and glm matrices are both column major
+static inline void StoreMatrix(const ozz::math::Float4x4& m, float* dest){
+	for (int c = 0; c < 4; c++) {
+		ozz::math::StorePtrU(m.cols[c], dest + c * 4);
+	}
+}
+
+static inline matrix4 ToMatrix4(const ozz::math::Float4x4& m){
+	glm::mat4 result;
+	StoreMatrix(m, glm::value_ptr(result));
+	return matrix4(result);
+}
+
+static inline void HashCombine(uint64_t& hash, uint64_t value){
+	hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+}
+
+struct AnimatorComponent::SharedPose{
+	ozz::vector<ozz::math::Float4x4> models, skinningmats;
+	uint64_t skinningMatsHash = 1;
+};
+
+STATIC(AnimatorComponent::sharedPoses);
+
+void AnimatorComponent::ClearSharedPoses(){
+	sharedPoses.clear();
+}
+
 
 /**
 Transitions to the new state. If the current state has a transition to the target state, that transition is played.
@@ -31,8 +63,16 @@ Create an AnimatorComponent with a SkeletonAsset
 */
 
 RavEngine::AnimatorComponent::AnimatorComponent(Ref<SkeletonAsset> sk) {
+	static std::atomic<uint32_t> nextLODFrame = 0;
+	lodFrame = nextLODFrame++;
 	UpdateSkeletonData(sk);
 }
+
+void AnimatorComponent::SetLODs(std::span<const LOD> newLODs){
+	Debug::Assert(std::is_sorted(newLODs.begin(), newLODs.end(), [](const LOD& a, const LOD& b){ return a.minDistance < b.minDistance; }), "LODs must be in order of increasing minDistance");
+	lods.assign(newLODs.begin(), newLODs.end());
+	currentLOD = 0;
+}
 RavEngine::AnimatorComponent::State& RavEngine::AnimatorComponent::Layer::GetStateForID(anim_id_t id){
     if (states.contains(id)){
         return states.at(id);
@@ -105,19 +145,67 @@ void RavEngine::AnimatorComponent::Layer::Pause() {
 	isPlaying = false;
 }
 
-void AnimatorComponent::Tick(const Transform& t){
+void AnimatorComponent::Tick(const Transform& t, float viewDistance){
+    // choose the level of detail
+    LOD lod;
+    currentLOD = 0;
+    for (uint8_t i = 1; i < lods.size(); i++) {
+        if (viewDistance >= lods[i].minDistance) {
+            currentLOD = i;
+        }
+    }
+    if (!lods.empty()) {
+        lod = lods[currentLOD];
+    }
+    
+    skippedTimeScale += GetApp()->GetCurrentFPSScale();
+    if (lod.updateInterval > 1 && lodFrame++ % lod.updateInterval != 0) {
+        return;
+    }
+    const auto timeScale = skippedTimeScale;
+    skippedTimeScale = 0;
+    
+    // animators in step share one pose, evaluated by whichever ticks first
+    const auto currentTime = GetApp()->GetCurrentTime();
+    uint64_t poseKey = uint64_t(uintptr_t(skeleton.get()));
+    bool sharing = poseSharingQuantum > 0 && lod.updatePose;
+    for (uint16_t index = 0; sharing && index < std::min<size_t>(layers.size(), lod.maxLayers); index++) {
+        sharing = layers[index]->HashSharedState(poseKey, currentTime, poseSharingQuantum);
+    }
+    if (sharing) {
+        std::shared_ptr<const SharedPose> found;
+        sharedPoses.if_contains(poseKey, [&found](const auto& pose) {
+            found = pose;
+        });
+        if (found) {
+            // shareable layers only sample, so there is no state machine to advance
+            sharedPose = std::move(found);
+            skinningMatsHash = sharedPose->skinningMatsHash;
+            worldMatrix = t.GetWorldMatrix();
+            UpdateSockets();
+            return;
+        }
+    }
+    
     // tick every layer
     static thread_local ozz::animation::BlendingJob::Layer blend_layers[kmax_layers];
     static thread_local ozz::animation::BlendingJob::Layer additive_blend_layers[kmax_layers];
     
-    auto setupLayers = [this]<bool isAdditive>(auto&& blend_layers){
+    auto setupLayers = [this, &lod, timeScale, currentTime, sharing]<bool isAdditive>(auto&& blend_layers){
         uint16_t i = 0;
-        for(auto& layer : layers){
+        for(uint16_t index = 0; index < layers.size(); index++){
+            auto& layer = layers[index];
             if(layer->isAdditive != isAdditive)
             {
                 continue;       // filter out the wrong type
             }
-            layer->Tick(skeleton);
+            if (index >= lod.maxLayers || layer->GetWeight() <= layerCullWeight) {
+                layer->skippedTimeScale += timeScale;   // catches up on the time when it is evaluated again
+                layer->ReleaseContexts();
+                continue;
+            }
+            layer->Tick(skeleton, timeScale + layer->skippedTimeScale, sharing ? layer->sharedSampleTime : currentTime);
+            layer->skippedTimeScale = 0;
             
             blend_layers[i].transform = ozz::make_span(layer->transforms);
             blend_layers[i].weight = layer->GetWeight();
@@ -132,11 +220,14 @@ void AnimatorComponent::Tick(const Transform& t){
     auto numLayers = setupLayers.operator()<false>(blend_layers);
     auto numAdditiveLayers = setupLayers.operator()<true>(additive_blend_layers);
     
+    if (!lod.updatePose) {
+        return;
+    }
     
     // blend layers, write to all_transforms
     
     ozz::animation::BlendingJob blend_job;
-    blend_job.threshold = 0.1f;            //TODO: make threshold configurable
+    blend_job.threshold = blendThreshold;
     blend_job.layers = ozz::span(blend_layers,numLayers);
     blend_job.additive_layers = ozz::span(additive_blend_layers,numAdditiveLayers);
     blend_job.rest_pose = skeleton->GetSkeleton()->joint_rest_poses();
@@ -157,24 +248,87 @@ void AnimatorComponent::Tick(const Transform& t){
         Debug::Fatal("local to model job failed");
     }
     
-    // create pose-bindpose skinning matrices
-    auto& pose = GetLocalPose();
-    auto& bindpose = skeleton->GetBindposes();
+    // create pose-bindpose skinning matrices. They stay in SIMD form, WriteSkinningMats stores them where they are needed.
+    auto& inverseBindposes = skeleton->GetInverseBindposes();
     for(int i = 0; i < skinningmats.size(); i++){
-        skinningmats[i] = pose[i] * matrix4(bindpose[i]);
+        skinningmats[i] = models[i] * inverseBindposes[i];
+    }
+    {
+        uint64_t hash = skinningmats.size();
+        const auto words = std::span(reinterpret_cast<const uint32_t*>(skinningmats.data()), skinningmats.size() * sizeof(ozz::math::Float4x4) / sizeof(uint32_t));
+        for (const auto word : words) {
+            HashCombine(hash, word);
+        }
+        skinningMatsHash = hash == 0 ? 1 : hash;
     }
     
-    // update world poses
-    GetPose(t);
+    // world poses are made on demand, sockets only need their joint
+    worldMatrix = t.GetWorldMatrix();
+    UpdateSockets();
+    
+    sharedPose.reset();
+    if (sharing) {
+        auto pose = std::make_shared<SharedPose>();
+        pose->models = models;
+        pose->skinningmats = skinningmats;
+        pose->skinningMatsHash = skinningMatsHash;
+        sharedPoses.try_emplace(poseKey, std::move(pose));
+    }
 }
 
-void AnimatorComponent::Layer::Tick(const Ref<SkeletonAsset>& skeleton){
+bool AnimatorComponent::Layer::HashSharedState(uint64_t& key, double currentTime, double quantum){
+    if (!isPlaying || isBlending) {
+        return false;
+    }
+    HashCombine(key, isAdditive);
+    HashCombine(key, std::bit_cast<uint32_t>(weight));
+    HashCombine(key, skeletonMask ? uintptr_t(skeletonMask.value().get()) : 0);
+    sharedSampleTime = currentTime;
+    if (!states.contains(currentState)) {
+        HashCombine(key, 0);    // in the rest pose
+        return true;
+    }
+    auto& state = GetStateForID(currentState);
+    if (!state.isLooping) {
+        return false;   // it has to be sampled to find when it ends
+    }
+    const auto start = std::max(lastPlayTime, state.lastPlayTime);
+    const auto steps = std::floor((currentTime - start) / quantum);
+    sharedSampleTime = start + steps * quantum;
+    HashCombine(key, uintptr_t(state.clip.get()));
+    HashCombine(key, std::bit_cast<uint32_t>(state.speed));
+    HashCombine(key, uint64_t(int64_t(steps)));
+    return true;
+}
+
+const ozz::vector<ozz::math::Float4x4>& AnimatorComponent::ActiveModels() const{
+    return sharedPose ? sharedPose->models : models;
+}
+
+const decltype(AnimatorComponent::skinningmats)& AnimatorComponent::GetSkinningMats() const{
+    return sharedPose ? sharedPose->skinningmats : skinningmats;
+}
+
+void AnimatorComponent::WriteSkinningMats(std::span<glm::mat4> dest) const{
+    const auto& mats = GetSkinningMats();
+    Debug::Assert(dest.size() >= mats.size(), "Not enough room for the skinning matrices");
+    for (size_t i = 0; i < mats.size(); i++) {
+        StoreMatrix(mats[i], glm::value_ptr(dest[i]));
+    }
+}
+
+// the context in the handle, taking one from the pool if it is empty
+static ozz::animation::SamplingJob::Context& ContextFor(SamplingContextPool::Handle& handle, const Ref<SkeletonAsset>& skeleton){
+    if (!handle){
+        handle = SamplingContextPool::Acquire(skeleton->GetSkeleton()->num_joints());
+    }
+    return *handle;
+}
+
+void AnimatorComponent::Layer::Tick(const Ref<SkeletonAsset>& skeleton, float timeScale, double currentTime){
 	//skip calculation
     if(isPlaying){
         
-        auto timeScale = GetApp()->GetCurrentFPSScale();
-        
-        auto currentTime = GetApp()->GetCurrentTime();
         //if isBlending, need to calculate both states, and blend between them
         if (isBlending){
             
@@ -187,9 +341,8 @@ void AnimatorComponent::Layer::Tick(const Ref<SkeletonAsset>& skeleton){
                 currentBlendingValue = stateBlend.currentTween.step((float)timeScale / stateBlend.currentTween.duration());
             }
             
-            auto& cref = *cache;
-            fromState.clip->Sample(currentTime, std::max(lastPlayTime,fromState.lastPlayTime), fromState.speed, fromState.isLooping, transforms, cref, skeleton->GetSkeleton().get());
-            bool toDone = toState.clip->Sample(currentTime, std::max(lastPlayTime,toState.lastPlayTime), toState.speed, toState.isLooping, transformsSecondaryBlending, cref, skeleton->GetSkeleton().get());
+            fromState.clip->Sample(currentTime, std::max(lastPlayTime,fromState.lastPlayTime), fromState.speed, fromState.isLooping, transforms, ContextFor(cache, skeleton), skeleton->GetSkeleton().get());
+            bool toDone = toState.clip->Sample(currentTime, std::max(lastPlayTime,toState.lastPlayTime), toState.speed, toState.isLooping, transformsSecondaryBlending, ContextFor(blendCache, skeleton), skeleton->GetSkeleton().get());
             
             //blend into output
             ozz::animation::BlendingJob::Layer layers[2];
@@ -203,6 +356,9 @@ void AnimatorComponent::Layer::Tick(const Ref<SkeletonAsset>& skeleton){
             //when the tween is finished, isBlending = false
             if (stateBlend.currentTween.progress() >= 1.0){
                 isBlending = false;
+                // the target state keeps its context
+                std::swap(cache, blendCache);
+                blendCache.reset();
                 if (toDone) {
                     EndState(toState,stateBlend.from);
                 }
@@ -219,10 +375,10 @@ void AnimatorComponent::Layer::Tick(const Ref<SkeletonAsset>& skeleton){
             }
         }
         else{
+            blendCache.reset();
             if (states.contains(currentState)){
                 auto& state = GetStateForID(currentState);
-                auto& cref = *cache;
-                if (state.clip->Sample(currentTime, std::max(lastPlayTime, state.lastPlayTime), state.speed, state.isLooping, transforms, cref, skeleton->GetSkeleton().get())) {
+                if (state.clip->Sample(currentTime, std::max(lastPlayTime, state.lastPlayTime), state.speed, state.isLooping, transforms, ContextFor(cache, skeleton), skeleton->GetSkeleton().get())) {
                     EndState(state,currentState);
                 }
             }
@@ -234,20 +390,60 @@ void AnimatorComponent::Layer::Tick(const Ref<SkeletonAsset>& skeleton){
             }
         }
     }
+    else{
+        // a paused layer keeps its pose, so it does not need to sample
+        ReleaseContexts();
+    }
+}
 
+static void MoveToSocket(const matrix4& mat, Transform& t){
+	//TODO: set matrix directly instead of with decompose?
+	auto translate = mat[3];
+	auto rotation = glm::quat_cast(mat);
+	
+	t.SetWorldPosition(translate);
+	t.SetWorldRotation(rotation);
+}
+
+AnimatorComponent::SocketHandle AnimatorComponent::AddSocket(const std::string_view boneName){
+	if (!skeleton->HasBone(boneName)) {
+		Debug::Fatal("Cannot add a socket to nonexistent bone {}", boneName);
+	}
+	return AddSocket(StringID(boneName));
+}
+
+AnimatorComponent::SocketHandle AnimatorComponent::AddSocket(StringID boneName){
+	auto joint = skeleton->IndexForBone(boneName);
+	if (!joint) {
+		Debug::Fatal("Cannot add a socket to nonexistent bone {:016x}", boneName.value);
+	}
+	if (auto it = std::find(socketJoints.begin(), socketJoints.end(), *joint); it != socketJoints.end()) {
+		return SocketHandle(it - socketJoints.begin());
+	}
+	Debug::Assert(socketJoints.size() < std::numeric_limits<SocketHandle>::max(), "Too many sockets");
+	socketJoints.push_back(*joint);
+	socketMatrices.push_back(worldMatrix * ToMatrix4(ActiveModels()[*joint]));
+	return SocketHandle(socketJoints.size() - 1);
+}
+
+void AnimatorComponent::UpdateSockets(){
+	const auto& models = ActiveModels();
+	for (uint16_t i = 0; i < socketJoints.size(); i++) {
+		socketMatrices[i] = worldMatrix * ToMatrix4(models[socketJoints[i]]);
+	}
+}
+
+void AnimatorComponent::UpdateSocket(SocketHandle socket, Transform& t) const{
+	MoveToSocket(socketMatrices[socket], t);
 }
 
 void AnimatorComponent::UpdateSocket(const std::string& name, Transform& t) const{
-	for (int i = 0; i < skeleton->GetSkeleton()->num_joints(); i++) {
-		auto name = skeleton->GetSkeleton()->joint_names()[i];
-		//TODO: set matrix directly instead of with decompose?
-        auto& mat = glm_pose[i];
+	UpdateSocket(StringID(name), t);
+}
 
-        auto translate = mat[3];
-        auto rotation = glm::quat_cast(mat);
-		
-		t.SetWorldPosition(translate);
-		t.SetWorldRotation(rotation);
+void AnimatorComponent::UpdateSocket(StringID name, Transform& t) const{
+	if (auto joint = skeleton->IndexForBone(name)) {
+		MoveToSocket(worldMatrix * ToMatrix4(ActiveModels()[*joint]), t);
 	}
 }
 
@@ -276,8 +472,8 @@ void RavEngine::AnimatorComponent::Layer::UpdateBuffers(const Ref<SkeletonAsset>
     transforms.resize(n_joints_soa);
     transformsSecondaryBlending.resize(n_joints_soa);
     
-    const auto n_joints = skeleton->GetSkeleton()->num_joints();
-    cache->Resize(n_joints);
+    // the new skeleton may need larger contexts
+    ReleaseContexts();
     
     //set all to skeleton bind pose
     for(int i = 0; i < transforms.size(); i++){
@@ -301,40 +497,18 @@ Get the current pose of the animation in world space
 */
 
 const decltype(RavEngine::AnimatorComponent::glm_pose)& RavEngine::AnimatorComponent::GetPose(const Transform& t) const {
-	decimalType matrix[16]{ 0 };
 	auto worldMat = t.GetWorldMatrix();
+	const auto& models = ActiveModels();
 	for (int i = 0; i < models.size(); i++) {
-		auto& t = models[i];
-		for (int r = 0; r < 4; r++) {
-			float result[4];
-			std::memcpy(result, t.cols + r, sizeof(t.cols[r]));
-			decimalType dresult[4];
-			for (int j = 0; j < 4; j++) {
-				dresult[j] = result[j];
-			}
-			//_mm_store_ps(result,p.cols[r]);
-			std::memcpy(matrix + r * 4, dresult, sizeof(dresult));
-		}
-		glm_pose[i] = worldMat * glm::make_mat4(matrix);
+		glm_pose[i] = worldMat * ToMatrix4(models[i]);
 	}
 	return glm_pose;
 }
 
 const decltype(RavEngine::AnimatorComponent::local_pose)& RavEngine::AnimatorComponent::GetLocalPose() {
-	decimalType matrix[16];
+	const auto& models = ActiveModels();
 	for (int i = 0; i < models.size(); i++) {
-		auto& t = models[i];
-		for (int r = 0; r < 4; r++) {
-			float result[4];
-			std::memcpy(result, t.cols + r, sizeof(t.cols[r]));
-			decimalType dresult[4];
-			for (int j = 0; j < 4; j++) {
-				dresult[j] = result[j];
-			}
-			//_mm_store_ps(result,p.cols[r]);
-			std::memcpy(matrix + r * 4, dresult, sizeof(dresult));
-		}
-		local_pose[i] = glm::make_mat4(matrix);
+		local_pose[i] = ToMatrix4(models[i]);
 	}
 	return local_pose;
 }
@@ -344,32 +518,40 @@ bool AnimBlendTree::Node::Sample(float t, float start, float speed, bool looping
 }
 
 bool AnimBlendTree::Sample(float t, float start, float speed, bool looping, ozz::vector<ozz::math::SoaTransform> &output, ozz::animation::SamplingJob::Context &cache, const ozz::animation::Skeleton* skeleton) const{
-	//iterate though the nodes, sample all, and blend
+	//iterate though the nodes, sample the ones with influence, and blend
 	//calculate the subtracks
 	static thread_local ozz::animation::BlendingJob::Layer layers[kmax_nodes];
 	Debug::Assert(states.size() <= kmax_nodes, "An AnimBlendTree can have a maximum of {} nodes",kmax_nodes);
-	//stackarray(layers, ozz::animation::BlendingJob::Layer, states.size());
 	int index = 0;
 	for(auto& row : states){
 		Sampler& sampler = const_cast<Sampler&>(row.second);	//TODO: avoid const_cast
 		
+		//the influence is calculated as 1 - (distance from control point)
+		const float weight = 1.0f - distance(blend_pos, sampler.node.graph_pos) * sampler.node.max_influence;
+		if (weight <= nodeCullWeight) {
+			sampler.context.reset();
+			continue;
+		}
+		
 		//make sure the buffers are the correct size
 		if (sampler.locals.size() != skeleton->num_soa_joints()){
 			sampler.locals.resize(skeleton->num_soa_joints());
 		}
+		if (!sampler.context || sampler.context->max_tracks() < skeleton->num_joints()) {
+			sampler.context = SamplingContextPool::Acquire(skeleton->num_joints());
+		}
 
-		row.second.node.Sample(t, start, speed, looping, sampler.locals,cache,skeleton);
+		sampler.node.Sample(t, start, speed, looping, sampler.locals, *sampler.context, skeleton);
 		
 		//populate layers
 		layers[index].transform = ozz::make_span(sampler.locals);
-		//the influence is calculated as 1 - (distance from control point)
-		layers[index].weight = 1.0 - distance(blend_pos, sampler.node.graph_pos) * sampler.node.max_influence;
+		layers[index].weight = weight;
 		index++;
 	}
 	
 	ozz::animation::BlendingJob blend_job;
-	blend_job.threshold = 0.1;			//TODO: make threshold configurable
-	blend_job.layers = ozz::span(layers,states.size());
+	blend_job.threshold = blendThreshold;
+	blend_job.layers = ozz::span(layers,index);
 	blend_job.rest_pose = skeleton->joint_rest_poses();
 	blend_job.output = make_span(output);
 	
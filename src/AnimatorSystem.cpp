@@ -0,0 +1,42 @@
+#include "AnimatorSystem.hpp"
+#include "World.hpp"
+#include "Transform.hpp"
+#if !RVE_SERVER
+#include "CameraComponent.hpp"
+#endif
+#include <cmath>
+
+using namespace RavEngine;
+
+void AnimatorSystem::before(World* world) const{
+	AnimatorComponent::ClearSharedPoses();
+	viewers->clear();
+#if !RVE_SERVER
+	if (auto cameras = world->GetAllComponentsOfType<CameraComponent>()) {
+		const auto referenceTan = std::tan(deg_to_rad(30.0f));
+		for (const auto& camera : *cameras) {
+			if (!camera.IsActive()) {
+				continue;
+			}
+			// a narrower field of view magnifies, which is the same as being closer
+			viewers->push_back({
+				.position = camera.GetOwner().GetTransform().GetWorldPosition(),
+				.distanceScale = float(std::tan(deg_to_rad(camera.FOV / 2)) / referenceTan)
+			});
+		}
+	}
+#endif
+}
+
+void AnimatorSystem::operator()(AnimatorComponent& c, const Transform& t) const{
+	// with no viewers, such as on a server, every animator updates fully
+	float viewDistance = 0;
+	if (!c.GetLODs().empty() && !viewers->empty()) {
+		const auto pos = t.GetWorldPosition();
+		viewDistance = std::numeric_limits<float>::max();
+		for (const auto& viewer : *viewers) {
+			viewDistance = std::min(viewDistance, float(glm::distance(pos, viewer.position)) * viewer.distanceScale);
+		}
+	}
+	c.Tick(t, viewDistance);
+}
@@ -16,6 +16,7 @@
     #include <RGL/CommandBuffer.hpp>
     #include "OpenXRIntegration.hpp"
 	#include "BuiltinTonemap.hpp"
+	#include "PerformanceOverlay.hpp"
 #endif
 #include <algorithm>
 #include "MeshAsset.hpp"
@@ -32,8 +33,12 @@
 
 #include "CameraComponent.hpp"
 #include <csignal>
+#include <atomic>
+#include <thread>
+#include <array>
 #include "Debug.hpp"
 #include "Profile.hpp"
+#include "SystemInfo.hpp"
 
 #ifdef _WIN32
 	#include <Windows.h>
@@ -73,6 +78,41 @@ void RGLmsgCallback(RGL::MessageSeverity severity, const std::string& msg, void*
 };
 #endif
 
+namespace {
+	size_t FrameWorkers(const ExecutorConfig& config) {
+#if SINGLE_THREADED
+		return 1;	// use main thread only on emscripten
+#else
+		// leave room for the main and audio threads. At least 2, and can't underflow on 1-2 core machines
+		return config.frameWorkers > 0 ? config.frameWorkers : std::max<size_t>(std::thread::hardware_concurrency(), 4) - 2;
+#endif
+	}
+
+	size_t BackgroundWorkers(const ExecutorConfig& config) {
+#if SINGLE_THREADED
+		return 1;
+#else
+		return config.backgroundWorkers > 0 ? config.backgroundWorkers : std::max<size_t>(std::thread::hardware_concurrency() / 4, 1);
+#endif
+	}
+
+	// frame workers stay on performance cores, where a slow worker can't hold up the frame
+	struct FrameWorkerInterface : public tf::WorkerInterface {
+		void scheduler_prologue(tf::Worker& worker) final {
+			SystemInfo::PlaceCurrentThread(SystemInfo::ThreadRole::LatencyCritical);
+		}
+		void scheduler_epilogue(tf::Worker& worker, std::exception_ptr ptr) final {}
+	};
+
+	// lowers the priority of background threads and moves them to efficiency cores, so the OS runs frame work first when cores are busy
+	struct BackgroundWorkerInterface : public tf::WorkerInterface {
+		void scheduler_prologue(tf::Worker& worker) final {
+			SystemInfo::PlaceCurrentThread(SystemInfo::ThreadRole::Background);
+		}
+		void scheduler_epilogue(tf::Worker& worker, std::exception_ptr ptr) final {}
+	};
+}
+
 // on crash, call this
 void crash_signal_handler(int signum) {
 	::signal(signum, SIG_DFL);
@@ -80,6 +120,15 @@ void crash_signal_handler(int signum) {
 	::raise(SIGABRT);
 }
 
+#if RVE_SERVER
+// set by Quit, or by an interrupt or terminate signal, and checked once per tick
+static std::atomic<bool> serverQuitRequested = false;
+
+void quit_signal_handler(int signum) {
+	serverQuitRequested = true;
+}
+#endif
+
 /**
  GameNetworkingSockets debug log function
  */
@@ -94,12 +143,18 @@ static void DebugOutput( ESteamNetworkingSocketsDebugOutputType eType, const cha
 	}
 }
 
-App::App()
+App::App(const ExecutorConfig& executorConfig) :
+	executor(FrameWorkers(executorConfig), tf::make_worker_interface<FrameWorkerInterface>()),
+	backgroundExecutor(BackgroundWorkers(executorConfig), tf::make_worker_interface<BackgroundWorkerInterface>())
 {
     currentApp = this;
 	// crash signal handlers
 	::signal(SIGSEGV, &crash_signal_handler);
 	::signal(SIGABRT, &crash_signal_handler);
+#if RVE_SERVER
+	::signal(SIGINT, &quit_signal_handler);
+	::signal(SIGTERM, &quit_signal_handler);
+#endif
 
 	//initialize virtual file system library
 #if __ANDROID__
@@ -118,18 +173,47 @@ App::App()
 #endif
 }
 
+void App::InitNetworking() {
+	std::call_once(networkingOnce, [this] {
+		SteamDatagramErrMsg errMsg;
+		if (!GameNetworkingSockets_Init(nullptr, errMsg)) {
+			Debug::Fatal("Networking initialization failed: {}", errMsg);
+		}
+		SteamNetworkingUtils()->SetDebugOutputFunction(k_ESteamNetworkingSocketsDebugOutputType_Msg, DebugOutput);
+		networkingInitialized = true;
+	});
+}
+
 int App::run(int argc, char** argv) {
+	// the main thread records and submits frames
+	SystemInfo::PlaceCurrentThread(SystemInfo::ThreadRole::LatencyCritical);
+
+	// each part of startup is a profiler zone, and its time is kept for GetStartupPhases
+	auto phaseStart = clocktype::now();
+	auto endPhase = [&](const char* name) {
+		const auto now = clocktype::now();
+		startupPhases.push_back({ name, now - phaseStart });
+		phaseStart = now;
+	};
 #if !RVE_SERVER
 	// initialize SDL2
+	RVE_PROFILE_SECTION(sdl, "Startup: SDL");
 	if (not SDL_Init(SDL_INIT_GAMEPAD | SDL_INIT_EVENTS | SDL_INIT_HAPTIC | SDL_INIT_VIDEO)) {
 		Debug::Fatal("Unable to initialize SDL: {}", SDL_GetError());
 	}
+	RVE_PROFILE_SECTION_END(sdl);
+	endPhase("SDL");
+	AppConfig config;
 	{
+		RVE_PROFILE_SECTION(window, "Startup: Window");
 		window = std::make_unique<Window>(960, 540, "RavEngine");
 
-		auto config = OnConfigure(argc, argv);
+		config = OnConfigure(argc, argv);
+		RVE_PROFILE_SECTION_END(window);
+		endPhase("Window");
 
 		// initialize RGL and the global Device
+		RVE_PROFILE_SECTION(device, "Startup: Device");
 		RGL::API api = RGL::API::PlatformDefault;
 		{
 
@@ -168,12 +252,18 @@ int App::run(int argc, char** argv) {
 		RGL::Init(opt);
 
 		device = RGL::IDevice::CreateSystemDefaultDevice();
+		RVE_PROFILE_SECTION_END(device);
+		endPhase("Device");
 
+		RVE_PROFILE_SECTION(renderer, "Startup: Renderer");
 		Renderer = std::make_unique<RenderEngine>(config, device);
 		Renderer->dummyTonemap = New<DummyTonemapInstance>(New<DummyTonemap>());
+		RVE_PROFILE_SECTION_END(renderer);
+		endPhase("Renderer");
 
-
+		RVE_PROFILE_SECTION(swapchain, "Startup: Swapchain");
 		window->InitSwapchain(device, Renderer->mainCommandQueue);
+		Renderer->SyncVideoSettings();
 
 		auto size = window->GetSizeInPixels();
 		mainWindowView = { Renderer->CreateRenderTargetCollection({ static_cast<unsigned int>(size.width), static_cast<unsigned int>(size.height) }) };
@@ -187,9 +277,12 @@ int App::run(int argc, char** argv) {
 			xrRenderViewCollections = OpenXRIntegration::CreateRenderTargetCollections();
 		}
 #endif
+		RVE_PROFILE_SECTION_END(swapchain);
+		endPhase("Swapchain");
 	}
 
 	//setup GUI rendering
+	RVE_PROFILE_SECTION(gui, "Startup: GUI");
 	Rml::SetSystemInterface(&GetRenderEngine());
 	Rml::SetRenderInterface(&GetRenderEngine());
 	Rml::SetFileInterface(new VFSInterface());
@@ -198,32 +291,40 @@ int App::run(int argc, char** argv) {
 #ifndef NDEBUG
 	Renderer->InitDebugger();
 #endif
+	performanceOverlay = std::make_unique<PerformanceOverlay>();
 
 #ifdef __APPLE__
 	enableSmoothScrolling();
 #endif
+	RVE_PROFILE_SECTION_END(gui);
+	endPhase("GUI");
 
 	//load the built-in fonts
+	RVE_PROFILE_SECTION(fonts, "Startup: Fonts");
 	App::Resources->IterateDirectory("fonts", [](const std::string& filename) {
 		auto p = Filesystem::Path(filename);
 		if (p.extension() == ".ttf") {
 			GUIComponent::LoadFont(p.filename().string());
 		}
 		});
+	RVE_PROFILE_SECTION_END(fonts);
+	endPhase("Fonts");
 
 	//setup Audio
 	if (NeedsAudio()) {
-		player = std::make_unique<AudioPlayer>();
+		RVE_PROFILE_SECTION(audio, "Startup: Audio");
+		player = std::make_unique<AudioPlayer>(config.audioWorkerThreads);
 		player->Init();
+		RVE_PROFILE_SECTION_END(audio);
+		endPhase("Audio");
 	}
 #endif
-	//setup networking
+	//setup networking, otherwise it starts with the first NetworkServer or NetworkClient
 	if (NeedsNetworking()) {
-		SteamDatagramErrMsg errMsg;
-		if (!GameNetworkingSockets_Init(nullptr, errMsg)) {
-			Debug::Fatal("Networking initialization failed: {}", errMsg);
-		}
-		SteamNetworkingUtils()->SetDebugOutputFunction(k_ESteamNetworkingSocketsDebugOutputType_Msg, DebugOutput);
+		RVE_PROFILE_SECTION(networking, "Startup: Networking");
+		InitNetworking();
+		RVE_PROFILE_SECTION_END(networking);
+		endPhase("Networking");
 	}
 	
 	// if built in non-UWP for Windows, need to manually set DPI awareness
@@ -235,6 +336,7 @@ int App::run(int argc, char** argv) {
 #if !RVE_SERVER
 
 	{
+		RVE_PROFILE_SECTION(textures, "Startup: Default textures");
 		//make the default texture white
 		uint8_t data[] = {0xFF,0xFF,0xFF,0xFF};
 		Texture::Manager::defaultTexture = make_shared<RuntimeTexture>(1, 1, Texture::Config{
@@ -256,11 +358,26 @@ int App::run(int argc, char** argv) {
 			.numLayers = 1,
 			.initialData = {{reinterpret_cast<std::byte*>(zeroData), sizeof(zeroData)}}
 		});
+		RVE_PROFILE_SECTION_END(textures);
+		endPhase("Default textures");
 	}
 #endif
 
 	//invoke startup hook
-	OnStartup(argc, argv);
+	{
+		RVE_PROFILE_SECTION(startup, "Startup: OnStartup");
+		OnStartup(argc, argv);
+		RVE_PROFILE_SECTION_END(startup);
+		endPhase("OnStartup");
+
+		std::string summary;
+		std::chrono::duration<double, std::milli> total{ 0 };
+		for (const auto& phase : startupPhases) {
+			summary += Format("\n\t{}: {:.1f} ms", phase.name, phase.duration.count());
+			total += phase.duration;
+		}
+		Debug::Log("Startup took {:.1f} ms:{}", total.count(), summary);
+	}
 	
 	lastFrameTime = clocktype::now();
    
@@ -268,12 +385,26 @@ int App::run(int argc, char** argv) {
     float windowScaleFactor = GetMainWindow()->GetDPIScale();
     SDL_Event event;
 #endif
+    // frames are scheduled on absolute deadlines, so the rate does not drift by the time spent waking up
+    auto nextFrame = lastFrameTime;
 	bool exit = false;
 	
 	while (!exit) {
 #if __APPLE__
 		@autoreleasepool{
 #endif
+#if RVE_SERVER
+        if (serverQuitRequested) {
+            break;
+        }
+#else
+        // wait for the display before reading input, rather than reading input and then waiting
+        window->WaitForFrameLatency();
+        if (lowLatencyFrames) {
+            // Tick waits for this anyway, but after input has been read
+            window->WaitForPreviousFrame();
+        }
+#endif
 
 		//setup framerate scaling for next frame
 		auto now = clocktype::now();
@@ -282,6 +413,7 @@ int App::run(int argc, char** argv) {
 		float deltaSeconds = std::chrono::duration<decltype(deltaSeconds)>(deltaTimeMicroseconds).count();
 		time += deltaSeconds;
 		currentScale = deltaSeconds * evalNormal;
+		fixedTickAccumulator += deltaSeconds;
 #if !RVE_SERVER
 		RVE_PROFILE_SECTION(events, "Process all Events");
 		auto windowflags = SDL_GetWindowFlags(window->window);
@@ -303,6 +435,11 @@ int App::run(int argc, char** argv) {
                 case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
                     exit = true;
                     break;
+                case SDL_EVENT_KEY_DOWN:
+                    if (performanceOverlayHotkey != 0 && event.key.scancode == performanceOverlayHotkey && !event.key.repeat) {
+                        SetPerformanceOverlayVisible(!IsPerformanceOverlayVisible());
+                    }
+                    break;
             }
 			//process others
 			if (inputManager) {
@@ -315,21 +452,22 @@ int App::run(int argc, char** argv) {
         RVE_PROFILE_SECTION_END(events);
 #endif // !RVE_SERVER
         Tick();
-#if RVE_SERVER
-        //make up the difference
-        // because there's no vsync on server builds, we need to add delay
-        //can't just call sleep because sleep is not very accurate
-        clocktype::duration work_time;
-        do{
-            auto workEnd = clocktype::now();
-            work_time = workEnd - now;
-            auto delta = min_tick_time - work_time;
-            if (delta > std::chrono::duration<double, std::milli>(3)) {
-                auto dc = std::chrono::duration_cast<std::chrono::milliseconds>(delta);
-                std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(dc.count()-1));
+#ifdef RVE_XR_AVAILABLE
+        const bool xrPaced = wantsXR;   // xrWaitFrame in Tick already holds the loop to the headset's rate
+#else
+        constexpr bool xrPaced = false;
+#endif
+        if (const auto frameTime = FrameInterval(); frameTime > clocktype::duration::zero() && !xrPaced) {
+            RVE_PROFILE_SECTION(limit, "Frame Limiter");
+            nextFrame += frameTime;
+            const auto workEnd = clocktype::now();
+            if (workEnd - nextFrame > frameTime) {
+                // more than a frame behind, don't run a burst of frames to catch up. In fixed-rate mode, the accumulator owes the simulation the lost time.
+                nextFrame = workEnd;
             }
-        }while (work_time < min_tick_time);
-#endif
+            frameLimiter.WaitUntil(nextFrame);
+            RVE_PROFILE_SECTION_END(limit);
+        }
             lastFrameTime = now;
 #if __APPLE__
 		}	// end of @autoreleasepool
@@ -344,10 +482,17 @@ void App::Tick(){
     @autoreleasepool{
 #endif
         
+#ifdef RVE_XR_AVAILABLE
+        // wait for the headset before simulating, so the simulated frame is the one that is displayed next
+        XrFrameState xrFrameState{ .type = XR_TYPE_FRAME_STATE };
+        if (wantsXR) {
+            xrFrameState = OpenXRIntegration::BeginXRFrame();
+        }
+#endif
 #if !RVE_SERVER
-        RVE_PROFILE_SECTION(getSwapchain, "Acquire Swapchain Image");
-        RGL::SwapchainPresentConfig swapchainPresentConfig;
-        window->QueueGetNextSwapchainImage(swapchainPresentConfig);
+        RVE_PROFILE_SECTION(waitPrevious, "Wait for Previous Frame");
+        window->WaitForPreviousFrame();
+        RVE_PROFILE_SECTION_END(waitPrevious);
 #ifndef NDEBUG
         RenderEngine::debuggerInput->TickAxes();
 #endif
@@ -360,11 +505,77 @@ void App::Tick(){
         auto windowSize = window->GetSizeInPixels();
         auto scale = window->GetDPIScale();
 #endif
+        {
+            // close the last frame's counters, now that the work it submitted has finished
+            static auto liveEntities = PerfCounters::GetGauge("World: Entities");
+            size_t entities = 0;
+            for (const auto& world : loadedWorlds) {
+                entities += world->GetNumLiveEntities();
+            }
+            liveEntities->Set(entities);
+            PerfCounters::TakeSnapshot(perfSnapshot);
+        }
         RVE_PROFILE_SECTION(tickallworlds, "Tick All Worlds");
+        const auto tickStart = clocktype::now();
+        // in fixed-rate mode, work out how many simulation ticks are owed and how far into the next one we are
+        uint32_t nFixedTicks = 0;
+        float fixedAlpha = 1;
+        if (fixedTickRate > 0) {
+            const double step = 1.0 / fixedTickRate;
+            while (fixedTickAccumulator >= step && nFixedTicks < maxFixedTicksPerFrame) {
+                fixedTickAccumulator -= step;
+                nFixedTicks++;
+            }
+            if (nFixedTicks == maxFixedTicksPerFrame) {
+                fixedTickAccumulator = std::min(fixedTickAccumulator, step);
+            }
+            fixedAlpha = static_cast<float>(fixedTickAccumulator / step);
+            currentScale = static_cast<float>(step * evalNormal);
+        }
         //tick all worlds
-        for (const auto world : loadedWorlds) {
-            world->Tick(currentScale);
 #if !RVE_SERVER
+        const bool pipelined = pipelinedFrames && renderWorld && loadedWorlds.size() > 1;
+#else
+        constexpr bool pipelined = false;
+#endif
+        auto tickWorld = [this, nFixedTicks, fixedAlpha](World* world) {
+            if (fixedTickRate > 0) {
+                for (uint32_t i = 0; i < nFixedTicks; i++) {
+                    world->TickSimulation(currentScale);
+                }
+                world->SyncRenderData(fixedAlpha);
+            }
+            else {
+                world->Tick(currentScale);
+            }
+        };
+        auto tickWorlds = [this, &tickWorld](const std::vector<World*>& worlds) {
+            if (parallelWorldTicks && worlds.size() > 1) {
+                // each world runs its graphs from inside its task, so leave a worker free for the work those graphs spawn
+                tf::Taskflow worldTicks;
+                tf::Semaphore concurrencyLimit(std::max<size_t>(executor.num_workers(), 2) - 1);
+                for (const auto world : worlds) {
+                    worldTicks.emplace([&tickWorld, world] {
+                        tickWorld(world);
+                    }).acquire(concurrencyLimit).release(concurrencyLimit);
+                }
+                executor.run(worldTicks).wait();
+            }
+            else {
+                for (const auto world : worlds) {
+                    tickWorld(world);
+                }
+            }
+        };
+        // when pipelined, only the rendered world ticks before it is drawn
+        std::vector<World*> worldsBeforeDraw, worldsDuringDraw;
+        for (const auto& world : loadedWorlds) {
+            (pipelined && world != renderWorld ? worldsDuringDraw : worldsBeforeDraw).push_back(world.get());
+        }
+        tickWorlds(worldsBeforeDraw);
+#if !RVE_SERVER
+        // GUI updates stay on the main thread
+        for (const auto& world : loadedWorlds) {
             world->Filter([=](GUIComponent& gui) {
                 if (gui.Mode == GUIComponent::RenderMode::Screenspace) {
                     gui.SetDimensions(windowSize.width, windowSize.height);
@@ -372,16 +583,34 @@ void App::Tick(){
                 }
                 gui.Update();
             });
-#endif
         }
+#endif
 
         //process main thread tasks
-        {
-            Function<void(void)> front;
-            while (main_tasks.try_dequeue(front)) {
-                front();
+        RunMainThreadTasks();
+
+        // replicate the state the worlds ended the tick with
+        auto replicate = [this] {
+            if (networkManager.IsServer()) {
+                for (const auto& world : loadedWorlds) {
+                    networkManager.server->UpdateRelevancy(world.get());
+                    networkManager.server->CaptureReplicatedState(world.get());
+                }
+                networkManager.server->SendReplicationSnapshot();
+                networkManager.server->FlushRPCs();
+                networkManager.server->StreamWorldSynchronization();
+                networkManager.server->PlotStats();
             }
+            if (networkManager.IsClient()) {
+                networkManager.client->FlushRPCs();
+                networkManager.client->PlotStats();
+            }
+        };
+        if (!pipelined) {
+            replicate();
         }
+        auto tickDuration = clocktype::now() - tickStart;
+        lastTickDuration = tickDuration;
         RVE_PROFILE_SECTION_END(tickallworlds);
 #if !RVE_SERVER
 
@@ -402,16 +631,22 @@ void App::Tick(){
             
             auto viewportOverride = camera.viewportOverride;
             
-            return RenderViewCollection::camData{ viewProj, projOnly, viewOnly, camPos,{camera.nearClip, camera.farClip} ,viewportOverride, camera.renderLayers, camera.FOV, width, height, &camera.postProcessingEffects, camera.tonemap.get(), camera.indirectLightingSettings};
+            return RenderViewCollection::camData{ viewProj, projOnly, viewOnly, camPos,{camera.nearClip, camera.farClip} ,viewportOverride, camera.renderLayers, camera.FOV, width, height, &camera.postProcessingEffects, camera.tonemap.get(), camera.indirectLightingSettings, camera.features, camera.foveation};
         };
         std::vector<RenderViewCollection> allViews;
-        for(const auto& camera : *allCameras){
+        for(auto& camera : *allCameras){
             if (!camera.IsActive()) {
                 continue;
             }
             if (!camera.target){
                 continue;   // only want render texture cameras
             }
+            if (!Renderer->ShouldRenderTextureCameras()){
+                continue;   // over the VRAM budget, see VRAMPressureLevel::RenderTextureCameras
+            }
+            if (!camera.AdvanceTargetUpdate()){
+                continue;   // the target keeps what it last rendered
+            }
             
             auto& collection = camera.target->GetCollection();
             auto size = collection.depthStencil->GetSize();
@@ -431,26 +666,52 @@ void App::Tick(){
 
         mainWindowView.pixelDimensions = window->GetSizeInPixels();
 
+        // acquired only now, because acquiring can block until the display releases an image
+        RVE_PROFILE_SECTION(getSwapchain, "Acquire Swapchain Image");
+        auto nextTexture = window->AcquireNextSwapchainImage();
+        RVE_PROFILE_SECTION_END(getSwapchain);
+        mainWindowView.collection.finalFramebuffer = nextTexture.texture;
 #ifdef RVE_XR_AVAILABLE
-        // update OpenXR data if it is requested
-        std::pair<std::vector<XrView>, XrFrameState> xrBeginData;
-        if (wantsXR) {
-            xrBeginData = OpenXRIntegration::BeginXRFrame();
-            OpenXRIntegration::UpdateXRTargetCollections(xrRenderViewCollections, xrBeginData.first);
+        // locate the headset after everything that can block, right before encoding, so the rendered poses are as recent as possible
+        if (wantsXR && xrFrameState.shouldRender) {
+            OpenXRIntegration::UpdateXRTargetCollections(xrRenderViewCollections, OpenXRIntegration::LocateXRViews(xrFrameState));
             allViews.insert(allViews.end(), xrRenderViewCollections.begin(), xrRenderViewCollections.end());
         }
 #endif
-
-        auto nextTexture = window->BlockGetNextSwapchainImage(swapchainPresentConfig);
-        RVE_PROFILE_SECTION_END(getSwapchain);
-        mainWindowView.collection.finalFramebuffer = nextTexture.texture;
+        mainWindowView.overlay = performanceOverlay->Update(windowSize.width, windowSize.height, scale);
         allViews.push_back(mainWindowView);
-        auto mainCommandBuffer = Renderer->Draw(renderWorld, allViews, scale);
+        RGLCommandBufferPtr mainCommandBuffer;
+        if (pipelined) {
+            // replication only reads the rendered world, so it can run alongside encoding
+            auto encoding = executor.async([&] {
+#if __APPLE__
+                @autoreleasepool {
+#endif
+                return Renderer->Draw(renderWorld, allViews, scale);
+#if __APPLE__
+                }
+#endif
+            });
+            RVE_PROFILE_SECTION(tickduringdraw, "Tick Worlds During Draw");
+            const auto duringDrawStart = clocktype::now();
+            tickWorlds(worldsDuringDraw);
+            replicate();
+            tickDuration += clocktype::now() - duringDrawStart;
+            lastTickDuration = tickDuration;
+            RVE_PROFILE_SECTION_END(tickduringdraw);
+            mainCommandBuffer = encoding.get();
+        }
+        else {
+            mainCommandBuffer = Renderer->Draw(renderWorld, allViews, scale);
+        }
+        performanceOverlay->RecordFrame(std::chrono::duration<float, std::milli>(tickDuration).count());
 
 
         // show the results to the user
         RGL::CommitConfig commitconfig{
             .signalFence = window->swapchainFence,
+            .waitFor = Renderer->GetDrawDependencies(),
+            .waitStage = RGL::WaitStage::Draws,
         };
         mainCommandBuffer->Commit(commitconfig);
         
@@ -459,7 +720,7 @@ void App::Tick(){
 
 #ifdef RVE_XR_AVAILABLE
         if (wantsXR) {
-            OpenXRIntegration::EndXRFrame(xrBeginData.second);
+            OpenXRIntegration::EndXRFrame(xrFrameState);
         }
 #endif
         if (GetAudioActive()) {
@@ -474,10 +735,63 @@ void App::Tick(){
 #endif
 }
 
+clocktype::duration App::FrameInterval() const {
+	if (targetFrameRate > 0) {
+		return duration_cast<clocktype::duration>(std::chrono::duration<double>(1.0 / targetFrameRate));
+	}
+#if RVE_SERVER
+	// there's no vsync on server builds, so they are always paced
+	return duration_cast<clocktype::duration>(fixedTickRate > 0 ? std::chrono::duration<double>(1.0 / fixedTickRate) : min_tick_time);
+#else
+	return clocktype::duration::zero();
+#endif
+}
+
 float App::CurrentTPS() {
 	return App::evalNormal / currentScale;
 }
 
+void App::RunMainThreadTasks() {
+	RVE_PROFILE_FN_N("Main thread tasks");
+	const auto deadline = clocktype::now() + mainTaskBudget;
+	const bool limited = mainTaskBudget.count() > 0;
+
+	// leftovers from the last tick keep their order ahead of newer tasks
+	size_t i = 0;
+	for (; i < deferredMainTasks.size(); i++) {
+		deferredMainTasks[i]();
+		// checking the clock per task costs more than most tasks, so check every few
+		if (limited && i % 16 == 15 && clocktype::now() >= deadline) {
+			i++;
+			break;
+		}
+	}
+	deferredMainTasks.erase(deferredMainTasks.begin(), deferredMainTasks.begin() + i);
+	if (!deferredMainTasks.empty()) {
+		return;
+	}
+
+	// dequeue in batches, which costs one synchronization per batch instead of one per task
+	constexpr size_t batchSize = 64;
+	std::array<MainThreadTask, batchSize> batch;
+	size_t count;
+	while ((count = main_tasks.try_dequeue_bulk(batch.begin(), batchSize)) > 0) {
+		for (size_t t = 0; t < count; t++) {
+			batch[t]();
+			batch[t] = {};
+			if (limited && t % 16 == 15 && t + 1 < count && clocktype::now() >= deadline) {
+				for (size_t rest = t + 1; rest < count; rest++) {
+					deferredMainTasks.push_back(std::move(batch[rest]));
+				}
+				return;
+			}
+		}
+		if (limited && clocktype::now() >= deadline) {
+			return;
+		}
+	}
+}
+
 /**
 Set the current world to tick automatically
 @param newWorld the new world
@@ -557,7 +871,7 @@ void App::Quit(){
 	event.type = SDL_EVENT_QUIT;
 	SDL_PushEvent(&event);
 #else
-    Debug::Fatal("Quit is not implemented on the server (TODO)");
+    serverQuitRequested = true;
 #endif
 }
 
@@ -568,10 +882,11 @@ App::~App(){
 
 #if !RVE_SERVER
 	// ensure the GPU is done doing work
-	window->BlockGetNextSwapchainImage({});
+	window->WaitForPreviousFrame();
 #ifndef NDEBUG
 	Renderer->DeactivateDebugger();
 #endif
+	performanceOverlay.reset();
 #endif
     MeshAsset::Manager::Clear();
     MeshAssetSkinned::Manager::Clear();
@@ -595,7 +910,9 @@ App::~App(){
 	renderWorld = nullptr;
 	loadedWorlds.clear();
 
-	GameNetworkingSockets_Kill();
+	if (networkingInitialized) {
+		GameNetworkingSockets_Kill();
+	}
 	PHYSFS_deinit();
 #if !RVE_SERVER
 
@@ -612,6 +929,14 @@ App::~App(){
 void App::SetWindowTitle(const char *title){
 	SDL_SetWindowTitle(window->window, title);
 }
+
+void App::SetPerformanceOverlayVisible(bool visible){
+	performanceOverlay->SetVisible(visible);
+}
+
+bool App::IsPerformanceOverlayVisible() const{
+	return performanceOverlay->IsVisible();
+}
 #endif
 
 std::optional<Ref<World>> RavEngine::App::GetWorldByName(const std::string& name) {
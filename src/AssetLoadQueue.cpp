@@ -0,0 +1,63 @@
+#include "AssetLoadQueue.hpp"
+#include "App.hpp"
+#include "Array.hpp"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+using namespace RavEngine;
+
+namespace {
+	std::mutex mtx;
+	Array<std::deque<Function<void()>>, 3> pending;		// by priority
+	uint32_t running = 0;
+	uint32_t maxRunning = 0;
+
+	uint32_t MaxRunning() {
+		return maxRunning > 0 ? maxRunning : std::max<uint32_t>(uint32_t(GetApp()->backgroundExecutor.num_workers()), 1);
+	}
+
+	// runs loads until none are waiting
+	void RunLoads() {
+		while (true) {
+			Function<void()> load;
+			{
+				std::lock_guard lock(mtx);
+				auto queue = std::find_if(pending.rbegin(), pending.rend(), [](const auto& queue) {
+					return !queue.empty();
+				});
+				if (queue == pending.rend() || running > MaxRunning()) {
+					running--;
+					return;
+				}
+				load = std::move(queue->front());
+				queue->pop_front();
+			}
+			load();
+		}
+	}
+}
+
+void AssetLoadQueue::Enqueue(AssetLoadPriority priority, Function<void()>&& load)
+{
+	{
+		std::lock_guard lock(mtx);
+		pending[uint8_t(priority)].push_back(std::move(load));
+		if (running >= MaxRunning()) {
+			return;
+		}
+		running++;
+	}
+	GetApp()->backgroundExecutor.silent_async(RunLoads);
+}
+
+void AssetLoadQueue::SetMaxConcurrentLoads(uint32_t maxLoads)
+{
+	std::lock_guard lock(mtx);
+	maxRunning = maxLoads;
+}
+
+void AssetLoadQueue::RunOnMainThread(Function<void()>&& function)
+{
+	GetApp()->DispatchMainThread(std::move(function));
+}
@@ -0,0 +1,397 @@
+#include "AssetPack.hpp"
+#include "Compression.hpp"
+#include "Debug.hpp"
+#include <physfs.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+using namespace RavEngine;
+using namespace RavEngine::AssetPack;
+
+bool Index::Load(std::span<const std::byte> table, uint64_t packSize)
+{
+	Header header;
+	if (table.size() < sizeof(header)) {
+		return false;
+	}
+	std::memcpy(&header, table.data(), sizeof(header));
+	if (header.magic != magic || header.version != formatVersion || table.size() < TableSize(header)) {
+		return false;
+	}
+
+	entries.resize(header.entryCount);
+	std::memcpy(entries.data(), table.data() + sizeof(header), entries.size() * sizeof(Entry));
+	paths.assign(reinterpret_cast<const char*>(table.data()) + sizeof(header) + entries.size() * sizeof(Entry), header.pathsSize);
+
+	directories.clear();
+	directories[""];
+	for (size_t i = 0; i < entries.size(); i++) {
+		const auto& entry = entries[i];
+		if ((i > 0 && entries[i - 1].pathHash > entry.pathHash) ||
+			uint64_t(entry.pathOffset) + entry.pathLength > paths.size() ||
+			entry.offset > packSize || entry.storedSize > packSize - entry.offset ||
+			entry.encoding > Encoding::Deflate ||
+			(entry.encoding == Encoding::None && entry.size != entry.storedSize)) {
+			return false;
+		}
+
+		// every prefix of the path is a directory with the next component in it
+		const auto path = PathOf(entry);
+		size_t start = 0;
+		std::string parent;
+		for (auto slash = path.find('/'); ; slash = path.find('/', start)) {
+			const auto name = path.substr(start, slash == std::string_view::npos ? std::string_view::npos : slash - start);
+			auto& children = directories[parent];
+			if (std::find(children.begin(), children.end(), name) == children.end()) {
+				children.emplace_back(name);
+			}
+			if (slash == std::string_view::npos) {
+				break;
+			}
+			parent = std::string(path.substr(0, slash));
+			start = slash + 1;
+		}
+	}
+	return true;
+}
+
+const Entry* Index::Find(std::string_view path) const
+{
+	const auto hash = HashPath(path);
+	auto it = std::lower_bound(entries.begin(), entries.end(), hash, [](const Entry& entry, uint64_t hash) {
+		return entry.pathHash < hash;
+	});
+	for (; it != entries.end() && it->pathHash == hash; ++it) {
+		if (PathOf(*it) == path) {
+			return &*it;
+		}
+	}
+	return nullptr;
+}
+
+bool Index::EnumerateDirectory(std::string_view path, FunctionRef<void(const std::string&)> callback) const
+{
+	auto it = directories.find(std::string(path));
+	if (it == directories.end()) {
+		return false;
+	}
+	for (const auto& name : it->second) {
+		callback(name);
+	}
+	return true;
+}
+
+namespace {
+	struct MountedPack {
+		PHYSFS_Io* io = nullptr;
+		std::string name;
+		Index index;
+	};
+
+	// mounted packs by the path they were mounted from, for FindStoredFile
+	std::mutex mountedLock;
+	UnorderedMap<std::string, const MountedPack*> mountedPacks;
+
+	// a file stored uncompressed, read straight from the pack
+	struct StoredIo {
+		PHYSFS_Io* pack = nullptr;		// a duplicate of the pack's io, with its own position
+		uint64_t start = 0, size = 0, pos = 0;
+	};
+
+	// a compressed file, decompressed into memory when it is opened
+	struct InflatedIo {
+		std::shared_ptr<const Vector<std::byte>> data;
+		uint64_t pos = 0;
+	};
+
+	PHYSFS_Io* MakeIo(void* opaque, PHYSFS_sint64(*read)(PHYSFS_Io*, void*, PHYSFS_uint64), int(*seek)(PHYSFS_Io*, PHYSFS_uint64),
+		PHYSFS_sint64(*tell)(PHYSFS_Io*), PHYSFS_sint64(*length)(PHYSFS_Io*), PHYSFS_Io* (*duplicate)(PHYSFS_Io*), void(*destroy)(PHYSFS_Io*))
+	{
+		auto io = new PHYSFS_Io;
+		io->version = 0;
+		io->opaque = opaque;
+		io->read = read;
+		io->write = nullptr;		// read-only
+		io->seek = seek;
+		io->tell = tell;
+		io->length = length;
+		io->duplicate = duplicate;
+		io->flush = nullptr;
+		io->destroy = destroy;
+		return io;
+	}
+
+	PHYSFS_Io* MakeStoredIo(StoredIo* file);
+
+	PHYSFS_sint64 StoredRead(PHYSFS_Io* io, void* buffer, PHYSFS_uint64 len)
+	{
+		auto file = static_cast<StoredIo*>(io->opaque);
+		len = std::min<PHYSFS_uint64>(len, file->size - file->pos);
+		if (len == 0) {
+			return 0;
+		}
+		if (!file->pack->seek(file->pack, file->start + file->pos)) {
+			return -1;
+		}
+		const auto bytesRead = file->pack->read(file->pack, buffer, len);
+		if (bytesRead > 0) {
+			file->pos += bytesRead;
+		}
+		return bytesRead;
+	}
+
+	int StoredSeek(PHYSFS_Io* io, PHYSFS_uint64 offset)
+	{
+		auto file = static_cast<StoredIo*>(io->opaque);
+		if (offset > file->size) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+			return 0;
+		}
+		file->pos = offset;
+		return 1;
+	}
+
+	PHYSFS_sint64 StoredTell(PHYSFS_Io* io)
+	{
+		return static_cast<StoredIo*>(io->opaque)->pos;
+	}
+
+	PHYSFS_sint64 StoredLength(PHYSFS_Io* io)
+	{
+		return static_cast<StoredIo*>(io->opaque)->size;
+	}
+
+	PHYSFS_Io* StoredDuplicate(PHYSFS_Io* io)
+	{
+		auto file = static_cast<StoredIo*>(io->opaque);
+		auto pack = file->pack->duplicate(file->pack);
+		if (!pack) {
+			return nullptr;
+		}
+		return MakeStoredIo(new StoredIo{ pack, file->start, file->size, 0 });
+	}
+
+	void StoredDestroy(PHYSFS_Io* io)
+	{
+		auto file = static_cast<StoredIo*>(io->opaque);
+		file->pack->destroy(file->pack);
+		delete file;
+		delete io;
+	}
+
+	PHYSFS_Io* MakeStoredIo(StoredIo* file)
+	{
+		return MakeIo(file, StoredRead, StoredSeek, StoredTell, StoredLength, StoredDuplicate, StoredDestroy);
+	}
+
+	PHYSFS_Io* MakeInflatedIo(InflatedIo* file);
+
+	PHYSFS_sint64 InflatedRead(PHYSFS_Io* io, void* buffer, PHYSFS_uint64 len)
+	{
+		auto file = static_cast<InflatedIo*>(io->opaque);
+		len = std::min<PHYSFS_uint64>(len, file->data->size() - file->pos);
+		std::memcpy(buffer, file->data->data() + file->pos, len);
+		file->pos += len;
+		return len;
+	}
+
+	int InflatedSeek(PHYSFS_Io* io, PHYSFS_uint64 offset)
+	{
+		auto file = static_cast<InflatedIo*>(io->opaque);
+		if (offset > file->data->size()) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+			return 0;
+		}
+		file->pos = offset;
+		return 1;
+	}
+
+	PHYSFS_sint64 InflatedTell(PHYSFS_Io* io)
+	{
+		return static_cast<InflatedIo*>(io->opaque)->pos;
+	}
+
+	PHYSFS_sint64 InflatedLength(PHYSFS_Io* io)
+	{
+		return static_cast<InflatedIo*>(io->opaque)->data->size();
+	}
+
+	PHYSFS_Io* InflatedDuplicate(PHYSFS_Io* io)
+	{
+		return MakeInflatedIo(new InflatedIo{ static_cast<InflatedIo*>(io->opaque)->data, 0 });
+	}
+
+	void InflatedDestroy(PHYSFS_Io* io)
+	{
+		delete static_cast<InflatedIo*>(io->opaque);
+		delete io;
+	}
+
+	PHYSFS_Io* MakeInflatedIo(InflatedIo* file)
+	{
+		return MakeIo(file, InflatedRead, InflatedSeek, InflatedTell, InflatedLength, InflatedDuplicate, InflatedDestroy);
+	}
+
+	bool ReadAt(PHYSFS_Io* io, uint64_t offset, void* buffer, uint64_t size)
+	{
+		return io->seek(io, offset) && io->read(io, buffer, size) == PHYSFS_sint64(size);
+	}
+
+	void* OpenArchive(PHYSFS_Io* io, const char* name, int forWrite, int* claimed)
+	{
+		Header header;
+		if (!ReadAt(io, 0, &header, sizeof(header)) || header.magic != magic) {
+			// not a pack, let another archiver try it
+			PHYSFS_setErrorCode(PHYSFS_ERR_UNSUPPORTED);
+			return nullptr;
+		}
+		*claimed = 1;
+		if (forWrite) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+			return nullptr;
+		}
+
+		const auto packSize = io->length(io);
+		if (packSize < 0 || TableSize(header) > uint64_t(packSize)) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+			return nullptr;
+		}
+		Vector<std::byte> table(TableSize(header));
+		auto pack = std::make_unique<MountedPack>();
+		if (!ReadAt(io, 0, table.data(), table.size()) || !pack->index.Load(table, uint64_t(packSize))) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+			return nullptr;
+		}
+		pack->io = io;
+		pack->name = name;
+
+		std::lock_guard lock(mountedLock);
+		mountedPacks[pack->name] = pack.get();
+		return pack.release();
+	}
+
+	PHYSFS_EnumerateCallbackResult Enumerate(void* opaque, const char* dirname, PHYSFS_EnumerateCallback callback, const char* origdir, void* callbackdata)
+	{
+		auto pack = static_cast<const MountedPack*>(opaque);
+		auto result = PHYSFS_ENUM_OK;
+		pack->index.EnumerateDirectory(dirname, [&](const std::string& name) {
+			if (result == PHYSFS_ENUM_OK) {
+				result = callback(callbackdata, origdir, name.c_str());
+			}
+		});
+		if (result == PHYSFS_ENUM_ERROR) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+		}
+		return result;
+	}
+
+	PHYSFS_Io* OpenRead(void* opaque, const char* path)
+	{
+		auto pack = static_cast<const MountedPack*>(opaque);
+		auto entry = pack->index.Find(path);
+		if (!entry) {
+			PHYSFS_setErrorCode(pack->index.IsDirectory(path) ? PHYSFS_ERR_NOT_A_FILE : PHYSFS_ERR_NOT_FOUND);
+			return nullptr;
+		}
+
+		// the pack's io is shared between all files, so each file reads through its own
+		auto io = pack->io->duplicate(pack->io);
+		if (!io) {
+			return nullptr;
+		}
+		if (entry->encoding == Encoding::None) {
+			return MakeStoredIo(new StoredIo{ io, entry->offset, entry->size, 0 });
+		}
+
+		Vector<std::byte> stored(entry->storedSize);
+		const bool read = ReadAt(io, entry->offset, stored.data(), stored.size());
+		io->destroy(io);
+		auto data = std::make_shared<Vector<std::byte>>(entry->size);
+		if (!read || !Compression::Inflate(stored, *data)) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+			return nullptr;
+		}
+		return MakeInflatedIo(new InflatedIo{ std::move(data), 0 });
+	}
+
+	PHYSFS_Io* OpenWrite(void*, const char*)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+		return nullptr;
+	}
+
+	int Modify(void*, const char*)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+		return 0;
+	}
+
+	int Stat(void* opaque, const char* path, PHYSFS_Stat* stat)
+	{
+		auto pack = static_cast<const MountedPack*>(opaque);
+		auto entry = pack->index.Find(path);
+		if (!entry && !pack->index.IsDirectory(path)) {
+			PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+			return 0;
+		}
+		stat->filesize = entry ? PHYSFS_sint64(entry->size) : 0;
+		stat->filetype = entry ? PHYSFS_FILETYPE_REGULAR : PHYSFS_FILETYPE_DIRECTORY;
+		stat->modtime = stat->createtime = stat->accesstime = -1;
+		stat->readonly = 1;
+		return 1;
+	}
+
+	void CloseArchive(void* opaque)
+	{
+		auto pack = static_cast<MountedPack*>(opaque);
+		{
+			std::lock_guard lock(mountedLock);
+			mountedPacks.erase(pack->name);
+		}
+		pack->io->destroy(pack->io);
+		delete pack;
+	}
+
+	const PHYSFS_Archiver archiver{
+		0,
+		{ "RVEDATA", "RavEngine asset pack", "RavEngine", "https://github.com/RavEngine/RavEngine", 0 },
+		OpenArchive,
+		Enumerate,
+		OpenRead,
+		OpenWrite,
+		OpenWrite,
+		Modify,
+		Modify,
+		Stat,
+		CloseArchive,
+	};
+}
+
+void AssetPack::RegisterArchiver()
+{
+	// PhysFS forgets archivers when it is deinitialized, so this is called after every init
+	if (PHYSFS_registerArchiver(&archiver) == 0) {
+		const auto error = PHYSFS_getLastErrorCode();
+		if (error != PHYSFS_ERR_DUPLICATE) {
+			Debug::Warning("Cannot register the asset pack archiver: {}", PHYSFS_getErrorByCode(error));
+		}
+	}
+}
+
+bool AssetPack::FindStoredFile(const char* archive, std::string_view path, uint64_t& offset, uint64_t& size)
+{
+	std::lock_guard lock(mountedLock);
+	auto it = mountedPacks.find(archive);
+	if (it == mountedPacks.end()) {
+		return false;
+	}
+	auto entry = it->second->index.Find(path);
+	if (!entry || entry->encoding != Encoding::None) {
+		return false;
+	}
+	offset = entry->offset;
+	size = entry->size;
+	return true;
+}
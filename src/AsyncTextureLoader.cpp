@@ -0,0 +1,81 @@
+#if !RVE_SERVER
+#include "AsyncTextureLoader.hpp"
+#include "Texture.hpp"
+#include "RenderEngine.hpp"
+#include "App.hpp"
+#include "Profile.hpp"
+#include <thread>
+
+using namespace RavEngine;
+
+AsyncTextureLoader::~AsyncTextureLoader() {
+    // decodes reference the queue
+    while (decodesInFlight > 0) {
+        std::this_thread::yield();
+    }
+}
+
+uint32_t AsyncTextureLoader::Register(AsyncTexture* texture) {
+    std::lock_guard lock(mtx);
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = uint32_t(entries.size());
+        entries.emplace_back();
+    }
+    entries[slot].texture = texture;
+    return slot;
+}
+
+void AsyncTextureLoader::Unregister(uint32_t slot) {
+    std::lock_guard lock(mtx);
+    auto& entry = entries[slot];
+    entry.texture = nullptr;
+    entry.generation++;
+    freeSlots.push_back(slot);
+}
+
+void AsyncTextureLoader::Load(uint32_t slot, Function<Decoded()>&& decode) {
+    uint32_t generation;
+    {
+        std::lock_guard lock(mtx);
+        generation = entries[slot].generation;
+    }
+    decodesInFlight++;
+    numPending++;
+    GetApp()->backgroundExecutor.silent_async([this, slot, generation, decode = std::move(decode)] {
+        auto result = decode();
+        result.slot = slot;
+        result.generation = generation;
+        decoded.enqueue(std::move(result));
+        decodesInFlight--;
+    });
+}
+
+void AsyncTextureLoader::Update(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine) {
+    RVE_PROFILE_FN;
+    Decoded next;
+    while (decoded.try_dequeue(next)) {
+        ready.push(std::move(next));
+    }
+
+    std::lock_guard lock(mtx);
+    uint64_t uploadedBytes = 0;
+    while (!ready.empty() && (uploadedBytes == 0 || uploadedBytes < uploadBudgetBytes)) {
+        auto& load = ready.front();
+        auto& entry = entries[load.slot];
+        // the texture may have been destroyed while loading
+        if (entry.texture != nullptr && entry.generation == load.generation) {
+            for (const auto& mip : load.mips) {
+                uploadedBytes += mip.size();
+            }
+            entry.texture->Upload(device, commandBuffer, engine, load);
+        }
+        ready.pop();
+        numPending--;
+    }
+}
+#endif
@@ -0,0 +1,121 @@
+#include "AudioADPCM.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace RavEngine;
+
+namespace {
+    constexpr std::array<int16_t, 89> stepTable{
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+        19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+        130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+        876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+        5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+
+    constexpr std::array<int8_t, 16> indexTable{
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+
+    struct State {
+        int32_t predictor = 0;
+        int32_t index = 0;
+
+        // apply a nibble, the same way for encoding and decoding so the two never drift apart
+        void Step(uint8_t nibble) {
+            const int32_t step = stepTable[index];
+            int32_t delta = step >> 3;
+            if (nibble & 4) {
+                delta += step;
+            }
+            if (nibble & 2) {
+                delta += step >> 1;
+            }
+            if (nibble & 1) {
+                delta += step >> 2;
+            }
+            predictor = std::clamp(predictor + ((nibble & 8) ? -delta : delta), -32768, 32767);
+            index = std::clamp(index + indexTable[nibble], 0, int32_t(stepTable.size() - 1));
+        }
+
+        uint8_t Encode(int32_t sample) {
+            int32_t diff = sample - predictor;
+            uint8_t nibble = 0;
+            if (diff < 0) {
+                nibble = 8;
+                diff = -diff;
+            }
+            int32_t step = stepTable[index];
+            for (uint8_t bit = 4; bit > 0; bit >>= 1) {
+                if (diff >= step) {
+                    nibble |= bit;
+                    diff -= step;
+                }
+                step >>= 1;
+            }
+            Step(nibble);
+            return nibble;
+        }
+    };
+
+    int16_t ToPCM(float sample) {
+        return int16_t(std::lround(std::clamp(sample, -1.f, 1.f) * 32767.f));
+    }
+}
+
+ADPCMChannel::ADPCMChannel(std::span<const float> samples) : numSamples(uint32_t(samples.size())) {
+    blocks.resize(size_t(GetNumBlocks()) * bytesPerBlock, 0);
+
+    // start with a step that fits the first change, instead of ramping up from the smallest step over the first few samples
+    State state;
+    if (samples.size() > 1) {
+        const auto firstDelta = std::abs(ToPCM(samples[1]) - ToPCM(samples[0]));
+        while (state.index < int32_t(stepTable.size() - 1) && stepTable[state.index] < firstDelta) {
+            state.index++;
+        }
+    }
+    for (uint32_t b = 0; b < GetNumBlocks(); b++) {
+        auto block = blocks.data() + size_t(b) * bytesPerBlock;
+        const auto first = size_t(b) * samplesPerBlock;
+
+        // the header stores the first sample exactly, the rest are deltas from it
+        const int16_t head = ToPCM(samples[first]);
+        state.predictor = head;
+        block[0] = uint8_t(head & 0xFF);
+        block[1] = uint8_t((uint16_t(head) >> 8) & 0xFF);
+        block[2] = uint8_t(state.index);
+
+        auto nibbles = block + headerBytes;
+        for (uint32_t i = 1; i < samplesPerBlock; i++) {
+            const auto pos = first + i;
+            const int32_t sample = pos < samples.size() ? ToPCM(samples[pos]) : 0;
+            const auto nibble = state.Encode(sample);
+            const auto n = i - 1;
+            nibbles[n / 2] |= (n % 2 == 0) ? nibble : uint8_t(nibble << 4);
+        }
+    }
+}
+
+void ADPCMChannel::DecodeBlock(uint32_t block, std::span<float, samplesPerBlock> out) const {
+    const auto data = blocks.data() + size_t(block) * bytesPerBlock;
+    constexpr float scale = 1.f / 32767.f;
+
+    State state;
+    state.predictor = int16_t(uint16_t(data[0]) | (uint16_t(data[1]) << 8));
+    state.index = std::min<int32_t>(data[2], stepTable.size() - 1);
+    out[0] = state.predictor * scale;
+
+    auto nibbles = data + headerBytes;
+    for (uint32_t i = 1; i < samplesPerBlock; i++) {
+        const auto n = i - 1;
+        const uint8_t nibble = (n % 2 == 0) ? (nibbles[n / 2] & 0x0F) : (nibbles[n / 2] >> 4);
+        state.Step(nibble);
+        out[i] = state.predictor * scale;
+    }
+}
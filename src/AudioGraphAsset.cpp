@@ -1,5 +1,6 @@
 #include "AudioGraphAsset.hpp"
 #include "AudioPlayer.hpp"
+#include <algorithm>
 
 using namespace RavEngine;
 
@@ -9,22 +10,74 @@ AudioGraphAsset::AudioGraphAsset(uint8_t nchannels) :
    
 }
 
-void AudioGraphAsset::Render(PlanarSampleBufferInlineView& inout, PlanarSampleBufferInlineView& scratchBuffer, uint8_t nchannels){
+void AudioGraphAsset::Render(PlanarSampleBufferInlineView& inout, PlanarSampleBufferInlineView& scratchBuffer, uint8_t nchannels, bool skipLeadingGain){
     assert(this->nchannels == nchannels);
     
+    auto it = filters.begin();
+    if (skipLeadingGain) {
+        while (it != filters.end() && (*it)->GetLinearGain()) {
+            ++it;
+        }
+    }
+    
     // iterate the stack
-    for (auto& filter : filters) {
+    bool swapped = false;
+    while (it != filters.end()) {
+        // fold a run of linear layers into one gain, applied in place
+        if (const auto gain = (*it)->GetLinearGain()) {
+            float total = *gain;
+            for (++it; it != filters.end(); ++it) {
+                const auto next = (*it)->GetLinearGain();
+                if (!next) {
+                    break;
+                }
+                total *= *next;
+            }
+            if (total != 1) {
+                for (uint8_t c = 0; c < inout.GetNChannels(); c++) {
+                    AudioKernels::Scale(inout[c].data(), inout[c].data(), total, inout.sizeOneChannel());
+                }
+            }
+            continue;
+        }
+        
         // call filter
-        filter->process(inout, scratchBuffer);
+        (*it)->process(inout, scratchBuffer);
+        ++it;
         
         //inout will now have the results of processing
         std::swap(inout, scratchBuffer);
+        swapped = !swapped;
+    }
+    
+    // callers often read the result through another view of inout's memory, so after an odd number of filters, copy it back there
+    if (swapped) {
+        std::swap(inout, scratchBuffer);
+        for (uint8_t c = 0; c < nchannels; c++) {
+            std::copy_n(scratchBuffer[c].data(), inout.sizeOneChannel(), inout[c].data());
+        }
     }
 }
 
+float AudioGraphAsset::GetLeadingGain() const {
+    float total = 1;
+    for (const auto& filter : filters) {
+        const auto gain = filter->GetLinearGain();
+        if (!gain) {
+            break;
+        }
+        total *= *gain;
+    }
+    return total;
+}
+
 
-void AudioGraphComposed::renderImpl(PlanarSampleBufferInlineView& inputSamples, PlanarSampleBufferInlineView& intermediateBuffer, uint8_t nchannels){
-    if (effectGraph){
-        effectGraph->Render(inputSamples, intermediateBuffer, nchannels);
+void AudioGraphComposed::renderImpl(PlanarSampleBufferInlineView& inputSamples, PlanarSampleBufferInlineView& intermediateBuffer, uint8_t nchannels, bool skipLeadingGain){
+    if (effectGraph && !effectGraph->filters.empty()){
+        effectGraph->Render(inputSamples, intermediateBuffer, nchannels, skipLeadingGain);
     }
+}
+
+float AudioGraphComposed::GetLeadingGain() const {
+    return effectGraph ? effectGraph->GetLeadingGain() : 1;
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "AudioKernels.hpp"
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define RVE_AUDIO_SSE 1
+    #include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define RVE_AUDIO_NEON 1
+    #include <arm_neon.h>
+#endif
+
+using namespace RavEngine;
+
+void AudioKernels::Fill(float* data, float value, size_t n) {
+    size_t i = 0;
+#if RVE_AUDIO_SSE
+    const __m128 v = _mm_set1_ps(value);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(data + i, v);
+    }
+#elif RVE_AUDIO_NEON
+    const float32x4_t v = vdupq_n_f32(value);
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(data + i, v);
+    }
+#endif
+    for (; i < n; i++) {
+        data[i] = value;
+    }
+}
+
+void AudioKernels::Add(float* dst, const float* src, size_t n) {
+    size_t i = 0;
+#if RVE_AUDIO_SSE
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_loadu_ps(src + i + 4)));
+    }
+#elif RVE_AUDIO_NEON
+    for (; i + 8 <= n; i += 8) {
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+        vst1q_f32(dst + i + 4, vaddq_f32(vld1q_f32(dst + i + 4), vld1q_f32(src + i + 4)));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] += src[i];
+    }
+}
+
+void AudioKernels::Scale(float* dst, const float* src, float gain, size_t n) {
+    size_t i = 0;
+#if RVE_AUDIO_SSE
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+    }
+#elif RVE_AUDIO_NEON
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(src + i), gain));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = src[i] * gain;
+    }
+}
+
+void AudioKernels::Clamp(float* data, float lo, float hi, size_t n) {
+    size_t i = 0;
+#if RVE_AUDIO_SSE
+    const __m128 l = _mm_set1_ps(lo), h = _mm_set1_ps(hi);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(data + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), l), h));
+    }
+#elif RVE_AUDIO_NEON
+    const float32x4_t l = vdupq_n_f32(lo), h = vdupq_n_f32(hi);
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(data + i, vminq_f32(vmaxq_f32(vld1q_f32(data + i), l), h));
+    }
+#endif
+    for (; i < n; i++) {
+        data[i] = std::clamp(data[i], lo, hi);
+    }
+}
+
+void AudioKernels::InterleaveClamped(const float* planar, uint8_t nchannels, size_t frames, float* interleaved) {
+    size_t i = 0;
+    // stereo is the usual output, so it gets a shuffle instead of a strided loop
+    if (nchannels == 2) {
+        const float* left = planar;
+        const float* right = planar + frames;
+#if RVE_AUDIO_SSE
+        const __m128 l = _mm_set1_ps(-1), h = _mm_set1_ps(1);
+        for (; i + 4 <= frames; i += 4) {
+            const __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(left + i), l), h);
+            const __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(right + i), l), h);
+            _mm_storeu_ps(interleaved + i * 2, _mm_unpacklo_ps(a, b));
+            _mm_storeu_ps(interleaved + i * 2 + 4, _mm_unpackhi_ps(a, b));
+        }
+#elif RVE_AUDIO_NEON
+        const float32x4_t l = vdupq_n_f32(-1), h = vdupq_n_f32(1);
+        for (; i + 4 <= frames; i += 4) {
+            float32x4x2_t pair;
+            pair.val[0] = vminq_f32(vmaxq_f32(vld1q_f32(left + i), l), h);
+            pair.val[1] = vminq_f32(vmaxq_f32(vld1q_f32(right + i), l), h);
+            vst2q_f32(interleaved + i * 2, pair);
+        }
+#endif
+    }
+    for (; i < frames; i++) {
+        for (uint8_t c = 0; c < nchannels; c++) {
+            interleaved[i * nchannels + c] = std::clamp(planar[c * frames + i], -1.f, 1.f);
+        }
+    }
+}
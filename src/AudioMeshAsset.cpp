@@ -64,6 +64,10 @@ namespace RavEngine {
 		iplSceneCreate(context, &sceneSettings, &iplscene);
 
 		iplStaticMeshCreate(iplscene, &staticMeshSettings, &staticMesh);
+
+		// the geometry never changes, so the scene is committed once and every instance of it shares the result
+		iplStaticMeshAdd(staticMesh, iplscene);
+		iplSceneCommit(iplscene);
 	}
 
 	AudioMeshAsset::~AudioMeshAsset()
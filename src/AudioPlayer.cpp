@@ -8,9 +8,12 @@
 #include "AudioSource.hpp"
 #include "AudioSpace.hpp"
 #include "DataStructures.hpp"
+#include "FrameArena.hpp"
 #include "AudioGraphAsset.hpp"
 #include "App.hpp"
 #include "Profile.hpp"
+#include "PerfCounters.hpp"
+#include "SystemInfo.hpp"
 #include <algorithm>
 #if _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -43,6 +46,15 @@ constexpr auto doDataProvider = [](auto&& player) {
 };
 
 
+constexpr auto doVirtualProvider = [](auto&& player) {
+    auto renderData = &player->renderData;
+    auto sharedBufferView = renderData->GetWritableDataBufferView();
+    auto effectScratchBuffer = renderData->GetWritableScratchBufferView();
+
+    player->AdvanceSilently(sharedBufferView, effectScratchBuffer);
+};
+
+
 struct AudioWorker : public tf::WorkerInterface{
     void scheduler_prologue(tf::Worker& worker) final{
 #if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
@@ -53,6 +65,8 @@ struct AudioWorker : public tf::WorkerInterface{
                     "Audio Worker"
                     );
 #endif
+        // a late mix is an audible glitch
+        SystemInfo::PlaceCurrentThread(SystemInfo::ThreadRole::LatencyCritical);
     }
     void scheduler_epilogue(tf::Worker& worker, std::exception_ptr ptr) final{};
 };
@@ -69,18 +83,12 @@ std::string_view IPLerrorToString(IPLerror error){
     }
 }
 
-AudioPlayer::AudioPlayer() : audioExecutor{2, std::make_shared<AudioWorker>()}{
+AudioPlayer::AudioPlayer(uint16_t nWorkers) : audioExecutor{nWorkers, std::make_shared<AudioWorker>()}{
     
 }
 
-template<typename T>
-inline static void TMemset(T* data, T value, size_t nData){
-    std::fill(data, data+nData, value);
-}
-
-template<typename T>
-inline static void TZero(T* data, size_t nData){
-    TMemset<T>(data, 0, nData);
+inline static void TZero(float* data, size_t nData){
+    AudioKernels::Fill(data, 0, nData);
 }
 
 void AudioPlayer::Tick() {
@@ -89,6 +97,7 @@ void AudioPlayer::Tick() {
     auto queuedSize = SDL_GetAudioStreamQueued(stream);
     if (queuedSize < maxAudioSampleLatency) {
         RVE_PROFILE_SECTION(tickAudio,"AudioPlayer::Tick");
+        const auto quantumBegin = std::chrono::steady_clock::now();
         GetApp()->SwapRenderAudioSnapshotIfNeeded();
         SnapshotToRender = GetApp()->GetRenderAudioSnapshot();
 #if USE_MT_IMPL
@@ -98,11 +107,63 @@ void AudioPlayer::Tick() {
 #endif
         
         SDL_PutAudioStreamData(stream, interleavedOutputBuffer.data(), interleavedOutputBuffer.size() * sizeof(interleavedOutputBuffer[0]));
+        RecordMetrics(quantumBegin, uint32_t(std::max(queuedSize, 0) / (sizeof(float) * nchannels)));
         RVE_PROFILE_SECTION_END(tickAudio);
     }
 }
 
-void RavEngine::AudioPlayer::CalculateGeometryAudioSpace(AudioSnapshot::GeometryAudioSpaceData& r) {
+void AudioPlayer::RecordMetrics(std::chrono::steady_clock::time_point quantumBegin, uint32_t queuedFrames) {
+    const auto stageEnd = [this](Stage stage) {
+        return stageEnds[size_t(stage)];
+    };
+    // rooms begin once the point sources are done, so a stage is timed from the end of the one before it
+    const auto providersEnd = stageEnd(Stage::Providers);
+    const auto roomsEnd = std::max(stageEnd(Stage::Rooms), providersEnd);
+    const auto now = std::chrono::steady_clock::now();
+
+    Metrics m;
+    bool underran = false;
+    {
+        std::lock_guard lock(metricsMtx);
+        metrics.providerTime = providersEnd - stageEnd(Stage::Preamble);
+        metrics.roomTime = roomsEnd - providersEnd;
+        metrics.finalMixTime = stageEnd(Stage::FinalMix) - roomsEnd;
+        metrics.quantumTime = now - quantumBegin;
+        metrics.queuedFrames = queuedFrames;
+        metrics.activeVoices = Debug::AssertSize<uint32_t>(SnapshotToRender->dataProviders.size());
+        metrics.virtualVoices = Debug::AssertSize<uint32_t>(SnapshotToRender->virtualProviders.size());
+        // the first quantum begins with nothing queued because nothing was rendered yet
+        if (queuedFrames == 0 && metrics.quanta > 0) {
+            metrics.underruns++;
+            underran = true;
+        }
+        metrics.quanta++;
+        m = metrics;
+    }
+
+    RVE_PROFILE_PLOT("Audio Provider Time (ms)", m.providerTime.count());
+    RVE_PROFILE_PLOT("Audio Room Time (ms)", m.roomTime.count());
+    RVE_PROFILE_PLOT("Audio Final Mix Time (ms)", m.finalMixTime.count());
+    RVE_PROFILE_PLOT("Audio Quantum Time (ms)", m.quantumTime.count());
+    RVE_PROFILE_PLOT("Audio Queued Frames", int64_t(m.queuedFrames));
+    RVE_PROFILE_PLOT("Audio Underruns", int64_t(m.underruns));
+    RVE_PROFILE_PLOT("Audio Active Voices", int64_t(m.activeVoices));
+    RVE_PROFILE_PLOT("Audio Virtual Voices", int64_t(m.virtualVoices));
+
+    static auto quantumTime = PerfCounters::GetHistogram("Audio: Quantum (ms)");
+    static auto underruns = PerfCounters::GetCounter("Audio: Underruns");
+    static auto activeVoices = PerfCounters::GetGauge("Audio: Active Voices");
+    quantumTime->Record(m.quantumTime.count());
+    underruns->Add(underran);
+    activeVoices->Set(m.activeVoices);
+}
+
+AudioPlayer::Metrics AudioPlayer::GetMetrics() const {
+    std::lock_guard lock(metricsMtx);
+    return metrics;
+}
+
+bool RavEngine::AudioPlayer::PrepareGeometryAudioSpace(AudioSnapshot::GeometryAudioSpaceData& r) {
     RVE_PROFILE_FN;
     auto& room = r.room;
 
@@ -122,12 +183,14 @@ void RavEngine::AudioPlayer::CalculateGeometryAudioSpace(AudioSnapshot::Geometry
 
     // first check that the listener is inside the room
     if (!r.IsInsideMeshArea(lpos)) {
-        return;
+        return false;
     }
 
-    // add meshes
+    // add meshes. The scene only changes for the meshes that moved, unless the room moved.
+    const bool roomMoved = room->lastInvRoomTransform != r.invRoomTransform;
+    room->lastInvRoomTransform = r.invRoomTransform;
     for (const auto& mesh : SnapshotToRender->audioMeshes) {
-        room->ConsiderMesh(mesh.asset, mesh.worldTransform, r.worldpos, r.invRoomTransform, mesh.ownerID);
+        room->ConsiderMesh(mesh.asset, mesh.worldTransform, r.worldpos, r.invRoomTransform, mesh.ownerID, roomMoved);
     }
 
     for (const auto& source : SnapshotToRender->sources) {
@@ -146,24 +209,34 @@ void RavEngine::AudioPlayer::CalculateGeometryAudioSpace(AudioSnapshot::Geometry
     listenerUp = r.invRoomTransform * listenerUp;
 
     room->CalculateRoom(r.invRoomTransform, listenerForward, listenerUp, listenerRight);
+    return true;
+}
 
-    // render each source
-
-    auto outputView = room->workingBuffers.GetWritableDataBufferView();
-    auto outputScratchView = room->workingBuffers.GetWritableScratchBufferView();
-
+void RavEngine::AudioPlayer::RenderGeometrySources(AudioSnapshot::GeometryAudioSpaceData& r, uint32_t begin, uint32_t end, PlanarSampleBufferInlineView& accumulationView, SingleAudioRenderBuffer& working) {
+    RVE_PROFILE_FN;
+    auto outputView = working.GetWritableDataBufferView();
+    auto outputScratchView = working.GetWritableScratchBufferView();
 
-    for (const auto& source : SnapshotToRender->sources) {
+    for (uint32_t i = begin; i < end; i++) {
+        const auto& source = SnapshotToRender->sources[i];
         TZero(outputView.data(), outputView.size());
         TZero(outputScratchView.data(), outputScratchView.size());
-        room->RenderAudioSource(outputView, outputScratchView, source.ownerID, source.data->renderData.GetReadonlyDataBufferView(), invListenerTransform);
+        r.room->RenderAudioSource(outputView, outputScratchView, source.ownerID, source.data->renderData.GetReadonlyDataBufferView(), invListenerTransform);
        
         AdditiveBlendSamples(accumulationView, outputView);
     }
 }
 
+void RavEngine::AudioPlayer::CalculateGeometryAudioSpace(AudioSnapshot::GeometryAudioSpaceData& r) {
+    if (!PrepareGeometryAudioSpace(r)) {
+        return;
+    }
+    auto accumulationView = r.room->accumulationBuffer.GetWritableDataBufferView();
+    RenderGeometrySources(r, 0, Debug::AssertSize<uint32_t>(SnapshotToRender->sources.size()), accumulationView, r.room->workingBuffers);
+}
+
 
-void RavEngine::AudioPlayer::CalculateSimpleAudioSpace(AudioSnapshot::SimpleAudioSpaceData& r)
+bool RavEngine::AudioPlayer::PrepareSimpleAudioSpace(AudioSnapshot::SimpleAudioSpaceData& r)
 {
     RVE_PROFILE_FN;
     auto& room = r.room;
@@ -178,16 +251,17 @@ void RavEngine::AudioPlayer::CalculateSimpleAudioSpace(AudioSnapshot::SimpleAudi
 
     // existing sources
     // first check that the listener is inside the room
-    if (!r.IsInsideSourceArea(lpos)) {
-        return;
-    }
-
-    auto outputView = room->workingBuffers.GetWritableDataBufferView();
-    auto outputScratchView = room->workingBuffers.GetWritableScratchBufferView();
+    return r.IsInsideSourceArea(lpos);
+}
 
-   
+void RavEngine::AudioPlayer::RenderSimpleSources(AudioSnapshot::SimpleAudioSpaceData& r, uint32_t begin, uint32_t end, PlanarSampleBufferInlineView& accumulationView, SingleAudioRenderBuffer& working)
+{
+    RVE_PROFILE_FN;
+    auto outputView = working.GetWritableDataBufferView();
+    auto outputScratchView = working.GetWritableScratchBufferView();
 
-    for (const auto& source : SnapshotToRender->sources) {
+    for (uint32_t i = begin; i < end; i++) {
+        const auto& source = SnapshotToRender->sources[i];
         // is this source inside the space? if not, then don't process it
         if (!r.IsInsideSourceArea(source.worldpos)) {
             continue;
@@ -200,13 +274,73 @@ void RavEngine::AudioPlayer::CalculateSimpleAudioSpace(AudioSnapshot::SimpleAudi
         TZero(outputView.data(), outputView.size());
         TZero(outputScratchView.data(), outputScratchView.size());
 
-        room->RenderAudioSource(outputView, outputScratchView,
+        r.room->RenderAudioSource(outputView, outputScratchView,
             sourceView, source.worldpos, source.ownerID,
             invListenerTransform
         );
         AdditiveBlendSamples(accumulationView, outputView);
     }
-    
+}
+
+void RavEngine::AudioPlayer::CalculateSimpleAudioSpace(AudioSnapshot::SimpleAudioSpaceData& r)
+{
+    if (!PrepareSimpleAudioSpace(r)) {
+        return;
+    }
+    auto accumulationView = r.room->accumulationBuffer.GetWritableDataBufferView();
+    RenderSimpleSources(r, 0, Debug::AssertSize<uint32_t>(SnapshotToRender->sources.size()), accumulationView, r.room->workingBuffers);
+}
+
+template<typename Space, typename Prepare, typename Render>
+void RavEngine::AudioPlayer::EmplaceSpaceTasks(tf::Subflow& subflow, Space& r, Prepare prepare, Render render)
+{
+    subflow.emplace([this, &r, prepare, render](tf::Subflow& roomFlow) {
+        if (!(this->*prepare)(r)) {
+            return;
+        }
+        auto& room = r.room;
+        const auto nSources = Debug::AssertSize<uint32_t>(SnapshotToRender->sources.size());
+
+        // the effect graph of the space may keep state between sources, so it cannot be shared across threads
+        uint32_t nChunks = 1;
+        if (!room->GetGraph()) {
+            nChunks = std::clamp<uint32_t>(nSources / minSourcesPerChunk, 1, Debug::AssertSize<uint32_t>(workerBuffers.size()));
+        }
+        if (nChunks == 1) {
+            auto accumulationView = room->accumulationBuffer.GetWritableDataBufferView();
+            (this->*render)(r, 0, nSources, accumulationView, room->workingBuffers);
+            return;
+        }
+
+        // chunk 0 mixes into the space's buffer, the others into their own
+        while (room->partialMixes.size() < nChunks - 1) {
+            room->partialMixes.push_back(std::make_unique<SingleAudioRenderBufferNoScratch>(GetBufferSize(), GetNChannels()));
+        }
+        const auto mixOf = [&room](uint32_t chunk) -> SingleAudioRenderBufferNoScratch& {
+            return chunk == 0 ? room->accumulationBuffer : *room->partialMixes[chunk - 1];
+        };
+
+        auto reduce = roomFlow.emplace([&mixOf, nChunks] {
+            // pairwise, so every sum is of two mixes of about the same number of sources
+            for (uint32_t stride = 1; stride < nChunks; stride *= 2) {
+                for (uint32_t i = 0; i + stride < nChunks; i += stride * 2) {
+                    auto into = mixOf(i).GetWritableDataBufferView();
+                    AdditiveBlendSamples(into, mixOf(i + stride).GetReadonlyDataBufferView());
+                }
+            }
+        });
+        for (uint32_t chunk = 0; chunk < nChunks; chunk++) {
+            roomFlow.emplace([this, &r, &mixOf, render, chunk, nChunks, nSources] {
+                auto accumulationView = mixOf(chunk).GetWritableDataBufferView();
+                if (chunk != 0) {
+                    TZero(accumulationView.data(), accumulationView.size());
+                }
+                auto& working = *workerBuffers[audioExecutor.this_worker_id()];
+                (this->*render)(r, uint64_t(nSources) * chunk / nChunks, uint64_t(nSources) * (chunk + 1) / nChunks, accumulationView, working);
+            }).precede(reduce);
+        }
+        roomFlow.join();
+    });
 }
 
 
@@ -294,27 +428,8 @@ void RavEngine::AudioPlayer::CalculateFinalMix()
             }
             */
 
-    InterleavedSampleBufferView accumView{ interleavedOutputBuffer.data(), interleavedOutputBuffer.size() };
-    TZero(accumView.data(), accumView.size());  // reset to silence
-
-    const auto blendBufferIn = [accumView](PlanarSampleBufferInlineView sourceView) {
-        const auto nchannels = sourceView.GetNChannels();
-#pragma omp simd
-        for (int i = 0; i < accumView.size(); i++) {
-            //mix with existing
-            // also perform planar-to-interleaved conversion
-            accumView[i] += sourceView[i % nchannels][i / nchannels];
-        }
-        };
-
-    // copy the mix created by worker threads to the current mix 
-    blendBufferIn(sharedBufferView);
-
-    //clipping: clamp all values to [-1,1]
-#pragma omp simd
-    for (int i = 0; i < accumView.size(); i++) {
-        accumView[i] = std::clamp(accumView[i], -1.0f, 1.0f);
-    }
+    // copy the mix created by worker threads to the output, converting it to interleaved and clipping it to [-1,1]
+    AudioKernels::InterleaveClamped(sharedBufferView.data(), sharedBufferView.GetNChannels(), sharedBufferView.sizeOneChannel(), interleavedOutputBuffer.data());
 
     globalSamples += GetBufferSize();
 }
@@ -329,6 +444,10 @@ void RavEngine::AudioPlayer::ST_DoMix()
     for (auto& ambient : SnapshotToRender->ambientSources) {
         doDataProvider(ambient);
     }
+    for (auto& provider : SnapshotToRender->virtualProviders) {
+        doVirtualProvider(provider);
+    }
+    MarkStageEnd(Stage::Providers);
 
     for (auto& space : SnapshotToRender->simpleAudioSpaces) {
         CalculateSimpleAudioSpace(space);
@@ -341,8 +460,10 @@ void RavEngine::AudioPlayer::ST_DoMix()
     for (auto& space : SnapshotToRender->boxAudioSpaces) {
         CalculateBoxAudioSpace(space);
     }
+    MarkStageEnd(Stage::Rooms);
 
     CalculateFinalMix();
+    MarkStageEnd(Stage::FinalMix);
 }
 
 void RavEngine::AudioPlayer::PerformAudioTickPreamble()
@@ -351,6 +472,8 @@ void RavEngine::AudioPlayer::PerformAudioTickPreamble()
     dataProvidersEnd = SnapshotToRender->dataProviders.end();
     ambientSourcesBegin = SnapshotToRender->ambientSources.begin();
     ambientSourcesEnd = SnapshotToRender->ambientSources.end();
+    virtualProvidersBegin = SnapshotToRender->virtualProviders.begin();
+    virtualProvidersEnd = SnapshotToRender->virtualProviders.end();
 
     simpleSpacesBegin = SnapshotToRender->simpleAudioSpaces.begin();
     simpleSpacesEnd = SnapshotToRender->simpleAudioSpaces.end();
@@ -367,25 +490,18 @@ void RavEngine::AudioPlayer::PerformAudioTickPreamble()
     listenerTransform = glm::translate(matrix4(1), (vector3)lpos) * glm::toMat4((quaternion)lrot);
     invListenerTransform = glm::inverse(listenerTransform);
 
+    // stages that have nothing to do this quantum end when the preamble does
+    stageEnds.fill(std::chrono::steady_clock::now());
+
     auto lockedworld = SnapshotToRender->sourceWorld.lock();
     if (lockedworld == nullptr) {
         return;
     }
     // copy out the destroyed sources
     destroyedSources.clear();
-    {
-        entity_id_t id = INVALID_ENTITY;
-        while (lockedworld->destroyedAudioSources.try_dequeue(id)) {
-            destroyedSources.push_back(id);
-        }
-    }
+    DequeueAllInto(lockedworld->destroyedAudioSources, destroyedSources);
     destroyedMeshComponents.clear();
-    {
-        entity_id_t id = INVALID_ENTITY;
-        while (lockedworld->destroyedAudioSources.try_dequeue(id)) {
-            destroyedMeshComponents.push_back(id);
-        }
-    }
+    DequeueAllInto(lockedworld->destroyedMeshSources, destroyedMeshComponents);
 }
 
 void AudioPlayer::SetupAudioTaskGraph(){
@@ -401,25 +517,41 @@ void AudioPlayer::SetupAudioTaskGraph(){
     // ambient sources
     auto processAmbients = audioTaskflow.for_each(std::ref(ambientSourcesBegin), std::ref(ambientSourcesEnd), doDataProvider).name("Process ambient audio").succeed(updateIterators);
 
-    // once point sources have completed, start processing Rooms
-    auto processSimpleRooms = audioTaskflow.for_each(std::ref(simpleSpacesBegin), std::ref(simpleSpacesEnd), [this](AudioSnapshot::SimpleAudioSpaceData& r) {
-        CalculateSimpleAudioSpace(r);
+    // virtualized point sources only advance, they are not mixed
+    auto processVirtualProviders = audioTaskflow.for_each(std::ref(virtualProvidersBegin), std::ref(virtualProvidersEnd), doVirtualProvider).name("Advance virtual point sources").succeed(updateIterators);
+
+    // once point sources have completed, start processing Rooms. The sources of each room are also split across workers.
+    auto processSimpleRooms = audioTaskflow.emplace([this](tf::Subflow& subflow) {
+        for (auto it = simpleSpacesBegin; it != simpleSpacesEnd; ++it) {
+            EmplaceSpaceTasks(subflow, *it, &AudioPlayer::PrepareSimpleAudioSpace, &AudioPlayer::RenderSimpleSources);
+        }
     }).name("Process Simple Audio Rooms").succeed(processDataProviders);
 
-    auto processGeometryRooms = audioTaskflow.for_each(std::ref(geometrySpacesBegin), std::ref(geometrySpacesEnd), [this](AudioSnapshot::GeometryAudioSpaceData& r) {
-        CalculateGeometryAudioSpace(r);
+    auto processGeometryRooms = audioTaskflow.emplace([this](tf::Subflow& subflow) {
+        for (auto it = geometrySpacesBegin; it != geometrySpacesEnd; ++it) {
+            EmplaceSpaceTasks(subflow, *it, &AudioPlayer::PrepareGeometryAudioSpace, &AudioPlayer::RenderGeometrySources);
+        }
     }).name("Process Geometry Audio Rooms").succeed(processDataProviders);
 
     auto processBoxRooms = audioTaskflow.for_each(std::ref(boxSpacesBegin), std::ref(boxSpacesEnd), [this](AudioSnapshot::BoxReverbationSpaceData& r) {
         CalculateBoxAudioSpace(r);
     }).name("Process Box Audio Rooms").succeed(processDataProviders);
 
+    // timestamps for the metrics. Nothing waits on these.
+    audioTaskflow.emplace([this] {
+        MarkStageEnd(Stage::Providers);
+    }).name("Providers complete").succeed(processDataProviders, processAmbients, processVirtualProviders);
+    audioTaskflow.emplace([this] {
+        MarkStageEnd(Stage::Rooms);
+    }).name("Rooms complete").succeed(processSimpleRooms, processGeometryRooms, processBoxRooms);
+
     // once rooms are done, do the final mix
     auto finalMix = audioTaskflow.emplace([this] {
 
         CalculateFinalMix();
+        MarkStageEnd(Stage::FinalMix);
 
-    }).name("Final audio mix").succeed(processDataProviders, processAmbients, processSimpleRooms, processGeometryRooms, processBoxRooms);
+    }).name("Final audio mix").succeed(processDataProviders, processAmbients, processVirtualProviders, processSimpleRooms, processGeometryRooms, processBoxRooms);
     //audioTaskflow.dump(std::cout);
 }
 
@@ -449,6 +581,9 @@ void AudioPlayer::Init(){
     buffer_size = config_buffersize;
 
     playerRenderBuffer.emplace(buffer_size,nchannels);
+    for (size_t i = 0; i < audioExecutor.num_workers(); i++) {
+        workerBuffers.push_back(std::make_unique<SingleAudioRenderBuffer>(buffer_size, nchannels));
+    }
     interleavedOutputBuffer.resize(buffer_size * nchannels, 0);
     maxAudioSampleLatency = buffer_size * 16;
 	
@@ -490,6 +625,40 @@ void AudioPlayer::Init(){
         }
     });
     audioTickThread->detach();
+
+    // reflections and occlusion are too slow to simulate every quantum, so they run behind the audio at a lower rate
+    simulationThread.emplace([this] {
+        SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_LOW);
+        while (audioThreadShouldRun) {
+            const auto next = std::chrono::steady_clock::now() + config_simulationInterval;
+            SimulateSpaces();
+            std::this_thread::sleep_until(next);
+        }
+    });
+}
+
+void AudioPlayer::AddSimulatedSpace(const Ref<GeometryAudioSpace::RoomData>& space) {
+    std::lock_guard lock(simulatedSpacesMtx);
+    simulatedSpaces.push_back(space);
+}
+
+void AudioPlayer::SimulateSpaces() {
+    RVE_PROFILE_FN;
+    // lock the spaces for the whole pass, so none is destroyed while it simulates
+    FrameVector<Ref<GeometryAudioSpace::RoomData>> spaces;
+    {
+        std::lock_guard lock(simulatedSpacesMtx);
+        std::erase_if(simulatedSpaces, [&spaces](const WeakRef<GeometryAudioSpace::RoomData>& weak) {
+            auto space = weak.lock();
+            if (space) {
+                spaces.push_back(std::move(space));
+            }
+            return !space;
+        });
+    }
+    for (const auto& space : spaces) {
+        space->Simulate();
+    }
 }
 
 void AudioPlayer::Shutdown(){
@@ -498,6 +667,10 @@ void AudioPlayer::Shutdown(){
         audioTickThread->join();
     }
     audioTickThread.reset();
+    if (simulationThread->joinable()) {
+        simulationThread->join();
+    }
+    simulationThread.reset();
 
 	SDL_CloseAudioDevice(SDL_GetAudioStreamDevice(stream));
     iplHRTFRelease(&steamAudioHRTF);
@@ -0,0 +1,39 @@
+#if !RVE_SERVER
+#include "AudioSnapshot.hpp"
+#include <algorithm>
+#include <atomic>
+
+using namespace RavEngine;
+
+uint64_t AudioSnapshot::NextStamp(){
+    static std::atomic<uint64_t> counter = 1;
+    return counter++;
+}
+
+void AudioSnapshot::LimitVoices(){
+    if (maxVoices == 0 || sources.size() <= maxVoices){
+        return;
+    }
+    
+    // inverse distance attenuation, as the spaces apply it, clamped so sources at the listener do not rank infinitely high
+    const auto audibility = [this](const PointSource& source){
+        const auto distance = std::max<float>(glm::distance(source.worldpos, listenerPos), 1);
+        return source.data->GetVolume() * source.data->GetPriority() / distance;
+    };
+    
+    auto& all = sources.get_underlying();
+    std::nth_element(all.begin(), all.begin() + maxVoices, all.end(), [&audibility](const PointSource& a, const PointSource& b){
+        return audibility(a) > audibility(b);
+    });
+    
+    // a provider shared by a kept source and a cut one must still be rendered
+    const auto keep = NextStamp();
+    for (uint32_t i = 0; i < maxVoices; i++){
+        all[i].data->snapshotStamp = keep;
+    }
+    dataProviders.Partition([keep](const Ref<AudioDataProvider>& provider){
+        return provider->snapshotStamp == keep;
+    }, virtualProviders);
+    all.erase(all.begin() + maxVoices, all.end());
+}
+#endif
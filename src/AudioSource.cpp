@@ -13,7 +13,9 @@
 #include <CDSPResampler.h>
 #include "VirtualFileSystem.hpp"
 #include "AudioPlayer.hpp"
+#include "SerializedAudio.hpp"
 #include <phonon.h>
+#include <cstring>
 
 using namespace RavEngine;
 using namespace std;
@@ -37,22 +39,62 @@ InstantaneousAmbientAudioSource::InstantaneousAmbientAudioSource(Ref<AudioAsset>
     player->Play();
 }
 
-AudioAsset::AudioAsset(const std::string& name, decltype(nchannels) desired_channels){
+AudioAsset::AudioAsset(const std::string& name, decltype(nchannels) desired_channels, Encoding encoding){
 	//expand audio into buffer
 	string path = Format("/sounds/{}", name);
 	auto datavec = GetApp()->GetResources().FileContentsAt<std::vector<uint8_t>>(path.c_str(),false);    // the extra arg signals not to null terminate the file data
 	
 	const int desiredSampleRate = AudioPlayer::GetSamplesPerSec();
 	
-	nqr::NyquistIO loader;
 	auto file_ext = Filesystem::Path(path).extension().string().substr(1);
 	nqr::AudioData data;
-	loader.Load(&data, file_ext, datavec);
+	if (file_ext == "rvesnd") {
+		// compiled by rveauc, already planar
+		SerializedAudioDataHeader header;
+		Debug::Assert(datavec.size() >= sizeof(header), "{} is not a compiled sound", path);
+		std::memcpy(&header, datavec.data(), sizeof(header));
+		Debug::Assert(header.header == SerializedAudioDataHeader{}.header, "{} is not a compiled sound", path);
+		const auto planarSamples = reinterpret_cast<const float*>(datavec.data() + sizeof(header));
+		const auto nPlanarSamples = size_t(header.numSamples) * header.nchannels;
+		Debug::Assert(datavec.size() >= sizeof(header) + nPlanarSamples * sizeof(float), "{} is truncated", path);
+
+		if (int(header.sampleRate) == desiredSampleRate && header.nchannels == desired_channels) {
+			nchannels = header.nchannels;
+			numSamples = header.numSamples;
+			lengthSeconds = header.lengthSeconds;
+			if (encoding == Encoding::ADPCM) {
+				for (uint8_t c = 0; c < nchannels; c++) {
+					compressed.emplace_back(std::span<const float>(planarSamples + size_t(c) * numSamples, numSamples));
+				}
+				return;
+			}
+			auto planar = new float[nPlanarSamples];
+			std::memcpy(planar, planarSamples, nPlanarSamples * sizeof(float));
+			audiodata = planar;
+			data = PlanarSampleBufferInlineView{ planar, nPlanarSamples, numSamples };
+			return;
+		}
+
+		// compiled for another output configuration, so convert it like any other file
+		data.sampleRate = header.sampleRate;
+		data.channelCount = header.nchannels;
+		data.lengthSeconds = header.lengthSeconds;
+		data.samples.resize(nPlanarSamples);
+		for (uint8_t c = 0; c < header.nchannels; c++) {
+			for (uint32_t i = 0; i < header.numSamples; i++) {
+				data.samples[size_t(i) * header.nchannels + c] = planarSamples[size_t(c) * header.numSamples + i];
+			}
+		}
+	}
+	else {
+		nqr::NyquistIO loader;
+		loader.Load(&data, file_ext, datavec);
+	}
 	
 	if (data.sampleRate != desiredSampleRate){
 		//assume that in release the user intends this behavior, so do not send the warning.
 #ifndef NDEBUG
-		Debug::Warning("Sample rate mismatch in {} - requested {} hz but got {} hz. Beginning resampling - to reduce load times, supply audio in the correct sample rate.", path, desiredSampleRate, data.sampleRate);
+		Debug::Warning("Sample rate mismatch in {} - requested {} hz but got {} hz. Beginning resampling - to reduce load times, supply audio in the correct sample rate, or compile it with COMPILED_SOUNDS.", path, desiredSampleRate, data.sampleRate);
 #endif
 
 		// resample to the correct rate
@@ -105,6 +147,19 @@ AudioAsset::AudioAsset(const std::string& name, decltype(nchannels) desired_chan
 
 	
 	lengthSeconds = data.lengthSeconds;
+	numSamples = uint32_t(data.samples.size() / nchannels);
+	
+	if (encoding == Encoding::ADPCM) {
+		// compress each channel straight from the interleaved samples, the planar floats are never kept
+		Vector<float> channel(numSamples);
+		for (uint8_t c = 0; c < nchannels; c++) {
+			for (uint32_t i = 0; i < numSamples; i++) {
+				channel[i] = data.samples[size_t(i) * nchannels + c];
+			}
+			compressed.emplace_back(channel);
+		}
+		return;
+	}
 	
     audiodata = new float[data.samples.size()]{0};
     
@@ -155,6 +210,15 @@ void SampledAudioDataProvider::ProvideBufferData(PlanarSampleBufferInlineView& b
         playhead_pos = globalAudioTime - lastPlayTime;
     }
     
+    // the graph's leading gain layers ride along with the volume, so a graph of only gains costs nothing
+    const float gain = volume * AudioGraphComposed::GetLeadingGain();
+    
+    if (asset->IsCompressed()){
+        ProvideCompressedData(buffer, playhead_pos, gain);
+        AudioGraphComposed::Render(buffer,scratchSpace, asset->GetNChanels(), true);
+        return;
+    }
+    
     for(size_t i = 0; i < buffer.sizeOneChannel(); i++){
         //is playhead past end of source?
         if (playhead_pos >= nsamples){
@@ -172,10 +236,68 @@ void SampledAudioDataProvider::ProvideBufferData(PlanarSampleBufferInlineView& b
         }
 #pragma omp simd
         for(uint8_t c = 0; c < nchannels; c++){
-            buffer[c][i] = asset->data[c][playhead_pos] * volume;
+            buffer[c][i] = asset->data[c][playhead_pos] * gain;
         }
         playhead_pos++;
     }
-    AudioGraphComposed::Render(buffer,scratchSpace, asset->GetNChanels());
+    AudioGraphComposed::Render(buffer,scratchSpace, asset->GetNChanels(), true);
+}
+
+void SampledAudioDataProvider::AdvanceSilently(PlanarSampleBufferInlineView& buffer, PlanarSampleBufferInlineView& scratchSpace){
+    if (loops){
+        return;
+    }
+    const auto playhead_pos = GetApp()->GetAudioPlayer()->GetGlobalAudioTime() - lastPlayTime;
+    if (playhead_pos + buffer.sizeOneChannel() > asset->GetNumSamples()){
+        isPlaying = false;
+    }
+}
+
+void SampledAudioDataProvider::ProvideCompressedData(PlanarSampleBufferInlineView& buffer, uint64_t playhead_pos, float gain){
+    constexpr auto blockSize = ADPCMChannel::samplesPerBlock;
+    const auto nsamples = asset->GetNumSamples();
+    const auto nchannels = asset->GetNChanels();
+    
+    // the asset may have been swapped with SetAudio since the last quantum
+    if (decodedAsset != asset.get()){
+        decodedAsset = asset.get();
+        decodedBlockIndex = std::numeric_limits<uint32_t>::max();
+        decodedBlock.resize(size_t(blockSize) * nchannels);
+    }
+    
+    size_t i = 0;
+    const auto outSize = buffer.sizeOneChannel();
+    while (i < outSize){
+        if (playhead_pos >= nsamples){
+            if (loops){
+                playhead_pos = 0;
+            }
+            else{
+                // past the end, fill the rest with silence
+                for(uint8_t c = 0; c < nchannels; c++){
+                    std::fill(buffer[c].begin() + i, buffer[c].end(), 0.f);
+                }
+                isPlaying = false;
+                break;
+            }
+        }
+        
+        const auto block = uint32_t(playhead_pos / blockSize);
+        if (block != decodedBlockIndex){
+            for(uint8_t c = 0; c < nchannels; c++){
+                asset->compressed[c].DecodeBlock(block, std::span<float, blockSize>(decodedBlock.data() + size_t(c) * blockSize, blockSize));
+            }
+            decodedBlockIndex = block;
+        }
+        
+        // copy up to the end of the block, the end of the clip, or the end of the buffer, whichever is first
+        const auto offset = size_t(playhead_pos % blockSize);
+        const auto count = std::min({size_t(blockSize) - offset, size_t(nsamples - playhead_pos), outSize - i});
+        for(uint8_t c = 0; c < nchannels; c++){
+            AudioKernels::Scale(buffer[c].data() + i, decodedBlock.data() + size_t(c) * blockSize + offset, gain, count);
+        }
+        i += count;
+        playhead_pos += count;
+    }
 }
 #endif
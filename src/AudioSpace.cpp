@@ -1,469 +1,575 @@
-#if !RVE_SERVER
-
-#include "AudioSpace.hpp"
-#include "Entity.hpp"
-#include "AudioSource.hpp"
-#include "DataStructures.hpp"
-#include "Transform.hpp"
-#include "AudioPlayer.hpp"
-#include <phonon.h>
-#include "App.hpp"
-#include "Debug.hpp"
-#include "AudioMeshAsset.hpp"
-#include "Profile.hpp"
-
-#include "mathtypes.hpp"
-#include <glm/gtc/type_ptr.hpp>
-
-using namespace RavEngine;
-using namespace std;
-
-void RavEngine::SimpleAudioSpace::RoomData::RenderAudioSource(PlanarSampleBufferInlineView& buffer, PlanarSampleBufferInlineView& scratchBuffer, PlanarSampleBufferInlineView monoSourceData, const vector3& sourcePos, entity_t owningEntity, const matrix4& invListenerTransform)
-{
-    RVE_PROFILE_FN;
-    // get the binaural effect
-    auto& audioPlayer = GetApp()->GetAudioPlayer();
-    auto state = audioPlayer->GetSteamAudioState();
-
-    SteamAudioEffects effects;
-    auto it = steamAudioData.find(owningEntity.id);
-    if (it == steamAudioData.end()) {
-        IPLBinauralEffectSettings effectSettings{};
-        effectSettings.hrtf = state.hrtf;
-
-        auto settings = audioPlayer->GetSteamAudioSettings();
-
-        iplBinauralEffectCreate(state.context, &settings, &effectSettings, &effects.binauralEffect);
-
-        IPLDirectEffectSettings directEffectSettings{
-            .numChannels = AudioPlayer::GetNChannels(),
-        };
-        iplDirectEffectCreate(state.context, &settings, &directEffectSettings, &effects.directEffect);
-
-        steamAudioData.emplace(entity_id_t(owningEntity.id), effects);
-    }
-    else {
-        effects = it->second;
-    }
-    const auto nchannels = AudioPlayer::GetNChannels();
-
-    // render it
-    IPLfloat32* inputChannels[]{ monoSourceData.data() };
-    static_assert(std::size(inputChannels) == 1, "Input must be mono!");
-    IPLAudioBuffer inBuffer{
-        .numChannels = 1,
-        .numSamples = IPLint32(monoSourceData.GetNumSamples()),
-        .data = inputChannels,
-    };
-
-    Debug::Assert(buffer.GetNChannels() == 2, "Non-stereo output is not supported");
-
-    IPLfloat32* outputChannels[]{
-        buffer[0].data(),
-        buffer[1].data()
-    };
-    IPLAudioBuffer outputBuffer{
-        .numChannels = nchannels,
-        .numSamples = IPLint32(buffer.GetNumSamples()),
-        .data = outputChannels
-    };
-
-    auto sourcePosInListenerSpace = vector3(invListenerTransform * vector4(sourcePos,1));
-    auto normalizedPos = glm::normalize(sourcePosInListenerSpace);
-
-    IPLBinauralEffectParams params{
-        .direction = { normalizedPos.x,normalizedPos.y,normalizedPos.z },
-        .interpolation = IPL_HRTFINTERPOLATION_BILINEAR,
-        .spatialBlend = 1.0f,
-        .hrtf = GetApp()->GetAudioPlayer()->GetSteamAudioHRTF(),
-        .peakDelays = nullptr
-    };
-
-    auto result = iplBinauralEffectApply(effects.binauralEffect, &params, &inBuffer, &outputBuffer);
-
-    // do distance attenuation in-place
-    IPLDistanceAttenuationModel distanceAttenuationModel{
-       .type = IPL_DISTANCEATTENUATIONTYPE_DEFAULT
-    };
-    IPLDirectEffectParams directParams{
-        .flags = IPL_DIRECTEFFECTFLAGS_APPLYDISTANCEATTENUATION,
-        .distanceAttenuation = iplDistanceAttenuationCalculate(state.context,{sourcePosInListenerSpace.x,sourcePosInListenerSpace.y,sourcePosInListenerSpace.z},{0,0,0},&distanceAttenuationModel)
-    };
-   
-    result = iplDirectEffectApply(effects.directEffect, &directParams, &outputBuffer, &outputBuffer);
-
-    AudioGraphComposed::Render(buffer, scratchBuffer, nchannels); // process graph for spatialized audio
-
-}
-
-void RavEngine::SimpleAudioSpace::RoomData::DeleteAudioDataForEntity(entity_id_t entity)
-{
-    steamAudioData.if_contains(entity, [this](SteamAudioEffects& effects) {
-        DestroyEffects(effects);
-    });
-    steamAudioData.erase(entity);
-}
-
-RavEngine::SimpleAudioSpace::RoomData::RoomData() : workingBuffers(AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels()), accumulationBuffer{ AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels() }
-# if ENABLE_RINGBUFFERS
-, debugBuffer(AudioPlayer::GetNChannels())
-#endif
-{
-}
-RavEngine::SimpleAudioSpace::RoomData::~RoomData() {
-    for (auto& [entity, effects] : steamAudioData) {
-        DestroyEffects(effects);
-    }
-}
-
-
-# if ENABLE_RINGBUFFERS
-void RavEngine::SimpleAudioSpace::RoomData::OutputSampleData(const Filesystem::Path& path) const
-{
-    debugBuffer.DumpToFileNoProcessing(path);
-}
-
-#endif
-void RavEngine::SimpleAudioSpace::RoomData::DestroyEffects(SteamAudioEffects& effects)
-{
-    iplBinauralEffectRelease(&effects.binauralEffect);
-    iplDirectEffectRelease(&effects.directEffect);
-}
-
-RavEngine::GeometryAudioSpace::RoomData::RoomData() : workingBuffers(AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels()), accumulationBuffer{ AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels() }{
-    // load simulator
-    IPLSimulationSettings simulationSettings{
-        .flags = IPLSimulationFlags(IPL_SIMULATIONFLAGS_DIRECT | IPL_SIMULATIONFLAGS_PATHING),    // this enables occlusion/transmission simulation
-        .sceneType = IPL_SCENETYPE_DEFAULT,
-        .reflectionType = IPL_REFLECTIONEFFECTTYPE_CONVOLUTION, // disabled if flags does not include IPL_SIMULATIONFLAGS_REFLECTIONS
-        .maxNumRays = 4096,
-        .numDiffuseSamples = 32,
-        .maxDuration = 2.0f,
-        .maxOrder = 1,
-        .maxNumSources = 8,
-        .numThreads = 2,
-        .samplingRate = IPLint32(AudioPlayer::GetSamplesPerSec()),
-        .frameSize = AudioPlayer::GetBufferSize()
-    };
-    // see below for examples of how to initialize the remaining fields of this structure
-
-    auto context = GetApp()->GetAudioPlayer()->GetSteamAudioContext();
-
-    auto errorCode = iplSimulatorCreate(context, &simulationSettings, &steamAudioSimulator);
-    if (errorCode) {
-        Debug::Fatal("Cannot create Steam Audio Simulator: {}", int(errorCode));
-    }
-
-
-    IPLSceneSettings sceneSettings{
-        .type = IPL_SCENETYPE_DEFAULT
-    };
-    iplSceneCreate(context, &sceneSettings, &rootScene);
-
-    iplSimulatorSetScene(steamAudioSimulator, rootScene);
-
-}
-
-RavEngine::GeometryAudioSpace::RoomData::~RoomData()
-{
-    for (auto& [entity, sourceData] : steamAudioSourceData) {
-        DestroySteamAudioSourceConfig(sourceData);
-    }
-    for (auto& [entity, meshData] : steamAudioMeshData) {
-        DestroySteamAudioMeshConfig(meshData);
-    }
-
-    iplSimulatorRelease(&steamAudioSimulator);
-    iplSceneRelease(&rootScene);
-}
-
-constexpr static auto geometrySpaceSimulationFlags = IPLSimulationFlags(IPL_SIMULATIONFLAGS_DIRECT | IPL_SIMULATIONFLAGS_REFLECTIONS | IPL_SIMULATIONFLAGS_PATHING); //TODO: make this configurable
-
-
-void RavEngine::GeometryAudioSpace::RoomData::ConsiderAudioSource(const vector3& sourcePos, entity_t owningEntity, const vector3& roomPos, const matrix4& invRoomTransform)
-{
-
-    // determine if in-radius or not
-    bool inRange = glm::distance2(sourcePos, roomPos) <= sourceRadius * sourceRadius;
-
-    // if not in-radius, but previously was in-radius, then destroy associated steam audio data 
-
-    SteamAudioSourceConfig sourceData;
-    auto it = steamAudioSourceData.find(owningEntity.id);
-    if (it == steamAudioSourceData.end()) {
-
-        // out of range, and wasn't in range before. Skip
-        if (!inRange) {
-            return;
-        }
-
-        IPLSourceSettings sourceSettings{
-            .flags = geometrySpaceSimulationFlags
-        };
-
-
-        iplSourceCreate(steamAudioSimulator, &sourceSettings, &sourceData.source);
-        iplSourceAdd(sourceData.source, steamAudioSimulator);
-
-        auto& audioPlayer = GetApp()->GetAudioPlayer();
-        auto state = audioPlayer->GetSteamAudioState();
-        auto settings = audioPlayer->GetSteamAudioSettings();
-
-        // create effects
-        IPLDirectEffectSettings directEffectSettings{
-           .numChannels = AudioPlayer::GetNChannels(),
-        };
-        iplDirectEffectCreate(state.context, &settings, &directEffectSettings, &sourceData.directEffect);
-
-        IPLPathEffectSettings pathEffectSettings{
-            .maxOrder = 1,  //TODO: is this a good number? we should make this configurable
-            .spatialize = IPL_TRUE,
-            .speakerLayout = {
-                .type = IPL_SPEAKERLAYOUTTYPE_STEREO,   // other values are optional if type != IPL_SPEAKERLAYOUTTYPE_CUSTOM
-            },
-            .hrtf = state.hrtf
-        };
-
-        iplPathEffectCreate(state.context, &settings, &pathEffectSettings, &sourceData.pathEffect);
-
-        IPLBinauralEffectSettings effectSettings{
-            .hrtf = state.hrtf
-        };
-
-        iplBinauralEffectCreate(state.context, &settings, &effectSettings, &sourceData.binauralEffect);
-
-
-        it = steamAudioSourceData.emplace(entity_id_t(owningEntity.id), sourceData).first;
-    }
-    else {
-        if (!inRange) {
-            // destroy data and bail
-            iplSourceRemove(sourceData.source,steamAudioSimulator);
-            DestroySteamAudioSourceConfig(sourceData);
-            steamAudioSourceData.erase(owningEntity.id);
-            return;
-        }
-        else {
-            sourceData = it->second;
-        }
-    }
-   
-    // set source config
-    // all positions are in room space
-
-    auto sourceInRoomSpace = invRoomTransform * vector4(sourcePos,1);
-
-    it->second.roomSpacePos = sourceInRoomSpace;
-
-    IPLSimulationInputs inputs{
-        .flags = geometrySpaceSimulationFlags,
-        .directFlags = IPLDirectSimulationFlags(IPL_DIRECTSIMULATIONFLAGS_OCCLUSION | IPL_DIRECTSIMULATIONFLAGS_TRANSMISSION),
-        .source = {sourceInRoomSpace.x, sourceInRoomSpace.y, sourceInRoomSpace.z},
-        .distanceAttenuationModel = IPL_DISTANCEATTENUATIONTYPE_DEFAULT,
-        .airAbsorptionModel = IPL_AIRABSORPTIONTYPE_DEFAULT,
-        .directivity = {        //TODO: allow setting these on audio sources
-            .dipoleWeight = 0,  // purely omni
-            .dipolePower = 1,   // direction sharpness
-            .callback = nullptr,
-            .userData = nullptr,
-        },
-        .occlusionType = IPL_OCCLUSIONTYPE_RAYCAST,
-        .occlusionRadius = 1,   //TODO: what effect does this have? (ignored if occlusion type is not volumetric)
-        .numOcclusionSamples = 0,   // ignored if occlusion type is not volumetric
-        .reverbScale = {1,1,1},
-        .hybridReverbTransitionTime = 1,    //TODO what's a good number for this?
-        .hybridReverbOverlapPercent = 0.25, //TODO: what's a good number for this?
-        .baked = IPL_FALSE,
-        .bakedDataIdentifier = {},  // unused if not baked
-        .pathingProbes = nullptr,
-        .visRadius = 1, // TODO: what's a good number for this?
-        .visThreshold = 0.75,
-        .visRange = sourceRadius * 2,   // diameter of the room
-        .pathingOrder = 1,
-        .enableValidation = IPL_TRUE,
-        .findAlternatePaths = IPL_FALSE,    //TODO: is there overhead to using this?
-        .numTransmissionRays = 4
-    };
-    iplSourceSetInputs(sourceData.source, geometrySpaceSimulationFlags, &inputs);
-    
-}
-
-void RavEngine::GeometryAudioSpace::RoomData::CalculateRoom(const matrix4& invRoomTransform, const vector3& listenerForwardWorldSpace, const vector3& listenerUpWorldSpace, const vector3& listenerRightWorldSpace)
-{
-    RVE_PROFILE_FN;
-    iplSimulatorCommit(steamAudioSimulator);        // apply all queued changes
-
-    const auto forwardRoomSpace = invRoomTransform * vector4(listenerForwardWorldSpace, 1);
-    const auto upRoomSpace = invRoomTransform * vector4(listenerUpWorldSpace, 1);
-    const auto rightRoomSpace = invRoomTransform * vector4(listenerRightWorldSpace, 1);
-
-    IPLSimulationSharedInputs sharedInputs{
-        .listener = {
-            .right = {rightRoomSpace.x, rightRoomSpace.y, rightRoomSpace.z},
-            .up = {upRoomSpace.x, upRoomSpace.y, upRoomSpace.z},
-            .ahead = {forwardRoomSpace.x, forwardRoomSpace.y, forwardRoomSpace.z},
-            .origin = {0,0,0}
-         },
-        .numRays = 32,      // TODO: make these configurable
-        .numBounces = 3,
-        .duration = 1,
-        .order = 1,
-        .irradianceMinDistance = 0.01,
-        .pathingVisCallback = nullptr,
-        .pathingUserData = nullptr,
-    };
-    iplSimulatorSetSharedInputs(steamAudioSimulator, geometrySpaceSimulationFlags, &sharedInputs);
-
-    //TODO: make this configurable
-    iplSimulatorRunDirect(steamAudioSimulator);
-    //iplSimulatorRunPathing(steamAudioSimulator);          // TODO: need to setup probes (https://valvesoftware.github.io/steam-audio/doc/capi/guide.html#static-geometry) before using this
-    //iplSimulatorRunReflections(steamAudioSimulator);
-}
-
-void RavEngine::GeometryAudioSpace::RoomData::ConsiderMesh(Ref<AudioMeshAsset> mesh, const matrix4& transform, const vector3& roomPos, const matrix4& invRoomTransform, entity_t ownerID)
-{
-    const auto meshPos = transform * vector4(0,0,0,1);
-
-    // is it inside the bounds?
-    bool inRange = glm::distance(vector3(meshPos), roomPos) <= mesh->GetRadius() + meshRadius;
-
-    SteamAudioMeshConfig meshConfig;
-    auto it = steamAudioMeshData.find(ownerID.id);
-    if (it == steamAudioMeshData.end()) {
-        // not in range, and wasn't in range before? bail
-        if (!inRange) {
-            return;
-        }
-
-        auto transformInRoomSpace = glm::transpose(invRoomTransform * transform);   // col-major to row-major
-
-        static_assert(sizeof(transformInRoomSpace) == sizeof(float) * 4 * 4, "transform is not a 4x4 float matrix!");
-
-        // create mesh data
-        IPLInstancedMeshSettings meshSettings{
-            .subScene = mesh->GetScene(),
-        };
-        memcpy(meshSettings.transform.elements, glm::value_ptr(transformInRoomSpace), sizeof(transformInRoomSpace));
-
-        iplInstancedMeshCreate(rootScene, &meshSettings, &meshConfig.instancedMesh);
-        steamAudioMeshData.emplace(entity_id_t(ownerID.id), meshConfig);
-    }
-    else {
-        if (!inRange) {
-            // was in range but no longer is. Destroy its data
-            DestroySteamAudioMeshConfig(it->second);
-            steamAudioMeshData.erase(entity_id_t(ownerID.id));
-            return;
-        }
-
-        meshConfig = it->second;
-    }
-
-    // set mesh data
-    const auto posInRoomSpace = invRoomTransform * meshPos;
-    const auto rotInRoomSpace = glm::quat_cast(invRoomTransform * transform);
-    if (meshConfig.lastPos != vector3(posInRoomSpace) || meshConfig.lastRot != rotInRoomSpace) {
-        meshConfig.lastPos = posInRoomSpace;
-        meshConfig.lastRot = rotInRoomSpace;
-
-        auto transformInRoomSpace = glm::transpose(invRoomTransform * transform);   // col-major to row-major
-
-        IPLMatrix4x4 transform;
-        memcpy(transform.elements, glm::value_ptr(transformInRoomSpace), sizeof(transformInRoomSpace));
-
-        iplInstancedMeshUpdateTransform(meshConfig.instancedMesh, rootScene, transform);
-    }
-}
-
-void RavEngine::GeometryAudioSpace::RoomData::RenderAudioSource(PlanarSampleBufferInlineView& outBuffer, PlanarSampleBufferInlineView& scratchBuffer, entity_t sourceOwningEntity, PlanarSampleBufferInlineView monoSourceData, const matrix4& invListenerTransform)
-{
-    auto it = steamAudioSourceData.find(sourceOwningEntity.id);
-    if (it == steamAudioSourceData.end()) {
-        // something invalid has happend!
-        Debug::Fatal("Attempting to render source that was not calculated in CalculateRoom()");
-    }
-    else {
-        auto& effects = it->second;
-
-        IPLSimulationOutputs outputs{};
-
-        auto& sourceData = it->second;
-        iplSourceGetOutputs(sourceData.source, IPLSimulationFlags(IPL_SIMULATIONFLAGS_DIRECT | IPL_SIMULATIONFLAGS_PATHING | IPL_SIMULATIONFLAGS_REFLECTIONS), &outputs);
-
-        IPLfloat32* inputChannels[]{ monoSourceData.data() };
-        static_assert(std::size(inputChannels) == 1, "Input must be mono!");
-        IPLAudioBuffer inBuffer{
-            .numChannels = 1,
-            .numSamples = IPLint32(monoSourceData.GetNumSamples()),
-            .data = inputChannels,
-        };
-
-        const auto nchannels = outBuffer.GetNChannels();
-        Debug::Assert(outBuffer.GetNChannels() == 2, "Non-stereo output is not supported");
-
-        IPLfloat32* outputChannels[]{
-            outBuffer[0].data(),
-            outBuffer[1].data()
-        };
-        IPLAudioBuffer outputBuffer{
-            .numChannels = nchannels,
-            .numSamples = IPLint32(outBuffer.GetNumSamples()),
-            .data = outputChannels
-        };
-
-        //iplPathEffectApply(effects.pathEffect, &outputs.pathing, &inBuffer, &outputBuffer); 
-
-        auto listenerSpaceDir = glm::normalize(invListenerTransform * vector4(sourceData.roomSpacePos,1));
-        
-        //TODO: replace this with a pathing effect
-        IPLBinauralEffectParams params{
-              .direction = { listenerSpaceDir.x,listenerSpaceDir.y,listenerSpaceDir.z },
-              .interpolation = IPL_HRTFINTERPOLATION_BILINEAR,
-              .spatialBlend = 1.0f,
-              .hrtf = GetApp()->GetAudioPlayer()->GetSteamAudioHRTF(),
-              .peakDelays = nullptr
-        };
-
-        auto result = iplBinauralEffectApply(effects.binauralEffect, &params, &inBuffer, &outputBuffer);
-        
-        iplDirectEffectApply(effects.directEffect, &outputs.direct, &outputBuffer, &outputBuffer);
-
-        AudioGraphComposed::Render(outBuffer, scratchBuffer, nchannels); // process graph for spatialized audio
-    }
-    
-}
-
-void RavEngine::GeometryAudioSpace::RoomData::DeleteAudioDataForEntity(entity_id_t entity) {
-    steamAudioSourceData.if_contains(entity, [this](SteamAudioSourceConfig& effects) {
-        DestroySteamAudioSourceConfig(effects);
-    });
-    steamAudioSourceData.erase(entity);
-}
-
-void RavEngine::GeometryAudioSpace::RoomData::DeleteMeshDataForEntity(entity_id_t entity)
-{
-    steamAudioMeshData.if_contains(entity, [this](SteamAudioMeshConfig& effects) {
-        DestroySteamAudioMeshConfig(effects);
-    });
-    steamAudioMeshData.erase(entity);
-}
-
-void RavEngine::GeometryAudioSpace::RoomData::DestroySteamAudioSourceConfig(SteamAudioSourceConfig& effects)
-{
-    iplBinauralEffectRelease(&effects.binauralEffect);
-    iplDirectEffectRelease(&effects.directEffect);
-    iplPathEffectRelease(&effects.pathEffect);
-    iplSourceRelease(&effects.source);
-}
-
-void RavEngine::GeometryAudioSpace::RoomData::DestroySteamAudioMeshConfig(SteamAudioMeshConfig& config)
-{
-    iplInstancedMeshRelease(&config.instancedMesh);
-}
-
-//void RavEngine::AudioRoom::DebugDraw(RavEngine::DebugDrawer& dbg, const RavEngine::Transform& tr) const
-//{
-//	dbg.DrawRectangularPrism(tr.CalculateWorldMatrix(), debug_color, data->roomDimensions);
-//}
-#endif
-
+#if !RVE_SERVER
+
+#include "AudioSpace.hpp"
+#include "Entity.hpp"
+#include "AudioSource.hpp"
+#include "DataStructures.hpp"
+#include "Transform.hpp"
+#include "AudioPlayer.hpp"
+#include <phonon.h>
+#include "App.hpp"
+#include "Debug.hpp"
+#include "AudioMeshAsset.hpp"
+#include "Profile.hpp"
+
+#include "mathtypes.hpp"
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace RavEngine;
+using namespace std;
+
+void RavEngine::SimpleAudioSpace::RoomData::RenderAudioSource(PlanarSampleBufferInlineView& buffer, PlanarSampleBufferInlineView& scratchBuffer, PlanarSampleBufferInlineView monoSourceData, const vector3& sourcePos, entity_t owningEntity, const matrix4& invListenerTransform)
+{
+    RVE_PROFILE_FN;
+    // get the binaural effect
+    auto& audioPlayer = GetApp()->GetAudioPlayer();
+    auto state = audioPlayer->GetSteamAudioState();
+
+    // sources in the same space render in parallel, so the effects are copied out under the map's lock
+    SteamAudioEffects effects;
+    const bool found = steamAudioData.if_contains(owningEntity.id, [&effects](const SteamAudioEffects& existing) {
+        effects = existing;
+    });
+    if (!found) {
+        IPLBinauralEffectSettings effectSettings{};
+        effectSettings.hrtf = state.hrtf;
+
+        auto settings = audioPlayer->GetSteamAudioSettings();
+
+        iplBinauralEffectCreate(state.context, &settings, &effectSettings, &effects.binauralEffect);
+
+        IPLDirectEffectSettings directEffectSettings{
+            .numChannels = AudioPlayer::GetNChannels(),
+        };
+        iplDirectEffectCreate(state.context, &settings, &directEffectSettings, &effects.directEffect);
+
+        steamAudioData.emplace(entity_id_t(owningEntity.id), effects);
+    }
+    const auto nchannels = AudioPlayer::GetNChannels();
+
+    // render it
+    IPLfloat32* inputChannels[]{ monoSourceData.data() };
+    static_assert(std::size(inputChannels) == 1, "Input must be mono!");
+    IPLAudioBuffer inBuffer{
+        .numChannels = 1,
+        .numSamples = IPLint32(monoSourceData.GetNumSamples()),
+        .data = inputChannels,
+    };
+
+    Debug::Assert(buffer.GetNChannels() == 2, "Non-stereo output is not supported");
+
+    IPLfloat32* outputChannels[]{
+        buffer[0].data(),
+        buffer[1].data()
+    };
+    IPLAudioBuffer outputBuffer{
+        .numChannels = nchannels,
+        .numSamples = IPLint32(buffer.GetNumSamples()),
+        .data = outputChannels
+    };
+
+    auto sourcePosInListenerSpace = vector3(invListenerTransform * vector4(sourcePos,1));
+    auto normalizedPos = glm::normalize(sourcePosInListenerSpace);
+
+    IPLBinauralEffectParams params{
+        .direction = { normalizedPos.x,normalizedPos.y,normalizedPos.z },
+        .interpolation = IPL_HRTFINTERPOLATION_BILINEAR,
+        .spatialBlend = 1.0f,
+        .hrtf = GetApp()->GetAudioPlayer()->GetSteamAudioHRTF(),
+        .peakDelays = nullptr
+    };
+
+    auto result = iplBinauralEffectApply(effects.binauralEffect, &params, &inBuffer, &outputBuffer);
+
+    // do distance attenuation in-place
+    IPLDistanceAttenuationModel distanceAttenuationModel{
+       .type = IPL_DISTANCEATTENUATIONTYPE_DEFAULT
+    };
+    IPLDirectEffectParams directParams{
+        .flags = IPL_DIRECTEFFECTFLAGS_APPLYDISTANCEATTENUATION,
+        .distanceAttenuation = iplDistanceAttenuationCalculate(state.context,{sourcePosInListenerSpace.x,sourcePosInListenerSpace.y,sourcePosInListenerSpace.z},{0,0,0},&distanceAttenuationModel)
+    };
+   
+    result = iplDirectEffectApply(effects.directEffect, &directParams, &outputBuffer, &outputBuffer);
+
+    AudioGraphComposed::Render(buffer, scratchBuffer, nchannels); // process graph for spatialized audio
+
+}
+
+void RavEngine::SimpleAudioSpace::RoomData::DeleteAudioDataForEntity(entity_id_t entity)
+{
+    steamAudioData.if_contains(entity, [this](SteamAudioEffects& effects) {
+        DestroyEffects(effects);
+    });
+    steamAudioData.erase(entity);
+}
+
+RavEngine::SimpleAudioSpace::RoomData::RoomData() : workingBuffers(AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels()), accumulationBuffer{ AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels() }
+# if ENABLE_RINGBUFFERS
+, debugBuffer(AudioPlayer::GetNChannels())
+#endif
+{
+}
+RavEngine::SimpleAudioSpace::RoomData::~RoomData() {
+    for (auto& [entity, effects] : steamAudioData) {
+        DestroyEffects(effects);
+    }
+}
+
+
+# if ENABLE_RINGBUFFERS
+void RavEngine::SimpleAudioSpace::RoomData::OutputSampleData(const Filesystem::Path& path) const
+{
+    debugBuffer.DumpToFileNoProcessing(path);
+}
+
+#endif
+void RavEngine::SimpleAudioSpace::RoomData::DestroyEffects(SteamAudioEffects& effects)
+{
+    iplBinauralEffectRelease(&effects.binauralEffect);
+    iplDirectEffectRelease(&effects.directEffect);
+}
+
+// the last published results of simulating one source, shared by the audio thread and the simulation thread
+struct RavEngine::GeometryAudioSpace::RoomData::SimulationResults {
+    IPLSource source = nullptr;     // retained, so the simulation thread can read it after the audio thread drops the source
+    SpinLock mtx;
+    IPLDirectEffectParams direct{};
+    bool valid = false;
+
+    SimulationResults(IPLSource source) : source(iplSourceRetain(source)) {}
+    ~SimulationResults() {
+        iplSourceRelease(&source);
+    }
+};
+
+RavEngine::GeometryAudioSpace::GeometryAudioSpace(Entity owner) : ComponentWithOwner(owner), data(std::make_shared<RoomData>()) {
+    GetApp()->GetAudioPlayer()->AddSimulatedSpace(data);
+}
+
+RavEngine::GeometryAudioSpace::RoomData::RoomData() : workingBuffers(AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels()), accumulationBuffer{ AudioPlayer::GetBufferSize(), AudioPlayer::GetNChannels() }{
+    // load simulator
+    IPLSimulationSettings simulationSettings{
+        .flags = IPLSimulationFlags(IPL_SIMULATIONFLAGS_DIRECT | IPL_SIMULATIONFLAGS_PATHING),    // this enables occlusion/transmission simulation
+        .sceneType = IPL_SCENETYPE_DEFAULT,
+        .reflectionType = IPL_REFLECTIONEFFECTTYPE_CONVOLUTION, // disabled if flags does not include IPL_SIMULATIONFLAGS_REFLECTIONS
+        .maxNumRays = 4096,
+        .numDiffuseSamples = 32,
+        .maxDuration = 2.0f,
+        .maxOrder = 1,
+        .maxNumSources = 8,
+        .numThreads = 2,
+        .samplingRate = IPLint32(AudioPlayer::GetSamplesPerSec()),
+        .frameSize = AudioPlayer::GetBufferSize()
+    };
+    // see below for examples of how to initialize the remaining fields of this structure
+
+    auto context = GetApp()->GetAudioPlayer()->GetSteamAudioContext();
+
+    auto errorCode = iplSimulatorCreate(context, &simulationSettings, &steamAudioSimulator);
+    if (errorCode) {
+        Debug::Fatal("Cannot create Steam Audio Simulator: {}", int(errorCode));
+    }
+
+
+    IPLSceneSettings sceneSettings{
+        .type = IPL_SCENETYPE_DEFAULT
+    };
+    iplSceneCreate(context, &sceneSettings, &rootScene);
+
+    iplSimulatorSetScene(steamAudioSimulator, rootScene);
+
+}
+
+RavEngine::GeometryAudioSpace::RoomData::~RoomData()
+{
+    for (auto& [entity, sourceData] : steamAudioSourceData) {
+        DestroySteamAudioSourceConfig(sourceData);
+    }
+    for (auto& [entity, meshData] : steamAudioMeshData) {
+        DestroySteamAudioMeshConfig(meshData);
+    }
+    for (auto source : removedSources) {
+        iplSourceRelease(&source);
+    }
+    for (auto mesh : removedMeshes) {
+        iplInstancedMeshRelease(&mesh);
+    }
+    simulatedSources.clear();
+
+    iplSimulatorRelease(&steamAudioSimulator);
+    iplSceneRelease(&rootScene);
+}
+
+constexpr static auto geometrySpaceSimulationFlags = IPLSimulationFlags(IPL_SIMULATIONFLAGS_DIRECT | IPL_SIMULATIONFLAGS_REFLECTIONS | IPL_SIMULATIONFLAGS_PATHING); //TODO: make this configurable
+
+
+void RavEngine::GeometryAudioSpace::RoomData::ConsiderAudioSource(const vector3& sourcePos, entity_t owningEntity, const vector3& roomPos, const matrix4& invRoomTransform)
+{
+
+    // determine if in-radius or not
+    bool inRange = glm::distance2(sourcePos, roomPos) <= sourceRadius * sourceRadius;
+
+    // if not in-radius, but previously was in-radius, then destroy associated steam audio data 
+
+    auto it = steamAudioSourceData.find(owningEntity.id);
+    if (it == steamAudioSourceData.end()) {
+
+        // out of range, and wasn't in range before. Skip
+        if (!inRange) {
+            return;
+        }
+
+        SteamAudioSourceConfig sourceData;
+
+        IPLSourceSettings sourceSettings{
+            .flags = geometrySpaceSimulationFlags
+        };
+
+
+        // added to the simulator at the next commit
+        iplSourceCreate(steamAudioSimulator, &sourceSettings, &sourceData.source);
+        sourceData.results = std::make_shared<SimulationResults>(sourceData.source);
+
+        auto& audioPlayer = GetApp()->GetAudioPlayer();
+        auto state = audioPlayer->GetSteamAudioState();
+        auto settings = audioPlayer->GetSteamAudioSettings();
+
+        // create effects
+        IPLDirectEffectSettings directEffectSettings{
+           .numChannels = AudioPlayer::GetNChannels(),
+        };
+        iplDirectEffectCreate(state.context, &settings, &directEffectSettings, &sourceData.directEffect);
+
+        IPLPathEffectSettings pathEffectSettings{
+            .maxOrder = 1,  //TODO: is this a good number? we should make this configurable
+            .spatialize = IPL_TRUE,
+            .speakerLayout = {
+                .type = IPL_SPEAKERLAYOUTTYPE_STEREO,   // other values are optional if type != IPL_SPEAKERLAYOUTTYPE_CUSTOM
+            },
+            .hrtf = state.hrtf
+        };
+
+        iplPathEffectCreate(state.context, &settings, &pathEffectSettings, &sourceData.pathEffect);
+
+        IPLBinauralEffectSettings effectSettings{
+            .hrtf = state.hrtf
+        };
+
+        iplBinauralEffectCreate(state.context, &settings, &effectSettings, &sourceData.binauralEffect);
+
+
+        it = steamAudioSourceData.emplace(entity_id_t(owningEntity.id), sourceData).first;
+        sourcesChanged = true;
+    }
+    else if (!inRange) {
+        // destroy data and bail
+        DestroySteamAudioSourceConfig(it->second);
+        steamAudioSourceData.erase(owningEntity.id);
+        return;
+    }
+   
+    // all positions are in room space. The simulator receives it at the next commit.
+    it->second.roomSpacePos = invRoomTransform * vector4(sourcePos,1);
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::SetSourceInputs(const SteamAudioSourceConfig& sourceData)
+{
+    const auto& sourceInRoomSpace = sourceData.roomSpacePos;
+    IPLSimulationInputs inputs{
+        .flags = geometrySpaceSimulationFlags,
+        .directFlags = IPLDirectSimulationFlags(IPL_DIRECTSIMULATIONFLAGS_OCCLUSION | IPL_DIRECTSIMULATIONFLAGS_TRANSMISSION),
+        .source = {sourceInRoomSpace.x, sourceInRoomSpace.y, sourceInRoomSpace.z},
+        .distanceAttenuationModel = IPL_DISTANCEATTENUATIONTYPE_DEFAULT,
+        .airAbsorptionModel = IPL_AIRABSORPTIONTYPE_DEFAULT,
+        .directivity = {        //TODO: allow setting these on audio sources
+            .dipoleWeight = 0,  // purely omni
+            .dipolePower = 1,   // direction sharpness
+            .callback = nullptr,
+            .userData = nullptr,
+        },
+        .occlusionType = IPL_OCCLUSIONTYPE_RAYCAST,
+        .occlusionRadius = 1,   //TODO: what effect does this have? (ignored if occlusion type is not volumetric)
+        .numOcclusionSamples = 0,   // ignored if occlusion type is not volumetric
+        .reverbScale = {1,1,1},
+        .hybridReverbTransitionTime = 1,    //TODO what's a good number for this?
+        .hybridReverbOverlapPercent = 0.25, //TODO: what's a good number for this?
+        .baked = IPL_FALSE,
+        .bakedDataIdentifier = {},  // unused if not baked
+        .pathingProbes = nullptr,
+        .visRadius = 1, // TODO: what's a good number for this?
+        .visThreshold = 0.75,
+        .visRange = sourceRadius * 2,   // diameter of the room
+        .pathingOrder = 1,
+        .enableValidation = IPL_TRUE,
+        .findAlternatePaths = IPL_FALSE,    //TODO: is there overhead to using this?
+        .numTransmissionRays = 4
+    };
+    iplSourceSetInputs(sourceData.source, geometrySpaceSimulationFlags, &inputs);
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::CalculateRoom(const matrix4& invRoomTransform, const vector3& listenerForwardWorldSpace, const vector3& listenerUpWorldSpace, const vector3& listenerRightWorldSpace)
+{
+    RVE_PROFILE_FN;
+    // the simulator cannot change while it runs. Rather than wait for the simulation thread, apply the changes next quantum.
+    std::unique_lock lock(simulationMtx, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+
+    // apply the mesh changes to the scene
+    for (auto mesh : removedMeshes) {
+        iplInstancedMeshRemove(mesh, rootScene);
+        iplInstancedMeshRelease(&mesh);
+    }
+    bool sceneChanged = !removedMeshes.empty();
+    removedMeshes.clear();
+    for (auto& [entity, meshConfig] : steamAudioMeshData) {
+        if (!meshConfig.added) {
+            iplInstancedMeshAdd(meshConfig.instancedMesh, rootScene);
+            meshConfig.added = true;
+            sceneChanged = true;
+        }
+        if (meshConfig.transformDirty) {
+            const auto transformInRoomSpace = glm::transpose(meshConfig.transformInRoomSpace);   // col-major to row-major
+            static_assert(sizeof(transformInRoomSpace) == sizeof(float) * 4 * 4, "transform is not a 4x4 float matrix!");
+            IPLMatrix4x4 transform;
+            memcpy(transform.elements, glm::value_ptr(transformInRoomSpace), sizeof(transformInRoomSpace));
+            iplInstancedMeshUpdateTransform(meshConfig.instancedMesh, rootScene, transform);
+            meshConfig.transformDirty = false;
+            sceneChanged = true;
+        }
+    }
+    if (sceneChanged) {
+        iplSceneCommit(rootScene);
+    }
+
+    // apply the source changes to the simulator
+    for (auto source : removedSources) {
+        iplSourceRemove(source, steamAudioSimulator);
+        iplSourceRelease(&source);
+    }
+    sourcesChanged = sourcesChanged || !removedSources.empty();
+    removedSources.clear();
+    if (sourcesChanged) {
+        simulatedSources.clear();
+    }
+    for (auto& [entity, sourceData] : steamAudioSourceData) {
+        if (sourcesChanged) {
+            if (!sourceData.added) {
+                iplSourceAdd(sourceData.source, steamAudioSimulator);
+                sourceData.added = true;
+            }
+            simulatedSources.push_back(sourceData.results);
+        }
+        SetSourceInputs(sourceData);
+    }
+    sourcesChanged = false;
+
+    iplSimulatorCommit(steamAudioSimulator);        // apply all queued changes
+
+    const auto forwardRoomSpace = invRoomTransform * vector4(listenerForwardWorldSpace, 1);
+    const auto upRoomSpace = invRoomTransform * vector4(listenerUpWorldSpace, 1);
+    const auto rightRoomSpace = invRoomTransform * vector4(listenerRightWorldSpace, 1);
+
+    IPLSimulationSharedInputs sharedInputs{
+        .listener = {
+            .right = {rightRoomSpace.x, rightRoomSpace.y, rightRoomSpace.z},
+            .up = {upRoomSpace.x, upRoomSpace.y, upRoomSpace.z},
+            .ahead = {forwardRoomSpace.x, forwardRoomSpace.y, forwardRoomSpace.z},
+            .origin = {0,0,0}
+         },
+        .numRays = 32,      // TODO: make these configurable
+        .numBounces = 3,
+        .duration = 1,
+        .order = 1,
+        .irradianceMinDistance = 0.01,
+        .pathingVisCallback = nullptr,
+        .pathingUserData = nullptr,
+    };
+    iplSimulatorSetSharedInputs(steamAudioSimulator, geometrySpaceSimulationFlags, &sharedInputs);
+    committed = true;
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::Simulate()
+{
+    RVE_PROFILE_FN;
+    std::lock_guard lock(simulationMtx);
+    if (!committed) {
+        return;
+    }
+
+    //TODO: make this configurable
+    iplSimulatorRunDirect(steamAudioSimulator);
+    //iplSimulatorRunPathing(steamAudioSimulator);          // TODO: need to setup probes (https://valvesoftware.github.io/steam-audio/doc/capi/guide.html#static-geometry) before using this
+    //iplSimulatorRunReflections(steamAudioSimulator);
+
+    // publish, so rendering reads a complete set of parameters while the next simulation runs
+    for (const auto& results : simulatedSources) {
+        IPLSimulationOutputs outputs{};
+        iplSourceGetOutputs(results->source, IPL_SIMULATIONFLAGS_DIRECT, &outputs);
+        std::lock_guard resultsLock(results->mtx);
+        results->direct = outputs.direct;
+        results->valid = true;
+    }
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::ConsiderMesh(Ref<AudioMeshAsset> mesh, const matrix4& transform, const vector3& roomPos, const matrix4& invRoomTransform, entity_t ownerID, bool roomMoved)
+{
+    auto it = steamAudioMeshData.find(ownerID.id);
+
+    // a mesh that has not moved, in a room that has not moved, is already instanced where it should be
+    if (it != steamAudioMeshData.end() && !roomMoved && it->second.lastWorldTransform == transform) {
+        return;
+    }
+
+    const auto meshPos = transform * vector4(0,0,0,1);
+
+    // is it inside the bounds?
+    bool inRange = glm::distance(vector3(meshPos), roomPos) <= mesh->GetRadius() + meshRadius;
+
+    if (it == steamAudioMeshData.end()) {
+        // not in range, and wasn't in range before? bail
+        if (!inRange) {
+            return;
+        }
+
+        // create mesh data, added to the scene at the next commit
+        SteamAudioMeshConfig meshConfig;
+        IPLInstancedMeshSettings meshSettings{
+            .subScene = mesh->GetScene(),
+        };
+        const auto transformInRoomSpace = glm::transpose(invRoomTransform * transform);   // col-major to row-major
+        memcpy(meshSettings.transform.elements, glm::value_ptr(transformInRoomSpace), sizeof(transformInRoomSpace));
+
+        meshConfig.lastWorldTransform = transform;
+        iplInstancedMeshCreate(rootScene, &meshSettings, &meshConfig.instancedMesh);
+        steamAudioMeshData.emplace(entity_id_t(ownerID.id), meshConfig);
+        return;
+    }
+    else if (!inRange) {
+        // was in range but no longer is. Destroy its data
+        DestroySteamAudioMeshConfig(it->second);
+        steamAudioMeshData.erase(entity_id_t(ownerID.id));
+        return;
+    }
+
+    // set mesh data, applied at the next commit
+    auto& meshConfig = it->second;
+    meshConfig.lastWorldTransform = transform;
+    meshConfig.transformInRoomSpace = invRoomTransform * transform;
+    meshConfig.transformDirty = true;
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::RenderAudioSource(PlanarSampleBufferInlineView& outBuffer, PlanarSampleBufferInlineView& scratchBuffer, entity_t sourceOwningEntity, PlanarSampleBufferInlineView monoSourceData, const matrix4& invListenerTransform)
+{
+    auto it = steamAudioSourceData.find(sourceOwningEntity.id);
+    if (it == steamAudioSourceData.end()) {
+        // something invalid has happend!
+        Debug::Fatal("Attempting to render source that was not calculated in CalculateRoom()");
+    }
+    else {
+        auto& effects = it->second;
+
+        auto& sourceData = it->second;
+        IPLDirectEffectParams direct;
+        bool simulated;
+        {
+            std::lock_guard lock(sourceData.results->mtx);
+            direct = sourceData.results->direct;
+            simulated = sourceData.results->valid;
+        }
+
+        IPLfloat32* inputChannels[]{ monoSourceData.data() };
+        static_assert(std::size(inputChannels) == 1, "Input must be mono!");
+        IPLAudioBuffer inBuffer{
+            .numChannels = 1,
+            .numSamples = IPLint32(monoSourceData.GetNumSamples()),
+            .data = inputChannels,
+        };
+
+        const auto nchannels = outBuffer.GetNChannels();
+        Debug::Assert(outBuffer.GetNChannels() == 2, "Non-stereo output is not supported");
+
+        IPLfloat32* outputChannels[]{
+            outBuffer[0].data(),
+            outBuffer[1].data()
+        };
+        IPLAudioBuffer outputBuffer{
+            .numChannels = nchannels,
+            .numSamples = IPLint32(outBuffer.GetNumSamples()),
+            .data = outputChannels
+        };
+
+        //iplPathEffectApply(effects.pathEffect, &outputs.pathing, &inBuffer, &outputBuffer); 
+
+        auto listenerSpaceDir = glm::normalize(invListenerTransform * vector4(sourceData.roomSpacePos,1));
+        
+        //TODO: replace this with a pathing effect
+        IPLBinauralEffectParams params{
+              .direction = { listenerSpaceDir.x,listenerSpaceDir.y,listenerSpaceDir.z },
+              .interpolation = IPL_HRTFINTERPOLATION_BILINEAR,
+              .spatialBlend = 1.0f,
+              .hrtf = GetApp()->GetAudioPlayer()->GetSteamAudioHRTF(),
+              .peakDelays = nullptr
+        };
+
+        auto result = iplBinauralEffectApply(effects.binauralEffect, &params, &inBuffer, &outputBuffer);
+        
+        // a source that has not been simulated yet plays unoccluded
+        if (simulated) {
+            iplDirectEffectApply(effects.directEffect, &direct, &outputBuffer, &outputBuffer);
+        }
+
+        AudioGraphComposed::Render(outBuffer, scratchBuffer, nchannels); // process graph for spatialized audio
+    }
+    
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::DeleteAudioDataForEntity(entity_id_t entity) {
+    steamAudioSourceData.if_contains(entity, [this](SteamAudioSourceConfig& effects) {
+        DestroySteamAudioSourceConfig(effects);
+    });
+    steamAudioSourceData.erase(entity);
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::DeleteMeshDataForEntity(entity_id_t entity)
+{
+    steamAudioMeshData.if_contains(entity, [this](SteamAudioMeshConfig& effects) {
+        DestroySteamAudioMeshConfig(effects);
+    });
+    steamAudioMeshData.erase(entity);
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::DestroySteamAudioSourceConfig(SteamAudioSourceConfig& effects)
+{
+    iplBinauralEffectRelease(&effects.binauralEffect);
+    iplDirectEffectRelease(&effects.directEffect);
+    iplPathEffectRelease(&effects.pathEffect);
+
+    // the simulator may be using the source, so it is removed at the next commit
+    if (effects.added) {
+        removedSources.push_back(effects.source);
+    }
+    else {
+        iplSourceRelease(&effects.source);
+    }
+    effects.results.reset();
+}
+
+void RavEngine::GeometryAudioSpace::RoomData::DestroySteamAudioMeshConfig(SteamAudioMeshConfig& config)
+{
+    if (config.added) {
+        removedMeshes.push_back(config.instancedMesh);
+    }
+    else {
+        iplInstancedMeshRelease(&config.instancedMesh);
+    }
+}
+
+//void RavEngine::AudioRoom::DebugDraw(RavEngine::DebugDrawer& dbg, const RavEngine::Transform& tr) const
+//{
+//	dbg.DrawRectangularPrism(tr.CalculateWorldMatrix(), debug_color, data->roomDimensions);
+//}
+#endif
+
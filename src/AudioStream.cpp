@@ -0,0 +1,352 @@
+#if !RVE_SERVER
+#if defined _M_ARM64 && _M_ARM64
+#define ARCH_CPU_LITTLE_ENDIAN 1
+#endif
+#include "AudioStream.hpp"
+#include "App.hpp"
+#include "AudioPlayer.hpp"
+#include "VirtualFileSystem.hpp"
+#include "Filesystem.hpp"
+#include "Debug.hpp"
+#include <libnyquist/Decoders.h>
+#include <r8bbase.h>
+#include <CDSPResampler.h>
+#include <dr_wav.h>
+#include <vorbis/vorbisfile.h>
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <algorithm>
+#include <span>
+#include <cctype>
+
+using namespace RavEngine;
+using namespace std;
+
+namespace {
+    constexpr uint32_t decodeChunkFrames = 4096;
+
+    // reads interleaved float frames from the start of a file, and can go back to the start
+    struct Decoder {
+        uint32_t sampleRate = 0;
+        uint8_t nchannels = 0;
+        double lengthSeconds = 0;
+
+        // @return the number of frames read, less than maxFrames only at the end of the file
+        virtual uint32_t Read(float* interleaved, uint32_t maxFrames) = 0;
+        virtual void Rewind() = 0;
+        virtual ~Decoder() {}
+    };
+
+    struct WavDecoder : public Decoder {
+        drwav wav;
+
+        WavDecoder(std::span<const uint8_t> file) {
+            if (!drwav_init_memory(&wav, file.data(), file.size(), nullptr)) {
+                Debug::Fatal("Could not read WAV data");
+            }
+            sampleRate = wav.sampleRate;
+            nchannels = uint8_t(wav.channels);
+            lengthSeconds = double(wav.totalPCMFrameCount) / wav.sampleRate;
+        }
+
+        uint32_t Read(float* interleaved, uint32_t maxFrames) final {
+            return uint32_t(drwav_read_pcm_frames_f32(&wav, maxFrames, interleaved));
+        }
+
+        void Rewind() final {
+            drwav_seek_to_pcm_frame(&wav, 0);
+        }
+
+        ~WavDecoder() {
+            drwav_uninit(&wav);
+        }
+    };
+
+    struct VorbisDecoder : public Decoder {
+        OggVorbis_File vf;
+        std::span<const uint8_t> file;
+        size_t cursor = 0;
+
+        static size_t ReadCallback(void* ptr, size_t size, size_t nmemb, void* source) {
+            auto self = static_cast<VorbisDecoder*>(source);
+            const auto n = std::min(size * nmemb, self->file.size() - self->cursor);
+            std::memcpy(ptr, self->file.data() + self->cursor, n);
+            self->cursor += n;
+            return size > 0 ? n / size : 0;
+        }
+
+        static int SeekCallback(void* source, ogg_int64_t offset, int whence) {
+            auto self = static_cast<VorbisDecoder*>(source);
+            int64_t base = whence == SEEK_SET ? 0 : whence == SEEK_CUR ? int64_t(self->cursor) : int64_t(self->file.size());
+            const auto pos = base + offset;
+            if (pos < 0 || pos > int64_t(self->file.size())) {
+                return -1;
+            }
+            self->cursor = size_t(pos);
+            return 0;
+        }
+
+        static long TellCallback(void* source) {
+            return long(static_cast<VorbisDecoder*>(source)->cursor);
+        }
+
+        VorbisDecoder(std::span<const uint8_t> file) : file(file) {
+            ov_callbacks callbacks{ &ReadCallback, &SeekCallback, nullptr, &TellCallback };
+            if (ov_open_callbacks(this, &vf, nullptr, 0, callbacks) != 0) {
+                Debug::Fatal("Could not read Ogg Vorbis data");
+            }
+            auto info = ov_info(&vf, -1);
+            sampleRate = uint32_t(info->rate);
+            nchannels = uint8_t(info->channels);
+            lengthSeconds = ov_time_total(&vf, -1);
+        }
+
+        uint32_t Read(float* interleaved, uint32_t maxFrames) final {
+            uint32_t total = 0;
+            while (total < maxFrames) {
+                float** planar = nullptr;
+                int bitstream = 0;
+                auto n = ov_read_float(&vf, &planar, int(maxFrames - total), &bitstream);
+                if (n <= 0) {
+                    break;
+                }
+                for (long i = 0; i < n; i++) {
+                    for (uint8_t c = 0; c < nchannels; c++) {
+                        interleaved[(total + i) * nchannels + c] = planar[c][i];
+                    }
+                }
+                total += uint32_t(n);
+            }
+            return total;
+        }
+
+        void Rewind() final {
+            ov_pcm_seek(&vf, 0);
+        }
+
+        ~VorbisDecoder() {
+            ov_clear(&vf);
+        }
+    };
+
+    // for formats that libnyquist can only decode whole
+    struct WholeFileDecoder : public Decoder {
+        nqr::AudioData data;
+        size_t cursor = 0;
+
+        WholeFileDecoder(const std::string& extension, const std::vector<uint8_t>& file) {
+            nqr::NyquistIO loader;
+            loader.Load(&data, extension, file);
+            sampleRate = data.sampleRate;
+            nchannels = uint8_t(data.channelCount);
+            lengthSeconds = data.lengthSeconds;
+        }
+
+        uint32_t Read(float* interleaved, uint32_t maxFrames) final {
+            const auto frames = std::min<size_t>(maxFrames, (data.samples.size() - cursor) / nchannels);
+            std::memcpy(interleaved, data.samples.data() + cursor, frames * nchannels * sizeof(float));
+            cursor += frames * nchannels;
+            return uint32_t(frames);
+        }
+
+        void Rewind() final {
+            cursor = 0;
+        }
+    };
+}
+
+struct StreamingAudioDataProvider::Stream {
+    std::vector<uint8_t> file;      // still compressed
+    std::string extension;
+    std::unique_ptr<Decoder> decoder;
+    uint8_t nchannels = 0;
+    uint32_t outputRate = 0;
+    Vector<std::unique_ptr<r8b::CDSPResampler>> resamplers;     // one per output channel, if the rates differ
+
+    // planar, capacity frames per channel. The decode task writes and the audio thread reads, so each position has one writer.
+    Vector<float> ring;
+    uint32_t capacity = 0;
+    std::atomic<uint64_t> readPos = 0, writePos = 0;
+    std::atomic<uint64_t> discardBefore = 0;    // data before this position was decoded before a restart
+    std::atomic<bool> decoding = false, ended = false, restartRequested = false;
+    std::mutex decodeMtx;
+
+    // scratch, only used under decodeMtx
+    Vector<float> interleaved, converted;
+    Vector<double> resampleIn;
+
+    // opening a decoder may decode the whole file, so it happens on the first decode rather than on construction
+    void Open() {
+        if (extension == "wav") {
+            decoder = std::make_unique<WavDecoder>(file);
+        }
+        else if (extension == "ogg") {
+            decoder = std::make_unique<VorbisDecoder>(file);
+        }
+        else {
+            decoder = std::make_unique<WholeFileDecoder>(extension, file);
+            file = {};  // the decoder has its own copy
+        }
+        Debug::Assert(decoder->nchannels == nchannels || (decoder->nchannels == 1 && nchannels == 2) || (decoder->nchannels == 2 && nchannels == 1),
+            "Unable to convert input audio with {} channels to desired {} channels", decoder->nchannels, nchannels);
+        if (decoder->sampleRate != outputRate) {
+            for (uint8_t c = 0; c < nchannels; c++) {
+                resamplers.push_back(std::make_unique<r8b::CDSPResampler>(decoder->sampleRate, outputRate, decodeChunkFrames));
+            }
+        }
+        interleaved.resize(decodeChunkFrames * decoder->nchannels);
+        converted.resize(decodeChunkFrames);
+        resampleIn.resize(decodeChunkFrames);
+    }
+
+    void Write(uint8_t channel, uint64_t pos, const float* samples, uint32_t n) {
+        auto dest = ring.data() + size_t(channel) * capacity;
+        for (uint32_t i = 0; i < n; i++) {
+            dest[(pos + i) % capacity] = samples[i];
+        }
+    }
+
+    // decode until the ring is nearly full or the file ends
+    void Fill(bool loops) {
+        std::lock_guard lock(decodeMtx);
+        if (!decoder) {
+            Open();
+        }
+        if (restartRequested.exchange(false)) {
+            decoder->Rewind();
+            for (auto& resampler : resamplers) {
+                resampler->clear();
+            }
+            ended = false;
+            discardBefore = writePos.load();
+        }
+
+        // a chunk can grow by the resampling ratio
+        const auto maxChunkOut = uint64_t(decodeChunkFrames * (double(outputRate) / decoder->sampleRate)) + 64;
+        while (!ended && capacity - (writePos - std::max(readPos.load(), discardBefore.load())) > maxChunkOut) {
+            auto frames = decoder->Read(interleaved.data(), decodeChunkFrames);
+            if (frames < decodeChunkFrames && loops) {
+                // continue from the start, through the same resamplers so there is no seam
+                decoder->Rewind();
+                frames += decoder->Read(interleaved.data() + frames * decoder->nchannels, decodeChunkFrames - frames);
+            }
+            if (frames == 0) {
+                ended = true;
+                break;
+            }
+
+            const auto pos = writePos.load();
+            uint32_t written = 0;
+            for (uint8_t c = 0; c < nchannels; c++) {
+                // channel conversion
+                const auto srcChannels = decoder->nchannels;
+                for (uint32_t i = 0; i < frames; i++) {
+                    if (srcChannels == nchannels) {
+                        converted[i] = interleaved[i * srcChannels + c];
+                    }
+                    else if (srcChannels == 1) {
+                        converted[i] = interleaved[i];
+                    }
+                    else {
+                        converted[i] = (interleaved[i * 2] + interleaved[i * 2 + 1]) * 0.5f;
+                    }
+                }
+
+                if (resamplers.empty()) {
+                    Write(c, pos, converted.data(), frames);
+                    written = frames;
+                }
+                else {
+                    std::copy(converted.begin(), converted.begin() + frames, resampleIn.begin());
+                    double* out = nullptr;
+                    const auto nOut = resamplers[c]->process(resampleIn.data(), int(frames), out);
+                    for (int i = 0; i < nOut; i++) {
+                        ring[size_t(c) * capacity + (pos + i) % capacity] = float(out[i]);
+                    }
+                    written = uint32_t(nOut);
+                }
+            }
+            writePos = pos + written;
+            if (frames < decodeChunkFrames && !loops) {
+                ended = true;
+            }
+        }
+    }
+};
+
+StreamingAudioDataProvider::StreamingAudioDataProvider(const std::string& name, uint8_t nchannels, double bufferSeconds) : AudioDataProvider(AudioPlayer::GetBufferSize(), nchannels), stream(std::make_shared<Stream>()){
+    string path = Format("/sounds/{}", name);
+    stream->file = GetApp()->GetResources().FileContentsAt<std::vector<uint8_t>>(path.c_str(), false);
+    stream->extension = Filesystem::Path(path).extension().string().substr(1);
+    std::transform(stream->extension.begin(), stream->extension.end(), stream->extension.begin(), [](char c) { return char(std::tolower(c)); });
+    stream->nchannels = nchannels;
+    stream->outputRate = AudioPlayer::GetSamplesPerSec();
+    stream->capacity = std::max<uint32_t>(uint32_t(bufferSeconds * stream->outputRate), decodeChunkFrames * 4);
+    stream->ring.resize(size_t(stream->capacity) * nchannels);
+}
+
+void StreamingAudioDataProvider::ScheduleDecode(){
+    if (stream->decoding.exchange(true)) {
+        return;     // already decoding, it will fill the space this read made
+    }
+    GetApp()->executor.silent_async([stream = this->stream, loops = bool(loops)] {
+        stream->Fill(loops);
+        stream->decoding = false;
+    });
+}
+
+void StreamingAudioDataProvider::Prefetch(){
+    ScheduleDecode();
+}
+
+void StreamingAudioDataProvider::Play(){
+    if (!isPlaying) {
+        ScheduleDecode();
+        AudioDataProvider::Play();
+    }
+}
+
+void StreamingAudioDataProvider::Restart(){
+    stream->restartRequested = true;
+    ScheduleDecode();
+}
+
+double StreamingAudioDataProvider::GetLength() const{
+    std::lock_guard lock(stream->decodeMtx);
+    if (!stream->decoder) {
+        stream->Open();
+    }
+    return stream->decoder->lengthSeconds;
+}
+
+void StreamingAudioDataProvider::ProvideBufferData(PlanarSampleBufferInlineView& buffer, PlanarSampleBufferInlineView& scratchSpace){
+    const auto nchannels = stream->nchannels;
+    assert(buffer.GetNChannels() >= nchannels);  // you are trying to do something that doesn't make sense!!
+    
+    // skip what was decoded before a restart
+    auto readPos = std::max(stream->readPos.load(), stream->discardBefore.load());
+    const auto available = stream->writePos.load() - readPos;
+    const auto nframes = std::min<uint64_t>(available, buffer.sizeOneChannel());
+    
+    const float gain = volume * AudioGraphComposed::GetLeadingGain();
+    for (uint8_t c = 0; c < nchannels; c++) {
+        const auto src = stream->ring.data() + size_t(c) * stream->capacity;
+        for (uint64_t i = 0; i < nframes; i++) {
+            buffer[c][i] = src[(readPos + i) % stream->capacity] * gain;
+        }
+        for (uint64_t i = nframes; i < buffer.sizeOneChannel(); i++) {
+            buffer[c][i] = 0;
+        }
+    }
+    stream->readPos = readPos + nframes;
+    
+    if (nframes == available && stream->ended && !stream->restartRequested) {
+        isPlaying = false;
+    }
+    else if (!stream->ended && stream->writePos - stream->readPos < stream->capacity / 2) {
+        ScheduleDecode();
+    }
+    AudioGraphComposed::Render(buffer, scratchSpace, nchannels, true);
+}
+#endif
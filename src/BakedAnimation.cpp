@@ -0,0 +1,92 @@
+#include "BakedAnimation.hpp"
+#include "AnimationAsset.hpp"
+#include "SkeletonAsset.hpp"
+#include "Debug.hpp"
+#include "App.hpp"
+#include <ozz/animation/runtime/local_to_model_job.h>
+#include <ozz/base/maths/soa_transform.h>
+#include <ozz/base/maths/simd_math.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#if !RVE_SERVER
+#include "RenderEngine.hpp"
+#endif
+
+using namespace RavEngine;
+
+BakedAnimation::BakedAnimation(Ref<SkeletonAsset> skeleton, std::span<const Clip> inClips, float framesPerSecond) : skeleton(skeleton), framesPerSecond(framesPerSecond) {
+	const auto& sk = *skeleton->GetSkeleton();
+	numJoints = sk.num_joints();
+
+	clips.reserve(inClips.size());
+	uint32_t totalFrames = 0;
+	for (const auto& clip : inClips) {
+		// a clip that does not loop holds its last frame, so it needs the frame at its end
+		const auto numFrames = std::max<uint32_t>(1, uint32_t(std::ceil(clip.duration * framesPerSecond)) + (clip.looping ? 0 : 1));
+		clips.push_back({ .firstFrame = totalFrames, .numFrames = numFrames, .looping = clip.looping });
+		totalFrames += numFrames;
+	}
+
+#if !RVE_SERVER
+	Vector<glm::mat4> frames(size_t(totalFrames) * numJoints);
+	ozz::vector<ozz::math::SoaTransform> locals(sk.num_soa_joints());
+	ozz::vector<ozz::math::Float4x4> models(numJoints);
+	ozz::animation::SamplingJob::Context cache(numJoints);
+	const auto& inverseBindposes = skeleton->GetInverseBindposes();
+
+	for (uint16_t c = 0; c < inClips.size(); c++) {
+		const auto& range = clips[c];
+		for (uint32_t frame = 0; frame < range.numFrames; frame++) {
+			const float time = std::min(frame / framesPerSecond, inClips[c].duration);
+			inClips[c].clip->Sample(time, 0, 1, range.looping, locals, cache, &sk);
+
+			ozz::animation::LocalToModelJob job;
+			job.skeleton = &sk;
+			job.input = ozz::make_span(locals);
+			job.output = ozz::make_span(models);
+			if (!job.Run()) {
+				Debug::Fatal("local to model job failed");
+			}
+
+			// the same pose-bindpose product AnimatorComponent makes
+			auto dest = frames.data() + (size_t(range.firstFrame) + frame) * numJoints;
+			for (uint32_t j = 0; j < numJoints; j++) {
+				const auto skinning = models[j] * inverseBindposes[j];
+				for (int col = 0; col < 4; col++) {
+					ozz::math::StorePtrU(skinning.cols[col], glm::value_ptr(dest[j]) + col * 4);
+				}
+			}
+		}
+	}
+
+	matrices = GetApp()->GetDevice()->CreateBuffer({
+		uint32_t(frames.size()),
+		{.StorageBuffer = true},
+		sizeof(frames[0]),
+		RGL::BufferAccess::Private,
+		{.debugName = "Baked Animation"}
+	});
+	matrices->SetBufferData({ frames.data(), frames.size() * sizeof(frames[0]) });
+#endif
+}
+
+BakedAnimation::~BakedAnimation() {
+#if !RVE_SERVER
+	GetApp()->GetRenderEngine().gcBuffers.enqueue(matrices);
+#endif
+}
+
+uint32_t BakedAnimation::GetFrameOffset(uint16_t clip, double time) const {
+	const auto& range = clips.at(clip);
+	auto frame = int64_t(std::floor(time * framesPerSecond));
+	if (range.looping) {
+		frame %= range.numFrames;
+		if (frame < 0) {
+			frame += range.numFrames;
+		}
+	}
+	else {
+		frame = std::clamp<int64_t>(frame, 0, range.numFrames - 1);
+	}
+	return (range.firstFrame + uint32_t(frame)) * numJoints;
+}
@@ -5,8 +5,26 @@
 #include "App.hpp"
 #include "RenderEngine.hpp"
 #include "Profile.hpp"
+#include "PerfCounters.hpp"
 
 namespace RavEngine{
+std::atomic<uint64_t> BufferedVRAMStructureBase::totalPrivateBytes = 0;
+
+void BufferedVRAMStructureBase::TrackPrivateBuffer(){
+    if (memoryPool == nullptr) {
+        memoryPool = MemoryTracking::GetPool(Format("VRAM: {}", debugName.empty() ? "Unnamed buffer" : debugName));
+    }
+    MemoryTracking::Allocated(memoryPool, privateBuffer.get(), privateBuffer->getBufferSize());
+    totalPrivateBytes.fetch_add(privateBuffer->getBufferSize(), std::memory_order_relaxed);
+}
+
+void BufferedVRAMStructureBase::UntrackPrivateBuffer(){
+    if (privateBuffer) {
+        MemoryTracking::Freed(memoryPool, privateBuffer.get(), privateBuffer->getBufferSize());
+        totalPrivateBytes.fetch_sub(privateBuffer->getBufferSize(), std::memory_order_relaxed);
+    }
+}
+
 void BufferedVRAMStructureBase::InitializePrivateBuffer(RGLDevicePtr device, uint32_t size){
     Debug::Assert(!privateBuffer, "Cannot be invoked after creation!");
     privateBuffer = device->CreateBuffer({
@@ -16,21 +34,25 @@ void BufferedVRAMStructureBase::InitializePrivateBuffer(RGLDevicePtr device, uin
         RGL::BufferAccess::Private,
         {.TransferDestination = true, .Transfersource = true,  .debugName = debugName.data()}
     });
+    TrackPrivateBuffer();
 }
 
 BufferedVRAMStructureBase::~BufferedVRAMStructureBase()
 {
+    UntrackPrivateBuffer();
     if (auto app = GetApp()) {
         app->GetRenderEngine().gcBuffers.enqueue(privateBuffer);
     }
 }
 
-void BufferedVRAMStructureBase::EncodeSync(RGLDevicePtr device, RGLBufferPtr hostBuffer, RGLCommandBufferPtr transformSyncCommandBuffer, uint32_t elemSize, const Function<void(RGLBufferPtr)>& gcBuffersFn, bool& needsSync){
+void BufferedVRAMStructureBase::EncodeSync(RGLDevicePtr device, RGLBufferPtr hostBuffer, RGLCommandBufferPtr transformSyncCommandBuffer, uint32_t elemSize, FunctionRef<void(RGLBufferPtr)> gcBuffersFn, bool& needsSync){
     RVE_PROFILE_FN;
+    static auto uploadBytes = PerfCounters::GetCounter("Render: Upload Bytes");
     uint32_t newPrivateSize = 0;
     {
         const uint32_t hostSize = hostBuffer->getBufferSize();
-        if (!(privateBuffer) || privateBuffer->getBufferSize() != hostSize) {
+        // the host buffer grows geometrically, and the private buffer never shrinks, so reallocations stay rare
+        if (!(privateBuffer) || privateBuffer->getBufferSize() < hostSize) {
             newPrivateSize = hostSize;
         }
     }
@@ -38,9 +60,6 @@ void BufferedVRAMStructureBase::EncodeSync(RGLDevicePtr device, RGLBufferPtr hos
     bool beginCalled = false;
     // sync transforms to GPU
     
-    int8_t gapCounter = 0;
-    uint32_t rangeBegin = 0;
-    auto& syncTrackBuffer = syncTrackingBuffer;
     auto beginCB = [&] {
         if (!needsSync) {
             transformSyncCommandBuffer->Reset();
@@ -57,6 +76,7 @@ void BufferedVRAMStructureBase::EncodeSync(RGLDevicePtr device, RGLBufferPtr hos
         beginCB();
         RGLBufferPtr oldBuffer;
         if (privateBuffer) {
+            UntrackPrivateBuffer();
             oldBuffer = privateBuffer;
             gcBuffersFn(oldBuffer);
         }
@@ -67,8 +87,9 @@ void BufferedVRAMStructureBase::EncodeSync(RGLDevicePtr device, RGLBufferPtr hos
             {.StorageBuffer = true},
             sizeof(std::byte),
             RGL::BufferAccess::Private,
-            {.TransferDestination = true, .debugName = debugName.c_str()}
+            {.TransferDestination = true, .Transfersource = true, .debugName = debugName.c_str()}
         });
+        TrackPrivateBuffer();
 
         if (oldBuffer) {
             // copy the old data over
@@ -85,12 +106,12 @@ void BufferedVRAMStructureBase::EncodeSync(RGLDevicePtr device, RGLBufferPtr hos
         }
     }
 
-    auto endRange = [&](uint32_t end) {
-        // this is the end of the range. add a command
-        //Debug::Log("Range: {} - {}", rangeBegin, i);
+    RVE_PROFILE_SECTION(computeRanges, "Compute Ranges");
+    // we can have gaps of up to 2 elements before making a new range
+    syncTracking.ConsumeRanges(2, [&](uint32_t rangeBegin, uint32_t rangeEnd) {
         beginCB();
         const auto bufferOffset = rangeBegin * elemSize;
-        const auto copySize = (end - rangeBegin) * elemSize;
+        const auto copySize = (rangeEnd - rangeBegin) * elemSize;
         transformSyncCommandBuffer->CopyBufferToBuffer(
             {
                 .buffer = hostBuffer,
@@ -100,35 +121,10 @@ void BufferedVRAMStructureBase::EncodeSync(RGLDevicePtr device, RGLBufferPtr hos
                 .buffer = privateBuffer,
                 .offset = bufferOffset
             }, copySize);
-
-    };
-    RVE_PROFILE_SECTION(computeRanges, "Compute Ranges");
-    const auto n = syncTrackBuffer.size();
-    for (uint32_t i = 0; i < n; i++) {
-        auto& modified = syncTrackBuffer[i];
-
-        if (modified && gapCounter == 0) {
-            gapCounter = 2; // we can have gaps of up to 2 matrices before making a new range
-            rangeBegin = i;
-        }
-        if (!modified) {
-            auto prevValue = gapCounter;
-            gapCounter = std::max(0, gapCounter - 1);   // decrement
-            if (gapCounter == 0 && prevValue != 0) {
-                endRange(i);
-            }
-        }
-        if (modified) {
-            modified = false;
-        }
-    }
+        uploadBytes->Add(copySize);
+    });
     RVE_PROFILE_SECTION_END(computeRanges);
 
-    // if the loop ends and gapCounter != 0, then create another range
-    if (gapCounter != 0) {
-        endRange(uint32_t(syncTrackBuffer.size()));
-    }        
-    
     if (beginCalled) {
         transformSyncCommandBuffer->EndRenderDebugMarker();
     }
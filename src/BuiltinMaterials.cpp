@@ -168,6 +168,94 @@ RavEngine::PBRMaterial::PBRMaterial(MaterialRenderOptions options) : LitMaterial
     .pushConstantSize = sizeof(PBRPushConstantData) 
     }, options) {}
 
+RavEngine::ImpostorMaterialInstance::ImpostorMaterialInstance(Ref<ImpostorMaterial> m, const MeshAsset::PackedImpostor& impostor, uint32_t priority) : MaterialInstance(m, priority) {
+    textureBindings[1] = impostor.albedoAtlas ? impostor.albedoAtlas : Texture::Manager::defaultTexture;
+    textureBindings[2] = impostor.normalDepthAtlas ? impostor.normalDepthAtlas : Texture::Manager::defaultNormalTexture;
+    const auto& header = impostor.header;
+    pushConstantData.center = header.center;
+    pushConstantData.radius = header.radius;
+    pushConstantData.framesPerSide = header.framesPerSide;
+    pushConstantData.hemisphere = header.hemisphere;
+}
+
+// the quad turns to face the camera, so neither side can be culled
+RavEngine::ImpostorMaterial::ImpostorMaterial() : LitMaterial("impostor", "impostor", {
+    .bindings = {
+        {
+            .binding = 0,
+                .type = RGL::BindingType::Sampler,
+                .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+        {
+            .binding = 1,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+        {
+            .binding = 2,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+    },
+    .pushConstantSize = sizeof(ImpostorPushConstantData)
+    }, { .cullMode = RGL::CullMode::None }) {}
+
+RavEngine::TerrainMaterialInstance::TerrainMaterialInstance(Ref<TerrainMaterial> m, Ref<Texture> heights, Ref<Texture> normals, Ref<Texture> splat, const TerrainPushConstantData& data, uint32_t priority) : MaterialInstance(m, priority), pushConstantData(data) {
+    textureBindings[1] = heights;
+    textureBindings[2] = normals;
+    textureBindings[3] = splat;
+    for (uint8_t layer = 0; layer < 4; layer++) {
+        textureBindings[4 + layer] = Texture::Manager::defaultTexture;
+    }
+}
+
+// the vertex shader reads the heights, the fragment shader everything else
+RavEngine::TerrainMaterial::TerrainMaterial() : LitMaterial("terrain", "terrain", {
+    .bindings = {
+        {
+            .binding = 0,
+            .type = RGL::BindingType::Sampler,
+            .stageFlags = RGL::BindingVisibility::VertexFragment,
+        },
+        {
+            .binding = 1,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Vertex,
+        },
+        {
+            .binding = 2,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+        {
+            .binding = 3,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+        {
+            .binding = 4,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+        {
+            .binding = 5,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+        {
+            .binding = 6,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+        {
+            .binding = 7,
+            .type = RGL::BindingType::SampledImage,
+            .stageFlags = RGL::BindingVisibility::Fragment,
+        },
+    },
+    .pushConstantSize = sizeof(TerrainPushConstantData)
+    }) {}
+
 
 #endif
 
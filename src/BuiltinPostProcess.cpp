@@ -79,6 +79,7 @@ RavEngine::BloomEffect::BloomApplyPassInstance::BloomApplyPassInstance(Ref<Bloom
     }){}
 
 BloomEffect::BloomEffect(){
+    fusedStep = FusedScreenEffect::BloomApply;
     sampler = GetApp()->GetDevice()->CreateSampler({
         .addressModeU = RGL::SamplerAddressMode::Clamp,
         .addressModeV = RGL::SamplerAddressMode::Clamp,
@@ -162,6 +163,7 @@ void BloomEffect::Preamble(dim_t<int> targetSize){
 
 FXAAEffect::FXAAEffect()
 {
+    fusedStep = FusedScreenEffect::FXAA;
     auto pass = New<FXAAPass>();
     auto instance = New<FXAAPassInstance>(pass);
     passes.push_back(instance);
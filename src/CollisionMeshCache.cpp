@@ -0,0 +1,216 @@
+#include "CollisionMeshCache.hpp"
+#include "MeshAsset.hpp"
+#include "PhysicsSolver.hpp"
+#include "WeakRef.hpp"
+#include "Map.hpp"
+#include "Debug.hpp"
+#include <extensions/PxDefaultStreams.h>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+
+using namespace physx;
+using namespace RavEngine;
+
+namespace {
+	struct Entry {
+		WeakRef<MeshAsset> asset;		// the key is only an address, this detects when it is reused
+		PxTriangleMesh* triangleMesh = nullptr;
+		PxConvexMesh* convexMesh = nullptr;
+
+		void Release() {
+			if (triangleMesh) {
+				triangleMesh->release();
+				triangleMesh = nullptr;
+			}
+			if (convexMesh) {
+				convexMesh->release();
+				convexMesh = nullptr;
+			}
+		}
+	};
+
+	UnorderedMap<const MeshAsset*, Entry> entries;
+	std::mutex mtx;
+
+	// prefixes the PhysX cooked data in serialized meshes
+	struct SerializedHeader {
+		char magic[4]{ 'R','V','C','M' };
+		CollisionMeshCache::Type type;
+		uint8_t pad[3]{};
+	};
+
+	Vector<PxVec3> GetPositions(const Ref<MeshAsset>& meshAsset) {
+		auto& meshdata = meshAsset->GetSystemCopy();
+		Debug::Assert(meshAsset->hasSystemRAMCopy(), "Cooking a collision mesh requires a MeshAsset that keeps a system RAM copy");
+
+		// only want positional data here, UVs and other data are not relevant
+		Vector<PxVec3> vertices(meshdata.positions.size());
+		for (int i = 0; i < vertices.size(); i++) {
+			vertices[i] = PxVec3(meshdata.positions[i][0], meshdata.positions[i][1], meshdata.positions[i][2]);
+		}
+		return vertices;
+	}
+
+	// cooks the asset into stream
+	void Cook(const Ref<MeshAsset>& meshAsset, CollisionMeshCache::Type type, PxOutputStream& stream) {
+		auto vertices = GetPositions(meshAsset);
+		assert(vertices.size() < std::numeric_limits<physx::PxU32>::max());
+
+		if (type == CollisionMeshCache::Type::Triangle) {
+			auto& meshdata = meshAsset->GetSystemCopy();
+			Vector<PxU32> indices(meshdata.indices.size());
+			for (int i = 0; i < indices.size(); i++) {
+				indices[i] = meshdata.indices[i];
+			}
+
+			PxTriangleMeshDesc meshDesc;
+			meshDesc.setToDefault();
+			meshDesc.points.data = vertices.data();
+			meshDesc.points.stride = sizeof(vertices[0]);
+			meshDesc.points.count = static_cast<physx::PxU32>(vertices.size());
+
+			assert(indices.size() / 3 < std::numeric_limits<physx::PxU32>::max());
+			meshDesc.triangles.count = static_cast<physx::PxU32>(indices.size() / 3);
+			meshDesc.triangles.stride = 3 * sizeof(indices[0]);
+			meshDesc.triangles.data = indices.data();
+
+			if (!PhysicsSolver::cooking->cookTriangleMesh(meshDesc, stream)) {
+				Debug::Fatal("Triangle mesh cooking failed");
+			}
+		}
+		else {
+			PxConvexMeshDesc meshDesc;
+			meshDesc.setToDefault();
+			meshDesc.points.count = static_cast<physx::PxU32>(vertices.size());
+			meshDesc.points.stride = sizeof(PxVec3);
+			meshDesc.points.data = vertices.data();
+			meshDesc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
+
+			if (!PhysicsSolver::cooking->cookConvexMesh(meshDesc, stream)) {
+				Debug::Fatal("Convex mesh cooking failed");
+			}
+		}
+	}
+
+	// the entry for the asset, reset if its address belonged to an asset that no longer exists. Call with mtx held.
+	Entry& EntryFor(const Ref<MeshAsset>& meshAsset) {
+		auto& entry = entries[meshAsset.get()];
+		if (entry.asset.lock() != meshAsset) {
+			entry.Release();
+			entry.asset = meshAsset;
+		}
+		return entry;
+	}
+
+	template<typename T>
+	T* GetOrCook(const Ref<MeshAsset>& meshAsset, CollisionMeshCache::Type type, T* Entry::* member) {
+		{
+			std::lock_guard lock(mtx);
+			if (auto mesh = EntryFor(meshAsset).*member) {
+				return mesh;
+			}
+		}
+
+		// cook without the lock, so other meshes can be fetched meanwhile
+		PxDefaultMemoryOutputStream stream;
+		Cook(meshAsset, type, stream);
+		PxDefaultMemoryInputData input(stream.getData(), stream.getSize());
+		T* cooked;
+		if constexpr (std::is_same_v<T, PxTriangleMesh>) {
+			cooked = PhysicsSolver::phys->createTriangleMesh(input);
+		}
+		else {
+			cooked = PhysicsSolver::phys->createConvexMesh(input);
+		}
+
+		std::lock_guard lock(mtx);
+		auto& slot = EntryFor(meshAsset).*member;
+		if (slot) {
+			// another thread cooked it first
+			cooked->release();
+		}
+		else {
+			slot = cooked;
+		}
+		return slot;
+	}
+}
+
+PxTriangleMesh* CollisionMeshCache::GetTriangleMesh(const Ref<MeshAsset>& mesh) {
+	return GetOrCook(mesh, Type::Triangle, &Entry::triangleMesh);
+}
+
+PxConvexMesh* CollisionMeshCache::GetConvexMesh(const Ref<MeshAsset>& mesh) {
+	return GetOrCook(mesh, Type::Convex, &Entry::convexMesh);
+}
+
+Vector<uint8_t> CollisionMeshCache::Serialize(const Ref<MeshAsset>& mesh, Type type) {
+	PxDefaultMemoryOutputStream stream;
+	Cook(mesh, type, stream);
+
+	SerializedHeader header{ .type = type };
+	Vector<uint8_t> data(sizeof(header) + stream.getSize());
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), stream.getData(), stream.getSize());
+	return data;
+}
+
+bool CollisionMeshCache::Deserialize(const Ref<MeshAsset>& mesh, Type type, std::span<const uint8_t> data) {
+	SerializedHeader expected{ .type = type }, header;
+	if (data.size() <= sizeof(header)) {
+		return false;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.type != type) {
+		return false;
+	}
+
+	// PhysX reads without modifying the data
+	PxDefaultMemoryInputData input(const_cast<PxU8*>(data.data() + sizeof(header)), PxU32(data.size() - sizeof(header)));
+	std::lock_guard lock(mtx);
+	auto& entry = EntryFor(mesh);
+	if (type == Type::Triangle) {
+		auto cooked = PhysicsSolver::phys->createTriangleMesh(input);
+		if (!cooked) {
+			return false;
+		}
+		if (entry.triangleMesh) {
+			entry.triangleMesh->release();
+		}
+		entry.triangleMesh = cooked;
+	}
+	else {
+		auto cooked = PhysicsSolver::phys->createConvexMesh(input);
+		if (!cooked) {
+			return false;
+		}
+		if (entry.convexMesh) {
+			entry.convexMesh->release();
+		}
+		entry.convexMesh = cooked;
+	}
+	return true;
+}
+
+void CollisionMeshCache::Compact() {
+	std::lock_guard lock(mtx);
+	for (auto it = entries.begin(); it != entries.end();) {
+		if (it->second.asset.expired()) {
+			it->second.Release();
+			it = entries.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void CollisionMeshCache::Clear() {
+	std::lock_guard lock(mtx);
+	for (auto& [key, entry] : entries) {
+		entry.Release();
+	}
+	entries.clear();
+}
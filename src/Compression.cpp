@@ -0,0 +1,24 @@
+#include "Compression.hpp"
+#include "Debug.hpp"
+#include <zip_file.hpp>		// the only translation unit to include it, it contains miniz's implementation
+
+using namespace RavEngine;
+
+size_t Compression::DeflateBound(size_t size)
+{
+	return mz_compressBound(mz_ulong(size));
+}
+
+size_t Compression::Deflate(std::span<const std::byte> input, std::span<std::byte> output, int level)
+{
+	mz_ulong compressedSize = mz_ulong(output.size());
+	const auto result = mz_compress2(reinterpret_cast<unsigned char*>(output.data()), &compressedSize, reinterpret_cast<const unsigned char*>(input.data()), mz_ulong(input.size()), level);
+	Debug::Assert(result == MZ_OK, "Compression failed: {}", result);
+	return compressedSize;
+}
+
+bool Compression::Inflate(std::span<const std::byte> input, std::span<std::byte> output)
+{
+	mz_ulong uncompressedSize = mz_ulong(output.size());
+	return mz_uncompress(reinterpret_cast<unsigned char*>(output.data()), &uncompressedSize, reinterpret_cast<const unsigned char*>(input.data()), mz_ulong(input.size())) == MZ_OK && uncompressedSize == output.size();
+}
@@ -31,13 +31,13 @@ void Constraint::Destroy(){
 
 
 SocketConstraint::SocketConstraint(Entity id, decltype(target) t, const decltype(boneTarget)& tgt) : Constraint(id,t) , boneTarget(tgt){
-	//TODO: check if target entity has the bone
-	Debug::Assert(target.GetOwner().GetComponent<AnimatorComponent>().GetSkeleton()->HasBone(tgt), "Cannot add socket constraint to nonexistent bone {}", tgt);
+	// resolved once here, so the socket system does not look up the bone each frame
+	socket = target.GetOwner().GetComponent<AnimatorComponent>().AddSocket(tgt);
 }
 
 void SocketSystem::operator()(const SocketConstraint& constraint, Transform& trns){
 	if (constraint){
 		auto& animator = constraint.GetTarget()->GetOwner().GetComponent<AnimatorComponent>();
-		animator.UpdateSocket(constraint.boneTarget,trns);
+		animator.UpdateSocket(constraint.socket,trns);
 	}
 }
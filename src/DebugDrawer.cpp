@@ -2,6 +2,7 @@
 #include <im3d.h>
 #include "Function.hpp"
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include "PhysXDefines.h"
 #include "Debug.hpp"
 #include <MeshAsset.hpp>
@@ -24,39 +25,36 @@ static inline Im3d::Mat4 matrix4ToMat4(const matrix4& m){
 	return Im3d::Mat4(p[0],p[1],p[2],p[3],p[4],p[5],p[6],p[7],p[8],p[9],p[10],p[11],p[12],p[13],p[14]);
 }
 
+void DebugDrawer::AddShape(UnitShape shape, const matrix4& transform, color_t color){
+	mtx.lock();
+	shapeInstances[shape].push_back({ glm::mat4(transform), color });
+	mtx.unlock();
+}
+
 void DebugDrawer::DrawRectangularPrism(const matrix4 &transform, const color_t c, const vector3& d){
 #ifndef NDEBUG
-	DrawHelper(transform, [=]{
-		Im3d::SetColor(c);
-		Im3d::DrawAlignedBox(Im3d::Vec3(-d.x/2,-d.y/2,-d.z/2), Im3d::Vec3(d.x/2,d.y/2,d.z/2));
-	});
+	AddShape(UnitBox, glm::scale(transform, d), c);
 #endif
 }
 
 void DebugDrawer::DrawCylinder(const matrix4 &transform, const color_t c,decimalType radius, decimalType height){
 #ifndef NDEBUG
-	DrawHelper(transform, [=]{
-		Im3d::SetColor(c);
-		Im3d::DrawCylinder(Im3d::Vec3(0,0,0), Im3d::Vec3(0,height,0), radius);
-	});
+	AddShape(UnitCylinder, glm::scale(transform, vector3(radius, height, radius)), c);
 #endif
 }
 
 void DebugDrawer::DrawSphere(const matrix4 &transform, const color_t c, decimalType radius){
 #ifndef NDEBUG
-	DrawHelper(transform, [=]{
-		Im3d::SetColor(c);
-		Im3d::DrawSphere(Im3d::Vec3(0,0,0), radius);
-	});
+	AddShape(UnitSphere, glm::scale(transform, vector3(radius)), c);
 #endif
 }
 
 void DebugDrawer::DrawCapsule(const matrix4 &transform, const color_t color, decimalType radius, decimalType height){
 #ifndef NDEBUG
-	DrawHelper(transform, [=]{
-        Im3d::SetColor(color);
-        Im3d::DrawCapsule(Im3d::Vec3(0,0,0), Im3d::Vec3(0,height,0), radius);
-    });
+	// a cylinder between the centers of the end caps, with a whole sphere for each cap
+	AddShape(UnitCylinder, glm::scale(transform, vector3(radius, height, radius)), color);
+	AddShape(UnitSphere, glm::scale(transform, vector3(radius)), color);
+	AddShape(UnitSphere, glm::scale(glm::translate(transform, vector3(0, height, 0)), vector3(radius)), color);
 #endif
 }
 
@@ -80,6 +78,15 @@ void DebugDrawer::DrawArrow(const vector3 &start, const vector3 &end, const colo
 }
 
 
+void DebugDrawer::DrawLine(const vector3& start, const vector3& end, const color_t color){
+#ifndef NDEBUG
+	mtx.lock();
+	lineVertices.push_back({ glm::vec4(start.x, start.y, start.z, 1), color });
+	lineVertices.push_back({ glm::vec4(end.x, end.y, end.z, 1), color });
+	mtx.unlock();
+#endif
+}
+
 void DebugDrawer::DrawHelper(const matrix4 &transform, Function<void()> impl){
 #ifndef NDEBUG
 	mtx.lock();
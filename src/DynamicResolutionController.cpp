@@ -0,0 +1,30 @@
+#include "DynamicResolutionController.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace RavEngine;
+
+float DynamicResolutionController::Update(float gpuFrameTimeMs) {
+    if (!(gpuFrameTimeMs > 0)) {
+        return scale;
+    }
+    const float budget = config.targetFrameTimeMs * config.headroom;
+    const float fit = scale * std::sqrt(budget / gpuFrameTimeMs);     // the scale at which this frame would have been on budget
+
+    if (fit < scale) {
+        scale = fit;
+        framesUnderBudget = 0;
+    }
+    else if (++framesUnderBudget >= config.framesBeforeIncrease) {
+        scale = std::min(fit, scale + config.maxIncreasePerFrame);
+        framesUnderBudget = config.framesBeforeIncrease;   // keep climbing every frame while there is room
+    }
+    scale = std::clamp(scale, config.minScale, config.maxScale);
+    return scale;
+}
+
+void DynamicResolutionController::SetConfig(const Config& newConfig) {
+    config = newConfig;
+    scale = config.maxScale;
+    framesUnderBudget = 0;
+}
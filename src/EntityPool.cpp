@@ -0,0 +1,43 @@
+#include "EntityPool.hpp"
+#include "Transform.hpp"
+#include "PhysicsBodyComponent.hpp"
+
+using namespace RavEngine;
+
+renderlayer_t EntityPoolBase::Deactivate(Entity entity) {
+    renderlayer_t layers = ALL_LAYERS;
+#if !RVE_SERVER
+    layers = entity.GetEntityRenderlayer();
+    entity.SetEntityRenderlayer(0);
+#endif
+    if (entity.HasComponent<RigidBodyDynamicComponent>()) {
+        entity.GetComponent<RigidBodyDynamicComponent>().SetSimulationEnabled(false);
+    }
+    if (entity.HasComponent<RigidBodyStaticComponent>()) {
+        entity.GetComponent<RigidBodyStaticComponent>().SetSimulationEnabled(false);
+    }
+    return layers;
+}
+
+void EntityPoolBase::Activate(Entity entity, renderlayer_t layers, const vector3& position, const quaternion& rotation) {
+#if !RVE_SERVER
+    entity.SetEntityRenderlayer(layers);
+#endif
+    // a body must be simulated to be moved. Disabling simulation cleared its velocity and forces.
+    if (entity.HasComponent<RigidBodyDynamicComponent>()) {
+        entity.GetComponent<RigidBodyDynamicComponent>().SetSimulationEnabled(true);
+    }
+    if (entity.HasComponent<RigidBodyStaticComponent>()) {
+        entity.GetComponent<RigidBodyStaticComponent>().SetSimulationEnabled(true);
+    }
+    Place(entity, position, rotation);
+}
+
+void EntityPoolBase::Place(Entity entity, const vector3& position, const quaternion& rotation) {
+    if (entity.HasComponent<Transform>()) {
+        entity.GetTransform().SetWorldPosition(position).SetWorldRotation(rotation);
+    }
+    if (entity.HasComponent<RigidBodyDynamicComponent>()) {
+        entity.GetComponent<RigidBodyDynamicComponent>().setDynamicsWorldPose(position, rotation);
+    }
+}
@@ -0,0 +1,51 @@
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <new>
+
+using namespace RavEngine;
+
+namespace {
+	struct ArenaHolder {
+		FrameArena* arena = new FrameArena();
+		~ArenaHolder() {
+			// if something allocated on this thread is still alive, the arena lives until it is freed
+			FrameArena::Release(arena);
+		}
+	};
+}
+
+FrameArena& FrameArena::ForThisThread() {
+	thread_local ArenaHolder holder;
+	return *holder.arena;
+}
+
+FrameArena::~FrameArena() {
+	for (const auto& chunk : chunks) {
+		::operator delete(chunk.data);
+	}
+}
+
+void FrameArena::Grow(size_t size, size_t alignment) {
+	// double the total each time, so a frame needs few chunks even before they are merged
+	const auto chunkSize = std::max({ initialChunkSize, capacity, size + alignment + sizeof(Header) });
+	auto data = static_cast<std::byte*>(::operator new(chunkSize));
+	chunks.push_back({ data, chunkSize });
+	capacity += chunkSize;
+	top = data;
+	end = data + chunkSize;
+}
+
+void FrameArena::Restart() {
+	if (chunks.size() > 1) {
+		for (const auto& chunk : chunks) {
+			::operator delete(chunk.data);
+		}
+		chunks.clear();
+		auto data = static_cast<std::byte*>(::operator new(capacity));
+		chunks.push_back({ data, capacity });
+	}
+	if (!chunks.empty()) {
+		top = chunks.front().data;
+		end = top + chunks.front().size;
+	}
+}
@@ -0,0 +1,81 @@
+#include "FrameLimiter.hpp"
+#include <thread>
+#include <algorithm>
+#ifdef _WIN32
+	#include <Windows.h>
+	#include <timeapi.h>
+	#pragma comment(lib, "winmm.lib")
+#elif defined __APPLE__
+	#include <mach/mach_time.h>
+#elif !defined __EMSCRIPTEN__
+	#include <time.h>
+	#include <cerrno>
+#endif
+
+using namespace RavEngine;
+using namespace std::chrono;
+
+FrameLimiter::FrameLimiter() : spinTime(200) {
+#ifdef _WIN32
+#ifdef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+	timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	highResolution = timer != nullptr;
+#endif
+	if (!highResolution) {
+		// before Windows 10 1803, timers wake on the scheduler tick, which is ~15ms unless raised
+		timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+		timeBeginPeriod(1);
+		spinTime = microseconds(1500);
+	}
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+	if (timer) {
+		CloseHandle(timer);
+	}
+	if (!highResolution) {
+		timeEndPeriod(1);
+	}
+#endif
+}
+
+void FrameLimiter::SleepFor(nanoseconds duration) {
+#ifdef _WIN32
+	LARGE_INTEGER due;
+	due.QuadPart = -std::max<LONGLONG>(duration.count() / 100, 1);		// negative is relative, in 100ns units
+	if (timer && SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE)) {
+		WaitForSingleObject(timer, INFINITE);
+		return;
+	}
+	std::this_thread::sleep_for(duration);
+#elif defined __APPLE__
+	static const auto timebase = [] {
+		mach_timebase_info_data_t info;
+		mach_timebase_info(&info);
+		return info;
+	}();
+	mach_wait_until(mach_absolute_time() + uint64_t(duration.count()) * timebase.denom / timebase.numer);
+#elif !defined __EMSCRIPTEN__
+	// an absolute deadline, so waking for a signal and sleeping again doesn't add time
+	timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	const auto nsec = deadline.tv_nsec + duration.count();
+	deadline.tv_sec += nsec / 1'000'000'000;
+	deadline.tv_nsec = nsec % 1'000'000'000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+#else
+	std::this_thread::sleep_for(duration);
+#endif
+}
+
+void FrameLimiter::WaitUntil(clock::time_point deadline) {
+	const auto sleepTime = deadline - spinTime - clock::now();
+	if (sleepTime > clock::duration::zero()) {
+		SleepFor(duration_cast<nanoseconds>(sleepTime));
+	}
+	while (clock::now() < deadline) {
+		std::this_thread::yield();
+	}
+}
@@ -87,11 +87,15 @@ ElementDocument* GUIComponent::AddDocument(const std::string &name){
 		Debug::Fatal("Cannot load document at path {}", dir);
 	}
 	ed->Show();
-	data->documents[name] = ed;
+	data->documents[Intern(name)] = ed;
 	return ed;
 }
 
 void GUIComponent::RemoveDocument(const std::string &name){
+	RemoveDocument(StringID(name));
+}
+
+void GUIComponent::RemoveDocument(StringID name){
 	if (!IsDocumentLoaded(name)){
 		Debug::Fatal("Cannot unload document that is not loaded");
 	}
@@ -104,6 +108,10 @@ void GUIComponent::RemoveDocument(const std::string &name){
 }
 
 bool GUIComponent::IsDocumentLoaded(const std::string &name) const{
+	return IsDocumentLoaded(StringID(name));
+}
+
+bool GUIComponent::IsDocumentLoaded(StringID name) const{
 	return data->documents.contains(name);
 }
 
@@ -122,24 +130,40 @@ bool GUIComponent::Update(){
     data->current.store(a);
     data->inactive.store(b);
     
-    bool result;
-    ExclusiveAccess([&]{
+    bool result = true;
+    data->ExclusiveAccess([&]{
         // process the 'inactive' queue (which was filled previously)
         Function<void(void)> task;
+        bool ranTask = false;
         auto ptr = a;
         while(ptr->try_dequeue(task)){
             task();
+            ranTask = true;
+        }
+        // without input, changes, or a pending animation, the layout would come out the same
+        const auto now = Rml::GetSystemInterface()->GetElapsedTime();
+        if (ranTask || data->needsUpdate.exchange(false) || now >= data->nextUpdateTime) {
+            result = data->context->Update();
+            data->nextUpdateTime = now + data->context->GetNextUpdateDelay();
+            data->contentChanged = true;
         }
-        result = data->context->Update();
     });
     
     return result;
 }
 
 bool GUIComponent::Render(){
-	bool result;
-    ExclusiveAccess([&]{
-        result = data->context->Render();
+	bool result = true;
+    data->ExclusiveAccess([&]{
+        auto& renderer = GetApp()->GetRenderEngine();
+        if (data->contentChanged || !renderer.ReplayGUIDrawList(data->drawList)) {
+            renderer.BeginGUIDrawList(data->drawList);
+            result = data->context->Render();
+            renderer.EndGUIDrawList();
+            data->contentChanged = false;
+            // elements may ask for another update while rendering, such as a blinking text cursor
+            data->nextUpdateTime = std::min(data->nextUpdateTime, Rml::GetSystemInterface()->GetElapsedTime() + data->context->GetNextUpdateDelay());
+        }
     });
 	return result;
 }
@@ -151,15 +175,25 @@ GUIComponent::GUIComponent(int width, int height, float DPIScale){
 	
 	data->context = Rml::CreateContext(uuid.to_string(), Vector2i(width,height));
 	data->context->SetDensityIndependentPixelRatio(DPIScale);
+	data->requestedDimensions = Vector2i(width, height);
 }
 
 void RavEngine::GUIComponent::SetDPIScale(float scale) {
-	data->context->SetDensityIndependentPixelRatio(scale);
+	if (data->context->GetDensityIndependentPixelRatio() == scale) {
+		return;
+	}
+	ExclusiveAccess([&] {
+		data->context->SetDensityIndependentPixelRatio(scale);
+	});
 }
 
 Rml::ElementDocument* GUIComponent::GetDocument(const std::string &name) const{
+	return GetDocument(StringID(name));
+}
+
+Rml::ElementDocument* GUIComponent::GetDocument(StringID name) const{
 	if (!IsDocumentLoaded(name)){
-		Debug::Fatal("Cannot get pointer to {} because it is not loaded.",name);
+		Debug::Fatal("Cannot get pointer to {} because it is not loaded.", name.ToString());
 	}
 	return data->documents.at(name);
 }
@@ -281,12 +315,22 @@ void GUIComponent::GUIData::ScrollY(float amt){
 void GUIComponent::GUIData::MouseMove(){
 	//Forward to canvas, using the bitmask
     auto dim = context->GetDimensions();
+    // an unmoved mouse would not change the hover state, and enqueuing it would update the context every frame
+    if (MousePos.x == lastMouseMove.x && MousePos.y == lastMouseMove.y && dim == lastMouseMove.dim) {
+        return;
+    }
+    lastMouseMove = { MousePos.x, MousePos.y, dim };
     EnqueueUIUpdate([this,dim] {
 		context->ProcessMouseMove(MousePos.x * dim.x, MousePos.y * dim.y, modifier_state);
 	});
 }
 
 void GUIComponent::GUIData::SetDimensions(uint32_t width, uint32_t height){
+    const Rml::Vector2i dim(width, height);
+    if (dim == requestedDimensions) {
+        return;
+    }
+    requestedDimensions = dim;
     EnqueueUIUpdate([this,width,height] {
 		context->SetDimensions(Rml::Vector2i(width, height));
 	});
@@ -0,0 +1,79 @@
+#include "Heightfield.hpp"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace RavEngine;
+
+float Heightfield::Sample(float x, float z) const {
+    const float fx = std::clamp(x / spacing, 0.f, float(width - 1));
+    const float fz = std::clamp(z / spacing, 0.f, float(depth - 1));
+    const auto x0 = uint32_t(fx), z0 = uint32_t(fz);
+    const auto x1 = std::min(x0 + 1, width - 1), z1 = std::min(z0 + 1, depth - 1);
+    const float tx = fx - x0, tz = fz - z0;
+
+    // interpolate within the cell's triangle that holds the position
+    const float h00 = At(x0, z0), h11 = At(x1, z1);
+    if (tx >= tz) {
+        const float h10 = At(x1, z0);
+        return h00 + tx * (h10 - h00) + tz * (h11 - h10);
+    }
+    const float h01 = At(x0, z1);
+    return h00 + tz * (h01 - h00) + tx * (h11 - h01);
+}
+
+glm::vec3 Heightfield::Normal(uint32_t x, uint32_t z) const {
+    const auto xl = x > 0 ? x - 1 : x, xr = std::min(x + 1, width - 1);
+    const auto zl = z > 0 ? z - 1 : z, zr = std::min(z + 1, depth - 1);
+    const float dx = xr > xl ? (At(xr, z) - At(xl, z)) / ((xr - xl) * spacing) : 0;
+    const float dz = zr > zl ? (At(x, zr) - At(x, zl)) / ((zr - zl) * spacing) : 0;
+    return glm::normalize(glm::vec3(-dx, 1, -dz));
+}
+
+Heightfield::Range Heightfield::HeightRange(uint32_t x0, uint32_t z0, uint32_t x1, uint32_t z1) const {
+    Range range{ At(x0, z0), At(x0, z0) };
+    for (uint32_t z = z0; z <= z1; z++) {
+        for (uint32_t x = x0; x <= x1; x++) {
+            range.min = std::min(range.min, At(x, z));
+            range.max = std::max(range.max, At(x, z));
+        }
+    }
+    return range;
+}
+
+bool RavEngine::ParseTerrainTile(std::span<const std::byte> bytes, float tileSize, TerrainTileData& out) {
+    if (bytes.size() < sizeof(TerrainTileHeader)) {
+        return false;
+    }
+    const auto& header = *reinterpret_cast<const TerrainTileHeader*>(bytes.data());
+    if (header.header != TerrainTileHeader{}.header || header.resolution < 2) {
+        return false;
+    }
+    const size_t numHeights = size_t(header.resolution) * header.resolution;
+    const size_t numSplat = size_t(header.splatResolution) * header.splatResolution;
+    if (bytes.size() != sizeof(header) + numHeights * sizeof(float) + numSplat * sizeof(out.splat[0])) {
+        return false;
+    }
+
+    out.heights = Heightfield(header.resolution, header.resolution, tileSize / (header.resolution - 1));
+    std::memcpy(out.heights.heights.data(), bytes.data() + sizeof(header), numHeights * sizeof(float));
+    out.splatResolution = header.splatResolution;
+    out.splat.resize(numSplat);
+    std::memcpy(out.splat.data(), bytes.data() + sizeof(header) + numHeights * sizeof(float), numSplat * sizeof(out.splat[0]));
+    return true;
+}
+
+Vector<std::byte> RavEngine::SerializeTerrainTile(const Heightfield& heights, uint32_t splatResolution, std::span<const std::array<uint8_t, 4>> splat) {
+    TerrainTileHeader header;
+    header.resolution = heights.width;
+    header.splatResolution = splatResolution;
+    const size_t heightBytes = heights.heights.size() * sizeof(float), splatBytes = splat.size_bytes();
+
+    Vector<std::byte> bytes(sizeof(header) + heightBytes + splatBytes);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), heights.heights.data(), heightBytes);
+    std::memcpy(bytes.data() + sizeof(header) + heightBytes, splat.data(), splatBytes);
+    return bytes;
+}
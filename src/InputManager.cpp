@@ -27,14 +27,68 @@ vector2 RavEngine::InputManager::GetMousePosPixels(float scaleFactor)
 	return pos;
 }
 
+uint32_t InputManager::ActionIndex(StringID name){
+	auto it = ActionIndices.find(name);
+	if (it == ActionIndices.end()){
+		it = ActionIndices.emplace(name, uint32_t(Actions.size())).first;
+		Actions.emplace_back();
+	}
+	return it->second;
+}
+
+uint32_t InputManager::AxisIndex(StringID name){
+	auto it = AxisIndices.find(name);
+	if (it == AxisIndices.end()){
+		it = AxisIndices.emplace(name, uint32_t(Axes.size())).first;
+		Axes.emplace_back();
+	}
+	return it->second;
+}
+
+void InputManager::AddActionMap(const std::string& name, int Id){
+	auto& actions = CodeToAction[Id];
+	const auto index = ActionIndex(StringID(name));
+	if (std::find(actions.begin(), actions.end(), index) == actions.end()){
+		actions.push_back(index);
+	}
+}
+
+void InputManager::AddAxisMap(const std::string& name, int Id, float scale){
+	auto& axes = CodeToAxis[Id];
+	const AxisMapping mapping{AxisIndex(StringID(name)), scale};
+	if (std::find_if(axes.begin(), axes.end(), [&](const AxisMapping& m){ return m.axis == mapping.axis && m.scale == mapping.scale; }) == axes.end()){
+		axes.push_back(mapping);
+	}
+}
+
+void InputManager::RemoveActionMap(const std::string& name, int Id){
+	if (auto it = CodeToAction.find(Id); it != CodeToAction.end()){
+		auto& actions = it->second;
+		if (auto pos = std::find(actions.begin(), actions.end(), ActionIndex(StringID(name))); pos != actions.end()){
+			actions.erase(pos);
+		}
+	}
+}
+
+void InputManager::RemoveAxisMap(const std::string& name, int Id, float scale){
+	if (auto it = CodeToAxis.find(Id); it != CodeToAxis.end()){
+		auto& axes = it->second;
+		const auto axis = AxisIndex(StringID(name));
+		if (auto pos = std::find_if(axes.begin(), axes.end(), [&](const AxisMapping& m){ return m.axis == axis && m.scale == scale; }); pos != axes.end()){
+			axes.erase(pos);
+		}
+	}
+}
+
 void InputManager::ProcessActionID(int id, ActionState state_in, CID controller){
 	RVE_PROFILE_FN;
-	if (CodeToAction.contains(id)){
+	if (auto it = CodeToAction.find(id); it != CodeToAction.end()){
 		//get the actions that need to be run
-		for(const auto& actionName : CodeToAction[id]){
-			//for each action, get the bindings to execute
-			for(const auto& binding : ActionBindings[actionName]){
-				binding(state_in, controller);	//execute the binding
+		for(const auto action : it->second){
+			//for each action, get the bindings to execute. By index, because a binding may bind or unbind others.
+			auto& bindings = Actions[action].bindings;
+			for(size_t i = 0; i < bindings.size(); i++){
+				bindings[i](state_in, controller);	//execute the binding
 			}
 		}
 	}
@@ -55,34 +109,58 @@ void InputManager::ProcessActionID(int id, ActionState state_in, CID controller)
 
 void InputManager::ProcessAxisID(int ID, float value, CID controller){
 	RVE_PROFILE_FN;
-	if (CodeToAxis.contains(ID)){
-		//buffer the input
-		for(const auto& axisName : CodeToAxis[ID]){
-			auto scale = axisName.scale;
-			AxisBindings[axisName.identifier].bufferedInputs[ID]={value * scale,controller};
+	if (auto it = CodeToAxis.find(ID); it != CodeToAxis.end()){
+		//buffer the input, replacing the previous value from this code
+		for(const auto& mapping : it->second){
+			auto& buffered = Axes[mapping.axis].bufferedInputs;
+			const AxisInput input{ID, value * mapping.scale, controller};
+			if (auto pos = std::find_if(buffered.begin(), buffered.end(), [ID](const AxisInput& in){ return in.code == ID; }); pos != buffered.end()){
+				*pos = input;
+			}
+			else{
+				buffered.push_back(input);
+			}
 		}
 	}
 }
 
+void InputManager::FlushCoalescedInput(){
+	if (coalesced.moved){
+		ProcessAxisID(Special::MOUSEMOVE_X, coalesced.x, CID::C0);
+		ProcessAxisID(Special::MOUSEMOVE_Y, coalesced.y, CID::C0);
+		ProcessAxisID(Special::MOUSEMOVE_XVEL, coalesced.xrel, CID::C0);
+		ProcessAxisID(Special::MOUSEMOVE_YVEL, coalesced.yrel, CID::C0);
+	}
+	if (coalesced.scrolled){
+		ProcessAxisID(Special::MOUSEWHEEL_X, coalesced.wheelX, CID::C0);
+		ProcessAxisID(Special::MOUSEWHEEL_Y, coalesced.wheelY, CID::C0);
+	}
+	coalesced.xrel = coalesced.yrel = coalesced.wheelX = coalesced.wheelY = 0;
+	coalesced.moved = coalesced.scrolled = false;
+}
+
 void InputManager::TickAxes(){
 	RVE_PROFILE_FN;
-	for(auto& binding : AxisBindings){
-		//get each binding
-		for(const auto& axis : binding.second.bindings){
+	FlushCoalescedInput();
+	for(auto& axis : Axes){
+		//get each binding. By index, because a binding may bind or unbind others.
+		for(size_t i = 0; i < axis.bindings.size(); i++){
 			//pass each buffered value to each Action
-			for(const auto& buffered_value : binding.second.bufferedInputs){
-				axis(buffered_value.second.value, buffered_value.second.source_controller);
+			for(const auto& buffered_value : axis.bufferedInputs){
+				axis.bindings[i](buffered_value.value, buffered_value.source_controller);
 			}
 		}
 	}
 	
 	//clear mouse velocity inputs
 	auto clearvel = [&](int ID){
-		if (CodeToAxis.contains(ID)){
-			//buffer the input
-			for(const auto& axisName : CodeToAxis[ID]){
-				auto scale = axisName.scale;
-				AxisBindings[axisName.identifier].bufferedInputs[ID]={0,CID::C0};
+		if (auto it = CodeToAxis.find(ID); it != CodeToAxis.end()){
+			for(const auto& mapping : it->second){
+				for(auto& buffered : Axes[mapping.axis].bufferedInputs){
+					if (buffered.code == ID){
+						buffered = {ID, 0, CID::C0};
+					}
+				}
 			}
 		}
 	};
@@ -99,15 +177,15 @@ void InputManager::TickAxes(){
 void InputManager::CleanupBindings(){
 	RVE_PROFILE_FN;
 	//clean up invalid action bindings
-	for(auto& binding : ActionBindings){
-		binding.second.remove_if([](const ActionBinding& b) -> bool{
+	for(auto& action : Actions){
+		std::erase_if(action.bindings, [](const ActionBinding& b) -> bool{
 			return !b.IsValid();
 		});
 	}
 	
 	//clean up invalid axis bindings
-	for(auto& binding : AxisBindings){
-		binding.second.bindings.remove_if([](const AxisBinding& b) -> bool{
+	for(auto& axis : Axes){
+		std::erase_if(axis.bindings, [](const AxisBinding& b) -> bool{
 			return !b.IsValid();
 		});
 	}
@@ -134,17 +212,18 @@ void InputManager::ProcessInput(const SDL_Event& event, uint32_t windowflags, fl
 				
 				float velscale = 1 / scale;
 				
-				ProcessAxisID(Special::MOUSEMOVE_X, (float)event.motion.x / (width / dpiScale), CID::C0);
-				ProcessAxisID(Special::MOUSEMOVE_Y, (float)event.motion.y / (height / dpiScale), CID::C0);
-				
-				ProcessAxisID(Special::MOUSEMOVE_XVEL, event.motion.xrel * velscale, CID::C0);
-				ProcessAxisID(Special::MOUSEMOVE_YVEL, event.motion.yrel * velscale, CID::C0);
-				
+				// the latest position, and the motion since the last frame
+				coalesced.x = (float)event.motion.x / (width / dpiScale);
+				coalesced.y = (float)event.motion.y / (height / dpiScale);
+				coalesced.xrel += event.motion.xrel * velscale;
+				coalesced.yrel += event.motion.yrel * velscale;
+				coalesced.moved = true;
 			}
 			break;
         case SDL_EVENT_MOUSE_WHEEL:
-			ProcessAxisID(Special::MOUSEWHEEL_X, event.wheel.x * -0.2, CID::C0);
-			ProcessAxisID(Special::MOUSEWHEEL_Y, event.wheel.y * -0.2, CID::C0);
+			coalesced.wheelX += event.wheel.x * -0.2;
+			coalesced.wheelY += event.wheel.y * -0.2;
+			coalesced.scrolled = true;
 			break;
         case SDL_EVENT_MOUSE_BUTTON_DOWN:
         case SDL_EVENT_MOUSE_BUTTON_UP:
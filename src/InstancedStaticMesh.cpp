@@ -0,0 +1,140 @@
+#if !RVE_SERVER
+
+#include "InstancedStaticMesh.hpp"
+#include "World.hpp"
+#include "Transform.hpp"
+#include "BufferedVRAMVector.hpp"
+
+using namespace RavEngine;
+
+InstancedStaticMesh::InstancedStaticMesh(Entity owner, Ref<MeshCollectionStatic> mesh, Ref<MaterialInstance> material) : ComponentWithOwner(owner), mesh(mesh), material(material) {
+	assert(owner.HasComponent<Transform>() && "Instanced meshes are positioned relative to their owner's Transform");
+}
+
+void InstancedStaticMesh::AllocateSlots(uint32_t count) {
+	auto world = GetOwner().GetWorld();
+	const auto firstNew = renderSlots.size();
+	world->CreateEntities(count, renderSlots);
+	std::span<const entity_t> newSlots(renderSlots.begin() + firstNew, renderSlots.end());
+	for (const auto slot : newSlots) {
+		if (renderLayers != ALL_LAYERS) {
+			world->SetEntityRenderlayer(slot, renderLayers);
+		}
+		if (attributes != ALL_ATTRIBUTES) {
+			world->SetEntityAttributes(slot, attributes);
+		}
+	}
+	if (GetEnabled()) {
+		world->AddInstancedMeshRenderData(newSlots, material, mesh);
+	}
+}
+
+uint32_t InstancedStaticMesh::AddInstance(const matrix4& transform) {
+	AddInstances({ &transform, 1 });
+	return GetInstanceCount() - 1;
+}
+
+void InstancedStaticMesh::AddInstances(std::span<const matrix4> transforms) {
+	if (transforms.empty()) {
+		return;
+	}
+	const auto first = GetInstanceCount();
+	instanceTransforms.insert(instanceTransforms.end(), transforms.begin(), transforms.end());
+	AllocateSlots(static_cast<uint32_t>(transforms.size()));
+	MarkDirty(first);
+	MarkDirty(GetInstanceCount() - 1);
+}
+
+void InstancedStaticMesh::RemoveInstance(uint32_t index) {
+	assert(index < GetInstanceCount());
+	auto world = GetOwner().GetWorld();
+
+	// the removed instance gives up the last slot, and the last instance takes over its index
+	const auto lastSlot = renderSlots.back();
+	if (GetEnabled()) {
+		world->RemoveInstancedMeshRenderData({ &lastSlot, 1 }, material, mesh);
+	}
+	world->ReleaseInstanceSlots({ &lastSlot, 1 });
+	renderSlots.pop_back();
+
+	instanceTransforms[index] = instanceTransforms.back();
+	instanceTransforms.pop_back();
+	if (index < GetInstanceCount()) {
+		MarkDirty(index);
+	}
+	dirtyEnd = std::min(dirtyEnd, GetInstanceCount());
+	dirtyBegin = std::min(dirtyBegin, dirtyEnd);
+}
+
+void InstancedStaticMesh::ClearInstances() {
+	auto world = GetOwner().GetWorld();
+	if (GetEnabled()) {
+		world->RemoveInstancedMeshRenderData(renderSlots, material, mesh);
+	}
+	world->ReleaseInstanceSlots(renderSlots);
+	renderSlots.clear();
+	instanceTransforms.clear();
+	dirtyBegin = dirtyEnd = 0;
+}
+
+void InstancedStaticMesh::SetMaterial(Ref<MaterialInstance> mat) {
+	if (mat == material) {
+		return;
+	}
+	if (GetEnabled()) {
+		auto world = GetOwner().GetWorld();
+		world->RemoveInstancedMeshRenderData(renderSlots, material, mesh);
+		world->AddInstancedMeshRenderData(renderSlots, mat, mesh);
+	}
+	material = mat;
+}
+
+void InstancedStaticMesh::SetRenderLayers(renderlayer_t layers) {
+	renderLayers = layers;
+	auto world = GetOwner().GetWorld();
+	for (const auto slot : renderSlots) {
+		world->SetEntityRenderlayer(slot, layers);
+	}
+}
+
+void InstancedStaticMesh::SetAttributes(perobject_t attr) {
+	attributes = attr;
+	auto world = GetOwner().GetWorld();
+	for (const auto slot : renderSlots) {
+		world->SetEntityAttributes(slot, attr);
+	}
+}
+
+void InstancedStaticMesh::SetEnabled(bool in) {
+	if (in == GetEnabled()) {
+		return;
+	}
+	Disableable::SetEnabled(in);
+	auto world = GetOwner().GetWorld();
+	if (in) {
+		world->AddInstancedMeshRenderData(renderSlots, material, mesh);
+	}
+	else {
+		world->RemoveInstancedMeshRenderData(renderSlots, material, mesh);
+	}
+}
+
+void InstancedStaticMesh::Destroy() {
+	ClearInstances();
+}
+
+void InstancedStaticMesh::SyncRenderTransforms(BufferedVRAMVector<matrix4>& worldTransforms, const matrix4& ownerMatrix) {
+	uint32_t begin = dirtyBegin, end = dirtyEnd;
+	if (ownerMatrix != lastOwnerMatrix) {
+		// the owner moved, so every instance moved
+		begin = 0;
+		end = GetInstanceCount();
+		lastOwnerMatrix = ownerMatrix;
+	}
+	for (uint32_t i = begin; i < end; i++) {
+		worldTransforms.SetValueAt(renderSlots[i].id, ownerMatrix * instanceTransforms[i]);
+	}
+	dirtyBegin = dirtyEnd = 0;
+}
+
+#endif
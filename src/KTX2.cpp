@@ -0,0 +1,107 @@
+#include "KTX2.hpp"
+#include "Compression.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace RavEngine;
+
+namespace {
+	constexpr uint8_t identifier[12]{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	struct Header {
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth, pixelHeight, pixelDepth;
+		uint32_t layerCount, faceCount, levelCount;
+		uint32_t supercompressionScheme;
+		uint32_t dfdByteOffset, dfdByteLength;
+		uint32_t kvdByteOffset, kvdByteLength;
+		uint32_t sgdByteOffsetAndLength[4];	// two uint64s, which would be misaligned here
+	};
+	static_assert(sizeof(Header) == 68);
+
+	struct LevelIndex {
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	constexpr size_t levelIndexOffset = sizeof(identifier) + sizeof(Header);
+}
+
+bool KTX2::IsKTX2(std::span<const std::byte> data)
+{
+	return data.size() >= sizeof(identifier) && std::memcmp(data.data(), identifier, sizeof(identifier)) == 0;
+}
+
+KTX2::ReadResult KTX2::Read(std::span<const std::byte> data, Image& image)
+{
+	if (!IsKTX2(data)) {
+		return ReadResult::NotKTX2;
+	}
+	if (data.size() < levelIndexOffset) {
+		return ReadResult::Truncated;
+	}
+	Header header;
+	std::memcpy(&header, data.data() + sizeof(identifier), sizeof(header));
+
+	// undefined formats are Basis Universal, whose blocks must be transcoded to a format the GPU reads
+	if (header.vkFormat == 0 || header.supercompressionScheme == uint32_t(Supercompression::BasisLZ)) {
+		return ReadResult::BasisUniversal;
+	}
+	if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.pixelWidth == 0 || header.pixelHeight == 0) {
+		return ReadResult::Unsupported;
+	}
+	if (header.supercompressionScheme != uint32_t(Supercompression::None) && header.supercompressionScheme != uint32_t(Supercompression::ZLIB)) {
+		return ReadResult::Unsupported;
+	}
+
+	// 0 levels asks the loader to generate mips, which only the largest is stored for
+	const uint32_t levelCount = std::max(header.levelCount, 1u);
+	if (levelCount > 32 || data.size() < levelIndexOffset + levelCount * sizeof(LevelIndex)) {
+		return ReadResult::Truncated;
+	}
+
+	image.vkFormat = header.vkFormat;
+	image.width = header.pixelWidth;
+	image.height = header.pixelHeight;
+	image.supercompression = Supercompression(header.supercompressionScheme);
+	image.levels.clear();
+	image.levelSizes.clear();
+	for (uint32_t i = 0; i < levelCount; i++) {
+		LevelIndex level;
+		std::memcpy(&level, data.data() + levelIndexOffset + i * sizeof(LevelIndex), sizeof(level));
+		if (level.byteOffset > data.size() || level.byteLength > data.size() - level.byteOffset) {
+			return ReadResult::Truncated;
+		}
+		if (image.supercompression == Supercompression::None && level.uncompressedByteLength != level.byteLength) {
+			return ReadResult::Truncated;
+		}
+		image.levels.push_back(data.subspan(level.byteOffset, level.byteLength));
+		image.levelSizes.push_back(level.uncompressedByteLength);
+	}
+	return ReadResult::Success;
+}
+
+bool KTX2::DecodeLevels(const Image& image, Vector<std::byte>& mips)
+{
+	size_t totalSize = 0;
+	for (const auto size : image.levelSizes) {
+		totalSize += size;
+	}
+	mips.resize(totalSize);
+	size_t offset = 0;
+	for (size_t i = 0; i < image.levels.size(); i++) {
+		const std::span<std::byte> destination{ mips.data() + offset, size_t(image.levelSizes[i]) };
+		if (image.supercompression == Supercompression::ZLIB) {
+			if (!Compression::Inflate(image.levels[i], destination)) {
+				return false;
+			}
+		}
+		else {
+			std::copy(image.levels[i].begin(), image.levels[i].end(), destination.begin());
+		}
+		offset += destination.size();
+	}
+	return true;
+}
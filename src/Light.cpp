@@ -87,31 +87,30 @@ void SpotLight::DebugDraw(RavEngine::DebugDrawer& dbg, const Transform& tr) cons
 RavEngine::DirectionalLight::DirectionalLight()
 {
 #if !RVE_SERVER
-	constexpr static auto dim = 4096;
-    {
-        int i = 0;
-        for(auto& pyramid : shadowData.pyramid){
-            pyramid = {dim,Format("Shadowmap Cascasde {} Depth Pyramid", i++)};
-        }
-    }
+    ResizeShadowMaps(shadowMapSize);
+#endif
+}
 
+#if !RVE_SERVER
+Array<RGLTexturePtr,4> RavEngine::DirectionalLight::ResizeShadowMaps(uint32_t dim)
+{
 	auto device = GetApp()->GetDevice();
 
-    {
-        int i = 0;
-        for(auto& shadowMap : shadowData.shadowMap){
-            shadowMap = device->CreateTexture({
-                .usage = {.Sampled = true, .DepthStencilAttachment = true },
-                .aspect = {.HasDepth = true },
-                .width = dim,
-                .height = dim,
-                .format = RGL::TextureFormat::D32SFloat,
-                .debugName = Format("Shadow Cascade {} Texture", i++)
-            });
-        }
+    auto old = shadowData.shadowMap;
+    int i = 0;
+    for(auto& shadowMap : shadowData.shadowMap){
+        shadowMap = device->CreateTexture({
+            .usage = {.Sampled = true, .DepthStencilAttachment = true },
+            .aspect = {.HasDepth = true },
+            .width = dim,
+            .height = dim,
+            .format = RGL::TextureFormat::D32SFloat,
+            .debugName = Format("Shadow Cascade {} Texture", i++)
+        });
     }
-#endif
+    return old;
 }
+#endif
 
 matrix4 RavEngine::SpotLight::CalcProjectionMatrix() const{
     matrix4 ret(1);
@@ -144,69 +143,10 @@ matrix4 RavEngine::SpotLight::CalcViewMatrix(const matrix4& worldTransform) cons
     matrix4 ret(1);
 #if !RVE_SERVER
     // -y is forward for spot lights, so we need to rotate to compensate
-    const auto rotmat = glm::toMat4(quaternion(vector3(-3.14159265358 / 2, 0, 0)));
+    static const auto rotmat = glm::toMat4(quaternion(vector3(-3.14159265358 / 2, 0, 0)));
     auto combinedMat = worldTransform * rotmat;
 
     ret = glm::inverse(combinedMat);
 #endif
     return ret;
 }
-
-RavEngine::SpotLight::SpotLight()
-{
-#if !RVE_SERVER
-    constexpr static auto dim = 4096;
-    shadowData.pyramid = {dim,"Shadowmap Spot Light Depth Pyramid"};
-
-    auto device = GetApp()->GetDevice();
-    
-    shadowData.shadowMap = device->CreateTexture({
-        .usage = {.Sampled = true, .DepthStencilAttachment = true },
-        .aspect = {.HasDepth = true },
-        .width = dim,
-        .height = dim,
-        .format = RGL::TextureFormat::D32SFloat,
-        .debugName = "Spot Light Shadow Texture"
-    });
-#endif
-}
-
-RavEngine::PointLight::PointLight()
-{
-#if !RVE_SERVER
-
-	constexpr static auto dim = 1024;
-    {
-        int i = 0;
-        for (auto& facePyramid : shadowData.cubePyramids) {
-            facePyramid = { dim, Format("Shadowmap Depth Pyramid Face {} Point Light", i++) };
-        }
-    }
-	auto device = GetApp()->GetDevice();
-
-    {
-        int i = 0;
-        for (auto& shadowMap : shadowData.cubeShadowmaps) {
-            shadowMap = device->CreateTexture({
-                .usage = {.TransferSource = true, .Sampled = true, .DepthStencilAttachment = true },
-                .aspect = {.HasDepth = true },
-                .width = dim,
-                .height = dim,
-                .format = RGL::TextureFormat::D32SFloat,
-                .debugName = Format("Point Light Shadow Texture Face {}", i++)
-            });
-        }
-    }
-
-	shadowData.mapCube = device->CreateTexture({
-		.usage = {.TransferDestination = true, .Sampled = true, .DepthStencilAttachment = true },
-		.aspect = {.HasDepth = true },
-		.width = dim,
-		.height = dim,
-		.arrayLayers = 6,
-		.format = RGL::TextureFormat::D32SFloat,
-		.isCubemap = true,
-		.debugName = "Shadow Texture Cubemap Point Light"
-	});
-#endif
-}
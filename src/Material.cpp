@@ -153,10 +153,12 @@ namespace RavEngine {
                 .depthFunction = hasDepthPrepass? RGL::DepthCompareFunction::Equal : config.depthCompareFunction,
             },
             .pipelineLayout = pipelineLayout,
+            .variableShadingRate = config.variableShadingRate,
             .debugName = Format("Material {}, {}",vsh_name, fsh_name)
         };
 
         renderPipeline = device->CreateRenderPipeline(rpd);
+        rpd.variableShadingRate = false;    // depth-only passes shade every pixel
 
         // invert some settings for the shadow pipeline
         if (hasDepthPrepass) {
@@ -178,6 +180,13 @@ namespace RavEngine {
         {
             auto rpd_cpy = rpd;
             trimVertexAttributes(rpd_cpy.vertexConfig,depthPrepassAttributes);
+            // the prepass also records which entity covers each pixel
+            rpd_cpy.colorBlendConfig.attachments = {
+                {
+                    .format = RenderTargetCollection::entityIDFormat,
+                    .colorWriteMask = hasDepthPrepass ? RGL::ColorWriteMask::RGBA : RGL::ColorWriteMask(0),
+                }
+            };
             depthPrepassPipeline = device->CreateRenderPipeline(rpd_cpy);
         }
 
@@ -252,6 +261,13 @@ std::vector<RGL::PipelineLayoutDescriptor::LayoutBindingDesc> augmentLitMaterial
                 .stageFlags = RGL::BindingVisibility::Fragment
             }
         );
+        configBindingsCopy.push_back(
+            {
+                .binding = 31,
+                .type = RGL::BindingType::StorageBuffer,
+                .stageFlags = RGL::BindingVisibility::Fragment
+            }
+        );
         if (opacityMode == OpacityMode::Transparent){ // storage images for MLAB
             configBindingsCopy.push_back(
                                          {
@@ -340,6 +356,7 @@ std::vector<RGL::PipelineLayoutDescriptor::LayoutBindingDesc> augmentLitMaterial
             .cullMode = options.cullMode,
             .opacityMode = options.opacityMode,
             .requiredAttributes = options.requiredAttributes,
+            .variableShadingRate = true,
         }
     )
     {
@@ -454,6 +471,13 @@ std::vector<RGL::PipelineLayoutDescriptor::LayoutBindingDesc> augmentLitMaterial
 
         return { pipeline, depthPrepassAttributes };
     }
+
+    const Material* RavEngine::MaterialVariant::GetBaseMaterial() const
+    {
+        return std::visit([](const auto& m) -> const Material* {
+            return m.get();
+        }, variant);
+    }
 }
 #endif
 
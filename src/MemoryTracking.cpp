@@ -0,0 +1,118 @@
+#include "MemoryTracking.hpp"
+#include "App.hpp"
+#include "World.hpp"
+#include "Profile.hpp"
+#include "MeshAsset.hpp"
+#include "MeshAssetSkinned.hpp"
+#include "Texture.hpp"
+#include "Format.hpp"
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#if !RVE_SERVER
+#include "RenderEngine.hpp"
+#endif
+
+using namespace RavEngine;
+
+struct MemoryTracking::Pool {
+	std::string name;		// Tracy keeps the pointer, so this must not move
+	std::atomic<size_t> bytes = 0, count = 0;
+};
+
+namespace {
+	// never destroyed, since allocations may be freed while statics are torn down
+	struct PoolRegistry {
+		std::mutex mtx;
+		Vector<std::unique_ptr<MemoryTracking::Pool>> pools;
+	};
+	PoolRegistry& Registry() {
+		static auto registry = new PoolRegistry;
+		return *registry;
+	}
+}
+
+MemoryTracking::Pool* MemoryTracking::GetPool(std::string_view name)
+{
+	auto& registry = Registry();
+	std::lock_guard guard(registry.mtx);
+	for (const auto& pool : registry.pools) {
+		if (pool->name == name) {
+			return pool.get();
+		}
+	}
+	auto pool = std::make_unique<Pool>();
+	pool->name = name;
+	return registry.pools.emplace_back(std::move(pool)).get();
+}
+
+void MemoryTracking::Allocated(Pool* pool, const void* ptr, size_t bytes)
+{
+	pool->bytes.fetch_add(bytes, std::memory_order_relaxed);
+	pool->count.fetch_add(1, std::memory_order_relaxed);
+	RVE_PROFILE_ALLOC(ptr, bytes, pool->name.c_str());
+}
+
+void MemoryTracking::Freed(Pool* pool, const void* ptr, size_t bytes)
+{
+	pool->bytes.fetch_sub(bytes, std::memory_order_relaxed);
+	pool->count.fetch_sub(1, std::memory_order_relaxed);
+	RVE_PROFILE_FREE(ptr, pool->name.c_str());
+}
+
+MemoryReport App::GetMemoryReport()
+{
+	MemoryReport report;
+	{
+		auto& registry = Registry();
+		std::lock_guard guard(registry.mtx);
+		for (const auto& pool : registry.pools) {
+			report.pools.push_back({ pool->name, pool->bytes.load(std::memory_order_relaxed), pool->count.load(std::memory_order_relaxed) });
+		}
+	}
+
+	for (const auto& world : loadedWorlds) {
+		world->AddComponentMemory(report.componentSets);
+	}
+
+	auto addCache = [&report](const char* name, MemoryReport::Item usage) {
+		usage.name = name;
+		report.assetCaches.push_back(std::move(usage));
+	};
+	addCache("MeshAsset", MeshAsset::Manager::GetMemoryUsage());
+	addCache("MeshAssetSkinned", MeshAssetSkinned::Manager::GetMemoryUsage());
+	addCache("Texture", Texture::Manager::GetMemoryUsage());
+
+#if !RVE_SERVER
+	report.vramInUseMB = GetRenderEngine().GetCurrentVRAMUse();
+#endif
+
+	auto bySize = [](const MemoryReport::Item& a, const MemoryReport::Item& b) {
+		return a.bytes > b.bytes;
+	};
+	std::sort(report.pools.begin(), report.pools.end(), bySize);
+	std::sort(report.componentSets.begin(), report.componentSets.end(), bySize);
+	std::sort(report.assetCaches.begin(), report.assetCaches.end(), bySize);
+	return report;
+}
+
+std::string MemoryReport::ToString() const
+{
+	std::string out;
+	auto section = [&out](const char* title, const Vector<Item>& items) {
+		size_t total = 0;
+		for (const auto& item : items) {
+			total += item.bytes;
+		}
+		out += Format("{} ({:.2f} MB)\n", title, total / (1024.0 * 1024.0));
+		for (const auto& item : items) {
+			out += Format("  {:<48} {:>10.2f} MB {:>10}\n", item.name, item.bytes / (1024.0 * 1024.0), item.count);
+		}
+	};
+	section("Pools", pools);
+	section("Component sets", componentSets);
+	section("Asset caches", assetCaches);
+	out += Format("VRAM in use: {} MB\n", vramInUseMB);
+	return out;
+}
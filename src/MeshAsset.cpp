@@ -2,12 +2,17 @@
 #include "Common3D.hpp"
 #include "App.hpp"
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
 #include "Debug.hpp"
 #include "VirtualFileSystem.hpp"
+#include "MeshEncoding.hpp"
+#include <meshoptimizer.h>
 #if !RVE_SERVER
     #include "RenderEngine.hpp"
     #include <RGL/Buffer.hpp>
     #include <RGL/Device.hpp>
+    #include "Texture.hpp"
 #endif
 
 using namespace RavEngine;
@@ -20,71 +25,247 @@ MeshPart RavEngine::MeshAsset::DeserializeMesh(const istream& stream)
 	return {};
 }
 
-std::pair<MeshPart, uint32_t> RavEngine::MeshAsset::DeserializeMeshFromMemory(const std::span<uint8_t> mem)
+std::pair<MeshPartView, uint32_t> RavEngine::MeshAsset::ViewMeshInMemory(const std::span<const uint8_t> mem)
 {
-	uint8_t* fp = mem.data();
-	SerializedMeshDataHeader header = *reinterpret_cast<SerializedMeshDataHeader*>(fp);
-	fp += sizeof(SerializedMeshDataHeader);
+	if (mem.size() < sizeof(SerializedMeshDataHeader)) {
+		Debug::Fatal("Data is too short to be a mesh!");
+	}
+	const auto& header = *reinterpret_cast<const SerializedMeshDataHeader*>(mem.data());
 
 	// check header
 	if (strncmp(header.header.data(), "rvem", sizeof("rvem") - 1) != 0) {
 		Debug::Fatal("Header does not match, data is not a mesh!");
 	}
+	// every section is a multiple of 4 bytes long, so the sections are aligned if the data is
+	Debug::Assert(reinterpret_cast<uintptr_t>(mem.data()) % alignof(SerializedMeshDataHeader) == 0, "Mesh data is not aligned");
 
-	MeshPart mesh;
-	mesh.indices.reserve(header.numIndicies);
-	mesh.ReserveVerts(header.numVertices);
-	
-	auto loadMeshProperty = [&fp, &header](auto&& destination) {
-		for (int i = 0; i < header.numVertices; i++) {
-			std::remove_reference_t<decltype(destination[0])> prop = *reinterpret_cast<decltype(prop)*>(fp);
-			destination.push_back(prop);
-			fp += sizeof(prop);
+	MeshPartView mesh;
+	size_t offset = sizeof(SerializedMeshDataHeader);
+	auto viewMeshProperty = [&mem, &offset]<typename T>(basic_immutable_span<T>& destination, uint32_t count) {
+		if (offset + size_t(count) * sizeof(T) > mem.size()) {
+			Debug::Fatal("Mesh data is truncated!");
 		}
+		destination = { reinterpret_cast<const T*>(mem.data() + offset), count };
+		offset += size_t(count) * sizeof(T);
 	};
 
-	// load vertices
+	// view vertices
 	if (header.attributes & SerializedMeshDataHeader::hasPositionsBit) {
 		mesh.attributes.position = true;
-		loadMeshProperty(mesh.positions);
+		viewMeshProperty(mesh.positions, header.numVertices);
 	}
 	if (header.attributes & SerializedMeshDataHeader::hasNormalsBit) {
 		mesh.attributes.normal = true;
-		loadMeshProperty(mesh.normals);
+		viewMeshProperty(mesh.normals, header.numVertices);
 	}
 	if (header.attributes & SerializedMeshDataHeader::hasTangentsBit) {
 		mesh.attributes.tangent = true;
-		loadMeshProperty(mesh.tangents);
+		viewMeshProperty(mesh.tangents, header.numVertices);
 	}
 	if (header.attributes & SerializedMeshDataHeader::hasBitangentsBit) {
 		mesh.attributes.bitangent = true;
-		loadMeshProperty(mesh.bitangents);
+		viewMeshProperty(mesh.bitangents, header.numVertices);
 	}
 	if (header.attributes & SerializedMeshDataHeader::hasUV0Bit) {
 		mesh.attributes.uv0 = true;
-		loadMeshProperty(mesh.uv0);
+		viewMeshProperty(mesh.uv0, header.numVertices);
 	}
 	if (header.attributes & SerializedMeshDataHeader::hasLightmapUVBit) {
 		mesh.attributes.lightmapUV = true;
-		loadMeshProperty(mesh.lightmapUVs);
+		viewMeshProperty(mesh.lightmapUVs, header.numVertices);
+	}
+
+	viewMeshProperty(mesh.indices, header.numIndicies);
+
+	if (header.attributes & SerializedMeshDataHeader::hasMeshletsBit) {
+		basic_immutable_span<uint32_t> numMeshlets;
+		viewMeshProperty(numMeshlets, 1);
+		viewMeshProperty(mesh.meshlets, numMeshlets[0]);
+	}
+
+	return { mesh, uint32_t(offset) };
+}
+
+std::pair<MeshPartView, uint32_t> RavEngine::MeshAsset::ReadMeshInMemory(const std::span<const uint8_t> mem, MeshPart& storage)
+{
+	if (mem.size() < sizeof(SerializedMeshDataHeader) + sizeof(MeshEncoding::EncodedMeshHeader) || reinterpret_cast<const SerializedMeshDataHeader*>(mem.data())->header != MeshEncoding::magic) {
+		return ViewMeshInMemory(mem);
+	}
+	const auto& header = *reinterpret_cast<const SerializedMeshDataHeader*>(mem.data());
+	const auto& encoded = *reinterpret_cast<const MeshEncoding::EncodedMeshHeader*>(mem.data() + sizeof(SerializedMeshDataHeader));
+	size_t offset = sizeof(SerializedMeshDataHeader) + sizeof(MeshEncoding::EncodedMeshHeader);
+	auto nextStream = [&mem, &offset](uint32_t size) {
+		if (offset + MeshEncoding::Padded(size) > mem.size()) {
+			Debug::Fatal("Mesh data is truncated!");
+		}
+		auto stream = mem.subspan(offset, size);
+		offset += MeshEncoding::Padded(size);
+		return stream;
+	};
+	const auto positionStream = nextStream(encoded.positionStreamSize);
+	const auto attributeStream = nextStream(encoded.attributeStreamSize);
+	const auto indexStream = nextStream(encoded.indexStreamSize);
+
+	const auto numVerts = header.numVertices;
+	Vector<float> bitangentSigns(numVerts);
+	storage.positions.resize(numVerts);
+	if (encoded.quantizedPositions) {
+		Vector<MeshEncoding::QuantizedPosition> positions(numVerts);
+		if (meshopt_decodeVertexBuffer(positions.data(), numVerts, sizeof(positions[0]), positionStream.data(), positionStream.size()) != 0) {
+			Debug::Fatal("Mesh positions are corrupt!");
+		}
+		for (uint32_t i = 0; i < numVerts; i++) {
+			storage.positions[i] = {
+				MeshEncoding::DequantizeUnorm16(positions[i].x, encoded.boundsMin.x, encoded.boundsExtent.x),
+				MeshEncoding::DequantizeUnorm16(positions[i].y, encoded.boundsMin.y, encoded.boundsExtent.y),
+				MeshEncoding::DequantizeUnorm16(positions[i].z, encoded.boundsMin.z, encoded.boundsExtent.z),
+			};
+			bitangentSigns[i] = positions[i].bitangentSign ? -1.f : 1.f;
+		}
+	}
+	else {
+		Vector<MeshEncoding::FullPosition> positions(numVerts);
+		if (meshopt_decodeVertexBuffer(positions.data(), numVerts, sizeof(positions[0]), positionStream.data(), positionStream.size()) != 0) {
+			Debug::Fatal("Mesh positions are corrupt!");
+		}
+		for (uint32_t i = 0; i < numVerts; i++) {
+			storage.positions[i] = positions[i].position;
+			bitangentSigns[i] = positions[i].bitangentSign;
+		}
 	}
 
-	for (int i = 0; i < header.numIndicies; i++) {
-		uint32_t ind = *reinterpret_cast<decltype(ind)*>(fp);
-		mesh.indices.push_back(ind);
+	Vector<MeshEncoding::QuantizedAttributes> attributes(numVerts);
+	if (meshopt_decodeVertexBuffer(attributes.data(), numVerts, sizeof(attributes[0]), attributeStream.data(), attributeStream.size()) != 0) {
+		Debug::Fatal("Mesh attributes are corrupt!");
+	}
+	const bool hasLightmapUVs = header.attributes & SerializedMeshDataHeader::hasLightmapUVBit;
+	storage.normals.resize(numVerts);
+	storage.tangents.resize(numVerts);
+	storage.bitangents.resize(numVerts);
+	storage.uv0.resize(numVerts);
+	storage.lightmapUVs.resize(hasLightmapUVs ? numVerts : 0);
+	for (uint32_t i = 0; i < numVerts; i++) {
+		storage.normals[i] = MeshEncoding::DecodeOctahedral(attributes[i].normal);
+		storage.tangents[i] = MeshEncoding::DecodeOctahedral(attributes[i].tangent);
+		storage.bitangents[i] = bitangentSigns[i] * glm::cross(storage.normals[i], storage.tangents[i]);
+		storage.uv0[i] = MeshEncoding::DecodeHalf2(attributes[i].uv0);
+		if (hasLightmapUVs) {
+			storage.lightmapUVs[i] = MeshEncoding::DecodeHalf2(attributes[i].lightmapUV);
+		}
+	}
 
-		fp += sizeof(ind);
+	storage.indices.resize(header.numIndicies);
+	if (meshopt_decodeIndexBuffer(storage.indices.data(), storage.indices.size(), indexStream.data(), indexStream.size()) != 0) {
+		Debug::Fatal("Mesh indices are corrupt!");
+	}
+
+	storage.meshlets.clear();
+	if (header.attributes & SerializedMeshDataHeader::hasMeshletsBit) {
+		uint32_t numMeshlets;
+		if (offset + sizeof(numMeshlets) > mem.size()) {
+			Debug::Fatal("Mesh data is truncated!");
+		}
+		std::memcpy(&numMeshlets, mem.data() + offset, sizeof(numMeshlets));
+		offset += sizeof(numMeshlets);
+		if (offset + size_t(numMeshlets) * sizeof(Meshlet) > mem.size()) {
+			Debug::Fatal("Mesh data is truncated!");
+		}
+		const auto meshlets = reinterpret_cast<const Meshlet*>(mem.data() + offset);
+		storage.meshlets.assign(meshlets, meshlets + numMeshlets);
+		offset += size_t(numMeshlets) * sizeof(Meshlet);
 	}
 
-	return { mesh, fp - mem.data()};
+	storage.attributes = {};
+	storage.attributes.position = true;
+	storage.attributes.normal = true;
+	storage.attributes.tangent = true;
+	storage.attributes.bitangent = true;
+	storage.attributes.uv0 = true;
+	storage.attributes.lightmapUV = hasLightmapUVs;
+	return { MeshPartView(storage), uint32_t(offset) };
+}
+
+static MeshPart CopyMeshPart(const MeshPartView& view) {
+	MeshPart mesh;
+	mesh.positions.assign(view.positions.begin(), view.positions.end());
+	mesh.normals.assign(view.normals.begin(), view.normals.end());
+	mesh.tangents.assign(view.tangents.begin(), view.tangents.end());
+	mesh.bitangents.assign(view.bitangents.begin(), view.bitangents.end());
+	mesh.uv0.assign(view.uv0.begin(), view.uv0.end());
+	mesh.lightmapUVs.assign(view.lightmapUVs.begin(), view.lightmapUVs.end());
+	mesh.indices.assign(view.indices.begin(), view.indices.end());
+	mesh.meshlets.assign(view.meshlets.begin(), view.meshlets.end());
+	mesh.attributes = view.attributes;
+	return mesh;
+}
+
+std::pair<MeshPart, uint32_t> RavEngine::MeshAsset::DeserializeMeshFromMemory(const std::span<uint8_t> mem)
+{
+	MeshPart storage;
+	auto view = ReadMeshInMemory(mem, storage);
+	return { CopyMeshPart(view.first), view.second };
+}
+
+void MeshAsset::InitializeFromSerializedMesh(const MeshPartView& mesh, const MeshAssetOptions& options){
+	if (options.keepInSystemRAM) {
+		systemRAMcopy = CopyMeshPart(mesh);
+	}
+	InitializeFromRawMeshView(mesh, options);
 }
 
 MeshAsset::MeshAsset(const string& name, const MeshAssetOptions& options){
 	string dir = Format("meshes/{}.rvem", name);
-	auto str = GetApp()->GetResources().FileContentsAt(dir.c_str());
+	// uploaded straight from the file's bytes, which are mapped instead of read when the file is loose on disk
+	const auto file = GetApp()->GetResources().MapFile(dir.c_str());
+	const std::span<const uint8_t> str{ reinterpret_cast<const uint8_t*>(file.Data().data()), file.Data().size() };
+
+	MeshPart decoded;
+	auto mesh = ReadMeshInMemory(str, decoded);
+	InitializeFromSerializedMesh(mesh.first, options);
+
+	// load the LODs packed after the base mesh
+	const auto numAdditionalLODs = reinterpret_cast<const SerializedMeshDataHeader*>(str.data())->numAdditionalLODs;
+	uint32_t offset = mesh.second;
+	packedLODs.reserve(numAdditionalLODs);
+	for (uint8_t i = 0; i < numAdditionalLODs; i++) {
+		float minDistance = *reinterpret_cast<const float*>(str.data() + offset);
+		offset += sizeof(minDistance);
+
+		auto lod = ReadMeshInMemory({ str.data() + offset, str.size() - offset }, decoded);
+		offset += lod.second;
+		auto lodAsset = options.keepInSystemRAM ? New<MeshAsset>(CopyMeshPart(lod.first), options) : New<MeshAsset>(lod.first, options);
+		packedLODs.push_back({ lodAsset, minDistance });
+	}
 
-	auto mesh = DeserializeMeshFromMemory(str);
-	InitializeFromRawMesh(mesh.first, options);
+	// then the impostor, if one was baked
+	if (reinterpret_cast<const SerializedMeshDataHeader*>(str.data())->impostorFramesPerSide > 0) {
+		ImpostorEncoding::ImpostorHeader header;
+		std::memcpy(&header, str.data() + offset, sizeof(header));
+		offset += sizeof(header);
+
+		auto quad = ReadMeshInMemory({ str.data() + offset, str.size() - offset }, decoded);
+		offset += quad.second;
+		auto quadAsset = options.keepInSystemRAM ? New<MeshAsset>(CopyMeshPart(quad.first), options) : New<MeshAsset>(quad.first, options);
+		packedImpostor = PackedImpostor{ quadAsset, header };
+
+#if !RVE_SERVER
+		if (options.uploadToGPU) {
+			const auto atlasBytes = ImpostorEncoding::AtlasBytes(header);
+			auto makeAtlas = [&](const char* debugName) {
+				auto atlas = New<RuntimeTexture>(header.atlasSize, header.atlasSize, Texture::Config{
+					.mipLevels = header.mipLevels,
+					.initialData = {{str.data() + offset, atlasBytes}},
+					.format = RGL::TextureFormat::RGBA8_Unorm,
+					.debugName = debugName,
+				});
+				offset += atlasBytes;
+				return atlas;
+			};
+			packedImpostor->albedoAtlas = makeAtlas("Impostor albedo atlas");
+			packedImpostor->normalDepthAtlas = makeAtlas("Impostor normal atlas");
+		}
+#endif
+	}
 }
 
 MeshAsset::MeshAsset(const Filesystem::Path& path, const MeshAssetOptions& opt){
@@ -118,6 +299,9 @@ void MeshAsset::InitializeFromMeshPartFragments(const RavEngine::Vector<MeshPart
 	allMeshes.indices.reserve(ti);
 	
 	MeshAttributes attrCheck = meshes[0].attributes;
+
+	// the combined mesh can only be culled per-meshlet if every fragment was clustered
+	const bool keepMeshlets = std::all_of(meshes.begin(), meshes.end(), [](const MeshPart& mesh) { return mesh.meshlets.size() > 0; });
 	
 	uint32_t baseline_index = 0;
 	for(const auto& mesh : meshes){
@@ -135,6 +319,12 @@ void MeshAsset::InitializeFromMeshPartFragments(const RavEngine::Vector<MeshPart
 		copyProp(allMeshes.uv0, mesh.uv0);
 		copyProp(allMeshes.lightmapUVs, mesh.lightmapUVs);
 		
+		if (keepMeshlets) {
+			for (auto meshlet : mesh.meshlets) {
+				meshlet.indexStart += allMeshes.indices.size();
+				allMeshes.meshlets.push_back(meshlet);
+			}
+		}
 		for (int i = 0; i < mesh.indices.size(); i++) {
 			allMeshes.indices.push_back(mesh.indices[i] + baseline_index);	//must recompute index here
 		}
@@ -153,6 +343,7 @@ void MeshAsset::InitializeFromRawMesh(const MeshPart& allMeshes, const MeshAsset
 
 void MeshAsset::InitializeFromRawMeshView(const MeshPartView& allMeshes, const MeshAssetOptions& options){
 	attributes = allMeshes.attributes;
+	meshlets.assign(allMeshes.meshlets.begin(), allMeshes.meshlets.end());
 
     // calculate bounding box
     for(const auto& pos : allMeshes.positions){
@@ -178,3 +369,13 @@ void MeshAsset::InitializeFromRawMeshView(const MeshPartView& allMeshes, const M
 #endif
     }
 }
+
+size_t MeshAsset::GetMemoryFootprint() const
+{
+	constexpr size_t vertexSize = sizeof(VertexPosition_t) + sizeof(VertexNormal_t) + sizeof(VertexTangent_t) + sizeof(VertexBitangent_t) + 2 * sizeof(VertexUV_t);
+	size_t bytes = systemRAMcopy.NumVerts() * vertexSize + systemRAMcopy.indices.size() * sizeof(uint32_t) + meshlets.capacity() * sizeof(Meshlet);
+#if !RVE_SERVER
+	bytes += totalVerts * vertexSize + totalIndices * sizeof(uint32_t);
+#endif
+	return bytes;
+}
@@ -31,11 +31,13 @@ MeshAssetSkinned::MeshAssetSkinned(const std::string& path) // we intentionally
 		Debug::Fatal("No asset at {}",fullpath);
 	}
 	
-	auto str = GetApp()->GetResources().FileContentsAt(fullpath.c_str());
+	const auto file = GetApp()->GetResources().MapFile(fullpath.c_str());
+	const std::span<const uint8_t> str{ reinterpret_cast<const uint8_t*>(file.Data().data()), file.Data().size() };
 
 
-	auto mesh = DeserializeMeshFromMemory(str);
-	InitializeFromRawMesh(mesh.first, MeshAssetOptions{ false,true });	// this intializes the staticmesh part
+	MeshPart decoded;
+	auto mesh = ReadMeshInMemory(str, decoded);
+	InitializeFromRawMeshView(mesh.first, MeshAssetOptions{ false,true });	// this intializes the staticmesh part
 	
 	
 #if !RVE_SERVER
@@ -46,17 +48,12 @@ MeshAssetSkinned::MeshAssetSkinned(const std::string& path) // we intentionally
 		Debug::Fatal("Mesh is probably not a skinned mesh");
 	}
 
-	uint8* fp = str.data() + mesh.second;
+	const uint8_t* fp = str.data() + mesh.second;
 	auto size = ((str.data() + str.size()) - fp) / sizeof(VertexWeights);
 	Debug::Assert(size == GetNumVerts(),"Skin does not have vertex weights for every vertex, input file is corrupt");
 
-	//make gpu version
-    std::vector<VertexWeights> weightsgpu;
-	weightsgpu.reserve(size);
-	for (int i = 0; i < size; i++) {
-		VertexWeights weights = *(reinterpret_cast<VertexWeights*>(fp)+i);
-		weightsgpu.push_back(weights);
-	}
+	// the weights are uploaded straight from the file's bytes
+	std::span<const VertexWeights> weightsgpu{ reinterpret_cast<const VertexWeights*>(fp), size };
 
 	//map to GPU
 	weightsBuffer = GetApp()->GetDevice()->CreateBuffer({
@@ -66,7 +63,7 @@ MeshAssetSkinned::MeshAssetSkinned(const std::string& path) // we intentionally
 		RGL::BufferAccess::Private,
 		{.Writable = false}
 	});
-	weightsBuffer->SetBufferData({ weightsgpu.data(),weightsgpu.size() * sizeof(decltype(weightsgpu)::value_type)});
+	weightsBuffer->SetBufferData({ weightsgpu.data(),weightsgpu.size_bytes()});
 #endif
 }
 
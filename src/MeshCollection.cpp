@@ -3,6 +3,7 @@
 #include "MeshAsset.hpp"
 #include "MeshAssetSkinned.hpp"
 #include "MeshAllocation.hpp"
+#include <cmath>
 
 namespace RavEngine {
 	MeshCollectionStatic::MeshCollectionStatic(std::span<Entry> meshes)
@@ -21,22 +22,32 @@ namespace RavEngine {
 	}
 	MeshCollectionStatic::MeshCollectionStatic(Ref<MeshAsset> mesh)
 	{
-		AddMesh({mesh, std::numeric_limits<float>::infinity()});
+		const auto packedLODs = mesh->GetPackedLODs();
+		Reserve(packedLODs.size() + 1);
+		// with LODs, the base mesh must be selectable from distance 0
+		AddMesh({mesh, packedLODs.empty() ? std::numeric_limits<float>::infinity() : 0});
+		for (const auto& lod : packedLODs) {
+			AddMesh({ lod.mesh, lod.minDistance });
+		}
 	}
 
 	void MeshCollectionStatic::AddMesh(const Entry& m)
 	{
 		meshes.push_back(m.mesh);
 		lodDistances.push_back(m.minDistance);
-		auto attrCheck = m.mesh->GetAttributes();
-		for (const auto& mesh : meshes) {
-			Debug::Assert(attrCheck == mesh->GetAttributes(), "Mesh attributes do not match!");
+		if (m.mesh) {
+			auto attrCheck = m.mesh->GetAttributes();
+			for (const auto& mesh : meshes) {
+				Debug::Assert(!mesh || attrCheck == mesh->GetAttributes(), "Mesh attributes do not match!");
+			}
 		}
+		UpdateDrawSlots();
 	}
 	void MeshCollectionStatic::RemoveMeshAtIndex(uint16_t idx)
 	{
 		meshes.erase(meshes.begin() + idx);
 		lodDistances.erase(lodDistances.begin() + idx);
+		UpdateDrawSlots();
 	}
 
 	void MeshCollectionStatic::Reserve(uint16_t size)
@@ -49,12 +60,78 @@ namespace RavEngine {
 	{
 		meshes.resize(size);
 		lodDistances.Resize(size);
+		UpdateDrawSlots();
+	}
+
+	void MeshCollectionStatic::UpdateDrawSlots()
+	{
+		uint32_t totalMeshlets = 0;
+		for (const auto& mesh : meshes) {
+			if (mesh) {
+				totalMeshlets += mesh->GetMeshlets().size();
+			}
+		}
+
+		lodDrawSlots.Resize(meshes.size());
+		meshletData.Resize(totalMeshlets);
+		numDrawSlots = 0;
+		uint32_t firstMeshlet = 0;
+		for (uint32_t i = 0; i < meshes.size(); i++) {
+			const auto meshlets = meshes[i] ? meshes[i]->GetMeshlets() : std::span<const Meshlet>{};
+			lodDrawSlots.SetValueAt(i, {
+				.firstSlot = numDrawSlots,
+				.firstMeshlet = firstMeshlet,
+				.numMeshlets = uint32_t(meshlets.size()),
+			});
+			for (const auto& meshlet : meshlets) {
+				meshletData.SetValueAt(firstMeshlet++, meshlet);
+			}
+			numDrawSlots += std::max<uint32_t>(meshlets.size(), 1);
+		}
 	}
 
 	float MeshCollectionStatic::GetRadius() const
 	{
-		Debug::Assert(meshes.size() > 0, "Mesh collection is empty!");
-		return meshes.front()->GetRadius();
+		for (const auto& mesh : meshes) {
+			if (mesh) {
+				return mesh->GetRadius();
+			}
+		}
+		Debug::Fatal("Mesh collection is empty!");
+		return 0;
+	}
+
+	MeshAttributes MeshCollectionStatic::GetAttributes() const
+	{
+		for (const auto& mesh : meshes) {
+			if (mesh) {
+				return mesh->GetAttributes();
+			}
+		}
+		Debug::Fatal("Mesh collection is empty!");
+		return {};
+	}
+
+	void MeshCollectionStatic::SetImpostor(Ref<MeshAsset> quad, Ref<MaterialInstance> material, float minDistance)
+	{
+		ClearImpostor();
+		// a lone mesh is at an infinite distance, which the empty LOD could never beat
+		if (meshes.size() == 1 && std::isinf(lodDistances[0])) {
+			lodDistances.SetValueAt(0, 0);
+		}
+		impostor.emptyLOD = uint32_t(meshes.size());
+		AddMesh({ nullptr, minDistance });
+		// LOD 0 is what is drawn when no other LOD's distance is reached, so the empty LOD must come first
+		impostor.collection = New<MeshCollectionStatic>(std::initializer_list<Entry>{ {nullptr, 0}, { quad, minDistance } });
+		impostor.material = material;
+	}
+
+	void MeshCollectionStatic::ClearImpostor()
+	{
+		if (impostor.collection) {
+			RemoveMeshAtIndex(impostor.emptyLOD);
+		}
+		impostor = {};
 	}
 
 
@@ -10,38 +10,533 @@
 #include "App.hpp"
 #include "MeshAsset.hpp"
 #include "RenderEngine.hpp"
+#include "Queue.hpp"
+#include "Map.hpp"
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <tuple>
 
 using namespace std;
 using namespace RavEngine;
 
-NavMeshComponent::NavMeshComponent(Ref<MeshAsset> mesh, Options opt){
+namespace {
+    // the mesh in the form Recast reads. Tile builds share it, so it is replaced rather than modified.
+    struct SourceGeometry {
+        Vector<float> verts;
+        Vector<int> indices;
+        Vector<Vector<int>> tileTriangles;   // in tiled mode, the triangles overlapping each tile and its border, by tile index
+    };
+
+    struct Obstacle {
+        uint32_t id;
+        Bounds box;
+    };
+
+    /**
+     Run the Recast pipeline over the triangles and make Detour data from it
+     @param cfg the configuration, with the bounds and border of the area to build
+     @param indices the triangles to rasterize, three per triangle, into the geometry's verts
+     @return the Detour data, or nullptr if the area has nothing walkable
+     */
+    unsigned char* BuildNavData(const rcConfig& cfg, const NavMeshComponent::Options& opt, const SourceGeometry& geometry, std::span<const int> indices, std::span<const Obstacle> obstacles, int tileX, int tileY, int& navDataSize) {
+        rcContext ctx(0);
+
+        // step 2: rasterize input polygon
+        auto solid = rcAllocHeightfield();
+        if (!solid){
+            Debug::Fatal("Build nagivation failed: out of memory");
+        }
+        if (!rcCreateHeightfield(&ctx, *solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch)){
+            Debug::Fatal("Height field generation failed");
+        }
+
+        const int ntris = Debug::AssertSize<decltype(ntris)>(indices.size()/3);
+        const int nverts = Debug::AssertSize<int>(geometry.verts.size() / 3);
+        // allocate array to hold triangle area types ( = number of triangles)
+        Vector<unsigned char> triareas(ntris, 0);
+
+        rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, geometry.verts.data(), nverts, indices.data(), ntris, triareas.data());
+        if(!rcRasterizeTriangles(&ctx, geometry.verts.data(), nverts, indices.data(), triareas.data(), ntris, *solid)){
+            Debug::Fatal("Could not rasterize triangles for navigation");
+        }
+
+        // step 3: filter walkable areas
+        rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *solid);
+        rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid);
+        rcFilterWalkableLowHeightSpans(&ctx,cfg.walkableHeight, *solid);
+
+        // step 4: partition walkable surfaces to simple regions
+        auto chf = rcAllocCompactHeightfield();
+        if (!chf){
+            Debug::Fatal("Failed to allocate compact height field");
+        }
+        if (!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid, *chf)){
+            Debug::Fatal("Compact height field generation failed");
+        }
+        rcFreeHeightField(solid);   // don't need this anymore
+        solid = nullptr;
+
+        // Erode walkable area by agent radius
+        if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *chf)){
+            Debug::Fatal("Walkable radius erode failed");
+        }
+
+        for (const auto& obstacle : obstacles) {
+            rcMarkBoxArea(&ctx, obstacle.box.min, obstacle.box.max, RC_NULL_AREA, *chf);
+        }
+
+        switch(opt.partitionMethod){
+            case NavMeshComponent::Options::Watershed:{
+                if (!rcBuildDistanceField(&ctx, *chf)){
+                    Debug::Fatal("Distance field generation failed");
+                }
+                if (!rcBuildRegions(&ctx,*chf,cfg.borderSize,cfg.minRegionArea,cfg.mergeRegionArea)){
+                    Debug::Fatal("Region generation failed");
+                }
+            }
+            break;
+            case NavMeshComponent::Options::Monotone:{
+                if (!rcBuildRegionsMonotone(&ctx,*chf,cfg.borderSize,cfg.minRegionArea,cfg.mergeRegionArea)){
+                    Debug::Fatal("Monotone region generation failed");
+                }
+            }
+            break;
+            case NavMeshComponent::Options::Layer:{
+                if (!rcBuildLayerRegions(&ctx,*chf,cfg.borderSize,cfg.minRegionArea)){
+                    Debug::Fatal("Layer region generation failed");
+                }
+            }
+            break;
+        }
+
+        // step 5: trace and simplify region contours
+        auto cset = rcAllocContourSet();
+        if (!cset){
+            Debug::Fatal("Could not allocate contour set");
+        }
+        if (!rcBuildContours(&ctx, *chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *cset)){
+            Debug::Fatal("Contour generation failed");
+        }
+
+        // step 6: build polygon mesh from contours
+        auto pmesh = rcAllocPolyMesh();
+        if (!pmesh){
+            Debug::Fatal("PolyMesh allocation failed");
+        }
+        if(!rcBuildPolyMesh(&ctx, *cset, cfg.maxVertsPerPoly, *pmesh)){
+            Debug::Fatal("Contour triangulation failed");
+        }
+        // TODO: fix - for now, set all poly flags to 1 so that the filter includes them
+        for(int i = 0; i < pmesh->npolys; i++){
+            pmesh->flags[i] = 1;
+        }
+
+        // step 7: create detail mesh to approximate height on each polygon
+        auto dmesh = rcAllocPolyMeshDetail();
+        if (!dmesh){
+            Debug::Fatal("Detail mesh allocation failed");
+        }
+        if (!rcBuildPolyMeshDetail(&ctx, *pmesh, *chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *dmesh)){
+            Debug::Fatal("Detail mesh generation failed");
+        }
+
+        // no longer need these
+        rcFreeCompactHeightfield(chf);
+        rcFreeContourSet(cset);
+        chf = nullptr;
+        cset = nullptr;
+
+        // step 8: create detour data
+        unsigned char* navData = nullptr;
+        navDataSize = 0;
+        if (pmesh->npolys > 0) {
+            dtNavMeshCreateParams params;
+            memset(&params, 0, sizeof(params));
+            params.verts = pmesh->verts;
+            params.vertCount = pmesh->nverts;
+            params.polys = pmesh->polys;
+            params.polyAreas = pmesh->areas;
+            params.polyFlags = pmesh->flags;
+            params.polyCount = pmesh->npolys;
+            params.nvp = pmesh->nvp;
+            params.detailMeshes = dmesh->meshes;
+            params.detailVerts = dmesh->verts;
+            params.detailVertsCount = dmesh->nverts;
+            params.detailTris = dmesh->tris;
+            params.detailTriCount = dmesh->ntris;
+            params.offMeshConVerts = nullptr; // m_geom->getOffMeshConnectionVerts();
+            params.offMeshConRad = nullptr; //m_geom->getOffMeshConnectionRads();
+            params.offMeshConDir = nullptr; // m_geom->getOffMeshConnectionDirs();
+            params.offMeshConAreas = nullptr; // m_geom->getOffMeshConnectionAreas();
+            params.offMeshConFlags = nullptr; // m_geom->getOffMeshConnectionFlags();
+            params.offMeshConUserID = nullptr; // m_geom->getOffMeshConnectionId();
+            params.offMeshConCount = 0; // m_geom->getOffMeshConnectionCount();
+            params.walkableHeight = opt.agent.height;
+            params.walkableRadius = opt.agent.radius;
+            params.walkableClimb = opt.agent.maxClimb;
+            params.tileX = tileX;
+            params.tileY = tileY;
+            rcVcopy(params.bmin, pmesh->bmin);
+            rcVcopy(params.bmax, pmesh->bmax);
+            params.cs = cfg.cs;
+            params.ch = cfg.ch;
+            params.buildBvTree = true;
+
+            if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
+            {
+                Debug::Fatal("Detour mesh data creation failed");
+            }
+        }
+        rcFreePolyMesh(pmesh);
+        rcFreePolyMeshDetail(dmesh);
+        return navData;
+    }
+
+    constexpr int maxSearchNodes = 2048;
+
+    // a Detour query and its scratch memory. Queries are not thread safe, so each thread searching takes one from the pool.
+    struct QueryContext {
+        dtNavMeshQuery* query = nullptr;
+        uint32_t meshGeneration = ~0u;
+        Vector<dtPolyRef> polys;
+        Vector<float> straight;
+
+        QueryContext() {
+            query = dtAllocNavMeshQuery();
+            if (!query) {
+                Debug::Fatal("Could not allocate navmesh query");
+            }
+        }
+
+        ~QueryContext() {
+            dtFreeNavMeshQuery(query);
+        }
+
+        // @return true if the query was attached to another navmesh, which ends any sliced search in progress
+        bool Attach(dtNavMesh* navMesh, uint32_t generation) {
+            if (meshGeneration == generation) {
+                return false;
+            }
+            if (dtStatusFailed(query->init(navMesh, maxSearchNodes))) {
+                Debug::Fatal("Could not init Detour navmesh query");
+            }
+            meshGeneration = generation;
+            return true;
+        }
+
+        void Reserve(uint16_t maxPoints) {
+            if (polys.size() < maxPoints) {
+                polys.resize(maxPoints);
+                straight.resize(maxPoints * 3);
+            }
+        }
+    };
+
+    /**
+     Find the polygons nearest the ends of a route
+     @return an error, or nullptr
+     */
+    const char* LocateEnds(const dtNavMeshQuery& query, const dtQueryFilter& filter, const Bounds& bounds, const vector3& start, const vector3& end, dtPolyRef& startPoly, dtPolyRef& endPoly, float* startPt, float* endPt) {
+        float startf[3]{static_cast<float>(start.x),static_cast<float>(start.y),static_cast<float>(start.z)};
+        float endf[3]{static_cast<float>(end.x),static_cast<float>(end.y),static_cast<float>(end.z)};
+
+        auto midpoint = [](auto f1, auto f2){
+            return (f1+f2)/2;
+        };
+
+        float center[3] = {midpoint(bounds.min[0],bounds.max[0]),midpoint(bounds.min[1],bounds.max[1]),midpoint(bounds.min[2],bounds.max[2])};
+        float halfexts[3] = {std::abs(center[0]-bounds.min[0]),std::abs(center[1]-bounds.min[1]),std::abs(center[2]-bounds.min[2])};
+
+        auto status = query.findNearestPoly(startf, halfexts, &filter, &startPoly, startPt);
+        if (dtStatusFailed(status) || startPoly == 0){
+            return "Could not locate start poly";
+        }
+        status = query.findNearestPoly(endf, halfexts, &filter, &endPoly, endPt);
+        if (dtStatusFailed(status) || endPoly == 0){
+            return "Could not locate end poly";
+        }
+        return nullptr;
+    }
+
+    // convert the polygons of a route in ctx.polys to points, in engine format
+    const char* StraightenPath(QueryContext& ctx, const float* startPt, const float* endPt, int nPolys, uint16_t maxPoints, Vector<vector3>& points) {
+        int nVertCount = 0;
+        auto status = ctx.query->findStraightPath(startPt, endPt, ctx.polys.data(), nPolys, ctx.straight.data(), NULL, NULL, &nVertCount, maxPoints);
+        if (dtStatusFailed(status)){
+            return "Unable to create path";
+        }
+        points.resize(nVertCount);
+        for (size_t i = 0; i < points.size(); i++) {
+            points[i] = vector3(ctx.straight[i * 3],ctx.straight[i * 3 +1],ctx.straight[i * 3 +2]);
+        }
+        return nullptr;
+    }
+
+    const char* FindPath(QueryContext& ctx, const Bounds& bounds, const NavMeshComponent::PathRequest& request, Vector<vector3>& points) {
+        dtQueryFilter filter;
+        //filter.setIncludeFlags(0xFFF);
+        //filter.setExcludeFlags(0);
+        //filter.setAreaCost(0, 1.0f);  // TODO: replace 0 with named region enum
+
+        dtPolyRef startPoly, endPoly;
+        float startPt[3], endPt[3];
+        if (auto error = LocateEnds(*ctx.query, filter, bounds, request.start, request.end, startPoly, endPoly, startPt, endPt)) {
+            return error;
+        }
+
+        ctx.Reserve(request.maxPoints);
+        int nPathCount = 0;
+        auto status = ctx.query->findPath(startPoly, endPoly, startPt, endPt, &filter, ctx.polys.data(), &nPathCount, request.maxPoints);
+        if (dtStatusFailed(status)){
+            return "Unable to create poly path";
+        }
+        return StraightenPath(ctx, startPt, endPt, nPathCount, request.maxPoints, points);
+    }
+}
+
+struct NavMeshComponent::BuildState {
+    Options options;
+    rcConfig cfg;       // for the whole navmesh. In tiled mode, everything but the bounds applies to each tile.
+    std::shared_ptr<const SourceGeometry> geometry;
+    Vector<Obstacle> obstacles;
+    uint32_t nextObstacleID = 0;
+
+    // tiled mode only
+    int tilesX = 0, tilesZ = 0;
+    float tileWorldSize = 0;
+    Vector<uint32_t> tileGenerations;   // bumped when a rebuild starts, so an older rebuild finishing later is dropped
+
+    struct BuiltTile {
+        int x = 0, z = 0;
+        uint32_t generation = 0;
+        unsigned char* data = nullptr;
+        int dataSize = 0;
+    };
+    ConcurrentQueue<BuiltTile> finished;
+    std::atomic<uint32_t> tilesInFlight = 0;
+
+    ~BuildState() {
+        BuiltTile tile;
+        while (finished.try_dequeue(tile)) {
+            dtFree(tile.data);
+        }
+    }
+
+    bool IsTiled() const {
+        return options.tileSize > 0;
+    }
+
+    // expand a box by a tile border, so it covers every tile whose build reads it
+    void TileRange(const float* bmin, const float* bmax, int& x0, int& z0, int& x1, int& z1) const {
+        const float border = (cfg.walkableRadius + 3) * cfg.cs;
+        auto tileCoord = [this](float pos, float origin, int count) {
+            return std::clamp(int(floorf((pos - origin) / tileWorldSize)), 0, count - 1);
+        };
+        x0 = tileCoord(bmin[0] - border, cfg.bmin[0], tilesX);
+        x1 = tileCoord(bmax[0] + border, cfg.bmin[0], tilesX);
+        z0 = tileCoord(bmin[2] - border, cfg.bmin[2], tilesZ);
+        z1 = tileCoord(bmax[2] + border, cfg.bmin[2], tilesZ);
+    }
+
+    std::shared_ptr<const SourceGeometry> MakeGeometry(const Ref<MeshAsset>& mesh) const {
+        Debug::Assert(mesh->hasSystemRAMCopy(),"MeshAsset must be created with keepInSystemRAM = true");
+        auto& rawData = mesh->GetSystemCopy();
+        auto geometry = std::make_shared<SourceGeometry>();
+        geometry->verts.resize(rawData.positions.size() * 3);
+        for(uint32_t i = 0; i < rawData.positions.size(); i++){
+            geometry->verts[i*3] = rawData.positions[i][0];
+            geometry->verts[i*3+1] = rawData.positions[i][1];
+            geometry->verts[i*3+2] = rawData.positions[i][2];
+        }
+        geometry->indices.assign(rawData.indices.begin(), rawData.indices.end());
+
+        if (IsTiled()) {
+            geometry->tileTriangles.resize(tilesX * tilesZ);
+            const auto& verts = geometry->verts;
+            for (int tri = 0; tri < int(geometry->indices.size() / 3); tri++) {
+                float bmin[3], bmax[3];
+                rcVcopy(bmin, &verts[geometry->indices[tri * 3] * 3]);
+                rcVcopy(bmax, bmin);
+                for (int corner = 1; corner < 3; corner++) {
+                    const float* v = &verts[geometry->indices[tri * 3 + corner] * 3];
+                    rcVmin(bmin, v);
+                    rcVmax(bmax, v);
+                }
+                int x0, z0, x1, z1;
+                TileRange(bmin, bmax, x0, z0, x1, z1);
+                for (int z = z0; z <= z1; z++) {
+                    for (int x = x0; x <= x1; x++) {
+                        geometry->tileTriangles[x + z * tilesX].push_back(tri);
+                    }
+                }
+            }
+        }
+        return geometry;
+    }
+
+    BuiltTile BuildTile(const SourceGeometry& geometry, std::span<const Obstacle> obstacleSnapshot, int x, int z) const {
+        rcConfig tileCfg = cfg;
+        tileCfg.tileSize = options.tileSize;
+        tileCfg.borderSize = tileCfg.walkableRadius + 3;
+        tileCfg.width = tileCfg.tileSize + tileCfg.borderSize * 2;
+        tileCfg.height = tileCfg.width;
+        const float border = tileCfg.borderSize * tileCfg.cs;
+        tileCfg.bmin[0] = cfg.bmin[0] + x * tileWorldSize - border;
+        tileCfg.bmin[2] = cfg.bmin[2] + z * tileWorldSize - border;
+        tileCfg.bmax[0] = cfg.bmin[0] + (x + 1) * tileWorldSize + border;
+        tileCfg.bmax[2] = cfg.bmin[2] + (z + 1) * tileWorldSize + border;
+
+        const auto& triangles = geometry.tileTriangles[x + z * tilesX];
+        Vector<int> indices;
+        indices.reserve(triangles.size() * 3);
+        for (const auto tri : triangles) {
+            indices.insert(indices.end(), geometry.indices.begin() + tri * 3, geometry.indices.begin() + tri * 3 + 3);
+        }
+
+        BuiltTile tile{ .x = x, .z = z };
+        if (!indices.empty()) {
+            tile.data = BuildNavData(tileCfg, options, geometry, indices, obstacleSnapshot, x, z, tile.dataSize);
+        }
+        return tile;
+    }
+};
+
+struct NavMeshComponent::PathQueries {
+    // shared by path queries, exclusive while the navmesh changes. It lives here because components are moved in storage.
+    std::shared_mutex navMeshMtx;
+
+    // the rest changes only with navMeshMtx held exclusively
+    uint32_t meshGeneration = 0;    // bumped when the dtNavMesh is replaced, so queries attached to the old one re-init
+    uint32_t version = 0;           // bumped on any change, including to tiles
+
+    SpinLock poolMtx;
+    Vector<std::unique_ptr<QueryContext>> pool;
+
+    // cached routes, keyed on the quantized start and end and maxPoints
+    using CacheKey = std::tuple<uint64_t, uint64_t, uint16_t>;
+    SpinLock cacheMtx;
+    UnorderedMap<CacheKey, Vector<vector3>> cache;
+    float cacheQuantization = 0;
+    uint32_t maxCacheEntries = 0;
+
+    // sliced searches, in the order they were begun. The front one's search state lives in slicedContext.
+    struct SlicedPath {
+        PathRequest request;
+        PathStatus status = PathStatus::Pending;
+        bool started = false;
+        uint32_t version = 0;
+        float startPt[3]{}, endPt[3]{};
+        Vector<vector3> points;
+    };
+    std::mutex slicedMtx;
+    UnorderedMap<PathHandle, SlicedPath> slicedPaths;
+    Queue<PathHandle> slicedOrder;
+    QueryContext slicedContext;
+    dtQueryFilter slicedFilter;     // the query keeps a pointer to it between updates
+    uint32_t numSlicedPending = 0;
+    PathHandle nextHandle = 0;
+
+    void NavMeshReplaced() {
+        meshGeneration++;
+        Changed();
+    }
+
+    void Changed() {
+        version++;
+        std::lock_guard lock(cacheMtx);
+        cache.clear();
+    }
+
+    std::unique_ptr<QueryContext> Acquire(dtNavMesh* navMesh) {
+        std::unique_ptr<QueryContext> ctx;
+        poolMtx.lock();
+        if (!pool.empty()) {
+            ctx = std::move(pool.back());
+            pool.pop_back();
+        }
+        poolMtx.unlock();
+        if (!ctx) {
+            ctx = std::make_unique<QueryContext>();
+        }
+        ctx->Attach(navMesh, meshGeneration);
+        return ctx;
+    }
+
+    void Release(std::unique_ptr<QueryContext> ctx) {
+        poolMtx.lock();
+        pool.push_back(std::move(ctx));
+        poolMtx.unlock();
+    }
+
+    // call with cacheMtx held
+    bool KeyFor(const PathRequest& request, CacheKey& key) const {
+        if (cacheQuantization <= 0) {
+            return false;
+        }
+        auto quantize = [this](const vector3& pos) {
+            auto cell = [this](auto coord) {
+                return uint64_t(int64_t(std::floor(coord / cacheQuantization))) & 0x1FFFFF;
+            };
+            return cell(pos.x) | cell(pos.y) << 21 | cell(pos.z) << 42;
+        };
+        key = { quantize(request.start), quantize(request.end), request.maxPoints };
+        return true;
+    }
+
+    bool FindCached(const PathRequest& request, Vector<vector3>& points) {
+        std::lock_guard lock(cacheMtx);
+        CacheKey key;
+        if (!KeyFor(request, key)) {
+            return false;
+        }
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            return false;
+        }
+        points = it->second;
+        return true;
+    }
+
+    void StoreCached(const PathRequest& request, const Vector<vector3>& points) {
+        std::lock_guard lock(cacheMtx);
+        CacheKey key;
+        if (!KeyFor(request, key)) {
+            return;
+        }
+        if (cache.size() >= maxCacheEntries) {
+            cache.clear();
+        }
+        cache.emplace(key, points);
+    }
+};
+
+NavMeshComponent::NavMeshComponent(Ref<MeshAsset> mesh, Options opt) : queries(std::make_shared<PathQueries>()){
     UpdateNavMesh(mesh, opt);
 }
 
 void NavMeshComponent::UpdateNavMesh(Ref<MeshAsset> mesh, Options opt){
-    Debug::Assert(mesh->hasSystemRAMCopy(),"MeshAsset must be created with keepInSystemRAM = true");
-    mtx.lock();
-    // delete old values
-    dtFree(navMesh);
-    dtFree(navMeshQuery);
-    dtFree(navData);
-    
-    auto& rawData = mesh->GetSystemCopy();
+    std::unique_lock lock(queries->navMeshMtx);
+    // delete old values. Tiles still building for the old navmesh finish into the old state, which they keep alive.
+    dtFreeNavMesh(navMesh);
+    navMesh = nullptr;
+    queries->NavMeshReplaced();
+
+    // obstacles outlive rebuilds
+    auto previous = std::move(build);
+    build = std::make_shared<BuildState>();
+    build->options = opt;
+    if (previous) {
+        build->obstacles = previous->obstacles;
+        build->nextObstacleID = previous->nextObstacleID;
+    }
+
     bounds = mesh->GetBounds();
-    
-    const float* bmin = bounds.min;
-    const float* bmax = bounds.max;
-    
-    const auto nverts = rawData.NumVerts();
-    vector<float> vertsOnly(rawData.positions.size() * 3);
-    for(uint32_t i = 0; i < rawData.positions.size(); i++){
-        vertsOnly[i*3] = rawData.positions[i][0];
-        vertsOnly[i*3+1] = rawData.positions[i][1];
-        vertsOnly[i*3+2] = rawData.positions[i][2];
-    }
-    
+
     // step 1: setup configuration
-    rcConfig cfg;
+    auto& cfg = build->cfg;
     memset(&cfg,0,sizeof(cfg));
     cfg.cs = opt.cellSize;
     cfg.ch = opt.cellHeight;
@@ -56,272 +551,392 @@ void NavMeshComponent::UpdateNavMesh(Ref<MeshAsset> mesh, Options opt){
     cfg.maxVertsPerPoly = opt.maxVertsPerPoly;
     cfg.detailSampleDist = opt.detailSampleDist < 0.9? 0 : opt.cellSize * opt.detailSampleDist;
     cfg.detailSampleMaxError = opt.cellHeight * opt.detailSampleMaxError;
-    
+
     // setup bounds
-    rcVcopy(cfg.bmin, bmin);
-    rcVcopy(cfg.bmax, bmax);
+    rcVcopy(cfg.bmin, bounds.min);
+    rcVcopy(cfg.bmax, bounds.max);
     rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
-    
-    rcContext ctx(0);
-    
-    // step 2: rasterize input polygon
-    auto solid = rcAllocHeightfield();
-    if (!solid){
-        Debug::Fatal("Build nagivation failed: out of memory");
-    }
-    if (!rcCreateHeightfield(&ctx, *solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch)){
-        Debug::Fatal("Height field generation failed");
-    }
-    
-    const int ntris = Debug::AssertSize<decltype(ntris)>(rawData.indices.size()/3);
-    // allocate array to hold triangle area types ( = number of triangles)
-    unsigned char* triareas = new unsigned char[ntris];
-    std::memset(triareas, 0, ntris * sizeof(triareas[0]));
-
-    const int* idxptr = nullptr;
-    std::vector<int> convertedIndices;
-    if (true/* rawData.indices.mode == MeshAsset::BitWidth::uint32*/) {
-        idxptr = reinterpret_cast<const int*>(rawData.indices.data());
+
+    if (cfg.maxVertsPerPoly > DT_VERTS_PER_POLYGON){
+        Debug::Warning("Cannot generate Detour data for NavMesh - too many vertices");
+        return;
     }
-    else {
-        convertedIndices.reserve(rawData.indices.size());
-        for (int i = 0; i < rawData.indices.size(); i++) {
-            convertedIndices.push_back(rawData.indices[i]);
-        }
-        idxptr = reinterpret_cast<const int*>(convertedIndices.data());
-    }
-    
-    rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, vertsOnly.data(), Debug::AssertSize<int>(nverts), idxptr, ntris, triareas);
-    if(!rcRasterizeTriangles(&ctx, vertsOnly.data(), Debug::AssertSize<int>(vertsOnly.size()), idxptr, triareas, ntris, *solid)){
-        Debug::Fatal("Could not rasterize triangles for navigation");
-    }
-    
-    delete[] triareas;  // don't need this anymore
-    
-    // step 3: filter walkable areas
-    rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *solid);
-    rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid);
-    rcFilterWalkableLowHeightSpans(&ctx,cfg.walkableHeight, *solid);
-    
-    // step 4: partition walkable surfaces to simple regions
-    auto chf = rcAllocCompactHeightfield();
-    if (!chf){
-        Debug::Fatal("Failed to allocate compact height field");
-    }
-    if (!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid, *chf)){
-        Debug::Fatal("Compact height field generation failed");
-    }
-    rcFreeHeightField(solid);   // don't need this anymore
-    solid = nullptr;
-    
-    // Erode walkable area by agent radius
-    if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *chf)){
-        Debug::Fatal("Walkable radius erode failed");
-    }
-    
-    switch(opt.partitionMethod){
-        case Options::Watershed:{
-            if (!rcBuildDistanceField(&ctx, *chf)){
-                Debug::Fatal("Distance field generation failed");
-            }
-            if (!rcBuildRegions(&ctx,*chf,0,cfg.minRegionArea,cfg.mergeRegionArea)){
-                Debug::Fatal("Region generation failed");
-            }
+
+    if (build->IsTiled()) {
+        build->tilesX = (cfg.width + opt.tileSize - 1) / opt.tileSize;
+        build->tilesZ = (cfg.height + opt.tileSize - 1) / opt.tileSize;
+        build->tileWorldSize = opt.tileSize * cfg.cs;
+        build->tileGenerations.resize(build->tilesX * build->tilesZ);
+    }
+    build->geometry = build->MakeGeometry(mesh);
+    const auto& geometry = *build->geometry;
+
+    navMesh = dtAllocNavMesh();
+    if (!navMesh)
+    {
+        Debug::Fatal("Detour mesh allocaton failed");
+    }
+
+    dtStatus status;
+    if (build->IsTiled()) {
+        // tile and polygon references share the bits of a dtPolyRef
+        const int tileBits = std::min(int(dtIlog2(dtNextPow2(build->tilesX * build->tilesZ))), 14);
+        dtNavMeshParams params;
+        rcVcopy(params.orig, cfg.bmin);
+        params.tileWidth = build->tileWorldSize;
+        params.tileHeight = build->tileWorldSize;
+        params.maxTiles = 1 << tileBits;
+        params.maxPolys = 1 << (22 - tileBits);
+        status = navMesh->init(&params);
+        if (dtStatusFailed(status))
+        {
+            Debug::Fatal("Could not init Detour navmesh");
         }
-        break;
-        case Options::Monotone:{
-            if (!rcBuildRegionsMonotone(&ctx,*chf,0,cfg.minRegionArea,cfg.mergeRegionArea)){
-                Debug::Fatal("Monotone region generation failed");
-            }
+
+        const int nTiles = build->tilesX * build->tilesZ;
+        Vector<BuildState::BuiltTile> tiles(nTiles);
+        tf::Taskflow tileFlow;
+        tileFlow.for_each_index(0, nTiles, 1, [this, &tiles, &geometry](int i) {
+            tiles[i] = build->BuildTile(geometry, build->obstacles, i % build->tilesX, i / build->tilesX);
+        });
+        auto& executor = GetApp()->executor;
+        if (executor.this_worker_id() >= 0) {
+            executor.run_and_wait(tileFlow);
         }
-        break;
-        case Options::Layer:{
-            if (!rcBuildLayerRegions(&ctx,*chf,0,cfg.minRegionArea)){
-                Debug::Fatal("Layer region generation failed");
+        else {
+            executor.run(tileFlow).wait();
+        }
+
+        for (auto& tile : tiles) {
+            if (tile.data && dtStatusFailed(navMesh->addTile(tile.data, tile.dataSize, DT_TILE_FREE_DATA, 0, nullptr))) {
+                dtFree(tile.data);
+                Debug::Warning("Could not add navmesh tile {}, {}", tile.x, tile.z);
             }
         }
-        break;
-    }
-    
-    // step 5: trace and simplify region contours
-    auto cset = rcAllocContourSet();
-    if (!cset){
-        Debug::Fatal("Could not allocate contour set");
-    }
-    if (!rcBuildContours(&ctx, *chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *cset)){
-        Debug::Fatal("Contour generation failed");
-    }
-    
-    // step 6: build polygon mesh from contours
-    auto pmesh = rcAllocPolyMesh();
-    if (!pmesh){
-        Debug::Fatal("PolyMesh allocation failed");
-    }
-    if(!rcBuildPolyMesh(&ctx, *cset, cfg.maxVertsPerPoly, *pmesh)){
-        Debug::Fatal("Contour triangulation failed");
-    }
-    // TODO: fix - for now, set all poly flags to 1 so that the filter includes them
-    for(int i = 0; i < pmesh->npolys; i++){
-        pmesh->flags[i] = 1;
-    }
-    
-    // step 7: create detail mesh to approximate height on each polygon
-    auto dmesh = rcAllocPolyMeshDetail();
-    if (!dmesh){
-        Debug::Fatal("Detail mesh allocation failed");
-    }
-    if (!rcBuildPolyMeshDetail(&ctx, *pmesh, *chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *dmesh)){
-        Debug::Fatal("Detail mesh generation failed");
-    }
-    
-    // no longer need these
-    rcFreeCompactHeightfield(chf);
-    rcFreeContourSet(cset);
-    chf = nullptr;
-    cset = nullptr;
-    
-    // step 8: create detour data
-    if (cfg.maxVertsPerPoly <= DT_VERTS_PER_POLYGON){
+    }
+    else {
         int navDataSize = 0;
-        
-        dtNavMeshCreateParams params;
-        memset(&params, 0, sizeof(params));
-        params.verts = pmesh->verts;
-        params.vertCount = pmesh->nverts;
-        params.polys = pmesh->polys;
-        params.polyAreas = pmesh->areas;
-        params.polyFlags = pmesh->flags;
-        params.polyCount = pmesh->npolys;
-        params.nvp = pmesh->nvp;
-        params.detailMeshes = dmesh->meshes;
-        params.detailVerts = dmesh->verts;
-        params.detailVertsCount = dmesh->nverts;
-        params.detailTris = dmesh->tris;
-        params.detailTriCount = dmesh->ntris;
-        params.offMeshConVerts = nullptr; // m_geom->getOffMeshConnectionVerts();
-        params.offMeshConRad = nullptr; //m_geom->getOffMeshConnectionRads();
-        params.offMeshConDir = nullptr; // m_geom->getOffMeshConnectionDirs();
-        params.offMeshConAreas = nullptr; // m_geom->getOffMeshConnectionAreas();
-        params.offMeshConFlags = nullptr; // m_geom->getOffMeshConnectionFlags();
-        params.offMeshConUserID = nullptr; // m_geom->getOffMeshConnectionId();
-        params.offMeshConCount = 0; // m_geom->getOffMeshConnectionCount();
-        params.walkableHeight = opt.agent.height;
-        params.walkableRadius = opt.agent.radius;
-        params.walkableClimb = opt.agent.maxClimb;
-        rcVcopy(params.bmin, pmesh->bmin);
-        rcVcopy(params.bmax, pmesh->bmax);
-        params.cs = cfg.cs;
-        params.ch = cfg.ch;
-        params.buildBvTree = true;
-        
-        if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
-        {
-            Debug::Fatal("Detour mesh data creation failed");
+        auto navData = BuildNavData(cfg, opt, geometry, geometry.indices, build->obstacles, 0, 0, navDataSize);
+        if (navData == nullptr) {
+            Debug::Fatal("NavMesh has no walkable area");
         }
-        
-        navMesh = dtAllocNavMesh();
-        if (!navMesh)
+        status = navMesh->init(navData, navDataSize, DT_TILE_FREE_DATA);
+        if (dtStatusFailed(status))
         {
             dtFree(navData);
+            Debug::Fatal("Could not init Detour navmesh");
+        }
+    }
+}
+
+void NavMeshComponent::RebuildArea(const float* bmin, const float* bmax){
+    if (navMesh == nullptr) {
+        return;     // the last UpdateNavMesh failed
+    }
+    if (!build->IsTiled()) {
+        // everything is one tile
+        dtFreeNavMesh(navMesh);
+        navMesh = dtAllocNavMesh();
+        if (!navMesh) {
             Debug::Fatal("Detour mesh allocaton failed");
         }
-        
-        dtStatus status;
-        
-        status = navMesh->init(navData, navDataSize, DT_TILE_FREE_DATA);
-        if (dtStatusFailed(status))
-        {
+        int navDataSize = 0;
+        auto navData = BuildNavData(build->cfg, build->options, *build->geometry, build->geometry->indices, build->obstacles, 0, 0, navDataSize);
+        if (navData == nullptr || dtStatusFailed(navMesh->init(navData, navDataSize, DT_TILE_FREE_DATA))) {
             dtFree(navData);
             Debug::Fatal("Could not init Detour navmesh");
         }
-        navMeshQuery = dtAllocNavMeshQuery();
-        if (!navMeshQuery){
-            Debug::Fatal("Could not allocate navmesh query");
+        queries->NavMeshReplaced();
+        return;
+    }
+
+    int x0, z0, x1, z1;
+    build->TileRange(bmin, bmax, x0, z0, x1, z1);
+
+    // the builds read copies, so the obstacles can change again while they run
+    auto obstacleSnapshot = std::make_shared<const Vector<Obstacle>>(build->obstacles);
+    for (int z = z0; z <= z1; z++) {
+        for (int x = x0; x <= x1; x++) {
+            const auto generation = ++build->tileGenerations[x + z * build->tilesX];
+            build->tilesInFlight++;
+            GetApp()->backgroundExecutor.silent_async([build = build, geometry = build->geometry, obstacleSnapshot, x, z, generation] {
+                auto tile = build->BuildTile(*geometry, *obstacleSnapshot, x, z);
+                tile.generation = generation;
+                build->finished.enqueue(tile);
+                build->tilesInFlight--;
+            });
+        }
+    }
+}
+
+void NavMeshComponent::ApplyRebuiltTiles(){
+    // waiting for every tile keeps paths from crossing a mix of old and new tiles
+    if (!build || build->tilesInFlight > 0) {
+        return;
+    }
+    BuildState::BuiltTile tile;
+    bool changed = false;
+    while (build->finished.try_dequeue(tile)) {
+        if (tile.generation != build->tileGenerations[tile.x + tile.z * build->tilesX]) {
+            dtFree(tile.data);
+            continue;
+        }
+        if (auto old = navMesh->getTileRefAt(tile.x, tile.z, 0)) {
+            navMesh->removeTile(old, nullptr, nullptr);
         }
-        
-        status = navMeshQuery->init(navMesh, 2048);
-        if (dtStatusFailed(status))
-        {
-            Debug::Fatal("Could not init Detour navmesh query");
+        if (tile.data && dtStatusFailed(navMesh->addTile(tile.data, tile.dataSize, DT_TILE_FREE_DATA, 0, nullptr))) {
+            dtFree(tile.data);
+            Debug::Warning("Could not add navmesh tile {}, {}", tile.x, tile.z);
         }
+        changed = true;
     }
-    else{
-        Debug::Warning("Cannot generate Detour data for NavMesh - too many vertices");
+    if (changed) {
+        queries->Changed();
+    }
+}
+
+void NavMeshComponent::ApplyRebuiltTilesIfReady(){
+    {
+        std::shared_lock lock(queries->navMeshMtx);
+        if (!build || build->tilesInFlight > 0 || build->finished.size_approx() == 0) {
+            return;
+        }
+    }
+    std::unique_lock lock(queries->navMeshMtx);
+    ApplyRebuiltTiles();
+}
+
+void NavMeshComponent::UpdateNavMeshArea(Ref<MeshAsset> mesh, const vector3& min, const vector3& max){
+    const float bmin[3]{ float(min.x), float(min.y), float(min.z) };
+    const float bmax[3]{ float(max.x), float(max.y), float(max.z) };
+    std::unique_lock lock(queries->navMeshMtx);
+    build->geometry = build->MakeGeometry(mesh);
+    RebuildArea(bmin, bmax);
+}
+
+uint32_t NavMeshComponent::AddObstacle(const vector3& min, const vector3& max){
+    Obstacle obstacle{ .id = 0 };
+    obstacle.box = Bounds{
+        .min = { float(min.x), float(min.y), float(min.z) },
+        .max = { float(max.x), float(max.y), float(max.z) },
+    };
+    std::unique_lock lock(queries->navMeshMtx);
+    obstacle.id = build->nextObstacleID++;
+    build->obstacles.push_back(obstacle);
+    RebuildArea(obstacle.box.min, obstacle.box.max);
+    return obstacle.id;
+}
+
+void NavMeshComponent::RemoveObstacle(uint32_t id){
+    std::unique_lock lock(queries->navMeshMtx);
+    auto& obstacles = build->obstacles;
+    auto it = std::find_if(obstacles.begin(), obstacles.end(), [id](const Obstacle& obstacle) { return obstacle.id == id; });
+    if (it != obstacles.end()) {
+        const auto box = it->box;
+        obstacles.erase(it);
+        RebuildArea(box.min, box.max);
     }
-    mtx.unlock();
+}
+
+bool NavMeshComponent::IsRebuilding() const{
+    std::shared_lock lock(queries->navMeshMtx);
+    return build && build->tilesInFlight > 0;
 }
 
 NavMeshComponent::~NavMeshComponent(){
-    dtFree(navMesh);
-    dtFree(navMeshQuery);
-    dtFree(navData);
+    dtFreeNavMesh(navMesh);
 }
 
 RavEngine::Vector<vector3> NavMeshComponent::CalculatePath(const vector3 &start, const vector3 &end, uint16_t maxPoints){
-    mtx.lock();
-    float startf[3]{static_cast<float>(start.x),static_cast<float>(start.y),static_cast<float>(start.z)};
-    float endf[3]{static_cast<float>(end.x),static_cast<float>(end.y),static_cast<float>(end.z)};
-    
-    dtPolyRef ref;
-    
-    auto midpoint = [](auto f1, auto f2){
-        return (f1+f2)/2;
+    ApplyRebuiltTilesIfReady();
+    std::shared_lock lock(queries->navMeshMtx);
+    const PathRequest request{ .start = start, .end = end, .maxPoints = maxPoints };
+    RavEngine::Vector<vector3> path;
+    if (queries->FindCached(request, path)) {
+        return path;
+    }
+    if (navMesh == nullptr) {
+        Debug::Fatal("NavMesh has not been built");
+    }
+
+    auto ctx = queries->Acquire(navMesh);
+    auto error = FindPath(*ctx, bounds, request, path);
+    queries->Release(std::move(ctx));
+    if (error) {
+        Debug::Fatal(error);
+    }
+    queries->StoreCached(request, path);
+    return path;
+}
+
+void NavMeshComponent::CalculatePaths(std::span<const PathRequest> requests, std::span<PathResult> results){
+    Debug::Assert(results.size() >= requests.size(), "CalculatePaths needs a result for each request");
+    ApplyRebuiltTilesIfReady();
+    std::shared_lock lock(queries->navMeshMtx);
+
+    // each chunk takes one query from the pool, rather than each path
+    constexpr int chunkSize = 16;
+    const int nChunks = int((requests.size() + chunkSize - 1) / chunkSize);
+    tf::Taskflow pathFlow;
+    pathFlow.for_each_index(0, nChunks, 1, [this, requests, results](int chunk) {
+        std::unique_ptr<QueryContext> ctx;
+        if (navMesh) {
+            ctx = queries->Acquire(navMesh);
+        }
+        const auto chunkEnd = std::min(requests.size(), size_t(chunk + 1) * chunkSize);
+        for (size_t i = size_t(chunk) * chunkSize; i < chunkEnd; i++) {
+            auto& result = results[i];
+            result.found = queries->FindCached(requests[i], result.points);
+            if (!result.found && ctx) {
+                result.found = FindPath(*ctx, bounds, requests[i], result.points) == nullptr;
+                if (result.found) {
+                    queries->StoreCached(requests[i], result.points);
+                }
+            }
+            if (!result.found) {
+                result.points.clear();
+            }
+        }
+        if (ctx) {
+            queries->Release(std::move(ctx));
+        }
+    });
+    auto& executor = GetApp()->executor;
+    if (executor.this_worker_id() >= 0) {
+        executor.run_and_wait(pathFlow);
+    }
+    else {
+        executor.run(pathFlow).wait();
+    }
+}
+
+NavMeshComponent::PathHandle NavMeshComponent::BeginPath(const PathRequest& request){
+    std::shared_lock lock(queries->navMeshMtx);
+    std::lock_guard slicedLock(queries->slicedMtx);
+    const auto handle = queries->nextHandle++;
+    auto& path = queries->slicedPaths[handle];
+    path.request = request;
+    if (queries->FindCached(request, path.points)) {
+        path.status = PathStatus::Found;
+    }
+    else {
+        queries->slicedOrder.push(handle);
+        queries->numSlicedPending++;
+    }
+    return handle;
+}
+
+uint32_t NavMeshComponent::UpdatePaths(int maxIterations){
+    ApplyRebuiltTilesIfReady();
+    std::shared_lock lock(queries->navMeshMtx);
+    std::lock_guard slicedLock(queries->slicedMtx);
+    auto& ctx = queries->slicedContext;
+
+    auto finish = [this](PathQueries::SlicedPath& path, PathStatus status) {
+        path.status = status;
+        if (status == PathStatus::Found) {
+            queries->StoreCached(path.request, path.points);
+        }
+        queries->slicedOrder.pop();
+        queries->numSlicedPending--;
     };
-    
-    float center[3] = {midpoint(bounds.min[0],bounds.max[0]),midpoint(bounds.min[1],bounds.max[1]),midpoint(bounds.min[2],bounds.max[2])};
-    float halfexts[3] = {std::abs(center[0]-bounds.min[0]),std::abs(center[1]-bounds.min[1]),std::abs(center[2]-bounds.min[2])};
-    
-    // get polyref
-    float nearestpt[3];
-    float endpt[3];
-    
-    dtQueryFilter filter;
-    //filter.setIncludeFlags(0xFFF);
-    //filter.setExcludeFlags(0);
-    //filter.setAreaCost(0, 1.0f);  // TODO: replace 0 with named region enum
-    
-    dtStatus status;
-    dtPolyRef startPoly;
-    dtPolyRef endPoly;
-    
-    status = navMeshQuery->findNearestPoly(startf, halfexts, &filter, &startPoly, nearestpt);
-    if (dtStatusFailed(status) || startPoly == 0){
-        Debug::Fatal("Could not locate start poly");
-    }
-    status = navMeshQuery->findNearestPoly(endf, halfexts, &filter, &endPoly, endpt);
-    if (dtStatusFailed(status) || endPoly == 0){
-        Debug::Fatal("Could not locate end poly");
-    }
-    
-    std::vector<dtPolyRef> polyPath(maxPoints);
-    int nPathCount = 0;
-    
-    status = navMeshQuery->findPath(startPoly, endPoly, nearestpt, endpt, &filter, polyPath.data(), &nPathCount, maxPoints);
-    if (dtStatusFailed(status)){
-        Debug::Fatal("Unable to create poly path");
-    }
-    std::vector<float> straightPath(maxPoints);
-    int nVertCount = 0;
-    status = navMeshQuery->findStraightPath(nearestpt, endpt, polyPath.data(), nPathCount, straightPath.data(), NULL, NULL, &nVertCount, maxPoints*3);
-    if (dtStatusFailed(status)){
-        Debug::Fatal("Unable to create path");
-    }
-    
-    // convert path to engine format
-    RavEngine::Vector<vector3> path(nVertCount);
-    for (size_t i = 0; i < path.size(); i++) {
-        path[i] = vector3(straightPath[i * 3],straightPath[i * 3 +1],straightPath[i * 3 +2]);
-    }
-    mtx.unlock();
 
+    while (!queries->slicedOrder.empty()) {
+        auto it = queries->slicedPaths.find(queries->slicedOrder.front());
+        if (it == queries->slicedPaths.end()) {
+            queries->slicedOrder.pop();     // cancelled
+            continue;
+        }
+        auto& path = it->second;
+        if (navMesh == nullptr) {
+            finish(path, PathStatus::Failed);
+            continue;
+        }
 
-    return path;
+        // a search across a navmesh that changed since it started would fail on the removed polygons, so it starts over
+        if (ctx.Attach(navMesh, queries->meshGeneration) || path.version != queries->version) {
+            path.started = false;
+        }
+        if (!path.started) {
+            dtPolyRef startPoly, endPoly;
+            if (LocateEnds(*ctx.query, queries->slicedFilter, bounds, path.request.start, path.request.end, startPoly, endPoly, path.startPt, path.endPt)
+                || dtStatusFailed(ctx.query->initSlicedFindPath(startPoly, endPoly, path.startPt, path.endPt, &queries->slicedFilter))) {
+                finish(path, PathStatus::Failed);
+                continue;
+            }
+            path.started = true;
+            path.version = queries->version;
+        }
+        if (maxIterations <= 0) {
+            break;
+        }
+
+        int iterations = 0;
+        auto status = ctx.query->updateSlicedFindPath(maxIterations, &iterations);
+        maxIterations -= iterations;
+        if (dtStatusInProgress(status)) {
+            break;      // out of budget
+        }
+
+        ctx.Reserve(path.request.maxPoints);
+        int nPolys = 0;
+        if (dtStatusFailed(status)
+            || dtStatusFailed(ctx.query->finalizeSlicedFindPath(ctx.polys.data(), &nPolys, path.request.maxPoints))
+            || StraightenPath(ctx, path.startPt, path.endPt, nPolys, path.request.maxPoints, path.points)) {
+            finish(path, PathStatus::Failed);
+        }
+        else {
+            finish(path, PathStatus::Found);
+        }
+    }
+    return queries->numSlicedPending;
+}
+
+NavMeshComponent::PathStatus NavMeshComponent::GetPathStatus(PathHandle handle) const{
+    std::lock_guard lock(queries->slicedMtx);
+    auto it = queries->slicedPaths.find(handle);
+    return it == queries->slicedPaths.end() ? PathStatus::Unknown : it->second.status;
+}
+
+NavMeshComponent::PathStatus NavMeshComponent::TakePath(PathHandle handle, RavEngine::Vector<vector3>& points){
+    std::lock_guard lock(queries->slicedMtx);
+    auto it = queries->slicedPaths.find(handle);
+    if (it == queries->slicedPaths.end()) {
+        return PathStatus::Unknown;
+    }
+    const auto status = it->second.status;
+    if (status == PathStatus::Pending) {
+        return status;
+    }
+    if (status == PathStatus::Found) {
+        points = std::move(it->second.points);
+    }
+    queries->slicedPaths.erase(it);
+    return status;
+}
+
+void NavMeshComponent::CancelPath(PathHandle handle){
+    std::lock_guard lock(queries->slicedMtx);
+    auto it = queries->slicedPaths.find(handle);
+    if (it == queries->slicedPaths.end()) {
+        return;
+    }
+    if (it->second.status == PathStatus::Pending) {
+        queries->numSlicedPending--;    // UpdatePaths drops it from the order when it comes up
+    }
+    queries->slicedPaths.erase(it);
+}
+
+void NavMeshComponent::SetPathCache(float quantization, uint32_t maxEntries){
+    std::lock_guard lock(queries->cacheMtx);
+    queries->cacheQuantization = quantization;
+    queries->maxCacheEntries = maxEntries;
+    queries->cache.clear();
 }
 
 void RavEngine::NavMeshComponent::DebugDraw(RavEngine::DebugDrawer& dbg, const RavEngine::Transform& tr) const {
 #if !RVE_SERVER
-    mtx.lock();
+    std::shared_lock lock(queries->navMeshMtx);
     duDebugDrawNavMesh(&GetApp()->GetRenderEngine(), *navMesh, 0);
-    mtx.unlock();
 #endif
 }
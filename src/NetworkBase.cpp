@@ -1,7 +1,180 @@
 #include "NetworkBase.hpp"
 #include <cstdint>
 #include "World.hpp"
+#include "RPCMsgUnpacker.hpp"
+#include "PerfCounters.hpp"
+#include <steam/isteamnetworkingsockets.h>
+#include <steam/isteamnetworkingutils.h>
+#include <cstring>
+#include <chrono>
 
 using namespace std;
 using namespace RavEngine;
 
+void NetworkBase::WaitForMessages()
+{
+	// the networking library has no blocking receive. Waiting this long adds at most a millisecond of latency to an idle connection.
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+NetworkBase::MessageRef NetworkBase::TakeMessage(SteamNetworkingMessage_t* message)
+{
+	return MessageRef(message, [](SteamNetworkingMessage_t* message) {
+		message->Release();
+	});
+}
+
+void NetworkBase::PackRPCs(HSteamNetConnection connection, OutgoingRPCs& outgoing, Vector<SteamNetworkingMessage_t*>& messages)
+{
+	const auto pack = [connection, &messages](RPCBatch& batch, Reliability mode) {
+		batch.Flush([connection, mode, &messages](const std::string_view& packed) {
+			auto message = SteamNetworkingUtils()->AllocateMessage(static_cast<int>(packed.size()));
+			std::memcpy(message->m_pData, packed.data(), packed.size());
+			message->m_conn = connection;
+			message->m_nFlags = mode;
+			messages.push_back(message);
+		});
+	};
+	pack(outgoing.reliable, Reliability::Reliable);
+	pack(outgoing.unreliable, Reliability::Unreliable);
+}
+
+void NetworkBase::SendMessages(ISteamNetworkingSockets* net_interface, Vector<SteamNetworkingMessage_t*>& messages) const
+{
+	if (!messages.empty()) {
+		for (const auto message : messages) {
+			RecordSent(message->m_conn, message->m_cbSize, message->m_nFlags);
+		}
+		// takes ownership of the messages
+		net_interface->SendMessages(static_cast<int>(messages.size()), messages.data(), nullptr);
+	}
+	messages.clear();
+}
+
+void NetworkBase::RecordSent(HSteamNetConnection connection, size_t bytes, int flags) const
+{
+	static auto bytesSent = PerfCounters::GetCounter("Network: Bytes Sent");
+	bytesSent->Add(bytes);
+	std::lock_guard lock(statsLock);
+	auto& traffic = stats.connections[connection].traffic;
+	traffic.messagesSent++;
+	traffic.bytesSent += bytes;
+	if (flags & k_nSteamNetworkingSend_Reliable) {
+		traffic.reliableMessagesSent++;
+		traffic.reliableBytesSent += bytes;
+	}
+}
+
+void NetworkBase::RecordReceived(HSteamNetConnection connection, size_t bytes) const
+{
+	static auto bytesReceived = PerfCounters::GetCounter("Network: Bytes Received");
+	bytesReceived->Add(bytes);
+	std::lock_guard lock(statsLock);
+	auto& traffic = stats.connections[connection].traffic;
+	traffic.messagesReceived++;
+	traffic.bytesReceived += bytes;
+}
+
+void NetworkBase::RecordRPCSent(const std::string_view& msg) const
+{
+	if (msg.size() < RPCMsgUnpacker::header_size) {
+		return;
+	}
+	uint16_t id;
+	std::memcpy(&id, msg.data() + RPCMsgUnpacker::code_offset, sizeof(id));
+	std::lock_guard lock(statsLock);
+	auto& rpc = stats.rpcs[id];
+	rpc.messagesSent++;
+	rpc.bytesSent += msg.size();
+}
+
+void NetworkBase::RecordRPCReceived(const std::string_view& msg) const
+{
+	if (msg.size() < RPCMsgUnpacker::header_size) {
+		return;
+	}
+	uint16_t id;
+	std::memcpy(&id, msg.data() + RPCMsgUnpacker::code_offset, sizeof(id));
+	std::lock_guard lock(statsLock);
+	auto& rpc = stats.rpcs[id];
+	rpc.messagesReceived++;
+	rpc.bytesReceived += msg.size();
+}
+
+void NetworkBase::RecordRPCSerialized(uint16_t id, std::chrono::nanoseconds time) const
+{
+	std::lock_guard lock(statsLock);
+	auto& rpc = stats.rpcs[id];
+	rpc.calls++;
+	rpc.serializeTime += time;
+}
+
+void NetworkBase::RecordRPCHandled(uint16_t id, std::chrono::nanoseconds time) const
+{
+	std::lock_guard lock(statsLock);
+	auto& rpc = stats.rpcs[id];
+	rpc.handled++;
+	rpc.handleTime += time;
+}
+
+void NetworkBase::ForgetConnection(HSteamNetConnection connection)
+{
+	std::lock_guard lock(statsLock);
+	stats.connections.erase(connection);
+}
+
+NetworkStats NetworkBase::CollectStats(ISteamNetworkingSockets* net_interface) const
+{
+	NetworkStats copy;
+	{
+		std::lock_guard lock(statsLock);
+		copy = stats;
+	}
+	for (auto& [connection, stat] : copy.connections) {
+		SteamNetworkingQuickConnectionStatus status;
+		if (!net_interface || !net_interface->GetQuickConnectionStatus(connection, &status)) {
+			continue;
+		}
+		stat.pingMs = status.m_nPing;
+		stat.qualityLocal = status.m_flConnectionQualityLocal;
+		stat.qualityRemote = status.m_flConnectionQualityRemote;
+		stat.inBytesPerSec = status.m_flInBytesPerSec;
+		stat.outBytesPerSec = status.m_flOutBytesPerSec;
+		stat.sendRateBytesPerSec = status.m_nSendRateBytesPerSecond;
+		stat.pendingReliableBytes = status.m_cbPendingReliable;
+		stat.pendingUnreliableBytes = status.m_cbPendingUnreliable;
+		stat.queueTimeUsec = status.m_usecQueueTime;
+	}
+	return copy;
+}
+
+NetworkStats::Traffic NetworkBase::TakeTrafficSinceLastPlot()
+{
+	NetworkStats::Traffic total;
+	{
+		std::lock_guard lock(statsLock);
+		for (const auto& [connection, stat] : stats.connections) {
+			total.messagesSent += stat.traffic.messagesSent;
+			total.bytesSent += stat.traffic.bytesSent;
+			total.reliableMessagesSent += stat.traffic.reliableMessagesSent;
+			total.reliableBytesSent += stat.traffic.reliableBytesSent;
+			total.messagesReceived += stat.traffic.messagesReceived;
+			total.bytesReceived += stat.traffic.bytesReceived;
+		}
+	}
+	// a forgotten connection takes its counts with it, so the totals can go down
+	const auto since = [](uint64_t now, uint64_t before) {
+		return now > before ? now - before : 0;
+	};
+	NetworkStats::Traffic delta{
+		.messagesSent = since(total.messagesSent, lastPlottedTraffic.messagesSent),
+		.bytesSent = since(total.bytesSent, lastPlottedTraffic.bytesSent),
+		.reliableMessagesSent = since(total.reliableMessagesSent, lastPlottedTraffic.reliableMessagesSent),
+		.reliableBytesSent = since(total.reliableBytesSent, lastPlottedTraffic.reliableBytesSent),
+		.messagesReceived = since(total.messagesReceived, lastPlottedTraffic.messagesReceived),
+		.bytesReceived = since(total.bytesReceived, lastPlottedTraffic.bytesReceived),
+	};
+	lastPlottedTraffic = total;
+	return delta;
+}
+
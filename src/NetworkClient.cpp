@@ -7,7 +7,12 @@
 #include <string_view>
 #include <cstring>
 #include <limits>
+#include <mutex>
 #include "NetworkIdentity.hpp"
+#include "SpawnBatch.hpp"
+#include "Profile.hpp"
+#include "ReplicationComponent.hpp"
+#include "SystemInfo.hpp"
 
 using namespace RavEngine;
 NetworkClient* NetworkClient::currentClient = nullptr;
@@ -21,6 +26,7 @@ void RavEngine::NetworkClient::GainOwnership(ComponentHandle<NetworkIdentity> id
 }
 
 NetworkClient::NetworkClient(){
+	GetApp()->InitNetworking();
 	net_interface = SteamNetworkingSockets();
 }
 
@@ -83,6 +89,7 @@ void NetworkClient::OnSteamNetConnectionStatusChanged(SteamNetConnectionStatusCh
 			// so we just pass 0's.
 			net_interface->CloseConnection( pInfo->m_hConn, 0, nullptr, false );
 			connection = k_HSteamNetConnection_Invalid;
+			ForgetConnection(pInfo->m_hConn);
 			if(OnLostConnection){
 				OnLostConnection(pInfo->m_hConn);
 			}
@@ -129,17 +136,19 @@ void NetworkClient::SteamNetConnectionStatusChanged(SteamNetConnectionStatusChan
 }
 
 void NetworkClient::ClientTick(){
+	SystemInfo::PlaceCurrentThread(SystemInfo::ThreadRole::LatencyCritical);
+	Array<ISteamNetworkingMessage*, receiveBatchSize> received;
 	while(workerIsRunning){
-		while(workerIsRunning){
-			ISteamNetworkingMessage *pIncomingMsg = nullptr;
-			int numMsgs = net_interface->ReceiveMessagesOnConnection( connection, &pIncomingMsg, 1 );
-			if ( numMsgs == 0 ){
-				break;
-			}
-			if ( numMsgs < 0 ){
-				Debug::Fatal( "Error checking for messages" );
-			}
+		const int numMsgs = net_interface->ReceiveMessagesOnConnection( connection, received.data(), receiveBatchSize );
+		if ( numMsgs < 0 ){
+			Debug::Fatal( "Error checking for messages" );
+		}
+		for (int i = 0; i < numMsgs; i++) {
+			auto pIncomingMsg = received[i];
 				
+			// RPCs read from the message until they are processed on the main thread
+			const auto incoming = TakeMessage(pIncomingMsg);
+			RecordReceived(connection, pIncomingMsg->m_cbSize);
 			std::string_view message((char*)pIncomingMsg->m_pData, pIncomingMsg->m_cbSize);
             //get the command code (first byte in the message)
             uint8_t cmdcode = message[0];
@@ -150,8 +159,12 @@ void NetworkClient::ClientTick(){
             case NetworkBase::CommandCode::Destroy:
                 NetDestroy(message);
                 break;
+            case NetworkBase::CommandCode::SpawnBatch:
+                NetSpawnBatch(message);
+                break;
             case NetworkBase::CommandCode::RPC:
-				OnRPC(message);
+            case NetworkBase::CommandCode::CompactRPC:
+				OnRPC(message, incoming);
                 break;
 			case NetworkBase::CommandCode::OwnershipRevoked:
 				OwnershipRevoked(message);
@@ -159,16 +172,27 @@ void NetworkClient::ClientTick(){
 			case NetworkBase::CommandCode::OwnershipToThis:
 				OwnershipToThis(message);
 				break;
+			case NetworkBase::CommandCode::Replicate:
+				OnReplicate(message);
+				break;
+			case NetworkBase::CommandCode::BatchedRPCs:
+				if (!RPCBatch::Unpack(message, [this, &incoming](const std::string_view& rpc) {
+					OnRPC(rpc, incoming);
+				})) {
+					Debug::Warning("Malformed RPC batch");
+				}
+				break;
             default:
                 Debug::Warning("Invalid command code: {}",cmdcode);
             }
-			
-			// We don't need this anymore.
-			pIncomingMsg->Release();
 		}
 		
 		//state changes
 		net_interface->RunCallbacks();
+
+		if (numMsgs == 0) {
+			WaitForMessages();
+		}
 	}
 	workerHasStopped = true;
 }
@@ -182,6 +206,11 @@ void NetworkClient::NetSpawn(const std::string_view& command){
     std::memcpy(&id,command.data()+offset,sizeof(id));
     offset += sizeof(id);
     
+    // session id
+    netid_t sessionID;
+    std::memcpy(&sessionID, command.data()+offset, sizeof(sessionID));
+    offset += sizeof(sessionID);
+    
     // uuid
     char uuid_bytes[16];
     std::memcpy(uuid_bytes, command.data()+offset, 16);
@@ -193,22 +222,8 @@ void NetworkClient::NetSpawn(const std::string_view& command){
     std::memcpy(worldname, command.data()+offset, World::id_size);
     if (auto world = GetApp()->GetWorldByName(std::string(worldname,World::id_size))){
         // try to create the entity, the result of this is the entity spawned in the world
-        GetApp()->DispatchMainThread([id,world,uuid,this](){
-            if (auto e = GetApp()->networkManager.CreateEntity(id, world.value().get())){
-                // create a NetworkIdentity for this spawned entity
-                auto& eHandle = e.value();
-                auto& netid = eHandle.EmplaceComponent<NetworkIdentity>(uuid);
-                // track this entity
-                NetworkIdentities[uuid] = eHandle;
-                
-                // now invoke the netspawnhook
-                if (OnNetSpawnHooks.contains(id)) {
-                    OnNetSpawnHooks.at(id)(e.value(),world.value());
-                }
-            }
-            else{
-                Debug::Fatal("Cannot spawn entity with CTTI ID {}",id);
-            }
+        GetApp()->DispatchMainThread([id,world,uuid,sessionID,this](){
+            SpawnFromServer(id, sessionID, uuid, world.value());
         });
     }
     else{
@@ -216,25 +231,60 @@ void NetworkClient::NetSpawn(const std::string_view& command){
     }
 }
 
+void NetworkClient::NetSpawnBatch(const std::string_view& command){
+    std::string worldname;
+    Vector<SpawnBatch::Record> records;
+    if (!SpawnBatch::Decode(command, worldname, records)){
+        Debug::Warning("Malformed spawn batch");
+        return;
+    }
+    if (auto world = GetApp()->GetWorldByName(worldname)){
+        GetApp()->DispatchMainThread([records = std::move(records),world,this](){
+            for (const auto& record : records){
+                SpawnFromServer(record.type, record.sessionID, record.id, world.value());
+            }
+        });
+    }
+    else{
+        Debug::Fatal("Cannot spawn networked entities in unloaded world: {}", worldname);
+    }
+}
+
+void NetworkClient::SpawnFromServer(ctti_t id, netid_t sessionID, const uuids::uuid& uuid, Ref<World> world){
+    if (auto e = GetApp()->networkManager.CreateEntity(id, world.get())){
+        // create a NetworkIdentity for this spawned entity
+        auto& eHandle = e.value();
+        auto& netid = eHandle.EmplaceComponent<NetworkIdentity>(uuid);
+        netid.SessionID = sessionID;
+        // track this entity
+        NetworkIdentities.Set(sessionID, eHandle);
+        
+        // now invoke the netspawnhook
+        if (OnNetSpawnHooks.contains(id)) {
+            OnNetSpawnHooks.at(id)(e.value(),world);
+        }
+    }
+    else{
+        Debug::Fatal("Cannot spawn entity with CTTI ID {}",id);
+    }
+}
+
 void NetworkClient::NetDestroy(const std::string_view& command){
     //unpack the command
     uint8_t offset = 1;
     
-    //uuid
-    char uuid_bytes[16];
-    std::memcpy(uuid_bytes,command.data() + offset,16);
-    uuids::uuid uuid(uuid_bytes);
+    //session id
+    netid_t id;
+    std::memcpy(&id,command.data() + offset,sizeof(id));
         
     //lookup the entity and destroy it
-    GetApp()->DispatchMainThread([uuid,this](){
-        if (NetworkIdentities.if_contains(uuid, [&](auto entity) {
-            entity.Destroy();
-        })) {
-            //this must be here, otherwise we will encounter deadlock
-            NetworkIdentities.erase(uuid);
+    GetApp()->DispatchMainThread([id,this](){
+        if (auto entity = NetworkIdentities.Find(id)) {
+            NetworkIdentities.Erase(id);
+            entity->Destroy();
         }
         else{
-            Debug::Warning("Cannot destroy entity with UUID {} because it does not exist",uuid.to_string());
+            Debug::Warning("Cannot destroy entity with session ID {} because it does not exist",id);
         }
     });
 	
@@ -242,25 +292,27 @@ void NetworkClient::NetDestroy(const std::string_view& command){
 
 void RavEngine::NetworkClient::OwnershipRevoked(const std::string_view& cmd)
 {
-	uuids::uuid id(cmd.data() + 1);
-	bool success = NetworkIdentities.if_contains(id, [this](const auto id) {
-		RevokeOwnership(id);
-	});
-	if (!success) {
+	netid_t id;
+	std::memcpy(&id, cmd.data() + 1, sizeof(id));
+	if (auto entity = NetworkIdentities.Find(id)) {
+		RevokeOwnership(*entity);
+	}
+	else {
 		// the entity did not exist 
-		Debug::Warning("Cannot revoke ownership from an entity that does not exist, id = {}", id.to_string());
+		Debug::Warning("Cannot revoke ownership from an entity that does not exist, id = {}", id);
 	}
 }
 
 void RavEngine::NetworkClient::OwnershipToThis(const std::string_view& cmd)
 {
-	uuids::uuid netid(cmd.data() + 1);
+	netid_t netid;
+	std::memcpy(&netid, cmd.data() + 1, sizeof(netid));
     GetApp()->DispatchMainThread([netid,this](){
-        bool success = NetworkIdentities.if_contains(netid, [this](const auto id) {
-            GainOwnership(id);
-        });
-        if (!success) {
-            Debug::Warning("Cannot add ownership to an entity that does not exist, id = {}", netid.to_string());
+        if (auto entity = NetworkIdentities.Find(netid)) {
+            GainOwnership(*entity);
+        }
+        else {
+            Debug::Warning("Cannot add ownership to an entity that does not exist, id = {}", netid);
         }
     });
 }
@@ -268,21 +320,120 @@ void RavEngine::NetworkClient::OwnershipToThis(const std::string_view& cmd)
 void NetworkClient::SendMessageToServer(const std::string_view& msg, Reliability mode) const {
 	assert(msg.length() < std::numeric_limits<uint32_t>::max());	// message is too long!
 	net_interface->SendMessageToConnection(connection, msg.data(), static_cast<uint32_t>(msg.length()), mode, nullptr);
+	RecordSent(connection, msg.size(), mode);
+}
+
+void NetworkClient::QueueRPC(const std::string_view& msg, Reliability mode, bool coalesce) {
+	RecordRPCSent(msg);
+	std::lock_guard lock(outgoingRPCsLock);
+	(mode == Reliability::Reliable ? outgoingRPCs.reliable : outgoingRPCs.unreliable).Add(msg, coalesce);
+}
+
+void NetworkClient::FlushRPCs() {
+	{
+		std::lock_guard lock(outgoingRPCsLock);
+		PackRPCs(connection, outgoingRPCs, outgoingMessages);
+	}
+	SendMessages(net_interface, outgoingMessages);
 }
 
-void RavEngine::NetworkClient::OnRPC(const std::string_view& cmd)
+NetworkStats NetworkClient::GetStats() const {
+	return CollectStats(net_interface);
+}
+
+void NetworkClient::PlotStats() {
+#if RVE_PROFILE
+	const auto traffic = TakeTrafficSinceLastPlot();
+	RVE_PROFILE_PLOT("Client Bytes Sent", int64_t(traffic.bytesSent));
+	RVE_PROFILE_PLOT("Client Reliable Bytes Sent", int64_t(traffic.reliableBytesSent));
+	RVE_PROFILE_PLOT("Client Messages Sent", int64_t(traffic.messagesSent));
+	RVE_PROFILE_PLOT("Client Bytes Received", int64_t(traffic.bytesReceived));
+	RVE_PROFILE_PLOT("Client Messages Received", int64_t(traffic.messagesReceived));
+
+	SteamNetworkingQuickConnectionStatus status;
+	if (connection != k_HSteamNetConnection_Invalid && net_interface->GetQuickConnectionStatus(connection, &status)) {
+		RVE_PROFILE_PLOT("Client Ping (ms)", int64_t(status.m_nPing));
+		RVE_PROFILE_PLOT("Client Pending Bytes", int64_t(status.m_cbPendingReliable + status.m_cbPendingUnreliable));
+		RVE_PROFILE_PLOT("Client Connection Quality", std::min(status.m_flConnectionQualityLocal, status.m_flConnectionQualityRemote));
+	}
+#endif
+}
+
+void RavEngine::NetworkClient::OnRPC(const std::string_view& cmd, const MessageRef& source)
 {
+	if (cmd.size() < RPCMsgUnpacker::header_size) {
+		Debug::Warning("Malformed RPC");
+		return;
+	}
+	RecordRPCReceived(cmd);
 	//decode the RPC header to to know where it is going
-	uuids::uuid id(cmd.data() + 1);
-	bool success = NetworkIdentities.if_contains(id, [&cmd,this](auto entity) {
-        assert(entity.template HasComponent<RPCComponent>());
-        assert(entity.template HasComponent<NetworkIdentity>());
-        auto& netid = entity.template GetComponent<NetworkIdentity>();
-        entity.template GetComponent<RPCComponent>().CacheClientRPC(cmd, netid.Owner == k_HSteamNetConnection_Invalid, this->connection);
+	netid_t id;
+	std::memcpy(&id, cmd.data() + 1, sizeof(id));
+	if (auto entity = NetworkIdentities.Find(id)) {
+        assert(entity->HasComponent<RPCComponent>());
+        assert(entity->HasComponent<NetworkIdentity>());
+        auto& netid = entity->GetComponent<NetworkIdentity>();
+        entity->GetComponent<RPCComponent>().CacheClientRPC(cmd, source, netid.Owner == k_HSteamNetConnection_Invalid, this->connection);
+	}
+	else {
+		Debug::Warning("Cannot relay RPC, entity with ID {} does not exist", id);
+	}
+}
+
+void RavEngine::NetworkClient::OnReplicate(const std::string_view& cmd)
+{
+	uint32_t sequence, baselineSequence;
+	constexpr size_t headerSize = 1 + sizeof(sequence) + sizeof(baselineSequence);
+	if (cmd.size() < headerSize) {
+		Debug::Warning("Malformed replication snapshot");
+		return;
+	}
+	std::memcpy(&sequence, cmd.data() + 1, sizeof(sequence));
+	std::memcpy(&baselineSequence, cmd.data() + 1 + sizeof(sequence), sizeof(baselineSequence));
+
+	// snapshots are unreliable, so they can arrive out of order. An older one has nothing the newer one did not.
+	if (sequence <= lastReceivedSequence) {
+		return;
+	}
+	const ReplicationSnapshot* baseline = nullptr;
+	if (baselineSequence != 0) {
+		const auto& slot = receivedSnapshots[baselineSequence % replicationHistory];
+		if (!slot || slot->sequence != baselineSequence) {
+			// cannot be rebuilt. The server keeps using the last acknowledged baseline, or sends a full snapshot once that is too old.
+			return;
+		}
+		baseline = slot.get();
+	}
+	auto snapshot = std::make_shared<ReplicationSnapshot>();
+	if (!snapshot->Decode(cmd.substr(headerSize), baseline)) {
+		Debug::Warning("Malformed replication snapshot {}", sequence);
+		return;
+	}
+	snapshot->sequence = sequence;
+	receivedSnapshots[sequence % replicationHistory] = snapshot;
+	lastReceivedSequence = sequence;
+
+	char ack[1 + sizeof(sequence)];
+	ack[0] = CommandCode::ReplicationAck;
+	std::memcpy(ack + 1, &sequence, sizeof(sequence));
+	SendMessageToServer(std::string_view(ack, sizeof(ack)), Reliability::Unreliable);
+
+	GetApp()->DispatchMainThread([this, snapshot = std::shared_ptr<const ReplicationSnapshot>(std::move(snapshot))]() mutable {
+		ApplySnapshot(std::move(snapshot));
 	});
-	if (!success) {
-		Debug::Warning("Cannot relay RPC, entity with ID {} does not exist", id.to_string());
+}
+
+void RavEngine::NetworkClient::ApplySnapshot(std::shared_ptr<const ReplicationSnapshot> snapshot)
+{
+	for (const auto& entity : snapshot->GetEntities()) {
+		auto owner = NetworkIdentities.Find(entity.id);
+		// the owner is the authority on its entities
+		if (!owner || !owner->HasComponent<ReplicationComponent>() || owner->GetComponent<NetworkIdentity>().IsOwner()) {
+			continue;
+		}
+		owner->GetComponent<ReplicationComponent>().Apply(*snapshot, entity, lastAppliedSnapshot.get());
 	}
+	lastAppliedSnapshot = std::move(snapshot);
 }
 
 void RavEngine::NetworkClient::SendSyncWorldRequest(Ref<World> world) {
@@ -6,10 +6,10 @@
 using namespace RavEngine;
 using namespace std;
 
-void NetworkManager::Spawn(World* source, ctti_t id, Entity ent_id, const uuids::uuid& uuid) {
+void NetworkManager::Spawn(World* source, ctti_t id, Entity ent_id, NetworkIdentity& identity) {
 	// Running on the server?
     if (IsServer()){
-        server->SpawnEntity(source,id,ent_id,uuid);
+        server->SpawnEntity(source,id,ent_id,identity);
     }
 	else{
 		Debug::Warning("Cannot replicate entity creation from client");
@@ -19,10 +19,10 @@ void NetworkManager::Spawn(World* source, ctti_t id, Entity ent_id, const uuids:
     //instead use an RPC to have the server construct it and then spawn it
 }
 
-void NetworkManager::Destroy(const uuids::uuid& entity_id) {
+void NetworkManager::Destroy(const NetworkIdentity& identity) {
 	// ownership is server and running in the server? need to RPC clients
 	if (IsServer()){	//even if the server does not own this object, if it is destroyed here, it must be replicated
-        server->DestroyEntity(entity_id);
+        server->DestroyEntity(identity);
 	}
 	else{
 		Debug::Warning("Cannot replicate entity destruction from client");
@@ -6,12 +6,23 @@
 #include <steam/isteamnetworkingutils.h>
 #include "App.hpp"
 #include "RPCComponent.hpp"
+#include "ReplicationComponent.hpp"
+#include "Transform.hpp"
+#include "SpawnBatch.hpp"
+#include "Profile.hpp"
+#include "SystemInfo.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
 
 using namespace RavEngine;
 using namespace std;
 NetworkServer* NetworkServer::currentServer = nullptr;
 
-NetworkServer::NetworkServer() : net_interface(SteamNetworkingSockets()){}
+NetworkServer::NetworkServer(){
+	GetApp()->InitNetworking();
+	net_interface = SteamNetworkingSockets();
+}
 
 void RavEngine::NetworkServer::HandleDisconnect(HSteamNetConnection connection)
 {
@@ -19,47 +30,111 @@ void RavEngine::NetworkServer::HandleDisconnect(HSteamNetConnection connection)
         entity.GetOwner().Destroy();
     }
 	OwnershipTracker.erase(connection);
+	replicationAcks.erase(connection);
+	interests.erase(connection);
+	synchronizations.erase(connection);
+	ForgetConnection(connection);
+	{
+		std::lock_guard lock(outgoingRPCsLock);
+		outgoingRPCs.erase(connection);
+	}
 }
 
-void NetworkServer::SpawnEntity(World* source, ctti_t id, Entity ent_id, const uuids::uuid& netID) {
-	NetworkIdentities[netID] = ent_id;
-    auto message = CreateSpawnCommand(netID,id,source->worldID);
-	auto len = message.size();
-	assert(len < numeric_limits<uint32_t>::max());	// message is too long!
-    for (auto connection : clients) {
-        net_interface->SendMessageToConnection(connection, message.c_str(), static_cast<uint32_t>(len), k_nSteamNetworkingSend_Reliable, nullptr);
-    }
+void NetworkServer::SpawnEntity(World* source, ctti_t id, Entity ent_id, NetworkIdentity& identity) {
+	identity.SessionID = NetworkIdentities.Allocate(ent_id);
+	if (identity.SessionID == NetworkIDTable<Entity>::invalid) {
+		Debug::Fatal("Cannot spawn more than {} networked entities", NetworkIDTable<Entity>::maxSlots);
+	}
+	if (relevancy) {
+		// spawned on the clients it is relevant to by the next UpdateRelevancy
+		return;
+	}
+    SendMessageToAllClients(CreateSpawnCommand(identity,source->worldID), Reliability::Reliable);
 }
 
-void NetworkServer::DestroyEntity(const uuids::uuid& netID){
-	NetworkIdentities.erase(netID);
-    auto message = CreateDestroyCommand(netID);
-	auto len = message.size();
-	assert(len < numeric_limits<uint32_t>::max());	// message is too long!
-    for (auto connection : clients) {
-        net_interface->SendMessageToConnection(connection, message.c_str(), static_cast<uint32_t>(len), k_nSteamNetworkingSend_Reliable, nullptr);
-    }
+void NetworkServer::DestroyEntity(const NetworkIdentity& identity){
+	const auto netID = identity.GetSessionID();
+	NetworkIdentities.Erase(netID);
+	if (relevancy) {
+		// only the clients it was spawned on know about it
+		for (auto& [connection, interest] : interests) {
+			for (auto& [world, spawned] : interest.spawned) {
+				if (spawned.erase(netID)) {
+					SendMessageToClient(CreateDestroyCommand(netID), connection, Reliability::Reliable);
+				}
+			}
+		}
+		return;
+	}
+    SendMessageToAllClients(CreateDestroyCommand(netID), Reliability::Reliable);
 }
 
 void RavEngine::NetworkServer::SendMessageToAllClients(const std::string_view& msg, Reliability mode) const
 {
-	for (const auto connection : clients) {
-		SendMessageToClient(msg, connection, mode);
-	}
+	const Vector<HSteamNetConnection> connections(clients.begin(), clients.end());
+	SendMessagePerClient(connections, [msg](HSteamNetConnection, std::string& message) {
+		message = msg;
+	}, mode);
 }
 
 void NetworkServer::SendMessageToClient(const std::string_view& msg, HSteamNetConnection connection, Reliability mode) const{
 	assert(msg.size() < numeric_limits<uint32_t>::max());	// message is too long!
 	net_interface->SendMessageToConnection(connection, msg.data(), static_cast<uint32_t>(msg.length()), mode, nullptr);
+	RecordSent(connection, msg.size(), mode);
 }
 
 void RavEngine::NetworkServer::SendMessageToAllClientsExcept(const std::string_view& msg, HSteamNetConnection connection, Reliability mode) const
 {
+	Vector<HSteamNetConnection> connections;
+	connections.reserve(clients.size());
 	for (const auto c : clients) {
 		if (c != connection) {
-			SendMessageToClient(msg,c,mode);
+			connections.push_back(c);
+		}
+	}
+	SendMessagePerClient(connections, [msg](HSteamNetConnection, std::string& message) {
+		message = msg;
+	}, mode);
+}
+
+void RavEngine::NetworkServer::SendMessagePerClient(std::span<const HSteamNetConnection> connections, const Function<void(HSteamNetConnection, std::string&)>& encode, Reliability mode) const
+{
+	RVE_PROFILE_FN;
+	// each client's message has its own place, so the workers share nothing
+	Vector<SteamNetworkingMessage_t*> messages(connections.size(), nullptr);
+	auto assemble = [&](size_t i) {
+		std::string message;
+		encode(connections[i], message);
+		if (message.empty()) {
+			return;
+		}
+		assert(message.size() < numeric_limits<uint32_t>::max());	// message is too long!
+		auto packet = SteamNetworkingUtils()->AllocateMessage(static_cast<int>(message.size()));
+		std::memcpy(packet->m_pData, message.data(), message.size());
+		packet->m_conn = connections[i];
+		packet->m_nFlags = mode;
+		messages[i] = packet;
+	};
+
+	auto& executor = GetApp()->executor;
+	if (connections.size() < minClientsForParallelSend || executor.num_workers() <= 1) {
+		for (size_t i = 0; i < connections.size(); i++) {
+			assemble(i);
 		}
 	}
+	else {
+		tf::Taskflow sendFlow;
+		sendFlow.for_each_index(size_t(0), connections.size(), size_t(1), assemble);
+		if (executor.this_worker_id() >= 0) {
+			executor.run_and_wait(sendFlow);
+		}
+		else {
+			executor.run(sendFlow).wait();
+		}
+	}
+
+	std::erase(messages, nullptr);
+	SendMessages(net_interface, messages);
 }
 
 void NetworkServer::Start(uint16_t port){
@@ -209,21 +284,24 @@ void NetworkServer::SteamNetConnectionStatusChanged(SteamNetConnectionStatusChan
 }
 
 void NetworkServer::ServerTick(){
+	SystemInfo::PlaceCurrentThread(SystemInfo::ThreadRole::LatencyCritical);
+	Array<ISteamNetworkingMessage*, receiveBatchSize> received;
 	while(workerIsRunning){
 		
 		//get incoming messages
-		while (workerIsRunning){	//do we need this double loop?
-			ISteamNetworkingMessage *pIncomingMsg = nullptr;
-			int numMsgs = net_interface->ReceiveMessagesOnPollGroup( pollGroup, &pIncomingMsg, 1 );
-			if ( numMsgs == 0 ){
-				break;
-			}
-			if ( numMsgs < 0 ){
-				Debug::Fatal( "Error checking for messages" );
-			}
-			
+		const int numMsgs = net_interface->ReceiveMessagesOnPollGroup( pollGroup, received.data(), receiveBatchSize );
+		if ( numMsgs < 0 ){
+			Debug::Fatal( "Error checking for messages" );
+		}
+		for (int i = 0; i < numMsgs; i++) {
+			auto pIncomingMsg = received[i];
+
 			//is this from a connected client
 			assert(clients.contains(pIncomingMsg->m_conn));
+
+			// RPCs read from the message until they are processed on the main thread
+			const auto incoming = TakeMessage(pIncomingMsg);
+			RecordReceived(pIncomingMsg->m_conn, pIncomingMsg->m_cbSize);
 			
 			//figure out what to do with the message
             //get the command code (first byte in the message)
@@ -231,22 +309,34 @@ void NetworkServer::ServerTick(){
             uint8_t cmdcode = message[0];
             switch (cmdcode) {
             case NetworkBase::CommandCode::RPC:
+            case NetworkBase::CommandCode::CompactRPC:
                 //TODO: server needs to check ownership, client does not
-				OnRPC(message, pIncomingMsg->GetConnection());
+				OnRPC(message, pIncomingMsg->GetConnection(), incoming);
                 break;
 			case NetworkBase::CommandCode::ClientRequestingWorldSynchronization:
 				SynchronizeWorldToClient(pIncomingMsg->GetConnection(), message);
 				break;
+			case NetworkBase::CommandCode::ReplicationAck:
+				OnReplicationAck(message, pIncomingMsg->GetConnection());
+				break;
+			case NetworkBase::CommandCode::BatchedRPCs:
+				if (!RPCBatch::Unpack(message, [this, &incoming](const std::string_view& rpc) {
+					OnRPC(rpc, incoming->GetConnection(), incoming);
+				})) {
+					Debug::Warning("Malformed RPC batch");
+				}
+				break;
             default:
                 Debug::Warning("Invalid command code: {}",cmdcode);
             }
-			
-			//deallocate when done
-			pIncomingMsg->Release();
 		}
 				
 		//invoke callbacks
 		net_interface->RunCallbacks();
+
+		if (numMsgs == 0) {
+			WaitForMessages();
+		}
 	}
 	workerHasStopped = true;
 }
@@ -256,38 +346,91 @@ void RavEngine::NetworkServer::SynchronizeWorldToClient(HSteamNetConnection conn
     char buffer[World::id_size]{0};
 	std::memcpy(buffer, in_message.data() + 1, in_message.size() - 1);
 	string name(buffer,sizeof(buffer));
-	if (auto world = GetApp()->GetWorldByName(name)) {
-		// get all the networkidentities in the world
-		auto identities = world.value()->GetAllComponentsOfType<NetworkIdentity>();
-		// call SpawnEntity on each owner
-        
-		for (const auto& identity : *identities) {
-			auto entity = identity.GetOwner();
-			auto id = identity.GetNetTypeID();
-			auto& netID = identity.GetNetworkID();
-			//send highest-priority safe message with this info to clients
-			auto message = CreateSpawnCommand(netID, id, world.value()->worldID);
-
-			SendMessageToClient(message, connection,Reliability::Reliable);
+	if (relevancy) {
+		// the world's entities are spawned as they become relevant
+		GetApp()->DispatchMainThread([this, connection, name] {
+			if (clients.contains(connection)) {
+				interests[connection].spawned.try_emplace(name);
+			}
+		});
+		return;
+	}
+	// the world's entities are sent in batches by StreamWorldSynchronization, as the client's connection drains
+	GetApp()->DispatchMainThread([this, connection, name] {
+		auto world = GetApp()->GetWorldByName(name);
+		if (!world || !clients.contains(connection)) {
+			return;
+		}
+		WorldSynchronization synchronization{ .worldID = std::string(world.value()->worldID) };
+		world.value()->Filter([&synchronization](const NetworkIdentity& identity) {
+			synchronization.entities.push_back(identity.GetSessionID());
+		});
+		if (!synchronization.entities.empty()) {
+			synchronizations[connection].push_back(std::move(synchronization));
+		}
+	});
+}
+
+void RavEngine::NetworkServer::StreamWorldSynchronization()
+{
+	Vector<SpawnBatch::Record> records;
+	Vector<HSteamNetConnection> finished;
+	for (auto& [connection, pending] : synchronizations) {
+		while (!pending.empty()) {
+			SteamNetworkingQuickConnectionStatus status;
+			if (!net_interface->GetQuickConnectionStatus(connection, &status)) {
+				pending.clear();
+				break;
+			}
+			if (status.m_cbPendingReliable > maxPendingSynchronizationBytes) {
+				break;
+			}
+
+			// entities destroyed since the client asked are skipped, so a destroy never arrives before its spawn
+			auto& synchronization = pending.front();
+			records.clear();
+			for (; synchronization.next < synchronization.entities.size() && records.size() < SpawnBatch::recordsPerBatch; synchronization.next++) {
+				const auto id = synchronization.entities[synchronization.next];
+				if (auto entity = NetworkIdentities.Find(id)) {
+					const auto& identity = entity->GetComponent<NetworkIdentity>();
+					records.push_back({ identity.GetNetTypeID(), id, identity.GetNetworkID() });
+				}
+			}
+			if (!records.empty()) {
+				SendMessageToClient(SpawnBatch::Encode(records, synchronization.worldID), connection, Reliability::Reliable);
+			}
+			if (synchronization.next == synchronization.entities.size()) {
+				pending.pop_front();
+			}
 		}
+		if (pending.empty()) {
+			finished.push_back(connection);
+		}
+	}
+	for (const auto connection : finished) {
+		synchronizations.erase(connection);
 	}
 }
 
-void RavEngine::NetworkServer::OnRPC(const std::string_view& cmd, HSteamNetConnection origin)
+void RavEngine::NetworkServer::OnRPC(const std::string_view& cmd, HSteamNetConnection origin, const MessageRef& source)
 {
+	if (cmd.size() < RPCMsgUnpacker::header_size) {
+		Debug::Warning("Malformed RPC from {}", origin);
+		return;
+	}
+	RecordRPCReceived(cmd);
 	//decode the RPC header to to know where it is going
 
-	uuids::uuid id(cmd.data() + 1);
-	if (!NetworkIdentities.if_contains(id, [&cmd, &origin](auto entity) {
-		assert(entity.template HasComponent<NetworkIdentity>());
-		bool isOwner = origin == entity.template GetComponent<NetworkIdentity>().Owner;
-		entity.template GetComponent<RPCComponent>().CacheServerRPC(cmd, isOwner, origin);
-		})) {
-		
-            Debug::Warning("Got RPC for {} but it has not been tracked, ids = ",id.to_string());
-            for (const auto& [id,entity] : NetworkIdentities) {
-                Debug::Warning(" - UUID = {}, id = {}", id.to_string(), entity_id_t(entity.id.id));
-            }
+	netid_t id;
+	std::memcpy(&id, cmd.data() + 1, sizeof(id));
+	if (auto entity = NetworkIdentities.Find(id)) {
+		assert(entity->HasComponent<NetworkIdentity>());
+		bool isOwner = origin == entity->GetComponent<NetworkIdentity>().Owner;
+		entity->GetComponent<RPCComponent>().CacheServerRPC(cmd, source, isOwner, origin);
+	}
+	else {
+		// the entity was destroyed while the RPC was in flight
+		Debug::Warning("Got RPC for {} but it has not been tracked", id);
 	}
 }
 
@@ -310,10 +453,10 @@ void RavEngine::NetworkServer::ChangeOwnership(HSteamNetConnection newOwner, Com
 {
 	//send message revoke ownership for the existing owner, if it is not currently owned by server
 	if (object->Owner != k_HSteamNetConnection_Invalid) {
-		auto& uuid = object->GetNetworkID();
-		char msg[uuids::uuid::size() + 1];
+		const auto id = object->GetSessionID();
+		char msg[sizeof(id) + 1];
 		msg[0] = NetworkBase::CommandCode::OwnershipRevoked;
-		std::memcpy(msg + 1, uuid.raw(), uuid.size());
+		std::memcpy(msg + 1, &id, sizeof(id));
         OwnershipTracker[object->Owner].erase(object);
 		SendMessageToClient(std::string_view(msg, sizeof(msg)), object->Owner, Reliability::Reliable);
 	}
@@ -323,18 +466,297 @@ void RavEngine::NetworkServer::ChangeOwnership(HSteamNetConnection newOwner, Com
 
 	//send message to the new owner that it is now the owner, if the new owner is not the server
 	if (newOwner != k_HSteamNetConnection_Invalid) {
-		const auto& uuid = object->GetNetworkID();
-        char msg[uuids::uuid::size() + 1]{0};
+		const auto id = object->GetSessionID();
+        char msg[sizeof(id) + 1]{0};
 		msg[0] = NetworkBase::CommandCode::OwnershipToThis;
-		std::memcpy(msg + 1, uuid.raw(), uuid.size());
+		std::memcpy(msg + 1, &id, sizeof(id));
         OwnershipTracker[object->Owner].insert(object);
 		SendMessageToClient(std::string_view(msg, sizeof(msg)), object->Owner, Reliability::Reliable);
 	}
 }
 
-std::string RavEngine::NetworkServer::CreateSpawnCommand(const uuids::uuid& id, ctti_t type, std::string_view& worldID)
+bool RavEngine::NetworkServer::ClientInterest::IsSpawned(netid_t id) const
+{
+	for (const auto& [world, ids] : spawned) {
+		if (ids.contains(id)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void RavEngine::NetworkServer::EnableRelevancy(const RelevancySettings& settings)
+{
+	relevancy = settings;
+}
+
+void RavEngine::NetworkServer::SetClientViewpoint(HSteamNetConnection connection, const vector3& position)
+{
+	interests[connection].viewpoint = position;
+}
+
+void RavEngine::NetworkServer::QueueRPC(const std::string_view& msg, HSteamNetConnection connection, Reliability mode, bool coalesce)
+{
+	RecordRPCSent(msg);
+	std::lock_guard lock(outgoingRPCsLock);
+	auto& outgoing = outgoingRPCs[connection];
+	(mode == Reliability::Reliable ? outgoing.reliable : outgoing.unreliable).Add(msg, coalesce);
+}
+
+void RavEngine::NetworkServer::QueueEntityRPC(const std::string_view& msg, netid_t id, Reliability mode, bool coalesce, HSteamNetConnection except)
+{
+	if (!relevancy) {
+		for (const auto connection : clients) {
+			if (connection != except) {
+				QueueRPC(msg, connection, mode, coalesce);
+			}
+		}
+		return;
+	}
+	for (const auto& [connection, interest] : interests) {
+		if (connection != except && interest.IsSpawned(id)) {
+			QueueRPC(msg, connection, mode, coalesce);
+		}
+	}
+}
+
+void RavEngine::NetworkServer::FlushRPCs()
+{
+	{
+		std::lock_guard lock(outgoingRPCsLock);
+		for (auto& [connection, outgoing] : outgoingRPCs) {
+			PackRPCs(connection, outgoing, outgoingMessages);
+		}
+	}
+	SendMessages(net_interface, outgoingMessages);
+}
+
+NetworkStats RavEngine::NetworkServer::GetStats() const
 {
-    constexpr uint16_t size = 16 + sizeof(type) + World::id_size + 1;
+	return CollectStats(net_interface);
+}
+
+void RavEngine::NetworkServer::PlotStats()
+{
+#if RVE_PROFILE
+	const auto traffic = TakeTrafficSinceLastPlot();
+	RVE_PROFILE_PLOT("Server Bytes Sent", int64_t(traffic.bytesSent));
+	RVE_PROFILE_PLOT("Server Reliable Bytes Sent", int64_t(traffic.reliableBytesSent));
+	RVE_PROFILE_PLOT("Server Messages Sent", int64_t(traffic.messagesSent));
+	RVE_PROFILE_PLOT("Server Bytes Received", int64_t(traffic.bytesReceived));
+	RVE_PROFILE_PLOT("Server Messages Received", int64_t(traffic.messagesReceived));
+
+	// the worst connection, which is the one that limits the game
+	int maxPing = 0, maxPending = 0;
+	float minQuality = 1;
+	for (const auto connection : clients) {
+		SteamNetworkingQuickConnectionStatus status;
+		if (net_interface->GetQuickConnectionStatus(connection, &status)) {
+			maxPing = std::max(maxPing, status.m_nPing);
+			maxPending = std::max(maxPending, status.m_cbPendingReliable + status.m_cbPendingUnreliable);
+			minQuality = std::min({ minQuality, status.m_flConnectionQualityLocal, status.m_flConnectionQualityRemote });
+		}
+	}
+	RVE_PROFILE_PLOT("Server Max Ping (ms)", int64_t(maxPing));
+	RVE_PROFILE_PLOT("Server Max Pending Bytes", int64_t(maxPending));
+	RVE_PROFILE_PLOT("Server Min Connection Quality", minQuality);
+#endif
+}
+
+void RavEngine::NetworkServer::UpdateRelevancy(World* world)
+{
+	if (!relevancy) {
+		return;
+	}
+	const auto& settings = relevancy.value();
+	const std::string worldID(world->worldID);
+	const auto cellOf = [&settings](const vector3& position) {
+		return glm::ivec3(glm::floor(position / settings.cellSize));
+	};
+	const auto cellKey = [](const glm::ivec3& cell) {
+		return (uint64_t(cell.x & 0x1FFFFF) << 42) | (uint64_t(cell.y & 0x1FFFFF) << 21) | uint64_t(cell.z & 0x1FFFFF);
+	};
+
+	// bucket the world's networked entities by position, so each client only visits the cells near it
+	struct Candidate {
+		const NetworkIdentity* identity;
+		vector3 position;
+	};
+	Vector<Candidate> candidates;
+	Vector<uint32_t> everywhere;
+	UnorderedMap<netid_t, uint32_t> indexOf;
+	UnorderedMap<uint64_t, Vector<uint32_t>> grid;
+	world->Filter([&](const NetworkIdentity& identity) {
+		auto owner = identity.GetOwner();
+		const auto index = uint32_t(candidates.size());
+		indexOf.emplace(identity.GetSessionID(), index);
+		if (identity.AlwaysRelevant || !owner.HasComponent<Transform>()) {
+			candidates.push_back({ &identity, vector3(0) });
+			everywhere.push_back(index);
+			return;
+		}
+		const auto position = owner.GetComponent<Transform>().GetWorldPosition();
+		candidates.push_back({ &identity, position });
+		grid[cellKey(cellOf(position))].push_back(index);
+	});
+
+	const auto radiusSquared = settings.radius * settings.radius;
+	for (auto& [connection, interest] : interests) {
+		auto found = interest.spawned.find(worldID);
+		if (found == interest.spawned.end()) {
+			// the client has not loaded this world
+			continue;
+		}
+		UnorderedSet<netid_t> relevant;
+		for (const auto index : everywhere) {
+			relevant.insert(candidates[index].identity->GetSessionID());
+		}
+		if (auto owned = OwnershipTracker.find(connection); owned != OwnershipTracker.end()) {
+			for (const auto& handle : owned->second) {
+				const auto id = handle->GetSessionID();
+				if (indexOf.contains(id)) {
+					relevant.insert(id);
+				}
+			}
+		}
+		if (interest.viewpoint) {
+			const auto viewpoint = interest.viewpoint.value();
+			const auto lo = cellOf(viewpoint - vector3(settings.radius)), hi = cellOf(viewpoint + vector3(settings.radius));
+			for (int x = lo.x; x <= hi.x; x++) {
+				for (int y = lo.y; y <= hi.y; y++) {
+					for (int z = lo.z; z <= hi.z; z++) {
+						auto cell = grid.find(cellKey({ x, y, z }));
+						if (cell == grid.end()) {
+							continue;
+						}
+						for (const auto index : cell->second) {
+							const auto& candidate = candidates[index];
+							const auto offset = candidate.position - viewpoint;
+							if (glm::dot(offset, offset) <= radiusSquared && (!IsRelevantTo || IsRelevantTo(connection, *candidate.identity))) {
+								relevant.insert(candidate.identity->GetSessionID());
+							}
+						}
+					}
+				}
+			}
+		}
+
+		auto& spawned = found->second;
+		for (const auto& id : relevant) {
+			if (!spawned.contains(id)) {
+				SendMessageToClient(CreateSpawnCommand(*candidates[indexOf.at(id)].identity, world->worldID), connection, Reliability::Reliable);
+			}
+		}
+		for (const auto& id : spawned) {
+			if (!relevant.contains(id)) {
+				SendMessageToClient(CreateDestroyCommand(id), connection, Reliability::Reliable);
+			}
+		}
+		spawned = std::move(relevant);
+	}
+}
+
+void RavEngine::NetworkServer::CaptureReplicatedState(World* world)
+{
+	auto& snapshot = replicationHistoryRing[(replicationSequence + 1) % replicationHistory];
+	if (!replicationCaptureBegun) {
+		snapshot.Clear();
+		replicationCaptureBegun = true;
+	}
+	world->Filter([&snapshot](const NetworkIdentity& identity, const ReplicationComponent& replication) {
+		replication.Capture(snapshot, identity.GetSessionID());
+	});
+}
+
+void RavEngine::NetworkServer::SendReplicationSnapshot()
+{
+	if (!replicationCaptureBegun) {
+		return;
+	}
+	replicationCaptureBegun = false;
+	auto& snapshot = replicationHistoryRing[(replicationSequence + 1) % replicationHistory];
+	snapshot.sequence = ++replicationSequence;
+	snapshot.Finalize();
+
+	// the newest snapshot a client acknowledged that is still in the history, or 0 to send everything
+	const auto baselineFor = [this, &snapshot](HSteamNetConnection connection) -> uint32_t {
+		uint32_t baselineSequence = 0;
+		replicationAcks.if_contains(connection, [&baselineSequence](uint32_t acked) {
+			baselineSequence = acked;
+		});
+		return baselineSequence != 0 && snapshot.sequence - baselineSequence < replicationHistory ? baselineSequence : 0;
+	};
+	const auto beginMessage = [&snapshot](std::string& message, uint32_t baselineSequence) {
+		message.push_back(char(CommandCode::Replicate));
+		message.append(reinterpret_cast<const char*>(&snapshot.sequence), sizeof(snapshot.sequence));
+		message.append(reinterpret_cast<const char*>(&baselineSequence), sizeof(baselineSequence));
+	};
+	const Vector<HSteamNetConnection> connections(clients.begin(), clients.end());
+
+	if (relevancy) {
+		// each client is sent its own relevant entities, against what it was sent in the baseline. Clients are encoded in parallel,
+		// and each only touches its own interest.
+		SendMessagePerClient(connections, [&](HSteamNetConnection connection, std::string& message) {
+			auto found = interests.find(connection);
+			if (found == interests.end()) {
+				return;
+			}
+			auto& interest = found->second;
+			const auto baselineSequence = baselineFor(connection);
+			const ReplicationSnapshot* baseline = baselineSequence != 0 ? &replicationHistoryRing[baselineSequence % replicationHistory] : nullptr;
+			auto& subset = interest.replicated[snapshot.sequence % replicationHistory];
+			subset.clear();
+			for (const auto& [world, ids] : interest.spawned) {
+				for (const auto& id : ids) {
+					if (auto entity = snapshot.Find(id)) {
+						subset.push_back(uint32_t(entity - snapshot.GetEntities().data()));
+					}
+				}
+			}
+			std::sort(subset.begin(), subset.end());
+			beginMessage(message, baselineSequence);
+			snapshot.Encode(baseline, message, &subset, baseline ? &interest.replicated[baselineSequence % replicationHistory] : nullptr);
+		}, Reliability::Unreliable);
+		return;
+	}
+
+	// clients that acknowledged the same snapshot are sent the same message, so it is encoded once up front
+	UnorderedMap<uint32_t, std::string> messages;
+	UnorderedMap<HSteamNetConnection, uint32_t> baselines;
+	for (const auto connection : connections) {
+		const auto baselineSequence = baselineFor(connection);
+		baselines[connection] = baselineSequence;
+		auto [it, inserted] = messages.try_emplace(baselineSequence);
+		if (inserted) {
+			beginMessage(it->second, baselineSequence);
+			snapshot.Encode(baselineSequence != 0 ? &replicationHistoryRing[baselineSequence % replicationHistory] : nullptr, it->second);
+		}
+	}
+	SendMessagePerClient(connections, [&](HSteamNetConnection connection, std::string& message) {
+		message = messages.at(baselines.at(connection));
+	}, Reliability::Unreliable);
+}
+
+void RavEngine::NetworkServer::OnReplicationAck(const std::string_view& cmd, HSteamNetConnection connection)
+{
+	uint32_t sequence;
+	if (cmd.size() < 1 + sizeof(sequence)) {
+		Debug::Warning("Malformed replication ack");
+		return;
+	}
+	std::memcpy(&sequence, cmd.data() + 1, sizeof(sequence));
+	// acks are unreliable, so an older one can arrive after a newer one
+	replicationAcks.try_emplace_l(connection, [sequence](auto& entry) {
+		entry.second = std::max(entry.second, sequence);
+	}, sequence);
+}
+
+std::string RavEngine::NetworkServer::CreateSpawnCommand(const NetworkIdentity& identity, const std::string_view& worldID)
+{
+    const auto type = identity.GetNetTypeID();
+    const auto sessionID = identity.GetSessionID();
+    const auto& id = identity.GetNetworkID();
+    constexpr uint16_t size = 16 + sizeof(type) + sizeof(sessionID) + World::id_size + 1;
     char message[size];
     memset(message, 0, size);
 
@@ -347,6 +769,10 @@ std::string RavEngine::NetworkServer::CreateSpawnCommand(const uuids::uuid& id,
 
     offset += sizeof(type);
 
+    //set session id
+    memcpy(message + offset, &sessionID, sizeof(sessionID));
+    offset += sizeof(sessionID);
+
     //set uuid
     auto raw = id.raw();
     memcpy(message + offset, raw, 16);
@@ -359,17 +785,16 @@ std::string RavEngine::NetworkServer::CreateSpawnCommand(const uuids::uuid& id,
     return string(message,size);
 }
 
-std::string RavEngine::NetworkServer::CreateDestroyCommand(const uuids::uuid& id)
+std::string RavEngine::NetworkServer::CreateDestroyCommand(netid_t id)
 {
-    constexpr uint16_t size = 16 + 1;
+    constexpr uint16_t size = sizeof(id) + 1;
     char message[size];
     
     //set command code
     message[0] = CommandCode::Destroy;
     
-    //set uuid
-    auto raw = id.raw();
-    memcpy(message + 1, raw, 16);
+    //set session id
+    memcpy(message + 1, &id, sizeof(id));
     
     return string(message,size);
 }
@@ -0,0 +1,219 @@
+#include "OffsetAllocator.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+using namespace RavEngine;
+
+OffsetAllocator::OffsetAllocator(uint32_t size) {
+    Reset(size);
+}
+
+uint32_t OffsetAllocator::BinRoundDown(uint32_t size) {
+    // small sizes get an exact bin each, larger sizes keep their top nSecondLevelBits + 1 bits
+    if (size < nSecondLevel) {
+        return size;
+    }
+    const uint32_t log2 = 31 - std::countl_zero(size);
+    return ((log2 - (nSecondLevelBits - 1)) << nSecondLevelBits) | ((size >> (log2 - nSecondLevelBits)) & (nSecondLevel - 1));
+}
+
+uint32_t OffsetAllocator::BinLowerBound(uint32_t bin) {
+    if (bin < nSecondLevel) {
+        return bin;
+    }
+    const auto firstLevel = bin >> nSecondLevelBits;
+    return (nSecondLevel | (bin & (nSecondLevel - 1))) << (firstLevel - 1);
+}
+
+uint32_t OffsetAllocator::BinRoundUp(uint32_t size) {
+    // every region in the returned bin or above is at least size
+    const auto bin = BinRoundDown(size);
+    return BinLowerBound(bin) < size ? bin + 1 : bin;
+}
+
+OffsetAllocator::node_t OffsetAllocator::NewNode() {
+    if (freeNodes == INVALID_NODE) {
+        nodes.emplace_back();
+        return static_cast<node_t>(nodes.size() - 1);
+    }
+    const auto node = freeNodes;
+    freeNodes = nodes[node].binNext;
+    nodes[node] = Node{};
+    return node;
+}
+
+void OffsetAllocator::ReleaseNode(node_t node) {
+    nodes[node] = Node{};
+    nodes[node].binNext = freeNodes;
+    freeNodes = node;
+}
+
+void OffsetAllocator::InsertIntoBin(node_t node) {
+    const auto bin = BinRoundDown(nodes[node].size);
+    auto& n = nodes[node];
+    n.binPrev = INVALID_NODE;
+    n.binNext = binHeads[bin];
+    if (n.binNext != INVALID_NODE) {
+        nodes[n.binNext].binPrev = node;
+    }
+    binHeads[bin] = node;
+    usedSecondLevel[bin >> nSecondLevelBits] |= 1 << (bin & (nSecondLevel - 1));
+    usedFirstLevel |= 1u << (bin >> nSecondLevelBits);
+}
+
+void OffsetAllocator::RemoveFromBin(node_t node) {
+    const auto bin = BinRoundDown(nodes[node].size);
+    auto& n = nodes[node];
+    if (n.binPrev != INVALID_NODE) {
+        nodes[n.binPrev].binNext = n.binNext;
+    }
+    else {
+        binHeads[bin] = n.binNext;
+    }
+    if (n.binNext != INVALID_NODE) {
+        nodes[n.binNext].binPrev = n.binPrev;
+    }
+    n.binPrev = n.binNext = INVALID_NODE;
+
+    if (binHeads[bin] == INVALID_NODE) {
+        const auto firstLevel = bin >> nSecondLevelBits;
+        usedSecondLevel[firstLevel] &= ~(1 << (bin & (nSecondLevel - 1)));
+        if (usedSecondLevel[firstLevel] == 0) {
+            usedFirstLevel &= ~(1u << firstLevel);
+        }
+    }
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t size) {
+    size = std::max(size, 1u);
+    auto bin = BinRoundUp(size);
+    auto firstLevel = bin >> nSecondLevelBits;
+    if (firstLevel >= nFirstLevel) {
+        return {};
+    }
+
+    // a fitting bin at this first level, otherwise the smallest non-empty bin in a higher one
+    uint32_t secondLevelMask = usedSecondLevel[firstLevel] & (0xFFu << (bin & (nSecondLevel - 1)));
+    if (secondLevelMask == 0) {
+        const auto firstLevelMask = firstLevel + 1 < nFirstLevel ? usedFirstLevel & (~0u << (firstLevel + 1)) : 0;
+        if (firstLevelMask == 0) {
+            return {};
+        }
+        firstLevel = std::countr_zero(firstLevelMask);
+        secondLevelMask = usedSecondLevel[firstLevel];
+    }
+    bin = (firstLevel << nSecondLevelBits) | std::countr_zero(secondLevelMask);
+
+    const auto node = binHeads[bin];
+    RemoveFromBin(node);
+    const auto remainder = nodes[node].size - size;
+    nodes[node].size = size;
+    nodes[node].used = true;
+    freeStorage -= size;
+
+    // return the unused tail to the allocator
+    if (remainder > 0) {
+        const auto tail = NewNode();   // may reallocate nodes, so no references are held across this
+        const auto next = nodes[node].neighborNext;
+        nodes[tail].offset = nodes[node].offset + size;
+        nodes[tail].size = remainder;
+        nodes[tail].neighborPrev = node;
+        nodes[tail].neighborNext = next;
+        if (next != INVALID_NODE) {
+            nodes[next].neighborPrev = tail;
+        }
+        else {
+            lastNode = tail;
+        }
+        nodes[node].neighborNext = tail;
+        InsertIntoBin(tail);
+    }
+
+    return { nodes[node].offset, node };
+}
+
+void OffsetAllocator::Free(node_t node) {
+    assert(node < nodes.size() && nodes[node].used);
+    nodes[node].used = false;
+    freeStorage += nodes[node].size;
+
+    const auto prev = nodes[node].neighborPrev;
+    if (prev != INVALID_NODE && !nodes[prev].used) {
+        RemoveFromBin(prev);
+        nodes[node].offset = nodes[prev].offset;
+        nodes[node].size += nodes[prev].size;
+        nodes[node].neighborPrev = nodes[prev].neighborPrev;
+        if (nodes[node].neighborPrev != INVALID_NODE) {
+            nodes[nodes[node].neighborPrev].neighborNext = node;
+        }
+        ReleaseNode(prev);
+    }
+
+    const auto next = nodes[node].neighborNext;
+    if (next != INVALID_NODE && !nodes[next].used) {
+        RemoveFromBin(next);
+        nodes[node].size += nodes[next].size;
+        nodes[node].neighborNext = nodes[next].neighborNext;
+        if (nodes[node].neighborNext != INVALID_NODE) {
+            nodes[nodes[node].neighborNext].neighborPrev = node;
+        }
+        else {
+            lastNode = node;
+        }
+        ReleaseNode(next);
+    }
+
+    InsertIntoBin(node);
+}
+
+void OffsetAllocator::Grow(uint32_t newSize) {
+    assert(newSize >= capacity);
+    const auto extra = newSize - capacity;
+    if (extra == 0) {
+        return;
+    }
+    if (lastNode != INVALID_NODE && !nodes[lastNode].used) {
+        RemoveFromBin(lastNode);
+        nodes[lastNode].size += extra;
+        InsertIntoBin(lastNode);
+    }
+    else {
+        const auto tail = NewNode();
+        nodes[tail].offset = capacity;
+        nodes[tail].size = extra;
+        nodes[tail].neighborPrev = lastNode;
+        if (lastNode != INVALID_NODE) {
+            nodes[lastNode].neighborNext = tail;
+        }
+        lastNode = tail;
+        InsertIntoBin(tail);
+    }
+    capacity = newSize;
+    freeStorage += extra;
+}
+
+void OffsetAllocator::Reset(uint32_t size) {
+    nodes.clear();
+    freeNodes = INVALID_NODE;
+    lastNode = INVALID_NODE;
+    binHeads.fill(INVALID_NODE);
+    usedSecondLevel.fill(0);
+    usedFirstLevel = 0;
+    capacity = 0;
+    freeStorage = 0;
+    Grow(size);
+}
+
+uint32_t OffsetAllocator::GetLargestFreeRegion() const {
+    if (usedFirstLevel == 0) {
+        return 0;
+    }
+    const uint32_t firstLevel = 31 - std::countl_zero(usedFirstLevel);
+    const uint32_t secondLevel = 31 - std::countl_zero(uint32_t(usedSecondLevel[firstLevel]));
+    uint32_t largest = 0;
+    for (auto node = binHeads[(firstLevel << nSecondLevelBits) | secondLevel]; node != INVALID_NODE; node = nodes[node].binNext) {
+        largest = std::max(largest, nodes[node].size);
+    }
+    return largest;
+}
@@ -262,42 +262,50 @@ namespace RavEngine {
 				}
 			}
 
-			xr.swapchains.resize(view_count);
-			xr.swapchainImages.resize(view_count);
-			xr.rglSwapchainImages.resize(view_count);
-			xr.rglDepthSwapchainImages.resize(view_count);
-			for (uint32_t i = 0; i < view_count; i++) {
+			// the eyes are rendered side by side into one swapchain, so the renderer handles them as one stereo view
+			xr.stereoWidth = 0;
+			xr.stereoHeight = 0;
+			for (const auto& view : xr.viewConfigurationViews) {
+				xr.stereoWidth += view.recommendedImageRectWidth;
+				xr.stereoHeight = std::max(xr.stereoHeight, view.recommendedImageRectHeight);
+			}
+
+			xr.swapchains.resize(1);
+			xr.swapchainImages.resize(1);
+			xr.rglSwapchainImages.resize(1);
+			xr.rglDepthSwapchainImages.resize(1);
+			{
 				XrSwapchainCreateInfo swapchain_create_info{
 					.type = XR_TYPE_SWAPCHAIN_CREATE_INFO,
 					.next = nullptr,
 					.createFlags = 0,
 					.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT,
 					.format = xr.swapchain_format,
-					.sampleCount = xr.viewConfigurationViews[i].recommendedSwapchainSampleCount,
-					.width = xr.viewConfigurationViews[i].recommendedImageRectWidth,
-					.height = xr.viewConfigurationViews[i].recommendedImageRectHeight,
+					.sampleCount = xr.viewConfigurationViews[0].recommendedSwapchainSampleCount,
+					.width = xr.stereoWidth,
+					.height = xr.stereoHeight,
 					.faceCount = 1,
 					.arraySize = 1,
 					.mipCount = 1,
 				};
-				XR_CHECK(xrCreateSwapchain(xr.session, &swapchain_create_info, &xr.swapchains[i]));
+				XR_CHECK(xrCreateSwapchain(xr.session, &swapchain_create_info, &xr.swapchains[0]));
 
 				uint32_t swapchain_length;
-				XR_CHECK(xrEnumerateSwapchainImages(xr.swapchains[i], 0, &swapchain_length, nullptr));
+				XR_CHECK(xrEnumerateSwapchainImages(xr.swapchains[0], 0, &swapchain_length, nullptr));
 
-				xr.swapchainImages[i].resize(swapchain_length, { currentAPI == RGL::API::Direct3D12 ? XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR : XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR , nullptr });
-				xr.rglSwapchainImages[i].resize(swapchain_length);
-				XR_CHECK(xrEnumerateSwapchainImages(xr.swapchains[i], swapchain_length, &swapchain_length, (XrSwapchainImageBaseHeader*)xr.swapchainImages[i].data()));
+				xr.swapchainImages[0].resize(swapchain_length, { currentAPI == RGL::API::Direct3D12 ? XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR : XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR , nullptr });
+				xr.rglSwapchainImages[0].resize(swapchain_length);
+				XR_CHECK(xrEnumerateSwapchainImages(xr.swapchains[0], swapchain_length, &swapchain_length, (XrSwapchainImageBaseHeader*)xr.swapchainImages[0].data()));
 
 				// convert to RGL texture objects
 				for (uint32_t j = 0; j < swapchain_length; j++) {
-					auto& img = xr.swapchainImages[i][j];
+					auto& img = xr.swapchainImages[0][j];
 #if RGL_DX12_AVAILABLE
-					xr.rglSwapchainImages[i][j] = std::make_unique<RGL::TextureD3D12>(ComPtr<ID3D12Resource>(img.d3d12Image.texture), RGL::TextureConfig{
+					xr.rglSwapchainImages[0][j] = std::make_unique<RGL::TextureD3D12>(ComPtr<ID3D12Resource>(img.d3d12Image.texture), RGL::TextureConfig{
 						.usage = { .ColorAttachment = true },
 							.aspect = { .HasColor = true },
-							.width = xr.viewConfigurationViews[i].recommendedImageRectWidth,
-							.height = xr.viewConfigurationViews[i].recommendedImageRectHeight,
+							.width = xr.stereoWidth,
+							.height = xr.stereoHeight,
 							.format = RGL::TextureFormat::BGRA8_Unorm,
 					},
 						config.device,
@@ -314,40 +322,40 @@ namespace RavEngine {
 			}
 
 			// the process is much the same for the depth swapchain
-			xr.depth_swapchains.resize(view_count);
-			xr.depthSwapchainImages.resize(view_count);
-			for (uint32_t i = 0; i < view_count; i++) {
+			xr.depth_swapchains.resize(1);
+			xr.depthSwapchainImages.resize(1);
+			{
 				XrSwapchainCreateInfo swapchain_create_info{
 					.type = XR_TYPE_SWAPCHAIN_CREATE_INFO,
 					.next = nullptr,
 					.createFlags = 0,
 					.usageFlags = XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
 					.format = xr.depth_swapchain_format,
-					.sampleCount = xr.viewConfigurationViews[i].recommendedSwapchainSampleCount,
-					.width = xr.viewConfigurationViews[i].recommendedImageRectWidth,
-					.height = xr.viewConfigurationViews[i].recommendedImageRectHeight,
+					.sampleCount = xr.viewConfigurationViews[0].recommendedSwapchainSampleCount,
+					.width = xr.stereoWidth,
+					.height = xr.stereoHeight,
 					.faceCount = 1,
 					.arraySize = 1,
 					.mipCount = 1,
 				};
-				XR_CHECK(xrCreateSwapchain(xr.session, &swapchain_create_info, &xr.depth_swapchains[i]));
+				XR_CHECK(xrCreateSwapchain(xr.session, &swapchain_create_info, &xr.depth_swapchains[0]));
 
 				uint32_t depth_swapchain_length;
-				XR_CHECK(xrEnumerateSwapchainImages(xr.depth_swapchains[i], 0, &depth_swapchain_length, nullptr));
+				XR_CHECK(xrEnumerateSwapchainImages(xr.depth_swapchains[0], 0, &depth_swapchain_length, nullptr));
 
-				xr.depthSwapchainImages[i].resize(depth_swapchain_length, { currentAPI == RGL::API::Direct3D12 ? XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR : XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR , nullptr });
-				xr.rglDepthSwapchainImages[i].resize(depth_swapchain_length);
-				XR_CHECK(xrEnumerateSwapchainImages(xr.depth_swapchains[i], depth_swapchain_length, &depth_swapchain_length, (XrSwapchainImageBaseHeader*)xr.depthSwapchainImages[i].data()));
+				xr.depthSwapchainImages[0].resize(depth_swapchain_length, { currentAPI == RGL::API::Direct3D12 ? XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR : XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR , nullptr });
+				xr.rglDepthSwapchainImages[0].resize(depth_swapchain_length);
+				XR_CHECK(xrEnumerateSwapchainImages(xr.depth_swapchains[0], depth_swapchain_length, &depth_swapchain_length, (XrSwapchainImageBaseHeader*)xr.depthSwapchainImages[0].data()));
 
 				for (uint32_t j = 0; j < depth_swapchain_length; j++) {
-					auto& img = xr.depthSwapchainImages[i][j];
+					auto& img = xr.depthSwapchainImages[0][j];
 					if (currentAPI == RGL::API::Direct3D12) {
 #if RGL_DX12_AVAILABLE
-						xr.rglDepthSwapchainImages[i][j] = std::make_shared<RGL::TextureD3D12>(ComPtr<ID3D12Resource>(img.d3d12Image.texture), RGL::TextureConfig{
+						xr.rglDepthSwapchainImages[0][j] = std::make_shared<RGL::TextureD3D12>(ComPtr<ID3D12Resource>(img.d3d12Image.texture), RGL::TextureConfig{
 							.usage = { .Sampled = true, .DepthStencilAttachment = true },
 								.aspect = { .HasDepth = true },
-								.width = xr.viewConfigurationViews[i].recommendedImageRectWidth,
-								.height = xr.viewConfigurationViews[i].recommendedImageRectHeight,
+								.width = xr.stereoWidth,
+								.height = xr.stereoHeight,
 								.format = RGL::TextureFormat::D32SFloat
 						},
 							config.device,
@@ -378,25 +386,27 @@ namespace RavEngine {
 						};
 						VkImageView imageView;
 						vkCreateImageView(*(VkDevice*)(devicedata.vkData.device), &createInfo, nullptr, &imageView);
-						xr.rglDepthSwapchainImages[i][j] = std::make_unique<RGL::TextureVk>(std::reinterpret_pointer_cast <RGL::DeviceVk>(config.device), imageView, img.vkImage.image, RGL::Dimension{ xr.viewConfigurationViews[i].recommendedImageRectWidth, xr.viewConfigurationViews[i].recommendedImageRectHeight});
+						xr.rglDepthSwapchainImages[0][j] = std::make_unique<RGL::TextureVk>(std::reinterpret_pointer_cast <RGL::DeviceVk>(config.device), imageView, img.vkImage.image, RGL::Dimension{ xr.stereoWidth, xr.stereoHeight });
 #endif
 					}
 					
 				}
 			}
 
-			// a stereo configuration means two views, but we can handle any number
+			// a stereo configuration means two views, but we can handle any number. Each view is a rect of the shared swapchain.
 			xr.views.resize(view_count, { XR_TYPE_VIEW, nullptr });
+			xr.locatedViews.resize(view_count, { XR_TYPE_VIEW, nullptr });
 			xr.projectionViews.resize(view_count);
+			int32_t viewOffset = 0;
 			for (uint32_t i = 0; i < view_count; i++) {
 				xr.projectionViews[i] = {
 					.type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW,
 					.next = nullptr,
 					.subImage = {
-						.swapchain = xr.swapchains[i],
+						.swapchain = xr.swapchains[0],
 						.imageRect = {
 							.offset = {
-								.x = 0,
+								.x = viewOffset,
 								.y = 0
 							},
 							.extent = {
@@ -408,6 +418,7 @@ namespace RavEngine {
 					// we will fill pose and fov each frame
 				}
 				};
+				viewOffset += xr.viewConfigurationViews[i].recommendedImageRectWidth;
 			}
 			xr.depth.infos.resize(view_count);
 			for (uint32_t i = 0; i < view_count; i++) {
@@ -415,17 +426,8 @@ namespace RavEngine {
 					.type = XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR,
 					.next = nullptr,
 					.subImage = {
-						.swapchain = xr.depth_swapchains[i],
-						.imageRect = {
-							.offset = {
-								.x = 0,
-								.y = 0
-							},
-							.extent = {
-								.width = static_cast<int>(xr.viewConfigurationViews[i].recommendedImageRectWidth),
-								.height = static_cast<int>(xr.viewConfigurationViews[i].recommendedImageRectHeight)
-							}
-						},
+						.swapchain = xr.depth_swapchains[0],
+						.imageRect = xr.projectionViews[i].subImage.imageRect,
 						.imageArrayIndex = 0
 					},
 					.minDepth = 0,
@@ -438,91 +440,117 @@ namespace RavEngine {
 		}
 		std::vector<RenderViewCollection> CreateRenderTargetCollections()
 		{
-			std::vector<RenderViewCollection> collections;
 			auto& renderer = GetApp()->GetRenderEngine();
 
-			for (const auto& view : xr.viewConfigurationViews) {
-				dim_t<int> size = { int(view.recommendedImageRectWidth),int(view.recommendedImageRectHeight) };
-				auto collection = renderer.CreateRenderTargetCollection({ uint32_t(size.width),uint32_t(size.height) });
-				collections.push_back(RenderViewCollection{
-					.collection = collection,
-					.pixelDimensions = size,
-				});
-			}
-			return collections;
+			// all the eyes render into one collection, see RenderViewCollection::stereo
+			dim_t<int> size = { int(xr.stereoWidth),int(xr.stereoHeight) };
+			auto collection = renderer.CreateRenderTargetCollection({ xr.stereoWidth, xr.stereoHeight });
+			return { RenderViewCollection{
+				.collection = collection,
+				.pixelDimensions = size,
+				.stereo = xr.viewConfigurationViews.size() == 2,
+			} };
 		}
 
 		void UpdateXRTargetCollections(std::vector<RenderViewCollection>& collections, const std::vector<XrView>& views) {
-			uint32_t view_count = xr.viewConfigurationViews.size();
-			for (uint32_t i = 0; i < view_count; i++) {
-				// get the swapchain image for both color and depth			
-
-				XrSwapchainImageAcquireInfo color_acquire_info{
-					.type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO,
-					.next = nullptr,
-				};
-				uint32_t color_acquired_index;
-				XR_CHECK(xrAcquireSwapchainImage(xr.swapchains[i], &color_acquire_info, &color_acquired_index));
-				XrSwapchainImageWaitInfo waitInfo{
-					.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
-					.next = nullptr,
-					.timeout = 1000,
-				};
-				XR_CHECK(xrWaitSwapchainImage(xr.swapchains[i], &waitInfo));
-
+			// get the swapchain image for both color and depth
 
-				XrSwapchainImageAcquireInfo depth_aquire_info{
-					.type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO,
-					.next = nullptr,
-				};
-				uint32_t depth_acquired_index;
-				XR_CHECK(xrAcquireSwapchainImage(xr.depth_swapchains[i], &depth_aquire_info, &depth_acquired_index));
-				waitInfo = {
-					.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
-					.next = nullptr,
-					.timeout = 1000,
-				};
-				XR_CHECK(xrWaitSwapchainImage(xr.depth_swapchains[i], &waitInfo));
+			XrSwapchainImageAcquireInfo color_acquire_info{
+				.type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO,
+				.next = nullptr,
+			};
+			uint32_t color_acquired_index;
+			XR_CHECK(xrAcquireSwapchainImage(xr.swapchains[0], &color_acquire_info, &color_acquired_index));
+			XrSwapchainImageWaitInfo waitInfo{
+				.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
+				.next = nullptr,
+				.timeout = 1000,
+			};
+			XR_CHECK(xrWaitSwapchainImage(xr.swapchains[0], &waitInfo));
 
-				xr.projectionViews[i].pose = views[i].pose;
-				xr.projectionViews[i].fov = views[i].fov;
 
-				auto genCamPos = [](const XrPosef& pose) {
-					return glm::vec3(pose.position.x, pose.position.y, pose.position.z);
-				};
+			XrSwapchainImageAcquireInfo depth_aquire_info{
+				.type = XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO,
+				.next = nullptr,
+			};
+			uint32_t depth_acquired_index;
+			XR_CHECK(xrAcquireSwapchainImage(xr.depth_swapchains[0], &depth_aquire_info, &depth_acquired_index));
+			waitInfo = {
+				.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
+				.next = nullptr,
+				.timeout = 1000,
+			};
+			XR_CHECK(xrWaitSwapchainImage(xr.depth_swapchains[0], &waitInfo));
 
-				auto genViewMat = [](const XrPosef& pose) {
-					return glm::inverse(glm::translate(glm::mat4(1), glm::vec3(pose.position.x, pose.position.y, pose.position.z)) * (glm::toMat4(glm::quat(pose.orientation.w, pose.orientation.x, pose.orientation.y, pose.orientation.z))));
-				};
+			auto genCamPos = [](const XrPosef& pose) {
+				return glm::vec3(pose.position.x, pose.position.y, pose.position.z);
+			};
 
-				auto genProjMat = [](const XrFovf& fov, float width, float height) {
-					return glm::mat4(RMath::perspectiveProjection<float>(fov.angleRight * 2, (float)width / height, 0.1, 100));	//TODO: fix hardcoded clipping planes
-				};
-				// calculate the viewproj matrix
-				const auto& viewState = views[i];
+			auto genViewMat = [](const XrPosef& pose) {
+				return glm::inverse(glm::translate(glm::mat4(1), glm::vec3(pose.position.x, pose.position.y, pose.position.z)) * (glm::toMat4(glm::quat(pose.orientation.w, pose.orientation.x, pose.orientation.y, pose.orientation.z))));
+			};
 
-				// update the collection's viewProj
-				collections[i].camDatas = {{ .viewProj = genProjMat(xr.projectionViews[i].fov, float(xr.viewConfigurationViews[i].recommendedImageRectWidth), float(xr.viewConfigurationViews[i].recommendedImageRectHeight)) * genViewMat(xr.projectionViews[i].pose), .camPos = genCamPos(xr.projectionViews[i].pose)} };
+			auto genProjMat = [](const XrFovf& fov, float width, float height) {
+				return glm::mat4(RMath::perspectiveProjection<float>(fov.angleRight * 2, (float)width / height, 0.1, 100));	//TODO: fix hardcoded clipping planes
+			};
 
-				// update the collection's textures
-				collections[i].collection.finalFramebuffer = xr.rglSwapchainImages[i][color_acquired_index].get();
-				collections[i].collection.depthStencil = xr.rglDepthSwapchainImages[i][depth_acquired_index];
+			auto& collection = collections[0];
+			collection.camDatas.clear();
+			uint32_t view_count = xr.viewConfigurationViews.size();
+			for (uint32_t i = 0; i < view_count; i++) {
+				xr.projectionViews[i].pose = views[i].pose;
+				xr.projectionViews[i].fov = views[i].fov;
 
-				XrSwapchainImageReleaseInfo release_info{
-					.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO,
-					.next = nullptr,
+				// each eye renders into its rect of the shared target
+				const auto& rect = xr.projectionViews[i].subImage.imageRect;
+				const float width = float(rect.extent.width), height = float(rect.extent.height);
+				const auto projOnly = genProjMat(xr.projectionViews[i].fov, width, height);
+				const auto viewOnly = genViewMat(xr.projectionViews[i].pose);
+				// the lens center, where the eye usually looks, is off center in asymmetric fields of view
+				const auto& fov = xr.projectionViews[i].fov;
+				const glm::vec2 lensCenter{
+					std::tan(-fov.angleLeft) / (std::tan(fov.angleRight) - std::tan(fov.angleLeft)),
+					std::tan(fov.angleUp) / (std::tan(fov.angleUp) - std::tan(fov.angleDown)),
 				};
-				XR_CHECK(xrReleaseSwapchainImage(xr.swapchains[i], &release_info));
-				XrSwapchainImageReleaseInfo depth_release_info{
-					.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO,
-					.next = nullptr,
-				};
-				XR_CHECK(xrReleaseSwapchainImage(xr.depth_swapchains[i], &depth_release_info));
+				collection.camDatas.push_back({
+					.viewProj = projOnly * viewOnly,
+					.projOnly = projOnly,
+					.viewOnly = viewOnly,
+					.camPos = genCamPos(xr.projectionViews[i].pose),
+					.zNearFar = {0.1, 100},
+					.viewportOverride = {
+						.originFactor = { rect.offset.x / float(xr.stereoWidth), rect.offset.y / float(xr.stereoHeight) },
+						.sizeFactor = { width / float(xr.stereoWidth), height / float(xr.stereoHeight) },
+					},
+					.layers = ALL_LAYERS,
+					.fov = glm::degrees(xr.projectionViews[i].fov.angleRight * 2),
+					.targetWidth = uint32_t(width),
+					.targetHeight = uint32_t(height),
+					.foveation = {
+						.enabled = true,
+						.center = lensCenter,
+					},
+				});
 			}
+
+			// update the collection's textures
+			collection.collection.finalFramebuffer = xr.rglSwapchainImages[0][color_acquired_index].get();
+			collection.collection.depthStencil = xr.rglDepthSwapchainImages[0][depth_acquired_index];
+
+			XrSwapchainImageReleaseInfo release_info{
+				.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO,
+				.next = nullptr,
+			};
+			XR_CHECK(xrReleaseSwapchainImage(xr.swapchains[0], &release_info));
+			XrSwapchainImageReleaseInfo depth_release_info{
+				.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO,
+				.next = nullptr,
+			};
+			XR_CHECK(xrReleaseSwapchainImage(xr.depth_swapchains[0], &depth_release_info));
 		}
 
-		std::pair<std::vector<XrView>, XrFrameState> BeginXRFrame() {
-			// xr frame wait
+		XrFrameState BeginXRFrame() {
+			// blocks until the runtime's compositor wants this frame, which paces the loop to the headset
 			XrFrameState frameState{
 				.type = XR_TYPE_FRAME_STATE,
 				.next = nullptr
@@ -533,7 +561,17 @@ namespace RavEngine {
 			};
 			XR_CHECK(xrWaitFrame(xr.session, &frameWaitInfo, &frameState));
 
-			// get viewproj for the headset
+			XrFrameBeginInfo frameBeginInfo{
+				.type = XR_TYPE_FRAME_BEGIN_INFO,
+				.next = nullptr,
+			};
+			XR_CHECK(xrBeginFrame(xr.session, &frameBeginInfo));
+
+			return frameState;
+		}
+
+		const std::vector<XrView>& LocateXRViews(const XrFrameState& frameState) {
+			// the later this runs, the shorter the prediction the runtime has to make
 			XrViewLocateInfo viewLocateInfo{
 				.type = XR_TYPE_VIEW_LOCATE_INFO,
 				.next = nullptr,
@@ -541,25 +579,21 @@ namespace RavEngine {
 				.displayTime = frameState.predictedDisplayTime,
 				.space = xr.space
 			};
-			uint32_t view_count = xr.viewConfigurationViews.size();
-			std::vector<XrView> views{ view_count, { .type = XR_TYPE_VIEW, .next = nullptr } };	// note: avoid making vectors every frame
+			uint32_t view_count = xr.locatedViews.size();
 			XrViewState viewState{
 				.type = XR_TYPE_VIEW_STATE,
 				.next = nullptr,
 			};
-			XR_CHECK(xrLocateViews(xr.session, &viewLocateInfo, &viewState, view_count, &view_count, views.data()));
+			XR_CHECK(xrLocateViews(xr.session, &viewLocateInfo, &viewState, view_count, &view_count, xr.locatedViews.data()));
 
-			// begin frame
-			XrFrameBeginInfo frameBeginInfo{
-				.type = XR_TYPE_FRAME_BEGIN_INFO,
-				.next = nullptr,
-			};
-			XR_CHECK(xrBeginFrame(xr.session, &frameBeginInfo));
-
-			return std::make_pair(views,frameState);
+			constexpr XrViewStateFlags validPose = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT;
+			if ((viewState.viewStateFlags & validPose) == validPose) {
+				std::copy(xr.locatedViews.begin(), xr.locatedViews.end(), xr.views.begin());
+			}
+			return xr.views;
 		}
 
-		void EndXRFrame(XrFrameState& frameState) {
+		void EndXRFrame(const XrFrameState& frameState) {
 			uint32_t view_count = xr.viewConfigurationViews.size();
 			XrCompositionLayerProjection projectionLayer{
 			.type = XR_TYPE_COMPOSITION_LAYER_PROJECTION,
@@ -573,12 +607,13 @@ namespace RavEngine {
 				(const XrCompositionLayerBaseHeader* const)&projectionLayer
 			};
 
+			// a frame the runtime does not want rendered still has to end, with nothing in it
 			XrFrameEndInfo frameEndInfo{
 				.type = XR_TYPE_FRAME_END_INFO,
 				.next = nullptr,
 				.displayTime = frameState.predictedDisplayTime,
 				.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE,
-				.layerCount = std::size(submittedLayers),
+				.layerCount = frameState.shouldRender ? uint32_t(std::size(submittedLayers)) : 0,
 				.layers = submittedLayers,
 			};
 			XR_CHECK(xrEndFrame(xr.session, &frameEndInfo));
@@ -2,6 +2,7 @@
 #include "ParticleMaterial.hpp"
 #include "App.hpp"
 #include "Texture.hpp"
+#include "RenderTargetCollection.hpp"
 #include <RGL/Texture.hpp>
 #include <ravengine_shader_defs.h>
 
@@ -111,10 +112,12 @@ namespace RavEngine {
 					.depthFunction = hasDepthPrepass ? RGL::DepthCompareFunction::Equal : RGL::DepthCompareFunction::Greater,
 				},
 				.pipelineLayout = layout,
+				.variableShadingRate = internalConfig.mode == LightingMode::Lit,
 				.debugName = Format("ParticleMaterial {} {}",particleVS, particleFS),
 			};
 
 			userRenderPipeline = device->CreateRenderPipeline(rpd);
+			rpd.variableShadingRate = false;
 			if (hasDepthPrepass) {
 				const auto sh_name = Format("{}_fsh_depthonly", particleFS);
 				rpd.debugName = Format("ParticleMaterial DepthOnly {} {}", particleVS, particleFS);
@@ -128,6 +131,16 @@ namespace RavEngine {
 			rpd.debugName = Format("ParticleMaterial Shadow {}", particleVS);
 			rpd.depthStencilConfig.depthFunction = RGL::DepthCompareFunction::Greater;
 			shadowRenderPipeline = device->CreateRenderPipeline(rpd);
+
+			// the depth prepass has the entity ID attachment, which particles leave alone because they do not move with their emitter
+			rpd.colorBlendConfig.attachments = {
+				{
+					.format = RenderTargetCollection::entityIDFormat,
+					.colorWriteMask = RGL::ColorWriteMask(0),
+				}
+			};
+			rpd.debugName = Format("ParticleMaterial Depth Prepass {}", particleVS);
+			depthPrepassPipeline = device->CreateRenderPipeline(rpd);
 		}
 	}
 	ParticleUpdateMaterial::ParticleUpdateMaterial(const std::string_view initShaderName, const std::string_view updateShaderName)
@@ -166,6 +179,12 @@ namespace RavEngine {
 						.type = RGL::BindingType::StorageBuffer,
 						.stageFlags = RGL::BindingVisibility::Compute,
 						.writable = false,
+					},
+					{
+						.binding = 5,
+						.type = RGL::BindingType::StorageBuffer,
+						.stageFlags = RGL::BindingVisibility::Compute,
+						.writable = false,
 					}
 				},
 				.constants = {}
@@ -207,6 +226,12 @@ namespace RavEngine {
 						.stageFlags = RGL::BindingVisibility::Compute,
 						.writable = true,
 					},
+					{
+						.binding = 4,
+						.type = RGL::BindingType::StorageBuffer,
+						.stageFlags = RGL::BindingVisibility::Compute,
+						.writable = false,
+					},
 				},
 				.constants = {
 					{
@@ -0,0 +1,111 @@
+#if !RVE_SERVER
+#include "ParticlePool.hpp"
+#include "ParticleEmitter.hpp"
+#include <RGL/Device.hpp>
+#include <RGL/Buffer.hpp>
+#include <RGL/CommandBuffer.hpp>
+#include <RGL/CommandQueue.hpp>
+#include <RGL/Synchronization.hpp>
+#include <algorithm>
+#include <span>
+
+using namespace RavEngine;
+
+namespace {
+    struct BufferGrowth {
+        RGLBufferPtr& buffer;
+        uint32_t stride;
+        const char* debugName;
+        bool indirect = false;
+    };
+
+    // replace each buffer with a larger one holding the same contents
+    void GrowBuffers(RGLDevicePtr device, RGLCommandQueuePtr queue, ConcurrentQueue<RGLBufferPtr>& gcBuffers, std::span<BufferGrowth> growths, uint32_t oldElements, uint32_t newElements) {
+        auto commandBuffer = queue->CreateCommandBuffer();
+        auto fence = device->CreateFence({});
+        commandBuffer->Begin();
+        for (auto& growth : growths) {
+            auto oldBuffer = growth.buffer;
+            growth.buffer = device->CreateBuffer({
+                newElements,
+                {.StorageBuffer = true, .IndirectBuffer = growth.indirect},
+                growth.stride,
+                RGL::BufferAccess::Private,
+                {.TransferDestination = true, .Transfersource = true, .Writable = true, .debugName = growth.debugName}
+            });
+            if (oldBuffer) {
+                commandBuffer->CopyBufferToBuffer(
+                    {
+                        .buffer = oldBuffer,
+                        .offset = 0,
+                    },
+                    {
+                        .buffer = growth.buffer,
+                        .offset = 0,
+                    },
+                    oldElements * growth.stride
+                );
+                gcBuffers.enqueue(oldBuffer);
+            }
+        }
+        commandBuffer->End();
+        commandBuffer->Commit({ fence });
+        fence->Wait();
+    }
+}
+
+ParticlePool::Slot ParticlePool::Allocate(RGLDevicePtr device, RGLCommandQueuePtr queue, ConcurrentQueue<RGLBufferPtr>& gcBuffers, uint32_t maxParticles, entity_t owner) {
+    Slot slot;
+
+    if (freeStateSlots.empty()) {
+        const auto newCapacity = std::max(stateCapacity * 2, 16u);
+        BufferGrowth growths[]{
+            { emitterState, stateStride, "Particle state buffer" },
+            { drawCommands, sizeof(RGL::IndirectCommand), "Particle indirect draw buffer", true },
+        };
+        GrowBuffers(device, queue, gcBuffers, growths, stateCapacity, newCapacity);
+        for (uint32_t i = newCapacity; i > stateCapacity; i--) {
+            freeStateSlots.push_back(i - 1);
+        }
+        stateCapacity = newCapacity;
+    }
+    slot.state = freeStateSlots.back();
+    freeStateSlots.pop_back();
+
+    const uint32_t units = (maxParticles + particleAlignment - 1) / particleAlignment;
+    slot.particles = particleAllocator.Allocate(units);
+    if (!slot.particles.IsValid()) {
+        // twice the request leaves room for the allocator's size classes
+        const auto oldCapacity = particleAllocator.GetCapacity();
+        const auto newCapacity = std::max(oldCapacity * 2, oldCapacity + units * 2);
+        BufferGrowth growths[]{
+            { particleData, particleSize, "Particle Data Buffer" },
+            { particleLife, sizeof(float), "Particle life buffer" },
+            { particleFreelist, sizeof(uint32_t), "Particle freelist" },
+            { spawnedThisFrame, sizeof(uint32_t), "Particle Created This Frame Buffer" },
+            { activeParticleIndices, sizeof(uint32_t), "Alive particle index Buffer" },
+        };
+        GrowBuffers(device, queue, gcBuffers, growths, oldCapacity * particleAlignment, newCapacity * particleAlignment);
+        particleAllocator.Grow(newCapacity);
+        slot.particles = particleAllocator.Allocate(units);
+    }
+
+    emitterState->SetBufferData(EmitterState{
+        .emitterOwnerID = owner
+    }, slot.state * stateStride);
+    RGL::IndirectCommand draw{
+        .vertexCount = 4,
+        .instanceCount = 0,
+        .firstVertex = 0,
+        .firstInstance = 0,
+    };
+    drawCommands->SetBufferData(draw, slot.state * sizeof(RGL::IndirectCommand));
+
+    return slot;
+}
+
+void ParticlePool::Free(const Slot& slot) {
+    freeStateSlots.push_back(slot.state);
+    particleAllocator.Free(slot.particles.node);
+}
+#endif
@@ -0,0 +1,193 @@
+#include "PerfCounters.hpp"
+#include "Profile.hpp"
+#include "Format.hpp"
+#include <mutex>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+using namespace RavEngine;
+
+namespace {
+	// never destroyed, since counters may be updated while statics are torn down
+	struct CounterRegistry {
+		std::mutex mtx;
+		Vector<std::unique_ptr<PerfCounters::Counter>> counters;
+		Vector<std::unique_ptr<PerfCounters::Gauge>> gauges;
+		Vector<std::unique_ptr<PerfCounters::Histogram>> histograms;
+		uint64_t frame = 0;
+	};
+	CounterRegistry& Registry() {
+		static auto registry = new CounterRegistry;
+		return *registry;
+	}
+
+	template<typename T>
+	T* FindOrCreate(Vector<std::unique_ptr<T>>& entries, std::string_view name) {
+		for (const auto& entry : entries) {
+			if (entry->name == name) {
+				return entry.get();
+			}
+		}
+		return entries.emplace_back(std::make_unique<T>(name)).get();
+	}
+
+	template<typename T>
+	const T* FindByName(const Vector<T>& entries, std::string_view name) {
+		auto it = std::find_if(entries.begin(), entries.end(), [name](const T& entry) { return entry.name == name; });
+		return it != entries.end() ? &*it : nullptr;
+	}
+
+	// std::atomic<double>::fetch_add is not available on every standard library this builds with
+	void AtomicAdd(std::atomic<double>& target, double value) {
+		auto current = target.load(std::memory_order_relaxed);
+		while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed));
+	}
+
+	template<typename Compare>
+	void AtomicReplaceIf(std::atomic<double>& target, double value, Compare shouldReplace) {
+		auto current = target.load(std::memory_order_relaxed);
+		while (shouldReplace(value, current) && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+	}
+
+	constexpr int bucketOffset = 10;	// bucket 0 ends at 2^-bucketOffset
+}
+
+PerfCounters::Counter* PerfCounters::GetCounter(std::string_view name)
+{
+	auto& registry = Registry();
+	std::lock_guard guard(registry.mtx);
+	return FindOrCreate(registry.counters, name);
+}
+
+PerfCounters::Gauge* PerfCounters::GetGauge(std::string_view name)
+{
+	auto& registry = Registry();
+	std::lock_guard guard(registry.mtx);
+	return FindOrCreate(registry.gauges, name);
+}
+
+PerfCounters::Histogram* PerfCounters::GetHistogram(std::string_view name)
+{
+	auto& registry = Registry();
+	std::lock_guard guard(registry.mtx);
+	return FindOrCreate(registry.histograms, name);
+}
+
+uint32_t PerfCounters::Histogram::BucketFor(double value)
+{
+	if (!(value > 0)) {
+		return 0;
+	}
+	// value = mantissa * 2^exponent, with the mantissa in [0.5, 1)
+	int exponent;
+	std::frexp(value, &exponent);
+	return uint32_t(std::clamp(exponent + bucketOffset, 0, int(PerfSnapshot::numBuckets) - 1));
+}
+
+double PerfCounters::Histogram::BucketLimit(uint32_t bucket)
+{
+	if (bucket >= PerfSnapshot::numBuckets - 1) {
+		return std::numeric_limits<double>::infinity();
+	}
+	return std::ldexp(1.0, int(bucket) - bucketOffset);
+}
+
+void PerfCounters::Histogram::Record(double value)
+{
+	buckets[BucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	AtomicAdd(sum, value);
+	AtomicReplaceIf(min, value, std::less<double>{});
+	AtomicReplaceIf(max, value, std::greater<double>{});
+}
+
+void PerfCounters::TakeSnapshot(PerfSnapshot& snapshot)
+{
+	auto& registry = Registry();
+	std::lock_guard guard(registry.mtx);
+	snapshot.frame = ++registry.frame;
+
+	snapshot.counters.resize(registry.counters.size());
+	for (size_t i = 0; i < registry.counters.size(); i++) {
+		auto& counter = *registry.counters[i];
+		const auto total = counter.value.load(std::memory_order_relaxed);
+		snapshot.counters[i] = { counter.name, total - counter.lastSnapshot, total };
+		counter.lastSnapshot = total;
+		RVE_PROFILE_PLOT(counter.name.c_str(), int64_t(snapshot.counters[i].frame));
+	}
+
+	snapshot.gauges.resize(registry.gauges.size());
+	for (size_t i = 0; i < registry.gauges.size(); i++) {
+		auto& gauge = *registry.gauges[i];
+		snapshot.gauges[i] = { gauge.name, gauge.value.load(std::memory_order_relaxed) };
+		RVE_PROFILE_PLOT(gauge.name.c_str(), snapshot.gauges[i].value);
+	}
+
+	snapshot.histograms.resize(registry.histograms.size());
+	for (size_t i = 0; i < registry.histograms.size(); i++) {
+		auto& histogram = *registry.histograms[i];
+		auto& out = snapshot.histograms[i];
+		out.name = histogram.name;
+		out.count = histogram.count.exchange(0, std::memory_order_relaxed);
+		out.sum = histogram.sum.exchange(0, std::memory_order_relaxed);
+		out.min = histogram.min.exchange(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+		out.max = histogram.max.exchange(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+		for (uint32_t b = 0; b < PerfSnapshot::numBuckets; b++) {
+			out.buckets[b] = histogram.buckets[b].exchange(0, std::memory_order_relaxed);
+		}
+		if (out.count == 0) {
+			out.min = out.max = 0;
+		}
+		RVE_PROFILE_PLOT(histogram.name.c_str(), out.Mean());
+	}
+}
+
+double PerfSnapshot::Histogram::Percentile(double fraction) const
+{
+	if (count == 0) {
+		return 0;
+	}
+	const auto rank = std::clamp(fraction, 0.0, 1.0) * count;
+	uint64_t seen = 0;
+	for (uint32_t b = 0; b < numBuckets; b++) {
+		seen += buckets[b];
+		if (seen >= rank && seen > 0) {
+			return std::clamp(PerfCounters::Histogram::BucketLimit(b), min, max);
+		}
+	}
+	return max;
+}
+
+const PerfSnapshot::Counter* PerfSnapshot::FindCounter(std::string_view name) const
+{
+	return FindByName(counters, name);
+}
+
+const PerfSnapshot::Gauge* PerfSnapshot::FindGauge(std::string_view name) const
+{
+	return FindByName(gauges, name);
+}
+
+const PerfSnapshot::Histogram* PerfSnapshot::FindHistogram(std::string_view name) const
+{
+	return FindByName(histograms, name);
+}
+
+std::string PerfSnapshot::ToString() const
+{
+	std::string out = Format("Frame {}\n", frame);
+	out += "Counters (this frame, total)\n";
+	for (const auto& counter : counters) {
+		out += Format("  {:<48} {:>12} {:>16}\n", counter.name, counter.frame, counter.total);
+	}
+	out += "Gauges\n";
+	for (const auto& gauge : gauges) {
+		out += Format("  {:<48} {:>12.2f}\n", gauge.name, gauge.value);
+	}
+	out += "Histograms (count, mean, p50, p99, max)\n";
+	for (const auto& histogram : histograms) {
+		out += Format("  {:<48} {:>8} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}\n", histogram.name, histogram.count, histogram.Mean(), histogram.Percentile(0.5), histogram.Percentile(0.99), histogram.max);
+	}
+	return out;
+}
@@ -0,0 +1,179 @@
+#if !RVE_SERVER
+#include "PerformanceOverlay.hpp"
+#include "App.hpp"
+#include "World.hpp"
+#include "RenderEngine.hpp"
+#include "AudioPlayer.hpp"
+#include "NetworkManager.hpp"
+#include "NetworkServer.hpp"
+#include "NetworkClient.hpp"
+#include <RmlUi/Core/ElementDocument.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <vector>
+
+using namespace RavEngine;
+using namespace std;
+
+static constexpr auto documentName = "perf_overlay.rml";
+static constexpr float graphCeilingMs = 33.3f;     // a full bar. Slower frames are clipped
+
+void PerformanceOverlay::SetVisible(bool visible) {
+    if (visible == IsVisible()) {
+        return;
+    }
+    auto& renderer = GetApp()->GetRenderEngine();
+    if (visible) {
+        gpuTimingsWereEnabled = renderer.GetGPUPassTimingsEnabled();
+        renderer.SetGPUPassTimingsEnabled(true);
+        renderer.SetCommandCountsEnabled(true);
+        CreateDocument();
+    }
+    else {
+        renderer.SetGPUPassTimingsEnabled(gpuTimingsWereEnabled);
+        renderer.SetCommandCountsEnabled(false);
+        gui.reset();
+        passesText.clear();
+    }
+}
+
+void PerformanceOverlay::CreateDocument() {
+    gui.emplace(10, 10);
+    gui->AddDocument(documentName);
+    gui->ExclusiveAccess([this] {
+        auto doc = gui->GetDocument(documentName);
+        for (const auto graph : { "tick", "renderSync", "encode", "gpu" }) {
+            auto element = doc->GetElementById(graph);
+            for (uint32_t i = 0; i < historyLength; i++) {
+                element->AppendChild(doc->CreateElement("div"));
+            }
+        }
+    });
+    nextRefresh = 0;
+}
+
+void PerformanceOverlay::RecordFrame(float tickMs) {
+    if (!IsVisible()) {
+        return;
+    }
+    auto& renderer = GetApp()->GetRenderEngine();
+    const auto& timings = renderer.GetLastFrameTimings();
+    history[nextSample] = { tickMs, timings.renderSyncMs, timings.encodeMs, timings.gpuMs };
+    nextSample = (nextSample + 1) % historyLength;
+
+    // top-level passes only, merged by name, since passes such as shadowmaps repeat per light
+    std::vector<RGL::CommandCountRegion> passes;
+    for (const auto& region : renderer.GetCommandCounts()) {
+        if (region.depth != 0) {
+            continue;
+        }
+        auto it = std::find_if(passes.begin(), passes.end(), [&](const auto& pass) { return pass.label == region.label; });
+        if (it == passes.end()) {
+            passes.push_back(region);
+        }
+        else {
+            it->draws += region.draws;
+            it->dispatches += region.dispatches;
+        }
+    }
+    passesText.clear();
+    for (const auto& pass : passes) {
+        passesText += fmt::format("{}: {} draws, {} dispatches<br/>", pass.label, pass.draws, pass.dispatches);
+    }
+}
+
+GUIComponent* PerformanceOverlay::Update(uint32_t width, uint32_t height, float dpiScale) {
+    if (!IsVisible()) {
+        return nullptr;
+    }
+    gui->SetDimensions(width, height);
+    gui->SetDPIScale(dpiScale);
+    UpdateGraphs();
+    const auto now = GetApp()->GetCurrentTime();
+    if (now >= nextRefresh) {
+        UpdateText();
+        nextRefresh = now + refreshInterval;
+    }
+    gui->Update();
+    return &*gui;
+}
+
+void PerformanceOverlay::UpdateGraphs() {
+    gui->ExclusiveAccess([this] {
+        auto doc = gui->GetDocument(documentName);
+        const auto setGraph = [&](const char* id, auto member) {
+            auto element = doc->GetElementById(id);
+            // oldest on the left
+            for (uint32_t i = 0; i < historyLength; i++) {
+                const auto value = history[(nextSample + i) % historyLength].*member;
+                const auto percent = std::clamp(value / graphCeilingMs, 0.f, 1.f) * 100;
+                element->GetChild(i)->SetProperty("height", fmt::format("{:.1f}%", percent));
+            }
+        };
+        setGraph("tick", &FrameSample::tick);
+        setGraph("renderSync", &FrameSample::renderSync);
+        setGraph("encode", &FrameSample::encode);
+        setGraph("gpu", &FrameSample::gpu);
+    });
+}
+
+void PerformanceOverlay::UpdateText() {
+    // the labels show the mean over the history, which is steadier to read than the last frame
+    FrameSample mean;
+    for (const auto& sample : history) {
+        mean.tick += sample.tick;
+        mean.renderSync += sample.renderSync;
+        mean.encode += sample.encode;
+        mean.gpu += sample.gpu;
+    }
+
+    std::string systemsText;
+    if (auto world = GetApp()->GetCurrentRenderWorld()) {
+        auto stats = world->GetSystemStats();
+        std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) { return a.meanMs > b.meanMs; });
+        for (uint32_t i = 0; i < std::min<size_t>(numTopSystems, stats.size()); i++) {
+            const auto& system = stats[i];
+            systemsText += fmt::format("{}: {:.2f} ms (p99 {:.2f}){}<br/>", system.name, system.meanMs, system.p99Ms, system.onCriticalPath ? " *" : "");
+        }
+    }
+
+    auto& renderer = GetApp()->GetRenderEngine();
+    auto vramText = fmt::format("VRAM: {} / {} MB", renderer.GetCurrentVRAMUse(), renderer.GetTotalVRAM());
+    if (const auto level = renderer.GetVRAMPressureLevel(); level != VRAMPressureLevel::None) {
+        vramText += fmt::format(", pressure level {}", uint32_t(level));
+    }
+
+    std::string audioText = "Audio: inactive";
+    if (GetApp()->GetAudioActive()) {
+        const auto metrics = GetApp()->GetAudioPlayer()->GetMetrics();
+        // the time left over once a quantum is rendered, before the device needs the next one
+        const auto deadlineMs = double(AudioPlayer::GetBufferSize()) / AudioPlayer::GetSamplesPerSec() * 1000;
+        audioText = fmt::format("Audio: {:.2f} ms margin, {} underruns", deadlineMs - metrics.quantumTime.count(), metrics.underruns);
+    }
+
+    std::string networkText = "Network: offline";
+    const auto& network = GetApp()->networkManager;
+    if (network.IsServer() || network.IsClient()) {
+        const auto stats = network.IsServer() ? network.server->GetStats() : network.client->GetStats();
+        float in = 0, out = 0;
+        for (const auto& [id, connection] : stats.connections) {
+            in += connection.inBytesPerSec;
+            out += connection.outBytesPerSec;
+        }
+        networkText = fmt::format("Network: {:.1f} KB/s in, {:.1f} KB/s out, {} connections", in / 1024, out / 1024, stats.connections.size());
+    }
+
+    gui->ExclusiveAccess([&] {
+        auto doc = gui->GetDocument(documentName);
+        doc->GetElementById("tickLabel")->SetInnerRML(fmt::format("CPU tick: {:.2f} ms", mean.tick / historyLength));
+        doc->GetElementById("renderSyncLabel")->SetInnerRML(fmt::format("Render sync: {:.2f} ms", mean.renderSync / historyLength));
+        doc->GetElementById("encodeLabel")->SetInnerRML(fmt::format("Encode: {:.2f} ms", mean.encode / historyLength));
+        doc->GetElementById("gpuLabel")->SetInnerRML(fmt::format("GPU: {:.2f} ms", mean.gpu / historyLength));
+        doc->GetElementById("systems")->SetInnerRML(systemsText);
+        doc->GetElementById("passes")->SetInnerRML(passesText);
+        doc->GetElementById("vram")->SetInnerRML(vramText);
+        doc->GetElementById("audio")->SetInnerRML(audioText);
+        doc->GetElementById("network")->SetInnerRML(networkText);
+    });
+}
+#endif
@@ -87,6 +87,20 @@ void PhysicsBodyComponent::RemoveReceiver(PhysicsCallback* ptr){
     Debug::Fatal("Bug: Cannot remove item that is not bound");
 }
 
+void PhysicsBodyComponent::UpdateFilterData(){
+	if (rigidActor == nullptr) {
+		return;
+	}
+	LockWrite([&] {
+		for (auto& collider : colliders) {
+			collider->UpdateFilterData(this);
+		}
+		if (auto scene = rigidActor->getScene()) {
+			scene->resetFiltering(*rigidActor);
+		}
+	});
+}
+
 std::pair<vector3,quaternion> PhysicsBodyComponent::getDynamicsWorldPose() const{
 	PxTransform t;
 	LockRead([&] {
@@ -96,7 +110,9 @@ std::pair<vector3,quaternion> PhysicsBodyComponent::getDynamicsWorldPose() const
 }
 
 void PhysicsBodyComponent::setDynamicsWorldPose(const vector3& pos, const quaternion& quat) const{
-	setPoseNeedsSync = true;
+	// kinematic and sleeping bodies are not reported as moved by PhysX
+	auto owner = GetOwner();
+	owner.GetWorld()->Solver->RequestPoseSync(owner.GetID());
 	rigidActor->getScene()->lockWrite();
 		rigidActor->setGlobalPose(PxTransform(convert(pos), convertQuat(quat)));
 	rigidActor->getScene()->unlockWrite();
@@ -139,12 +155,14 @@ Enable or disable simulation for this body.
 */
 void RavEngine::PhysicsBodyComponent::SetSimulationEnabled(bool state)
 {
-	rigidActor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION,state);
+	LockWrite([&]{
+		rigidActor->setActorFlag(PxActorFlag::eDISABLE_SIMULATION,!state);
+	});
 }
 
 bool RavEngine::PhysicsBodyComponent::GetSimulationEnabled() const
 {
-	return rigidActor->getActorFlags() & PxActorFlag::eDISABLE_SIMULATION;
+	return !(rigidActor->getActorFlags() & PxActorFlag::eDISABLE_SIMULATION);
 }
 
 
@@ -217,6 +235,13 @@ uint16_t RavEngine::RigidBodyDynamicComponent::GetAxisLock() const{
 	return static_cast<PxRigidDynamic*>(rigidActor)->getRigidDynamicLockFlags();
 }
 
+void RavEngine::RigidBodyDynamicComponent::SetSimulationEnabled(bool state)
+{
+	// the game's choice replaces the region's
+	regionFrozen = false;
+	PhysicsBodyComponent::SetSimulationEnabled(state);
+}
+
 void RavEngine::RigidBodyDynamicComponent::Wake()
 {
 	static_cast<PxRigidDynamic*>(rigidActor)->wakeUp();
@@ -262,19 +287,22 @@ void PhysicsBodyComponent::OnColliderExit(PhysicsBodyComponent& other, const Con
 
 void PhysicsBodyComponent::OnTriggerEnter(PhysicsBodyComponent& other){
 	for (auto& receiver : receivers) {
-        receiver->OnTriggerEnter(other);
+        if (receiver->OnTriggerEnter){
+            receiver->OnTriggerEnter(other);
+        }
 	}
 }
 
 void PhysicsBodyComponent::OnTriggerExit(PhysicsBodyComponent& other){
 	for (auto& receiver : receivers) {
-        receiver->OnTriggerExit(other);
+        if (receiver->OnTriggerExit){
+            receiver->OnTriggerExit(other);
+        }
 	}
 }
 
 void RavEngine::PhysicsBodyComponent::setDynamicsWorldPoseNoLock(const vector3& pos, const quaternion& quat) const
 {
-	setPoseNeedsSync = true;
 	rigidActor->setGlobalPose(PxTransform(convert(pos), convertQuat(quat)));
 }
 
@@ -6,6 +6,12 @@
 #include "DebugDrawer.hpp"
 #include "PhysicsSolver.hpp"
 #include "Transform.hpp"
+#include "CollisionMeshCache.hpp"
+#include "Heightfield.hpp"
+#include <geometry/PxHeightFieldDesc.h>
+#include <geometry/PxHeightFieldGeometry.h>
+#include <cooking/PxCooking.h>
+#include <cmath>
 
 using namespace physx;
 using namespace RavEngine;
@@ -14,6 +20,8 @@ void PhysicsCollider::UpdateFilterData(PhysicsBodyComponent* owner){
     PxFilterData filterData;
     filterData.word0 = owner->filterGroup; // word0 = own ID
     filterData.word1 = owner->filterMask;
+    filterData.word2 = owner->GetEventFlags();    // see FilterShader
+    filterData.word3 = owner->GetWantsContactData();
     collider->setSimulationFilterData(filterData);
 }
 
@@ -61,74 +69,49 @@ MeshCollider::MeshCollider(PhysicsBodyComponent* owner, Ref<MeshAsset> meshAsset
 #endif
 {
     material = mat;
-    auto& meshdata = meshAsset->GetSystemCopy();
-    
-    RavEngine::Vector<PxVec3> vertices(meshdata.positions.size());
-    RavEngine::Vector<PxU32> indices(meshdata.indices.size());
-    // only want positional data here, UVs and other data are not relevant
-    for(int i = 0; i < vertices.size(); i++){
-        vertices[i] = PxVec3(meshdata.positions[i][0],meshdata.positions[i][1],meshdata.positions[i][2]);
-    }
-    
-    for(int i = 0; i < indices.size(); i++){
-        indices[i] = meshdata.indices[i];
-    }
-    
-    // cooking data info
-    PxTriangleMeshDesc meshDesc;
-    meshDesc.setToDefault();
-    meshDesc.points.data = &vertices[0];
-    meshDesc.points.stride = sizeof(vertices[0]);
-	assert(vertices.size() < std::numeric_limits<physx::PxU32>::max());
-    meshDesc.points.count = static_cast<physx::PxU32>(vertices.size());
-    
-	assert(indices.size() / 3 < std::numeric_limits<physx::PxU32>::max());
-    meshDesc.triangles.count = static_cast<physx::PxU32>(indices.size() / 3);
-    meshDesc.triangles.stride = 3 * sizeof(indices[0]);
-    meshDesc.triangles.data = &indices[0];
-    
-    // specify width
-    if (sizeof(indices[0]) == sizeof(uint16_t)){
-        meshDesc.flags = PxMeshFlag::e16_BIT_INDICES;
-    }    //otherwise assume 32 bit
-    
-#ifndef NDEBUG
-    //Debug::Assert(PhysicsSolver::cooking->validateTriangleMesh(meshDesc), "Triangle mesh validation failed");
-#endif
-    
-    physx::PxTriangleMesh* triMesh = PhysicsSolver::cooking->createTriangleMesh(meshDesc, PhysicsSolver::phys->getPhysicsInsertionCallback());
-    
-    collider = PxRigidActorExt::createExclusiveShape(*owner->rigidActor, PxTriangleMeshGeometry(triMesh), *material->GetPhysXmat());
-    triMesh->release();
+    // the shape holds its own reference to the cached mesh
+    collider = PxRigidActorExt::createExclusiveShape(*owner->rigidActor, PxTriangleMeshGeometry(CollisionMeshCache::GetTriangleMesh(meshAsset)), *material->GetPhysXmat());
     UpdateFilterData(owner);
 }
 
 ConvexMeshCollider::ConvexMeshCollider(PhysicsBodyComponent* owner, Ref<MeshAsset> meshAsset, Ref<PhysicsMaterial> mat) {
     material = mat;
-    
-    auto& meshdata = meshAsset->GetSystemCopy();
-    
-    // only want positional data here, UVs and other data are not relevant
-    RavEngine::Vector<PxVec3> vertices(meshdata.positions.size());
-    for(int i = 0; i < vertices.size(); i++){
-        vertices[i] = PxVec3(meshdata.positions[i][0],meshdata.positions[i][1],meshdata.positions[i][2]);
+    collider = PxRigidActorExt::createExclusiveShape(*owner->rigidActor, PxConvexMeshGeometry(CollisionMeshCache::GetConvexMesh(meshAsset)), *material->GetPhysXmat());
+    UpdateFilterData(owner);
+}
+
+HeightfieldCollider::HeightfieldCollider(PhysicsBodyComponent* owner, const Heightfield& heights, Ref<PhysicsMaterial> mat) {
+    material = mat;
+
+    // PhysX stores the heights as offsets from the middle of the range, in rows along X
+    const auto range = heights.HeightRange(0, 0, heights.width - 1, heights.depth - 1);
+    const float middle = (range.min + range.max) * 0.5f;
+    const float heightScale = std::max((range.max - range.min) / 65534.f, PX_MIN_HEIGHTFIELD_Y_SCALE);
+    Vector<PxHeightFieldSample> samples(size_t(heights.width) * heights.depth);
+    for (uint32_t x = 0; x < heights.width; x++) {
+        for (uint32_t z = 0; z < heights.depth; z++) {
+            auto& sample = samples[size_t(x) * heights.depth + z];
+            sample.height = PxI16(std::lround((heights.At(x, z) - middle) / heightScale));
+            sample.materialIndex0 = 0;
+            sample.materialIndex1 = 0;
+            // split each cell from (x, z) to (x + 1, z + 1), like Heightfield::Sample and the terrain's patches
+            sample.setTessFlag();
+        }
     }
-    
-    PxBoundedData pointdata;
-	assert(vertices.size() < std::numeric_limits<physx::PxU32>::max());
-    pointdata.count = static_cast<physx::PxU32>(vertices.size());
-    pointdata.stride = sizeof(PxVec3);
-    pointdata.data = &vertices[0];
-    
-    PxConvexMeshDesc meshDesc;
-    meshDesc.setToDefault();
-    meshDesc.points.count = static_cast<physx::PxU32>(vertices.size());
-    meshDesc.points = pointdata;
-    meshDesc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
-    
-    physx::PxConvexMesh* convMesh = PhysicsSolver::cooking->createConvexMesh(meshDesc, PhysicsSolver::phys->getPhysicsInsertionCallback());
-    
-    collider = PxRigidActorExt::createExclusiveShape(*owner->rigidActor, PxConvexMeshGeometry(convMesh), *material->GetPhysXmat());
+
+    PxHeightFieldDesc desc;
+    desc.format = PxHeightFieldFormat::eS16_TM;
+    desc.nbRows = heights.width;
+    desc.nbColumns = heights.depth;
+    desc.samples.data = samples.data();
+    desc.samples.stride = sizeof(PxHeightFieldSample);
+    auto field = PhysicsSolver::cooking->createHeightField(desc, PhysicsSolver::phys->getPhysicsInsertionCallback());
+
+    collider = PxRigidActorExt::createExclusiveShape(*owner->rigidActor, PxHeightFieldGeometry(field, PxMeshGeometryFlags(), heightScale, heights.spacing, heights.spacing), *material->GetPhysXmat());
+    // the shape holds its own reference
+    field->release();
+
+    SetRelativeTransform(vector3(0, middle, 0), quaternion(1.0, 0.0, 0.0, 0.0));
     UpdateFilterData(owner);
 }
 
@@ -11,18 +11,64 @@
 #include "Transform.hpp"
 #include "World.hpp"
 #include "PhysicsSolver.hpp"
+#include "TransformBatch.hpp"
+#include "App.hpp"
+#include <PxScene.h>
+#include <PxRigidActor.h>
+#include <algorithm>
 
 using namespace RavEngine;
 
-void PhysicsLinkSystemRead::operator()(const RigidBodyDynamicComponent& rigid, Transform& transform) const{
-    //physx requires reads and writes to be sequential
-    if (rigid.IsSleeping() && !rigid.setPoseNeedsSync){
-        return;
-    }
-    rigid.setPoseNeedsSync = false;
-    auto pose = rigid.getDynamicsWorldPose();
-    transform.SetWorldPosition(pose.first);
-    transform.SetWorldRotation(pose.second);
+void PhysicsLinkSystemRead::operator()(World* world) const{
+    auto& moved = world->Solver->movedBodies;
+
+    // a body that moved in several substeps is listed once per substep
+    std::sort(moved.begin(), moved.end(), [](entity_t a, entity_t b) {
+        return a.id < b.id || (a.id == b.id && a.version < b.version);
+    });
+    moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+
+#if !RVE_SERVER
+    // with a fixed tick rate, the render data gets interpolated matrices instead
+    const bool writeRenderMatrices = GetApp()->GetFixedTickRate() <= 0;
+    auto& worldTransforms = world->renderData.worldTransforms;
+#endif
+    auto scene = world->Solver->scene;
+    constexpr pos_t minBodiesPerChunk = 256;
+    world->DispatchParallelChunks(moved.size(), minBodiesPerChunk, [&](pos_t begin, pos_t end) {
+        // one read lock for the chunk, rather than one per body
+        scene->lockRead();
+        for (pos_t i = begin; i < end; i++) {
+            const auto id = moved[i];
+            // the body may have been destroyed since it moved
+            if (!world->CorrectVersion(id) || !world->HasComponent<RigidBodyDynamicComponent>(id)) {
+                continue;
+            }
+            const auto& rigid = world->GetComponent<RigidBodyDynamicComponent>(id);
+            auto& transform = world->GetComponent<Transform>(id);
+            const auto pose = rigid.rigidActor->getGlobalPose();
+            const vector3 position(pose.p.x, pose.p.y, pose.p.z);
+            const quaternion rotation(pose.q.w, pose.q.x, pose.q.y, pose.q.z);
+            if (transform.HasParent() || transform.children.size() > 0) {
+                transform.SetWorldPosition(position);
+                transform.SetWorldRotation(rotation);
+                continue;
+            }
+            // a root with no children: set the fields and flags once, and write its render matrix here, so the render
+            // data sync does not rebuild it. Its Transform stays dirty for everything else that reads it.
+            transform.position = position;
+            transform.rotation = rotation;
+            transform.MarkAsDirty();
+#if !RVE_SERVER
+            if (writeRenderMatrices && id.id < worldTransforms.Size()) {
+                TransformBatch::ComposeMatrix(transform.matrix, position, rotation, transform.scale, worldTransforms.GetValueAtForWriting(id.id));
+                transform.renderMatrixWritten = true;
+            }
+#endif
+        }
+        scene->unlockRead();
+    });
+    moved.clear();
 }
 
 void RavEngine::PhysicsLinkSystemWrite::before(World* world) const
@@ -36,6 +82,11 @@ void RavEngine::PhysicsLinkSystemWrite::after(World* world) const
 }
 
 void PhysicsLinkSystemWrite::operator()(const RigidBodyStaticComponent& rigid, const Transform& transform) const{
+    // only transforms that moved since the last copy need syncing
+    if (!transform.physicsPoseDirty){
+        return;
+    }
+    transform.physicsPoseDirty = false;
 
     //physx requires reads and writes to be sequential
     auto pos = transform.GetWorldPosition();
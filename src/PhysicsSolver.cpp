@@ -10,32 +10,89 @@
 #include "App.hpp"
 #include "PhysXDefines.h"
 #include "Entity.hpp"
+#include "World.hpp"
+#include "Debug.hpp"
+#include "CollisionMeshCache.hpp"
+#include "SimulationAnchor.hpp"
+#include "Transform.hpp"
+#include "MemoryTracking.hpp"
+#include "PerfCounters.hpp"
 #include <snippetcommon/SnippetPVD.h>
 #include <extensions/PxDefaultSimulationFilterShader.h>
 #define PX_RELEASE(x)    if(x)    { x->release(); x = NULL;    }
 
 #include <thread>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <utility>
 
 using namespace physx;
 using namespace std;
 using namespace RavEngine;
 
 
+namespace {
+    // PhysX requires 16 byte alignment, so the header keeps it
+    constexpr size_t allocationHeaderSize = 16;
+    const auto physxPool = MemoryTracking::GetPool("PhysX");
+}
+
+void* PhysXTrackingAllocator::allocate(size_t size, const char* typeName, const char* filename, int line) {
+    auto block = static_cast<std::byte*>(allocator.allocate(size + allocationHeaderSize, typeName, filename, line));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(block, &size, sizeof(size));
+    MemoryTracking::Allocated(physxPool, block, size);
+    return block + allocationHeaderSize;
+}
+
+void PhysXTrackingAllocator::deallocate(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto block = static_cast<std::byte*>(ptr) - allocationHeaderSize;
+    size_t size;
+    std::memcpy(&size, block, sizeof(size));
+    MemoryTracking::Freed(physxPool, block, size);
+    allocator.deallocate(block);
+}
+
 STATIC(PhysicsSolver::gDefaultErrorCallback);
 STATIC(PhysicsSolver::gDefaultAllocatorCallback);
 STATIC(PhysicsSolver::foundation) = nullptr;
 STATIC(PhysicsSolver::phys) = nullptr;
 STATIC(PhysicsSolver::pvd) = nullptr;
 STATIC(PhysicsSolver::cooking) = nullptr;
+STATIC(PhysicsSolver::cudaContextManager) = nullptr;
+STATIC(PhysicsSolver::requestGPUAcceleration) = false;
 
 
 //see https://gameworksdocs.nvidia.com/PhysX/4.1/documentation/physxguide/Manual/RigidBodyCollision.html#broad-phase-callback
+// word2 of the filter data holds the body's PhysicsBodyComponent::EventFlags, and word3 whether it wants contact points.
+// Only the events that one of the bodies wants are reported.
 PxFilterFlags FilterShader(physx::PxFilterObjectAttributes attributes0, physx::PxFilterData filterData0, physx::PxFilterObjectAttributes attributes1, physx::PxFilterData filterData1, physx::PxPairFlags & pairFlags, const void* constantBlock, physx::PxU32 constantBlockSize)
 {
+    using EventFlags = PhysicsBodyComponent::EventFlags;
+    const auto wantedEvents = filterData0.word2 | filterData1.word2;
+
     // let triggers through
     if (PxFilterObjectIsTrigger(attributes0) || PxFilterObjectIsTrigger(attributes1))
     {
-        pairFlags = PxPairFlag::eTRIGGER_DEFAULT;
+        // triggers do nothing but report
+        if (!(wantedEvents & (EventFlags::TriggerEnter | EventFlags::TriggerExit))) {
+            return PxFilterFlag::eSUPPRESS;
+        }
+        pairFlags = PxPairFlag::eDETECT_DISCRETE_CONTACT;
+        if (wantedEvents & EventFlags::TriggerEnter) {
+            pairFlags |= PxPairFlag::eNOTIFY_TOUCH_FOUND;
+        }
+        if (wantedEvents & EventFlags::TriggerExit) {
+            pairFlags |= PxPairFlag::eNOTIFY_TOUCH_LOST;
+        }
         return PxFilterFlag::eDEFAULT;
     }
     // generate contacts for all that were not filtered above
@@ -43,70 +100,94 @@ PxFilterFlags FilterShader(physx::PxFilterObjectAttributes attributes0, physx::P
 
     // trigger the contact callback for pairs (A,B) where
     // the filtermask of A contains the ID of B and vice versa.
-    if ((filterData0.word0 & filterData1.word1) && (filterData1.word0 & filterData0.word1))
-        pairFlags |= PxPairFlag::eNOTIFY_TOUCH_FOUND | PxPairFlag::eNOTIFY_TOUCH_PERSISTS | PxPairFlag::eNOTIFY_TOUCH_LOST | PxPairFlag::eNOTIFY_CONTACT_POINTS;
+    if ((filterData0.word0 & filterData1.word1) && (filterData1.word0 & filterData0.word1)) {
+        if (wantedEvents & EventFlags::ColliderEnter) {
+            pairFlags |= PxPairFlag::eNOTIFY_TOUCH_FOUND;
+        }
+        if (wantedEvents & EventFlags::ColliderPersist) {
+            pairFlags |= PxPairFlag::eNOTIFY_TOUCH_PERSISTS;
+        }
+        if (wantedEvents & EventFlags::ColliderExit) {
+            pairFlags |= PxPairFlag::eNOTIFY_TOUCH_LOST;
+        }
+        if ((wantedEvents & EventFlags::AllCollider) && (filterData0.word3 || filterData1.word3)) {
+            pairFlags |= PxPairFlag::eNOTIFY_CONTACT_POINTS;
+        }
+    }
 
     return PxFilterFlag::eDEFAULT;
 }
 
 
-// Invoked by PhysX after simulation each tick
+// Invoked by PhysX inside fetchResults. The events are only recorded here, see DispatchEvents.
 void PhysicsSolver::onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pairs, physx::PxU32 nbPairs)
 {
+    using EventFlags = PhysicsBodyComponent::EventFlags;
+    constexpr static std::pair<PxPairFlag::Enum, uint8_t> contactEvents[]{
+        {PxPairFlag::eNOTIFY_TOUCH_FOUND, EventFlags::ColliderEnter},
+        {PxPairFlag::eNOTIFY_TOUCH_LOST, EventFlags::ColliderExit},
+        {PxPairFlag::eNOTIFY_TOUCH_PERSISTS, EventFlags::ColliderPersist},
+    };
+    constexpr static PxContactPairFlag::Enum removedShapeFlags[]{ PxContactPairFlag::eREMOVED_SHAPE_0, PxContactPairFlag::eREMOVED_SHAPE_1 };
+
+    //if these actors do not exist in the scene anymore due to deallocation, do not process
+    if(pairHeader.actors[0]->userData == nullptr || pairHeader.actors[1]->userData == nullptr){
+        return;
+    }
+    entity_t ids[2];
+    memcpy(&ids[0],&pairHeader.actors[0]->userData, sizeof(ids[0]));
+    memcpy(&ids[1],&pairHeader.actors[1]->userData, sizeof(ids[1]));
+
     for (PxU32 i = 0; i < nbPairs; ++i) {
         const PxContactPair& contactpair = pairs[i];
-        
-        //if these actors do not exist in the scene anymore due to deallocation, do not process
-        if(pairHeader.actors[0]->userData == nullptr || pairHeader.actors[1]->userData == nullptr){
-            continue;
-        }
-        
-        entity_t id1, id2;
-        memcpy(&id1,&pairHeader.actors[0]->userData, sizeof(id1));
-        memcpy(&id2,&pairHeader.actors[1]->userData, sizeof(id2));
 
-        Entity actor1_e(id1,owner);
-        Entity actor2_e(id2, owner);
-        
-        auto& actor1 = actor1_e.GetAllComponentsPolymorphic<PhysicsBodyComponent>()[0];
-        auto& actor2 = actor2_e.GetAllComponentsPolymorphic<PhysicsBodyComponent>()[0];
-
-        size_t numContacts = 0;
-        stackarray(contactPoints, ContactPairPoint, contactpair.contactCount);
-        {
-            // do we need contact data?
-            if (actor1.GetWantsContactData() || actor2.GetWantsContactData()) {
-                stackarray(points, PxContactPairPoint, contactpair.contactCount);
-                auto count = contactpair.extractContacts(points, contactpair.contactCount);
-                for (int i = 0; i < contactpair.contactCount; i++) {
-                    contactPoints[i] = points[i];
-                }
-                numContacts = count;
+        // the events each side wants, from the filter data. A removed shape's data cannot be read, so its body receives nothing.
+        uint8_t wanted[2]{};
+        bool wantsContactData = false;
+        for (int side = 0; side < 2; side++) {
+            if (!(contactpair.flags & removedShapeFlags[side])) {
+                const auto filterData = contactpair.shapes[side]->getSimulationFilterData();
+                wanted[side] = filterData.word2;
+                wantsContactData |= filterData.word3 != 0;
             }
         }
-		
-        //invoke events
-        if (contactpair.events & PxPairFlag::eNOTIFY_TOUCH_FOUND) {
-
-            actor1.OnColliderEnter(actor2,contactPoints, numContacts);
-            actor2.OnColliderEnter(actor1, contactPoints, numContacts);
+        if (!((wanted[0] | wanted[1]) & EventFlags::AllCollider)) {
+            continue;
         }
 
-        if (contactpair.events & PxPairFlag::eNOTIFY_TOUCH_LOST) {
-            actor1.OnColliderExit(actor2, contactPoints, numContacts);
-            actor2.OnColliderExit(actor1, contactPoints, numContacts);
+        // both bodies' events share the pair's points
+        const auto firstContactPoint = uint32_t(bufferedContactPoints.size());
+        uint32_t numContactPoints = 0;
+        if (wantsContactData && contactpair.contactCount > 0) {
+            extractedContactPoints.resize(contactpair.contactCount);
+            numContactPoints = contactpair.extractContacts(extractedContactPoints.data(), contactpair.contactCount);
+            bufferedContactPoints.insert(bufferedContactPoints.end(), extractedContactPoints.begin(), extractedContactPoints.begin() + numContactPoints);
         }
 
-        if (contactpair.events & PxPairFlag::eNOTIFY_TOUCH_PERSISTS) {
-            actor1.OnColliderPersist(actor2, contactPoints, numContacts);
-            actor2.OnColliderPersist(actor1, contactPoints, numContacts);
+        for (const auto [pairFlag, type] : contactEvents) {
+            if (!(contactpair.events & pairFlag)) {
+                continue;
+            }
+            for (int side = 0; side < 2; side++) {
+                if (wanted[side] & type) {
+                    bufferedEvents.push_back({
+                        .receiver = ids[side],
+                        .other = ids[1 - side],
+                        .firstContactPoint = firstContactPoint,
+                        .numContactPoints = numContactPoints,
+                        .sequence = uint32_t(bufferedEvents.size()),
+                        .type = type
+                    });
+                }
+            }
         }
-
     }
 }
 
+// Invoked by PhysX inside fetchResults. The events are only recorded here, see DispatchEvents.
 void PhysicsSolver::onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count)
 {
+    using EventFlags = PhysicsBodyComponent::EventFlags;
     for (PxU32 i = 0; i < count; ++i) {
         // ignore pairs when shapes have been deleted
 		const PxTriggerPair& cp = pairs[i];
@@ -119,38 +200,109 @@ void PhysicsSolver::onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count)
             continue;
         }
         
-        entity_t id1, id2;
-        memcpy(&id1,&cp.otherActor->userData, sizeof(id1));
-        memcpy(&id2,&cp.triggerActor->userData, sizeof(id2));
-        
-        Entity other_e(id1,owner);
-        Entity trigger_e(id2, owner);
-        
-    
-        auto& other = other_e.GetAllComponentsPolymorphic<PhysicsBodyComponent>()[0];
-        auto& trigger = trigger_e.GetAllComponentsPolymorphic<PhysicsBodyComponent>()[0];
-
-		//process events
+        entity_t ids[2];
+        memcpy(&ids[0],&cp.otherActor->userData, sizeof(ids[0]));
+        memcpy(&ids[1],&cp.triggerActor->userData, sizeof(ids[1]));
+        const uint8_t wanted[2]{
+            uint8_t(cp.otherShape->getSimulationFilterData().word2),
+            uint8_t(cp.triggerShape->getSimulationFilterData().word2)
+        };
+
+		uint8_t type = 0;
 		if(cp.status & (PxPairFlag::eNOTIFY_TOUCH_FOUND)){
-			other.OnTriggerEnter(trigger);
-			trigger.OnTriggerEnter(other);
+			type = EventFlags::TriggerEnter;
 		}
-		
-		if(cp.status & (PxPairFlag::eNOTIFY_TOUCH_LOST)){
-			other.OnTriggerExit(trigger);
-			trigger.OnTriggerExit(other);
+		else if(cp.status & (PxPairFlag::eNOTIFY_TOUCH_LOST)){
+			type = EventFlags::TriggerExit;
 		}
+        for (int side = 0; side < 2; side++) {
+            if (wanted[side] & type) {
+                bufferedEvents.push_back({
+                    .receiver = ids[side],
+                    .other = ids[1 - side],
+                    .sequence = uint32_t(bufferedEvents.size()),
+                    .type = type
+                });
+            }
+        }
+    }
+}
+
+void PhysicsSolver::DispatchEvents(){
+    if (bufferedEvents.empty()) {
+        return;
     }
+    // grouped by receiver, so each body is looked up once, in the order the simulation reported them
+    std::sort(bufferedEvents.begin(), bufferedEvents.end(), [](const BufferedEvent& a, const BufferedEvent& b) {
+        return a.receiver.id != b.receiver.id ? a.receiver.id < b.receiver.id : a.sequence < b.sequence;
+    });
+
+    // receivers may destroy either body
+    auto isAlive = [this](entity_t id) {
+        return owner->CorrectVersion(id) && owner->HasComponentOfBase<PhysicsBodyComponent>(id);
+    };
+
+    using EventFlags = PhysicsBodyComponent::EventFlags;
+    for (size_t begin = 0; begin < bufferedEvents.size();) {
+        const auto receiverID = bufferedEvents[begin].receiver;
+        auto end = begin + 1;
+        while (end < bufferedEvents.size() && bufferedEvents[end].receiver == receiverID) {
+            end++;
+        }
+        if (isAlive(receiverID)) {
+            auto& receiver = owner->GetAllComponentsPolymorphic<PhysicsBodyComponent>(receiverID)[0];
+            for (auto i = begin; i < end && isAlive(receiverID); i++) {
+                const auto& event = bufferedEvents[i];
+                if (!isAlive(event.other)) {
+                    continue;
+                }
+                auto& other = owner->GetAllComponentsPolymorphic<PhysicsBodyComponent>(event.other)[0];
+                const auto contactPoints = bufferedContactPoints.data() + event.firstContactPoint;
+                switch (event.type) {
+                case EventFlags::ColliderEnter:
+                    receiver.OnColliderEnter(other, contactPoints, event.numContactPoints);
+                    break;
+                case EventFlags::ColliderPersist:
+                    receiver.OnColliderPersist(other, contactPoints, event.numContactPoints);
+                    break;
+                case EventFlags::ColliderExit:
+                    receiver.OnColliderExit(other, contactPoints, event.numContactPoints);
+                    break;
+                case EventFlags::TriggerEnter:
+                    receiver.OnTriggerEnter(other);
+                    break;
+                case EventFlags::TriggerExit:
+                    receiver.OnTriggerExit(other);
+                    break;
+                }
+            }
+        }
+        begin = end;
+    }
+    bufferedEvents.clear();
+    bufferedContactPoints.clear();
+}
+
+PhysicsSolver::~PhysicsSolver(){
+    DeallocatePhysx();
 }
 
 void PhysicsSolver::DeallocatePhysx() {
     if (scene != nullptr) {
+        // the scene cannot be released mid-simulation. Its events are dropped, the World is being torn down.
+        if (simulationInFlight) {
+            FetchInFlight();
+        }
+        bufferedEvents.clear();
+        bufferedContactPoints.clear();
         PX_RELEASE(scene);
     }
 }
 
 void PhysicsSolver::ReleaseStatics() {
+    CollisionMeshCache::Clear();
     PX_RELEASE(phys);
+    PX_RELEASE(cudaContextManager);
     PX_RELEASE(foundation);
 	PX_RELEASE(cooking);
 }
@@ -183,11 +335,64 @@ bool RavEngine::PhysicsSolver::CapsuleOverlap(const vector3& origin, const quate
 bool RavEngine::PhysicsSolver::generic_overlap(const PhysicsTransform& t, const PxGeometry& geo, OverlapHit& out_hit)
 {
     PxOverlapBuffer hit;
-    bool result = scene->overlap(geo,PxTransform(PxVec3(t.pos.x,t.pos.y,t.pos.y),PxQuat(t.rot.x,t.rot.y,t.rot.z,t.rot.w)),hit);
+    bool result = scene->overlap(geo,PxTransform(PxVec3(t.pos.x,t.pos.y,t.pos.z),PxQuat(t.rot.x,t.rot.y,t.rot.z,t.rot.w)),hit);
     out_hit = OverlapHit(hit);
     return result;
 }
 
+uint32_t PhysicsSolver::dispatch_queries(uint32_t count, FunctionRef<bool(uint32_t)> query)
+{
+    // below this, a worker spends more time being scheduled than querying
+    constexpr pos_t minQueriesPerChunk = 32;
+
+    std::atomic<uint32_t> numHits = 0;
+    owner->DispatchParallelChunks(count, minQueriesPerChunk, [this, &query, &numHits](pos_t begin, pos_t end) {
+        PxSceneReadLock lock(*scene);
+        uint32_t chunkHits = 0;
+        for (pos_t i = begin; i < end; i++) {
+            chunkHits += query(i);
+        }
+        numHits += chunkHits;
+    });
+    return numHits;
+}
+
+uint32_t PhysicsSolver::RaycastBatch(std::span<const RaycastQuery> queries, std::span<RaycastHit> out_hits)
+{
+    Debug::Assert(out_hits.size() >= queries.size(), "Not enough room for the raycast results");
+    return dispatch_queries(queries.size(), [&](uint32_t i) {
+        const auto& q = queries[i];
+        return Raycast(q.origin, q.direction, q.maxDistance, out_hits[i]);
+    });
+}
+
+uint32_t PhysicsSolver::BoxOverlapBatch(std::span<const BoxOverlapQuery> queries, std::span<OverlapHit> out_hits)
+{
+    Debug::Assert(out_hits.size() >= queries.size(), "Not enough room for the overlap results");
+    return dispatch_queries(queries.size(), [&](uint32_t i) {
+        const auto& q = queries[i];
+        return BoxOverlap(q.origin, q.rotation, q.half_ext, out_hits[i]);
+    });
+}
+
+uint32_t PhysicsSolver::SphereOverlapBatch(std::span<const SphereOverlapQuery> queries, std::span<OverlapHit> out_hits)
+{
+    Debug::Assert(out_hits.size() >= queries.size(), "Not enough room for the overlap results");
+    return dispatch_queries(queries.size(), [&](uint32_t i) {
+        const auto& q = queries[i];
+        return SphereOverlap(q.origin, q.radius, out_hits[i]);
+    });
+}
+
+uint32_t PhysicsSolver::CapsuleOverlapBatch(std::span<const CapsuleOverlapQuery> queries, std::span<OverlapHit> out_hits)
+{
+    Debug::Assert(out_hits.size() >= queries.size(), "Not enough room for the overlap results");
+    return dispatch_queries(queries.size(), [&](uint32_t i) {
+        const auto& q = queries[i];
+        return CapsuleOverlap(q.origin, q.rotation, q.radius, q.halfheight, out_hits[i]);
+    });
+}
+
 
 /**
  Make the physics system aware of an object
@@ -221,16 +426,165 @@ void PhysicsSolver::Tick(float scaleFactor){
 
     auto step = scaleFactor / (GetApp()->evalNormal / 2);
 
-    //physics substepping
-    int nsteps = ceil(step / max_step_time);
-    float step_time = step / nsteps;
+    int nsteps;
+    float step_time;
+    if (fixedTimestep) {
+        accumulatedTime += step;
+        nsteps = std::min(int(accumulatedTime / fixedStepTime), int(maxStepsPerTick));
+        step_time = fixedStepTime;
+        // whole steps beyond the clamp are dropped, the partial step carries to the next tick
+        accumulatedTime = std::fmod(accumulatedTime - nsteps * fixedStepTime, fixedStepTime);
+        if (nsteps == 0) {
+            return;
+        }
+    }
+    else {
+        //physics substepping
+        nsteps = ceil(step / max_step_time);
+        step_time = step / nsteps;
+    }
+    static auto steps = PerfCounters::GetCounter("Physics: Steps");
+    static auto stepTime = PerfCounters::GetHistogram("Physics: Tick (ms)");
+    steps->Add(nsteps);
+    const auto stepStart = std::chrono::steady_clock::now();
 	scene->lockWrite();
     for (int i = 0; i < nsteps; i++)
     {
         scene->simulate(step_time);
+        if (overlapSimulation && i == nsteps - 1) {
+            simulationInFlight = true;  // fetched by FetchResults on the next tick
+            break;
+        }
         scene->fetchResults(true);      //simulate is async, this blocks until the results have been calculated
+        CollectActiveActors();
     }
 	scene->unlockWrite();
+    stepTime->Record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stepStart).count());
+    DispatchEvents();   // outside the scene lock, so receivers can modify bodies
+}
+
+void PhysicsSolver::FetchResults(){
+    if (!simulationInFlight) {
+        return;
+    }
+    FetchInFlight();
+    DispatchEvents();
+}
+
+void PhysicsSolver::FetchInFlight(){
+    scene->lockWrite();
+    scene->fetchResults(true);
+    CollectActiveActors();
+    scene->unlockWrite();
+    simulationInFlight = false;
+}
+
+void PhysicsSolver::CollectActiveActors(){
+    // only valid until the next simulate, so the IDs are copied out
+    PxU32 numActive = 0;
+    auto activeActors = scene->getActiveActors(numActive);
+    static auto activeBodies = PerfCounters::GetGauge("Physics: Active Bodies");
+    activeBodies->Set(numActive);
+    std::lock_guard lock(movedBodiesMtx);
+    for (PxU32 i = 0; i < numActive; i++) {
+        entity_t id;
+        memcpy(&id, &activeActors[i]->userData, sizeof(id));
+        movedBodies.push_back(id);
+    }
+}
+
+void PhysicsSolver::RequestPoseSync(entity_t id){
+    std::lock_guard lock(movedBodiesMtx);
+    movedBodies.push_back(id);
+}
+
+void PhysicsSolver::UpdateSimulationRegions(){
+    // after the regions are turned off, one more update restores the frozen bodies
+    if (!useSimulationRegions && numRegionFrozen == 0) {
+        return;
+    }
+    if (++ticksSinceRegionUpdate < regionUpdateInterval) {
+        return;
+    }
+    ticksSinceRegionUpdate = 0;
+    auto bodies = owner->GetAllComponentsOfType<RigidBodyDynamicComponent>();
+    if (bodies == nullptr) {
+        return;
+    }
+
+    regionAnchors.clear();
+    if (useSimulationRegions) {
+        owner->Filter([this](const SimulationAnchor& anchor, const Transform& transform) {
+            auto pos = transform.GetWorldPosition();
+            regionAnchors.push_back({ PxVec3(pos.x, pos.y, pos.z), anchor.radius * anchor.radius });
+        });
+    }
+
+    // decide in parallel, then apply the changes under one write lock
+    regionChanges.clear();
+    std::mutex changesMtx;
+    std::atomic<uint32_t> numFrozen = 0;    // recounted, so destroyed frozen bodies are not counted
+    const float freezeScale = (1 + regionHysteresis) * (1 + regionHysteresis);
+    constexpr pos_t minBodiesPerChunk = 256;
+    owner->DispatchParallelChunks(bodies->DenseSize(), minBodiesPerChunk, [&](pos_t begin, pos_t end) {
+        Vector<pos_t> changes;
+        scene->lockRead();
+        for (pos_t i = begin; i < end; i++) {
+            const auto& body = bodies->Get(i);
+            auto dynamic = static_cast<PxRigidDynamic*>(body.rigidActor);
+            if (dynamic->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC) {
+                continue;
+            }
+            if (!body.regionFrozen && (dynamic->getActorFlags() & PxActorFlag::eDISABLE_SIMULATION)) {
+                continue;   // disabled by the game
+            }
+            const auto pos = dynamic->getGlobalPose().p;
+            const float scale = body.regionFrozen ? 1 : freezeScale;
+            bool inside = regionAnchors.empty();
+            for (const auto& anchor : regionAnchors) {
+                if ((pos - anchor.position).magnitudeSquared() <= anchor.radiusSquared * scale) {
+                    inside = true;
+                    break;
+                }
+            }
+            if (inside == body.regionFrozen) {
+                changes.push_back(i);
+            }
+            numFrozen += !inside;
+        }
+        scene->unlockRead();
+        if (!changes.empty()) {
+            std::lock_guard lock(changesMtx);
+            regionChanges.insert(regionChanges.end(), changes.begin(), changes.end());
+        }
+    });
+
+    numRegionFrozen = numFrozen;
+    if (regionChanges.empty()) {
+        return;
+    }
+    scene->lockWrite();
+    for (const auto i : regionChanges) {
+        auto& body = bodies->Get(i);
+        auto dynamic = static_cast<PxRigidDynamic*>(body.rigidActor);
+        if (body.regionFrozen) {
+            dynamic->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, false);
+            const auto& linear = body.frozenLinearVelocity;
+            const auto& angular = body.frozenAngularVelocity;
+            dynamic->setLinearVelocity(PxVec3(linear.x, linear.y, linear.z));
+            dynamic->setAngularVelocity(PxVec3(angular.x, angular.y, angular.z));
+            body.regionFrozen = false;
+        }
+        else {
+            const auto linear = dynamic->getLinearVelocity();
+            const auto angular = dynamic->getAngularVelocity();
+            body.frozenLinearVelocity = vector3(linear.x, linear.y, linear.z);
+            body.frozenAngularVelocity = vector3(angular.x, angular.y, angular.z);
+            dynamic->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, true);
+            body.regionFrozen = true;
+        }
+    }
+    scene->unlockWrite();
 }
 
 //constructor which configures PhysX
@@ -260,6 +614,35 @@ PhysicsSolver::PhysicsSolver(World* world): owner(world){
 
     desc.filterShader = FilterShader;
     desc.simulationEventCallback = this;
+    desc.flags |= PxSceneFlag::eENABLE_ACTIVE_ACTORS;     // so only moved bodies are copied to their Transforms
+
+#if PX_SUPPORT_GPU_PHYSX
+    if (requestGPUAcceleration) {
+        // only attempted once, so a machine without CUDA warns once
+        static bool cudaUnavailable = false;
+        if (cudaContextManager == nullptr && !cudaUnavailable) {
+            PxCudaContextManagerDesc cudaDesc;
+            cudaContextManager = PxCreateCudaContextManager(*foundation, cudaDesc, PxGetProfilerCallback());
+            if (cudaContextManager != nullptr && !cudaContextManager->contextIsValid()) {
+                PX_RELEASE(cudaContextManager);
+            }
+            if (cudaContextManager == nullptr) {
+                cudaUnavailable = true;
+                Debug::Warning("PhysX GPU acceleration is unavailable, simulating on the CPU");
+            }
+        }
+        if (cudaContextManager != nullptr) {
+            desc.cudaContextManager = cudaContextManager;
+            desc.flags |= PxSceneFlag::eENABLE_GPU_DYNAMICS | PxSceneFlag::eENABLE_PCM;    // the GPU solver only supports PCM contacts
+            desc.broadPhaseType = PxBroadPhaseType::eGPU;
+            gpuAccelerated = true;
+        }
+    }
+#else
+    if (requestGPUAcceleration) {
+        Debug::Warning("PhysX GPU acceleration is not supported on this platform, simulating on the CPU");
+    }
+#endif
 	
 	// initialize cooking library with defaults
 	cooking = PxCreateCooking(PX_PHYSICS_VERSION, *foundation, PxCookingParams(PxTolerancesScale()));
@@ -284,6 +667,14 @@ PhysicsSolver::PhysicsSolver(World* world): owner(world){
     
     //create the scene
     scene = phys->createScene(desc);
+    if (!scene && gpuAccelerated) {
+        Debug::Warning("PhysX GPU scene failed to create, simulating on the CPU");
+        desc.cudaContextManager = nullptr;
+        desc.flags.clear(PxSceneFlag::eENABLE_GPU_DYNAMICS);
+        desc.broadPhaseType = PxBroadPhaseType::ePABP;
+        gpuAccelerated = false;
+        scene = phys->createScene(desc);
+    }
     if (!scene) {
 		Debug::Fatal("PhysX Scene failed to create");
     }
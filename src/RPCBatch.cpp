@@ -0,0 +1,67 @@
+#include "RPCBatch.hpp"
+#include "NetworkBase.hpp"
+#include "RPCMsgUnpacker.hpp"
+#include <cstring>
+
+using namespace std;
+using namespace RavEngine;
+
+void RPCBatch::Add(const std::string_view& msg, bool coalesce)
+{
+	if (coalesce && msg.size() >= RPCMsgUnpacker::header_size) {
+		// the entity uuid and the RPC id follow the command code
+		auto [it, inserted] = coalesced.try_emplace(std::string(msg.substr(1, RPCMsgUnpacker::header_size - 1)), uint32_t(queued.size()));
+		if (!inserted) {
+			queued[it->second].assign(msg);
+			return;
+		}
+	}
+	queued.emplace_back(msg);
+}
+
+void RPCBatch::Flush(FunctionRef<void(const std::string_view&)> send)
+{
+	constexpr size_t lengthSize = sizeof(uint16_t);
+	packed.clear();
+	for (const auto& msg : queued) {
+		const bool alone = 1 + lengthSize + msg.size() > maxBatchSize;
+		if (!packed.empty() && (alone || packed.size() + lengthSize + msg.size() > maxBatchSize)) {
+			send(packed);
+			packed.clear();
+		}
+		if (alone) {
+			send(msg);
+			continue;
+		}
+		if (packed.empty()) {
+			packed.push_back(char(NetworkBase::CommandCode::BatchedRPCs));
+		}
+		const auto length = uint16_t(msg.size());
+		packed.append(reinterpret_cast<const char*>(&length), lengthSize);
+		packed.append(msg);
+	}
+	if (!packed.empty()) {
+		send(packed);
+	}
+	queued.clear();
+	coalesced.clear();
+}
+
+bool RPCBatch::Unpack(const std::string_view& batch, FunctionRef<void(const std::string_view&)> each)
+{
+	size_t offset = 1;
+	while (offset < batch.size()) {
+		uint16_t length;
+		if (offset + sizeof(length) > batch.size()) {
+			return false;
+		}
+		std::memcpy(&length, batch.data() + offset, sizeof(length));
+		offset += sizeof(length);
+		if (length == 0 || offset + length > batch.size()) {
+			return false;
+		}
+		each(batch.substr(offset, length));
+		offset += length;
+	}
+	return true;
+}
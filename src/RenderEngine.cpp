@@ -18,6 +18,7 @@
 #include <RmlUi/Debugger.h>
 #include "Utilities.hpp"
 #include "InputManager.hpp"
+#include "Window.hpp"
 #include "AnimatorComponent.hpp"
 #include "Skybox.hpp"
 
@@ -33,9 +34,14 @@
 #include "DebugDrawer.hpp"
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <fstream>
+#include <filesystem>
 #include "Debug.hpp"
+#include "PerfCounters.hpp"
 #include <chrono>
 #include <cstdio>
+#include <limits>
+#include <bit>
 #include <RGL/RGL.hpp>
 #include <RGL/Device.hpp>
 #include <RGL/Synchronization.hpp>
@@ -300,12 +306,31 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
         Debug::Fatal("Cannot proceed: device \"{}\" is under the minimum spec!", device->GetBrandString());
     }
 #endif
+
+	if (config.enablePipelineCache) {
+		if (!config.pipelineCachePath.empty()) {
+			pipelineCachePath = config.pipelineCachePath;
+		}
+		else if (auto prefPath = SDL_GetPrefPath("RavEngine", "PipelineCache")) {
+			pipelineCachePath = std::filesystem::path(prefPath) / Format("{}.bin", RGL::APIToString(RGL::CurrentAPI()));
+			SDL_free(prefPath);
+		}
+	}
+	// before any pipelines are created, so the engine's own pipelines benefit too
+	LoadPipelineCache();
     
 	mainCommandQueue = device->CreateCommandQueue(RGL::QueueType::AllCommands);
 	mainCommandBuffer = mainCommandQueue->CreateCommandBuffer();
     transformSyncCommandBuffer = mainCommandQueue->CreateCommandBuffer();
     transientCommandBuffer = mainCommandQueue->CreateCommandBuffer();
+    meshUploadCommandBuffer = mainCommandQueue->CreateCommandBuffer();
+	asyncComputeQueue = device->CreateCommandQueue(RGL::QueueType::ComputeOnly);
+	asyncComputeCommandBuffer = asyncComputeQueue->CreateCommandBuffer();
 	textureSampler = device->CreateSampler({});
+	materialTextureSampler = device->CreateSampler({
+		.minFilter = RGL::MinMagFilterMode::Linear,
+		.mipFilter = RGL::MipFilterMode::Linear
+	});
 	shadowSampler = device->CreateSampler({
 		.addressModeU = RGL::SamplerAddressMode::Border,
 		.addressModeV = RGL::SamplerAddressMode::Border,
@@ -384,6 +409,11 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 				   .loadOp = RGL::LoadAccessOperation::Clear,
 				   .storeOp = RGL::StoreAccessOperation::Store,
 			   },
+			   {
+				   .format = RenderTargetCollection::entityIDFormat,
+				   .loadOp = RGL::LoadAccessOperation::Clear,
+				   .storeOp = RGL::StoreAccessOperation::Store,
+			   },
 		   },
 		   .depthAttachment = RGL::RenderPassConfig::AttachmentDesc{
 			   .format = RGL::TextureFormat::D32SFloat,
@@ -549,8 +579,24 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 		}
 	});
 
-	depthPrepassRenderPass = RGL::CreateRenderPass({
+	// draws dynamic casters over a copied static shadow layer
+	shadowRenderPassLoad = RGL::CreateRenderPass({
 		.attachments = {},
+		.depthAttachment = RGL::RenderPassConfig::AttachmentDesc{
+			.format = RGL::TextureFormat::D32SFloat,
+			.loadOp = RGL::LoadAccessOperation::Load,
+			.storeOp = RGL::StoreAccessOperation::Store,
+		}
+	});
+
+	depthPrepassRenderPass = RGL::CreateRenderPass({
+		.attachments = {
+			{
+				.format = RenderTargetCollection::entityIDFormat,
+				.loadOp = RGL::LoadAccessOperation::Load,
+				.storeOp = RGL::StoreAccessOperation::Store,
+			},
+		},
 		.depthAttachment = RGL::RenderPassConfig::AttachmentDesc{
 			.format = RGL::TextureFormat::D32SFloat,
 			.loadOp = RGL::LoadAccessOperation::Load,
@@ -581,6 +627,15 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
         }
     );
 
+	shadowAtlasTexture = device->CreateTexture({
+		.usage = {.TransferDestination = true, .Sampled = true, .DepthStencilAttachment = true },
+		.aspect = {.HasDepth = true },
+		.width = shadowAtlasSize,
+		.height = shadowAtlasSize,
+		.format = RGL::TextureFormat::D32SFloat,
+		.debugName = "Spot and Point Light Shadow Atlas"
+	});
+
 	// create lighting render pipelines
 	constexpr static uint32_t width = 640, height = 480;
 
@@ -696,21 +751,14 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 			.pipelineLayout = guiPipelineLayout,
 		});
 
-	transientBuffer = device->CreateBuffer({
-		65536,
-		{.StorageBuffer = true},
-		sizeof(char),
-		RGL::BufferAccess::Private,
-		{.TransferDestination = true, .PixelShaderResource = true, .debugName = "Transient Buffer" }
-	});
-	transientStagingBuffer = device->CreateBuffer({
-		65536,
+	meshStagingBuffer = device->CreateBuffer({
+		meshStagingSizeBytes,
 		{.StorageBuffer = true},
 		sizeof(char),
 		RGL::BufferAccess::Shared,
-		{.Transfersource = true, .debugName = "Transient Staging Buffer" }
+		{.Transfersource = true, .debugName = "Mesh Staging Buffer" }
 	});
-	transientStagingBuffer->MapMemory();
+	meshStagingBuffer->MapMemory();
 
 	// lighting meshes
 	constexpr static Vertex2D vertices[] = {
@@ -750,12 +798,69 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 		RGL::BufferAccess::Private,
 		{.Writable = true, .debugName = "Light cluster buffer"}
 	});
+	clusterTileDepthBuffer = device->CreateBuffer({
+		Clustered::gridSizeX * Clustered::gridSizeY,
+		{.StorageBuffer = true},
+		sizeof(Clustered::TileDepthBounds),
+		RGL::BufferAccess::Private,
+		{.Writable = true, .debugName = "Cluster tile depth bounds buffer"}
+	});
+	clusterLightIndexBuffer = device->CreateBuffer({
+		clusterLightIndexCapacity,
+		{.StorageBuffer = true},
+		sizeof(uint32_t),
+		RGL::BufferAccess::Private,
+		{.Writable = true, .debugName = "Cluster light index buffer"}
+	});
+	// the next free light index, and the most light indices any view needed this frame
+	clusterLightCounterBuffer = device->CreateBuffer({
+		2,
+		{.StorageBuffer = true},
+		sizeof(uint32_t),
+		RGL::BufferAccess::Shared,
+		{.TransferDestination = true, .Writable = true, .debugName = "Cluster light counter buffer"}
+	});
+	clusterLightCounterBuffer->MapMemory();
+	{
+		uint32_t zeros[2]{ 0, 0 };
+		clusterLightCounterBuffer->UpdateBufferData(zeros);
+	}
+	// zeros, copied over the light index counter and the visible light counts to reset them
+	clusterLightCounterResetBuffer = device->CreateBuffer({
+		2,
+		{.StorageBuffer = true},
+		sizeof(uint32_t),
+		RGL::BufferAccess::Private,
+		{.Transfersource = true, .debugName = "Cluster light counter reset buffer"}
+	});
+	{
+		uint32_t zeros[2]{ 0, 0 };
+		clusterLightCounterResetBuffer->SetBufferData(zeros);
+	}
+
+	// bound to the culling history slots when culling in a single phase, and to the view slot when culling a single view, which never read them
+	dummyCullHistoryBuffer = device->CreateBuffer({
+		1,
+		{.StorageBuffer = true},
+		sizeof(glm::mat4),
+		RGL::BufferAccess::Private,
+		{.Writable = true, .debugName = "Dummy culling history buffer"}
+	});
+
+	textureStreamer.Init(device);
+
+	im3dDebugVertices.stride = sizeof(Im3d::VertexData);
+	im3dDebugVertices.debugName = "Im3d Vertex Arena";
+	navDebugVertices.stride = sizeof(VertexColorUV);
+	navDebugVertices.debugName = "Navigation Debug Vertex Arena";
+	debugShapeInstances.stride = sizeof(DebugDrawer::ShapeInstance);
+	debugShapeInstances.debugName = "Debug Shape Instance Arena";
 
 	// debug render pipelines
 #ifndef NDEBUG
 	auto debugVSH = LoadShaderByFilename("debug_vsh", device);
 	auto debugFSH = LoadShaderByFilename("debug_fsh", device);
-	auto createDebugRenderPipeline = [this, debugVSH, debugFSH, debugPipelineLayout, device](RGL::PolygonOverride drawMode, RGL::PrimitiveTopology topology) {
+	auto debugRenderPipelineDescriptor = [this, debugVSH, debugFSH, debugPipelineLayout](RGL::PolygonOverride drawMode, RGL::PrimitiveTopology topology) {
 		RGL::RenderPipelineDescriptor rpd{
 			.stages = {
 				{
@@ -818,11 +923,126 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 			},
 			.pipelineLayout = debugPipelineLayout,
 		};
-		return device->CreateRenderPipeline(rpd);
+		return rpd;
+	};
+	auto createDebugRenderPipeline = [&debugRenderPipelineDescriptor, device](RGL::PolygonOverride drawMode, RGL::PrimitiveTopology topology) {
+		return device->CreateRenderPipeline(debugRenderPipelineDescriptor(drawMode, topology));
 	};
 	im3dLineRenderPipeline = createDebugRenderPipeline(RGL::PolygonOverride::Line, RGL::PrimitiveTopology::LineList);
 	im3dPointRenderPipeline = createDebugRenderPipeline(RGL::PolygonOverride::Point, RGL::PrimitiveTopology::PointList);
 	im3dTriangleRenderPipeline = createDebugRenderPipeline(RGL::PolygonOverride::Fill, RGL::PrimitiveTopology::TriangleList);
+
+	// DebugDrawer shapes: unit outlines, placed by a per-instance matrix
+	{
+		auto desc = debugRenderPipelineDescriptor(RGL::PolygonOverride::Line, RGL::PrimitiveTopology::LineList);
+		desc.stages[0].shaderModule = LoadShaderByFilename("debug_instanced_vsh", device);
+		desc.vertexConfig = {
+			.vertexBindings = {
+				{
+					.binding = 0,
+					.stride = sizeof(glm::vec3),
+				},
+				{
+					.binding = 1,
+					.stride = sizeof(DebugDrawer::ShapeInstance),
+					.inputRate = RGL::InputRate::Instance,
+				},
+			},
+			.attributeDescs = {
+				{
+					.location = 0,
+					.binding = 0,
+					.offset = 0,
+					.format = RGL::VertexAttributeFormat::R32G32B32_SignedFloat,
+				},
+				{
+					.location = 1,
+					.binding = 1,
+					.offset = 0,
+					.format = RGL::VertexAttributeFormat::R32G32B32A32_SignedFloat,
+				},
+				{
+					.location = 2,
+					.binding = 1,
+					.offset = sizeof(glm::vec4),
+					.format = RGL::VertexAttributeFormat::R32G32B32A32_SignedFloat,
+				},
+				{
+					.location = 3,
+					.binding = 1,
+					.offset = sizeof(glm::vec4) * 2,
+					.format = RGL::VertexAttributeFormat::R32G32B32A32_SignedFloat,
+				},
+				{
+					.location = 4,
+					.binding = 1,
+					.offset = sizeof(glm::vec4) * 3,
+					.format = RGL::VertexAttributeFormat::R32G32B32A32_SignedFloat,
+				},
+				{
+					.location = 5,
+					.binding = 1,
+					.offset = offsetof(DebugDrawer::ShapeInstance, color),
+					.format = RGL::VertexAttributeFormat::R32_Uint,
+				},
+			}
+		};
+		debugShapeRenderPipeline = device->CreateRenderPipeline(desc);
+
+		Vector<glm::vec3> lines;
+		auto circle = [&lines](auto point) {
+			constexpr int segments = 32;
+			for (int i = 0; i < segments; i++) {
+				lines.push_back(point(2 * glm::pi<float>() * i / segments));
+				lines.push_back(point(2 * glm::pi<float>() * (i + 1) / segments));
+			}
+		};
+		auto beginShape = [&lines, this](DebugDrawer::UnitShape shape, float boundingRadius) {
+			debugShapeRanges[shape] = { uint32_t(lines.size()), 0, boundingRadius };
+		};
+		auto endShape = [&lines, this](DebugDrawer::UnitShape shape) {
+			debugShapeRanges[shape].nVertices = uint32_t(lines.size()) - debugShapeRanges[shape].firstVertex;
+		};
+
+		beginShape(DebugDrawer::UnitBox, std::sqrt(0.75f));
+		for (int axis = 0; axis < 3; axis++) {
+			// the four edges parallel to this axis
+			for (int corner = 0; corner < 4; corner++) {
+				glm::vec3 a(0), b(0);
+				a[axis] = -0.5f;
+				b[axis] = 0.5f;
+				a[(axis + 1) % 3] = b[(axis + 1) % 3] = (corner & 1) ? 0.5f : -0.5f;
+				a[(axis + 2) % 3] = b[(axis + 2) % 3] = (corner & 2) ? 0.5f : -0.5f;
+				lines.push_back(a);
+				lines.push_back(b);
+			}
+		}
+		endShape(DebugDrawer::UnitBox);
+
+		beginShape(DebugDrawer::UnitSphere, 1);
+		circle([](float t) { return glm::vec3(std::cos(t), std::sin(t), 0); });
+		circle([](float t) { return glm::vec3(std::cos(t), 0, std::sin(t)); });
+		circle([](float t) { return glm::vec3(0, std::cos(t), std::sin(t)); });
+		endShape(DebugDrawer::UnitSphere);
+
+		beginShape(DebugDrawer::UnitCylinder, std::sqrt(2.f));
+		circle([](float t) { return glm::vec3(std::cos(t), 0, std::sin(t)); });
+		circle([](float t) { return glm::vec3(std::cos(t), 1, std::sin(t)); });
+		for (const auto& side : { glm::vec2(1, 0), glm::vec2(-1, 0), glm::vec2(0, 1), glm::vec2(0, -1) }) {
+			lines.push_back({ side.x, 0, side.y });
+			lines.push_back({ side.x, 1, side.y });
+		}
+		endShape(DebugDrawer::UnitCylinder);
+
+		debugShapeVertices = device->CreateBuffer({
+			uint32_t(lines.size()),
+			{.VertexBuffer = true},
+			sizeof(glm::vec3),
+			RGL::BufferAccess::Private,
+			{.debugName = "Debug Shape Vertex Buffer"}
+		});
+		debugShapeVertices->SetBufferData({ lines.data(), lines.size() * sizeof(glm::vec3) });
+	}
 #endif
 
 	// cluster grid build
@@ -845,13 +1065,44 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 		.pipelineLayout = gridBuildLayout
 	});
 
-	auto clusterPopulateLayout = device->CreatePipelineLayout({
+	auto clusterCullLightsLayout = device->CreatePipelineLayout({
 		.bindings = {
 			{
 				.binding = 0,
 				.type = RGL::BindingType::StorageBuffer,
 				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
+			},
+			{
+				.binding = 1,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
+			},
+			{
+				.binding = 2,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
 				.writable = true
+			}
+		},
+		.constants = {{ sizeof(LightCullUBO), 0, RGL::StageVisibility::Compute}}
+	});
+	clusterCullLightsPipeline = device->CreateComputePipeline(RGL::ComputePipelineDescriptor{
+		.stage = {
+			.type = RGL::ShaderStageDesc::Type::Compute,
+			.shaderModule = LoadShaderByFilename("cluster_cull_lights_csh",device)
+		},
+		.pipelineLayout = clusterCullLightsLayout
+	});
+
+	auto clusterPopulateLayout = device->CreatePipelineLayout({
+		.bindings = {
+			{
+				.binding = 0,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
 			},
 			{
 				.binding = 1,
@@ -864,6 +1115,36 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 				.type = RGL::BindingType::StorageBuffer,
 				.stageFlags = RGL::BindingVisibility::Compute,
 				.writable = false
+			},
+			{
+				.binding = 3,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = true
+			},
+			{
+				.binding = 4,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = true
+			},
+			{
+				.binding = 5,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = true
+			},
+			{
+				.binding = 6,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
+			},
+			{
+				.binding = 7,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
 			}
 		},
 		.constants = {{ sizeof(GridAssignUBO), 0, RGL::StageVisibility::Compute}}
@@ -877,6 +1158,30 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 		.pipelineLayout = clusterPopulateLayout
 	});
 
+	auto clusterDepthBoundsLayout = device->CreatePipelineLayout({
+		.bindings = {
+			{
+				.binding = 0,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 1,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = true
+			}
+		},
+		.constants = {{ sizeof(ClusterDepthBoundsUBO), 0, RGL::StageVisibility::Compute}}
+	});
+	clusterDepthBoundsPipeline = device->CreateComputePipeline(RGL::ComputePipelineDescriptor{
+		.stage = {
+			.type = RGL::ShaderStageDesc::Type::Compute,
+			.shaderModule = LoadShaderByFilename("cluster_depth_bounds_csh",device)
+		},
+		.pipelineLayout = clusterDepthBoundsLayout
+	});
+
 	// skinned mesh compute pipeline
 	auto skinnedCSH = LoadShaderByFilename("skinning_cs_csh", device);
 	auto skinnedPipelineLayout = device->CreatePipelineLayout({
@@ -954,6 +1259,12 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 					.stageFlags = RGL::BindingVisibility::Compute,
 					.writable = false
 				},
+				{
+					.binding = 22,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = false
+				},
 			},
 			.constants = {{ sizeof(SkinningUBO), 0, RGL::StageVisibility::Compute}}
 	});
@@ -1004,6 +1315,24 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 					.type = RGL::BindingType::Sampler,
 					.stageFlags = RGL::BindingVisibility::Compute,
 				},
+				{
+					.binding = DefaultCullBindings::cullHistory,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = false
+				},
+				{
+					.binding = DefaultCullBindings::visibility,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = true
+				},
+				{
+					.binding = DefaultCullBindings::views,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = false
+				},
 				{
 					.binding = 3,
 					.isBindless = true,
@@ -1032,6 +1361,20 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 					.stageFlags = RGL::BindingVisibility::Compute,
 					.writable = false
 				},
+				{
+					.binding = 7,
+					.isBindless = true,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = false
+				},
+				{
+					.binding = 8,
+					.isBindless = true,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = false
+				},
 				
 			},
 			.constants = {{ sizeof(CullingUBO), 0, RGL::StageVisibility::Compute}}
@@ -1045,6 +1388,36 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 		.pipelineLayout = defaultCullingLayout
 	});
 
+	// without indirect-count draws, compacting would not save anything, because every slot is still submitted
+	supportsIndirectCount = device->SupportsIndirectCount();
+	if (supportsIndirectCount) {
+		auto compactDrawsLayout = device->CreatePipelineLayout({
+			.bindings = {
+				{
+					.binding = 0,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = false
+				},
+				{
+					.binding = 1,
+					.isBindless = true,
+					.type = RGL::BindingType::StorageBuffer,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = true
+				},
+			},
+			.constants = {{ sizeof(CompactDrawsUBO), 0, RGL::StageVisibility::Compute}}
+		});
+		compactDrawsPipeline = device->CreateComputePipeline({
+			.stage = {
+				.type = RGL::ShaderStageDesc::Type::Compute,
+				.shaderModule = LoadShaderByFilename("compactdraws_csh", device)
+			},
+			.pipelineLayout = compactDrawsLayout
+		});
+	}
+
 	auto skinningDrawCallPrepareLayout = device->CreatePipelineLayout({
 		.bindings = {
 			{
@@ -1095,37 +1468,182 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
         .pipelineLayout = depthPyramidLayout
     });
 
-	auto depthPyramidCopyVSH = LoadShaderByFilename("depthpyramidcopy_vsh", device);
-	auto depthPyramidCopyFSH = LoadShaderByFilename("depthpyramidcopy_fsh", device);
-
-	auto depthPyramidCopyLayout = device->CreatePipelineLayout({
+	auto fusedPostProcessLayout = device->CreatePipelineLayout({
 		.bindings = {
 			{
 				.binding = 0,
-				.type = RGL::BindingType::SampledImage,
-				.stageFlags = RGL::BindingVisibility::Fragment,
+				.type = RGL::BindingType::Sampler,
+				.stageFlags = RGL::BindingVisibility::Compute,
 			},
 			{
 				.binding = 1,
-				.type = RGL::BindingType::Sampler,
-				.stageFlags = RGL::BindingVisibility::Fragment,
-			}
-		},
-		.constants = {{sizeof(PyramidCopyUBO), 0,RGL::StageVisibility::Fragment}}
-	});
-
-	depthPyramidCopyPipeline = device->CreateRenderPipeline(RGL::RenderPipelineDescriptor{
-		.stages = {
-				{
-					.type = RGL::ShaderStageDesc::Type::Vertex,
-					.shaderModule = depthPyramidCopyVSH,
-				},
-				{
-					.type = RGL::ShaderStageDesc::Type::Fragment,
-					.shaderModule = depthPyramidCopyFSH,
-				}
-		},
-		.vertexConfig = {
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 2,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 3,
+				.type = RGL::BindingType::StorageImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 4,
+				.type = RGL::BindingType::StorageImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 5,
+				.type = RGL::BindingType::StorageImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 6,
+				.type = RGL::BindingType::StorageImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 7,
+				.type = RGL::BindingType::StorageImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = true
+			},
+		},
+		.constants = {{ sizeof(FusedPostProcessUBO), 0, RGL::StageVisibility::Compute}}
+	});
+	fusedPostProcessPipeline = device->CreateComputePipeline({
+		.stage = {
+			.type = RGL::ShaderStageDesc::Type::Compute,
+			.shaderModule = LoadShaderByFilename("post_fused_csh", device)
+		},
+		.pipelineLayout = fusedPostProcessLayout
+	});
+
+	auto temporalUpscaleLayout = device->CreatePipelineLayout({
+		.bindings = {
+			{
+				.binding = 0,
+				.type = RGL::BindingType::Sampler,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 1,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 2,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 3,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 4,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+			},
+			{
+				.binding = 5,
+				.type = RGL::BindingType::StorageImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = true
+			},
+			{
+				.binding = 6,
+				.type = RGL::BindingType::StorageImage,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = true
+			},
+			{
+				.binding = 7,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
+			},
+			{
+				.binding = 8,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
+			},
+		},
+		.constants = {{ sizeof(TemporalUpscaleUBO), 0, RGL::StageVisibility::Compute}}
+	});
+	temporalUpscalePipeline = device->CreateComputePipeline({
+		.stage = {
+			.type = RGL::ShaderStageDesc::Type::Compute,
+			.shaderModule = LoadShaderByFilename("taa_upscale_csh", device)
+		},
+		.pipelineLayout = temporalUpscaleLayout
+	});
+	temporalUpscaleSampler = device->CreateSampler({
+		.addressModeU = RGL::SamplerAddressMode::Clamp,
+		.addressModeV = RGL::SamplerAddressMode::Clamp,
+		.addressModeW = RGL::SamplerAddressMode::Clamp,
+		.minFilter = RGL::MinMagFilterMode::Linear,
+		.magFilter = RGL::MinMagFilterMode::Linear,
+	});
+
+	shadingRateTileSize = device->GetShadingRateTileSize();
+	if (shadingRateTileSize > 0) {
+		auto shadingRateLayout = device->CreatePipelineLayout({
+			.bindings = {
+				{
+					.binding = 0,
+					.type = RGL::BindingType::StorageImage,
+					.stageFlags = RGL::BindingVisibility::Compute,
+					.writable = true
+				},
+			},
+			.constants = {{ sizeof(ShadingRateUBO), 0, RGL::StageVisibility::Compute}}
+		});
+		shadingRatePipeline = device->CreateComputePipeline({
+			.stage = {
+				.type = RGL::ShaderStageDesc::Type::Compute,
+				.shaderModule = LoadShaderByFilename("shading_rate_csh", device),
+			},
+			.pipelineLayout = shadingRateLayout
+		});
+	}
+
+	auto depthPyramidCopyVSH = LoadShaderByFilename("depthpyramidcopy_vsh", device);
+	auto depthPyramidCopyFSH = LoadShaderByFilename("depthpyramidcopy_fsh", device);
+
+	auto depthPyramidCopyLayout = device->CreatePipelineLayout({
+		.bindings = {
+			{
+				.binding = 0,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Fragment,
+			},
+			{
+				.binding = 1,
+				.type = RGL::BindingType::Sampler,
+				.stageFlags = RGL::BindingVisibility::Fragment,
+			}
+		},
+		.constants = {{sizeof(PyramidCopyUBO), 0,RGL::StageVisibility::Fragment}}
+	});
+
+	depthPyramidCopyPipeline = device->CreateRenderPipeline(RGL::RenderPipelineDescriptor{
+		.stages = {
+				{
+					.type = RGL::ShaderStageDesc::Type::Vertex,
+					.shaderModule = depthPyramidCopyVSH,
+				},
+				{
+					.type = RGL::ShaderStageDesc::Type::Fragment,
+					.shaderModule = depthPyramidCopyFSH,
+				}
+		},
+		.vertexConfig = {
 			.vertexBindings = {
 				{
 					.binding = 0,
@@ -1170,6 +1688,49 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 			   },
 		   },
 		});
+
+	// resets one tile of a shadow atlas to the far plane, within the scissor
+	shadowTileClearPipeline = device->CreateRenderPipeline(RGL::RenderPipelineDescriptor{
+		.stages = {
+				{
+					.type = RGL::ShaderStageDesc::Type::Vertex,
+					.shaderModule = LoadShaderByFilename("shadow_tile_clear_vsh", device),
+				},
+		},
+		.vertexConfig = {
+			.vertexBindings = {
+				{
+					.binding = 0,
+					.stride = sizeof(Vertex2D),
+				},
+			},
+			.attributeDescs = {
+				{
+					.location = 0,
+					.binding = 0,
+					.offset = 0,
+					.format = RGL::VertexAttributeFormat::R32G32_SignedFloat,
+				},
+			}
+		},
+		.inputAssembly = {
+			.topology = RGL::PrimitiveTopology::TriangleList,
+		},
+		.rasterizerConfig = {
+			.windingOrder = RGL::WindingOrder::Counterclockwise,
+		},
+		.colorBlendConfig = {
+			.attachments = {}
+		},
+		.depthStencilConfig = {
+			.depthFormat = RGL::TextureFormat::D32SFloat,
+			.depthTestEnabled = true,
+			.depthWriteEnabled = true,
+			.depthFunction = RGL::DepthCompareFunction::Always,
+		},
+		.pipelineLayout = device->CreatePipelineLayout({}),
+		.debugName = "Shadow Atlas Tile Clear"
+	});
     defaultPostEffectVSH = LoadShaderByFilename("defaultpostprocess_vsh", device);
    
 
@@ -1261,86 +1822,7 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 		},
 	});
 
-	auto navDebugLayout = device->CreatePipelineLayout({
-		.constants = {{sizeof(navDebugUBO), 0, RGL::StageVisibility(RGL::StageVisibility::Vertex)}}
-	});
-
-	auto recastDebugVSH = LoadShaderByFilename("debugNav_vsh", device);
-	auto recastDebugFSH = LoadShaderByFilename("debugNav_fsh", device);
-	auto createDebugNavPipeline = [navDebugLayout, device, recastDebugFSH, recastDebugVSH](RGL::PolygonOverride drawMode, RGL::PrimitiveTopology topology) {
-		RGL::RenderPipelineDescriptor recastDebugDesc{
-		.stages = {
-				{
-					.type = RGL::ShaderStageDesc::Type::Vertex,
-					.shaderModule = recastDebugVSH,
-				},
-				{
-					.type = RGL::ShaderStageDesc::Type::Fragment,
-					.shaderModule = recastDebugFSH,
-				}
-		},
-		.vertexConfig = {
-			.vertexBindings = {
-				{
-					.binding = 0,
-					.stride = sizeof(VertexColorUV),
-				},
-			},
-			.attributeDescs = {
-				{
-					.location = 0,
-					.binding = 0,
-					.offset = 0,
-					.format = RGL::VertexAttributeFormat::R32G32B32_SignedFloat,
-				},
-				{
-					.location = 1,
-					.binding = 0,
-					.offset = offsetof(VertexColorUV,uv),
-					.format = RGL::VertexAttributeFormat::R32G32_SignedFloat,
-				},
-				{
-					.location = 2,
-					.binding = 0,
-					.offset = offsetof(VertexColorUV,color),
-					.format = RGL::VertexAttributeFormat::R32_Uint,
-				},
-			}
-		},
-		.inputAssembly = {
-			.topology = topology,
-		},
-		.rasterizerConfig = {
-			.polygonOverride = drawMode,
-			.windingOrder = RGL::WindingOrder::Counterclockwise,
-		},
-		.colorBlendConfig = {
-			.attachments = {
-				{
-					.format = RGL::TextureFormat::BGRA8_Unorm,
-					.sourceColorBlendFactor = RGL::BlendFactor::SourceAlpha,
-					.destinationColorBlendFactor = RGL::BlendFactor::OneMinusSourceAlpha,
-					.alphaBlendOperation = RGL::BlendOperation::Add,
-					.colorWriteMask = RGL::ColorWriteMask::RGB,
-					.blendEnabled = true,
-				},
-			}
-		},
-		.depthStencilConfig = {
-			.depthFormat = depthFormat,
-			.depthTestEnabled = true,
-			.depthWriteEnabled = false,
-			.depthFunction = RGL::DepthCompareFunction::Greater
-		},
-		.pipelineLayout = navDebugLayout,
-		};
-
-		return device->CreateRenderPipeline(recastDebugDesc);
-	};
-	
-	recastLinePipeline = createDebugNavPipeline(RGL::PolygonOverride::Line, RGL::PrimitiveTopology::LineList);
-	recastPointPipeline = createDebugNavPipeline(RGL::PolygonOverride::Line, RGL::PrimitiveTopology::PointList);
-	recastTrianglePipeline = createDebugNavPipeline(RGL::PolygonOverride::Fill, RGL::PrimitiveTopology::TriangleList);
+	// the navigation debug pipelines are created by CreateNavDebugPipelines the first time a navmesh is drawn
 
 	auto particleCreateShader = LoadShaderByFilename("create_particle_csh", device);
 	auto particleCreateLayout = device->CreatePipelineLayout({
@@ -1369,10 +1851,14 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 				.stageFlags = RGL::BindingVisibility::Compute,
 				.writable = true
 			},
+			{
+				.binding = 4,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
+			},
 		},
-		.constants = {
-			{sizeof(ParticleCreationPushConstants), 0, RGL::StageVisibility(RGL::StageVisibility::Compute)}
-		}
+		.constants = {}
 	});
 	particleCreatePipeline = device->CreateComputePipeline({
 		.stage = {
@@ -1402,41 +1888,21 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 				.stageFlags = RGL::BindingVisibility::Compute,
 				.writable = true
 			},
-		},
-		.constants = {}
-	});
-	particleDispatchSetupPipeline = device->CreateComputePipeline({
-		.stage = {
-			.type = RGL::ShaderStageDesc::Type::Compute,
-			.shaderModule = LoadShaderByFilename("particle_dispatch_setup_csh",device)
-		},
-		.pipelineLayout = particleDispatchLayout
-	});
-
-	auto particleDispatchLayoutIndexed = device->CreatePipelineLayout({
-		.bindings = {
 			{
-				.binding = 0,
+				.binding = 3,
 				.type = RGL::BindingType::StorageBuffer,
 				.stageFlags = RGL::BindingVisibility::Compute,
 				.writable = false
 			},
-			{
-				.binding = 1,
-				.type = RGL::BindingType::StorageBuffer,
-				.stageFlags = RGL::BindingVisibility::Compute,
-				.writable = true
-			},
 		},
-		.constants = {}
+		.constants = {{sizeof(ParticleDispatchSetupUBO), 0, RGL::StageVisibility::Compute}}
 	});
-
-	particleDispatchSetupPipelineIndexed = device->CreateComputePipeline({
+	particleDispatchSetupPipeline = device->CreateComputePipeline({
 		.stage = {
 			.type = RGL::ShaderStageDesc::Type::Compute,
-			.shaderModule = LoadShaderByFilename("particle_dispatch_setup_indexed_csh",device)
+			.shaderModule = LoadShaderByFilename("particle_dispatch_setup_csh",device)
 		},
-		.pipelineLayout = particleDispatchLayoutIndexed
+		.pipelineLayout = particleDispatchLayout
 	});
 
 	auto particleKillLayout = device->CreatePipelineLayout({
@@ -1465,8 +1931,14 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 				.stageFlags = RGL::BindingVisibility::Compute,
 				.writable = true
 			},
+			{
+				.binding = 4,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::Compute,
+				.writable = false
+			},
 		},
-		.constants = {{sizeof(KillParticleUBO), 0, RGL::StageVisibility(RGL::StageVisibility::Compute)}}
+		.constants = {}
 	});
 	particleKillPipeline = device->CreateComputePipeline({
 		.stage = {
@@ -1722,21 +2194,138 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 			.attachments = {
 					{
 						.format = ssgiOutputFormat,
-						//.destinationColorBlendFactor = RGL::BlendFactor::One,	// additive blend, because we don't want to replace the AO
-						//.destinationAlphaBlendFactor = RGL::BlendFactor::One,
-						//.blendEnabled = true
+						//.destinationColorBlendFactor = RGL::BlendFactor::One,	// additive blend, because we don't want to replace the AO
+						//.destinationAlphaBlendFactor = RGL::BlendFactor::One,
+						//.blendEnabled = true
+					},
+				}
+		};
+		ssgiupsample_rpd.colorBlendConfig.attachments[0].colorWriteMask = RGL::ColorWriteMask::RGB;
+
+		ssgiUpsamplePipleineFinalStep = device->CreateRenderPipeline(ssgiupsample_rpd);
+
+		// also reads the scene depth, to keep the upsample from crossing edges
+		auto aoUpscaleLayout = device->CreatePipelineLayout({
+			.bindings = {
+				{
+					.binding = 0,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+				{
+					.binding = 1,
+					.type = RGL::BindingType::Sampler,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+				{
+					.binding = 2,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+			},
+			.constants = {{sizeof(UpsampleUBO), 0, RGL::StageVisibility(RGL::StageVisibility::Fragment)}}
+			});
+
+		ssgiupsample_rpd.stages[1].shaderModule = LoadShaderByFilename("ao_upsample_fsh", device);	// doesn't matter this is additive because the previous data will be 0
+		ssgiupsample_rpd.colorBlendConfig.attachments[0].colorWriteMask = RGL::ColorWriteMask::Alpha;	// don't touch RGB
+		ssgiupsample_rpd.colorBlendConfig.attachments[0].blendEnabled = false;
+		ssgiupsample_rpd.pipelineLayout = aoUpscaleLayout;
+
+		aoUpsamplePipeline = device->CreateRenderPipeline(ssgiupsample_rpd);
+	}
+
+	ssgiTemporalPass = RGL::CreateRenderPass({
+		.attachments = {
+			{
+				.format = ssgiOutputFormat,
+				.loadOp = RGL::LoadAccessOperation::Clear,
+				.storeOp = RGL::StoreAccessOperation::Store,
+			},
+			{
+				.format = indirectLightingHistoryDepthFormat,
+				.loadOp = RGL::LoadAccessOperation::Clear,
+				.storeOp = RGL::StoreAccessOperation::Store,
+			},
+		},
+	});
+
+	{
+		auto temporalLayout = device->CreatePipelineLayout({
+			.bindings = {
+				{
+					.binding = 0,
+					.type = RGL::BindingType::Sampler,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+				{
+					.binding = 1,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+				{
+					.binding = 2,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+				{
+					.binding = 3,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+				{
+					.binding = 4,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+			},
+			.constants = {{sizeof(SSGITemporalUBO), 0, RGL::StageVisibility(RGL::StageVisibility::Fragment)}}
+		});
+
+		ssgiTemporalPipeline = device->CreateRenderPipeline(RGL::RenderPipelineDescriptor{
+			.stages = {
+					{
+						.type = RGL::ShaderStageDesc::Type::Vertex,
+						.shaderModule = LoadShaderByFilename("defaultpostprocess_vsh", device),
+					},
+					{
+						.type = RGL::ShaderStageDesc::Type::Fragment,
+						.shaderModule = LoadShaderByFilename("ssgi_temporal_fsh", device),
+					}
+			},
+			.vertexConfig = {
+				.vertexBindings = {
+					{
+						.binding = 0,
+						.stride = sizeof(Vertex2D),
+					},
+				},
+				.attributeDescs = {
+					{
+						.location = 0,
+						.binding = 0,
+						.offset = 0,
+						.format = RGL::VertexAttributeFormat::R32G32_SignedFloat,
+					},
+				}
+			},
+			.inputAssembly = {
+				.topology = RGL::PrimitiveTopology::TriangleList,
+			},
+			.rasterizerConfig = {
+				.windingOrder = RGL::WindingOrder::Counterclockwise,
+			},
+			.colorBlendConfig = {
+				.attachments = {
+					{
+						.format = ssgiOutputFormat,
+					},
+					{
+						.format = indirectLightingHistoryDepthFormat,
 					},
 				}
-		};
-		ssgiupsample_rpd.colorBlendConfig.attachments[0].colorWriteMask = RGL::ColorWriteMask::RGB;
-
-		ssgiUpsamplePipleineFinalStep = device->CreateRenderPipeline(ssgiupsample_rpd);
-
-		ssgiupsample_rpd.stages[1].shaderModule = LoadShaderByFilename("ao_upsample_fsh", device);	// doesn't matter this is additive because the previous data will be 0
-		ssgiupsample_rpd.colorBlendConfig.attachments[0].colorWriteMask = RGL::ColorWriteMask::Alpha;	// don't touch RGB
-		ssgiupsample_rpd.colorBlendConfig.attachments[0].blendEnabled = false;
-
-		aoUpsamplePipeline = device->CreateRenderPipeline(ssgiupsample_rpd);
+			},
+			.pipelineLayout = temporalLayout,
+		});
 	}
 
 	transparencyApplyPass = RGL::CreateRenderPass({
@@ -1771,6 +2360,16 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 					.type = RGL::BindingType::SampledImage,
 					.stageFlags = RGL::BindingVisibility::Fragment,
 				},
+				{
+					.binding = 4,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
+				{
+					.binding = 5,
+					.type = RGL::BindingType::SampledImage,
+					.stageFlags = RGL::BindingVisibility::Fragment,
+				},
 				{
 					.binding = 10,
 					.type = RGL::BindingType::StorageBuffer,
@@ -1847,6 +2446,160 @@ RenderEngine::RenderEngine(const AppConfig& config, RGLDevicePtr device) : devic
 			.clearColor = depthClearColor
 		}}
 	});
+
+	// cached skies, see Skybox::cached
+	skyCachePass = RGL::CreateRenderPass({
+		.attachments = {
+			{
+				.format = colorTexFormat,
+				.loadOp = RGL::LoadAccessOperation::DontCare,
+				.storeOp = RGL::StoreAccessOperation::Store,
+			},
+		},
+		.depthAttachment = {{
+			.format = RGL::TextureFormat::D32SFloat,
+			.loadOp = RGL::LoadAccessOperation::Clear,
+			.storeOp = RGL::StoreAccessOperation::DontCare,
+			.clearColor = depthClearColor	// the sky material draws where the depth is the clear value
+		}}
+	});
+
+	skyIrradiancePass = RGL::CreateRenderPass({
+		.attachments = {
+			{
+				.format = colorTexFormat,
+				.loadOp = RGL::LoadAccessOperation::DontCare,
+				.storeOp = RGL::StoreAccessOperation::Store,
+			},
+		},
+	});
+
+	auto skyCacheLayout = device->CreatePipelineLayout({
+		.bindings = {
+			{
+				.binding = 0,
+				.type = RGL::BindingType::Sampler,
+				.stageFlags = RGL::BindingVisibility::Fragment,
+			},
+			{
+				.binding = 1,
+				.type = RGL::BindingType::StorageBuffer,
+				.stageFlags = RGL::BindingVisibility::VertexFragment,
+			},
+			{
+				.binding = 2,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Fragment,
+			},
+		},
+	});
+
+	skyCachePipeline = device->CreateRenderPipeline(RGL::RenderPipelineDescriptor{
+		.stages = {
+				{
+					.type = RGL::ShaderStageDesc::Type::Vertex,
+					.shaderModule = LoadShaderByFilename("defaultsky_vsh", device),
+				},
+				{
+					.type = RGL::ShaderStageDesc::Type::Fragment,
+					.shaderModule = LoadShaderByFilename("skybox_cached_fsh", device),
+				}
+		},
+		.vertexConfig = {
+			.vertexBindings = {
+				{
+					.binding = 0,
+					.stride = sizeof(Vertex2D),
+				},
+			},
+			.attributeDescs = {
+				{
+					.location = 0,
+					.binding = 0,
+					.offset = 0,
+					.format = RGL::VertexAttributeFormat::R32G32_SignedFloat,
+				},
+			}
+		},
+		.inputAssembly = {
+			.topology = RGL::PrimitiveTopology::TriangleList,
+		},
+		.rasterizerConfig = {
+			.windingOrder = RGL::WindingOrder::Counterclockwise,
+		},
+		.colorBlendConfig = {
+			.attachments = {
+				{
+					.format = colorTexFormat,
+				},
+			}
+		},
+		.depthStencilConfig = {
+			.depthFormat = depthFormat,
+			.depthTestEnabled = true,
+			.depthWriteEnabled = false,
+			.depthFunction = RGL::DepthCompareFunction::Equal
+		},
+		.pipelineLayout = skyCacheLayout,
+	});
+
+	auto skyIrradianceLayout = device->CreatePipelineLayout({
+		.bindings = {
+			{
+				.binding = 0,
+				.type = RGL::BindingType::Sampler,
+				.stageFlags = RGL::BindingVisibility::Fragment,
+			},
+			{
+				.binding = 1,
+				.type = RGL::BindingType::SampledImage,
+				.stageFlags = RGL::BindingVisibility::Fragment,
+			},
+		},
+	});
+
+	skyIrradiancePipeline = device->CreateRenderPipeline(RGL::RenderPipelineDescriptor{
+		.stages = {
+				{
+					.type = RGL::ShaderStageDesc::Type::Vertex,
+					.shaderModule = LoadShaderByFilename("defaultpostprocess_vsh", device),
+				},
+				{
+					.type = RGL::ShaderStageDesc::Type::Fragment,
+					.shaderModule = LoadShaderByFilename("sky_irradiance_fsh", device),
+				}
+		},
+		.vertexConfig = {
+			.vertexBindings = {
+				{
+					.binding = 0,
+					.stride = sizeof(Vertex2D),
+				},
+			},
+			.attributeDescs = {
+				{
+					.location = 0,
+					.binding = 0,
+					.offset = 0,
+					.format = RGL::VertexAttributeFormat::R32G32_SignedFloat,
+				},
+			}
+		},
+		.inputAssembly = {
+			.topology = RGL::PrimitiveTopology::TriangleList,
+		},
+		.rasterizerConfig = {
+			.windingOrder = RGL::WindingOrder::Counterclockwise,
+		},
+		.colorBlendConfig = {
+			.attachments = {
+				{
+					.format = colorTexFormat,
+				},
+			}
+		},
+		.pipelineLayout = skyIrradianceLayout,
+	});
 }
 
 RenderTargetCollection RavEngine::RenderEngine::CreateRenderTargetCollection(dim size, bool createDepth)
@@ -1865,15 +2618,68 @@ RenderTargetCollection RavEngine::RenderEngine::CreateRenderTargetCollection(dim
             .format = RGL::TextureFormat::D32SFloat,
             .debugName = "Depth Texture"
         });
+        collection.entityIDTexture = device->CreateTexture({
+            .usage = {.Sampled = true, .ColorAttachment = true },
+            .aspect = {.HasColor = true },
+            .width = width,
+            .height = height,
+            .format = RenderTargetCollection::entityIDFormat,
+            .initialLayout = RGL::ResourceLayout::Undefined,
+            .debugName = "Entity ID Texture"
+        });
         
         auto dim = std::min(width, height);
         
         collection.depthPyramid = {static_cast<uint16_t>(dim)};
-        
+        collection.occlusionHistory = std::make_shared<OcclusionCullingHistory>();
+        collection.indirectLightingHistory = std::make_shared<IndirectLightingHistory>();
+        collection.temporalUpscalingHistory = std::make_shared<TemporalUpscalingHistory>();
     }
 
+	// written by shading_rate.csh for each camera before its lit passes
+	if (shadingRateTileSize > 0) {
+		collection.shadingRateTexture = device->CreateTexture({
+			.usage = {.Storage = true, .ShadingRate = true },
+			.aspect = {.HasColor = true },
+			.width = (width + shadingRateTileSize - 1) / shadingRateTileSize,
+			.height = (height + shadingRateTileSize - 1) / shadingRateTileSize,
+			.format = RGL::TextureFormat::R8_Uint,
+			.initialLayout = RGL::ResourceLayout::Undefined,
+			.debugName = "Shading Rate Texture"
+		});
+	}
+
+	const auto poolKey = (uint64_t(width) << 32) | height;
+	if (shareTransientRenderTargets) {
+		for (auto it = transientTargetPool.begin(); it != transientTargetPool.end();) {
+			if (it->second.lightingTexture.expired()) {
+				transientTargetPool.erase(it++);
+			}
+			else {
+				++it;
+			}
+		}
+		if (auto it = transientTargetPool.find(poolKey); it != transientTargetPool.end()) {
+			const auto& set = it->second;
+			collection.lightingTexture = set.lightingTexture.lock();
+			collection.lightingScratchTexture = set.lightingScratchTexture.lock();
+			collection.radianceTexture = set.radianceTexture.lock();
+			collection.viewSpaceNormalsTexture = set.viewSpaceNormalsTexture.lock();
+			collection.ssgiOutputTexture = set.ssgiOutputTexture.lock();
+			collection.mlabDepth = set.mlabDepth.lock();
+			bool complete = collection.lightingTexture && collection.lightingScratchTexture && collection.radianceTexture && collection.viewSpaceNormalsTexture && collection.ssgiOutputTexture && collection.mlabDepth;
+			for (const auto& [i, tx] : Enumerate(set.mlabAccum)) {
+				collection.mlabAccum[i] = tx.lock();
+				complete = complete && collection.mlabAccum[i];
+			}
+			if (complete) {
+				return collection;
+			}
+		}
+	}
+
     RGL::TextureConfig lightingConfig{
-        .usage = {.Sampled = true, .ColorAttachment = true },
+        .usage = {.Sampled = true, .Storage = true, .ColorAttachment = true },	// storage for the fused post processing pass
         .aspect = {.HasColor = true },
         .width = width,
         .height = height,
@@ -1947,19 +2753,54 @@ RenderTargetCollection RavEngine::RenderEngine::CreateRenderTargetCollection(dim
         .debugName = "MLAB Depth"
     });
 
+	if (shareTransientRenderTargets) {
+		auto& set = transientTargetPool[poolKey];
+		set.lightingTexture = collection.lightingTexture;
+		set.lightingScratchTexture = collection.lightingScratchTexture;
+		set.radianceTexture = collection.radianceTexture;
+		set.viewSpaceNormalsTexture = collection.viewSpaceNormalsTexture;
+		set.ssgiOutputTexture = collection.ssgiOutputTexture;
+		set.mlabDepth = collection.mlabDepth;
+		for (const auto& [i, tx] : Enumerate(collection.mlabAccum)) {
+			set.mlabAccum[i] = tx;
+		}
+	}
+
 	return collection;
 }
 
 void RavEngine::RenderEngine::ResizeRenderTargetCollection(RenderTargetCollection& collection, dim size)
 {
 	gcTextures.enqueue(collection.depthStencil);
+	gcTextures.enqueue(collection.entityIDTexture);
 	gcTextures.enqueue(collection.lightingTexture);
     gcTextures.enqueue(collection.depthPyramid.pyramidTexture);
+	if (collection.occlusionHistory && collection.occlusionHistory->visibilityBuffer) {
+		gcBuffers.enqueue(collection.occlusionHistory->visibilityBuffer);
+	}
+	if (collection.indirectLightingHistory) {
+		for (const auto& view : collection.indirectLightingHistory->views) {
+			for (const auto& tx : view.color) {
+				gcTextures.enqueue(tx);
+			}
+			for (const auto& tx : view.depth) {
+				gcTextures.enqueue(tx);
+			}
+		}
+	}
+	if (collection.temporalUpscalingHistory) {
+		for (const auto& tx : collection.temporalUpscalingHistory->color) {
+			gcTextures.enqueue(tx);
+		}
+	}
     gcTextures.enqueue(collection.lightingScratchTexture);
     gcTextures.enqueue(collection.mlabDepth);
     gcTextures.enqueue(collection.radianceTexture);
     gcTextures.enqueue(collection.viewSpaceNormalsTexture);
     gcTextures.enqueue(collection.ssgiOutputTexture);
+    if (collection.shadingRateTexture) {
+        gcTextures.enqueue(collection.shadingRateTexture);
+    }
     
     for(const auto tx : collection.mlabAccum){
         gcTextures.enqueue(tx);
@@ -1973,24 +2814,233 @@ RavEngine::RenderEngine::~RenderEngine()
 {
 	mainCommandBuffer->BlockUntilCompleted();
 	mainCommandQueue->WaitUntilCompleted();
-	DestroyUnusedResources();
+	asyncComputeQueue->WaitUntilCompleted();
+	DestroyUnusedResources(true);
 	device->BlockUntilIdle();
+	SavePipelineCache();
 }
 
-void RenderEngine::DestroyUnusedResources() {
-	RVE_PROFILE_FN;
-	// deallocate the resources that have been freed
+void RenderEngine::LoadPipelineCache() {
+	if (pipelineCachePath.empty()) {
+		return;
+	}
+	std::ifstream file(pipelineCachePath, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return;	// first run
+	}
+	Vector<std::byte> data(size_t(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(data.data()), data.size());
+	if (file) {
+		device->LoadPipelineCache(data);
+	}
+}
+
+void RenderEngine::SavePipelineCache() {
+	if (pipelineCachePath.empty()) {
+		return;
+	}
+	const auto data = device->GetPipelineCacheData();
+	if (data.empty()) {
+		return;
+	}
+	// write to the side and swap in, so a crash mid-write cannot leave a truncated cache
+	auto tmpPath = pipelineCachePath;
+	tmpPath += ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+		if (!file) {
+			Debug::Warning("Could not write pipeline cache to {}", tmpPath.string());
+			return;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, pipelineCachePath, ec);
+	if (ec) {
+		Debug::Warning("Could not save pipeline cache to {}: {}", pipelineCachePath.string(), ec.message());
+	}
+}
+
+void RenderEngine::SetGPUPassTimingsEnabled(bool enabled) {
+	gpuPassTimingsRequested = enabled;
+	mainCommandBuffer->SetTimestampsEnabled(gpuPassTimingsRequested || dynamicResolutionEnabled);
+}
+
+void RenderEngine::SetDynamicResolutionEnabled(bool enabled) {
+	dynamicResolutionEnabled = enabled;
+	dynamicResolution.SetConfig(dynamicResolution.GetConfig());
+	mainCommandBuffer->SetTimestampsEnabled(gpuPassTimingsRequested || dynamicResolutionEnabled);
+}
+
+void RenderEngine::UpdateVRAMBudget(World* world) {
+	vramResidency.usage = device->GetCurrentVRAMInUse();
+	vramResidency.budget = device->GetTotalVRAM();
+	if (vramBudgetEnabled) {
+		vramBudget.Update(vramResidency.usage, vramResidency.budget);
+	}
+	else if (vramBudget.GetLevel() != VRAMPressureLevel::None) {
+		vramBudget.SetConfig(vramBudget.GetConfig());
+	}
+
+	// streaming textures give up the overage, paced like the steps so the released mips can show in the usage first
+	if (vramBudget.IsAtLeast(VRAMPressureLevel::TextureMips)) {
+		const auto overage = vramBudget.GetOverageBytes();
+		if (overage > 0 && frameCount >= textureLimitFrame + vramBudget.GetConfig().framesBetweenSteps) {
+			const auto resident = textureStreamer.GetResidentBytes();
+			textureStreamer.pressureLimitBytes = std::min(textureStreamer.pressureLimitBytes, resident > overage ? resident - overage : 0);
+			textureLimitFrame = frameCount;
+		}
+	}
+	else {
+		textureStreamer.pressureLimitBytes = std::numeric_limits<uint64_t>::max();
+	}
+	vramResidency.streamingTextures = textureStreamer.GetResidentBytes();
+
+	constexpr uint64_t depthTexelBytes = 4;		// D32SFloat
+	vramResidency.shadowMaps = uint64_t(shadowAtlasSize) * shadowAtlasSize * depthTexelBytes * (shadowAtlasStaticTexture ? 2 : 1);
+	const auto cascadeSize = DirectionalLight::shadowMapSize >> ShadowResolutionShift();
+	auto& dirLightData = world->renderData.directionalLightData;
+	world->Filter([&](DirectionalLight& light, const Transform& t) {
+		if (light.shadowData.shadowMap[0]->GetSize().width != cascadeSize) {
+			for (const auto& old : light.ResizeShadowMaps(cascadeSize)) {
+				gcTextures.enqueue(old);
+			}
+			const auto id = t.GetOwner().GetID().id;
+			if (dirLightData.HasForSparseIndex(id)) {
+				auto& uploadData = dirLightData.GetForSparseIndexForWriting(id);
+				for (uint8_t i = 0; i < light.shadowData.shadowMap.size(); i++) {
+					uploadData.shadowmapBindlessIndex[i] = light.shadowData.shadowMap[i]->GetDefaultView().GetReadonlyBindlessTextureHandle();
+				}
+			}
+		}
+		vramResidency.shadowMaps += uint64_t(cascadeSize) * cascadeSize * depthTexelBytes * light.shadowData.shadowMap.size();
+	});
+
+	vramResidency.meshes = 0;
+	for (const auto& buffer : { sharedPositionBuffer, sharedNormalBuffer, sharedTangentBuffer, sharedBitangentBuffer, sharedUV0Buffer, sharedLightmapUVBuffer, sharedIndexBuffer }) {
+		if (buffer) {
+			vramResidency.meshes += buffer->getBufferSize();
+		}
+	}
+	vramResidency.buffers = BufferedVRAMStructureBase::GetTotalPrivateBytes();
+}
+
+void RenderEngine::UpdateRenderScale() {
+	if (!dynamicResolutionEnabled) {
+		// the temporal upscaler fills in the detail that a fixed lower scale leaves out
+		renderScale = VideoSettings.temporalUpscaling ? std::clamp(VideoSettings.temporalUpscalingScale, 0.25f, 1.f) : 1;
+		return;
+	}
+	renderScale = dynamicResolution.Update(lastFrameTimings.gpuMs);
+}
+
+void RenderEngine::UpdateLightClusters() {
+	auto counters = static_cast<uint32_t*>(clusterLightCounterBuffer->GetMappedDataPtr());
+	const uint32_t peakLightIndices = counters[1];
+	counters[1] = 0;
+	if (peakLightIndices > clusterLightIndexCapacity) {
+		// clusters dropped lights last frame
+		gcBuffers.enqueue(clusterLightIndexBuffer);
+		clusterLightIndexCapacity = std::bit_ceil(peakLightIndices);
+		clusterLightIndexBuffer = device->CreateBuffer({
+			clusterLightIndexCapacity,
+			{.StorageBuffer = true},
+			sizeof(uint32_t),
+			RGL::BufferAccess::Private,
+			{.Writable = true, .debugName = "Cluster light index buffer"}
+		});
+	}
+
+	std::erase_if(clusterGridCache, [this](const ClusterGridCacheEntry& entry) {
+		if (frameCount - entry.lastUsedFrame > clusterGridCacheFrames) {
+			gcBuffers.enqueue(entry.bounds);
+			return true;
+		}
+		return false;
+	});
+}
+
+std::span<const RGL::TimestampRegion> RenderEngine::GetGPUPassTimings() const {
+	return mainCommandBuffer->GetResolvedTimestamps();
+}
+
+void RenderEngine::SetCommandCountsEnabled(bool enabled) {
+	mainCommandBuffer->SetCommandCountsEnabled(enabled);
+}
+
+std::span<const RGL::CommandCountRegion> RenderEngine::GetCommandCounts() const {
+	return mainCommandBuffer->GetCommandCounts();
+}
 
-	auto clear = [](auto& queue) {
-		typename std::remove_reference_t<decltype(queue)>::value_type item;
-		while (queue.try_dequeue(item)) {}
+void RenderEngine::ReportGPUPassTimings() {
+#if RVE_PROFILE && defined(TRACY_ENABLE)
+	const auto regions = GetGPUPassTimings();
+	if (regions.empty()) {
+		return;
+	}
+	// timestamps are already in nanoseconds, so the context period is 1
+	if (!gpuZoneContextCreated) {
+		gpuZoneContext = tracy::GetGpuCtxCounter().fetch_add(1, std::memory_order_relaxed);
+		___tracy_emit_gpu_new_context({ .gpuTime = int64_t(regions.front().beginNs), .period = 1, .context = gpuZoneContext, .flags = 0, .type = uint8_t(tracy::GpuContextType::Vulkan) });
+		constexpr static std::string_view contextName = "RenderEngine";
+		___tracy_emit_gpu_context_name({ .context = gpuZoneContext, .name = contextName.data(), .len = uint16_t(contextName.size()) });
+		gpuZoneContextCreated = true;
+	}
 
+	// Tracy expects properly nested zones, so close every open region that is not an ancestor of the next one
+	struct OpenZone {
+		uint32_t depth;
+		int64_t endNs;
+	};
+	Vector<OpenZone> openZones;
+	auto closeZone = [this, &openZones] {
+		const auto queryId = nextGPUZoneQueryId++;
+		___tracy_emit_gpu_zone_end({ .queryId = queryId, .context = gpuZoneContext });
+		___tracy_emit_gpu_time({ .gpuTime = openZones.back().endNs, .queryId = queryId, .context = gpuZoneContext });
+		openZones.pop_back();
 	};
+	for (const auto& region : regions) {
+		while (!openZones.empty() && openZones.back().depth >= region.depth) {
+			closeZone();
+		}
+		const auto srcloc = ___tracy_alloc_srcloc_name(__LINE__, __FILE__, sizeof(__FILE__) - 1, __func__, sizeof(__func__) - 1, region.label.data(), region.label.size(), 0);
+		const auto queryId = nextGPUZoneQueryId++;
+		___tracy_emit_gpu_zone_begin_alloc({ .srcloc = srcloc, .queryId = queryId, .context = gpuZoneContext });
+		___tracy_emit_gpu_time({ .gpuTime = int64_t(region.beginNs), .queryId = queryId, .context = gpuZoneContext });
+		openZones.push_back({ region.depth, int64_t(region.endNs) });
+	}
+	while (!openZones.empty()) {
+		closeZone();
+	}
+#endif
+}
+
+void RenderEngine::DestroyUnusedResources(bool releaseAll) {
+	RVE_PROFILE_FN;
+	// this slot was filled gcFramesInFlight frames ago, so the GPU is done with it
+	auto& retired = retiredResources[frameCount % gcFramesInFlight];
+	retired.clear();
+
+	DequeueAllInto(gcBuffers, retired.buffers);
+	DequeueAllInto(gcTextures, retired.textures);
+	DequeueAllInto(gcPipelineLayout, retired.pipelineLayouts);
+	DequeueAllInto(gcRenderPipeline, retired.renderPipelines);
+	static auto retiredGauge = PerfCounters::GetGauge("Render: Retired Resources");
+	retiredGauge->Set(double(retired.buffers.size() + retired.textures.size() + retired.pipelineLayouts.size() + retired.renderPipelines.size()));
+
+	if (releaseAll) {
+		for (auto& slot : retiredResources) {
+			slot.clear();
+		}
+	}
 
-	clear(gcBuffers);
-	clear(gcTextures);
-	clear(gcPipelineLayout);
-	clear(gcRenderPipeline);
+	releasedGUIGeometry.clear();
+	DequeueAllInto(gcGUIGeometry, releasedGUIGeometry);
+	for (const auto& guiGeometry : releasedGUIGeometry) {
+		guiCompiledVertices.allocator.Free(guiGeometry.first);
+		guiCompiledIndices.allocator.Free(guiGeometry.second);
+	}
 }
 
 /**
@@ -2043,6 +3093,8 @@ size_t RavEngine::RenderEngine::GetTotalVRAM()
 
 void RavEngine::RenderEngine::SyncVideoSettings()
 {
-	//TODO: implement
+	auto& swapchain = GetApp()->GetMainWindow()->swapchain;
+	swapchain->SetPresentMode(VideoSettings.presentMode);
+	swapchain->SetMaxFrameLatency(VideoSettings.maxFrameLatency);
 }
 #endif
@@ -2,187 +2,331 @@
 #include "RenderEngine.hpp"
 #include <RGL/Span.hpp>
 #include <mutex>
+#include <array>
+#include <cstring>
 #include <RGL/RGL.hpp>
 #include <RGL/Buffer.hpp>
 #include <RGL/Device.hpp>
 #include <RGL/CommandBuffer.hpp>
 #include "Debug.hpp"
+#include "Profile.hpp"
+#include "PerfCounters.hpp"
 
 namespace RavEngine {
 	MeshRange RenderEngine::AllocateMesh(const MeshPartView& mesh)
 	{
-        std::lock_guard mtx{allocationLock};
-	
-		using alloc_iterator_t = allocation_allocatedlist_t::iterator;
-		using freelist_iterator_t = allocation_freelist_t::iterator;
+        std::unique_lock mtx{allocationLock};
 
 		/**
-		Find a Range that can fit the current allocation. If one does not exist, returns -1 (aka uint max)
-		@return an interator into the freelist.
+		* Find a place for an allocation, growing the underlying memory if necessary, and record it as allocated.
+		* @returns an iterator into the allocated list
 		*/
-		auto findPlacement = [](uint32_t requestedSize, allocation_freelist_t& freeList) {
-			auto bestRangeIndex = freeList.begin();
-			for (auto it = freeList.begin(); it != freeList.end(); it++) {
-				auto& nextRange = *it;
-				if (requestedSize <= (*bestRangeIndex).count) {
-					return it;
-				}
+		auto allocate = [](uint32_t size, const uint32_t& currentSize, OffsetAllocator& allocator, allocation_allocatedlist_t& allocatedList, auto realloc_fn) {
+			auto allocation = allocator.Allocate(size);
+			if (!allocation.IsValid()) {
+				// resize to fit. Existing data keeps its offsets, so the new space is at the end and must fit.
+				realloc_fn(currentSize + std::max(size, 1u));
+				allocation = allocator.Allocate(size);
+				Debug::Assert(allocation.IsValid(), "Mesh allocation failed after resizing");
 			}
-			return freeList.end();
-		};
-
-		/**
-		* Given a byte size, find a possible block, resizing the underlying memory if necessary.
-		* @returns an iterator into the freelist
-		*/
-		auto getAllocationLocation = [&findPlacement](uint32_t size, const uint32_t& currentSize, allocation_freelist_t& freeList, auto realloc_fn) {
-			auto allocation = freeList.end();
-			do {
-				allocation = findPlacement(size, freeList);
-				if (allocation == freeList.end()) {
-					// resize to fit
-					realloc_fn(currentSize + size);
-				}
-
-			} while (allocation == freeList.end());
-			return allocation;
+			AllocatedRange range;
+			range.start = allocation.offset;
+			range.count = size;
+			range.node = allocation.node;
+			allocatedList.push_back(range);
+			return --allocatedList.end();
 		};
 
-		// figure out where to put the new data, resizing the buffer as needed
-		auto vertexAllocation = getAllocationLocation(mesh.NumVerts(), currentVertexSize, vertexFreeList, [this](uint32_t newSize) {ReallocateVertexAllocationToSize(newSize); });
-		auto indexAllocation = getAllocationLocation(mesh.indices.size(), currentIndexSize, indexFreeList,  [this](uint32_t newSize) {ReallocateIndexAllocationToSize(newSize); });
-
-		// now we have the location to place the vertex and index data in the buffer
-		// these numbers are stable because, if the buffer resized, then the only place it could be stored is at the end.
-		// if the new data fits, then the buffer was not resized, so the indices are stable.
+		auto vertexPlacement = allocate(mesh.NumVerts(), currentVertexSize, vertexAllocator, vertexAllocatedList, [this](uint32_t newSize) {ReallocateVertexAllocationToSize(newSize); });
+		auto indexPlacement = allocate(mesh.indices.size(), currentIndexSize, indexAllocator, indexAllocatedList, [this](uint32_t newSize) {ReallocateIndexAllocationToSize(newSize); });
 
-		auto consumeRange = [](alloc_iterator_t allocation, uint32_t allocatedSize, allocation_freelist_t& freeList, allocation_allocatedlist_t& allocatedList) {
-			// construct a range to match the current allocation
-			auto range = *allocation;
-			range.count = allocatedSize;
-			// mark as allocated (copy into)
-			allocatedList.push_back(range);
+		MeshRange range{ vertexPlacement, indexPlacement };
 
-			// update the freelist
-			auto& rangeToUpdate = *allocation;
-			// if it fits exactly, delete it
-			if (rangeToUpdate.count == allocatedSize) {
-				freeList.erase(allocation);
-			}
-			else {
-				// otherwise, modify it to represent the new shrunken size
-				// we allocate aligned with the start of the range
-				rangeToUpdate.start += allocatedSize;
-				rangeToUpdate.count -= allocatedSize;
-			}
-			
-			return --allocatedList.end();
+		const std::array<RGL::untyped_span, nMeshStreams> streams{
+			RGL::untyped_span{ mesh.positions.data(), mesh.positions.size_bytes() },
+			RGL::untyped_span{ mesh.normals.data(), mesh.normals.size_bytes() },
+			RGL::untyped_span{ mesh.tangents.data(), mesh.tangents.size_bytes() },
+			RGL::untyped_span{ mesh.bitangents.data(), mesh.bitangents.size_bytes() },
+			RGL::untyped_span{ mesh.uv0.data(), mesh.uv0.size_bytes() },
+			RGL::untyped_span{ mesh.lightmapUVs.data(), mesh.lightmapUVs.size_bytes() },
+			RGL::untyped_span{ mesh.indices.data(), mesh.indices.size_bytes() },
 		};
 
-		// mark the ranges as consumed
-		auto vertexPlacement = consumeRange(vertexAllocation, mesh.NumVerts(), vertexFreeList, vertexAllocatedList);
-		auto indexPlacement = consumeRange(indexAllocation, mesh.indices.size(), indexFreeList, indexAllocatedList);
+		// stage the data in the ring, so the copies are encoded by the render thread instead of submitted here
+		PendingMeshUpload upload{ .range = range };
+		uint32_t stagingSize = 0;
+		for (uint32_t i = 0; i < nMeshStreams; i++) {
+			upload.streamOffsets[i] = stagingSize;
+			upload.streamSizes[i] = streams[i].size();
+			stagingSize = closest_multiple_of<uint32_t>(stagingSize + streams[i].size(), 16);
+		}
+		if (ReserveMeshStaging(stagingSize, upload.stagingOffset)) {
+			const auto seq = pendingMeshUploadsFrontSeq + pendingMeshUploads.size();
+			pendingMeshUploads.push_back(upload);
+			mtx.unlock();
+
+			// the reserved region is not touched by anyone else until it is marked ready
+			auto staging = static_cast<char*>(meshStagingBuffer->GetMappedDataPtr()) + upload.stagingOffset;
+			for (uint32_t i = 0; i < nMeshStreams; i++) {
+				if (streams[i].size() > 0) {
+					std::memcpy(staging + upload.streamOffsets[i], streams[i].data(), streams[i].size());
+				}
+			}
 
-		MeshRange range{ vertexPlacement, indexPlacement };
+			mtx.lock();
+			pendingMeshUploads[seq - pendingMeshUploadsFrontSeq].state = PendingMeshUpload::State::Ready;
+			return range;
+		}
 
-		// upload buffer data
-		sharedPositionBuffer->SetBufferData({ mesh.positions.data(), mesh.positions.size_bytes() }, range.getPositionByteStart());
-		sharedNormalBuffer->SetBufferData({ mesh.normals.data(), mesh.normals.size_bytes() }, range.getNormalByteStart());
-		sharedTangentBuffer->SetBufferData({ mesh.tangents.data(), mesh.tangents.size_bytes() }, range.getTangentByteStart());
-		sharedBitangentBuffer->SetBufferData({ mesh.bitangents.data(), mesh.bitangents.size_bytes() }, range.getBitangentByteStart());
-		sharedUV0Buffer->SetBufferData({ mesh.uv0.data(), mesh.uv0.size_bytes() }, range.getUVByteStart());
+		// too large for the staging ring, or the ring is full
+		sharedPositionBuffer->SetBufferData(streams[0], range.getPositionByteStart());
+		sharedNormalBuffer->SetBufferData(streams[1], range.getNormalByteStart());
+		sharedTangentBuffer->SetBufferData(streams[2], range.getTangentByteStart());
+		sharedBitangentBuffer->SetBufferData(streams[3], range.getBitangentByteStart());
+		sharedUV0Buffer->SetBufferData(streams[4], range.getUVByteStart());
 		if (mesh.lightmapUVs.size() > 0) {
-			sharedLightmapUVBuffer->SetBufferData({ mesh.lightmapUVs.data(), mesh.lightmapUVs.size_bytes() }, range.getPositionByteStart());
+			sharedLightmapUVBuffer->SetBufferData(streams[5], range.getUVByteStart());
 		}
-
-		sharedIndexBuffer->SetBufferData(
-			{ mesh.indices.data(), mesh.indices.size_bytes() }, range.getIndexRangeByteStart()
-		);
+		sharedIndexBuffer->SetBufferData(streams[6], range.getIndexRangeByteStart());
 		
 		return range;
 	}
-	void RenderEngine::DeallocateMesh(const MeshRange& range)
+
+	bool RenderEngine::ReserveMeshStaging(uint32_t size, uint32_t& offset)
 	{
-        std::lock_guard mtx{allocationLock};
-		
-		auto deallocateData = [](Range range, allocation_allocatedlist_t& allocatedList, allocation_freelist_t& freeList) {
-
-			Range foundRange;
-			for (auto it = allocatedList.begin(); it != allocatedList.end(); it++) {
-				const auto& nextRange = *it;
-				if (nextRange.start >= range.start && nextRange.count >= range.count) {
-					foundRange = nextRange;
-					allocatedList.erase(it);
-					break;
+		if (pendingMeshUploads.empty()) {
+			meshStagingHead = meshStagingTail = 0;
+		}
+		// the ring is full when the head would reach the tail from below
+		if (meshStagingHead >= meshStagingTail) {
+			if (meshStagingHead + size <= meshStagingSizeBytes) {
+				offset = meshStagingHead;
+			}
+			else if (size < meshStagingTail) {
+				offset = 0;
+			}
+			else {
+				return false;
+			}
+		}
+		else if (meshStagingHead + size < meshStagingTail) {
+			offset = meshStagingHead;
+		}
+		else {
+			return false;
+		}
+		meshStagingHead = offset + size;
+		return true;
+	}
+
+	void RenderEngine::FlushMeshUploads()
+	{
+		RVE_PROFILE_FN;
+		static auto uploadBytes = PerfCounters::GetCounter("Render: Upload Bytes");
+		std::lock_guard mtx{ allocationLock };
+		using State = PendingMeshUpload::State;
+
+		// the previous batch was submitted a frame ago, so this rarely waits
+		if (meshUploadSubmitted) {
+			meshUploadCommandBuffer->BlockUntilCompleted();
+			meshUploadSubmitted = false;
+			for (auto& upload : pendingMeshUploads) {
+				if (upload.state == State::Encoded) {
+					upload.state = State::Done;
 				}
 			}
+		}
 
-			// xxxxx------xxxxx --> ----------xxxxx --> ----------------
+		// release staging space in the order it was reserved
+		while (!pendingMeshUploads.empty() && (pendingMeshUploads.front().state == State::Done || (pendingMeshUploads.front().state == State::Ready && pendingMeshUploads.front().cancelled))) {
+			pendingMeshUploads.pop_front();
+			pendingMeshUploadsFrontSeq++;
+		}
+		meshStagingTail = pendingMeshUploads.empty() ? meshStagingHead : pendingMeshUploads.front().stagingOffset;
 
-			//does this range border any other ranges? If so, don't push a new range onto the freelist, isntead merge the existing ranges
-			bool overlapFound = false;
-			for (auto& range : freeList) {
-				// the found range overlaps with a range to the left of it
-				if (range.start + range.count == foundRange.start) {
-					range.count += foundRange.count;
-					overlapFound = true;
-				}
-				// the found range overlaps with a range to the right of it
-				if (foundRange.start + foundRange.count == range.start) {
-					range.start -= foundRange.count;
-					range.count += foundRange.count;
-					overlapFound = true;
-				}
+		// destinations are resolved now, because growing or compacting the shared buffers may have moved the ranges
+		for (auto& upload : pendingMeshUploads) {
+			if (upload.state != State::Ready || upload.cancelled) {
+				continue;
 			}
-			if (!overlapFound) {
-				freeList.push_back(range);
+			if (!meshUploadSubmitted) {
+				meshUploadCommandBuffer->Reset();
+				meshUploadCommandBuffer->Begin();
+				meshUploadSubmitted = true;
+			}
+			const auto& range = upload.range;
+			const std::array<std::pair<RGLBufferPtr, uint32_t>, nMeshStreams> destinations{ {
+				{ sharedPositionBuffer, range.getPositionByteStart() },
+				{ sharedNormalBuffer, range.getNormalByteStart() },
+				{ sharedTangentBuffer, range.getTangentByteStart() },
+				{ sharedBitangentBuffer, range.getBitangentByteStart() },
+				{ sharedUV0Buffer, range.getUVByteStart() },
+				{ sharedLightmapUVBuffer, range.getUVByteStart() },
+				{ sharedIndexBuffer, range.getIndexRangeByteStart() },
+			} };
+			for (uint32_t i = 0; i < nMeshStreams; i++) {
+				if (upload.streamSizes[i] == 0) {
+					continue;
+				}
+				meshUploadCommandBuffer->CopyBufferToBuffer(
+					{
+						.buffer = meshStagingBuffer,
+						.offset = upload.stagingOffset + upload.streamOffsets[i],
+					},
+					{
+						.buffer = destinations[i].first,
+						.offset = destinations[i].second,
+					},
+					upload.streamSizes[i]
+				);
+				uploadBytes->Add(upload.streamSizes[i]);
 			}
+			upload.state = State::Encoded;
+		}
+		if (meshUploadSubmitted) {
+			meshUploadCommandBuffer->End();
+			meshUploadCommandBuffer->Commit({});
+		}
+	}
 
+	void RenderEngine::DeallocateMesh(const MeshRange& range)
+	{
+        std::lock_guard mtx{allocationLock};
+		
+		auto deallocateData = [](allocation_allocatedlist_t::iterator it, allocation_allocatedlist_t& allocatedList, OffsetAllocator& allocator) {
+			allocator.Free(it->node);
+			allocatedList.erase(it);
 		};
+		// staged data for this mesh no longer has anywhere to go
+		for (auto& upload : pendingMeshUploads) {
+			if (upload.range.getVertRange() == range.getVertRange() && upload.range.getIndexRange() == range.getIndexRange()) {
+				upload.cancelled = true;
+			}
+		}
 		if (range.getVertRange().getNodePointer() != nullptr) {
-			deallocateData(*range.getVertRange(), vertexAllocatedList, vertexFreeList);
+			deallocateData(range.getVertRange(), vertexAllocatedList, vertexAllocator);
 		}
 		if (range.getIndexRange().getNodePointer() != nullptr) {
-			deallocateData(*range.getIndexRange(), indexAllocatedList, indexFreeList);
+			deallocateData(range.getIndexRange(), indexAllocatedList, indexAllocator);
 		}
 	}
 
-	uint32_t RenderEngine::WriteTransient(RGL::untyped_span data)
+	RenderEngine::TransientAllocation RenderEngine::WriteTransient(RGL::untyped_span data, uint32_t alignment)
 	{
-		auto start = transientOffset;
-
-		if (start + data.size() > transientSizeBytes) {
-			Debug::Fatal("Not enough space left in transient buffer");
+		// vulkan requires at least this
+		alignment = std::max(alignment, 16u);
+		const auto size = uint32_t(data.size());
+		auto& arena = CurrentTransientArena();
+		auto fits = [size, alignment](const TransientBlock& block) {
+			return closest_multiple_of(block.offset, alignment) + size <= block.size;
+		};
+		while (arena.currentBlock < arena.blocks.size() && !fits(arena.blocks[arena.currentBlock])) {
+			arena.currentBlock++;
+		}
+		if (arena.currentBlock == arena.blocks.size()) {
+			// chain another block, large enough for this write
+			const auto blockSize = std::max(transientBlockSizeBytes, closest_power_of<uint32_t>(size, 2));
+			auto& block = arena.blocks.emplace_back();
+			block.size = blockSize;
+			block.buffer = device->CreateBuffer({
+				blockSize,
+				{.StorageBuffer = true},
+				sizeof(char),
+				RGL::BufferAccess::Private,
+				{.TransferDestination = true, .PixelShaderResource = true, .debugName = "Transient Buffer" }
+			});
+			block.stagingBuffer = device->CreateBuffer({
+				blockSize,
+				{.StorageBuffer = true},
+				sizeof(char),
+				RGL::BufferAccess::Shared,
+				{.Transfersource = true, .debugName = "Transient Staging Buffer" }
+			});
+			block.stagingBuffer->MapMemory();
 		}
 
-		std::memcpy((char*)(transientStagingBuffer->GetMappedDataPtr()) + start,data.data(),data.size());
-
-		transientOffset += data.size();
-		transientOffset = closest_multiple_of<decltype(transientOffset)>(transientOffset, 16);	// vulkan requires this
+		auto& block = arena.blocks[arena.currentBlock];
+		const auto start = closest_multiple_of(block.offset, alignment);
+		std::memcpy(static_cast<char*>(block.stagingBuffer->GetMappedDataPtr()) + start, data.data(), size);
+		arena.bytesUsed += start + size - block.offset;
+		block.offset = start + size;
 
-		return start;
+		return { block.buffer, start };
 	}
 
-	void RavEngine::RenderEngine::ReallocateVertexAllocationToSize(uint32_t newSize)
+	bool RenderEngine::EncodeTransientSync(RGLCommandBufferPtr commandBuffer)
 	{
-		ReallocateGeneric(sharedPositionBuffer, currentVertexSize, newSize, vertexAllocatedList, vertexFreeList, sizeof(VertexPosition_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Position Buffer");
-		ReallocateGeneric(sharedNormalBuffer, currentVertexSize, newSize, vertexAllocatedList, vertexFreeList, sizeof(VertexNormal_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Normal Buffer");
-		ReallocateGeneric(sharedTangentBuffer, currentVertexSize, newSize, vertexAllocatedList, vertexFreeList, sizeof(VertexTangent_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Tangent Buffer");
-		ReallocateGeneric(sharedBitangentBuffer, currentVertexSize, newSize, vertexAllocatedList, vertexFreeList, sizeof(VertexBitangent_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Bitangent Buffer");
-		ReallocateGeneric(sharedUV0Buffer, currentVertexSize, newSize, vertexAllocatedList, vertexFreeList, sizeof(VertexUV_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared UV0 Buffer");
-		ReallocateGeneric(sharedLightmapUVBuffer, currentVertexSize, newSize, vertexAllocatedList, vertexFreeList, sizeof(VertexUV_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared LightmapUV Buffer");
+		auto& arena = CurrentTransientArena();
+		transientHighWaterMark = std::max(transientHighWaterMark, arena.bytesUsed);
+		RVE_PROFILE_PLOT("Transient Bytes", int64_t(arena.bytesUsed));
+		if (arena.bytesUsed == 0) {
+			return false;
+		}
+		commandBuffer->Reset();
+		commandBuffer->Begin();
+		for (const auto& block : arena.blocks) {
+			if (block.offset == 0) {
+				continue;
+			}
+			commandBuffer->CopyBufferToBuffer({
+				.buffer = block.stagingBuffer,
+				.offset = 0
+			}, {
+				.buffer = block.buffer,
+				.offset = 0
+			}, block.offset);
+		}
+		commandBuffer->End();
+		return true;
 	}
-	void RenderEngine::ReallocateIndexAllocationToSize(uint32_t newSize)
+
+	RenderEngine::TransientAllocation RenderEngine::WriteDebugVertices(DebugVertexArena& arena, RGL::untyped_span vertices)
 	{
-		ReallocateGeneric(sharedIndexBuffer, currentIndexSize, newSize, indexAllocatedList, indexFreeList, sizeof(uint32_t), {.IndexBuffer = true}, lastResizeFrameIB, "Shared Index Buffer");
+		auto& frame = arena.frames[frameCount % debugVertexFramesInFlight];
+		const auto count = uint32_t(vertices.size() / arena.stride);
+		if (frame.used + count > frame.capacity) {
+			// draws already recorded this frame keep the old buffer alive until the frame is done
+			gcBuffers.enqueue(frame.buffer);
+			frame.capacity = std::max({ frame.capacity * 2, count, 16384u });
+			frame.buffer = device->CreateBuffer({
+				frame.capacity,
+				{.VertexBuffer = true},
+				arena.stride,
+				RGL::BufferAccess::Shared,
+				{.debugName = arena.debugName}
+			});
+			frame.buffer->MapMemory();
+			frame.used = 0;
+		}
+		const auto offset = frame.used;
+		std::memcpy(static_cast<char*>(frame.buffer->GetMappedDataPtr()) + size_t(offset) * arena.stride, vertices.data(), vertices.size());
+		frame.used += count;
+		return { frame.buffer, offset };
 	}
-	void RenderEngine::ReallocateGeneric(RGLBufferPtr& reallocBuffer, uint32_t& targetBufferCurrentSize, uint32_t newSize, allocation_allocatedlist_t& allocatedList, allocation_freelist_t& freelist, uint32_t stride, RGL::BufferConfig::Type bufferType, decltype(frameCount)& lastResizeFrame, const char* debugName)
+
+	void RavEngine::RenderEngine::ReallocateVertexAllocationToSize(uint32_t newSize)
 	{
 		// newsize is the minimum size needed to fit the new data and nothing more
 		// we want to over-allocate a bit in case more data is loaded
 		newSize = closest_power_of<float>(newSize, 1.5f);
-
-
+		ReallocateGeneric(sharedPositionBuffer, currentVertexSize, newSize, sizeof(VertexPosition_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Position Buffer");
+		ReallocateGeneric(sharedNormalBuffer, currentVertexSize, newSize, sizeof(VertexNormal_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Normal Buffer");
+		ReallocateGeneric(sharedTangentBuffer, currentVertexSize, newSize, sizeof(VertexTangent_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Tangent Buffer");
+		ReallocateGeneric(sharedBitangentBuffer, currentVertexSize, newSize, sizeof(VertexBitangent_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared Bitangent Buffer");
+		ReallocateGeneric(sharedUV0Buffer, currentVertexSize, newSize, sizeof(VertexUV_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared UV0 Buffer");
+		ReallocateGeneric(sharedLightmapUVBuffer, currentVertexSize, newSize, sizeof(VertexUV_t), { .StorageBuffer = true, .VertexBuffer = true }, lastResizeFrameVB, "Shared LightmapUV Buffer");
+		currentVertexSize = newSize;
+		vertexAllocator.Grow(newSize);
+	}
+	void RenderEngine::ReallocateIndexAllocationToSize(uint32_t newSize)
+	{
+		newSize = closest_power_of<float>(newSize, 1.5f);
+		ReallocateGeneric(sharedIndexBuffer, currentIndexSize, newSize, sizeof(uint32_t), {.IndexBuffer = true}, lastResizeFrameIB, "Shared Index Buffer");
+		currentIndexSize = newSize;
+		indexAllocator.Grow(newSize);
+	}
+	void RenderEngine::ReallocateGeneric(RGLBufferPtr& reallocBuffer, uint32_t oldSize, uint32_t newSize, uint32_t stride, RGL::BufferConfig::Type bufferType, decltype(frameCount)& lastResizeFrame, const char* debugName)
+	{
 		auto oldBuffer = reallocBuffer;
 		// trash old buffer
 		reallocBuffer = device->CreateBuffer({
@@ -193,69 +337,136 @@ namespace RavEngine {
 			{.TransferDestination = true, .Transfersource = true, .debugName = debugName}
 			});
 
-		auto extendLastRange = [&freelist,newSize,targetBufferCurrentSize]() {
-			if (freelist.size() == 0) {
-				// add a new range representing the space that has been made available
-                freelist.push_back(Range{targetBufferCurrentSize, newSize - targetBufferCurrentSize});
-				return;
-			}
-			// otherwise find the last range and extend its length
-			auto lastIt = freelist.begin();
-			for (auto it = freelist.begin(); it != freelist.end(); it++) {
-				if (it->start > lastIt->start) {
-					lastIt = it;
-				}
-			}
-			lastIt->count = newSize - lastIt->start;
-		};
-		targetBufferCurrentSize = newSize;
-
-
 		// no copying needed if the buffer began empty
 		if (oldBuffer == nullptr) {
-			extendLastRange();
 			return;
 		}
 
 		if (lastResizeFrame != frameCount) {	// if they are equal, then this means a resize occurred on this frame. Therefore, we don't want to schedule deletion of the buffer
 			gcBuffers.enqueue(oldBuffer);
 		}
-		
 
+		// allocations keep their offsets when growing, so the old contents are copied as-is
+		auto commandbuffer = mainCommandQueue->CreateCommandBuffer();
+		auto fence = device->CreateFence({});
+		commandbuffer->Begin();
+		commandbuffer->CopyBufferToBuffer(
+			{
+				.buffer = oldBuffer,
+				.offset = 0,
+			},
+			{
+				.buffer = reallocBuffer,
+				.offset = 0,
+			},
+			oldSize * stride
+		);
+		// submit and wait
+		commandbuffer->End();
+		commandbuffer->Commit({ fence });
+		fence->Wait();
+		lastResizeFrame = frameCount;
+	}
 
-		// begin compaction
+	void RenderEngine::CompactMeshAllocations()
+	{
+		std::lock_guard mtx{ allocationLock };
 
 		auto commandbuffer = mainCommandQueue->CreateCommandBuffer();
 		auto fence = device->CreateFence({});
 		commandbuffer->Begin();
 
-		// fill holes and copy data
-		{
-			uint32_t offset = 0;
-			for (auto& ptr : allocatedList) {
-				auto oldstart = ptr.start;
-				// copy buffers from:oldBuffer, offset:oldstart, to:sharedVertexBuffer offset:offset, size: ptr->count
-				commandbuffer->CopyBufferToBuffer(
-					{
-						.buffer = oldBuffer,
-						.offset = oldstart * stride,
-					},
-					{
-						.buffer = reallocBuffer,
-						.offset = offset * stride,
-					},
-					ptr.count * stride
-				);
-				ptr.start = offset;
-				offset += ptr.count;
+		struct BufferToCompact {
+			RGLBufferPtr* buffer;
+			uint32_t stride;
+			const char* debugName;
+		};
+
+		/**
+		* Repack an allocated list from offset 0, and copy every buffer sharing it into a fresh buffer at the new offsets
+		*/
+		auto compact = [this, &commandbuffer](allocation_allocatedlist_t& allocatedList, OffsetAllocator& allocator, uint32_t size, std::initializer_list<BufferToCompact> buffers, RGL::BufferConfig::Type bufferType) {
+			// a fresh allocator places each allocation directly after the previous one
+			allocator.Reset(size);
+			Vector<OffsetAllocator::Allocation> placements;
+			placements.reserve(allocatedList.size());
+			for (const auto& range : allocatedList) {
+				placements.push_back(allocator.Allocate(range.count));
 			}
-		}
+
+			for (const auto& [buffer, stride, debugName] : buffers) {
+				auto oldBuffer = *buffer;
+				*buffer = device->CreateBuffer({
+					size,
+					bufferType,
+					stride,
+					RGL::BufferAccess::Private,
+					{.TransferDestination = true, .Transfersource = true, .debugName = debugName}
+					});
+				uint32_t i = 0;
+				for (const auto& range : allocatedList) {
+					if (range.count > 0) {
+						commandbuffer->CopyBufferToBuffer(
+							{
+								.buffer = oldBuffer,
+								.offset = range.start * stride,
+							},
+							{
+								.buffer = *buffer,
+								.offset = placements[i].offset * stride,
+							},
+							range.count * stride
+						);
+					}
+					i++;
+				}
+				gcBuffers.enqueue(oldBuffer);
+			}
+
+			uint32_t i = 0;
+			for (auto& range : allocatedList) {
+				range.start = placements[i].offset;
+				range.node = placements[i].node;
+				i++;
+			}
+		};
+
+		compact(vertexAllocatedList, vertexAllocator, currentVertexSize, {
+			{ &sharedPositionBuffer, sizeof(VertexPosition_t), "Shared Position Buffer" },
+			{ &sharedNormalBuffer, sizeof(VertexNormal_t), "Shared Normal Buffer" },
+			{ &sharedTangentBuffer, sizeof(VertexTangent_t), "Shared Tangent Buffer" },
+			{ &sharedBitangentBuffer, sizeof(VertexBitangent_t), "Shared Bitangent Buffer" },
+			{ &sharedUV0Buffer, sizeof(VertexUV_t), "Shared UV0 Buffer" },
+			{ &sharedLightmapUVBuffer, sizeof(VertexUV_t), "Shared LightmapUV Buffer" },
+		}, { .StorageBuffer = true, .VertexBuffer = true });
+		compact(indexAllocatedList, indexAllocator, currentIndexSize, {
+			{ &sharedIndexBuffer, sizeof(uint32_t), "Shared Index Buffer" }
+		}, { .IndexBuffer = true });
+
 		// submit and wait
 		commandbuffer->End();
 		commandbuffer->Commit({ fence });
-		extendLastRange();
 		fence->Wait();
-		lastResizeFrame = frameCount;
+		meshAllocationGeneration++;
+	}
+
+	void RenderEngine::CompactMeshAllocationsIfFragmented()
+	{
+		if (meshCompactionThreshold <= 0) {
+			return;
+		}
+		auto isFragmented = [this](const OffsetAllocator& allocator) {
+			const auto free = allocator.GetFreeStorage();
+			return free > 0 && 1 - float(allocator.GetLargestFreeRegion()) / free > meshCompactionThreshold;
+		};
+		bool shouldCompact;
+		{
+			std::lock_guard mtx{ allocationLock };
+			shouldCompact = isFragmented(vertexAllocator) || isFragmented(indexAllocator);
+		}
+		if (shouldCompact) {
+			CompactMeshAllocations();
+		}
 	}
 }
 #endif
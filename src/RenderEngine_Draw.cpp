@@ -11,6 +11,8 @@
 #include <im3d.h>
 #include <GUI.hpp>
 #include <AnimatorComponent.hpp>
+#include "BakedAnimatorComponent.hpp"
+#include "BakedAnimation.hpp"
 #include "MeshAssetSkinned.hpp"
 #include "MeshAsset.hpp"
 #include "SkeletonAsset.hpp"
@@ -18,6 +20,8 @@
 #include "Debug.hpp"
 #include <glm/gtc/type_ptr.hpp>
 #include <chrono>
+#include <bit>
+#include <cstring>
 #include "Transform.hpp"
 #include "ParticleEmitter.hpp"
 #include "ParticleMaterial.hpp"
@@ -26,6 +30,9 @@
 #include "MeshCollection.hpp"
 #include "Tonemap.hpp"
 #include "BuiltinTonemap.hpp"
+#include "FrameArena.hpp"
+#include "PerfCounters.hpp"
+#include "SpatialBoundsComponent.hpp"
 #include <ravengine_shader_defs.h>
 
 #undef near		// for some INSANE reason, Microsoft defines these words and they leak into here only on ARM targets
@@ -44,8 +51,55 @@ struct LightingType{
 	bool FilterLightBlockers : 1 = false;
 	bool Transparent : 1 = false;
 	bool Opaque : 1 = false;
+	bool StaticCastersOnly : 1 = false;		// shadow passes: only entities with a static Transform
+	bool DynamicCastersOnly : 1 = false;	// shadow passes: skip entities with a static Transform
+	bool SkipOcclusion : 1 = false;			// views without a depth pyramid of their own, like shadow views
 };
 
+// the shadow bits of CullingUBO::singleInstanceModeAndShadowMode, see defaultcull.csh
+static uint32_t ShadowModeBits(const LightingType& filter) {
+	return (filter.FilterLightBlockers ? (1 << 1) : 0u) | (filter.StaticCastersOnly ? (1 << 2) : 0u) | (filter.DynamicCastersOnly ? (1 << 3) : 0u) | (filter.SkipOcclusion ? (1 << 4) : 0u);
+}
+
+// Gribb-Hartmann plane extraction, as in SpatialIndex::QueryFrustum. Points in the frustum are on the positive side of every plane.
+static std::array<glm::vec4, 6> FrustumPlanes(const glm::mat4& viewProj) {
+	auto row = [&viewProj](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+	const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+	return { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2 };
+}
+
+static bool SphereIntersectsFrustum(const glm::mat4& viewProj, const glm::vec3& center, float radius) {
+	for (const auto& plane : FrustumPlanes(viewProj)) {
+		const glm::vec3 n(plane);
+		if (glm::dot(n, center) + plane.w < -radius * glm::length(n)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static float Halton(uint32_t index, uint32_t base) {
+	float result = 0, fraction = 1;
+	for (; index > 0; index /= base) {
+		fraction /= base;
+		result += fraction * (index % base);
+	}
+	return result;
+}
+
+// the temporal upscaling jitter for a frame, in pixels from the pixel center. The 8 points of Halton(2,3) cover the pixel evenly
+static glm::vec2 TemporalJitter(uint64_t frame) {
+	const auto index = uint32_t(frame % 8) + 1;
+	return { Halton(index, 2) - 0.5f, Halton(index, 3) - 0.5f };
+}
+
+// shifts clip space by a jitter in pixels of a render area. Pixel rows run opposite to clip space y
+static glm::mat4 JitterMatrix(glm::vec2 jitter, const RGL::Rect& renderArea) {
+	glm::mat4 mtx(1);
+	mtx[3] = glm::vec4(2 * jitter.x / renderArea.extent[0], -2 * jitter.y / renderArea.extent[1], 0, 1);
+	return mtx;
+}
+
 #ifndef NDEBUG
 	static DebugDrawer dbgdraw;	//for rendering debug primitives
 #endif
@@ -92,23 +146,364 @@ struct LightingType{
 
 	};
 
+	// changes whenever the set or the placement of the world's static casters may have changed
+	uint64_t RenderEngine::StaticShadowCastersKey(const World* world) const {
+		uint64_t key = reinterpret_cast<uintptr_t>(world);
+		auto mix = [&key](uint64_t value) {
+			key ^= value + 0x9e3779b97f4a7c15 + (key << 6) + (key >> 2);
+		};
+		mix(world->staticMembershipVersion);
+		mix(world->staticMoveVersion);
+		mix(shadowCacheInvalidations);
+		mix(meshAllocationGeneration);
+		for (const auto& [materialInstance, drawcommand] : world->renderData.staticMeshRenderData) {
+			mix(reinterpret_cast<uintptr_t>(materialInstance.mat.get()));
+			for (const auto& command : drawcommand.commands) {
+				mix(reinterpret_cast<uintptr_t>(command.mesh.lock().get()));
+				mix(command.entities.DenseSize());
+			}
+		}
+		return key;
+	}
+
+	// conservative for meshes: their layers and culling are only known on the GPU, and reading the draw counts back would stall
+	bool RenderEngine::CameraHasTransparency(World* world, renderlayer_t layers, const glm::mat4& viewProj) const {
+		auto hasInstances = [](const auto& drawcommand) {
+			return std::ranges::any_of(drawcommand.commands, [](const auto& command) {
+				return command.entities.DenseSize() > 0;
+			});
+		};
+		auto isTransparent = [](const auto& materialVariant) {
+			return std::visit([](auto&& mat) {
+				return mat->IsTransparent();
+			}, materialVariant);
+		};
+		for (const auto& [materialInstance, drawcommand] : world->renderData.staticMeshRenderData) {
+			if (isTransparent(materialInstance.mat->GetMat()->variant) && hasInstances(drawcommand)) {
+				return true;
+			}
+		}
+		for (const auto& [materialInstance, drawcommand] : world->renderData.skinnedMeshRenderData) {
+			if (isTransparent(materialInstance.mat->GetMat()->variant) && hasInstances(drawcommand)) {
+				return true;
+			}
+		}
+
+		// the same tests the particle pass makes
+		bool found = false;
+		world->Filter([&](const ParticleEmitter& emitter, const Transform&) {
+			if (found || !emitter.GetVisible() || !emitter.poolSlot.IsValid() || (world->renderData.renderLayers[emitter.GetOwner().GetID().id] & layers) == 0) {
+				return;
+			}
+			if (emitter.culling.boundsRadius > 0 && !SphereIntersectsFrustum(viewProj, emitter.renderState.worldBoundsCenter, emitter.renderState.worldBoundsRadius)) {
+				return;
+			}
+			found = std::visit([&isTransparent](auto&& materialInstance) {
+				return isTransparent(materialInstance->GetMaterial());
+			}, emitter.GetRenderMaterial());
+		});
+		return found;
+	}
+
+	void RenderEngine::UpdateShadowAtlas(World* world, std::span<const RenderViewCollection> screenTargets) {
+		RVE_PROFILE_FN_N("Update Shadow Atlas");
+		// the largest diameter in pixels of a light's sphere of influence in any view, or 0 if no view can see it
+		auto pixelDiameter = [&screenTargets](const glm::vec3& center, float radius) {
+			float largest = 0;
+			for (const auto& view : screenTargets) {
+				for (const auto& camData : view.camDatas) {
+					if (!SphereIntersectsFrustum(camData.viewProj, center, radius)) {
+						continue;
+					}
+					const float height = camData.targetHeight;
+					const float dist = glm::distance(center, camData.camPos);
+					const float diameter = dist <= radius ? height : radius * std::abs(camData.projOnly[1][1]) / dist * height;
+					largest = std::max(largest, std::min(diameter, height));
+				}
+			}
+			return largest;
+		};
+		const auto shift = ShadowResolutionShift();
+		auto tileSize = [shift](float pixels, uint16_t maxSize) {
+			return uint16_t(std::clamp<uint32_t>(std::bit_ceil(uint32_t(pixels)), shadowAtlasMinTileSize, maxSize >> shift));
+		};
+
+		struct TileRequest {
+			uint64_t key;
+			uint16_t size;
+			float importance;
+		};
+		FrameVector<TileRequest> requests;
+		auto& spotLights = world->renderData.spotLightData;
+		for (uint32_t i = 0; i < spotLights.DenseSize(); i++) {
+			const auto& light = spotLights.GetAtDenseIndex(i);
+			if (!light.castsShadows) {
+				continue;
+			}
+			const auto pixels = pixelDiameter(glm::vec3(light.worldTransform[3]), std::sqrt(light.intensity / LIGHT_MIN_INFLUENCE));
+			if (pixels > 0) {
+				requests.push_back({ ShadowAtlasKey(spotLights.GetSparseIndexForDense(i), spotLightAtlasFace), tileSize(pixels, maxSpotShadowTileSize), pixels });
+			}
+		}
+		auto& pointLights = world->renderData.pointLightData;
+		for (uint32_t i = 0; i < pointLights.DenseSize(); i++) {
+			const auto& light = pointLights.GetAtDenseIndex(i);
+			if (!light.castsShadows) {
+				continue;
+			}
+			const auto pixels = pixelDiameter(light.position, std::sqrt(light.intensity / LIGHT_MIN_INFLUENCE));
+			if (pixels > 0) {
+				// a face sees a quarter of the light's surroundings
+				for (uint8_t face = 0; face < 6; face++) {
+					requests.push_back({ ShadowAtlasKey(pointLights.GetSparseIndexForDense(i), face), tileSize(pixels / 2, maxPointShadowTileSize), pixels });
+				}
+			}
+		}
+
+		// release the tiles of lights that no longer need one
+		for (const auto& request : requests) {
+			shadowAtlasEntries[request.key].lastUsedFrame = frameCount;
+		}
+		for (auto it = shadowAtlasEntries.begin(); it != shadowAtlasEntries.end();) {
+			if (it->second.lastUsedFrame != frameCount) {
+				if (it->second.tile.IsValid()) {
+					shadowAtlasAllocator.Free(it->second.tile);
+				}
+				shadowAtlasEntries.erase(it++);
+			}
+			else {
+				++it;
+			}
+		}
+
+		// place the lights that appear largest first. If the atlas is full, try smaller tiles.
+		// A tile may be one size too large, so lights near a size boundary do not move every frame.
+		std::sort(requests.begin(), requests.end(), [](const TileRequest& a, const TileRequest& b) {
+			return a.importance > b.importance;
+		});
+		for (const auto& request : requests) {
+			auto& entry = shadowAtlasEntries.at(request.key);
+			const auto oldTile = entry.tile;
+			if (entry.tile.IsValid() && entry.tile.size < request.size) {
+				// only move if the atlas has room for the larger tile
+				if (auto larger = shadowAtlasAllocator.Allocate(request.size); larger.IsValid()) {
+					shadowAtlasAllocator.Free(entry.tile);
+					entry.tile = larger;
+				}
+			}
+			else if (entry.tile.IsValid() && entry.tile.size > request.size * 2) {
+				shadowAtlasAllocator.Free(entry.tile);
+				entry.tile = {};
+			}
+			for (uint16_t size = request.size; size >= shadowAtlasMinTileSize && !entry.tile.IsValid(); size /= 2) {
+				entry.tile = shadowAtlasAllocator.Allocate(size);
+			}
+			if (entry.tile != oldTile) {
+				entry.staticCastersKey = 0;		// the static layer belongs to the old tile
+			}
+		}
+
+		// the shaders read the tiles from the light data, so only write lights whose tile changed
+		const uint32_t atlasIndex = shadowAtlasTexture->GetDefaultView().GetReadonlyBindlessTextureHandle();
+		auto tileRect = [this](uint64_t key) {
+			auto it = shadowAtlasEntries.find(key);
+			if (it == shadowAtlasEntries.end() || !it->second.tile.IsValid()) {
+				return glm::vec4(0);
+			}
+			const auto& tile = it->second.tile;
+			return glm::vec4(tile.x, tile.y, tile.size, tile.size) / float(shadowAtlasSize);
+		};
+		for (uint32_t i = 0; i < spotLights.DenseSize(); i++) {
+			const auto sparseIdx = spotLights.GetSparseIndexForDense(i);
+			const auto rect = tileRect(ShadowAtlasKey(sparseIdx, spotLightAtlasFace));
+			const auto& light = spotLights.GetAtDenseIndex(i);
+			if (light.shadowAtlasRect != rect || light.shadowmapBindlessIndex != atlasIndex) {
+				auto& upload = spotLights.GetForSparseIndexForWriting(sparseIdx);
+				upload.shadowAtlasRect = rect;
+				upload.shadowmapBindlessIndex = atlasIndex;
+			}
+		}
+		for (uint32_t i = 0; i < pointLights.DenseSize(); i++) {
+			const auto sparseIdx = pointLights.GetSparseIndexForDense(i);
+			std::array<glm::vec4, 6> rects;
+			for (uint8_t face = 0; face < 6; face++) {
+				rects[face] = tileRect(ShadowAtlasKey(sparseIdx, face));
+			}
+			const auto& light = pointLights.GetAtDenseIndex(i);
+			if (!std::equal(rects.begin(), rects.end(), std::begin(light.shadowAtlasRects)) || light.shadowmapBindlessIndex != atlasIndex) {
+				auto& upload = pointLights.GetForSparseIndexForWriting(sparseIdx);
+				std::copy(rects.begin(), rects.end(), std::begin(upload.shadowAtlasRects));
+				upload.shadowmapBindlessIndex = atlasIndex;
+			}
+		}
+	}
+
+	void RenderEngine::UpdateSkyCache(Skybox& skybox) {
+		auto& cache = skybox.cache;
+		const auto resolution = std::max(skybox.cacheResolution, 1u);
+		if (cache.faces && cache.version == skybox.version && cache.material == skybox.skyMat.get() && cache.resolution == resolution) {
+			return;
+		}
+		RVE_PROFILE_FN_N("Update Sky Cache");
+
+		if (cache.resolution != resolution) {
+			if (cache.faces) {
+				gcTextures.enqueue(cache.faces);
+				gcTextures.enqueue(cache.depth);
+			}
+			cache.faces = device->CreateTexture({
+				.usage = {.Sampled = true, .ColorAttachment = true },
+				.aspect = {.HasColor = true },
+				.width = resolution * 6,
+				.height = resolution,
+				.format = colorTexFormat,
+				.debugName = "Sky Cache Faces"
+			});
+			cache.depth = device->CreateTexture({
+				.usage = {.DepthStencilAttachment = true },
+				.aspect = {.HasDepth = true },
+				.width = resolution * 6,
+				.height = resolution,
+				.format = RGL::TextureFormat::D32SFloat,
+				.debugName = "Sky Cache Depth"
+			});
+		}
+		if (!cache.irradiance) {
+			cache.irradiance = device->CreateTexture({
+				.usage = {.Sampled = true, .ColorAttachment = true },
+				.aspect = {.HasColor = true },
+				.width = 6,
+				.height = 1,
+				.format = colorTexFormat,
+				.debugName = "Sky Cache Irradiance"
+			});
+		}
+
+		// each face is a square 90 degree view, drawn side by side with the material's own pipeline. The order matches sky_cache.glsl
+		skyCachePass->SetAttachmentTexture(0, cache.faces->GetDefaultView());
+		skyCachePass->SetDepthAttachmentTexture(cache.depth->GetDefaultView());
+		mainCommandBuffer->BeginRenderDebugMarker("Render Sky Cache");
+		mainCommandBuffer->BeginRendering(skyCachePass);
+		mainCommandBuffer->BindRenderPipeline(skybox.skyMat->GetMat()->renderPipeline);
+		mainCommandBuffer->SetVertexBuffer(screenTriVerts);
+		for (uint32_t face = 0; face < 6; face++) {
+			const auto axis = face / 2;
+			const float sign = face % 2 == 0 ? 1 : -1;
+			glm::vec3 forward{ 0 };
+			forward[axis] = sign;
+			const auto up = axis == 1 ? glm::vec3(0, 0, sign) : glm::vec3(0, 1, 0);
+			const auto right = glm::cross(forward, up);
+
+			auto transientAllocation = WriteTransient(SkyboxData{
+				.invView = glm::mat3(right, up, -forward),
+				.camPos = glm::vec3(0),
+				.fov = deg_to_rad(90.f),
+				.aspectRatio = 1,
+			});
+			mainCommandBuffer->BindBuffer(transientAllocation.buffer, 1, transientAllocation.offset);
+			mainCommandBuffer->SetViewport({
+				.x = float(face * resolution),
+				.y = 0,
+				.width = float(resolution),
+				.height = float(resolution),
+			});
+			mainCommandBuffer->SetScissor({
+				.offset = {int32_t(face * resolution), 0},
+				.extent = {resolution, resolution}
+			});
+			mainCommandBuffer->Draw(3);
+		}
+		mainCommandBuffer->EndRendering();
+
+		// the irradiance is convolved once here, rather than every frame in the ambient pass
+		skyIrradiancePass->SetAttachmentTexture(0, cache.irradiance->GetDefaultView());
+		mainCommandBuffer->BeginRendering(skyIrradiancePass);
+		mainCommandBuffer->BindRenderPipeline(skyIrradiancePipeline);
+		mainCommandBuffer->SetViewport({
+			.x = 0,
+			.y = 0,
+			.width = 6,
+			.height = 1,
+		});
+		mainCommandBuffer->SetScissor({
+			.offset = {0, 0},
+			.extent = {6, 1}
+		});
+		mainCommandBuffer->SetFragmentSampler(textureSampler, 0);
+		mainCommandBuffer->SetFragmentTexture(cache.faces->GetDefaultView(), 1);
+		mainCommandBuffer->SetVertexBuffer(screenTriVerts);
+		mainCommandBuffer->Draw(3);
+		mainCommandBuffer->EndRendering();
+		mainCommandBuffer->EndRenderDebugMarker();
+
+		cache.version = skybox.version;
+		cache.material = skybox.skyMat.get();
+		cache.resolution = resolution;
+	}
+
 	/**
  Render one frame using the current state of every object in the world
  */
 RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const std::span<RenderViewCollection> screenTargets, float guiScaleFactor) {
-    transientOffset = 0;
 	RVE_PROFILE_FN_N("RenderEngine::Draw");
+	const auto drawStart = std::chrono::steady_clock::now();
+	{
+		auto& arena = CurrentTransientArena();
+		for (auto& block : arena.blocks) {
+			block.offset = 0;
+		}
+		arena.currentBlock = 0;
+		arena.bytesUsed = 0;
+
+		auto& guiGeometry = guiFrameGeometry[frameCount % transientFramesInFlight];
+		guiGeometry.nVertices = 0;
+		guiGeometry.nIndices = 0;
+
+		im3dDebugVertices.frames[frameCount % debugVertexFramesInFlight].used = 0;
+		navDebugVertices.frames[frameCount % debugVertexFramesInFlight].used = 0;
+		debugShapeInstances.frames[frameCount % debugVertexFramesInFlight].used = 0;
+	}
 
 	worldOwning->renderData.stagingBufferPool.Reset();	// release unused buffers
     
     DestroyUnusedResources();
+	CompactMeshAllocationsIfFragmented();
+	FlushMeshUploads();
 	RVE_PROFILE_SECTION(resetCB, "Reset Command Buffer")
+	const auto syncStart = std::chrono::steady_clock::now();
     mainCommandBuffer->Reset();
+	const auto syncTime = std::chrono::steady_clock::now() - syncStart;
     mainCommandBuffer->Begin();
 	RVE_PROFILE_SECTION_END(resetCB);
+	ReportGPUPassTimings();	// Reset waited for the previous frame, so its timestamps are resolved
+	{
+		// the frame's GPU time spans from the first marked pass to the last
+		uint64_t beginNs = std::numeric_limits<uint64_t>::max(), endNs = 0;
+		for (const auto& region : GetGPUPassTimings()) {
+			beginNs = std::min(beginNs, region.beginNs);
+			endNs = std::max(endNs, region.endNs);
+		}
+		lastFrameTimings.gpuMs = endNs > beginNs ? float(endNs - beginNs) / 1e6f : 0;
+	}
+	UpdateRenderScale();
+	UpdateVRAMBudget(worldOwning.get());
+	textureStreamer.Update(device, mainCommandBuffer, *this);
+	asyncTextureLoader.Update(device, mainCommandBuffer, *this);
+	UpdateLightClusters();
    
 	RVE_PROFILE_SECTION(enc_sync_transforms,"Encode Sync Private Data");
     
+	UpdateShadowAtlas(worldOwning.get(), screenTargets);
+
+	auto skybox = worldOwning->skybox.get();
+	const bool skyCached = skybox && skybox->cached && skybox->skyMat && skybox->skyMat->GetMat()->renderPipeline;
+	if (skyCached) {
+		UpdateSkyCache(*skybox);
+	}
+
+	// the directional shadow cascades of this frame, which skinned meshes are culled against before skinning
+	FrameVector<glm::mat4> cascadeViewProjs;
+
     // sync private buffers
 	bool transformSyncCommandBufferNeedsCommit = false;
     {
@@ -140,6 +535,15 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
         // MDIIcommands
 		RVE_PROFILE_SECTION(staticmesh, "Encode Static Mesh Transforms");
         syncMeshData(wrd.staticMeshRenderData);
+        for (auto& [mat, command] : wrd.staticMeshRenderData) {
+            for (auto& draw : command.commands) {
+                auto mesh = draw.mesh.lock();
+                if (mesh->HasMeshlets()) {
+                    mesh->lodDrawSlots.EncodeSync(device, transformSyncCommandBuffer, gcbuffer, transformSyncCommandBufferNeedsCommit);
+                    mesh->meshletData.EncodeSync(device, transformSyncCommandBuffer, gcbuffer, transformSyncCommandBufferNeedsCommit);
+                }
+            }
+        }
 		RVE_PROFILE_SECTION_END(staticmesh);
 		RVE_PROFILE_SECTION(skinnedMesh, "Encode Skinned Mesh Trasnforms");
         syncMeshData(wrd.skinnedMeshRenderData);
@@ -151,13 +555,15 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
         for(const auto& target : screenTargets){
             numVaryingElts += target.camDatas.size();
         }
-        wrd.directionalLightPassVarying.Resize(numVaryingElts);
+        wrd.directionalLightPassVarying.BeginFrame(device, frameCount, numVaryingElts);
         if (wrd.directionalLightPassVaryingHostOnly.size() != numVaryingElts){
             wrd.directionalLightPassVaryingHostOnly.resize(numVaryingElts);
         }
         uint32_t passIndex = 0;
         for(const auto& target : screenTargets){
             for(const auto& camData : target.camDatas){
+                const bool isStereo = target.stereo && target.camDatas.size() == 2;
+                const bool isRightEye = isStereo && &camData == &target.camDatas[1];
                 // visit all the lights
                 for (uint32_t i = 0; i < wrd.directionalLightData.DenseSize(); i++) {
                     auto& light = wrd.directionalLightData.GetHostDenseForWriting(i);
@@ -168,8 +574,23 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
                     
                     const auto& origLight = worldOwning->GetComponent<DirectionalLight>({sparseIdx, worldOwning->VersionForEntity(sparseIdx)});
                     
+                    const uint32_t varyingLightIndex = passIndex + i;
+                    // built on the stack and stored whole, since the upload memory is write-combined and must not be read
+                    World::DirLightUploadDataPassVarying varying;
+                    
+                    // the right eye shades with the cascades of the left eye, which cover both
+                    if (isRightEye){
+                        wrd.directionalLightPassVarying[varyingLightIndex] = wrd.directionalLightPassVaryingHostOnly[varyingLightIndex - 1].varying;
+                        wrd.directionalLightPassVaryingHostOnly[varyingLightIndex] = wrd.directionalLightPassVaryingHostOnly[varyingLightIndex - 1];
+                        continue;
+                    }
+                    
+                    // the camera may ask for fewer cascades than the light has
+                    const auto numCascades = std::max<uint8_t>(std::min({origLight.numCascades, uint8_t(origLight.shadowCascades.size()), camData.features.maxShadowCascades}), 1);
+                    varying.numCascades = numCascades;
+                    
                     // iterate the cascades
-                    for(uint32_t index = 0; index < origLight.numCascades; index++){
+                    for(uint32_t index = 0; index < numCascades; index++){
                         
 #ifndef NDEBUG
                         Debug::Assert(std::is_sorted(std::begin(origLight.shadowCascades), std::end(origLight.shadowCascades)),"Cascades must be in sorted order");
@@ -207,7 +628,6 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
                         if (index > 0){
                             near = glm::mix(camData.zNearFar[0], camData.zNearFar[1], origLight.shadowCascades[index-1]);
                         }
-                        const auto numCascades = std::min<uint8_t>(origLight.numCascades, origLight.shadowCascades.size());
                         if (index < numCascades - 1){
                             far = glm::mix(camData.zNearFar[0], camData.zNearFar[1], origLight.shadowCascades[index]);
                         }
@@ -215,7 +635,14 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
                         //FIXME: the *1.5 is a hack. Without it, the matrices are not placed properly and the edges of the shadowmap cut into the view when the camera is not axis aligned in world space.
                         const auto proj = RMath::perspectiveProjection(deg_to_rad(camData.fov * 1.5), float(camData.targetWidth/camData.targetHeight), near, far);
                         
-                        auto corners = getFrustumCornersWorldSpace(proj, camData.viewOnly);
+                        Array<glm::vec4, 16> cornerStorage;
+                        std::ranges::copy(getFrustumCornersWorldSpace(proj, camData.viewOnly), cornerStorage.begin());
+                        uint32_t numCorners = 8;
+                        if (isStereo){
+                            std::ranges::copy(getFrustumCornersWorldSpace(proj, target.camDatas[1].viewOnly), cornerStorage.begin() + numCorners);
+                            numCorners += 8;
+                        }
+                        const std::span<const glm::vec4> corners(cornerStorage.data(), numCorners);
                         
                         glm::vec3 center(0, 0, 0);
                         for (const auto& v : corners)
@@ -273,20 +700,21 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
                         
                         auto lightProj = RMath::orthoProjection<float>(minX, maxX, minY, maxY, minZ, maxZ);
                         
-                        const uint32_t varyingLightIndex = passIndex + i;
-                        
-                        wrd.directionalLightPassVarying.GetValueAtForWriting(varyingLightIndex).lightViewProj[index] = lightProj * lightView;
+                        varying.lightViewProj[index] = lightProj * lightView;
                         wrd.directionalLightPassVaryingHostOnly[varyingLightIndex].lightview[index] = lightView;
                         wrd.directionalLightPassVaryingHostOnly[varyingLightIndex].lightProj[index] = lightProj;
+                        cascadeViewProjs.push_back(lightProj * lightView);
                         
-                        light.cascadeDistances[index] = far;
+                        varying.cascadeDistances[index] = far;
                     }
+                    wrd.directionalLightPassVarying[varyingLightIndex] = varying;
+                    wrd.directionalLightPassVaryingHostOnly[varyingLightIndex].varying = varying;
                 }
                 passIndex++;
             }
         }
         
-        wrd.directionalLightPassVarying.EncodeSync(device, transformSyncCommandBuffer, gcbuffer, transformSyncCommandBufferNeedsCommit);
+        wrd.directionalLightPassVarying.FlushAll();
 		RVE_PROFILE_SECTION_END(dirlight);
         
         if (transformSyncCommandBufferNeedsCommit){
@@ -346,6 +774,54 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 			}
 		};
 
+		// the output buffers all have the same count. Growing them keeps their contents, so skinned slots stay usable.
+		auto growSkinnedOutputBuffers = [this](uint32_t newCapacity) {
+			struct OutputBuffer {
+				RGLBufferPtr& buffer;
+				uint32_t stride;
+				const char* debugName;
+			};
+			OutputBuffer outputs[]{
+				{ sharedSkinnedPositionBuffer, sizeof(VertexPosition_t), "Shared Skinned Position Buffer" },
+				{ sharedSkinnedNormalBuffer, sizeof(VertexNormal_t), "Shared Skinned Normal Buffer" },
+				{ sharedSkinnedTangentBuffer, sizeof(VertexTangent_t), "Shared Skinned Tangent Buffer" },
+				{ sharedSkinnedBitangentBuffer, sizeof(VertexBitangent_t), "Shared Skinned Bitangent Buffer" },
+				{ sharedSkinnedUV0Buffer, sizeof(VertexUV_t), "Shared Skinned UV0 Buffer" },
+			};
+			const auto oldCapacity = skinnedOutputAllocator.GetCapacity();
+			for (auto& output : outputs) {
+				auto oldBuffer = output.buffer;
+				output.buffer = device->CreateBuffer({
+					newCapacity,
+					{ .StorageBuffer = true, .VertexBuffer = true },
+					output.stride,
+					RGL::BufferAccess::Private,
+					{ .TransferDestination = true, .Transfersource = true, .Writable = true, .debugName = output.debugName }
+					});
+				if (oldBuffer) {
+					// recorded before this frame's skinning
+					mainCommandBuffer->CopyBufferToBuffer(
+						{
+							.buffer = oldBuffer,
+							.offset = 0
+						},
+						{
+							.buffer = output.buffer,
+							.offset = 0
+						}, oldCapacity * output.stride
+					);
+					gcBuffers.enqueue(oldBuffer);
+				}
+			}
+			skinnedOutputAllocator.Grow(newCapacity);
+		};
+
+		// return the regions of destroyed commands
+		OffsetAllocator::node_t releasedRegion;
+		while (gcSkinnedOutput.try_dequeue(releasedRegion)) {
+			skinnedOutputAllocator.Free(releasedRegion);
+		}
+
 		for (auto& [materialInstance, drawcommand] : worldOwning->renderData.skinnedMeshRenderData) {
 			uint32_t totalEntitiesForThisCommand = 0;
 			for (auto& command : drawcommand.commands) {
@@ -355,6 +831,27 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 				if (auto mesh = command.mesh.lock()) {
 					totalVertsToSkin += mesh->GetNumVerts() * subCommandEntityCount;
+
+					// move the command's slots only when it outgrows them or uses under a third of them, leaving room to
+					// grow so that instances spawning one at a time do not move it every frame
+					auto& region = command.outputRegion;
+					if (!region.allocation.IsValid() || subCommandEntityCount > region.capacity || subCommandEntityCount * 3 < region.capacity) {
+						if (region.allocation.IsValid()) {
+							skinnedOutputAllocator.Free(region.allocation.node);
+						}
+						region.capacity = std::max(subCommandEntityCount + subCommandEntityCount / 2, subCommandEntityCount + 1);
+						const auto vertsToAllocate = region.capacity * mesh->GetNumVerts();
+						region.allocation = skinnedOutputAllocator.Allocate(vertsToAllocate);
+						if (!region.allocation.IsValid()) {
+							// twice the request leaves room for the allocator's size classes
+							const auto oldCapacity = skinnedOutputAllocator.GetCapacity();
+							growSkinnedOutputBuffers(std::max(oldCapacity + oldCapacity / 2, oldCapacity + vertsToAllocate * 2));
+							region.allocation = skinnedOutputAllocator.Allocate(vertsToAllocate);
+						}
+						// the new place holds nothing skinned for this command yet
+						command.slotPoses.clear();
+						command.outputVertexOffset = region.allocation.offset;
+					}
 				}
 
 				if (auto skeleton = command.skeleton.lock()) {
@@ -362,17 +859,14 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				}
 			}
 
-			resizeSkeletonBuffer(drawcommand.indirectBuffer, sizeof(RGL::IndirectIndexedCommand), totalEntitiesForThisCommand, { .StorageBuffer = true, .IndirectBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Skeleton per-material IndirectBuffer" });
+			// room for the most views a multi-view cull writes
+			resizeSkeletonBuffer(drawcommand.indirectBuffer, sizeof(RGL::IndirectIndexedCommand), totalEntitiesForThisCommand * maxCullViews, { .StorageBuffer = true, .IndirectBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Skeleton per-material IndirectBuffer" });
 			//TODO: skinned meshes do not support LOD groups
-			resizeSkeletonBuffer(drawcommand.cullingBuffer, sizeof(entity_t), totalEntitiesForThisCommand, { .StorageBuffer = true, .VertexBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Skeleton per-material cullingBuffer" });
+			resizeSkeletonBuffer(drawcommand.cullingBuffer, sizeof(entity_t), totalEntitiesForThisCommand * maxCullViews, { .StorageBuffer = true, .VertexBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Skeleton per-material cullingBuffer" });
 		}
 
-		resizeSkeletonBuffer(sharedSkeletonMatrixBuffer, sizeof(matrix4), totalJointsToSkin, { .StorageBuffer = true }, RGL::BufferAccess::Shared, { .debugName = "sharedSkeletonMatrixBuffer" });
-		resizeSkeletonBuffer(sharedSkinnedPositionBuffer, sizeof(VertexPosition_t), totalVertsToSkin, { .StorageBuffer = true, .VertexBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Shared Skinned Position Buffer" });
-		resizeSkeletonBuffer(sharedSkinnedNormalBuffer, sizeof(VertexNormal_t), totalVertsToSkin, { .StorageBuffer = true, .VertexBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Shared Skinned Position Buffer" });
-		resizeSkeletonBuffer(sharedSkinnedTangentBuffer, sizeof(VertexTangent_t), totalVertsToSkin, { .StorageBuffer = true, .VertexBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Shared Skinned Position Buffer" });
-		resizeSkeletonBuffer(sharedSkinnedBitangentBuffer, sizeof(VertexBitangent_t), totalVertsToSkin, { .StorageBuffer = true, .VertexBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Shared Skinned Position Buffer" });
-		resizeSkeletonBuffer(sharedSkinnedUV0Buffer, sizeof(VertexUV_t), totalVertsToSkin, { .StorageBuffer = true, .VertexBuffer = true }, RGL::BufferAccess::Private, { .Writable = true, .debugName = "Shared Skinned Position Buffer" });
+		resizeSkeletonBuffer(sharedSkeletonMatrixBuffer, sizeof(glm::mat4), totalJointsToSkin, { .StorageBuffer = true }, RGL::BufferAccess::Shared, { .debugName = "sharedSkeletonMatrixBuffer" });
+		resizeSkeletonBuffer(sharedSkinningSlotBuffer, sizeof(SkinningObject), totalObjectsToSkin, { .StorageBuffer = true }, RGL::BufferAccess::Shared, { .debugName = "sharedSkinningSlotBuffer" });
 
 
 		return {
@@ -394,6 +888,7 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				const auto mesh = command.mesh.lock();
 				const auto vertexCount = mesh->GetNumVerts();
 
+				ubo.vertexBufferOffset = command.outputVertexOffset;
 				ubo.nVerticesInThisMesh = vertexCount;
 				ubo.nTotalObjects = objectCount;
 				ubo.indexBufferOffset = mesh->GetAllocation().getIndexRangeStart();
@@ -402,7 +897,6 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				mainCommandBuffer->SetComputeBytes(ubo, 0);
 				mainCommandBuffer->DispatchCompute(std::ceil(objectCount / 32.0f), 1, 1, 32, 1, 1);
 
-				ubo.vertexBufferOffset += vertexCount;
 				ubo.drawCallBufferOffset += objectCount;
 				ubo.baseInstanceOffset += objectCount;
 			}
@@ -412,8 +906,46 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 	};
 		
 
-	auto poseSkeletalMeshes = [this,&worldOwning]() {
+	auto poseSkeletalMeshes = [this,&worldOwning,&screenTargets,&cascadeViewProjs]() {
 		RVE_PROFILE_FN_N("Enc Pose Skinned Meshes");
+		auto& wrd = worldOwning->renderData;
+
+		// Conservative CPU version of the culling shader's tests, over every view that may draw an instance this frame.
+		// Instances that no view can see are not skinned, and the culling shader rejects them before they are drawn.
+		auto isVisibleInAnyView = [&wrd, &screenTargets, &cascadeViewProjs](entity_id_t id, float meshRadius) {
+			const auto& model = wrd.worldTransforms[id];
+			const glm::vec3 center(model[3]);
+			const float radius = meshRadius * std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+			const auto layers = wrd.renderLayers[id];
+			for (const auto& target : screenTargets) {
+				for (const auto& camData : target.camDatas) {
+					if ((camData.layers & layers) && SphereIntersectsFrustum(camData.viewProj, center, radius)) {
+						return true;
+					}
+				}
+			}
+			if (!(wrd.perObjectAttributes[id] & CastsShadowsBit)) {
+				return false;
+			}
+			for (const auto& viewProj : cascadeViewProjs) {
+				if (SphereIntersectsFrustum(viewProj, center, radius)) {
+					return true;
+				}
+			}
+			for (uint32_t i = 0; i < wrd.spotLightData.DenseSize(); i++) {
+				const auto& light = wrd.spotLightData.GetAtDenseIndex(i);
+				if (light.castsShadows && (light.shadowLayers & layers) && SphereIntersectsFrustum(light.lightViewProj, center, radius)) {
+					return true;
+				}
+			}
+			for (uint32_t i = 0; i < wrd.pointLightData.DenseSize(); i++) {
+				const auto& light = wrd.pointLightData.GetAtDenseIndex(i);
+				if (light.castsShadows && (light.shadowLayers & layers) && glm::distance(center, light.position) < radius + std::sqrt(light.intensity / LIGHT_MIN_INFLUENCE)) {
+					return true;
+				}
+			}
+			return false;
+		};
 
 		mainCommandBuffer->BeginComputeDebugMarker("Pose Skinned Meshes");
 		mainCommandBuffer->BeginCompute(skinnedMeshComputePipeline);
@@ -430,36 +962,114 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 		mainCommandBuffer->BindComputeBuffer(sharedUV0Buffer, 14);
 
 		mainCommandBuffer->BindComputeBuffer(sharedSkeletonMatrixBuffer, 20);
+		mainCommandBuffer->BindComputeBuffer(sharedSkinningSlotBuffer, 22);
 		using mat_t = glm::mat4;
 		std::span<mat_t> matbufMem{ static_cast<mat_t*>(sharedSkeletonMatrixBuffer->GetMappedDataPtr()), sharedSkeletonMatrixBuffer->getBufferSize() / sizeof(mat_t) };
+		std::span<SkinningObject> slotbufMem{ static_cast<SkinningObject*>(sharedSkinningSlotBuffer->GetMappedDataPtr()), sharedSkinningSlotBuffer->getBufferSize() / sizeof(SkinningObject) };
 		SkinningUBO subo;
-		for (const auto& [materialInstance, drawcommand] : worldOwning->renderData.skinnedMeshRenderData) {
+		uint32_t boneWriteOffset = 0;
+		FrameVector<uint64_t> poses;
+		UnorderedMap<uint64_t, uint32_t> slotForPose;
+		UnorderedMap<const BakedAnimation*, Vector<SkinningObject>> bakedObjects;	// skinned from the baked animation's buffer instead
+
+		// 0 if the entity has no pose to skin
+		auto poseHashFor = [worldOwning](entity_t owner) -> uint64_t {
+			if (worldOwning->HasComponent<AnimatorComponent>(owner)) {
+				return worldOwning->GetComponent<AnimatorComponent>(owner).GetPoseHash();
+			}
+			if (worldOwning->HasComponent<BakedAnimatorComponent>(owner)) {
+				const auto& baked = worldOwning->GetComponent<BakedAnimatorComponent>(owner);
+				uint64_t hash = uintptr_t(baked.animation.get());
+				hash ^= baked.animation->GetFrameOffset(baked.clip, baked.GetClipTime()) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+				return hash == 0 ? 1 : hash;
+			}
+			return 0;
+		};
+		for (auto& [materialInstance, drawcommand] : wrd.skinnedMeshRenderData) {
 			for (auto& command : drawcommand.commands) {
 				auto skeleton = command.skeleton.lock();
 				auto mesh = command.mesh.lock();
-				auto& entities = command.entities;
-				mainCommandBuffer->BindComputeBuffer(mesh->GetWeightsBuffer(), 21);
+				const auto nEntities = command.entities.DenseSize();
 
-				subo.numObjects = command.entities.DenseSize();
 				subo.numVertices = mesh->GetNumVerts();
 				subo.numBones = skeleton->GetSkeleton()->num_joints();
 				subo.vertexReadOffset = mesh->GetAllocation().getVertexRangeStart();
 
-				// write joint transform matrices into buffer and update uniform offset
+				subo.vertexWriteOffset = command.outputVertexOffset;
+				command.slotPoses.resize(nEntities, 0);
+				command.slotOwners.resize(nEntities, INVALID_ENTITY);
+				command.outputSlots.resize(nEntities);
+
+				// pick one slot per visible pose, preferring a slot that already holds it
+				poses.assign(nEntities, 0);
+				slotForPose.clear();
 				{
-					uint32_t object_id = 0;
+					uint32_t i = 0;
 					for (const auto& ownerid : command.entities.GetReverseMap()) {
-                        auto& animator = worldOwning->GetComponent<AnimatorComponent>({ownerid, worldOwning->VersionForEntity(ownerid)});
-						const auto& skinningMats = animator.GetSkinningMats();
-						std::copy(skinningMats.begin(), skinningMats.end(), (matbufMem.begin() + subo.boneReadOffset) + object_id * skinningMats.size());
-						object_id++;
+						if (command.slotOwners[i] != ownerid) {
+							command.slotOwners[i] = ownerid;
+							command.slotPoses[i] = 0;
+						}
+						command.outputSlots[i] = i;
+						if (isVisibleInAnyView(ownerid, mesh->GetRadius()) && (poses[i] = poseHashFor({ ownerid, worldOwning->VersionForEntity(ownerid) }))) {
+							auto [it, inserted] = slotForPose.try_emplace(poses[i], i);
+							if (!inserted && command.slotPoses[it->second] != poses[i] && command.slotPoses[i] == poses[i]) {
+								it->second = i;
+							}
+						}
+						i++;
+					}
+				}
+
+				// write the joint matrices and slots of the instances that need skinning
+				subo.numObjects = 0;
+				bakedObjects.clear();
+				{
+					uint32_t i = 0;
+					for (const auto& ownerid : command.entities.GetReverseMap()) {
+						if (poses[i] != 0) {
+							const auto slot = slotForPose.at(poses[i]);
+							command.outputSlots[i] = slot;
+							if (slot == i && command.slotPoses[i] != poses[i]) {
+								command.slotPoses[i] = poses[i];
+								const entity_t owner{ ownerid, worldOwning->VersionForEntity(ownerid) };
+								if (worldOwning->HasComponent<AnimatorComponent>(owner)) {
+									// stored straight from the animator's SIMD matrices into the mapped buffer
+									worldOwning->GetComponent<AnimatorComponent>(owner).WriteSkinningMats(matbufMem.subspan(boneWriteOffset, subo.numBones));
+									slotbufMem[subo.slotReadOffset + subo.numObjects] = { .slot = i, .boneBegin = boneWriteOffset };
+									boneWriteOffset += subo.numBones;
+									subo.numObjects++;
+								}
+								else {
+									// the frame is already on the GPU
+									const auto& baked = worldOwning->GetComponent<BakedAnimatorComponent>(owner);
+									bakedObjects[baked.animation.get()].push_back({ .slot = i, .boneBegin = baked.animation->GetFrameOffset(baked.clip, baked.GetClipTime()) });
+								}
+							}
+						}
+						i++;
 					}
 				}
 
-				mainCommandBuffer->SetComputeBytes(subo, 0);
-				mainCommandBuffer->DispatchCompute(std::ceil(subo.numObjects / 8.0f), std::ceil(subo.numVertices / 32.0f), 1, 8, 32, 1);
-				subo.boneReadOffset += subo.numBones * subo.numObjects;
-				subo.vertexWriteOffset += subo.numVertices * subo.numObjects;	// one copy of the vertex data per object
+				auto dispatchSkinning = [&] {
+					if (subo.numObjects > 0) {
+						mainCommandBuffer->SetComputeBytes(subo, 0);
+						mainCommandBuffer->DispatchCompute(std::ceil(subo.numObjects / 8.0f), std::ceil(subo.numVertices / 32.0f), 1, 8, 32, 1);
+					}
+					subo.slotReadOffset += subo.numObjects;
+				};
+				mainCommandBuffer->BindComputeBuffer(mesh->GetWeightsBuffer(), 21);
+				dispatchSkinning();
+				for (const auto& [animation, objects] : bakedObjects) {
+					Debug::Assert(animation->GetSkeleton() == skeleton, "A BakedAnimation must use the same skeleton as the mesh it animates");
+					std::copy(objects.begin(), objects.end(), slotbufMem.begin() + subo.slotReadOffset);
+					subo.numObjects = uint32_t(objects.size());
+					mainCommandBuffer->BindComputeBuffer(animation->GetBuffer(), 20);
+					dispatchSkinning();
+				}
+				if (!bakedObjects.empty()) {
+					mainCommandBuffer->BindComputeBuffer(sharedSkeletonMatrixBuffer, 20);
+				}
 			}
 		}
 		mainCommandBuffer->EndCompute();
@@ -467,108 +1077,211 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 	};
 
-	auto tickParticles = [this, worldOwning, worldTransformBuffer]() {
-		mainCommandBuffer->BeginComputeDebugMarker("Particle Update");
+	// the simulation goes on the async compute queue, where it overlaps the main queue's compute work up to the first draw
+	auto tickParticles = [this, worldOwning, worldTransformBuffer, &screenTargets]() {
+		asyncComputeCommandBuffer->Reset();
+		asyncComputeCommandBuffer->Begin();
+		asyncComputeCommandBuffer->BeginComputeDebugMarker("Particle Update");
+
+		// return the pool space of destroyed emitters
+		std::pair<uint16_t, ParticlePool::Slot> releasedSlot;
+		while (gcParticleSlots.try_dequeue(releasedSlot)) {
+			particlePools.at(releasedSlot.first).Free(releasedSlot.second);
+		}
+
+		// group the emitters by update material. Pools may grow here, so nothing is recorded until every emitter has its slot.
+		particleBatches.clear();
+		const auto fpsScale = GetApp()->GetCurrentFPSScale();
+        worldOwning->Filter([this, &screenTargets, fpsScale](ParticleEmitter& emitter, const Transform& transform) {
+			// the render passes cull against these too, so they are kept current for frozen emitters
+			const auto& culling = emitter.culling;
+			const auto worldTransform = transform.GetWorldMatrix();
+			emitter.renderState.worldBoundsCenter = glm::vec3(worldTransform * vector4(culling.boundsCenter, 1));
+			emitter.renderState.worldBoundsRadius = culling.boundsRadius * std::max({ glm::length(vector3(worldTransform[0])), glm::length(vector3(worldTransform[1])), glm::length(vector3(worldTransform[2])) });
 
-        worldOwning->Filter([this, worldOwning, worldTransformBuffer](ParticleEmitter& emitter, const Transform& transform) {
 			// frozen particle systems are not ticked
 			if (emitter.GetFrozen()) {
 				return;
 			}
 
-			Ref<ParticleRenderMaterialInstance> renderMat;
-			auto updateMat = emitter.GetUpdateMaterial();
+			auto& pool = particlePools.try_emplace(emitter.particleSize, emitter.particleSize).first->second;
+			if (!emitter.poolSlot.IsValid()) {
+				emitter.poolSlot = pool.Allocate(device, mainCommandQueue, gcBuffers, emitter.GetMaxParticles(), emitter.GetOwner().GetID());
+			}
 
-			Ref<MeshParticleMeshSelectionMaterialInstance> meshSelFn = nullptr;
-			bool isMeshPipeline = false;
-			uint32_t numMeshes = 0;
-				
-			std::visit(CaseAnalysis{
-                    [&renderMat](const Ref <BillboardParticleRenderMaterialInstance> &billboardMat) {
-                        renderMat = billboardMat;
-                    },
-                    [&renderMat, &meshSelFn, &isMeshPipeline](const Ref <MeshParticleRenderMaterialInstance> &meshMat) {
-                        renderMat = meshMat;
-						meshSelFn = meshMat->customSelectionFunction;
-						isMeshPipeline = true;
-                    }
-            }, emitter.GetRenderMaterial());
+			if (emitter.resetRequested) {
+				EmitterStateNumericFields resetState{};
 
-			auto worldTransform = transform.GetWorldMatrix();
+				pool.emitterState->SetBufferData(resetState, emitter.poolSlot.state * ParticlePool::stateStride);	// this will leave the emitter ID value untouched
 
-			auto dispatchSizeUpdate = [this, &emitter, &isMeshPipeline,&renderMat, &numMeshes, &meshSelFn] {
+				emitter.ClearReset();
+			}
 
-				if (isMeshPipeline) {
-					// allocate indirect buffer
-					auto asMeshInstance = std::static_pointer_cast<MeshParticleRenderMaterialInstance>(renderMat);
-					auto meshCollection = asMeshInstance->meshes;
+			// visibility and distance LOD
+			bool visible = true;
+			uint32_t tickInterval = 1;
+			if (culling.boundsRadius > 0) {
+				const auto center = emitter.renderState.worldBoundsCenter;
+				const auto radius = emitter.renderState.worldBoundsRadius;
+				visible = false;
+				float nearest = std::numeric_limits<float>::max();
+				for (const auto& target : screenTargets) {
+					for (const auto& camData : target.camDatas) {
+						visible = visible || SphereIntersectsFrustum(camData.viewProj, center, radius);
+						nearest = std::min(nearest, std::max(glm::distance(center, camData.camPos) - radius, 0.f));
+					}
+				}
+				if (culling.lodDistance > 0) {
+					tickInterval = uint32_t(std::clamp(std::ceil(nearest / culling.lodDistance), 1.f, float(std::max<uint8_t>(culling.maxTickInterval, 1))));
+				}
+			}
 
-					auto nMeshes = meshCollection->GetNumLods();
-					numMeshes = nMeshes;
-					auto nCurrentCommands = emitter.indirectDrawBuffer->getBufferSize() / sizeof(RGL::IndirectIndexedCommand);
-					if (nCurrentCommands != nMeshes || emitter.indirectDrawBuffer == nullptr || emitter.indirectDrawBufferStaging == nullptr) {
-						gcBuffers.enqueue(emitter.indirectDrawBuffer);
-						gcBuffers.enqueue(emitter.indirectDrawBufferStaging);
-						emitter.indirectDrawBuffer = device->CreateBuffer({
-							nMeshes, {.StorageBuffer = true, .IndirectBuffer = true}, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Private, {.TransferDestination = true, .Writable = true, .debugName = "Particle indirect draw buffer"}
-							});
+			// Skipped frames are simulated by the next tick in one larger step. Emitters with the same interval tick on the same frames,
+			// so they have the same step and share batches.
+			emitter.untickedTime += fpsScale;
+			if ((!visible && !culling.simulateOffscreen) || frameCount % tickInterval != 0) {
+				return;
+			}
+			const auto timeScale = std::min(emitter.untickedTime, std::max(culling.maxCatchUpSeconds * App::evalNormal, fpsScale));
+			emitter.untickedTime = 0;
 
-						emitter.indirectDrawBufferStaging = device->CreateBuffer({ nMeshes, {.StorageBuffer = true}, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Shared, {.Transfersource = true, .debugName = "Particle indirect draw buffer staging"} });
-					}
-					emitter.indirectDrawBufferStaging->MapMemory();
-					auto ptr = static_cast<RGL::IndirectIndexedCommand*>(emitter.indirectDrawBufferStaging->GetMappedDataPtr());
-					for (uint32_t i = 0; i < nMeshes; i++) {
-						auto mesh = meshCollection->GetMeshForLOD(i);
-						auto allocation = mesh->GetAllocation();
-						*(ptr + i) = {
-							.indexCount = uint32_t(mesh->GetNumIndices()),
-							.instanceCount = 0,
-							.indexStart = allocation.getIndexRangeStart(),
-							.baseVertex = allocation.getVertexRangeStart(),
-							.baseInstance = i
-						};
-					}
+			// spawning particles?
+			auto spawnCount = emitter.GetNextParticleSpawnCount();
+			if (!emitter.IsEmitting()) {
+				spawnCount = 0;
+			}
+			else if (emitter.mode == ParticleEmitter::Mode::Stream) {
+				// distant emitters spawn at a fraction of their rate, and catching up spawns at most maxCatchUpSeconds of particles
+				spawnCount = std::min<uint32_t>(spawnCount / tickInterval, std::ceil(culling.maxCatchUpSeconds * emitter.spawnRate));
+			}
 
-					emitter.indirectDrawBufferStaging->UnmapMemory();
-					mainCommandBuffer->CopyBufferToBuffer(
-						{
-							.buffer = emitter.indirectDrawBufferStaging,
-							.offset = 0,
-						},
-						{
-							.buffer = emitter.indirectDrawBuffer,
-							.offset = 0,
-						},
-						emitter.indirectDrawBufferStaging->getBufferSize());
-				}
+			// burst mode
+			if (emitter.mode == ParticleEmitter::Mode::Burst && emitter.IsEmitting()) {
+				emitter.Stop();
+			}
 
-				// setup dispatch sizes
-				// we always need to run this because the Update shader may kill particles, changing the number of active particles
-				if (isMeshPipeline) {
-					mainCommandBuffer->BeginCompute(particleDispatchSetupPipelineIndexed);
-				}
-				else{ 
-					mainCommandBuffer->BeginCompute(particleDispatchSetupPipeline);
-				}
-				mainCommandBuffer->BindComputeBuffer(emitter.emitterStateBuffer, 0);
-				mainCommandBuffer->BindComputeBuffer(emitter.indirectComputeBuffer, 1);
-				if (isMeshPipeline) {
-					mainCommandBuffer->DispatchCompute(1, 1, 1, 1, 1, 1);
+			const auto& updateMat = emitter.GetUpdateMaterial()->mat;
+			auto batch = std::find_if(particleBatches.begin(), particleBatches.end(), [&](const ParticleBatch& batch) {
+				return batch.material == updateMat && batch.particleSize == emitter.particleSize && batch.timeScale == timeScale;
+			});
+			if (batch == particleBatches.end()) {
+				batch = particleBatches.insert(particleBatches.end(), ParticleBatch{ .material = updateMat, .particleSize = emitter.particleSize, .timeScale = timeScale });
+			}
+
+			batch->emitters.push_back({
+				.stateSlot = emitter.poolSlot.state,
+				.particleBase = emitter.poolSlot.GetParticleBase(),
+				.maxParticles = emitter.GetMaxParticles(),
+				.particlesToSpawn = spawnCount,
+			});
+			batch->maxSpawn = std::max(batch->maxSpawn, spawnCount);
+
+			if (std::holds_alternative<Ref<MeshParticleRenderMaterialInstance>>(emitter.GetRenderMaterial())) {
+				batch->meshEmitters.push_back(&emitter);
+			}
+		});
+
+		if (particleBatches.size() > particleDispatchBufferBatches) {
+			gcBuffers.enqueue(particleDispatchBuffer);
+			particleDispatchBufferBatches = std::max<uint32_t>(particleBatches.size(), particleDispatchBufferBatches * 2);
+			particleDispatchBuffer = device->CreateBuffer({
+				particleDispatchBufferBatches * 3, {.StorageBuffer = true, .IndirectBuffer = true}, sizeof(RGL::ComputeIndirectCommand), RGL::BufferAccess::Private, {.Writable = true, .debugName = "Particle indirect dispatch buffer"}
+			});
+		}
+
+		for (uint32_t batchIdx = 0; batchIdx < particleBatches.size(); batchIdx++) {
+			const auto& batch = particleBatches[batchIdx];
+			auto& pool = particlePools.at(batch.particleSize);
+			const auto numEmitters = uint32_t(batch.emitters.size());
+			const auto emitterTable = WriteTransient({ batch.emitters.data(), batch.emitters.size() * sizeof(ParticleEmitterDispatch) });
+
+			// init, update, kill
+			const uint32_t firstCommand = batchIdx * 3;
+			auto commandOffset = [firstCommand](uint32_t command) {
+				return uint32_t((firstCommand + command) * sizeof(RGL::ComputeIndirectCommand));
+			};
+
+			// x is the particle, y is the emitter
+			if (batch.maxSpawn > 0) {
+				asyncComputeCommandBuffer->BeginComputeDebugMarker("Create");
+				asyncComputeCommandBuffer->BeginCompute(particleCreatePipeline);
+
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.activeParticleIndices, 0);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.particleFreelist, 1);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.emitterState, 2);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.spawnedThisFrame, 3);
+				asyncComputeCommandBuffer->BindComputeBuffer(emitterTable.buffer, 4, emitterTable.offset);
+
+				asyncComputeCommandBuffer->DispatchCompute(std::ceil(batch.maxSpawn / 64.0f), numEmitters, 1, 64, 1, 1);
+				asyncComputeCommandBuffer->EndCompute();
+				asyncComputeCommandBuffer->EndComputeDebugMarker();
+			}
+
+			// setup dispatch sizes
+			// we always need to run this because the Update shader may kill particles, changing the number of active particles
+			ParticleDispatchSetupUBO setupUBO{
+				.numEmitters = numEmitters,
+				.firstCommand = firstCommand,
+			};
+			asyncComputeCommandBuffer->BeginCompute(particleDispatchSetupPipeline);
+			asyncComputeCommandBuffer->SetComputeBytes(setupUBO, 0);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.emitterState, 0);
+			asyncComputeCommandBuffer->BindComputeBuffer(particleDispatchBuffer, 1);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.drawCommands, 2);
+			asyncComputeCommandBuffer->BindComputeBuffer(emitterTable.buffer, 3, emitterTable.offset);
+			asyncComputeCommandBuffer->DispatchCompute(1, 1, 1, 64, 1, 1);
+			asyncComputeCommandBuffer->EndCompute();
+
+			for (auto emitterPtr : batch.meshEmitters) {
+				auto& emitter = *emitterPtr;
+				auto asMeshInstance = std::get<Ref<MeshParticleRenderMaterialInstance>>(emitter.GetRenderMaterial());
+				auto meshCollection = asMeshInstance->meshes;
+				const auto numMeshes = meshCollection->GetNumLods();
+
+				// allocate indirect buffer
+				if (emitter.indirectDrawBuffer == nullptr || emitter.indirectDrawBufferStaging == nullptr || emitter.indirectDrawBuffer->getBufferSize() / sizeof(RGL::IndirectIndexedCommand) != numMeshes) {
+					gcBuffers.enqueue(emitter.indirectDrawBuffer);
+					gcBuffers.enqueue(emitter.indirectDrawBufferStaging);
+					emitter.indirectDrawBuffer = device->CreateBuffer({
+						numMeshes, {.StorageBuffer = true, .IndirectBuffer = true}, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Private, {.TransferDestination = true, .Writable = true, .debugName = "Particle indirect draw buffer"}
+						});
+
+					emitter.indirectDrawBufferStaging = device->CreateBuffer({ numMeshes, {.StorageBuffer = true}, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Shared, {.Transfersource = true, .debugName = "Particle indirect draw buffer staging"} });
 				}
-				else {
-					mainCommandBuffer->BindComputeBuffer(emitter.indirectDrawBuffer, 2);
-					mainCommandBuffer->DispatchCompute(1, 1, 1, 1, 1, 1);	// this is kinda terrible...
+				emitter.indirectDrawBufferStaging->MapMemory();
+				auto ptr = static_cast<RGL::IndirectIndexedCommand*>(emitter.indirectDrawBufferStaging->GetMappedDataPtr());
+				for (uint32_t i = 0; i < numMeshes; i++) {
+					auto mesh = meshCollection->GetMeshForLOD(i);
+					auto allocation = mesh->GetAllocation();
+					*(ptr + i) = {
+						.indexCount = uint32_t(mesh->GetNumIndices()),
+						.instanceCount = 0,
+						.indexStart = allocation.getIndexRangeStart(),
+						.baseVertex = allocation.getVertexRangeStart(),
+						.baseInstance = i
+					};
 				}
-				mainCommandBuffer->EndCompute();
+
+				emitter.indirectDrawBufferStaging->UnmapMemory();
+				asyncComputeCommandBuffer->CopyBufferToBuffer(
+					{
+						.buffer = emitter.indirectDrawBufferStaging,
+						.offset = 0,
+					},
+					{
+						.buffer = emitter.indirectDrawBuffer,
+						.offset = 0,
+					},
+					emitter.indirectDrawBufferStaging->getBufferSize());
 
 				// if there's no mesh selector function, or we have 1 mesh total,
 				// sidestep the selector function and populate the count directly
-				if (isMeshPipeline && (meshSelFn == nullptr || numMeshes == 1)) {
+				if (asMeshInstance->customSelectionFunction == nullptr || numMeshes == 1) {
 					// put the particle count into the indirect draw buffer
-					mainCommandBuffer->CopyBufferToBuffer(
+					asyncComputeCommandBuffer->CopyBufferToBuffer(
 						{
-							.buffer = emitter.emitterStateBuffer,
-							.offset = offsetof(EmitterState,fields) + offsetof(EmitterStateNumericFields,aliveParticleCount)
+							.buffer = pool.emitterState,
+							.offset = emitter.poolSlot.state * ParticlePool::stateStride + offsetof(EmitterState,fields) + offsetof(EmitterStateNumericFields,aliveParticleCount)
 						},
 						{
 							.buffer = emitter.indirectDrawBuffer,
@@ -577,116 +1290,79 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 						sizeof(EmitterStateNumericFields::aliveParticleCount)
 					);
 				}
-			};
-
-			bool hasCalculatedSizes = false;
-
-			if (emitter.resetRequested) {
-					
-				EmitterStateNumericFields resetState{};
-
-				emitter.emitterStateBuffer->SetBufferData(resetState);	// this will leave the emitter ID value untouched
-
-				emitter.ClearReset();
 			}
 
-			// spawning particles?
-			auto spawnCount = emitter.GetNextParticleSpawnCount();
-			if (spawnCount > 0 && emitter.IsEmitting()) {
-				ParticleCreationPushConstants constants{
-					.particlesToSpawn = spawnCount,
-					.maxParticles = emitter.GetMaxParticles(),
-				};
-				mainCommandBuffer->BeginComputeDebugMarker("Create and Init");
-				mainCommandBuffer->BeginCompute(particleCreatePipeline);
-				mainCommandBuffer->SetComputeBytes(constants, 0);
-
-				mainCommandBuffer->BindComputeBuffer(emitter.activeParticleIndexBuffer, 0);
-				mainCommandBuffer->BindComputeBuffer(emitter.particleReuseFreelist, 1);
-				mainCommandBuffer->BindComputeBuffer(emitter.emitterStateBuffer, 2);
-				mainCommandBuffer->BindComputeBuffer(emitter.spawnedThisFrameList, 3);
-
-				mainCommandBuffer->DispatchCompute(std::ceil(spawnCount / 64.0f), 1, 1, 64, 1, 1);
-				mainCommandBuffer->EndCompute();
-
-				dispatchSizeUpdate();
-				hasCalculatedSizes = true;
-
-				// init particles
-				mainCommandBuffer->BeginCompute(updateMat->mat->userInitPipeline);
-
-				mainCommandBuffer->BindComputeBuffer(emitter.emitterStateBuffer,0);
-				mainCommandBuffer->BindComputeBuffer(emitter.spawnedThisFrameList, 1);
-				mainCommandBuffer->BindComputeBuffer(emitter.particleDataBuffer, 2);
-				mainCommandBuffer->BindComputeBuffer(emitter.particleLifeBuffer, 3);
-				mainCommandBuffer->BindComputeBuffer(worldTransformBuffer, 4);
-
-				mainCommandBuffer->DispatchIndirect({
-					.indirectBuffer = emitter.indirectComputeBuffer,
-					.offsetIntoBuffer = 0,
+			// init particles
+			if (batch.maxSpawn > 0) {
+				asyncComputeCommandBuffer->BeginComputeDebugMarker("Init");
+				asyncComputeCommandBuffer->BeginCompute(batch.material->userInitPipeline);
+
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.emitterState, 0);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.spawnedThisFrame, 1);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.particleData, 2);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.particleLife, 3);
+				asyncComputeCommandBuffer->BindComputeBuffer(worldTransformBuffer, 4);
+				asyncComputeCommandBuffer->BindComputeBuffer(emitterTable.buffer, 5, emitterTable.offset);
+
+				asyncComputeCommandBuffer->DispatchIndirect({
+					.indirectBuffer = particleDispatchBuffer,
+					.offsetIntoBuffer = commandOffset(0),
                     .blocksizeX = 64, .blocksizeY = 1, .blocksizeZ = 1
 				});
 
-				mainCommandBuffer->EndCompute();
-				mainCommandBuffer->EndComputeDebugMarker();
-			}
-
-			// burst mode
-			if (emitter.mode == ParticleEmitter::Mode::Burst && emitter.IsEmitting()) {
-				emitter.Stop();
-			}
-
-			if (!hasCalculatedSizes) {
-				dispatchSizeUpdate();
+				asyncComputeCommandBuffer->EndCompute();
+				asyncComputeCommandBuffer->EndComputeDebugMarker();
 			}
 
 			// tick particles
-			mainCommandBuffer->BeginComputeDebugMarker("Update, Kill");
-			mainCommandBuffer->BeginCompute(updateMat->mat->userUpdatePipeline);
+			asyncComputeCommandBuffer->BeginComputeDebugMarker("Update, Kill");
+			asyncComputeCommandBuffer->BeginCompute(batch.material->userUpdatePipeline);
 
-			mainCommandBuffer->BindComputeBuffer(emitter.emitterStateBuffer, 0);
-			mainCommandBuffer->BindComputeBuffer(emitter.activeParticleIndexBuffer, 1);
-			mainCommandBuffer->BindComputeBuffer(emitter.particleDataBuffer, 2);
-			mainCommandBuffer->BindComputeBuffer(emitter.particleLifeBuffer, 3);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.emitterState, 0);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.activeParticleIndices, 1);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.particleData, 2);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.particleLife, 3);
+			asyncComputeCommandBuffer->BindComputeBuffer(emitterTable.buffer, 4, emitterTable.offset);
 
 			ParticleUpdateUBO ubo{
-				.fpsScale = GetApp()->GetCurrentFPSScale()
+				.fpsScale = batch.timeScale
 			};
 
-			mainCommandBuffer->SetComputeBytes(ubo, 0);
-			mainCommandBuffer->DispatchIndirect({
-				.indirectBuffer = emitter.indirectComputeBuffer,
-				.offsetIntoBuffer = sizeof(RGL::ComputeIndirectCommand),
+			asyncComputeCommandBuffer->SetComputeBytes(ubo, 0);
+			asyncComputeCommandBuffer->DispatchIndirect({
+				.indirectBuffer = particleDispatchBuffer,
+				.offsetIntoBuffer = commandOffset(1),
                 .blocksizeX = 64, .blocksizeY = 1, .blocksizeZ = 1
 			});
 
-			mainCommandBuffer->EndCompute();
+			asyncComputeCommandBuffer->EndCompute();
 
 			// kill particles
-			mainCommandBuffer->BeginCompute(particleKillPipeline);
+			asyncComputeCommandBuffer->BeginCompute(particleKillPipeline);
 
-			KillParticleUBO kubo{
-				.maxTotalParticles = emitter.GetMaxParticles()
-			};
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.emitterState, 0);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.activeParticleIndices, 1);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.particleFreelist, 2);
+			asyncComputeCommandBuffer->BindComputeBuffer(pool.particleLife, 3);
+			asyncComputeCommandBuffer->BindComputeBuffer(emitterTable.buffer, 4, emitterTable.offset);
 
-			mainCommandBuffer->SetComputeBytes(kubo,0);
-
-			mainCommandBuffer->BindComputeBuffer(emitter.emitterStateBuffer, 0);
-			mainCommandBuffer->BindComputeBuffer(emitter.activeParticleIndexBuffer, 1);
-			mainCommandBuffer->BindComputeBuffer(emitter.particleReuseFreelist, 2);
-			mainCommandBuffer->BindComputeBuffer(emitter.particleLifeBuffer, 3);
-
-			mainCommandBuffer->DispatchIndirect({
-				.indirectBuffer = emitter.indirectComputeBuffer,
-				.offsetIntoBuffer = sizeof(RGL::ComputeIndirectCommand),	// uses the same indirect command as the update shader, because it works on the alive set
+			asyncComputeCommandBuffer->DispatchIndirect({
+				.indirectBuffer = particleDispatchBuffer,
+				.offsetIntoBuffer = commandOffset(2),	// sized like the update command, but never empty so createdThisFrame is always reset
                 .blocksizeX = 64, .blocksizeY = 1, .blocksizeZ = 1
 			});
 
-			mainCommandBuffer->EndCompute();
-			mainCommandBuffer->EndComputeDebugMarker();
+			asyncComputeCommandBuffer->EndCompute();
+			asyncComputeCommandBuffer->EndComputeDebugMarker();
 
-			if (isMeshPipeline && meshSelFn) {
-				//custom mesh selection 
+			// mesh selection is per emitter, each writes its own draw commands
+			for (auto emitterPtr : batch.meshEmitters) {
+				auto& emitter = *emitterPtr;
+				auto meshSelFn = std::get<Ref<MeshParticleRenderMaterialInstance>>(emitter.GetRenderMaterial())->customSelectionFunction;
+				if (!meshSelFn) {
+					continue;
+				}
+				const auto numMeshes = uint32_t(emitter.indirectDrawBuffer->getBufferSize() / sizeof(RGL::IndirectIndexedCommand));
 
 				// if the buffer doesn't exist yet, create it
 				if (emitter.meshAliveParticleIndexBuffer == nullptr) {
@@ -703,33 +1379,31 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					.maxTotalParticles = emitter.GetMaxParticles()
 				};
 
-				auto transientOffset = WriteTransient(engineData);
-				emitter.renderState.maxTotalParticlesOffset = transientOffset;
+				auto transientAllocation = WriteTransient(engineData);
+				emitter.renderState.maxTotalParticlesBuffer = transientAllocation.buffer;
+				emitter.renderState.maxTotalParticlesOffset = transientAllocation.offset;
 
 				// setup rendering
 				auto selMat = meshSelFn->material;
-				mainCommandBuffer->BeginComputeDebugMarker("Select meshes");
-				mainCommandBuffer->BeginCompute(selMat->userSelectionPipeline);
-
-				mainCommandBuffer->BindComputeBuffer(emitter.meshAliveParticleIndexBuffer, 10);
-				mainCommandBuffer->BindComputeBuffer(emitter.indirectDrawBuffer, 11);
-				mainCommandBuffer->BindComputeBuffer(transientBuffer, 12, transientOffset);
-				mainCommandBuffer->BindComputeBuffer(emitter.emitterStateBuffer, 13);
-				mainCommandBuffer->BindComputeBuffer(emitter.activeParticleIndexBuffer, 14);
-				mainCommandBuffer->BindComputeBuffer(emitter.particleDataBuffer, 15);
-
-				mainCommandBuffer->DispatchIndirect({
-					.indirectBuffer = emitter.indirectComputeBuffer,
-					.offsetIntoBuffer = sizeof(RGL::ComputeIndirectCommand),
-					.blocksizeX = 64, .blocksizeY = 1, .blocksizeZ = 1
-				});
-				mainCommandBuffer->EndCompute();
+				const auto particleBase = emitter.poolSlot.GetParticleBase();
+				asyncComputeCommandBuffer->BeginComputeDebugMarker("Select meshes");
+				asyncComputeCommandBuffer->BeginCompute(selMat->userSelectionPipeline);
 
-				mainCommandBuffer->EndComputeDebugMarker();
+				asyncComputeCommandBuffer->BindComputeBuffer(emitter.meshAliveParticleIndexBuffer, 10);
+				asyncComputeCommandBuffer->BindComputeBuffer(emitter.indirectDrawBuffer, 11);
+				asyncComputeCommandBuffer->BindComputeBuffer(transientAllocation.buffer, 12, transientAllocation.offset);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.emitterState, 13, emitter.poolSlot.state * ParticlePool::stateStride);
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.activeParticleIndices, 14, particleBase * sizeof(uint32_t));
+				asyncComputeCommandBuffer->BindComputeBuffer(pool.particleData, 15, particleBase * batch.particleSize);
+
+				asyncComputeCommandBuffer->DispatchCompute(std::ceil(emitter.GetMaxParticles() / 64.0f), 1, 1, 64, 1, 1);
+				asyncComputeCommandBuffer->EndCompute();
+
+				asyncComputeCommandBuffer->EndComputeDebugMarker();
 			}
-				
-		});
-		mainCommandBuffer->EndComputeDebugMarker();
+		}
+		asyncComputeCommandBuffer->EndComputeDebugMarker();
+		asyncComputeCommandBuffer->End();
 	};
 
 	tickParticles();
@@ -743,9 +1417,41 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 		prepareSkeletalCullingBuffer();
 	}
 
-    auto renderFromPerspective = [this, &worldTransformBuffer, &worldOwning, &skeletalPrepareResult, &camIdx]<bool includeLighting = true, bool transparentMode = false, bool runCulling = true>(const matrix4& viewproj, const matrix4& viewonly, const matrix4& projOnly, vector3 camPos, glm::vec2 zNearFar, RGLRenderPassPtr renderPass, auto&& pipelineSelectorFunction, RGL::Rect viewportScissor, LightingType lightingFilter, const DepthPyramid& pyramid, const renderlayer_t layers, const RenderTargetCollection* target){
+	// the inputs for one phase of two-phase occlusion culling
+	struct TwoPhaseCullState {
+		CullPhase phase = CullPhase::Single;
+		TransientAllocation prevViewProj;
+		RGLBufferPtr visibilityBuffer;
+	};
+
+	// Several views culled by one dispatch. The pass that runs culling tests every view, and each pass (with or
+	// without culling) then draws its own view's slice of the indirect and culling buffers. Views are not occlusion culled.
+	struct MultiViewCull {
+		std::span<const CullingView> views;
+		uint32_t viewIndex = 0;		// the view the current pass draws
+	};
+
+    auto renderFromPerspective = [this, &worldTransformBuffer, &worldOwning, &skeletalPrepareResult, &camIdx]<bool includeLighting = true, bool transparentMode = false, bool runCulling = true>(const matrix4& viewproj, const matrix4& viewonly, const matrix4& projOnly, vector3 camPos, glm::vec2 zNearFar, RGLRenderPassPtr renderPass, auto&& pipelineSelectorFunction, RGL::Rect viewportScissor, LightingType lightingFilter, const DepthPyramid& pyramid, const renderlayer_t layers, const RenderTargetCollection* target, const TwoPhaseCullState* twoPhaseCull = nullptr, const MultiViewCull* multiView = nullptr){
 			RVE_PROFILE_FN_N("RenderFromPerspective");
-            uint32_t particleBillboardMatrices = 0;
+			Debug::Assert(!multiView || (multiView->views.size() <= maxCullViews && multiView->viewIndex < multiView->views.size() && !twoPhaseCull), "Invalid multi-view cull");
+			const uint32_t numViews = multiView ? uint32_t(multiView->views.size()) : 1;
+			const uint32_t viewIndex = multiView ? multiView->viewIndex : 0;
+			// the views a multi-view cull reads, bound in place of the push constant view
+			TransientAllocation cullViews;
+			if (runCulling && multiView) {
+				cullViews = WriteTransient({ multiView->views.data(), multiView->views.size_bytes() });
+			}
+			auto bindCullViews = [this, &cullViews]() {
+				if (cullViews.buffer) {
+					mainCommandBuffer->BindComputeBuffer(cullViews.buffer, DefaultCullBindings::views, cullViews.offset);
+				}
+				else {
+					mainCommandBuffer->BindComputeBuffer(dummyCullHistoryBuffer, DefaultCullBindings::views);
+				}
+			};
+			// the second phase only adds static meshes to what the first phase encoded
+			const bool isSecondCullPhase = twoPhaseCull != nullptr && twoPhaseCull->phase == CullPhase::Remaining;
+            TransientAllocation particleBillboardMatrices;
 
             struct QuadParticleData {
                 glm::mat4 viewProj;
@@ -762,51 +1468,133 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
             particleBillboardMatrices = WriteTransient(quadData);
 
 			if constexpr (includeLighting) {
-				// dispatch the lighting binning shaders
-				RVE_PROFILE_SECTION(lightBinning,"Light binning");
-				mainCommandBuffer->BeginComputeDebugMarker("Light Binning");
-				const auto nPointLights = worldOwning->renderData.pointLightData.DenseSize();
-				const auto nSpotLights = worldOwning->renderData.spotLightData.DenseSize();
-				if (nPointLights > 0 || nSpotLights > 0) {
-					{
-						GridBuildUBO ubo{
+				if (!isSecondCullPhase) {
+					// dispatch the lighting binning shaders
+					RVE_PROFILE_SECTION(lightBinning,"Light binning");
+					mainCommandBuffer->BeginComputeDebugMarker("Light Binning");
+					const auto nPointLights = worldOwning->renderData.pointLightData.DenseSize();
+					const auto nSpotLights = worldOwning->renderData.spotLightData.DenseSize();
+					if (nPointLights > 0 || nSpotLights > 0) {
+						GridBuildUBO gridKey{
 							.invProj = glm::inverse(projOnly),
 							.gridSize = {Clustered::gridSizeX, Clustered::gridSizeY, Clustered::gridSizeZ},
 							.zNear = zNearFar.x,
 							.screenDim = {viewportScissor.extent[0],viewportScissor.extent[1]},
 							.zFar = zNearFar.y
 						};
+						auto grid = std::find_if(clusterGridCache.begin(), clusterGridCache.end(), [&gridKey](const ClusterGridCacheEntry& entry) {
+							return std::memcmp(&entry.key, &gridKey, sizeof(gridKey)) == 0;
+						});
+						if (grid == clusterGridCache.end()) {
+							// the projection or the view size changed, so the cluster bounds have to be rebuilt
+							clusterGridCache.push_back({
+								.key = gridKey,
+								.bounds = device->CreateBuffer({
+									Clustered::numClusters,
+									{.StorageBuffer = true},
+									sizeof(Clustered::ClusterBounds),
+									RGL::BufferAccess::Private,
+									{.Writable = true, .debugName = "Cluster bounds buffer"}
+								})
+							});
+							grid = clusterGridCache.end() - 1;
 
-						mainCommandBuffer->BeginCompute(clusterBuildGridPipeline);
-						mainCommandBuffer->BindComputeBuffer(lightClusterBuffer, 0);
-						mainCommandBuffer->SetComputeBytes(ubo, 0);
-
-						mainCommandBuffer->DispatchCompute(Clustered::gridSizeX, Clustered::gridSizeY, Clustered::gridSizeZ, 1, 1, 1);
-						mainCommandBuffer->EndCompute();
-					}
-
-					// next assign lights to clusters
-					{
-						GridAssignUBO ubo{
-							.viewMat = viewonly,
-							.pointLightCount = nPointLights,
-							.spotLightCount = nSpotLights
-						};
-						mainCommandBuffer->BeginCompute(clusterPopulatePipeline);
-						mainCommandBuffer->SetComputeBytes(ubo, 0);
-						mainCommandBuffer->BindComputeBuffer(lightClusterBuffer, 0);
-						mainCommandBuffer->BindComputeBuffer(worldOwning->renderData.pointLightData.GetPrivateBuffer(), 1);
-						mainCommandBuffer->BindComputeBuffer(worldOwning->renderData.spotLightData.GetPrivateBuffer(), 2);
+							mainCommandBuffer->BeginCompute(clusterBuildGridPipeline);
+							mainCommandBuffer->BindComputeBuffer(grid->bounds, 0);
+							mainCommandBuffer->SetComputeBytes(gridKey, 0);
 
-						constexpr static auto threadGroupSize = 128;
+							mainCommandBuffer->DispatchCompute(Clustered::gridSizeX, Clustered::gridSizeY, Clustered::gridSizeZ, 1, 1, 1);
+							mainCommandBuffer->EndCompute();
+						}
+						grid->lastUsedFrame = frameCount;
 
-						mainCommandBuffer->DispatchCompute(Clustered::numClusters / threadGroupSize, 1, 1, threadGroupSize, 1, 1);
+						// cull the lights to the view, so assignment loops over the visible lights instead of all of them
+						{
+							const auto nLights = nPointLights + nSpotLights;
+							if (nLights > clusterVisibleLightCapacity) {
+								if (clusterVisibleLightBuffer) {
+									gcBuffers.enqueue(clusterVisibleLightBuffer);
+								}
+								clusterVisibleLightCapacity = std::bit_ceil(nLights);
+								clusterVisibleLightBuffer = device->CreateBuffer({
+									clusterVisibleLightCapacity + 2,	// after the two counts
+									{.StorageBuffer = true},
+									sizeof(uint32_t),
+									RGL::BufferAccess::Private,
+									{.TransferDestination = true, .Writable = true, .debugName = "Cluster visible light buffer"}
+								});
+							}
+							mainCommandBuffer->CopyBufferToBuffer(
+								{
+									.buffer = clusterLightCounterResetBuffer,
+									.offset = 0
+								},
+								{
+									.buffer = clusterVisibleLightBuffer,
+									.offset = 0
+								}, 2 * sizeof(uint32_t)
+							);
+
+							LightCullUBO cullUBO{
+								.pointLightCount = nPointLights,
+								.spotLightCount = nSpotLights
+							};
+							const auto planes = FrustumPlanes(glm::mat4(viewproj));
+							for (uint8_t i = 0; i < planes.size(); i++) {
+								cullUBO.planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+							}
+							constexpr static auto threadGroupSize = 64;
+							mainCommandBuffer->BeginCompute(clusterCullLightsPipeline);
+							mainCommandBuffer->SetComputeBytes(cullUBO, 0);
+							mainCommandBuffer->BindComputeBuffer(worldOwning->renderData.pointLightData.GetPrivateBuffer(), 0);
+							mainCommandBuffer->BindComputeBuffer(worldOwning->renderData.spotLightData.GetPrivateBuffer(), 1);
+							mainCommandBuffer->BindComputeBuffer(clusterVisibleLightBuffer, 2);
+							mainCommandBuffer->DispatchCompute((nLights + threadGroupSize - 1) / threadGroupSize, 1, 1, threadGroupSize, 1, 1);
+							mainCommandBuffer->EndCompute();
+						}
 
-						mainCommandBuffer->EndCompute();
+						// next assign lights to clusters, packing their indices into the shared list
+						{
+							mainCommandBuffer->CopyBufferToBuffer(
+								{
+									.buffer = clusterLightCounterResetBuffer,
+									.offset = 0
+								},
+								{
+									.buffer = clusterLightCounterBuffer,
+									.offset = 0
+								}, sizeof(uint32_t)
+							);
+
+							// transparent surfaces can be in front of the opaque depth, so they are binned against the whole grid
+							GridAssignUBO ubo{
+								.viewMat = viewonly,
+								.pointLightCount = nPointLights,
+								.spotLightCount = nSpotLights,
+								.lightIndexCapacity = clusterLightIndexCapacity,
+								.tilesPerSlice = (clusterTileDepthValid && !transparentMode) ? Clustered::gridSizeX * Clustered::gridSizeY : 0
+							};
+							mainCommandBuffer->BeginCompute(clusterPopulatePipeline);
+							mainCommandBuffer->SetComputeBytes(ubo, 0);
+							mainCommandBuffer->BindComputeBuffer(grid->bounds, 0);
+							mainCommandBuffer->BindComputeBuffer(worldOwning->renderData.pointLightData.GetPrivateBuffer(), 1);
+							mainCommandBuffer->BindComputeBuffer(worldOwning->renderData.spotLightData.GetPrivateBuffer(), 2);
+							mainCommandBuffer->BindComputeBuffer(lightClusterBuffer, 3);
+							mainCommandBuffer->BindComputeBuffer(clusterLightIndexBuffer, 4);
+							mainCommandBuffer->BindComputeBuffer(clusterLightCounterBuffer, 5);
+							mainCommandBuffer->BindComputeBuffer(clusterTileDepthBuffer, 6);
+							mainCommandBuffer->BindComputeBuffer(clusterVisibleLightBuffer, 7);
+
+							constexpr static auto threadGroupSize = 128;
+
+							mainCommandBuffer->DispatchCompute(Clustered::numClusters / threadGroupSize, 1, 1, threadGroupSize, 1, 1);
+
+							mainCommandBuffer->EndCompute();
+						}
 					}
+					RVE_PROFILE_SECTION_END(lightBinning);
+					mainCommandBuffer->EndComputeDebugMarker();
 				}
-				RVE_PROFILE_SECTION_END(lightBinning);
-				mainCommandBuffer->EndComputeDebugMarker();
 			}
 
 #pragma pack(push, 1)
@@ -890,11 +1678,49 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				return shouldKeep;
 				};
 
+			// after culling, pack each view's surviving commands to the front of compactedIndirectBuffer, and write how many
+			// there are to drawCountBuffer, so the draw does not submit the commands that were culled to zero instances
+			auto compactDrawCommands = [this, &reallocBuffer, lightingFilter, numViews](auto&& renderData) {
+				if (!supportsIndirectCount) {
+					return;
+				}
+				RVE_PROFILE_FN_N("Compact Draw Commands");
+				FrameVector<CompactDrawRange> ranges;
+				for (auto& [materialInstance, drawcommand] : renderData) {
+					if (!filterRenderData(lightingFilter, materialInstance) || drawcommand.numDrawSlots == 0) {
+						continue;
+					}
+					reallocBuffer(drawcommand.compactedIndirectBuffer, drawcommand.numDrawSlots * numViews, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Private, { .StorageBuffer = true, .IndirectBuffer = true }, { .Writable = true, .debugName = "Compacted Indirect Buffer" });
+					reallocBuffer(drawcommand.drawCountBuffer, maxCullViews, sizeof(uint32_t), RGL::BufferAccess::Private, { .StorageBuffer = true, .IndirectBuffer = true }, { .Writable = true, .debugName = "Draw Count Buffer" });
+					for (uint32_t view = 0; view < numViews; view++) {
+						ranges.push_back({
+							.indirectBufferBindlessHandle = drawcommand.indirectBuffer->GetReadwriteBindlessGPUHandle(),
+							.compactedBufferBindlessHandle = drawcommand.compactedIndirectBuffer->GetReadwriteBindlessGPUHandle(),
+							.countBufferBindlessHandle = drawcommand.drawCountBuffer->GetReadwriteBindlessGPUHandle(),
+							.sliceStart = view * drawcommand.numDrawSlots,
+							.numDrawSlots = drawcommand.numDrawSlots,
+							.view = view,
+						});
+					}
+				}
+				if (ranges.empty()) {
+					return;
+				}
+				auto rangeData = WriteTransient({ ranges.data(), ranges.size() * sizeof(CompactDrawRange) });
+				CompactDrawsUBO ubo{
+					.numRanges = uint32_t(ranges.size())
+				};
+				mainCommandBuffer->BeginCompute(compactDrawsPipeline);
+				mainCommandBuffer->BindComputeBuffer(rangeData.buffer, 0, rangeData.offset);
+				mainCommandBuffer->BindBindlessBufferDescriptorSet(1);
+				mainCommandBuffer->SetComputeBytes(ubo, 0);
+				mainCommandBuffer->DispatchCompute(ubo.numRanges, 1, 1, 64, 1, 1);
+				mainCommandBuffer->EndCompute();
+			};
 
-            auto cullSkeletalMeshes = [this, &worldTransformBuffer, &worldOwning, &reallocBuffer, layers, lightingFilter, &camPos](matrix4 viewproj, const DepthPyramid pyramid) {
+            auto cullSkeletalMeshes = [this, &worldTransformBuffer, &worldOwning, &reallocBuffer, layers, lightingFilter, &camPos, numViews, &bindCullViews, &compactDrawCommands](matrix4 viewproj, const DepthPyramid pyramid) {
 				RVE_PROFILE_FN_N("Cull Skeletal Meshes");
 				// first reset the indirect buffers
-				uint32_t skeletalVertexOffset = 0;
 				for (auto& [materialInstance, drawcommand] : worldOwning->renderData.skinnedMeshRenderData) {
 
 					bool shouldKeep = filterRenderData(lightingFilter, materialInstance);
@@ -912,40 +1738,42 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 					reallocBuffer(drawcommand.indirectStagingBuffer, total_entities, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Shared, { .StorageBuffer = true }, { .Transfersource = true, .Writable = false,.debugName = "Indirect Staging Buffer" });
 
+					// one draw per instance, in the same order as the culling shader's output
+					uint32_t commandBase = 0;
 					for (const auto& command : drawcommand.commands) {
-						uint32_t meshID = 0;
-
 						const auto nEntitiesInThisCommand = command.entities.DenseSize();
 						RGL::IndirectIndexedCommand initData;
 						if (auto mesh = command.mesh.lock()) {
 							Debug::Assert(mesh->GetNumLods() == 1, "Skeletal meshes cannot have more than 1 LOD currently");
 							for (uint32_t i = 0; i < nEntitiesInThisCommand; i++) {
-								for (uint32_t lodID = 0; lodID < mesh->GetNumLods(); lodID++) {
-									initData = {
-										.indexCount = uint32_t(mesh->GetNumIndices()),
-										.instanceCount = 0,
-										.indexStart = mesh->GetAllocation().getIndexRangeStart(),
-										.baseVertex = skeletalVertexOffset,
-										.baseInstance = i
-									};
-									drawcommand.indirectStagingBuffer->UpdateBufferData(initData, ((meshID * mesh->GetNumLods() + lodID + i)) * sizeof(RGL::IndirectIndexedCommand));
-									//TODO: this increment needs to account for the LOD size
-									skeletalVertexOffset += mesh->GetNumVerts();
-								}
+								// instances in the same pose draw the same skinned vertices, see poseSkeletalMeshes
+								initData = {
+									.indexCount = uint32_t(mesh->GetNumIndices()),
+									.instanceCount = 0,
+									.indexStart = mesh->GetAllocation().getIndexRangeStart(),
+									.baseVertex = command.outputVertexOffset + command.outputSlots[i] * mesh->GetNumVerts(),
+									.baseInstance = commandBase + i
+								};
+								drawcommand.indirectStagingBuffer->UpdateBufferData(initData, (commandBase + i) * sizeof(RGL::IndirectIndexedCommand));
 							}
-							meshID++;
 						}
+						commandBase += nEntitiesInThisCommand;
 					}
-					mainCommandBuffer->CopyBufferToBuffer(
-						{
-							.buffer = drawcommand.indirectStagingBuffer,
-							.offset = 0
-						},
+					// every view starts from the same commands
+					drawcommand.numDrawSlots = total_entities;
+					drawcommand.cullingViewStride = total_entities;
+					for (uint32_t view = 0; view < numViews && total_entities > 0; view++) {
+						mainCommandBuffer->CopyBufferToBuffer(
 							{
-								.buffer = drawcommand.indirectBuffer,
+								.buffer = drawcommand.indirectStagingBuffer,
 								.offset = 0
-							}, drawcommand.indirectStagingBuffer->getBufferSize()
-					);
+							},
+								{
+									.buffer = drawcommand.indirectBuffer,
+									.offset = view * total_entities * uint32_t(sizeof(RGL::IndirectIndexedCommand))
+								}, total_entities * sizeof(RGL::IndirectIndexedCommand)
+						);
+					}
 				}
 
 				// the culling shader will decide for each draw if the draw should exist (and set its instance count to 1 from 0).
@@ -965,12 +1793,15 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 						.camPos = camPos,
 						.numCubos = 0,
 						.cameraRenderLayers = layers,
-						.singleInstanceModeAndShadowMode = 1u | (lightingFilter.FilterLightBlockers ? (1 << 1) : 0u),
+						.singleInstanceModeAndShadowMode = 1u | ShadowModeBits(lightingFilter),
+						.numViews = numViews,
 					};
 
+					uint32_t totalEntities = 0;
 					for (const auto& command : drawcommand.commands) {
 						if (auto mesh = command.mesh.lock()) {
 							globalCubo.numCubos += mesh->GetNumLods();
+							totalEntities += command.entities.DenseSize();
 						}
 					}
 
@@ -981,6 +1812,8 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					CullingUBOinstance cubo{
 						.indirectBufferOffset = 0,
 						.numLODs = 1,
+						.indirectViewStride = drawcommand.numDrawSlots,
+						.cullingViewStride = drawcommand.cullingViewStride,
 					};
 					{
 						uint32_t i = 0;
@@ -999,7 +1832,7 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 								drawcommand.cuboStagingBuffer->UpdateBufferData(cubo, i * sizeof(CullingUBOinstance));
 								i++;
 
-								cubo.indirectBufferOffset += lodsForThisMesh;
+								cubo.indirectBufferOffset += lodsForThisMesh * command.entities.DenseSize();	// one draw per instance
 								cubo.cullingBufferOffset += lodsForThisMesh * command.entities.DenseSize();
 							}
 						}
@@ -1022,25 +1855,33 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					mainCommandBuffer->BindBindlessBufferDescriptorSet(4);
 					mainCommandBuffer->BindBindlessBufferDescriptorSet(5);
 					mainCommandBuffer->BindBindlessBufferDescriptorSet(6);
+					mainCommandBuffer->BindBindlessBufferDescriptorSet(7);
+					mainCommandBuffer->BindBindlessBufferDescriptorSet(8);
+					mainCommandBuffer->BindComputeBuffer(dummyCullHistoryBuffer, DefaultCullBindings::cullHistory);
+					mainCommandBuffer->BindComputeBuffer(dummyCullHistoryBuffer, DefaultCullBindings::visibility);
+					bindCullViews();
 
                     mainCommandBuffer->SetComputeTexture(pyramid.pyramidTexture->GetDefaultView(), DefaultCullBindings::depthPyramid);
                     mainCommandBuffer->SetComputeSampler(depthPyramidSampler, DefaultCullBindings::depthPyramidSamplerBinding);
 					mainCommandBuffer->SetComputeBytes(globalCubo, 0);
-					mainCommandBuffer->DispatchCompute(std::ceil(cubo.numObjects / 64.f), 1, 1, 64, 1, 1);
+					mainCommandBuffer->DispatchCompute(std::ceil(totalEntities / 64.f), 1, 1, 64, 1, 1);
 					mainCommandBuffer->EndCompute();
 				}
+				compactDrawCommands(worldOwning->renderData.skinnedMeshRenderData);
 				mainCommandBuffer->EndComputeDebugMarker();
 			};
 
 
-            auto cullTheRenderData = [this, &viewproj, &worldTransformBuffer, &camPos, &pyramid, &lightingFilter, &reallocBuffer, layers, &worldOwning](auto&& renderData) {
+            auto cullTheRenderData = [this, &viewproj, &worldTransformBuffer, &camPos, &pyramid, &lightingFilter, &reallocBuffer, layers, &worldOwning, twoPhaseCull, isSecondCullPhase, numViews, &bindCullViews, &compactDrawCommands](auto&& renderData) {
 				RVE_PROFILE_FN_N("Cull RenderData");
 				CullingUBO globalCubo{
 					.viewProj = viewproj,
 					.camPos = camPos,
 					.numCubos = 0,
 					.cameraRenderLayers = layers,
-					.singleInstanceModeAndShadowMode = (lightingFilter.FilterLightBlockers ? (1 << 1) : 0u),
+					.singleInstanceModeAndShadowMode = ShadowModeBits(lightingFilter),
+					.cullPhase = uint32_t(twoPhaseCull ? twoPhaseCull->phase : CullPhase::Single),
+					.numViews = numViews,
 				};
 
 				uint32_t totalEntities = 0;
@@ -1075,8 +1916,12 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 						continue;
 					}
 
-					//prepass: get number of LODs and entities
-					uint32_t numLODs = 0, numEntities = 0;
+					//prepass: get number of draw slots and entities, and a key for everything the culling inputs depend on
+					uint32_t numDrawSlots = 0, numEntities = 0;
+					size_t layout = drawcommand.commands.size() ^ (size_t(meshAllocationGeneration) << 32);
+					auto mixLayout = [&layout](size_t value) {
+						layout ^= value + 0x9e3779b97f4a7c15 + (layout << 6) + (layout >> 2);
+					};
 
 					MeshAttributes materialAttributes;
 					std::visit(CaseAnalysis{
@@ -1092,89 +1937,130 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 					for (const auto& command : drawcommand.commands) {
 						if (auto mesh = command.mesh.lock()) {
-							auto meshattr = mesh->GetMeshForLOD(0)->GetAttributes();
+							auto meshattr = mesh->GetAttributes();
 							Debug::Assert(mesh->GetNumLods() > 0, "Mesh has no LODs!");
 							Debug::Assert(materialAttributes.CompatibleWith(meshattr), "Mesh does not have all attributes required for material!");
-							numLODs += mesh->GetNumLods();
+							numDrawSlots += mesh->GetNumDrawSlots();
 							numEntities += command.entities.DenseSize();
+							mixLayout(reinterpret_cast<size_t>(mesh.get()));
+							mixLayout(mesh->GetNumDrawSlots());
+							mixLayout(reinterpret_cast<size_t>(mesh->lodDrawSlots.GetPrivateBuffer().get()));
+							mixLayout(reinterpret_cast<size_t>(mesh->meshletData.GetPrivateBuffer().get()));
+							mixLayout(command.entities.DenseSize());
+							mixLayout(reinterpret_cast<size_t>(command.entities.GetPrivateBuffer().get()));
+						}
+						else {
+							mixLayout(0);
 						}
 					}
 
 				
-					const auto cullingbufferTotalSlots = numEntities * numLODs;
-					reallocBuffer(drawcommand.cullingBuffer, cullingbufferTotalSlots, sizeof(entity_t), RGL::BufferAccess::Private, { .StorageBuffer = true, .VertexBuffer = true }, { .Writable = true, .debugName = "Culling Buffer" });
-					reallocBuffer(drawcommand.indirectBuffer, numLODs, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Private, { .StorageBuffer = true, .IndirectBuffer = true }, { .Writable = true, .debugName = "Indirect Buffer" });
-					reallocBuffer(drawcommand.indirectStagingBuffer, numLODs, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Shared, { .StorageBuffer = true }, { .Transfersource = true, .Writable = false,.debugName = "Indirect Staging Buffer" });
-
-					// initial populate of drawcall buffer
-					// we need one command per mesh per LOD
-					{
+					const auto cullingbufferTotalSlots = numEntities * numDrawSlots;
+					const auto prevCullingBuffer = drawcommand.cullingBuffer, prevIndirectBuffer = drawcommand.indirectBuffer, prevIndirectStagingBuffer = drawcommand.indirectStagingBuffer;
+					// each view gets its own slice of the culling and indirect buffers
+					reallocBuffer(drawcommand.cullingBuffer, cullingbufferTotalSlots * numViews, sizeof(entity_t), RGL::BufferAccess::Private, { .StorageBuffer = true, .VertexBuffer = true }, { .Writable = true, .debugName = "Culling Buffer" });
+					reallocBuffer(drawcommand.indirectBuffer, numDrawSlots * numViews, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Private, { .StorageBuffer = true, .IndirectBuffer = true }, { .Writable = true, .debugName = "Indirect Buffer" });
+					reallocBuffer(drawcommand.indirectStagingBuffer, numDrawSlots, sizeof(RGL::IndirectIndexedCommand), RGL::BufferAccess::Shared, { .StorageBuffer = true }, { .Transfersource = true, .Writable = false,.debugName = "Indirect Staging Buffer" });
+					const bool buffersChanged = drawcommand.cullingBuffer != prevCullingBuffer || drawcommand.indirectBuffer != prevIndirectBuffer || drawcommand.indirectStagingBuffer != prevIndirectStagingBuffer;
+
+					// the initial draw calls and the culling inputs only depend on the commands, so they are kept
+					// until the commands change, instead of being rebuilt for every view
+					if (buffersChanged || layout != drawcommand.cullingLayout || drawcommand.cachedCubos.empty()) {
 						RVE_PROFILE_FN_N("Update staging buffer");
-						uint32_t meshID = 0;
+						// initial populate of drawcall buffer
+						// we need one command per mesh per LOD, or one per meshlet if the LOD has meshlets
+						uint32_t slotID = 0;
 						uint32_t baseInstance = 0;
 						for (const auto& command : drawcommand.commands) {			// for each mesh
 							const auto nEntitiesInThisCommand = command.entities.DenseSize();
-							RGL::IndirectIndexedCommand initData;
 							if (auto mesh = command.mesh.lock()) {
-								for (uint32_t lodID = 0; lodID < mesh->GetNumLods(); lodID++) {
-									const auto meshInst = mesh->GetMeshForLOD(lodID);
-									initData = {
-										.indexCount = uint32_t(meshInst->totalIndices),
+								auto writeCommand = [&](uint32_t indexStart, uint32_t indexCount, uint32_t baseVertex) {
+									RGL::IndirectIndexedCommand initData{
+										.indexCount = indexCount,
 										.instanceCount = 0,
-										.indexStart = meshInst->meshAllocation.getIndexRangeStart(),
-										.baseVertex = meshInst->meshAllocation.getVertexRangeStart(),
+										.indexStart = indexStart,
+										.baseVertex = baseVertex,
 										.baseInstance = baseInstance,	// sets the offset into the material-global culling buffer (and other per-instance data buffers). we allocate based on worst-case here, so the offset is known.
 									};
 									baseInstance += nEntitiesInThisCommand;
-									drawcommand.indirectStagingBuffer->UpdateBufferData(initData, (meshID + lodID) * sizeof(RGL::IndirectIndexedCommand));
+									drawcommand.indirectStagingBuffer->UpdateBufferData(initData, slotID * sizeof(RGL::IndirectIndexedCommand));
+									slotID++;
+								};
+								for (uint32_t lodID = 0; lodID < mesh->GetNumLods(); lodID++) {
+									const auto meshInst = mesh->GetMeshForLOD(lodID);
+									if (!meshInst) {
+										writeCommand(0, 0, 0);		// an empty LOD, instances culled into it draw nothing
+										continue;
+									}
+									const auto indexRangeStart = meshInst->meshAllocation.getIndexRangeStart();
+									const auto baseVertex = meshInst->meshAllocation.getVertexRangeStart();
+									const auto meshlets = meshInst->GetMeshlets();
+									if (meshlets.empty()) {
+										writeCommand(indexRangeStart, uint32_t(meshInst->totalIndices), baseVertex);
+									}
+									for (const auto& meshlet : meshlets) {
+										writeCommand(indexRangeStart + meshlet.indexStart, meshlet.indexCount, baseVertex);
+									}
 								}
-
 							}
-							meshID++;
 						}
-					}
-					mainCommandBuffer->CopyBufferToBuffer(
-						{
-							.buffer = drawcommand.indirectStagingBuffer,
-							.offset = 0
-						},
-						{
-							.buffer = drawcommand.indirectBuffer,
-							.offset = 0
-						}, drawcommand.indirectStagingBuffer->getBufferSize());
 
-					RVE_PROFILE_SECTION(dispatchcull,"Write Cubo Data");
-
-
-					CullingUBOinstance cubo{
-						.indirectBufferOffset = 0,
-					};
-					static_assert(sizeof(cubo) <= 128, "CUBO is too big!");
-					{
-						
+						CullingUBOinstance cubo{
+							.indirectBufferOffset = 0,
+							.indirectViewStride = numDrawSlots,
+							.cullingViewStride = cullingbufferTotalSlots,
+						};
+						static_assert(sizeof(cubo) <= 128, "CUBO is too big!");
+						static_assert(std::is_trivially_copyable_v<CullingUBOinstance>);
+						drawcommand.cachedCubos.clear();
 						for (auto& command : drawcommand.commands) {
 
 							if (auto mesh = command.mesh.lock()) {
-								uint32_t lodsForThisMesh = mesh->GetNumLods();
+								uint32_t slotsForThisMesh = mesh->GetNumDrawSlots();
 
 								cubo.numObjects = command.entities.DenseSize();
 								cubo.radius = mesh->GetRadius();
-								cubo.numLODs = lodsForThisMesh;
+								cubo.numLODs = mesh->GetNumLods();
 								cubo.idOutputBufferBindlessHandle = drawcommand.cullingBuffer->GetReadwriteBindlessGPUHandle();
 								cubo.indirectOutputBufferBindlessHandle = drawcommand.indirectBuffer->GetReadwriteBindlessGPUHandle();
 								cubo.lodDistanceBufferBindlessHandle = mesh->lodDistances.GetPrivateBuffer()->GetReadonlyBindlessGPUHandle();
 								cubo.entityIDInputBufferBindlessHandle = command.entities.GetPrivateBuffer()->GetReadonlyBindlessGPUHandle();
+								cubo.hasMeshlets = mesh->HasMeshlets();
+								if (mesh->HasMeshlets()) {
+									cubo.lodDrawSlotsBufferBindlessHandle = mesh->lodDrawSlots.GetPrivateBuffer()->GetReadonlyBindlessGPUHandle();
+									cubo.meshletBufferBindlessHandle = mesh->meshletData.GetPrivateBuffer()->GetReadonlyBindlessGPUHandle();
+								}
 
+								const auto offset = drawcommand.cachedCubos.size();
+								drawcommand.cachedCubos.resize(offset + sizeof(cubo));
+								std::memcpy(drawcommand.cachedCubos.data() + offset, &cubo, sizeof(cubo));
 
-								cuboStagingBuffer->UpdateBufferData(cubo, cuboIdx * sizeof(CullingUBOinstance));
-								cuboIdx++;
-
-								cubo.indirectBufferOffset += lodsForThisMesh;
-								cubo.cullingBufferOffset += lodsForThisMesh * command.entities.DenseSize();
+								cubo.indirectBufferOffset += slotsForThisMesh;
+								cubo.cullingBufferOffset += slotsForThisMesh * command.entities.DenseSize();
 							}
 						}
+						drawcommand.cullingLayout = layout;
+						drawcommand.numDrawSlots = numDrawSlots;
+						drawcommand.cullingViewStride = cullingbufferTotalSlots;
+					}
+					// the second phase appends to the instance counts of the first
+					if (!isSecondCullPhase && numDrawSlots > 0) {
+						for (uint32_t view = 0; view < numViews; view++) {
+							mainCommandBuffer->CopyBufferToBuffer(
+								{
+									.buffer = drawcommand.indirectStagingBuffer,
+									.offset = 0
+								},
+								{
+									.buffer = drawcommand.indirectBuffer,
+									.offset = view * numDrawSlots * uint32_t(sizeof(RGL::IndirectIndexedCommand))
+								}, numDrawSlots * sizeof(RGL::IndirectIndexedCommand));
+						}
 					}
 
+					RVE_PROFILE_SECTION(dispatchcull,"Write Cubo Data");
+					cuboStagingBuffer->UpdateBufferData({ drawcommand.cachedCubos.data(), drawcommand.cachedCubos.size() }, cuboIdx * sizeof(CullingUBOinstance));
+					cuboIdx += drawcommand.cachedCubos.size() / sizeof(CullingUBOinstance);
 					RVE_PROFILE_SECTION_END(dispatchcull);
 				}
 				// copy to cubo buffer
@@ -1196,6 +2082,17 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				mainCommandBuffer->BindBindlessBufferDescriptorSet(4);
 				mainCommandBuffer->BindBindlessBufferDescriptorSet(5);
 				mainCommandBuffer->BindBindlessBufferDescriptorSet(6);
+				mainCommandBuffer->BindBindlessBufferDescriptorSet(7);
+				mainCommandBuffer->BindBindlessBufferDescriptorSet(8);
+				if (twoPhaseCull) {
+					mainCommandBuffer->BindComputeBuffer(twoPhaseCull->prevViewProj.buffer, DefaultCullBindings::cullHistory, twoPhaseCull->prevViewProj.offset);
+					mainCommandBuffer->BindComputeBuffer(twoPhaseCull->visibilityBuffer, DefaultCullBindings::visibility);
+				}
+				else {
+					mainCommandBuffer->BindComputeBuffer(dummyCullHistoryBuffer, DefaultCullBindings::cullHistory);
+					mainCommandBuffer->BindComputeBuffer(dummyCullHistoryBuffer, DefaultCullBindings::visibility);
+				}
+				bindCullViews();
                 mainCommandBuffer->SetComputeTexture(pyramid.pyramidTexture->GetDefaultView(), DefaultCullBindings::depthPyramid);
                 mainCommandBuffer->SetComputeSampler(depthPyramidSampler, DefaultCullBindings::depthPyramidSamplerBinding);
 				mainCommandBuffer->SetComputeBytes(globalCubo, 0);
@@ -1203,11 +2100,12 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 				mainCommandBuffer->EndCompute();
 
+				compactDrawCommands(renderData);
 			};
 			struct BufferSet {
 				RGLBufferPtr positionBuffer, normalBuffer, tangentBuffer, bitangentBuffer, uv0Buffer, lightmapBuffer;
 			};
-            auto renderTheRenderData = [this, &viewproj, &viewonly,&projOnly, &worldTransformBuffer, &pipelineSelectorFunction, &viewportScissor, &worldOwning, particleBillboardMatrices, &lightDataOffset,&layers, &target, &camIdx](auto&& renderData, const BufferSet& vertexBufferSet, LightingType currentLightingType) {
+            auto renderTheRenderData = [this, &viewproj, &viewonly,&projOnly, &worldTransformBuffer, &pipelineSelectorFunction, &viewportScissor, &worldOwning, particleBillboardMatrices, &lightDataOffset,&layers, &target, &camIdx, viewIndex](auto&& renderData, const BufferSet& vertexBufferSet, LightingType currentLightingType) {
 				// do static meshes
 				RVE_PROFILE_FN_N("RenderTheRenderData");
 				mainCommandBuffer->SetViewport({
@@ -1217,76 +2115,80 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					.height = static_cast<float>(viewportScissor.extent[1]),
 					});
 				mainCommandBuffer->SetScissor(viewportScissor);
-				
+
+				// renderData is sorted so that instances sharing a pipeline are adjacent. Per-pipeline state is only bound when it changes.
+				RGLRenderPipelinePtr boundPipeline;
 				for (auto& [materialInstance, drawcommand] : renderData) {
 
 					bool shouldKeep = filterRenderData(currentLightingType, materialInstance);
 
-					// is this the correct material type? if not, skip
-					if (!shouldKeep) {
+					// is this the correct material type? if not, skip. Also skip commands that have not been culled yet.
+					if (!shouldKeep || drawcommand.numDrawSlots == 0) {
 						continue;
 					}
 
 					// bind the pipeline
 					auto pipeline = pipelineSelectorFunction(materialInstance.mat->GetMat());
+					if (pipeline.pipeline != boundPipeline) {
+						boundPipeline = pipeline.pipeline;
 
-					if (pipeline.attributes.position) {
-						mainCommandBuffer->SetVertexBuffer(vertexBufferSet.positionBuffer, { .bindingPosition = VTX_POSITION_BINDING });
-					}
-					if (pipeline.attributes.normal) {
-						mainCommandBuffer->SetVertexBuffer(vertexBufferSet.normalBuffer, { .bindingPosition = VTX_NORMAL_BINDING });
-					}
-					if (pipeline.attributes.tangent) {
-						mainCommandBuffer->SetVertexBuffer(vertexBufferSet.tangentBuffer, { .bindingPosition = VTX_TANGENT_BINDING });
-					}
-					if (pipeline.attributes.bitangent) {
-						mainCommandBuffer->SetVertexBuffer(vertexBufferSet.bitangentBuffer, { .bindingPosition = VTX_BITANGENT_BINDING });
-					}
-					if (pipeline.attributes.uv0) {
-						mainCommandBuffer->SetVertexBuffer(vertexBufferSet.uv0Buffer, { .bindingPosition = VTX_UV0_BINDING });
-					}
-					if (pipeline.attributes.lightmapUV) {
-						mainCommandBuffer->SetVertexBuffer(vertexBufferSet.lightmapBuffer, { .bindingPosition = VTX_LIGHTMAP_BINDING });
-					}
-					mainCommandBuffer->SetIndexBuffer(sharedIndexBuffer);
+						if (pipeline.attributes.position) {
+							mainCommandBuffer->SetVertexBuffer(vertexBufferSet.positionBuffer, { .bindingPosition = VTX_POSITION_BINDING });
+						}
+						if (pipeline.attributes.normal) {
+							mainCommandBuffer->SetVertexBuffer(vertexBufferSet.normalBuffer, { .bindingPosition = VTX_NORMAL_BINDING });
+						}
+						if (pipeline.attributes.tangent) {
+							mainCommandBuffer->SetVertexBuffer(vertexBufferSet.tangentBuffer, { .bindingPosition = VTX_TANGENT_BINDING });
+						}
+						if (pipeline.attributes.bitangent) {
+							mainCommandBuffer->SetVertexBuffer(vertexBufferSet.bitangentBuffer, { .bindingPosition = VTX_BITANGENT_BINDING });
+						}
+						if (pipeline.attributes.uv0) {
+							mainCommandBuffer->SetVertexBuffer(vertexBufferSet.uv0Buffer, { .bindingPosition = VTX_UV0_BINDING });
+						}
+						if (pipeline.attributes.lightmapUV) {
+							mainCommandBuffer->SetVertexBuffer(vertexBufferSet.lightmapBuffer, { .bindingPosition = VTX_LIGHTMAP_BINDING });
+						}
+						mainCommandBuffer->SetIndexBuffer(sharedIndexBuffer);
 
-					mainCommandBuffer->BindRenderPipeline(pipeline.pipeline);
+						mainCommandBuffer->BindRenderPipeline(pipeline.pipeline);
 
-					// this is always needed
-					mainCommandBuffer->BindBuffer(transientBuffer, 11, lightDataOffset);
+						// this is always needed
+						mainCommandBuffer->BindBuffer(lightDataOffset.buffer, 11, lightDataOffset.offset);
 						
-					if constexpr (includeLighting) {
-						// make textures resident and put them in the right format
-						worldOwning->Filter([this](const DirectionalLight& light, const Transform& t) {
-                            for(const auto& shadowMap : light.shadowData.shadowMap){
-                                mainCommandBuffer->UseResource(shadowMap->GetDefaultView());
-                            }
-						});
-						worldOwning->Filter([this](const SpotLight& light, const Transform& t) {
-							mainCommandBuffer->UseResource(light.shadowData.shadowMap->GetDefaultView());
-						});
+						if constexpr (includeLighting) {
+							// make textures resident and put them in the right format
+							worldOwning->Filter([this](const DirectionalLight& light, const Transform& t) {
+	                            for(const auto& shadowMap : light.shadowData.shadowMap){
+	                                mainCommandBuffer->UseResource(shadowMap->GetDefaultView());
+	                            }
+							});
+							mainCommandBuffer->UseResource(shadowAtlasTexture->GetDefaultView());
 
-						mainCommandBuffer->BindBuffer(worldOwning->renderData.ambientLightData.GetPrivateBuffer(),12);
-						mainCommandBuffer->BindBuffer(worldOwning->renderData.directionalLightData.GetPrivateBuffer(),13);
-						mainCommandBuffer->BindBuffer(worldOwning->renderData.pointLightData.GetPrivateBuffer(), 15);
-						mainCommandBuffer->BindBuffer(worldOwning->renderData.spotLightData.GetPrivateBuffer(), 17);
-                        mainCommandBuffer->BindBuffer(worldOwning->renderData.renderLayers.GetPrivateBuffer(), 28);
-						mainCommandBuffer->BindBuffer(worldOwning->renderData.perObjectAttributes.GetPrivateBuffer(), 29);
-                        mainCommandBuffer->BindBuffer(worldOwning->renderData.directionalLightPassVarying.GetPrivateBuffer(), 30, camIdx * sizeof(World::DirLightUploadDataPassVarying));
-						mainCommandBuffer->SetFragmentTexture(device->GetGlobalBindlessTextureHeap(), 1);	
-						mainCommandBuffer->SetFragmentTexture(device->GetGlobalBindlessTextureHeap(), 2);
-						mainCommandBuffer->SetFragmentSampler(shadowSampler, 14);
-						mainCommandBuffer->BindBuffer(lightClusterBuffer, 16);
+							mainCommandBuffer->BindBuffer(worldOwning->renderData.ambientLightData.GetPrivateBuffer(),12);
+							mainCommandBuffer->BindBuffer(worldOwning->renderData.directionalLightData.GetPrivateBuffer(),13);
+							mainCommandBuffer->BindBuffer(worldOwning->renderData.pointLightData.GetPrivateBuffer(), 15);
+							mainCommandBuffer->BindBuffer(worldOwning->renderData.spotLightData.GetPrivateBuffer(), 17);
+	                        mainCommandBuffer->BindBuffer(worldOwning->renderData.renderLayers.GetPrivateBuffer(), 28);
+							mainCommandBuffer->BindBuffer(worldOwning->renderData.perObjectAttributes.GetPrivateBuffer(), 29);
+	                        mainCommandBuffer->BindBuffer(worldOwning->renderData.directionalLightPassVarying.GetBuffer(), 30, camIdx * sizeof(World::DirLightUploadDataPassVarying));
+							mainCommandBuffer->SetFragmentTexture(device->GetGlobalBindlessTextureHeap(), 1);	
+							mainCommandBuffer->SetFragmentTexture(device->GetGlobalBindlessTextureHeap(), 2);
+							mainCommandBuffer->SetFragmentSampler(shadowSampler, 14);
+							mainCommandBuffer->BindBuffer(lightClusterBuffer, 16);
+							mainCommandBuffer->BindBuffer(clusterLightIndexBuffer, 31);
 						
+						}
+	                    if constexpr(transparentMode){
+	                        assert(target != nullptr); // no target provided!
+	                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[0]->GetDefaultView(), 23);
+	                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[1]->GetDefaultView(), 24);
+	                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[2]->GetDefaultView(), 25);
+	                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[3]->GetDefaultView(), 26);
+	                        mainCommandBuffer->SetFragmentTexture(target->mlabDepth->GetDefaultView(), 27);
+	                    }
 					}
-                    if constexpr(transparentMode){
-                        assert(target != nullptr); // no target provided!
-                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[0]->GetDefaultView(), 23);
-                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[1]->GetDefaultView(), 24);
-                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[2]->GetDefaultView(), 25);
-                        mainCommandBuffer->SetFragmentTexture(target->mlabAccum[3]->GetDefaultView(), 26);
-                        mainCommandBuffer->SetFragmentTexture(target->mlabDepth->GetDefaultView(), 27);
-                    }
                         
 					// set push constant data
 					auto pushConstantData = materialInstance.mat->GetPushConstantData();
@@ -1322,20 +2224,33 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 							mainCommandBuffer->BindBuffer(buffer, i);
 						}
 						if (texture) {
-							mainCommandBuffer->SetFragmentSampler(textureSampler, 0); // TODO: don't hardcode this
+							mainCommandBuffer->SetFragmentSampler(materialTextureSampler, 0); // TODO: don't hardcode this
 							mainCommandBuffer->SetFragmentTexture(texture->GetRHITexturePointer()->GetDefaultView(), i);
 						}
 					}
 
-					// bind the culling buffer and the transform buffer
-					mainCommandBuffer->SetVertexBuffer(drawcommand.cullingBuffer, { .bindingPosition = ENTITY_INPUT_BINDING });
+					// bind this view's slice of the culling buffer, and the transform buffer
+					mainCommandBuffer->SetVertexBuffer(drawcommand.cullingBuffer, { .bindingPosition = ENTITY_INPUT_BINDING, .offsetIntoBuffer = viewIndex * drawcommand.cullingViewStride });	// in elements
 					mainCommandBuffer->BindBuffer(worldTransformBuffer, 10);
 
-					// do the indirect command
-					mainCommandBuffer->ExecuteIndirectIndexed({
-						.indirectBuffer = drawcommand.indirectBuffer,
-						.nDraws = uint32_t(drawcommand.indirectBuffer->getBufferSize() / sizeof(RGL::IndirectIndexedCommand))	// the number of structs in the buffer
-					});
+					// do the indirect command. With a draw count, only the commands that survived culling are submitted.
+					const auto sliceOffset = viewIndex * drawcommand.numDrawSlots * uint32_t(sizeof(RGL::IndirectIndexedCommand));
+					if (supportsIndirectCount && drawcommand.drawCountBuffer) {
+						mainCommandBuffer->ExecuteIndirectIndexed({
+							.indirectBuffer = drawcommand.compactedIndirectBuffer,
+							.offsetIntoBuffer = sliceOffset,
+							.nDraws = drawcommand.numDrawSlots,
+							.countBuffer = drawcommand.drawCountBuffer,
+							.countBufferOffset = viewIndex * uint32_t(sizeof(uint32_t)),
+						});
+					}
+					else {
+						mainCommandBuffer->ExecuteIndirectIndexed({
+							.indirectBuffer = drawcommand.indirectBuffer,
+							.offsetIntoBuffer = sliceOffset,
+							.nDraws = drawcommand.numDrawSlots
+						});
+					}
 				}
 
 				// render particles
@@ -1350,25 +2265,31 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					// check if casting shadows
                     auto attributes = worldOwning->renderData.perObjectAttributes[emitter.GetOwner().GetID().id];
 					const bool shouldConsider = !currentLightingType.FilterLightBlockers || (currentLightingType.FilterLightBlockers && (attributes & CastsShadowsBit));
-					if (!shouldConsider) {
+					// particles always animate, so they never go into a cached static shadow layer
+					if (!shouldConsider || currentLightingType.StaticCastersOnly) {
 						return;
 					}
                     
-					if (!emitter.GetVisible()) {
+					// emitters get their pool space the first time they are ticked
+					if (!emitter.GetVisible() || !emitter.poolSlot.IsValid()) {
 						return;
 					}
 
-                    auto sharedParticleImpl = [this, &particleBillboardMatrices, &pipelineSelectorFunction, &worldOwning, &lightDataOffset, &target, &camIdx, &worldTransformBuffer](const ParticleEmitter& emitter, auto&& materialInstance, Ref<ParticleRenderMaterial> material, RGLBufferPtr activeParticleIndexBuffer, bool isLit) {
-						auto pipeline = pipelineSelectorFunction(material);
+					if (emitter.culling.boundsRadius > 0 && !SphereIntersectsFrustum(viewproj, emitter.renderState.worldBoundsCenter, emitter.renderState.worldBoundsRadius)) {
+						return;
+					}
 
+                    auto sharedParticleImpl = [this, &particleBillboardMatrices, &pipelineSelectorFunction, &worldOwning, &lightDataOffset, &target, &camIdx, &worldTransformBuffer](const ParticleEmitter& emitter, auto&& materialInstance, Ref<ParticleRenderMaterial> material, RGLBufferPtr activeParticleIndexBuffer, uint32_t activeParticleIndexOffset, bool isLit) {
+						auto pipeline = pipelineSelectorFunction(material);
+						const auto& pool = particlePools.at(emitter.particleSize);
 
 						mainCommandBuffer->BindRenderPipeline(pipeline);
-						mainCommandBuffer->BindBuffer(emitter.particleDataBuffer, material->particleDataBufferBinding);
-						mainCommandBuffer->BindBuffer(activeParticleIndexBuffer, material->particleAliveIndexBufferBinding);
-                        mainCommandBuffer->BindBuffer(emitter.emitterStateBuffer, material->particleEmitterStateBufferBinding);
-						mainCommandBuffer->BindBuffer(transientBuffer, material->particleMatrixBufferBinding, particleBillboardMatrices);
+						mainCommandBuffer->BindBuffer(pool.particleData, material->particleDataBufferBinding, emitter.poolSlot.GetParticleBase() * emitter.particleSize);
+						mainCommandBuffer->BindBuffer(activeParticleIndexBuffer, material->particleAliveIndexBufferBinding, activeParticleIndexOffset);
+                        mainCommandBuffer->BindBuffer(pool.emitterState, material->particleEmitterStateBufferBinding, emitter.poolSlot.state * ParticlePool::stateStride);
+						mainCommandBuffer->BindBuffer(particleBillboardMatrices.buffer, material->particleMatrixBufferBinding, particleBillboardMatrices.offset);
 						mainCommandBuffer->BindBuffer(worldTransformBuffer, 10);
-						mainCommandBuffer->BindBuffer(transientBuffer, 11, lightDataOffset);
+						mainCommandBuffer->BindBuffer(lightDataOffset.buffer, 11, lightDataOffset.offset);
 						if (isLit) {
 							mainCommandBuffer->BindBuffer(worldOwning->renderData.ambientLightData.GetPrivateBuffer(), 12);
 							mainCommandBuffer->BindBuffer(worldOwning->renderData.directionalLightData.GetPrivateBuffer(), 13);
@@ -1377,8 +2298,9 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 							mainCommandBuffer->BindBuffer(worldOwning->renderData.spotLightData.GetPrivateBuffer(), 17);
                             mainCommandBuffer->BindBuffer(worldOwning->renderData.renderLayers.GetPrivateBuffer(), 28);
 							mainCommandBuffer->BindBuffer(worldOwning->renderData.perObjectAttributes.GetPrivateBuffer(), 29);
-                            mainCommandBuffer->BindBuffer(worldOwning->renderData.directionalLightPassVarying.GetPrivateBuffer(), 30,camIdx * sizeof(World::DirLightUploadDataPassVarying));
+                            mainCommandBuffer->BindBuffer(worldOwning->renderData.directionalLightPassVarying.GetBuffer(), 30,camIdx * sizeof(World::DirLightUploadDataPassVarying));
 							mainCommandBuffer->BindBuffer(lightClusterBuffer, 16);
+							mainCommandBuffer->BindBuffer(clusterLightIndexBuffer, 31);
 							mainCommandBuffer->SetFragmentTexture(device->GetGlobalBindlessTextureHeap(), 1);
 							mainCommandBuffer->SetFragmentTexture(device->GetGlobalBindlessTextureHeap(), 2);	// redundant on some backends, needed for DX
 						}
@@ -1403,7 +2325,7 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 						// set samplers (currently sampler is not configurable)
 						for (uint32_t i = 0; i < materialInstance->samplerBindings.size(); i++) {
 							if (materialInstance->samplerBindings[i]) {
-								mainCommandBuffer->SetFragmentSampler(textureSampler, i);
+								mainCommandBuffer->SetFragmentSampler(materialTextureSampler, i);
 							}
 						}
 
@@ -1429,20 +2351,22 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 									return;
 								}
 
-								sharedParticleImpl(emitter,billboardMat, result.material, emitter.activeParticleIndexBuffer,result.isLit);
+								const auto& pool = particlePools.at(emitter.particleSize);
+								sharedParticleImpl(emitter,billboardMat, result.material, pool.activeParticleIndices, emitter.poolSlot.GetParticleBase() * sizeof(uint32_t), result.isLit);
 
 								mainCommandBuffer->SetVertexBuffer(quadVertBuffer);
 
 								mainCommandBuffer->ExecuteIndirect(
 									{
-										.indirectBuffer = emitter.indirectDrawBuffer,
-										.offsetIntoBuffer = 0,
+										.indirectBuffer = pool.drawCommands,
+										.offsetIntoBuffer = uint32_t(emitter.poolSlot.state * sizeof(RGL::IndirectCommand)),
 										.nDraws = 1,
 									});
 
 							},
 							[this,&emitter,&sharedParticleImpl, &currentLightingType,&lightDataOffset](const Ref <MeshParticleRenderMaterialInstance>& meshMat) {
 							RGLBufferPtr activeIndexBuffer;
+							uint32_t activeIndexOffset = 0;
 
 								auto result = particleRenderFilter<MeshParticleRenderMaterial>(currentLightingType, meshMat);
 
@@ -1452,14 +2376,15 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 									activeIndexBuffer = emitter.meshAliveParticleIndexBuffer;
 								}
 								else {
-									activeIndexBuffer = emitter.activeParticleIndexBuffer;
+									activeIndexBuffer = particlePools.at(emitter.particleSize).activeParticleIndices;
+									activeIndexOffset = emitter.poolSlot.GetParticleBase() * sizeof(uint32_t);
 								}
 
 								if (!result.material) {
 									return;
 								}
 
-								sharedParticleImpl(emitter, meshMat, result.material, activeIndexBuffer,result.isLit);
+								sharedParticleImpl(emitter, meshMat, result.material, activeIndexBuffer, activeIndexOffset, result.isLit);
 
 								mainCommandBuffer->SetVertexBuffer(sharedPositionBuffer, { .bindingPosition = VTX_POSITION_BINDING });
 								mainCommandBuffer->SetVertexBuffer(sharedNormalBuffer, { .bindingPosition = VTX_NORMAL_BINDING });
@@ -1467,7 +2392,7 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 								mainCommandBuffer->SetVertexBuffer(sharedBitangentBuffer, { .bindingPosition = VTX_BITANGENT_BINDING });
 								mainCommandBuffer->SetVertexBuffer(sharedUV0Buffer, { .bindingPosition = VTX_UV0_BINDING });
 								mainCommandBuffer->SetIndexBuffer(sharedIndexBuffer);
-								mainCommandBuffer->BindBuffer(transientBuffer, MeshParticleRenderMaterialInstance::kEngineDataBinding, emitter.renderState.maxTotalParticlesOffset);
+								mainCommandBuffer->BindBuffer(emitter.renderState.maxTotalParticlesBuffer, MeshParticleRenderMaterialInstance::kEngineDataBinding, emitter.renderState.maxTotalParticlesOffset);
 
 								mainCommandBuffer->ExecuteIndirectIndexed(
 									{
@@ -1488,7 +2413,7 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				mainCommandBuffer->BeginComputeDebugMarker("Cull Static Meshes");
 				cullTheRenderData(worldOwning->renderData.staticMeshRenderData);
 				mainCommandBuffer->EndComputeDebugMarker();
-				if (skeletalPrepareResult.skeletalMeshesExist) {
+				if (skeletalPrepareResult.skeletalMeshesExist && !isSecondCullPhase) {
 					cullSkeletalMeshes(viewproj, pyramid);
 				}
 			}
@@ -1508,7 +2433,7 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 			renderTheRenderData(worldOwning->renderData.staticMeshRenderData, vertexBuffers, lightingFilter);
 			mainCommandBuffer->EndRenderDebugMarker();
 
-			if (skeletalPrepareResult.skeletalMeshesExist) {
+			if (skeletalPrepareResult.skeletalMeshesExist && !isSecondCullPhase) {
 				mainCommandBuffer->BeginRenderDebugMarker("Render Skinned Meshes");
 				vertexBuffers = {
 					.positionBuffer = sharedSkinnedPositionBuffer,
@@ -1528,16 +2453,35 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 		struct lightViewProjResult {
 			glm::mat4 lightProj, lightView;
 			glm::vec3 camPos = glm::vec3{ 0,0,0 };
-			DepthPyramid depthPyramid;
 			RGLTexturePtr shadowmapTexture;
 		};
 
+		// shadow views are culled in batches of up to maxCullViews, which are not occlusion culled, so they bind a placeholder pyramid
+		if (!shadowPlaceholderPyramid.pyramidTexture) {
+			shadowPlaceholderPyramid = { 1, "Shadow Placeholder Depth Pyramid" };
+		}
+		// render a batch of shadow views. The first culls all of them in one dispatch, the rest draw from that result.
+		auto renderShadowViewBatch = [](std::span<const CullingView> views, auto&& renderView) {
+			Debug::Assert(views.size() <= maxCullViews, "Too many views in one batch");
+			for (uint32_t i = 0; i < views.size(); i++) {
+				const MultiViewCull multiView{ views, i };
+				if (i == 0) {
+					renderView(std::true_type{}, i, &multiView);
+				}
+				else {
+					renderView(std::false_type{}, i, &multiView);
+				}
+			}
+		};
+
 		// render shadowmaps only once per light
 
 
 		// the generic shadowmap rendering function
+		// Shadow views are encoded serially into mainCommandBuffer: every view reuses the per-drawcommand culling and indirect buffers,
+		// the transient buffer and shadowRenderPass, so encoding them on separate threads would race on that shared state.
 		RVE_PROFILE_SECTION(encode_shadowmaps, "Render Encode Shadowmaps");
-        auto renderLightShadowmap = [this, &renderFromPerspective, &worldOwning](auto&& lightStore, uint32_t numShadowmaps, auto&& genLightViewProjAtIndex, auto&& postshadowmapFunction, auto&& shouldRendershadowmap) {
+        auto renderLightShadowmap = [this, &renderFromPerspective, &renderShadowViewBatch, &worldOwning](auto&& lightStore, uint32_t numShadowmaps, auto&& genLightViewProjAtIndex, auto&& postshadowmapFunction, auto&& shouldRendershadowmap) {
 			if (lightStore.DenseSize() <= 0) {
 				return;
 			}
@@ -1550,100 +2494,254 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				auto sparseIdx = lightStore.GetSparseIndexForDense(i);
                 auto owner = Entity({sparseIdx, worldOwning->VersionForEntity(sparseIdx)}, worldOwning.get());
 
-				using lightadt_t = std::remove_reference_t<decltype(lightStore)>;
-
+				// all the shadowmaps of a light are culled together
+				Array<lightViewProjResult, maxCullViews> lightMats;
+				Array<CullingView, maxCullViews> cullViews;
+				uint32_t numViews = 0;
 				for (uint8_t sm_i = 0; sm_i < numShadowmaps; sm_i++) {
                     if (!shouldRendershadowmap(sm_i, owner)){
                         continue;
                     }
-					lightViewProjResult lightMats = genLightViewProjAtIndex(sm_i, i, light, owner);
-
-					auto lightSpaceMatrix = lightMats.lightProj * lightMats.lightView;
+					Debug::Assert(numViews < maxCullViews, "Light has too many shadowmaps to cull at once");
+					lightMats[numViews] = genLightViewProjAtIndex(sm_i, i, light, owner);
+					cullViews[numViews] = { lightMats[numViews].lightProj * lightMats[numViews].lightView, lightMats[numViews].camPos, light.shadowLayers };
+					numViews++;
+				}
 
-					auto shadowTexture = lightMats.shadowmapTexture;
+				renderShadowViewBatch({ cullViews.data(), numViews }, [&](auto runCulling, uint32_t view, const MultiViewCull* multiView) {
+					const auto& mats = lightMats[view];
+					auto shadowTexture = mats.shadowmapTexture;
+					auto shadowMapSize = shadowTexture->GetSize().width;
 
 					shadowRenderPass->SetDepthAttachmentTexture(shadowTexture->GetDefaultView());
-					auto shadowMapSize = shadowTexture->GetSize().width;
-					renderFromPerspective.template operator()<false,false>(lightSpaceMatrix, lightMats.lightView, lightMats.lightProj, lightMats.camPos, {}, shadowRenderPass, [](auto&& mat) {
+					renderFromPerspective.template operator()<false, false, decltype(runCulling)::value>(cullViews[view].viewProj, mats.lightView, mats.lightProj, mats.camPos, {}, shadowRenderPass, [](auto&& mat) {
 						return mat->GetShadowRenderPipeline();
-                    }, { 0, 0, shadowMapSize,shadowMapSize }, { .Lit = true, .Unlit = true, .FilterLightBlockers = true, .Opaque = true }, lightMats.depthPyramid, light.shadowLayers, nullptr);
-
-				}
+					}, { 0, 0, shadowMapSize,shadowMapSize }, { .Lit = true, .Unlit = true, .FilterLightBlockers = true, .Opaque = true, .SkipOcclusion = true }, shadowPlaceholderPyramid, light.shadowLayers, nullptr, nullptr, multiView);
+				});
 				postshadowmapFunction(owner);
 			}
 			mainCommandBuffer->EndRenderDebugMarker();
 		};
 
-		RVE_PROFILE_SECTION(encode_spot_shadows,"Render Encode Spot Shadows");
-		const auto spotlightShadowMapFunction = [](uint8_t index, uint32_t denseIdx, const RavEngine::World::SpotLightDataUpload& light, Entity owner) {
-
-			auto camPos = light.worldTransform * glm::vec4(0, 0, 0, 1);
-			auto& origLight = owner.GetComponent<SpotLight>();
-            auto viewMat = origLight.CalcViewMatrix(light.worldTransform);
-			auto projMat = origLight.CalcProjectionMatrix();
-
-			return lightViewProjResult{
-				.lightProj = projMat,
-				.lightView = viewMat,
-				.camPos = camPos,
-				.depthPyramid = origLight.shadowData.pyramid,
-				.shadowmapTexture = origLight.shadowData.shadowMap,
+		// Spot lights and point light faces render into tiles of the shadow atlas, placed by UpdateShadowAtlas. All tiles share one
+		// attachment and render pass, and differ only in viewport and scissor. They are not occlusion culled, because a depth pyramid
+		// per tile would cost the memory the atlas saves.
+		RVE_PROFILE_SECTION(encode_atlas_shadows, "Render Encode Atlas Shadows");
+		{
+			struct AtlasShadowView {
+				glm::mat4 lightProj, lightView;
+				glm::vec3 camPos;
+				renderlayer_t layers;
+				ShadowAtlasEntry* entry;
 			};
-        };
-        
-		renderLightShadowmap(worldOwning->renderData.spotLightData, 1,
-			spotlightShadowMapFunction,
-			[](Entity unused) {},
-            [](uint32_t i, auto&& entity){ return true;}
-		);
-		RVE_PROFILE_SECTION_END(encode_spot_shadows);
-
-		RVE_PROFILE_SECTION(encode_point_shadows, "Render Encode Point Shadows");
-		constexpr auto pointLightShadowmapFunction = [](uint8_t index, uint32_t denseIdx, const RavEngine::World::PointLightUploadData& light, Entity owner) {
-			auto camPos = light.position;
-
-			auto& origLight = owner.GetComponent<PointLight>();
-
-			return lightViewProjResult{
-				.lightProj = origLight.CalcProjectionMatrix(),
-				.lightView = PointLight::CalcViewMatrix(light.position,index),
-				.camPos = camPos,
-				.depthPyramid = origLight.shadowData.cubePyramids[index],
-				.shadowmapTexture = origLight.shadowData.cubeShadowmaps[index],
+			FrameVector<AtlasShadowView> atlasViews;
+			auto addAtlasView = [this, &atlasViews](uint64_t key, const glm::mat4& lightProj, const glm::mat4& lightView, const glm::vec3& camPos, renderlayer_t layers) {
+				auto it = shadowAtlasEntries.find(key);
+				if (it != shadowAtlasEntries.end() && it->second.tile.IsValid()) {
+					atlasViews.push_back({ lightProj, lightView, camPos, layers, &it->second });
+				}
 			};
-		};
+			auto& spotLights = worldOwning->renderData.spotLightData;
+			for (uint32_t i = 0; i < spotLights.DenseSize(); i++) {
+				const auto& light = spotLights.GetAtDenseIndex(i);
+				if (!light.castsShadows) {
+					continue;
+				}
+				const auto sparseIdx = spotLights.GetSparseIndexForDense(i);
+				auto& origLight = Entity({ sparseIdx, worldOwning->VersionForEntity(sparseIdx) }, worldOwning.get()).GetComponent<SpotLight>();
+				addAtlasView(ShadowAtlasKey(sparseIdx, spotLightAtlasFace), origLight.CalcProjectionMatrix(), origLight.CalcViewMatrix(light.worldTransform), glm::vec3(light.worldTransform[3]), light.shadowLayers);
+			}
+			auto& pointLights = worldOwning->renderData.pointLightData;
+			for (uint32_t i = 0; i < pointLights.DenseSize(); i++) {
+				const auto& light = pointLights.GetAtDenseIndex(i);
+				if (!light.castsShadows) {
+					continue;
+				}
+				const auto sparseIdx = pointLights.GetSparseIndexForDense(i);
+				const auto lightProj = Entity({ sparseIdx, worldOwning->VersionForEntity(sparseIdx) }, worldOwning.get()).GetComponent<PointLight>().CalcProjectionMatrix();
+				for (uint8_t face = 0; face < 6; face++) {
+					addAtlasView(ShadowAtlasKey(sparseIdx, face), lightProj, PointLight::CalcViewMatrix(light.position, face), light.position, light.shadowLayers);
+				}
+			}
 
-		renderLightShadowmap(worldOwning->renderData.pointLightData, 6,
-			pointLightShadowmapFunction,
-			[this](Entity owner) {
-				auto& origLight = owner.GetComponent<PointLight>();
-				for (uint32_t i = 0; i < 6; i++) {
+			if (!atlasViews.empty()) {
+				mainCommandBuffer->BeginRenderDebugMarker("Render shadow atlas");
+				// tiles are culled in batches of maxCullViews
+				auto renderTiles = [this, &renderFromPerspective, &renderShadowViewBatch](std::span<AtlasShadowView* const> views, LightingType casters) {
+					for (uint32_t first = 0; first < views.size(); first += maxCullViews) {
+						const auto batch = views.subspan(first, std::min<size_t>(maxCullViews, views.size() - first));
+						Array<CullingView, maxCullViews> cullViews;
+						for (uint32_t i = 0; i < batch.size(); i++) {
+							cullViews[i] = { batch[i]->lightProj * batch[i]->lightView, batch[i]->camPos, batch[i]->layers };
+						}
+						renderShadowViewBatch({ cullViews.data(), batch.size() }, [&](auto runCulling, uint32_t i, const MultiViewCull* multiView) {
+							const auto& view = *batch[i];
+							const auto& tile = view.entry->tile;
+							renderFromPerspective.template operator()<false, false, decltype(runCulling)::value>(cullViews[i].viewProj, view.lightView, view.lightProj, view.camPos, {}, shadowRenderPassLoad, [](auto&& mat) {
+								return mat->GetShadowRenderPipeline();
+							}, { tile.x, tile.y, tile.size, tile.size }, casters, shadowPlaceholderPyramid, view.layers, nullptr, nullptr, multiView);
+						});
+					}
+				};
+				LightingType casters{ .Lit = true, .Unlit = true, .FilterLightBlockers = true, .Opaque = true, .SkipOcclusion = true };
+
+				if (cacheStaticShadows && !vramBudget.IsAtLeast(VRAMPressureLevel::StaticShadowCache)) {
+					if (!shadowAtlasStaticTexture) {
+						shadowAtlasStaticTexture = device->CreateTexture({
+							.usage = {.TransferSource = true, .DepthStencilAttachment = true },
+							.aspect = {.HasDepth = true },
+							.width = shadowAtlasSize,
+							.height = shadowAtlasSize,
+							.format = RGL::TextureFormat::D32SFloat,
+							.debugName = "Static Shadow Atlas"
+						});
+					}
+					// re-render the static layer of tiles that are new or moved, whose light moved, or whose static casters changed
+					const auto staticCastersKey = StaticShadowCastersKey(worldOwning.get());
+					FrameVector<AtlasShadowView*> staleViews;
+					for (auto& view : atlasViews) {
+						const auto& entry = *view.entry;
+						if (entry.staticCastersKey != staticCastersKey || entry.staticViewProj != view.lightProj * view.lightView || entry.staticLayers != view.layers) {
+							staleViews.push_back(&view);
+						}
+					}
+					if (!staleViews.empty()) {
+						mainCommandBuffer->BeginRenderDebugMarker("Render static shadow layers");
+						shadowRenderPassLoad->SetDepthAttachmentTexture(shadowAtlasStaticTexture->GetDefaultView());
+						mainCommandBuffer->BeginRendering(shadowRenderPassLoad);
+						mainCommandBuffer->BindRenderPipeline(shadowTileClearPipeline);
+						mainCommandBuffer->SetVertexBuffer(screenTriVerts);
+						for (const auto view : staleViews) {
+							const auto& tile = view->entry->tile;
+							mainCommandBuffer->SetViewport({ float(tile.x), float(tile.y), float(tile.size), float(tile.size) });
+							mainCommandBuffer->SetScissor({ tile.x, tile.y, tile.size, tile.size });
+							mainCommandBuffer->Draw(3);
+						}
+						mainCommandBuffer->EndRendering();
+
+						auto staticCasters = casters;
+						staticCasters.StaticCastersOnly = true;
+						renderTiles(staleViews, staticCasters);
+						for (const auto view : staleViews) {
+							auto& entry = *view->entry;
+							entry.staticCastersKey = staticCastersKey;
+							entry.staticViewProj = view->lightProj * view->lightView;
+							entry.staticLayers = view->layers;
+						}
+						mainCommandBuffer->EndRenderDebugMarker();
+					}
 					mainCommandBuffer->CopyTextureToTexture(
 						{
-							.texture = origLight.shadowData.cubeShadowmaps[i]->GetDefaultView(),
+							.texture = shadowAtlasStaticTexture->GetDefaultView(),
 							.mip = 0,
 							.layer = 0
 						},
 						{
-							.texture = origLight.shadowData.mapCube->GetDefaultView(),
+							.texture = shadowAtlasTexture->GetDefaultView(),
 							.mip = 0,
-							.layer = i
+							.layer = 0
 						}
 					);
+					casters.DynamicCastersOnly = true;
+				}
+				else {
+					if (shadowAtlasStaticTexture) {
+						gcTextures.enqueue(shadowAtlasStaticTexture);
+						shadowAtlasStaticTexture = nullptr;
+						for (auto& [key, entry] : shadowAtlasEntries) {
+							entry.staticCastersKey = 0;
+						}
+					}
+					// clear the whole atlas once, instead of per tile
+					shadowRenderPass->SetDepthAttachmentTexture(shadowAtlasTexture->GetDefaultView());
+					mainCommandBuffer->BeginRendering(shadowRenderPass);
+					mainCommandBuffer->EndRendering();
 				}
-            },
-        [](uint32_t i, auto&& entity){ return true;}
-        );
-		RVE_PROFILE_SECTION_END(encode_point_shadows);
+
+				shadowRenderPassLoad->SetDepthAttachmentTexture(shadowAtlasTexture->GetDefaultView());
+				FrameVector<AtlasShadowView*> allViews;
+				allViews.reserve(atlasViews.size());
+				for (auto& view : atlasViews) {
+					allViews.push_back(&view);
+				}
+				renderTiles(allViews, casters);
+				mainCommandBuffer->EndRenderDebugMarker();
+			}
+		}
+		RVE_PROFILE_SECTION_END(encode_atlas_shadows);
 		RVE_PROFILE_SECTION_END(encode_shadowmaps);
 
+		// depthScale is the render scale the depth texture was drawn at. The pyramid always covers the part that was drawn to.
+		auto generatePyramid = [this](const DepthPyramid& depthPyramid, RGLTexturePtr depthStencil, float depthScale) {
+#ifndef OCCLUSION_CULLING_UNAVAILABLE
+			RVE_PROFILE_FN_N("generatePyramid");
+			// build the depth pyramid from the current contents of the depth texture
+			depthPyramidCopyPass->SetAttachmentTexture(0, depthPyramid.pyramidTexture->GetViewForMip(0));
+			mainCommandBuffer->BeginRendering(depthPyramidCopyPass);
+			mainCommandBuffer->BeginRenderDebugMarker("First copy of depth pyramid");
+			mainCommandBuffer->BindRenderPipeline(depthPyramidCopyPipeline);
+			mainCommandBuffer->SetViewport({ 0,0,float(depthPyramid.dim) ,float(depthPyramid.dim) });
+			mainCommandBuffer->SetScissor({ 0,0,depthPyramid.dim,depthPyramid.dim });
+			PyramidCopyUBO pubo{ .size = depthPyramid.dim, .uvScale = depthScale };
+			mainCommandBuffer->SetFragmentBytes(pubo, 0);
+			mainCommandBuffer->SetFragmentTexture(depthStencil->GetDefaultView(), 0);
+			mainCommandBuffer->SetFragmentSampler(depthPyramidSampler, 1);
+			mainCommandBuffer->SetVertexBuffer(screenTriVerts);
+			mainCommandBuffer->Draw(3);
+			mainCommandBuffer->EndRenderDebugMarker();
+			mainCommandBuffer->EndRendering();
+
+			mainCommandBuffer->BeginCompute(depthPyramidPipeline);
+			mainCommandBuffer->BeginComputeDebugMarker("Build depth pyramid");
+
+			{
+				float dim = depthPyramid.dim;
+				for (int i = 0; i < depthPyramid.numLevels - 1; i++) {
+					auto fromTex = depthPyramid.pyramidTexture->GetViewForMip(i);
+					auto toTex = depthPyramid.pyramidTexture->GetViewForMip(i + 1);
+					mainCommandBuffer->SetComputeTexture(toTex, 0);
+					mainCommandBuffer->SetComputeTexture(fromTex, 1);
+					mainCommandBuffer->SetComputeSampler(depthPyramidSampler, 2);
+
+					dim /= 2.0;
+
+					mainCommandBuffer->DispatchCompute(std::ceil(dim / 32.f), std::ceil(dim / 32.f), 1, 32, 32, 1);
+				}
+			}
+			mainCommandBuffer->EndComputeDebugMarker();
+			mainCommandBuffer->EndCompute();
+#endif
+		};
+
 		RVE_PROFILE_SECTION(allViews, "Render Encode All Views");
 		for (const auto& view : screenTargets) {
+			const auto viewFirstCamIdx = camIdx;
 			currentRenderSize = view.pixelDimensions;
+			// the scene passes draw into the top left of the targets at this size, and the tonemap pass scales it up to the output
 			auto nextImgSize = view.pixelDimensions;
+			nextImgSize.width = std::max(1, int(nextImgSize.width * renderScale));
+			nextImgSize.height = std::max(1, int(nextImgSize.height * renderScale));
 			auto& target = view.collection;
 
-            auto renderLitPass_Impl = [this,&target, &renderFromPerspective,&renderLightShadowmap,&worldOwning, &camIdx]<bool transparentMode = false>(auto&& camData, auto&& fullSizeViewport, auto&& fullSizeScissor, auto&& renderArea) {
+			// views that cannot draw anything transparent skip clearing, accumulating and applying it
+			bool viewHasTransparency = false;
+			for (const auto& camData : view.camDatas) {
+				viewHasTransparency = viewHasTransparency || (camData.features.transparency && CameraHasTransparency(worldOwning.get(), camData.layers, camData.viewProj));
+			}
+
+            auto renderLitPass_Impl = [this,&target, &view, &renderFromPerspective,&renderLightShadowmap,&worldOwning, &camIdx, &generatePyramid, viewFirstCamIdx, &nextImgSize, skybox, skyCached]<bool transparentMode = false>(auto&& camData, auto&& fullSizeViewport, auto&& fullSizeScissor, auto&& renderArea) {
+				// the eyes of a stereo pair are culled in one dispatch, and share the left eye's directional shadowmaps
+				const bool isStereo = view.stereo && view.camDatas.size() == 2;
+				const uint32_t eyeIndex = camIdx - viewFirstCamIdx;
+				Array<CullingView, 2> stereoViews;
+				if (isStereo) {
+					for (uint32_t eye = 0; eye < stereoViews.size(); eye++) {
+						const auto& eyeData = view.camDatas[eye];
+						stereoViews[eye] = { eyeData.viewProj, eyeData.camPos, eyeData.layers };
+					}
+				}
+				const MultiViewCull stereoCull{ stereoViews, isStereo ? eyeIndex : 0 };
+
 				// directional light shadowmaps
                 
 
@@ -1662,7 +2760,6 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
                             .lightProj = hostdata[camIdx + denseIdx].lightProj[index],
                             .lightView = hostdata[camIdx + denseIdx].lightview[index],
 							.camPos = camData.camPos,
-							.depthPyramid = origLight.shadowData.pyramid[index],
 							.shadowmapTexture = origLight.shadowData.shadowMap[index],
 						};
                     };
@@ -1670,11 +2767,14 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					renderLightShadowmap(worldOwning->renderData.directionalLightData, MAX_CASCADES,
 						dirlightShadowmapDataFunction,
 						[](Entity unused) {},
-                         [](uint32_t index, const Entity& owner){
+                         [&camData, isStereo, eyeIndex](uint32_t index, const Entity& owner){
                             auto& origLight = owner.GetComponent<DirectionalLight>();
-                            if (index >= origLight.numCascades ){
+                            if (index >= origLight.numCascades || index >= camData.features.maxShadowCascades){
                                 return false;     // only render the requested number of cascades
                             }
+                            if (isStereo && eyeIndex > 0){
+                                return false;     // the left eye's cascades cover both eyes
+                            }
                             return true;
                         }
 					);
@@ -1683,17 +2783,120 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 					// render depth prepass
 					mainCommandBuffer->BeginRenderDebugMarker("Lit Opaque Depth Prepass");
-					renderFromPerspective.template operator() < true, transparentMode, true > (camData.viewProj, camData.viewOnly, camData.projOnly, camData.camPos, camData.zNearFar, depthPrepassRenderPass, [](auto&& mat) {
-						return mat->GetDepthPrepassPipeline();
-						}, renderArea, { .Lit = true, .Transparent = transparentMode, .Opaque = !transparentMode, }, target.depthPyramid, camData.layers, &target);
+					auto renderDepthPrepass = [&](const TwoPhaseCullState* twoPhaseCull) {
+						renderFromPerspective.template operator() < true, transparentMode, true > (camData.viewProj, camData.viewOnly, camData.projOnly, camData.camPos, camData.zNearFar, depthPrepassRenderPass, [](auto&& mat) {
+							return mat->GetDepthPrepassPipeline();
+							}, renderArea, { .Lit = true, .Transparent = transparentMode, .Opaque = !transparentMode, }, target.depthPyramid, camData.layers, &target, twoPhaseCull);
+					};
+					if (isStereo) {
+						// the left eye culls both eyes without occlusion, and the right eye draws its slice of that result
+						constexpr LightingType stereoFilter{ .Lit = true, .Opaque = true, .SkipOcclusion = true };
+						auto pipelineSelector = [](auto&& mat) {
+							return mat->GetDepthPrepassPipeline();
+						};
+						if (eyeIndex == 0) {
+							renderFromPerspective.template operator() < true, false, true > (camData.viewProj, camData.viewOnly, camData.projOnly, camData.camPos, camData.zNearFar, depthPrepassRenderPass, pipelineSelector, renderArea, stereoFilter, target.depthPyramid, camData.layers, &target, nullptr, &stereoCull);
+						}
+						else {
+							renderFromPerspective.template operator() < true, false, false > (camData.viewProj, camData.viewOnly, camData.projOnly, camData.camPos, camData.zNearFar, depthPrepassRenderPass, pipelineSelector, renderArea, stereoFilter, target.depthPyramid, camData.layers, &target, nullptr, &stereoCull);
+						}
+					}
+					else
+#ifndef OCCLUSION_CULLING_UNAVAILABLE
+					if (twoPhaseOcclusionCulling && target.occlusionHistory) {
+						auto& history = *target.occlusionHistory;
+						const auto viewCamIdx = camIdx - viewFirstCamIdx;
+						if (history.viewProjs.size() <= viewCamIdx) {
+							history.viewProjs.resize(viewCamIdx + 1, camData.viewProj);
+						}
+						// a new buffer holds no history, which costs at most one frame of culling
+						const auto nEntities = uint32_t(worldOwning->renderData.worldTransforms.GetPrivateBuffer()->getBufferSize() / sizeof(matrix4));
+						if (history.visibilityBuffer == nullptr || history.visibilityBuffer->getBufferSize() < nEntities * sizeof(uint32_t)) {
+							if (history.visibilityBuffer) {
+								gcBuffers.enqueue(history.visibilityBuffer);
+							}
+							history.visibilityBuffer = device->CreateBuffer({
+								nEntities,
+								{.StorageBuffer = true},
+								sizeof(uint32_t),
+								RGL::BufferAccess::Private,
+								{.Writable = true, .debugName = "Occlusion Visibility Buffer"}
+							});
+						}
+
+						TwoPhaseCullState cullState{
+							.phase = CullPhase::VisibleLastFrame,
+							.prevViewProj = WriteTransient(history.viewProjs[viewCamIdx]),
+							.visibilityBuffer = history.visibilityBuffer,
+						};
+						renderDepthPrepass(&cullState);
+
+						// rebuild the pyramid from what was visible last frame, and test everything else against it
+						generatePyramid(target.depthPyramid, target.depthStencil, renderScale);
+						cullState.phase = CullPhase::Remaining;
+						renderDepthPrepass(&cullState);
+
+						history.viewProjs[viewCamIdx] = camData.viewProj;
+					}
+					else
+#endif
+					{
+						renderDepthPrepass(nullptr);
+					}
 					mainCommandBuffer->EndRenderDebugMarker();
+
+					// the depth range of each tile of the cluster grid, so the lit pass's light binning skips the empty clusters
+					if (worldOwning->renderData.pointLightData.DenseSize() > 0 || worldOwning->renderData.spotLightData.DenseSize() > 0) {
+						ClusterDepthBoundsUBO dubo{
+							.invProj = glm::inverse(camData.projOnly),
+							.viewportOffset = { uint32_t(renderArea.offset[0]), uint32_t(renderArea.offset[1]) },
+							.viewportSize = { renderArea.extent[0], renderArea.extent[1] },
+							.gridSize = { Clustered::gridSizeX, Clustered::gridSizeY },
+						};
+						mainCommandBuffer->BeginCompute(clusterDepthBoundsPipeline);
+						mainCommandBuffer->BeginComputeDebugMarker("Cluster Depth Bounds");
+						mainCommandBuffer->SetComputeTexture(target.depthStencil->GetDefaultView(), 0);
+						mainCommandBuffer->BindComputeBuffer(clusterTileDepthBuffer, 1);
+						mainCommandBuffer->SetComputeBytes(dubo, 0);
+						mainCommandBuffer->DispatchCompute(Clustered::gridSizeX, Clustered::gridSizeY, 1, 16, 16, 1);
+						mainCommandBuffer->EndComputeDebugMarker();
+						mainCommandBuffer->EndCompute();
+						clusterTileDepthValid = true;
+					}
+				}
+
+				// the shading rates of this camera's tiles, which the transparent pass reuses
+				if (!transparentMode && target.shadingRateTexture) {
+					const auto& foveation = camData.foveation;
+					const glm::uvec2 areaStart{ renderArea.offset[0], renderArea.offset[1] };
+					const glm::uvec2 areaEnd = areaStart + glm::uvec2{ renderArea.extent[0], renderArea.extent[1] };
+					const glm::uvec2 firstTile = areaStart / shadingRateTileSize;
+					const glm::uvec2 endTile = (areaEnd + shadingRateTileSize - 1u) / shadingRateTileSize;
+					const glm::vec2 areaSize{ renderArea.extent[0], renderArea.extent[1] };
+					const float tileSize = shadingRateTileSize;
+					ShadingRateUBO subo{
+						.tileOffset = firstTile,
+						.tileCount = endTile - firstTile,
+						.center = (glm::vec2(areaStart) + areaSize * foveation.center) / tileSize - glm::vec2(firstTile),
+						.innerRadius = areaSize.y * foveation.innerRadius / tileSize,
+						.outerRadius = areaSize.y * foveation.outerRadius / tileSize,
+						.enabled = foveation.enabled,
+					};
+					mainCommandBuffer->BeginCompute(shadingRatePipeline);
+					mainCommandBuffer->BeginComputeDebugMarker("Shading Rates");
+					mainCommandBuffer->SetComputeTexture(target.shadingRateTexture->GetDefaultView(), 0);
+					mainCommandBuffer->SetComputeBytes(subo, 0);
+					mainCommandBuffer->DispatchCompute(std::ceil(subo.tileCount.x / 32.f), std::ceil(subo.tileCount.y / 32.f), 1, 32, 32, 1);
+					mainCommandBuffer->EndComputeDebugMarker();
+					mainCommandBuffer->EndCompute();
 				}
 
 				// render with shading
 
 				renderFromPerspective.template operator()<true, transparentMode, transparentMode>(camData.viewProj, camData.viewOnly, camData.projOnly, camData.camPos, camData.zNearFar, transparentMode ? litTransparentPass : litRenderPass, [](auto&& mat) {
 					return mat->GetMainRenderPipeline();
-                }, renderArea, {.Lit = true, .Transparent = transparentMode, .Opaque = !transparentMode, }, target.depthPyramid, camData.layers, &target);
+                }, renderArea, {.Lit = true, .Transparent = transparentMode, .Opaque = !transparentMode, .SkipOcclusion = isStereo }, target.depthPyramid, camData.layers, &target, nullptr, (isStereo && !transparentMode) ? &stereoCull : nullptr);
+				clusterTileDepthValid = false;
 
 				if (!transparentMode) {
 					if (camData.indirectSettings.SSAOEnabled || camData.indirectSettings.SSGIEnabled) {
@@ -1701,10 +2904,31 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 							return std::pow(2, mip);
 							};
 						const auto size = target.ssgiOutputTexture->GetSize();
+						const uint32_t numMips = std::min<uint32_t>(std::log2(std::min(size.width, size.height)), maxssgimips);
+
+						// reduced resolutions trace further down the mip chain, and make up for it by accumulating frames
+						uint32_t traceMip = 1;
+						switch (camData.indirectSettings.resolution) {
+						case IndirectLightingResolution::Full:
+							break;
+						case IndirectLightingResolution::Half:
+							traceMip = 2;
+							break;
+						case IndirectLightingResolution::Quarter:
+							traceMip = 3;
+							break;
+						}
+						traceMip = std::max(1u, std::min(traceMip, numMips - 1));
+						const bool temporal = traceMip > 1 && target.indirectLightingHistory;
+
+						// only the part of the traced mip that covers the rendered scene is traced
+						const auto traceDivFac = divFacForMip(traceMip);
+						const glm::ivec2 traceDim{ std::max(1, int(nextImgSize.width / traceDivFac)), std::max(1, int(nextImgSize.height / traceDivFac)) };
+						const auto traceUVScale = glm::vec2(traceDim) / glm::vec2(size.width / traceDivFac, size.height / traceDivFac);
 
 						mainCommandBuffer->BeginRenderDebugMarker("SSGI");
 						{
-							ssgiPassClear->SetAttachmentTexture(0, target.ssgiOutputTexture->GetViewForMip(1));	// not rendering to base mip
+							ssgiPassClear->SetAttachmentTexture(0, target.ssgiOutputTexture->GetViewForMip(traceMip));	// not rendering to base mip
 							ssgiPassClear->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
 							ssgiPassNoClear->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
 
@@ -1715,29 +2939,132 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 							mainCommandBuffer->SetFragmentTexture(target.viewSpaceNormalsTexture->GetDefaultView(), 2);
 							mainCommandBuffer->SetFragmentTexture(target.radianceTexture->GetDefaultView(), 3);
 
-							const auto divFac = divFacForMip(1);
 							{
 								SSGIUBO ssgiubo{
 									.projection = camData.projOnly,
 									.invProj = glm::inverse(camData.projOnly),
-									.outputDim = {size.width / divFac, size.height / divFac},
+									.outputDim = traceDim,
 									.sampleCount = 4,
 									.sampleRadius = 4.0,
 									.sliceCount = 4,
 									.hitThickness = 0.5,
+									.uvScale = traceUVScale,
+									.noiseOffset = temporal ? float(frameCount % 64) * 0.618034f : 0,
 								};
+								mainCommandBuffer->SetViewport({ 0, 0, float(traceDim.x), float(traceDim.y) });
+								mainCommandBuffer->SetScissor({ .offset = { 0, 0 }, .extent = { uint32_t(traceDim.x), uint32_t(traceDim.y) } });
 								mainCommandBuffer->SetFragmentBytes(ssgiubo, 0);
 							}
 
 							mainCommandBuffer->SetVertexBuffer(screenTriVerts);
 							mainCommandBuffer->Draw(3);
 							mainCommandBuffer->EndRendering();
+
+							// the passes below draw with the scene's viewport
+							mainCommandBuffer->SetViewport({
+								.x = float(renderArea.offset[0]),
+								.y = float(renderArea.offset[1]),
+								.width = float(renderArea.extent[0]),
+								.height = float(renderArea.extent[1]),
+							});
+							mainCommandBuffer->SetScissor(renderArea);
 						}
 
 
+						// blend the trace into the history, which stands in for the traced mip from here on
+						RGLTexturePtr accumulated;
+						if (temporal) {
+							auto& views = target.indirectLightingHistory->views;
+							const auto viewCamIdx = camIdx - viewFirstCamIdx;
+							if (views.size() <= viewCamIdx) {
+								views.resize(viewCamIdx + 1);
+							}
+							auto& history = views[viewCamIdx];
+
+							const uint32_t historyWidth = std::max(1u, size.width >> traceMip), historyHeight = std::max(1u, size.height >> traceMip);
+							bool historyValid = history.lastFrame + 1 == frameCount;
+							if (history.color[0] == nullptr || history.color[0]->GetSize().width != historyWidth || history.color[0]->GetSize().height != historyHeight) {
+								for (uint8_t i = 0; i < 2; i++) {
+									gcTextures.enqueue(history.color[i]);
+									gcTextures.enqueue(history.depth[i]);
+									history.color[i] = device->CreateTexture({
+										.usage = {.Sampled = true, .ColorAttachment = true },
+										.aspect = {.HasColor = true },
+										.width = historyWidth,
+										.height = historyHeight,
+										.format = ssgiOutputFormat,
+										.initialLayout = RGL::ResourceLayout::Undefined,
+										.debugName = "Indirect Lighting History"
+									});
+									history.depth[i] = device->CreateTexture({
+										.usage = {.Sampled = true, .ColorAttachment = true },
+										.aspect = {.HasColor = true },
+										.width = historyWidth,
+										.height = historyHeight,
+										.format = indirectLightingHistoryDepthFormat,
+										.initialLayout = RGL::ResourceLayout::Undefined,
+										.debugName = "Indirect Lighting History Depth"
+									});
+								}
+								historyValid = false;
+							}
+
+							const auto prev = history.current;
+							history.current = 1 - history.current;
+
+							mainCommandBuffer->BeginRenderDebugMarker("Accumulate");
+							ssgiTemporalPass->SetAttachmentTexture(0, history.color[history.current]->GetDefaultView());
+							ssgiTemporalPass->SetAttachmentTexture(1, history.depth[history.current]->GetDefaultView());
+							mainCommandBuffer->BeginRendering(ssgiTemporalPass);
+							mainCommandBuffer->BindRenderPipeline(ssgiTemporalPipeline);
+							mainCommandBuffer->SetFragmentSampler(textureSampler, 0);
+							mainCommandBuffer->SetFragmentTexture(target.ssgiOutputTexture->GetViewForMip(traceMip), 1);
+							mainCommandBuffer->SetFragmentTexture(history.color[prev]->GetDefaultView(), 2);
+							mainCommandBuffer->SetFragmentTexture(history.depth[prev]->GetDefaultView(), 3);
+							mainCommandBuffer->SetFragmentTexture(target.depthStencil->GetDefaultView(), 4);
+
+							SSGITemporalUBO ubo{
+								.invProj = glm::inverse(camData.projOnly),
+								.currentToPrevView = history.viewOnly * glm::inverse(camData.viewOnly),
+								.prevProj = history.projOnly,
+								.outputDim = traceDim,
+								.uvScale = traceUVScale,
+								.prevUVScale = history.uvScale,
+								.currentWeight = 0.1,
+								.historyValid = historyValid,
+							};
+							mainCommandBuffer->SetFragmentBytes(ubo, 0);
+							mainCommandBuffer->SetViewport({ 0, 0, float(traceDim.x), float(traceDim.y) });
+							mainCommandBuffer->SetScissor({ .offset = { 0, 0 }, .extent = { uint32_t(traceDim.x), uint32_t(traceDim.y) } });
+
+							mainCommandBuffer->SetVertexBuffer(screenTriVerts);
+							mainCommandBuffer->Draw(3);
+							mainCommandBuffer->EndRendering();
+							mainCommandBuffer->EndRenderDebugMarker();
+
+							mainCommandBuffer->SetViewport({
+								.x = float(renderArea.offset[0]),
+								.y = float(renderArea.offset[1]),
+								.width = float(renderArea.extent[0]),
+								.height = float(renderArea.extent[1]),
+							});
+							mainCommandBuffer->SetScissor(renderArea);
+
+							history.viewOnly = camData.viewOnly;
+							history.projOnly = camData.projOnly;
+							history.uvScale = traceUVScale;
+							history.lastFrame = frameCount;
+							accumulated = history.color[history.current];
+						}
+						auto ssgiMipView = [&](uint32_t mip) {
+							return accumulated && mip == traceMip ? accumulated->GetDefaultView() : target.ssgiOutputTexture->GetViewForMip(mip);
+						};
+						// AO is blurred from mip 2 at the least
+						const uint32_t aoStartMip = std::max(traceMip, 2u);
+
 						// dealing with the results
 						// first, downsample AO and GI one step
-						{
+						if (traceMip < aoStartMip) {
 							ssgiPassClear->SetAttachmentTexture(0, target.ssgiOutputTexture->GetViewForMip(2));
 
 							mainCommandBuffer->BeginRendering(ssgiPassClear);
@@ -1762,19 +3089,22 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 						if (camData.indirectSettings.SSAOEnabled)
 						{
 							mainCommandBuffer->BeginRenderDebugMarker("Upsample AO");
-							for (int i = 2; i >= 1; i--) {
+							for (int i = aoStartMip; i >= 1; i--) {
 								ssgiPassNoClear->SetAttachmentTexture(0, target.ssgiOutputTexture->GetViewForMip(i - 1));
 
 								mainCommandBuffer->BeginRendering(ssgiPassNoClear);
 								mainCommandBuffer->BindRenderPipeline(aoUpsamplePipeline);
 								mainCommandBuffer->SetFragmentSampler(textureSampler, 1);
-								mainCommandBuffer->SetFragmentTexture(target.ssgiOutputTexture->GetViewForMip(i), 0);
+								mainCommandBuffer->SetFragmentTexture(ssgiMipView(i), 0);
+								mainCommandBuffer->SetFragmentTexture(target.depthStencil->GetDefaultView(), 2);
 
 								const auto divFac = divFacForMip(i - 1);
 
+								// coarser traces would smear AO across edges without the depth weights
 								UpsampleUBO ubo{
 									.targetDim = {0,0,size.width / divFac, size.height / divFac},
-									.filterRadius = 0.005
+									.filterRadius = 0.005,
+									.depthSensitivity = temporal ? 16.f : 0.f,
 								};
 								mainCommandBuffer->SetFragmentBytes(ubo, 0);
 
@@ -1790,14 +3120,13 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 						// downscale AO + GI the rest of the way upscale 
 						if (camData.indirectSettings.SSGIEnabled) {
 							mainCommandBuffer->BeginRenderDebugMarker("Downsample");
-							const uint32_t numMips = std::min<uint32_t>(std::log2(std::min(size.width, size.height)), maxssgimips);
-							for (int i = 3; i < numMips; i++) {
+							for (int i = aoStartMip + 1; i < numMips; i++) {
 								ssgiPassClear->SetAttachmentTexture(0, target.ssgiOutputTexture->GetViewForMip(i));
 
 								mainCommandBuffer->BeginRendering(ssgiPassClear);
 								mainCommandBuffer->BindRenderPipeline(ssgiDownsamplePipeline);
 								mainCommandBuffer->SetFragmentSampler(textureSampler, 1);
-								mainCommandBuffer->SetFragmentTexture(target.ssgiOutputTexture->GetViewForMip(i - 1), 0);
+								mainCommandBuffer->SetFragmentTexture(ssgiMipView(i - 1), 0);
 
 								const auto divFac = divFacForMip(i);
 
@@ -1819,7 +3148,8 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 								mainCommandBuffer->BeginRendering(ssgiPassNoClear);
 								mainCommandBuffer->BindRenderPipeline(i == 1 ? ssgiUpsamplePipleineFinalStep : ssgiUpsamplePipeline);
 								mainCommandBuffer->SetFragmentSampler(textureSampler, 1);
-								mainCommandBuffer->SetFragmentTexture(target.ssgiOutputTexture->GetViewForMip(i), 0);
+								// the coarser mips are written by the previous steps, except for the trace if nothing was downsampled from it
+								mainCommandBuffer->SetFragmentTexture(i == numMips - 1 ? ssgiMipView(i) : target.ssgiOutputTexture->GetViewForMip(i), 0);
 
 								const auto divFac = divFacForMip(i - 1);
 
@@ -1851,8 +3181,12 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					mainCommandBuffer->SetFragmentTexture(target.lightingScratchTexture->GetDefaultView(), 1);	// albedo color
 					mainCommandBuffer->SetFragmentTexture(target.radianceTexture->GetDefaultView(), 2);
 					mainCommandBuffer->SetFragmentTexture(target.ssgiOutputTexture->GetDefaultView(), 3);
+					mainCommandBuffer->SetFragmentTexture(target.viewSpaceNormalsTexture->GetDefaultView(), 4);
+					// not read without a cached sky, but something must be bound
+					mainCommandBuffer->SetFragmentTexture(skyCached ? skybox->cache.irradiance->GetDefaultView() : target.ssgiOutputTexture->GetDefaultView(), 5);
 
 					AmbientSSGIApplyUBO ubo{
+						.invView = glm::inverse(camData.viewOnly),
 						.ambientLightCount = worldOwning->renderData.ambientLightData.DenseSize(),
 						.ssaoStrength = camData.indirectSettings.ssaoStrength,
 					};
@@ -1862,6 +3196,10 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					if (camData.indirectSettings.SSGIEnabled) {
 						ubo.options |= AmbientSSGIApplyUBO::SSGIBIT;
 					}
+					if (skyCached) {
+						ubo.options |= AmbientSSGIApplyUBO::SKYBIT;
+						ubo.skyIntensity = skybox->ambientIntensity;
+					}
 					mainCommandBuffer->SetFragmentBytes(ubo, 0);
 
 					mainCommandBuffer->BindBuffer(worldOwning->renderData.ambientLightData.GetPrivateBuffer(), 10);
@@ -1893,42 +3231,55 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 			};
 
 			auto renderLitPassTransparent = [&renderLitPass_Impl](auto&& camData, auto&& fullSizeViewport, auto&& fullSizeScissor, auto&& renderArea) {
+				if (!camData.features.transparency) {
+					return;
+				}
 				renderLitPass_Impl.template operator()<true>(camData, fullSizeViewport, fullSizeScissor, renderArea);
 			};
 
-            auto renderFinalPass = [this, &target, &worldOwning, &view, &guiScaleFactor, &nextImgSize, &renderFromPerspective](auto&& camData, auto&& fullSizeViewport, auto&& fullSizeScissor, auto&& renderArea) {
-               
+            uint32_t finalPassCamIdx = 0;	// within the view
+            auto renderFinalPass = [this, &target, &worldOwning, &worldTransformBuffer, &view, &guiScaleFactor, &nextImgSize, &renderFromPerspective, &finalPassCamIdx, skybox, skyCached, viewHasTransparency](auto&& camData, auto&& fullSizeViewport, auto&& fullSizeScissor, auto&& renderArea) {
+				const bool drawTransparency = camData.features.transparency && viewHasTransparency;
 
 				// render unlits with transparency
-				RVE_PROFILE_SECTION(unlittrans, "Encode Unlit Transparents");
-				unlitTransparentPass->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
-				renderFromPerspective.template operator() < false, true > (camData.viewProj, camData.viewOnly, camData.projOnly, camData.camPos, {}, unlitTransparentPass, [](auto&& mat) {
-					return mat->GetMainRenderPipeline();
-				}, renderArea, { .Unlit = true, .Transparent = true }, target.depthPyramid, camData.layers,&target);
-				RVE_PROFILE_SECTION_END(unlittrans);
+				if (drawTransparency) {
+					RVE_PROFILE_SECTION(unlittrans, "Encode Unlit Transparents");
+					unlitTransparentPass->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
+					renderFromPerspective.template operator() < false, true > (camData.viewProj, camData.viewOnly, camData.projOnly, camData.camPos, {}, unlitTransparentPass, [](auto&& mat) {
+						return mat->GetMainRenderPipeline();
+					}, renderArea, { .Unlit = true, .Transparent = true }, target.depthPyramid, camData.layers,&target);
+					RVE_PROFILE_SECTION_END(unlittrans);
+				}
                 
                 // then do the skybox, if one is defined.
                 if (worldOwning->skybox && worldOwning->skybox->skyMat && worldOwning->skybox->skyMat->GetMat()->renderPipeline) {
-                    struct skyboxData{
-                        glm::mat3 invView;
-                        glm::vec3 camPos;
-                        float fov;
-                        float aspectRatio;
-                    } data {
+                    SkyboxData data {
                         glm::inverse(camData.viewOnly),
                         camData.camPos,
                         deg_to_rad(camData.fov),
                         float(fullSizeViewport.width) / float(fullSizeViewport.height)
                     };
                     
-                    auto transientOffset = WriteTransient(data);
+                    auto transientAllocation = WriteTransient(data);
                     
                     mainCommandBuffer->BeginRendering(unlitRenderPass);
                     mainCommandBuffer->BeginRenderDebugMarker("Skybox");
-                    mainCommandBuffer->SetViewport(fullSizeViewport);
-                    mainCommandBuffer->SetScissor(fullSizeScissor);
-                    mainCommandBuffer->BindRenderPipeline(worldOwning->skybox->skyMat->GetMat()->renderPipeline);
-                    mainCommandBuffer->BindBuffer(transientBuffer, 1, transientOffset);
+                    mainCommandBuffer->SetViewport({
+                        .x = float(renderArea.offset[0]),
+                        .y = float(renderArea.offset[1]),
+                        .width = float(renderArea.extent[0]),
+                        .height = float(renderArea.extent[1]),
+                    });
+                    mainCommandBuffer->SetScissor(renderArea);
+                    if (skyCached) {
+                        mainCommandBuffer->BindRenderPipeline(skyCachePipeline);
+                        mainCommandBuffer->SetFragmentSampler(textureSampler, 0);
+                        mainCommandBuffer->SetFragmentTexture(skybox->cache.faces->GetDefaultView(), 2);
+                    }
+                    else {
+                        mainCommandBuffer->BindRenderPipeline(worldOwning->skybox->skyMat->GetMat()->renderPipeline);
+                    }
+                    mainCommandBuffer->BindBuffer(transientAllocation.buffer, 1, transientAllocation.offset);
                     mainCommandBuffer->SetVertexBuffer(screenTriVerts);
                     mainCommandBuffer->Draw(3);
                     mainCommandBuffer->EndRenderDebugMarker();
@@ -1936,40 +3287,135 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
                 }
 
 
-				// apply transparency
+				const bool upscaled = VideoSettings.temporalUpscaling && target.temporalUpscalingHistory;
+
+				// the built-in effects at the end of the stack can be applied in one compute pass, see VideoSettings::fusedPostProcessing
+				const PostProcessEffect* fusedBloom = nullptr, *fusedFXAA = nullptr;
+				bool fuseTransparency = false;
+				if (VideoSettings.fusedPostProcessing) {
+					Vector<const PostProcessEffect*> enabledEffects;
+					for (const auto& effect : camData.postProcessingEffects->effects) {
+						if (effect->enabled) {
+							enabledEffects.push_back(effect.get());
+						}
+					}
+					if (!enabledEffects.empty() && enabledEffects.back()->fusedStep == FusedScreenEffect::FXAA) {
+						fusedFXAA = enabledEffects.back();
+						enabledEffects.pop_back();
+					}
+					if (!enabledEffects.empty() && enabledEffects.back()->fusedStep == FusedScreenEffect::BloomApply) {
+						fusedBloom = enabledEffects.back();
+						enabledEffects.pop_back();
+					}
+					// the transparency must be resolved before any pass reads the color, and the bloom mip chain reads it, as does temporal upscaling
+					fuseTransparency = fusedFXAA && !fusedBloom && enabledEffects.empty() && drawTransparency && !upscaled;
+				}
 
-				transparencyApplyPass->SetAttachmentTexture(0, target.lightingTexture->GetDefaultView());
+				// apply transparency
+				if (drawTransparency && !fuseTransparency) {
+					transparencyApplyPass->SetAttachmentTexture(0, target.lightingTexture->GetDefaultView());
 
-				mainCommandBuffer->BeginRenderDebugMarker("Apply All Transparency");
-				mainCommandBuffer->BeginRendering(transparencyApplyPass);
+					mainCommandBuffer->BeginRenderDebugMarker("Apply All Transparency");
+					mainCommandBuffer->BeginRendering(transparencyApplyPass);
 
-				mainCommandBuffer->BindRenderPipeline(transparencyApplyPipeline);
+					mainCommandBuffer->BindRenderPipeline(transparencyApplyPipeline);
                 
-                for(const auto& [i, tx] : Enumerate(target.mlabAccum)){
-                    mainCommandBuffer->SetFragmentTexture(tx->GetDefaultView(), i);
-                }
+					for(const auto& [i, tx] : Enumerate(target.mlabAccum)){
+						mainCommandBuffer->SetFragmentTexture(tx->GetDefaultView(), i);
+					}
                 
-				mainCommandBuffer->SetVertexBuffer(screenTriVerts);
-				mainCommandBuffer->Draw(3);
+					mainCommandBuffer->SetVertexBuffer(screenTriVerts);
+					mainCommandBuffer->Draw(3);
 
-				mainCommandBuffer->EndRendering();
-				mainCommandBuffer->EndRenderDebugMarker();
+					mainCommandBuffer->EndRendering();
+					mainCommandBuffer->EndRenderDebugMarker();
+				}
+
+                RGL::TextureView currentInput = target.lightingTexture->GetDefaultView();
+                RGL::TextureView altInput = target.lightingScratchTexture->GetDefaultView();
+
+				// reconstruct the output resolution from the jittered render area and the history, see VideoSettings::temporalUpscaling.
+				// Everything after this works at the output resolution
+				const auto unjitteredViewProj = JitterMatrix(-camData.jitter, renderArea) * camData.viewProj;
+				if (upscaled) {
+					RVE_PROFILE_SECTION(taa, "Encode Temporal Upscaling");
+					auto& history = *target.temporalUpscalingHistory;
+					if (history.views.size() <= finalPassCamIdx) {
+						history.views.resize(finalPassCamIdx + 1);
+					}
+					auto& historyView = history.views[finalPassCamIdx];
+
+					const auto size = target.lightingTexture->GetSize();
+					bool historyValid = historyView.lastFrame + 1 == frameCount;
+					if (history.color[0] == nullptr || history.color[0]->GetSize().width != size.width || history.color[0]->GetSize().height != size.height) {
+						for (auto& tx : history.color) {
+							gcTextures.enqueue(tx);
+							tx = device->CreateTexture({
+								.usage = {.Sampled = true, .Storage = true },
+								.aspect = {.HasColor = true },
+								.width = size.width,
+								.height = size.height,
+								.format = colorTexFormat,
+								.initialLayout = RGL::ResourceLayout::Undefined,
+								.debugName = "Temporal Upscaling History"
+							});
+						}
+						for (auto& other : history.views) {
+							other.lastFrame = 0;
+						}
+						historyValid = false;
+					}
+					// the cameras of a view share the textures, so they swap once per frame
+					if (finalPassCamIdx == 0) {
+						history.current ^= 1;
+					}
 
+					const bool objectMotion = prevWorldTransforms && prevWorldTransformsWorld == worldOwning.get() && prevWorldTransformsFrame + 1 == frameCount && prevWorldTransforms->getBufferSize() == worldTransformBuffer->getBufferSize();
+
+					TemporalUpscaleUBO ubo{
+						.invViewProj = glm::inverse(camData.viewProj),
+						.prevViewProj = historyValid ? historyView.viewProj : unjitteredViewProj,
+						.inputRect = { renderArea.offset[0], renderArea.offset[1], renderArea.extent[0], renderArea.extent[1] },
+						.outputRect = { int(fullSizeViewport.x), int(fullSizeViewport.y), int(fullSizeViewport.width), int(fullSizeViewport.height) },
+						.jitter = camData.jitter,
+						.options = (historyValid ? TemporalUpscaleUBO::HISTORYBIT : 0) | (objectMotion ? TemporalUpscaleUBO::OBJECTMOTIONBIT : 0),
+					};
+					mainCommandBuffer->BeginCompute(temporalUpscalePipeline);
+					mainCommandBuffer->BeginComputeDebugMarker("Temporal Upscaling");
+					mainCommandBuffer->SetComputeSampler(temporalUpscaleSampler, 0);
+					mainCommandBuffer->SetComputeTexture(currentInput, 1);
+					mainCommandBuffer->SetComputeTexture(target.depthStencil->GetDefaultView(), 2);
+					mainCommandBuffer->SetComputeTexture(target.entityIDTexture->GetDefaultView(), 3);
+					mainCommandBuffer->SetComputeTexture(history.color[history.current ^ 1]->GetDefaultView(), 4);
+					mainCommandBuffer->SetComputeTexture(history.color[history.current]->GetDefaultView(), 5);
+					mainCommandBuffer->SetComputeTexture(altInput, 6);
+					mainCommandBuffer->BindComputeBuffer(worldTransformBuffer, 7);
+					mainCommandBuffer->BindComputeBuffer(objectMotion ? prevWorldTransforms : worldTransformBuffer, 8);
+					mainCommandBuffer->SetComputeBytes(ubo, 0);
+					constexpr auto tileSize = TemporalUpscaleUBO::tileSize;
+					mainCommandBuffer->DispatchCompute((ubo.outputRect.z + tileSize - 1) / tileSize, (ubo.outputRect.w + tileSize - 1) / tileSize, 1, tileSize, tileSize, 1);
+					mainCommandBuffer->EndComputeDebugMarker();
+					mainCommandBuffer->EndCompute();
+					std::swap(currentInput, altInput);
+
+					historyView.viewProj = unjitteredViewProj;
+					historyView.lastFrame = frameCount;
+					RVE_PROFILE_SECTION_END(taa);
+				}
 
                 // afterwards render the post processing effects
 				RVE_PROFILE_SECTION(postfx, "Encode Post Processing Effects");
-                uint32_t totalPostFXRendered = 0;
-                RGL::TextureView currentInput = target.lightingTexture->GetDefaultView();
-                RGL::TextureView altInput = target.lightingScratchTexture->GetDefaultView();
 				mainCommandBuffer->BeginRenderDebugMarker("Post processing");
                 
                 for(const auto& effect : camData.postProcessingEffects->effects){
-                    if (!effect->enabled){
+                    if (!effect->enabled || effect.get() == fusedFXAA){
                         continue;
                     }
 					
                     effect->Preamble({ int(fullSizeViewport.width), int(fullSizeViewport.height) });
-                    for(const auto pass : effect->passes){
+					// a fused bloom's merge pass is applied by the fused pass
+					const auto numPasses = effect.get() == fusedBloom ? effect->passes.size() - 1 : effect->passes.size();
+                    for(const auto pass : std::span(effect->passes.begin(), numPasses)){
 						BasePushConstantUBO baseUbo{
 							.dim = {0,0, fullSizeViewport.width, fullSizeViewport.height}
 						};
@@ -2038,23 +3484,59 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
                         mainCommandBuffer->EndRendering();
 						if (isUsingFinalOutput) {
 							std::swap(currentInput, altInput);
-							totalPostFXRendered++;
 						}
                     }
                 }
 
+				if (fusedBloom || fusedFXAA) {
+					FusedPostProcessUBO ubo{
+						.dim = { int(fullSizeViewport.width), int(fullSizeViewport.height) },
+					};
+					mainCommandBuffer->BeginCompute(fusedPostProcessPipeline);
+					mainCommandBuffer->BeginComputeDebugMarker("Fused Post Processing");
+					mainCommandBuffer->SetComputeSampler(textureSampler, 0);
+					mainCommandBuffer->SetComputeTexture(currentInput, 1);
+					mainCommandBuffer->SetComputeTexture(currentInput, 2);	// replaced by the bloom, if there is one
+					if (fusedBloom) {
+						// the merge pass holds the bloom texture, its sampler and its strength
+						const auto& mergePass = fusedBloom->passes.back();
+						mainCommandBuffer->SetComputeSampler(mergePass->inputSamplerBindings[2], 0);
+						mainCommandBuffer->SetComputeTexture(mergePass->inputBindings[1], 2);
+						const auto strength = mergePass->GetPushConstantData();
+						std::memcpy(&ubo.bloomStrength, strength.data(), sizeof(ubo.bloomStrength));
+						ubo.options |= FusedPostProcessUBO::BLOOMBIT;
+					}
+					for (const auto& [i, tx] : Enumerate(target.mlabAccum)) {
+						mainCommandBuffer->SetComputeTexture(tx->GetDefaultView(), 3 + i);
+					}
+					if (fuseTransparency) {
+						ubo.options |= FusedPostProcessUBO::TRANSPARENCYBIT;
+					}
+					if (fusedFXAA) {
+						ubo.options |= FusedPostProcessUBO::FXAABIT;
+					}
+					mainCommandBuffer->SetComputeTexture(altInput, 7);
+					mainCommandBuffer->SetComputeBytes(ubo, 0);
+					constexpr auto tileSize = FusedPostProcessUBO::tileSize;
+					mainCommandBuffer->DispatchCompute((ubo.dim.x + tileSize - 1) / tileSize, (ubo.dim.y + tileSize - 1) / tileSize, 1, tileSize, tileSize, 1);
+					mainCommandBuffer->EndComputeDebugMarker();
+					mainCommandBuffer->EndCompute();
+					std::swap(currentInput, altInput);
+				}
+
 				mainCommandBuffer->EndRenderDebugMarker();
                 
 				RVE_PROFILE_SECTION_END(postfx);
-                auto blitSource = totalPostFXRendered % 2 == 0 ? target.lightingTexture->GetDefaultView() : target.lightingScratchTexture->GetDefaultView();
+                auto blitSource = currentInput;
                 
 				// the final on-screen render pass
 // contains the results of the previous stages, as well as the UI, skybox and any debugging primitives
 				
-				glm::ivec4 viewRect {0, 0, nextImgSize.width, nextImgSize.height};
+				glm::ivec4 viewRect {0, 0, view.pixelDimensions.width, view.pixelDimensions.height};
 
 				LightToFBUBO fbubo{
-					.viewRect = viewRect
+					.viewRect = viewRect,
+					.sourceUVScale = upscaled ? glm::vec2(1) : glm::vec2(nextImgSize.width, nextImgSize.height) / glm::vec2(view.pixelDimensions.width, view.pixelDimensions.height),
 				};
 
 				// does the camera have a tonemapper set?
@@ -2100,6 +3582,13 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 					dbg.Update();
 					dbg.Render();
 				}
+#endif
+				// over the GUIs of the view's last camera, so no camera drawn after it covers the overlay
+				if (view.overlay && finalPassCamIdx + 1 == view.camDatas.size()) {
+					view.overlay->Render();
+				}
+				FlushGUIBatch();
+#ifndef NDEBUG
 				mainCommandBuffer->EndRenderDebugMarker();
 #endif
 				RVE_PROFILE_SECTION_END(gui);
@@ -2107,8 +3596,14 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				// process debug shapes
 				RVE_PROFILE_SECTION(debugShapes, "Encode Debug Navigation");
 				mainCommandBuffer->BeginRenderDebugMarker("Debug Navigation Mesh");
-				currentNavState.viewProj = camData.viewProj;
-				worldOwning->FilterPolymorphic([this](PolymorphicGetResult<IDebugRenderable, World::PolymorphicIndirection> dbg, const PolymorphicGetResult<Transform, World::PolymorphicIndirection> transform) {
+				currentNavState.viewProj = unjitteredViewProj;
+				const auto viewFrustum = Frustum::FromViewProj(matrix4(unjitteredViewProj));
+				worldOwning->FilterPolymorphic([this, &viewFrustum](PolymorphicGetResult<IDebugRenderable, World::PolymorphicIndirection> dbg, const PolymorphicGetResult<Transform, World::PolymorphicIndirection> transform) {
+					// only owners with bounds can be skipped, the rest may draw anywhere
+					const auto owner = transform[0].GetOwner();
+					if (owner.HasComponent<SpatialBoundsComponent>() && !viewFrustum.Intersects(transform[0].GetWorldPosition(), owner.GetComponent<SpatialBoundsComponent>().GetRadius())) {
+						return;
+					}
 					for (int i = 0; i < dbg.size(); i++) {
 						auto& ptr = dbg[i];
 						if (ptr.debugEnabled) {
@@ -2123,37 +3618,18 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 				mainCommandBuffer->BeginRenderDebugMarker("Debug Wireframes");
 				Im3d::AppData& data = Im3d::GetAppData();
 
-				struct DrawListMetadata {
-					uint32_t nverts = 0;
-				} im3dMeta;
-
                 const auto& im3dcontext = Im3d::GetContext();
                 Im3d::EndFrame();
+				mainCommandBuffer->SetViewport(fullSizeViewport);
+				mainCommandBuffer->SetScissor(fullSizeScissor);
+				DrawDebugShapes(dbgdraw, unjitteredViewProj);
 				if (im3dcontext.getDrawListCount() > 0) {
 					RVE_PROFILE_SECTION(wireframes, "Encode Debug Wireframes");
-					for (int i = 0; i < im3dcontext.getDrawListCount(); i++) {
-						im3dMeta.nverts += im3dcontext.getDrawLists()[i].m_vertexCount;
-					}
-
-					// resize buffer
-					if (im3dMeta.nverts > debugRenderBufferSize) {
-						debugRenderBufferUpload = device->CreateBuffer({
-							im3dMeta.nverts,
-							{.VertexBuffer = true},
-							sizeof(Im3d::VertexData),
-							RGL::BufferAccess::Shared,
-							});
-						debugRenderBufferSize = im3dMeta.nverts;
-					}
-
-					data.m_appData = (void*)&camData.viewProj;
-					debugRenderBufferOffset = 0;
+					data.m_appData = (void*)&unjitteredViewProj;
 					data.drawCallback = [](const Im3d::DrawList& list) {
 						GetApp()->GetRenderEngine().DebugRender(list);
 						};
 
-					mainCommandBuffer->SetViewport(fullSizeViewport);
-					mainCommandBuffer->SetScissor(fullSizeScissor);
 					Im3d::GetContext().draw();
 					RVE_PROFILE_SECTION_END(wireframes);
 				}
@@ -2164,123 +3640,51 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 #endif
 				mainCommandBuffer->EndRendering();
 			};
-			auto doPassWithCamData = [this,&target,&nextImgSize](auto&& camdata, auto&& function) {
+			auto doPassWithCamData = [this,&target,&nextImgSize,&view](auto&& camdata, auto&& function) {
 				const auto camPos = camdata.camPos;
 				const auto viewportOverride = camdata.viewportOverride;
 
+				// the scene passes draw into renderArea, and the passes that write the output use the full size viewport
 				RGL::Rect renderArea{
 					.offset = { int32_t(nextImgSize.width * viewportOverride.originFactor.x),int32_t(nextImgSize.height * viewportOverride.originFactor.y) },
-						.extent = { uint32_t(nextImgSize.width * viewportOverride.sizeFactor.x), uint32_t(nextImgSize.height * viewportOverride.sizeFactor.x) },
+						.extent = { uint32_t(nextImgSize.width * viewportOverride.sizeFactor.x), uint32_t(nextImgSize.height * viewportOverride.sizeFactor.y) },
 				};
 
+				const auto outputSize = view.pixelDimensions;
 				RGL::Viewport fullSizeViewport{
-					.x = float(renderArea.offset[0]),
-						.y = float(renderArea.offset[1]),
-						.width = static_cast<float>(renderArea.extent[0]),
-						.height = static_cast<float>(renderArea.extent[1]),
+					.x = float(int32_t(outputSize.width * viewportOverride.originFactor.x)),
+						.y = float(int32_t(outputSize.height * viewportOverride.originFactor.y)),
+						.width = float(uint32_t(outputSize.width * viewportOverride.sizeFactor.x)),
+						.height = float(uint32_t(outputSize.height * viewportOverride.sizeFactor.y)),
 				};
 
 				RGL::Rect fullSizeScissor{
 					.offset = { 0,0 },
-						.extent = { uint32_t(nextImgSize.width), uint32_t(nextImgSize.height) }
+						.extent = { uint32_t(outputSize.width), uint32_t(outputSize.height) }
 				};
 
+				if (VideoSettings.temporalUpscaling && target.temporalUpscalingHistory) {
+					// every scene pass of the frame sees the same jittered projection, and the resolve takes it back out
+					auto jittered = camdata;
+					jittered.jitter = TemporalJitter(frameCount);
+					const auto jitterMtx = JitterMatrix(jittered.jitter, renderArea);
+					jittered.projOnly = jitterMtx * jittered.projOnly;
+					jittered.viewProj = jitterMtx * jittered.viewProj;
+					function(jittered, fullSizeViewport, fullSizeScissor, renderArea);
+					return;
+				}
+
 				function(camdata, fullSizeViewport, fullSizeScissor, renderArea);
 			};
             
-			auto generatePyramid = [this](const DepthPyramid& depthPyramid, RGLTexturePtr depthStencil) {
-#ifndef OCCLUSION_CULLING_UNAVAILABLE
-				RVE_PROFILE_FN_N("generatePyramid");
-				// build the depth pyramid using the depth data from the previous frame
-				depthPyramidCopyPass->SetAttachmentTexture(0, depthPyramid.pyramidTexture->GetViewForMip(0));
-				mainCommandBuffer->BeginRendering(depthPyramidCopyPass);
-				mainCommandBuffer->BeginRenderDebugMarker("First copy of depth pyramid");
-				mainCommandBuffer->BindRenderPipeline(depthPyramidCopyPipeline);
-				mainCommandBuffer->SetViewport({ 0,0,float(depthPyramid.dim) ,float(depthPyramid.dim) });
-				mainCommandBuffer->SetScissor({ 0,0,depthPyramid.dim,depthPyramid.dim });
-				PyramidCopyUBO pubo{ .size = depthPyramid.dim };
-				mainCommandBuffer->SetFragmentBytes(pubo, 0);
-				mainCommandBuffer->SetFragmentTexture(depthStencil->GetDefaultView(), 0);
-				mainCommandBuffer->SetFragmentSampler(depthPyramidSampler, 1);
-				mainCommandBuffer->SetVertexBuffer(screenTriVerts);
-				mainCommandBuffer->Draw(3);
-				mainCommandBuffer->EndRenderDebugMarker();
-				mainCommandBuffer->EndRendering();
-
-				mainCommandBuffer->BeginCompute(depthPyramidPipeline);
-				mainCommandBuffer->BeginComputeDebugMarker("Build depth pyramid");
-
-				{
-					float dim = depthPyramid.dim;
-					for (int i = 0; i < depthPyramid.numLevels - 1; i++) {
-						auto fromTex = depthPyramid.pyramidTexture->GetViewForMip(i);
-						auto toTex = depthPyramid.pyramidTexture->GetViewForMip(i + 1);
-						mainCommandBuffer->SetComputeTexture(toTex, 0);
-						mainCommandBuffer->SetComputeTexture(fromTex, 1);
-						mainCommandBuffer->SetComputeSampler(depthPyramidSampler, 2);
-
-						dim /= 2.0;
-
-						mainCommandBuffer->DispatchCompute(std::ceil(dim / 32.f), std::ceil(dim / 32.f), 1, 32, 32, 1);
-					}
-				}
-				mainCommandBuffer->EndComputeDebugMarker();
-				mainCommandBuffer->EndCompute();
-#endif
-			};
-			generatePyramid(target.depthPyramid, target.depthStencil);
-
-			// also generate the pyramids for the shadow lights
-			auto genPyramidForLight = [&generatePyramid,&worldOwning](auto&& lightStore, auto* lightType, uint32_t nMaps, auto&& getMapDataForIndex) -> void {
-				RVE_PROFILE_FN_N("genPyramidForLight");
-				for (uint32_t i = 0; i < lightStore.DenseSize(); i++) {
-					const auto& light = lightStore.GetAtDenseIndex(i);
-					auto sparseIdx = lightStore.GetSparseIndexForDense(i);
-                    auto owner = Entity({sparseIdx, worldOwning->VersionForEntity(sparseIdx)}, worldOwning.get());
-
-					using LightType = std::remove_pointer_t<decltype(lightType)>;
-
-					auto& origLight = Entity(owner).GetComponent<LightType>();
-					if (origLight.CastsShadows()) {
-						for (uint32_t i = 0; i < nMaps; i++) {
-							const auto mapData = getMapDataForIndex(i, origLight);
-							generatePyramid(mapData.pyramid, mapData.shadowMap);
-						}
-					}
-				}
-			};
-			mainCommandBuffer->BeginRenderDebugMarker("Light depth pyramids");
-			{
-				DirectionalLight* ptr = nullptr;
-                genPyramidForLight(worldOwning->renderData.directionalLightData, ptr, MAX_CASCADES, [](uint32_t index, auto&& origLight) {
-                    struct ReturnData {
-                        DepthPyramid pyramid;
-                        RGLTexturePtr shadowMap;
-                    };
-                    return ReturnData{origLight.shadowData.pyramid[index], origLight.shadowData.shadowMap[index]};
-				});
-			}
-			{
-				SpotLight* ptr = nullptr;
-				genPyramidForLight(worldOwning->renderData.spotLightData, ptr,1, [](uint32_t index, auto&& origLight) {
-					return origLight.GetShadowMap();
-				});
-			}
-			{
-				PointLight* ptr = nullptr;
-				genPyramidForLight(worldOwning->renderData.pointLightData, ptr, 6, [](uint32_t index, auto&& origLight) {
-					struct ReturnData {
-						DepthPyramid pyramid;
-						RGLTexturePtr shadowMap;
-					};
-					return ReturnData{origLight.shadowData.cubePyramids[index], origLight.shadowData.cubeShadowmaps[index]};
-				});
+			// the depth texture still holds the previous frame here
+			generatePyramid(target.depthPyramid, target.depthStencil, target.occlusionHistory ? target.occlusionHistory->depthRenderScale : 1);
+			if (target.occlusionHistory) {
+				target.occlusionHistory->depthRenderScale = renderScale;
 			}
 
-			mainCommandBuffer->EndRenderDebugMarker();
-		
-
 			// lit pass
+			depthPrepassRenderPass->SetAttachmentTexture(0, target.entityIDTexture->GetDefaultView());
 			depthPrepassRenderPass->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
 
 			litRenderPass->SetAttachmentTexture(0, target.lightingTexture->GetDefaultView());
@@ -2288,11 +3692,16 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 			litRenderPass->SetAttachmentTexture(2, target.lightingScratchTexture->GetDefaultView());
 			litRenderPass->SetAttachmentTexture(3, target.viewSpaceNormalsTexture->GetDefaultView());
 			litRenderPass->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
+			if (target.shadingRateTexture) {
+				litRenderPass->SetShadingRateTexture(target.shadingRateTexture->GetDefaultView());
+				litTransparentPass->SetShadingRateTexture(target.shadingRateTexture->GetDefaultView());
+			}
 
 			litClearRenderPass->SetAttachmentTexture(0, target.lightingTexture->GetDefaultView());
 			litClearRenderPass->SetAttachmentTexture(1, target.radianceTexture->GetDefaultView());
 			litClearRenderPass->SetAttachmentTexture(2, target.lightingScratchTexture->GetDefaultView());
 			litClearRenderPass->SetAttachmentTexture(3, target.viewSpaceNormalsTexture->GetDefaultView());
+			litClearRenderPass->SetAttachmentTexture(4, target.entityIDTexture->GetDefaultView());
 			litClearRenderPass->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
 
 			mainCommandBuffer->BeginRenderDebugMarker("Lit Pass Opaque");
@@ -2322,24 +3731,26 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 			RVE_PROFILE_SECTION_END(unlit);
 
 
-            for(const auto& [i, tx] : Enumerate(target.mlabAccum)){
-                transparentClearPass->SetAttachmentTexture(i, tx->GetDefaultView());
-            }
-            transparentClearPass->SetAttachmentTexture(4, target.mlabDepth->GetDefaultView());
+			if (viewHasTransparency) {
+				for (const auto& [i, tx] : Enumerate(target.mlabAccum)) {
+					transparentClearPass->SetAttachmentTexture(i, tx->GetDefaultView());
+				}
+				transparentClearPass->SetAttachmentTexture(4, target.mlabDepth->GetDefaultView());
 
-			mainCommandBuffer->BeginRenderDebugMarker("Lit Pass Transparent");
-			mainCommandBuffer->BeginRendering(transparentClearPass);
-			mainCommandBuffer->EndRendering();
+				mainCommandBuffer->BeginRenderDebugMarker("Lit Pass Transparent");
+				mainCommandBuffer->BeginRendering(transparentClearPass);
+				mainCommandBuffer->EndRendering();
 
-            litTransparentPass->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
-			RVE_PROFILE_SECTION(littrans, "Encode Lit Pass Transparent");
-			for (const auto& camdata : view.camDatas) {
-				doPassWithCamData(camdata, renderLitPassTransparent);
-				camIdx++;
+				litTransparentPass->SetDepthAttachmentTexture(target.depthStencil->GetDefaultView());
+				RVE_PROFILE_SECTION(littrans, "Encode Lit Pass Transparent");
+				for (const auto& camdata : view.camDatas) {
+					doPassWithCamData(camdata, renderLitPassTransparent);
+					camIdx++;
+				}
+				mainCommandBuffer->EndRenderDebugMarker();
+				RVE_PROFILE_SECTION_END(littrans);
+				camIdx = camIdxHere;
 			}
-			mainCommandBuffer->EndRenderDebugMarker();
-			RVE_PROFILE_SECTION_END(littrans);
-			camIdx = camIdxHere;
             
 			
 			// final render pass
@@ -2357,25 +3768,32 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 			for (const auto& camdata : view.camDatas) {
 				doPassWithCamData(camdata, renderFinalPass);
+				finalPassCamIdx++;
 			}
 			mainCommandBuffer->EndRenderDebugMarker();
 			RVE_PROFILE_SECTION_END(forward);
 		}
 		RVE_PROFILE_SECTION_END(allViews);
+
+		// keep this frame's transforms, for the object motion of the next frame's temporal upscaling
+		if (VideoSettings.temporalUpscaling) {
+			const auto size = worldTransformBuffer->getBufferSize();
+			if (!prevWorldTransforms || prevWorldTransforms->getBufferSize() != size) {
+				if (prevWorldTransforms) {
+					gcBuffers.enqueue(prevWorldTransforms);
+				}
+				prevWorldTransforms = device->CreateBuffer({
+					size, {.StorageBuffer = true}, sizeof(std::byte), RGL::BufferAccess::Private, {.TransferDestination = true, .debugName = "Previous World Transforms"}
+				});
+			}
+			mainCommandBuffer->CopyBufferToBuffer({ .buffer = worldTransformBuffer }, { .buffer = prevWorldTransforms }, size);
+			prevWorldTransformsWorld = worldOwning.get();
+			prevWorldTransformsFrame = frameCount;
+		}
 		mainCommandBuffer->End();
     
         // sync the transient command buffer
-        if (transientOffset > 0){
-			transientCommandBuffer->Reset();
-            transientCommandBuffer->Begin();
-            transientCommandBuffer->CopyBufferToBuffer({
-                .buffer = transientStagingBuffer,
-                .offset = 0
-            }, {
-                .buffer = transientBuffer,
-                .offset = 0
-            }, transientOffset);
-            transientCommandBuffer->End();
+        if (EncodeTransientSync(transientCommandBuffer)){
             transientCommandBuffer->Commit({});
 			transientSubmittedLastFrame = true;
         }
@@ -2383,6 +3801,18 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 			transientSubmittedLastFrame = false;
 		}
 
+		// the async compute work reads the buffers that the main queue's sync command buffers fill, so it is committed after them
+		asyncComputeDependencies.clear();
+		if (transformSyncCommandBufferNeedsCommit) {
+			asyncComputeDependencies.push_back(transformSyncCommandBuffer);
+		}
+		if (transientSubmittedLastFrame) {
+			asyncComputeDependencies.push_back(transientCommandBuffer);
+		}
+		asyncComputeCommandBuffer->Commit({
+			.waitFor = asyncComputeDependencies
+		});
+
 		if (transformSyncCommandBufferNeedsCommit) {
 			RVE_PROFILE_SECTION(transient_wait,"Wait for Transient Buffer to complete");
 			transformSyncCommandBuffer->BlockUntilCompleted();
@@ -2392,6 +3822,19 @@ RGLCommandBufferPtr RenderEngine::Draw(Ref<RavEngine::World> worldOwning, const
 
 		frameCount++;
 
+		using ms_t = std::chrono::duration<float, std::milli>;
+		lastFrameTimings.renderSyncMs = ms_t(syncTime).count();
+		lastFrameTimings.encodeMs = ms_t(std::chrono::steady_clock::now() - drawStart - syncTime).count();
+
+		// only counted while command counts are enabled, see SetCommandCountsEnabled
+		static auto draws = PerfCounters::GetCounter("Render: Draws"), dispatches = PerfCounters::GetCounter("Render: Dispatches");
+		for (const auto& region : GetCommandCounts()) {
+			if (region.depth == 0) {
+				draws->Add(region.draws);
+				dispatches->Add(region.dispatches);
+			}
+		}
+
 		return mainCommandBuffer;
 	}
 }
@@ -2417,8 +3860,7 @@ void RavEngine::RenderEngine::DebugRender(const Im3d::DrawList& drawList)
 	const Im3d::VertexData* vertexdata = drawList.m_vertexData;
 	const auto nverts = drawList.m_vertexCount;
 
-	const auto dataSize = nverts * sizeof(Im3d::VertexData);
-	debugRenderBufferUpload->UpdateBufferData({ vertexdata,  dataSize}, debugRenderBufferOffset);
+	auto allocation = WriteDebugVertices(im3dDebugVertices, { vertexdata, nverts * sizeof(Im3d::VertexData) });
 
 
 	auto viewProj = *static_cast<glm::mat4*>(Im3d::GetAppData().m_appData);
@@ -2428,13 +3870,63 @@ void RavEngine::RenderEngine::DebugRender(const Im3d::DrawList& drawList)
     };
 
 	mainCommandBuffer->SetVertexBytes(ubo,0);
-	mainCommandBuffer->SetVertexBuffer(debugRenderBufferUpload, {.offsetIntoBuffer = debugRenderBufferOffset});
+	mainCommandBuffer->SetVertexBuffer(allocation.buffer, {.offsetIntoBuffer = allocation.offset});
 	mainCommandBuffer->Draw(nverts);
 
-	debugRenderBufferOffset += dataSize;
-
 
 #endif
 
+}
+
+void RavEngine::RenderEngine::DrawDebugShapes(DebugDrawer& drawer, const glm::mat4& viewProj)
+{
+#ifndef NDEBUG
+	std::lock_guard lock(drawer.mtx);
+	const auto frustum = Frustum::FromViewProj(matrix4(viewProj));
+	const DebugUBO ubo{
+		.viewProj = viewProj
+	};
+
+	// one instanced draw per unit shape, skipping instances outside the view
+	bool pipelineBound = false;
+	for (uint32_t shape = 0; shape < DebugDrawer::UnitShapeCount; shape++) {
+		auto& instances = drawer.shapeInstances[shape];
+		const auto& range = debugShapeRanges[shape];
+		visibleDebugShapes.clear();
+		for (const auto& instance : instances) {
+			const auto& m = instance.transform;
+			const float scale = std::max({ glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])) });
+			if (frustum.Intersects(vector3(m[3]), range.boundingRadius * scale)) {
+				visibleDebugShapes.push_back(instance);
+			}
+		}
+		instances.clear();
+		if (visibleDebugShapes.empty()) {
+			continue;
+		}
+
+		auto allocation = WriteDebugVertices(debugShapeInstances, { visibleDebugShapes.data(), visibleDebugShapes.size() * sizeof(DebugDrawer::ShapeInstance) });
+		if (!pipelineBound) {
+			mainCommandBuffer->BindRenderPipeline(debugShapeRenderPipeline);
+			mainCommandBuffer->SetVertexBytes(ubo, 0);
+			mainCommandBuffer->SetVertexBuffer(debugShapeVertices);
+			pipelineBound = true;
+		}
+		mainCommandBuffer->SetVertexBuffer(allocation.buffer, { .bindingPosition = 1, .offsetIntoBuffer = allocation.offset });
+		mainCommandBuffer->Draw(range.nVertices, { .nInstances = uint32_t(visibleDebugShapes.size()), .startVertex = range.firstVertex });
+	}
+
+	// loose lines share the Im3d line format and pipeline
+	static_assert(sizeof(DebugDrawer::LineVertex) == sizeof(Im3d::VertexData));
+	if (!drawer.lineVertices.empty()) {
+		const auto nverts = uint32_t(drawer.lineVertices.size());
+		auto allocation = WriteDebugVertices(im3dDebugVertices, { drawer.lineVertices.data(), nverts * sizeof(DebugDrawer::LineVertex) });
+		mainCommandBuffer->BindRenderPipeline(im3dLineRenderPipeline);
+		mainCommandBuffer->SetVertexBytes(ubo, 0);
+		mainCommandBuffer->SetVertexBuffer(allocation.buffer, { .offsetIntoBuffer = allocation.offset });
+		mainCommandBuffer->Draw(nverts);
+		drawer.lineVertices.clear();
+	}
+#endif
 }
 #endif
@@ -4,6 +4,7 @@
 #include "Debug.hpp"
 #include <RGL/CommandBuffer.hpp>
 #include <RGL/Device.hpp>
+#include <RGL/Pipeline.hpp>
 
 using namespace RavEngine;
 using namespace std;
@@ -22,73 +23,142 @@ void RenderEngine::texture(bool state){
  */
 void RenderEngine::begin(duDebugDrawPrimitives prim, float size){
     navMeshPolygon.clear();
-
-    //TODO: support navDebugDepthEnabled
-    switch(prim){
-        case duDebugDrawPrimitives::DU_DRAW_TRIS:
-            mainCommandBuffer->BindRenderPipeline(recastTrianglePipeline);
-            break;
-        case duDebugDrawPrimitives::DU_DRAW_LINES:
-            mainCommandBuffer->BindRenderPipeline(recastLinePipeline);
-            break;
-        case duDebugDrawPrimitives::DU_DRAW_POINTS:
-            mainCommandBuffer->BindRenderPipeline(recastPointPipeline);
-            break;
-        case duDebugDrawPrimitives::DU_DRAW_QUADS:
-            Debug::Fatal("Quad rendering mode is not supported");
-            break;
-    }
+    navMeshPrimitive = prim;
 }
 
 void RenderEngine::vertex(const float *pos, unsigned int color){
-    float uv[2] = {0,0};
-    vertex(pos, color,uv);
+    navMeshPolygon.push_back({ {pos[0], pos[1], pos[2]}, {0, 0}, color });
 }
 
 void RenderEngine::vertex(const float* pos, unsigned int color, const float* uv){
-    VertexColorUV vert;
-    vert.position[0] = pos[0];
-    vert.position[1] = pos[1];
-    vert.position[2] = pos[2];
-    vert.uv[0] = uv[0];
-    vert.uv[1] = uv[1];
-    vert.color = color;
-    navMeshPolygon.push_back(vert);
+    navMeshPolygon.push_back({ {pos[0], pos[1], pos[2]}, {uv[0], uv[1]}, color });
 }
 
 void RenderEngine::vertex(const float x, const float y, const float z, unsigned int color){
-    float pos[3] = {x,y,z};
-    float uv[2] = {0,0};
-    vertex(pos,color,uv);
+    navMeshPolygon.push_back({ {x, y, z}, {0, 0}, color });
 }
 
 void RenderEngine::vertex(const float x, const float y, const float z, unsigned int color, const float u, const float v){
-    float pos[3] = {x,y,z};
-    float uv[2] = {u,v};
-    vertex(pos,color,uv);
+    navMeshPolygon.push_back({ {x, y, z}, {u, v}, color });
 }
 
 void RenderEngine::end(){
     // submit the primitive here
-    if (navMeshPolygon.size() == 0){
+    DrawDebugVertices(navMeshPrimitive, navMeshPolygon);
+}
+
+// these are only needed once a navmesh is drawn for debugging, so they are not created with the other pipelines at startup
+void RenderEngine::CreateNavDebugPipelines(){
+    auto navDebugLayout = device->CreatePipelineLayout({
+        .constants = {{sizeof(navDebugUBO), 0, RGL::StageVisibility(RGL::StageVisibility::Vertex)}}
+    });
+
+    auto recastDebugVSH = LoadShaderByFilename("debugNav_vsh", device);
+    auto recastDebugFSH = LoadShaderByFilename("debugNav_fsh", device);
+    auto createDebugNavPipeline = [navDebugLayout, this, recastDebugFSH, recastDebugVSH](RGL::PolygonOverride drawMode, RGL::PrimitiveTopology topology) {
+        RGL::RenderPipelineDescriptor recastDebugDesc{
+        .stages = {
+                {
+                    .type = RGL::ShaderStageDesc::Type::Vertex,
+                    .shaderModule = recastDebugVSH,
+                },
+                {
+                    .type = RGL::ShaderStageDesc::Type::Fragment,
+                    .shaderModule = recastDebugFSH,
+                }
+        },
+        .vertexConfig = {
+            .vertexBindings = {
+                {
+                    .binding = 0,
+                    .stride = sizeof(VertexColorUV),
+                },
+            },
+            .attributeDescs = {
+                {
+                    .location = 0,
+                    .binding = 0,
+                    .offset = 0,
+                    .format = RGL::VertexAttributeFormat::R32G32B32_SignedFloat,
+                },
+                {
+                    .location = 1,
+                    .binding = 0,
+                    .offset = offsetof(VertexColorUV,uv),
+                    .format = RGL::VertexAttributeFormat::R32G32_SignedFloat,
+                },
+                {
+                    .location = 2,
+                    .binding = 0,
+                    .offset = offsetof(VertexColorUV,color),
+                    .format = RGL::VertexAttributeFormat::R32_Uint,
+                },
+            }
+        },
+        .inputAssembly = {
+            .topology = topology,
+        },
+        .rasterizerConfig = {
+            .polygonOverride = drawMode,
+            .windingOrder = RGL::WindingOrder::Counterclockwise,
+        },
+        .colorBlendConfig = {
+            .attachments = {
+                {
+                    .format = RGL::TextureFormat::BGRA8_Unorm,
+                    .sourceColorBlendFactor = RGL::BlendFactor::SourceAlpha,
+                    .destinationColorBlendFactor = RGL::BlendFactor::OneMinusSourceAlpha,
+                    .alphaBlendOperation = RGL::BlendOperation::Add,
+                    .colorWriteMask = RGL::ColorWriteMask::RGB,
+                    .blendEnabled = true,
+                },
+            }
+        },
+        .depthStencilConfig = {
+            .depthFormat = depthFormat,
+            .depthTestEnabled = true,
+            .depthWriteEnabled = false,
+            .depthFunction = RGL::DepthCompareFunction::Greater
+        },
+        .pipelineLayout = navDebugLayout,
+        };
+
+        return device->CreateRenderPipeline(recastDebugDesc);
+    };
+
+    recastLinePipeline = createDebugNavPipeline(RGL::PolygonOverride::Line, RGL::PrimitiveTopology::LineList);
+    recastPointPipeline = createDebugNavPipeline(RGL::PolygonOverride::Line, RGL::PrimitiveTopology::PointList);
+    recastTrianglePipeline = createDebugNavPipeline(RGL::PolygonOverride::Fill, RGL::PrimitiveTopology::TriangleList);
+}
+
+void RenderEngine::DrawDebugVertices(duDebugDrawPrimitives prim, std::span<const VertexColorUV> vertices){
+    if (vertices.empty()){
         return;
     }
-	auto size = navMeshPolygon.size() * sizeof(decltype(navMeshPolygon)::value_type);
-	assert(size < std::numeric_limits<unsigned int>::max());
-
-    auto vertBuffer = device->CreateBuffer({
-        uint32_t(navMeshPolygon.size()),
-        {.VertexBuffer = true},
-        sizeof(decltype(navMeshPolygon)::value_type),
-        RGL::BufferAccess::Private,
-        });
-    vertBuffer->SetBufferData({ navMeshPolygon.data(), navMeshPolygon.size() * sizeof(decltype(navMeshPolygon)::value_type)});
-
-    mainCommandBuffer->SetVertexBuffer(vertBuffer);
-    mainCommandBuffer->SetVertexBytes(currentNavState, 0);
-    mainCommandBuffer->Draw(navMeshPolygon.size());
+    if (!recastTrianglePipeline){
+        CreateNavDebugPipelines();
+    }
 
-    // trash the buffer now that we're done with it
-    gcBuffers.enqueue(vertBuffer);
+    //TODO: support navDebugDepthEnabled
+    switch(prim){
+        case duDebugDrawPrimitives::DU_DRAW_TRIS:
+            mainCommandBuffer->BindRenderPipeline(recastTrianglePipeline);
+            break;
+        case duDebugDrawPrimitives::DU_DRAW_LINES:
+            mainCommandBuffer->BindRenderPipeline(recastLinePipeline);
+            break;
+        case duDebugDrawPrimitives::DU_DRAW_POINTS:
+            mainCommandBuffer->BindRenderPipeline(recastPointPipeline);
+            break;
+        case duDebugDrawPrimitives::DU_DRAW_QUADS:
+            Debug::Fatal("Quad rendering mode is not supported");
+            break;
+    }
+
+    auto allocation = WriteDebugVertices(navDebugVertices, { vertices.data(), vertices.size_bytes() });
+
+    mainCommandBuffer->SetVertexBuffer(allocation.buffer, { .offsetIntoBuffer = allocation.offset });
+    mainCommandBuffer->SetVertexBytes(currentNavState, 0);
+    mainCommandBuffer->Draw(uint32_t(vertices.size()));
 }
 #endif
@@ -1,5 +1,6 @@
 #if !RVE_SERVER
 #include "RenderEngine.hpp"
+#include "GUI.hpp"
 #include "App.hpp"
 #include <RGL/RGL.hpp>
 #include <stb_image.h>
@@ -25,13 +26,12 @@ struct TextureHandleStruct{
 };
 
 struct CompiledGeoStruct{
-	RGLBufferPtr vb, ib;
+	OffsetAllocator::Allocation vertices, indices;	// in the compiled geometry pools
 	Rml::TextureHandle th;
 	const int nindices = 0;
 
 	void Destroy(RenderEngine* renderer) {
-		renderer->gcBuffers.enqueue(vb);
-		renderer->gcBuffers.enqueue(ib);
+		renderer->gcGUIGeometry.enqueue({ vertices.node, indices.node });
 	}
 	
 	~CompiledGeoStruct(){
@@ -39,6 +39,13 @@ struct CompiledGeoStruct{
 	}
 };
 
+static RGLTexturePtr textureForHandle(Rml::TextureHandle texture) {
+	if (texture) {
+		return reinterpret_cast<TextureHandleStruct*>(texture)->th;
+	}
+	return Texture::Manager::defaultTexture->GetRHITexturePointer();
+}
+
 matrix4 RenderEngine::make_gui_matrix(Rml::Vector2f translation){
 	matrix4 mat(1);	//start with identity
     dim_t<int> size = { static_cast<int>(currentRenderSize.width), static_cast<int>(currentRenderSize.height) };
@@ -97,138 +104,218 @@ void RenderEngine::GetClipboardText(Rml::String &text){
 
 /// Called by RmlUi when it wants to render geometry that it does not wish to optimise.
 void RenderEngine::RenderGeometry(Rml::Vertex* vertices, int num_vertices, int* indices, int num_indices, Rml::TextureHandle texture, const Rml::Vector2f& translation) {
-
-	auto vbuf = device->CreateBuffer({
-		 uint32_t(num_vertices),
-		{.VertexBuffer = true},
-		sizeof(Rml::Vertex),
-		RGL::BufferAccess::Private
+	if (guiRecording) {
+		auto& list = *guiRecording;
+		list.draws.push_back({
+			.texture = texture,
+			.translation = translation,
+			.firstVertex = uint32_t(list.vertices.size()),
+			.nVertices = uint32_t(num_vertices),
+			.firstIndex = uint32_t(list.indices.size()),
+			.nIndices = uint32_t(num_indices),
+			.scissorX = RMLScissor.x, .scissorY = RMLScissor.y, .scissorWidth = RMLScissor.width, .scissorHeight = RMLScissor.height,
+			.scissorEnabled = RMLScissor.enabled,
 		});
+		list.vertices.insert(list.vertices.end(), vertices, vertices + num_vertices);
+		list.indices.insert(list.indices.end(), indices, indices + num_indices);
+	}
 
-	auto ibuf = device->CreateBuffer({
-		 uint32_t(num_indices),
-		{.IndexBuffer = true},
-		sizeof(int),
-		RGL::BufferAccess::Private
-		});
+	auto& frame = guiFrameGeometry[frameCount % transientFramesInFlight];
 
-	vbuf->SetBufferData({ vertices, uint32_t(num_vertices * sizeof(Rml::Vertex))});
-	ibuf->SetBufferData({ indices, uint32_t(num_indices * sizeof(int)) });
+	if (guiBatch.nIndices > 0 && (guiBatch.texture != texture || !(guiBatch.scissorRect == RMLScissor))) {
+		FlushGUIBatch();
+	}
 
-	RGLTexturePtr tx;
-	if (texture) {
-		auto btexture = reinterpret_cast<TextureHandleStruct*>(texture);
-		tx = btexture->th;
+	// out of room, continue in larger buffers. Draws already recorded keep the old ones alive until the frame is done.
+	if (frame.nVertices + num_vertices > frame.vertexCapacity || frame.nIndices + num_indices > frame.indexCapacity) {
+		FlushGUIBatch();
+		auto grow = [this](RGLBufferPtr& buffer, uint32_t& capacity, uint32_t needed, uint32_t stride, RGL::BufferConfig::Type type, const char* debugName) {
+			if (needed <= capacity) {
+				return;
+			}
+			gcBuffers.enqueue(buffer);
+			capacity = std::max({ capacity * 2, needed, 4096u });
+			buffer = device->CreateBuffer({
+				capacity,
+				type,
+				stride,
+				RGL::BufferAccess::Shared,
+				{.debugName = debugName}
+			});
+			buffer->MapMemory();
+		};
+		grow(frame.vertexBuffer, frame.vertexCapacity, frame.nVertices + num_vertices, sizeof(Rml::Vertex), { .VertexBuffer = true }, "RML Frame Vertex Buffer");
+		grow(frame.indexBuffer, frame.indexCapacity, frame.nIndices + num_indices, sizeof(int), { .IndexBuffer = true }, "RML Frame Index Buffer");
+		frame.nVertices = 0;
+		frame.nIndices = 0;
 	}
-	else {
-		tx = Texture::Manager::defaultTexture->GetRHITexturePointer();
+
+	if (guiBatch.nIndices == 0) {
+		guiBatch.texture = texture;
+		guiBatch.scissorRect = RMLScissor;
+		guiBatch.firstVertex = frame.nVertices;
+		guiBatch.firstIndex = frame.nIndices;
 	}
-	auto drawmat = make_gui_matrix(translation);
+
+	auto vertexDest = static_cast<Rml::Vertex*>(frame.vertexBuffer->GetMappedDataPtr()) + frame.nVertices;
+	for (int i = 0; i < num_vertices; i++) {
+		vertexDest[i] = vertices[i];
+		vertexDest[i].position += translation;
+	}
+	// indices are relative to the batch's first vertex
+	const int baseVertex = frame.nVertices - guiBatch.firstVertex;
+	auto indexDest = static_cast<int*>(frame.indexBuffer->GetMappedDataPtr()) + frame.nIndices;
+	for (int i = 0; i < num_indices; i++) {
+		indexDest[i] = indices[i] + baseVertex;
+	}
+
+	frame.nVertices += num_vertices;
+	frame.nIndices += num_indices;
+	guiBatch.nIndices += num_indices;
+}
+
+void RenderEngine::FlushGUIBatch() {
+	if (guiBatch.nIndices == 0) {
+		return;
+	}
+	const auto& frame = guiFrameGeometry[frameCount % transientFramesInFlight];
+	auto drawmat = make_gui_matrix({ 0, 0 });
 
 	mainCommandBuffer->BindRenderPipeline(guiRenderPipeline);
-	if (RMLScissor.enabled) {
-		mainCommandBuffer->SetScissor({ RMLScissor.x, RMLScissor.y, RMLScissor.width, RMLScissor.height });
+	if (guiBatch.scissorRect.enabled) {
+		mainCommandBuffer->SetScissor({ guiBatch.scissorRect.x, guiBatch.scissorRect.y, guiBatch.scissorRect.width, guiBatch.scissorRect.height });
+	}
+	else {
+		mainCommandBuffer->SetScissor({ 0, 0, uint32_t(currentRenderSize.width), uint32_t(currentRenderSize.height) });
 	}
 
-	mainCommandBuffer->SetVertexBuffer(vbuf);
-	mainCommandBuffer->SetIndexBuffer(ibuf);
+	mainCommandBuffer->SetVertexBuffer(frame.vertexBuffer, { .offsetIntoBuffer = guiBatch.firstVertex });
+	mainCommandBuffer->SetIndexBuffer(frame.indexBuffer);
 	mainCommandBuffer->SetVertexBytes(drawmat, 0);
 	mainCommandBuffer->SetFragmentSampler(textureSampler, 0);
-	mainCommandBuffer->SetFragmentTexture(tx->GetDefaultView(), 1);
-	mainCommandBuffer->DrawIndexed(num_indices);
+	mainCommandBuffer->SetFragmentTexture(textureForHandle(guiBatch.texture)->GetDefaultView(), 1);
+	mainCommandBuffer->DrawIndexed(guiBatch.nIndices, { .firstIndex = guiBatch.firstIndex });
 
-	// trash buffers
-	gcBuffers.enqueue(vbuf);
-	gcBuffers.enqueue(ibuf);
+	guiBatch.nIndices = 0;
 }
 
-/// Called by RmlUi when it wants to compile geometry it believes will be static for the forseeable future.
-Rml::CompiledGeometryHandle RenderEngine::CompileGeometry(Rml::Vertex* vertices, int num_vertices, int* indices, int num_indices, Rml::TextureHandle texture){
-	auto vbuf = device->CreateBuffer({
-		 uint32_t(num_vertices),
-		{.VertexBuffer = true},
-		sizeof(Rml::Vertex),
-		RGL::BufferAccess::Private,
-		{.debugName = "RML Compiled Vertex Bufer"}
-	});
-
-	auto ibuf = device->CreateBuffer({
-		 uint32_t(num_indices),
-		{.IndexBuffer = true},
-		sizeof(int),
-		RGL::BufferAccess::Private,
-		{.debugName = "RML Compiled Index Bufer"}
-	});
-
-	// first half is for vertex data, second half is for index data
-	const auto vertSize = num_vertices * sizeof(Rml::Vertex);
-	const auto indsize = num_indices * sizeof(int);
-
-	if (RGL::CurrentAPI() == RGL::API::Direct3D12) {
-		auto vbufStaging = WriteTransient({ vertices, vertSize });
-		auto ibufStaging = WriteTransient({ indices, indsize });
-
-		mainCommandBuffer->CopyBufferToBuffer(
-			{
-				.buffer = transientBuffer,
-				.offset = vbufStaging
-			},
-		{
-			.buffer = vbuf,
-			.offset = 0
-		}, vertSize);
-
-		mainCommandBuffer->CopyBufferToBuffer(
-			{
-				.buffer = transientBuffer,
-				.offset = ibufStaging
-			},
-		{
-			.buffer = ibuf,
-			.offset = 0
-		},
-			indsize
-		);
+void RenderEngine::BeginGUIDrawList(GUIDrawList& list) {
+	list.clear();
+	list.resourceGeneration = guiResourceGeneration;
+	guiRecording = &list;
+}
+
+void RenderEngine::EndGUIDrawList() {
+	guiRecording->valid = true;
+	guiRecording = nullptr;
+}
+
+bool RenderEngine::ReplayGUIDrawList(GUIDrawList& list) {
+	if (!list.valid || list.resourceGeneration != guiResourceGeneration) {
+		return false;
 	}
-	else {
-		// vulkan requires us to do something inefficient here
-		vbuf->SetBufferData({ vertices, uint32_t(num_vertices * sizeof(Rml::Vertex)) });
-		ibuf->SetBufferData({ indices, uint32_t(num_indices * sizeof(int)) });
+	// same calls as rendering the context, without RmlUi walking its elements to produce them
+	for (const auto& draw : list.draws) {
+		RMLScissor = { draw.scissorX, draw.scissorY, draw.scissorWidth, draw.scissorHeight, draw.scissorEnabled };
+		if (draw.compiled) {
+			RenderCompiledGeometry(draw.compiled, draw.translation);
+		}
+		else {
+			RenderGeometry(list.vertices.data() + draw.firstVertex, int(draw.nVertices), list.indices.data() + draw.firstIndex, int(draw.nIndices), draw.texture, draw.translation);
+		}
+	}
+	return true;
+}
+
+OffsetAllocator::Allocation RenderEngine::WriteGUIGeometry(GUIGeometryPool& pool, RGL::untyped_span data, uint32_t stride, RGL::BufferConfig::Type bufferType, const char* debugName) {
+	const auto count = uint32_t(data.size() / stride);
+	auto allocation = pool.allocator.Allocate(count);
+	if (!allocation.IsValid()) {
+		// allocations keep their offsets when growing, so the old contents are copied as-is
+		const auto newCapacity = std::max({ pool.capacity * 2, pool.capacity + count * 2, 16384u });
+		auto oldBuffer = pool.buffer;
+		pool.buffer = device->CreateBuffer({
+			newCapacity,
+			bufferType,
+			stride,
+			RGL::BufferAccess::Private,
+			{.TransferDestination = true, .Transfersource = true, .debugName = debugName}
+		});
+		if (oldBuffer) {
+			auto commandbuffer = mainCommandQueue->CreateCommandBuffer();
+			auto fence = device->CreateFence({});
+			commandbuffer->Begin();
+			commandbuffer->CopyBufferToBuffer(
+				{
+					.buffer = oldBuffer,
+					.offset = 0,
+				},
+				{
+					.buffer = pool.buffer,
+					.offset = 0,
+				},
+				pool.capacity * stride
+			);
+			commandbuffer->End();
+			commandbuffer->Commit({ fence });
+			fence->Wait();
+			gcBuffers.enqueue(oldBuffer);
+		}
+		pool.allocator.Grow(newCapacity);
+		pool.capacity = newCapacity;
+		allocation = pool.allocator.Allocate(count);
 	}
+	pool.buffer->SetBufferData(data, allocation.offset * stride);
+	return allocation;
+}
+
+/// Called by RmlUi when it wants to compile geometry it believes will be static for the forseeable future.
+Rml::CompiledGeometryHandle RenderEngine::CompileGeometry(Rml::Vertex* vertices, int num_vertices, int* indices, int num_indices, Rml::TextureHandle texture){
+	auto vertexAllocation = WriteGUIGeometry(guiCompiledVertices, { vertices, num_vertices * sizeof(Rml::Vertex) }, sizeof(Rml::Vertex), { .VertexBuffer = true }, "RML Compiled Vertex Buffer");
+	auto indexAllocation = WriteGUIGeometry(guiCompiledIndices, { indices, num_indices * sizeof(int) }, sizeof(int), { .IndexBuffer = true }, "RML Compiled Index Buffer");
 
-	CompiledGeoStruct* cgs = new CompiledGeoStruct{ vbuf,ibuf, texture, num_indices };
+	CompiledGeoStruct* cgs = new CompiledGeoStruct{ vertexAllocation, indexAllocation, texture, num_indices };
 	return reinterpret_cast<Rml::CompiledGeometryHandle>(cgs);
 }
 /// Called by RmlUi when it wants to render application-compiled geometry.
 void RenderEngine::RenderCompiledGeometry(Rml::CompiledGeometryHandle geometry, const Rml::Vector2f& translation){
 	CompiledGeoStruct* cgs = reinterpret_cast<CompiledGeoStruct*>(geometry);
 
-	RGLTexturePtr tx;
-	if (cgs->th) {
-		auto btexture = reinterpret_cast<TextureHandleStruct*>(cgs->th);
-		tx = btexture->th;
-	}
-	else {
-		tx = Texture::Manager::defaultTexture->GetRHITexturePointer();
+	if (guiRecording) {
+		guiRecording->draws.push_back({
+			.texture = cgs->th,
+			.compiled = geometry,
+			.translation = translation,
+			.scissorX = RMLScissor.x, .scissorY = RMLScissor.y, .scissorWidth = RMLScissor.width, .scissorHeight = RMLScissor.height,
+			.scissorEnabled = RMLScissor.enabled,
+		});
 	}
+
+	// keep draw order with the uncompiled geometry before this
+	FlushGUIBatch();
+
 	mainCommandBuffer->BindRenderPipeline(guiRenderPipeline);
 	if (RMLScissor.enabled) {
 		mainCommandBuffer->SetScissor({ RMLScissor.x, RMLScissor.y, RMLScissor.width, RMLScissor.height });
 	}
+	else {
+		mainCommandBuffer->SetScissor({ 0, 0, uint32_t(currentRenderSize.width), uint32_t(currentRenderSize.height) });
+	}
 	auto drawmat = make_gui_matrix(translation);
 
-	mainCommandBuffer->SetVertexBuffer(cgs->vb);
-	mainCommandBuffer->SetIndexBuffer(cgs->ib);
+	mainCommandBuffer->SetVertexBuffer(guiCompiledVertices.buffer, { .offsetIntoBuffer = cgs->vertices.offset });
+	mainCommandBuffer->SetIndexBuffer(guiCompiledIndices.buffer);
 	mainCommandBuffer->SetVertexBytes(drawmat, 0);
 	mainCommandBuffer->SetFragmentSampler(textureSampler, 0);
-	mainCommandBuffer->SetFragmentTexture(tx->GetDefaultView(), 1);
-	mainCommandBuffer->DrawIndexed(cgs->nindices);
+	mainCommandBuffer->SetFragmentTexture(textureForHandle(cgs->th)->GetDefaultView(), 1);
+	mainCommandBuffer->DrawIndexed(cgs->nindices, { .firstIndex = cgs->indices.offset });
 
 	//don't delete here, RML will tell us when to delete cgs
 }
 /// Called by RmlUi when it wants to release application-compiled geometry.
 void RenderEngine::ReleaseCompiledGeometry(Rml::CompiledGeometryHandle geometry) {
 	CompiledGeoStruct* cgs = reinterpret_cast<CompiledGeoStruct*>(geometry);
+	guiResourceGeneration++;
 	cgs->Destroy(this);	// enqueue buffers for deletion on the next frame
 	delete cgs; 	//destructor decrements refcounts as needed
 }
@@ -276,6 +363,7 @@ bool RenderEngine::GenerateTexture(Rml::TextureHandle& texture_handle, const Rml
 /// Called by RmlUi when a loaded texture is no longer required.
 void RenderEngine::ReleaseTexture(Rml::TextureHandle texture_handle) {
 	TextureHandleStruct* ths = reinterpret_cast<TextureHandleStruct*>(texture_handle);
+	guiResourceGeneration++;
 	ths->Destroy(this);	// enqueue texture for deletion
 	delete ths;
 }
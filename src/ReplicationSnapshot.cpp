@@ -0,0 +1,251 @@
+#include "ReplicationSnapshot.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace RavEngine;
+
+namespace {
+	template<typename T>
+	void Write(std::string& out, const T& value) {
+		out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	struct Reader {
+		std::string_view in;
+		size_t offset = 0;
+
+		bool Read(void* dst, size_t size) {
+			if (offset + size > in.size()) {
+				return false;
+			}
+			std::memcpy(dst, in.data() + offset, size);
+			offset += size;
+			return true;
+		}
+
+		bool AtEnd() const {
+			return offset == in.size();
+		}
+	};
+
+	// walks the entities of a snapshot, or only the ones listed
+	struct Cursor {
+		const Vector<ReplicationSnapshot::Entity>& entities;
+		const Vector<uint32_t>* subset;
+		size_t pos = 0;
+
+		bool AtEnd() const {
+			return pos == (subset ? subset->size() : entities.size());
+		}
+
+		const ReplicationSnapshot::Entity& operator*() const {
+			return entities[subset ? (*subset)[pos] : pos];
+		}
+
+		const ReplicationSnapshot::Entity* operator->() const {
+			return &**this;
+		}
+
+		void operator++() {
+			pos++;
+		}
+	};
+
+	uint32_t AllFields(uint8_t nFields) {
+		return nFields == 32 ? ~0u : (1u << nFields) - 1;
+	}
+}
+
+void ReplicationSnapshot::BeginEntity(netid_t id) {
+	entities.push_back({
+		.id = id,
+		.fieldBegin = uint32_t(fieldSizes.size()),
+		.dataBegin = uint32_t(data.size()),
+	});
+}
+
+uint8_t* ReplicationSnapshot::AddField(uint16_t size) {
+	auto& entity = entities.back();
+	Debug::Assert(entity.nFields < maxFields, "An entity can replicate at most {} fields", maxFields);
+	entity.nFields++;
+	fieldSizes.push_back(size);
+	const auto begin = data.size();
+	data.resize(begin + size);
+	return data.data() + begin;
+}
+
+void ReplicationSnapshot::Finalize() {
+	// an entity without fields would encode like a removal
+	std::erase_if(entities, [](const Entity& entity) {
+		return entity.nFields == 0;
+	});
+	// the fields stay where they were written, only the records move
+	std::sort(entities.begin(), entities.end(), [](const Entity& a, const Entity& b) {
+		return a.id < b.id;
+	});
+}
+
+void ReplicationSnapshot::Clear() {
+	entities.clear();
+	fieldSizes.clear();
+	data.clear();
+}
+
+const ReplicationSnapshot::Entity* ReplicationSnapshot::Find(netid_t id) const {
+	auto it = std::lower_bound(entities.begin(), entities.end(), id, [](const Entity& entity, netid_t id) {
+		return entity.id < id;
+	});
+	return (it != entities.end() && it->id == id) ? &*it : nullptr;
+}
+
+std::span<const uint8_t> ReplicationSnapshot::GetField(const Entity& entity, uint8_t field) const {
+	uint32_t offset = entity.dataBegin;
+	for (uint8_t i = 0; i < field; i++) {
+		offset += fieldSizes[entity.fieldBegin + i];
+	}
+	return { data.data() + offset, fieldSizes[entity.fieldBegin + field] };
+}
+
+void ReplicationSnapshot::CopyEntity(const ReplicationSnapshot& other, const Entity& entity) {
+	BeginEntity(entity.id);
+	for (uint8_t i = 0; i < entity.nFields; i++) {
+		auto field = other.GetField(entity, i);
+		std::memcpy(AddField(uint16_t(field.size())), field.data(), field.size());
+	}
+}
+
+bool ReplicationSnapshot::SameLayout(const Entity& entity, const ReplicationSnapshot& other, const Entity& otherEntity) const {
+	return entity.nFields == otherEntity.nFields && std::equal(
+		fieldSizes.begin() + entity.fieldBegin, fieldSizes.begin() + entity.fieldBegin + entity.nFields,
+		other.fieldSizes.begin() + otherEntity.fieldBegin
+	);
+}
+
+void ReplicationSnapshot::Encode(const ReplicationSnapshot* baseline, std::string& out, const Vector<uint32_t>* subset, const Vector<uint32_t>* baselineSubset) const {
+	// each entry is the entity id and a mask of the fields that follow. A mask of 0 removes the entity.
+	const auto writeRemoved = [&out](netid_t id) {
+		Write(out, id);
+		Write(out, uint32_t(0));
+	};
+	// entities the baseline does not have also carry their field sizes
+	const auto writeFull = [this, &out](const Entity& entity) {
+		Write(out, entity.id);
+		Write(out, AllFields(entity.nFields));
+		Write(out, entity.nFields);
+		for (uint8_t i = 0; i < entity.nFields; i++) {
+			Write(out, fieldSizes[entity.fieldBegin + i]);
+		}
+		for (uint8_t i = 0; i < entity.nFields; i++) {
+			auto field = GetField(entity, i);
+			out.append(reinterpret_cast<const char*>(field.data()), field.size());
+		}
+	};
+
+	static const Vector<Entity> none;
+	Cursor base{ baseline ? baseline->entities : none, baseline ? baselineSubset : nullptr };
+	for (Cursor current{ entities, subset }; !current.AtEnd(); ++current) {
+		const auto& entity = *current;
+		for (; !base.AtEnd() && base->id < entity.id; ++base) {
+			writeRemoved(base->id);
+		}
+		if (base.AtEnd() || base->id != entity.id) {
+			writeFull(entity);
+			continue;
+		}
+		if (!SameLayout(entity, *baseline, *base)) {
+			writeRemoved(entity.id);
+			writeFull(entity);
+			++base;
+			continue;
+		}
+
+		uint32_t mask = 0;
+		for (uint8_t i = 0; i < entity.nFields; i++) {
+			auto field = GetField(entity, i);
+			if (std::memcmp(field.data(), baseline->GetField(*base, i).data(), field.size()) != 0) {
+				mask |= 1u << i;
+			}
+		}
+		if (mask != 0) {
+			Write(out, entity.id);
+			Write(out, mask);
+			for (uint8_t i = 0; i < entity.nFields; i++) {
+				if (mask & (1u << i)) {
+					auto field = GetField(entity, i);
+					out.append(reinterpret_cast<const char*>(field.data()), field.size());
+				}
+			}
+		}
+		++base;
+	}
+	for (; !base.AtEnd(); ++base) {
+		writeRemoved(base->id);
+	}
+}
+
+bool ReplicationSnapshot::Decode(std::string_view in, const ReplicationSnapshot* baseline) {
+	Clear();
+	static const Vector<Entity> none;
+	const auto& baseEntities = baseline ? baseline->entities : none;
+	auto base = baseEntities.begin();
+
+	Reader reader{ in };
+	while (!reader.AtEnd()) {
+		netid_t id;
+		uint32_t mask;
+		if (!reader.Read(&id, sizeof(id)) || !reader.Read(&mask, sizeof(mask))) {
+			return false;
+		}
+
+		// entities the delta skips did not change
+		for (; base != baseEntities.end() && base->id < id; ++base) {
+			CopyEntity(*baseline, *base);
+		}
+		const bool inBaseline = base != baseEntities.end() && base->id == id;
+		if (mask == 0) {
+			if (!inBaseline) {
+				return false;
+			}
+			++base;
+			continue;
+		}
+
+		if (inBaseline) {
+			BeginEntity(id);
+			for (uint8_t i = 0; i < base->nFields; i++) {
+				auto field = baseline->GetField(*base, i);
+				auto dst = AddField(uint16_t(field.size()));
+				if (mask & (1u << i)) {
+					if (!reader.Read(dst, field.size())) {
+						return false;
+					}
+				}
+				else {
+					std::memcpy(dst, field.data(), field.size());
+				}
+			}
+			++base;
+			continue;
+		}
+
+		uint8_t nFields;
+		if (!reader.Read(&nFields, sizeof(nFields)) || nFields == 0 || nFields > maxFields || mask != AllFields(nFields)) {
+			return false;
+		}
+		uint16_t sizes[maxFields];
+		if (!reader.Read(sizes, sizeof(sizes[0]) * nFields)) {
+			return false;
+		}
+		BeginEntity(id);
+		for (uint8_t i = 0; i < nFields; i++) {
+			if (!reader.Read(AddField(sizes[i]), sizes[i])) {
+				return false;
+			}
+		}
+	}
+	for (; base != baseEntities.end(); ++base) {
+		CopyEntity(*baseline, *base);
+	}
+	return true;
+}
@@ -0,0 +1,53 @@
+#include "SamplingContextPool.hpp"
+#include "Map.hpp"
+#include "Vector.hpp"
+#include <mutex>
+
+using namespace RavEngine;
+using Context = ozz::animation::SamplingJob::Context;
+
+namespace {
+	// free contexts, keyed by max_tracks
+	struct FreeContexts {
+		UnorderedMap<int, Vector<Context*>> byTracks;
+		std::mutex mtx;
+
+		void Clear() {
+			for (auto& [tracks, contexts] : byTracks) {
+				for (auto context : contexts) {
+					delete context;
+				}
+			}
+			byTracks.clear();
+		}
+
+		~FreeContexts() {
+			Clear();
+		}
+	} freeContexts;
+}
+
+void SamplingContextPool::Release::operator()(Context* context) const {
+	std::lock_guard lock(freeContexts.mtx);
+	freeContexts.byTracks[context->max_tracks()].push_back(context);
+}
+
+SamplingContextPool::Handle SamplingContextPool::Acquire(int numJoints) {
+	// contexts are sized in groups of 4 joints, so round up to find matching ones
+	const int tracks = (numJoints + 3) / 4 * 4;
+	{
+		std::lock_guard lock(freeContexts.mtx);
+		if (auto it = freeContexts.byTracks.find(tracks); it != freeContexts.byTracks.end() && !it->second.empty()) {
+			auto context = it->second.back();
+			it->second.pop_back();
+			return Handle(context);
+		}
+	}
+	// the sampling job invalidates a context when it is used with a different animation, so a new one needs no setup
+	return Handle(new Context(tracks));
+}
+
+void SamplingContextPool::Trim() {
+	std::lock_guard lock(freeContexts.mtx);
+	freeContexts.Clear();
+}
@@ -1,6 +1,8 @@
 #include "ScriptComponent.hpp"
 #include "ScriptSystem.hpp"
 #include "App.hpp"
+#include "World.hpp"
+#include <algorithm>
 
 using namespace RavEngine;
 
@@ -9,7 +11,81 @@ Transform& RavEngine::ScriptComponent::GetTransform()
 	return GetOwner().GetTransform();
 }
 
-void ScriptSystem::operator()(ScriptComponent& c) const{
-    const auto fpsScale = GetApp()->GetCurrentFPSScale();
-    c.Tick(fpsScale);
+bool ScriptAccess::ConflictsWith(const ScriptAccess& other) const {
+	auto touches = [](const ScriptAccess& access, ctti_t id) {
+		return std::find(access.reads.begin(), access.reads.end(), id) != access.reads.end()
+			|| std::find(access.writes.begin(), access.writes.end(), id) != access.writes.end();
+	};
+	return std::any_of(writes.begin(), writes.end(), [&](ctti_t id) { return touches(other, id); })
+		|| std::any_of(other.writes.begin(), other.writes.end(), [&](ctti_t id) { return touches(*this, id); });
+}
+
+void ScriptSystem::operator()(ScriptComponent& c) {
+	const std::type_index type = typeid(c);
+	auto it = batchForType.find(type);
+	if (it == batchForType.end()) {
+		it = batchForType.emplace(type, uint32_t(batches.size())).first;
+		batches.push_back({ {}, c.GetAccess() });
+	}
+	batches[it->second].scripts.push_back(&c);
+}
+
+void ScriptSystem::after(World* world) {
+	const auto fpsScale = GetApp()->GetCurrentFPSScale();
+
+	// undeclared scripts may touch anything, including other scripts, so they tick one at a time
+	waves.clear();
+	for (uint32_t i = 0; i < batches.size(); i++) {
+		auto& batch = batches[i];
+		if (batch.scripts.empty()) {
+			continue;
+		}
+		if (!batch.access) {
+			for (auto script : batch.scripts) {
+				script->Tick(fpsScale);
+			}
+			continue;
+		}
+		// put the batch in the first wave it does not conflict with
+		auto wave = std::find_if(waves.begin(), waves.end(), [&](const Vector<uint32_t>& wave) {
+			return std::none_of(wave.begin(), wave.end(), [&](uint32_t other) {
+				return batch.access->ConflictsWith(*batches[other].access);
+			});
+		});
+		if (wave == waves.end()) {
+			waves.emplace_back();
+			wave = waves.end() - 1;
+		}
+		wave->push_back(i);
+	}
+
+	for (const auto& wave : waves) {
+		if (wave.size() == 1 && !batches[wave.front()].access->instancesIndependent) {
+			for (auto script : batches[wave.front()].scripts) {
+				script->Tick(fpsScale);
+			}
+			continue;
+		}
+		tf::Taskflow flow;
+		for (const auto index : wave) {
+			auto& batch = batches[index];
+			if (batch.access->instancesIndependent) {
+				flow.for_each(batch.scripts.begin(), batch.scripts.end(), [fpsScale](ScriptComponent* script) {
+					script->Tick(fpsScale);
+				});
+			}
+			else {
+				flow.emplace([&batch, fpsScale] {
+					for (auto script : batch.scripts) {
+						script->Tick(fpsScale);
+					}
+				});
+			}
+		}
+		world->RunTaskGraph(flow);
+	}
+
+	for (auto& batch : batches) {
+		batch.scripts.clear();
+	}
 }
@@ -0,0 +1,95 @@
+#include "ShadowAtlasAllocator.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+using namespace RavEngine;
+
+ShadowAtlasAllocator::ShadowAtlasAllocator(uint16_t atlasSize, uint16_t minTileSize) : atlasSize(atlasSize), minTileSize(minTileSize) {
+    assert(std::has_single_bit(atlasSize) && std::has_single_bit(minTileSize) && minTileSize <= atlasSize);
+    numLevels = std::countr_zero(atlasSize) - std::countr_zero(minTileSize) + 1;
+    Reset();
+}
+
+void ShadowAtlasAllocator::Reset() {
+    // a complete quadtree with numLevels levels has (4^numLevels - 1) / 3 nodes
+    nodes.clear();
+    nodes.resize(((size_t(1) << (2 * numLevels)) - 1) / 3, NodeState::Free);
+    freeTexels = uint32_t(atlasSize) * atlasSize;
+}
+
+bool ShadowAtlasAllocator::AllocateInNode(uint32_t node, uint8_t level, uint8_t targetLevel, uint16_t x, uint16_t y, Tile& tile) {
+    auto& state = nodes[node];
+    if (level == targetLevel) {
+        if (state != NodeState::Free) {
+            return false;
+        }
+        state = NodeState::Allocated;
+        tile = { x, y, uint16_t(atlasSize >> level) };
+        return true;
+    }
+    if (state == NodeState::Allocated) {
+        return false;
+    }
+    // the children of an unsplit node are all free. Prefer children that are already split, so larger free tiles stay whole.
+    const uint16_t half = (atlasSize >> level) / 2;
+    const uint32_t firstChild = node * 4 + 1;
+    for (const auto pass : { NodeState::Split, NodeState::Free }) {
+        for (uint32_t c = 0; c < 4; c++) {
+            if (nodes[firstChild + c] != pass) {
+                continue;
+            }
+            if (AllocateInNode(firstChild + c, level + 1, targetLevel, x + (c & 1) * half, y + (c >> 1) * half, tile)) {
+                state = NodeState::Split;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+ShadowAtlasAllocator::Tile ShadowAtlasAllocator::Allocate(uint16_t size) {
+    size = std::clamp(size, minTileSize, atlasSize);
+    // the deepest level whose tiles still fit the request
+    uint8_t targetLevel = 0;
+    while (targetLevel + 1 < numLevels && (atlasSize >> (targetLevel + 1)) >= size) {
+        targetLevel++;
+    }
+    Tile tile;
+    if (AllocateInNode(0, 0, targetLevel, 0, 0, tile)) {
+        freeTexels -= uint32_t(tile.size) * tile.size;
+    }
+    return tile;
+}
+
+void ShadowAtlasAllocator::Free(const Tile& tile) {
+    assert(tile.IsValid());
+    // walk down to the tile's node
+    uint32_t node = 0;
+    uint8_t level = 0;
+    uint16_t x = 0, y = 0;
+    while ((atlasSize >> level) > tile.size) {
+        const uint16_t half = (atlasSize >> level) / 2;
+        const uint32_t c = (tile.x >= x + half ? 1 : 0) | (tile.y >= y + half ? 2 : 0);
+        x += (c & 1) * half;
+        y += (c >> 1) * half;
+        node = node * 4 + 1 + c;
+        level++;
+    }
+    assert(x == tile.x && y == tile.y && nodes[node] == NodeState::Allocated);
+    nodes[node] = NodeState::Free;
+    freeTexels += uint32_t(tile.size) * tile.size;
+
+    // merge upwards while all four siblings are free
+    while (node != 0) {
+        const uint32_t parent = (node - 1) / 4;
+        const uint32_t firstChild = parent * 4 + 1;
+        for (uint32_t c = 0; c < 4; c++) {
+            if (nodes[firstChild + c] != NodeState::Free) {
+                return;
+            }
+        }
+        nodes[parent] = NodeState::Free;
+        node = parent;
+    }
+}
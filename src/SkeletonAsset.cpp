@@ -126,6 +126,11 @@ SkeletonAsset::SkeletonAsset(const std::string& str){
 		Debug::Fatal("No skeleton at {}",path);
 	}
 
+	boneIndices.reserve(skeleton->num_joints());
+	for (uint16_t i = 0; i < skeleton->num_joints(); i++) {
+		boneIndices.emplace(Intern(skeleton->joint_names()[i]), i);
+	}
+
 	bindposes.resize(skeleton->joint_names().size());
 	stackarray(bindpose_ozz, ozz::math::Float4x4, skeleton->joint_names().size());
 	
@@ -137,18 +142,14 @@ SkeletonAsset::SkeletonAsset(const std::string& str){
 	
 	Debug::Assert(job.Run(), "Bindpose extraction failed");
 	
-	//convert to format understandble by GPU
-	float matrix[16];
+	//inverse here because skinning needs the inverse bindpose
+	inverseBindposes.resize(skeleton->joint_names().size());
 	for(int i = 0; i < skeleton->joint_names().size(); i++){
-		auto& t = bindpose_ozz[i];
-		for(int r = 0; r < 4; r++){
-			float result[4];
-			std::memcpy(result,t.cols + r,sizeof(t.cols[r]));
-			//_mm_store_ps(result,p.cols[r]);
-			std::memcpy(matrix + r*4,result,sizeof(result));
+		inverseBindposes[i] = ozz::math::Invert(bindpose_ozz[i]);
+		//convert to format understandble by GPU
+		for(int c = 0; c < 4; c++){
+			ozz::math::StorePtrU(inverseBindposes[i].cols[c], glm::value_ptr(bindposes[i]) + c * 4);
 		}
-		//inverse here because shader needs the inverse bindpose
-		bindposes[i] = glm::inverse(glm::make_mat4(matrix));
 	}
 	
 	assert(bindposes.size() * sizeof(bindposes[0]) < numeric_limits<uint32_t>::max());
@@ -189,11 +190,17 @@ bool SkeletonAsset::HasBone(const std::string_view boneName) const{
     return IndexForBone(boneName).has_value();
 }
 
+bool SkeletonAsset::HasBone(StringID boneName) const{
+    return boneIndices.contains(boneName);
+}
+
 std::optional<uint16_t> SkeletonAsset::IndexForBone(const std::string_view boneName) const{
-    for (int i = 0; i < skeleton->num_joints(); i++) {
-        if (strncmp(skeleton->joint_names()[i], boneName.data(), boneName.size()) == 0) {
-            return i;
-        }
+    return IndexForBone(StringID(boneName));
+}
+
+std::optional<uint16_t> SkeletonAsset::IndexForBone(StringID boneName) const{
+    if (auto it = boneIndices.find(boneName); it != boneIndices.end()) {
+        return it->second;
     }
     return {};
 };
@@ -0,0 +1,18 @@
+#include "SpatialBoundsComponent.hpp"
+#include "World.hpp"
+#if !RVE_SERVER
+#include "MeshCollection.hpp"
+#endif
+
+using namespace RavEngine;
+
+#if !RVE_SERVER
+SpatialBoundsComponent::SpatialBoundsComponent(Entity owner, const MeshCollectionStatic& mesh) : SpatialBoundsComponent(owner, mesh.GetRadius()) {}
+#endif
+
+void SpatialBoundsComponent::Destroy() {
+    if (proxy != SpatialIndex::INVALID_PROXY) {
+        GetOwner().GetWorld()->spatialIndex.Remove(proxy);
+        proxy = SpatialIndex::INVALID_PROXY;
+    }
+}
@@ -0,0 +1,194 @@
+#include "SpatialIndex.hpp"
+#include <cassert>
+
+using namespace RavEngine;
+
+SpatialIndex::proxy_t SpatialIndex::AllocateNode() {
+    if (freeList == INVALID_PROXY) {
+        nodes.emplace_back();
+        return static_cast<proxy_t>(nodes.size() - 1);
+    }
+    const auto node = freeList;
+    freeList = nodes[node].parent;
+    nodes[node] = Node{};
+    return node;
+}
+
+void SpatialIndex::FreeNode(proxy_t node) {
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+SpatialIndex::proxy_t SpatialIndex::Insert(entity_t entity, const AABB& bounds) {
+    const auto leaf = AllocateNode();
+    auto& node = nodes[leaf];
+    node.entity = entity;
+    node.tight = bounds;
+    node.fat = { bounds.min - vector3(margin), bounds.max + vector3(margin) };
+    InsertLeaf(leaf);
+    nProxies++;
+    return leaf;
+}
+
+bool SpatialIndex::Update(proxy_t proxy, const AABB& bounds) {
+    assert(proxy < nodes.size() && nodes[proxy].IsLeaf() && nodes[proxy].height == 0);
+    nodes[proxy].tight = bounds;
+    if (nodes[proxy].fat.Contains(bounds)) {
+        return false;
+    }
+    RemoveLeaf(proxy);
+    nodes[proxy].fat = { bounds.min - vector3(margin), bounds.max + vector3(margin) };
+    InsertLeaf(proxy);
+    return true;
+}
+
+void SpatialIndex::Remove(proxy_t proxy) {
+    assert(proxy < nodes.size() && nodes[proxy].IsLeaf() && nodes[proxy].height == 0);
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    nProxies--;
+}
+
+void SpatialIndex::InsertLeaf(proxy_t leaf) {
+    if (root == INVALID_PROXY) {
+        root = leaf;
+        nodes[leaf].parent = INVALID_PROXY;
+        return;
+    }
+
+    // descend towards the sibling with the lowest surface area cost
+    const auto box = nodes[leaf].fat;
+    auto index = root;
+    while (!nodes[index].IsLeaf()) {
+        const auto& node = nodes[index];
+        const auto area = node.fat.SurfaceArea();
+        const auto combinedArea = node.fat.Union(box).SurfaceArea();
+        const auto cost = 2 * combinedArea;                     // make a new parent for this node and the leaf
+        const auto inheritanceCost = 2 * (combinedArea - area); // minimum cost of pushing the leaf further down
+
+        auto childCost = [&](proxy_t child) {
+            const auto& c = nodes[child];
+            const auto unionArea = c.fat.Union(box).SurfaceArea();
+            return (c.IsLeaf() ? unionArea : unionArea - c.fat.SurfaceArea()) + inheritanceCost;
+        };
+        const auto cost0 = childCost(node.children[0]);
+        const auto cost1 = childCost(node.children[1]);
+        if (cost < cost0 && cost < cost1) {
+            break;
+        }
+        index = cost0 < cost1 ? node.children[0] : node.children[1];
+    }
+
+    const auto sibling = index;
+    const auto oldParent = nodes[sibling].parent;
+    const auto newParent = AllocateNode();  // may reallocate nodes, so no references are held across this
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].fat = box.Union(nodes[sibling].fat);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].children[0] = sibling;
+    nodes[newParent].children[1] = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == INVALID_PROXY) {
+        root = newParent;
+    }
+    else {
+        auto& p = nodes[oldParent];
+        p.children[p.children[0] == sibling ? 0 : 1] = newParent;
+    }
+    Refit(oldParent);
+}
+
+void SpatialIndex::RemoveLeaf(proxy_t leaf) {
+    if (leaf == root) {
+        root = INVALID_PROXY;
+        return;
+    }
+    const auto parent = nodes[leaf].parent;
+    const auto grandParent = nodes[parent].parent;
+    const auto sibling = nodes[parent].children[0] == leaf ? nodes[parent].children[1] : nodes[parent].children[0];
+
+    if (grandParent == INVALID_PROXY) {
+        root = sibling;
+        nodes[sibling].parent = INVALID_PROXY;
+    }
+    else {
+        auto& g = nodes[grandParent];
+        g.children[g.children[0] == parent ? 0 : 1] = sibling;
+        nodes[sibling].parent = grandParent;
+    }
+    FreeNode(parent);
+    Refit(grandParent);
+}
+
+void SpatialIndex::Refit(proxy_t node) {
+    while (node != INVALID_PROXY) {
+        auto& n = nodes[node];
+        const auto& c0 = nodes[n.children[0]];
+        const auto& c1 = nodes[n.children[1]];
+        n.fat = c0.fat.Union(c1.fat);
+        n.height = 1 + std::max(c0.height, c1.height);
+        node = n.parent;
+    }
+}
+
+template<typename Overlap, typename Visit>
+void SpatialIndex::Traverse(const Overlap& overlaps, const Visit& visit) const {
+    if (root == INVALID_PROXY) {
+        return;
+    }
+    Vector<proxy_t> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const auto& node = nodes[stack.back()];
+        stack.pop_back();
+        if (node.IsLeaf()) {
+            if (overlaps(node.tight) && !visit(node)) {
+                return;
+            }
+        }
+        else if (overlaps(node.fat)) {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+void SpatialIndex::QueryAABB(const AABB& box, FunctionRef<bool(entity_t)> fn) const {
+    Traverse([&box](const AABB& b) { return b.Overlaps(box); }, [&fn](const Node& node) { return fn(node.entity); });
+}
+
+void SpatialIndex::QuerySphere(const vector3& center, float radius, FunctionRef<bool(entity_t)> fn) const {
+    const auto r2 = radius * radius;
+    Traverse([&](const AABB& b) {
+        const auto closest = glm::clamp(center, b.min, b.max);
+        const auto d = closest - center;
+        return glm::dot(d, d) <= r2;
+    }, [&fn](const Node& node) { return fn(node.entity); });
+}
+
+void SpatialIndex::QueryFrustum(const matrix4& viewProj, FunctionRef<bool(entity_t)> fn) const {
+    const auto frustum = Frustum::FromViewProj(viewProj);
+    Traverse([&frustum](const AABB& b) {
+        return frustum.Intersects(b);
+    }, [&fn](const Node& node) { return fn(node.entity); });
+}
+
+void SpatialIndex::RayCast(const vector3& origin, const vector3& direction, float maxDistance, FunctionRef<bool(entity_t, float)> fn) const {
+    const vector3 invDir = 1.0f / direction;
+    float entry = 0;    // set by the overlap test for the box most recently tested
+    auto slab = [&](const AABB& b) {
+        const auto t1 = (b.min - origin) * invDir;
+        const auto t2 = (b.max - origin) * invDir;
+        const auto tNear = glm::min(t1, t2);
+        const auto tFar = glm::max(t1, t2);
+        const auto tMin = std::max({ tNear.x, tNear.y, tNear.z, 0.0f });
+        const auto tMax = std::min({ tFar.x, tFar.y, tFar.z, maxDistance });
+        entry = tMin;
+        return tMin <= tMax;
+    };
+    Traverse(slab, [&](const Node& node) { return fn(node.entity, entry); });
+}
@@ -0,0 +1,79 @@
+#include "SpawnBatch.hpp"
+#include "NetworkBase.hpp"
+#include "World.hpp"
+#include "Debug.hpp"
+#include "Compression.hpp"
+#include <cstring>
+
+using namespace std;
+using namespace RavEngine;
+
+namespace {
+	constexpr size_t recordSize = sizeof(ctti_t) + sizeof(netid_t) + uuids::uuid::nbytes;
+	constexpr size_t headerSize = 1 + World::id_size + 2 * sizeof(uint32_t);
+}
+
+std::string SpawnBatch::Encode(std::span<const Record> records, const std::string_view& worldID)
+{
+	Debug::Assert(records.size() <= recordsPerBatch, "A spawn batch holds at most {} records", recordsPerBatch);
+
+	// columns compress better than interleaved records, since types repeat and session IDs are mostly sequential
+	std::string raw(records.size() * recordSize, 0);
+	auto ptr = raw.data();
+	for (const auto& record : records) {
+		std::memcpy(ptr, &record.type, sizeof(record.type));
+		ptr += sizeof(record.type);
+	}
+	for (const auto& record : records) {
+		std::memcpy(ptr, &record.sessionID, sizeof(record.sessionID));
+		ptr += sizeof(record.sessionID);
+	}
+	for (const auto& record : records) {
+		std::memcpy(ptr, record.id.raw(), uuids::uuid::nbytes);
+		ptr += uuids::uuid::nbytes;
+	}
+
+	const uint32_t count = uint32_t(records.size()), rawSize = uint32_t(raw.size());
+	std::string batch(headerSize + Compression::DeflateBound(rawSize), 0);
+	batch[0] = char(NetworkBase::CommandCode::SpawnBatch);
+	std::memcpy(batch.data() + 1, worldID.data(), std::min<size_t>(worldID.size(), World::id_size));
+	std::memcpy(batch.data() + 1 + World::id_size, &count, sizeof(count));
+	std::memcpy(batch.data() + 1 + World::id_size + sizeof(count), &rawSize, sizeof(rawSize));
+	const auto compressedSize = Compression::Deflate(std::as_bytes(std::span(raw)), std::as_writable_bytes(std::span(batch).subspan(headerSize)));
+	batch.resize(headerSize + compressedSize);
+	return batch;
+}
+
+bool SpawnBatch::Decode(const std::string_view& batch, std::string& worldID, Vector<Record>& records)
+{
+	if (batch.size() < headerSize) {
+		return false;
+	}
+	uint32_t count, rawSize;
+	std::memcpy(&count, batch.data() + 1 + World::id_size, sizeof(count));
+	std::memcpy(&rawSize, batch.data() + 1 + World::id_size + sizeof(count), sizeof(rawSize));
+	if (count > recordsPerBatch || rawSize != count * recordSize) {
+		return false;
+	}
+	std::string raw(rawSize, 0);
+	if (!Compression::Inflate(std::as_bytes(std::span(batch).subspan(headerSize)), std::as_writable_bytes(std::span(raw)))) {
+		return false;
+	}
+
+	worldID.assign(batch.data() + 1, World::id_size);
+	records.resize(count);
+	auto ptr = raw.data();
+	for (auto& record : records) {
+		std::memcpy(&record.type, ptr, sizeof(record.type));
+		ptr += sizeof(record.type);
+	}
+	for (auto& record : records) {
+		std::memcpy(&record.sessionID, ptr, sizeof(record.sessionID));
+		ptr += sizeof(record.sessionID);
+	}
+	for (auto& record : records) {
+		record.id = uuids::uuid(ptr);
+		ptr += uuids::uuid::nbytes;
+	}
+	return true;
+}
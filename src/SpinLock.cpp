@@ -0,0 +1,92 @@
+#include "SpinLock.hpp"
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <string_view>
+#if defined __x86_64__ || defined _M_X64
+#include <immintrin.h>
+#endif
+
+using namespace RavEngine;
+
+namespace RavEngine {
+	struct LockSiteStats {
+		const char* site;
+		std::atomic<uint64_t> contentions = 0, waitNs = 0;
+	};
+}
+
+namespace {
+	inline void CPURelax() {
+#if defined __x86_64__ || defined _M_X64
+		_mm_pause();
+#elif defined __aarch64__
+		asm volatile("yield");
+#elif defined _M_ARM64
+		__yield();
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+#if RVE_PROFILE
+	std::mutex sitesMtx;
+	std::vector<std::unique_ptr<LockSiteStats>> sites;
+
+	LockSiteStats* StatsForSite(const char* site) {
+		const std::string_view name = site ? site : "unnamed";
+		std::lock_guard guard(sitesMtx);
+		for (const auto& stats : sites) {
+			if (stats->site == name) {
+				return stats.get();
+			}
+		}
+		return sites.emplace_back(new LockSiteStats{ site ? site : "unnamed" }).get();
+	}
+#endif
+
+	// about a microsecond of pausing before parking, the length of a typical critical section under these locks
+	constexpr uint32_t maxSpins = 10;
+}
+
+void SpinLock::LockContended() {
+#if RVE_PROFILE
+	const auto start = std::chrono::steady_clock::now();
+#endif
+	bool acquired = false;
+	for (uint32_t spin = 0; spin < maxSpins && !acquired; spin++) {
+		// exponential backoff, so that waiters don't hammer the cache line
+		for (uint32_t i = 0; i < (1u << spin); i++) {
+			CPURelax();
+		}
+		uint32_t expected = 0;
+		acquired = state.load(std::memory_order_relaxed) == 0 && state.compare_exchange_weak(expected, 1, std::memory_order_acquire);
+	}
+	if (!acquired) {
+		// marking the lock 2 tells the owner to wake a waiter when it unlocks
+		while (state.exchange(2, std::memory_order_acquire) != 0) {
+			state.wait(2, std::memory_order_relaxed);
+		}
+	}
+#if RVE_PROFILE
+	auto siteStats = stats.load(std::memory_order_relaxed);
+	if (siteStats == nullptr) {
+		siteStats = StatsForSite(site);
+		stats.store(siteStats, std::memory_order_relaxed);
+	}
+	siteStats->contentions.fetch_add(1, std::memory_order_relaxed);
+	siteStats->waitNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+#endif
+}
+
+std::vector<SpinLock::ContentionStats> SpinLock::GetContentionStats() {
+	std::vector<ContentionStats> result;
+#if RVE_PROFILE
+	std::lock_guard guard(sitesMtx);
+	for (const auto& stats : sites) {
+		result.push_back({ stats->site, stats->contentions.load(std::memory_order_relaxed), stats->waitNs.load(std::memory_order_relaxed) / 1e6 });
+	}
+#endif
+	return result;
+}
@@ -7,7 +7,7 @@ namespace RavEngine {
 		size_t nBytesToRead = std::min(outData.size_bytes(), data.size_bytes() - offset);
 
 		if (nBytesToRead > 0) {
-			std::memcpy(outData.data(), data.data(), nBytesToRead);
+			std::memcpy(outData.data(), data.data() + offset, nBytesToRead);
 		}
 		else {
 			return { 0, IStreamStatus::EndOfStream };
@@ -0,0 +1,36 @@
+#include "StringID.hpp"
+#include "Map.hpp"
+#include "SpinLock.hpp"
+#include "Debug.hpp"
+#include <string>
+
+using namespace RavEngine;
+
+// node storage, so that views of the strings stay valid as the map grows
+static auto& InternedStrings() {
+    static locked_node_hashmap<uint64_t, std::string, SpinLock> strings;
+    return strings;
+}
+
+StringID RavEngine::Intern(std::string_view str) {
+    const StringID id(str);
+    InternedStrings().lazy_emplace_l(id.value,
+        [&](const std::string& existing) {
+#ifndef NDEBUG
+            Debug::Assert(existing == str, "StringID collision between {} and {}", existing, str);
+#endif
+        },
+        [&](const auto& ctor) {
+            ctor(id.value, std::string(str));
+        }
+    );
+    return id;
+}
+
+std::string_view StringID::ToString() const {
+    std::string_view str;
+    InternedStrings().if_contains(value, [&](const std::string& interned) {
+        str = interned;
+    });
+    return str;
+}
@@ -19,13 +19,26 @@
     #include <dxgi1_4.h>
     #include <locale>
     #include <codecvt>
+    #include <Windows.h>
+    #undef min
+    #undef max
 #elif defined __APPLE__
     #include "AppleUtilities.h"
+    #include <sys/sysctl.h>
+    #include <pthread.h>
+    #include <sys/qos.h>
+    #include <mach/mach.h>
 #elif defined __linux__
     #include <sys/utsname.h>
     #include <sys/sysinfo.h>
     #include <fstream>
+    #include <filesystem>
+    #include <sched.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
 #endif
+#include <algorithm>
 
 using namespace RavEngine;
 using namespace std;
@@ -50,6 +63,186 @@ uint16_t RavEngine::SystemInfo::NumLogicalProcessors()
 	return thread::hardware_concurrency();
 }
 
+#ifdef __linux__
+namespace {
+    // parses sysfs cpu lists such as "0-3,8,10-11"
+    std::vector<uint16_t> ReadCPUList(const std::filesystem::path& path) {
+        std::vector<uint16_t> cpus;
+        std::ifstream in(path);
+        std::string range;
+        while (std::getline(in, range, ',')) {
+            int first = 0, last = 0;
+            const auto n = sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (n < 1) {
+                continue;
+            }
+            for (int cpu = first; cpu <= (n == 2 ? last : first); cpu++) {
+                cpus.push_back(uint16_t(cpu));
+            }
+        }
+        return cpus;
+    }
+
+    int ReadInt(const std::filesystem::path& path, int fallback) {
+        std::ifstream in(path);
+        int value = fallback;
+        in >> value;
+        return in ? value : fallback;
+    }
+}
+#endif
+
+uint16_t SystemInfo::CPUTopology::NumCores(CoreClass coreClass) const {
+    return uint16_t(std::count_if(cores.begin(), cores.end(), [coreClass](const LogicalCore& core) { return core.coreClass == coreClass; }));
+}
+
+const SystemInfo::CPUTopology& SystemInfo::GetCPUTopology() {
+    static const CPUTopology topology = [] {
+        CPUTopology topology;
+#ifdef _WIN32
+        ULONG size = 0;
+        GetSystemCpuSetInformation(nullptr, 0, &size, GetCurrentProcess(), 0);
+        std::vector<uint8_t> buffer(size);
+        if (size > 0 && GetSystemCpuSetInformation(reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data()), size, &size, GetCurrentProcess(), 0)) {
+            std::vector<BYTE> efficiencyClasses;
+            std::vector<std::pair<uint32_t, uint32_t>> physicalCores;  // (group, core index), since core indices are per group
+            for (ULONG offset = 0; offset < size;) {
+                auto info = reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data() + offset);
+                if (info->Type == CpuSetInformation) {
+                    const auto key = std::make_pair(uint32_t(info->CpuSet.Group), uint32_t(info->CpuSet.CoreIndex));
+                    auto it = std::find(physicalCores.begin(), physicalCores.end(), key);
+                    if (it == physicalCores.end()) {
+                        it = physicalCores.insert(it, key);
+                    }
+                    // the core's id is its CPU set ID, which is what SetThreadSelectedCpuSets takes
+                    topology.cores.push_back({ uint16_t(info->CpuSet.Id), uint16_t(it - physicalCores.begin()), uint16_t(info->CpuSet.NumaNodeIndex) });
+                    efficiencyClasses.push_back(info->CpuSet.EfficiencyClass);
+                }
+                offset += info->Size;
+            }
+            // a higher efficiency class is a faster core
+            const auto maxEfficiency = efficiencyClasses.empty() ? 0 : *std::max_element(efficiencyClasses.begin(), efficiencyClasses.end());
+            for (size_t i = 0; i < topology.cores.size(); i++) {
+                topology.cores[i].coreClass = efficiencyClasses[i] == maxEfficiency ? CoreClass::Performance : CoreClass::Efficiency;
+            }
+        }
+#elif defined __APPLE__
+        auto sysctlInt = [](const char* name) {
+            int value = 0;
+            size_t len = sizeof(value);
+            return sysctlbyname(name, &value, &len, nullptr, 0) == 0 ? value : 0;
+        };
+        const int logical = std::max(sysctlInt("hw.logicalcpu"), 1);
+        const int physical = std::max(sysctlInt("hw.physicalcpu"), 1);
+        // perflevel0 is the fastest. Intel Macs have no perflevels
+        const int perfCores = sysctlInt("hw.nperflevels") > 1 ? sysctlInt("hw.perflevel0.logicalcpu") : logical;
+        for (int i = 0; i < logical; i++) {
+            topology.cores.push_back({ uint16_t(i), uint16_t(i * physical / logical), 0, i < perfCores ? CoreClass::Performance : CoreClass::Efficiency });
+        }
+#elif defined __linux__
+        const std::filesystem::path cpuDir = "/sys/devices/system/cpu";
+        std::error_code ec;
+        std::vector<uint16_t> firstSiblings;
+        for (const auto cpu : ReadCPUList(cpuDir / "online")) {
+            const auto dir = cpuDir / ("cpu" + std::to_string(cpu));
+            LogicalCore core{ cpu };
+            // a physical core is named by the lowest logical core on it
+            const auto siblings = ReadCPUList(dir / "topology" / "thread_siblings_list");
+            const auto first = siblings.empty() ? cpu : siblings.front();
+            auto it = std::find(firstSiblings.begin(), firstSiblings.end(), first);
+            if (it == firstSiblings.end()) {
+                it = firstSiblings.insert(it, first);
+            }
+            core.physicalCore = uint16_t(it - firstSiblings.begin());
+            topology.cores.push_back(core);
+        }
+        // Intel hybrid CPUs list their efficiency cores as a separate PMU. ARM reports a relative capacity per core instead,
+        // where cores with under half of the fastest core's capacity are the little cores.
+        const auto atomCores = ReadCPUList("/sys/devices/cpu_atom/cpus");
+        int maxCapacity = 0;
+        for (const auto& core : topology.cores) {
+            maxCapacity = std::max(maxCapacity, ReadInt(cpuDir / ("cpu" + std::to_string(core.id)) / "cpu_capacity", 0));
+        }
+        for (auto& core : topology.cores) {
+            const bool isAtom = std::find(atomCores.begin(), atomCores.end(), core.id) != atomCores.end();
+            const auto capacity = ReadInt(cpuDir / ("cpu" + std::to_string(core.id)) / "cpu_capacity", maxCapacity);
+            core.coreClass = isAtom || capacity * 2 < maxCapacity ? CoreClass::Efficiency : CoreClass::Performance;
+        }
+        for (const auto& node : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+            const auto name = node.path().filename().string();
+            if (name.starts_with("node")) {
+                const auto nodeIndex = uint16_t(std::atoi(name.c_str() + 4));
+                for (const auto cpu : ReadCPUList(node.path() / "cpulist")) {
+                    for (auto& core : topology.cores) {
+                        if (core.id == cpu) {
+                            core.numaNode = nodeIndex;
+                        }
+                    }
+                }
+            }
+        }
+#endif
+        if (topology.cores.empty()) {
+            for (uint16_t i = 0; i < std::max<uint16_t>(NumLogicalProcessors(), 1); i++) {
+                topology.cores.push_back({ i, i });
+            }
+        }
+        for (const auto& core : topology.cores) {
+            topology.numPhysicalCores = std::max<uint16_t>(topology.numPhysicalCores, core.physicalCore + 1);
+            topology.numNumaNodes = std::max<uint16_t>(topology.numNumaNodes, core.numaNode + 1);
+        }
+        topology.hybrid = topology.NumCores(CoreClass::Performance) > 0 && topology.NumCores(CoreClass::Efficiency) > 0;
+        return topology;
+    }();
+    return topology;
+}
+
+void SystemInfo::PlaceCurrentThread(ThreadRole role) {
+#ifdef __APPLE__
+    pthread_set_qos_class_self_np(role == ThreadRole::LatencyCritical ? QOS_CLASS_USER_INTERACTIVE : QOS_CLASS_UTILITY, 0);
+#elif defined _WIN32 || defined __linux__
+    const auto& topology = GetCPUTopology();
+    const auto wanted = role == ThreadRole::LatencyCritical ? CoreClass::Performance : CoreClass::Efficiency;
+    // with only one kind of core, leave placement to the OS
+    const bool steer = topology.hybrid && topology.NumCores(wanted) > 0;
+#ifdef _WIN32
+    if (steer) {
+        // CPU sets are a preference, so the thread still runs elsewhere if its cores are busy
+        std::vector<ULONG> ids;
+        for (const auto& core : topology.cores) {
+            if (core.coreClass == wanted) {
+                ids.push_back(core.id);
+            }
+        }
+        SetThreadSelectedCpuSets(GetCurrentThread(), ids.data(), ULONG(ids.size()));
+    }
+    if (role == ThreadRole::Background) {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+    }
+#else
+    if (steer) {
+        // only narrow the cores the process may already use, so that taskset and cgroup limits still apply
+        cpu_set_t allowed, set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (const auto& core : topology.cores) {
+                if (core.coreClass == wanted && CPU_ISSET(core.id, &allowed)) {
+                    CPU_SET(core.id, &set);
+                }
+            }
+            if (CPU_COUNT(&set) > 0) {
+                sched_setaffinity(0, sizeof(set), &set);
+            }
+        }
+    }
+    if (role == ThreadRole::Background) {
+        // Linux applies niceness per thread
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+    }
+#endif
+#endif
+}
+
 std::string SystemInfo::CPUBrandString(){
 #ifdef __APPLE__
     char buf[100]{0};
@@ -153,6 +346,29 @@ uint32_t SystemInfo::SystemRAM(){
     return 0;
 }
 
+uint64_t SystemInfo::ProcessResidentMemory(){
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS){
+        return info.resident_size;
+    }
+#elif _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))){
+        return counters.WorkingSetSize;
+    }
+#elif __linux__
+    // the second field is the resident set, in pages
+    uint64_t pages = 0, resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    if (statm >> pages >> resident){
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return 0;
+}
+
 #if !RVE_SERVER
 
 std::string SystemInfo::GPUBrandString(){
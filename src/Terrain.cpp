@@ -0,0 +1,303 @@
+#include "Terrain.hpp"
+#include "App.hpp"
+#include "VirtualFileSystem.hpp"
+#include "Profile.hpp"
+#include "Debug.hpp"
+#include "GameObject.hpp"
+#include "PhysicsBodyComponent.hpp"
+#include "PhysicsCollider.hpp"
+#if !RVE_SERVER
+#include "StaticMesh.hpp"
+#include "MeshCollection.hpp"
+#include "BuiltinMaterials.hpp"
+#include "Texture.hpp"
+#endif
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+using namespace RavEngine;
+
+namespace {
+#if !RVE_SERVER
+    // a square grid of quads on [-0.5, 0.5] in XZ, with a skirt down from each edge. Skirt vertices have a U of 1.
+    // Its tangent frame is the identity, so the terrain's fragment shader outputs normals in object space.
+    Ref<MeshAsset> MakePatchGrid(uint32_t quads) {
+        MeshPart grid;
+        const uint32_t side = quads + 1;
+        auto addVertex = [&](uint32_t x, uint32_t z, bool skirt) {
+            grid.positions.push_back({ float(x) / quads - 0.5f, 0, float(z) / quads - 0.5f });
+            grid.normals.push_back({ 0, 0, 1 });
+            grid.tangents.push_back({ 1, 0, 0 });
+            grid.bitangents.push_back({ 0, 1, 0 });
+            grid.uv0.push_back({ skirt ? 1.f : 0.f, 0.f });
+        };
+        grid.ReserveVerts(side * side + side * 4);
+        for (uint32_t z = 0; z < side; z++) {
+            for (uint32_t x = 0; x < side; x++) {
+                addVertex(x, z, false);
+            }
+        }
+        // split each cell from (x, z) to (x + 1, z + 1), like Heightfield::Sample and the HeightfieldCollider
+        for (uint32_t z = 0; z < quads; z++) {
+            for (uint32_t x = 0; x < quads; x++) {
+                const uint32_t i00 = z * side + x, i10 = i00 + 1, i01 = i00 + side, i11 = i01 + 1;
+                grid.indices.insert(grid.indices.end(), { i00, i01, i11, i00, i11, i10 });
+            }
+        }
+
+        // walking the perimeter counterclockwise from above makes each skirt face out
+        auto addSkirt = [&](int32_t x, int32_t z, int32_t dx, int32_t dz) {
+            const auto first = grid.NumVerts();
+            for (uint32_t i = 0; i <= quads; i++) {
+                addVertex(x + dx * i, z + dz * i, true);
+            }
+            for (uint32_t i = 0; i < quads; i++) {
+                const uint32_t top0 = (z + dz * i) * side + x + dx * i, top1 = (z + dz * (i + 1)) * side + x + dx * (i + 1);
+                const uint32_t bottom0 = first + i, bottom1 = bottom0 + 1;
+                grid.indices.insert(grid.indices.end(), { top0, top1, bottom0, top1, bottom1, bottom0 });
+            }
+        };
+        addSkirt(0, 0, 1, 0);
+        addSkirt(quads, 0, 0, 1);
+        addSkirt(quads, quads, -1, 0);
+        addSkirt(0, quads, 0, -1);
+
+        grid.attributes.position = true;
+        grid.attributes.normal = true;
+        grid.attributes.tangent = true;
+        grid.attributes.bitangent = true;
+        grid.attributes.uv0 = true;
+        return New<MeshAsset>(grid);
+    }
+#endif
+}
+
+Terrain::Terrain(path_fn tilePath, Ref<PhysicsMaterial> physicsMaterial, const Config& config) : tilePath(std::move(tilePath)), physicsMaterial(physicsMaterial), config(config) {
+#if !RVE_SERVER
+    Debug::Assert(config.numLODs > 0 && (config.patchResolution >> (config.numLODs - 1)) > 0, "Terrain patches have more LODs than their resolution allows");
+    patchMesh = New<MeshCollectionStatic>();
+    for (uint8_t lod = 0; lod < config.numLODs; lod++) {
+        patchMesh->AddMesh({ MakePatchGrid(config.patchResolution >> lod), lod == 0 ? 0 : config.lodDistance * float(1u << (lod - 1)) });
+    }
+    material = Material::Manager::Get<TerrainMaterial>();
+#endif
+}
+
+Terrain::~Terrain() {
+    // loads reference the queue
+    while (loadsInFlight > 0) {
+        std::this_thread::yield();
+    }
+}
+
+bool Terrain::IsResident(StreamingCell tile) const {
+    const auto it = tiles.find(KeyFor(tile));
+    return it != tiles.end() && it->second.state == TileState::Resident;
+}
+
+std::optional<float> Terrain::SampleHeight(glm::vec3 position) const {
+    const StreamingCell coord{ int32_t(std::floor(position.x / config.tileSize)), int32_t(std::floor(position.z / config.tileSize)) };
+    const auto it = tiles.find(KeyFor(coord));
+    if (it == tiles.end() || it->second.state != TileState::Resident || it->second.empty) {
+        return std::nullopt;
+    }
+    return it->second.data.heights.Sample(position.x - coord.x * config.tileSize, position.z - coord.z * config.tileSize);
+}
+
+void Terrain::SetLayerTexture(uint8_t layer, Ref<Texture> texture) {
+#if !RVE_SERVER
+    layerTextures.at(layer) = texture;
+    for (auto& [key, tile] : tiles) {
+        if (tile.material) {
+            tile.material->SetLayerTexture(layer, texture);
+        }
+    }
+#endif
+}
+
+void Terrain::Commit(World& world, StreamingCell coord, Tile& tile) {
+    RVE_PROFILE_FN;
+    const auto& heights = tile.data.heights;
+    const glm::vec3 origin{ coord.x * config.tileSize, 0, coord.z * config.tileSize };
+
+    auto body = world.Instantiate<GameObject>();
+    body.GetTransform().SetLocalPosition(origin);
+    body.EmplaceComponent<RigidBodyStaticComponent>().EmplaceCollider<HeightfieldCollider>(heights, physicsMaterial);
+    tile.entities.push_back(body.id);
+
+#if !RVE_SERVER
+    const uint32_t resolution = heights.width;
+    auto makeTexture = [](const void* data, size_t bytes, uint32_t size, RGL::TextureFormat format, std::string_view debugName) {
+        return New<RuntimeTexture>(size, size, Texture::Config{
+            .initialData = {{data, bytes}},
+            .format = format,
+            .debugName = debugName,
+        });
+    };
+    auto heightTexture = makeTexture(heights.heights.data(), heights.heights.size() * sizeof(float), resolution, RGL::TextureFormat::R32_Float, "Terrain heights");
+    auto normalTexture = makeTexture(tile.normals.data(), tile.normals.size() * sizeof(tile.normals[0]), resolution, RGL::TextureFormat::RGBA8_Unorm, "Terrain normals");
+    Ref<Texture> splatTexture;
+    if (tile.data.splatResolution > 0) {
+        splatTexture = makeTexture(tile.data.splat.data(), tile.data.splat.size() * sizeof(tile.data.splat[0]), tile.data.splatResolution, RGL::TextureFormat::RGBA8_Unorm, "Terrain splat");
+    }
+    else {
+        // without a splat map, the tile is all the first layer
+        constexpr std::array<uint8_t, 4> firstLayer{ 255, 0, 0, 0 };
+        splatTexture = makeTexture(firstLayer.data(), sizeof(firstLayer), 1, RGL::TextureFormat::RGBA8_Unorm, "Terrain splat");
+    }
+    tile.data.splat = {};
+    tile.normals = {};
+
+    tile.material = New<TerrainMaterialInstance>(material, heightTexture, normalTexture, splatTexture, TerrainPushConstantData{
+        .tileOrigin = { origin.x, origin.z },
+        .tileSize = config.tileSize,
+        .resolution = resolution,
+        .skirtDepth = config.skirtDepth,
+    });
+    for (uint8_t layer = 0; layer < layerTextures.size(); layer++) {
+        if (layerTextures[layer]) {
+            tile.material->SetLayerTexture(layer, layerTextures[layer]);
+        }
+    }
+
+    const float patchSize = config.tileSize / config.patchesPerSide;
+    const auto quads = config.patchResolution;
+    for (uint32_t pz = 0; pz < config.patchesPerSide; pz++) {
+        for (uint32_t px = 0; px < config.patchesPerSide; px++) {
+            const auto range = heights.HeightRange(px * quads, pz * quads, (px + 1) * quads, (pz + 1) * quads);
+            const float bottom = range.min - config.skirtDepth;
+            const float halfHeight = (range.max - bottom) * 0.5f;
+
+            // the grid's bounding sphere has a radius of sqrt(0.5), and culling scales it by the largest axis.
+            // Stretching Y past the patch's size makes the sphere hold the patch's heights and skirts.
+            auto patch = world.Instantiate<GameObject>();
+            auto& transform = patch.GetTransform();
+            transform.SetLocalPosition({ origin.x + (px + 0.5f) * patchSize, bottom + halfHeight, origin.z + (pz + 0.5f) * patchSize });
+            transform.SetLocalScale(vector3(patchSize, std::sqrt(patchSize * patchSize + 2 * halfHeight * halfHeight), patchSize));
+            transform.SetStatic(true);
+            patch.EmplaceComponent<StaticMesh>(patchMesh, tile.material);
+            tile.entities.push_back(patch.id);
+        }
+    }
+#endif
+}
+
+void Terrain::Evict(World& world, Tile& tile) {
+    for (const auto id : tile.entities) {
+        // gameplay may have destroyed it already, and its ID may belong to another entity now
+        if (world.CorrectVersion(id)) {
+            Entity(id, &world).Destroy();
+        }
+    }
+    tile.entities.clear();
+}
+
+void Terrain::Update(World& world, std::span<const glm::vec3> anchors) {
+    RVE_PROFILE_FN;
+    auto distanceToAnchors = [&](StreamingCell tile) {
+        float closest = std::numeric_limits<float>::infinity();
+        for (const auto& anchor : anchors) {
+            closest = std::min(closest, StreamingCellDistance(tile, anchor, config.tileSize));
+        }
+        return closest;
+    };
+
+    // loads that finished wait to commit, unless their tile was evicted in the meantime
+    LoadedTile result;
+    while (loadedTiles.try_dequeue(result)) {
+        const auto it = tiles.find(KeyFor(result.tile));
+        if (it == tiles.end() || it->second.generation != result.generation || it->second.state != TileState::Loading) {
+            continue;
+        }
+        it->second.state = TileState::Loaded;
+        it->second.empty = result.empty;
+        it->second.data = std::move(result.data);
+        it->second.normals = std::move(result.normals);
+        loaded.push_back(result.tile);
+    }
+
+    // evict the tiles out of range
+    evicted.clear();
+    for (auto& [key, tile] : tiles) {
+        const StreamingCell coord{ int32_t(uint32_t(key >> 32)), int32_t(uint32_t(key)) };
+        if (distanceToAnchors(coord) > config.unloadRadius) {
+            Evict(world, tile);
+            evicted.push_back(key);
+        }
+    }
+    for (const auto key : evicted) {
+        tiles.erase(key);
+    }
+    std::erase_if(loaded, [this](StreamingCell coord) {
+        return !tiles.contains(KeyFor(coord));
+    });
+
+    // holes cost nothing to commit, so they do not count against the budget
+    uint32_t budget = config.tilesPerFrame;
+    while (!loaded.empty() && budget > 0) {
+        const auto coord = loaded.front();
+        loaded.erase(loaded.begin());
+        auto& tile = tiles.at(KeyFor(coord));
+        tile.state = TileState::Resident;
+        if (!tile.empty) {
+            Commit(world, coord, tile);
+            budget--;
+        }
+    }
+
+    // start loading the closest missing tiles
+    if (loadsInFlight >= config.maxLoadsInFlight) {
+        return;
+    }
+    candidates.clear();
+    for (const auto& anchor : anchors) {
+        tilesNearAnchor.clear();
+        StreamingCellsWithin(anchor, config.loadRadius, config.tileSize, tilesNearAnchor);
+        for (const auto coord : tilesNearAnchor) {
+            if (!tiles.contains(KeyFor(coord))) {
+                candidates.emplace_back(distanceToAnchors(coord), coord);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (const auto& [distance, coord] : candidates) {
+        if (loadsInFlight >= config.maxLoadsInFlight) {
+            break;
+        }
+        // anchors near each other list the same tiles
+        auto [it, inserted] = tiles.try_emplace(KeyFor(coord));
+        if (!inserted) {
+            continue;
+        }
+        it->second.generation = nextGeneration++;
+        loadsInFlight++;
+        GetApp()->backgroundExecutor.silent_async([this, coord, generation = it->second.generation, path = tilePath(coord)] {
+            LoadedTile result{ coord, generation };
+            auto& resources = GetApp()->GetResources();
+            if (!path.empty() && resources.Exists(path.c_str())) {
+                const auto bytes = resources.FileContentsAt<Vector<std::byte>>(path.c_str(), false);
+                const auto expected = config.patchesPerSide * config.patchResolution + 1;
+                if (ParseTerrainTile(bytes, config.tileSize, result.data) && result.data.heights.width == expected) {
+                    const auto& heights = result.data.heights;
+                    result.normals.resize(heights.heights.size());
+                    for (uint32_t z = 0; z < heights.depth; z++) {
+                        for (uint32_t x = 0; x < heights.width; x++) {
+                            const auto normal = heights.Normal(x, z) * 0.5f + 0.5f;
+                            result.normals[size_t(z) * heights.width + x] = { uint8_t(std::lround(normal.x * 255)), uint8_t(std::lround(normal.y * 255)), uint8_t(std::lround(normal.z * 255)), 255 };
+                        }
+                    }
+                    result.empty = false;
+                }
+                else {
+                    Debug::Warning("{} is not a terrain tile with {} samples per side", path, expected);
+                }
+            }
+            loadedTiles.enqueue(std::move(result));
+            loadsInFlight--;
+        });
+    }
+}
@@ -15,6 +15,11 @@
 #include <RGL/Texture.hpp>
 #endif
 #include <dds.hpp>
+#include "KTX2.hpp"
+#include "TextureStreamer.hpp"
+#include <fstream>
+#include <bit>
+#include <algorithm>
 
 using namespace std;
 using namespace RavEngine;
@@ -23,6 +28,25 @@ STATIC(Texture::Manager::defaultTexture);
 STATIC(Texture::Manager::defaultNormalTexture);
 STATIC(Texture::Manager::zeroTexture);
 
+// a 2x2 box filter, repeating the last row and column of odd-sized images
+static Vector<std::byte> DownsampleRGBA8(const Vector<std::byte>& source, uint32_t width, uint32_t height) {
+    constexpr uint32_t channels = 4;
+    const uint32_t newWidth = std::max(width / 2, 1u), newHeight = std::max(height / 2, 1u);
+    Vector<std::byte> result(size_t(newWidth) * newHeight * channels);
+    for (uint32_t y = 0; y < newHeight; y++) {
+        const uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < newWidth; x++) {
+            const uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            for (uint32_t c = 0; c < channels; c++) {
+                const uint32_t sum = uint32_t(source[(size_t(y0) * width + x0) * channels + c]) + uint32_t(source[(size_t(y0) * width + x1) * channels + c])
+                    + uint32_t(source[(size_t(y1) * width + x0) * channels + c]) + uint32_t(source[(size_t(y1) * width + x1) * channels + c]);
+                result[(size_t(y) * newWidth + x) * channels + c] = std::byte((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
 inline static bool IsRasterImage(const std::string& filepath){
     // assume that anything not in the whitelist is a raster image
     if (Filesystem::Path(filepath).extension() == ".svg"){
@@ -49,6 +73,81 @@ Texture::Texture(const std::string& name, uint16_t width, uint16_t height){
     });
 }
 
+static RGL::TextureFormat FormatForDDS(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_BC1_UNORM: return RGL::TextureFormat::BC1_RGBA_Unorm;
+    case DXGI_FORMAT_BC1_UNORM_SRGB: return RGL::TextureFormat::BC1_RGBA_SRGB;
+    case DXGI_FORMAT_BC3_UNORM: return RGL::TextureFormat::BC3_Unorm;
+    case DXGI_FORMAT_BC3_UNORM_SRGB: return RGL::TextureFormat::BC3_SRGB;
+    case DXGI_FORMAT_BC4_UNORM: return RGL::TextureFormat::BC4_Unorm;
+    case DXGI_FORMAT_BC5_UNORM: return RGL::TextureFormat::BC5_Unorm;
+    case DXGI_FORMAT_BC7_UNORM: return RGL::TextureFormat::BC7_Unorm;
+    case DXGI_FORMAT_BC7_UNORM_SRGB: return RGL::TextureFormat::BC7_SRGB;
+    case DXGI_FORMAT_R8_UNORM: return RGL::TextureFormat::R8_Unorm;
+    case DXGI_FORMAT_R8G8_UNORM: return RGL::TextureFormat::RG8_Unorm;
+    case DXGI_FORMAT_R8G8B8A8_UNORM: return RGL::TextureFormat::RGBA8_Unorm;
+    default:
+        Debug::Fatal("Invalid DDS format: {}", uint32_t(format));
+    }
+}
+
+// VkFormat values of the formats RGL can sample
+static RGL::TextureFormat FormatForKTX2(uint32_t vkFormat) {
+    switch (vkFormat) {
+    case 9: return RGL::TextureFormat::R8_Unorm;
+    case 13: return RGL::TextureFormat::R8_Uint;
+    case 16: return RGL::TextureFormat::RG8_Unorm;
+    case 37: return RGL::TextureFormat::RGBA8_Unorm;
+    case 41: return RGL::TextureFormat::RGBA8_Uint;
+    case 44: return RGL::TextureFormat::BGRA8_Unorm;
+    case 76: return RGL::TextureFormat::R16_Float;
+    case 91: return RGL::TextureFormat::RGBA16_Unorm;
+    case 92: return RGL::TextureFormat::RGBA16_Snorm;
+    case 97: return RGL::TextureFormat::RGBA16_Sfloat;
+    case 98: return RGL::TextureFormat::R32_Uint;
+    case 100: return RGL::TextureFormat::R32_Float;
+    case 109: return RGL::TextureFormat::RGBA32_Sfloat;
+    case 131: return RGL::TextureFormat::BC1_RGB_Unorm;
+    case 132: return RGL::TextureFormat::BC1_RGB_SRGB;
+    case 133: return RGL::TextureFormat::BC1_RGBA_Unorm;
+    case 134: return RGL::TextureFormat::BC1_RGBA_SRGB;
+    case 135: return RGL::TextureFormat::BC2_Unorm;
+    case 136: return RGL::TextureFormat::BC2_SRGB;
+    case 137: return RGL::TextureFormat::BC3_Unorm;
+    case 138: return RGL::TextureFormat::BC3_SRGB;
+    case 139: return RGL::TextureFormat::BC4_Unorm;
+    case 141: return RGL::TextureFormat::BC5_Unorm;
+    case 145: return RGL::TextureFormat::BC7_Unorm;
+    case 146: return RGL::TextureFormat::BC7_SRGB;
+    default:
+        return RGL::TextureFormat::Undefined;
+    }
+}
+
+void RavEngine::Texture::InitFromRGBA8(const unsigned char* pixels, int width, int height)
+{
+    // upload every mip down to 1x1, tightly packed and largest first
+    const uint8_t numMips = uint8_t(std::bit_width(uint32_t(std::max(width, height))));
+    Vector<std::byte> mip(reinterpret_cast<const std::byte*>(pixels), reinterpret_cast<const std::byte*>(pixels) + size_t(width) * height * 4);
+    Vector<std::byte> mipChain;
+    mipChain.reserve(mip.size() * 4 / 3 + numMips * 4);
+    uint32_t mipWidth = width, mipHeight = height;
+    for (uint8_t i = 0; i < numMips; i++) {
+        if (i > 0) {
+            mip = DownsampleRGBA8(mip, mipWidth, mipHeight);
+            mipWidth = std::max(mipWidth / 2, 1u);
+            mipHeight = std::max(mipHeight / 2, 1u);
+        }
+        mipChain.insert(mipChain.end(), mip.begin(), mip.end());
+    }
+
+    CreateTexture(width, height, {
+        .mipLevels = numMips,
+        .numLayers = 1,
+        .initialData = {{mipChain.data(), mipChain.size()}}
+    });
+}
+
 void RavEngine::Texture::InitFromDDS(IStream& stream)
 {
    
@@ -62,24 +161,60 @@ void RavEngine::Texture::InitFromDDS(IStream& stream)
         Debug::Fatal("Cannot load DDS: {}", uint32_t(result));
     }
 
-    RGL::TextureFormat dxtFormat = RGL::TextureFormat::Undefined;
-    switch (ddsImg.format) {
-    case DXGI_FORMAT_BC1_UNORM: dxtFormat = RGL::TextureFormat::BC1_RGBA_Unorm;  break;
-    case DXGI_FORMAT_BC3_UNORM: dxtFormat = RGL::TextureFormat::BC3_Unorm; break;
-    case DXGI_FORMAT_BC5_UNORM: dxtFormat = RGL::TextureFormat::BC5_Unorm; break;
-    default:
-        Debug::Fatal("Invalid DDS format: {}", uint32_t(ddsImg.format));
-    }
+    const auto dxtFormat = FormatForDDS(ddsImg.format);
 
+    // the mips follow each other in the file, largest first
+    size_t totalSize = 0;
+    for (const auto& mip : ddsImg.mipmaps) {
+        totalSize += mip.size();
+    }
     CreateTexture(ddsImg.width, ddsImg.height, {
-        .mipLevels = 1,
+        .mipLevels = uint8_t(ddsImg.mipmaps.size()),
         .numLayers = 1,
-        .initialData = {{ddsImg.mipmaps[0].data(),ddsImg.mipmaps[0].size()}},
+        .initialData = {{ddsImg.mipmaps[0].data(), totalSize}},
         .format = dxtFormat
     });
 }
 
 
+void RavEngine::Texture::InitFromKTX2(IStream& stream, const std::string& name)
+{
+    Vector<std::byte> fileData(stream.size());
+    stream.read(fileData);
+
+    KTX2::Image image;
+    switch (KTX2::Read(fileData, image)) {
+    case KTX2::ReadResult::Success:
+        break;
+    case KTX2::ReadResult::BasisUniversal:
+        Debug::Fatal("Cannot load KTX2 {}: Basis Universal textures must be transcoded offline, to BC7 for example", name);
+    case KTX2::ReadResult::Unsupported:
+        Debug::Fatal("Cannot load KTX2 {}: only 2D textures without Zstandard supercompression are supported", name);
+    default:
+        Debug::Fatal("Cannot load KTX2 {}: the file is truncated", name);
+    }
+    const auto format = FormatForKTX2(image.vkFormat);
+    if (format == RGL::TextureFormat::Undefined) {
+        Debug::Fatal("Cannot load KTX2 {}: unsupported VkFormat {}", name, image.vkFormat);
+    }
+
+    Vector<std::byte> mips;
+    if (!KTX2::DecodeLevels(image, mips)) {
+        Debug::Fatal("Cannot load KTX2 {}: a level is corrupt", name);
+    }
+    if (format == RGL::TextureFormat::RGBA8_Unorm && image.levels.size() == 1) {
+        InitFromRGBA8(reinterpret_cast<const unsigned char*>(mips.data()), image.width, image.height);
+        return;
+    }
+    CreateTexture(image.width, image.height, {
+        .mipLevels = uint8_t(image.levels.size()),
+        .numLayers = 1,
+        .initialData = {{mips.data(), mips.size()}},
+        .format = format,
+        .debugName = name
+    });
+}
+
 RavEngine::Texture::Texture(const Filesystem::Path& pathOnDisk)
 {
     FileStream stream(std::ifstream{ pathOnDisk, std::ios::binary });
@@ -93,6 +228,10 @@ RavEngine::Texture::Texture(const Filesystem::Path& pathOnDisk)
         InitFromDDS(stream);
         return;
     }
+    if (KTX2::IsKTX2(headerData)) {
+        InitFromKTX2(stream, pathOnDisk.string());
+        return;
+    }
 
 	int width, height, channels;
 	unsigned char* bytes = stbi_load(pathOnDisk.string().c_str(), &width, &height, &channels, 4);
@@ -112,14 +251,7 @@ RavEngine::Texture::Texture(const Filesystem::Path& pathOnDisk)
 	}
 
 load:
-    uint16_t numlayers = 1;
-    uint16_t numChannels = 4;	//TODO: allow n-channel textures
-    const uint32_t nBytes(width * height * numlayers * numChannels);
-    CreateTexture(width, height, {
-        .mipLevels = 1,
-        .numLayers = 1,
-        .initialData = {{reinterpret_cast<std::byte*>(bytes), nBytes}}
-     });
+    InitFromRGBA8(bytes, width, height);
     freer();
 }
 
@@ -143,6 +275,10 @@ Texture::Texture(const std::string& name){
         InitFromDDS(stream);
         return;
     }
+    if (KTX2::IsKTX2(headerData)) {
+        InitFromKTX2(stream, name);
+        return;
+    }
     
     std::function<void()> freer;
     const char* failureReason = nullptr;
@@ -165,15 +301,7 @@ Texture::Texture(const std::string& name){
     }
 	
     load:
-	uint16_t numlayers = 1;
-    uint16_t numChannels = 4;	//TODO: allow n-channel textures
-
-    const uint32_t nBytes(width * height * numlayers * numChannels);
-    CreateTexture(width, height, {
-        .mipLevels = 1, 
-        .numLayers = numlayers,
-        .initialData = {{reinterpret_cast<std::byte*>(bytes), nBytes }}
-    });
+    InitFromRGBA8(bytes, width, height);
     freer();
 	
 }
@@ -217,6 +345,261 @@ Texture::~Texture() {
 	}
 }
 
+struct StreamingTexture::Source {
+    Vector<std::byte> fileData;
+    dds::Image ddsImage;    // its mips point into fileData, valid if isDDS
+    bool isDDS = false;
+};
+
+StreamingTexture::StreamingTexture(const std::string& name) {
+    Debug::Assert(IsRasterImage(name), "Streaming textures only allow raster image formats");
+    Vector<std::byte> data;
+    GetApp()->GetResources().FileContentsAt(("/textures/" + name).c_str(), data);
+    Init(std::move(data), name);
+}
+
+StreamingTexture::StreamingTexture(const Filesystem::Path& pathOnDisk) {
+    std::ifstream file(pathOnDisk, std::ios::binary | std::ios::ate);
+    if (!file) {
+        Debug::Fatal("Cannot load texture from disk {}", pathOnDisk.string());
+    }
+    Vector<std::byte> data(size_t(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    Init(std::move(data), pathOnDisk.string());
+}
+
+void StreamingTexture::Init(Vector<std::byte>&& fileData, const std::string& name) {
+    debugName = name;
+    auto src = std::make_shared<Source>();
+    src->fileData = std::move(fileData);
+
+    if (src->fileData.size() >= 4 && std::string_view{ reinterpret_cast<const char*>(src->fileData.data()), 4 } == "DDS ") {
+        auto result = dds::readImage(reinterpret_cast<uint8_t*>(src->fileData.data()), src->fileData.size(), &src->ddsImage);
+        if (result != dds::ReadResult::Success) {
+            Debug::Fatal("Cannot load DDS {}: {}", name, uint32_t(result));
+        }
+        format = FormatForDDS(src->ddsImage.format);
+        blockDim = RGL::FormatBlockDimension(format);
+        bytesPerBlock = RGL::FormatBytesPerBlock(format);
+        src->isDDS = true;
+        fullWidth = src->ddsImage.width;
+        fullHeight = src->ddsImage.height;
+        numMips = uint8_t(src->ddsImage.mipmaps.size());
+    }
+    else {
+        int width = 0, height = 0, channels;
+        if (!stbi_info_from_memory(reinterpret_cast<const stbi_uc*>(src->fileData.data()), Debug::AssertSize<int>(src->fileData.size()), &width, &height, &channels)) {
+            Debug::Fatal("Cannot load texture {}: {}", name, stbi_failure_reason());
+        }
+        fullWidth = width;
+        fullHeight = height;
+        numMips = uint8_t(std::bit_width(std::max(fullWidth, fullHeight)));
+    }
+    source = src;
+
+    tailMip = 0;
+    while (tailMip + 1 < numMips && (std::max(fullWidth, fullHeight) >> tailMip) > tailSize) {
+        tailMip++;
+    }
+
+    // until the streamer uploads the whole tail on the next frame, a placeholder holds the largest mip of the tail
+    auto tail = DecodeMips(*source, tailMip, numMips);
+    CreateTexture(std::max(fullWidth >> tailMip, 1u), std::max(fullHeight >> tailMip, 1u), {
+        .mipLevels = 1,
+        .numLayers = 1,
+        .initialData = {{tail.front().data(), tail.front().size()}},
+        .format = format,
+        .debugName = debugName
+    });
+    residentMip = numMips;
+
+    auto& streamer = GetApp()->GetRenderEngine().GetTextureStreamer();
+    slot = streamer.Register(this);
+    streamer.SubmitDecodedMips(slot, tailMip, std::move(tail));
+}
+
+StreamingTexture::~StreamingTexture() {
+    if (auto app = GetApp()) {
+        if (app->HasRenderEngine()) {
+            app->GetRenderEngine().GetTextureStreamer().Unregister(slot);
+        }
+    }
+}
+
+void StreamingTexture::RequestMip(uint8_t mip) {
+    auto current = requestedMip.load();
+    while (mip < current && !requestedMip.compare_exchange_weak(current, mip)) {}
+}
+
+Vector<Vector<std::byte>> StreamingTexture::DecodeMips(const Source& source, uint8_t first, uint8_t last) {
+    Vector<Vector<std::byte>> mips;
+    mips.reserve(last - first);
+    if (source.isDDS) {
+        for (uint8_t mip = first; mip < last; mip++) {
+            auto data = reinterpret_cast<const std::byte*>(source.ddsImage.mipmaps[mip].data());
+            mips.emplace_back(data, data + source.ddsImage.mipmaps[mip].size());
+        }
+        return mips;
+    }
+
+    int width = 0, height = 0, channels;
+    unsigned char* bytes = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(source.fileData.data()), Debug::AssertSize<int>(source.fileData.size()), &width, &height, &channels, 4);
+    if (bytes == nullptr) {
+        Debug::Fatal("Cannot decode streaming texture: {}", stbi_failure_reason());
+    }
+    Vector<std::byte> current(reinterpret_cast<std::byte*>(bytes), reinterpret_cast<std::byte*>(bytes) + size_t(width) * height * 4);
+    stbi_image_free(bytes);
+
+    uint32_t mipWidth = width, mipHeight = height;
+    for (uint8_t mip = 0; mip < last; mip++) {
+        if (mip > 0) {
+            current = DownsampleRGBA8(current, mipWidth, mipHeight);
+            mipWidth = std::max(mipWidth / 2, 1u);
+            mipHeight = std::max(mipHeight / 2, 1u);
+        }
+        if (mip >= first) {
+            mips.push_back(current);
+        }
+    }
+    return mips;
+}
+
+// records copies of mips into the first mips of texture through staging buffers, so the upload does not block the caller
+static void UploadMips(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine, RGLTexturePtr texture, uint32_t width, uint32_t height, std::span<const Vector<std::byte>> mips) {
+    for (uint8_t i = 0; i < mips.size(); i++) {
+        auto staging = device->CreateBuffer({
+            uint32_t(mips[i].size()),
+            {.StorageBuffer = true},
+            sizeof(char),
+            RGL::BufferAccess::Shared,
+            {.Transfersource = true, .debugName = "Texture upload staging buffer"}
+        });
+        staging->MapMemory();
+        staging->UpdateBufferData({ mips[i].data(), mips[i].size() });
+        commandBuffer->CopyBufferToTexture(staging, uint32_t(mips[i].size()), {
+            .view = texture->GetViewForMip(i),
+            .destLoc = {.extent = {std::max(width >> i, 1u), std::max(height >> i, 1u)}},
+            .mip = i
+        });
+        engine.gcBuffers.enqueue(staging);
+    }
+}
+
+void StreamingTexture::SetResidentMips(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine, uint8_t newBaseMip, std::span<const Vector<std::byte>> newMips) {
+    auto newTexture = device->CreateTexture({
+        .usage = {.TransferSource = true, .TransferDestination = true, .Sampled = true},
+        .aspect = {.HasColor = true},
+        .width = std::max(fullWidth >> newBaseMip, 1u),
+        .height = std::max(fullHeight >> newBaseMip, 1u),
+        .mipLevels = uint32_t(numMips - newBaseMip),
+        .format = format,
+        .debugName = debugName
+    });
+
+    UploadMips(device, commandBuffer, engine, newTexture, std::max(fullWidth >> newBaseMip, 1u), std::max(fullHeight >> newBaseMip, 1u), newMips);
+
+    // the mips that are already resident move over on the GPU
+    for (uint32_t mip = std::max<uint32_t>(newBaseMip + newMips.size(), residentMip); mip < numMips; mip++) {
+        commandBuffer->CopyTextureToTexture(
+            { .texture = texture->GetDefaultView(), .mip = mip - residentMip },
+            { .texture = newTexture->GetDefaultView(), .mip = mip - newBaseMip }
+        );
+    }
+
+    engine.gcTextures.enqueue(texture);
+    texture = newTexture;
+    residentMip = newBaseMip;
+}
+
+AsyncTexture::AsyncTexture(const std::string& name) : debugName(name) {
+    Debug::Assert(IsRasterImage(name), "Async textures only allow raster image formats");
+    Load([name] {
+        Vector<std::byte> data;
+        GetApp()->GetResources().FileContentsAt(("/textures/" + name).c_str(), data);
+        return data;
+    });
+}
+
+AsyncTexture::AsyncTexture(const Filesystem::Path& pathOnDisk) : debugName(pathOnDisk.string()) {
+    Load([pathOnDisk] {
+        std::ifstream file(pathOnDisk, std::ios::binary | std::ios::ate);
+        if (!file) {
+            Debug::Fatal("Cannot load texture from disk {}", pathOnDisk.string());
+        }
+        Vector<std::byte> data(size_t(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+        return data;
+    });
+}
+
+void AsyncTexture::Load(Function<Vector<std::byte>()>&& read) {
+    texture = Texture::Manager::defaultTexture->GetRHITexturePointer();
+
+    auto& loader = GetApp()->GetRenderEngine().GetAsyncTextureLoader();
+    slot = loader.Register(this);
+    loader.Load(slot, [read = std::move(read), name = debugName] {
+        auto fileData = read();
+        AsyncTextureLoader::Decoded result;
+        if (fileData.size() >= 4 && std::string_view{ reinterpret_cast<const char*>(fileData.data()), 4 } == "DDS ") {
+            dds::Image ddsImage;
+            auto readResult = dds::readImage(reinterpret_cast<uint8_t*>(fileData.data()), fileData.size(), &ddsImage);
+            if (readResult != dds::ReadResult::Success) {
+                Debug::Fatal("Cannot load DDS {}: {}", name, uint32_t(readResult));
+            }
+            result.width = ddsImage.width;
+            result.height = ddsImage.height;
+            result.format = FormatForDDS(ddsImage.format);
+            for (const auto& mip : ddsImage.mipmaps) {
+                auto data = reinterpret_cast<const std::byte*>(mip.data());
+                result.mips.emplace_back(data, data + mip.size());
+            }
+            return result;
+        }
+
+        int width = 0, height = 0, channels;
+        unsigned char* bytes = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(fileData.data()), Debug::AssertSize<int>(fileData.size()), &width, &height, &channels, 4);
+        if (bytes == nullptr) {
+            Debug::Fatal("Cannot load texture {}: {}", name, stbi_failure_reason());
+        }
+        result.width = width;
+        result.height = height;
+        result.mips.emplace_back(reinterpret_cast<std::byte*>(bytes), reinterpret_cast<std::byte*>(bytes) + size_t(width) * height * 4);
+        stbi_image_free(bytes);
+        uint32_t mipWidth = width, mipHeight = height;
+        while (mipWidth > 1 || mipHeight > 1) {
+            result.mips.push_back(DownsampleRGBA8(result.mips.back(), mipWidth, mipHeight));
+            mipWidth = std::max(mipWidth / 2, 1u);
+            mipHeight = std::max(mipHeight / 2, 1u);
+        }
+        return result;
+    });
+}
+
+AsyncTexture::~AsyncTexture() {
+    if (auto app = GetApp()) {
+        if (app->HasRenderEngine()) {
+            app->GetRenderEngine().GetAsyncTextureLoader().Unregister(slot);
+        }
+    }
+}
+
+void AsyncTexture::Upload(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine, const AsyncTextureLoader::Decoded& decoded) {
+    auto newTexture = device->CreateTexture({
+        .usage = {.TransferDestination = true, .Sampled = true},
+        .aspect = {.HasColor = true},
+        .width = decoded.width,
+        .height = decoded.height,
+        .mipLevels = uint32_t(decoded.mips.size()),
+        .format = decoded.format,
+        .debugName = debugName
+    });
+    UploadMips(device, commandBuffer, engine, newTexture, decoded.width, decoded.height, decoded.mips);
+    texture = newTexture;
+    loaded = true;
+}
+
 RenderTexture::RenderTexture(int width, int height){
     collection = GetApp()->GetRenderEngine().CreateRenderTargetCollection({ static_cast<unsigned int>(width), static_cast<unsigned int>(height) });
     finalFB = New<RuntimeTexture>(width, height, Texture::Config{.enableRenderTarget = true, .format = RGL::TextureFormat::BGRA8_Unorm, .debugName="Render Texture"});
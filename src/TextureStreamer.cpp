@@ -0,0 +1,189 @@
+#if !RVE_SERVER
+#include "TextureStreamer.hpp"
+#include "Texture.hpp"
+#include "RenderEngine.hpp"
+#include "App.hpp"
+#include "Debug.hpp"
+#include "Profile.hpp"
+#include <RGL/Device.hpp>
+#include <RGL/Buffer.hpp>
+#include <algorithm>
+#include <queue>
+#include <thread>
+
+using namespace RavEngine;
+
+uint64_t RavEngine::TextureMipChainBytes(const TextureStreamingRequest& request, uint8_t baseMip) {
+    uint64_t total = 0;
+    for (uint8_t mip = baseMip; mip < request.numMips; mip++) {
+        const uint64_t width = std::max(request.width >> mip, 1u), height = std::max(request.height >> mip, 1u);
+        total += ((width + request.blockDim - 1) / request.blockDim) * ((height + request.blockDim - 1) / request.blockDim) * request.bytesPerBlock;
+    }
+    return total;
+}
+
+uint64_t RavEngine::ResolveTextureStreamingBudget(std::span<TextureStreamingRequest> requests, uint64_t budgetBytes) {
+    uint64_t total = 0;
+    for (auto& request : requests) {
+        request.grantedMip = std::min(request.wantedMip, request.tailMip);
+        total += TextureMipChainBytes(request, request.grantedMip);
+    }
+
+    // the textures that can still drop a mip, largest granted mip first
+    auto topMipBytes = [&](uint32_t i) {
+        return TextureMipChainBytes(requests[i], requests[i].grantedMip) - TextureMipChainBytes(requests[i], requests[i].grantedMip + 1);
+    };
+    auto smaller = [&](uint32_t a, uint32_t b) {
+        return topMipBytes(a) < topMipBytes(b);
+    };
+    std::priority_queue<uint32_t, Vector<uint32_t>, decltype(smaller)> droppable(smaller);
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        if (requests[i].grantedMip < requests[i].tailMip) {
+            droppable.push(i);
+        }
+    }
+
+    while (total > budgetBytes && !droppable.empty()) {
+        const auto i = droppable.top();
+        droppable.pop();
+        total -= topMipBytes(i);
+        requests[i].grantedMip++;
+        if (requests[i].grantedMip < requests[i].tailMip) {
+            droppable.push(i);
+        }
+    }
+    return total;
+}
+
+TextureStreamer::~TextureStreamer() {
+    // decodes reference the queue
+    while (decodesInFlight > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void TextureStreamer::Init(RGLDevicePtr device) {
+    feedbackBuffer = device->CreateBuffer({
+        maxStreamingTextures,
+        {.StorageBuffer = true},
+        sizeof(uint32_t),
+        RGL::BufferAccess::Shared,
+        {.Writable = true, .debugName = "Texture streaming feedback buffer"}
+    });
+    feedbackBuffer->MapMemory();
+    auto requested = static_cast<uint32_t*>(feedbackBuffer->GetMappedDataPtr());
+    std::fill(requested, requested + maxStreamingTextures, noRequest);
+}
+
+uint32_t TextureStreamer::Register(StreamingTexture* texture) {
+    std::lock_guard lock(mtx);
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = uint32_t(entries.size());
+        if (slot >= maxStreamingTextures) {
+            Debug::Fatal("Cannot create more than {} streaming textures", maxStreamingTextures);
+        }
+        entries.emplace_back();
+    }
+    auto& entry = entries[slot];
+    entry.texture = texture;
+    entry.lastRequestFrame = frameCount;
+    entry.wantedMip = texture->tailMip;
+    entry.loading = true;   // the tail is submitted by the texture
+    return slot;
+}
+
+void TextureStreamer::Unregister(uint32_t slot) {
+    std::lock_guard lock(mtx);
+    auto& entry = entries[slot];
+    entry.texture = nullptr;
+    entry.generation++;
+    entry.loading = false;
+    freeSlots.push_back(slot);
+}
+
+void TextureStreamer::SubmitDecodedMips(uint32_t slot, uint8_t baseMip, Vector<Vector<std::byte>>&& mips) {
+    uint32_t generation;
+    {
+        std::lock_guard lock(mtx);
+        generation = entries[slot].generation;
+    }
+    decodedMips.enqueue({ slot, generation, baseMip, std::move(mips) });
+}
+
+void TextureStreamer::Update(RGLDevicePtr device, RGLCommandBufferPtr commandBuffer, RenderEngine& engine) {
+    RVE_PROFILE_FN;
+    std::lock_guard lock(mtx);
+    frameCount++;
+
+    DecodedMips decoded;
+    while (decodedMips.try_dequeue(decoded)) {
+        auto& entry = entries[decoded.slot];
+        if (entry.texture == nullptr || entry.generation != decoded.generation) {
+            continue;   // the texture was destroyed while decoding
+        }
+        entry.loading = false;
+        entry.texture->SetResidentMips(device, commandBuffer, engine, decoded.baseMip, decoded.mips);
+    }
+
+    // the previous frame has completed, so its requests are all in
+    auto requested = static_cast<uint32_t*>(feedbackBuffer->GetMappedDataPtr());
+    requests.clear();
+    requestSlots.clear();
+    for (uint32_t slot = 0; slot < entries.size(); slot++) {
+        auto& entry = entries[slot];
+        auto texture = entry.texture;
+        if (texture == nullptr) {
+            continue;
+        }
+        const uint8_t reported = uint8_t(std::min({ requested[slot], uint32_t(texture->requestedMip.exchange(std::numeric_limits<uint8_t>::max())), uint32_t(texture->tailMip) }));
+        if (reported <= entry.wantedMip) {
+            entry.wantedMip = reported;
+            entry.lastRequestFrame = frameCount;
+        }
+        else if (frameCount - entry.lastRequestFrame > evictionDelayFrames) {
+            // let go of one mip at a time
+            entry.wantedMip++;
+            entry.lastRequestFrame = frameCount;
+        }
+        requests.push_back({
+            .width = texture->fullWidth,
+            .height = texture->fullHeight,
+            .numMips = texture->numMips,
+            .tailMip = texture->tailMip,
+            .wantedMip = entry.wantedMip,
+            .blockDim = texture->blockDim,
+            .bytesPerBlock = texture->bytesPerBlock,
+        });
+        requestSlots.push_back(slot);
+    }
+    std::fill(requested, requested + entries.size(), noRequest);
+
+    residentBytes = ResolveTextureStreamingBudget(requests, std::min(budgetBytes, pressureLimitBytes));
+
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        const auto slot = requestSlots[i];
+        auto& entry = entries[slot];
+        auto texture = entry.texture;
+        const auto grantedMip = requests[i].grantedMip;
+        if (entry.loading || grantedMip == texture->residentMip) {
+            continue;
+        }
+        if (grantedMip > texture->residentMip) {
+            // evicting only needs the mips that are already resident
+            texture->SetResidentMips(device, commandBuffer, engine, grantedMip, {});
+            continue;
+        }
+        entry.loading = true;
+        decodesInFlight++;
+        GetApp()->backgroundExecutor.silent_async([this, source = texture->source, slot, generation = entry.generation, first = grantedMip, last = texture->residentMip] {
+            decodedMips.enqueue({ slot, generation, first, StreamingTexture::DecodeMips(*source, first, last) });
+            decodesInFlight--;
+        });
+    }
+}
+#endif
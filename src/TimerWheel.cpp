@@ -0,0 +1,82 @@
+#include "TimerWheel.hpp"
+#include <cmath>
+
+using namespace RavEngine;
+
+void TimerWheel::Schedule(double runAtSeconds, callback_t fn) {
+    uint32_t node;
+    if (freeList != INVALID_NODE) {
+        node = freeList;
+        freeList = nodes[node].next;
+    }
+    else {
+        node = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    // round up, so that a callback never comes due before its time
+    const auto tick = std::ceil(std::max(runAtSeconds, 0.0) / slotSeconds);
+    nodes[node].fn = std::move(fn);
+    nodes[node].dueTick = tick >= double(std::numeric_limits<uint64_t>::max()) ? std::numeric_limits<uint64_t>::max() : uint64_t(tick);
+    Place(node);
+    nPending++;
+}
+
+void TimerWheel::Place(uint32_t node) {
+    auto& n = nodes[node];
+    if (n.dueTick <= currentTick) {
+        n.next = ready;
+        ready = node;
+        return;
+    }
+    // the lowest level whose span covers the delay
+    const auto delta = n.dueTick - currentTick;
+    uint32_t level = 0;
+    while (level < nLevels - 1 && delta >= (uint64_t(1) << (bitsPerLevel * (level + 1)))) {
+        level++;
+    }
+    // beyond the top level's span, park in the furthest top slot and re-place when it cascades
+    const auto maxTop = currentTick + (uint64_t(1) << (bitsPerLevel * nLevels)) - 1;
+    const auto placeTick = std::min(n.dueTick, maxTop);
+    auto& head = slots[level][(placeTick >> (bitsPerLevel * level)) & (slotsPerLevel - 1)];
+    n.next = head;
+    head = node;
+}
+
+void TimerWheel::Expire(uint32_t& head, Vector<callback_t>& out) {
+    while (head != INVALID_NODE) {
+        const auto node = head;
+        auto& n = nodes[node];
+        head = n.next;
+        out.push_back(std::move(n.fn));
+        n.fn = nullptr;
+        n.next = freeList;
+        freeList = node;
+        nPending--;
+    }
+}
+
+void TimerWheel::Advance(double nowSeconds, Vector<callback_t>& out) {
+    Expire(ready, out);
+    const auto targetTick = uint64_t(std::max(nowSeconds, 0.0) / slotSeconds);
+    while (currentTick < targetTick && nPending > 0) {
+        currentTick++;
+        // when a lower level wraps, the next slot of the level above is redistributed downwards
+        for (uint32_t level = 1; level < nLevels; level++) {
+            if ((currentTick & ((uint64_t(1) << (bitsPerLevel * level)) - 1)) != 0) {
+                break;
+            }
+            auto& head = slots[level][(currentTick >> (bitsPerLevel * level)) & (slotsPerLevel - 1)];
+            auto node = head;
+            head = INVALID_NODE;
+            while (node != INVALID_NODE) {
+                const auto next = nodes[node].next;
+                Place(node);
+                node = next;
+            }
+        }
+        Expire(slots[0][currentTick & (slotsPerLevel - 1)], out);
+        Expire(ready, out);
+    }
+    // nothing is pending, so the skipped ticks had no work
+    currentTick = std::max(currentTick, targetTick);
+}
@@ -1,7 +1,13 @@
 #if !RVE_SERVER
 #include "Tonemap.hpp"
 namespace RavEngine {
-	TonemapPass::TonemapPass(const std::string_view name, const ScreenEffectConfig& config) : ScreenEffectBase(name, config, {
+	// tonemaps also receive the source UV scale of dynamic resolution, see RenderEngine::LightToFBUBO
+	static ScreenEffectConfig WithSourceUVScale(ScreenEffectConfig config) {
+		config.pushConstantSize += sizeof(glm::vec2);
+		return config;
+	}
+
+	TonemapPass::TonemapPass(const std::string_view name, const ScreenEffectConfig& config) : ScreenEffectBase(name, WithSourceUVScale(config), {
 	.outputFormat = RGL::TextureFormat::BGRA8_Unorm
 		}
 	) {
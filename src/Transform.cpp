@@ -2,6 +2,7 @@
 #include "mathtypes.hpp"
 #include <glm/gtc/type_ptr.hpp>
 #include "Common3D.hpp"
+#include "World.hpp"
 
 using namespace std;
 using namespace glm;
@@ -13,6 +14,7 @@ Transform& Transform::AddChild(ComponentHandle<Transform> child)
 	auto worldPos = cptr->GetWorldPosition();
 	auto worldRot = cptr->GetWorldRotation();
 	
+	InvalidateHierarchy();
 	cptr->parent = ComponentHandle<Transform>(GetOwner());
 	children.insert(child);
 	child->matrix = GetWorldMatrix();
@@ -27,10 +29,39 @@ Transform& Transform::RemoveChild(ComponentHandle<Transform> child)
     auto cptr = child.get();
 	auto worldPos = cptr->GetWorldPosition();
 	auto worldRot = cptr->GetWorldRotation();
+	InvalidateHierarchy();
 	cptr->parent.reset();
 	children.erase(child);
 	child->matrix = matrix4(1);
 	cptr->SetWorldPosition(worldPos);
 	cptr->SetWorldRotation(worldRot);
     return *this;
-}
\ No newline at end of file
+}
+bool Transform::HierarchyIsDeferred() const
+{
+	return GetOwner().GetWorld()->deferTransformPropagation;
+}
+
+void Transform::InvalidateHierarchy() const
+{
+	GetOwner().GetWorld()->transformHierarchy.needsRebuild = true;
+}
+
+void Transform::QueueStaticMove() const
+{
+	GetOwner().GetWorld()->QueueStaticTransformMove(*this);
+}
+
+void Transform::SetStatic(bool in)
+{
+	if (in == isStatic) {
+		return;
+	}
+	isStatic = in;
+	GetOwner().GetWorld()->staticMembershipVersion++;
+#if !RVE_SERVER
+	GetOwner().GetWorld()->SetEntityStaticForRendering(GetOwner().GetID(), in);
+#endif
+	// make sure the passes see the transform's current state once
+	MarkAsDirty();
+}
@@ -0,0 +1,83 @@
+#include "TransformBatch.hpp"
+#include "Transform.hpp"
+#include <cassert>
+
+#if !DOUBLE_PRECISION
+    #if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+        #define RVE_TRANSFORM_BATCH_SSE 1
+        #include <xmmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define RVE_TRANSFORM_BATCH_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+using namespace RavEngine;
+
+namespace {
+    // columns of rotate(q) * scale(s), with glm's quaternion convention
+    inline void RotationScaleColumns(const quaternion& q, const vector3& s, float c0[3], float c1[3], float c2[3]) {
+        const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+        c0[0] = (1 - 2 * (yy + zz)) * s.x;
+        c0[1] = (2 * (xy + wz)) * s.x;
+        c0[2] = (2 * (xz - wy)) * s.x;
+
+        c1[0] = (2 * (xy - wz)) * s.y;
+        c1[1] = (1 - 2 * (xx + zz)) * s.y;
+        c1[2] = (2 * (yz + wx)) * s.y;
+
+        c2[0] = (2 * (xz + wy)) * s.z;
+        c2[1] = (2 * (yz - wx)) * s.z;
+        c2[2] = (1 - 2 * (xx + yy)) * s.z;
+    }
+
+    inline void ComposeKernel(const matrix4& parent, const vector3& position, const quaternion& rotation, const vector3& scale, matrix4& out) {
+#if RVE_TRANSFORM_BATCH_SSE || RVE_TRANSFORM_BATCH_NEON
+        float c0[3], c1[3], c2[3];
+        RotationScaleColumns(rotation, scale, c0, c1, c2);
+        const float* p = &parent[0][0];
+        float* o = &out[0][0];
+    #if RVE_TRANSFORM_BATCH_SSE
+        const __m128 p0 = _mm_loadu_ps(p), p1 = _mm_loadu_ps(p + 4), p2 = _mm_loadu_ps(p + 8), p3 = _mm_loadu_ps(p + 12);
+        auto column = [&](float x, float y, float z) {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(x)), _mm_mul_ps(p1, _mm_set1_ps(y))), _mm_mul_ps(p2, _mm_set1_ps(z)));
+        };
+        _mm_storeu_ps(o, column(c0[0], c0[1], c0[2]));
+        _mm_storeu_ps(o + 4, column(c1[0], c1[1], c1[2]));
+        _mm_storeu_ps(o + 8, column(c2[0], c2[1], c2[2]));
+        _mm_storeu_ps(o + 12, _mm_add_ps(column(position.x, position.y, position.z), p3));
+    #else
+        const float32x4_t p0 = vld1q_f32(p), p1 = vld1q_f32(p + 4), p2 = vld1q_f32(p + 8), p3 = vld1q_f32(p + 12);
+        auto column = [&](float x, float y, float z) {
+            return vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(p0, x), p1, y), p2, z);
+        };
+        vst1q_f32(o, column(c0[0], c0[1], c0[2]));
+        vst1q_f32(o + 4, column(c1[0], c1[1], c1[2]));
+        vst1q_f32(o + 8, column(c2[0], c2[1], c2[2]));
+        vst1q_f32(o + 12, vaddq_f32(column(position.x, position.y, position.z), p3));
+    #endif
+#else
+        matrix4 local = glm::toMat4(rotation);
+        local[0] *= scale.x;
+        local[1] *= scale.y;
+        local[2] *= scale.z;
+        local[3] = vector4(position, 1);
+        out = parent * local;
+#endif
+    }
+}
+
+void TransformBatch::ComposeMatrix(const matrix4& parent, const vector3& position, const quaternion& rotation, const vector3& scale, matrix4& out) {
+    ComposeKernel(parent, position, rotation, scale, out);
+}
+
+void TransformBatch::WriteWorldMatrices(std::span<const Transform* const> transforms, std::span<const uint32_t> outIndices, matrix4* out) {
+    assert(transforms.size() == outIndices.size());
+    for (size_t i = 0; i < transforms.size(); i++) {
+        const auto t = transforms[i];
+        ComposeKernel(t->GetParentSpaceMatrix(), t->GetLocalPosition(), t->GetLocalRotation(), t->GetLocalScale(), out[outIndices[i]]);
+    }
+}
@@ -0,0 +1,164 @@
+#include "TweenManager.hpp"
+#include "Debug.hpp"
+#include <tweeny.h>
+#include <taskflow/taskflow.hpp>
+#include <algorithm>
+
+using namespace RavEngine;
+
+namespace {
+    template<typename curve>
+    float Run(float t) {
+        return curve::template run<float>(t, 0.f, 1.f);
+    }
+
+    // the eased position of t in [0,1]
+    float Ease(TweenManager::Easing curve, float t) {
+        using E = TweenManager::Easing;
+        using easing = tweeny::easing;
+        switch (curve) {
+        case E::Linear: return t;
+        case E::Stepped: return Run<easing::steppedEasing>(t);
+        case E::QuadraticIn: return Run<easing::quadraticInEasing>(t);
+        case E::QuadraticOut: return Run<easing::quadraticOutEasing>(t);
+        case E::QuadraticInOut: return Run<easing::quadraticInOutEasing>(t);
+        case E::CubicIn: return Run<easing::cubicInEasing>(t);
+        case E::CubicOut: return Run<easing::cubicOutEasing>(t);
+        case E::CubicInOut: return Run<easing::cubicInOutEasing>(t);
+        case E::QuarticIn: return Run<easing::quarticInEasing>(t);
+        case E::QuarticOut: return Run<easing::quarticOutEasing>(t);
+        case E::QuarticInOut: return Run<easing::quarticInOutEasing>(t);
+        case E::QuinticIn: return Run<easing::quinticInEasing>(t);
+        case E::QuinticOut: return Run<easing::quinticOutEasing>(t);
+        case E::QuinticInOut: return Run<easing::quinticInOutEasing>(t);
+        case E::SinusoidalIn: return Run<easing::sinusoidalInEasing>(t);
+        case E::SinusoidalOut: return Run<easing::sinusoidalOutEasing>(t);
+        case E::SinusoidalInOut: return Run<easing::sinusoidalInOutEasing>(t);
+        case E::ExponentialIn: return Run<easing::exponentialInEasing>(t);
+        case E::ExponentialOut: return Run<easing::exponentialOutEasing>(t);
+        case E::ExponentialInOut: return Run<easing::exponentialInOutEasing>(t);
+        case E::CircularIn: return Run<easing::circularInEasing>(t);
+        case E::CircularOut: return Run<easing::circularOutEasing>(t);
+        case E::CircularInOut: return Run<easing::circularInOutEasing>(t);
+        case E::BounceIn: return Run<easing::bounceInEasing>(t);
+        case E::BounceOut: return Run<easing::bounceOutEasing>(t);
+        case E::BounceInOut: return Run<easing::bounceInOutEasing>(t);
+        case E::ElasticIn: return Run<easing::elasticInEasing>(t);
+        case E::ElasticOut: return Run<easing::elasticOutEasing>(t);
+        case E::ElasticInOut: return Run<easing::elasticInOutEasing>(t);
+        case E::BackIn: return Run<easing::backInEasing>(t);
+        case E::BackOut: return Run<easing::backOutEasing>(t);
+        case E::BackInOut: return Run<easing::backInOutEasing>(t);
+        }
+        return t;
+    }
+}
+
+TweenManager::Handle TweenManager::Add(float* target, float from, float to, float duration, Easing curve, callback_t onComplete) {
+    Debug::Assert(target != nullptr, "A tween needs a target");
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = uint32_t(slots.size());
+        slots.emplace_back();
+    }
+    auto& s = slots[slot];
+    s.dense = uint32_t(targets.size());
+    s.active = true;
+
+    start.push_back(from);
+    end.push_back(to);
+    elapsed.push_back(0);
+    this->duration.push_back(duration);
+    easing.push_back(curve);
+    targets.push_back(target);
+    callbacks.push_back(std::move(onComplete));
+    slotOf.push_back(slot);
+
+    *target = from;
+    return { slot, s.generation };
+}
+
+bool TweenManager::IsActive(Handle handle) const {
+    return handle.slot < slots.size() && slots[handle.slot].active && slots[handle.slot].generation == handle.generation;
+}
+
+bool TweenManager::Cancel(Handle handle) {
+    if (!IsActive(handle)) {
+        return false;
+    }
+    Remove(slots[handle.slot].dense);
+    return true;
+}
+
+void TweenManager::Remove(uint32_t dense) {
+    auto& removed = slots[slotOf[dense]];
+    removed.active = false;
+    removed.generation++;
+    freeSlots.push_back(slotOf[dense]);
+
+    const uint32_t last = uint32_t(targets.size() - 1);
+    if (dense != last) {
+        start[dense] = start[last];
+        end[dense] = end[last];
+        elapsed[dense] = elapsed[last];
+        duration[dense] = duration[last];
+        easing[dense] = easing[last];
+        targets[dense] = targets[last];
+        callbacks[dense] = std::move(callbacks[last]);
+        slotOf[dense] = slotOf[last];
+        slots[slotOf[dense]].dense = dense;
+    }
+    start.pop_back();
+    end.pop_back();
+    elapsed.pop_back();
+    duration.pop_back();
+    easing.pop_back();
+    targets.pop_back();
+    callbacks.pop_back();
+    slotOf.pop_back();
+}
+
+void TweenManager::StepRange(float delta, uint32_t begin, uint32_t count) {
+    for (uint32_t i = begin; i < begin + count; i++) {
+        elapsed[i] += delta;
+        const float t = duration[i] > 0 ? std::min(elapsed[i] / duration[i], 1.f) : 1.f;
+        *targets[i] = start[i] + (end[i] - start[i]) * Ease(easing[i], t);
+    }
+}
+
+void TweenManager::Step(float delta, Vector<callback_t>& completed, tf::Executor* executor) {
+    const uint32_t count = uint32_t(targets.size());
+    constexpr uint32_t chunkSize = 1024;
+    if (executor && count > chunkSize) {
+        const uint32_t nChunks = (count + chunkSize - 1) / chunkSize;
+        tf::Taskflow stepFlow;
+        stepFlow.for_each_index(uint32_t(0), nChunks, uint32_t(1), [this, delta, count](uint32_t chunk) {
+            const auto begin = chunk * chunkSize;
+            StepRange(delta, begin, std::min(chunkSize, count - begin));
+        });
+        if (executor->this_worker_id() >= 0) {
+            executor->run_and_wait(stepFlow);
+        }
+        else {
+            executor->run(stepFlow).wait();
+        }
+    }
+    else {
+        StepRange(delta, 0, count);
+    }
+
+    // backwards, so that the tween moved into a removed one's place has already been checked
+    for (uint32_t i = count; i > 0; i--) {
+        const auto dense = i - 1;
+        if (elapsed[dense] >= duration[dense]) {
+            if (callbacks[dense]) {
+                completed.push_back(std::move(callbacks[dense]));
+            }
+            Remove(dense);
+        }
+    }
+}
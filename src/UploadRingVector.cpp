@@ -0,0 +1,60 @@
+#if !RVE_SERVER
+#include "UploadRingVector.hpp"
+#include <RGL/Device.hpp>
+#include <algorithm>
+#include "App.hpp"
+#include "RenderEngine.hpp"
+#include "Debug.hpp"
+
+namespace RavEngine {
+
+void UploadRingBase::Begin(RGLDevicePtr device, uint64_t frameCount, uint32_t numElements) {
+    current = uint32_t(frameCount % framesInFlight);
+    nValues = numElements;
+    auto& copy = copies[current];
+    // always have a buffer, so there is something to bind even when there are no elements
+    if (copy.buffer && numElements <= copy.capacity) {
+        return;
+    }
+    if (memoryPool == nullptr) {
+        memoryPool = MemoryTracking::GetPool(Format("VRAM: {}", debugName));
+    }
+    if (copy.buffer) {
+        // this slot's last frame is complete, but the buffer may still be bound in commands that are being recorded
+        MemoryTracking::Freed(memoryPool, copy.buffer.get(), copy.buffer->getBufferSize());
+        GetApp()->GetRenderEngine().gcBuffers.enqueue(copy.buffer);
+    }
+    copy.capacity = std::max({ numElements, copy.capacity * 2, 1u });
+    copy.buffer = device->CreateBuffer({
+        copy.capacity,
+        {.StorageBuffer = true},
+        stride,
+        RGL::BufferAccess::Shared,
+        {.debugName = debugName.c_str()}
+    });
+    copy.buffer->MapMemory();
+    copy.mapped = copy.buffer->GetMappedDataPtr();
+    MemoryTracking::Allocated(memoryPool, copy.buffer.get(), copy.buffer->getBufferSize());
+}
+
+void UploadRingBase::FlushRange(uint32_t first, uint32_t count) {
+    Debug::Assert(first + count <= nValues, "Flushed range is outside the vector");
+    if (count > 0) {
+        copies[current].buffer->SignalRangeChanged({ first * stride, count * stride });
+    }
+}
+
+UploadRingBase::~UploadRingBase() {
+    auto app = GetApp();
+    for (auto& copy : copies) {
+        if (copy.buffer) {
+            MemoryTracking::Freed(memoryPool, copy.buffer.get(), copy.buffer->getBufferSize());
+            if (app) {
+                app->GetRenderEngine().gcBuffers.enqueue(copy.buffer);
+            }
+        }
+    }
+}
+
+}
+#endif
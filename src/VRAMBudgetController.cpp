@@ -0,0 +1,35 @@
+#include "VRAMBudgetController.hpp"
+#include <cmath>
+
+using namespace RavEngine;
+
+VRAMPressureLevel VRAMBudgetController::Update(uint64_t usageBytes, uint64_t budgetBytes) {
+    if (budgetBytes == 0) {
+        overageBytes = 0;
+        return level;
+    }
+    const auto highWater = uint64_t(std::llround(budgetBytes * double(config.highWater)));
+    const auto lowWater = uint64_t(std::llround(budgetBytes * double(config.lowWater)));
+    overageBytes = usageBytes > highWater ? usageBytes - highWater : 0;
+
+    if (framesSinceStep < config.framesBetweenSteps) {
+        framesSinceStep++;
+        return level;
+    }
+    if (usageBytes > highWater && level < VRAMPressureLevel::Max) {
+        level = VRAMPressureLevel(uint8_t(level) + 1);
+        framesSinceStep = 0;
+    }
+    else if (usageBytes < lowWater && level > VRAMPressureLevel::None) {
+        level = VRAMPressureLevel(uint8_t(level) - 1);
+        framesSinceStep = 0;
+    }
+    return level;
+}
+
+void VRAMBudgetController::SetConfig(const Config& newConfig) {
+    config = newConfig;
+    level = VRAMPressureLevel::None;
+    framesSinceStep = config.framesBetweenSteps;
+    overageBytes = 0;
+}
@@ -1,7 +1,19 @@
 #include "VirtualFileSystem.hpp"
+#include "AssetPack.hpp"
 #include <physfs.h>
 #include "Filesystem.hpp"
 #include <span>
+#include <filesystem>
+
+#ifdef _WIN32
+    #include <Windows.h>
+    #undef min
+#elif !__EMSCRIPTEN__
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 #ifdef __APPLE__
     #include <CoreFoundation/CFBundle.h>
@@ -164,6 +176,8 @@ VirtualFilesystem::VirtualFilesystem() {
 
     streamingAssetsPath = streamingAssetsPath / Format("{}_Streaming",path);
 
+    AssetPack::RegisterArchiver();
+
 #if __ANDROID__
     // we need to do some additional setup here. Android `assets` are not accessible to C functions
     // out of the box. we must copy them to a readable location using the Android api
@@ -210,6 +224,214 @@ size_t VirtualFilesystem::ReadInto(PHYSFS_File* file, void* output, size_t size)
     return PHYSFS_readBytes(file,output,size);
 }
 
+/**
+ Map a file on disk read-only
+ @param offset where the bytes to map start
+ @param size the number of bytes to map, or 0 for the rest of the file. Receives the number of bytes mapped.
+ @param mappingSize receives the size of the mapping, which starts before offset if offset is not on a page boundary
+ @return the start of the mapping, or nullptr if the file could not be mapped. The bytes are at offset % granularity into it.
+ */
+static void* MapNativeFile(const std::filesystem::path& path, uint64_t offset, size_t& size, size_t& mappingSize)
+{
+#ifdef _WIN32
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    const uint64_t start = offset - offset % system.dwAllocationGranularity;
+
+    auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    void* view = nullptr;
+    LARGE_INTEGER length;
+    if (GetFileSizeEx(file, &length) && uint64_t(length.QuadPart) > offset && (size == 0 || offset + size <= uint64_t(length.QuadPart))) {
+        if (auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+            size = size == 0 ? size_t(length.QuadPart - offset) : size;
+            mappingSize = size_t(offset - start) + size;
+            // the view keeps the mapping and the file open
+            view = MapViewOfFile(mapping, FILE_MAP_READ, DWORD(start >> 32), DWORD(start), mappingSize);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+    return view;
+#elif !__EMSCRIPTEN__
+    const uint64_t pageSize = uint64_t(sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset - offset % pageSize;
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* view = nullptr;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && uint64_t(info.st_size) > offset && (size == 0 || offset + size <= uint64_t(info.st_size))) {
+        size = size == 0 ? size_t(info.st_size - offset) : size;
+        mappingSize = size_t(offset - start) + size;
+        // the mapping keeps the file open
+        view = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, off_t(start));
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+    }
+    ::close(fd);
+    return view;
+#else
+    return nullptr;
+#endif
+}
+
+static void UnmapNativeFile(void* mapping, size_t size)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+#elif !__EMSCRIPTEN__
+    munmap(mapping, size);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Release();
+        owned = std::move(other.owned);
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+        data = mapping ? other.data : std::span<const std::byte>(owned);
+        other.mapping = nullptr;
+        other.mappingSize = 0;
+        other.data = {};
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    Release();
+}
+
+void MappedFile::Release()
+{
+    if (mapping) {
+        UnmapNativeFile(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+    owned.clear();
+    data = {};
+}
+
+MappedFile VirtualFilesystem::MapFile(const char* path)
+{
+    auto fullpath = Format("{}/{}", rootname, path);
+    if (!Exists(path)) {
+        Debug::Fatal("cannot open {}", fullpath);
+    }
+
+    MappedFile file;
+    // a file can be mapped if it is loose in a mounted directory, or stored uncompressed in a pack on disk
+    if (auto realDir = PHYSFS_getRealDir(fullpath.c_str())) {
+        std::error_code ec;
+        std::filesystem::path nativePath;
+        uint64_t offset = 0, size = 0;
+        if (std::filesystem::is_directory(realDir, ec)) {
+            nativePath = std::filesystem::path(realDir) / fullpath;
+        }
+        else if (AssetPack::FindStoredFile(realDir, fullpath, offset, size) && size > 0) {
+            nativePath = realDir;
+        }
+        if (!nativePath.empty()) {
+            size_t mappedSize = size;
+            if (auto mapping = MapNativeFile(nativePath, offset, mappedSize, file.mappingSize)) {
+                file.mapping = mapping;
+                file.data = { static_cast<const std::byte*>(mapping) + (file.mappingSize - mappedSize), mappedSize };
+                return file;
+            }
+        }
+    }
+
+    auto ptrsize = GetSizeAndPtr(fullpath.c_str());
+    file.owned.resize(ptrsize.size);
+    file.owned.resize(ReadInto(ptrsize.ptr, file.owned.data(), ptrsize.size));
+    close(ptrsize.ptr);
+    file.data = file.owned;
+    return file;
+}
+
+VirtualFileStream VirtualFilesystem::OpenStream(const char* path, size_t chunkSize)
+{
+    auto fullpath = Format("{}/{}", rootname, path);
+    if (!Exists(path)) {
+        Debug::Fatal("cannot open {}", fullpath);
+    }
+    auto ptrsize = GetSizeAndPtr(fullpath.c_str());
+    if (PHYSFS_setBuffer(ptrsize.ptr, chunkSize) == 0) {
+        Debug::Warning("Cannot buffer {}: {}", fullpath, PHYSFS_WHY());
+    }
+    return VirtualFileStream(ptrsize.ptr, ptrsize.size);
+}
+
+VirtualFileStream::VirtualFileStream(VirtualFileStream&& other) noexcept : file(other.file), length(other.length)
+{
+    other.file = nullptr;
+    other.length = 0;
+}
+
+VirtualFileStream& VirtualFileStream::operator=(VirtualFileStream&& other) noexcept
+{
+    if (this != &other) {
+        if (file) {
+            PHYSFS_close(file);
+        }
+        file = other.file;
+        length = other.length;
+        other.file = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+VirtualFileStream::~VirtualFileStream()
+{
+    if (file) {
+        PHYSFS_close(file);
+    }
+}
+
+IStreamResult VirtualFileStream::read(std::span<std::byte> outData)
+{
+    const auto bytesRead = PHYSFS_readBytes(file, outData.data(), outData.size());
+    if (bytesRead < 0) {
+        return { 0, IStreamStatus::Unknown };
+    }
+    return { size_t(bytesRead), PHYSFS_eof(file) ? IStreamStatus::EndOfStream : IStreamStatus::Success };
+}
+
+void VirtualFileStream::reset()
+{
+    PHYSFS_seek(file, 0);
+}
+
+void VirtualFileStream::advance(size_t amt)
+{
+    PHYSFS_seek(file, std::min(current_pos() + amt, length));
+}
+
+size_t VirtualFileStream::size()
+{
+    return length;
+}
+
+size_t VirtualFileStream::current_pos()
+{
+    return size_t(PHYSFS_tell(file));
+}
+
 bool RavEngine::VirtualFilesystem::Exists(const char* path)
 {
 	return PHYSFS_exists(Format("{}/{}",rootname,path).c_str());
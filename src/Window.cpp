@@ -117,18 +117,17 @@ namespace RavEngine {
 #endif
         return 1;
     }
-    void Window::QueueGetNextSwapchainImage(RGL::SwapchainPresentConfig& presentConfig){
-        // queue up the next swapchain image as soon as possible,
-        // it will become avaiable in the background
+    void Window::WaitForFrameLatency(){
+        swapchain->WaitForFrameLatency();
+    }
+    void Window::WaitForPreviousFrame(){
         swapchainFence->Wait();
-        swapchain->GetNextImage(&presentConfig.imageIndex);
     }
-	Window::SwapchainResult Window::BlockGetNextSwapchainImage(const RGL::SwapchainPresentConfig& presentConfig)
+	Window::SwapchainResult Window::AcquireNextSwapchainImage()
 	{
-		// execute when render fence says its ok
-		// did we get the swapchain image yet? if not, block until we do
-
+		RGL::SwapchainPresentConfig presentConfig;
 		swapchainFence->Wait();
+		swapchain->GetNextImage(&presentConfig.imageIndex);
 		swapchainFence->Reset();
 
 		auto nextimg = swapchain->ImageAtIndex(presentConfig.imageIndex);
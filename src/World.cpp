@@ -15,6 +15,9 @@
 #include "InputManager.hpp"
 #include "CameraComponent.hpp"
 #include "StaticMesh.hpp"
+#include "InstancedStaticMesh.hpp"
+#include "TransformBatch.hpp"
+#include "SpatialBoundsComponent.hpp"
 #include "BuiltinMaterials.hpp"
 #include "NetworkIdentity.hpp"
 #include "RPCSystem.hpp"
@@ -38,10 +41,13 @@
 #endif
 #include "PhysicsBodyComponent.hpp"
 #include "CaseAnalysis.hpp"
+#include "EntityCommandBuffer.hpp"
 
 using namespace std;
 using namespace RavEngine;
 
+std::atomic<uint32_t> ComponentTypeRegistry::nextIndex = 0;
+
 template<typename T>
 static const World::EntitySparseSet<T> staticEmptyContainer;
 
@@ -53,7 +59,17 @@ static inline void SetEmpty(typename World::EntitySparseSet<T>::const_iterator&
 
 void RavEngine::World::Tick(float scale) {
     RVE_PROFILE_FN;
+    TickSimulation(scale);
+    SyncRenderData();
+}
+
+void World::TickSimulation(float scale){
+    static auto tickTime = PerfCounters::GetHistogram("World: Tick (ms)");
+    const auto tickStart = std::chrono::steady_clock::now();
     if (graphWasModified) {
+        if (autoScheduleSystems) {
+            ScheduleSystems();
+        }
         CheckSystems();
     }
 
@@ -63,22 +79,39 @@ void RavEngine::World::Tick(float scale) {
 	TickECS(scale);
 
     PostTick(scale);
+    tickTime->Record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count());
+#if !RVE_SERVER
+    if (GetApp()->GetFixedTickRate() > 0){
+        CaptureInterpolationStep();
+    }
+    else if (transformInterpolation.step != 0){
+        // left fixed-rate mode, drop the recorded states
+        transformInterpolation = {};
+    }
+#endif
+}
 
+void World::SyncRenderData(float alpha){
 #if !RVE_SERVER
     // run the render sync tasks
     RVE_PROFILE_SECTION(render, "Sync render data");
-    auto& executor = GetApp()->executor;
-    executor.run(renderTasks).wait();
+    transformInterpolation.alpha = std::clamp(alpha, 0.0f, 1.0f);
+    RunTaskGraph(renderTasks);
     RVE_PROFILE_SECTION_END(render);
 #endif
 }
 
 
 RavEngine::World::World() : Solver(std::make_unique<PhysicsSolver>(this)){
+    const auto nBuffers = GetApp()->executor.num_workers() + 1;
+    commandBuffers.reserve(nBuffers);
+    for (size_t i = 0; i < nBuffers; i++) {
+        commandBuffers.push_back(std::make_unique<EntityCommandBuffer>());
+    }
     SetupTaskGraph();
-    EmplacePolymorphicSystem<ScriptSystem>();
+    EmplaceSerialPolymorphicSystem<ScriptSystem>();	// gathers scripts by type, then ticks compatible batches in parallel
     EmplaceSystem<AnimatorSystem>();
-	EmplaceSystem<SocketSystem>();
+	EmplaceSerialSystem<SocketSystem>();	// moving a transform updates its children, which other sockets' transforms may share
     CreateDependency<AnimatorSystem,ScriptSystem>();			// run scripts before animations
     CreateDependency<AnimatorSystem,PhysicsLinkSystemRead>();	// run physics reads before animator
     CreateDependency<PhysicsLinkSystemWrite,ScriptSystem>();	// run physics write before scripts
@@ -102,7 +135,7 @@ void World::NetworkingSpawn(ctti_t id, Entity& handle){
             auto& netidcomp = handle.EmplaceComponent<NetworkIdentity>(id);
             
             // now send the message to spawn this on the other end
-            GetApp()->networkManager.Spawn(this,id,handle,netidcomp.GetNetworkID());
+            GetApp()->networkManager.Spawn(this,id,handle,netidcomp);
         }
     }
 }
@@ -114,7 +147,7 @@ void World::NetworkingDestroy(entity_t id){
         // is this a networkobject?
         if(handle.HasComponent<NetworkIdentity>()){
             auto& netidcomp = handle.GetComponent<NetworkIdentity>();
-            GetApp()->networkManager.Destroy(netidcomp.GetNetworkID());
+            GetApp()->networkManager.Destroy(netidcomp);
         }
     }
 }
@@ -125,13 +158,13 @@ void World::NetworkingDestroy(entity_t id){
  */
 void RavEngine::World::TickECS(float fpsScale) {
 	currentFPSScale = fpsScale;
+    changeTick++;
 
 	//update time
 	time_now = e_clock_t::now();
 	
 	//execute and wait
-    GetApp()->executor.run(masterTasks);
-    GetApp()->executor.wait_for_all();
+    RunTaskGraph(masterTasks);
 	if (isRendering){
 		newFrame = true;
 	}
@@ -157,25 +190,35 @@ void World::SetupTaskGraph(){
     
     ECSTasks.name("ECS");
     ECSTaskModule = masterTasks.composed_of(ECSTasks).name("ECS");
+
+    // structural changes recorded by systems are applied once all systems have finished
+    auto commandBufferPlayback = masterTasks.emplace([this] {
+        FlushCommandBuffers();
+    }).name("Command Buffer Playback").succeed(ECSTaskModule);
+
+    auto transformPropagation = masterTasks.emplace([this] {
+        if (deferTransformPropagation) {
+            PropagateTransformHierarchy();
+        }
+    }).name("Transform Hierarchy Propagation").succeed(commandBufferPlayback);
+
+    auto spatialIndexUpdate = masterTasks.emplace([this] {
+        UpdateSpatialIndex();
+    }).name("Update Spatial Index").succeed(transformPropagation);
     
     // process any dispatched coroutines
     auto updateAsyncIterators = ECSTasks.emplace([&]{
-        async_begin = async_tasks.begin();
-        async_end = async_tasks.end();
+        // only the functions that have come due are pulled out of the wheel
+        asyncTimers.Advance(GetApp()->GetCurrentTime(), dueAsync);
+        async_begin = dueAsync.begin();
+        async_end = dueAsync.end();
     }).name("async iterator update");
-    auto doAsync = ECSTasks.for_each(std::ref(async_begin), std::ref(async_end), [&](const shared_ptr<dispatched_func>& item){
-        if (GetApp()->GetCurrentTime() >= item->runAtTime){
-            item->func();
-            ranFunctions.push_back(item);
-        }
+    auto doAsync = ECSTasks.for_each(std::ref(async_begin), std::ref(async_end), [&](const TimerWheel::callback_t& func){
+        func();
     }).name("Exec Async");
     updateAsyncIterators.precede(doAsync);
     auto cleanupRanAsync = ECSTasks.emplace([&]{
-        // remove functions that have been run
-        for(const auto item : ranFunctions){
-            async_tasks.erase(item);
-        }
-        ranFunctions.clear();
+        dueAsync.clear();
     }).name("Async cleanup");
     doAsync.precede(cleanupRanAsync);
     
@@ -183,6 +226,12 @@ void World::SetupTaskGraph(){
 
 	auto physicsRootTask = ECSTasks.emplace([] {}).name("PhysicsRootTask");
 
+    // with PhysicsSolver::overlapSimulation, the previous tick's simulation ran alongside the rest of that tick, and finishes here
+    auto FetchPhysics = ECSTasks.emplace([this]{
+        RVE_PROFILE_FN_N("PhysX Fetch");
+        Solver->FetchResults();
+    }).name("PhysX Fetch");
+
 	auto RunPhysics = ECSTasks.emplace([this]{
         RVE_PROFILE_FN_N("PhysX Tick");
         auto nc = (GetAllComponentsOfType<RigidBodyDynamicComponent>()->DenseSize() + GetAllComponentsOfType<RigidBodyStaticComponent>()->DenseSize());
@@ -191,10 +240,34 @@ void World::SetupTaskGraph(){
         }
 	}).name("PhysX Execute");
     
-    auto read = EmplaceSystem<PhysicsLinkSystemRead>();
+    // the read system visits only the bodies PhysX reports as moved, so it has no component scan and is registered by hand
+    SystemTasks read{
+        .rangeUpdate = ECSTasks.emplace([] {}).name("PhysicsLinkSystemRead range update"),
+        .do_task = ECSTasks.emplace([this] {
+            RVE_PROFILE_FN_N("PhysicsLinkSystemRead");
+            PhysicsLinkSystemRead{}(this);
+        }).name("PhysicsLinkSystemRead"),
+        .readDependencies = { CTTI<RigidBodyDynamicComponent>() },
+        .writeDependencies = { CTTI<Transform>() },
+    };
+    read.rangeUpdate.precede(read.do_task);
+    typeToName[CTTI<PhysicsLinkSystemRead>()] = type_name<PhysicsLinkSystemRead>();
+    typeToName[CTTI<RigidBodyDynamicComponent>()] = type_name<RigidBodyDynamicComponent>();
+    typeToName[CTTI<Transform>()] = type_name<Transform>();
+    typeToSystem[CTTI<PhysicsLinkSystemRead>()] = read;
+    systemRegistrationOrder.push_back(CTTI<PhysicsLinkSystemRead>());
+    graphWasModified = true;
+
     auto write = EmplaceSerialSystem<PhysicsLinkSystemWrite>();
+    auto UpdateRegions = ECSTasks.emplace([this]{
+        RVE_PROFILE_FN_N("PhysX Regions");
+        Solver->UpdateSimulationRegions();
+    }).name("PhysX Regions");
     RunPhysics.precede(read.do_task);
+    UpdateRegions.succeed(write.do_task);
+    UpdateRegions.precede(RunPhysics);
     RunPhysics.succeed(write.do_task);
+    FetchPhysics.precede(write.do_task);
 	
     physicsRootTask.precede(read.rangeUpdate,write.rangeUpdate);
 	read.do_task.succeed(RunPhysics);	// if checkRunPhysics returns a 1, it goes here anyways.
@@ -212,6 +285,7 @@ void World::SetupTaskGraph(){
                 ptr->listenerPos = transform.GetWorldPosition();
                 ptr->listenerRot = transform.GetWorldRotation();
                 ptr->listenerGraph = listener.GetGraph();
+                ptr->maxVoices = listener.GetMaxVoices();
             });
             GetApp()->GetCurrentAudioSnapshot()->sourceWorld = shared_from_this();
         }).name("Clear + Listener");
@@ -221,9 +295,8 @@ void World::SetupTaskGraph(){
         auto copyAudios = audioTasks.emplace([this]{
             Filter([this](const AudioSourceComponent& audioSource, const Transform& transform){
                 auto snapshot = GetApp()->GetCurrentAudioSnapshot();
-                auto provider = audioSource.GetPlayer();
-                snapshot->sources.emplace(provider,transform.GetWorldPosition(),transform.GetWorldRotation(), audioSource.GetOwner().GetID());
-                snapshot->dataProviders.insert(provider);
+                const auto& provider = audioSource.GetPlayer();
+                snapshot->AddPointSource(provider,transform.GetWorldPosition(),transform.GetWorldRotation(), audioSource.GetOwner().GetID());
             });
         
             // now clean up the fire-and-forget audios that have completed
@@ -242,16 +315,18 @@ void World::SetupTaskGraph(){
             // now do fire-and-forget audios that need to play
             for(auto& f : instantaneousToPlay){
                 auto snapshot = GetApp()->GetCurrentAudioSnapshot();
-                auto provider = f.source.GetPlayer();
-                snapshot->sources.emplace(provider,f.source.source_position,quaternion(0,0,0,1), f.fakeOwner.GetID());
-                snapshot->dataProviders.insert(provider);
+                const auto& provider = f.source.GetPlayer();
+                snapshot->AddPointSource(provider,f.source.source_position,quaternion(0,0,0,1), f.fakeOwner.GetID());
             }
+        
+            // past the listener's voice budget, only the most audible sources are spatialized
+            GetApp()->GetCurrentAudioSnapshot()->LimitVoices();
         }).name("Point Audios").succeed(audioClear);
     
         auto copyAmbients = audioTasks.emplace([this]{
             // raster audio
             Filter([this](const AmbientAudioSourceComponent& audioSource){
-                GetApp()->GetCurrentAudioSnapshot()->ambientSources.emplace(audioSource.GetPlayer());
+                GetApp()->GetCurrentAudioSnapshot()->ambientSources.Add(audioSource.GetPlayer());
             });
 
             // now clean up the fire-and-forget audios that have completed
@@ -261,7 +336,7 @@ void World::SetupTaskGraph(){
         
             // now do fire-and-forget audios that need to play
             for(auto& f : ambientToPlay){
-                GetApp()->GetCurrentAudioSnapshot()->ambientSources.emplace(f.GetPlayer());
+                GetApp()->GetCurrentAudioSnapshot()->ambientSources.Add(f.GetPlayer());
             }
         
         }).name("Ambient Audios").succeed(audioClear);
@@ -297,7 +372,7 @@ void World::SetupTaskGraph(){
         }).name("Swap Current").succeed(copyAudios,copyAmbients,copySimpleAudioSpaces,copyGeometryAudioSpaces, copyAudioGeometry, copyAudioBoxSpaces);
     
         audioTaskModule = masterTasks.composed_of(audioTasks).name("Audio");
-        audioTaskModule.succeed(ECSTaskModule);
+        audioTaskModule.succeed(spatialIndexUpdate);
     }
 #endif
 }
@@ -326,58 +401,89 @@ void World::setupRenderTasks(){
         nCreatedThisTick = 0;
     });
     
-    auto updateRenderDataGeneric = [this]<typename SM_T, typename ... Aux_T>(const SM_T* sm_t_holder, auto& renderDataSource, auto&& captureLambda, auto&& iteratorComparator, const Aux_T* ... axillaryParams){
-        Filter([this, &renderDataSource, &captureLambda, &iteratorComparator](const SM_T& sm, const Aux_T& ..., Transform& trns) {
-            if (trns.isTickDirty && sm.GetEnabled()) {
-                // update
-                auto valuesToCompare = captureLambda(sm);
-                auto& row = renderDataSource.at(sm.GetMaterial());
-
-                auto it = iteratorComparator(row, valuesToCompare);
-                if (it == row.commands.end()) {
-                    return;
+    auto updateRenderDataGeneric = [this]<typename SM_T, typename ... Aux_T>(NonStaticSubset& subset, const SM_T* sm_t_holder, const Aux_T* ... axillaryParams){
+        auto meshes = GetSetIfExists<SM_T>();
+        auto transforms = GetSetIfExists<Transform>();
+        if (meshes == nullptr || transforms == nullptr) {
+            subset.consumed.clear();
+            return;
+        }
+        auto HasAuxiliary = [this]<typename T>(entity_id_t owner) {
+            auto set = GetSetIfExists<T>();
+            return set && set->HasComponent(owner);
+        };
+        // static meshes only appear in the move list, and only when they have moved
+        RefreshNonStaticSubset(meshes, subset);
+        const auto nNonStatic = static_cast<pos_t>(subset.denseIndices.size());
+        const auto nRows = nNonStatic + static_cast<pos_t>(movedStaticEntities.size());
+        subset.consumed.resize(nRows);
+        DispatchParallelChunks(nRows, defaultParallelFilterChunkSize, [&](pos_t begin, pos_t end) {
+            // gather dirty transforms in small batches, then compose their matrices straight into the host buffer
+            constexpr pos_t batchSize = 64;
+            const Transform* batch[batchSize];
+            uint32_t slots[batchSize];
+            pos_t nBatched = 0;
+            auto flush = [&] {
+                std::span<const uint32_t> batchSlots(slots, nBatched);
+                TransformBatch::WriteWorldMatrices({ batch, nBatched }, batchSlots, renderData.worldTransforms.GetHostDataForWriting(batchSlots));
+                nBatched = 0;
+            };
+            for (pos_t row = begin; row < end; row++) {
+                subset.consumed[row] = nullptr;
+                entity_id_t i;
+                if (row < nNonStatic) {
+                    i = subset.denseIndices[row];
+                }
+                else {
+                    const auto moved = movedStaticEntities[row - nNonStatic];
+                    if (!meshes->HasComponent(moved)) {
+                        continue;
+                    }
+                    i = meshes->DenseIndexForEntity(moved);
+                }
+                const auto owner = meshes->GetOwner(i);
+                if (!transforms->HasComponent(owner) || !(HasAuxiliary.template operator()<Aux_T>(owner) && ...)) {
+                    continue;
+                }
+                auto& trns = transforms->GetComponent(owner);
+                if (trns.isTickDirty && meshes->Get(i).GetEnabled()) {
+                    // the flag is cleared by the last task of the graph, because the light tasks read it concurrently
+                    subset.consumed[row] = &trns;
+                    if (owner < transformInterpolation.capturedAtStep.size() && transformInterpolation.capturedAtStep[owner] == transformInterpolation.step) {
+                        // written by WriteInterpolatedTransforms instead
+                        continue;
+                    }
+                    if (trns.renderMatrixWritten) {
+                        // a body's pose, already written by PhysicsLinkSystemRead
+                        continue;
+                    }
+                    batch[nBatched] = &trns;
+                    slots[nBatched] = owner;
+                    nBatched++;
+                    if (nBatched == batchSize) {
+                        flush();
+                    }
                 }
-                assert(it != row.commands.end());
-                auto& vec = *it;
-                // write new matrix
-                auto owner = trns.GetOwner();
-                auto ownerIDInWorld = owner.GetID();
-                renderData.worldTransforms.SetValueAt(ownerIDInWorld.id, trns.GetWorldMatrix());
-               
-
-                trns.ClearTickDirty();
             }
+            flush();
         });
     };
 
     auto updateRenderDataStaticMesh = renderTasks.emplace([this,updateRenderDataGeneric] {
         RVE_PROFILE_FN_N("World: Update Static Mesh Render Data");
         constexpr static StaticMesh* ptrForTemplate = nullptr;
-        updateRenderDataGeneric(ptrForTemplate,renderData.staticMeshRenderData, [](auto& sm){
-            return sm.GetMesh();
-        }, [](auto& row, auto& meshToUpdate){
-            return std::find_if(row.commands.begin(), row.commands.end(), [&](const auto& value) {
-                return value.mesh.lock() == meshToUpdate;
-            });
-        });
-       
+        updateRenderDataGeneric(staticMeshSubset, ptrForTemplate);
     }).name("Update invalidated static mesh transforms");
 
     auto updateRenderDataSkinnedMesh = renderTasks.emplace([this,updateRenderDataGeneric] {
         RVE_PROFILE_FN_N("World: Update Skinned Mesh Render Data");
         constexpr static SkinnedMeshComponent* ptrForTemplate = nullptr;
-        constexpr static AnimatorComponent* ptrForTemplate2 = nullptr;
-        updateRenderDataGeneric(ptrForTemplate,renderData.skinnedMeshRenderData, [](auto& sm){
-            return std::make_pair(sm.GetMesh(), sm.GetSkeleton());
-        }, [](auto& row, auto& valuesToCompare){
-            return std::find_if(row.commands.begin(), row.commands.end(), [&](const auto& value) {
-                return value.mesh.lock() == valuesToCompare.first && value.skeleton.lock() == valuesToCompare.second;
-            });
-        }, ptrForTemplate2);
+        // posed by an AnimatorComponent or a BakedAnimatorComponent, the renderer skips meshes with neither
+        updateRenderDataGeneric(skinnedMeshSubset, ptrForTemplate);
     }).name("Upate invalidated skinned mesh transforms");
 
     auto updateParticleSystems = renderTasks.emplace([this] {
-        Filter([this](const ParticleEmitter& emitter, const Transform& t) {
+        ParallelFilter([this](const ParticleEmitter& emitter, const Transform& t) {
             if (t.getTickDirty()) {
                 auto owner = t.GetOwner();
                 auto ownerIDInWorld = owner.GetID();
@@ -386,17 +492,32 @@ void World::setupRenderTasks(){
         });
     });
     
-    resizeBuffer.precede(updateRenderDataStaticMesh, updateRenderDataSkinnedMesh, updateParticleSystems);
+    auto updateInstancedMeshes = renderTasks.emplace([this] {
+        RVE_PROFILE_FN_N("World: Update Instanced Mesh Render Data");
+        ParallelFilter([this](InstancedStaticMesh& ism, const Transform& t) {
+            if (ism.GetEnabled()) {
+                ism.SyncRenderTransforms(renderData.worldTransforms, t.GetWorldMatrix());
+            }
+        }, 16);     // each batch can hold many instances, so chunk finely
+    }).name("Update instanced mesh transforms");
+    
+    resizeBuffer.precede(updateRenderDataStaticMesh, updateRenderDataSkinnedMesh, updateParticleSystems, updateInstancedMeshes);
     
+    // Lights are updated in parallel, and each row only writes its own light and its own slot in the render data.
+    // They run alongside the mesh tasks, since nothing clears the transforms' tick-dirty flags until every reader is done.
+    // Static lights are skipped unless they moved, and the rest only write what changed: their transform, or their settings.
+    constexpr pos_t lightChunkSize = 64;
+
     auto updateInvalidatedDirs = renderTasks.emplace([this]{
-        if (auto ptr = GetAllComponentsOfType<DirectionalLight>()){
-            for(entity_id_t i = 0; i < ptr->DenseSize(); i++){
-                auto ownerID = ptr->GetOwner(i);
-                auto owner = Entity({ownerID, VersionForEntity(ownerID)},this);
-                auto& transform = owner.GetTransform();
+        auto ptr = GetAllComponentsOfType<DirectionalLight>();
+        auto transforms = GetSetIfExists<Transform>();
+        if (ptr && transforms){
+            ParallelForEachNonStaticOrMoved(ptr, dirLightSubset, lightChunkSize, [&](entity_id_t i){
+                const auto ownerID = ptr->GetOwner(i);
+                const auto& transform = transforms->GetComponent(ownerID);
                 if (transform.isTickDirty){
                     // update transform data if it has changed
-                    auto rot = owner.GetTransform().WorldUp();
+                    auto rot = transform.WorldUp();
 
                     // use local ID here, no need for local-to-global translation
                     auto& uploadData = renderData.directionalLightData.GetForSparseIndexForWriting(ptr->GetOwner(i));
@@ -416,21 +537,20 @@ void World::setupRenderTasks(){
                     }
                     dirLightUploadData.shadowLayers = lightdata.GetShadowLayers();
                     dirLightUploadData.illuminationLayers = lightdata.GetIlluminationLayers();
-                    dirLightUploadData.numCascades = lightdata.numCascades;
                     lightdata.clearInvalidate();
                     
                 }
-                // don't reset transform tickInvalidated here because the meshUpdater needs it after this
-            }
+            });
         }
-    }).name("Update Invalidated DirLights").precede(updateRenderDataStaticMesh, updateRenderDataSkinnedMesh);
+    }).name("Update Invalidated DirLights");
     
     auto updateInvalidatedSpots = renderTasks.emplace([this]{
-        if (auto ptr = GetAllComponentsOfType<SpotLight>()){
-            for(entity_id_t i = 0; i < ptr->DenseSize(); i++){
-                auto ownerID = ptr->GetOwner(i);
-                auto owner = Entity({ownerID, VersionForEntity(ownerID)},this);
-                auto& transform = owner.GetTransform();
+        auto ptr = GetAllComponentsOfType<SpotLight>();
+        auto transforms = GetSetIfExists<Transform>();
+        if (ptr && transforms){
+            ParallelForEachNonStaticOrMoved(ptr, spotLightSubset, lightChunkSize, [&](entity_id_t i){
+                const auto ownerID = ptr->GetOwner(i);
+                const auto& transform = transforms->GetComponent(ownerID);
                 auto& lightData = ptr->Get({i});
                 if (transform.isTickDirty){
                     // update transform data if it has changed
@@ -450,28 +570,27 @@ void World::setupRenderTasks(){
                     denseData.color = { colorData.R,colorData.G,colorData.B};
                     denseData.intensity = lightData.GetIntensity();
                     denseData.castsShadows = lightData.CastsShadows();
-                    denseData.shadowmapBindlessIndex = lightData.shadowData.shadowMap->GetDefaultView().GetReadonlyBindlessTextureHandle();
                     denseData.shadowLayers = lightData.GetShadowLayers();
                     denseData.illuminationLayers = lightData.GetIlluminationLayers();
                     lightData.clearInvalidate();
                 }
-                // don't reset transform tickInvalidated here because the meshUpdater needs it after this
-            }
+            });
         }
-    }).name("Update Invalidated SpotLights").precede(updateRenderDataStaticMesh, updateRenderDataSkinnedMesh);
+    }).name("Update Invalidated SpotLights");
     
     auto updateInvalidatedPoints = renderTasks.emplace([this]{
-        if (auto ptr = GetAllComponentsOfType<PointLight>()){
-            for(entity_id_t i = 0; i < ptr->DenseSize(); i++){
-                auto ownerID = ptr->GetOwner(i);
-                auto owner = Entity({ownerID, VersionForEntity(ownerID)},this);
-                auto& transform = owner.GetTransform();
+        auto ptr = GetAllComponentsOfType<PointLight>();
+        auto transforms = GetSetIfExists<Transform>();
+        if (ptr && transforms){
+            ParallelForEachNonStaticOrMoved(ptr, pointLightSubset, lightChunkSize, [&](entity_id_t i){
+                const auto ownerID = ptr->GetOwner(i);
+                const auto& transform = transforms->GetComponent(ownerID);
                 if (transform.isTickDirty){
                     // update transform data if it has changed
                     auto& gpudata = renderData.pointLightData.GetForSparseIndexForWriting(ptr->GetOwner(i));
                     gpudata.position = transform.GetWorldPosition();
-                    for (int i = 0; i < 6; i++) {
-                        gpudata.viewMats[i] = PointLight::CalcViewMatrix(gpudata.position, i);
+                    for (uint8_t face = 0; face < 6; face++) {
+                        gpudata.viewMats[face] = PointLight::CalcViewMatrix(gpudata.position, face);
                     }
                 }
                 auto& lightData = ptr->Get({i});
@@ -483,40 +602,297 @@ void World::setupRenderTasks(){
                     denseData.color = { colorData.R,colorData.G,colorData.B};
                     denseData.intensity = lightData.GetIntensity();
                     denseData.castsShadows = lightData.CastsShadows();
-                    for (int i = 0; i < 6; i++) {
-                        denseData.shadowmapBindlessIndices[i] = lightData.shadowData.cubeShadowmaps[i]->GetDefaultView().GetReadonlyBindlessTextureHandle();
-                    }
                     denseData.projMat = lightData.CalcProjectionMatrix();
-                    //denseData.shadowmapBindlessIndex = lightData.shadowData.mapCube->GetDefaultView().GetReadonlyBindlessTextureHandle();
                     denseData.shadowLayers = lightData.GetShadowLayers();
                     denseData.illuminationLayers = lightData.GetIlluminationLayers();
                     lightData.clearInvalidate();
                 }
-                // don't reset transform tickInvalidated here because the meshUpdater needs it after this
-            }
+            });
         }
-    }).name("Update Invalidated PointLights").precede(updateRenderDataStaticMesh, updateRenderDataSkinnedMesh);
+    }).name("Update Invalidated PointLights");
     
     auto updateInvalidatedAmbients = renderTasks.emplace([this]{
         if(auto ptr = GetAllComponentsOfType<AmbientLight>()){
+            // ambient lights have no transform, so only their settings change
             for(entity_id_t i = 0; i < ptr->DenseSize(); i++){
-                auto ownerLocalId = ptr->GetOwner(i);
                 auto& light = ptr->Get({i});
+                if (!light.isInvalidated()){
+                    continue;
+                }
+                auto ownerLocalId = ptr->GetOwner(i);
                 auto& color = light.GetColorRGBA();
                 renderData.ambientLightData.GetForSparseIndexForWriting(ownerLocalId) = {{color.R, color.G, color.B}, light.GetIntensity(), light.GetIlluminationLayers()};
                 light.clearInvalidate();
             }
         }
     }).name("Update Invalidated AmbLights"); 
+    
+    // the flags share a byte with the rest of the transform's bits, so nothing may read or write them while this runs
+    auto clearTickDirty = renderTasks.emplace([this]{
+        for (auto subset : { &staticMeshSubset, &skinnedMeshSubset }) {
+            DispatchParallelChunks(static_cast<pos_t>(subset->consumed.size()), defaultParallelFilterChunkSize, [subset](pos_t begin, pos_t end) {
+                for (pos_t row = begin; row < end; row++) {
+                    if (auto transform = subset->consumed[row]) {
+                        transform->ClearTickDirty();
+                    }
+                }
+            });
+        }
+    }).name("Clear consumed tick-dirty transforms").succeed(updateRenderDataStaticMesh, updateRenderDataSkinnedMesh, updateParticleSystems, updateInvalidatedDirs, updateInvalidatedSpots, updateInvalidatedPoints);
+
+    renderTasks.emplace([this]{
+        ClearStaticTransformMoves();
+    }).name("Clear moved static transforms").succeed(clearTickDirty);
+    
+    renderTasks.emplace([this]{
+        WriteInterpolatedTransforms();
+    }).name("Write interpolated mesh transforms").succeed(updateRenderDataStaticMesh, updateRenderDataSkinnedMesh);
 }
 #endif
 
+#if !RVE_SERVER
+World::InterpolationState World::InterpolationState::FromMatrix(const matrix4& m){
+    InterpolationState state;
+    state.position = vector3(m[3]);
+    state.scale = vector3(glm::length(vector3(m[0])), glm::length(vector3(m[1])), glm::length(vector3(m[2])));
+    const matrix3 rotation(vector3(m[0]) / state.scale.x, vector3(m[1]) / state.scale.y, vector3(m[2]) / state.scale.z);
+    state.rotation = glm::quat_cast(rotation);
+    return state;
+}
+
+matrix4 World::InterpolationState::ToMatrix() const{
+    matrix4 result;
+    TransformBatch::ComposeMatrix(matrix4(1), position, rotation, scale, result);
+    return result;
+}
+
+void World::CaptureInterpolationStep(){
+    RVE_PROFILE_FN;
+    auto& interp = transformInterpolation;
+    auto transforms = GetSetIfExists<Transform>();
+    if (!transforms){
+        return;
+    }
+    interp.step++;
+    const auto maxID = numEntities;
+    if (interp.capturedAtStep.size() < maxID){
+        interp.previous.resize(maxID);
+        interp.current.resize(maxID);
+        interp.capturedAtStep.resize(maxID, 0);
+        interp.capturedVersion.resize(maxID, 0);
+    }
+    auto advance = [&](entity_id_t id, const Transform& transform){
+        interp.previous[id] = interp.current[id];
+        interp.current[id] = InterpolationState::FromMatrix(transform.GetWorldMatrix());
+        interp.capturedAtStep[id] = interp.step;
+    };
+
+    // entities that moved last step: they may have stopped, so advance them regardless
+    for (const auto id : interp.moving){
+        if (transforms->HasComponent(id)){
+            advance(id, transforms->GetComponent(id));
+        }
+    }
+    // meshes that moved this step
+    auto captureSet = [&](auto set){
+        if (set == nullptr){
+            return;
+        }
+        for (entity_id_t i = 0; i < set->DenseSize(); i++){
+            const auto owner = set->GetOwner(i);
+            if (!transforms->HasComponent(owner) || interp.capturedAtStep[owner] == interp.step){
+                continue;
+            }
+            auto& transform = transforms->GetComponent(owner);
+            if (!transform.isTickDirty){
+                continue;
+            }
+            const auto version = VersionForEntity(owner);
+            if (interp.capturedAtStep[owner] == 0 || interp.capturedVersion[owner] != version){
+                // first time it's seen, so there is nothing to interpolate from
+                interp.capturedVersion[owner] = version;
+                interp.current[owner] = InterpolationState::FromMatrix(transform.GetWorldMatrix());
+            }
+            advance(owner, transform);
+            interp.moving.push_back(owner);
+        }
+    };
+    captureSet(GetSetIfExists<StaticMesh>());
+    captureSet(GetSetIfExists<SkinnedMeshComponent>());
+}
+
+void World::WriteInterpolatedTransforms(){
+    auto& interp = transformInterpolation;
+    auto transforms = GetSetIfExists<Transform>();
+    for (size_t i = 0; i < interp.moving.size();){
+        const auto id = interp.moving[i];
+        if (!transforms || !transforms->HasComponent(id) || interp.capturedVersion[id] != VersionForEntity(id)){
+            // destroyed since it was captured
+            interp.capturedAtStep[id] = 0;
+            interp.moving[i] = interp.moving.back();
+            interp.moving.pop_back();
+            continue;
+        }
+        const auto& from = interp.previous[id];
+        const auto& to = interp.current[id];
+        const InterpolationState blended{
+            glm::mix(from.position, to.position, interp.alpha),
+            glm::mix(from.scale, to.scale, interp.alpha),
+            glm::slerp(from.rotation, to.rotation, interp.alpha)
+        };
+        renderData.worldTransforms.SetValueAt(id, blended.ToMatrix());
+        i++;
+    }
+    // entities that did not move in the last step have reached their final state
+    std::erase_if(interp.moving, [&interp](entity_id_t id){
+        return interp.previous[id] == interp.current[id];
+    });
+}
+#endif
+
+template<typename T>
+void World::RefreshNonStaticSubset(const EntitySparseSet<T>* set, NonStaticSubset& subset){
+    if (subset.setVersion == set->GetStructureVersion() && subset.staticVersion == staticMembershipVersion){
+        return;
+    }
+    subset.setVersion = set->GetStructureVersion();
+    subset.staticVersion = staticMembershipVersion;
+    subset.denseIndices.clear();
+    auto transforms = GetSetIfExists<Transform>();
+    for (entity_id_t i = 0; i < set->DenseSize(); i++){
+        const auto owner = set->GetOwner(i);
+        if (transforms && transforms->HasComponent(owner) && transforms->GetComponent(owner).IsStatic()){
+            continue;
+        }
+        subset.denseIndices.push_back(i);
+    }
+}
+
+template<typename T, typename Fn>
+void World::ParallelForEachNonStaticOrMoved(EntitySparseSet<T>* set, NonStaticSubset& subset, pos_t minChunkSize, const Fn& fn){
+    RefreshNonStaticSubset(set, subset);
+    const auto nNonStatic = static_cast<pos_t>(subset.denseIndices.size());
+    const auto nRows = nNonStatic + static_cast<pos_t>(movedStaticEntities.size());
+    DispatchParallelChunks(nRows, minChunkSize, [&](pos_t begin, pos_t end){
+        for (pos_t row = begin; row < end; row++){
+            if (row < nNonStatic){
+                fn(subset.denseIndices[row]);
+            }
+            else if (const auto moved = movedStaticEntities[row - nNonStatic]; set->HasComponent(moved)){
+                fn(set->DenseIndexForEntity(moved));
+            }
+        }
+    });
+}
+
+void World::QueueStaticTransformMove(const Transform& transform){
+#if !RVE_SERVER
+    // only the render data passes consume the move list
+    RAIILock lock(staticMoveLock);
+    if (!transform.staticMoveQueued){
+        transform.staticMoveQueued = true;
+        movedStaticEntities.push_back(transform.GetOwner().GetID().id);
+        staticMoveVersion++;
+    }
+#endif
+}
+
+void World::ClearStaticTransformMoves(){
+    if (auto transforms = GetSetIfExists<Transform>()){
+        for (const auto moved : movedStaticEntities){
+            if (transforms->HasComponent(moved)){
+                transforms->GetComponent(moved).staticMoveQueued = false;
+            }
+        }
+    }
+    movedStaticEntities.clear();
+}
+
 void World::DispatchAsync(const Function<void ()>& func, double delaySeconds){
     auto time = GetApp()->GetCurrentTime();
     GetApp()->DispatchMainThread([=]{
-        async_tasks.insert(make_shared<dispatched_func>(time + delaySeconds,func));
+        asyncTimers.Schedule(time + delaySeconds, func);
+    });
+}
+EntityCommandBuffer& World::GetCommandBuffer(){
+    const auto workerID = GetApp()->executor.this_worker_id();
+    return *commandBuffers[workerID + 1];     // -1 (not a worker) maps to the shared buffer
+}
+
+void World::FlushCommandBuffers(){
+    RVE_PROFILE_FN;
+    using Command = EntityCommandBuffer::Command;
+    size_t total = 0;
+    for (const auto& buffer : commandBuffers) {
+        total += buffer->commands.size();
+    }
+    if (total == 0) {
+        return;
+    }
+
+    Vector<Command> commands;
+    commands.reserve(total);
+    for (auto& buffer : commandBuffers) {
+        std::move(buffer->commands.begin(), buffer->commands.end(), std::back_inserter(commands));
+        buffer->commands.clear();
+        buffer->nextSequence = 0;
+    }
+
+    // group by phase, then by component type so each sparse set is touched in one run.
+    // entries for the same type keep their recording order within a thread.
+    std::stable_sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+        if (a.type != b.type) {
+            return a.type < b.type;
+        }
+        if (a.componentType != b.componentType) {
+            return a.componentType < b.componentType;
+        }
+        return a.sequence < b.sequence;
+    });
+
+    for (auto& command : commands) {
+        command.apply(this);
+    }
+}
+
+void World::DispatchParallelChunks(pos_t count, pos_t minChunkSize, FunctionRef<void(pos_t, pos_t)> fn){
+    if (count == 0){
+        return;
+    }
+    auto& executor = GetApp()->executor;
+    const pos_t nWorkers = static_cast<pos_t>(executor.num_workers());
+
+    // aim for a few chunks per worker so that uneven chunks can be balanced, but never go below the minimum
+    const pos_t balancedChunkSize = (count + (nWorkers * 4) - 1) / (nWorkers * 4);
+    const pos_t chunkSize = std::max<pos_t>({ minChunkSize, balancedChunkSize, 1 });
+    const pos_t nChunks = (count + chunkSize - 1) / chunkSize;
+
+    // not worth the scheduling overhead
+    if (nChunks <= 1 || nWorkers <= 1){
+        fn(0, count);
+        return;
+    }
+
+    tf::Taskflow chunkFlow;
+    chunkFlow.for_each_index(pos_t(0), nChunks, pos_t(1), [&fn, chunkSize, count](pos_t chunk){
+        const pos_t begin = chunk * chunkSize;
+        fn(begin, std::min(begin + chunkSize, count));
     });
+
+    RunTaskGraph(chunkFlow);
+}
+
+void World::RunTaskGraph(tf::Taskflow& graph){
+    auto& executor = GetApp()->executor;
+    if (executor.this_worker_id() >= 0){
+        // we are already inside a task, for example when worlds tick in parallel, so participate instead of blocking the worker
+        executor.run_and_wait(graph);
+    }
+    else{
+        executor.run(graph).wait();
+    }
 }
+
 #if !RVE_SERVER
 void World::SetupPerEntityRenderData(entity_t localID){
     auto& renderLayers = renderData.renderLayers;
@@ -527,16 +903,49 @@ void World::SetupPerEntityRenderData(entity_t localID){
         perObjectAttributes.Resize(newSize);
     }
     renderLayers.SetValueAt(localID.id, ALL_LAYERS);
-    perObjectAttributes.SetValueAt(localID.id, ALL_ATTRIBUTES);
+    perObjectAttributes.SetValueAt(localID.id, ALL_ATTRIBUTES & ~StaticTransformBit);
+}
+
+void World::SetupPerEntityRenderData(std::span<const entity_t> localIDs){
+    if (localIDs.empty()){
+        return;
+    }
+    auto& renderLayers = renderData.renderLayers;
+    auto& perObjectAttributes = renderData.perObjectAttributes;
+    entity_id_t maxID = 0;
+    for (const auto id : localIDs){
+        maxID = std::max(maxID, entity_id_t(id.id));
+    }
+    if (renderLayers.Size() <= maxID){
+        auto newSize = closest_power_of<entity_id_t>(maxID+1, 2);
+        renderLayers.Resize(newSize);
+        perObjectAttributes.Resize(newSize);
+    }
+    for (const auto id : localIDs){
+        renderLayers.SetValueAt(id.id, ALL_LAYERS);
+        perObjectAttributes.SetValueAt(id.id, ALL_ATTRIBUTES & ~StaticTransformBit);
+    }
+}
+
+void World::SetEntityStaticForRendering(entity_t localid, bool isStatic){
+    auto attributes = renderData.perObjectAttributes[localid.id];
+    attributes = isStatic ? (attributes | StaticTransformBit) : (attributes & ~StaticTransformBit);
+    renderData.perObjectAttributes.SetValueAt(localid.id, attributes);
 }
 
 void World::SetEntityRenderlayer(entity_t localid, renderlayer_t layers){
     renderData.renderLayers.SetValueAt(localid.id, layers);
 }
 
+renderlayer_t World::GetEntityRenderlayer(entity_t localid){
+    return renderData.renderLayers[localid.id];
+}
+
 void World::SetEntityAttributes(entity_t localid, perobject_t attributes)
 {
-    renderData.perObjectAttributes.SetValueAt(localid.id, attributes);
+    // the static bit is owned by the engine
+    const auto staticBit = renderData.perObjectAttributes[localid.id] & StaticTransformBit;
+    renderData.perObjectAttributes.SetValueAt(localid.id, (attributes & ~StaticTransformBit) | staticBit);
 }
 
 perobject_t World::GetEntityAttributes(entity_t localid)
@@ -544,7 +953,7 @@ perobject_t World::GetEntityAttributes(entity_t localid)
     return renderData.perObjectAttributes[localid.id];
 }
 
-void DestroyMeshRenderDataGeneric(const auto& mesh, auto material, auto&& renderData, entity_t local_id, auto&& iteratorComparator){
+void DestroyMeshRenderDataGeneric(const auto& key, auto material, auto&& renderData, entity_t local_id){
     if (material == nullptr) {
         return;
     }
@@ -553,14 +962,12 @@ void DestroyMeshRenderDataGeneric(const auto& mesh, auto material, auto&& render
     auto data_it = renderData.find(material);
     if (data_it != renderData.end()){
         auto& data = (*data_it).second;
-        auto it = std::find_if(data.commands.begin(), data.commands.end(), [&](auto& other) {
-            return iteratorComparator(other);
-        });
-        if (it != data.commands.end() && (*it).entities.HasForSparseIndex(local_id.id)) {
-            (*it).entities.EraseAtSparseIndex(local_id.id);
+        auto command = data.commandIndex.Find(data.commands, key);
+        if (command != nullptr && command->entities.HasForSparseIndex(local_id.id)) {
+            command->entities.EraseAtSparseIndex(local_id.id);
             // if empty, remove from the larger container
-            if ((*it).entities.DenseSize() == 0) {
-                data.commands.erase(it);
+            if (command->entities.DenseSize() == 0) {
+                data.commandIndex.Erase(data.commands, key);
             }
             if (data.commands.size() == 0){
                 removeContains = true;
@@ -573,7 +980,7 @@ void DestroyMeshRenderDataGeneric(const auto& mesh, auto material, auto&& render
     
 }
 
-void updateMeshMaterialGeneric(auto&& renderData, entity_t localID, auto oldMat, auto newMat, auto mesh, auto&& deletionComparator, auto&& comparator, auto&& newConstructionFunction){
+void updateMeshMaterialGeneric(auto&& renderData, entity_t localID, auto oldMat, auto newMat, const auto& key, auto&& newConstructionFunction){
     
     // detect the case of the material set to itself
     if (oldMat == newMat) {
@@ -581,77 +988,79 @@ void updateMeshMaterialGeneric(auto&& renderData, entity_t localID, auto oldMat,
     }
 
     // remove render data for the old mesh
-    DestroyMeshRenderDataGeneric(mesh, oldMat, renderData, localID, deletionComparator);
+    DestroyMeshRenderDataGeneric(key, oldMat, renderData, localID);
         
     // add the new mesh & its transform to the hashmap
     auto& set = renderData[newMat];
-    bool found = false;
-    for (auto& command : set.commands) {
-        found = comparator(command);
-        if (found) {
-            command.entities.Emplace(localID.id,entity_id_t(localID.id));
-            break;
-        }
+    if (auto command = set.commandIndex.Find(set.commands, key)) {
+        command->entities.Emplace(localID.id,entity_id_t(localID.id));
     }
-    // otherwise create a new entry
-    if (!found) {
-        newConstructionFunction(set.commands);
+    else {
+        // otherwise create a new entry
+        newConstructionFunction(set);
     }
     
 }
 
+// impostors draw from their own collection and material, which do not change with the mesh's material, see MeshCollectionStatic::SetImpostor
+void AddImpostorRenderData(auto&& renderData, entity_t localID, const MeshCollectionStatic& mesh){
+    auto impostorMesh = mesh.GetImpostorCollection();
+    if (impostorMesh == nullptr){
+        return;
+    }
+    const MeshCollectionStatic* key = impostorMesh.get();
+    updateMeshMaterialGeneric(renderData, localID, Ref<MaterialInstance>{}, mesh.GetImpostorMaterial(), key,
+        [impostorMesh, localID, key](auto&& set){
+            set.commandIndex.Emplace(set.commands, key, impostorMesh, localID.id, localID.id);
+        }
+    );
+}
+
+void DestroyImpostorRenderData(auto&& renderData, entity_t localID, const MeshCollectionStatic& mesh){
+    if (auto impostorMesh = mesh.GetImpostorCollection()){
+        const MeshCollectionStatic* key = impostorMesh.get();
+        DestroyMeshRenderDataGeneric(key, mesh.GetImpostorMaterial(), renderData, localID);
+    }
+}
+
 void RavEngine::World::updateStaticMeshMaterial(entity_t localId, Ref<MaterialInstance> oldMat, Ref<MaterialInstance> newMat, Ref<MeshCollectionStatic> mesh)
 {
 
     assert(HasComponent<Transform>(localId) && "Cannot change material on an entity that does not have a transform!");
-    updateMeshMaterialGeneric(renderData.staticMeshRenderData, localId, oldMat, newMat, mesh,
-        [mesh](auto&& other){
-            return other.mesh.lock() == mesh;
-        },
-        [mesh](auto&& command){
-            auto cmpMesh = command.mesh.lock();
-            return cmpMesh == mesh;
-        },
-        [mesh, localId](auto&& commands){
-            commands.emplace(mesh, localId.id, localId.id);
+    const MDIICommand::key_t key = mesh.get();
+    updateMeshMaterialGeneric(renderData.staticMeshRenderData, localId, oldMat, newMat, key,
+        [mesh, localId, key](auto&& set){
+            set.commandIndex.Emplace(set.commands, key, mesh, localId.id, localId.id);
         }
     );
+    // entering the render data
+    if (oldMat == nullptr && newMat != nullptr){
+        AddImpostorRenderData(renderData.staticMeshRenderData, localId, *mesh);
+    }
 }
 
 void RavEngine::World::updateSkinnedMeshMaterial(entity_t localId, Ref<MaterialInstance> oldMat, Ref<MaterialInstance> newMat, Ref<MeshCollectionSkinned> mesh, Ref<SkeletonAsset> skeleton)
 {
     
     assert(HasComponent<Transform>(localId) && "Cannot change material on an entity that does not have a transform!");
-    updateMeshMaterialGeneric(renderData.skinnedMeshRenderData, localId, oldMat, newMat, mesh,
-        [mesh, &skeleton](auto&& other){
-            return other.mesh.lock() == mesh && other.skeleton.lock() == skeleton;
-        },
-        [mesh, &skeleton](auto&& command){
-            auto cmpMesh = command.mesh.lock();
-            return cmpMesh == mesh && command.skeleton.lock() == skeleton;
-        },
-        [mesh, &skeleton, localId](auto&& commands){
-            commands.emplace(mesh, skeleton, localId.id, localId.id);
+    const MDIICommandSkinned::key_t key{ mesh.get(), skeleton.get() };
+    updateMeshMaterialGeneric(renderData.skinnedMeshRenderData, localId, oldMat, newMat, key,
+        [mesh, &skeleton, localId, &key](auto&& set){
+            set.commandIndex.Emplace(set.commands, key, mesh, skeleton, localId.id, localId.id);
         }
     );
 }
 
 void RavEngine::World::DestroyStaticMeshRenderData(const StaticMesh& mesh, entity_t local_id)
 {
-    
-    auto meshData = mesh.GetMesh();
-    DestroyMeshRenderDataGeneric(mesh.GetMesh(), mesh.GetMaterial(), renderData.staticMeshRenderData, local_id, [meshData](auto&& other){
-        return other.mesh.lock() == meshData;
-    });
+    const MDIICommand::key_t key = mesh.GetMesh().get();
+    DestroyMeshRenderDataGeneric(key, mesh.GetMaterial(), renderData.staticMeshRenderData, local_id);
+    DestroyImpostorRenderData(renderData.staticMeshRenderData, local_id, *mesh.GetMesh());
 }
 
 void World::DestroySkinnedMeshRenderData(const SkinnedMeshComponent& mesh, entity_t local_id) {
-    
-    auto skeleton = mesh.GetSkeleton();
-    auto meshData = mesh.GetMesh();
-    DestroyMeshRenderDataGeneric(mesh.GetMesh(), mesh.GetMaterial(), renderData.skinnedMeshRenderData, local_id, [&meshData, &skeleton](auto&& other){
-        return other.mesh.lock() == meshData && other.skeleton.lock() == skeleton;
-    });
+    const MDIICommandSkinned::key_t key{ mesh.GetMesh().get(), mesh.GetSkeleton().get() };
+    DestroyMeshRenderDataGeneric(key, mesh.GetMaterial(), renderData.skinnedMeshRenderData, local_id);
 }
 
 void World::StaticMeshChangedVisibility(const StaticMesh* mesh){
@@ -664,6 +1073,42 @@ void World::StaticMeshChangedVisibility(const StaticMesh* mesh){
 	}
 }
 
+void World::AddInstancedMeshRenderData(std::span<const entity_t> slots, Ref<MaterialInstance> mat, Ref<MeshCollectionStatic> mesh){
+    if (slots.empty() || mat == nullptr){
+        return;
+    }
+    auto& set = renderData.staticMeshRenderData[mat];
+    const MDIICommand::key_t key = mesh.get();
+    size_t first = 0;
+    auto command = set.commandIndex.Find(set.commands, key);
+    if (command == nullptr){
+        command = &set.commandIndex.Emplace(set.commands, key, mesh, slots[0].id, slots[0].id);
+        first = 1;
+    }
+    auto& entities = command->entities;
+    for (size_t i = first; i < slots.size(); i++){
+        entities.Emplace(slots[i].id, entity_id_t(slots[i].id));
+    }
+    for (const auto slot : slots){
+        AddImpostorRenderData(renderData.staticMeshRenderData, slot, *mesh);
+    }
+}
+
+void World::RemoveInstancedMeshRenderData(std::span<const entity_t> slots, Ref<MaterialInstance> mat, Ref<MeshCollectionStatic> mesh){
+    for (const auto slot : slots){
+        DestroyMeshRenderDataGeneric(MDIICommand::key_t(mesh.get()), mat, renderData.staticMeshRenderData, slot);
+        DestroyImpostorRenderData(renderData.staticMeshRenderData, slot, *mesh);
+    }
+}
+
+void World::ReleaseInstanceSlots(std::span<const entity_t> slots){
+    // slots never hold components, so skip the component sweep that DestroyEntity does
+    for (const auto slot : slots){
+        available.push(slot.id);
+        versions[slot.id]++;
+    }
+}
+
 void World::SkinnedMeshChangedVisibility(const SkinnedMeshComponent* mesh){
 	auto owner = mesh->GetOwner();
 	if (mesh->GetEnabled()){
@@ -695,6 +1140,186 @@ entity_t World::CreateEntity(){
     return id;
 }
 
+void World::CreateEntities(pos_t count, Vector<entity_t>& outIDs){
+    outIDs.reserve(outIDs.size() + count);
+    const auto firstNew = outIDs.size();
+
+    // recycle first
+    while (count > 0 && available.size() > 0){
+        entity_t id;
+        id.id = available.front();
+        available.pop();
+        id.version = versions[id.id];
+        outIDs.push_back(id);
+        count--;
+    }
+
+    // then allocate fresh IDs, growing the version table once
+    if (count > 0){
+        const entity_id_t lastID = numEntities + count - 1;
+        if (lastID >= versions.size()){
+            versions.resize(closest_power_of<entity_id_t>(lastID + 1, 2));
+        }
+        for (pos_t i = 0; i < count; i++){
+            entity_t id;
+            id.id = numEntities++;
+            id.version = 0;
+            versions[id.id] = 0;
+            outIDs.push_back(id);
+        }
+        nCreatedThisTick += count;
+    }
+#if !RVE_SERVER
+    SetupPerEntityRenderData(std::span<const entity_t>(outIDs.begin() + firstNew, outIDs.end()));
+#endif
+}
+
+namespace {
+    constexpr uint32_t snapshotMagic = 0x53455652;  // "RVES"
+    constexpr uint32_t snapshotFormatVersion = 1;
+}
+
+const std::byte* World::SnapshotReader::Take(size_t size){
+    if (size > bytes.size() - offset){
+        Debug::Fatal("World snapshot is truncated: needed {} bytes at offset {}, but it is {} bytes", size, offset, bytes.size());
+    }
+    auto ptr = bytes.data() + offset;
+    offset += size;
+    return ptr;
+}
+
+void World::WriteSnapshotEntities(SnapshotWriter& writer) const{
+    // the free list is saved in order, so IDs are recycled in the same order after loading
+    auto freeList = available;
+    writer.Write(snapshotMagic);
+    writer.Write(snapshotFormatVersion);
+    writer.Write(uint32_t(numEntities));
+    writer.Write(uint32_t(freeList.size()));
+    writer.Write(versions.data(), numEntities * sizeof(decltype(versions)::value_type));
+    while (!freeList.empty()){
+        writer.Write(freeList.front());
+        freeList.pop();
+    }
+}
+
+void World::ReadSnapshotEntities(SnapshotReader& reader){
+    if (numEntities != 0){
+        Debug::Fatal("A world snapshot can only be loaded into a world with no entities");
+    }
+    if (reader.Read<uint32_t>() != snapshotMagic){
+        Debug::Fatal("Data is not a world snapshot");
+    }
+    if (const auto version = reader.Read<uint32_t>(); version != snapshotFormatVersion){
+        Debug::Fatal("World snapshot has format version {}, expected {}", version, snapshotFormatVersion);
+    }
+    const auto nEntities = reader.Read<uint32_t>();
+    const auto nFree = reader.Read<uint32_t>();
+    numEntities = nEntities;
+    nCreatedThisTick += nEntities;
+    if (nEntities > versions.size()){
+        versions.resize(closest_power_of<entity_id_t>(nEntities, 2));
+    }
+    std::memcpy(versions.data(), reader.Take(nEntities * sizeof(decltype(versions)::value_type)), nEntities * sizeof(decltype(versions)::value_type));
+    for (uint32_t i = 0; i < nFree; i++){
+        available.push(reader.Read<entity_id_t>());
+    }
+}
+
+World::SnapshotSection World::ReadSnapshotSection(SnapshotReader& reader){
+    SnapshotSection section;
+    section.type = reader.Read<uint64_t>();
+    section.stride = reader.Read<uint32_t>();
+    section.count = reader.Read<entity_id_t>();
+    section.owners = reader.Take(size_t(section.count) * sizeof(entity_id_t));
+    section.components = reader.Take(size_t(section.count) * section.stride);
+    for (entity_id_t i = 0; i < section.count; i++){
+        entity_id_t owner;
+        std::memcpy(&owner, section.owners + i * sizeof(entity_id_t), sizeof(owner));
+        if (owner >= numEntities){
+            Debug::Fatal("World snapshot has a component owned by entity {}, but only {} entities", owner, numEntities);
+        }
+    }
+    return section;
+}
+
+void World::FinishSnapshotLoad(){
+#if !RVE_SERVER
+    // per-entity render data is set up once for every live entity
+    Vector<bool> isFree(numEntities, false);
+    auto freeList = available;
+    while (!freeList.empty()){
+        isFree[freeList.front()] = true;
+        freeList.pop();
+    }
+    Vector<entity_t> live;
+    live.reserve(numEntities);
+    for (entity_id_t i = 0; i < numEntities; i++){
+        if (!isFree[i]){
+            live.push_back({i, versions[i]});
+        }
+    }
+    SetupPerEntityRenderData(live);
+#endif
+}
+
+World::UnpackedSnapshot World::UnpackSnapshot(std::span<const std::byte> snapshot){
+    SnapshotReader reader{snapshot};
+    if (reader.Read<uint32_t>() != snapshotMagic){
+        Debug::Fatal("Data is not a world snapshot");
+    }
+    if (const auto version = reader.Read<uint32_t>(); version != snapshotFormatVersion){
+        Debug::Fatal("World snapshot has format version {}, expected {}", version, snapshotFormatVersion);
+    }
+    const auto nEntities = reader.Read<uint32_t>();
+    const auto nFree = reader.Read<uint32_t>();
+    reader.Take(nEntities * sizeof(decltype(versions)::value_type));   // versions only matter when IDs are kept
+
+    // freed IDs are not created, so the live ones are renumbered without gaps
+    Vector<bool> isFree(nEntities, false);
+    for (uint32_t i = 0; i < nFree; i++){
+        const auto id = reader.Read<entity_id_t>();
+        if (id >= nEntities){
+            Debug::Fatal("World snapshot frees entity {}, but only has {} entities", id, nEntities);
+        }
+        isFree[id] = true;
+    }
+    UnpackedSnapshot unpacked;
+    Vector<entity_id_t> numberForID(nEntities);
+    for (entity_id_t i = 0; i < nEntities; i++){
+        if (!isFree[i]){
+            numberForID[i] = unpacked.numEntities++;
+        }
+    }
+
+    Vector<std::pair<entity_id_t, entity_id_t>> order;     // entity number, row
+    while (!reader.AtEnd()){
+        auto& section = unpacked.sections.emplace_back();
+        section.type = reader.Read<uint64_t>();
+        section.stride = reader.Read<uint32_t>();
+        const auto count = reader.Read<entity_id_t>();
+        const auto owners = reader.Take(size_t(count) * sizeof(entity_id_t));
+        const auto components = reader.Take(size_t(count) * section.stride);
+        order.clear();
+        order.reserve(count);
+        for (entity_id_t i = 0; i < count; i++){
+            entity_id_t owner;
+            std::memcpy(&owner, owners + i * sizeof(entity_id_t), sizeof(owner));
+            if (owner >= nEntities || isFree[owner]){
+                Debug::Fatal("World snapshot has a component owned by entity {}, which does not exist", owner);
+            }
+            order.emplace_back(numberForID[owner], i);
+        }
+        std::sort(order.begin(), order.end());
+        section.owners.reserve(count);
+        section.components.resize(size_t(count) * section.stride);
+        for (entity_id_t i = 0; i < count; i++){
+            section.owners.push_back(order[i].first);
+            std::memcpy(section.components.data() + size_t(i) * section.stride, components + size_t(order[i].second) * section.stride, section.stride);
+        }
+    }
+    return unpacked;
+}
+
 World::~World() {
 #if ENABLE_RINGBUFFERS
     // dump out any live rooms
@@ -732,11 +1357,313 @@ RavEngine::World::MDICommandBase::~MDICommandBase()
         gcBuffers.enqueue(indirectBuffer);
         gcBuffers.enqueue(cullingBuffer);
         gcBuffers.enqueue(indirectStagingBuffer);
+        gcBuffers.enqueue(compactedIndirectBuffer);
+        gcBuffers.enqueue(drawCountBuffer);
     }
   
 }
+
+RavEngine::World::MDIICommandSkinned::command::OutputRegion::~OutputRegion()
+{
+    if (allocation.IsValid()) {
+        if (auto app = GetApp()) {
+            app->GetRenderEngine().gcSkinnedOutput.enqueue(allocation.node);
+        }
+    }
+}
 #endif
 
+void World::SetDeferredTransformPropagation(bool deferred){
+    if (deferTransformPropagation && !deferred){
+        // settle pending changes before setters go back to walking the tree
+        PropagateTransformHierarchy();
+    }
+    deferTransformPropagation = deferred;
+    transformHierarchy.needsRebuild = true;
+}
+
+void World::RebuildTransformHierarchy(){
+    auto& h = transformHierarchy;
+    h.nodes.clear();
+    h.parentIndices.clear();
+    h.levelStarts.clear();
+    h.needsRebuild = false;
+
+    auto transforms = GetSetIfExists<Transform>();
+    if (transforms){
+        // depth 0: roots that have children. Unparented leaves never need propagation.
+        for (entity_id_t i = 0; i < transforms->DenseSize(); i++){
+            const auto owner = transforms->GetOwner(i);
+            const auto& t = transforms->GetComponent(owner);
+            if (!t.HasParent() && t.GetChildren().size() > 0){
+                h.nodes.push_back(owner);
+                h.parentIndices.push_back(INVALID_INDEX);
+            }
+        }
+        pos_t levelBegin = 0;
+        while (levelBegin < h.nodes.size()){
+            const pos_t levelEnd = static_cast<pos_t>(h.nodes.size());
+            h.levelStarts.push_back(levelBegin);
+            for (pos_t i = levelBegin; i < levelEnd; i++){
+                for (const auto& child : transforms->GetComponent(h.nodes[i]).GetChildren()){
+                    const auto childID = child.GetOwner().GetID();
+                    // skip handles to transforms that were destroyed without being removed
+                    if (!EntityIsValid(childID.id) || !CorrectVersion(childID) || !transforms->HasComponent(childID.id)){
+                        continue;
+                    }
+                    h.nodes.push_back(childID.id);
+                    h.parentIndices.push_back(i);
+                }
+            }
+            levelBegin = levelEnd;
+        }
+        h.levelStarts.push_back(static_cast<pos_t>(h.nodes.size()));
+    }
+    h.worldMatrices.resize(h.nodes.size());
+    h.moved.resize(h.nodes.size());
+}
+
+void World::PropagateTransformHierarchy(){
+    RVE_PROFILE_FN;
+    auto& h = transformHierarchy;
+    if (h.needsRebuild){
+        RebuildTransformHierarchy();
+    }
+    auto transforms = GetSetIfExists<Transform>();
+    if (!transforms || h.nodes.empty()){
+        return;
+    }
+    // parents are always on a shallower level, so each level only reads results from the one before it
+    for (size_t level = 0; level + 1 < h.levelStarts.size(); level++){
+        const auto levelBegin = h.levelStarts[level];
+        const auto levelEnd = h.levelStarts[level + 1];
+        DispatchParallelChunks(levelEnd - levelBegin, 64, [&h, transforms, levelBegin](pos_t chunkBegin, pos_t chunkEnd){
+            for (pos_t i = levelBegin + chunkBegin; i < levelBegin + chunkEnd; i++){
+                auto& t = transforms->GetComponent(h.nodes[i]);
+                const auto parent = h.parentIndices[i];
+                bool moved = t.isDirty;
+                if (parent != INVALID_INDEX){
+                    moved = moved || h.moved[parent];
+                    if (moved){
+                        t.matrix = h.worldMatrices[parent];
+                        t.MarkAsDirty();
+                    }
+                }
+                h.moved[i] = moved;
+                h.worldMatrices[i] = t.GetWorldMatrix();
+                t.isDirty = false;
+            }
+        });
+    }
+}
+
+void World::UpdateSpatialIndex(){
+    auto boundsSet = GetSetIfExists<SpatialBoundsComponent>();
+    auto transforms = GetSetIfExists<Transform>();
+    if (!boundsSet || !transforms){
+        return;
+    }
+    RVE_PROFILE_FN;
+    for (entity_id_t i = 0; i < boundsSet->DenseSize(); i++){
+        auto& bounds = boundsSet->Get(i);
+        const auto owner = boundsSet->GetOwner(i);
+        assert(transforms->HasComponent(owner) && "SpatialBoundsComponent requires a Transform");
+        auto& transform = transforms->GetComponent(owner);
+        if (!transform.spatialBoundsDirty && !bounds.needsUpdate){
+            continue;
+        }
+        transform.spatialBoundsDirty = false;
+        bounds.needsUpdate = false;
+
+        // a sphere around the world position, grown by the largest axis scale
+        const auto m = transform.GetWorldMatrix();
+        const auto scale = std::max({ glm::length(vector3(m[0])), glm::length(vector3(m[1])), glm::length(vector3(m[2])) });
+        const auto box = AABB::FromSphere(vector3(m[3]), bounds.radius * scale);
+        if (bounds.proxy == SpatialIndex::INVALID_PROXY){
+            bounds.proxy = spatialIndex.Insert({owner, VersionForEntity(owner)}, box);
+        }
+        else{
+            spatialIndex.Update(bounds.proxy, box);
+        }
+    }
+}
+
+void World::LinkSystems(const SystemTasks& first, const SystemTasks& second) {
+    auto root = first.postHook ? first.postHook.value() : first.do_task;
+    auto leaf = second.preHook ? second.preHook.value() : second.do_task;
+    leaf.succeed(root);
+}
+
+Vector<Vector<size_t>> World::SystemSuccessors() const {
+    // a system's successors are the systems whose first task follows its last
+    UnorderedMap<size_t, size_t> taskToSystem;
+    for (size_t i = 0; i < systemRegistrationOrder.size(); i++) {
+        const auto& tasks = typeToSystem.at(systemRegistrationOrder[i]);
+        taskToSystem[tasks.rangeUpdate.hash_value()] = i;
+        taskToSystem[tasks.do_task.hash_value()] = i;
+        if (tasks.preHook) {
+            taskToSystem[tasks.preHook->hash_value()] = i;
+        }
+    }
+    Vector<Vector<size_t>> successors(systemRegistrationOrder.size());
+    for (size_t i = 0; i < systemRegistrationOrder.size(); i++) {
+        const auto& tasks = typeToSystem.at(systemRegistrationOrder[i]);
+        auto last = tasks.postHook ? tasks.postHook.value() : tasks.do_task;
+        last.for_each_successor([&](const tf::Task& successor) {
+            auto it = taskToSystem.find(successor.hash_value());
+            if (it != taskToSystem.end() && it->second != i) {
+                successors[i].push_back(it->second);
+            }
+        });
+    }
+    return successors;
+}
+
+Vector<World::SystemStats> World::GetSystemStats() const {
+    Vector<SystemStats> stats;
+    stats.reserve(systemRegistrationOrder.size());
+    for (const auto type : systemRegistrationOrder) {
+        auto& stat = stats.emplace_back();
+        stat.name = typeToName.at(type);
+        auto it = ecsRangeSizes.find(type);
+        if (it == ecsRangeSizes.end() || it->second.numSamples == 0) {
+            continue;
+        }
+        const auto& range = it->second;
+        std::array<float, SystemRange::statsWindow> sorted;
+        std::copy_n(range.samples.begin(), range.numSamples, sorted.begin());
+        std::sort(sorted.begin(), sorted.begin() + range.numSamples);
+        float sum = 0;
+        for (uint32_t i = 0; i < range.numSamples; i++) {
+            sum += sorted[i];
+        }
+        stat.meanMs = sum / range.numSamples;
+        stat.p99Ms = sorted[std::min(range.numSamples - 1, range.numSamples * 99 / 100)];
+        stat.lastMs = range.samples[(range.nextSample + SystemRange::statsWindow - 1) % SystemRange::statsWindow];
+        stat.entities = range.size;
+        stat.samples = range.numSamples;
+    }
+
+    const auto successors = SystemSuccessors();
+
+    // longest chain by mean time, memoized since the graph is acyclic
+    Vector<float> pathLength(stats.size(), -1);
+    Vector<size_t> next(stats.size(), SIZE_MAX);
+    Function<float(size_t)> longest = [&](size_t i) -> float {
+        if (pathLength[i] < 0) {
+            float best = 0;
+            for (const auto s : successors[i]) {
+                const auto length = longest(s);
+                if (length > best) {
+                    best = length;
+                    next[i] = s;
+                }
+            }
+            pathLength[i] = stats[i].meanMs + best;
+        }
+        return pathLength[i];
+    };
+    size_t start = SIZE_MAX;
+    float startLength = 0;
+    for (size_t i = 0; i < stats.size(); i++) {
+        if (longest(i) > startLength) {
+            startLength = pathLength[i];
+            start = i;
+        }
+    }
+    for (auto i = start; i != SIZE_MAX; i = next[i]) {
+        stats[i].onCriticalPath = true;
+    }
+    return stats;
+}
+
+void World::ExportSystemGraph(std::ostream& out) const {
+    const auto stats = GetSystemStats();
+    const auto successors = SystemSuccessors();
+
+    float criticalMs = 0;
+    for (const auto& stat : stats) {
+        criticalMs += stat.onCriticalPath ? stat.meanMs : 0;
+    }
+    out << "digraph Systems {\n";
+    out << Format("  // critical path {:.3f} ms\n", criticalMs);
+    for (size_t i = 0; i < stats.size(); i++) {
+        const auto& stat = stats[i];
+        out << Format("  s{} [label=\"{}\\nmean {:.3f} ms, p99 {:.3f} ms\\n{} entities\"{}];\n", i, stat.name, stat.meanMs, stat.p99Ms, stat.entities, stat.onCriticalPath ? " color=red" : "");
+    }
+    for (size_t i = 0; i < successors.size(); i++) {
+        for (const auto s : successors[i]) {
+            const bool critical = stats[i].onCriticalPath && stats[s].onCriticalPath;
+            out << Format("  s{} -> s{}{};\n", i, s, critical ? " [color=red]" : "");
+        }
+    }
+    out << "}\n";
+}
+
+void World::AddComponentMemory(Vector<MemoryReport::Item>& sets) {
+    for (const auto& [type, set] : componentMap) {
+        auto it = std::find_if(sets.begin(), sets.end(), [&set](const MemoryReport::Item& item) { return item.name == set.typeName; });
+        if (it == sets.end()) {
+            it = sets.insert(sets.end(), { std::string(set.typeName) });
+        }
+        it->bytes += set.AllocatedBytes();
+        it->count += set.DenseSize();
+    }
+}
+
+void World::ScheduleSystems() {
+    // is `to` downstream of `from` in the ECS graph?
+    auto reaches = [](const tf::Task& from, const tf::Task& to) -> bool {
+        UnorderedSet<size_t> visited;
+        Vector<tf::Task> stack{ from };
+        while (!stack.empty()) {
+            auto task = stack.back();
+            stack.pop_back();
+            if (task == to) {
+                return true;
+            }
+            task.for_each_successor([&](const tf::Task& successor) {
+                if (visited.insert(successor.hash_value()).second) {
+                    stack.push_back(successor);
+                }
+            });
+        }
+        return false;
+    };
+
+    auto conflicts = [](const SystemTasks& A, const SystemTasks& B) -> bool {
+        // hooks and world access can touch anything
+        if (A.preHook || A.postHook || B.preHook || B.postHook || A.usesWorldDataProvider || B.usesWorldDataProvider) {
+            return true;
+        }
+        auto writesAny = [](const SystemTasks& writer, const SystemTasks& other) {
+            for (const auto id : writer.writeDependencies) {
+                if (std::find(other.readDependencies.begin(), other.readDependencies.end(), id) != other.readDependencies.end()
+                    || std::find(other.writeDependencies.begin(), other.writeDependencies.end(), id) != other.writeDependencies.end()) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        return writesAny(A, B) || writesAny(B, A);
+    };
+
+    for (size_t i = 0; i < systemRegistrationOrder.size(); i++) {
+        const auto& first = typeToSystem.at(systemRegistrationOrder[i]);
+        for (size_t j = i + 1; j < systemRegistrationOrder.size(); j++) {
+            const auto& second = typeToSystem.at(systemRegistrationOrder[j]);
+            if (!conflicts(first, second)) {
+                continue;
+            }
+            // skip pairs that are already ordered, either explicitly or transitively
+            if (reaches(first.rangeUpdate, second.do_task) || reaches(second.rangeUpdate, first.do_task)) {
+                continue;
+            }
+            LinkSystems(first, second);
+        }
+    }
+}
+
 void World::CheckSystems() {
 #if 0
     auto findTaskOwner = [this](const tf::Task& task) -> std::optional<ctti_t> {
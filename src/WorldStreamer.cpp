@@ -0,0 +1,174 @@
+#include "WorldStreamer.hpp"
+#include "Entity.hpp"
+#include "App.hpp"
+#include "VirtualFileSystem.hpp"
+#include "Profile.hpp"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+using namespace RavEngine;
+
+float RavEngine::StreamingCellDistance(StreamingCell cell, glm::vec3 position, float cellSize) {
+    const glm::vec2 min{ cell.x * cellSize, cell.z * cellSize };
+    const glm::vec2 pos{ position.x, position.z };
+    const auto nearest = glm::clamp(pos, min, min + cellSize);
+    return glm::distance(pos, nearest);
+}
+
+void RavEngine::StreamingCellsWithin(glm::vec3 position, float radius, float cellSize, Vector<StreamingCell>& cells) {
+    const auto minX = int32_t(std::floor((position.x - radius) / cellSize)), maxX = int32_t(std::floor((position.x + radius) / cellSize));
+    const auto minZ = int32_t(std::floor((position.z - radius) / cellSize)), maxZ = int32_t(std::floor((position.z + radius) / cellSize));
+    for (int32_t z = minZ; z <= maxZ; z++) {
+        for (int32_t x = minX; x <= maxX; x++) {
+            // the corners of the square are farther than the radius
+            if (StreamingCellDistance({ x, z }, position, cellSize) <= radius) {
+                cells.push_back({ x, z });
+            }
+        }
+    }
+}
+
+WorldStreamer::~WorldStreamer() {
+    // loads reference the queue
+    while (loadsInFlight > 0) {
+        std::this_thread::yield();
+    }
+}
+
+bool WorldStreamer::IsResident(StreamingCell cell) const {
+    const auto it = cells.find(KeyFor(cell));
+    return it != cells.end() && it->second.state == CellState::Resident;
+}
+
+void WorldStreamer::Update(World& world, std::span<const glm::vec3> anchors) {
+    RVE_PROFILE_FN;
+    auto distanceToAnchors = [&](StreamingCell cell) {
+        float closest = std::numeric_limits<float>::infinity();
+        for (const auto& anchor : anchors) {
+            closest = std::min(closest, StreamingCellDistance(cell, anchor, config.cellSize));
+        }
+        return closest;
+    };
+
+    // loads that finished start committing, unless their cell was evicted in the meantime
+    LoadedCell loaded;
+    while (loadedCells.try_dequeue(loaded)) {
+        const auto it = cells.find(KeyFor(loaded.cell));
+        if (it == cells.end() || it->second.generation != loaded.generation || it->second.state != CellState::Loading) {
+            continue;
+        }
+        it->second.state = CellState::Committing;
+        it->second.snapshot = std::move(loaded.snapshot);
+        it->second.entities.reserve(it->second.snapshot.numEntities);
+        committing.push_back(loaded.cell);
+    }
+
+    // evict the cells out of range
+    for (auto& [key, cell] : cells) {
+        if (cell.state == CellState::Evicting) {
+            continue;
+        }
+        const StreamingCell coord{ int32_t(uint32_t(key >> 32)), int32_t(uint32_t(key)) };
+        if (distanceToAnchors(coord) <= config.unloadRadius) {
+            continue;
+        }
+        if (cell.state == CellState::Resident && onCellUnloading) {
+            onCellUnloading(coord, cell.entities);
+        }
+        cell.state = CellState::Evicting;
+        cell.snapshot = {};
+        evicting.push_back(coord);
+    }
+    std::erase_if(committing, [this](StreamingCell coord) {
+        return cells.at(KeyFor(coord)).state != CellState::Committing;
+    });
+
+    // destroy before creating, so memory is freed before it is needed again
+    uint32_t budget = config.entitiesPerFrame;
+    while (!evicting.empty()) {
+        const auto coord = evicting.front();
+        auto& cell = cells.at(KeyFor(coord));
+        while (!cell.entities.empty() && budget > 0) {
+            const auto id = cell.entities.back();
+            cell.entities.pop_back();
+            // gameplay may have destroyed it already, and its ID may belong to another entity now
+            if (world.CorrectVersion(id)) {
+                Entity(id, &world).Destroy();
+            }
+            budget--;
+        }
+        if (!cell.entities.empty()) {
+            break;
+        }
+        cells.erase(KeyFor(coord));
+        evicting.erase(evicting.begin());
+    }
+
+    while (!committing.empty() && budget > 0) {
+        const auto coord = committing.front();
+        auto& cell = cells.at(KeyFor(coord));
+        const auto first = entity_id_t(cell.entities.size());
+        const auto count = std::min<entity_id_t>(budget, cell.snapshot.numEntities - first);
+        if (count > 0) {
+            const auto ids = world.CreateEntities(count);
+            cell.entities.insert(cell.entities.end(), ids.begin(), ids.end());
+            if (merge) {
+                merge(world, cell.snapshot, first, ids);
+            }
+            budget -= count;
+        }
+        if (cell.entities.size() < cell.snapshot.numEntities) {
+            break;
+        }
+        cell.state = CellState::Resident;
+        cell.snapshot = {};
+        committing.erase(committing.begin());
+        if (onCellLoaded) {
+            onCellLoaded(coord, cell.entities);
+        }
+    }
+
+    // start loading the closest missing cells
+    if (loadsInFlight >= config.maxLoadsInFlight) {
+        return;
+    }
+    candidates.clear();
+    for (const auto& anchor : anchors) {
+        cellsNearAnchor.clear();
+        StreamingCellsWithin(anchor, config.loadRadius, config.cellSize, cellsNearAnchor);
+        for (const auto coord : cellsNearAnchor) {
+            if (!cells.contains(KeyFor(coord))) {
+                candidates.emplace_back(distanceToAnchors(coord), coord);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (const auto& [distance, coord] : candidates) {
+        if (loadsInFlight >= config.maxLoadsInFlight) {
+            break;
+        }
+        // anchors near each other list the same cells
+        auto [it, inserted] = cells.try_emplace(KeyFor(coord));
+        if (!inserted) {
+            continue;
+        }
+        it->second.generation = nextGeneration++;
+        loadsInFlight++;
+        GetApp()->backgroundExecutor.silent_async([this, coord, generation = it->second.generation, path = cellPath(coord)] {
+            LoadedCell result{ coord, generation };
+            auto& resources = GetApp()->GetResources();
+            if (!path.empty() && resources.Exists(path.c_str())) {
+                const auto bytes = resources.FileContentsAt<Vector<std::byte>>(path.c_str(), false);
+                result.snapshot = World::UnpackSnapshot(bytes);
+            }
+            loadedCells.enqueue(std::move(result));
+            loadsInFlight--;
+        });
+    }
+}
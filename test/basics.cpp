@@ -16,8 +16,49 @@
 #include <RavEngine/RPCSystem.hpp>
 #include <RavEngine/Validator.hpp>
 #include <RavEngine/CheckedComponentHandle.hpp>
+#include <RavEngine/EntityCommandBuffer.hpp>
+#include <RavEngine/PagedSparseArray.hpp>
+#include <RavEngine/GameObject.hpp>
+#include <RavEngine/TransformBatch.hpp>
+#include <RavEngine/SpatialBoundsComponent.hpp>
+#include <RavEngine/TimerWheel.hpp>
+#include <RavEngine/TweenManager.hpp>
+#include <RavEngine/AudioADPCM.hpp>
+#include <RavEngine/AudioGraphAsset.hpp>
+#include <RavEngine/OffsetAllocator.hpp>
+#include <RavEngine/ShadowAtlasAllocator.hpp>
+#include <RavEngine/DirtyBitset.hpp>
+#include <RavEngine/DynamicResolutionController.hpp>
+#include <RavEngine/VRAMBudgetController.hpp>
+#include <RavEngine/TextureStreamer.hpp>
+#include <RavEngine/ReplicationSnapshot.hpp>
+#include <RavEngine/RPCBatch.hpp>
+#include <RavEngine/RPCMsgUnpacker.hpp>
+#include <RavEngine/NetworkIDTable.hpp>
+#include <RavEngine/Quantize.hpp>
+#include <RavEngine/SpawnBatch.hpp>
+#include <RavEngine/AssetPack.hpp>
+#include <RavEngine/Compression.hpp>
+#include <RavEngine/MeshEncoding.hpp>
+#include <RavEngine/ImpostorEncoding.hpp>
+#include <RavEngine/WorldStreamer.hpp>
+#include <RavEngine/EntityPool.hpp>
+#include <RavEngine/KTX2.hpp>
+#include <RavEngine/sorted_vector_map.hpp>
+#include <RavEngine/Queue.hpp>
+#include <RavEngine/StringID.hpp>
+#include <RavEngine/ScriptComponent.hpp>
+#include <RavEngine/FrameArena.hpp>
+#include <RavEngine/Heightfield.hpp>
+#include <RavEngine/PerfCounters.hpp>
 #include <cassert>
+#include <cmath>
+#include <array>
 #include <span>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 using namespace RavEngine;
 using namespace std;
@@ -70,6 +111,12 @@ int Test_CTTI(){
 	assert(t1 == t3);
 	assert(t1 != t2);
 	assert(t2 != t3);
+
+	// dense runtime indices are stable per type and unique across types
+	auto i1 = ComponentTypeRegistry::IndexFor<IntComponent>();
+	auto i2 = ComponentTypeRegistry::IndexFor<FloatComponent>();
+	assert(i1 == ComponentTypeRegistry::IndexFor<IntComponent>());
+	assert(i1 != i2);
 	
 	return 0;
 }
@@ -420,6 +467,2329 @@ int Test_DataProviders() {
     return 0;
 }
 
+int Test_AmortizedSystem() {
+    struct VisitCount {
+        int visits = 0;
+    };
+    struct CountingSystem {
+        void operator()(VisitCount& count) const {
+            count.visits++;
+        }
+    };
+
+    World w;
+    Vector<Entity> entities;
+    for (int i = 0; i < 100; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<VisitCount>();
+        entities.push_back(e);
+    }
+    w.EmplaceSerialAmortizedSystem<CountingSystem>({ .entitiesPerTick = 30 });
+
+    // 10 ticks of 30 visit each of the 100 entities 3 times
+    for (int i = 0; i < 10; i++) {
+        w.Tick(1);
+    }
+    bool uneven = false;
+    w.Filter([&uneven](const VisitCount& count) {
+        uneven |= count.visits != 3;
+    });
+    if (uneven) {
+        cout << "Amortized system did not visit every entity evenly" << std::endl;
+        return 1;
+    }
+
+    // removing entities reorders the rest, but the slices keep cycling through all of them
+    for (int i = 0; i < 100; i += 10) {
+        entities[i].Destroy();
+    }
+    for (int i = 0; i < 9; i++) {
+        w.Tick(1);
+    }
+    bool missed = false;
+    w.Filter([&missed](const VisitCount& count) {
+        missed |= count.visits < 5;
+    });
+    if (missed) {
+        cout << "Amortized system skipped entities after others were removed" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+int Test_SmallFunction() {
+    struct Counted {
+        int* live;
+        Counted(int* live) : live(live) { ++*live; }
+        Counted(Counted&& other) noexcept : live(other.live) { ++*live; }
+        Counted(const Counted& other) : live(other.live) { ++*live; }
+        ~Counted() { --*live; }
+    };
+
+    int live = 0, calls = 0;
+    {
+        SmallFunction<void()> small([counted = Counted(&live), &calls] { calls++; });
+        std::array<char, 128> padding{};
+        SmallFunction<void()> large([counted = Counted(&live), padding, &calls] { calls += padding[0] + 1; });
+        SmallFunction<int(int)> square([](int x) { return x * x; });
+        if (square(7) != 49) {
+            cout << "SmallFunction returned the wrong value" << std::endl;
+            return 1;
+        }
+
+        // moving transfers the callable without running or duplicating it
+        SmallFunction<void()> movedSmall(std::move(small));
+        SmallFunction<void()> movedLarge;
+        movedLarge = std::move(large);
+        if (small || large || !movedSmall || !movedLarge) {
+            cout << "SmallFunction move did not transfer ownership" << std::endl;
+            return 2;
+        }
+        movedSmall();
+        movedLarge();
+        if (calls != 2 || live != 2) {
+            cout << "SmallFunction ran " << calls << " calls with " << live << " live captures" << std::endl;
+            return 3;
+        }
+    }
+    if (live != 0) {
+        cout << "SmallFunction leaked " << live << " captures" << std::endl;
+        return 4;
+    }
+
+    int sum = 0;
+    auto accumulate = [&sum](FunctionRef<void(int)> fn) {
+        for (int i = 1; i <= 4; i++) {
+            fn(i);
+        }
+    };
+    accumulate([&sum](int i) { sum += i; });
+    if (sum != 10) {
+        cout << "FunctionRef did not call through to its callable" << std::endl;
+        return 5;
+    }
+    return 0;
+}
+
+int Test_CachedComponentHandle() {
+    struct Payload {
+        int value = 0;
+        Payload(int value) : value(value) {}
+    };
+
+    World w;
+    Vector<Entity> entities;
+    for (int i = 0; i < 10; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<Payload>(i);
+        entities.push_back(e);
+    }
+    CachedComponentHandle<Payload> handle(entities.back());
+    if (handle->value != 9) {
+        cout << "CachedComponentHandle resolved the wrong component" << std::endl;
+        return 1;
+    }
+
+    // destroying the first entity moves the last component into its row, and growing reallocates the set
+    entities.front().Destroy();
+    for (int i = 0; i < 1000; i++) {
+        w.Instantiate<Entity>().EmplaceComponent<Payload>(-1);
+    }
+    if (handle.get() != &entities.back().GetComponent<Payload>() || handle->value != 9) {
+        cout << "CachedComponentHandle did not follow its component after it moved" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+int Test_SortedVectorMap() {
+    sorted_vector_map<int, std::string> map;
+    for (const int key : { 5, 1, 9, 3, 7 }) {
+        map[key] = std::to_string(key);
+    }
+    map.erase(9);
+    map[4] = "4";
+
+    // iteration is in key order, and every key is still found through the index after the inserts and erases
+    int previous = 0;
+    for (const auto& [key, value] : map) {
+        if (key <= previous || map.find(key)->second != value || value != std::to_string(key)) {
+            cout << "sorted_vector_map is out of order or its index is stale at " << key << std::endl;
+            return 1;
+        }
+        previous = key;
+    }
+    if (map.size() != 5 || map.contains(9) || map.find(9) != map.end() || map.at(4) != "4") {
+        cout << "sorted_vector_map lookup failed" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+int Test_SmallVector() {
+    SmallVector<std::string, 2> vec;
+    vec.push_back("a");
+    vec.push_back("b");
+    if (vec.heap_bytes() != 0) {
+        cout << "small_vector allocated within its inline capacity" << std::endl;
+        return 1;
+    }
+    // pushing an element of itself while spilling to the heap must not read the moved-from original
+    vec.push_back(vec[0]);
+    if (vec.size() != 3 || vec[2] != "a" || vec.heap_bytes() == 0) {
+        cout << "small_vector did not grow onto the heap" << std::endl;
+        return 2;
+    }
+
+    auto copy = vec;
+    auto moved = std::move(vec);
+    moved.erase(moved.begin());
+    if (!vec.empty() || copy.size() != 3 || moved.size() != 2 || moved[0] != "b" || moved[1] != "a") {
+        cout << "small_vector copy, move or erase failed" << std::endl;
+        return 3;
+    }
+
+    SmallUnorderedVector<int, 2> unordered;
+    for (int i = 0; i < 5; i++) {
+        unordered.insert(i);
+    }
+    unordered.erase(2);
+    int sum = 0;
+    for (const auto value : unordered) {
+        sum += value;
+    }
+    if (unordered.size() != 4 || sum != 8) {
+        cout << "small_vector did not work as unordered_vector storage" << std::endl;
+        return 4;
+    }
+    return 0;
+}
+
+int Test_DequeueAllInto() {
+    ConcurrentQueue<int> queue;
+    for (int i = 0; i < 1000; i++) {
+        queue.enqueue(i);
+    }
+    std::vector<int> into{ -1 };
+    const auto count = DequeueAllInto(queue, into);
+    int unused;
+    if (count != 1000 || into.size() != 1001 || into[0] != -1 || queue.try_dequeue(unused)) {
+        cout << "DequeueAllInto did not drain the whole queue onto the end of the vector" << std::endl;
+        return 1;
+    }
+    // a single producer's items come out in order
+    for (int i = 0; i < 1000; i++) {
+        if (into[i + 1] != i) {
+            cout << "DequeueAllInto reordered items" << std::endl;
+            return 2;
+        }
+    }
+    if (DequeueAllInto(queue, into) != 0 || into.size() != 1001) {
+        cout << "DequeueAllInto of an empty queue changed the vector" << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+struct IntFloatCountSystem {
+    int* count;
+    IntFloatCountSystem(int* count) : count(count) {}
+    void operator()(const IntComponent&, const FloatComponent&) {
+        (*count)++;
+    }
+};
+
+int Test_FilterSmallestSet() {
+    World w;
+    for (int i = 0; i < 100; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>(i);
+        if (i % 40 == 0) {
+            e.EmplaceComponent<FloatComponent>(float(i));
+        }
+    }
+    w.Tick(1);
+    const auto since = w.GetCurrentChangeTick();
+
+    // IntComponent is listed first, but the walk is over the three FloatComponents
+    int count = 0;
+    w.Filter([&](IntComponent& ic, const FloatComponent& fc) {
+        if (float(ic.value) == fc.value) {
+            count++;
+        }
+        ic.value = -1;
+    });
+    if (count != 3) {
+        cout << "Filter matched " << count << " entities instead of 3" << std::endl;
+        return 1;
+    }
+
+    int changed = 0, written = 0;
+    w.FilterChanged([&](const IntComponent&) {
+        changed++;
+    }, since);
+    w.Filter([&](const IntComponent& ic) {
+        written += ic.value == -1;
+    });
+    if (changed != 3 || written != 3) {
+        cout << "Filter wrote or stamped components outside of the match" << std::endl;
+        return 2;
+    }
+
+    // the generic paths pick their driving set the same way
+    std::atomic<int> parallelCount = 0;
+    w.ParallelFilter([&](const IntComponent&, const FloatComponent&) {
+        parallelCount++;
+    }, 1);
+    int systemCount = 0;
+    w.EmplaceSerialSystem<IntFloatCountSystem>(&systemCount);
+    w.Tick(1);
+    if (parallelCount != 3 || systemCount != 3) {
+        cout << "ParallelFilter or a system did not visit the 3 matches" << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+struct IncrementOwnIntScript : public ScriptComponent {
+    IncrementOwnIntScript(Entity owner) : ScriptComponent(owner) {}
+    void Tick(float) final {
+        GetOwner().GetComponent<IntComponent>().value++;
+    }
+    std::optional<ScriptAccess> GetAccess() const final {
+        return ScriptAccess::Of<IntComponent>(true);
+    }
+};
+
+// undeclared, so its instances must never tick at the same time
+struct CountTicksScript : public ScriptComponent {
+    int* count;
+    CountTicksScript(Entity owner, int* count) : ScriptComponent(owner), count(count) {}
+    void Tick(float) final {
+        (*count)++;
+    }
+};
+
+int Test_ScriptBatches() {
+    const auto readInt = ScriptAccess::Of<const IntComponent>(), writeInt = ScriptAccess::Of<IntComponent>(), writeFloat = ScriptAccess::Of<FloatComponent, const IntComponent>();
+    if (readInt.ConflictsWith(readInt) || !readInt.ConflictsWith(writeInt) || !writeInt.ConflictsWith(writeFloat) || readInt.ConflictsWith(ScriptAccess::Of<FloatComponent>())) {
+        cout << "ScriptAccess conflicts are wrong" << std::endl;
+        return 1;
+    }
+
+    World w;
+    constexpr int nEntities = 1000, nTicks = 3;
+    int count = 0;
+    for (int i = 0; i < nEntities; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>(i);
+        e.EmplaceComponent<IncrementOwnIntScript>();
+        e.EmplaceComponent<CountTicksScript>(&count);
+    }
+    for (int i = 0; i < nTicks; i++) {
+        w.Tick(1);
+    }
+    int64_t total = 0;
+    w.Filter([&](const IntComponent& ic) {
+        total += ic.value;
+    });
+    if (count != nEntities * nTicks || total != int64_t(nEntities) * (nEntities - 1) / 2 + nEntities * nTicks) {
+        cout << "Scripts ticked " << count << " times and summed to " << total << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+int Test_StringID() {
+    static_assert("left_hand"_sid == StringID("left_hand"), "literals must hash like runtime strings");
+    std::string name = "Hips";
+    const auto id = Intern(name);
+    name = "changed";
+    if (id != "Hips"_sid || id == "hips"_sid || id.ToString() != "Hips") {
+        cout << "Interned StringID does not match its string" << std::endl;
+        return 1;
+    }
+    if (!StringID("never interned").ToString().empty() || Intern("Hips") != id) {
+        cout << "StringID lookup of an uninterned string, or reinterning, failed" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+int Test_ParallelFilter() {
+    World w;
+    constexpr int nEntities = 10'000;
+    for (int i = 0; i < nEntities; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>(1);
+        if (i % 2 == 0) {
+            e.EmplaceComponent<FloatComponent>(2.f);
+        }
+    }
+
+    std::atomic<int> count = 0;
+    w.ParallelFilter([&](IntComponent& ic) {
+        ic.value *= 3;
+        count++;
+    }, 64);
+    if (count != nEntities) {
+        cout << "ParallelFilter visited " << count << " entities, expected " << nEntities << std::endl;
+        return 1;
+    }
+
+    count = 0;
+    w.ParallelFilter([&](const IntComponent& ic, const FloatComponent& fc) {
+        if (ic.value == 3 && fc.value == 2.f) {
+            count++;
+        }
+    }, 64);
+    if (count != nEntities / 2) {
+        cout << "2-component ParallelFilter visited " << count << " entities, expected " << nEntities / 2 << std::endl;
+        return 1;
+    }
+
+    // queries smaller than the chunk size run inline
+    count = 0;
+    w.ParallelFilter([&](const FloatComponent& fc) {
+        count++;
+    }, nEntities * 2);
+    if (count != nEntities / 2) {
+        cout << "Inline ParallelFilter visited " << count << " entities, expected " << nEntities / 2 << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Test_OwningGroup() {
+    World w;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 100; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>(i);
+        if (i % 3 == 0) {
+            e.EmplaceComponent<FloatComponent>(float(i));
+        }
+        entities.push_back(e);
+    }
+
+    // existing entities are adopted when the group is declared
+    w.DeclareGroup<IntComponent, FloatComponent>();
+
+    auto countMatching = [&w]() {
+        int count = 0;
+        bool mismatch = false;
+        w.Filter([&](const IntComponent& ic, const FloatComponent& fc) {
+            count++;
+            mismatch = mismatch || (float(ic.value) != fc.value);
+        });
+        return mismatch ? -1 : count;
+    };
+
+    if (countMatching() != 34) {
+        cout << "Grouped filter did not visit the expected entities after declaring the group" << std::endl;
+        return 1;
+    }
+
+    // entities entering and leaving the group
+    for (int i = 0; i < 100; i++) {
+        auto& e = entities[i];
+        if (i % 3 == 0 && i % 2 == 0) {
+            e.DestroyComponent<FloatComponent>();
+        }
+        else if (i % 3 != 0 && i % 5 == 0) {
+            e.EmplaceComponent<FloatComponent>(float(i));
+        }
+    }
+    int expected = 0;
+    for (int i = 0; i < 100; i++) {
+        if ((i % 3 == 0 && i % 2 != 0) || (i % 3 != 0 && i % 5 == 0)) {
+            expected++;
+        }
+    }
+    if (countMatching() != expected) {
+        cout << "Grouped filter did not track components being added and removed" << std::endl;
+        return 1;
+    }
+
+    entities[5].Destroy();
+    if (countMatching() != expected - 1) {
+        cout << "Grouped filter did not track entity destruction" << std::endl;
+        return 1;
+    }
+
+    // ungrouped single-type queries are unaffected
+    int intCount = 0;
+    w.Filter([&](const IntComponent&) {
+        intCount++;
+    });
+    if (intCount != 99) {
+        cout << "Single-type filter over a grouped type visited " << intCount << " entities" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+struct ChangedSystem {
+    constexpr static bool filterChanged = true;
+    int* count;
+    ChangedSystem(int* count) : count(count) {}
+    void operator()(const IntComponent&) {
+        (*count)++;
+    }
+};
+
+int Test_ChangeTracking() {
+    World w;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 50; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>(i);
+        e.EmplaceComponent<FloatComponent>(0.f);
+        entities.push_back(e);
+    }
+
+    auto countChanged = [&w](change_tick_t since) {
+        int count = 0;
+        w.FilterChanged([&](const IntComponent&, const FloatComponent&) {
+            count++;
+        }, since);
+        return count;
+    };
+
+    // newly created components are changed
+    if (countChanged(w.GetCurrentChangeTick()) != 50) {
+        cout << "Newly created components were not reported as changed" << std::endl;
+        return 1;
+    }
+
+    w.Tick(1);
+    const auto since = w.GetCurrentChangeTick();
+    if (countChanged(since) != 0) {
+        cout << "Components were reported as changed without being written" << std::endl;
+        return 1;
+    }
+
+    // const access does not stamp, mutable access does
+    w.Filter([](const IntComponent&) {});
+    w.Filter([](FloatComponent& fc) {
+        if (fc.value == 0.f) {
+            fc.value = 1;
+        }
+    });
+    if (countChanged(since) != 50) {
+        cout << "Mutable filter access was not reported as a change" << std::endl;
+        return 1;
+    }
+
+    w.Tick(1);
+    const auto since2 = w.GetCurrentChangeTick();
+    entities[3].MarkComponentChanged<IntComponent>();
+    entities[7].GetComponent<IntComponent>().value = 5;  // untracked
+    if (countChanged(since2) != 1) {
+        cout << "MarkComponentChanged was not reported as a change" << std::endl;
+        return 1;
+    }
+
+    // change-filtered systems only see rows written since their previous run
+    int systemCount = 0;
+    w.EmplaceSerialSystem<ChangedSystem>(&systemCount);
+    w.Tick(1);
+    if (systemCount != 50) {
+        cout << "Change-filtered system did not visit every row on its first run" << std::endl;
+        return 1;
+    }
+    systemCount = 0;
+    w.Tick(1);
+    w.Tick(1);
+    if (systemCount != 0) {
+        cout << "Change-filtered system visited " << systemCount << " unchanged rows" << std::endl;
+        return 1;
+    }
+    entities[10].MarkComponentChanged<IntComponent>();
+    w.Tick(1);
+    if (systemCount != 1) {
+        cout << "Change-filtered system did not visit the changed row" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+struct CommandBufferSystem {
+    World* world;
+    CommandBufferSystem(World* w) : world(w) {}
+    void operator()(const IntComponent& ic) {
+        if (ic.value % 2 == 0) {
+            world->GetCommandBuffer().Instantiate<MyPrototype>();
+        }
+    }
+};
+
+int Test_CommandBuffer() {
+    World w;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 20; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>(i);
+        entities.push_back(e);
+    }
+
+    // recording does not change the world until playback
+    auto& buffer = w.GetCommandBuffer();
+    for (int i = 0; i < 10; i++) {
+        buffer.EmplaceComponent<FloatComponent>(entities[i], float(i));
+    }
+    buffer.DestroyComponent<IntComponent>(entities[0]);
+    buffer.Destroy(entities[19]);
+    int floatCount = 0;
+    w.Filter([&](const FloatComponent&) {
+        floatCount++;
+    });
+    if (floatCount != 0) {
+        cout << "Command buffer was applied before playback" << std::endl;
+        return 1;
+    }
+
+    w.FlushCommandBuffers();
+    floatCount = 0;
+    w.Filter([&](const FloatComponent&) {
+        floatCount++;
+    });
+    int intCount = 0;
+    w.Filter([&](const IntComponent&) {
+        intCount++;
+    });
+    if (floatCount != 10 || intCount != 18) {
+        cout << "Command buffer playback produced " << floatCount << " floats and " << intCount << " ints" << std::endl;
+        return 1;
+    }
+
+    // stale handles are skipped
+    buffer.EmplaceComponent<FloatComponent>(entities[19], 1.f);
+    w.FlushCommandBuffers();
+
+    // commands recorded from a parallel system are applied at the end of the tick
+    w.EmplaceSystem<CommandBufferSystem>(&w);
+    w.Tick(1);
+    intCount = 0;
+    w.Filter([&](const IntComponent&) {
+        intCount++;
+    });
+    if (intCount != 18 + 9) {
+        cout << "Instantiations recorded by a parallel system were not played back, got " << intCount << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_BulkCreate() {
+    World w;
+    // make some recycled IDs available
+    for (int i = 0; i < 5; i++) {
+        w.Instantiate<Entity>().Destroy();
+    }
+    auto ids = w.CreateEntities(100);
+    if (ids.size() != 100) {
+        cout << "CreateEntities made " << ids.size() << " entities" << std::endl;
+        return 1;
+    }
+    UnorderedSet<entity_id_t> unique;
+    for (const auto id : ids) {
+        unique.insert(id.id);
+    }
+    if (unique.size() != ids.size()) {
+        cout << "CreateEntities handed out a duplicate ID" << std::endl;
+        return 1;
+    }
+
+    w.EmplaceComponents<IntComponent>(ids, 7);
+    int count = 0;
+    bool allSeven = true;
+    w.Filter([&](const IntComponent& c) {
+        count++;
+        allSeven = allSeven && c.value == 7;
+    });
+    if (count != 100 || !allSeven) {
+        cout << "EmplaceComponents produced " << count << " components" << std::endl;
+        return 1;
+    }
+
+    auto entities = w.InstantiateMany<Entity>(10);
+    for (auto& e : entities) {
+        if (unique.contains(e.GetID().id)) {
+            cout << "InstantiateMany reused a live ID" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int Test_PagedSparseArray() {
+    PagedSparseArray<entity_id_t, 64> arr;
+    if (arr.Contains(5) || arr[100000] != INVALID_ENTITY) {
+        cout << "Empty paged array reported a value" << std::endl;
+        return 1;
+    }
+    arr.Set(3, 10);
+    arr.Set(100000, 20);
+    if (arr[3] != 10 || arr[100000] != 20 || arr.AllocatedPageCount() != 2) {
+        cout << "Paged array lookup failed, " << arr.AllocatedPageCount() << " pages allocated" << std::endl;
+        return 1;
+    }
+    arr.Set(100000, INVALID_ENTITY);
+    if (arr.Contains(100000) || arr.AllocatedPageCount() != 1) {
+        cout << "Clearing the last entry of a page did not free it" << std::endl;
+        return 1;
+    }
+
+    // a world with sparse IDs still resolves components through the pages
+    World w;
+    Vector<Entity> entities;
+    for (int i = 0; i < 3000; i++) {
+        entities.push_back(w.Instantiate<Entity>());
+    }
+    entities[2999].EmplaceComponent<IntComponent>(4);
+    entities[1].EmplaceComponent<IntComponent>(5);
+    entities[2999].DestroyComponent<IntComponent>();
+    if (entities[2999].HasComponent<IntComponent>() || entities[1].GetComponent<IntComponent>().value != 5) {
+        cout << "Component lookup through paged storage failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+struct IncrementIntSystem {
+    void operator()(IntComponent& ic) {
+        ic.value++;
+    }
+};
+
+struct CopyIntToFloatSystem {
+    void operator()(const IntComponent& ic, FloatComponent& fc) {
+        fc.value = float(ic.value);
+    }
+};
+
+int Test_AutoSchedule() {
+    World w;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 100; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>(i);
+        e.EmplaceComponent<FloatComponent>(0.f);
+        entities.push_back(e);
+    }
+    // these conflict on IntComponent, so without a CreateDependency they would fail validation
+    w.SetAutomaticSystemScheduling(true);
+    w.EmplaceSystem<IncrementIntSystem>();
+    w.EmplaceSystem<CopyIntToFloatSystem>();
+    w.Tick(1);
+
+    // the system registered first must have run first
+    for (int i = 0; i < entities.size(); i++) {
+        if (entities[i].GetComponent<FloatComponent>().value != float(i + 1)) {
+            cout << "Conflicting systems were not ordered by registration" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int Test_DeferredTransforms() {
+    // build the same chain in two worlds, one immediate and one deferred
+    auto buildChain = [](World& w, Vector<GameObject>& chain) {
+        for (int i = 0; i < 6; i++) {
+            auto e = w.Instantiate<GameObject>();
+            e.GetTransform().SetLocalPosition(vector3(1, 0, 0)).SetLocalRotation(quaternion(vector3(0, 0.3f, 0)));
+            if (!chain.empty()) {
+                chain.back().GetTransform().AddChild(ComponentHandle<Transform>(e));
+            }
+            chain.push_back(e);
+        }
+    };
+    World immediate, deferred;
+    deferred.SetDeferredTransformPropagation(true);
+    Vector<GameObject> a, b;
+    buildChain(immediate, a);
+    buildChain(deferred, b);
+    deferred.PropagateTransformHierarchy();
+
+    a.front().GetTransform().SetLocalPosition(vector3(5, 2, 0));
+    b.front().GetTransform().SetLocalPosition(vector3(5, 2, 0));
+
+    deferred.PropagateTransformHierarchy();
+    for (int i = 0; i < a.size(); i++) {
+        auto expected = a[i].GetTransform().GetWorldPosition();
+        auto actual = b[i].GetTransform().GetWorldPosition();
+        if (glm::distance(expected, actual) > 0.001f) {
+            cout << "Deferred propagation disagrees with immediate at depth " << i << std::endl;
+            return 1;
+        }
+    }
+
+    // propagation also runs as part of the tick
+    b[2].GetTransform().SetLocalScale(2);
+    a[2].GetTransform().SetLocalScale(2);
+    deferred.Tick(1);
+    if (glm::distance(a.back().GetTransform().GetWorldPosition(), b.back().GetTransform().GetWorldPosition()) > 0.001f) {
+        cout << "Tick did not propagate deferred transform changes" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_TransformBatch() {
+    World w;
+    Vector<GameObject> objects;
+    for (int i = 0; i < 10; i++) {
+        auto e = w.Instantiate<GameObject>();
+        e.GetTransform().SetLocalPosition(vector3(i, -i, 2 * i)).SetLocalRotation(quaternion(vector3(0.1f * i, 0.2f, -0.3f * i))).SetLocalScale(vector3(1 + i, 0.5f, 2));
+        if (i > 0) {
+            objects.back().GetTransform().AddChild(ComponentHandle<Transform>(e));
+        }
+        objects.push_back(e);
+    }
+    Vector<const Transform*> transforms;
+    Vector<uint32_t> indices;
+    for (int i = 0; i < objects.size(); i++) {
+        transforms.push_back(&objects[i].GetTransform());
+        indices.push_back(objects.size() - 1 - i);     // scatter in reverse
+    }
+    Vector<matrix4> out(objects.size());
+    TransformBatch::WriteWorldMatrices(transforms, indices, out.data());
+    for (int i = 0; i < objects.size(); i++) {
+        const auto expected = transforms[i]->GetWorldMatrix();
+        const auto& actual = out[indices[i]];
+        for (int c = 0; c < 4; c++) {
+            // scales compound down the chain, so compare relative to the column's magnitude
+            if (glm::distance(expected[c], actual[c]) > 1e-4f * std::max(1.0f, glm::length(expected[c]))) {
+                cout << "Batched world matrix " << i << " differs from GetWorldMatrix" << std::endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int Test_SpatialIndex() {
+    World w;
+    Vector<GameObject> objects;
+    for (int i = 0; i < 200; i++) {
+        auto e = w.Instantiate<GameObject>();
+        e.GetTransform().SetLocalPosition(vector3(i % 20, 0, i / 20) * 3.0f);
+        e.EmplaceComponent<SpatialBoundsComponent>(0.5f);
+        objects.push_back(e);
+    }
+    w.Tick(1);
+    auto& index = w.GetSpatialIndex();
+    if (index.GetProxyCount() != objects.size()) {
+        cout << "Spatial index has " << index.GetProxyCount() << " proxies, expected " << objects.size() << std::endl;
+        return 1;
+    }
+
+    // compare a sphere query against brute force, before and after moving half the objects
+    auto check = [&](const vector3& center, float radius) {
+        UnorderedSet<entity_id_t> found;
+        index.QuerySphere(center, radius, [&](entity_t e) {
+            found.insert(e.id);
+            return true;
+        });
+        for (auto& obj : objects) {
+            const bool inside = glm::distance(obj.GetTransform().GetWorldPosition(), center) <= radius + 0.5f;
+            if (inside != found.contains(obj.GetID().id)) {
+                cout << "Sphere query disagrees with brute force for entity " << obj.GetID().id << std::endl;
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!check(vector3(10, 0, 10), 7)) {
+        return 1;
+    }
+    for (int i = 0; i < objects.size(); i += 2) {
+        objects[i].GetTransform().LocalTranslateDelta(vector3(0, 0, 25));
+    }
+    w.Tick(1);
+    if (!check(vector3(10, 0, 10), 7) || !check(vector3(10, 0, 35), 9)) {
+        return 1;
+    }
+
+    // a ray along the first row hits every object in it
+    int nHits = 0;
+    index.RayCast(vector3(-5, 0, 0), vector3(1, 0, 0), 100, [&](entity_t, float) {
+        nHits++;
+        return true;
+    });
+    if (nHits != 10) {
+        cout << "Ray hit " << nHits << " objects, expected 10" << std::endl;
+        return 1;
+    }
+
+    objects.back().Destroy();
+    if (index.GetProxyCount() != objects.size() - 1) {
+        cout << "Destroying an entity did not remove its proxy" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+struct PolyTestBase : public AutoCTTI {
+    virtual int Get() const = 0;
+    virtual ~PolyTestBase() {}
+};
+struct PolyTestA : public PolyTestBase, public Queryable<PolyTestA, PolyTestBase> {
+    int Get() const override { return 1; }
+};
+struct PolyTestB : public PolyTestBase, public Queryable<PolyTestB, PolyTestBase> {
+    int value = 2;
+    int Get() const override { return value; }
+};
+
+int Test_PolymorphicQuery() {
+    World w;
+    Vector<Entity> entities;
+    auto sum = [&w] {
+        int total = 0;
+        w.FilterPolymorphic([&](const PolyTestBase& item) {
+            total += item.Get();
+        });
+        return total;
+    };
+    for (int i = 0; i < 100; i++) {
+        auto e = w.Instantiate<Entity>();
+        e.EmplaceComponent<PolyTestA>();
+        if (i % 2 == 0) {
+            e.EmplaceComponent<PolyTestB>();
+        }
+        entities.push_back(e);
+    }
+    if (sum() != 100 + 50 * 2) {
+        cout << "Polymorphic query visited the wrong components" << std::endl;
+        return 1;
+    }
+
+    // removing components moves others in dense storage, and adding many reallocates it
+    for (int i = 0; i < 20; i += 2) {
+        entities[i].DestroyComponent<PolyTestB>();
+    }
+    for (int i = 0; i < 1000; i++) {
+        w.Instantiate<Entity>().EmplaceComponent<PolyTestB>().value = 0;
+    }
+    entities[1].EmplaceComponent<PolyTestB>().value = 7;
+    if (sum() != 100 + 40 * 2 + 7) {
+        cout << "Polymorphic query read stale storage after the component sets changed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_TimerWheel() {
+    TimerWheel wheel;
+    double now = 0;
+    int nRan = 0, nWrong = 0;
+    // delays up to 100 seconds cascade down from the upper levels of the wheel
+    constexpr int nTimers = 10000;
+    for (int i = 0; i < nTimers; i++) {
+        const double due = (i * 7919 % 100000) / 1000.0;
+        wheel.Schedule(due, [&, due] {
+            nRan++;
+            if (now < due || now > due + 0.02) {
+                nWrong++;
+            }
+        });
+    }
+    // already due
+    wheel.Schedule(-1, [&] { nRan++; });
+
+    Vector<TimerWheel::callback_t> due;
+    while (now < 101) {
+        now += 0.016;
+        wheel.Advance(now, due);
+        for (const auto& fn : due) {
+            fn();
+        }
+        due.clear();
+    }
+    if (nRan != nTimers + 1 || nWrong != 0 || wheel.size() != 0) {
+        cout << "Timer wheel ran " << nRan << " callbacks, " << nWrong << " at the wrong time, " << wheel.size() << " left" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_TweenManager() {
+    TweenManager tweens;
+    constexpr int nTweens = 3000;
+    Vector<float> values(nTweens, -1);
+    int nCompleted = 0;
+    for (int i = 0; i < nTweens; i++) {
+        const auto curve = i % 2 == 0 ? TweenManager::Easing::Linear : TweenManager::Easing::CubicInOut;
+        tweens.Add(&values[i], 0, float(i), 1 + i % 10, curve, [&nCompleted] { nCompleted++; });
+    }
+    // cancelled halfway, so it keeps its value and never completes
+    float cancelled = -1;
+    auto handle = tweens.Add(&cancelled, 0, 10, 10);
+
+    Vector<TweenManager::callback_t> completed;
+    for (int step = 0; step < 5; step++) {
+        tweens.Step(1, completed);
+    }
+    if (!tweens.Cancel(handle) || tweens.IsActive(handle) || cancelled != 5 || values[0] != 0 || values[4] != 4) {
+        cout << "Tween cancellation or early completion is wrong" << std::endl;
+        return 1;
+    }
+    for (int step = 0; step < 10; step++) {
+        tweens.Step(1, completed);
+    }
+    for (const auto& fn : completed) {
+        fn();
+    }
+    for (int i = 0; i < nTweens; i++) {
+        if (values[i] != float(i)) {
+            cout << "Tween " << i << " ended at " << values[i] << std::endl;
+            return 1;
+        }
+    }
+    if (nCompleted != nTweens || tweens.size() != 0 || cancelled != 5) {
+        cout << "Tweens completed " << nCompleted << " times, " << tweens.size() << " left" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_ADPCM() {
+    // a length that leaves the last block partly filled
+    constexpr uint32_t nSamples = ADPCMChannel::samplesPerBlock * 10 + 37;
+    Vector<float> samples(nSamples);
+    for (uint32_t i = 0; i < nSamples; i++) {
+        samples[i] = 0.8f * std::sin(i * 0.05f) + 0.1f * std::sin(i * 0.7f);
+    }
+    ADPCMChannel channel(samples);
+    if (channel.GetNumSamples() != nSamples || channel.GetNumBlocks() != 11 || channel.GetSizeBytes() * 4 > nSamples * sizeof(float)) {
+        cout << "ADPCM channel has " << channel.GetNumBlocks() << " blocks in " << channel.GetSizeBytes() << " bytes" << std::endl;
+        return 1;
+    }
+
+    // decode out of order, each block stands alone
+    std::array<float, ADPCMChannel::samplesPerBlock> decoded;
+    for (int32_t block = channel.GetNumBlocks() - 1; block >= 0; block--) {
+        channel.DecodeBlock(block, decoded);
+        for (uint32_t i = 0; i < decoded.size() && block * ADPCMChannel::samplesPerBlock + i < nSamples; i++) {
+            const auto pos = block * ADPCMChannel::samplesPerBlock + i;
+            const auto expected = samples[pos];
+            if (std::abs(decoded[i] - expected) > 0.02f) {
+                cout << "ADPCM sample " << pos << " decoded as " << decoded[i] << ", expected " << expected << std::endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int Test_AudioGraphFusion() {
+    struct OffsetLayer : public AudioFilterLayer {
+        void process(const PlanarSampleBufferInlineView& in, PlanarSampleBufferInlineView& out) final {
+            for (uint8_t c = 0; c < in.GetNChannels(); c++) {
+                for (size_t i = 0; i < in.sizeOneChannel(); i++) {
+                    out[c][i] = in[c][i] + 1;
+                }
+            }
+        }
+    };
+    constexpr size_t nframes = 37;
+    std::array<float, nframes * 2> samples, scratch;
+    PlanarSampleBufferInlineView samplesView{ samples.data(), samples.size(), nframes }, scratchView{ scratch.data(), scratch.size(), nframes };
+
+    // the gains on either side of the offset fold into one pass each, and the result lands in the input's memory
+    AudioGraphAsset graph(2);
+    graph.filters.push_back(std::make_shared<AudioGainFilterLayer>(2));
+    graph.filters.push_back(std::make_shared<AudioGainFilterLayer>(3));
+    graph.filters.push_back(std::make_shared<OffsetLayer>());
+    graph.filters.push_back(std::make_shared<AudioGainFilterLayer>(0.5));
+    graph.filters.push_back(std::make_shared<AudioGainFilterLayer>(4));
+    samples.fill(1);
+    graph.Render(samplesView, scratchView, 2);
+    if (samplesView.data() != samples.data() || std::ranges::any_of(samples, [](float s) { return s != 14; })) {
+        cout << "Graph rendered " << samples[0] << ", expected 14" << std::endl;
+        return 1;
+    }
+
+    // a caller that applied the leading gain itself gets the same result
+    if (graph.GetLeadingGain() != 6) {
+        cout << "Leading gain is " << graph.GetLeadingGain() << ", expected 6" << std::endl;
+        return 1;
+    }
+    samples.fill(6);
+    graph.Render(samplesView, scratchView, 2, true);
+    if (std::ranges::any_of(samples, [](float s) { return s != 14; })) {
+        cout << "Graph without its leading gain rendered " << samples[0] << ", expected 14" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_PerfCounters() {
+    auto counter = PerfCounters::GetCounter("Test: Counter");
+    auto gauge = PerfCounters::GetGauge("Test: Gauge");
+    auto histogram = PerfCounters::GetHistogram("Test: Histogram");
+    if (PerfCounters::GetCounter("Test: Counter") != counter) {
+        cout << "Getting a counter twice made two counters" << std::endl;
+        return 1;
+    }
+
+    // updated from several threads at once
+    constexpr uint32_t nThreads = 4, perThread = 10000;
+    {
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < nThreads; t++) {
+            threads.emplace_back([&] {
+                for (uint32_t i = 0; i < perThread; i++) {
+                    counter->Add();
+                    histogram->Record(i < perThread / 100 ? 100 : 1);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    gauge->Set(42);
+
+    PerfSnapshot snapshot;
+    PerfCounters::TakeSnapshot(snapshot);
+    auto frameCounter = snapshot.FindCounter("Test: Counter");
+    auto frameGauge = snapshot.FindGauge("Test: Gauge");
+    auto frameHistogram = snapshot.FindHistogram("Test: Histogram");
+    if (!frameCounter || !frameGauge || !frameHistogram) {
+        cout << "Snapshot is missing an entry" << std::endl;
+        return 1;
+    }
+    if (frameCounter->frame != nThreads * perThread || frameCounter->total != nThreads * perThread) {
+        cout << "Counter is " << frameCounter->frame << ", expected " << nThreads * perThread << std::endl;
+        return 1;
+    }
+    if (frameGauge->value != 42) {
+        cout << "Gauge is " << frameGauge->value << ", expected 42" << std::endl;
+        return 1;
+    }
+    // 1% of the values are 100, the rest are 1, which is the top of its bucket
+    if (frameHistogram->count != nThreads * perThread || frameHistogram->min != 1 || frameHistogram->max != 100) {
+        cout << "Histogram has " << frameHistogram->count << " values in [" << frameHistogram->min << ", " << frameHistogram->max << "]" << std::endl;
+        return 1;
+    }
+    if (frameHistogram->Percentile(0.5) != 2 || frameHistogram->Percentile(0.98) != 2 || frameHistogram->Percentile(1) != 100) {
+        cout << "Histogram percentiles are " << frameHistogram->Percentile(0.5) << ", " << frameHistogram->Percentile(0.98) << ", " << frameHistogram->Percentile(1) << std::endl;
+        return 1;
+    }
+
+    // the next frame starts over, except for counter totals and gauges
+    counter->Add(5);
+    PerfCounters::TakeSnapshot(snapshot);
+    frameCounter = snapshot.FindCounter("Test: Counter");
+    frameHistogram = snapshot.FindHistogram("Test: Histogram");
+    if (frameCounter->frame != 5 || frameCounter->total != nThreads * perThread + 5) {
+        cout << "Counter is " << frameCounter->frame << " this frame and " << frameCounter->total << " in total" << std::endl;
+        return 1;
+    }
+    if (frameHistogram->count != 0 || snapshot.FindGauge("Test: Gauge")->value != 42) {
+        cout << "Histogram was not restarted, or gauge was" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_WorldSnapshot() {
+    World source;
+    auto entities = source.InstantiateMany<Entity>(64);
+    for (int i = 0; i < 8; i++) {
+        entities[i * 3].Destroy();
+    }
+    for (int i = 0; i < 64; i++) {
+        if (i % 3 != 0 || i >= 24) {
+            entities[i].EmplaceComponent<IntComponent>().value = i;
+            if (i % 2 == 0) {
+                entities[i].EmplaceComponent<FloatComponent>().value = i * 0.5f;
+            }
+        }
+    }
+    const auto snapshot = source.SaveSnapshot<IntComponent, FloatComponent>();
+
+    World loaded;
+    loaded.LoadSnapshot<IntComponent, FloatComponent>(snapshot);
+    int nInts = 0, nFloats = 0;
+    bool correct = true;
+    loaded.Filter([&](const IntComponent& c) {
+        nInts++;
+    });
+    loaded.Filter([&](const IntComponent& c, const FloatComponent& f) {
+        nFloats++;
+    });
+    for (int i = 0; i < 64; i++) {
+        const Entity e(entities[i].GetID(), &loaded);
+        const bool alive = i % 3 != 0 || i >= 24;
+        if (alive && (!loaded.CorrectVersion(e.GetID()) || e.GetComponent<IntComponent>().value != i)) {
+            correct = false;
+        }
+        if (alive && i % 2 == 0 && e.GetComponent<FloatComponent>().value != i * 0.5f) {
+            correct = false;
+        }
+    }
+    if (!correct || nInts != 56 || nFloats != 28) {
+        cout << "Snapshot restored " << nInts << " ints and " << nFloats << " floats, correct = " << correct << std::endl;
+        return 1;
+    }
+
+    // freed IDs are recycled in the same order
+    auto next = loaded.Instantiate<Entity>();
+    auto expected = source.Instantiate<Entity>();
+    if (!(next.GetID() == expected.GetID())) {
+        cout << "Snapshot recycled entity " << next.GetID().id << " instead of " << expected.GetID().id << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_ParallelWorldTicks() {
+    // worlds ticked from inside executor tasks run their graphs on the calling worker instead of blocking it
+    constexpr int nWorlds = 4, nTicks = 10, nEntities = 1000;
+    Vector<std::unique_ptr<World>> worlds;
+    for (int i = 0; i < nWorlds; i++) {
+        auto& w = worlds.emplace_back(std::make_unique<World>());
+        auto entities = w->InstantiateMany<Entity>(nEntities);
+        for (int j = 0; j < nEntities; j++) {
+            entities[j].EmplaceComponent<IntComponent>(j);
+        }
+        w->EmplaceSystem<IncrementIntSystem>();
+    }
+    tf::Taskflow worldTicks;
+    for (auto& w : worlds) {
+        worldTicks.emplace([world = w.get()] {
+            for (int i = 0; i < nTicks; i++) {
+                world->Tick(1);
+            }
+        });
+    }
+    GetApp()->executor.run(worldTicks).wait();
+
+    for (auto& w : worlds) {
+        int64_t total = 0;
+        w->Filter([&](const IntComponent& c) {
+            total += c.value;
+        });
+        if (total != int64_t(nEntities) * (nEntities - 1) / 2 + int64_t(nEntities) * nTicks) {
+            cout << "A world ticked in parallel has total " << total << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int Test_OffsetAllocator() {
+    constexpr uint32_t capacity = 1 << 20;
+    OffsetAllocator allocator(capacity);
+    struct Live {
+        OffsetAllocator::Allocation allocation;
+        uint32_t size;
+    };
+    Vector<Live> live;
+    Vector<uint8_t> owned(capacity, 0);
+    uint32_t seed = 1;
+    auto rand = [&seed] {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    };
+    uint32_t used = 0;
+    // churn of mixed sizes, checking that no two live allocations overlap
+    for (int i = 0; i < 20000; i++) {
+        if (live.empty() || rand() % 3 != 0) {
+            const auto size = 1 + rand() % (rand() % 4 == 0 ? 4096 : 64);
+            auto allocation = allocator.Allocate(size);
+            if (!allocation.IsValid()) {
+                continue;
+            }
+            if (allocation.offset + size > capacity) {
+                cout << "Allocation at " << allocation.offset << " overruns the capacity" << std::endl;
+                return 1;
+            }
+            for (uint32_t j = 0; j < size; j++) {
+                if (owned[allocation.offset + j]++ != 0) {
+                    cout << "Allocation at " << allocation.offset << " overlaps another" << std::endl;
+                    return 1;
+                }
+            }
+            live.push_back({ allocation, size });
+            used += size;
+        }
+        else {
+            const auto idx = rand() % live.size();
+            const auto victim = live[idx];
+            std::memset(owned.data() + victim.allocation.offset, 0, victim.size);
+            allocator.Free(victim.allocation.node);
+            used -= victim.size;
+            live[idx] = live.back();
+            live.pop_back();
+        }
+        if (allocator.GetFreeStorage() != capacity - used) {
+            cout << "Allocator reports " << allocator.GetFreeStorage() << " free, expected " << capacity - used << std::endl;
+            return 1;
+        }
+    }
+
+    // growing keeps allocations in place, and freeing everything merges back into one region
+    allocator.Grow(capacity * 2);
+    if (allocator.GetLargestFreeRegion() < capacity) {
+        cout << "Grown allocator's largest free region is only " << allocator.GetLargestFreeRegion() << std::endl;
+        return 1;
+    }
+    for (const auto& l : live) {
+        allocator.Free(l.allocation.node);
+    }
+    if (allocator.GetFreeStorage() != capacity * 2 || allocator.GetLargestFreeRegion() != capacity * 2) {
+        cout << "Freed allocator did not coalesce: " << allocator.GetLargestFreeRegion() << " of " << allocator.GetFreeStorage() << std::endl;
+        return 1;
+    }
+    if (!allocator.Allocate(capacity * 2).IsValid() || allocator.Allocate(1).IsValid()) {
+        cout << "Allocator could not hand out its whole capacity exactly once" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_ShadowAtlasAllocator() {
+    constexpr uint16_t atlasSize = 1024, minTileSize = 32;
+    ShadowAtlasAllocator allocator(atlasSize, minTileSize);
+    Vector<ShadowAtlasAllocator::Tile> live;
+    Vector<uint8_t> owned(atlasSize * atlasSize, 0);
+    uint32_t seed = 1;
+    auto rand = [&seed] {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    };
+    uint32_t used = 0;
+    // churn of mixed tile sizes, checking that tiles are aligned and that no two live tiles overlap
+    for (int i = 0; i < 20000; i++) {
+        if (live.empty() || rand() % 3 != 0) {
+            const uint16_t size = minTileSize << (rand() % 5);
+            auto tile = allocator.Allocate(size);
+            if (!tile.IsValid()) {
+                continue;
+            }
+            if (tile.size != size || tile.x % size != 0 || tile.y % size != 0 || tile.x + size > atlasSize || tile.y + size > atlasSize) {
+                cout << "Tile at " << tile.x << "," << tile.y << " of size " << tile.size << " is misplaced" << std::endl;
+                return 1;
+            }
+            for (uint32_t y = 0; y < size; y++) {
+                for (uint32_t x = 0; x < size; x++) {
+                    if (owned[(tile.y + y) * atlasSize + tile.x + x]++ != 0) {
+                        cout << "Tile at " << tile.x << "," << tile.y << " overlaps another" << std::endl;
+                        return 1;
+                    }
+                }
+            }
+            live.push_back(tile);
+            used += uint32_t(size) * size;
+        }
+        else {
+            const auto idx = rand() % live.size();
+            const auto victim = live[idx];
+            for (uint32_t y = 0; y < victim.size; y++) {
+                std::memset(owned.data() + (victim.y + y) * atlasSize + victim.x, 0, victim.size);
+            }
+            allocator.Free(victim);
+            used -= uint32_t(victim.size) * victim.size;
+            live[idx] = live.back();
+            live.pop_back();
+        }
+        if (allocator.GetFreeTexels() != uint32_t(atlasSize) * atlasSize - used) {
+            cout << "Allocator reports " << allocator.GetFreeTexels() << " free texels, expected " << uint32_t(atlasSize) * atlasSize - used << std::endl;
+            return 1;
+        }
+    }
+
+    // freeing everything merges back into the whole atlas, and sizes round up to a power of two
+    for (const auto& tile : live) {
+        allocator.Free(tile);
+    }
+    auto whole = allocator.Allocate(atlasSize);
+    if (!whole.IsValid() || allocator.Allocate(minTileSize).IsValid()) {
+        cout << "Freed allocator did not merge its tiles" << std::endl;
+        return 1;
+    }
+    allocator.Free(whole);
+    if (allocator.Allocate(100).size != 128 || allocator.Allocate(1).size != minTileSize) {
+        cout << "Allocator did not round tile sizes" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_DirtyBitset() {
+    constexpr uint32_t n = 100000;
+    DirtyBitset dirty;
+    dirty.Resize(n, false);
+    Vector<bool> expected(n, false);
+    uint32_t seed = 7;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 1664525 + 1013904223;
+        const auto idx = (seed >> 8) % n;
+        dirty.Set(idx);
+        expected[idx] = true;
+    }
+    // a run that spans several whole words, and one that ends at the last element
+    dirty.SetRange(1000, 1300);
+    dirty.SetRange(n - 70, n);
+    for (uint32_t i = 1000; i < 1300; i++) {
+        expected[i] = true;
+    }
+    for (uint32_t i = n - 70; i < n; i++) {
+        expected[i] = true;
+    }
+
+    constexpr uint32_t maxGap = 2;
+    Vector<bool> covered(n, false);
+    uint32_t prevEnd = 0, nRanges = 0;
+    bool ok = true;
+    dirty.ConsumeRanges(maxGap, [&](uint32_t begin, uint32_t end) {
+        // ranges are ascending, separated by more than the gap, and start and end on marked elements
+        if ((nRanges > 0 && begin <= prevEnd + maxGap) || end > n || !expected[begin] || !expected[end - 1]) {
+            ok = false;
+        }
+        for (uint32_t i = begin; i < end; i++) {
+            covered[i] = true;
+        }
+        prevEnd = end;
+        nRanges++;
+    });
+    for (uint32_t i = 0; i < n; i++) {
+        if (expected[i] && !covered[i]) {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        cout << "Dirty ranges did not cover the marked elements" << std::endl;
+        return 1;
+    }
+
+    // consuming clears, and growing marks the new tail
+    uint32_t nAfter = 0;
+    dirty.ConsumeRanges(maxGap, [&](uint32_t, uint32_t) { nAfter++; });
+    dirty.Resize(n + 10, true);
+    uint32_t tailBegin = 0, tailEnd = 0;
+    dirty.ConsumeRanges(maxGap, [&](uint32_t begin, uint32_t end) { tailBegin = begin; tailEnd = end; nAfter++; });
+    if (nAfter != 1 || tailBegin != n || tailEnd != n + 10) {
+        cout << "Dirty bitset was not cleared or did not mark its new tail" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_DynamicResolution() {
+    DynamicResolutionController controller({
+        .targetFrameTimeMs = 10,
+        .headroom = 1,
+        .minScale = 0.5f,
+        .maxScale = 1,
+        .maxIncreasePerFrame = 0.1f,
+        .framesBeforeIncrease = 4,
+    });
+    // a frame over budget drops the scale right away, by the square root of the overrun, and never below the minimum
+    if (std::abs(controller.Update(20) - std::sqrt(0.5f)) > 1e-4f || controller.Update(1000) != 0.5f || controller.Update(0) != 0.5f) {
+        cout << "Scale did not drop to fit an over-budget frame" << std::endl;
+        return 1;
+    }
+    // it climbs only after several frames in a row fit, and a little at a time
+    for (int i = 0; i < 3; i++) {
+        if (controller.Update(1) != 0.5f) {
+            cout << "Scale increased before enough frames fit the budget" << std::endl;
+            return 1;
+        }
+    }
+    if (std::abs(controller.Update(1) - 0.6f) > 1e-4f || std::abs(controller.Update(1) - 0.7f) > 1e-4f) {
+        cout << "Scale did not climb by the increase step" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < 10; i++) {
+        controller.Update(1);
+    }
+    if (controller.GetScale() != 1) {
+        cout << "Scale did not return to the maximum" << std::endl;
+        return 1;
+    }
+
+    // under a load whose cost scales with pixels, it settles where the frame fits the budget, and stays there
+    controller.SetConfig(controller.GetConfig());
+    const float expected = std::sqrt(10 / 12.f);
+    for (int i = 0; i < 50; i++) {
+        const float scale = controller.GetScale();
+        controller.Update(12 * scale * scale);
+        if (i > 0 && std::abs(controller.GetScale() - expected) > 1e-3f) {
+            cout << "Scale " << controller.GetScale() << " did not settle at " << expected << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int Test_VRAMBudget() {
+    VRAMBudgetController controller({ .highWater = 0.9f, .lowWater = 0.5f, .framesBetweenSteps = 2 });
+    // a device without a budget is never under pressure
+    if (controller.Update(2000, 0) != VRAMPressureLevel::None) {
+        cout << "Pressure without a budget" << std::endl;
+        return 1;
+    }
+    // over the high water mark, the first step is taken right away, and the next ones after the wait
+    if (controller.Update(950, 1000) != VRAMPressureLevel::TextureMips || controller.GetOverageBytes() != 50) {
+        cout << "First step was not taken right away" << std::endl;
+        return 1;
+    }
+    if (controller.Update(950, 1000) != VRAMPressureLevel::TextureMips || controller.Update(950, 1000) != VRAMPressureLevel::TextureMips || controller.Update(950, 1000) != VRAMPressureLevel::ShadowResolution) {
+        cout << "Steps did not wait between each other" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < 20; i++) {
+        controller.Update(950, 1000);
+    }
+    if (controller.GetLevel() != VRAMPressureLevel::Max) {
+        cout << "Pressure did not reach the last level" << std::endl;
+        return 1;
+    }
+    // between the marks the level holds, and under the low water mark it steps back down
+    for (int i = 0; i < 10; i++) {
+        if (controller.Update(700, 1000) != VRAMPressureLevel::Max || controller.GetOverageBytes() != 0) {
+            cout << "Level changed between the water marks" << std::endl;
+            return 1;
+        }
+    }
+    for (int i = 0; i < 20; i++) {
+        controller.Update(400, 1000);
+    }
+    if (controller.GetLevel() != VRAMPressureLevel::None) {
+        cout << "Pressure did not go away under the low water mark" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_ImpostorEncoding() {
+    auto near = [](glm::vec3 a, glm::vec3 b) {
+        return glm::distance(a, b) < 1e-4f;
+    };
+    // every direction survives the trip through the grid
+    for (int i = 0; i < 200; i++) {
+        const float theta = i * 0.61803f * 6.28318f, phi = std::acos(1 - 2 * (i + 0.5f) / 200);
+        const glm::vec3 dir{ std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) };
+        if (!near(ImpostorEncoding::GridToDirection(ImpostorEncoding::DirectionToGrid(dir, false), false), dir)) {
+            cout << "Octahedral round trip failed" << std::endl;
+            return 1;
+        }
+        const glm::vec3 upper{ dir.x, std::abs(dir.y), dir.z };
+        if (!near(ImpostorEncoding::GridToDirection(ImpostorEncoding::DirectionToGrid(upper, true), true), upper)) {
+            cout << "Hemi-octahedral round trip failed" << std::endl;
+            return 1;
+        }
+    }
+    // the middle frame looks from above, and the corners of the full map from below
+    if (!near(ImpostorEncoding::FrameDirection(2, 2, 5, false), { 0, 1, 0 }) || !near(ImpostorEncoding::FrameDirection(2, 2, 5, true), { 0, 1, 0 }) || !near(ImpostorEncoding::FrameDirection(0, 0, 5, false), { 0, -1, 0 })) {
+        cout << "Frame directions are wrong" << std::endl;
+        return 1;
+    }
+    // the corners of the hemisphere map are on the horizon
+    if (std::abs(ImpostorEncoding::FrameDirection(4, 0, 5, true).y) > 1e-4f) {
+        cout << "Hemisphere corners are not on the horizon" << std::endl;
+        return 1;
+    }
+    for (const auto dir : { glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::normalize(glm::vec3(1, 2, 3)) }) {
+        const auto basis = ImpostorEncoding::BasisForDirection(dir);
+        if (std::abs(glm::dot(basis.right, basis.up)) > 1e-4f || std::abs(glm::dot(basis.right, dir)) > 1e-4f || std::abs(glm::dot(basis.up, dir)) > 1e-4f || std::abs(glm::length(basis.up) - 1) > 1e-4f) {
+            cout << "Frame basis is not orthonormal" << std::endl;
+            return 1;
+        }
+    }
+    const ImpostorEncoding::ImpostorHeader header{ .atlasSize = 64, .framesPerSide = 8, .mipLevels = 2 };
+    if (ImpostorEncoding::AtlasBytes(header) != (64 * 64 + 32 * 32) * 4) {
+        cout << "Atlas size is wrong" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_WorldStreamingCells() {
+    // a circle of radius 1.4 cells around the middle of a cell touches that cell and the 8 around it, and no others
+    Vector<StreamingCell> cells;
+    StreamingCellsWithin({ 15, 0, 15 }, 14, 10, cells);
+    if (cells.size() != 9 || std::ranges::find(cells, StreamingCell{ 0, 0 }) == cells.end() || std::ranges::find(cells, StreamingCell{ 2, 2 }) == cells.end()) {
+        cout << "Found " << cells.size() << " cells within the radius" << std::endl;
+        return 1;
+    }
+    if (StreamingCellDistance({ 0, 0 }, { 5, 100, 5 }, 10) != 0 || std::abs(StreamingCellDistance({ -1, 0 }, { 3, 0, 5 }, 10) - 3) > 1e-5f || std::abs(StreamingCellDistance({ 1, 1 }, { 7, 0, 6 }, 10) - 5) > 1e-5f) {
+        cout << "Cell distances are wrong" << std::endl;
+        return 1;
+    }
+
+    // a snapshot is merged into a world that already has entities, in batches
+    World source;
+    for (int i = 0; i < 10; i++) {
+        auto e = source.Instantiate<Entity>();
+        e.EmplaceComponent<IntComponent>().value = i;
+        if (i % 2 == 0) {
+            e.EmplaceComponent<FloatComponent>().value = i * 0.5f;
+        }
+        if (i == 3) {
+            e.Destroy();
+        }
+    }
+    const auto unpacked = World::UnpackSnapshot(source.SaveSnapshot<IntComponent, FloatComponent>());
+    if (unpacked.numEntities != 9) {
+        cout << "Unpacked " << unpacked.numEntities << " entities" << std::endl;
+        return 1;
+    }
+    World target;
+    target.Instantiate<Entity>().EmplaceComponent<IntComponent>().value = -1;
+    Vector<entity_t> merged;
+    for (entity_id_t first = 0; first < unpacked.numEntities; first += 4) {
+        const auto ids = target.CreateEntities(std::min<entity_id_t>(4, unpacked.numEntities - first));
+        target.MergeSnapshot<IntComponent, FloatComponent>(unpacked, first, ids);
+        merged.insert(merged.end(), ids.begin(), ids.end());
+    }
+    const int expected[]{ 0, 1, 2, 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 9; i++) {
+        const Entity e(merged[i], &target);
+        if (e.GetComponent<IntComponent>().value != expected[i] || (expected[i] % 2 == 0) != e.HasComponent<FloatComponent>() || (e.HasComponent<FloatComponent>() && e.GetComponent<FloatComponent>().value != expected[i] * 0.5f)) {
+            cout << "Merged entity " << i << " has the wrong components" << std::endl;
+            return 1;
+        }
+    }
+    int nInts = 0;
+    target.Filter([&](const IntComponent&) {
+        nInts++;
+    });
+    if (nInts != 10) {
+        cout << "Merged world has " << nInts << " ints" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_EntityPool() {
+    World world;
+    int nSpawned = 0, nDespawned = 0;
+    Vector<Entity> spawned;
+    entity_t recycledID;
+    {
+        EntityPool<Entity> pool(&world);
+        pool.onSpawn = [&](Entity) { nSpawned++; };
+        pool.onDespawn = [&](Entity e) {
+            e.DestroyComponent<IntComponent>();
+            nDespawned++;
+        };
+        pool.Reserve(2);
+        if (pool.NumPooled() != 2) {
+            cout << "Reserve pooled " << pool.NumPooled() << " entities" << std::endl;
+            return 1;
+        }
+        // the reserved entities come out first, then new ones are made
+        for (int i = 0; i < 3; i++) {
+            auto e = pool.Spawn(vector3(i, 0, 0), quaternion(1, 0, 0, 0));
+            e.EmplaceComponent<IntComponent>().value = i;
+            spawned.push_back(e);
+        }
+        if (pool.NumPooled() != 0 || nSpawned != 3) {
+            cout << "Spawning left " << pool.NumPooled() << " pooled" << std::endl;
+            return 1;
+        }
+        spawned[0].SetEntityRenderlayer(0b101);
+        recycledID = spawned[0].GetID();
+        for (auto& e : spawned) {
+            pool.Despawn(e);
+        }
+        // pooled entities stay alive, hidden
+        if (!world.CorrectVersion(recycledID) || spawned[0].GetEntityRenderlayer() != 0 || nDespawned != 3) {
+            cout << "Despawned entity was destroyed or is not hidden" << std::endl;
+            return 1;
+        }
+        // the last entity despawned is the first spawned
+        const auto again = pool.Spawn(vector3(0), quaternion(1, 0, 0, 0));
+        const auto second = pool.Spawn(vector3(0), quaternion(1, 0, 0, 0));
+        if (!(again.GetID() == spawned[2].GetID()) || !(second.GetID() == spawned[1].GetID())) {
+            cout << "Spawn did not reuse the despawned entities" << std::endl;
+            return 1;
+        }
+        pool.Despawn(again);
+        const auto restored = pool.Spawn(vector3(0), quaternion(1, 0, 0, 0));
+        pool.Despawn(pool.Spawn(vector3(0), quaternion(1, 0, 0, 0)));
+        if (!(pool.Spawn(vector3(0), quaternion(1, 0, 0, 0)).GetID() == recycledID) || spawned[0].GetEntityRenderlayer() != 0b101 || restored.GetEntityRenderlayer() != ALL_LAYERS) {
+            cout << "Spawn did not restore the render layers" << std::endl;
+            return 1;
+        }
+        pool.Despawn(restored);
+    }
+    // the pool destroys what it still holds, and leaves spawned entities alone
+    if (world.CorrectVersion(spawned[2].GetID()) || !world.CorrectVersion(spawned[1].GetID()) || !world.CorrectVersion(recycledID)) {
+        cout << "Pool destroyed the wrong entities" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_Heightfield() {
+    // a plane rising by 0.5 per unit along X and 1 per unit along Z, with samples 2 units apart
+    Heightfield plane(3, 3, 2);
+    for (uint32_t z = 0; z < 3; z++) {
+        for (uint32_t x = 0; x < 3; x++) {
+            plane.At(x, z) = x + 2.f * z;
+        }
+    }
+    // either triangle of a cell reproduces a plane, and positions off the grid clamp to its edge
+    if (std::abs(plane.Sample(1, 1) - 1.5f) > 1e-5f || std::abs(plane.Sample(3, 0.5f) - 2) > 1e-5f || std::abs(plane.Sample(-5, 100) - 4) > 1e-5f) {
+        cout << "Sampled the plane wrong" << std::endl;
+        return 1;
+    }
+    const auto normal = plane.Normal(1, 1);
+    if (glm::distance(normal, glm::vec3(-1, 2, -2) / 3.f) > 1e-5f) {
+        cout << "Plane normal is " << normal.x << ", " << normal.y << ", " << normal.z << std::endl;
+        return 1;
+    }
+    const auto cell = plane.HeightRange(0, 0, 1, 1), all = plane.HeightRange(0, 0, 2, 2);
+    if (cell.min != 0 || cell.max != 3 || all.min != 0 || all.max != 6) {
+        cout << "Height ranges are wrong" << std::endl;
+        return 1;
+    }
+
+    // the cell is split from (0, 0) to (1, 1), so the middle is on the raised corner's edge
+    Heightfield corner(2, 2, 1);
+    corner.At(1, 1) = 1;
+    if (std::abs(corner.Sample(0.5f, 0.5f) - 0.5f) > 1e-5f || std::abs(corner.Sample(0.9f, 0.1f) - 0.1f) > 1e-5f) {
+        cout << "Cell is split along the wrong diagonal" << std::endl;
+        return 1;
+    }
+
+    // tiles round trip, and the spacing comes from the tile size
+    const std::array<std::array<uint8_t, 4>, 4> splat{ { { 255, 0, 0, 0 }, { 0, 255, 0, 0 }, { 0, 0, 255, 0 }, { 0, 0, 0, 255 } } };
+    const auto bytes = SerializeTerrainTile(plane, 2, splat);
+    TerrainTileData tile;
+    if (!ParseTerrainTile(bytes, 8, tile) || tile.heights.width != 3 || tile.heights.spacing != 4 || tile.heights.heights != plane.heights || tile.splatResolution != 2 || !std::ranges::equal(tile.splat, splat)) {
+        cout << "Tile did not round trip" << std::endl;
+        return 1;
+    }
+    if (ParseTerrainTile(std::span(bytes).first(bytes.size() - 1), 8, tile) || ParseTerrainTile(std::span(bytes).subspan(4), 8, tile)) {
+        cout << "Parsed a broken tile" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_TextureStreamingBudget() {
+    const TextureStreamingRequest large{ .width = 1024, .height = 1024, .numMips = 11, .tailMip = 4 };
+    const TextureStreamingRequest small{ .width = 256, .height = 256, .numMips = 9, .tailMip = 2 };
+    const TextureStreamingRequest compressed{ .width = 2048, .height = 2048, .numMips = 12, .tailMip = 5, .blockDim = 4, .bytesPerBlock = 8 };
+    Vector<TextureStreamingRequest> requests{ large, small, compressed };
+
+    // block-compressed mips are rounded up to whole blocks
+    if (TextureMipChainBytes(compressed, 0) - TextureMipChainBytes(compressed, 1) != 2048 * 2048 / 2 || TextureMipChainBytes(compressed, 11) != 8) {
+        cout << "Wrong size for block-compressed mips" << std::endl;
+        return 1;
+    }
+
+    uint64_t wantedBytes = 0, tailBytes = 0;
+    for (const auto& request : requests) {
+        wantedBytes += TextureMipChainBytes(request, request.wantedMip);
+        tailBytes += TextureMipChainBytes(request, request.tailMip);
+    }
+    auto granted = [&](uint8_t a, uint8_t b, uint8_t c) {
+        return requests[0].grantedMip == a && requests[1].grantedMip == b && requests[2].grantedMip == c;
+    };
+
+    if (ResolveTextureStreamingBudget(requests, wantedBytes) != wantedBytes || !granted(0, 0, 0)) {
+        cout << "Requests that fit the budget were not all granted" << std::endl;
+        return 1;
+    }
+
+    // the largest mip goes first, which is the uncompressed one
+    const uint64_t largeTopMip = 1024 * 1024 * 4;
+    if (ResolveTextureStreamingBudget(requests, wantedBytes - largeTopMip) != wantedBytes - largeTopMip || !granted(1, 0, 0)) {
+        cout << "The largest mip was not dropped first" << std::endl;
+        return 1;
+    }
+    if (ResolveTextureStreamingBudget(requests, wantedBytes - largeTopMip - 1) > wantedBytes - largeTopMip - 1 || !granted(1, 0, 1)) {
+        cout << "The next largest mip was not dropped second" << std::endl;
+        return 1;
+    }
+
+    // tails are never dropped, even over budget
+    if (ResolveTextureStreamingBudget(requests, 0) != tailBytes || !granted(4, 2, 5)) {
+        cout << "Textures did not keep their tails" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_ReplicationDelta() {
+    auto idFor = [](uint8_t i) {
+        return netid_t((uint32_t(i * 37 % 256) << NetworkIDTable<int>::indexBits) | i);
+    };
+    // each tick some entities are missing, some fields change, and one entity gains a field
+    std::array<ReplicationSnapshot, 6> ticks;
+    for (uint32_t tick = 0; tick < ticks.size(); tick++) {
+        auto& snapshot = ticks[tick];
+        snapshot.sequence = tick + 1;
+        for (uint8_t i = 0; i < 20; i++) {
+            if ((i + tick) % 7 == 0) {
+                continue;
+            }
+            snapshot.BeginEntity(idFor(i));
+            const uint8_t nFields = (i == 3 && tick > 2) ? 3 : 2;
+            for (uint8_t f = 0; f < nFields; f++) {
+                const float value = i + ((i + f + tick) % 4 == 0 ? float(tick) : 0.f);
+                std::memcpy(snapshot.AddField(sizeof(value)), &value, sizeof(value));
+            }
+        }
+        snapshot.Finalize();
+    }
+
+    for (uint32_t tick = 0; tick < ticks.size(); tick++) {
+        std::string full;
+        ticks[tick].Encode(nullptr, full);
+        for (int32_t base = -1; base < int32_t(tick); base++) {
+            const ReplicationSnapshot* baseline = base < 0 ? nullptr : &ticks[base];
+            std::string delta;
+            ticks[tick].Encode(baseline, delta);
+            if (baseline && delta.size() >= full.size()) {
+                cout << "Replication delta from " << base << " to " << tick << " is not smaller than the full snapshot" << std::endl;
+                return 1;
+            }
+            ReplicationSnapshot decoded;
+            if (!decoded.Decode(delta, baseline) || decoded.GetEntities().size() != ticks[tick].GetEntities().size()) {
+                cout << "Replication delta from " << base << " to " << tick << " did not decode" << std::endl;
+                return 1;
+            }
+            for (const auto& entity : ticks[tick].GetEntities()) {
+                auto other = decoded.Find(entity.id);
+                if (other == nullptr || other->nFields != entity.nFields) {
+                    cout << "Replicated entity missing from delta " << base << " to " << tick << std::endl;
+                    return 1;
+                }
+                for (uint8_t f = 0; f < entity.nFields; f++) {
+                    auto expected = ticks[tick].GetField(entity, f);
+                    auto actual = decoded.GetField(*other, f);
+                    if (expected.size() != actual.size() || std::memcmp(expected.data(), actual.data(), expected.size()) != 0) {
+                        cout << "Replicated field " << int(f) << " differs after delta " << base << " to " << tick << std::endl;
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // a receiver that is only sent some of the entities rebuilds exactly those
+    auto everyOther = [](const ReplicationSnapshot& snapshot, uint32_t parity) {
+        Vector<uint32_t> subset;
+        for (uint32_t i = parity; i < snapshot.GetEntities().size(); i += 2) {
+            subset.push_back(i);
+        }
+        return subset;
+    };
+    const auto subset1 = everyOther(ticks[1], 0), subset2 = everyOther(ticks[2], 1);
+    std::string first, second;
+    ticks[1].Encode(nullptr, first, &subset1);
+    ticks[2].Encode(&ticks[1], second, &subset2, &subset1);
+    ReplicationSnapshot received1, received2;
+    if (!received1.Decode(first, nullptr) || !received2.Decode(second, &received1) || received2.GetEntities().size() != subset2.size()) {
+        cout << "Replication subset did not decode" << std::endl;
+        return 1;
+    }
+    for (auto i : subset2) {
+        const auto& entity = ticks[2].GetEntities()[i];
+        auto other = received2.Find(entity.id);
+        if (other == nullptr || other->nFields != entity.nFields) {
+            cout << "Replicated entity missing from subset" << std::endl;
+            return 1;
+        }
+        for (uint8_t f = 0; f < entity.nFields; f++) {
+            auto expected = ticks[2].GetField(entity, f);
+            if (std::memcmp(expected.data(), received2.GetField(*other, f).data(), expected.size()) != 0) {
+                cout << "Replicated field " << int(f) << " differs in subset" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // truncated deltas are rejected
+    std::string delta;
+    ticks[1].Encode(&ticks[0], delta);
+    ReplicationSnapshot decoded;
+    if (decoded.Decode(std::string_view(delta).substr(0, delta.size() - 1), &ticks[0])) {
+        cout << "Truncated replication delta decoded" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int Test_RPCBatch() {
+    auto makeRPC = [](uint8_t entity, uint16_t id, size_t size, char fill) {
+        std::string msg(RPCMsgUnpacker::header_size + size, fill);
+        msg[0] = NetworkBase::CommandCode::RPC;
+        const netid_t sessionID = entity + 1;
+        std::memcpy(msg.data() + 1, &sessionID, sizeof(sessionID));
+        std::memcpy(msg.data() + RPCMsgUnpacker::code_offset, &id, sizeof(id));
+        return msg;
+    };
+
+    // coalesced RPCs keep their place and take the latest value, others are all sent in order
+    RPCBatch batch;
+    std::vector<std::string> expected;
+    for (uint8_t i = 0; i < 100; i++) {
+        auto msg = makeRPC(i % 5, i % 3, 10 + i % 11, char('a' + i % 26));
+        const bool coalesce = i % 3 == 0;
+        if (coalesce) {
+            auto found = std::find_if(expected.begin(), expected.end(), [&msg](const std::string& queued) {
+                return queued.compare(1, RPCMsgUnpacker::header_size - 1, msg, 1, RPCMsgUnpacker::header_size - 1) == 0;
+            });
+            if (found != expected.end()) {
+                *found = msg;
+                batch.Add(msg, coalesce);
+                continue;
+            }
+        }
+        expected.push_back(msg);
+        batch.Add(msg, coalesce);
+    }
+    expected.push_back(makeRPC(1, 7, RPCBatch::maxBatchSize, 'z'));   // too long to batch
+    batch.Add(expected.back(), false);
+
+    std::vector<std::string> received;
+    uint32_t nBatches = 0;
+    batch.Flush([&](const std::string_view& packed) {
+        if (packed.size() > RPCBatch::maxBatchSize) {
+            received.emplace_back(packed);
+            return;
+        }
+        nBatches++;
+        if (packed[0] != NetworkBase::CommandCode::BatchedRPCs || !RPCBatch::Unpack(packed, [&received](const std::string_view& rpc) {
+            received.emplace_back(rpc);
+        })) {
+            cout << "Malformed RPC batch" << std::endl;
+            received.clear();
+        }
+    });
+    if (received != expected) {
+        cout << "RPC batch delivered " << received.size() << " messages, expected " << expected.size() << std::endl;
+        return 1;
+    }
+    if (nBatches < 2 || !batch.Empty()) {
+        cout << "RPC batch was not split or not cleared" << std::endl;
+        return 2;
+    }
+
+    std::string truncated;
+    batch.Add(makeRPC(0, 0, 4, 'x'), false);
+    batch.Flush([&truncated](const std::string_view& packed) {
+        truncated = packed;
+    });
+    truncated.pop_back();
+    if (RPCBatch::Unpack(truncated, [](const std::string_view&) {})) {
+        cout << "Truncated RPC batch unpacked" << std::endl;
+        return 3;
+    }
+    return 0;
+}
+
+int Test_NetworkIDTable() {
+    NetworkIDTable<int> server, client;
+    std::vector<netid_t> ids;
+    for (int i = 0; i < 100; i++) {
+        ids.push_back(server.Allocate(i));
+        client.Set(ids.back(), i);
+    }
+    for (int i = 0; i < 100; i++) {
+        if (ids[i] == NetworkIDTable<int>::invalid || server.Find(ids[i]) != i || client.Find(ids[i]) != i) {
+            cout << "Session ID " << ids[i] << " does not find " << i << std::endl;
+            return 1;
+        }
+    }
+
+    // a destroyed entity's slot is reused under a new ID, and the old ID no longer finds anything
+    const auto stale = ids[10];
+    if (!server.Erase(stale) || server.Erase(stale) || server.Find(stale)) {
+        cout << "Erased session ID is still found" << std::endl;
+        return 2;
+    }
+    const auto reused = server.Allocate(1000);
+    client.Set(reused, 1000);
+    if (NetworkIDTable<int>::IndexOf(reused) != NetworkIDTable<int>::IndexOf(stale) || reused == stale) {
+        cout << "Session ID slot was not reused with a new generation" << std::endl;
+        return 3;
+    }
+    if (client.Find(stale) || client.Find(reused) != 1000 || server.Find(reused) != 1000) {
+        cout << "Stale session ID reached the reused slot" << std::endl;
+        return 4;
+    }
+    if (server.Find(NetworkIDTable<int>::invalid) || client.Find(ids.back() + 1)) {
+        cout << "Invalid session ID was found" << std::endl;
+        return 5;
+    }
+    return 0;
+}
+
+int Test_CompactRPC() {
+    // bit streams round trip values of any width, and refuse to overflow
+    {
+        Array<uint8_t, 5> buffer{};
+        BitWriter writer(buffer);
+        const uint32_t values[] = { 1, 0x3FF, 0, 0x1234, 5 };
+        const uint8_t widths[] = { 1, 10, 3, 16, 7 };
+        for (int i = 0; i < 5; i++) {
+            writer.Write(values[i], widths[i]);
+        }
+        if (writer.BitsWritten() != 37 || writer.Write(0, 4)) {
+            cout << "Bit writer overflowed" << std::endl;
+            return 1;
+        }
+        BitReader reader(buffer);
+        for (int i = 0; i < 5; i++) {
+            uint32_t value = 0;
+            if (!reader.Read(value, widths[i]) || value != values[i]) {
+                cout << "Bit reader read " << value << " instead of " << values[i] << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    // quantized values stay within their precision
+    for (float value = -12; value <= 12; value += 0.37f) {
+        const RangedFloat<-10.f, 10.f, 12> ranged(value);
+        const auto expected = std::clamp(value, -10.f, 10.f);
+        if (std::abs(ranged.Get() - expected) > 20.f / 4095) {
+            cout << "Ranged float " << value << " decoded as " << ranged.Get() << std::endl;
+            return 3;
+        }
+        const auto vec = HalfVector3(vector3(value, value * 10, -value)).Get();
+        if (glm::distance(vec, vector3(value, value * 10, -value)) > 0.1f) {
+            cout << "Half vector decoded too far from " << value << std::endl;
+            return 4;
+        }
+    }
+    static_assert(sizeof(PackedQuaternion) == 4 && sizeof(HalfVector3) == 6);
+    for (int i = 0; i < 50; i++) {
+        const auto q = glm::normalize(quaternion(std::sin(i * 1.3f), std::cos(i * 0.7f) - 0.2f, std::sin(i * 2.1f), -std::cos(i * 0.3f)));
+        const auto decoded = PackedQuaternion(q).Get();
+        if (std::abs(glm::dot(q, decoded)) < 0.999f) {
+            cout << "Packed quaternion " << i << " decoded too far from the original" << std::endl;
+            return 5;
+        }
+    }
+
+    // compact RPCs carry one signature instead of a type per parameter
+    const vector3 position(1, 2, 3);
+    const HalfVector3 packedPosition(position);
+    const PackedQuaternion packedRotation(quaternion(1, 0, 0, 0));
+    std::string msg(RPCMsgUnpacker::CompactSize<HalfVector3, PackedQuaternion>(), 0);
+    msg[0] = NetworkBase::CommandCode::CompactRPC;
+    const auto signature = RPCMsgUnpacker::Signature<HalfVector3, PackedQuaternion>();
+    std::memcpy(msg.data() + RPCMsgUnpacker::header_size, &signature, sizeof(signature));
+    std::memcpy(msg.data() + RPCMsgUnpacker::header_size + sizeof(signature), &packedPosition, sizeof(packedPosition));
+    std::memcpy(msg.data() + RPCMsgUnpacker::header_size + sizeof(signature) + sizeof(packedPosition), &packedRotation, sizeof(packedRotation));
+    if (msg.size() * 2 > RPCMsgUnpacker::header_size + RPCMsgUnpacker::TotalSerializedSize<vector3>() + RPCMsgUnpacker::TotalSerializedSize<quaternion>()) {
+        cout << "Compact RPC is " << msg.size() << " bytes, not half of the tagged encoding" << std::endl;
+        return 6;
+    }
+    auto args = RPCMsgUnpacker(msg).Unpack<HalfVector3, PackedQuaternion>();
+    if (!args || std::get<0>(*args).Get() != position || std::abs(std::get<1>(*args).Get().w - 1) > 0.001f) {
+        cout << "Compact RPC did not unpack" << std::endl;
+        return 7;
+    }
+    if (RPCMsgUnpacker(msg).Unpack<PackedQuaternion, HalfVector3>() || RPCMsgUnpacker(msg).Unpack<HalfVector3>()) {
+        cout << "Compact RPC unpacked with the wrong signature" << std::endl;
+        return 8;
+    }
+    return 0;
+}
+
+int Test_SpawnBatch() {
+    Vector<SpawnBatch::Record> records(SpawnBatch::recordsPerBatch);
+    for (uint32_t i = 0; i < records.size(); i++) {
+        records[i].type = 1000 + i % 3;
+        records[i].sessionID = (1 << NetworkIDTable<int>::indexBits) | i;
+        records[i].id = uuids::uuid::create();
+    }
+    const std::string worldID = "world_01";
+    const auto batch = SpawnBatch::Encode(records, worldID);
+    if (batch[0] != NetworkBase::CommandCode::SpawnBatch) {
+        cout << "Spawn batch has the wrong command code" << std::endl;
+        return 1;
+    }
+    const auto rawSize = records.size() * (sizeof(ctti_t) + sizeof(netid_t) + uuids::uuid::nbytes);
+    if (batch.size() >= rawSize) {
+        cout << "Spawn batch of " << batch.size() << " bytes did not compress" << std::endl;
+        return 2;
+    }
+
+    std::string decodedWorld;
+    Vector<SpawnBatch::Record> decoded;
+    if (!SpawnBatch::Decode(batch, decodedWorld, decoded) || decodedWorld != worldID || decoded.size() != records.size()) {
+        cout << "Spawn batch did not decode" << std::endl;
+        return 3;
+    }
+    for (uint32_t i = 0; i < records.size(); i++) {
+        if (decoded[i].type != records[i].type || decoded[i].sessionID != records[i].sessionID || decoded[i].id != records[i].id) {
+            cout << "Spawn record " << i << " changed in transit" << std::endl;
+            return 4;
+        }
+    }
+
+    // truncated or corrupted batches are rejected
+    if (SpawnBatch::Decode(std::string_view(batch).substr(0, batch.size() - 1), decodedWorld, decoded) || SpawnBatch::Decode(std::string_view(batch).substr(0, 4), decodedWorld, decoded)) {
+        cout << "Truncated spawn batch decoded" << std::endl;
+        return 5;
+    }
+    auto corrupt = batch;
+    corrupt[1 + World::id_size] = char(0xFF);
+    if (SpawnBatch::Decode(corrupt, decodedWorld, decoded)) {
+        cout << "Spawn batch with a bad count decoded" << std::endl;
+        return 6;
+    }
+    return 0;
+}
+
+int Test_AssetPack() {
+    // one file stored and one compressed, laid out the way rvepack writes them
+    const std::string stored(5000, 's');
+    std::string text;
+    for (int i = 0; i < 200; i++) {
+        text += "a line of text that repeats\n";
+    }
+    Vector<std::byte> compressed(Compression::DeflateBound(text.size()));
+    compressed.resize(Compression::Deflate(std::as_bytes(std::span(text)), compressed));
+
+    const std::string paths = "Game/a.binGame/sub/b.txt";
+    AssetPack::Header header;
+    header.entryCount = 2;
+    header.pathsSize = uint32_t(paths.size());
+    Array<AssetPack::Entry, 2> entries;
+    entries[0] = { AssetPack::HashPath("Game/a.bin"), AssetPack::alignment, stored.size(), stored.size(), 0, 10, AssetPack::Encoding::None, 0 };
+    entries[1] = { AssetPack::HashPath("Game/sub/b.txt"), AssetPack::alignment + stored.size(), text.size(), compressed.size(), 10, 14, AssetPack::Encoding::Deflate, 1 };
+    if (entries[1].pathHash < entries[0].pathHash) {
+        std::swap(entries[0], entries[1]);
+    }
+    Vector<std::byte> table(AssetPack::TableSize(header));
+    std::memcpy(table.data(), &header, sizeof(header));
+    std::memcpy(table.data() + sizeof(header), entries.data(), sizeof(entries));
+    std::memcpy(table.data() + sizeof(header) + sizeof(entries), paths.data(), paths.size());
+    const uint64_t packSize = AssetPack::alignment + stored.size() + compressed.size();
+
+    AssetPack::Index index;
+    if (!index.Load(table, packSize)) {
+        cout << "Asset pack index did not load" << std::endl;
+        return 1;
+    }
+    auto a = index.Find("Game/a.bin");
+    auto b = index.Find("Game/sub/b.txt");
+    if (!a || !b || a->offset != AssetPack::alignment || b->encoding != AssetPack::Encoding::Deflate || index.Find("Game/c.bin") || index.Find("Game/sub")) {
+        cout << "Asset pack lookup found the wrong entries" << std::endl;
+        return 2;
+    }
+    if (!index.IsDirectory("Game/sub") || index.IsDirectory("Game/a.bin")) {
+        cout << "Asset pack directories are wrong" << std::endl;
+        return 3;
+    }
+    Vector<std::string> names;
+    index.EnumerateDirectory("Game", [&](const std::string& name) {
+        names.push_back(name);
+    });
+    std::sort(names.begin(), names.end());
+    if (names != Vector<std::string>{ "a.bin", "sub" }) {
+        cout << "Asset pack enumerated the wrong files" << std::endl;
+        return 4;
+    }
+
+    std::string inflated(text.size(), 0);
+    if (!Compression::Inflate(compressed, std::as_writable_bytes(std::span(inflated))) || inflated != text) {
+        cout << "Asset pack entry did not decompress" << std::endl;
+        return 5;
+    }
+
+    // entries outside the pack are rejected
+    if (index.Load(table, packSize - 1)) {
+        cout << "Asset pack with a truncated entry loaded" << std::endl;
+        return 6;
+    }
+    return 0;
+}
+
+int Test_MeshEncoding() {
+    // unit vectors survive octahedral encoding, including the lower hemisphere and the axes
+    const glm::vec3 normals[]{ {0,0,1}, {0,0,-1}, {1,0,0}, {0,-1,0}, glm::normalize(glm::vec3(1,2,-3)), glm::normalize(glm::vec3(-0.3,0.1,0.9)) };
+    for (const auto& n : normals) {
+        int16_t encoded[2];
+        MeshEncoding::EncodeOctahedral(n, encoded);
+        if (glm::dot(MeshEncoding::DecodeOctahedral(encoded), n) < 0.9999f) {
+            cout << "Octahedral normal did not round trip" << std::endl;
+            return 1;
+        }
+    }
+
+    const float min = -2, extent = 5;
+    for (float value : {-2.f, 0.f, 1.2345f, 3.f}) {
+        if (std::abs(MeshEncoding::DequantizeUnorm16(MeshEncoding::QuantizeUnorm16(value, min, extent), min, extent) - value) > extent / 65535) {
+            cout << "Quantized position did not round trip" << std::endl;
+            return 2;
+        }
+    }
+
+    uint16_t uv[2];
+    MeshEncoding::EncodeHalf2({ 0.25f, 0.7f }, uv);
+    const auto decoded = MeshEncoding::DecodeHalf2(uv);
+    if (decoded.x != 0.25f || std::abs(decoded.y - 0.7f) > 0.001f) {
+        cout << "Half UV did not round trip" << std::endl;
+        return 3;
+    }
+
+    // a mirrored tangent frame keeps its handedness
+    if (MeshEncoding::BitangentSign({ 0,0,1 }, { 1,0,0 }, { 0,-1,0 }) != -1 || MeshEncoding::BitangentSign({ 0,0,1 }, { 1,0,0 }, { 0,1,0 }) != 1) {
+        cout << "Bitangent sign is wrong" << std::endl;
+        return 4;
+    }
+    return 0;
+}
+
+int Test_KTX2() {
+    // a 4x2 RGBA8 texture with two levels, optionally zlib supercompressed
+    const std::string level0(4 * 2 * 4, 'a'), level1(2 * 1 * 4, 'b');
+    auto makeFile = [&](uint32_t vkFormat, uint32_t scheme) {
+        const std::string levels[]{ level0, level1 };
+        Vector<Vector<std::byte>> stored;
+        for (const auto& level : levels) {
+            Vector<std::byte> data(Compression::DeflateBound(level.size()));
+            if (scheme == 3) {
+                data.resize(Compression::Deflate(std::as_bytes(std::span(level)), data));
+            }
+            else {
+                data.assign(reinterpret_cast<const std::byte*>(level.data()), reinterpret_cast<const std::byte*>(level.data()) + level.size());
+            }
+            stored.push_back(std::move(data));
+        }
+        const uint8_t identifier[12]{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        const uint32_t header[17]{ vkFormat, 1, 4, 2, 0, 0, 1, 2, scheme };
+        Vector<std::byte> file(80 + 2 * 24);
+        std::memcpy(file.data(), identifier, sizeof(identifier));
+        std::memcpy(file.data() + 12, header, sizeof(header));
+        for (size_t i = 0; i < 2; i++) {
+            const uint64_t index[3]{ file.size(), stored[i].size(), levels[i].size() };
+            std::memcpy(file.data() + 80 + i * sizeof(index), index, sizeof(index));
+            file.insert(file.end(), stored[i].begin(), stored[i].end());
+        }
+        return file;
+    };
+
+    for (uint32_t scheme : {0u, 3u}) {
+        const auto file = makeFile(37, scheme);
+        KTX2::Image image;
+        if (KTX2::Read(file, image) != KTX2::ReadResult::Success || image.width != 4 || image.height != 2 || image.levels.size() != 2) {
+            cout << "KTX2 did not read" << std::endl;
+            return 1;
+        }
+        Vector<std::byte> mips;
+        if (!KTX2::DecodeLevels(image, mips) || std::string(reinterpret_cast<const char*>(mips.data()), mips.size()) != level0 + level1) {
+            cout << "KTX2 levels did not decode" << std::endl;
+            return 2;
+        }
+    }
+
+    KTX2::Image image;
+    if (KTX2::Read(makeFile(0, 1), image) != KTX2::ReadResult::BasisUniversal) {
+        cout << "Basis Universal KTX2 was not detected" << std::endl;
+        return 3;
+    }
+    auto truncated = makeFile(37, 0);
+    truncated.pop_back();
+    if (KTX2::Read(truncated, image) != KTX2::ReadResult::Truncated) {
+        cout << "Truncated KTX2 was read" << std::endl;
+        return 4;
+    }
+    return 0;
+}
+
+int Test_FrameArena() {
+    auto& arena = FrameArena::ForThisThread();
+    {
+        FrameVector<int> values;
+        for (int i = 0; i < 100000; i++) {
+            values.push_back(i);
+        }
+        for (int i = 0; i < 100000; i++) {
+            if (values[i] != i) {
+                cout << "Frame vector lost its contents while growing" << std::endl;
+                return 1;
+            }
+        }
+        struct alignas(64) Aligned {
+            char data[64];
+        };
+        FrameVector<Aligned> aligned(3);
+        if (reinterpret_cast<uintptr_t>(aligned.data()) % 64 != 0) {
+            cout << "Frame allocation is misaligned" << std::endl;
+            return 2;
+        }
+    }
+    if (!arena.IsEmpty()) {
+        cout << "Frame arena has live allocations after they were freed" << std::endl;
+        return 3;
+    }
+
+    // once empty, the arena starts over in one chunk that fits what it needed before
+    FrameVector<int> next(1);
+    if (arena.GetNumChunks() != 1 || arena.GetCapacity() < 100000 * sizeof(int)) {
+        cout << "Frame arena did not restart in one chunk" << std::endl;
+        return 4;
+    }
+
+    // memory allocated on a thread that has exited can still be freed
+    FrameVector<int>* fromThread = nullptr;
+    std::thread([&fromThread] {
+        fromThread = new FrameVector<int>(1000, 7);
+    }).join();
+    if ((*fromThread)[999] != 7) {
+        cout << "Frame vector from another thread lost its contents" << std::endl;
+        return 5;
+    }
+    delete fromThread;
+    return 0;
+}
+
+int Test_SpinLock() {
+    // more threads than cores, so waiters have to park for the owner to run
+    NamedSpinLock<"Test_SpinLock"> lock;
+    uint64_t counter = 0;
+    const auto numThreads = std::thread::hardware_concurrency() * 4;
+    constexpr uint64_t increments = 20000;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < numThreads; t++) {
+        threads.emplace_back([&] {
+            for (uint64_t i = 0; i < increments; i++) {
+                std::lock_guard guard(lock);
+                counter++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (counter != numThreads * increments) {
+        cout << "SpinLock allowed concurrent access, counted " << counter << std::endl;
+        return 1;
+    }
+    if (!lock.try_lock()) {
+        cout << "SpinLock was not released" << std::endl;
+        return 2;
+    }
+    if (lock.try_lock()) {
+        cout << "SpinLock was acquired twice" << std::endl;
+        return 3;
+    }
+    lock.unlock();
+    return 0;
+}
+
 int main(int argc, char** argv) {
     const unordered_map<std::string_view, std::function<int(void)>> tests{
 		{"CTTI",&Test_CTTI},
@@ -427,7 +2797,54 @@ int main(int argc, char** argv) {
         {"Test_AddDel",&Test_AddDel},
         {"Test_SpawnDestroy",&Test_SpawnDestroy},
         {"Test_CheckGraph",&Test_CheckGraph},
-        {"Test_DataProviders", &Test_DataProviders}
+        {"Test_DataProviders", &Test_DataProviders},
+        {"Test_ParallelFilter", &Test_ParallelFilter},
+        {"Test_OwningGroup", &Test_OwningGroup},
+        {"Test_ChangeTracking", &Test_ChangeTracking},
+        {"Test_CommandBuffer", &Test_CommandBuffer},
+        {"Test_BulkCreate", &Test_BulkCreate},
+        {"Test_PagedSparseArray", &Test_PagedSparseArray},
+        {"Test_AutoSchedule", &Test_AutoSchedule},
+        {"Test_DeferredTransforms", &Test_DeferredTransforms},
+        {"Test_TransformBatch", &Test_TransformBatch},
+        {"Test_SpatialIndex", &Test_SpatialIndex},
+        {"Test_PolymorphicQuery", &Test_PolymorphicQuery},
+        {"Test_TimerWheel", &Test_TimerWheel},
+        {"Test_TweenManager", &Test_TweenManager},
+        {"Test_ADPCM", &Test_ADPCM},
+        {"Test_WorldSnapshot", &Test_WorldSnapshot},
+        {"Test_ParallelWorldTicks", &Test_ParallelWorldTicks},
+        {"Test_OffsetAllocator", &Test_OffsetAllocator},
+        {"Test_ShadowAtlasAllocator", &Test_ShadowAtlasAllocator},
+        {"Test_DirtyBitset", &Test_DirtyBitset},
+        {"Test_DynamicResolution", &Test_DynamicResolution},
+        {"Test_TextureStreamingBudget", &Test_TextureStreamingBudget},
+        {"Test_ReplicationDelta", &Test_ReplicationDelta},
+        {"Test_RPCBatch", &Test_RPCBatch},
+        {"Test_NetworkIDTable", &Test_NetworkIDTable},
+        {"Test_CompactRPC", &Test_CompactRPC},
+        {"Test_SpawnBatch", &Test_SpawnBatch},
+        {"Test_AssetPack", &Test_AssetPack},
+        {"Test_MeshEncoding", &Test_MeshEncoding},
+        {"Test_KTX2", &Test_KTX2},
+        {"Test_FrameArena", &Test_FrameArena},
+        {"Test_SpinLock", &Test_SpinLock},
+        {"Test_AmortizedSystem", &Test_AmortizedSystem},
+        {"Test_SmallFunction", &Test_SmallFunction},
+        {"Test_CachedComponentHandle", &Test_CachedComponentHandle},
+        {"Test_SortedVectorMap", &Test_SortedVectorMap},
+        {"Test_SmallVector", &Test_SmallVector},
+        {"Test_DequeueAllInto", &Test_DequeueAllInto},
+        {"Test_StringID", &Test_StringID},
+        {"Test_FilterSmallestSet", &Test_FilterSmallestSet},
+        {"Test_ScriptBatches", &Test_ScriptBatches},
+        {"Test_VRAMBudget", &Test_VRAMBudget},
+        {"Test_ImpostorEncoding", &Test_ImpostorEncoding},
+        {"Test_WorldStreamingCells", &Test_WorldStreamingCells},
+        {"Test_EntityPool", &Test_EntityPool},
+        {"Test_Heightfield", &Test_Heightfield},
+        {"Test_AudioGraphFusion", &Test_AudioGraphFusion},
+        {"Test_PerfCounters", &Test_PerfCounters}
     };
 
     if (argc < 2){
@@ -5,6 +5,25 @@
 #include <typeinfo>
 #include <RavEngine/AnimatorComponent.hpp>
 #include <RavEngine/unordered_vector.hpp>
+#include <RavEngine/App.hpp>
+#include <RavEngine/World.hpp>
+#include <RavEngine/GameObject.hpp>
+#include <RavEngine/Transform.hpp>
+#include <RavEngine/ComponentHandle.hpp>
+#include <RavEngine/SparseSet.hpp>
+#include <RavEngine/Queue.hpp>
+#include <optional>
+#include <RavEngine/Queryable.hpp>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <btree.h>
 
 using namespace RavEngine;
 using namespace std;
@@ -14,154 +33,548 @@ const std::string_view RVE_VFS_get_name(){
     return "";
 }
 
-static std::chrono::system_clock timer;
+// set with --warmup and --reps
+static int warmupRuns = 1;
+static int repetitions = 5;
+
+struct BenchmarkResult{
+	std::string name;
+	uint64_t operations;			// per repetition
+	std::vector<double> samples;	// microseconds, one per repetition
+};
+static std::vector<BenchmarkResult> results;
+
+struct BenchmarkStats{
+	double min = 0, median = 0, mean = 0, stddev = 0, max = 0;
+};
+
+static BenchmarkStats statsOf(std::vector<double> samples){
+	BenchmarkStats stats;
+	if (samples.empty()){
+		return stats;
+	}
+	std::sort(samples.begin(), samples.end());
+	stats.min = samples.front();
+	stats.max = samples.back();
+	const auto mid = samples.size() / 2;
+	stats.median = samples.size() % 2 == 1 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+	for(const auto sample : samples){
+		stats.mean += sample;
+	}
+	stats.mean /= samples.size();
+	for(const auto sample : samples){
+		stats.stddev += (sample - stats.mean) * (sample - stats.mean);
+	}
+	stats.stddev = std::sqrt(stats.stddev / samples.size());
+	return stats;
+}
+
+static double toMicroseconds(clocktype::duration dur){
+	return double(chrono::duration_cast<std::chrono::nanoseconds>(dur).count()) / 1000.0;
+}
+
+static void report(const BenchmarkResult& result){
+	const auto stats = statsOf(result.samples);
+	const auto nsPerOp = result.operations > 0 ? (stats.median * 1000.0) / result.operations : 0.0;
+	cout << Format("{:<56} median {:>11.1f} µs  min {:>11.1f}  max {:>11.1f}  sd {:>9.1f}  ({:.2f} ns/op)\n", result.name, stats.median, stats.min, stats.max, stats.stddev, nsPerOp);
+}
+
+static void writeJSON(std::ostream& out){
+	out << Format("{{\n  \"warmup\": {},\n  \"repetitions\": {},\n  \"benchmarks\": [\n", warmupRuns, repetitions);
+	for(size_t i = 0; i < results.size(); i++){
+		const auto& r = results[i];
+		const auto stats = statsOf(r.samples);
+		const auto nsPerOp = r.operations > 0 ? (stats.median * 1000.0) / r.operations : 0.0;
+		out << Format("    {{\"name\": \"{}\", \"operations\": {}, \"samples\": {}, \"min_us\": {:.3f}, \"median_us\": {:.3f}, \"mean_us\": {:.3f}, \"stddev_us\": {:.3f}, \"max_us\": {:.3f}, \"ns_per_op\": {:.3f}}}{}\n", r.name, r.operations, r.samples.size(), stats.min, stats.median, stats.mean, stats.stddev, stats.max, nsPerOp, i + 1 < results.size() ? "," : "");
+	}
+	out << "  ]\n}\n";
+}
+
+// one repetition's clock. The body starts and stops it around the measured part, so that its setup is not counted.
+struct Stopwatch{
+	clocktype::time_point begin;
+	clocktype::duration elapsed{0};
+
+	void start(){
+		begin = clocktype::now();
+	}
+	void stop(){
+		elapsed += clocktype::now() - begin;
+	}
+};
+
+/**
+ Run body warmupRuns times untimed, then repetitions times, recording each repetition
+ @param operations the number of operations in one repetition, for ns/op
+ @param body called with a Stopwatch to start and stop
+ */
+template<typename F>
+static void bench(std::string name, uint64_t operations, const F& body){
+	BenchmarkResult result{std::move(name), operations};
+	for(int i = 0; i < warmupRuns + repetitions; i++){
+		Stopwatch stopwatch;
+		body(stopwatch);
+		if (i >= warmupRuns){
+			result.samples.push_back(toMicroseconds(stopwatch.elapsed));
+		}
+	}
+	report(result);
+	results.push_back(std::move(result));
+}
+
+// for the benchmarks that are too expensive to repeat
+static inline void record(std::string_view name, uint64_t operations, clocktype::duration dur){
+	results.push_back({std::string(name), operations, {toMicroseconds(dur)}});
+}
 
 template<typename T>
 static inline clocktype::duration time(const T& func){
-	auto begin_time = timer.now();
+	auto begin_time = clocktype::now();
 	func();
-	auto end_time = timer.now();
-	return chrono::duration_cast<std::chrono::microseconds>(end_time - begin_time);
+	return clocktype::now() - begin_time;
 }
 
-template<typename T, typename is_fn, typename es_fn>
-static inline void do_test(const T& ds, const is_fn& insert_func, const es_fn& erase_func){
-	
-	auto dur = time([&]{
-		// time to add 100K elements
-		for(int i = 0; i < 100'000; i++){
-			insert_func(i);
+// container matrix. Each adapter wraps a container with insert and erase by int, and exposes it for iteration.
+
+template<typename T>
+struct ByValue{
+	T container;
+	void insert(int i){ container.insert(i); }
+	void erase(int i){ container.erase(i); }
+};
+
+template<typename T>
+struct ByKey{
+	T container;
+	void insert(int i){ container.emplace(i, i); }
+	void erase(int i){ container.erase(i); }
+};
+
+// erasing by value searches the whole vector, as the engine's vectors must
+template<typename T>
+struct SequenceByValue{
+	T container;
+	void insert(int i){ container.push_back(i); }
+	void erase(int i){ container.erase(std::remove(container.begin(), container.end(), i), container.end()); }
+};
+
+// when the caller knows the element's position
+struct UnorderedVectorByPosition{
+	unordered_vector<int> container;
+	void insert(int i){ container.insert(i); }
+	void erase(int i){ container.erase(container.begin() + i); }
+};
+
+// colonies and lists are erased through the iterators that inserting returned, as their users do
+template<typename T>
+struct ByIterator{
+	T container;
+	std::vector<typename T::iterator> iterators;
+	void insert(int i){
+		if constexpr (requires{ container.insert(i); }){
+			iterators.push_back(container.insert(i));
 		}
-	});
-	cout << Format("Time to add {} elements: {} µs\n",ds.size(), dur.count()/100);
-	
-	// time to remove elements from the middle
-	dur = time([&]{
-		for (int i = 50'000; i < 51'000; i++){
-			erase_func(i);
+		else{
+			iterators.push_back(container.insert(container.end(), i));
 		}
-	});
-	cout << Format("Time to remove {} elements: {} µs\n",1'000, dur.count()/100);
-    
-    // time to iterate 90*10 times (10 seconds worth of ticking on default)
-    constexpr auto iter_count = 90*10;
-    uint64_t sum = 0;
-    dur = time([&]{
-        for(int i = 0; i < iter_count; i++){
-            for(const auto& elem : ds){
-                sum += elem;                // calculate a sum so the compiler doesn't optimize this
-            }
-        }
-    });
-    cout << Format("Time to iterate {} times: {} µs (sum = {})\n",iter_count, dur.count()/100,sum);
-    
+	}
+	void erase(int i){ container.erase(iterators[i]); }
+};
+
+struct SparseSetByEntity{
+	UnorderedSparseSet<entity_id_t, int> container;
+	void insert(int i){ container.Emplace(i, i); }
+	void erase(int i){ container.EraseAtSparseIndex(i); }
+};
+
+template<typename T>
+static inline uint64_t valueOf(const T& value){
+	return uint64_t(value);
 }
 
+template<typename K, typename V>
+static inline uint64_t valueOf(const std::pair<K, V>& value){
+	return uint64_t(value.second);
+}
 
-int main(int argc, const char** argv){
-	
-	// STL vector
-	{
-		cout<<"STL vector\n";
-		std::vector<int> vec;
-		
-		do_test(vec,[&](int i){
-			vec.push_back(i);
-		},[&](int i){
-			vec.erase(std::remove(vec.begin(),vec.end(),i),vec.end());
+static constexpr uint32_t containerSizes[] = {1'000, 10'000, 100'000};
+
+template<typename Adapter>
+static void container_bench(std::string_view name){
+	for(const auto n : containerSizes){
+		bench(Format("{}/{}/insert", name, n), n, [&](Stopwatch& stopwatch){
+			Adapter adapter;
+			stopwatch.start();
+			for(uint32_t i = 0; i < n; i++){
+				adapter.insert(i);
+			}
+			stopwatch.stop();
 		});
-	}
-	
-	// ozz vector
-	{
-		cout << "\nozz vector\n";
-		ozz::vector<int> vec;
-		
-		do_test(vec,[&](int i){
-			vec.push_back(i);
-		},[&](int i){
-			vec.erase(std::remove(vec.begin(),vec.end(),i),vec.end());
+
+		// from the middle, where vectors have the most to shift
+		const uint32_t numErased = std::min<uint32_t>(n / 10, 1'000);
+		const uint32_t firstErased = n / 2 - numErased / 2;
+		bench(Format("{}/{}/erase", name, n), numErased, [&](Stopwatch& stopwatch){
+			Adapter adapter;
+			for(uint32_t i = 0; i < n; i++){
+				adapter.insert(i);
+			}
+			stopwatch.start();
+			for(uint32_t i = firstErased; i < firstErased + numErased; i++){
+				adapter.erase(i);
+			}
+			stopwatch.stop();
 		});
-	}
-	
-	{
-		cout << "\nunordered_vector\n";
-		unordered_vector<int> vec;
-		do_test(vec,[&](int i){
-			vec.insert(i);
-		},[&](int i){
-			vec.erase(i);
+
+		Adapter adapter;
+		for(uint32_t i = 0; i < n; i++){
+			adapter.insert(i);
+		}
+		constexpr auto iter_count = 100;
+		uint64_t sum = 0;
+		bench(Format("{}/{}/iterate", name, n), uint64_t(iter_count) * n, [&](Stopwatch& stopwatch){
+			stopwatch.start();
+			for(int i = 0; i < iter_count; i++){
+				for(const auto& elem : adapter.container){
+					sum += valueOf(elem);		// so the compiler doesn't optimize this out
+				}
+			}
+			stopwatch.stop();
 		});
+		if (sum == 0){
+			cout << "\t(sum = 0)\n";
+		}
 	}
-	
-	{
-		cout << ("\nunordered_vector with known iterators\n");
-		unordered_vector<int> vec;
-		do_test(vec,[&](int i){
-			vec.insert(i);
-		},[&](int i){
-			vec.erase(vec.begin() + i);
+}
+
+// producers enqueue one item at a time while this thread drains, as the engine's gc and event queues are used
+template<bool bulk>
+static void queue_bench(uint32_t numProducers){
+	for(const auto n : containerSizes){
+		const uint32_t perProducer = n / numProducers;
+		const uint32_t total = perProducer * numProducers;
+		bench(Format("concurrent_queue/{}/{}_producers/{}", n, numProducers, bulk ? "dequeue_bulk" : "dequeue"), total, [&](Stopwatch& stopwatch){
+			ConcurrentQueue<int> queue;
+			std::atomic<bool> go = false;
+			std::vector<std::thread> producers;
+			for(uint32_t p = 0; p < numProducers; p++){
+				producers.emplace_back([&]{
+					while (!go.load(std::memory_order_acquire)){}
+					for(uint32_t i = 0; i < perProducer; i++){
+						queue.enqueue(int(i));
+					}
+				});
+			}
+			std::array<int, 64> batch;
+			uint64_t sum = 0;
+			uint32_t received = 0;
+			stopwatch.start();
+			go.store(true, std::memory_order_release);
+			while (received < total){
+				if constexpr (bulk){
+					const auto count = queue.try_dequeue_bulk(batch.begin(), batch.size());
+					for(size_t i = 0; i < count; i++){
+						sum += batch[i];
+					}
+					received += count;
+				}
+				else{
+					int item;
+					if (queue.try_dequeue(item)){
+						sum += item;
+						received++;
+					}
+				}
+			}
+			stopwatch.stop();
+			for(auto& producer : producers){
+				producer.join();
+			}
+			if (sum == 0){
+				cout << "\t(sum = 0)\n";
+			}
 		});
 	}
-    
-    {
-        cout << ("\nstd::unordered_set\n");
-        std::unordered_set<int> vec;
-        do_test(vec,[&](int i){
-            vec.insert(i);
-        },[&](int i){
-            vec.erase(i);
-        });
-    }
-	
+}
+
+// many tiny lists, as in per-entity child lists: build them, then sum them repeatedly
+template<typename T>
+static inline void do_small_list_test(std::string_view name){
+	constexpr int num_lists = 100'000;
+	bench(Format("{}/build", name), num_lists, [&](Stopwatch& stopwatch){
+		std::vector<T> lists;
+		stopwatch.start();
+		lists.resize(num_lists);
+		for(int i = 0; i < num_lists; i++){
+			for(int j = 0; j < i % 5; j++){     // 0 to 4 elements
+				lists[i].push_back(j);
+			}
+		}
+		stopwatch.stop();
+	});
+
+	std::vector<T> lists(num_lists);
+	for(int i = 0; i < num_lists; i++){
+		for(int j = 0; j < i % 5; j++){
+			lists[i].push_back(j);
+		}
+	}
+	constexpr auto iter_count = 90;
+	uint64_t sum = 0;
+	bench(Format("{}/iterate", name), uint64_t(iter_count) * num_lists, [&](Stopwatch& stopwatch){
+		stopwatch.start();
+		for(int i = 0; i < iter_count; i++){
+			for(const auto& list : lists){
+				for(const auto& elem : list){
+					sum += elem;
+				}
+			}
+		}
+		stopwatch.stop();
+	});
+	if (sum == 0){
+		cout << "\t(sum = 0)\n";
+	}
+}
+
+// ECS benchmarks
+
+template<int N>
+struct BenchComponent{
+	float value = N;
+};
+
+struct BenchPolyBase : public AutoCTTI{
+	virtual float Get() const = 0;
+	virtual ~BenchPolyBase(){}
+};
+
+struct BenchPolyA : public BenchPolyBase, public Queryable<BenchPolyA, BenchPolyBase>{
+	float Get() const override{ return 1; }
+};
+
+struct BenchPolyB : public BenchPolyBase, public Queryable<BenchPolyB, BenchPolyBase>{
+	float Get() const override{ return 2; }
+};
+
+struct BenchWrite0System{
+	void operator()(BenchComponent<0>& c){ c.value += 1; }
+};
+struct BenchWrite1System{
+	void operator()(BenchComponent<1>& c){ c.value += 1; }
+};
+struct BenchRead0Write2System{
+	void operator()(const BenchComponent<0>& a, BenchComponent<2>& b){ b.value = a.value; }
+};
+struct BenchRead1Write3System{
+	void operator()(const BenchComponent<1>& a, BenchComponent<3>& b){ b.value = a.value; }
+};
+
+static constexpr entity_id_t ecs_entity_count = 100'000;
+static constexpr int ecs_iter_count = 100;
+
+static void ecs_report(std::string_view name, uint64_t operations, clocktype::duration dur){
+	cout << Format("{}: {} ops in {} µs\n", name, operations, chrono::duration_cast<std::chrono::microseconds>(dur).count());
+	record(name, operations, dur);
+}
+
+template<int ... Ns>
+static void ecs_filter_arity(World& world, std::integer_sequence<int, Ns...>){
+	float sum = 0;
+	auto dur = time([&]{
+		for(int i = 0; i < ecs_iter_count; i++){
+			world.Filter([&](BenchComponent<Ns>& ... c){
+				sum += (c.value + ...);
+			});
+		}
+	});
+	ecs_report(Format("ecs/filter_arity_{}", sizeof...(Ns)), uint64_t(ecs_iter_count) * ecs_entity_count, dur);
+	cout << Format("\t(sum = {})\n", sum);
+}
+
+static void ecs_benchmarks(){
+	cout << "\nECS\n";
+
+	// entity lifetime
 	{
-		cout << ("\nlocked_hashset std::mutex\n");
-		locked_hashset<int> set;
-		do_test(set, [&](int i){
-			set.insert(i);
-		}, [&](int i){
-			set.erase(i);
+		World world;
+		Vector<Entity> entities;
+		entities.reserve(ecs_entity_count);
+		auto dur = time([&]{
+			for(entity_id_t i = 0; i < ecs_entity_count; i++){
+				entities.push_back(world.Instantiate<Entity>());
+			}
 		});
+		ecs_report("ecs/create_entity", ecs_entity_count, dur);
+
+		dur = time([&]{
+			for(auto& e : entities){
+				e.Destroy();
+			}
+		});
+		ecs_report("ecs/destroy_entity", ecs_entity_count, dur);
+
+		Vector<entity_t> ids;
+		dur = time([&]{
+			ids = world.CreateEntities(ecs_entity_count);
+		});
+		ecs_report("ecs/create_entities_bulk", ecs_entity_count, dur);
 	}
-	// flat hashset with lock
+
+	// component churn
 	{
-		cout << ("\nlocked_hashset Spinlock\n");
-		locked_hashset<int,SpinLock> set;
-		do_test(set, [&](int i){
-			set.insert(i);
-		}, [&](int i){
-			set.erase(i);
+		World world;
+		Vector<Entity> entities;
+		for(entity_id_t i = 0; i < ecs_entity_count; i++){
+			entities.push_back(world.Instantiate<Entity>());
+		}
+		constexpr auto rounds = 10;
+		auto dur = time([&]{
+			for(int r = 0; r < rounds; r++){
+				for(auto& e : entities){
+					e.EmplaceComponent<BenchComponent<0>>();
+				}
+				for(auto& e : entities){
+					e.DestroyComponent<BenchComponent<0>>();
+				}
+			}
 		});
+		ecs_report("ecs/emplace_destroy_component", uint64_t(rounds) * ecs_entity_count * 2, dur);
 	}
-	// flat hashset with no mutex
+
+	// queries
 	{
-		cout << ("\nphmap::flat_hashset\n");
-		phmap::flat_hash_set<int> set;
-		do_test(set, [&](int i){
-			set.insert(i);
-		}, [&](int i){
-			set.erase(i);
+		World world;
+		for(entity_id_t i = 0; i < ecs_entity_count; i++){
+			auto e = world.Instantiate<Entity>();
+			e.EmplaceComponent<BenchComponent<0>>();
+			e.EmplaceComponent<BenchComponent<1>>();
+			e.EmplaceComponent<BenchComponent<2>>();
+			e.EmplaceComponent<BenchComponent<3>>();
+			if (i % 2 == 0){
+				e.EmplaceComponent<BenchPolyA>();
+			}
+			else{
+				e.EmplaceComponent<BenchPolyB>();
+			}
+		}
+		ecs_filter_arity(world, std::integer_sequence<int, 0>{});
+		ecs_filter_arity(world, std::integer_sequence<int, 0, 1>{});
+		ecs_filter_arity(world, std::integer_sequence<int, 0, 1, 2>{});
+		ecs_filter_arity(world, std::integer_sequence<int, 0, 1, 2, 3>{});
+
+		float sum = 0;
+		auto dur = time([&]{
+			for(int i = 0; i < ecs_iter_count; i++){
+				world.FilterPolymorphic([&](const BenchPolyBase& item){
+					sum += item.Get();
+				});
+			}
+		});
+		ecs_report("ecs/filter_polymorphic", uint64_t(ecs_iter_count) * ecs_entity_count, dur);
+		cout << Format("\t(sum = {})\n", sum);
+
+		// system graph execution
+		world.SetAutomaticSystemScheduling(true);
+		world.EmplaceSystem<BenchWrite0System>();
+		world.EmplaceSystem<BenchWrite1System>();
+		world.EmplaceSystem<BenchRead0Write2System>();
+		world.EmplaceSystem<BenchRead1Write3System>();
+		world.Tick(1);	// build and validate the graph outside of the timed section
+		dur = time([&]{
+			for(int i = 0; i < ecs_iter_count; i++){
+				world.Tick(1);
+			}
 		});
+		ecs_report("ecs/system_graph_tick", ecs_iter_count, dur);
 	}
-	// node hashset
+
+	// transform hierarchy propagation
 	{
-		cout << ("\nlocked_node_hashset spinlock\n");
-		locked_node_hashset<int,SpinLock> set;
-		do_test(set, [&](int i){
-			set.insert(i);
-		}, [&](int i){
-			set.erase(i);
+		World world;
+		constexpr auto nRoots = 1'000;
+		constexpr auto depth = 8;
+		Vector<GameObject> roots;
+		for(int i = 0; i < nRoots; i++){
+			auto root = world.Instantiate<GameObject>();
+			auto parent = root;
+			for(int d = 0; d < depth; d++){
+				auto child = world.Instantiate<GameObject>();
+				parent.GetTransform().AddChild(ComponentHandle<Transform>(child));
+				parent = child;
+			}
+			roots.push_back(root);
+		}
+		auto dur = time([&]{
+			for(int i = 0; i < ecs_iter_count; i++){
+				for(auto& root : roots){
+					root.GetTransform().LocalTranslateDelta(vector3(1, 0, 0));
+				}
+			}
 		});
+		ecs_report("ecs/transform_propagation", uint64_t(ecs_iter_count) * nRoots * (depth + 1), dur);
+	}
+}
+
+int main(int argc, const char** argv){
+	// --json <path> writes machine-readable results, use - for stdout
+	// --warmup <n> and --reps <n> set the untimed and timed runs of each benchmark
+	std::optional<std::string> jsonPath;
+	for(int i = 1; i < argc; i++){
+		const std::string_view arg(argv[i]);
+		if (arg == "--json" && i + 1 < argc){
+			jsonPath = argv[++i];
+		}
+		else if (arg == "--warmup" && i + 1 < argc){
+			warmupRuns = std::max(std::atoi(argv[++i]), 0);
+		}
+		else if (arg == "--reps" && i + 1 < argc){
+			repetitions = std::max(std::atoi(argv[++i]), 1);
+		}
+	}
+	
+	cout << "Containers\n";
+	container_bench<SequenceByValue<std::vector<int>>>("std_vector");
+	container_bench<SequenceByValue<ozz::vector<int>>>("ozz_vector");
+	container_bench<ByValue<unordered_vector<int>>>("unordered_vector");
+	container_bench<UnorderedVectorByPosition>("unordered_vector_position_erase");
+	container_bench<ByIterator<Colony<int>>>("colony");
+	container_bench<ByIterator<LinkedList<int>>>("plf_list");
+	container_bench<SparseSetByEntity>("unordered_sparse_set");
+	container_bench<ByValue<std::unordered_set<int>>>("std_unordered_set");
+	container_bench<ByValue<phmap::flat_hash_set<int>>>("flat_hash_set");
+	container_bench<ByValue<phmap::node_hash_set<int>>>("node_hash_set");
+	container_bench<ByValue<locked_hashset<int>>>("locked_hashset_mutex");
+	container_bench<ByValue<locked_hashset<int, SpinLock>>>("locked_hashset_spinlock");
+	container_bench<ByKey<std::map<int, int>>>("std_map");
+	container_bench<ByKey<phmap::flat_hash_map<int, int>>>("flat_hash_map");
+	container_bench<ByKey<phmap::node_hash_map<int, int>>>("node_hash_map");
+	container_bench<ByKey<phmap::btree_map<int, int>>>("btree_map");
+
+	cout << "\nConcurrentQueue\n";
+	for(const uint32_t producers : {1u, 4u}){
+		queue_bench<false>(producers);
+		queue_bench<true>(producers);
 	}
-	// node hashset no lock
+
+	cout << "\nSmall lists\n";
+	do_small_list_test<std::vector<int>>("small_lists_std_vector");
+	do_small_list_test<SmallVector<int, 4>>("small_lists_small_vector");
+	do_small_list_test<SmallVector<int, 2>>("small_lists_small_vector_2");
+
 	{
-		cout << ("\nlocked_node_hashset no lock\n");
-		phmap::node_hash_set<int> set;
-		do_test(set, [&](int i){
-			set.insert(i);
-		}, [&](int i){
-			set.erase(i);
-		});
+		RavEngine::App app;
+		ecs_benchmarks();
+	}
+
+	if (jsonPath){
+		if (jsonPath.value() == "-"){
+			writeJSON(cout);
+		}
+		else{
+			std::ofstream out(jsonPath.value());
+			writeJSON(out);
+		}
 	}
 	
 	return 0;
@@ -0,0 +1,490 @@
+#include <RavEngine/App.hpp>
+#include <RavEngine/World.hpp>
+#include <RavEngine/GameObject.hpp>
+#include <RavEngine/NetworkManager.hpp>
+#include <RavEngine/NetworkServer.hpp>
+#include <RavEngine/RPCComponent.hpp>
+#include <RavEngine/RPCMsgUnpacker.hpp>
+#include <RavEngine/RPCBatch.hpp>
+#include <RavEngine/ReplicationComponent.hpp>
+#include <RavEngine/SpawnBatch.hpp>
+#include <RavEngine/SystemInfo.hpp>
+#include <RavEngine/Format.hpp>
+#include <RavEngine/StartApp.hpp>
+#include <steam/isteamnetworkingsockets.h>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace RavEngine;
+using namespace std;
+
+// needed for linker
+const std::string_view RVE_VFS_get_name(){
+	return "";
+}
+
+// the workload. Bots and entities are placed from these alone, so every run sends the same traffic.
+struct BenchConfig{
+	uint32_t bots = 32;
+	uint32_t botThreads = 1;		// the bots are split evenly over these
+	uint32_t entities = 256;		// networked entities on the server, each moved and replicated every tick
+	double rpcRate = 10;			// pings each bot sends a second
+	bool reliableRPCs = false;
+	double tickRate = 30;
+	double warmupSeconds = 2;		// not recorded, so connections and world synchronization settle first
+	double seconds = 10;
+	uint16_t port = 27015;
+	bool serve = true;				// run the server in this process
+	std::string address = "127.0.0.1";
+	std::optional<std::string> jsonPath;
+};
+static BenchConfig config;
+
+static constexpr auto worldName = "netbench";		// exactly World::id_size characters, so the bots can send it as is
+
+enum BenchRPC : uint16_t {
+	Ping = 1,		// to the server, carrying the time the bot sent it
+	Pong			// back to the bot that pinged, with the same time
+};
+
+// set by the world once warmup is over, and read by the bots
+static std::atomic<bool> recording = false;
+
+struct SampleStats{
+	double min = 0, median = 0, mean = 0, p90 = 0, p99 = 0, max = 0;
+};
+
+static SampleStats statsOf(std::vector<double> samples){
+	SampleStats stats;
+	if (samples.empty()){
+		return stats;
+	}
+	std::sort(samples.begin(), samples.end());
+	stats.min = samples.front();
+	stats.max = samples.back();
+	const auto mid = samples.size() / 2;
+	stats.median = samples.size() % 2 == 1 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+	for(const auto sample : samples){
+		stats.mean += sample;
+	}
+	stats.mean /= samples.size();
+	stats.p90 = samples[std::min(samples.size() - 1, size_t(samples.size() * 0.9))];
+	stats.p99 = samples[std::min(samples.size() - 1, size_t(samples.size() * 0.99))];
+	return stats;
+}
+
+static std::string statsJSON(const std::vector<double>& samples){
+	const auto stats = statsOf(samples);
+	return Format("{{\"min\": {:.4f}, \"median\": {:.4f}, \"mean\": {:.4f}, \"p90\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f}}}", stats.min, stats.median, stats.mean, stats.p90, stats.p99, stats.max);
+}
+
+static uint64_t NowNs(){
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(clocktype::now().time_since_epoch()).count();
+}
+
+static NetworkBase::Reliability RPCReliability(){
+	return config.reliableRPCs ? NetworkBase::Reliability::Reliable : NetworkBase::Reliability::Unreliable;
+}
+
+// on the server, answers pings and replicates its position, which moves every tick
+struct BenchEntity : public GameObject{
+	void Create(){
+		GameObject::Create();
+		GameObject self = *this;
+		auto& rpc = EmplaceComponent<RPCComponent>();
+		rpc.RegisterServerRPC(Ping, [self](RPCMsgUnpacker& msg, HSteamNetConnection origin){
+			if (auto args = msg.Unpack<uint64_t>()){
+				self.GetComponent<RPCComponent>().InvokeClientRPCDirected(Pong, origin, RPCReliability(), uint64_t(std::get<0>(*args)));
+			}
+		}, RPCComponent::Directionality::Bidirectional);
+		rpc.RegisterClientRPC(Pong, [](RPCMsgUnpacker&, HSteamNetConnection){});
+		rpc.CompactRPC(Pong);
+		EmplaceComponent<ReplicationComponent>().ReplicateField<vector3>([self]() mutable {
+			return self.GetTransform().GetLocalPosition();
+		}, [](const vector3&){});
+	}
+};
+
+/**
+ Headless clients, which speak the wire protocol directly on one thread instead of each running a NetworkClient, because an App
+ has only one. Each connects, synchronizes the world, acknowledges every snapshot, and pings the entities it was spawned round robin.
+ */
+class BotSwarm{
+	struct Bot{
+		HSteamNetConnection connection = k_HSteamNetConnection_Invalid;
+		bool synchronizing = false;
+		Vector<netid_t> entities;		// spawned on this bot
+		clocktype::time_point nextPing;
+		uint64_t pings = 0;
+	};
+	Vector<Bot> bots;
+	std::thread thread;
+	std::atomic<bool> running = true;
+	Vector<SpawnBatch::Record> records;	// reused by OnMessage
+
+public:
+	// while recording, over every bot
+	std::vector<double> latencyMs;
+	uint64_t pingsSent = 0, pongsReceived = 0;
+	struct Traffic{
+		uint64_t bytesSent = 0, bytesReceived = 0;
+	};
+	Vector<Traffic> traffic;		// per bot
+
+	BotSwarm(uint32_t count){
+		auto net = SteamNetworkingSockets();
+		SteamNetworkingIPAddr address;
+		address.Clear();
+		if (!address.ParseString(config.address.c_str())){
+			Debug::Fatal("Invalid IP: {}", config.address);
+		}
+		address.m_port = config.port;
+		bots.resize(count);
+		traffic.resize(count);
+		for(auto& bot : bots){
+			bot.connection = net->ConnectByIPAddress(address, 0, nullptr);
+			if (bot.connection == k_HSteamNetConnection_Invalid){
+				Debug::Fatal("Cannot connect to {}:{}", config.address, config.port);
+			}
+		}
+		thread = std::thread(&BotSwarm::Run, this);
+	}
+
+	// disconnect the bots, and wait for the thread to exit
+	void Stop(){
+		running = false;
+		thread.join();
+		for(const auto& bot : bots){
+			SteamNetworkingSockets()->CloseConnection(bot.connection, 0, "Benchmark finished", false);
+		}
+	}
+
+private:
+	void Send(uint32_t index, const std::string_view& msg, int flags){
+		SteamNetworkingSockets()->SendMessageToConnection(bots[index].connection, msg.data(), uint32_t(msg.size()), flags, nullptr);
+		if (recording){
+			traffic[index].bytesSent += msg.size();
+		}
+	}
+
+	void Run(){
+		auto net = SteamNetworkingSockets();
+		const auto pingInterval = std::chrono::duration_cast<clocktype::duration>(std::chrono::duration<double>(1.0 / std::max(config.rpcRate, 0.001)));
+		Array<SteamNetworkingMessage_t*, 64> received;
+		while(running){
+			bool idle = true;
+			const auto now = clocktype::now();
+			for(uint32_t i = 0; i < bots.size(); i++){
+				auto& bot = bots[i];
+				if (!bot.synchronizing){
+					SteamNetConnectionInfo_t info;
+					if (net->GetConnectionInfo(bot.connection, &info) && info.m_eState == k_ESteamNetworkingConnectionState_Connected){
+						char request[1 + World::id_size]{ 0 };
+						request[0] = NetworkBase::CommandCode::ClientRequestingWorldSynchronization;
+						std::memcpy(request + 1, worldName, World::id_size);
+						Send(i, std::string_view(request, sizeof(request)), k_nSteamNetworkingSend_Reliable);
+						bot.synchronizing = true;
+						// spread the bots' pings over the interval, so they do not all arrive on the same tick
+						bot.nextPing = now + pingInterval * i / bots.size();
+					}
+					continue;
+				}
+				int numMsgs;
+				while((numMsgs = net->ReceiveMessagesOnConnection(bot.connection, received.data(), int(received.size()))) > 0){
+					idle = false;
+					for(int m = 0; m < numMsgs; m++){
+						const std::string_view message((const char*)received[m]->m_pData, received[m]->m_cbSize);
+						if (recording){
+							traffic[i].bytesReceived += message.size();
+						}
+						OnMessage(i, message);
+						received[m]->Release();
+					}
+				}
+				if (config.rpcRate > 0 && !bot.entities.empty() && now >= bot.nextPing){
+					SendPing(i);
+					bot.nextPing += pingInterval;
+				}
+			}
+			if (idle){
+				// short, because the sleep is part of every latency sample
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+		}
+	}
+
+	void OnMessage(uint32_t index, const std::string_view& message){
+		if (message.empty()){
+			return;
+		}
+		auto& bot = bots[index];
+		switch(uint8_t(message[0])){
+		case NetworkBase::CommandCode::Spawn:
+			if (message.size() >= 1 + sizeof(ctti_t) + sizeof(netid_t)){
+				netid_t id;
+				std::memcpy(&id, message.data() + 1 + sizeof(ctti_t), sizeof(id));
+				bot.entities.push_back(id);
+			}
+			break;
+		case NetworkBase::CommandCode::SpawnBatch: {
+			std::string worldID;
+			records.clear();
+			if (SpawnBatch::Decode(message, worldID, records)){
+				for(const auto& record : records){
+					bot.entities.push_back(record.sessionID);
+				}
+			}
+		}
+			break;
+		case NetworkBase::CommandCode::Destroy:
+			if (message.size() >= 1 + sizeof(netid_t)){
+				netid_t id;
+				std::memcpy(&id, message.data() + 1, sizeof(id));
+				std::erase(bot.entities, id);
+			}
+			break;
+		case NetworkBase::CommandCode::Replicate:
+			// acknowledged like a real client, so the server encodes against it instead of sending full snapshots
+			if (message.size() >= 1 + sizeof(uint32_t)){
+				char ack[1 + sizeof(uint32_t)];
+				ack[0] = NetworkBase::CommandCode::ReplicationAck;
+				std::memcpy(ack + 1, message.data() + 1, sizeof(uint32_t));
+				Send(index, std::string_view(ack, sizeof(ack)), k_nSteamNetworkingSend_Unreliable);
+			}
+			break;
+		case NetworkBase::CommandCode::BatchedRPCs:
+			RPCBatch::Unpack(message, [this](const std::string_view& rpc){
+				OnRPC(rpc);
+			});
+			break;
+		case NetworkBase::CommandCode::RPC:
+		case NetworkBase::CommandCode::CompactRPC:
+			OnRPC(message);
+			break;
+		}
+	}
+
+	void OnRPC(const std::string_view& rpc){
+		if (rpc.size() < RPCMsgUnpacker::header_size){
+			return;
+		}
+		uint16_t id;
+		std::memcpy(&id, rpc.data() + RPCMsgUnpacker::code_offset, sizeof(id));
+		if (id != Pong || !recording){
+			return;
+		}
+		RPCMsgUnpacker unpacker(rpc);
+		if (auto args = unpacker.Unpack<uint64_t>()){
+			latencyMs.push_back(double(NowNs() - std::get<0>(*args)) / 1e6);
+			pongsReceived++;
+		}
+	}
+
+	// a compact RPC, laid out as RPCComponent::SerializeCompactRPC does
+	void SendPing(uint32_t index){
+		auto& bot = bots[index];
+		const auto target = bot.entities[bot.pings++ % bot.entities.size()];
+		const uint16_t id = Ping;
+		const auto signature = RPCMsgUnpacker::Signature<uint64_t>();
+		const auto sent = NowNs();
+		char msg[RPCMsgUnpacker::CompactSize<uint64_t>()]{ 0 };
+		msg[0] = NetworkBase::CommandCode::CompactRPC;
+		std::memcpy(msg + 1, &target, sizeof(target));
+		std::memcpy(msg + RPCMsgUnpacker::code_offset, &id, sizeof(id));
+		std::memcpy(msg + RPCMsgUnpacker::header_size, &signature, sizeof(signature));
+		std::memcpy(msg + RPCMsgUnpacker::header_size + sizeof(signature), &sent, sizeof(sent));
+		Send(index, std::string_view(msg, sizeof(msg)), config.reliableRPCs ? k_nSteamNetworkingSend_Reliable : k_nSteamNetworkingSend_Unreliable);
+		if (recording){
+			pingsSent++;
+		}
+	}
+};
+static Vector<std::unique_ptr<BotSwarm>> swarms;
+
+struct BenchWorld : public World{
+	Vector<GameObject> entities;
+	uint32_t tick = 0;
+	bool finished = false;
+	clocktype::time_point start, recordStart, nextMemorySample;
+
+	// while recording
+	std::vector<double> tickMs, residentMB;
+	NetworkStats statsAtRecordStart;
+
+	BenchWorld() : World(worldName){
+		if (!config.serve){
+			return;
+		}
+		for(uint32_t i = 0; i < config.entities; i++){
+			entities.push_back(Instantiate<BenchEntity>());
+		}
+	}
+
+	void PreTick(float fpsScale) final{
+		if (finished){
+			return;		// the quit is processed at the start of the next frame
+		}
+		const auto now = clocktype::now();
+		if (tick == 0){
+			start = now;
+		}
+		const auto elapsed = std::chrono::duration<double>(now - start).count();
+		if (!recording && elapsed >= config.warmupSeconds){
+			recordStart = nextMemorySample = now;
+			if (config.serve){
+				statsAtRecordStart = GetApp()->networkManager.server->GetStats();
+			}
+			recording = true;
+		}
+		else if (recording){
+			// the previous frame's tick, which is the last one that finished
+			tickMs.push_back(std::chrono::duration<double, std::milli>(GetApp()->GetLastTickDuration()).count());
+		}
+		if (recording && now >= nextMemorySample){
+			residentMB.push_back(double(SystemInfo::ProcessResidentMemory()) / (1024 * 1024));
+			nextMemorySample += std::chrono::seconds(1);
+		}
+
+		if (elapsed >= config.warmupSeconds + config.seconds){
+			recording = false;
+			for(auto& swarm : swarms){
+				swarm->Stop();
+			}
+			WriteResults(std::chrono::duration<double>(now - recordStart).count());
+			GetApp()->Quit();
+			finished = true;
+			return;
+		}
+
+		// every entity moves every tick, so each snapshot carries all of them
+		const auto t = float(tick) / float(std::max(config.tickRate, 1.0));
+		for(uint32_t i = 0; i < entities.size(); i++){
+			const auto angle = t + float(i);
+			entities[i].GetTransform().SetLocalPosition(vector3(std::cos(angle) * 10, 0, std::sin(angle) * 10));
+		}
+		tick++;
+	}
+
+	void WriteResults(double recordedSeconds){
+		const auto perSecond = [&](uint64_t bytes){
+			return double(bytes) / std::max(recordedSeconds, 1e-6);
+		};
+		std::string json = Format("{{\n  \"config\": {{\"bots\": {}, \"bot_threads\": {}, \"entities\": {}, \"rpc_rate\": {}, \"reliable_rpcs\": {}, \"tick_rate\": {}, \"warmup_seconds\": {}, \"seconds\": {}, \"serve\": {}}},\n",
+			config.bots, config.botThreads, config.serve ? config.entities : 0, config.rpcRate, config.reliableRPCs, config.tickRate, config.warmupSeconds, config.seconds, config.serve);
+		json += Format("  \"recorded_seconds\": {:.3f},\n", recordedSeconds);
+
+		// bandwidth is the server's view of each connection when it runs here, and the bots' otherwise
+		std::vector<double> sentPerClient, receivedPerClient;
+		if (config.serve){
+			const auto stats = GetApp()->networkManager.server->GetStats();
+			json += Format("  \"tick_ms\": {},\n", statsJSON(tickMs));
+			for(const auto& [connection, end] : stats.connections){
+				const auto it = statsAtRecordStart.connections.find(connection);
+				const auto& begin = it != statsAtRecordStart.connections.end() ? it->second.traffic : NetworkStats::Traffic{};
+				sentPerClient.push_back(perSecond(end.traffic.bytesSent - begin.bytesSent));
+				receivedPerClient.push_back(perSecond(end.traffic.bytesReceived - begin.bytesReceived));
+			}
+		}
+		else{
+			for(const auto& swarm : swarms){
+				for(const auto& bot : swarm->traffic){
+					sentPerClient.push_back(perSecond(bot.bytesReceived));
+					receivedPerClient.push_back(perSecond(bot.bytesSent));
+				}
+			}
+		}
+		double totalSent = 0;
+		for(const auto bytes : sentPerClient){
+			totalSent += bytes;
+		}
+		json += Format("  \"server_to_client_bytes_per_sec\": {},\n  \"client_to_server_bytes_per_sec\": {},\n  \"server_total_bytes_per_sec\": {:.1f},\n",
+			statsJSON(sentPerClient), statsJSON(receivedPerClient), totalSent);
+
+		std::vector<double> latencyMs;
+		uint64_t pingsSent = 0, pongsReceived = 0;
+		for(const auto& swarm : swarms){
+			latencyMs.insert(latencyMs.end(), swarm->latencyMs.begin(), swarm->latencyMs.end());
+			pingsSent += swarm->pingsSent;
+			pongsReceived += swarm->pongsReceived;
+		}
+		json += Format("  \"rpc\": {{\"sent\": {}, \"answered\": {}, \"latency_ms\": {}}},\n", pingsSent, pongsReceived, statsJSON(latencyMs));
+		json += Format("  \"resident_mb\": {}\n}}\n", statsJSON(residentMB));
+
+		if (!config.jsonPath || config.jsonPath.value() == "-"){
+			cout << json;
+		}
+		else{
+			std::ofstream out(config.jsonPath.value());
+			out << json;
+		}
+	}
+};
+
+struct NetBenchApp : public RavEngine::App {
+	void OnStartup(int argc, char** argv) final{
+		// --bots, --bot-threads and --entities <n> set the workload, --rpc-rate <hz> sets each bot's pings a second, --reliable sends them reliably
+		// --tick-rate <hz> sets the server's loop rate, --warmup and --seconds <s> set the unrecorded and recorded time
+		// --serve-only runs the server without bots, --connect <ip> runs only the bots against a server elsewhere, --port <n> sets its port
+		// --json <path> writes the results there instead of stdout
+		for(int i = 1; i < argc; i++){
+			const std::string_view arg(argv[i]);
+			const auto count = [&](uint32_t& value){
+				if (i + 1 < argc){
+					value = uint32_t(std::max(std::atoi(argv[++i]), 0));
+				}
+			};
+			const auto real = [&](double& value){
+				if (i + 1 < argc){
+					value = std::max(std::atof(argv[++i]), 0.0);
+				}
+			};
+			if (arg == "--bots") count(config.bots);
+			else if (arg == "--bot-threads") count(config.botThreads);
+			else if (arg == "--entities") count(config.entities);
+			else if (arg == "--rpc-rate") real(config.rpcRate);
+			else if (arg == "--reliable") config.reliableRPCs = true;
+			else if (arg == "--tick-rate") real(config.tickRate);
+			else if (arg == "--warmup") real(config.warmupSeconds);
+			else if (arg == "--seconds") real(config.seconds);
+			else if (arg == "--port" && i + 1 < argc) config.port = uint16_t(std::atoi(argv[++i]));
+			else if (arg == "--serve-only") config.bots = 0;
+			else if (arg == "--connect" && i + 1 < argc){
+				config.serve = false;
+				config.address = argv[++i];
+			}
+			else if (arg == "--json" && i + 1 < argc) config.jsonPath = argv[++i];
+		}
+
+		if (config.serve){
+			networkManager.RegisterNetworkedEntity<BenchEntity>();
+			networkManager.server = std::make_unique<NetworkServer>();
+			networkManager.server->Start(config.port);
+		}
+		else{
+			InitNetworking();
+		}
+		SetFixedTickRate(config.tickRate);
+		AddWorld(RavEngine::New<BenchWorld>());
+
+		const auto threads = std::clamp(config.botThreads, 1u, std::max(config.bots, 1u));
+		for(uint32_t i = 0; i < threads && config.bots > 0; i++){
+			// the first bots % threads swarms take one more bot each
+			swarms.push_back(std::make_unique<BotSwarm>(config.bots / threads + (i < config.bots % threads ? 1 : 0)));
+		}
+	}
+	bool NeedsAudio() const final{
+		return false;
+	}
+	void OnFatal(const std::string_view msg) final {
+		cerr << msg << endl;
+	}
+};
+
+START_APP(NetBenchApp)
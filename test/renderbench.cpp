@@ -0,0 +1,314 @@
+#include <RavEngine/App.hpp>
+#include <RavEngine/World.hpp>
+#include <RavEngine/GameObject.hpp>
+#include <RavEngine/StaticMesh.hpp>
+#include <RavEngine/MeshCollection.hpp>
+#include <RavEngine/BuiltinMaterials.hpp>
+#include <RavEngine/CameraComponent.hpp>
+#include <RavEngine/Light.hpp>
+#include <RavEngine/GUI.hpp>
+#include <RavEngine/RenderEngine.hpp>
+#include <RavEngine/Dialogs.hpp>
+#include <RavEngine/Format.hpp>
+#include <RavEngine/StartApp.hpp>
+#include <RGL/Device.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+
+using namespace RavEngine;
+using namespace std;
+
+// the workload. Everything is placed from these alone, without random numbers, so every run and machine draws the same frames.
+struct BenchConfig{
+	uint32_t staticMeshes = 4096;
+	uint32_t pointLights = 16;
+	uint32_t spotLights = 8;
+	uint32_t directionalLights = 1;
+	uint32_t guiDocuments = 1;
+	bool shadows = true;
+	uint32_t warmupFrames = 60;		// not recorded, so pipeline creation and streaming settle first
+	uint32_t frames = 600;
+	std::optional<std::string> jsonPath;
+};
+static BenchConfig config;
+
+struct SampleStats{
+	double min = 0, median = 0, mean = 0, p99 = 0, max = 0;
+};
+
+static SampleStats statsOf(std::vector<double> samples){
+	SampleStats stats;
+	if (samples.empty()){
+		return stats;
+	}
+	std::sort(samples.begin(), samples.end());
+	stats.min = samples.front();
+	stats.max = samples.back();
+	const auto mid = samples.size() / 2;
+	stats.median = samples.size() % 2 == 1 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+	for(const auto sample : samples){
+		stats.mean += sample;
+	}
+	stats.mean /= samples.size();
+	stats.p99 = samples[std::min(samples.size() - 1, size_t(samples.size() * 0.99))];
+	return stats;
+}
+
+static std::string statsJSON(const std::vector<double>& samples){
+	const auto stats = statsOf(samples);
+	return Format("{{\"min\": {:.4f}, \"median\": {:.4f}, \"mean\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f}}}", stats.min, stats.median, stats.mean, stats.p99, stats.max);
+}
+
+// a unit cube with a face per axis direction, so it has proper normals and tangents for lit shading
+static MeshPart MakeCube(){
+	MeshPart part;
+	part.attributes = { .position = true, .normal = true, .tangent = true, .bitangent = true, .uv0 = true };
+	const std::array<glm::vec3, 6> normals{ glm::vec3(1,0,0), glm::vec3(-1,0,0), glm::vec3(0,1,0), glm::vec3(0,-1,0), glm::vec3(0,0,1), glm::vec3(0,0,-1) };
+	for(const auto& normal : normals){
+		const auto tangent = std::abs(normal.y) > 0.5f ? glm::vec3(1, 0, 0) : glm::normalize(glm::cross(glm::vec3(0, 1, 0), normal));
+		const auto bitangent = glm::cross(normal, tangent);
+		const auto base = uint32_t(part.positions.size());
+		for(const auto& [u, v] : { std::pair{-1.f,-1.f}, {1.f,-1.f}, {1.f,1.f}, {-1.f,1.f} }){
+			part.positions.push_back((normal + tangent * u + bitangent * v) * 0.5f);
+			part.normals.push_back(normal);
+			part.tangents.push_back(tangent);
+			part.bitangents.push_back(bitangent);
+			part.uv0.push_back({ (u + 1) / 2, (v + 1) / 2 });
+		}
+		for(const auto index : { 0u, 1u, 2u, 0u, 2u, 3u }){
+			part.indices.push_back(base + index);
+		}
+	}
+	return part;
+}
+
+// the side of the square grid the meshes sit on, in meters
+static float SceneExtent(){
+	return std::ceil(std::sqrt(float(config.staticMeshes))) * 2;
+}
+
+// where the camera is on the given frame. It orbits the scene while rising and falling, so the visible set and the depth complexity change over the run.
+static std::pair<vector3, quaternion> CameraPathAt(uint32_t frame){
+	const auto t = float(frame) / float(std::max(config.warmupFrames + config.frames, 1u));
+	const auto angle = t * glm::two_pi<float>();
+	const auto radius = SceneExtent() * (0.35f + 0.15f * std::cos(angle * 3));
+	const auto position = vector3(std::cos(angle) * radius, 4 + 6 * (0.5f + 0.5f * std::sin(angle * 2)), std::sin(angle) * radius);
+	const auto target = vector3(std::cos(angle + 0.6f) * radius * 0.3f, 0, std::sin(angle + 0.6f) * radius * 0.3f);
+	return { position, glm::quatLookAt(glm::normalize(target - position), vector3(0, 1, 0)) };
+}
+
+struct BenchWorld : public World{
+	GameObject camera;
+	uint32_t frame = 0;
+	bool finished = false;
+	clocktype::time_point lastTick;
+
+	// one per recorded frame
+	std::vector<double> frameMs, renderSyncMs, encodeMs, gpuMs;
+	struct PassSamples{
+		std::vector<double> gpuMs;
+		uint64_t draws = 0, dispatches = 0;		// summed over the recorded frames
+	};
+	std::map<std::string, PassSamples> passes;
+	Vector<std::string> passOrder;
+
+	BenchWorld(){
+		const auto extent = SceneExtent();
+		const auto gridSide = uint32_t(std::ceil(std::sqrt(float(config.staticMeshes))));
+
+		auto cube = New<MeshCollectionStatic>(New<MeshAsset>(MakeCube()));
+		auto floorMaterial = New<PBRMaterialInstance>(Material::Manager::Get<PBRMaterial>());
+		floorMaterial->SetAlbedoColor({ 0.5, 0.5, 0.5, 1 });
+		auto floor = Instantiate<GameObject>();
+		floor.EmplaceComponent<StaticMesh>(cube, floorMaterial);
+		floor.GetTransform().SetLocalScale(vector3(extent, 0.1, extent)).SetLocalPosition(vector3(0, -0.05, 0));
+
+		// a few materials, so the meshes are not all one batch
+		std::array<Ref<PBRMaterialInstance>, 4> materials;
+		for(uint32_t i = 0; i < materials.size(); i++){
+			materials[i] = New<PBRMaterialInstance>(Material::Manager::Get<PBRMaterial>());
+			materials[i]->SetAlbedoColor({ 0.3f + 0.2f * i, 0.8f - 0.15f * i, 0.5f, 1 });
+		}
+		for(uint32_t i = 0; i < config.staticMeshes; i++){
+			const auto x = i % gridSide, z = i / gridSide;
+			const auto height = 0.5f + float((i * 7) % 5);
+			auto mesh = Instantiate<GameObject>();
+			mesh.EmplaceComponent<StaticMesh>(cube, materials[i % materials.size()]);
+			mesh.GetTransform()
+				.SetLocalScale(vector3(1, height, 1))
+				.SetLocalPosition(vector3(x * 2.f - extent / 2 + 1, height / 2, z * 2.f - extent / 2 + 1));
+		}
+
+		auto ambient = Instantiate<GameObject>();
+		ambient.EmplaceComponent<AmbientLight>().SetIntensity(0.1);
+
+		// lights are spread over the scene on a golden angle spiral
+		constexpr auto goldenAngle = 2.39996323f;
+		const auto spiral = [&](uint32_t i, uint32_t count, float y){
+			const auto r = std::sqrt((i + 0.5f) / count) * extent * 0.45f;
+			return vector3(std::cos(i * goldenAngle) * r, y, std::sin(i * goldenAngle) * r);
+		};
+		for(uint32_t i = 0; i < config.directionalLights; i++){
+			auto light = Instantiate<GameObject>();
+			auto& dirLight = light.EmplaceComponent<DirectionalLight>();
+			dirLight.SetCastsShadows(config.shadows);
+			dirLight.SetIntensity(1.0f / config.directionalLights);
+			light.GetTransform().SetLocalRotation(quaternion(vector3(glm::radians(-50.f), glm::radians(30.f + 90.f * i), 0)));
+		}
+		for(uint32_t i = 0; i < config.pointLights; i++){
+			auto light = Instantiate<GameObject>();
+			auto& pointLight = light.EmplaceComponent<PointLight>();
+			pointLight.SetCastsShadows(config.shadows);
+			pointLight.SetIntensity(8);
+			pointLight.SetColorRGBA({ 1, 0.8f + 0.2f * (i % 2), 0.7f + 0.3f * (i % 3) / 2, 1 });
+			light.GetTransform().SetLocalPosition(spiral(i, config.pointLights, 3));
+		}
+		for(uint32_t i = 0; i < config.spotLights; i++){
+			auto light = Instantiate<GameObject>();
+			auto& spotLight = light.EmplaceComponent<SpotLight>();
+			spotLight.SetCastsShadows(config.shadows);
+			spotLight.SetIntensity(12);
+			spotLight.SetConeAngle(35);
+			// spread over the opposite spiral arm to the point lights
+			auto position = spiral(i, config.spotLights, 8);
+			position.x = -position.x;
+			light.GetTransform().SetLocalPosition(position);
+		}
+
+		// the engine's only bundled document, each in its own context so every document is laid out and drawn
+		for(uint32_t i = 0; i < config.guiDocuments; i++){
+			auto gui = Instantiate<GameObject>();
+			gui.EmplaceComponent<GUIComponent>().AddDocument("perf_overlay.rml");
+		}
+
+		camera = Instantiate<GameObject>();
+		camera.EmplaceComponent<CameraComponent>(60, 0.1, extent * 2).SetActive(true);
+	}
+
+	void PreTick(float fpsScale) final{
+		if (finished){
+			return;		// the quit is processed at the start of the next frame
+		}
+		const auto now = clocktype::now();
+		if (frame > config.warmupFrames){
+			Record(std::chrono::duration<double, std::milli>(now - lastTick).count());
+		}
+		lastTick = now;
+
+		if (frame == config.warmupFrames + config.frames){
+			WriteResults();
+			GetApp()->Quit();
+			finished = true;
+			return;
+		}
+
+		// driven by the frame number rather than time, so a slow GPU draws the same frames as a fast one
+		const auto [position, rotation] = CameraPathAt(frame);
+		camera.GetTransform().SetLocalPosition(position).SetLocalRotation(rotation);
+		frame++;
+	}
+
+	// the renderer's numbers for the previous frame. GPU timings arrive one frame later still, which does not matter for aggregates.
+	void Record(double cpuFrameMs){
+		auto& renderer = GetApp()->GetRenderEngine();
+		const auto& timings = renderer.GetLastFrameTimings();
+		frameMs.push_back(cpuFrameMs);
+		renderSyncMs.push_back(timings.renderSyncMs);
+		encodeMs.push_back(timings.encodeMs);
+		gpuMs.push_back(timings.gpuMs);
+
+		const auto passFor = [&](const std::string& label) -> PassSamples& {
+			auto [it, inserted] = passes.try_emplace(label);
+			if (inserted){
+				passOrder.push_back(label);
+			}
+			return it->second;
+		};
+		// passes that run more than once a frame, such as per-light shadowmaps, are summed
+		std::map<std::string, double> frameGPU;
+		for(const auto& region : renderer.GetGPUPassTimings()){
+			if (region.depth == 0){
+				frameGPU[region.label] += double(region.endNs - region.beginNs) / 1e6;
+			}
+		}
+		for(const auto& [label, ms] : frameGPU){
+			passFor(label).gpuMs.push_back(ms);
+		}
+		for(const auto& region : renderer.GetCommandCounts()){
+			if (region.depth == 0){
+				auto& pass = passFor(region.label);
+				pass.draws += region.draws;
+				pass.dispatches += region.dispatches;
+			}
+		}
+	}
+
+	void WriteResults(){
+		auto& renderer = GetApp()->GetRenderEngine();
+		std::string json = Format("{{\n  \"backend\": \"{}\",\n  \"device\": \"{}\",\n", RenderEngine::GetCurrentBackendName(), GetApp()->GetDevice()->GetBrandString());
+		json += Format("  \"config\": {{\"static_meshes\": {}, \"point_lights\": {}, \"spot_lights\": {}, \"directional_lights\": {}, \"gui_documents\": {}, \"shadows\": {}, \"warmup_frames\": {}, \"frames\": {}}},\n",
+			config.staticMeshes, config.pointLights, config.spotLights, config.directionalLights, config.guiDocuments, config.shadows, config.warmupFrames, config.frames);
+		json += Format("  \"frame_ms\": {},\n  \"render_sync_ms\": {},\n  \"encode_ms\": {},\n  \"gpu_ms\": {},\n", statsJSON(frameMs), statsJSON(renderSyncMs), statsJSON(encodeMs), statsJSON(gpuMs));
+		json += "  \"passes\": [\n";
+		const auto recorded = std::max<size_t>(frameMs.size(), 1);
+		for(size_t i = 0; i < passOrder.size(); i++){
+			const auto& pass = passes.at(passOrder[i]);
+			json += Format("    {{\"name\": \"{}\", \"gpu_ms\": {}, \"draws_per_frame\": {:.1f}, \"dispatches_per_frame\": {:.1f}}}{}\n", passOrder[i], statsJSON(pass.gpuMs), double(pass.draws) / recorded, double(pass.dispatches) / recorded, i + 1 < passOrder.size() ? "," : "");
+		}
+		json += "  ]\n}\n";
+
+		if (!config.jsonPath || config.jsonPath.value() == "-"){
+			cout << json;
+		}
+		else{
+			std::ofstream out(config.jsonPath.value());
+			out << json;
+		}
+	}
+};
+
+struct RenderBenchApp : public RavEngine::App {
+	void OnStartup(int argc, char** argv) final{
+		// --static, --point, --spot, --directional and --gui <n> set the workload, --no-shadows turns shadows off
+		// --warmup <n> and --frames <n> set the unrecorded and recorded frames, --json <path> writes the results there instead of stdout
+		for(int i = 1; i < argc; i++){
+			const std::string_view arg(argv[i]);
+			const auto count = [&](uint32_t& value){
+				if (i + 1 < argc){
+					value = uint32_t(std::max(std::atoi(argv[++i]), 0));
+				}
+			};
+			if (arg == "--static") count(config.staticMeshes);
+			else if (arg == "--point") count(config.pointLights);
+			else if (arg == "--spot") count(config.spotLights);
+			else if (arg == "--directional") count(config.directionalLights);
+			else if (arg == "--gui") count(config.guiDocuments);
+			else if (arg == "--warmup") count(config.warmupFrames);
+			else if (arg == "--frames") count(config.frames);
+			else if (arg == "--no-shadows") config.shadows = false;
+			else if (arg == "--json" && i + 1 < argc) config.jsonPath = argv[++i];
+		}
+
+		SetWindowTitle("RavEngine Render Benchmark");
+
+		// run as fast as the GPU allows, and measure every pass
+		RenderEngine::VideoSettings.presentMode = RGL::PresentMode::Immediate;
+		GetRenderEngine().SyncVideoSettings();
+		SetTargetFrameRate(0);
+		GetRenderEngine().SetGPUPassTimingsEnabled(true);
+		GetRenderEngine().SetCommandCountsEnabled(true);
+
+		AddWorld(RavEngine::New<BenchWorld>());
+	}
+	void OnFatal(const std::string_view msg) final {
+		RavEngine::Dialog::ShowBasic("Fatal Error", msg, Dialog::MessageBoxType::Error);
+	}
+};
+
+START_APP(RenderBenchApp)
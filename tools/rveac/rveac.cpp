@@ -11,6 +11,15 @@
 #include <assimp/material.h>
 #include <assimp/mesh.h>
 #include "Animation.hpp"
+#include <ozz/animation/offline/raw_skeleton.h>
+#include <ozz/animation/offline/skeleton_builder.h>
+#include <ozz/animation/offline/raw_animation.h>
+#include <ozz/animation/offline/animation_optimizer.h>
+#include <ozz/animation/offline/animation_builder.h>
+#include <ozz/animation/runtime/animation.h>
+#include <ozz/animation/runtime/skeleton.h>
+#include <ozz/base/io/archive.h>
+#include <ozz/base/io/stream.h>
 
 using namespace RavEngine;
 using namespace std;
@@ -18,7 +27,7 @@ using namespace std;
 #define FATAL(reason) {std::cerr << "rveac error: " << reason << std::endl; std::exit(1);}
 #define ASSERT(cond, str) {if (!(cond)) FATAL(str)}
 
-JointAnimation LoadAnimation(const std::filesystem::path& path) {
+JointAnimation LoadAnimation(const std::filesystem::path& path, SkeletonData& sk) {
 	const aiScene* scene = aiImportFile(path.string().c_str(),
 		aiProcess_ImproveCacheLocality |
 		aiProcess_ValidateDataStructure |
@@ -65,7 +74,7 @@ JointAnimation LoadAnimation(const std::filesystem::path& path) {
 	};
 
 	auto allbones = NameToBone(scene);
-	auto sk = CreateSkeleton(allbones);
+	sk = CreateSkeleton(allbones);
 	auto serialized = FlattenSkeleton(sk);
 
 	// populate the tracks
@@ -95,7 +104,66 @@ JointAnimation LoadAnimation(const std::filesystem::path& path) {
 	return raw_animation;
 }
 
-void SerializeAnim(const std::filesystem::path& outfile, const JointAnimation& anim) {
+struct CompressionOptions {
+	bool enabled = true;
+	// see ozz::animation::offline::AnimationOptimizer::Setting
+	float tolerance = 1e-3f;	// the error allowed on a joint's whole hierarchy, in meters
+	float distance = 1e-1f;		// how far from each joint the error is measured, to emulate the effect on skinning
+};
+
+// remove the keys that interpolation between their neighbours reproduces within the tolerance, then quantize the rest into ozz's runtime format
+ozz::unique_ptr<ozz::animation::Animation> CompressAnim(const JointAnimation& anim, const SkeletonData& sk, const CompressionOptions& options) {
+	// the optimizer measures error along the hierarchy, so it needs the skeleton the tracks were made for
+	ozz::animation::offline::RawSkeleton raw_skeleton;
+	raw_skeleton.roots.resize(1);
+	auto convertBone = [](ozz::animation::offline::RawSkeleton::Joint& dest, const SkeletonData::Bone& source, auto&& fn) -> void {
+		dest.name = source.name;
+		dest.transform.translation = { source.transform.translation.x,source.transform.translation.y,source.transform.translation.z };
+		dest.transform.scale = { source.transform.scale.x,source.transform.scale.y,source.transform.scale.z };
+		dest.transform.rotation = { source.transform.rotation.x,source.transform.rotation.y,source.transform.rotation.z, source.transform.rotation.w };
+
+		dest.children.reserve(source.children.size());
+		for (const auto& child : source.children) {
+			fn(dest.children.emplace_back(), child, fn);
+		}
+	};
+	convertBone(raw_skeleton.roots[0], sk.root, convertBone);
+
+	ozz::animation::offline::SkeletonBuilder skeletonBuilder;
+	auto skeleton = skeletonBuilder(raw_skeleton);
+	ASSERT(skeleton, "Could not build the skeleton to optimize against");
+	ASSERT(size_t(skeleton->num_joints()) == anim.tracks.size(), fmt::format("The skeleton has {} joints but the animation has {} tracks", skeleton->num_joints(), anim.tracks.size()));
+
+	ozz::animation::offline::RawAnimation raw_animation;
+	raw_animation.duration = anim.duration;
+	raw_animation.name = anim.name;
+	raw_animation.tracks.reserve(anim.tracks.size());
+	for (const auto& src_track : anim.tracks) {
+		auto& track = raw_animation.tracks.emplace_back();
+		for (const auto& key : src_track.translations) {
+			track.translations.push_back({ key.time, {key.value.x, key.value.y, key.value.z} });
+		}
+		for (const auto& key : src_track.rotations) {
+			track.rotations.push_back({ key.time, {key.value.x, key.value.y, key.value.z, key.value.w} });
+		}
+		for (const auto& key : src_track.scales) {
+			track.scales.push_back({ key.time, {key.value.x, key.value.y, key.value.z} });
+		}
+	}
+	ASSERT(raw_animation.Validate(), "Animation failed validation");
+
+	ozz::animation::offline::AnimationOptimizer optimizer;
+	optimizer.setting = { options.tolerance, options.distance };
+	ozz::animation::offline::RawAnimation optimized;
+	ASSERT(optimizer(raw_animation, *skeleton, &optimized), "Animation optimization failed");
+
+	ozz::animation::offline::AnimationBuilder builder;
+	auto compressed = builder(optimized);
+	ASSERT(compressed, "Could not build the compressed animation");
+	return compressed;
+}
+
+void SerializeAnim(const std::filesystem::path& outfile, const JointAnimation& anim, const ozz::animation::Animation* compressed) {
 	constexpr auto maxLen = std::numeric_limits<decltype(SerializedJointAnimationHeader::nameLength)>::max();
 	ASSERT(anim.name.size() <= maxLen, "Animation's name is too long!");
 
@@ -108,7 +176,8 @@ void SerializeAnim(const std::filesystem::path& outfile, const JointAnimation& a
 		.duration = anim.duration,
         .ticksPerSecond = anim.ticksPerSecond,
 		.numTracks = uint32_t(anim.tracks.size()),
-		.nameLength = uint16_t(anim.name.size())
+		.nameLength = uint16_t(anim.name.size()),
+		.encoding = compressed ? SerializedJointAnimationHeader::Encoding::OzzArchive : SerializedJointAnimationHeader::Encoding::Keyframes
 	};
 
 	// write header
@@ -117,6 +186,16 @@ void SerializeAnim(const std::filesystem::path& outfile, const JointAnimation& a
 	// write name
 	out.write(anim.name.data(), anim.name.size());
 
+	if (compressed) {
+		// the archive follows the name
+		out.close();
+		ozz::io::File file(outfile.string().c_str(), "ab");
+		ASSERT(file.opened(), fmt::format("Could not open {} for writing", outfile.string()));
+		ozz::io::OArchive archive(&file);
+		archive << *compressed;
+		return;
+	}
+
 	// write tracks
 	for (const auto& track : anim.tracks) {
 		SerializedJointAnimationTrackHeader header{
@@ -177,12 +256,33 @@ int main(int argc, char** argv) {
 
     auto infile = json_dir / std::string_view(doc["file"]);
 
-	auto anim = LoadAnimation(infile);
+	CompressionOptions compression;
+	{
+		bool enabled;
+		if (doc["compress"].get_bool().get(enabled) == simdjson::SUCCESS) {
+			compression.enabled = enabled;
+		}
+		double value;
+		if (doc["tolerance"].get_double().get(value) == simdjson::SUCCESS) {
+			compression.tolerance = value;
+		}
+		if (doc["distance"].get_double().get(value) == simdjson::SUCCESS) {
+			compression.distance = value;
+		}
+	}
+
+	SkeletonData sk;
+	auto anim = LoadAnimation(infile, sk);
+
+	ozz::unique_ptr<ozz::animation::Animation> compressed;
+	if (compression.enabled) {
+		compressed = CompressAnim(anim, sk, compression);
+	}
 
 	inputFile.replace_extension("");
 	const auto outfileName = inputFile.filename().string() + ".rvea";
 
-	SerializeAnim(outputDir / outfileName, anim);
+	SerializeAnim(outputDir / outfileName, anim, compressed.get());
 
 	return 0;
 }
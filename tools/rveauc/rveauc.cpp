@@ -0,0 +1,184 @@
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <filesystem>
+#include <simdjson.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <libnyquist/Decoders.h>
+#include <r8bbase.h>
+#include <CDSPResampler.h>
+#include "SerializedAudio.hpp"
+
+using namespace std;
+using namespace RavEngine;
+
+#define FATAL(reason) {std::cerr << "rveauc error: " << reason << std::endl; std::exit(1);}
+#define ASSERT(cond, str) {if (!(cond)) FATAL(str)}
+
+struct AudioConfig {
+    uint32_t sampleRate = 44'100;   // the rate of the AudioPlayer, see AudioPlayer::config_samplesPerSec
+    uint8_t channels = 1;           // the desired_channels the game passes to AudioAsset
+};
+
+// the samples of each channel, one after another
+struct PlanarAudio {
+    uint32_t sampleRate = 0;
+    uint32_t numSamples = 0;        // per channel
+    uint8_t nchannels = 0;
+    vector<float> samples;
+
+    float* Channel(uint8_t c) {
+        return samples.data() + size_t(c) * numSamples;
+    }
+};
+
+static PlanarAudio LoadAudio(const std::filesystem::path& infile) {
+    nqr::NyquistIO loader;
+    nqr::AudioData data;
+    try {
+        loader.Load(&data, infile.string());
+    }
+    catch (std::exception& e) {
+        FATAL(fmt::format("Cannot load {}: {}", infile.string(), e.what()));
+    }
+    ASSERT(data.channelCount > 0 && data.channelCount <= 2, fmt::format("{} has {} channels, only mono and stereo are supported", infile.string(), data.channelCount));
+
+    PlanarAudio audio{
+        .sampleRate = uint32_t(data.sampleRate),
+        .numSamples = uint32_t(data.samples.size() / data.channelCount),
+        .nchannels = uint8_t(data.channelCount),
+    };
+    audio.samples.resize(size_t(audio.numSamples) * audio.nchannels);
+    for (uint8_t c = 0; c < audio.nchannels; c++) {
+        auto channel = audio.Channel(c);
+        for (uint32_t i = 0; i < audio.numSamples; i++) {
+            channel[i] = data.samples[size_t(i) * audio.nchannels + c];
+        }
+    }
+    return audio;
+}
+
+static PlanarAudio Resample(PlanarAudio& in, uint32_t sampleRate) {
+    PlanarAudio out{
+        .sampleRate = sampleRate,
+        .numSamples = uint32_t(std::llround(double(in.numSamples) * sampleRate / in.sampleRate)),
+        .nchannels = in.nchannels,
+    };
+    out.samples.resize(size_t(out.numSamples) * out.nchannels);
+    for (uint8_t c = 0; c < in.nchannels; c++) {
+        r8b::CDSPResampler resampler(in.sampleRate, sampleRate, int(in.numSamples));
+        resampler.oneshot(in.Channel(c), int(in.numSamples), out.Channel(c), int(out.numSamples));
+    }
+    return out;
+}
+
+static PlanarAudio ConvertChannels(PlanarAudio& in, uint8_t nchannels) {
+    PlanarAudio out{
+        .sampleRate = in.sampleRate,
+        .numSamples = in.numSamples,
+        .nchannels = nchannels,
+    };
+    out.samples.resize(size_t(out.numSamples) * out.nchannels);
+    if (nchannels == 1) {
+        // stereo -> mono
+        auto left = in.Channel(0), right = in.Channel(1), mono = out.Channel(0);
+        for (uint32_t i = 0; i < in.numSamples; i++) {
+            mono[i] = (left[i] + right[i]) / 2.0f;
+        }
+    }
+    else {
+        // mono -> stereo
+        std::copy_n(in.Channel(0), in.numSamples, out.Channel(0));
+        std::copy_n(in.Channel(0), in.numSamples, out.Channel(1));
+    }
+    return out;
+}
+
+static void SerializeAudio(const std::filesystem::path& outfile, const PlanarAudio& audio) {
+    std::filesystem::create_directories(outfile.parent_path());		// make all the folders necessary
+
+    SerializedAudioDataHeader header{
+        .sampleRate = audio.sampleRate,
+        .numSamples = audio.numSamples,
+        .nchannels = audio.nchannels,
+        .lengthSeconds = double(audio.numSamples) / audio.sampleRate,
+    };
+
+    ofstream out(outfile, std::ios::binary);
+    if (!out) {
+        FATAL(fmt::format("Could not open {} for writing", outfile.string()));
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(audio.samples.data()), audio.samples.size() * sizeof(audio.samples[0]));
+}
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("rveauc", "RavEngine Audio Compiler");
+    options.add_options()
+        ("f,file", "Input file path", cxxopts::value<std::filesystem::path>())
+        ("o,output", "Ouptut file path", cxxopts::value<std::filesystem::path>())
+        ("h,help", "Show help menu")
+        ;
+
+    auto args = options.parse(argc, argv);
+
+    if (args["help"].as<bool>()) {
+        cout << options.help() << endl;
+        return 0;
+    }
+
+    std::filesystem::path inputFile;
+    try {
+        inputFile = args["file"].as<decltype(inputFile)>();
+    }
+    catch (exception& e) {
+        FATAL("no input file")
+    }
+    std::filesystem::path outputDir;
+    try {
+        outputDir = args["output"].as<decltype(outputDir)>();
+    }
+    catch (exception& e) {
+        FATAL("no output file")
+    }
+
+    simdjson::ondemand::parser parser;
+
+    auto json = simdjson::padded_string::load(inputFile.string());
+    simdjson::ondemand::document doc = parser.iterate(json);
+
+    const auto json_dir = inputFile.parent_path();
+
+    auto infile = json_dir / std::string_view(doc["file"]);
+
+    AudioConfig config;
+    {
+        uint64_t value;
+        if (doc["sampleRate"].get_uint64().get(value) == simdjson::SUCCESS) {
+            config.sampleRate = uint32_t(value);
+        }
+        if (doc["channels"].get_uint64().get(value) == simdjson::SUCCESS) {
+            config.channels = uint8_t(value);
+        }
+    }
+    ASSERT(config.sampleRate > 0, "sampleRate must be positive");
+    ASSERT(config.channels == 1 || config.channels == 2, "channels must be 1 or 2");
+
+    auto audio = LoadAudio(infile);
+    if (audio.sampleRate != config.sampleRate) {
+        audio = Resample(audio, config.sampleRate);
+    }
+    if (audio.nchannels != config.channels) {
+        audio = ConvertChannels(audio, config.channels);
+    }
+
+    inputFile.replace_extension("");
+    const auto outfileName = inputFile.filename().string() + ".rvesnd";
+
+    SerializeAudio(outputDir / outfileName, audio);
+
+    return 0;
+}
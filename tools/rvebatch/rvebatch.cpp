@@ -0,0 +1,327 @@
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <simdjson.h>
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <map>
+#include <optional>
+#include <random>
+#include <cstdlib>
+
+using namespace std;
+
+#define FATAL(reason) {std::cerr << "rvebatch error: " << reason << std::endl; std::exit(1);}
+#define ASSERT(cond, str) {if (!(cond)) FATAL(str)}
+
+// bump to invalidate every cache entry written by an older rvebatch
+static constexpr uint64_t cacheVersion = 1;
+
+struct Job {
+    vector<string> command;                         // the tool, then its arguments
+    vector<std::filesystem::path> inputs;           // files or directories the outputs depend on, besides the tool itself
+    vector<std::filesystem::path> outputs;
+};
+
+// FNV-1a, 64 bit
+struct Hasher {
+    uint64_t value = 0xcbf29ce484222325;
+
+    void Update(const void* data, size_t size) {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            value ^= bytes[i];
+            value *= 0x100000001b3;
+        }
+    }
+    void Update(string_view str) {
+        const uint64_t size = str.size();
+        Update(&size, sizeof(size));        // so that ("ab","c") and ("a","bc") differ
+        Update(str.data(), str.size());
+    }
+};
+
+static bool HashFile(Hasher& hasher, const std::filesystem::path& path) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        return false;
+    }
+    char buffer[64 * 1024];
+    uint64_t size = 0;
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+        hasher.Update(buffer, size_t(in.gcount()));
+        size += in.gcount();
+    }
+    hasher.Update(&size, sizeof(size));
+    return true;
+}
+
+// directories hash every file under them, by relative path, so adding or renaming a file changes the hash
+static bool HashInput(Hasher& hasher, const std::filesystem::path& path) {
+    if (!std::filesystem::is_directory(path)) {
+        return HashFile(hasher, path);
+    }
+    vector<std::filesystem::path> files;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(path)) {
+        if (item.is_regular_file()) {
+            files.push_back(item.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        hasher.Update(std::filesystem::relative(file, path).generic_string());
+        if (!HashFile(hasher, file)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static string Quote(const string& arg) {
+#ifdef _WIN32
+    string quoted = "\"";
+    for (const auto c : arg) {
+        if (c == '"') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+#else
+    string quoted = "'";
+    for (const auto c : arg) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        }
+        else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+#endif
+}
+
+static int Run(const vector<string>& command) {
+    string line;
+    for (const auto& arg : command) {
+        line += Quote(arg) + " ";
+    }
+#ifdef _WIN32
+    // cmd strips the first and last quote of the line
+    line = "\"" + line + "\"";
+#endif
+    return std::system(line.c_str());
+}
+
+class Cache {
+    std::filesystem::path root;
+    std::mutex toolMtx;
+    std::map<string, pair<bool, uint64_t>> toolHashes;      // hashing a tool once covers every job that uses it
+
+    bool ToolHash(const string& tool, uint64_t& hash) {
+        std::lock_guard lock(toolMtx);
+        auto it = toolHashes.find(tool);
+        if (it == toolHashes.end()) {
+            Hasher hasher;
+            const bool found = HashFile(hasher, tool);
+            it = toolHashes.emplace(tool, make_pair(found, hasher.value)).first;
+        }
+        hash = it->second.second;
+        return it->second.first;
+    }
+
+public:
+    Cache(const std::filesystem::path& root) : root(root) {}
+
+    // an empty path if the job cannot be cached, such as when an input is missing
+    std::filesystem::path EntryFor(const Job& job) {
+        Hasher hasher;
+        hasher.Update(&cacheVersion, sizeof(cacheVersion));
+        uint64_t toolHash;
+        if (!ToolHash(job.command.front(), toolHash)) {
+            return {};
+        }
+        hasher.Update(&toolHash, sizeof(toolHash));
+        for (const auto& arg : job.command) {
+            hasher.Update(arg);
+        }
+        for (const auto& input : job.inputs) {
+            hasher.Update(input.generic_string());
+            if (!HashInput(hasher, input)) {
+                return {};
+            }
+        }
+        for (const auto& output : job.outputs) {
+            hasher.Update(output.generic_string());
+        }
+        return root / fmt::format("{:016x}", hasher.value);
+    }
+
+    static bool Restore(const Job& job, const std::filesystem::path& entry) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(entry, ec)) {
+            return false;
+        }
+        for (size_t i = 0; i < job.outputs.size(); i++) {
+            const auto& output = job.outputs[i];
+            if (output.has_parent_path()) {
+                std::filesystem::create_directories(output.parent_path(), ec);
+            }
+            // copying gives the output a new modification time, so the build sees it as up to date
+            std::filesystem::remove(output, ec);
+            if (!std::filesystem::copy_file(entry / std::to_string(i), output, ec)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void Store(const Job& job, const std::filesystem::path& entry) {
+        // written under a temporary name and renamed, so a concurrent build never sees a partial entry
+        std::error_code ec;
+        auto staging = entry;
+        staging += fmt::format(".{:08x}", std::random_device{}());
+        std::filesystem::remove_all(staging, ec);
+        std::filesystem::create_directories(staging, ec);
+        for (size_t i = 0; i < job.outputs.size(); i++) {
+            if (!std::filesystem::copy_file(job.outputs[i], staging / std::to_string(i), ec)) {
+                std::filesystem::remove_all(staging, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(staging, entry, ec);
+        if (ec) {
+            std::filesystem::remove_all(staging, ec);      // another process stored it first
+        }
+    }
+};
+
+static vector<Job> ReadManifest(const std::filesystem::path& path) {
+    simdjson::ondemand::parser parser;
+    auto json = simdjson::padded_string::load(path.string());
+    ASSERT(json.error() == simdjson::SUCCESS, fmt::format("cannot read {}", path.string()));
+    simdjson::ondemand::document doc = parser.iterate(json);
+
+    // paths in the manifest are relative to it
+    const auto dir = path.parent_path();
+    vector<Job> jobs;
+    for (auto item : doc["jobs"].get_array()) {
+        Job job;
+        for (auto arg : item["command"].get_array()) {
+            job.command.emplace_back(std::string_view(arg));
+        }
+        simdjson::ondemand::array inputs;
+        if (!item["inputs"].get(inputs)) {
+            for (auto input : inputs) {
+                job.inputs.push_back(dir / std::string_view(input));
+            }
+        }
+        for (auto output : item["outputs"].get_array()) {
+            job.outputs.push_back(dir / std::string_view(output));
+        }
+        ASSERT(!job.command.empty(), "a job has no command");
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("rvebatch", "RavEngine Asset Batch Compiler");
+    options.add_options()
+        ("m,manifest", "JSON file listing jobs as {\"jobs\" : [{\"command\" : [tool, args...], \"inputs\" : [...], \"outputs\" : [...]}]}", cxxopts::value<std::filesystem::path>())
+        ("c,cache", "Cache directory. Jobs whose tool, arguments and inputs are unchanged copy their outputs from it instead of running.", cxxopts::value<std::filesystem::path>())
+        ("j,jobs", "Jobs to run at once, 0 for one per core", cxxopts::value<unsigned>()->default_value("0"))
+        ("in", "With a command after --, an input of that command", cxxopts::value<vector<std::filesystem::path>>())
+        ("out", "With a command after --, an output of that command", cxxopts::value<vector<std::filesystem::path>>())
+        ("h,help", "Show help menu")
+        ;
+    options.custom_help("[-m manifest | --in input... --out output... -- tool args...]");
+
+    auto args = options.parse(argc, argv);
+
+    if (args["help"].as<bool>()) {
+        cout << options.help() << endl;
+        return 0;
+    }
+
+    vector<Job> jobs;
+    if (args.count("manifest")) {
+        jobs = ReadManifest(args["manifest"].as<std::filesystem::path>());
+    }
+    else {
+        Job job;
+        job.command = args.unmatched();
+        ASSERT(!job.command.empty(), "no manifest or command");
+        if (args.count("in")) {
+            job.inputs = args["in"].as<vector<std::filesystem::path>>();
+        }
+        if (args.count("out")) {
+            job.outputs = args["out"].as<vector<std::filesystem::path>>();
+        }
+        jobs.push_back(std::move(job));
+    }
+
+    std::optional<Cache> cache;
+    if (args.count("cache")) {
+        const auto cacheDir = args["cache"].as<std::filesystem::path>();
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDir, ec);
+        ASSERT(!ec, fmt::format("cannot create {}", cacheDir.string()));
+        cache.emplace(cacheDir);
+    }
+
+    auto numThreads = args["jobs"].as<unsigned>();
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    numThreads = std::min<unsigned>(numThreads, jobs.size());
+
+    std::atomic<size_t> nextJob = 0, compiled = 0, cached = 0, failed = 0;
+    std::mutex outputMtx;
+    auto worker = [&] {
+        for (size_t i; (i = nextJob++) < jobs.size();) {
+            const auto& job = jobs[i];
+            // outputs are only cached if the job declares them, otherwise nothing could be restored
+            std::filesystem::path entry;
+            if (cache && !job.outputs.empty()) {
+                entry = cache->EntryFor(job);
+                if (!entry.empty() && Cache::Restore(job, entry)) {
+                    cached++;
+                    continue;
+                }
+            }
+
+            const auto result = Run(job.command);
+            if (result != 0) {
+                std::lock_guard lock(outputMtx);
+                std::cerr << fmt::format("rvebatch: {} failed with {}", job.command.front(), result) << std::endl;
+                failed++;
+                continue;
+            }
+            if (!entry.empty()) {
+                Cache::Store(job, entry);
+            }
+            compiled++;
+        }
+    };
+    vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (jobs.size() > 1) {
+        cout << fmt::format("rvebatch: {} compiled, {} from cache, {} failed", compiled.load(), cached.load(), failed.load()) << endl;
+    }
+    return failed > 0 ? 1 : 0;
+}
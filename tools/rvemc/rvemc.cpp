@@ -12,11 +12,16 @@
 #include <assimp/material.h>
 #include <assimp/mesh.h>
 #include "Mesh.hpp"
+#include "MeshEncoding.hpp"
+#include "ImpostorEncoding.hpp"
 #include <variant>
 #include "CaseAnalysis.hpp"
 #include <RavEngine/ImportLib.hpp>
 #include <meshoptimizer.h>
 #include <numeric>
+#include <limits>
+#include <optional>
+#include <stb_image.h>
 
 using namespace std;
 using namespace RavEngine;
@@ -46,6 +51,371 @@ struct SkinnedMeshPart : public MeshPart {
     std::vector<VertexWeights> vertexWeights;
 };
 
+struct EncodingSettings {
+    bool compress = false;              // quantize the vertices and meshopt-encode the vertices and indices
+    bool quantizePositions = false;     // 16-bit positions relative to the bounds, if compressing
+};
+
+// Splits the mesh into meshlets and rewrites the index buffer in meshlet order,
+// so that each meshlet is a contiguous index range that can be drawn and culled on its own.
+// The meshlets are larger than typical mesh-shader meshlets because each one becomes an indirect draw.
+void BuildMeshlets(MeshPart& mesh) {
+    constexpr size_t maxVertices = 255, maxTriangles = 256;
+    constexpr float coneWeight = 0.25;   // trade some spatial locality for tighter normal cones
+
+    if (mesh.indices.empty()) {
+        return;
+    }
+
+    const auto maxMeshlets = meshopt_buildMeshletsBound(mesh.indices.size(), maxVertices, maxTriangles);
+    std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+    std::vector<unsigned int> meshletVertices(maxMeshlets * maxVertices);
+    std::vector<unsigned char> meshletTriangles(maxMeshlets * maxTriangles * 3);
+
+    const auto nMeshlets = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(), mesh.indices.data(), mesh.indices.size(), &mesh.positions[0].x, mesh.NumVerts(), sizeof(VertexPosition_t), maxVertices, maxTriangles, coneWeight);
+
+    decltype(mesh.indices) reorderedIndices;
+    reorderedIndices.reserve(mesh.indices.size());
+    mesh.meshlets.clear();
+    mesh.meshlets.reserve(nMeshlets);
+    for (size_t i = 0; i < nMeshlets; i++) {
+        const auto& m = meshlets[i];
+        auto bounds = meshopt_computeMeshletBounds(&meshletVertices[m.vertex_offset], &meshletTriangles[m.triangle_offset], m.triangle_count, &mesh.positions[0].x, mesh.NumVerts(), sizeof(VertexPosition_t));
+
+        Meshlet meshlet{
+            .indexStart = uint32_t(reorderedIndices.size()),
+            .indexCount = m.triangle_count * 3,
+            .center = {bounds.center[0], bounds.center[1], bounds.center[2]},
+            .radius = bounds.radius,
+            .coneApex = {bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]},
+            .coneAxis = {bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]},
+            .coneCutoff = bounds.cone_cutoff,
+        };
+
+        // meshlet triangles index into the meshlet's vertex list, convert back to mesh vertex indices
+        for (uint32_t t = 0; t < meshlet.indexCount; t++) {
+            reorderedIndices.push_back(meshletVertices[m.vertex_offset + meshletTriangles[m.triangle_offset + t]]);
+        }
+        mesh.meshlets.push_back(meshlet);
+    }
+    ASSERT(reorderedIndices.size() == mesh.indices.size(), "Meshlets do not cover the mesh");
+    mesh.indices = std::move(reorderedIndices);
+}
+
+struct LODSettings {
+    float minDistance = 0;      // the LOD is used beyond this distance from the camera
+    float targetRatio = 0.5;    // fraction of the base mesh's triangles to keep
+    float targetError = 0.01;   // maximum deviation from the base mesh, relative to the mesh extents
+};
+
+// Simplifies the base mesh with meshoptimizer and drops the vertices the result no longer uses
+MeshPart GenerateLOD(const MeshPart& mesh, const LODSettings& settings) {
+    const size_t targetIndexCount = size_t(mesh.indices.size() * settings.targetRatio) / 3 * 3;
+
+    decltype(mesh.indices) simplified(mesh.indices.size());
+    float resultError = 0;
+    simplified.resize(meshopt_simplify(simplified.data(), mesh.indices.data(), mesh.indices.size(), &mesh.positions[0].x, mesh.NumVerts(), sizeof(VertexPosition_t), targetIndexCount, settings.targetError, 0, &resultError));
+    ASSERT(simplified.size() > 0, fmt::format("LOD at distance {} simplified to nothing", settings.minDistance));
+
+    std::vector<uint32_t> remap(mesh.NumVerts());
+    const auto numVerts = meshopt_optimizeVertexFetchRemap(remap.data(), simplified.data(), simplified.size(), mesh.NumVerts());
+
+    MeshPart lod;
+    lod.attributes = mesh.attributes;
+    lod.indices.resize(simplified.size());
+    meshopt_remapIndexBuffer(lod.indices.data(), simplified.data(), simplified.size(), remap.data());
+
+    auto remapProperty = [&remap, numVerts](auto& destination, const auto& source) {
+        if (source.empty()) {
+            return;
+        }
+        destination.resize(numVerts);
+        meshopt_remapVertexBuffer(destination.data(), source.data(), source.size(), sizeof(source[0]), remap.data());
+    };
+    remapProperty(lod.positions, mesh.positions);
+    remapProperty(lod.normals, mesh.normals);
+    remapProperty(lod.tangents, mesh.tangents);
+    remapProperty(lod.bitangents, mesh.bitangents);
+    remapProperty(lod.uv0, mesh.uv0);
+    remapProperty(lod.lightmapUVs, mesh.lightmapUVs);
+
+    BuildMeshlets(lod);
+    return lod;
+}
+
+struct ImpostorSettings {
+    float minDistance = 0;                  // the impostor replaces the mesh beyond this distance from the camera
+    uint32_t framesPerSide = 8;
+    uint32_t atlasSize = 1024;
+    bool hemisphere = false;                // only bake views from above, for meshes that are never seen from below
+    std::filesystem::path albedoTexture;    // sampled with the mesh's UVs. Without one, the mesh is white.
+    glm::vec3 color{ 1 };                   // multiplies the albedo, linear
+};
+
+// see ImpostorEncoding for the layout
+struct ImpostorBake {
+    ImpostorEncoding::ImpostorHeader header;
+    MeshPart quad;
+    std::vector<uint8_t> albedo, normalDepth;   // the mip chains
+};
+
+// linear floats
+struct BakeImage {
+    uint32_t width = 0, height = 0;
+    std::vector<glm::vec4> texels;
+
+    BakeImage(uint32_t width, uint32_t height, glm::vec4 value = glm::vec4(0)) : width(width), height(height), texels(size_t(width) * height, value) {}
+
+    glm::vec4& At(uint32_t x, uint32_t y) {
+        return texels[size_t(y) * width + x];
+    }
+    const glm::vec4& At(uint32_t x, uint32_t y) const {
+        return texels[size_t(y) * width + x];
+    }
+
+    // bilinear, repeating
+    glm::vec4 Sample(glm::vec2 uv) const {
+        const glm::vec2 pos = uv * glm::vec2(width, height) - 0.5f;
+        const glm::vec2 base = glm::floor(pos);
+        const glm::vec2 f = pos - base;
+        auto texel = [this](int x, int y) {
+            return At(uint32_t(((x % int(width)) + int(width)) % int(width)), uint32_t(((y % int(height)) + int(height)) % int(height)));
+        };
+        const int x = int(base.x), y = int(base.y);
+        return glm::mix(glm::mix(texel(x, y), texel(x + 1, y), f.x), glm::mix(texel(x, y + 1), texel(x + 1, y + 1), f.x), f.y);
+    }
+};
+
+static float SRGBToLinear(float c) {
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSRGB(float c) {
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1 / 2.4f) - 0.055f;
+}
+
+static uint8_t ToUnorm8(float c) {
+    return uint8_t(std::clamp(c, 0.f, 1.f) * 255 + 0.5f);
+}
+
+static BakeImage LoadAlbedoTexture(const std::filesystem::path& path) {
+    int width, height, channels;
+    auto pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+    if (pixels == nullptr) {
+        FATAL(fmt::format("Cannot load {}: {}", path.string(), stbi_failure_reason()));
+    }
+    BakeImage image(width, height);
+    for (size_t i = 0; i < image.texels.size(); i++) {
+        image.texels[i] = { SRGBToLinear(pixels[i * 4] / 255.f), SRGBToLinear(pixels[i * 4 + 1] / 255.f), SRGBToLinear(pixels[i * 4 + 2] / 255.f), pixels[i * 4 + 3] / 255.f };
+    }
+    stbi_image_free(pixels);
+    return image;
+}
+
+// Gives the empty texels around the silhouettes the colors of their covered neighbors, so that filtering at the
+// silhouettes does not blend in black. Texels only take from neighbors in the same frame.
+static void DilateFrames(BakeImage& albedo, BakeImage& normalDepth, uint32_t frameSize, uint32_t iterations) {
+    std::vector<bool> filled(albedo.texels.size());
+    for (size_t i = 0; i < filled.size(); i++) {
+        filled[i] = albedo.texels[i].a > 0;
+    }
+    for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+        auto next = filled;
+        for (uint32_t y = 0; y < albedo.height; y++) {
+            for (uint32_t x = 0; x < albedo.width; x++) {
+                if (filled[size_t(y) * albedo.width + x]) {
+                    continue;
+                }
+                glm::vec3 color{ 0 }, normal{ 0 };
+                uint32_t count = 0;
+                const std::pair<int, int> neighbors[]{ {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+                for (const auto [dx, dy] : neighbors) {
+                    const int nx = int(x) + dx, ny = int(y) + dy;
+                    if (nx < 0 || ny < 0 || nx >= int(albedo.width) || ny >= int(albedo.height) || nx / frameSize != x / frameSize || ny / frameSize != y / frameSize || !filled[size_t(ny) * albedo.width + nx]) {
+                        continue;
+                    }
+                    color += glm::vec3(albedo.At(nx, ny));
+                    normal += glm::vec3(normalDepth.At(nx, ny));
+                    count++;
+                }
+                if (count > 0) {
+                    albedo.At(x, y) = glm::vec4(color / float(count), 0);
+                    normalDepth.At(x, y) = glm::vec4(glm::normalize(normal), normalDepth.At(x, y).a);
+                    next[size_t(y) * albedo.width + x] = true;
+                }
+            }
+        }
+        filled = std::move(next);
+    }
+}
+
+// a 2x2 box filter that weighs the texels by coverage, so that empty texels do not darken the silhouettes
+static void DownsampleAtlases(const BakeImage& albedo, const BakeImage& normalDepth, BakeImage& albedoOut, BakeImage& normalDepthOut) {
+    for (uint32_t y = 0; y < albedoOut.height; y++) {
+        for (uint32_t x = 0; x < albedoOut.width; x++) {
+            glm::vec3 color{ 0 }, weightedColor{ 0 }, normal{ 0 }, weightedNormal{ 0 };
+            float coverage = 0, depth = 0, weightedDepth = 0;
+            for (uint32_t i = 0; i < 4; i++) {
+                const auto& a = albedo.At(x * 2 + i % 2, y * 2 + i / 2);
+                const auto& n = normalDepth.At(x * 2 + i % 2, y * 2 + i / 2);
+                color += glm::vec3(a);
+                weightedColor += glm::vec3(a) * a.a;
+                normal += glm::vec3(n);
+                weightedNormal += glm::vec3(n) * a.a;
+                depth += n.a;
+                weightedDepth += n.a * a.a;
+                coverage += a.a;
+            }
+            const bool covered = coverage > 0;
+            albedoOut.At(x, y) = glm::vec4(covered ? weightedColor / coverage : color / 4.f, coverage / 4);
+            const auto n = covered ? weightedNormal : normal;
+            normalDepthOut.At(x, y) = glm::vec4(glm::length(n) > 0 ? glm::normalize(n) : glm::vec3(0, 0, 1), covered ? weightedDepth / coverage : depth / 4);
+        }
+    }
+}
+
+// Renders the mesh from the directions of an octahedral map into the albedo and normal atlases, on the CPU.
+// The frames are orthographic views of the mesh's bounding sphere.
+ImpostorBake BakeImpostor(const MeshPart& mesh, const ImpostorSettings& settings) {
+    ASSERT(settings.framesPerSide >= 2 && settings.framesPerSide <= std::numeric_limits<uint8_t>::max(), "Impostor frames must be between 2 and 255");
+    ASSERT(settings.atlasSize % settings.framesPerSide == 0, "Impostor size must be a multiple of the frames");
+    ASSERT(!mesh.positions.empty(), "Cannot make an impostor of an empty mesh");
+    const uint32_t frameSize = settings.atlasSize / settings.framesPerSide;
+
+    glm::vec3 min = mesh.positions[0], max = mesh.positions[0];
+    for (const auto& position : mesh.positions) {
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+    const glm::vec3 center = (min + max) * 0.5f;
+    float radius = 0;
+    for (const auto& position : mesh.positions) {
+        radius = std::max(radius, glm::distance(glm::vec3(position), center));
+    }
+    radius = std::max(radius, 1e-6f);
+
+    std::optional<BakeImage> albedoTexture;
+    if (!settings.albedoTexture.empty()) {
+        albedoTexture = LoadAlbedoTexture(settings.albedoTexture);
+    }
+
+    BakeImage albedo(settings.atlasSize, settings.atlasSize);
+    BakeImage normalDepth(settings.atlasSize, settings.atlasSize, glm::vec4(0, 0, 1, 0));
+    std::vector<float> depthBuffer(size_t(frameSize) * frameSize);
+
+    auto edge = [](glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    };
+
+    for (uint32_t frameY = 0; frameY < settings.framesPerSide; frameY++) {
+        for (uint32_t frameX = 0; frameX < settings.framesPerSide; frameX++) {
+            const auto dir = ImpostorEncoding::FrameDirection(frameX, frameY, settings.framesPerSide, settings.hemisphere);
+            const auto basis = ImpostorEncoding::BasisForDirection(dir);
+            std::fill(depthBuffer.begin(), depthBuffer.end(), -std::numeric_limits<float>::infinity());
+
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                const uint32_t index[3]{ mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] };
+                glm::vec2 screen[3];
+                float depth[3];
+                for (int v = 0; v < 3; v++) {
+                    const glm::vec3 local = glm::vec3(mesh.positions[index[v]]) - center;
+                    screen[v] = { (glm::dot(local, basis.right) / radius * 0.5f + 0.5f) * frameSize, (0.5f - glm::dot(local, basis.up) / radius * 0.5f) * frameSize };
+                    depth[v] = glm::dot(local, dir) / radius;
+                }
+                const float area = edge(screen[0], screen[1], screen[2]);
+                if (std::abs(area) < 1e-12f) {
+                    continue;
+                }
+                const auto lo = glm::max(glm::floor(glm::min(screen[0], glm::min(screen[1], screen[2]))), glm::vec2(0));
+                const auto hi = glm::min(glm::ceil(glm::max(screen[0], glm::max(screen[1], screen[2]))), glm::vec2(frameSize - 1));
+                for (uint32_t y = uint32_t(lo.y); y <= uint32_t(hi.y) && lo.y <= hi.y; y++) {
+                    for (uint32_t x = uint32_t(lo.x); x <= uint32_t(hi.x) && lo.x <= hi.x; x++) {
+                        const glm::vec2 p{ x + 0.5f, y + 0.5f };
+                        const float w0 = edge(screen[1], screen[2], p) / area;
+                        const float w1 = edge(screen[2], screen[0], p) / area;
+                        const float w2 = 1 - w0 - w1;
+                        if (w0 < 0 || w1 < 0 || w2 < 0) {
+                            continue;
+                        }
+                        // the frame looks along -dir, so the closest surface has the greatest depth
+                        const float d = w0 * depth[0] + w1 * depth[1] + w2 * depth[2];
+                        auto& closest = depthBuffer[size_t(y) * frameSize + x];
+                        if (d <= closest) {
+                            continue;
+                        }
+                        glm::vec4 color{ settings.color, 1 };
+                        if (albedoTexture) {
+                            const glm::vec2 uv = mesh.uv0[index[0]] * w0 + mesh.uv0[index[1]] * w1 + mesh.uv0[index[2]] * w2;
+                            color *= albedoTexture->Sample(uv);
+                            // alpha-tested cutouts, like leaves
+                            if (color.a < 0.5f) {
+                                continue;
+                            }
+                        }
+                        closest = d;
+                        glm::vec3 normal = glm::normalize(mesh.normals[index[0]] * w0 + mesh.normals[index[1]] * w1 + mesh.normals[index[2]] * w2);
+                        // two-sided cards show their back, which faces the viewer
+                        if (glm::dot(normal, dir) < 0) {
+                            normal = -normal;
+                        }
+                        const uint32_t atlasX = frameX * frameSize + x, atlasY = frameY * frameSize + y;
+                        albedo.At(atlasX, atlasY) = glm::vec4(glm::vec3(color), 1);
+                        normalDepth.At(atlasX, atlasY) = glm::vec4(normal, d);
+                    }
+                }
+            }
+        }
+    }
+    DilateFrames(albedo, normalDepth, frameSize, 4);
+
+    ImpostorBake bake;
+    bake.header = {
+        .center = center,
+        .radius = radius,
+        .minDistance = settings.minDistance,
+        .atlasSize = settings.atlasSize,
+        .framesPerSide = uint8_t(settings.framesPerSide),
+        .hemisphere = uint8_t(settings.hemisphere),
+    };
+
+    // stop while the frames still have a few texels, and before they stop halving evenly
+    uint32_t mipFrameSize = frameSize;
+    bake.header.mipLevels = 1;
+    while (mipFrameSize % 2 == 0 && mipFrameSize / 2 >= 4) {
+        mipFrameSize /= 2;
+        bake.header.mipLevels++;
+    }
+
+    for (uint32_t mip = 0; mip < bake.header.mipLevels; mip++) {
+        if (mip > 0) {
+            BakeImage albedoMip(albedo.width / 2, albedo.height / 2), normalDepthMip(albedo.width / 2, albedo.height / 2);
+            DownsampleAtlases(albedo, normalDepth, albedoMip, normalDepthMip);
+            albedo = std::move(albedoMip);
+            normalDepth = std::move(normalDepthMip);
+        }
+        for (size_t i = 0; i < albedo.texels.size(); i++) {
+            const auto& a = albedo.texels[i];
+            const auto& n = normalDepth.texels[i];
+            bake.albedo.insert(bake.albedo.end(), { ToUnorm8(LinearToSRGB(a.r)), ToUnorm8(LinearToSRGB(a.g)), ToUnorm8(LinearToSRGB(a.b)), ToUnorm8(a.a) });
+            bake.normalDepth.insert(bake.normalDepth.end(), { ToUnorm8(n.r * 0.5f + 0.5f), ToUnorm8(n.g * 0.5f + 0.5f), ToUnorm8(n.b * 0.5f + 0.5f), ToUnorm8(n.a * 0.5f + 0.5f) });
+        }
+    }
+    ASSERT(bake.albedo.size() == ImpostorEncoding::AtlasBytes(bake.header), "Impostor atlas size mismatch");
+
+    // the material turns the quad to face the camera. Its tangent frame is the identity, so the
+    // normals the material reads from the atlas are in object space, and its UVs name its corners.
+    const glm::vec2 corners[]{ {-1, 1}, {1, 1}, {1, -1}, {-1, -1} };
+    for (const auto& corner : corners) {
+        bake.quad.positions.push_back(center + glm::vec3(corner * radius, 0));
+        bake.quad.normals.push_back({ 0, 0, 1 });
+        bake.quad.tangents.push_back({ 1, 0, 0 });
+        bake.quad.bitangents.push_back({ 0, 1, 0 });
+        bake.quad.uv0.push_back({ corner.x * 0.5f + 0.5f, 0.5f - corner.y * 0.5f });
+    }
+    bake.quad.indices = { 0, 1, 2, 0, 2, 3 };
+    return bake;
+}
+
 template<bool isSkinned>
 std::variant<MeshPart, SkinnedMeshPart> LoadMesh(const std::filesystem::path& path, std::optional<std::string_view> meshName, float scaleFactor) {
     const aiScene* scene = aiImportFile(path.string().c_str(), assimp_flags);
@@ -122,6 +492,11 @@ std::variant<MeshPart, SkinnedMeshPart> LoadMesh(const std::filesystem::path& pa
     }
 #endif
 
+    // skinned meshes are drawn with one indirect command per entity, so they do not get meshlets
+    if constexpr (!isSkinned) {
+        BuildMeshlets(mesh);
+    }
+
     decltype(SkinnedMeshPart::vertexWeights) weightsgpu;
     if constexpr (isSkinned) {
         // load skin data
@@ -190,7 +565,135 @@ std::variant<MeshPart, SkinnedMeshPart> LoadMesh(const std::filesystem::path& pa
     return mesh;
 }
 
-void SerializeMeshPart(const std::filesystem::path& outfile, const std::variant<MeshPart,SkinnedMeshPart>& mesh) {
+static void WritePadded(ofstream& out, const std::vector<unsigned char>& data) {
+    constexpr char zeros[4]{};
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    out.write(zeros, MeshEncoding::Padded(uint32_t(data.size())) - data.size());
+}
+
+template<typename T>
+static std::vector<unsigned char> EncodeVertexStream(const std::vector<T>& vertices) {
+    std::vector<unsigned char> encoded(meshopt_encodeVertexBufferBound(vertices.size(), sizeof(T)));
+    encoded.resize(meshopt_encodeVertexBuffer(encoded.data(), encoded.size(), vertices.data(), vertices.size(), sizeof(T)));
+    return encoded;
+}
+
+// see MeshEncoding::magic for the layout
+void WriteEncodedVertices(ofstream& out, const MeshPart& mesh, bool quantizePositions) {
+    ASSERT(mesh.indices.size() % 3 == 0, "Compressed meshes must be triangle lists");
+    const auto numVerts = mesh.NumVerts();
+
+    MeshEncoding::EncodedMeshHeader header;
+    header.quantizedPositions = quantizePositions;
+    if (numVerts > 0) {
+        glm::vec3 min = mesh.positions[0], max = mesh.positions[0];
+        for (const auto& position : mesh.positions) {
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        header.boundsMin = min;
+        header.boundsExtent = max - min;
+    }
+
+    std::vector<float> bitangentSigns(numVerts);
+    std::vector<MeshEncoding::QuantizedAttributes> attributes(numVerts);
+    for (uint32_t i = 0; i < numVerts; i++) {
+        bitangentSigns[i] = MeshEncoding::BitangentSign(mesh.normals[i], mesh.tangents[i], mesh.bitangents[i]);
+        MeshEncoding::EncodeOctahedral(mesh.normals[i], attributes[i].normal);
+        MeshEncoding::EncodeOctahedral(mesh.tangents[i], attributes[i].tangent);
+        MeshEncoding::EncodeHalf2(mesh.uv0[i], attributes[i].uv0);
+        if (!mesh.lightmapUVs.empty()) {
+            MeshEncoding::EncodeHalf2(mesh.lightmapUVs[i], attributes[i].lightmapUV);
+        }
+    }
+
+    std::vector<unsigned char> positionStream;
+    if (quantizePositions) {
+        std::vector<MeshEncoding::QuantizedPosition> positions(numVerts);
+        for (uint32_t i = 0; i < numVerts; i++) {
+            positions[i] = {
+                MeshEncoding::QuantizeUnorm16(mesh.positions[i].x, header.boundsMin.x, header.boundsExtent.x),
+                MeshEncoding::QuantizeUnorm16(mesh.positions[i].y, header.boundsMin.y, header.boundsExtent.y),
+                MeshEncoding::QuantizeUnorm16(mesh.positions[i].z, header.boundsMin.z, header.boundsExtent.z),
+                uint16_t(bitangentSigns[i] < 0),
+            };
+        }
+        positionStream = EncodeVertexStream(positions);
+    }
+    else {
+        std::vector<MeshEncoding::FullPosition> positions(numVerts);
+        for (uint32_t i = 0; i < numVerts; i++) {
+            positions[i] = { mesh.positions[i], bitangentSigns[i] };
+        }
+        positionStream = EncodeVertexStream(positions);
+    }
+    const auto attributeStream = EncodeVertexStream(attributes);
+
+    std::vector<unsigned char> indexStream(meshopt_encodeIndexBufferBound(mesh.indices.size(), numVerts));
+    indexStream.resize(meshopt_encodeIndexBuffer(indexStream.data(), indexStream.size(), mesh.indices.data(), mesh.indices.size()));
+
+    header.positionStreamSize = uint32_t(positionStream.size());
+    header.attributeStreamSize = uint32_t(attributeStream.size());
+    header.indexStreamSize = uint32_t(indexStream.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadded(out, positionStream);
+    WritePadded(out, attributeStream);
+    WritePadded(out, indexStream);
+}
+
+void WriteRawVertices(ofstream& out, const MeshPart& mesh) {
+    out.write(reinterpret_cast<const char*>(mesh.positions.data()), mesh.positions.size() * sizeof(mesh.positions[0]));
+    out.write(reinterpret_cast<const char*>(mesh.normals.data()), mesh.normals.size() * sizeof(mesh.normals[0]));
+    out.write(reinterpret_cast<const char*>(mesh.tangents.data()), mesh.tangents.size() * sizeof(mesh.tangents[0]));
+    out.write(reinterpret_cast<const char*>(mesh.bitangents.data()), mesh.bitangents.size() * sizeof(mesh.bitangents[0]));
+    out.write(reinterpret_cast<const char*>(mesh.uv0.data()), mesh.uv0.size() * sizeof(mesh.uv0[0]));
+
+    if (mesh.lightmapUVs.size() > 0) {
+        out.write(reinterpret_cast<const char*>(mesh.lightmapUVs.data()), mesh.lightmapUVs.size() * sizeof(mesh.uv0[0]));
+    }
+
+    out.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(mesh.indices[0]));
+}
+
+void WriteMeshPart(ofstream& out, const MeshPart& mesh, bool isSkinned, uint8_t numAdditionalLODs, const EncodingSettings& encoding, uint8_t impostorFramesPerSide = 0) {
+    SerializedMeshDataHeader header{
+       .header = encoding.compress ? MeshEncoding::magic : std::array<char, 4>{'r','v','e','m'},
+       .numVertices = uint32_t(mesh.positions.size()),  // these are all the same
+       .numIndicies = uint32_t(mesh.indices.size()),
+       .attributes = uint8_t(isSkinned ? SerializedMeshDataHeader::SkinnedMeshBit : 0),
+       .numAdditionalLODs = numAdditionalLODs,
+       .impostorFramesPerSide = impostorFramesPerSide
+    };
+    header.attributes |= SerializedMeshDataHeader::hasPositionsBit;
+    header.attributes |= SerializedMeshDataHeader::hasNormalsBit;
+    header.attributes |= SerializedMeshDataHeader::hasTangentsBit;
+    header.attributes |= SerializedMeshDataHeader::hasBitangentsBit;
+    header.attributes |= SerializedMeshDataHeader::hasUV0Bit;
+    if (mesh.lightmapUVs.size() > 0) {
+        header.attributes |= SerializedMeshDataHeader::hasLightmapUVBit;
+    }
+    if (mesh.meshlets.size() > 0) {
+        header.attributes |= SerializedMeshDataHeader::hasMeshletsBit;
+    }
+
+    // write header
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (encoding.compress) {
+        WriteEncodedVertices(out, mesh, encoding.quantizePositions);
+    }
+    else {
+        WriteRawVertices(out, mesh);
+    }
+
+    if (mesh.meshlets.size() > 0) {
+        const uint32_t numMeshlets = mesh.meshlets.size();
+        out.write(reinterpret_cast<const char*>(&numMeshlets), sizeof(numMeshlets));
+        out.write(reinterpret_cast<const char*>(mesh.meshlets.data()), mesh.meshlets.size() * sizeof(mesh.meshlets[0]));
+    }
+}
+
+void SerializeMeshPart(const std::filesystem::path& outfile, const std::variant<MeshPart,SkinnedMeshPart>& mesh, const std::vector<std::pair<float, MeshPart>>& lods, const std::optional<ImpostorBake>& impostor, const EncodingSettings& encoding) {
     std::filesystem::create_directories(outfile.parent_path());		// make all the folders necessary
 
     bool isSkinned = false;
@@ -208,39 +711,8 @@ void SerializeMeshPart(const std::filesystem::path& outfile, const std::variant<
         FATAL(fmt::format("Could not open {} for writing", outfile.string()));
     }
 
-    std::visit([&out,&isSkinned](const MeshPart& mesh) {
-        
-        SerializedMeshDataHeader header{
-           .numVertices = uint32_t(mesh.positions.size()),  // these are all the same
-           .numIndicies = uint32_t(mesh.indices.size()),
-           .attributes = uint8_t(isSkinned ? SerializedMeshDataHeader::SkinnedMeshBit : 0)
-        };
-        header.attributes |= SerializedMeshDataHeader::hasPositionsBit;
-        header.attributes |= SerializedMeshDataHeader::hasNormalsBit;
-        header.attributes |= SerializedMeshDataHeader::hasTangentsBit;
-        header.attributes |= SerializedMeshDataHeader::hasBitangentsBit;
-        header.attributes |= SerializedMeshDataHeader::hasUV0Bit;
-        if (mesh.lightmapUVs.size() > 0) {
-            header.attributes |= SerializedMeshDataHeader::hasLightmapUVBit;
-        }
-
-        // write header
-        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
-
-        // vertices and indices
-        out.write(reinterpret_cast<const char*>(mesh.positions.data()), mesh.positions.size() * sizeof(mesh.positions[0]));
-        out.write(reinterpret_cast<const char*>(mesh.normals.data()), mesh.normals.size() * sizeof(mesh.normals[0]));
-        out.write(reinterpret_cast<const char*>(mesh.tangents.data()), mesh.tangents.size() * sizeof(mesh.tangents[0]));
-        out.write(reinterpret_cast<const char*>(mesh.bitangents.data()), mesh.bitangents.size() * sizeof(mesh.bitangents[0]));
-        out.write(reinterpret_cast<const char*>(mesh.uv0.data()), mesh.uv0.size() * sizeof(mesh.uv0[0]));
-
-        if (mesh.lightmapUVs.size() > 0) {
-            out.write(reinterpret_cast<const char*>(mesh.lightmapUVs.data()), mesh.lightmapUVs.size() * sizeof(mesh.uv0[0]));
-        }
-
-        out.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(mesh.indices[0]));
-
-
+    std::visit([&out,&isSkinned,&lods,&impostor,&encoding](const MeshPart& mesh) {
+        WriteMeshPart(out, mesh, isSkinned, uint8_t(lods.size()), encoding, impostor ? impostor->header.framesPerSide : 0);
     }, mesh);
    
     // executed only for skinned meshes
@@ -249,6 +721,20 @@ void SerializeMeshPart(const std::filesystem::path& outfile, const std::variant<
         [&out](const SkinnedMeshPart& mesh) {
             out.write(reinterpret_cast<const char*>(mesh.vertexWeights.data()), mesh.vertexWeights.size() * sizeof(decltype(mesh.vertexWeights)::value_type));
         }}, mesh);
+
+    // the generated LODs follow the base mesh
+    for (const auto& [minDistance, lod] : lods) {
+        out.write(reinterpret_cast<const char*>(&minDistance), sizeof(minDistance));
+        WriteMeshPart(out, lod, false, 0, encoding);
+    }
+
+    // then the impostor
+    if (impostor) {
+        out.write(reinterpret_cast<const char*>(&impostor->header), sizeof(impostor->header));
+        WriteMeshPart(out, impostor->quad, false, 0, encoding);
+        out.write(reinterpret_cast<const char*>(impostor->albedo.data()), impostor->albedo.size());
+        out.write(reinterpret_cast<const char*>(impostor->normalDepth.data()), impostor->normalDepth.size());
+    }
 }
 
 int main(int argc, char** argv){
@@ -310,12 +796,97 @@ int main(int argc, char** argv){
         isSkinned = (typeStr == "skinned");
     }
     
+    // optional generated LODs: "lods" : [{"distance" : 20, "ratio" : 0.5, "error" : 0.01}, ...]
+    std::vector<LODSettings> lodSettings;
+    simdjson::ondemand::array lodArray;
+    err = doc["lods"].get(lodArray);
+    if (!err) {
+        for (auto lodJson : lodArray) {
+            LODSettings settings;
+            double value;
+            if (lodJson["distance"].get(value)) {
+                FATAL("LOD is missing a distance");
+            }
+            settings.minDistance = value;
+            if (!lodJson["ratio"].get(value)) {
+                settings.targetRatio = value;
+            }
+            if (!lodJson["error"].get(value)) {
+                settings.targetError = value;
+            }
+            lodSettings.push_back(settings);
+        }
+    }
+    ASSERT(!isSkinned || lodSettings.empty(), "Skinned meshes do not support LODs");
+
+    // optional baked impostor, drawn instead of the mesh far away:
+    // "impostor" : {"distance" : 150, "frames" : 8, "size" : 1024, "hemisphere" : true, "albedo" : "bark.png", "color" : [1, 1, 1]}
+    std::optional<ImpostorSettings> impostorSettings;
+    simdjson::ondemand::object impostorJson;
+    err = doc["impostor"].get(impostorJson);
+    if (!err) {
+        ImpostorSettings settings;
+        double value;
+        if (impostorJson["distance"].get(value)) {
+            FATAL("Impostor is missing a distance");
+        }
+        settings.minDistance = value;
+        uint64_t count;
+        if (!impostorJson["frames"].get(count)) {
+            settings.framesPerSide = uint32_t(count);
+        }
+        if (!impostorJson["size"].get(count)) {
+            settings.atlasSize = uint32_t(count);
+        }
+        bool hemisphere;
+        if (!impostorJson["hemisphere"].get(hemisphere)) {
+            settings.hemisphere = hemisphere;
+        }
+        std::string_view albedoFile;
+        if (!impostorJson["albedo"].get(albedoFile)) {
+            settings.albedoTexture = json_dir / albedoFile;
+        }
+        simdjson::ondemand::array color;
+        if (!impostorJson["color"].get(color)) {
+            int channel = 0;
+            for (auto component : color) {
+                ASSERT(channel < 3 && !component.get(value), "Impostor color must be 3 numbers");
+                settings.color[channel++] = value;
+            }
+        }
+        impostorSettings = settings;
+    }
+    ASSERT(!isSkinned || !impostorSettings, "Skinned meshes do not support impostors");
+
+    // optional compression: "compress" : true, and "positionBits" : 16 to also quantize positions
+    EncodingSettings encoding;
+    bool compress;
+    if (!doc["compress"].get(compress)) {
+        encoding.compress = compress;
+    }
+    uint64_t positionBits;
+    if (!doc["positionBits"].get(positionBits)) {
+        ASSERT(positionBits == 16 || positionBits == 32, "positionBits must be 16 or 32");
+        encoding.quantizePositions = positionBits == 16;
+    }
+    ASSERT(lodSettings.size() <= std::numeric_limits<uint8_t>::max(), "Too many LODs");
+    
     auto mesh = isSkinned ? LoadMesh<true>(infile, fmn_opt, scaleFactor) : LoadMesh<false>(infile, fmn_opt, scaleFactor);
 
+    std::vector<std::pair<float, MeshPart>> lods;
+    for (const auto& settings : lodSettings) {
+        lods.emplace_back(settings.minDistance, GenerateLOD(std::get<MeshPart>(mesh), settings));
+    }
+
+    std::optional<ImpostorBake> impostor;
+    if (impostorSettings) {
+        impostor = BakeImpostor(std::get<MeshPart>(mesh), impostorSettings.value());
+    }
+
     inputFile.replace_extension("");
     const auto outfileName = inputFile.filename().string() + ".rvem";
 
-    SerializeMeshPart(outputDir / outfileName, mesh);
+    SerializeMeshPart(outputDir / outfileName, mesh, lods, impostor, encoding);
 
     return 0;
 }
@@ -0,0 +1,192 @@
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <zip_file.hpp>
+#include "AssetPackFormat.hpp"
+
+using namespace std;
+using namespace RavEngine;
+
+#define FATAL(reason) {std::cerr << "rvepack error: " << reason << std::endl; std::exit(1);}
+#define ASSERT(cond, str) {if (!(cond)) FATAL(str)}
+
+struct PackFile {
+    std::filesystem::path source;
+    std::string path;       // in the pack
+    uint8_t group = 0;
+};
+
+static vector<char> ReadFile(const std::filesystem::path& path) {
+    ifstream in(path, ios::binary);
+    ASSERT(in, fmt::format("cannot open {}", path.string()));
+    return vector<char>(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+static string Extension(const std::filesystem::path& path) {
+    auto ext = path.extension().string();
+    return ext.empty() ? ext : ext.substr(1);
+}
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("rvepack", "RavEngine Asset Packer");
+    options.add_options()
+        ("i,input", "Directory to pack. Its name is the root directory in the pack.", cxxopts::value<std::filesystem::path>())
+        ("o,output", "Output file path", cxxopts::value<std::filesystem::path>())
+        ("order", "File listing paths relative to the input directory in the order they are loaded. A blank line starts the next group. Unlisted files go last.", cxxopts::value<std::filesystem::path>())
+        ("l,level", "Deflate level, 0 to 9", cxxopts::value<int>()->default_value("6"))
+        ("s,store", "Extensions to store uncompressed so they can be memory-mapped", cxxopts::value<vector<string>>()->default_value("rvem"))
+        ("h,help", "Show help menu")
+        ;
+
+    auto args = options.parse(argc, argv);
+
+    if (args["help"].as<bool>()) {
+        cout << options.help() << endl;
+        return 0;
+    }
+
+    std::filesystem::path inputDir;
+    try {
+        inputDir = args["input"].as<decltype(inputDir)>();
+    }
+    catch (exception& e) {
+        FATAL("no input directory")
+    }
+    std::filesystem::path outputFile;
+    try {
+        outputFile = args["output"].as<decltype(outputFile)>();
+    }
+    catch (exception& e) {
+        FATAL("no output file")
+    }
+    ASSERT(std::filesystem::is_directory(inputDir), fmt::format("{} is not a directory", inputDir.string()));
+    const int level = std::clamp(args["level"].as<int>(), 0, 9);
+    const auto storeList = args["store"].as<vector<string>>();
+    const unordered_set<string> storedExtensions(storeList.begin(), storeList.end());
+
+    // the VFS looks files up under the name of the pack's root directory
+    const auto root = (inputDir / "").parent_path().filename().string();
+    vector<PackFile> files;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(inputDir)) {
+        if (item.is_regular_file()) {
+            files.push_back({ item.path(), root + "/" + std::filesystem::relative(item.path(), inputDir).generic_string() });
+        }
+    }
+
+    // listed files go in their groups in the listed order, the rest after them sorted by path
+    unordered_map<string, pair<uint8_t, size_t>> order;
+    uint8_t unlistedGroup = 0;
+    if (args.count("order")) {
+        ifstream in(args["order"].as<std::filesystem::path>());
+        ASSERT(in, "cannot open the load order file");
+        string line;
+        bool groupHasFiles = false;
+        while (getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                if (groupHasFiles) {
+                    ASSERT(unlistedGroup < 254, "too many load order groups");
+                    unlistedGroup++;
+                    groupHasFiles = false;
+                }
+                continue;
+            }
+            order.emplace(root + "/" + line, make_pair(unlistedGroup, order.size()));
+            groupHasFiles = true;
+        }
+        if (groupHasFiles) {
+            unlistedGroup++;
+        }
+    }
+    for (auto& file : files) {
+        auto it = order.find(file.path);
+        file.group = it != order.end() ? it->second.first : unlistedGroup;
+    }
+    std::sort(files.begin(), files.end(), [&](const PackFile& a, const PackFile& b) {
+        if (a.group != b.group) {
+            return a.group < b.group;
+        }
+        if (a.group != unlistedGroup) {
+            return order.at(a.path).second < order.at(b.path).second;
+        }
+        return a.path < b.path;
+    });
+
+    AssetPack::Header header;
+    header.entryCount = uint32_t(files.size());
+    vector<AssetPack::Entry> entries(files.size());
+    string paths;
+    for (size_t i = 0; i < files.size(); i++) {
+        ASSERT(files[i].path.size() <= UINT16_MAX, fmt::format("{} is too long", files[i].path));
+        entries[i].pathHash = AssetPack::HashPath(files[i].path);
+        entries[i].pathOffset = uint32_t(paths.size());
+        entries[i].pathLength = uint16_t(files[i].path.size());
+        entries[i].group = files[i].group;
+        paths += files[i].path;
+    }
+    header.pathsSize = uint32_t(paths.size());
+
+    ofstream out(outputFile, ios::binary | ios::trunc);
+    ASSERT(out, fmt::format("cannot open {}", outputFile.string()));
+    uint64_t offset = AssetPack::TableSize(header);
+    out.seekp(offset);
+    uint64_t totalSize = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        auto data = ReadFile(files[i].source);
+        auto& entry = entries[i];
+        entry.size = data.size();
+
+        vector<char> compressed;
+        if (!storedExtensions.contains(Extension(files[i].source)) && level > 0 && !data.empty()) {
+            mz_ulong compressedSize = mz_compressBound(mz_ulong(data.size()));
+            compressed.resize(compressedSize);
+            ASSERT(mz_compress2(reinterpret_cast<unsigned char*>(compressed.data()), &compressedSize, reinterpret_cast<const unsigned char*>(data.data()), mz_ulong(data.size()), level) == MZ_OK, fmt::format("cannot compress {}", files[i].path));
+            compressed.resize(compressedSize);
+        }
+
+        // files that barely compress are stored, since reading them costs less than inflating them
+        if (!compressed.empty() && compressed.size() < data.size() * 9 / 10) {
+            entry.encoding = AssetPack::Encoding::Deflate;
+            data = std::move(compressed);
+        }
+        else {
+            entry.encoding = AssetPack::Encoding::None;
+            offset = (offset + AssetPack::alignment - 1) / AssetPack::alignment * AssetPack::alignment;
+            out.seekp(offset);
+        }
+        entry.offset = offset;
+        entry.storedSize = data.size();
+        out.write(data.data(), data.size());
+        offset += data.size();
+        totalSize += entry.size;
+    }
+
+    // the table is sorted by hash for lookup, after the data is laid out in load order
+    vector<size_t> byHash(entries.size());
+    for (size_t i = 0; i < byHash.size(); i++) {
+        byHash[i] = i;
+    }
+    std::sort(byHash.begin(), byHash.end(), [&](size_t a, size_t b) {
+        return entries[a].pathHash != entries[b].pathHash ? entries[a].pathHash < entries[b].pathHash : files[a].path < files[b].path;
+    });
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto i : byHash) {
+        out.write(reinterpret_cast<const char*>(&entries[i]), sizeof(entries[i]));
+    }
+    out.write(paths.data(), paths.size());
+    ASSERT(out, fmt::format("cannot write {}", outputFile.string()));
+
+    cout << fmt::format("Packed {} files, {} bytes into {} bytes", files.size(), totalSize, offset) << endl;
+    return 0;
+}
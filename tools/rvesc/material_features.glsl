@@ -0,0 +1,40 @@
+// Material permutations. rvesc defines these from the "features" object of a material's json,
+// so a feature that a material turns off is compiled out rather than branched on per pixel.
+// Features are on unless the material turns them off.
+#ifndef RVE_FEATURE_NORMAL_MAP
+#define RVE_FEATURE_NORMAL_MAP 1
+#endif
+
+#ifndef RVE_FEATURE_SURFACE_MAPS        // specular, metallic, roughness and ao textures
+#define RVE_FEATURE_SURFACE_MAPS 1
+#endif
+
+#ifndef RVE_FEATURE_EMISSIVE
+#define RVE_FEATURE_EMISSIVE 1
+#endif
+
+#ifndef RVE_FEATURE_DIRECTIONAL_LIGHTS
+#define RVE_FEATURE_DIRECTIONAL_LIGHTS 1
+#endif
+
+#ifndef RVE_FEATURE_POINT_LIGHTS
+#define RVE_FEATURE_POINT_LIGHTS 1
+#endif
+
+#ifndef RVE_FEATURE_SPOT_LIGHTS
+#define RVE_FEATURE_SPOT_LIGHTS 1
+#endif
+
+#ifndef RVE_FEATURE_SHADOWS
+#define RVE_FEATURE_SHADOWS 1
+#endif
+
+// RVE_ALPHA_CUTOFF is defined by "alpha_cutoff" in the material's json, and discards fragments whose alpha is below it.
+
+// Reduced-precision builds decorate values declared rve_mediump as RelaxedPrecision,
+// which mobile GPUs may evaluate at 16 bits. Lighting accumulates at full precision.
+#if RVE_REDUCED_PRECISION
+#define rve_mediump mediump
+#else
+#define rve_mediump
+#endif
@@ -13,6 +13,9 @@ layout(early_fragment_tests) in;
 #else
     #if !RVE_DEPTHONLY 
     layout(location = 0) out vec4 result;
+    #else
+    // entity + 1, or 0 for none. Temporal upscaling reads this to find per-object motion. Shadow passes have no attachment for it.
+    layout(location = 0) out uint outEntityID;
     #endif
 #endif
 
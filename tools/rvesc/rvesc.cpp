@@ -19,7 +19,7 @@ void immediatewindow_print(const std::string& str) {
 
 #define FATAL(reason) {std::cerr << fmt::format("rvesc error ({}): {}", shaderName.string(), reason) << std::endl; return 1;}
 
-int do_compile(const std::filesystem::path& in_desc_file, const std::filesystem::path& outfile, const std::vector<std::filesystem::path>& includeDirs, const std::span<std::string> extraDefines, librglc::API targetAPI, bool debug) {
+int do_compile(const std::filesystem::path& in_desc_file, const std::filesystem::path& outfile, const std::vector<std::filesystem::path>& includeDirs, const std::span<std::string> extraDefines, librglc::API targetAPI, bool debug, bool reducedPrecision) {
 	simdjson::ondemand::parser parser;
 
 	auto json = simdjson::padded_string::load(in_desc_file.string());
@@ -182,6 +182,42 @@ int do_compile(const std::filesystem::path& in_desc_file, const std::filesystem:
 		}
 	}
 
+	// material features, such as "normal_map": false. Each becomes RVE_FEATURE_<NAME>, so a permutation 
+	// compiles out what it does not use instead of branching on it at runtime. See material_features.glsl.
+	{
+		simdjson::ondemand::object features;
+		auto err = doc["features"].get(features);
+		if (!err) {
+			for (auto field : features) {
+				std::string feature{ std::string_view(field.unescaped_key()) };
+				bool enabled;
+				if (field.value().get(enabled)) {
+					FATAL(fmt::format("feature {} must be true or false", feature));
+				}
+				std::transform(feature.begin(), feature.end(), feature.begin(), [](unsigned char c) { return std::toupper(c); });
+				defines.push_back(fmt::format("RVE_FEATURE_{} {}", feature, int(enabled)));
+			}
+		}
+	}
+
+	// alpha-tested materials discard fragments below the cutoff
+	{
+		double cutoff;
+		auto err = doc["alpha_cutoff"].get(cutoff);
+		if (!err) {
+			defines.push_back(fmt::format("RVE_ALPHA_CUTOFF {}", cutoff));
+		}
+	}
+
+	// "precision": "full" keeps a material at full precision in reduced-precision builds
+	{
+		std::string_view precision;
+		auto err = doc["precision"].get(precision);
+		if (reducedPrecision && (err || precision != "full")) {
+			defines.push_back("RVE_REDUCED_PRECISION 1");
+		}
+	}
+
 	try {
 		auto result = librglc::CompileString(full_shader, fullTemplatePath.generic_string(), targetAPI, inputStage, {
 			.include_paths = includeDirs, 
@@ -217,6 +253,7 @@ int main(int argc, char** argv) {
 		("s,stage", "Shader stage", cxxopts::value<std::string>())
 		("i,include", "Include paths", cxxopts::value<std::vector<filesystem::path>>())
 		("v,define", "Additional defines", cxxopts::value<std::vector<std::string>>())
+		("p,reduced-precision", "Shade material outputs at reduced precision, for mobile GPUs")
 		("h,help", "Show help menu")
 		;
 
@@ -233,6 +270,12 @@ int main(int argc, char** argv) {
 	}
 	catch (exception& e) {}
 
+	bool reducedPrecision = false;
+	try {
+		reducedPrecision = args["reduced-precision"].as<decltype(reducedPrecision)>();
+	}
+	catch (exception& e) {}
+
 	std::filesystem::path inputFile;
 	try {
 		inputFile = args["file"].as<decltype(inputFile)>();
@@ -306,5 +349,5 @@ int main(int argc, char** argv) {
 	}
 
 
-	return do_compile(inputFile, outputFile, includepaths, extraDefines, api, debug);;
+	return do_compile(inputFile, outputFile, includepaths, extraDefines, api, debug, reducedPrecision);;
 }
@@ -0,0 +1,500 @@
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <filesystem>
+#include <simdjson.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stb_image.h>
+#include <dds_formats.hpp>
+
+using namespace std;
+
+#define FATAL(reason) {std::cerr << "rvetc error: " << reason << std::endl; std::exit(1);}
+#define ASSERT(cond, str) {if (!(cond)) FATAL(str)}
+
+enum class OutputFormat {
+    BC1,    // RGB, 4 bpp
+    BC3,    // RGBA, 8 bpp
+    BC4,    // R, 4 bpp
+    BC5,    // RG, 8 bpp, for normal maps
+    BC7,    // RGBA, 8 bpp, higher quality than BC1 and BC3
+    R8,
+    RG8,
+    RGBA8,
+};
+
+struct TextureConfig {
+    OutputFormat format = OutputFormat::BC7;
+    bool srgb = false;          // the color channels are sRGB-encoded, so mips are averaged in linear space
+    bool normalMap = false;     // the RGB channels are a tangent-space normal, renormalized in every mip
+};
+
+// one mip of the image, as floats in [0,1]. Color channels are linear if the texture is sRGB.
+struct Image {
+    uint32_t width = 0, height = 0;
+    vector<array<float, 4>> texels;
+
+    const array<float, 4>& At(uint32_t x, uint32_t y) const {
+        return texels[size_t(std::min(y, height - 1)) * width + std::min(x, width - 1)];
+    }
+};
+
+using Texel = array<float, 4>;
+
+static float SRGBToLinear(float c) {
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSRGB(float c) {
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1 / 2.4f) - 0.055f;
+}
+
+static uint8_t ToUnorm8(float c) {
+    return uint8_t(std::clamp(c, 0.f, 1.f) * 255 + 0.5f);
+}
+
+static Image LoadImage(const std::filesystem::path& infile, const TextureConfig& config) {
+    int width, height, channels;
+    auto pixels = stbi_load(infile.string().c_str(), &width, &height, &channels, 4);
+    if (pixels == nullptr) {
+        FATAL(fmt::format("Cannot load {}: {}", infile.string(), stbi_failure_reason()));
+    }
+    Image image{ uint32_t(width), uint32_t(height) };
+    image.texels.resize(size_t(width) * height);
+    for (size_t i = 0; i < image.texels.size(); i++) {
+        for (int c = 0; c < 4; c++) {
+            const float value = pixels[i * 4 + c] / 255.f;
+            image.texels[i][c] = (config.srgb && c < 3) ? SRGBToLinear(value) : value;
+        }
+    }
+    stbi_image_free(pixels);
+    return image;
+}
+
+// a 2x2 box filter, repeating the last row and column of odd-sized images
+static Image Downsample(const Image& source, const TextureConfig& config) {
+    Image result{ std::max(source.width / 2, 1u), std::max(source.height / 2, 1u) };
+    result.texels.resize(size_t(result.width) * result.height);
+    for (uint32_t y = 0; y < result.height; y++) {
+        for (uint32_t x = 0; x < result.width; x++) {
+            Texel sum{};
+            for (const auto& texel : { source.At(x * 2, y * 2), source.At(x * 2 + 1, y * 2), source.At(x * 2, y * 2 + 1), source.At(x * 2 + 1, y * 2 + 1) }) {
+                for (int c = 0; c < 4; c++) {
+                    sum[c] += texel[c] / 4;
+                }
+            }
+            if (config.normalMap) {
+                // averaging shortens the normal, so stretch it back out from [0,1] storage
+                float n[3], length = 0;
+                for (int c = 0; c < 3; c++) {
+                    n[c] = sum[c] * 2 - 1;
+                    length += n[c] * n[c];
+                }
+                length = std::sqrt(length);
+                if (length > 0) {
+                    for (int c = 0; c < 3; c++) {
+                        sum[c] = (n[c] / length) * 0.5f + 0.5f;
+                    }
+                }
+            }
+            result.texels[size_t(y) * result.width + x] = sum;
+        }
+    }
+    return result;
+}
+
+// the 4x4 block at (bx, by), encoded back to storage space, repeating the edge texels of images smaller than a block
+static array<Texel, 16> ReadBlock(const Image& image, uint32_t bx, uint32_t by, const TextureConfig& config) {
+    array<Texel, 16> block;
+    for (uint32_t i = 0; i < 16; i++) {
+        block[i] = image.At(bx * 4 + i % 4, by * 4 + i / 4);
+        if (config.srgb) {
+            for (int c = 0; c < 3; c++) {
+                block[i][c] = LinearToSRGB(block[i][c]);
+            }
+        }
+    }
+    return block;
+}
+
+// the ends of the line that best fits the texels: the principal axis of their covariance, clipped to the extent of the texels
+static void FitEndpoints(const array<Texel, 16>& block, int channels, Texel& e0, Texel& e1) {
+    Texel mean{};
+    for (const auto& texel : block) {
+        for (int c = 0; c < channels; c++) {
+            mean[c] += texel[c] / 16;
+        }
+    }
+    float covariance[4][4]{};
+    for (const auto& texel : block) {
+        for (int i = 0; i < channels; i++) {
+            for (int j = 0; j < channels; j++) {
+                covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+            }
+        }
+    }
+    // power iteration
+    Texel axis{ 1, 1, 1, 1 };
+    for (int iteration = 0; iteration < 8; iteration++) {
+        Texel next{};
+        float length = 0;
+        for (int i = 0; i < channels; i++) {
+            for (int j = 0; j < channels; j++) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+            length = std::max(length, std::abs(next[i]));
+        }
+        if (length == 0) {
+            break;
+        }
+        for (int i = 0; i < channels; i++) {
+            axis[i] = next[i] / length;
+        }
+    }
+    float minT = 0, maxT = 0;
+    for (const auto& texel : block) {
+        float t = 0;
+        for (int c = 0; c < channels; c++) {
+            t += (texel[c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float axisLength = 0;
+    for (int c = 0; c < channels; c++) {
+        axisLength += axis[c] * axis[c];
+    }
+    axisLength = std::max(axisLength, 1e-12f);
+    for (int c = 0; c < channels; c++) {
+        e0[c] = std::clamp(mean[c] + axis[c] * minT / axisLength, 0.f, 1.f);
+        e1[c] = std::clamp(mean[c] + axis[c] * maxT / axisLength, 0.f, 1.f);
+    }
+}
+
+static float DistanceSquared(const Texel& a, const Texel& b, int channels) {
+    float d = 0;
+    for (int c = 0; c < channels; c++) {
+        d += (a[c] - b[c]) * (a[c] - b[c]);
+    }
+    return d;
+}
+
+// 8 bytes: two RGB565 endpoints and 2-bit indices into the endpoints and two colors between them
+static void EncodeBC1(const array<Texel, 16>& block, uint8_t* out) {
+    Texel e0{}, e1{};
+    FitEndpoints(block, 3, e0, e1);
+    auto pack565 = [](const Texel& c) {
+        return uint16_t((uint16_t(std::lround(std::clamp(c[0], 0.f, 1.f) * 31)) << 11) | (uint16_t(std::lround(std::clamp(c[1], 0.f, 1.f) * 63)) << 5) | uint16_t(std::lround(std::clamp(c[2], 0.f, 1.f) * 31)));
+    };
+    auto unpack565 = [](uint16_t c) {
+        return Texel{ ((c >> 11) & 31) / 31.f, ((c >> 5) & 63) / 63.f, (c & 31) / 31.f, 1 };
+    };
+    uint16_t c0 = pack565(e1), c1 = pack565(e0);
+    // c0 > c1 selects the four color mode
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        const Texel p0 = unpack565(c0), p1 = unpack565(c1);
+        Texel palette[4] = { p0, p1 };
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * p0[c] + p1[c]) / 3;
+            palette[3][c] = (p0[c] + 2 * p1[c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) {
+            uint32_t best = 0;
+            for (uint32_t p = 1; p < 4; p++) {
+                if (DistanceSquared(block[i], palette[p], 3) < DistanceSquared(block[i], palette[best], 3)) {
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+// 8 bytes: two 8-bit endpoints and 3-bit indices into the endpoints and six values between them
+static void EncodeBC4(const array<Texel, 16>& block, int channel, uint8_t* out) {
+    float lo = 1, hi = 0;
+    for (const auto& texel : block) {
+        lo = std::min(lo, texel[channel]);
+        hi = std::max(hi, texel[channel]);
+    }
+    const uint8_t a0 = ToUnorm8(hi), a1 = ToUnorm8(lo);
+    uint64_t bits = a0 | (uint64_t(a1) << 8);
+    // a0 > a1 selects the eight value mode. If they are equal, every index decodes to a0.
+    if (a0 > a1) {
+        float palette[8] = { a0 / 255.f, a1 / 255.f };
+        for (int i = 1; i < 7; i++) {
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / (7 * 255.f);
+        }
+        for (int i = 0; i < 16; i++) {
+            uint64_t best = 0;
+            for (uint64_t p = 1; p < 8; p++) {
+                if (std::abs(block[i][channel] - palette[p]) < std::abs(block[i][channel] - palette[best])) {
+                    best = p;
+                }
+            }
+            bits |= best << (16 + i * 3);
+        }
+    }
+    std::memcpy(out, &bits, 8);
+}
+
+// writes the low `count` bits of `value` at bit `offset` of a little-endian 128-bit block
+static void WriteBits(uint8_t* out, uint32_t& offset, uint32_t value, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++, offset++) {
+        out[offset / 8] |= uint8_t(((value >> i) & 1) << (offset % 8));
+    }
+}
+
+// 16 bytes, in mode 6: one subset with RGBA7777 endpoints plus a shared low bit per endpoint, and 4-bit indices
+static void EncodeBC7(const array<Texel, 16>& block, uint8_t* out) {
+    constexpr uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    Texel e0{}, e1{};
+    FitEndpoints(block, 4, e0, e1);
+
+    // quantize each endpoint with both p-bits and keep the closer one
+    auto quantize = [](const Texel& e, array<uint32_t, 4>& q, uint32_t& p) {
+        float bestError = std::numeric_limits<float>::max();
+        for (uint32_t pbit = 0; pbit < 2; pbit++) {
+            array<uint32_t, 4> candidate;
+            float error = 0;
+            for (int c = 0; c < 4; c++) {
+                candidate[c] = uint32_t(std::clamp(std::lround((e[c] * 255 - pbit) / 2), 0l, 127l));
+                const float decoded = ((candidate[c] << 1) | pbit) / 255.f;
+                error += (decoded - e[c]) * (decoded - e[c]);
+            }
+            if (error < bestError) {
+                bestError = error;
+                q = candidate;
+                p = pbit;
+            }
+        }
+    };
+    array<uint32_t, 4> q0, q1;
+    uint32_t p0, p1;
+    quantize(e0, q0, p0);
+    quantize(e1, q1, p1);
+
+    Texel palette[16];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            const uint32_t a = (q0[c] << 1) | p0, b = (q1[c] << 1) | p1;
+            palette[i][c] = (((64 - weights[i]) * a + weights[i] * b + 32) >> 6) / 255.f;
+        }
+    }
+    uint32_t indices[16];
+    for (int i = 0; i < 16; i++) {
+        indices[i] = 0;
+        for (uint32_t p = 1; p < 16; p++) {
+            if (DistanceSquared(block[i], palette[p], 4) < DistanceSquared(block[i], palette[indices[i]], 4)) {
+                indices[i] = p;
+            }
+        }
+    }
+    // the first index is stored without its high bit, so it must be below 8
+    if (indices[0] >= 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (auto& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    std::memset(out, 0, 16);
+    uint32_t offset = 0;
+    WriteBits(out, offset, 1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        WriteBits(out, offset, q0[c], 7);
+        WriteBits(out, offset, q1[c], 7);
+    }
+    WriteBits(out, offset, p0, 1);
+    WriteBits(out, offset, p1, 1);
+    WriteBits(out, offset, indices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        WriteBits(out, offset, indices[i], 4);
+    }
+}
+
+static DXGI_FORMAT DXGIFormat(const TextureConfig& config) {
+    switch (config.format) {
+    case OutputFormat::BC1: return config.srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+    case OutputFormat::BC3: return config.srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+    case OutputFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+    case OutputFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+    case OutputFormat::BC7: return config.srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+    case OutputFormat::R8: return DXGI_FORMAT_R8_UNORM;
+    case OutputFormat::RG8: return DXGI_FORMAT_R8G8_UNORM;
+    case OutputFormat::RGBA8: return DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+static vector<uint8_t> EncodeMip(const Image& mip, const TextureConfig& config) {
+    vector<uint8_t> result;
+    const uint32_t channels = config.format == OutputFormat::R8 ? 1 : config.format == OutputFormat::RG8 ? 2 : config.format == OutputFormat::RGBA8 ? 4 : 0;
+    if (channels > 0) {
+        result.reserve(mip.texels.size() * channels);
+        for (const auto& texel : mip.texels) {
+            for (uint32_t c = 0; c < channels; c++) {
+                result.push_back(ToUnorm8((config.srgb && c < 3) ? LinearToSRGB(texel[c]) : texel[c]));
+            }
+        }
+        return result;
+    }
+
+    const uint32_t blocksWide = (mip.width + 3) / 4, blocksHigh = (mip.height + 3) / 4;
+    const uint32_t blockBytes = (config.format == OutputFormat::BC1 || config.format == OutputFormat::BC4) ? 8 : 16;
+    result.resize(size_t(blocksWide) * blocksHigh * blockBytes);
+    for (uint32_t by = 0; by < blocksHigh; by++) {
+        for (uint32_t bx = 0; bx < blocksWide; bx++) {
+            const auto block = ReadBlock(mip, bx, by, config);
+            auto out = result.data() + (size_t(by) * blocksWide + bx) * blockBytes;
+            switch (config.format) {
+            case OutputFormat::BC1: EncodeBC1(block, out); break;
+            case OutputFormat::BC3: EncodeBC4(block, 3, out); EncodeBC1(block, out + 8); break;
+            case OutputFormat::BC4: EncodeBC4(block, 0, out); break;
+            case OutputFormat::BC5: EncodeBC4(block, 0, out); EncodeBC4(block, 1, out + 8); break;
+            case OutputFormat::BC7: EncodeBC7(block, out); break;
+            default: break;
+            }
+        }
+    }
+    return result;
+}
+
+static void SerializeDDS(const std::filesystem::path& outfile, const TextureConfig& config, const vector<Image>& mips, const vector<vector<uint8_t>>& encoded) {
+    std::filesystem::create_directories(outfile.parent_path());		// make all the folders necessary
+
+    ofstream out(outfile, std::ios::binary);
+    if (!out) {
+        FATAL(fmt::format("Could not open {} for writing", outfile.string()));
+    }
+
+    const uint32_t magic = dds::DdsMagicNumber::DDS;
+    dds::FileHeader header{};
+    header.size = sizeof(header);
+    header.flags = dds::HeaderFlags(dds::HeaderFlags::Texture | dds::HeaderFlags::Mipmap | dds::HeaderFlags::LinearSize);
+    header.height = mips[0].height;
+    header.width = mips[0].width;
+    header.pitch = uint32_t(encoded[0].size());
+    header.mipmapCount = uint32_t(mips.size());
+    header.pixelFormat.size = sizeof(header.pixelFormat);
+    header.pixelFormat.flags = dds::PixelFormatFlags::FourCC;
+    header.pixelFormat.fourCC = dds::DdsMagicNumber::DX10;
+    header.caps1 = 0x1000 | 0x400000 | 0x8;    // texture, complex, mipmap
+    dds::Dx10Header dx10Header{
+        .dxgiFormat = DXGIFormat(config),
+        .resourceDimension = dds::Texture2D,
+        .miscFlags = 0,
+        .arraySize = 1,
+        .miscFlags2 = 0
+    };
+
+    out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&dx10Header), sizeof(dx10Header));
+    for (const auto& mip : encoded) {
+        out.write(reinterpret_cast<const char*>(mip.data()), mip.size());
+    }
+}
+
+static OutputFormat ParseFormat(std::string_view name) {
+    constexpr std::pair<std::string_view, OutputFormat> formats[] = {
+        {"bc1", OutputFormat::BC1}, {"bc3", OutputFormat::BC3}, {"bc4", OutputFormat::BC4}, {"bc5", OutputFormat::BC5},
+        {"bc7", OutputFormat::BC7}, {"r8", OutputFormat::R8}, {"rg8", OutputFormat::RG8}, {"rgba8", OutputFormat::RGBA8},
+    };
+    for (const auto& [formatName, format] : formats) {
+        if (name == formatName) {
+            return format;
+        }
+    }
+    FATAL(fmt::format("Unknown format {}", name));
+}
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("rvetc", "RavEngine Texture Compiler");
+    options.add_options()
+        ("f,file", "Input file path", cxxopts::value<std::filesystem::path>())
+        ("o,output", "Ouptut file path", cxxopts::value<std::filesystem::path>())
+        ("h,help", "Show help menu")
+        ;
+
+    auto args = options.parse(argc, argv);
+
+    if (args["help"].as<bool>()) {
+        cout << options.help() << endl;
+        return 0;
+    }
+
+    std::filesystem::path inputFile;
+    try {
+        inputFile = args["file"].as<decltype(inputFile)>();
+    }
+    catch (exception& e) {
+        FATAL("no input file")
+    }
+    std::filesystem::path outputDir;
+    try {
+        outputDir = args["output"].as<decltype(outputDir)>();
+    }
+    catch (exception& e) {
+        FATAL("no output file")
+    }
+
+    simdjson::ondemand::parser parser;
+
+    auto json = simdjson::padded_string::load(inputFile.string());
+    simdjson::ondemand::document doc = parser.iterate(json);
+
+    const auto json_dir = inputFile.parent_path();
+
+    auto infile = json_dir / std::string_view(doc["file"]);
+
+    TextureConfig config;
+    {
+        std::string_view format;
+        if (doc["format"].get_string().get(format) == simdjson::SUCCESS) {
+            config.format = ParseFormat(format);
+        }
+        bool value;
+        if (doc["srgb"].get_bool().get(value) == simdjson::SUCCESS) {
+            config.srgb = value;
+        }
+        if (doc["normalmap"].get_bool().get(value) == simdjson::SUCCESS) {
+            config.normalMap = value;
+        }
+    }
+    ASSERT(!config.srgb || config.format == OutputFormat::BC1 || config.format == OutputFormat::BC3 || config.format == OutputFormat::BC7, "srgb is only supported with bc1, bc3 and bc7");
+    ASSERT(!(config.srgb && config.normalMap), "a normal map cannot be srgb");
+
+    // every mip down to 1x1
+    vector<Image> mips;
+    mips.push_back(LoadImage(infile, config));
+    while (mips.back().width > 1 || mips.back().height > 1) {
+        mips.push_back(Downsample(mips.back(), config));
+    }
+
+    vector<vector<uint8_t>> encoded;
+    for (const auto& mip : mips) {
+        encoded.push_back(EncodeMip(mip, config));
+    }
+
+    inputFile.replace_extension("");
+    const auto outfileName = inputFile.filename().string() + ".dds";
+
+    SerializeDDS(outputDir / outfileName, config, mips, encoded);
+
+    return 0;
+}